@@ -0,0 +1,169 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/fork_choice.hpp"
+
+#include <benchmark/benchmark.h>
+#include <qtils/cxx23/ranges/contains.hpp>
+
+#include "mock/app/validator_keys_manifest_mock.hpp"
+#include "mock/blockchain/block_storage_mock.hpp"
+#include "mock/blockchain/validator_registry_mock.hpp"
+#include "mock/crypto/xmss_provider_mock.hpp"
+#include "utils/allocation_counter.hpp"
+#include "utils/synthetic_chain.hpp"
+
+using lean::BlockHash;
+using lean::Checkpoint;
+using lean::Config;
+using lean::ForkChoiceStore;
+using lean::Interval;
+using lean::SignedAggregatedAttestation;
+using lean::State;
+using lean::ValidatorIndex;
+using lean::benchmarks::AllocationScope;
+using lean::benchmarks::cachedChain;
+using lean::benchmarks::SyntheticChain;
+using lean::benchmarks::VotePattern;
+
+/// Forks competing with canonical chain
+constexpr size_t kForks = 4;
+constexpr lean::Slot kChainLength = 64;
+
+/**
+ * Store at slot after head of `chain`, with head and safe target at chain
+ * head, no votes and states loaded from `chain` on demand.
+ */
+ForkChoiceStore createStore(const SyntheticChain &chain) {
+  auto validator_registry =
+      std::make_shared<testing::NiceMock<lean::ValidatorRegistryMock>>();
+  static lean::ValidatorRegistry::ValidatorIndices validators{0};
+  ON_CALL(*validator_registry, currentValidatorIndices())
+      .WillByDefault(testing::ReturnRef(validators));
+  ON_CALL(*validator_registry, isCurrentValidator(testing::_))
+      .WillByDefault([](lean::ValidatorIndex index) {
+        return qtils::cxx23::ranges::contains(validators, index);
+      });
+  ON_CALL(*validator_registry, nodeIdByIndex(testing::_))
+      .WillByDefault(testing::Return("node"));
+  auto block_storage =
+      std::make_shared<testing::NiceMock<lean::blockchain::BlockStorageMock>>();
+  ON_CALL(*block_storage, getState(testing::_))
+      .WillByDefault([&chain](const BlockHash &hash)
+                         -> outcome::result<std::optional<State>> {
+        auto it = chain.states().find(hash);
+        if (it == chain.states().end()) {
+          return std::nullopt;
+        }
+        return it->second;
+      });
+  auto validator_keys_manifest = std::make_shared<
+      testing::NiceMock<lean::app::ValidatorKeysManifestMock>>();
+  auto xmss_provider = std::make_shared<
+      testing::NiceMock<lean::crypto::xmss::XmssProviderMock>>();
+  auto head = Checkpoint::from(chain.head());
+  return ForkChoiceStore(
+      Interval::fromSlot(chain.head().slot + 1, 0),
+      chain.logging_system,
+      chain.metrics,
+      Config{},
+      head,
+      head,
+      {},
+      {},
+      0,
+      validator_registry,
+      validator_keys_manifest,
+      xmss_provider,
+      chain.block_tree,
+      block_storage,
+      false,
+      1);
+}
+
+/**
+ * LMD GHOST walk from genesis over canonical chain and `kForks` forks.
+ * Args: validators, fork depth, `VotePattern`.
+ */
+void BM_ComputeLmdGhostHead(benchmark::State &state) {
+  auto validators = static_cast<ValidatorIndex>(state.range(0));
+  auto &chain = cachedChain({
+      .validators = validators,
+      .length = kChainLength,
+      .forks = kForks,
+      .fork_depth = static_cast<lean::Slot>(state.range(1)),
+  });
+  auto votes = chain.votes(static_cast<VotePattern>(state.range(2)));
+  auto store = createStore(chain);
+  {
+    AllocationScope allocations{state};
+    for (auto _ : state) {
+      auto head = store.computeLmdGhostHead(chain.genesis().hash(), votes);
+      benchmark::DoNotOptimize(head);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * validators);
+  state.counters["distinct_votes"] =
+      static_cast<double>(votes.distinctCount());
+}
+BENCHMARK(BM_ComputeLmdGhostHead)
+    ->ArgNames({"validators", "fork_depth", "pattern"})
+    ->ArgsProduct({
+        {64, 1024, 4096},
+        {8, 32},
+        {
+            static_cast<int64_t>(VotePattern::SameHead),
+            static_cast<int64_t>(VotePattern::ForkTips),
+            static_cast<int64_t>(VotePattern::Scattered),
+        },
+    });
+
+/**
+ * Attestation selection for block on top of canonical head, with gossip
+ * proofs of `groups` distinct attestation data, each by every `groups`-th
+ * validator, so no group justifies alone and all of them are applied.
+ * Args: validators, groups.
+ */
+void BM_GetProposalAttestations(benchmark::State &state) {
+  auto validators = static_cast<ValidatorIndex>(state.range(0));
+  auto groups = static_cast<size_t>(state.range(1));
+  auto &chain = cachedChain({
+      .validators = validators,
+      .length = kChainLength,
+  });
+  auto store = createStore(chain);
+  for (auto &attestation : chain.attestations(groups)) {
+    SignedAggregatedAttestation signed_attestation{
+        .data = attestation.data,
+        .proof = {.participants = attestation.aggregation_bits},
+    };
+    if (not store.onAggregatedAttestation(signed_attestation, true)) {
+      state.SkipWithError("Can't add attestation");
+      return;
+    }
+  }
+  auto slot = chain.head().slot + 1;
+  auto proposer = slot % validators;
+  {
+    AllocationScope allocations{state};
+    for (auto _ : state) {
+      auto result = store.getProposalAttestations(
+          slot, proposer, chain.head().hash());
+      if (not result) {
+        state.SkipWithError("getProposalAttestations failed");
+        break;
+      }
+      benchmark::DoNotOptimize(result);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * validators);
+}
+BENCHMARK(BM_GetProposalAttestations)
+    ->ArgNames({"validators", "groups"})
+    ->ArgsProduct({
+        {64, 1024, 4096},
+        {2, 4, 16},
+    });
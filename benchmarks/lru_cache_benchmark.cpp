@@ -0,0 +1,58 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+#include "utils/lru_cache.hpp"
+#include "utils/sharded_lru_cache.hpp"
+
+using LockedCache = lean::LruCache<int, int, true>;
+using ShardedCache = lean::ShardedLruCache<int, int>;
+
+constexpr int kKeys = 256;
+
+const int kMaxThreads =
+    static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+
+/// Cache shared by benchmark threads, with `kKeys` keys
+template <typename Cache>
+Cache &filledCache() {
+  static auto cache = [] {
+    auto cache = std::make_unique<Cache>(kKeys);
+    for (int i = 0; i < kKeys; ++i) {
+      cache->put(i, i);
+    }
+    return cache;
+  }();
+  return *cache;
+}
+
+/**
+ * Concurrent lookups of cached keys, single-mutex `LruCache` compared to
+ * `ShardedLruCache`.
+ * Threads: concurrent readers.
+ */
+template <typename Cache>
+void BM_ConcurrentGet(benchmark::State &state) {
+  auto &cache = filledCache<Cache>();
+  auto key = static_cast<int>(state.thread_index());
+  for (auto _ : state) {
+    auto value = cache.get(key % kKeys);
+    benchmark::DoNotOptimize(value);
+    ++key;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_ConcurrentGet, LockedCache)
+    ->ThreadRange(1, kMaxThreads)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ConcurrentGet, ShardedCache)
+    ->ThreadRange(1, kMaxThreads)
+    ->UseRealTime();
@@ -0,0 +1,70 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <fstream>
+#include <optional>
+
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+#include "utils/simulation.hpp"
+
+using lean::benchmarks::Simulation;
+
+/// Slots simulated by each run
+constexpr lean::Slot kSlots = 32;
+
+/**
+ * Resident memory of this process, bytes.
+ * Null if `/proc/self/statm` is not available.
+ */
+std::optional<size_t> residentBytes() {
+  std::ifstream statm{"/proc/self/statm"};
+  size_t size = 0;
+  size_t resident = 0;
+  if (not(statm >> size >> resident)) {
+    return std::nullopt;
+  }
+  return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+/**
+ * Network of `nodes` fork choice stores with one validator each, finalizing
+ * over `kSlots` slots of virtual time. `rss_mib` is resident memory taken by
+ * simulation, `heads` should be 1 when nodes agree.
+ * Args: nodes, share.
+ */
+void BM_Simulation(benchmark::State &state) {
+  auto rss_before = residentBytes();
+  std::optional<lean::benchmarks::SimulationResult> result;
+  std::optional<size_t> rss_after;
+  for (auto _ : state) {
+    Simulation simulation{{
+        .nodes = static_cast<lean::ValidatorIndex>(state.range(0)),
+        .share = state.range(1) != 0,
+    }};
+    simulation.runUntil(kSlots);
+    result = simulation.result();
+    rss_after = residentBytes();
+  }
+  state.counters["slots"] = benchmark::Counter{
+      kSlots, benchmark::Counter::kIsIterationInvariantRate};
+  state.counters["heads"] = result->heads;
+  state.counters["finalized"] = result->min_finalized;
+  state.counters["deliveries"] = result->deliveries;
+  state.counters["shared_states"] = result->shared_states;
+  if (rss_before and rss_after) {
+    state.counters["rss_mib"] =
+        (static_cast<double>(*rss_after) - static_cast<double>(*rss_before))
+        / (1 << 20);
+  }
+}
+BENCHMARK(BM_Simulation)
+    ->ArgNames({"nodes", "share"})
+    ->ArgsProduct({{4, 32, 128, 256}, {0, 1}})
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond);
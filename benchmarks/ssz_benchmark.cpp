@@ -0,0 +1,157 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ranges>
+
+#include <benchmark/benchmark.h>
+
+#include "blockchain/state_root.hpp"
+#include "serde/serialization.hpp"
+#include "test_vectors/state_transition_test_json.hpp"
+#include "utils/allocation_counter.hpp"
+#include "utils/fixtures.hpp"
+#include "utils/synthetic_chain.hpp"
+
+using lean::State;
+using lean::StateTransitionTestJson;
+using lean::ValidatorIndex;
+using lean::benchmarks::AllocationScope;
+using lean::benchmarks::cachedChain;
+using lean::benchmarks::loadFixtures;
+
+constexpr lean::Slot kChainLength = 64;
+
+const State &headState(ValidatorIndex validators) {
+  auto &chain = cachedChain({
+      .validators = validators,
+      .length = kChainLength,
+  });
+  return chain.state(chain.head().hash());
+}
+
+/**
+ * Full `sszHash(State)`, without merkle cache.
+ * Args: validators.
+ */
+void BM_SszHashState(benchmark::State &state) {
+  auto &head_state = headState(state.range(0));
+  {
+    AllocationScope allocations{state};
+    for (auto _ : state) {
+      auto root = lean::sszHash(head_state);
+      benchmark::DoNotOptimize(root);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SszHashState)
+    ->ArgNames({"validators"})
+    ->Arg(64)
+    ->Arg(1024)
+    ->Arg(4096);
+
+/**
+ * `stateRoot` of child state after slot advance, reusing merkle cache of
+ * hashed parent, as on block import.
+ * Args: validators.
+ */
+void BM_StateRootIncremental(benchmark::State &state) {
+  auto &head_state = headState(state.range(0));
+  std::ignore = lean::stateRoot(head_state);
+  State child;
+  {
+    AllocationScope allocations{state};
+    for (auto _ : state) {
+      state.PauseTiming();
+      allocations.pause();
+      child = head_state;
+      ++child.slot;
+      child.historical_block_hashes.mut().push_back(
+          child.latest_block_header.hash());
+      allocations.resume();
+      state.ResumeTiming();
+      auto root = lean::stateRoot(child);
+      benchmark::DoNotOptimize(root);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StateRootIncremental)
+    ->ArgNames({"validators"})
+    ->Arg(64)
+    ->Arg(1024)
+    ->Arg(4096);
+
+/**
+ * SSZ encoding of `State` into reused buffer.
+ * Args: validators.
+ */
+void BM_SszEncodeState(benchmark::State &state) {
+  auto &head_state = headState(state.range(0));
+  qtils::ByteVec buffer;
+  {
+    AllocationScope allocations{state};
+    for (auto _ : state) {
+      lean::encodeInto(head_state, buffer);
+      benchmark::DoNotOptimize(buffer.data());
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_SszEncodeState)
+    ->ArgNames({"validators"})
+    ->Arg(64)
+    ->Arg(1024)
+    ->Arg(4096);
+
+/**
+ * SSZ decoding of `State`, as on state load from storage.
+ * Args: validators.
+ */
+void BM_SszDecodeState(benchmark::State &state) {
+  auto encoded = lean::encode(headState(state.range(0))).value();
+  {
+    AllocationScope allocations{state};
+    for (auto _ : state) {
+      auto decoded = lean::decode<State>(encoded);
+      if (not decoded) {
+        state.SkipWithError("State decode failed");
+        break;
+      }
+      benchmark::DoNotOptimize(decoded);
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * encoded.size());
+}
+BENCHMARK(BM_SszDecodeState)
+    ->ArgNames({"validators"})
+    ->Arg(64)
+    ->Arg(1024)
+    ->Arg(4096);
+
+/**
+ * `sszHash` of pre-states of state transition test vectors.
+ * Items are states.
+ */
+void BM_SszHashFixtureStates(benchmark::State &state) {
+  static const auto fixtures =
+      loadFixtures<StateTransitionTestJson>("state_transition");
+  if (fixtures.empty()) {
+    state.SkipWithError("No state transition fixtures");
+    return;
+  }
+  {
+    AllocationScope allocations{state};
+    for (auto _ : state) {
+      for (auto &fixture : fixtures | std::views::values) {
+        auto root = lean::sszHash(fixture.pre);
+        benchmark::DoNotOptimize(root);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * fixtures.size());
+}
+BENCHMARK(BM_SszHashFixtureStates);
@@ -0,0 +1,159 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/state_transition_function.hpp"
+
+#include <algorithm>
+#include <ranges>
+
+#include <benchmark/benchmark.h>
+
+#include "blockchain/state_root.hpp"
+#include "test_vectors/state_transition_test_json.hpp"
+#include "utils/allocation_counter.hpp"
+#include "utils/fixtures.hpp"
+#include "utils/synthetic_chain.hpp"
+
+using lean::Block;
+using lean::State;
+using lean::StateTransitionTestJson;
+using lean::ValidatorIndex;
+using lean::benchmarks::AllocationScope;
+using lean::benchmarks::cachedChain;
+using lean::benchmarks::loadFixtures;
+
+constexpr lean::Slot kChainLength = 64;
+
+/**
+ * Attestations of `groups` distinct data applied to canonical head state,
+ * each by every `groups`-th validator, so `groups` = 1 justifies target.
+ * Args: validators, groups.
+ */
+void BM_ProcessAttestations(benchmark::State &state) {
+  auto validators = static_cast<ValidatorIndex>(state.range(0));
+  auto &chain = cachedChain({
+      .validators = validators,
+      .length = kChainLength,
+  });
+  auto attestations =
+      chain.attestations(static_cast<size_t>(state.range(1)));
+  auto &head_state = chain.state(chain.head().hash());
+  State post_state;
+  {
+    AllocationScope allocations{state};
+    for (auto _ : state) {
+      state.PauseTiming();
+      allocations.pause();
+      post_state = head_state;
+      allocations.resume();
+      state.ResumeTiming();
+      auto result = chain.stf.processAttestations(post_state, attestations);
+      if (not result) {
+        state.SkipWithError("processAttestations failed");
+        break;
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * validators);
+}
+BENCHMARK(BM_ProcessAttestations)
+    ->ArgNames({"validators", "groups"})
+    ->ArgsProduct({
+        {64, 1024, 4096},
+        {1, 4, 16},
+    });
+
+/**
+ * Import of block on top of canonical head, with attestations of 4 groups
+ * in body, including state root check.
+ * Args: validators.
+ */
+void BM_StateTransition(benchmark::State &state) {
+  auto validators = static_cast<ValidatorIndex>(state.range(0));
+  auto &chain = cachedChain({
+      .validators = validators,
+      .length = kChainLength,
+  });
+  auto &head_state = chain.state(chain.head().hash());
+  Block block{
+      .slot = chain.head().slot + 1,
+      .proposer_index = (chain.head().slot + 1) % validators,
+      .parent_root = chain.head().hash(),
+      .state_root = {},
+      .body = {.attestations = chain.attestations(4)},
+  };
+  auto expected = chain.stf.stateTransition(block, head_state, false);
+  if (not expected) {
+    state.SkipWithError("stateTransition failed");
+    return;
+  }
+  block.state_root = lean::stateRoot(expected.value());
+  {
+    AllocationScope allocations{state};
+    for (auto _ : state) {
+      auto result = chain.stf.stateTransition(block, head_state, true);
+      if (not result) {
+        state.SkipWithError("stateTransition failed");
+        break;
+      }
+      benchmark::DoNotOptimize(result);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StateTransition)
+    ->ArgNames({"validators"})
+    ->Arg(64)
+    ->Arg(1024)
+    ->Arg(4096);
+
+/**
+ * Valid state transition test vectors, as realistic mix of blocks.
+ * Items are blocks.
+ */
+void BM_StateTransitionFixtures(benchmark::State &state) {
+  static const auto fixtures = [] {
+    auto fixtures = loadFixtures<StateTransitionTestJson>("state_transition");
+    std::erase_if(fixtures, [](const auto &fixture) {
+      return not fixture.second.post.has_value()
+          or fixture.second.expect_exception.has_value();
+    });
+    return fixtures;
+  }();
+  if (fixtures.empty()) {
+    state.SkipWithError("No state transition fixtures");
+    return;
+  }
+  auto &stf = cachedChain({}).stf;
+  auto apply = [&](const StateTransitionTestJson &fixture) {
+    auto post_state = fixture.pre;
+    for (auto &block : fixture.blocks) {
+      auto result = stf.stateTransition(block, post_state, true);
+      if (not result) {
+        return false;
+      }
+      post_state = std::move(result.value());
+    }
+    return true;
+  };
+  size_t blocks = 0;
+  {
+    AllocationScope allocations{state};
+    for (auto _ : state) {
+      auto ok = std::ranges::all_of(fixtures | std::views::values, apply);
+      if (not ok) {
+        state.SkipWithError("Fixture state transition failed");
+        break;
+      }
+      for (auto &fixture : fixtures | std::views::values) {
+        blocks += fixture.blocks.size();
+      }
+    }
+  }
+  state.SetItemsProcessed(blocks);
+  state.counters["fixtures"] = static_cast<double>(fixtures.size());
+}
+BENCHMARK(BM_StateTransitionFixtures);
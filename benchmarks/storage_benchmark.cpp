@@ -0,0 +1,364 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "blockchain/impl/storage_util.hpp"
+#include "mock/app/configuration_mock.hpp"
+#include "serde/serialization.hpp"
+#include "storage/in_memory/hashed_memory_spaced_storage.hpp"
+#include "storage/in_memory/in_memory_spaced_storage.hpp"
+#include "storage/rocksdb/rocksdb.hpp"
+#include "testutil/prepare_loggers.hpp"
+#include "types/block_body.hpp"
+#include "types/block_header.hpp"
+#include "utils/allocation_counter.hpp"
+#include "utils/synthetic_chain.hpp"
+
+using lean::BlockHash;
+using lean::benchmarks::AllocationScope;
+using lean::benchmarks::cachedChain;
+using lean::storage::Space;
+using lean::storage::SpacedStorage;
+
+enum class Backend : int64_t {
+  /// Ordered maps, `InMemorySpacedStorage`
+  InMemory,
+  /// Hash tables, `HashedMemorySpacedStorage` used by `--db_in_memory`
+  Hashed,
+  RocksDb,
+};
+
+enum class Profiles : int64_t {
+  /// Per-space profiles of default configuration
+  Tuned,
+  /// `default_space` profile for all spaces
+  Uniform,
+};
+
+/// Headers, bodies and slots stored before reads
+constexpr size_t kHeaders = 1 << 17;
+constexpr size_t kBodies = 1 << 12;
+constexpr size_t kSlots = 1 << 16;
+/// Entries read by one slot scan
+constexpr size_t kScanLength = 64;
+/// States are overwritten in ring of keys, as if older ones were pruned
+constexpr size_t kStateKeys = 64;
+
+/**
+ * Spaced storage by `Backend`.
+ * RocksDB is opened in fresh temporary directory, removed on destruction.
+ */
+class BenchmarkStorage {
+ public:
+  BenchmarkStorage(Backend backend, size_t cache_mib, Profiles profiles) {
+    switch (backend) {
+      case Backend::InMemory:
+        storage_ = std::make_shared<lean::storage::InMemorySpacedStorage>();
+        break;
+      case Backend::Hashed:
+        storage_ =
+            std::make_shared<lean::storage::HashedMemorySpacedStorage>();
+        break;
+      case Backend::RocksDb: {
+        directory_ = std::filesystem::temp_directory_path()
+                   / "qlean_storage_benchmark";
+        std::filesystem::remove_all(directory_);
+        database_ = app_config_->Configuration::database();
+        database_.directory = directory_;
+        database_.cache_size = cache_mib << 20;
+        if (profiles == Profiles::Uniform) {
+          database_.spaces.clear();
+        }
+        ON_CALL(*app_config_, database())
+            .WillByDefault(testing::ReturnRef(database_));
+        storage_ = std::make_shared<lean::storage::RocksDb>(
+            testutil::prepareLoggers(soralog::Level::ERROR),
+            app_config_,
+            nullptr);
+        break;
+      }
+    }
+  }
+
+  ~BenchmarkStorage() {
+    storage_.reset();
+    if (not directory_.empty()) {
+      std::filesystem::remove_all(directory_);
+    }
+  }
+
+  std::shared_ptr<lean::storage::BufferStorage> space(Space space) {
+    return storage_->getSpace(space);
+  }
+
+ private:
+  std::shared_ptr<testing::NiceMock<lean::app::ConfigurationMock>>
+      app_config_ = std::make_shared<
+          testing::NiceMock<lean::app::ConfigurationMock>>();
+  lean::app::Configuration::DatabaseConfig database_;
+  std::filesystem::path directory_;
+  std::shared_ptr<SpacedStorage> storage_;
+};
+
+BenchmarkStorage openStorage(const benchmark::State &state) {
+  return BenchmarkStorage{static_cast<Backend>(state.range(0)),
+                          static_cast<size_t>(state.range(1)),
+                          static_cast<Profiles>(state.range(2))};
+}
+
+/// In-memory backends once, RocksDB with each cache size and profiles
+std::vector<std::vector<int64_t>> storageRows() {
+  std::vector<std::vector<int64_t>> rows{
+      {static_cast<int64_t>(Backend::InMemory), 0, 0},
+      {static_cast<int64_t>(Backend::Hashed), 0, 0},
+  };
+  for (int64_t cache_mib : {8, 64, 512}) {
+    for (auto profiles : {Profiles::Tuned, Profiles::Uniform}) {
+      rows.push_back({static_cast<int64_t>(Backend::RocksDb),
+                      cache_mib,
+                      static_cast<int64_t>(profiles)});
+    }
+  }
+  return rows;
+}
+
+void storageArgs(benchmark::internal::Benchmark *benchmark) {
+  benchmark->ArgNames({"backend", "cache_mib", "profiles"});
+  for (auto &row : storageRows()) {
+    benchmark->Args(row);
+  }
+}
+
+void stateWriteArgs(benchmark::internal::Benchmark *benchmark) {
+  benchmark->ArgNames({"backend", "cache_mib", "profiles", "validators"});
+  for (auto &row : storageRows()) {
+    for (int64_t validators : {64, 1024, 4096}) {
+      row.resize(3);
+      row.emplace_back(validators);
+      benchmark->Args(row);
+    }
+  }
+}
+
+/// Latency of each operation, reported as `p99_us`
+class Latencies {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  decltype(auto) measure(const auto &f) {
+    struct Record {
+      Latencies &latencies;
+      Clock::time_point started = Clock::now();
+      ~Record() {
+        latencies.samples_.emplace_back(Clock::now() - started);
+      }
+    } record{*this};
+    return f();
+  }
+
+  void report(benchmark::State &state) {
+    if (samples_.empty()) {
+      return;
+    }
+    auto p99 = samples_.begin() + samples_.size() * 99 / 100;
+    std::ranges::nth_element(samples_, p99);
+    state.counters["p99_us"] =
+        std::chrono::duration<double, std::micro>{*p99}.count();
+  }
+
+ private:
+  std::vector<Clock::duration> samples_;
+};
+
+/**
+ * Bytes passed to write syscalls by this process, including background
+ * flushes and compactions of RocksDB.
+ * Null if `/proc/self/io` is not available.
+ */
+std::optional<uint64_t> processWrittenBytes() {
+  std::ifstream io{"/proc/self/io"};
+  std::string name;
+  uint64_t value = 0;
+  while (io >> name >> value) {
+    if (name == "wchar:") {
+      return value;
+    }
+  }
+  return std::nullopt;
+}
+
+BlockHash randomHash(std::mt19937_64 &random) {
+  BlockHash hash;
+  for (auto &byte : hash) {
+    byte = static_cast<uint8_t>(random());
+  }
+  return hash;
+}
+
+/// Keys of `count` values put by `make_value(i)` into `space`
+std::vector<BlockHash> fill(lean::storage::BufferStorage &space,
+                            size_t count,
+                            const auto &make_value) {
+  std::mt19937_64 random{count};
+  std::vector<BlockHash> keys;
+  keys.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto &key = keys.emplace_back(randomHash(random));
+    auto value = make_value(i);
+    space.put(key, qtils::ByteView{value}).value();
+  }
+  return keys;
+}
+
+/**
+ * Random point reads of headers by hash, as by fork choice and sync.
+ * Args: backend, cache_mib, profiles.
+ */
+void BM_StorageHeaderRead(benchmark::State &state) {
+  auto storage = openStorage(state);
+  auto space = storage.space(Space::Header);
+  std::mt19937_64 random{0};
+  auto keys = fill(*space, kHeaders, [&](size_t i) {
+    lean::BlockHeader header;
+    header.slot = i;
+    header.parent_root = randomHash(random);
+    header.state_root = randomHash(random);
+    header.body_root = randomHash(random);
+    return lean::encode(header).value();
+  });
+  Latencies latencies;
+  {
+    AllocationScope allocations{state};
+    for (auto _ : state) {
+      auto &key = keys[random() % keys.size()];
+      auto header = latencies.measure([&] { return space->get(key); });
+      benchmark::DoNotOptimize(header.value());
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  latencies.report(state);
+}
+BENCHMARK(BM_StorageHeaderRead)->Apply(storageArgs);
+
+/**
+ * Writes of encoded head state of synthetic chain, as after each block
+ * import. `write_amp` is bytes written to files per byte of values.
+ * Args: backend, cache_mib, profiles, validators.
+ */
+void BM_StorageStateWrite(benchmark::State &state) {
+  auto storage = openStorage(state);
+  auto space = storage.space(Space::State);
+  auto &chain = cachedChain({
+      .validators = static_cast<lean::ValidatorIndex>(state.range(3)),
+      .length = 8,
+  });
+  auto value = lean::encode(chain.state(chain.head().hash())).value();
+  std::mt19937_64 random{0};
+  std::vector<BlockHash> keys;
+  for (size_t i = 0; i < kStateKeys; ++i) {
+    keys.emplace_back(randomHash(random));
+  }
+  Latencies latencies;
+  auto written_before = processWrittenBytes();
+  size_t i = 0;
+  {
+    AllocationScope allocations{state};
+    for (auto _ : state) {
+      auto &key = keys[i++ % keys.size()];
+      latencies.measure(
+          [&] { return space->put(key, qtils::ByteView{value}); })
+          .value();
+    }
+  }
+  auto written_after = processWrittenBytes();
+  auto bytes = state.iterations() * value.size();
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+  latencies.report(state);
+  if (written_before and written_after and bytes != 0) {
+    state.counters["write_amp"] =
+        static_cast<double>(*written_after - *written_before)
+        / static_cast<double>(bytes);
+  }
+}
+BENCHMARK(BM_StorageStateWrite)
+    ->Apply(stateWriteArgs)
+    ->Unit(benchmark::kMicrosecond);
+
+/**
+ * Cursor scan of `kScanLength` slot-to-hashes entries from random slot,
+ * as by slot iterator on restart and sync.
+ * Args: backend, cache_mib, profiles.
+ */
+void BM_StorageSlotScan(benchmark::State &state) {
+  auto storage = openStorage(state);
+  auto space = storage.space(Space::SlotToHashes);
+  std::mt19937_64 random{0};
+  for (lean::Slot slot = 0; slot < kSlots; ++slot) {
+    auto hashes = lean::encode(std::vector{randomHash(random)}).value();
+    space
+        ->put(lean::blockchain::slotToHashLookupKey(slot),
+              qtils::ByteView{hashes})
+        .value();
+  }
+  Latencies latencies;
+  {
+    AllocationScope allocations{state};
+    for (auto _ : state) {
+      latencies.measure([&] {
+        auto cursor = space->cursor();
+        cursor
+            ->seek(lean::blockchain::slotToHashLookupKey(random() % kSlots))
+            .value();
+        for (size_t i = 0; i < kScanLength and cursor->isValid(); ++i) {
+          benchmark::DoNotOptimize(cursor->value());
+          cursor->next().value();
+        }
+      });
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kScanLength);
+  latencies.report(state);
+}
+BENCHMARK(BM_StorageSlotScan)->Apply(storageArgs);
+
+/**
+ * Random reads of block bodies with aggregated attestations, as served to
+ * peers by blocks-by-root requests.
+ * Args: backend, cache_mib, profiles.
+ */
+void BM_StorageBodyRead(benchmark::State &state) {
+  auto storage = openStorage(state);
+  auto space = storage.space(Space::Body);
+  auto &chain = cachedChain({.validators = 1024, .length = 8});
+  lean::BlockBody body{.attestations = chain.attestations(4)};
+  auto value = lean::encode(body).value();
+  auto keys = fill(*space, kBodies, [&](size_t) { return value; });
+  std::mt19937_64 random{0};
+  Latencies latencies;
+  {
+    AllocationScope allocations{state};
+    for (auto _ : state) {
+      auto &key = keys[random() % keys.size()];
+      auto read = latencies.measure([&] { return space->get(key); });
+      benchmark::DoNotOptimize(read.value());
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * value.size());
+  latencies.report(state);
+}
+BENCHMARK(BM_StorageBodyRead)->Apply(storageArgs);
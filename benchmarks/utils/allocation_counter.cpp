@@ -0,0 +1,96 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/allocation_counter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+  std::atomic_size_t allocation_count{0};
+  std::atomic_size_t allocation_bytes{0};
+
+  void *allocate(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (auto ptr = std::malloc(size != 0 ? size : 1)) {
+      return ptr;
+    }
+    throw std::bad_alloc{};
+  }
+
+  void *allocate(size_t size, std::align_val_t align) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+    auto alignment = static_cast<size_t>(align);
+    // `aligned_alloc` requires size multiple of alignment
+    auto padded = (std::max<size_t>(size, 1) + alignment - 1) / alignment
+                * alignment;
+    if (auto ptr = std::aligned_alloc(alignment, padded)) {
+      return ptr;
+    }
+    throw std::bad_alloc{};
+  }
+}  // namespace
+
+namespace lean::benchmarks {
+  Allocations allocations() {
+    return {
+        .count = allocation_count.load(std::memory_order_relaxed),
+        .bytes = allocation_bytes.load(std::memory_order_relaxed),
+    };
+  }
+}  // namespace lean::benchmarks
+
+void *operator new(size_t size) {
+  return allocate(size);
+}
+
+void *operator new[](size_t size) {
+  return allocate(size);
+}
+
+void *operator new(size_t size, std::align_val_t align) {
+  return allocate(size, align);
+}
+
+void *operator new[](size_t size, std::align_val_t align) {
+  return allocate(size, align);
+}
+
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr, size_t, std::align_val_t) noexcept {
+  std::free(ptr);
+}
@@ -0,0 +1,70 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <benchmark/benchmark.h>
+
+namespace lean::benchmarks {
+  /// Heap allocations made by all threads since process start
+  struct Allocations {
+    size_t count = 0;
+    size_t bytes = 0;
+  };
+
+  /**
+   * Totals counted by global `operator new` replacement from
+   * `allocation_counter.cpp`, compiled into each benchmark.
+   */
+  Allocations allocations();
+
+  /**
+   * Counts allocations of measured code of benchmark and reports them as
+   * per-iteration `allocs` and `alloc_bytes` counters.
+   * Allocations of setup done with `state.PauseTiming()` are excluded by
+   * calling `pause` and `resume` around it too.
+   */
+  class AllocationScope {
+   public:
+    explicit AllocationScope(benchmark::State &state)
+        : state_{state}, start_{allocations()} {}
+
+    AllocationScope(const AllocationScope &) = delete;
+    AllocationScope &operator=(const AllocationScope &) = delete;
+
+    ~AllocationScope() {
+      pause();
+      constexpr auto kPerIteration = benchmark::Counter::kAvgIterations;
+      state_.counters["allocs"] = benchmark::Counter(
+          static_cast<double>(total_.count), kPerIteration);
+      state_.counters["alloc_bytes"] = benchmark::Counter(
+          static_cast<double>(total_.bytes), kPerIteration);
+    }
+
+    void pause() {
+      if (paused_) {
+        return;
+      }
+      auto now = allocations();
+      total_.count += now.count - start_.count;
+      total_.bytes += now.bytes - start_.bytes;
+      paused_ = true;
+    }
+
+    void resume() {
+      start_ = allocations();
+      paused_ = false;
+    }
+
+   private:
+    benchmark::State &state_;
+    Allocations start_;
+    Allocations total_;
+    bool paused_ = false;
+  };
+}  // namespace lean::benchmarks
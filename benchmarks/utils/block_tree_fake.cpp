@@ -0,0 +1,230 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/block_tree_fake.hpp"
+
+#include <boost/assert.hpp>
+
+#include "blockchain/block_tree_error.hpp"
+#include "types/block_body.hpp"
+#include "types/signed_block.hpp"
+
+namespace lean::benchmarks {
+  using blockchain::BlockTreeError;
+
+  BlockTreeFake::BlockTreeFake(const Block &genesis)
+      : genesis_{genesis.index()},
+        finalized_{genesis_},
+        justified_{.root = genesis_.hash, .slot = genesis_.slot} {
+    blocks_.emplace(genesis.hash(), Entry{.header = genesis.getHeader()});
+  }
+
+  void BlockTreeFake::add(const Block &block) {
+    auto parent_it = blocks_.find(block.parent_root);
+    BOOST_ASSERT(parent_it != blocks_.end());
+    if (blocks_.emplace(block.hash(), Entry{.header = block.getHeader()})
+            .second) {
+      parent_it->second.children.emplace_back(block.hash());
+    }
+  }
+
+  outcome::result<Slot> BlockTreeFake::getSlotByHash(
+      const BlockHash &block_hash) const {
+    OUTCOME_TRY(header, getBlockHeader(block_hash));
+    return header.slot;
+  }
+
+  outcome::result<BlockHeader> BlockTreeFake::getBlockHeader(
+      const BlockHash &block_hash) const {
+    auto it = blocks_.find(block_hash);
+    if (it == blocks_.end()) {
+      return BlockTreeError::HEADER_NOT_FOUND;
+    }
+    return it->second.header;
+  }
+
+  outcome::result<std::optional<BlockHeader>> BlockTreeFake::tryGetBlockHeader(
+      const BlockHash &block_hash) const {
+    auto it = blocks_.find(block_hash);
+    if (it == blocks_.end()) {
+      return std::nullopt;
+    }
+    return it->second.header;
+  }
+
+  const BlockHash &BlockTreeFake::getGenesisBlockHash() const {
+    return genesis_.hash;
+  }
+
+  bool BlockTreeFake::has(const BlockHash &hash) const {
+    return blocks_.contains(hash);
+  }
+
+  outcome::result<BlockBody> BlockTreeFake::getBlockBody(
+      const BlockHash &) const {
+    return BlockTreeError::BODY_NOT_FOUND;
+  }
+
+  outcome::result<void> BlockTreeFake::addBlockHeader(const BlockHeader &) {
+    return BlockTreeError::WRONG_WORKFLOW;
+  }
+
+  outcome::result<void> BlockTreeFake::addBlockBody(const BlockHash &,
+                                                    const BlockBody &) {
+    return BlockTreeError::WRONG_WORKFLOW;
+  }
+
+  outcome::result<void> BlockTreeFake::addExistingBlock(const BlockHash &,
+                                                        const BlockHeader &) {
+    return BlockTreeError::WRONG_WORKFLOW;
+  }
+
+  outcome::result<void> BlockTreeFake::addBlock(
+      const SignedBlock &signed_block) {
+    if (not has(signed_block.block.parent_root)) {
+      return BlockTreeError::NO_PARENT;
+    }
+    add(signed_block.block);
+    return outcome::success();
+  }
+
+  outcome::result<void> BlockTreeFake::removeLeaf(const BlockHash &) {
+    return BlockTreeError::WRONG_WORKFLOW;
+  }
+
+  outcome::result<void> BlockTreeFake::finalize(const BlockHash &block) {
+    OUTCOME_TRY(slot, getSlotByHash(block));
+    finalized_ = {slot, block};
+    return outcome::success();
+  }
+
+  outcome::result<void> BlockTreeFake::setJustified(const BlockHash &block) {
+    OUTCOME_TRY(slot, getSlotByHash(block));
+    justified_ = {.root = block, .slot = slot};
+    return outcome::success();
+  }
+
+  outcome::result<std::vector<BlockHash>> BlockTreeFake::getBestChainFromBlock(
+      const BlockHash &, uint64_t) const {
+    return BlockTreeError::WRONG_WORKFLOW;
+  }
+
+  outcome::result<std::vector<BlockHash>>
+  BlockTreeFake::getDescendingChainToBlock(const BlockHash &,
+                                           uint64_t) const {
+    return BlockTreeError::WRONG_WORKFLOW;
+  }
+
+  bool BlockTreeFake::isFinalized(const BlockIndex &block) const {
+    auto ancestor = getAncestorAtSlot(finalized_.hash, block.slot);
+    return ancestor.has_value() and ancestor.value() == block;
+  }
+
+  BlockIndex BlockTreeFake::bestBlock() const {
+    auto best = genesis_;
+    for (auto &[hash, entry] : blocks_) {
+      if (entry.header.slot > best.slot) {
+        best = {entry.header.slot, hash};
+      }
+    }
+    return best;
+  }
+
+  outcome::result<BlockIndex> BlockTreeFake::getBestContaining(
+      const BlockHash &) const {
+    return BlockTreeError::WRONG_WORKFLOW;
+  }
+
+  std::vector<BlockHash> BlockTreeFake::getLeaves() const {
+    std::vector<BlockHash> leaves;
+    for (auto &[hash, entry] : blocks_) {
+      if (entry.children.empty()) {
+        leaves.emplace_back(hash);
+      }
+    }
+    return leaves;
+  }
+
+  outcome::result<std::vector<BlockHash>> BlockTreeFake::getChildren(
+      const BlockHash &block) const {
+    auto it = blocks_.find(block);
+    if (it == blocks_.end()) {
+      return BlockTreeError::HEADER_NOT_FOUND;
+    }
+    return it->second.children;
+  }
+
+  void BlockTreeFake::forEachNonFinalizedAncestor(
+      const BlockHash &block, const AncestorVisitor &visit) const {
+    for (auto it = blocks_.find(block);
+         it != blocks_.end() and it->first != finalized_.hash;
+         it = blocks_.find(it->second.header.parent_root)) {
+      auto &header = it->second.header;
+      if (not visit({
+              .index = {header.slot, it->first},
+              .parent_root = header.parent_root,
+              .state_root = header.state_root,
+          })) {
+        break;
+      }
+    }
+  }
+
+  std::optional<BlockIndex> BlockTreeFake::getAncestorAtSlot(
+      const BlockHash &block, Slot slot) const {
+    for (auto it = blocks_.find(block); it != blocks_.end();
+         it = blocks_.find(it->second.header.parent_root)) {
+      if (it->second.header.slot <= slot) {
+        return BlockIndex{it->second.header.slot, it->first};
+      }
+    }
+    return std::nullopt;
+  }
+
+  std::optional<blockchain::CommonAncestor> BlockTreeFake::getCommonAncestor(
+      const BlockHash &lhs, const BlockHash &rhs) const {
+    auto lhs_it = blocks_.find(lhs);
+    auto rhs_it = blocks_.find(rhs);
+    blockchain::CommonAncestor ancestor{};
+    while (lhs_it != blocks_.end() and rhs_it != blocks_.end()) {
+      if (lhs_it == rhs_it) {
+        ancestor.index = {lhs_it->second.header.slot, lhs_it->first};
+        return ancestor;
+      }
+      // Step down from higher block, or from both at same slot
+      auto lhs_slot = lhs_it->second.header.slot;
+      auto rhs_slot = rhs_it->second.header.slot;
+      if (lhs_slot >= rhs_slot) {
+        lhs_it = blocks_.find(lhs_it->second.header.parent_root);
+        ++ancestor.lhs_distance;
+      }
+      if (rhs_slot >= lhs_slot) {
+        rhs_it = blocks_.find(rhs_it->second.header.parent_root);
+        ++ancestor.rhs_distance;
+      }
+    }
+    return std::nullopt;
+  }
+
+  BlockIndex BlockTreeFake::lastFinalized() const {
+    return finalized_;
+  }
+
+  Checkpoint BlockTreeFake::getLatestJustified() const {
+    return justified_;
+  }
+
+  outcome::result<std::optional<SignedBlock>> BlockTreeFake::tryGetSignedBlock(
+      const BlockHash) const {
+    return std::nullopt;
+  }
+
+  outcome::result<std::vector<std::optional<SignedBlock>>>
+  BlockTreeFake::tryGetSignedBlocks(
+      std::span<const BlockHash> block_hashes) const {
+    return std::vector<std::optional<SignedBlock>>(block_hashes.size());
+  }
+}  // namespace lean::benchmarks
@@ -0,0 +1,88 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "blockchain/block_tree.hpp"
+#include "types/block.hpp"
+#include "types/checkpoint.hpp"
+
+namespace lean::benchmarks {
+  /**
+   * In-memory block tree of synthetic chain, without storage and locks.
+   *
+   * Mocks of tests answer `getChildren` and ancestor walks by scanning all
+   * blocks, which would dominate fork choice timings. Genesis is finalized
+   * and justified initially, `finalize` and `setJustified` only move
+   * checkpoints, nothing is pruned. Only lookups used by fork choice and STF
+   * are implemented, other tree modifications return `WRONG_WORKFLOW`.
+   */
+  class BlockTreeFake : public blockchain::BlockTree {
+   public:
+    explicit BlockTreeFake(const Block &genesis);
+
+    /// Add block whose parent is in tree
+    void add(const Block &block);
+
+    outcome::result<Slot> getSlotByHash(
+        const BlockHash &block_hash) const override;
+    outcome::result<BlockHeader> getBlockHeader(
+        const BlockHash &block_hash) const override;
+    outcome::result<std::optional<BlockHeader>> tryGetBlockHeader(
+        const BlockHash &block_hash) const override;
+
+    const BlockHash &getGenesisBlockHash() const override;
+    bool has(const BlockHash &hash) const override;
+    outcome::result<BlockBody> getBlockBody(
+        const BlockHash &block_hash) const override;
+    outcome::result<void> addBlockHeader(const BlockHeader &header) override;
+    outcome::result<void> addBlockBody(const BlockHash &block_hash,
+                                       const BlockBody &block_body) override;
+    outcome::result<void> addExistingBlock(
+        const BlockHash &block_hash, const BlockHeader &block_header) override;
+    outcome::result<void> addBlock(const SignedBlock &signed_block) override;
+    outcome::result<void> removeLeaf(const BlockHash &block_hash) override;
+    outcome::result<void> finalize(const BlockHash &block) override;
+    outcome::result<void> setJustified(const BlockHash &block) override;
+    outcome::result<std::vector<BlockHash>> getBestChainFromBlock(
+        const BlockHash &block, uint64_t maximum) const override;
+    outcome::result<std::vector<BlockHash>> getDescendingChainToBlock(
+        const BlockHash &block, uint64_t maximum) const override;
+    bool isFinalized(const BlockIndex &block) const override;
+    BlockIndex bestBlock() const override;
+    outcome::result<BlockIndex> getBestContaining(
+        const BlockHash &target_hash) const override;
+    std::vector<BlockHash> getLeaves() const override;
+    outcome::result<std::vector<BlockHash>> getChildren(
+        const BlockHash &block) const override;
+    void forEachNonFinalizedAncestor(
+        const BlockHash &block, const AncestorVisitor &visit) const override;
+    std::optional<BlockIndex> getAncestorAtSlot(const BlockHash &block,
+                                                Slot slot) const override;
+    std::optional<blockchain::CommonAncestor> getCommonAncestor(
+        const BlockHash &lhs, const BlockHash &rhs) const override;
+    BlockIndex lastFinalized() const override;
+    Checkpoint getLatestJustified() const override;
+    outcome::result<std::optional<SignedBlock>> tryGetSignedBlock(
+        const BlockHash block_hash) const override;
+    outcome::result<std::vector<std::optional<SignedBlock>>>
+    tryGetSignedBlocks(std::span<const BlockHash> block_hashes) const override;
+
+   private:
+    struct Entry {
+      BlockHeader header;
+      std::vector<BlockHash> children;
+    };
+
+    BlockIndex genesis_;
+    BlockIndex finalized_;
+    Checkpoint justified_;
+    std::unordered_map<BlockHash, Entry> blocks_;
+  };
+}  // namespace lean::benchmarks
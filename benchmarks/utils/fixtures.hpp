@@ -0,0 +1,48 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <qtils/read_file.hpp>
+
+#include "serde/json.hpp"
+
+namespace lean::benchmarks {
+  /**
+   * Load named fixtures of test vectors from `directory` under
+   * `tests/test_vectors/fixtures/consensus`, same as `FIXTURE_INSTANTIATE`
+   * of test vectors test.
+   * Nothing is loaded if fixtures are not downloaded.
+   */
+  template <typename T>
+  std::vector<std::pair<std::string, T>> loadFixtures(
+      std::string_view directory) {
+    std::vector<std::pair<std::string, T>> fixtures;
+    auto search_dir = std::filesystem::path{PROJECT_SOURCE_DIR}
+                    / "tests/test_vectors/fixtures/consensus" / directory;
+    std::error_code ec;
+    for (auto &item :
+         std::filesystem::recursive_directory_iterator{search_dir, ec}) {
+      auto &json_path = item.path();
+      if (json_path.extension() != ".json") {
+        continue;
+      }
+      auto json_str = qtils::readText(json_path).value();
+      std::unordered_map<std::string, T> file_fixtures;
+      json::decode(json::NameCase::CAMEL, file_fixtures, json_str);
+      for (auto &[name, fixture] : file_fixtures) {
+        fixtures.emplace_back(name, std::move(fixture));
+      }
+    }
+    return fixtures;
+  }
+}  // namespace lean::benchmarks
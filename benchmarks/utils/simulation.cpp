@@ -0,0 +1,226 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/simulation.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+
+#include <qtils/cxx23/ranges/contains.hpp>
+
+#include "testutil/prepare_loggers.hpp"
+#include "types/fork_choice_snapshot.hpp"
+#include "utils/synthetic_chain.hpp"
+
+namespace lean::benchmarks {
+  using testing::_;
+
+  struct Simulation::Node {
+    ValidatorRegistry::ValidatorIndices validators;
+    /// Names of all nodes by validator index, viewed by registry mock
+    std::vector<std::string> node_ids;
+    std::vector<crypto::xmss::XmssPublicKey> public_keys;
+    std::shared_ptr<StoredStates> stored;
+    std::shared_ptr<BlockTreeFake> block_tree;
+    std::shared_ptr<testing::NiceMock<blockchain::BlockStorageMock>>
+        block_storage = std::make_shared<
+            testing::NiceMock<blockchain::BlockStorageMock>>();
+    std::shared_ptr<testing::NiceMock<ValidatorRegistryMock>>
+        validator_registry =
+            std::make_shared<testing::NiceMock<ValidatorRegistryMock>>();
+    std::shared_ptr<testing::NiceMock<app::ValidatorKeysManifestMock>>
+        validator_keys_manifest = std::make_shared<
+            testing::NiceMock<app::ValidatorKeysManifestMock>>();
+    std::unique_ptr<ForkChoiceStore> store;
+  };
+
+  Simulation::Simulation(const SimulationParams &params)
+      : params_{params},
+        logging_system_{testutil::prepareLoggers(soralog::Level::ERROR)},
+        validators_{makeValidators(params.nodes)} {
+    if (params.nodes == 0 or params.subnet_count == 0) {
+      throw std::invalid_argument{"Simulation: invalid params"};
+    }
+    using crypto::xmss::XmssAggregatedSignature;
+    ON_CALL(*xmss_provider_, verify(_, _, _, _))
+        .WillByDefault(testing::Return(true));
+    ON_CALL(*xmss_provider_, verifyAggregatedSignatures(_, _, _, _))
+        .WillByDefault(testing::Return(true));
+    ON_CALL(*xmss_provider_, aggregateSignatures(_, _, _, _, _, _))
+        .WillByDefault(testing::Return(XmssAggregatedSignature{}));
+
+    auto genesis_state = STF::generateGenesisState(config_, validators_);
+    genesis_ = STF::genesisBlock(genesis_state);
+    std::shared_ptr<StoredStates> shared_stored;
+    if (params.share) {
+      state_pool_ = std::make_shared<SharedStatePool>();
+      shared_stored = std::make_shared<StoredStates>();
+      shared_stored->emplace(genesis_.hash(), genesis_state);
+    }
+    nodes_.reserve(params.nodes);
+    for (ValidatorIndex index = 0; index < params.nodes; ++index) {
+      auto stored = shared_stored;
+      if (not stored) {
+        stored = std::make_shared<StoredStates>();
+        stored->emplace(genesis_.hash(), genesis_state);
+      }
+      nodes_.emplace_back(makeNode(index, std::move(stored)));
+    }
+  }
+
+  Simulation::~Simulation() = default;
+
+  std::unique_ptr<Simulation::Node> Simulation::makeNode(
+      ValidatorIndex index, std::shared_ptr<StoredStates> stored) {
+    auto node = std::make_unique<Node>();
+    node->validators = {index};
+    for (ValidatorIndex i = 0; i < validators_.size(); ++i) {
+      node->node_ids.emplace_back(fmt::format("node-{}", i));
+    }
+    node->public_keys = {
+        validators_.at(index).attestation_pubkey,
+        validators_.at(index).proposal_pubkey,
+    };
+    node->stored = std::move(stored);
+    node->block_tree = std::make_shared<BlockTreeFake>(genesis_);
+
+    auto &block_storage = *node->block_storage;
+    ON_CALL(block_storage, getState(_))
+        .WillByDefault([stored{node->stored.get()}](const BlockHash &hash)
+                           -> outcome::result<std::optional<State>> {
+          auto it = stored->find(hash);
+          if (it == stored->end()) {
+            return std::optional<State>{};
+          }
+          return it->second;
+        });
+    ON_CALL(block_storage, putState(_, _))
+        .WillByDefault([stored{node->stored.get()}](const BlockHash &hash,
+                                                    const State &state)
+                           -> outcome::result<void> {
+          stored->try_emplace(hash, state);
+          return outcome::success();
+        });
+    ON_CALL(block_storage, putForkChoiceSnapshot(_))
+        .WillByDefault(testing::Return(outcome::success()));
+    ON_CALL(block_storage, getForkChoiceSnapshot())
+        .WillByDefault(
+            testing::Return(std::optional<ForkChoiceSnapshot>{}));
+
+    ON_CALL(*node->validator_registry, currentValidatorIndices())
+        .WillByDefault(testing::ReturnRef(node->validators));
+    ON_CALL(*node->validator_registry, isCurrentValidator(_))
+        .WillByDefault([&validators = node->validators](ValidatorIndex index) {
+          return qtils::cxx23::ranges::contains(validators, index);
+        });
+    ON_CALL(*node->validator_registry, nodeIdByIndex(_))
+        .WillByDefault([&node_ids = node->node_ids](ValidatorIndex index)
+                           -> std::optional<std::string_view> {
+          if (index >= node_ids.size()) {
+            return std::nullopt;
+          }
+          return node_ids[index];
+        });
+    ON_CALL(*node->validator_keys_manifest, getAllXmssPubkeys())
+        .WillByDefault(testing::Return(node->public_keys));
+    ON_CALL(*node->validator_keys_manifest, getKeypair(_))
+        .WillByDefault([](const crypto::xmss::XmssPublicKey &public_key) {
+          return crypto::xmss::XmssKeypair{.public_key = public_key};
+        });
+
+    auto genesis = Checkpoint::from(genesis_);
+    node->store = std::make_unique<ForkChoiceStore>(
+        time_,
+        logging_system_,
+        metrics_,
+        config_,
+        genesis,
+        genesis,
+        ForkChoiceStore::AttestationDataByValidator{},
+        ForkChoiceStore::AttestationDataByValidator{},
+        index,
+        node->validator_registry,
+        node->validator_keys_manifest,
+        xmss_provider_,
+        node->block_tree,
+        node->block_storage,
+        index < params_.aggregators,
+        params_.subnet_count);
+    if (state_pool_) {
+      node->store->shareStates(state_pool_);
+    }
+    return node;
+  }
+
+  void Simulation::runUntil(Slot slot) {
+    auto end = Interval::fromSlot(slot + 1, 0);
+    while (time_.interval < end.interval) {
+      ++time_.interval;
+      now_ = time_.time(config_);
+      deliverUntil(now_);
+      for (size_t i = 0; i < nodes_.size(); ++i) {
+        for (auto &message : nodes_[i]->store->onTick(now_)) {
+          publish(i, std::move(message));
+        }
+      }
+    }
+    deliverUntil(now_);
+  }
+
+  void Simulation::publish(size_t from, Message message) {
+    gossip_.emplace(now_ + params_.latency,
+                    Delivery{
+                        .from = from,
+                        .message = std::make_shared<const Message>(
+                            std::move(message)),
+                    });
+  }
+
+  void Simulation::deliverUntil(std::chrono::milliseconds time) {
+    while (not gossip_.empty() and gossip_.begin()->first <= time) {
+      auto delivery = std::move(gossip_.begin()->second);
+      gossip_.erase(gossip_.begin());
+      for (size_t i = 0; i < nodes_.size(); ++i) {
+        if (i == delivery.from) {
+          continue;
+        }
+        auto &store = *nodes_[i]->store;
+        // Rejected gossip is dropped, as by networking
+        std::visit(
+            [&]<typename T>(const T &message) {
+              if constexpr (std::is_same_v<T, SignedBlock>) {
+                std::ignore = store.onBlock(message);
+              } else if constexpr (std::is_same_v<T, SignedAttestation>) {
+                std::ignore = store.onGossipAttestation(message);
+              } else {
+                std::ignore = store.onGossipAggregatedAttestation(message);
+              }
+            },
+            *delivery.message);
+        ++deliveries_;
+      }
+    }
+  }
+
+  SimulationResult Simulation::result() const {
+    SimulationResult result{
+        .min_finalized = nodes_.front()->store->getLatestFinalized().slot,
+        .deliveries = deliveries_,
+        .shared_states = state_pool_ ? state_pool_->sharedCount() : 0,
+    };
+    std::unordered_set<BlockHash> heads;
+    for (auto &node : nodes_) {
+      heads.emplace(node->store->getHead().root);
+      auto finalized = node->store->getLatestFinalized().slot;
+      result.min_finalized = std::min(result.min_finalized, finalized);
+      result.max_finalized = std::max(result.max_finalized, finalized);
+    }
+    result.heads = heads.size();
+    return result;
+  }
+}  // namespace lean::benchmarks
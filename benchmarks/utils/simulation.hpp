@@ -0,0 +1,113 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <qtils/shared_ref.hpp>
+
+#include "blockchain/fork_choice.hpp"
+#include "blockchain/shared_state_pool.hpp"
+#include "mock/app/validator_keys_manifest_mock.hpp"
+#include "mock/blockchain/block_storage_mock.hpp"
+#include "mock/blockchain/validator_registry_mock.hpp"
+#include "mock/crypto/xmss_provider_mock.hpp"
+#include "mock/metrics_mock.hpp"
+#include "utils/block_tree_fake.hpp"
+
+namespace lean::benchmarks {
+  struct SimulationParams {
+    /// Each node runs one validator
+    ValidatorIndex nodes = 4;
+    /// Nodes aggregating attestations, from first one
+    size_t aggregators = 1;
+    uint64_t subnet_count = 1;
+    /// Gossip delay between any two nodes
+    std::chrono::milliseconds latency{100};
+    /// Share genesis state, post-states and stored states between nodes
+    bool share = true;
+  };
+
+  /// Outcome of simulation, for checking that nodes agree
+  struct SimulationResult {
+    /// Distinct heads of nodes
+    size_t heads = 0;
+    Slot min_finalized = 0;
+    Slot max_finalized = 0;
+    /// Gossip messages delivered to nodes
+    size_t deliveries = 0;
+    /// States which were kept shared instead of copied
+    size_t shared_states = 0;
+  };
+
+  /**
+   * Many fork choice stores in one process, connected by in-memory gossip
+   * with fixed latency and driven by virtual clock, so consensus runs as
+   * fast as stores process it.
+   *
+   * Nodes share immutable objects: logging, metrics, xmss provider, which
+   * accepts all signatures, genesis state and, if `share` is set,
+   * post-states of state caches and stored states. Blocks and votes are
+   * produced by stores as on real nodes, block trees are separate.
+   */
+  class Simulation {
+   public:
+    explicit Simulation(const SimulationParams &params);
+    ~Simulation();
+
+    /// Run until virtual clock reaches end of `slot`
+    void runUntil(Slot slot);
+
+    SimulationResult result() const;
+
+    const SimulationParams &params() const {
+      return params_;
+    }
+
+   private:
+    using Message = ForkChoiceStore::OnTickAction;
+
+    struct Node;
+
+    /// Stored states, shared by nodes or own of one node
+    using StoredStates = std::unordered_map<BlockHash, State>;
+
+    struct Delivery {
+      size_t from;
+      std::shared_ptr<const Message> message;
+    };
+
+    std::unique_ptr<Node> makeNode(ValidatorIndex index,
+                                   std::shared_ptr<StoredStates> stored);
+
+    void publish(size_t from, Message message);
+
+    void deliverUntil(std::chrono::milliseconds time);
+
+    SimulationParams params_;
+    Config config_{};
+    qtils::SharedRef<log::LoggingSystem> logging_system_;
+    qtils::SharedRef<metrics::MetricsMock> metrics_ =
+        std::make_shared<metrics::MetricsMock>();
+    qtils::SharedRef<testing::NiceMock<crypto::xmss::XmssProviderMock>>
+        xmss_provider_ = std::make_shared<
+            testing::NiceMock<crypto::xmss::XmssProviderMock>>();
+    std::vector<Validator> validators_;
+    Block genesis_;
+    std::shared_ptr<SharedStatePool> state_pool_;
+    std::vector<std::unique_ptr<Node>> nodes_;
+    /// Pending gossip by delivery time
+    std::multimap<std::chrono::milliseconds, Delivery> gossip_;
+    std::chrono::milliseconds now_{};
+    Interval time_{};
+    size_t deliveries_ = 0;
+  };
+}  // namespace lean::benchmarks
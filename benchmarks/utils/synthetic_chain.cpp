@@ -0,0 +1,189 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/synthetic_chain.hpp"
+
+#include <map>
+#include <random>
+#include <ranges>
+#include <stdexcept>
+#include <tuple>
+
+#include "blockchain/is_justifiable_slot.hpp"
+#include "blockchain/state_root.hpp"
+#include "testutil/prepare_loggers.hpp"
+
+namespace lean::benchmarks {
+  std::vector<Validator> makeValidators(ValidatorIndex count) {
+    std::vector<Validator> validators;
+    validators.reserve(count);
+    for (ValidatorIndex index = 0; index < count; ++index) {
+      auto &validator = validators.emplace_back();
+      validator.index = index;
+      for (size_t i = 0; i < validator.attestation_pubkey.size(); ++i) {
+        validator.attestation_pubkey[i] = static_cast<uint8_t>(index + i);
+        validator.proposal_pubkey[i] = static_cast<uint8_t>(~(index + i));
+      }
+    }
+    return validators;
+  }
+
+  SyntheticChain::SyntheticChain(const SyntheticChainParams &params)
+      : SyntheticChain{params,
+                       STF::generateGenesisState(
+                           Config{}, makeValidators(params.validators))} {}
+
+  SyntheticChain::SyntheticChain(const SyntheticChainParams &params,
+                                 State genesis_state)
+      : logging_system{testutil::prepareLoggers(soralog::Level::ERROR)},
+        block_tree{
+            std::make_shared<BlockTreeFake>(STF::genesisBlock(genesis_state))},
+        stf{logging_system, block_tree, metrics},
+        params_{params} {
+    if (params.validators == 0 or params.fork_depth > params.length) {
+      throw std::invalid_argument{"SyntheticChain: invalid params"};
+    }
+    auto &genesis = canonical_.emplace_back(STF::genesisBlock(genesis_state));
+    states_.emplace(genesis.hash(), std::move(genesis_state));
+    for (Slot slot = 1; slot <= params.length; ++slot) {
+      canonical_.emplace_back(produceBlock(slot, canonical_.back()));
+    }
+    auto branch_slot = params.length - params.fork_depth;
+    for (size_t fork = 1; fork <= params.forks and params.fork_depth != 0;
+         ++fork) {
+      auto &blocks = forks_.emplace_back();
+      const Block *parent = &canonical_.at(branch_slot);
+      for (Slot i = 0; i < params.fork_depth; ++i) {
+        parent = &blocks.emplace_back(
+            produceBlock(branch_slot + 1 + fork + i, *parent));
+      }
+    }
+  }
+
+  Block SyntheticChain::produceBlock(Slot slot, const Block &parent) {
+    Block block{
+        .slot = slot,
+        .proposer_index = slot % params_.validators,
+        .parent_root = parent.hash(),
+        .state_root = {},
+        .body = {},
+    };
+    auto state = stf.stateTransition(block, states_.at(parent.hash()), false)
+                     .value();
+    block.state_root = stateRoot(state);
+    block.setHash();
+    block_tree->add(block);
+    states_.emplace(block.hash(), std::move(state));
+    return block;
+  }
+
+  std::vector<const Block *> SyntheticChain::tips() const {
+    std::vector<const Block *> tips{&head()};
+    for (auto &fork : forks_) {
+      tips.emplace_back(&fork.back());
+    }
+    return tips;
+  }
+
+  std::vector<const Block *> SyntheticChain::blocks() const {
+    std::vector<const Block *> blocks;
+    for (auto &block : canonical_ | std::views::drop(1)) {
+      blocks.emplace_back(&block);
+    }
+    for (auto &fork : forks_) {
+      for (auto &block : fork) {
+        blocks.emplace_back(&block);
+      }
+    }
+    return blocks;
+  }
+
+  VoteTable SyntheticChain::votes(VotePattern pattern) const {
+    auto vote = [&](const Block &block) {
+      return AttestationData{
+          .slot = block.slot,
+          .head = Checkpoint::from(block),
+          .target = Checkpoint::from(block),
+          .source = Checkpoint::from(genesis()),
+      };
+    };
+    VoteTable votes;
+    switch (pattern) {
+      case VotePattern::SameHead: {
+        auto data = vote(head());
+        for (ValidatorIndex i = 0; i < params_.validators; ++i) {
+          votes.insert_or_assign(i, data);
+        }
+        break;
+      }
+      case VotePattern::ForkTips: {
+        auto tips = this->tips();
+        for (ValidatorIndex i = 0; i < params_.validators; ++i) {
+          votes.insert_or_assign(i, vote(*tips[i % tips.size()]));
+        }
+        break;
+      }
+      case VotePattern::Scattered: {
+        auto blocks = this->blocks();
+        // Fixed seed, so runs are comparable
+        std::mt19937_64 random{params_.validators};
+        std::uniform_int_distribution<size_t> pick{0, blocks.size() - 1};
+        for (ValidatorIndex i = 0; i < params_.validators; ++i) {
+          votes.insert_or_assign(i, vote(*blocks[pick(random)]));
+        }
+        break;
+      }
+    }
+    return votes;
+  }
+
+  AggregatedAttestations SyntheticChain::attestations(size_t groups) const {
+    std::vector<Slot> target_slots;
+    for (auto slot = head().slot - 1; slot > 0 and target_slots.size() < groups;
+         --slot) {
+      if (isJustifiableSlot(0, slot)) {
+        target_slots.emplace_back(slot);
+      }
+    }
+    if (target_slots.size() < groups) {
+      throw std::invalid_argument{"SyntheticChain: chain is too short"};
+    }
+    AggregatedAttestations attestations;
+    for (size_t group = 0; group < groups; ++group) {
+      auto &target = canonical_.at(target_slots[group]);
+      AggregatedAttestation attestation{
+          .aggregation_bits = {},
+          .data =
+              {
+                  .slot = target.slot,
+                  .head = Checkpoint::from(target),
+                  .target = Checkpoint::from(target),
+                  .source = Checkpoint::from(genesis()),
+              },
+      };
+      for (auto i = group; i < params_.validators; i += groups) {
+        attestation.aggregation_bits.add(i);
+      }
+      attestations.push_back(std::move(attestation));
+    }
+    return attestations;
+  }
+
+  const SyntheticChain &cachedChain(const SyntheticChainParams &params) {
+    using Key = std::tuple<ValidatorIndex, Slot, size_t, Slot>;
+    static std::map<Key, std::unique_ptr<SyntheticChain>> chains;
+    auto &chain = chains[Key{
+        params.validators,
+        params.length,
+        params.forks,
+        params.fork_depth,
+    }];
+    if (chain == nullptr) {
+      chain = std::make_unique<SyntheticChain>(params);
+    }
+    return *chain;
+  }
+}  // namespace lean::benchmarks
@@ -0,0 +1,132 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <qtils/shared_ref.hpp>
+
+#include "blockchain/state_transition_function.hpp"
+#include "blockchain/vote_table.hpp"
+#include "mock/metrics_mock.hpp"
+#include "types/aggregated_attestations.hpp"
+#include "types/block.hpp"
+#include "types/state.hpp"
+#include "utils/block_tree_fake.hpp"
+
+namespace lean::benchmarks {
+  struct SyntheticChainParams {
+    ValidatorIndex validators = 64;
+    /// Blocks of canonical chain after genesis
+    Slot length = 32;
+    /// Forks branching from canonical chain at slot `length - fork_depth`
+    size_t forks = 0;
+    /// Blocks in each fork, not more than `length`
+    Slot fork_depth = 0;
+  };
+
+  /// How validators vote on synthetic chain
+  enum class VotePattern : int64_t {
+    /// All validators vote for canonical head
+    SameHead,
+    /// Validators are spread evenly over canonical head and fork tips
+    ForkTips,
+    /// Each validator votes for random block, most data is distinct
+    Scattered,
+  };
+
+  /**
+   * Chain of real blocks and post-states, produced with STF from genesis
+   * with `validators` validators.
+   *
+   * Canonical chain has block at each slot. Fork `k` (1-based) branches
+   * from canonical block at slot `length - fork_depth`, its first block is
+   * at slot `length - fork_depth + 1 + k`, so slots of forks differ and all
+   * blocks have distinct hashes. Blocks have empty bodies and are added to
+   * `block_tree`.
+   */
+  class SyntheticChain {
+   public:
+    explicit SyntheticChain(const SyntheticChainParams &params);
+
+    const SyntheticChainParams &params() const {
+      return params_;
+    }
+
+    const Block &genesis() const {
+      return canonical_.front();
+    }
+
+    const Block &head() const {
+      return canonical_.back();
+    }
+
+    /// Canonical blocks by slot, starting from genesis
+    const std::vector<Block> &canonical() const {
+      return canonical_;
+    }
+
+    const std::vector<std::vector<Block>> &forks() const {
+      return forks_;
+    }
+
+    /// Canonical head followed by tips of forks
+    std::vector<const Block *> tips() const;
+
+    /// All blocks except genesis
+    std::vector<const Block *> blocks() const;
+
+    const State &state(const BlockHash &block_hash) const {
+      return states_.at(block_hash);
+    }
+
+    const std::unordered_map<BlockHash, State> &states() const {
+      return states_;
+    }
+
+    /**
+     * Latest vote of each validator by `pattern`.
+     * Source is genesis, target is voted block.
+     */
+    VoteTable votes(VotePattern pattern) const;
+
+    /**
+     * `groups` attestations, each by every `groups`-th validator, with
+     * distinct justifiable canonical targets before head and genesis
+     * source, as aggregated in proposed block.
+     */
+    AggregatedAttestations attestations(size_t groups) const;
+
+    qtils::SharedRef<log::LoggingSystem> logging_system;
+    qtils::SharedRef<metrics::MetricsMock> metrics =
+        std::make_shared<metrics::MetricsMock>();
+    qtils::SharedRef<BlockTreeFake> block_tree;
+    STF stf;
+
+   private:
+    SyntheticChain(const SyntheticChainParams &params, State genesis_state);
+
+    Block produceBlock(Slot slot, const Block &parent);
+
+    SyntheticChainParams params_;
+    std::vector<Block> canonical_;
+    std::vector<std::vector<Block>> forks_;
+    std::unordered_map<BlockHash, State> states_;
+  };
+
+  /// Validators with distinct non-zero public keys
+  std::vector<Validator> makeValidators(ValidatorIndex count);
+
+  /**
+   * Chain with `params`, produced once per process.
+   * Benchmark function is called several times while iteration count is
+   * estimated, so generation is not repeated by each call.
+   */
+  const SyntheticChain &cachedChain(const SyntheticChainParams &params);
+}  // namespace lean::benchmarks
@@ -0,0 +1,264 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "crypto/xmss/ffi.hpp"
+#include "crypto/xmss/xmss_provider_impl.hpp"
+#include "mock/metrics_mock.hpp"
+#include "types/constants.hpp"
+#include "utils/allocation_counter.hpp"
+#include "utils/worker_pool.hpp"
+
+using lean::VALIDATOR_REGISTRY_LIMIT;
+using lean::benchmarks::AllocationScope;
+using lean::crypto::xmss::XmssAggregatedSignature;
+using lean::crypto::xmss::XmssKeypair;
+using lean::crypto::xmss::XmssMessage;
+using lean::crypto::xmss::XmssProviderImpl;
+using lean::crypto::xmss::XmssPublicKeyRef;
+using lean::crypto::xmss::XmssSignature;
+using lean::crypto::xmss::XmssVerifyItem;
+namespace ffi = lean::crypto::xmss::ffi;
+
+constexpr uint64_t kActiveEpochs = 10;
+constexpr uint32_t kEpoch = 5;
+const XmssMessage kMessage{0x42};
+
+const int kMaxThreads =
+    static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+/// Provider without metrics and without pool, for single calls
+XmssProviderImpl &provider() {
+  static XmssProviderImpl provider;
+  return provider;
+}
+
+/// Provider with own pool of `threads` workers, for batch calls
+XmssProviderImpl &pooledProvider(size_t threads) {
+  static std::mutex mutex;
+  static std::map<size_t, std::unique_ptr<XmssProviderImpl>> providers;
+  std::lock_guard lock{mutex};
+  auto &provider = providers[threads];
+  if (not provider) {
+    provider = std::make_unique<XmssProviderImpl>(
+        std::make_shared<lean::metrics::MetricsMock>(),
+        std::make_shared<lean::WorkerPool>(threads));
+  }
+  return *provider;
+}
+
+/**
+ * Signed committee, keys are generated once and grow on demand.
+ * Keypairs don't move as committee grows, public keys refer to them.
+ */
+struct Committee {
+  std::deque<XmssKeypair> keypairs;
+  std::vector<XmssPublicKeyRef> public_keys;
+  std::vector<XmssSignature> signatures;
+  std::map<size_t, XmssAggregatedSignature> proofs;
+};
+
+Committee &committee(size_t size) {
+  static std::mutex mutex;
+  static Committee committee;
+  std::lock_guard lock{mutex};
+  while (committee.keypairs.size() < size) {
+    auto &keypair = committee.keypairs.emplace_back(
+        provider().generateKeypair(0, kActiveEpochs));
+    committee.public_keys.emplace_back(&keypair.public_key);
+    committee.signatures.emplace_back(
+        provider().sign(keypair.private_key, kEpoch, kMessage));
+  }
+  return committee;
+}
+
+/// Proof of first `size` signatures of committee
+const XmssAggregatedSignature &proof(size_t size) {
+  auto &signed_committee = committee(size);
+  static std::mutex mutex;
+  std::lock_guard lock{mutex};
+  auto it = signed_committee.proofs.find(size);
+  if (it == signed_committee.proofs.end()) {
+    it = signed_committee.proofs
+             .emplace(size,
+                      provider().aggregateSignatures(
+                          {},
+                          {},
+                          std::span{signed_committee.public_keys}.first(size),
+                          std::span{signed_committee.signatures}.first(size),
+                          kEpoch,
+                          kMessage))
+             .first;
+  }
+  return it->second;
+}
+
+/**
+ * `sign`, each thread signs with own key.
+ * Threads: concurrent signers.
+ */
+void BM_XmssSign(benchmark::State &state) {
+  auto &keypair = committee(kMaxThreads).keypairs.at(state.thread_index());
+  {
+    AllocationScope allocations{state};
+    for (auto _ : state) {
+      auto signature = provider().sign(keypair.private_key, kEpoch, kMessage);
+      benchmark::DoNotOptimize(signature);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_XmssSign)->ThreadRange(1, kMaxThreads)->UseRealTime();
+
+/**
+ * `verify` of single signature, public key is parsed once and cached.
+ * Threads: concurrent verifiers.
+ */
+void BM_XmssVerify(benchmark::State &state) {
+  auto &signed_committee = committee(kMaxThreads);
+  auto &public_key = *signed_committee.public_keys.at(state.thread_index());
+  auto &signature = signed_committee.signatures.at(state.thread_index());
+  {
+    AllocationScope allocations{state};
+    for (auto _ : state) {
+      auto valid = provider().verify(public_key, kMessage, kEpoch, signature);
+      benchmark::DoNotOptimize(valid);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_XmssVerify)->ThreadRange(1, kMaxThreads)->UseRealTime();
+
+/// FFI deserialization of public key, the part of `verify` hidden by cache
+void BM_XmssParsePublicKey(benchmark::State &state) {
+  auto &public_key = *committee(1).public_keys.front();
+  for (auto _ : state) {
+    PQPublicKey *raw = nullptr;
+    ffi::asOutcome(pq_public_key_from_bytes(public_key.data(), &raw)).value();
+    ffi::PublicKey parsed{raw};
+    benchmark::DoNotOptimize(parsed);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_XmssParsePublicKey);
+
+/// FFI deserialization of signature, done by each `verify`
+void BM_XmssParseSignature(benchmark::State &state) {
+  auto &signature = committee(1).signatures.front();
+  for (auto _ : state) {
+    PQSignature *raw = nullptr;
+    ffi::asOutcome(pq_signature_from_bytes(signature.data(), &raw)).value();
+    ffi::Signature parsed{raw};
+    benchmark::DoNotOptimize(parsed);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_XmssParseSignature);
+
+/// `pq_verify` of parsed key and signature, `verify` without FFI overhead
+void BM_XmssVerifyParsed(benchmark::State &state) {
+  auto &signed_committee = committee(1);
+  PQPublicKey *public_key_raw = nullptr;
+  ffi::asOutcome(pq_public_key_from_bytes(
+                     signed_committee.public_keys.front()->data(),
+                     &public_key_raw))
+      .value();
+  ffi::PublicKey public_key{public_key_raw};
+  PQSignature *signature_raw = nullptr;
+  ffi::asOutcome(pq_signature_from_bytes(
+                     signed_committee.signatures.front().data(),
+                     &signature_raw))
+      .value();
+  ffi::Signature signature{signature_raw};
+  for (auto _ : state) {
+    auto valid = pq_verify(
+        public_key.get(), kEpoch, kMessage.data(), signature.get());
+    benchmark::DoNotOptimize(valid);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_XmssVerifyParsed);
+
+/**
+ * `aggregateBatch` of one committee, which planner may split into leaf
+ * proofs over pool.
+ * `shadow_xmss_aggregate_signatures_rate` of `threads:1` rows is value
+ * for `--shadow-xmss-aggregate-signatures-rate`.
+ * Args: committee, threads.
+ */
+void BM_XmssAggregate(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  auto &pooled = pooledProvider(state.range(1));
+  auto &signed_committee = committee(size);
+  lean::crypto::xmss::XmssAggregateItem item{
+      .public_keys = std::span{signed_committee.public_keys}.first(size),
+      .signatures = std::span{signed_committee.signatures}.first(size),
+      .epoch = kEpoch,
+      .message = kMessage,
+  };
+  for (auto _ : state) {
+    auto proofs = pooled.aggregateBatch(std::span{&item, 1});
+    benchmark::DoNotOptimize(proofs);
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+  state.counters["shadow_xmss_aggregate_signatures_rate"] =
+      benchmark::Counter(static_cast<double>(size),
+                         benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_XmssAggregate)
+    ->ArgNames({"committee", "threads"})
+    ->ArgsProduct({
+        benchmark::CreateRange(1, VALIDATOR_REGISTRY_LIMIT, 8),
+        benchmark::CreateRange(1, kMaxThreads, 2),
+    })
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+/**
+ * `verifyBatch` of one proof per thread of pool.
+ * `shadow_xmss_verify_aggregated_signatures_rate` of `threads:1` rows is
+ * value for `--shadow-xmss-verify-aggregated-signatures-rate`.
+ * Args: committee, threads.
+ */
+void BM_XmssVerifyAggregated(benchmark::State &state) {
+  auto size = static_cast<size_t>(state.range(0));
+  auto threads = static_cast<size_t>(state.range(1));
+  auto &pooled = pooledProvider(threads);
+  auto &aggregated = proof(size);
+  std::vector<XmssVerifyItem> items(
+      threads,
+      XmssVerifyItem{
+          .public_keys = std::span{committee(size).public_keys}.first(size),
+          .epoch = kEpoch,
+          .message = kMessage,
+          .aggregated_signature = aggregated,
+      });
+  for (auto _ : state) {
+    auto valid = pooled.verifyBatch(items);
+    benchmark::DoNotOptimize(valid);
+  }
+  state.SetItemsProcessed(state.iterations() * threads);
+  state.counters["shadow_xmss_verify_aggregated_signatures_rate"] =
+      benchmark::Counter(static_cast<double>(size * threads),
+                         benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_XmssVerifyAggregated)
+    ->ArgNames({"committee", "threads"})
+    ->ArgsProduct({
+        benchmark::CreateRange(1, VALIDATOR_REGISTRY_LIMIT, 8),
+        benchmark::CreateRange(1, kMaxThreads, 2),
+    })
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
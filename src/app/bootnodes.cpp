@@ -14,10 +14,12 @@
 namespace lean::app {
   BootnodeInfo::BootnodeInfo(libp2p::multi::Multiaddress address,
                              libp2p::PeerId id,
-                             bool is_aggregator)
+                             bool is_aggregator,
+                             std::optional<uint64_t> attnets)
       : address{std::move(address)},
         peer_id{std::move(id)},
-        is_aggregator{is_aggregator} {}
+        is_aggregator{is_aggregator},
+        attnets{attnets} {}
 
   Bootnodes::Bootnodes(std::vector<BootnodeInfo> nodes)
       : nodes_(std::move(nodes)) {}
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -21,10 +22,13 @@ namespace lean::app {
     libp2p::multi::Multiaddress address;
     libp2p::PeerId peer_id;
     bool is_aggregator;
+    /// Attestation subnets advertised by ENR
+    std::optional<uint64_t> attnets;
 
     BootnodeInfo(libp2p::multi::Multiaddress address,
                  libp2p::PeerId id,
-                 bool is_aggregator);
+                 bool is_aggregator,
+                 std::optional<uint64_t> attnets = std::nullopt);
   };
 
   /**
@@ -16,6 +16,28 @@ namespace lean::app {
         database_{
             .directory = "db",
             .cache_size = 1 << 30,
+            .state_retention = 1024,
+            .state_archive_interval = 1024,
+            .state_cache_size = size_t{512} << 20,
+            .state_warm_cache_size = size_t{128} << 20,
+            .state_prefetch = true,
+            .default_space = {},
+            .spaces =
+                {
+                    // slot-keyed, read by exact slot key
+                    {"lookup_key",
+                     {.block_size_kib = 16, .prefix_length = 8}},
+                    // small random point reads
+                    {"header",
+                     {.block_size_kib = 4,
+                      .compression = DatabaseConfig::Compression::None}},
+                    // large values written once
+                    {"state",
+                     {.block_size_kib = 64,
+                      .compression = DatabaseConfig::Compression::Zstd,
+                      .blob_files = true,
+                      .min_blob_size = 4096}},
+                },
         },
         metrics_{
             .endpoint{boost::asio::ip::make_address("127.0.0.1"), 9668},
@@ -43,8 +65,8 @@ namespace lean::app {
     return bootnodes_file_;
   }
 
-  const std::optional<std::string> &Configuration::stateSyncUrl() const {
-    return state_sync_url_;
+  const std::vector<std::string> &Configuration::stateSyncUrls() const {
+    return state_sync_urls_;
   }
 
   const std::filesystem::path &Configuration::genesisDir() const {
@@ -64,6 +86,10 @@ namespace lean::app {
     return max_bootnodes_;
   }
 
+  size_t Configuration::workerThreads() const {
+    return worker_threads_;
+  }
+
   bool Configuration::cliIsAggregator() const {
     return cli_is_aggregator_;
   }
@@ -72,6 +98,62 @@ namespace lean::app {
     return cli_subnet_count_;
   }
 
+  const std::vector<uint64_t> &Configuration::cliAggregateSubnets() const {
+    return cli_aggregate_subnets_;
+  }
+
+  const std::optional<std::filesystem::path> &Configuration::recordChain()
+      const {
+    return record_chain_;
+  }
+
+  const std::optional<std::filesystem::path> &Configuration::replayChain()
+      const {
+    return replay_chain_;
+  }
+
+  const std::optional<std::filesystem::path> &Configuration::replayDb() const {
+    return replay_db_;
+  }
+
+  const std::optional<std::filesystem::path> &Configuration::apiReplicaDb()
+      const {
+    return api_replica_db_;
+  }
+
+  bool Configuration::validatorClient() const {
+    return validator_client_;
+  }
+
+  const Configuration::ReplaySlots &Configuration::replaySlots() const {
+    return replay_slots_;
+  }
+
+  bool Configuration::replaySignatures() const {
+    return replay_signatures_;
+  }
+
+  const std::filesystem::path &Configuration::traceFile() const {
+    return trace_file_;
+  }
+
+  bool Configuration::traceAtStart() const {
+    return trace_at_start_;
+  }
+
+  size_t Configuration::flightRecorderEvents() const {
+    return flight_recorder_events_;
+  }
+
+  std::chrono::seconds Configuration::heapPurgeInterval() const {
+    return heap_purge_interval_;
+  }
+
+  const std::optional<std::filesystem::path> &Configuration::xmssAccelerator()
+      const {
+    return xmss_accelerator_;
+  }
+
   double Configuration::fakeXmssAggregateSignaturesRate() const {
     ASSERT_QLEAN_ENABLE_SHADOW();
     return fake_xmss_aggregate_signatures_rate_;
@@ -82,6 +164,11 @@ namespace lean::app {
     return fake_xmss_verify_aggregated_signatures_rate_;
   }
 
+  size_t Configuration::fakeXmssThreads() const {
+    ASSERT_QLEAN_ENABLE_SHADOW();
+    return fake_xmss_threads_;
+  }
+
   const Configuration::DatabaseConfig &Configuration::database() const {
     return database_;
   }
@@ -93,4 +180,29 @@ namespace lean::app {
   const Configuration::Endpoint &Configuration::apiEndpoint() const {
     return api_endpoint_;
   }
+
+  const Configuration::ApiConfig &Configuration::api() const {
+    return api_;
+  }
+
+  const ThreadPlacements &Configuration::threads() const {
+    return threads_;
+  }
+
+  const Configuration::WatchdogConfig &Configuration::watchdog() const {
+    return watchdog_;
+  }
+
+  const Configuration::NetworkConfig &Configuration::network() const {
+    return network_;
+  }
+
+  const Configuration::ValidatorKeysConfig &Configuration::validatorKeys()
+      const {
+    return validator_keys_;
+  }
+
+  const Configuration::FollowerConfig &Configuration::follower() const {
+    return follower_;
+  }
 }  // namespace lean::app
@@ -6,9 +6,14 @@
 
 #pragma once
 
+#include <chrono>
 #include <filesystem>
+#include <map>
 #include <optional>
+#include <set>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <boost/asio/ip/tcp.hpp>
 #include <libp2p/crypto/key.hpp>
@@ -17,6 +22,7 @@
 
 #include "app/validator_keys_manifest.hpp"
 #include "crypto/xmss/xmss_provider.hpp"
+#include "utils/thread_placement.hpp"
 
 namespace lean::app {
   class Configuration : Singleton<Configuration> {
@@ -24,13 +30,133 @@ namespace lean::app {
     using Endpoint = boost::asio::ip::tcp::endpoint;
 
     struct DatabaseConfig {
+      enum class Compression : uint8_t {
+        None,
+        Lz4,
+        Zstd,
+      };
+
+      /// Column family tuning, by space access pattern
+      struct SpaceProfile {
+        /// Bloom filter bits per key, 0 disables filter
+        uint32_t bloom_bits_per_key = 10;
+        uint32_t block_size_kib = 32;
+        Compression compression = Compression::Lz4;
+        /// Store values not less than `min_blob_size` in blob files
+        bool blob_files = false;
+        uint64_t min_blob_size = 0;
+        /// Fixed key prefix length for prefix bloom, 0 disables extractor
+        size_t prefix_length = 0;
+      };
+
       std::filesystem::path directory = "db";
       size_t cache_size = 1 << 30;  // 1GiB
+      /// Slots behind last finalized to keep finalized states for, 0 keeps all
+      uint64_t state_retention = 1024;
+      /// Slots between finalized states kept as snapshots by state pruning,
+      /// to regenerate removed states from, 0 keeps none
+      uint64_t state_archive_interval = 1024;
+      /// Memory budget of fork choice post-state cache
+      size_t state_cache_size = size_t{512} << 20;  // 512MiB
+      /// Memory budget of compressed states evicted from state cache,
+      /// 0 disables
+      size_t state_warm_cache_size = size_t{128} << 20;  // 128MiB
+      /// Load states needed by blocks waiting for missing parent in advance
+      bool state_prefetch = true;
+      /// Move finalized canonical blocks from database to append-only files
+      /// indexed by slot, in `ancient` subdirectory
+      bool ancient_store = false;
+      /// Store block bodies and signatures snappy compressed, as on wire
+      bool compress_blocks = false;
+      /// Collect RocksDB statistics and sample operations with perf context
+      /// for metrics
+      bool statistics = false;
+      /// Flush and compaction I/O limit in bytes per second during latency
+      /// critical intervals 0-2 of slot, 0 doesn't throttle
+      size_t critical_io_rate = size_t{16} << 20;  // 16MiB/s
+      /// Open `directory` of other process read-only, as RocksDB secondary
+      /// instance keeping its own files here, see `RocksDb::catchUp`
+      std::optional<std::filesystem::path> secondary_directory;
+      /// Keep database in memory instead of RocksDB
+      bool in_memory = false;
+      /// Map behind in-memory database
+      enum class MemoryBackend : uint8_t {
+        /// Hash tables, shareable between node threads
+        Hashed,
+        /// Ordered maps, for chain replay only
+        Ordered,
+      };
+      MemoryBackend in_memory_backend = MemoryBackend::Hashed;
+      /// Profile of spaces not listed in `spaces`
+      SpaceProfile default_space;
+      /// Profiles by space (column family) name
+      std::map<std::string, SpaceProfile, std::less<>> spaces;
+
+      const SpaceProfile &profile(std::string_view space_name) const {
+        auto it = spaces.find(space_name);
+        return it != spaces.end() ? it->second : default_space;
+      }
     };
 
     struct MetricsConfig {
       Endpoint endpoint;
       std::optional<bool> enabled;
+      /// Bucket boundaries of histograms by name, instead of defined ones
+      std::map<std::string, std::vector<double>> buckets;
+      /// Names of metrics not exported, e.g. high cardinality labelled ones
+      std::set<std::string> drop;
+      /// Scrapes within this time since previous one get its text, so
+      /// several scrapers don't multiply serialization, zero disables
+      std::chrono::milliseconds cache_ttl{1000};
+    };
+
+    struct ApiConfig {
+      /// Threads serving http api, metrics are served by own thread
+      size_t threads = 2;
+      /// Connections served at once, more are refused
+      size_t max_connections = 256;
+      /// Parallel downloads of finalized state, for checkpoint sync
+      size_t max_state_downloads = 16;
+    };
+
+    struct WatchdogConfig {
+      /// Period of event loop lag probes
+      std::chrono::milliseconds probe_interval{50};
+      /// Lag after which stack of stalled thread is logged, zero disables
+      std::chrono::milliseconds stall_threshold{500};
+    };
+
+    struct NetworkConfig {
+      /// Upload bytes per second of gossip and served blocks, 0 is unlimited
+      uint64_t upload_rate = 0;
+      /// Bytes per second of blocks served to single peer, 0 is unlimited
+      uint64_t peer_serve_rate = 0;
+      /// Bytes per second of history fetched after checkpoint sync, 0 is
+      /// unlimited
+      uint64_t backfill_rate = 1 << 20;
+      /// Send own attestations to aggregators of their subnet directly too
+      bool direct_attestations = false;
+    };
+
+    struct ValidatorKeysConfig {
+      /// Load private key on first use instead of at startup
+      bool lazy = false;
+      /// Prebuilt keystore, see `XmssKeystore`, used instead of key files
+      std::optional<std::filesystem::path> keystore;
+    };
+
+    /// Optimistic following by node without validators, see `--follower`
+    struct FollowerConfig {
+      bool enabled = false;
+      /// Fraction of block aggregated proofs verified
+      double sample_rate = 0.1;
+    };
+
+    /// Slots of blocks replayed from `--replay-db`
+    struct ReplaySlots {
+      uint64_t from = 0;
+      /// Last stored slot if not set
+      std::optional<uint64_t> to;
     };
 
     Configuration();
@@ -44,23 +170,68 @@ namespace lean::app {
     [[nodiscard]] virtual const std::string &nodeId() const;
     [[nodiscard]] virtual const std::filesystem::path &basePath() const;
     [[nodiscard]] virtual const std::filesystem::path &bootnodesFile() const;
-    [[nodiscard]] virtual const std::optional<std::string> &stateSyncUrl()
+    /// Checkpoint-sync sources, state agreed by their majority is used
+    [[nodiscard]] virtual const std::vector<std::string> &stateSyncUrls()
         const;
     [[nodiscard]] virtual const std::filesystem::path &genesisDir() const;
     [[nodiscard]] virtual const std::optional<libp2p::Multiaddress> &
     listenMultiaddr() const;
     [[nodiscard]] virtual const libp2p::crypto::KeyPair &nodeKey() const;
     [[nodiscard]] virtual const std::optional<size_t> &maxBootnodes() const;
+    /// Shared worker pool size, 0 means number of CPUs
+    [[nodiscard]] virtual size_t workerThreads() const;
     [[nodiscard]] virtual bool cliIsAggregator() const;
     [[nodiscard]] virtual uint64_t cliSubnetCount() const;
+    /// Extra attestation subnets aggregated while node is aggregator
+    [[nodiscard]] virtual const std::vector<uint64_t> &cliAggregateSubnets()
+        const;
+    /// File to record fork choice inputs into, see `ChainRecorder`
+    [[nodiscard]] virtual const std::optional<std::filesystem::path> &
+    recordChain() const;
+    /// Recording to replay instead of running node, see `ChainReplay`
+    [[nodiscard]] virtual const std::optional<std::filesystem::path> &
+    replayChain() const;
+    /// Database of node to replay stored blocks of, see `ChainReplay`
+    [[nodiscard]] virtual const std::optional<std::filesystem::path> &
+    replayDb() const;
+    [[nodiscard]] virtual const ReplaySlots &replaySlots() const;
+    /// Database of node to serve read-only api from, see `ApiReplica`
+    [[nodiscard]] virtual const std::optional<std::filesystem::path> &
+    apiReplicaDb() const;
+    /// Run as validator process of node at api endpoint, see `ValidatorClient`
+    [[nodiscard]] virtual bool validatorClient() const;
+    /// Verify block signatures while replaying, they are skipped otherwise
+    [[nodiscard]] virtual bool replaySignatures() const;
+    /// Trace file of `log::startTracing`, `<base_path>/trace.json` by default
+    [[nodiscard]] virtual const std::filesystem::path &traceFile() const;
+    /// Start tracing on node start, otherwise it is enabled by API
+    [[nodiscard]] virtual bool traceAtStart() const;
+    /// Events kept per thread by `log::startFlightRecorder`, 0 disables
+    [[nodiscard]] virtual size_t flightRecorderEvents() const;
+    /// Free heap memory is returned to OS this often, 0 disables
+    [[nodiscard]] virtual std::chrono::seconds heapPurgeInterval() const;
+    /// Plugin library offloading aggregation and aggregated verification,
+    /// see `XmssProviderAccelerated`
+    [[nodiscard]] virtual const std::optional<std::filesystem::path> &
+    xmssAccelerator() const;
 
     [[nodiscard]] virtual double fakeXmssAggregateSignaturesRate() const;
     [[nodiscard]] virtual double fakeXmssVerifyAggregatedSignaturesRate() const;
+    /// Parallel crypto jobs simulated by fake xmss provider, 0 is worker
+    /// threads
+    [[nodiscard]] virtual size_t fakeXmssThreads() const;
 
     [[nodiscard]] virtual const DatabaseConfig &database() const;
 
     [[nodiscard]] virtual const MetricsConfig &metrics() const;
     [[nodiscard]] virtual const Endpoint &apiEndpoint() const;
+    [[nodiscard]] virtual const ApiConfig &api() const;
+    /// CPU placement by thread class, e.g. `io`, `pool`, `rocksdb`
+    [[nodiscard]] virtual const ThreadPlacements &threads() const;
+    [[nodiscard]] virtual const WatchdogConfig &watchdog() const;
+    [[nodiscard]] virtual const NetworkConfig &network() const;
+    [[nodiscard]] virtual const ValidatorKeysConfig &validatorKeys() const;
+    [[nodiscard]] virtual const FollowerConfig &follower() const;
 
    private:
     friend class Configurator;  // for external configure
@@ -74,17 +245,38 @@ namespace lean::app {
     std::optional<libp2p::Multiaddress> listen_multiaddr_;
     std::optional<libp2p::crypto::KeyPair> node_key_;
     std::optional<size_t> max_bootnodes_;
-    std::optional<std::string> state_sync_url_;
+    size_t worker_threads_ = 0;
+    std::vector<std::string> state_sync_urls_;
 
     bool cli_is_aggregator_ = false;
     uint64_t cli_subnet_count_ = 1;
+    std::vector<uint64_t> cli_aggregate_subnets_;
+    std::optional<std::filesystem::path> record_chain_;
+    std::optional<std::filesystem::path> replay_chain_;
+    std::optional<std::filesystem::path> replay_db_;
+    ReplaySlots replay_slots_;
+    std::optional<std::filesystem::path> api_replica_db_;
+    bool validator_client_ = false;
+    bool replay_signatures_ = true;
+    std::filesystem::path trace_file_;
+    bool trace_at_start_ = false;
+    size_t flight_recorder_events_ = 4096;
+    std::chrono::seconds heap_purge_interval_{0};
+    std::optional<std::filesystem::path> xmss_accelerator_;
 
     double fake_xmss_aggregate_signatures_rate_ = 22.704;
     double fake_xmss_verify_aggregated_signatures_rate_ = 3463.106;
+    size_t fake_xmss_threads_ = 0;
 
     DatabaseConfig database_;
     MetricsConfig metrics_;
     Endpoint api_endpoint_;
+    ApiConfig api_;
+    ThreadPlacements threads_;
+    WatchdogConfig watchdog_;
+    NetworkConfig network_;
+    ValidatorKeysConfig validator_keys_;
+    FollowerConfig follower_;
   };
 
 }  // namespace lean::app
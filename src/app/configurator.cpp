@@ -12,6 +12,7 @@
 #include <filesystem>
 #include <iostream>
 #include <optional>
+#include <ranges>
 #include <string>
 #include <string_view>
 
@@ -21,6 +22,7 @@
 #include <boost/program_options.hpp>
 #include <boost/program_options/value_semantic.hpp>
 #include <fmt/format.h>
+#include <fmt/ranges.h>
 #include <qtils/outcome.hpp>
 #include <qtils/shared_ref.hpp>
 
@@ -32,8 +34,10 @@
 #include "crypto/xmss/xmss_util.hpp"
 #include "executable/qlean_enable_shadow.hpp"
 #include "log/formatters/filepath.hpp"
+#include "metrics/histogram_buckets.hpp"
 #include "modules/networking/get_node_key.hpp"
 #include "utils/parsers.hpp"
+#include "utils/thread_placement.hpp"
 
 OUTCOME_CPP_DEFINE_CATEGORY(lean::app, Configurator::Error, e) {
   using E = lean::app::Configurator::Error;
@@ -83,6 +87,34 @@ namespace {
     return false;
   }
 
+  /// `<from>[:<to>]` slots
+  std::optional<lean::app::Configuration::ReplaySlots> parseReplaySlots(
+      std::string_view value) {
+    auto parse = [](std::string_view part) -> std::optional<uint64_t> {
+      uint64_t slot = 0;
+      auto end = part.data() + part.size();
+      auto [ptr, ec] = std::from_chars(part.data(), end, slot);
+      if (part.empty() or ec != std::errc{} or ptr != end) {
+        return std::nullopt;
+      }
+      return slot;
+    };
+    lean::app::Configuration::ReplaySlots slots;
+    auto colon = value.find(':');
+    auto from = parse(value.substr(0, colon));
+    if (not from.has_value()) {
+      return std::nullopt;
+    }
+    slots.from = *from;
+    if (colon != std::string_view::npos) {
+      slots.to = parse(value.substr(colon + 1));
+      if (not slots.to.has_value() or *slots.to < slots.from) {
+        return std::nullopt;
+      }
+    }
+    return slots;
+  }
+
 }  // namespace
 
 namespace lean::app {
@@ -138,13 +170,36 @@ namespace lean::app {
         ("genesis-dir", po::value<std::string>(), "Quickstart genesis directory path")
         ("listen-addr", po::value<std::string>(), "Set libp2p listen multiaddress.")
         ("bootnodes", po::value<std::string>(), "Set path to yaml file containing boot node ENRs (genesis/nodes.yaml).")
-        ("checkpoint-sync-url", po::value<std::string>(),  "Optional. URL for pre-syncing the state at startup if any")
+        ("checkpoint-sync-url", po::value<std::vector<std::string>>()->composing(),  "Optional. URL for pre-syncing the state at startup if any. Repeat or separate by comma to sync from several sources")
         ("name,n", po::value<std::string>(), "Set name of node.")
         ("node-id", po::value<std::string>(), "Node id from validator registry (genesis/validators.yaml).")
         ("node-key", po::value<std::string>(), "Set secp256k1 node key as hex string (with or without 0x prefix).")
         ("is-aggregator", po::bool_switch())
         ("attestation-committee-count", po::value<uint64_t>())
+        ("aggregate-subnets", po::value<std::vector<uint64_t>>()->multitoken()->composing(), "Attestation subnets to subscribe and aggregate as aggregator, in addition to subnets of own validators.")
         ("max-bootnodes", po::value<size_t>(), "Max bootnodes count to connect to.")
+        ("worker-threads", po::value<size_t>(), "Worker pool size for signature verification and aggregation. Default: number of CPUs.")
+        ("lazy-validator-keys", po::bool_switch(), "Load validator private key on first use instead of at startup.")
+        ("validator-keystore", po::value<std::string>(), "Load validator keys from keystore built by \"key build-keystore\" instead of key files.")
+        ("record-chain", po::value<std::string>(), "Record received blocks, attestations and ticks into file, for replay with \"--replay-chain\".")
+        ("replay-chain", po::value<std::string>(), "Replay recording into fresh database as fast as possible and print import statistics, instead of running node.")
+        ("replay-db", po::value<std::string>(), "Replay blocks stored in database directory of node, re-executing state transition and fork choice, and print per-block timing, instead of running node. Same as \"replay <dir>\" subcommand.")
+        ("replay-slots", po::value<std::string>(), "Slots of \"--replay-db\" blocks: <from>[:<to>]. Default: all stored.")
+        ("replay-skip-signatures", po::bool_switch(), "Don't verify block signatures while replaying.")
+        ("api-replica-db", po::value<std::string>(), "Serve read-only api from database directory of running node, opened as RocksDB secondary instance, instead of running node. Same as \"api-replica <dir>\" subcommand.")
+        ("validator-client", po::bool_switch(), "Sign attestations of validators with keys of this process, for node serving api at \"--api-host\" and \"--api-port\", instead of running node. Validators are those of \"--node-id\", which must differ from node id of node, and they don't propose blocks.")
+        ("watchdog-stall-threshold", po::value<uint32_t>(), "Log stack of event loop thread stalled for this many milliseconds, 0 disables. Default: 500.")
+        ("upload-rate-limit", po::value<uint64_t>(), "Limit upload of gossip and served blocks to this many KiB per second, gossip goes first. 0 is unlimited. Default: 0.")
+        ("peer-serve-rate-limit", po::value<uint64_t>(), "Limit blocks served to single peer to this many KiB per second. 0 is unlimited. Default: 0.")
+        ("backfill-rate-limit", po::value<uint64_t>(), "Limit download of finalized history after checkpoint sync to this many KiB per second. 0 is unlimited. Default: 1024.")
+        ("follower", po::bool_switch(), "Follow chain optimistically, for node without validators serving api: verify proposer signatures and sample of aggregated proofs of blocks, don't import gossip aggregated attestations. Api responses are marked optimistic.")
+        ("follower-sample-rate", po::value<double>(), "Fraction of block aggregated proofs verified by \"--follower\", from 0 to 1. Default: 0.1.")
+        ("direct-attestations", po::bool_switch(), "Send own attestations directly to aggregators of their subnet, in addition to gossip.")
+        ("pin-threads", po::value<std::vector<std::string>>()->composing(), "Pin class of threads to CPUs: <class>=<cpulist>, e.g. io=0 or pool=2-7,10. Repeat for several classes. Classes: lean-node, io, http, fork_choice, pool, worker, timer, db, rocksdb, pruner, memory, watchdog, accelerator, replay.")
+        ("trace", po::value<std::string>()->implicit_value(""), "Write block import and gossip spans as Chrome trace JSON into file, \"<base_path>/trace.json\" if not specified. Tracing can be toggled at runtime with \"/lean/v0/admin/tracing\" API.")
+        ("flight-recorder-events", po::value<size_t>(), "Keep this many last hot path events of each thread in memory, dumped into \"<base_path>/flight_recorder\" on missed interval deadline and by \"/lean/v0/admin/flight_recorder\" API. 0 disables. Default: 4096.")
+        ("xmss-accelerator", po::value<std::string>(), "Offload aggregation and verification of aggregated signatures to device of this plugin library, see \"crypto/xmss/xmss_accelerator.h\". Batches of concurrent blocks and groups run as single device call, CPU is used if plugin fails or queue is full. Ignored by shadow build.")
+        ("heap-purge-interval", po::value<uint32_t>(), "Return free memory of heap allocator to OS every this many seconds, against fragmentation of long runs. Purge can be also triggered by \"/lean/v0/admin/heap\" API. 0 disables. Default: 0.")
         ("log,l", po::value<std::vector<std::string>>(),
           "Sets a custom logging filter.\n"
           "Syntax: <target>=<level>, e.g., -llibp2p=off.\n"
@@ -157,6 +212,7 @@ namespace lean::app {
       general_options.add_options()
           ("shadow-xmss-aggregate-signatures-rate", "How many signatures can be aggregated per second (fake xmss provider)")
           ("shadow-xmss-verify-aggregated-signatures-rate", "How many signatures inside aggregated signature can be verified per second (fake xmss provider)")
+          ("shadow-xmss-threads", po::value<size_t>(), "How many crypto jobs run in parallel, others queue (fake xmss provider, default: worker threads)")
           ;
     }
 
@@ -165,6 +221,17 @@ namespace lean::app {
         ("db_path", po::value<std::string>()->default_value(config_->database_.directory), "Path to DB directory. Can be relative on base path.")
         // ("db-tmp", "Use temporary storage path.")
         ("db_cache_size", po::value<uint32_t>()->default_value(config_->database_.cache_size), "Limit the memory the database cache can use <MiB>.")
+        ("db_state_retention", po::value<uint64_t>(), "Slots behind last finalized to keep finalized states for, 0 keeps all.")
+        ("db_state_archive_interval", po::value<uint64_t>(), "Slots between finalized states kept by state pruning, to regenerate removed states from by replaying blocks, 0 keeps none.")
+        ("db_state_cache_size", po::value<std::string>(), "Memory budget of fork choice state cache: 512Mb, 1G, etc.")
+        ("db_state_warm_cache_size", po::value<std::string>(), "Memory budget of compressed states evicted from state cache: 128Mb, 1G, etc. 0 disables.")
+        ("db_no_state_prefetch", "Don't load states needed by blocks waiting for parent in advance.")
+        ("db_ancient_store", "Move finalized canonical blocks from DB to append-only files indexed by slot.")
+        ("db_compress_blocks", "Store block bodies and signatures snappy compressed, as on wire.")
+        ("db_statistics", "Export RocksDB statistics and sampled operation latencies by space to metrics.")
+        ("db_critical_io_rate", po::value<std::string>(), "Flush and compaction I/O per second during intervals 0-2 of slot: 16Mb, 64Mb, etc. 0 doesn't throttle.")
+        ("db_in_memory", "Keep database in memory instead of RocksDB.")
+        ("db_in_memory_backend", po::value<std::string>(), "Map behind in-memory database: \"hashed\" (default) or \"ordered\". Ordered one only with \"--replay-chain\".")
         ;
 
     po::options_description metrics_options("Metric options");
@@ -172,8 +239,14 @@ namespace lean::app {
         ("metrics-disable", "Set to disable OpenMetrics.")
         ("metrics-host", po::value<std::string>(), "Set address for OpenMetrics over HTTP.")
         ("metrics-port", po::value<uint16_t>(), "Set port for OpenMetrics over HTTP.")
+        ("metrics-buckets", po::value<std::vector<std::string>>()->composing(), "Override buckets of histogram: <name>=<b1>,<b2>,... or <name>=exp:<start>:<factor>:<count> or <name>=lin:<start>:<width>:<count>. Repeat for several histograms.")
+        ("metrics-drop", po::value<std::vector<std::string>>()->composing(), "Don't export metric by name, e.g. high cardinality lean_connected_peers. Repeat for several metrics.")
+        ("metrics-cache-ttl", po::value<uint32_t>(), "Serve scrapes within this many milliseconds of previous one with its text, 0 disables. Default: 1000.")
         ("api-host", po::value<std::string>(), "Set address for OpenMetrics over HTTP.")
         ("api-port", po::value<uint16_t>(), "Set port for OpenMetrics over HTTP.")
+        ("api-threads", po::value<size_t>(), "Threads serving HTTP API and OpenMetrics. Default: 2.")
+        ("api-max-connections", po::value<size_t>(), "Max HTTP API connections served at once, more are refused. Default: 256.")
+        ("api-max-state-downloads", po::value<size_t>(), "Max parallel downloads of finalized state for checkpoint sync. Default: 16.")
         ;
 
     // clang-format on
@@ -300,6 +373,9 @@ namespace lean::app {
     OUTCOME_TRY(initGeneralConfig());
     OUTCOME_TRY(initDatabaseConfig());
     OUTCOME_TRY(initOpenMetricsConfig());
+    OUTCOME_TRY(initWatchdogConfig());
+    OUTCOME_TRY(initNetworkConfig());
+    OUTCOME_TRY(initThreadsConfig());
 
     return config_;
   }
@@ -438,6 +514,17 @@ namespace lean::app {
             find_argument<size_t>(cli_values_map_, "max-bootnodes")) {
       config_->max_bootnodes_ = *max_bootnodes;
     }
+    if (auto worker_threads =
+            find_argument<size_t>(cli_values_map_, "worker-threads")) {
+      config_->worker_threads_ = *worker_threads;
+    }
+    if (find_argument(cli_values_map_, "lazy-validator-keys")) {
+      config_->validator_keys_.lazy = true;
+    }
+    if (auto value =
+            find_argument<std::string>(cli_values_map_, "validator-keystore")) {
+      config_->validator_keys_.keystore = *value;
+    }
     find_argument<std::string>(
         cli_values_map_, "base-path", [&](const std::string &value) {
           config_->base_path_ = value;
@@ -470,13 +557,100 @@ namespace lean::app {
       config_->bootnodes_file_ = config_->genesis_dir_ / "nodes.yaml";
     }
 
-    find_argument<std::string>(
-        cli_values_map_, "checkpoint-sync-url", [&](const std::string &value) {
-          config_->state_sync_url_.emplace(value);
+    find_argument<std::vector<std::string>>(
+        cli_values_map_,
+        "checkpoint-sync-url",
+        [&](const std::vector<std::string> &values) {
+          for (auto &value : values) {
+            for (auto &&url : std::views::split(value, ',')) {
+              if (not url.empty()) {
+                config_->state_sync_urls_.emplace_back(std::string_view{url});
+              }
+            }
+          }
         });
     if (find_argument(cli_values_map_, "is-aggregator")) {
       config_->cli_is_aggregator_ = true;
     }
+    if (auto value =
+            find_argument<std::string>(cli_values_map_, "record-chain")) {
+      config_->record_chain_ = *value;
+    }
+    if (auto value =
+            find_argument<std::string>(cli_values_map_, "replay-chain")) {
+      config_->replay_chain_ = *value;
+    }
+    if (config_->record_chain_.has_value()
+        and config_->replay_chain_.has_value()) {
+      SL_ERROR(logger_, "'--record-chain' can't be used with '--replay-chain'");
+      return Error::CliArgsParseFailed;
+    }
+    if (auto value = find_argument<std::string>(cli_values_map_, "replay-db")) {
+      config_->replay_db_ = *value;
+    }
+    if (config_->replay_db_.has_value()
+        and (config_->record_chain_.has_value()
+             or config_->replay_chain_.has_value())) {
+      SL_ERROR(logger_,
+               "'--replay-db' can't be used with '--record-chain' "
+               "or '--replay-chain'");
+      return Error::CliArgsParseFailed;
+    }
+    if (auto value =
+            find_argument<std::string>(cli_values_map_, "replay-slots")) {
+      auto slots = parseReplaySlots(*value);
+      if (not slots.has_value()) {
+        SL_ERROR(logger_,
+                 "Bad '--replay-slots' value '{}'; Expected: <from>[:<to>]",
+                 *value);
+        return Error::CliArgsParseFailed;
+      }
+      config_->replay_slots_ = *slots;
+    }
+    if (find_argument(cli_values_map_, "replay-skip-signatures")) {
+      config_->replay_signatures_ = false;
+    }
+    if (auto value =
+            find_argument<std::string>(cli_values_map_, "api-replica-db")) {
+      config_->api_replica_db_ = *value;
+    }
+    if (find_argument(cli_values_map_, "validator-client")) {
+      config_->validator_client_ = true;
+    }
+    if (config_->validator_client_
+        and (config_->api_replica_db_.has_value()
+             or config_->replay_chain_.has_value()
+             or config_->replay_db_.has_value())) {
+      SL_ERROR(logger_,
+               "'--validator-client' can't be used with '--api-replica-db', "
+               "'--replay-chain' or '--replay-db'");
+      return Error::CliArgsParseFailed;
+    }
+    if (config_->api_replica_db_.has_value()
+        and (config_->record_chain_.has_value()
+             or config_->replay_chain_.has_value()
+             or config_->replay_db_.has_value())) {
+      SL_ERROR(logger_,
+               "'--api-replica-db' can't be used with '--record-chain', "
+               "'--replay-chain' or '--replay-db'");
+      return Error::CliArgsParseFailed;
+    }
+    if (auto value = find_argument<std::string>(cli_values_map_, "trace")) {
+      config_->trace_file_ = *value;
+      config_->trace_at_start_ = true;
+    }
+    if (auto value =
+            find_argument<size_t>(cli_values_map_, "flight-recorder-events")) {
+      config_->flight_recorder_events_ = *value;
+    }
+    if (auto value =
+            find_argument<uint32_t>(cli_values_map_, "heap-purge-interval")) {
+      config_->heap_purge_interval_ = std::chrono::seconds{*value};
+    }
+    if (auto value =
+            find_argument<std::string>(cli_values_map_, "xmss-accelerator")) {
+      config_->xmss_accelerator_ = *value;
+    }
     if (auto value = find_argument<uint64_t>(cli_values_map_,
                                              "attestation-committee-count")) {
       if (*value == 0) {
@@ -485,6 +659,39 @@ namespace lean::app {
       }
       config_->cli_subnet_count_ = *value;
     }
+    if (auto value = find_argument<std::vector<uint64_t>>(
+            cli_values_map_, "aggregate-subnets")) {
+      for (auto subnet : *value) {
+        if (subnet >= config_->cli_subnet_count_) {
+          SL_ERROR(logger_,
+                   "--aggregate-subnets {} must be less than "
+                   "--attestation-committee-count {}",
+                   subnet,
+                   config_->cli_subnet_count_);
+          return Error::CliArgsParseFailed;
+        }
+      }
+      config_->cli_aggregate_subnets_ = *value;
+    }
+    if (find_argument(cli_values_map_, "follower")) {
+      config_->follower_.enabled = true;
+    }
+    if (auto value =
+            find_argument<double>(cli_values_map_, "follower-sample-rate")) {
+      if (not(*value >= 0 and *value <= 1)) {
+        SL_ERROR(logger_, "--follower-sample-rate must be from 0 to 1");
+        return Error::CliArgsParseFailed;
+      }
+      config_->follower_.sample_rate = *value;
+    }
+    if (config_->follower_.enabled
+        and (config_->cli_is_aggregator_ or config_->validator_client_
+             or not config_->cli_aggregate_subnets_.empty())) {
+      SL_ERROR(logger_,
+               "'--follower' can't be used with '--is-aggregator', "
+               "'--validator-client' or '--aggregate-subnets'");
+      return Error::CliArgsParseFailed;
+    }
     if (fail) {
       return Error::CliArgsParseFailed;
     }
@@ -556,6 +763,9 @@ namespace lean::app {
       return Error::InvalidValue;
     }
 
+    if (config_->trace_file_.empty()) {
+      config_->trace_file_ = config_->base_path_ / "trace.json";
+    }
 
     // Helper to resolve general paths: if provided via CLI -> relative to CWD,
     // else if provided via config file -> relative to config file dir,
@@ -601,12 +811,60 @@ namespace lean::app {
               "shadow-xmss-verify-aggregated-signatures-rate")) {
         config_->fake_xmss_verify_aggregated_signatures_rate_ = value.value();
       }
+      if (auto value =
+              find_argument<size_t>(cli_values_map_, "shadow-xmss-threads")) {
+        config_->fake_xmss_threads_ = value.value();
+      }
     }
 
     return outcome::success();
   }
 
   outcome::result<void> Configurator::initDatabaseConfig() {
+    auto init_space_profile =
+        [&](const std::string &name,
+            const YAML::Node &node,
+            Configuration::DatabaseConfig::SpaceProfile &profile) {
+          using Compression = Configuration::DatabaseConfig::Compression;
+          if (not node.IsMap()) {
+            file_errors_ << "E: Value 'database.spaces." << name
+                         << "' must be map\n";
+            file_has_error_ = true;
+            return;
+          }
+          auto scalar = [&](const char *key, auto &value) {
+            auto field = node[key];
+            if (not field.IsDefined()) {
+              return;
+            }
+            try {
+              value = field.as<std::remove_reference_t<decltype(value)>>();
+            } catch (const YAML::Exception &) {
+              file_errors_ << "E: Bad value of 'database.spaces." << name
+                           << "." << key << "'\n";
+              file_has_error_ = true;
+            }
+          };
+          scalar("bloom_bits_per_key", profile.bloom_bits_per_key);
+          scalar("block_size_kib", profile.block_size_kib);
+          scalar("blob_files", profile.blob_files);
+          scalar("min_blob_size", profile.min_blob_size);
+          scalar("prefix_length", profile.prefix_length);
+          std::string compression;
+          scalar("compression", compression);
+          if (compression == "none") {
+            profile.compression = Compression::None;
+          } else if (compression == "lz4") {
+            profile.compression = Compression::Lz4;
+          } else if (compression == "zstd") {
+            profile.compression = Compression::Zstd;
+          } else if (not compression.empty()) {
+            file_errors_ << "E: Bad value of 'database.spaces." << name
+                         << ".compression'; Expected: none, lz4, zstd\n";
+            file_has_error_ = true;
+          }
+        };
+
     // Init by config-file
     if (config_file_.has_value()) {
       auto section = (*config_file_)["database"];
@@ -637,6 +895,138 @@ namespace lean::app {
               file_has_error_ = true;
             }
           }
+          auto state_retention = section["state_retention"];
+          if (state_retention.IsDefined()) {
+            if (state_retention.IsScalar()) {
+              config_->database_.state_retention =
+                  state_retention.as<uint64_t>();
+            } else {
+              file_errors_
+                  << "E: Value 'database.state_retention' must be scalar\n";
+              file_has_error_ = true;
+            }
+          }
+          auto state_archive_interval = section["state_archive_interval"];
+          if (state_archive_interval.IsDefined()) {
+            if (state_archive_interval.IsScalar()) {
+              config_->database_.state_archive_interval =
+                  state_archive_interval.as<uint64_t>();
+            } else {
+              file_errors_ << "E: Value 'database.state_archive_interval' "
+                              "must be scalar\n";
+              file_has_error_ = true;
+            }
+          }
+          auto state_cache_size = section["state_cache_size"];
+          if (state_cache_size.IsDefined()) {
+            if (state_cache_size.IsScalar()) {
+              auto value =
+                  util::parseByteQuantity(state_cache_size.as<std::string>());
+              if (value.has_value()) {
+                config_->database_.state_cache_size = value.value();
+              } else {
+                file_errors_ << "E: Bad 'state_cache_size' value; "
+                                "Expected: 4096, 512Mb, 1G, etc.\n";
+                file_has_error_ = true;
+              }
+            } else {
+              file_errors_
+                  << "E: Value 'database.state_cache_size' must be scalar\n";
+              file_has_error_ = true;
+            }
+          }
+          auto state_warm_cache_size = section["state_warm_cache_size"];
+          if (state_warm_cache_size.IsDefined()) {
+            if (state_warm_cache_size.IsScalar()) {
+              auto value = util::parseByteQuantity(
+                  state_warm_cache_size.as<std::string>());
+              if (value.has_value()) {
+                config_->database_.state_warm_cache_size = value.value();
+              } else {
+                file_errors_ << "E: Bad 'state_warm_cache_size' value; "
+                                "Expected: 0, 128Mb, 1G, etc.\n";
+                file_has_error_ = true;
+              }
+            } else {
+              file_errors_ << "E: Value 'database.state_warm_cache_size' "
+                              "must be scalar\n";
+              file_has_error_ = true;
+            }
+          }
+          auto state_prefetch = section["state_prefetch"];
+          if (state_prefetch.IsDefined()) {
+            try {
+              config_->database_.state_prefetch = state_prefetch.as<bool>();
+            } catch (const YAML::Exception &) {
+              file_errors_ << "E: Value 'database.state_prefetch' must be "
+                              "'true' or 'false'\n";
+              file_has_error_ = true;
+            }
+          }
+          auto ancient_store = section["ancient_store"];
+          if (ancient_store.IsDefined()) {
+            try {
+              config_->database_.ancient_store = ancient_store.as<bool>();
+            } catch (const YAML::Exception &) {
+              file_errors_ << "E: Value 'database.ancient_store' must be "
+                              "'true' or 'false'\n";
+              file_has_error_ = true;
+            }
+          }
+          auto compress_blocks = section["compress_blocks"];
+          if (compress_blocks.IsDefined()) {
+            try {
+              config_->database_.compress_blocks = compress_blocks.as<bool>();
+            } catch (const YAML::Exception &) {
+              file_errors_ << "E: Value 'database.compress_blocks' must be "
+                              "'true' or 'false'\n";
+              file_has_error_ = true;
+            }
+          }
+          auto statistics = section["statistics"];
+          if (statistics.IsDefined()) {
+            try {
+              config_->database_.statistics = statistics.as<bool>();
+            } catch (const YAML::Exception &) {
+              file_errors_ << "E: Value 'database.statistics' must be "
+                              "'true' or 'false'\n";
+              file_has_error_ = true;
+            }
+          }
+          auto critical_io_rate = section["critical_io_rate"];
+          if (critical_io_rate.IsDefined()) {
+            if (critical_io_rate.IsScalar()) {
+              auto value =
+                  util::parseByteQuantity(critical_io_rate.as<std::string>());
+              if (value.has_value()) {
+                config_->database_.critical_io_rate = value.value();
+              } else {
+                file_errors_ << "E: Bad 'critical_io_rate' value; "
+                                "Expected: 0, 16Mb, 64Mb, etc.\n";
+                file_has_error_ = true;
+              }
+            } else {
+              file_errors_
+                  << "E: Value 'database.critical_io_rate' must be scalar\n";
+              file_has_error_ = true;
+            }
+          }
+          auto spaces = section["spaces"];
+          if (spaces.IsDefined()) {
+            if (spaces.IsMap()) {
+              for (const auto &it : spaces) {
+                auto name = it.first.as<std::string>();
+                auto &profile =
+                    config_->database_.spaces
+                        .try_emplace(name, config_->database_.profile(name))
+                        .first->second;
+                init_space_profile(name, it.second, profile);
+              }
+            } else {
+              file_errors_ << "E: Value 'database.spaces' must be map\n";
+              file_has_error_ = true;
+            }
+          }
         } else {
           file_errors_ << "E: Section 'database' defined, but is not map\n";
           file_has_error_ = true;
@@ -671,6 +1061,91 @@ namespace lean::app {
         cli_values_map_, "db_cache_size", [&](const uint32_t &value) {
           config_->database_.cache_size = value;
         });
+    find_argument<uint64_t>(
+        cli_values_map_, "db_state_retention", [&](const uint64_t &value) {
+          config_->database_.state_retention = value;
+        });
+    find_argument<uint64_t>(
+        cli_values_map_,
+        "db_state_archive_interval",
+        [&](const uint64_t &value) {
+          config_->database_.state_archive_interval = value;
+        });
+    find_argument<std::string>(
+        cli_values_map_, "db_state_cache_size", [&](const std::string &value) {
+          if (auto size = util::parseByteQuantity(value)) {
+            config_->database_.state_cache_size = size.value();
+          } else {
+            SL_ERROR(logger_,
+                     "Bad 'db_state_cache_size' value; "
+                     "Expected: 4096, 512Mb, 1G, etc.");
+            fail = true;
+          }
+        });
+    find_argument<std::string>(
+        cli_values_map_,
+        "db_state_warm_cache_size",
+        [&](const std::string &value) {
+          if (auto size = util::parseByteQuantity(value)) {
+            config_->database_.state_warm_cache_size = size.value();
+          } else {
+            SL_ERROR(logger_,
+                     "Bad 'db_state_warm_cache_size' value; "
+                     "Expected: 0, 128Mb, 1G, etc.");
+            fail = true;
+          }
+        });
+    if (find_argument(cli_values_map_, "db_no_state_prefetch")) {
+      config_->database_.state_prefetch = false;
+    }
+    if (find_argument(cli_values_map_, "db_ancient_store")) {
+      config_->database_.ancient_store = true;
+    }
+    if (find_argument(cli_values_map_, "db_compress_blocks")) {
+      config_->database_.compress_blocks = true;
+    }
+    if (find_argument(cli_values_map_, "db_statistics")) {
+      config_->database_.statistics = true;
+    }
+    find_argument<std::string>(
+        cli_values_map_, "db_critical_io_rate", [&](const std::string &value) {
+          if (auto rate = util::parseByteQuantity(value)) {
+            config_->database_.critical_io_rate = rate.value();
+          } else {
+            SL_ERROR(logger_,
+                     "Bad 'db_critical_io_rate' value; "
+                     "Expected: 0, 16Mb, 64Mb, etc.");
+            fail = true;
+          }
+        });
+    using MemoryBackend = Configuration::DatabaseConfig::MemoryBackend;
+    find_argument<std::string>(
+        cli_values_map_,
+        "db_in_memory_backend",
+        [&](const std::string &value) {
+          if (value == "hashed") {
+            config_->database_.in_memory_backend = MemoryBackend::Hashed;
+          } else if (value == "ordered") {
+            config_->database_.in_memory_backend = MemoryBackend::Ordered;
+          } else {
+            SL_ERROR(logger_,
+                     "Bad 'db_in_memory_backend' value; "
+                     "Expected: hashed, ordered");
+            fail = true;
+          }
+        });
+    if (find_argument(cli_values_map_, "db_in_memory")) {
+      if (config_->database_.in_memory_backend == MemoryBackend::Ordered
+          and not config_->replay_chain_.has_value()
+          and not config_->replay_db_.has_value()) {
+        // Ordered in-memory storage is not synchronized for node threads
+        SL_ERROR(logger_,
+                 "Ordered 'db_in_memory' requires '--replay-chain' "
+                 "or '--replay-db'");
+        fail = true;
+      }
+      config_->database_.in_memory = true;
+    }
     if (fail) {
       return Error::CliArgsParseFailed;
     }
@@ -683,6 +1158,28 @@ namespace lean::app {
 
     config_->database_.directory = make_absolute(config_->database_.directory);
 
+    if (auto &replay_db = config_->replay_db_; replay_db.has_value()) {
+      *replay_db = weakly_canonical(absolute(*replay_db));
+      // Replayed blocks are imported into node database
+      if (not config_->database_.in_memory
+          and *replay_db == config_->database_.directory) {
+        SL_ERROR(logger_,
+                 "'--replay-db' must differ from node database directory, "
+                 "or use 'db_in_memory'");
+        return Error::CliArgsParseFailed;
+      }
+    }
+    if (auto &replica_db = config_->api_replica_db_; replica_db.has_value()) {
+      *replica_db = weakly_canonical(absolute(*replica_db));
+      // Secondary instance files are kept in node database directory
+      if (*replica_db == config_->database_.directory) {
+        SL_ERROR(logger_,
+                 "'--api-replica-db' must differ from database directory "
+                 "of replica");
+        return Error::CliArgsParseFailed;
+      }
+    }
+
     return outcome::success();
   }
 
@@ -757,6 +1254,57 @@ namespace lean::app {
             }
           }
 
+          auto buckets = section["buckets"];
+          if (buckets.IsDefined()) {
+            if (buckets.IsMap()) {
+              for (const auto &item : buckets) {
+                auto name = item.first.as<std::string>();
+                // List of boundaries or spec as on command line
+                auto spec = item.second.IsSequence()
+                              ? fmt::format(
+                                    "{}",
+                                    fmt::join(
+                                        item.second.as<std::vector<double>>(),
+                                        ","))
+                              : item.second.as<std::string>();
+                if (auto parsed = metrics::parseHistogramBuckets(spec)) {
+                  config_->metrics_.buckets[name] = std::move(*parsed);
+                } else {
+                  file_errors_ << "E: Value 'metrics.buckets." << name
+                               << "' has invalid buckets\n";
+                  file_has_error_ = true;
+                }
+              }
+            } else {
+              file_errors_ << "E: Value 'metrics.buckets' must be map\n";
+              file_has_error_ = true;
+            }
+          }
+
+          auto drop = section["drop"];
+          if (drop.IsDefined()) {
+            if (drop.IsSequence()) {
+              for (auto &name : drop.as<std::vector<std::string>>()) {
+                config_->metrics_.drop.emplace(std::move(name));
+              }
+            } else {
+              file_errors_ << "E: Value 'metrics.drop' must be sequence\n";
+              file_has_error_ = true;
+            }
+          }
+
+          auto cache_ttl = section["cache_ttl_ms"];
+          if (cache_ttl.IsDefined()) {
+            try {
+              config_->metrics_.cache_ttl =
+                  std::chrono::milliseconds{cache_ttl.as<uint32_t>()};
+            } catch (const YAML::Exception &) {
+              file_errors_ << "E: Value 'metrics.cache_ttl_ms' must be "
+                              "milliseconds\n";
+              file_has_error_ = true;
+            }
+          }
+
         } else {
           file_errors_ << "E: Section 'metrics' defined, but is not map\n";
           file_has_error_ = true;
@@ -778,9 +1326,47 @@ namespace lean::app {
     if (not config_->metrics_.enabled.has_value()) {
       config_->metrics_.enabled = false;
     }
+    if (auto values = find_argument<std::vector<std::string>>(
+            cli_values_map_, "metrics-buckets")) {
+      for (auto &value : *values) {
+        auto eq = value.find('=');
+        auto parsed = eq == std::string::npos
+                        ? std::nullopt
+                        : metrics::parseHistogramBuckets(
+                              std::string_view{value}.substr(eq + 1));
+        if (not parsed.has_value()) {
+          SL_ERROR(logger_,
+                   "Bad '--metrics-buckets' value '{}'; Expected: "
+                   "<name>=<b1>,<b2>,... or "
+                   "<name>=exp:<start>:<factor>:<count>",
+                   value);
+          return Error::CliArgsParseFailed;
+        }
+        config_->metrics_.buckets[value.substr(0, eq)] = std::move(*parsed);
+      }
+    }
+    if (auto values = find_argument<std::vector<std::string>>(cli_values_map_,
+                                                              "metrics-drop")) {
+      config_->metrics_.drop.insert(values->begin(), values->end());
+    }
+    if (auto cache_ttl =
+            find_argument<uint32_t>(cli_values_map_, "metrics-cache-ttl")) {
+      config_->metrics_.cache_ttl = std::chrono::milliseconds{*cache_ttl};
+    }
 
     BOOST_OUTCOME_TRY(parseEndpoint(
         config_->api_endpoint_, cli_values_map_, "api-host", "api-port"));
+    if (auto threads = find_argument<size_t>(cli_values_map_, "api-threads")) {
+      config_->api_.threads = std::max<size_t>(*threads, 1);
+    }
+    if (auto max_connections =
+            find_argument<size_t>(cli_values_map_, "api-max-connections")) {
+      config_->api_.max_connections = *max_connections;
+    }
+    if (auto max_state_downloads =
+            find_argument<size_t>(cli_values_map_, "api-max-state-downloads")) {
+      config_->api_.max_state_downloads = *max_state_downloads;
+    }
 
     if (not config_->node_key_.has_value()) {
       config_->node_key_ = randomKeyPair();
@@ -790,4 +1376,215 @@ namespace lean::app {
     return outcome::success();
   }
 
+  outcome::result<void> Configurator::initWatchdogConfig() {
+    // Init by config-file
+    if (config_file_.has_value()) {
+      auto section = (*config_file_)["watchdog"];
+      if (section.IsDefined()) {
+        if (section.IsMap()) {
+          auto read_ms = [&](const char *name,
+                             std::chrono::milliseconds &value,
+                             int64_t min) {
+            auto node = section[name];
+            if (not node.IsDefined()) {
+              return;
+            }
+            try {
+              auto ms = node.as<int64_t>();
+              if (ms >= min) {
+                value = std::chrono::milliseconds{ms};
+                return;
+              }
+            } catch (const YAML::Exception &) {
+            }
+            file_errors_ << "E: Bad value of 'watchdog." << name
+                         << "'; Expected milliseconds, at least " << min
+                         << "\n";
+            file_has_error_ = true;
+          };
+          read_ms("probe_interval_ms", config_->watchdog_.probe_interval, 1);
+          read_ms("stall_threshold_ms", config_->watchdog_.stall_threshold, 0);
+        } else {
+          file_errors_ << "E: Section 'watchdog' defined, but is not map\n";
+          file_has_error_ = true;
+        }
+      }
+    }
+
+    // Adjust by CLI arguments
+    if (auto threshold = find_argument<uint32_t>(cli_values_map_,
+                                                 "watchdog-stall-threshold")) {
+      config_->watchdog_.stall_threshold =
+          std::chrono::milliseconds{*threshold};
+    }
+
+    return outcome::success();
+  }
+
+  outcome::result<void> Configurator::initNetworkConfig() {
+    // Init by config-file
+    if (config_file_.has_value()) {
+      auto section = (*config_file_)["network"];
+      if (section.IsDefined()) {
+        if (section.IsMap()) {
+          auto read_kib = [&](const char *name, uint64_t &value) {
+            auto node = section[name];
+            if (not node.IsDefined()) {
+              return;
+            }
+            try {
+              value = node.as<uint64_t>() << 10;
+              return;
+            } catch (const YAML::Exception &) {
+            }
+            file_errors_ << "E: Bad value of 'network." << name
+                         << "'; Expected KiB per second\n";
+            file_has_error_ = true;
+          };
+          read_kib("upload_rate_kib", config_->network_.upload_rate);
+          read_kib("peer_serve_rate_kib", config_->network_.peer_serve_rate);
+          read_kib("backfill_rate_kib", config_->network_.backfill_rate);
+          if (auto node = section["direct_attestations"]; node.IsDefined()) {
+            try {
+              config_->network_.direct_attestations = node.as<bool>();
+            } catch (const YAML::Exception &) {
+              file_errors_ << "E: Value 'network.direct_attestations' must "
+                              "be boolean\n";
+              file_has_error_ = true;
+            }
+          }
+        } else {
+          file_errors_ << "E: Section 'network' defined, but is not map\n";
+          file_has_error_ = true;
+        }
+      }
+    }
+
+    // Adjust by CLI arguments
+    if (auto rate =
+            find_argument<uint64_t>(cli_values_map_, "upload-rate-limit")) {
+      config_->network_.upload_rate = *rate << 10;
+    }
+    if (auto rate =
+            find_argument<uint64_t>(cli_values_map_, "peer-serve-rate-limit")) {
+      config_->network_.peer_serve_rate = *rate << 10;
+    }
+    if (auto rate =
+            find_argument<uint64_t>(cli_values_map_, "backfill-rate-limit")) {
+      config_->network_.backfill_rate = *rate << 10;
+    }
+    if (find_argument(cli_values_map_, "direct-attestations")) {
+      config_->network_.direct_attestations = true;
+    }
+
+    return outcome::success();
+  }
+
+  outcome::result<void> Configurator::initThreadsConfig() {
+    // Init by config-file
+    if (config_file_.has_value()) {
+      auto section = (*config_file_)["threads"];
+      if (section.IsDefined()) {
+        if (section.IsMap()) {
+          for (const auto &it : section) {
+            auto name = it.first.as<std::string>();
+            auto &placement = config_->threads_[name];
+            if (not it.second.IsMap()) {
+              file_errors_ << "E: Value 'threads." << name
+                           << "' must be map\n";
+              file_has_error_ = true;
+              continue;
+            }
+            auto cpus = it.second["cpus"];
+            if (cpus.IsDefined()) {
+              auto list = cpus.IsScalar()
+                            ? parseCpuList(cpus.as<std::string>())
+                            : std::nullopt;
+              if (list.has_value()) {
+                placement.cpus = std::move(list.value());
+              } else {
+                file_errors_ << "E: Bad value of 'threads." << name
+                             << ".cpus'; Expected cpulist: 0-3,8\n";
+                file_has_error_ = true;
+              }
+            }
+            auto nice = it.second["nice"];
+            if (nice.IsDefined()) {
+              try {
+                placement.nice = nice.as<int>();
+              } catch (const YAML::Exception &) {
+                file_errors_ << "E: Bad value of 'threads." << name
+                             << ".nice'; Expected: -20..19\n";
+                file_has_error_ = true;
+              }
+            }
+            auto realtime_priority = it.second["realtime_priority"];
+            if (realtime_priority.IsDefined()) {
+              std::optional<int> value;
+              try {
+                value = realtime_priority.as<int>();
+              } catch (const YAML::Exception &) {
+              }
+              // SCHED_FIFO priority range of Linux
+              if (value.has_value() and *value >= 1 and *value <= 99) {
+                placement.realtime_priority = *value;
+              } else {
+                file_errors_ << "E: Bad value of 'threads." << name
+                             << ".realtime_priority'; Expected: 1..99\n";
+                file_has_error_ = true;
+              }
+            }
+          }
+        } else {
+          file_errors_ << "E: Section 'threads' defined, but is not map\n";
+          file_has_error_ = true;
+        }
+      }
+    }
+
+    if (file_has_error_) {
+      std::string path;
+      find_argument<std::string>(
+          cli_values_map_, "config", [&](const std::string &value) {
+            path = value;
+          });
+      SL_ERROR(logger_, "Config file `{}` has some problems:", path);
+      std::istringstream iss(file_errors_.str());
+      std::string line;
+      while (std::getline(iss, line)) {
+        SL_ERROR(logger_, "  {}", std::string_view(line).substr(3));
+      }
+      return Error::ConfigFileParseFailed;
+    }
+
+    // Adjust by CLI arguments
+    bool fail = false;
+    find_argument<std::vector<std::string>>(
+        cli_values_map_,
+        "pin-threads",
+        [&](const std::vector<std::string> &values) {
+          for (std::string_view value : values) {
+            auto eq = value.find('=');
+            auto cpus = eq != std::string_view::npos
+                          ? parseCpuList(value.substr(eq + 1))
+                          : std::nullopt;
+            if (eq == 0 or not cpus.has_value()) {
+              SL_ERROR(logger_,
+                       "Bad 'pin-threads' value '{}'; "
+                       "Expected: <class>=<cpulist>, e.g. pool=2-7",
+                       value);
+              fail = true;
+              continue;
+            }
+            config_->threads_[std::string{value.substr(0, eq)}].cpus =
+                std::move(cpus.value());
+          }
+        });
+    if (fail) {
+      return Error::CliArgsParseFailed;
+    }
+
+    return outcome::success();
+  }
+
 }  // namespace lean::app
@@ -61,6 +61,9 @@ namespace lean::app {
     outcome::result<void> initGeneralConfig();
     outcome::result<void> initDatabaseConfig();
     outcome::result<void> initOpenMetricsConfig();
+    outcome::result<void> initWatchdogConfig();
+    outcome::result<void> initNetworkConfig();
+    outcome::result<void> initThreadsConfig();
 
     int argc_;
     const char **argv_;
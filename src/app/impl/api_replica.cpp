@@ -0,0 +1,269 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "app/impl/api_replica.hpp"
+
+#include <csignal>
+#include <format>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <qtils/error_throw.hpp>
+
+#include "app/configuration.hpp"
+#include "blockchain/block_storage_error.hpp"
+#include "blockchain/impl/block_storage_impl.hpp"
+#include "blockchain/impl/block_value_codec.hpp"
+#include "crypto/hasher/hasher_impl.hpp"
+#include "serde/serialization.hpp"
+#include "storage/rocksdb/rocksdb.hpp"
+#include "types/state.hpp"
+#include "utils/http.hpp"
+#include "utils/thread_placement.hpp"
+
+namespace lean::app {
+  constexpr auto *kContentTypeJson = "application/json; charset=utf-8";
+
+  ApiReplica::ApiReplica(qtils::SharedRef<log::LoggingSystem> logsys,
+                         qtils::SharedRef<const Configuration> app_config)
+      : log_{logsys->getLogger("ApiReplica", "http")},
+        app_config_{std::move(app_config)} {
+    auto database = app_config_->database();
+    database.secondary_directory = database.directory;
+    database.directory = app_config_->apiReplicaDb().value();
+    database.in_memory = false;
+    database.statistics = false;
+    database.critical_io_rate = 0;
+    db_ = std::make_shared<storage::RocksDb>(logsys, database, nullptr);
+    // Finalized blocks moved to ancient store are not served
+    block_storage_ = std::make_shared<blockchain::BlockStorageImpl>(
+        logsys,
+        db_,
+        std::make_shared<crypto::HasherImpl>(),
+        nullptr,
+        std::make_shared<blockchain::BlockValueCodec>(database.compress_blocks),
+        nullptr,
+        nullptr,
+        nullptr);
+  }
+
+  ApiReplica::~ApiReplica() = default;
+
+  outcome::result<void> ApiReplica::run() {
+    io_context_ = std::make_shared<boost::asio::io_context>();
+    events_ = std::make_shared<http::EventStream>();
+    auto view_res = readView();
+    if (view_res.has_error()) {
+      SL_CRITICAL(log_,
+                  "Can't read chain of {}: {}",
+                  app_config_->apiReplicaDb().value(),
+                  view_res.error());
+      return view_res.error();
+    }
+    view_ = std::make_shared<const View>(std::move(view_res.value()));
+    SL_INFO(log_,
+            "Replica of {}, head {}, finalized {}",
+            app_config_->apiReplicaDb().value(),
+            view_->head,
+            view_->finalized);
+
+    auto &api_config = app_config_->api();
+    http::ServerConfig config_api{
+        .endpoint = app_config_->apiEndpoint(),
+        .max_connections = api_config.max_connections,
+        .on_request =
+            [weak_self{weak_from_this()}](
+                http::Request request) -> http::AnyResponse {
+              http::Response response;
+              auto self = weak_self.lock();
+              if (not self) {
+                response.result(boost::beast::http::status::bad_gateway);
+                return response;
+              }
+              std::string_view url{request.target()};
+              SL_DEBUG(self->log_,
+                       "{} {}",
+                       std::string_view{request.method_string()},
+                       url);
+              if (url == "/lean/v0/health") {
+                response.set(boost::beast::http::field::content_type,
+                             kContentTypeJson);
+                response.body() =
+                    R"({"status":"healthy","service":"lean-rpc-api"})";
+                return response;
+              }
+              if (url == "/lean/v0/states/finalized") {
+                auto view_res = self->finalizedState();
+                if (not view_res.has_value()) {
+                  // State of finalized block may be not written yet
+                  response.result(
+                      boost::beast::http::status::service_unavailable);
+                  response.set(boost::beast::http::field::retry_after, "1");
+                  return response;
+                }
+                auto &view = view_res.value();
+                return http::sharedBodyResponse(request,
+                                                view->finalized_state,
+                                                view->finalized_etag,
+                                                "application/octet-stream");
+              }
+              if (url == "/lean/v0/checkpoints/justified") {
+                auto justified = [&] {
+                  std::lock_guard lock{self->mutex_};
+                  return self->view_->justified;
+                }();
+                response.set(boost::beast::http::field::content_type,
+                             kContentTypeJson);
+                response.body() = std::format(R"({{"root":"0x{}","slot":{}}})",
+                                              justified.root.toHex(),
+                                              justified.slot);
+                return response;
+              }
+              if (url == "/lean/v0/events") {
+                return http::EventStreamResponse{self->events_};
+              }
+              response.result(boost::beast::http::status::not_found);
+              return response;
+            },
+    };
+    OUTCOME_TRY(http::serve(log_, *io_context_, config_api));
+
+    boost::asio::signal_set signals{*io_context_, SIGINT, SIGTERM};
+    signals.async_wait([io_context{io_context_}](auto &&...) {
+      io_context->stop();
+    });
+    scheduleCatchUp();
+
+    std::vector<std::thread> io_threads;
+    for (size_t i = 0; i < api_config.threads; ++i) {
+      io_threads.emplace_back([io_context{io_context_}] {
+        setThreadName("http");
+        io_context->run();
+      });
+    }
+    for (auto &io_thread : io_threads) {
+      io_thread.join();
+    }
+    SL_INFO(log_, "Replica stopped");
+    return outcome::success();
+  }
+
+  void ApiReplica::scheduleCatchUp() {
+    auto timer = std::make_shared<boost::asio::steady_timer>(*io_context_);
+    timer->expires_after(kCatchUpPeriod);
+    timer->async_wait(
+        [weak_self{weak_from_this()}, timer](boost::system::error_code ec) {
+          auto self = weak_self.lock();
+          if (ec or not self) {
+            return;
+          }
+          self->catchUp();
+          self->scheduleCatchUp();
+        });
+  }
+
+  void ApiReplica::catchUp() {
+    if (db_->catchUp().has_error()) {
+      return;
+    }
+    auto view_res = readView();
+    if (view_res.has_error()) {
+      SL_WARN(log_, "Can't read chain: {}", view_res.error());
+      return;
+    }
+    auto &view = view_res.value();
+    std::shared_ptr<const View> previous;
+    {
+      std::lock_guard lock{mutex_};
+      previous = view_;
+      if (previous->head == view.head
+          and previous->justified == view.justified
+          and previous->finalized == view.finalized) {
+        return;
+      }
+      if (previous->finalized == view.finalized) {
+        // Keep encoded finalized state
+        view.finalized_state = previous->finalized_state;
+      }
+      view_ = std::make_shared<const View>(view);
+    }
+    SL_DEBUG(log_, "Head {}, finalized {}", view.head, view.finalized);
+    if (previous->justified != view.justified) {
+      events_->publish("justified",
+                       std::format(R"({{"root":"0x{}","slot":{}}})",
+                                   view.justified.root.toHex(),
+                                   view.justified.slot));
+    }
+    if (previous->finalized != view.finalized) {
+      events_->publish("finalized",
+                       std::format(R"({{"root":"0x{}","slot":{}}})",
+                                   view.finalized.root.toHex(),
+                                   view.finalized.slot));
+    }
+  }
+
+  outcome::result<ApiReplica::View> ApiReplica::readView() const {
+    View view;
+    OUTCOME_TRY(leaves, block_storage_->getBlockTreeLeaves());
+    std::optional<BlockIndex> head;
+    for (auto &hash : leaves) {
+      OUTCOME_TRY(header, block_storage_->getBlockHeader(hash));
+      if (not head.has_value() or header.slot > head->slot) {
+        head = BlockIndex{header.slot, hash};
+      }
+    }
+    if (not head.has_value()) {
+      return blockchain::BlockStorageError::BLOCK_TREE_LEAVES_NOT_FOUND;
+    }
+    view.head = *head;
+    // Latest block with stored state, as states are not stored for all
+    for (auto hash = head->hash;;) {
+      OUTCOME_TRY(header, block_storage_->getBlockHeader(hash));
+      if (header.slot == 0) {
+        view.finalized = {.root = hash, .slot = 0};
+        view.justified = view.finalized;
+        break;
+      }
+      OUTCOME_TRY(checkpoints, block_storage_->getStateCheckpoints(hash));
+      if (checkpoints.has_value()) {
+        view.finalized = checkpoints->finalized;
+        view.justified = checkpoints->justified;
+        break;
+      }
+      hash = header.parent_root;
+    }
+    view.finalized_etag = std::format(R"("0x{}")", view.finalized.root.toHex());
+    return view;
+  }
+
+  outcome::result<std::shared_ptr<const ApiReplica::View>>
+  ApiReplica::finalizedState() {
+    // Concurrent requests wait for one encoding instead of repeating it
+    std::lock_guard lock{mutex_};
+    if (view_->finalized_state) {
+      return view_;
+    }
+    OUTCOME_TRY(state, block_storage_->getState(view_->finalized.root));
+    if (not state.has_value()) {
+      return blockchain::BlockStorageError::STATE_NOT_FOUND;
+    }
+    OUTCOME_TRY(ssz, encode(*state));
+    auto view = std::make_shared<View>(*view_);
+    view->finalized_state =
+        std::make_shared<const qtils::ByteVec>(std::move(ssz));
+    SL_DEBUG(log_,
+             "Encoded finalized state {} for api, {} bytes",
+             view->finalized.slot,
+             view->finalized_state->size());
+    view_ = view;
+    return view_;
+  }
+}  // namespace lean::app
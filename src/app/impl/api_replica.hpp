@@ -0,0 +1,92 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include <qtils/byte_vec.hpp>
+#include <qtils/shared_ref.hpp>
+
+#include "log/logger.hpp"
+#include "types/block_index.hpp"
+#include "types/checkpoint.hpp"
+
+namespace boost::asio {
+  class io_context;
+}  // namespace boost::asio
+
+namespace lean::blockchain {
+  class BlockStorage;
+}  // namespace lean::blockchain
+
+namespace lean::http {
+  class EventStream;
+}  // namespace lean::http
+
+namespace lean::storage {
+  class RocksDb;
+}  // namespace lean::storage
+
+namespace lean::app {
+  class Configuration;
+
+  /**
+   * Read-only api of other node, `--api-replica-db`, served from its
+   * database opened as RocksDB secondary instance, so api load doesn't
+   * compete with consensus work of node.
+   *
+   * Writes of node are caught up with periodically, then head and
+   * checkpoints are found by walking back from highest block tree leaf, as
+   * `BlockTreeInitializer` does at node start.
+   * Fork choice votes are kept in node memory only, so `/lean/v0/fork_choice`
+   * and admin endpoints are not served.
+   */
+  class ApiReplica : public std::enable_shared_from_this<ApiReplica> {
+   public:
+    /// Database of node is caught up with this often
+    static constexpr std::chrono::seconds kCatchUpPeriod{1};
+
+    ApiReplica(qtils::SharedRef<log::LoggingSystem> logsys,
+               qtils::SharedRef<const Configuration> app_config);
+    ~ApiReplica();
+
+    /// Serve api until SIGINT or SIGTERM
+    outcome::result<void> run();
+
+   private:
+    /// Chain of node database at last catch up
+    struct View {
+      BlockIndex head;
+      Checkpoint justified;
+      Checkpoint finalized;
+      std::string finalized_etag;
+      /// Encoded on first request
+      std::shared_ptr<const qtils::ByteVec> finalized_state;
+    };
+
+    /// Read writes of node, and update view if chain changed
+    void catchUp();
+    void scheduleCatchUp();
+    outcome::result<View> readView() const;
+    /// View with encoded finalized state
+    outcome::result<std::shared_ptr<const View>> finalizedState();
+
+    log::Logger log_;
+    qtils::SharedRef<const Configuration> app_config_;
+    std::shared_ptr<storage::RocksDb> db_;
+    std::shared_ptr<blockchain::BlockStorage> block_storage_;
+    std::shared_ptr<boost::asio::io_context> io_context_;
+    std::shared_ptr<http::EventStream> events_;
+    /// Protects view, io context runs on several threads
+    std::mutex mutex_;
+    std::shared_ptr<const View> view_;
+  };
+}  // namespace lean::app
@@ -10,15 +10,19 @@
 #include <unistd.h>
 
 #include "app/configuration.hpp"
+#include "app/impl/memory_monitor.hpp"
 #include "app/impl/watchdog.hpp"
 #include "app/state_manager.hpp"
 #include "app/timeline.hpp"
+#include "blockchain/impl/storage_pruner.hpp"
 #include "clock/clock.hpp"
 #include "log/logger.hpp"
 #include "metrics/handler.hpp"
 #include "metrics/impl/metrics_impl.hpp"
 #include "metrics/metrics.hpp"
 #include "se/impl/subscription_manager.hpp"
+#include "utils/thread_placement.hpp"
+#include "utils/worker_pool.hpp"
 
 namespace lean::app {
 
@@ -38,8 +42,11 @@ namespace lean::app {
       qtils::SharedRef<metrics::Handler> metrics_handler,
       qtils::SharedRef<clock::SystemClock> system_clock,
       qtils::SharedRef<Timeline> timeline,
+      qtils::SharedRef<blockchain::StoragePruner> storage_pruner,
+      qtils::SharedRef<MemoryMonitor> memory_monitor,
       qtils::SharedRef<metrics::Registry> metrics_registry,
-      std::shared_ptr<SeHolder>)
+      qtils::SharedRef<WorkerPool> worker_pool,
+      std::shared_ptr<SeHolder> se_holder)
       : logger_(logsys->getLogger("Application", "application")),
         app_config_(std::move(config)),
         state_manager_(std::move(state_manager)),
@@ -48,7 +55,9 @@ namespace lean::app {
         metrics_(std::move(metrics)),
         metrics_handler_(std::move(metrics_handler)),
         system_clock_(std::move(system_clock)),
-        timeline_(std::move(timeline)) {
+        timeline_(std::move(timeline)),
+        storage_pruner_(std::move(storage_pruner)),
+        memory_monitor_(std::move(memory_monitor)) {
     metrics_handler_->registerCollectable(*metrics_registry);
 
     // Metric for exposing name and version of node
@@ -58,6 +67,23 @@ namespace lean::app {
             {"version", app_config_->nodeVersion()},
         })
         ->set(1);
+
+    watchdog_->watch(
+        "dispatcher",
+        [dispatcher{std::weak_ptr{se_holder->se_->dispatcher()}}](
+            std::function<void()> probe) {
+          if (auto self = dispatcher.lock()) {
+            self->add(
+                static_cast<se::Dispatcher::Tid>(
+                    SubscriptionEngineHandlers::kTest),
+                std::move(probe));
+          }
+        });
+    watchdog_->watch("pool",
+                     [pool{std::move(worker_pool)}](
+                         std::function<void()> probe) {
+                       pool->post(std::move(probe));
+                     });
   }
 
   void ApplicationImpl::run() {
@@ -67,12 +93,15 @@ namespace lean::app {
                   getpid());
 
     std::thread watchdog_thread([this] {
-      soralog::util::setThreadName("watchdog");
+      setThreadName("watchdog");
       watchdog_->checkLoop(kWatchdogDefaultTimeout);
     });
 
     state_manager_->atShutdown([this] { watchdog_->stop(); });
 
+    // Threads not started by node, e.g. of RocksDB, exist by now
+    state_manager_->atLaunch([] { placeThreads(); });
+
     // Set process start time metric
     metrics_->app_process_start_time()->set(system_clock_->nowSec());
 
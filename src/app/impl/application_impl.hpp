@@ -17,15 +17,21 @@
 
 namespace lean {
   class Watchdog;
+  class WorkerPool;
 }  // namespace lean
 
 namespace lean::app {
   class Timeline;
   class Configuration;
   class HttpServer;
+  class MemoryMonitor;
   class StateManager;
 }  // namespace lean::app
 
+namespace lean::blockchain {
+  class StoragePruner;
+}  // namespace lean::blockchain
+
 namespace lean::clock {
   class SystemClock;
 }  // namespace lean::clock
@@ -87,8 +93,11 @@ namespace lean::app {
                     qtils::SharedRef<metrics::Handler> metrics_handler,
                     qtils::SharedRef<clock::SystemClock> system_clock,
                     qtils::SharedRef<Timeline> timeline,
+                    qtils::SharedRef<blockchain::StoragePruner> storage_pruner,
+                    qtils::SharedRef<MemoryMonitor> memory_monitor,
                     qtils::SharedRef<metrics::Registry> metrics_registry,
-                    std::shared_ptr<SeHolder>);
+                    qtils::SharedRef<WorkerPool> worker_pool,
+                    std::shared_ptr<SeHolder> se_holder);
 
     void run() override;
 
@@ -102,6 +111,8 @@ namespace lean::app {
     qtils::SharedRef<metrics::Handler> metrics_handler_;
     qtils::SharedRef<clock::SystemClock> system_clock_;
     qtils::SharedRef<Timeline> timeline_;
+    qtils::SharedRef<blockchain::StoragePruner> storage_pruner_;
+    qtils::SharedRef<MemoryMonitor> memory_monitor_;
   };
 
 }  // namespace lean::app
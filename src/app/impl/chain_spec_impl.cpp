@@ -120,8 +120,10 @@ namespace lean::app {
         auto peer_id = entry.enr.peerId();
         auto multiaddr = entry.enr.connectAddress();
 
-        bootnode_infos.emplace_back(
-            std::move(multiaddr), std::move(peer_id), entry.enr.isAggregator());
+        bootnode_infos.emplace_back(std::move(multiaddr),
+                                    std::move(peer_id),
+                                    entry.enr.isAggregator(),
+                                    entry.enr.attnets);
         SL_INFO(log_,
                 "Added boot node: {} -> peer={}, address={}",
                 entry.raw,
@@ -6,24 +6,58 @@
 
 #include "app/impl/http_server.hpp"
 
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <limits>
+
+#include <boost/asio/post.hpp>
 #include <boost/beast/http/message.hpp>
 #include <boost/beast/http/string_body.hpp>
 #include <qtils/bytestr.hpp>
-#include <qtils/option_take.hpp>
 
 #include "app/chain_spec.hpp"
 #include "app/configuration.hpp"
+#include "app/impl/watchdog.hpp"
 #include "app/state_manager.hpp"
+#include "blockchain/block_storage.hpp"
+#include "blockchain/block_storage_error.hpp"
+#include "blockchain/block_tree.hpp"
 #include "blockchain/fork_choice_mutex.hpp"
+#include "blockchain/lock_profiler.hpp"
+#include "blockchain/state_regenerator.hpp"
+#include "log/tracing.hpp"
 #include "metrics/handler.hpp"
+#include "modules/shared/networking_types.tmp.hpp"
+#include "modules/shared/prodution_types.tmp.hpp"
+#include "se/impl/subscription_manager.hpp"
+#include "se/subscription.hpp"
 #include "serde/json.hpp"
 #include "serde/serialization.hpp"
+#include "storage/db_snapshot.hpp"
+#include "storage/spaced_storage.hpp"
 #include "types/fork_choice_api_json.hpp"
 #include "types/state.hpp"
+#include "utils/cpu_profiler.hpp"
+#include "utils/heap.hpp"
+#include "utils/hex.hpp"
 #include "utils/http.hpp"
+#include "utils/thread_placement.hpp"
 
 namespace lean::app {
   constexpr auto *kContentTypeJson = "application/json; charset=utf-8";
+  constexpr auto *kContentTypeSsz = "application/octet-stream";
+  /// Header of chain view responses of follower, which imports blocks with
+  /// unverified aggregated proofs
+  constexpr auto *kOptimisticHeader = "Lean-Optimistic";
+  /// Sites listed by lock contention API
+  constexpr size_t kTopLockContenders = 20;
+  /// CPU profile API defaults and limits
+  constexpr uint32_t kProfileSeconds = 10;
+  constexpr uint32_t kMaxProfileSeconds = 60;
+  /// Not multiple of timer ticks, so sampling doesn't align with them
+  constexpr uint32_t kProfileFrequency = 99;
+  constexpr uint32_t kMaxProfileFrequency = 1000;
 
   struct Enabled {
     bool enabled;
@@ -31,18 +65,79 @@ namespace lean::app {
     JSON_FIELDS(enabled);
   };
 
+  /// Body of CPU profile request, defaults if fields are missing
+  struct ProfileRequest {
+    std::optional<uint32_t> seconds;
+    std::optional<uint32_t> frequency;
+
+    JSON_FIELDS(seconds, frequency);
+  };
+
+  /// Body of heap request, "purge" or "profile"
+  struct HeapRequest {
+    std::string action;
+
+    JSON_FIELDS(action);
+  };
+
+  /// Body of database snapshot request, name of directory in
+  /// `<base_path>/db_snapshots`, finalized slot by default
+  struct DbSnapshotRequest {
+    std::optional<std::string> name;
+
+    JSON_FIELDS(name);
+  };
+
+  struct DbSnapshotJson {
+    std::string directory;
+
+    JSON_FIELDS(directory);
+  };
+
+  /// Snapshot name from api can't refer outside of snapshots directory
+  inline bool isSnapshotName(std::string_view name) {
+    return not name.empty() and name != "." and name != ".."
+           and name.find_first_of("/\\") == std::string_view::npos;
+  }
+
+  /// Statistics of heap allocator, as returned by admin API
+  struct HeapJson {
+    std::string allocator;
+    size_t allocated;
+    size_t active;
+    size_t resident;
+    size_t retained;
+    std::vector<size_t> arenas;
+
+    JSON_FIELDS(allocator, allocated, active, resident, retained, arenas);
+  };
+
   HttpServer::HttpServer(
       qtils::SharedRef<log::LoggingSystem> logsys,
       qtils::SharedRef<StateManager> state_manager,
+      qtils::SharedRef<Subscription> se_manager,
       qtils::SharedRef<Configuration> app_config,
       qtils::SharedRef<metrics::Handler> metrics_handler,
       qtils::SharedRef<app::ChainSpec> chain_spec,
-      qtils::SharedRef<ForkChoiceStoreMutex> fork_choice_store)
+      qtils::SharedRef<ForkChoiceStoreMutex> fork_choice_store,
+      qtils::SharedRef<LockProfiler> lock_profiler,
+      qtils::SharedRef<Watchdog> watchdog,
+      qtils::SharedRef<blockchain::BlockTree> block_tree,
+      qtils::SharedRef<blockchain::BlockStorage> block_storage,
+      qtils::SharedRef<blockchain::StateRegenerator> state_regenerator,
+      qtils::SharedRef<storage::SpacedStorage> storage)
       : log_{logsys->getLogger("HttpServer", "http")},
+        se_manager_{std::move(se_manager)},
         app_config_{std::move(app_config)},
         metrics_handler_{std::move(metrics_handler)},
         chain_spec_{std::move(chain_spec)},
-        fork_choice_store_{std::move(fork_choice_store)} {
+        fork_choice_store_{std::move(fork_choice_store)},
+        lock_profiler_{std::move(lock_profiler)},
+        watchdog_{std::move(watchdog)},
+        block_tree_{std::move(block_tree)},
+        block_storage_{std::move(block_storage)},
+        state_regenerator_{std::move(state_regenerator)},
+        storage_{std::move(storage)} {
     state_manager->takeControl(*this);
   }
 
@@ -52,6 +147,8 @@ namespace lean::app {
 
   void HttpServer::start() {
     io_context_ = std::make_shared<boost::asio::io_context>();
+    events_ = std::make_shared<http::EventStream>();
+    duties_ = std::make_shared<http::EventStream>();
     http::ServerConfig config_metrics{
         .endpoint = app_config_->metrics().endpoint,
         .on_request =
@@ -77,10 +174,13 @@ namespace lean::app {
               return response;
             },
     };
+    auto &api_config = app_config_->api();
     http::ServerConfig config_api{
         .endpoint = app_config_->apiEndpoint(),
+        .max_connections = api_config.max_connections,
         .on_request =
-            [weak_self{weak_from_this()}](http::Request request) {
+            [weak_self{weak_from_this()}](
+                http::Request request) -> http::AnyResponse {
               http::Response response;
               auto self = weak_self.lock();
               if (not self) {
@@ -96,22 +196,48 @@ namespace lean::app {
                 response.set(boost::beast::http::field::content_type,
                              kContentTypeJson);
                 response.body() =
-                    R"({"status":"healthy","service":"lean-rpc-api"})";
+                    self->fork_choice_store_->optimistic()
+                        ? R"({"status":"healthy","service":"lean-rpc-api",)"
+                          R"("optimistic":true})"
+                        : R"({"status":"healthy","service":"lean-rpc-api"})";
                 return response;
               }
               if (url == "/lean/v0/states/finalized") {
-                auto finalized = self->fork_choice_store_->getLatestFinalized();
-                if (auto state_res =
-                        self->fork_choice_store_->getState(finalized.root)) {
-                  auto &state = state_res.value();
-                  response.set(boost::beast::http::field::content_type,
-                               "application/octet-stream");
-                  response.body() = qtils::byte2str(encode(*state).value());
-                } else {
+                // Checkpoint sync clients retry, instead of sharing
+                // bandwidth with too many others
+                auto download = self->beginStateDownload();
+                if (not download) {
+                  response.result(
+                      boost::beast::http::status::service_unavailable);
+                  response.set(boost::beast::http::field::retry_after, "1");
+                  return response;
+                }
+                auto snapshot_res = self->finalizedState();
+                if (not snapshot_res.has_value()) {
                   response.result(
                       boost::beast::http::status::internal_server_error);
+                  return response;
                 }
-                return response;
+                auto &snapshot = snapshot_res.value();
+                return http::sharedBodyResponse(request,
+                                                snapshot->ssz,
+                                                snapshot->etag,
+                                                kContentTypeSsz,
+                                                std::move(download));
+              }
+              auto path = http::targetPath(url);
+              constexpr std::string_view kStates = "/lean/v0/states/";
+              if (path.starts_with(kStates)) {
+                return self->stateResponse(request,
+                                           path.substr(kStates.size()));
+              }
+              if (path == "/lean/v0/blocks") {
+                return self->blocksRangeResponse(request);
+              }
+              constexpr std::string_view kBlocks = "/lean/v0/blocks/";
+              if (path.starts_with(kBlocks)) {
+                return self->blockResponse(request,
+                                           path.substr(kBlocks.size()));
               }
               if (url == "/lean/v0/checkpoints/justified") {
                 auto justified = self->fork_choice_store_->getLatestJustified();
@@ -120,20 +246,63 @@ namespace lean::app {
                 response.body() = std::format(R"({{"root":"0x{}","slot":{}}})",
                                               justified.root.toHex(),
                                               justified.slot);
+                if (self->fork_choice_store_->optimistic()) {
+                  response.set(kOptimisticHeader, "true");
+                }
+                return response;
+              }
+              if (url == "/lean/v0/events") {
+                return http::EventStreamResponse{self->events_};
+              }
+              if (url == "/lean/v0/validator/events") {
+                return http::EventStreamResponse{self->duties_};
+              }
+              if (url == "/lean/v0/validator/attestation_data") {
+                auto duty = [&] {
+                  std::lock_guard lock{self->cache_mutex_};
+                  return self->attestation_duty_;
+                }();
+                if (not duty) {
+                  response.result(boost::beast::http::status::not_found);
+                  return response;
+                }
+                response.set(boost::beast::http::field::content_type,
+                             kContentTypeSsz);
+                auto ssz = encode(duty->data).value();
+                response.body().assign(ssz.begin(), ssz.end());
                 return response;
               }
+              if (url == "/lean/v0/validator/attestations"
+                  and request.method() == boost::beast::http::verb::post) {
+                return self->submitAttestation(request);
+              }
               if (url == "/lean/v0/fork_choice") {
-                if (auto result_res =
-                        self->fork_choice_store_->apiForkChoice()) {
-                  auto &result = result_res.value();
-                  response.set(boost::beast::http::field::content_type,
-                               kContentTypeJson);
-                  response.body() = json::encode(json::NameCase::SNAKE, result);
-                } else {
+                auto snapshot_res = self->forkChoice();
+                if (not snapshot_res.has_value()) {
                   response.result(
                       boost::beast::http::status::internal_server_error);
+                  return response;
                 }
-                return response;
+                auto &snapshot = snapshot_res.value();
+                // Pollers get empty response until fork choice changes
+                if (request[boost::beast::http::field::if_none_match]
+                    == snapshot->etag) {
+                  response.result(boost::beast::http::status::not_modified);
+                  response.set(boost::beast::http::field::etag,
+                               snapshot->etag);
+                  return response;
+                }
+                http::SharedResponse shared{.body = snapshot->json};
+                shared.header.version(request.version());
+                shared.header.result(boost::beast::http::status::ok);
+                shared.header.set(boost::beast::http::field::content_type,
+                                  kContentTypeJson);
+                shared.header.set(boost::beast::http::field::etag,
+                                  snapshot->etag);
+                if (self->fork_choice_store_->optimistic()) {
+                  shared.header.set(kOptimisticHeader, "true");
+                }
+                return shared;
               }
               if (url == "/lean/v0/admin/aggregator") {
                 if (request.method() == boost::beast::http::verb::get) {
@@ -154,6 +323,11 @@ namespace lean::app {
                     return response;
                   }
                   auto enabled = body.enabled;
+                  // Aggregates of follower would include unverified votes
+                  if (enabled and self->fork_choice_store_->optimistic()) {
+                    response.result(boost::beast::http::status::conflict);
+                    return response;
+                  }
                   auto previous = self->chain_spec_->setIsAggregator(enabled);
                   response.set(boost::beast::http::field::content_type,
                                kContentTypeJson);
@@ -164,18 +338,273 @@ namespace lean::app {
                   return response;
                 }
               }
+              if (url == "/lean/v0/admin/lock_contention") {
+                response.set(boost::beast::http::field::content_type,
+                             kContentTypeJson);
+                response.body() = json::encode(
+                    json::NameCase::SNAKE,
+                    self->lock_profiler_->topContenders(kTopLockContenders));
+                return response;
+              }
+              if (url == "/lean/v0/admin/threads") {
+                response.set(boost::beast::http::field::content_type,
+                             kContentTypeJson);
+                response.body() =
+                    json::encode(json::NameCase::SNAKE, listThreads());
+                return response;
+              }
+              if (url == "/lean/v0/admin/heap") {
+                if (request.method() == boost::beast::http::verb::post) {
+                  HeapRequest body;
+                  try {
+                    json::decode(json::NameCase::SNAKE, body, request.body());
+                  } catch (std::exception &e) {
+                    response.result(boost::beast::http::status::bad_request);
+                    response.body() = e.what();
+                    return response;
+                  }
+                  if (body.action == "profile") {
+                    auto profile = heapProfile();
+                    if (not profile.has_value()) {
+                      response.result(
+                          profile.error() == HeapError::UNSUPPORTED
+                              ? boost::beast::http::status::not_implemented
+                              : boost::beast::http::status::
+                                    internal_server_error);
+                      response.body() = profile.error().message();
+                      return response;
+                    }
+                    response.set(boost::beast::http::field::content_type,
+                                 "text/plain; charset=utf-8");
+                    response.body() = std::move(profile.value());
+                    return response;
+                  }
+                  if (body.action != "purge") {
+                    response.result(boost::beast::http::status::bad_request);
+                    response.body() = "action must be purge or profile";
+                    return response;
+                  }
+                  SL_INFO(self->log_, "Purging heap of {}", heapAllocator());
+                  purgeHeap();
+                }
+                auto stats = heapStats();
+                if (not stats.has_value()) {
+                  response.result(boost::beast::http::status::not_implemented);
+                  response.body() =
+                      make_error_code(HeapError::UNSUPPORTED).message();
+                  return response;
+                }
+                response.set(boost::beast::http::field::content_type,
+                             kContentTypeJson);
+                response.body() = json::encode(
+                    json::NameCase::SNAKE,
+                    HeapJson{
+                        .allocator = std::string{heapAllocator()},
+                        .allocated = stats->allocated,
+                        .active = stats->active,
+                        .resident = stats->resident,
+                        .retained = stats->retained,
+                        .arenas = std::move(stats->arenas),
+                    });
+                return response;
+              }
+              if (url == "/lean/v0/admin/profile"
+                  and request.method() == boost::beast::http::verb::post) {
+                ProfileRequest body;
+                try {
+                  if (not request.body().empty()) {
+                    json::decode(json::NameCase::SNAKE, body, request.body());
+                  }
+                } catch (std::exception &e) {
+                  response.result(boost::beast::http::status::bad_request);
+                  response.body() = e.what();
+                  return response;
+                }
+                auto seconds = body.seconds.value_or(kProfileSeconds);
+                auto frequency = body.frequency.value_or(kProfileFrequency);
+                if (seconds == 0 or seconds > kMaxProfileSeconds
+                    or frequency == 0 or frequency > kMaxProfileFrequency) {
+                  response.result(boost::beast::http::status::bad_request);
+                  response.body() = std::format(
+                      "seconds must be 1..{}, frequency must be 1..{}",
+                      kMaxProfileSeconds,
+                      kMaxProfileFrequency);
+                  return response;
+                }
+                SL_INFO(self->log_,
+                        "CPU profiling for {}s at {}Hz",
+                        seconds,
+                        frequency);
+                // Blocks this HTTP thread for `seconds`, others keep serving
+                auto names = self->watchdog_->threadNames();
+                auto folded = profileCpu(
+                    std::chrono::seconds{seconds},
+                    frequency,
+                    [&](uint64_t tid) -> std::optional<std::string> {
+                      auto it = names.find(tid);
+                      if (it == names.end()) {
+                        return std::nullopt;
+                      }
+                      return it->second;
+                    });
+                if (not folded.has_value()) {
+                  response.result(
+                      folded.error() == CpuProfilerError::BUSY
+                          ? boost::beast::http::status::conflict
+                          : boost::beast::http::status::internal_server_error);
+                  response.body() = folded.error().message();
+                  return response;
+                }
+                response.set(boost::beast::http::field::content_type,
+                             "text/plain; charset=utf-8");
+                response.body() = std::move(folded.value());
+                return response;
+              }
+              if (url == "/lean/v0/admin/db_snapshot"
+                  and request.method() == boost::beast::http::verb::post) {
+                DbSnapshotRequest body;
+                try {
+                  if (not request.body().empty()) {
+                    json::decode(json::NameCase::SNAKE, body, request.body());
+                  }
+                } catch (std::exception &e) {
+                  response.result(boost::beast::http::status::bad_request);
+                  response.body() = e.what();
+                  return response;
+                }
+                auto name = body.name.value_or(std::format(
+                    "slot-{}", self->block_tree_->lastFinalized().slot));
+                if (not isSnapshotName(name)) {
+                  response.result(boost::beast::http::status::bad_request);
+                  response.body() = "name must not be empty, . or .., or "
+                                    "contain path separator";
+                  return response;
+                }
+                auto directory =
+                    self->app_config_->basePath() / "db_snapshots" / name;
+                std::error_code ec;
+                if (std::filesystem::exists(directory, ec)) {
+                  response.result(boost::beast::http::status::conflict);
+                  response.body() =
+                      make_error_code(storage::DbSnapshotError::EXISTS)
+                          .message();
+                  return response;
+                }
+                if (self->db_snapshot_running_.exchange(true)) {
+                  response.result(boost::beast::http::status::conflict);
+                  response.body() = "Snapshot is in progress";
+                  return response;
+                }
+                // Previous snapshot has finished
+                if (self->db_snapshot_thread_.joinable()) {
+                  self->db_snapshot_thread_.join();
+                }
+                std::filesystem::create_directories(directory.parent_path(),
+                                                    ec);
+                // Memtable flush and ancient store copy take long
+                self->db_snapshot_thread_ = std::thread{
+                    [self_ptr{self.get()},
+                     log{self->log_},
+                     storage{self->storage_},
+                     db_directory{self->app_config_->database().directory},
+                     directory] {
+                      setThreadName("db_snapshot");
+                      auto res = storage::checkpointDatabase(
+                          *storage, db_directory, directory);
+                      if (res.has_error()) {
+                        SL_ERROR(log,
+                                 "Database snapshot into {} failed: {}",
+                                 directory.native(),
+                                 res.error());
+                      } else {
+                        SL_INFO(log,
+                                "Database snapshot created in {}",
+                                directory.native());
+                      }
+                      self_ptr->db_snapshot_running_ = false;
+                    }};
+                response.result(boost::beast::http::status::accepted);
+                response.set(boost::beast::http::field::content_type,
+                             kContentTypeJson);
+                response.body() = json::encode(
+                    json::NameCase::SNAKE,
+                    DbSnapshotJson{.directory = directory.string()});
+                return response;
+              }
+              if (url == "/lean/v0/admin/flight_recorder"
+                  and request.method() == boost::beast::http::verb::post) {
+                auto dump = log::dumpFlightRecorder();
+                if (not dump.has_value()) {
+                  response.result(boost::beast::http::status::not_found);
+                  response.body() = dump.error().message();
+                  return response;
+                }
+                response.set(boost::beast::http::field::content_type,
+                             "application/octet-stream");
+                response.body() = std::move(dump.value());
+                return response;
+              }
+              if (url == "/lean/v0/admin/tracing") {
+                if (request.method() == boost::beast::http::verb::get) {
+                  response.set(boost::beast::http::field::content_type,
+                               kContentTypeJson);
+                  response.body() = std::format(R"({{"enabled":{}}})",
+                                                log::tracingEnabled());
+                  return response;
+                }
+                if (request.method() == boost::beast::http::verb::post) {
+                  Enabled body;
+                  try {
+                    json::decode(json::NameCase::SNAKE, body, request.body());
+                  } catch (std::exception &e) {
+                    response.result(boost::beast::http::status::bad_request);
+                    response.body() = e.what();
+                    return response;
+                  }
+                  auto previous = log::tracingEnabled();
+                  if (body.enabled and not previous) {
+                    auto &path = self->app_config_->traceFile();
+                    if (auto res = log::startTracing(path); res.has_error()) {
+                      response.result(
+                          boost::beast::http::status::internal_server_error);
+                      response.body() = res.error().message();
+                      return response;
+                    }
+                    SL_INFO(self->log_, "Tracing into {}", path);
+                  } else if (not body.enabled and previous) {
+                    log::stopTracing();
+                    SL_INFO(self->log_, "Tracing stopped");
+                  }
+                  response.set(boost::beast::http::field::content_type,
+                               kContentTypeJson);
+                  response.body() =
+                      std::format(R"({{"enabled":{},"previous":{}}})",
+                                  body.enabled,
+                                  previous);
+                  return response;
+                }
+              }
               response.result(boost::beast::http::status::not_found);
               return response;
             },
     };
     if (app_config_->metrics().enabled.value_or(false)) {
-      auto listen_res = http::serve(log_, *io_context_, config_metrics);
+      // Own thread, so scrapes don't delay api requests and can be placed
+      // away from critical threads
+      metrics_io_context_ = std::make_shared<boost::asio::io_context>();
+      auto listen_res =
+          http::serve(log_, *metrics_io_context_, config_metrics);
       if (not listen_res.has_value()) {
         SL_WARN(log_,
                 "listen metrics {}:{} error: {}",
                 config_metrics.endpoint.address().to_string(),
                 config_metrics.endpoint.port(),
                 listen_res.error());
+      } else {
+        io_threads_.emplace_back([io_context{metrics_io_context_}] {
+          setThreadName("metrics");
+          io_context->run();
+        });
       }
     }
     auto listen_res = http::serve(log_, *io_context_, config_api);
@@ -186,16 +615,393 @@ namespace lean::app {
               config_api.endpoint.port(),
               listen_res.error());
     }
-    io_thread_.emplace([io_context{io_context_}] {
-      auto work_guard = boost::asio::make_work_guard(*io_context);
-      io_context->run();
-    });
+    on_new_leaf_ =
+        se::SubscriberCreator<qtils::Empty,
+                              std::shared_ptr<const messages::NewLeaf>>::
+            create<EventTypes::BlockAdded>(
+                *se_manager_,
+                SubscriptionEngineHandlers::kTest,
+                [weak_self{weak_from_this()}](auto &, auto msg) {
+                  if (auto self = weak_self.lock()) {
+                    auto &header = msg->header;
+                    if (msg->best) {
+                      self->publishDuty("head", Checkpoint::from(header));
+                    }
+                    self->publishEvent(
+                        "block",
+                        std::format(R"({{"slot":{},"root":"0x{}",)"
+                                    R"("parent_root":"0x{}",)"
+                                    R"("proposer_index":{},"best":{}}})",
+                                    header.slot,
+                                    header.hash().toHex(),
+                                    header.parent_root.toHex(),
+                                    header.proposer_index,
+                                    msg->best));
+                  }
+                });
+    on_block_finalized_ =
+        se::SubscriberCreator<qtils::Empty,
+                              std::shared_ptr<const messages::Finalized>>::
+            create<EventTypes::BlockFinalized>(
+                *se_manager_,
+                SubscriptionEngineHandlers::kTest,
+                [weak_self{weak_from_this()}](auto &, auto msg) {
+                  if (auto self = weak_self.lock()) {
+                    self->publishEvent(
+                        "finalized",
+                        std::format(R"({{"root":"0x{}","slot":{}}})",
+                                    msg->finalized.hash.toHex(),
+                                    msg->finalized.slot));
+                  }
+                });
+    // Justification changes only when attestations are processed, so
+    // checking once per interval is enough
+    on_slot_interval_started_ = se::SubscriberCreator<
+        qtils::Empty,
+        std::shared_ptr<const messages::SlotIntervalStarted>>::
+        create<EventTypes::SlotIntervalStarted>(
+            *se_manager_,
+            SubscriptionEngineHandlers::kTest,
+            [weak_self{weak_from_this()}](auto &, auto msg) {
+              if (auto self = weak_self.lock()) {
+                self->publishDuty("interval", msg->interval.interval);
+                self->publishJustified();
+              }
+            });
+    on_attestation_duty_ = se::SubscriberCreator<
+        qtils::Empty,
+        std::shared_ptr<const messages::AttestationDuty>>::
+        create(*se_manager_,
+               SubscriptionEngineHandlers::kTest,
+               DeriveEventType::get<messages::AttestationDuty>(),
+               [weak_self{weak_from_this()}](auto &, auto msg) {
+                 if (auto self = weak_self.lock()) {
+                   {
+                     std::lock_guard lock{self->cache_mutex_};
+                     self->attestation_duty_ = msg;
+                   }
+                   self->publishDuty("attestation_data", msg->data);
+                 }
+               });
+    auto work_guard = std::make_shared<boost::asio::executor_work_guard<
+        boost::asio::io_context::executor_type>>(io_context_->get_executor());
+    for (size_t i = 0; i < api_config.threads; ++i) {
+      io_threads_.emplace_back([io_context{io_context_}, work_guard] {
+        setThreadName("http");
+        io_context->run();
+      });
+    }
+    watchdog_->watch("http",
+                     [io_context{std::weak_ptr{io_context_}}](
+                         std::function<void()> probe) {
+                       if (auto io = io_context.lock()) {
+                         boost::asio::post(*io, std::move(probe));
+                       }
+                     });
+  }
+
+  std::shared_ptr<const void> HttpServer::beginStateDownload() {
+    auto limit = app_config_->api().max_state_downloads;
+    if (state_downloads_->fetch_add(1) >= limit) {
+      state_downloads_->fetch_sub(1);
+      return nullptr;
+    }
+    return std::shared_ptr<const void>{
+        // Deleter is called for null pointer too
+        nullptr,
+        [downloads{state_downloads_}](const void *) {
+          downloads->fetch_sub(1);
+        }};
+  }
+
+  outcome::result<std::shared_ptr<const HttpServer::FinalizedStateSnapshot>>
+  HttpServer::finalizedState() {
+    // Concurrent requests wait for one encoding instead of repeating it
+    std::lock_guard lock{cache_mutex_};
+    auto finalized = fork_choice_store_->getLatestFinalized();
+    if (finalized_state_ and finalized_state_->finalized == finalized) {
+      return finalized_state_;
+    }
+    OUTCOME_TRY(state, fork_choice_store_->getState(finalized.root));
+    OUTCOME_TRY(ssz, encode(*state));
+    finalized_state_ = std::make_shared<const FinalizedStateSnapshot>(
+        FinalizedStateSnapshot{
+            .finalized = finalized,
+            .etag = std::format(R"("0x{}")", finalized.root.toHex()),
+            .ssz = std::make_shared<const qtils::ByteVec>(std::move(ssz)),
+        });
+    SL_DEBUG(log_,
+             "Encoded finalized state {} for api, {} bytes",
+             finalized.slot,
+             finalized_state_->ssz->size());
+    return finalized_state_;
+  }
+
+  /// Response with status only
+  static http::Response statusResponse(const http::Request &request,
+                                       boost::beast::http::status status) {
+    http::Response response{status, request.version()};
+    return response;
+  }
+
+  http::AnyResponse HttpServer::blockResponse(const http::Request &request,
+                                              std::string_view block_id) {
+    std::optional<BlockHash> hash;
+    if (block_id.starts_with("0x")) {
+      auto hash_res = BlockHash::fromHexWithPrefix(block_id);
+      if (not hash_res.has_value()) {
+        return statusResponse(request, boost::beast::http::status::bad_request);
+      }
+      hash = hash_res.value();
+    } else {
+      Slot slot = 0;
+      const auto *end = block_id.data() + block_id.size();
+      auto [ptr, ec] = std::from_chars(block_id.data(), end, slot);
+      if (ec != std::errc{} or ptr != end) {
+        return statusResponse(request, boost::beast::http::status::bad_request);
+      }
+      auto hash_res = block_tree_->getCanonicalHash(slot);
+      if (not hash_res.has_value()) {
+        return statusResponse(
+            request, boost::beast::http::status::internal_server_error);
+      }
+      hash = hash_res.value();
+    }
+    if (not hash.has_value()) {
+      return statusResponse(request, boost::beast::http::status::not_found);
+    }
+    auto blocks_res = block_tree_->tryGetSignedBlocks(std::span{&*hash, 1});
+    if (not blocks_res.has_value()) {
+      return statusResponse(request,
+                            boost::beast::http::status::internal_server_error);
+    }
+    auto &block = blocks_res.value().front();
+    if (not block.has_value()) {
+      return statusResponse(request, boost::beast::http::status::not_found);
+    }
+    auto ssz_res = encode(*block);
+    if (not ssz_res.has_value()) {
+      return statusResponse(request,
+                            boost::beast::http::status::internal_server_error);
+    }
+    // Block of root never changes, so root is its version
+    return http::sharedBodyResponse(
+        request,
+        std::make_shared<const qtils::ByteVec>(std::move(ssz_res.value())),
+        std::format(R"("0x{}")", hash->toHex()),
+        kContentTypeSsz);
+  }
+
+  http::AnyResponse HttpServer::blocksRangeResponse(
+      const http::Request &request) {
+    auto param = [&](std::string_view name) -> std::optional<uint64_t> {
+      auto value = http::queryParam(request.target(), name);
+      if (not value.has_value()) {
+        return std::nullopt;
+      }
+      uint64_t number = 0;
+      const auto *end = value->data() + value->size();
+      auto [ptr, ec] = std::from_chars(value->data(), end, number);
+      if (ec != std::errc{} or ptr != end) {
+        return std::nullopt;
+      }
+      return number;
+    };
+    auto start_slot = param("start_slot");
+    auto count = param("count");
+    if (not start_slot.has_value() or not count.has_value()
+        or *count > kMaxRangeBlocks
+        or *start_slot > std::numeric_limits<Slot>::max() - *count) {
+      return statusResponse(request, boost::beast::http::status::bad_request);
+    }
+    http::ChunkedResponse chunked;
+    chunked.header.version(request.version());
+    chunked.header.result(boost::beast::http::status::ok);
+    chunked.header.set(boost::beast::http::field::content_type,
+                       kContentTypeSsz);
+    // Slots of range are read lazily, batch by batch, as stream is written,
+    // so range reflects canonical chain at time of writing
+    chunked.next = [block_tree{block_tree_},
+                    slot{*start_slot},
+                    end{*start_slot + *count}]() mutable
+        -> outcome::result<std::shared_ptr<const qtils::ByteVec>> {
+      auto best = block_tree->bestBlock().slot;
+      std::vector<BlockHash> hashes;
+      // Batches of empty slots only are skipped
+      while (hashes.empty() and slot < end and slot <= best) {
+        auto batch = std::min<uint64_t>(end - slot, kRangeBatchSize);
+        OUTCOME_TRY(canonical, block_tree->getCanonicalBlocks(slot, batch));
+        slot += batch;
+        for (auto &block : canonical) {
+          hashes.emplace_back(block.hash);
+        }
+      }
+      if (hashes.empty()) {
+        return nullptr;
+      }
+      // Single batched storage lookup for all blocks of batch
+      OUTCOME_TRY(blocks, block_tree->tryGetSignedBlocks(hashes));
+      auto part = std::make_shared<qtils::ByteVec>();
+      for (auto &block : blocks) {
+        if (not block.has_value()) {
+          // Pruned since slot was read
+          continue;
+        }
+        OUTCOME_TRY(ssz, encode(*block));
+        auto size = static_cast<uint32_t>(ssz.size());
+        for (size_t i = 0; i < sizeof(size); ++i) {
+          part->emplace_back(static_cast<uint8_t>(size >> (8 * i)));
+        }
+        part->insert(part->end(), ssz.begin(), ssz.end());
+      }
+      return part;
+    };
+    return chunked;
+  }
+
+  http::AnyResponse HttpServer::stateResponse(const http::Request &request,
+                                              std::string_view root) {
+    auto root_res = BlockHash::fromHexWithPrefix(root);
+    if (not root_res.has_value()) {
+      return statusResponse(request, boost::beast::http::status::bad_request);
+    }
+    auto &block_hash = root_res.value();
+    auto download = beginStateDownload();
+    if (not download) {
+      auto response = statusResponse(
+          request, boost::beast::http::status::service_unavailable);
+      response.set(boost::beast::http::field::retry_after, "1");
+      return response;
+    }
+    std::shared_ptr<const StateSnapshot> snapshot;
+    {
+      // Parallel and resumed downloads of state share one encoding
+      std::lock_guard lock{cache_mutex_};
+      if (state_ and state_->root == block_hash) {
+        snapshot = state_;
+      }
+    }
+    if (not snapshot) {
+      // Read from storage, not to evict fork choice states from cache.
+      // States removed by pruning are replayed, without lock, as it takes
+      // a while
+      auto state_res = state_regenerator_->getState(block_hash);
+      if (not state_res.has_value()) {
+        return statusResponse(
+            request, boost::beast::http::status::internal_server_error);
+      }
+      if (not state_res.value().has_value()) {
+        return statusResponse(request, boost::beast::http::status::not_found);
+      }
+      auto ssz_res = encode(*state_res.value().value());
+      if (not ssz_res.has_value()) {
+        return statusResponse(
+            request, boost::beast::http::status::internal_server_error);
+      }
+      snapshot = std::make_shared<const StateSnapshot>(StateSnapshot{
+          .root = block_hash,
+          .ssz = std::make_shared<const qtils::ByteVec>(
+              std::move(ssz_res.value())),
+      });
+      std::lock_guard lock{cache_mutex_};
+      state_ = snapshot;
+    }
+    auto etag = std::format(R"("0x{}")", block_hash.toHex());
+    return http::sharedBodyResponse(
+        request, snapshot->ssz, etag, kContentTypeSsz, std::move(download));
+  }
+
+  outcome::result<std::shared_ptr<const HttpServer::ForkChoiceApiSnapshot>>
+  HttpServer::forkChoice() {
+    // Read before building, so change during build is rebuilt next time
+    auto version = fork_choice_store_->apiForkChoiceVersion();
+    std::lock_guard lock{cache_mutex_};
+    if (fork_choice_api_ and fork_choice_api_->version == version) {
+      return fork_choice_api_;
+    }
+    OUTCOME_TRY(result, fork_choice_store_->apiForkChoice());
+    auto json = json::encode(json::NameCase::SNAKE, result);
+    fork_choice_api_ =
+        std::make_shared<const ForkChoiceApiSnapshot>(ForkChoiceApiSnapshot{
+            .version = version,
+            // Head distinguishes versions of restarted node
+            .etag = std::format(R"("{}-0x{}")", version, result.head.toHex()),
+            .json = std::make_shared<const qtils::ByteVec>(json.begin(),
+                                                           json.end()),
+        });
+    return fork_choice_api_;
+  }
+
+  void HttpServer::publishEvent(std::string_view event,
+                                std::string_view data) {
+    events_->publish(event, data);
+  }
+
+  void HttpServer::publishDuty(std::string_view event, const auto &value) {
+    duties_->publish(event, hex0x(encode(value).value()));
+  }
+
+  http::Response HttpServer::submitAttestation(const http::Request &request) {
+    http::Response response;
+    response.version(request.version());
+    auto signed_attestation =
+        decode<SignedAttestation>(qtils::str2byte(request.body()));
+    if (not signed_attestation.has_value()) {
+      response.result(boost::beast::http::status::bad_request);
+      response.body() = signed_attestation.error().message();
+      return response;
+    }
+    // Verified like gossip, api is not authenticated, so it must not delay
+    // ticks
+    auto res = fork_choice_store_->onGossipAttestation(
+        signed_attestation.value(), ForkChoiceStoreMutex::Priority::GOSSIP);
+    if (not res.has_value()) {
+      SL_WARN(log_,
+              "Attestation of validator {} for slot {} rejected: {}",
+              signed_attestation.value().validator_id,
+              signed_attestation.value().data.slot,
+              res.error());
+      response.result(boost::beast::http::status::bad_request);
+      response.body() = res.error().message();
+      return response;
+    }
+    auto batch = std::make_shared<messages::SendGossipBatch>();
+    batch->votes.emplace_back(std::move(signed_attestation.value()));
+    dispatchDerive(
+        *se_manager_,
+        std::shared_ptr<const messages::SendGossipBatch>{std::move(batch)});
+    return response;
+  }
+
+  void HttpServer::publishJustified() {
+    auto justified = fork_choice_store_->getLatestJustified();
+    if (published_justified_ == justified) {
+      return;
+    }
+    published_justified_ = justified;
+    publishEvent("justified",
+                 std::format(R"({{"root":"0x{}","slot":{}}})",
+                             justified.root.toHex(),
+                             justified.slot));
   }
 
   void HttpServer::stop() {
-    if (auto io_thread = qtils::optionTake(io_thread_)) {
+    on_new_leaf_.reset();
+    on_block_finalized_.reset();
+    on_slot_interval_started_.reset();
+    on_attestation_duty_.reset();
+    if (io_context_) {
       io_context_->stop();
-      io_thread->join();
+    }
+    if (metrics_io_context_) {
+      metrics_io_context_->stop();
+    }
+    for (auto &io_thread : io_threads_) {
+      io_thread.join();
+    }
+    io_threads_.clear();
+    if (db_snapshot_thread_.joinable()) {
+      db_snapshot_thread_.join();
     }
   }
 }  // namespace lean::app
@@ -6,11 +6,19 @@
 
 #pragma once
 
+#include <atomic>
+#include <mutex>
 #include <thread>
+#include <vector>
 
+#include <qtils/byte_vec.hpp>
+#include <qtils/empty.hpp>
 #include <qtils/shared_ref.hpp>
 
 #include "log/logger.hpp"
+#include "se/subscription_fwd.hpp"
+#include "types/checkpoint.hpp"
+#include "utils/http.hpp"
 
 namespace boost::asio {
   class io_context;
@@ -18,8 +26,31 @@ namespace boost::asio {
 
 namespace lean {
   class ForkChoiceStoreMutex;
+  class LockProfiler;
+  class Watchdog;
 }  // namespace lean
 
+namespace lean::blockchain {
+  class BlockStorage;
+  class BlockTree;
+  class StateRegenerator;
+}  // namespace lean::blockchain
+
+namespace lean::http {
+  class EventStream;
+}  // namespace lean::http
+
+namespace lean::storage {
+  class SpacedStorage;
+}  // namespace lean::storage
+
+namespace lean::messages {
+  struct AttestationDuty;
+  struct Finalized;
+  struct NewLeaf;
+  struct SlotIntervalStarted;
+}  // namespace lean::messages
+
 namespace lean::app {
   class ChainSpec;
 }  // namespace lean::app
@@ -34,24 +65,136 @@ namespace lean::app {
 
   class HttpServer : public std::enable_shared_from_this<HttpServer> {
    public:
-    HttpServer(qtils::SharedRef<log::LoggingSystem> logsys,
-               qtils::SharedRef<StateManager> state_manager,
-               qtils::SharedRef<Configuration> app_config,
-               qtils::SharedRef<metrics::Handler> metrics_handler,
-               qtils::SharedRef<app::ChainSpec> chain_spec,
-               qtils::SharedRef<ForkChoiceStoreMutex> fork_choice_store);
+    /// Blocks streamed by single blocks range request
+    static constexpr uint64_t kMaxRangeBlocks = 1 << 14;
+    /// Blocks of range read from storage at once
+    static constexpr size_t kRangeBatchSize = 64;
+
+    HttpServer(
+        qtils::SharedRef<log::LoggingSystem> logsys,
+        qtils::SharedRef<StateManager> state_manager,
+        qtils::SharedRef<Subscription> se_manager,
+        qtils::SharedRef<Configuration> app_config,
+        qtils::SharedRef<metrics::Handler> metrics_handler,
+        qtils::SharedRef<app::ChainSpec> chain_spec,
+        qtils::SharedRef<ForkChoiceStoreMutex> fork_choice_store,
+        qtils::SharedRef<LockProfiler> lock_profiler,
+        qtils::SharedRef<Watchdog> watchdog,
+        qtils::SharedRef<blockchain::BlockTree> block_tree,
+        qtils::SharedRef<blockchain::BlockStorage> block_storage,
+        qtils::SharedRef<blockchain::StateRegenerator> state_regenerator,
+        qtils::SharedRef<storage::SpacedStorage> storage);
     ~HttpServer();
 
     void start();
     void stop();
 
    private:
+    /// Finalized state encoded once and shared by all requests for it
+    struct FinalizedStateSnapshot {
+      Checkpoint finalized;
+      std::string etag;
+      std::shared_ptr<const qtils::ByteVec> ssz;
+    };
+
+    /// Snapshot of current finalized state, encoded on first request for it
+    outcome::result<std::shared_ptr<const FinalizedStateSnapshot>>
+    finalizedState();
+
+    /// Fork choice api response encoded once per fork choice change
+    struct ForkChoiceApiSnapshot {
+      uint64_t version;
+      std::string etag;
+      std::shared_ptr<const qtils::ByteVec> json;
+    };
+
+    /**
+     * Snapshot of fork choice api response, rebuilt under fork choice lock
+     * only if fork choice changed since previous request.
+     */
+    outcome::result<std::shared_ptr<const ForkChoiceApiSnapshot>> forkChoice();
+
+    /**
+     * Count download of finalized state, limited by
+     * `ApiConfig::max_state_downloads`.
+     * @return token held until download is written, or null if limit is
+     * reached
+     */
+    std::shared_ptr<const void> beginStateDownload();
+
+    /// SSZ state of block, encoded once for parallel and resumed downloads
+    struct StateSnapshot {
+      BlockHash root;
+      std::shared_ptr<const qtils::ByteVec> ssz;
+    };
+
+    /// SSZ block by "0x<root>" or canonical slot
+    http::AnyResponse blockResponse(const http::Request &request,
+                                    std::string_view block_id);
+    /**
+     * Canonical blocks of `start_slot` and `count` query parameters,
+     * streamed as SSZ blocks, each prefixed by its size, 4 bytes little
+     * endian.
+     */
+    http::AnyResponse blocksRangeResponse(const http::Request &request);
+    /// SSZ post-state of block "0x<root>"
+    http::AnyResponse stateResponse(const http::Request &request,
+                                    std::string_view root);
+
+    /// Publish event to `/lean/v0/events` clients
+    void publishEvent(std::string_view event, std::string_view data);
+    /// Publish SSZ of `value` to `/lean/v0/validator/events` clients
+    void publishDuty(std::string_view event, const auto &value);
+    /// Verify and gossip SSZ attestation signed by validator process
+    http::Response submitAttestation(const http::Request &request);
+    /// Publish justified checkpoint, if changed since previous interval
+    void publishJustified();
+
     log::Logger log_;
+    qtils::SharedRef<Subscription> se_manager_;
     qtils::SharedRef<Configuration> app_config_;
     qtils::SharedRef<metrics::Handler> metrics_handler_;
     qtils::SharedRef<app::ChainSpec> chain_spec_;
     qtils::SharedRef<ForkChoiceStoreMutex> fork_choice_store_;
+    qtils::SharedRef<LockProfiler> lock_profiler_;
+    qtils::SharedRef<Watchdog> watchdog_;
+    qtils::SharedRef<blockchain::BlockTree> block_tree_;
+    qtils::SharedRef<blockchain::BlockStorage> block_storage_;
+    qtils::SharedRef<blockchain::StateRegenerator> state_regenerator_;
+    qtils::SharedRef<storage::SpacedStorage> storage_;
     std::shared_ptr<boost::asio::io_context> io_context_;
-    std::optional<std::thread> io_thread_;
+    std::shared_ptr<boost::asio::io_context> metrics_io_context_;
+    std::vector<std::thread> io_threads_;
+    /// Database checkpoint is made here, not to block http thread by flush
+    std::thread db_snapshot_thread_;
+    std::atomic_bool db_snapshot_running_ = false;
+    std::shared_ptr<http::EventStream> events_;
+    std::shared_ptr<http::EventStream> duties_;
+    /// Protects snapshots below, io context runs on several threads
+    std::mutex cache_mutex_;
+    std::shared_ptr<const messages::AttestationDuty> attestation_duty_;
+    std::shared_ptr<const FinalizedStateSnapshot> finalized_state_;
+    std::shared_ptr<const ForkChoiceApiSnapshot> fork_choice_api_;
+    std::shared_ptr<const StateSnapshot> state_;
+    std::shared_ptr<std::atomic_size_t> state_downloads_ =
+        std::make_shared<std::atomic_size_t>(0);
+    /// Accessed by subscription thread only
+    std::optional<Checkpoint> published_justified_;
+
+    std::shared_ptr<
+        BaseSubscriber<qtils::Empty, std::shared_ptr<const messages::NewLeaf>>>
+        on_new_leaf_;
+    std::shared_ptr<
+        BaseSubscriber<qtils::Empty,
+                       std::shared_ptr<const messages::Finalized>>>
+        on_block_finalized_;
+    std::shared_ptr<
+        BaseSubscriber<qtils::Empty,
+                       std::shared_ptr<const messages::SlotIntervalStarted>>>
+        on_slot_interval_started_;
+    std::shared_ptr<
+        BaseSubscriber<qtils::Empty,
+                       std::shared_ptr<const messages::AttestationDuty>>>
+        on_attestation_duty_;
   };
 }  // namespace lean::app
@@ -0,0 +1,121 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "app/impl/memory_monitor.hpp"
+
+#include <fstream>
+#include <unistd.h>
+
+#include "app/configuration.hpp"
+#include "app/state_manager.hpp"
+#include "metrics/metrics.hpp"
+#include "storage/spaced_storage.hpp"
+#include "utils/heap.hpp"
+#include "utils/thread_placement.hpp"
+
+namespace lean::app {
+  namespace {
+    /// Resident set size from `/proc/self/statm`, zero if unavailable
+    size_t residentBytes() {
+      std::ifstream statm{"/proc/self/statm"};
+      size_t total_pages = 0;
+      size_t resident_pages = 0;
+      if (not(statm >> total_pages >> resident_pages)) {
+        return 0;
+      }
+      return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+  }  // namespace
+
+  MemoryMonitor::MemoryMonitor(
+      qtils::SharedRef<log::LoggingSystem> logsys,
+      qtils::SharedRef<StateManager> state_manager,
+      qtils::SharedRef<metrics::Metrics> metrics,
+      qtils::SharedRef<storage::SpacedStorage> storage,
+      qtils::SharedRef<const Configuration> app_config)
+      : logger_(logsys->getLogger("MemoryMonitor", "application")),
+        metrics_(std::move(metrics)),
+        storage_(std::move(storage)),
+        heap_purge_interval_(app_config->heapPurgeInterval()),
+        heap_purged_at_(std::chrono::steady_clock::now()) {
+    state_manager->takeControl(*this);
+  }
+
+  MemoryMonitor::~MemoryMonitor() {
+    stop();
+  }
+
+  void MemoryMonitor::start() {
+    thread_ = std::thread{[this] {
+      setThreadName("memory");
+      run();
+    }};
+  }
+
+  void MemoryMonitor::stop() {
+    {
+      std::lock_guard lock{mutex_};
+      stop_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  void MemoryMonitor::run() {
+    std::unique_lock lock{mutex_};
+    while (not stop_) {
+      lock.unlock();
+      update();
+      lock.lock();
+      cv_.wait_for(lock, kInterval, [&] { return stop_; });
+    }
+  }
+
+  void MemoryMonitor::update() {
+    auto set = [&](const std::string &subsystem, size_t bytes) {
+      metrics_->app_memory_usage_bytes({{"subsystem", subsystem}})->set(bytes);
+    };
+    size_t accounted = 0;
+    for (auto &[component, bytes] : storage_->memoryUsage()) {
+      set(component, bytes);
+      accounted += bytes;
+    }
+    storage_->updateMetrics();
+    auto resident = residentBytes();
+    set("process_resident", resident);
+    SL_TRACE(logger_,
+             "Resident memory {} bytes, storage {} bytes",
+             resident,
+             accounted);
+    updateHeap();
+  }
+
+  void MemoryMonitor::updateHeap() {
+    auto now = std::chrono::steady_clock::now();
+    if (heap_purge_interval_.count() != 0
+        and now - heap_purged_at_ >= heap_purge_interval_) {
+      heap_purged_at_ = now;
+      purgeHeap();
+    }
+    auto stats = heapStats();
+    if (not stats.has_value()) {
+      return;
+    }
+    auto set = [&](const std::string &kind, size_t bytes) {
+      metrics_->app_heap_bytes({{"kind", kind}})->set(bytes);
+    };
+    set("allocated", stats->allocated);
+    set("active", stats->active);
+    set("resident", stats->resident);
+    set("retained", stats->retained);
+    for (size_t arena = 0; arena < stats->arenas.size(); ++arena) {
+      metrics_->app_heap_arena_bytes({{"arena", std::to_string(arena)}})
+          ->set(stats->arenas[arena]);
+    }
+  }
+}  // namespace lean::app
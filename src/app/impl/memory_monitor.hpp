@@ -0,0 +1,72 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <qtils/shared_ref.hpp>
+
+#include "log/logger.hpp"
+
+namespace lean::metrics {
+  class Metrics;
+}  // namespace lean::metrics
+
+namespace lean::storage {
+  class SpacedStorage;
+}  // namespace lean::storage
+
+namespace lean::app {
+  class Configuration;
+  class StateManager;
+
+  /**
+   * Periodically exports memory used by storage components and resident
+   * memory of process as `lean_memory_usage_bytes`, on own thread.
+   * Fork choice and networking account their data themselves, so sum of
+   * subsystems can be compared with resident memory. Storage statistics are
+   * exported along, if enabled, and statistics of heap allocator.
+   * Free heap memory is purged every `--heap-purge-interval`.
+   */
+  class MemoryMonitor {
+   public:
+    static constexpr std::chrono::seconds kInterval{10};
+
+    MemoryMonitor(qtils::SharedRef<log::LoggingSystem> logsys,
+                  qtils::SharedRef<StateManager> state_manager,
+                  qtils::SharedRef<metrics::Metrics> metrics,
+                  qtils::SharedRef<storage::SpacedStorage> storage,
+                  qtils::SharedRef<const Configuration> app_config);
+
+    MemoryMonitor(const MemoryMonitor &) = delete;
+    MemoryMonitor &operator=(const MemoryMonitor &) = delete;
+
+    ~MemoryMonitor();
+
+    void start();
+    void stop();
+
+   private:
+    void run();
+    void update();
+    void updateHeap();
+
+    log::Logger logger_;
+    qtils::SharedRef<metrics::Metrics> metrics_;
+    qtils::SharedRef<storage::SpacedStorage> storage_;
+    std::chrono::seconds heap_purge_interval_;
+    std::chrono::steady_clock::time_point heap_purged_at_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::thread thread_;
+  };
+}  // namespace lean::app
@@ -6,8 +6,11 @@
 
 #include "app/impl/state_manager_impl.hpp"
 
+#include <algorithm>
 #include <csignal>
 #include <functional>
+#include <thread>
+#include <unordered_map>
 
 #include "log/logger.hpp"
 
@@ -118,6 +121,8 @@ namespace lean::app {
     std::queue<OnShutdown> empty_shutdown;
     std::swap(shutdown_, empty_shutdown);
 
+    prepare_steps_.clear();
+
     state_ = State::Init;
   }
 
@@ -129,6 +134,26 @@ namespace lean::app {
     prepare_.emplace(std::move(cb));
   }
 
+  void StateManagerImpl::atPrepareStep(std::string name,
+                                       std::vector<std::string> after,
+                                       OnPrepare &&cb) {
+    std::lock_guard lg(mutex_);
+    if (state_ > State::Init) {
+      throw AppStateException("adding step for stage 'prepare'");
+    }
+    prepare_steps_.emplace_back(PrepareStep{
+        .name = std::move(name),
+        .after = std::move(after),
+        .action = std::move(cb),
+    });
+  }
+
+  std::vector<StateManager::PrepareStepTiming>
+  StateManagerImpl::prepareStepTimings() const {
+    std::lock_guard lock{timings_mutex_};
+    return prepare_step_timings_;
+  }
+
   void StateManagerImpl::atLaunch(OnLaunch &&cb) {
     std::lock_guard lg(mutex_);
     if (state_ > State::Starting) {
@@ -145,16 +170,164 @@ namespace lean::app {
     shutdown_.emplace(std::move(cb));
   }
 
-  void StateManagerImpl::doPrepare() {
-    std::lock_guard lg(mutex_);
+  bool StateManagerImpl::runPrepareSteps(std::vector<PrepareStep> steps) {
+    if (steps.empty()) {
+      return true;
+    }
+    std::unordered_map<std::string_view, size_t> index;
+    for (size_t i = 0; i < steps.size(); ++i) {
+      if (not index.emplace(steps[i].name, i).second) {
+        throw AppStateException("prepare step '" + steps[i].name
+                                + "' added twice");
+      }
+    }
+    std::vector<std::vector<size_t>> deps(steps.size());
+    std::vector<std::vector<size_t>> dependents(steps.size());
+    for (size_t i = 0; i < steps.size(); ++i) {
+      for (auto &name : steps[i].after) {
+        auto it = index.find(name);
+        if (it == index.end()) {
+          throw AppStateException("prepare step '" + steps[i].name
+                                  + "' after unknown step '" + name + "'");
+        }
+        deps[i].emplace_back(it->second);
+        dependents[it->second].emplace_back(i);
+      }
+    }
+    // Steps on cycle would wait for each other forever
+    std::vector<size_t> waiting(steps.size());
+    std::vector<size_t> ready;
+    for (size_t i = 0; i < steps.size(); ++i) {
+      waiting[i] = deps[i].size();
+      if (waiting[i] == 0) {
+        ready.emplace_back(i);
+      }
+    }
+    size_t ordered = 0;
+    while (not ready.empty()) {
+      auto i = ready.back();
+      ready.pop_back();
+      ++ordered;
+      for (auto j : dependents[i]) {
+        if (--waiting[j] == 0) {
+          ready.emplace_back(j);
+        }
+      }
+    }
+    if (ordered != steps.size()) {
+      throw AppStateException("prepare steps with cyclic dependencies");
+    }
 
-    auto state = State::Init;
-    if (not state_.compare_exchange_strong(state, State::Prepare)) {
-      if (state != State::ShuttingDown) {
-        throw AppStateException("running stage 'preparing'");
+    enum class Status : uint8_t { Pending, Done, Failed };
+    std::vector<Status> status(steps.size(), Status::Pending);
+    std::vector<PrepareStepTiming> timings(steps.size());
+    std::mutex mutex;
+    std::condition_variable cv;
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    auto since_start = [&](Clock::time_point time) {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(time
+                                                                   - start);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(steps.size());
+    for (size_t i = 0; i < steps.size(); ++i) {
+      threads.emplace_back([&, i] {
+        bool skip = false;
+        {
+          std::unique_lock lock{mutex};
+          cv.wait(lock, [&] {
+            return std::ranges::none_of(deps[i], [&](size_t j) {
+              return status[j] == Status::Pending;
+            });
+          });
+          skip = std::ranges::any_of(
+              deps[i], [&](size_t j) { return status[j] == Status::Failed; });
+        }
+        auto begin = Clock::now();
+        auto success = false;
+        if (skip) {
+          SL_ERROR(logger_,
+                   "Prepare step '{}' is skipped, as step before failed",
+                   steps[i].name);
+        } else {
+          try {
+            success = steps[i].action();
+          } catch (const std::exception &e) {
+            SL_ERROR(logger_,
+                     "Prepare step '{}' thrown: {}",
+                     steps[i].name,
+                     e.what());
+          }
+        }
+        auto end = Clock::now();
+        {
+          std::lock_guard lock{mutex};
+          status[i] = success ? Status::Done : Status::Failed;
+          timings[i] = {
+              .name = steps[i].name,
+              .begin = since_start(begin),
+              .duration = since_start(end) - since_start(begin),
+              .failed = not success,
+          };
+        }
+        cv.notify_all();
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    std::ranges::sort(timings, {}, &PrepareStepTiming::begin);
+    std::chrono::milliseconds total{};
+    for (auto &timing : timings) {
+      total += timing.duration;
+      SL_INFO(logger_,
+              "Prepare step '{}' {} in {}ms, started at +{}ms",
+              timing.name,
+              timing.failed ? "failed" : "done",
+              timing.duration.count(),
+              timing.begin.count());
+    }
+    SL_INFO(logger_,
+            "Prepare steps took {}ms, {}ms one by one",
+            since_start(Clock::now()).count(),
+            total.count());
+    auto success = std::ranges::none_of(
+        status, [](Status status) { return status == Status::Failed; });
+    {
+      std::lock_guard lock{timings_mutex_};
+      prepare_step_timings_ = std::move(timings);
+    }
+    return success;
+  }
+
+  void StateManagerImpl::doPrepare() {
+    std::vector<PrepareStep> steps;
+    {
+      std::lock_guard lg(mutex_);
+      auto state = State::Init;
+      if (not state_.compare_exchange_strong(state, State::Prepare)) {
+        if (state != State::ShuttingDown) {
+          throw AppStateException("running stage 'preparing'");
+        }
       }
+      steps = std::move(prepare_steps_);
+      prepare_steps_.clear();
     }
 
+    // Steps run without lock, so they may register callbacks
+    if (state_ == State::Prepare
+        and not runPrepareSteps(std::move(steps))) {
+      SL_ERROR(logger_, "Stage 'preparing' is failed");
+      auto state = State::Prepare;
+      state_.compare_exchange_strong(state, State::ShuttingDown);
+    }
+
+    std::lock_guard lg(mutex_);
+    auto state = State::Prepare;
+
     if (not prepare_.empty()) {
       SL_TRACE(logger_, "Running stage 'preparing'…");
     }
@@ -223,6 +396,8 @@ namespace lean::app {
     std::queue<OnLaunch> empty_launch;
     std::swap(launch_, empty_launch);
 
+    prepare_steps_.clear();
+
     while (!shutdown_.empty()) {
       auto &cb = shutdown_.front();
       cb();
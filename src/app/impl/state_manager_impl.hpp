@@ -9,6 +9,8 @@
 #include <condition_variable>
 #include <mutex>
 #include <queue>
+#include <string>
+#include <vector>
 
 #include <qtils/shared_ref.hpp>
 
@@ -34,6 +36,10 @@ namespace lean::app {
     ~StateManagerImpl() override;
 
     void atPrepare(OnPrepare &&cb) override;
+    void atPrepareStep(std::string name,
+                       std::vector<std::string> after,
+                       OnPrepare &&cb) override;
+    std::vector<PrepareStepTiming> prepareStepTimings() const override;
     void atLaunch(OnLaunch &&cb) override;
     void atShutdown(OnShutdown &&cb) override;
 
@@ -66,6 +72,16 @@ namespace lean::app {
 
     void shutdownRequestWaiting();
 
+    struct PrepareStep {
+      std::string name;
+      std::vector<std::string> after;
+      OnPrepare action;
+    };
+
+    /// Run named steps concurrently in order of dependencies
+    /// @return false if any step failed
+    bool runPrepareSteps(std::vector<PrepareStep> steps);
+
     qtils::SharedRef<soralog::Logger> logger_;
     qtils::SharedRef<log::LoggingSystem> logging_system_;
 
@@ -77,8 +93,12 @@ namespace lean::app {
     std::condition_variable cv_;
 
     std::queue<OnPrepare> prepare_;
+    std::vector<PrepareStep> prepare_steps_;
     std::queue<OnLaunch> launch_;
     std::queue<OnShutdown> shutdown_;
+
+    mutable std::mutex timings_mutex_;
+    std::vector<PrepareStepTiming> prepare_step_timings_;
   };
 
 }  // namespace lean::app
@@ -7,15 +7,20 @@
 
 #include "timeline_impl.hpp"
 
+#include <cerrno>
+#include <ctime>
 #include <iostream>
 #include <utility>
 
+#include <sys/prctl.h>
+
 #include "app/state_manager.hpp"
 #include "blockchain/block_tree.hpp"
 #include "blockchain/genesis_config.hpp"
 #include "clock/clock.hpp"
 #include "lean_interop_test.hpp"
 #include "log/logger.hpp"
+#include "metrics/metrics.hpp"
 #include "modules/shared/networking_types.tmp.hpp"
 #include "modules/shared/prodution_types.tmp.hpp"
 #include "se/impl/subscription_manager.hpp"
@@ -23,25 +28,52 @@
 #include "se/subscription_fwd.hpp"
 #include "types/config.hpp"
 #include "types/constants.hpp"
+#include "utils/thread_placement.hpp"
 
 namespace lean::app {
+  namespace {
+    std::chrono::nanoseconds realtimeNow() {
+      timespec now{};
+      ::clock_gettime(CLOCK_REALTIME, &now);
+      return std::chrono::seconds{now.tv_sec}
+           + std::chrono::nanoseconds{now.tv_nsec};
+    }
+
+    /// Sleep to absolute time, not early regardless of scheduling delays
+    void sleepUntil(std::chrono::nanoseconds deadline) {
+      auto seconds = std::chrono::floor<std::chrono::seconds>(deadline);
+      timespec time{
+          .tv_sec = static_cast<time_t>(seconds.count()),
+          .tv_nsec = static_cast<long>((deadline - seconds).count()),
+      };
+      while (::clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &time, nullptr)
+             == EINTR) {
+      }
+    }
+  }  // namespace
 
   TimelineImpl::TimelineImpl(qtils::SharedRef<log::LoggingSystem> logsys,
                              qtils::SharedRef<StateManager> state_manager,
                              qtils::SharedRef<Subscription> se_manager,
                              qtils::SharedRef<clock::SystemClock> clock,
                              qtils::SharedRef<GenesisConfig> config,
-                             qtils::SharedRef<blockchain::BlockTree> block_tree)
+                             qtils::SharedRef<blockchain::BlockTree> block_tree,
+                             qtils::SharedRef<metrics::Metrics> metrics)
       : logger_(logsys->getLogger("Timeline", "application")),
         digest_(logsys->getLogger("Digest", "digest")),
         state_manager_(std::move(state_manager)),
         genesis_config_(std::move(config)),
         clock_(std::move(clock)),
         se_manager_(std::move(se_manager)),
-        block_tree_(std::move(block_tree)) {
+        block_tree_(std::move(block_tree)),
+        metrics_(std::move(metrics)) {
     state_manager_->takeControl(*this);
   }
 
+  TimelineImpl::~TimelineImpl() {
+    stop();
+  }
+
   void TimelineImpl::prepare() {
     on_slot_interval_started_ = se::SubscriberCreator<
         qtils::Empty,
@@ -56,7 +88,7 @@ namespace lean::app {
     on_peers_total_count_updated_ = se::SubscriberCreator<
         qtils::Empty,
         std::shared_ptr<const messages::PeerCountsMessage>>::
-        create<EventTypes::PeerCountsUpdated>(
+        createLatestWins<EventTypes::PeerCountsUpdated>(
             *se_manager_,
             SubscriptionEngineHandlers::kTest,
             [this](auto &,
@@ -66,25 +98,67 @@ namespace lean::app {
   }
 
   void TimelineImpl::start() {
-    auto now = clock_->nowMsec();
-    waitNextInterval(now, Interval::fromTime(now, *genesis_config_));
+    tick_thread_ = std::thread{[this] {
+      setThreadName("tick");
+      runTicks();
+    }};
   }
 
   void TimelineImpl::stop() {
-    stopped_ = true;
+    {
+      std::lock_guard lock{tick_mutex_};
+      stopped_ = true;
+    }
+    tick_cv_.notify_one();
+    if (tick_thread_.joinable()) {
+      tick_thread_.join();
+    }
   }
 
-  void TimelineImpl::waitNextInterval(std::chrono::milliseconds now,
-                                      std::optional<Interval> interval) {
-    Interval next_interval{
+  void TimelineImpl::runTicks() {
+    // Default timer slack of 50us would delay each wake up
+    ::prctl(PR_SET_TIMERSLACK, 1);
+    auto interval = Interval::fromTime(clock_->nowMsec(), *genesis_config_);
+    Interval next{
         .interval = interval.has_value() ? interval->interval + 1 : 0,
     };
-    auto time_to_next_slot = next_interval.time(*genesis_config_) - now;
-    time_to_next_slot = std::max(time_to_next_slot.zero(), time_to_next_slot);
-    se_manager_->notifyDelayed(
-        time_to_next_slot,
-        EventTypes::SlotIntervalStarted,
-        std::make_shared<const messages::SlotIntervalStarted>(next_interval));
+    while (true) {
+      // Deadline is computed from genesis time for each interval, so
+      // wake up delays don't accumulate
+      std::chrono::nanoseconds deadline = next.time(*genesis_config_);
+      {
+        std::unique_lock lock{tick_mutex_};
+        tick_cv_.wait_until(
+            lock,
+            std::chrono::sys_time<std::chrono::nanoseconds>{deadline
+                                                            - kPreciseSleep},
+            [&] { return stopped_; });
+        if (stopped_) {
+          SL_INFO(logger_, "Timeline is stopped on slot {}", next.slot());
+          return;
+        }
+      }
+      sleepUntil(deadline);
+      auto now = realtimeNow();
+      metrics_->app_tick_jitter()->observe(
+          std::chrono::duration<double>(now - deadline).count());
+      se_manager_->notify(
+          EventTypes::SlotIntervalStarted,
+          std::make_shared<const messages::SlotIntervalStarted>(next));
+
+      // After suspend, intervals which are over are not ticked one by one,
+      // fork choice catches up by time
+      ++next.interval;
+      auto current = Interval::fromTime(
+          std::chrono::duration_cast<std::chrono::milliseconds>(now),
+          *genesis_config_);
+      if (current.has_value() and current->interval > next.interval) {
+        SL_WARN(logger_,
+                "Tick is late, skip {} intervals",
+                current->interval - next.interval);
+        next = current.value();
+      }
+    }
   }
 
   void TimelineImpl::printSlot(Interval interval) {
@@ -157,13 +231,5 @@ namespace lean::app {
     if (msg->interval.phase() == 1) {
       printSlot(msg->interval);
     }
-
-    if (stopped_) [[unlikely]] {
-      SL_INFO(logger_, "Timeline is stopped on slot {}", msg->interval.slot());
-      return;
-    }
-
-    auto now = clock_->nowMsec();
-    waitNextInterval(now, msg->interval);
   }
 }  // namespace lean::app
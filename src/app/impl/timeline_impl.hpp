@@ -6,6 +6,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 
 #include <qtils/empty.hpp>
@@ -31,6 +36,9 @@ namespace lean::blockchain {
 namespace lean::clock {
   class SystemClock;
 }
+namespace lean::metrics {
+  class Metrics;
+}
 namespace soralog {
   class Logger;
 }
@@ -41,22 +49,34 @@ namespace lean::app {
 
 namespace lean::app {
 
+  /**
+   * Publishes `SlotIntervalStarted` from own `tick` thread, which sleeps to
+   * absolute realtime deadline of each interval derived from genesis time.
+   * Scheduling delays don't accumulate, and interval starts are accurate to
+   * timer slack, unless thread isn't scheduled; `threads.tick` placement
+   * may give it realtime priority.
+   */
   class TimelineImpl final : public Timeline {
    public:
+    /// Last part of wait is slept with `clock_nanosleep`, not interruptible
+    static constexpr std::chrono::milliseconds kPreciseSleep{2};
+
     TimelineImpl(qtils::SharedRef<log::LoggingSystem> logsys,
                  qtils::SharedRef<StateManager> state_manager,
                  qtils::SharedRef<Subscription> se_manager,
                  qtils::SharedRef<clock::SystemClock> clock,
                  qtils::SharedRef<GenesisConfig> config,
-                 qtils::SharedRef<blockchain::BlockTree> block_tree);
+                 qtils::SharedRef<blockchain::BlockTree> block_tree,
+                 qtils::SharedRef<metrics::Metrics> metrics);
+
+    ~TimelineImpl();
 
     void prepare();
     void start();
     void stop();
 
    private:
-    void waitNextInterval(std::chrono::milliseconds now,
-                          std::optional<Interval> interval);
+    void runTicks();
     void printSlot(Interval interval);
     void on_slot_interval_started(
         std::shared_ptr<const messages::SlotIntervalStarted> msg);
@@ -68,10 +88,14 @@ namespace lean::app {
     qtils::SharedRef<clock::SystemClock> clock_;
     qtils::SharedRef<Subscription> se_manager_;
     qtils::SharedRef<blockchain::BlockTree> block_tree_;
+    qtils::SharedRef<metrics::Metrics> metrics_;
 
     std::unordered_map<std::string, size_t> connected_peers_;
 
+    std::mutex tick_mutex_;
+    std::condition_variable tick_cv_;
     bool stopped_ = false;
+    std::thread tick_thread_;
 
     std::shared_ptr<
         BaseSubscriber<qtils::Empty,
@@ -0,0 +1,285 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "app/impl/validator_client.hpp"
+
+#include <format>
+#include <ranges>
+#include <vector>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/http/write.hpp>
+
+#include "app/configuration.hpp"
+#include "app/state_manager.hpp"
+#include "app/validator_keys_manifest.hpp"
+#include "blockchain/validator_registry.hpp"
+#include "crypto/xmss/xmss_provider.hpp"
+#include "serde/serialization.hpp"
+#include "types/state.hpp"
+#include "utils/hex.hpp"
+#include "utils/thread_placement.hpp"
+
+namespace lean::app {
+  constexpr std::string_view kEventsTarget = "/lean/v0/validator/events";
+  constexpr std::string_view kAttestationsTarget =
+      "/lean/v0/validator/attestations";
+
+  ValidatorClient::ValidatorClient(
+      qtils::SharedRef<log::LoggingSystem> logsys,
+      qtils::SharedRef<StateManager> state_manager,
+      qtils::SharedRef<const Configuration> app_config,
+      qtils::SharedRef<ValidatorRegistry> validator_registry,
+      qtils::SharedRef<ValidatorKeysManifest> validator_keys_manifest,
+      qtils::SharedRef<crypto::xmss::XmssProvider> xmss_provider,
+      qtils::SharedRef<AnchorState> anchor_state)
+      : log_{logsys->getLogger("ValidatorClient", "validator")},
+        state_manager_{std::move(state_manager)},
+        endpoint_{app_config->apiEndpoint()},
+        validator_registry_{std::move(validator_registry)},
+        validator_keys_manifest_{std::move(validator_keys_manifest)},
+        xmss_provider_{std::move(xmss_provider)},
+        anchor_state_{std::move(anchor_state)} {
+    state_manager_->takeControl(*this);
+  }
+
+  ValidatorClient::~ValidatorClient() {
+    stop();
+  }
+
+  void ValidatorClient::run() {
+    state_manager_->run();
+  }
+
+  void ValidatorClient::start() {
+    SL_INFO(log_,
+            "Validator client of node {}:{}, {} validators",
+            endpoint_.address().to_string(),
+            endpoint_.port(),
+            validator_registry_->currentValidatorIndices().size());
+    boost::asio::post(io_context_,
+                      [weak_self{weak_from_this()}] {
+                        if (auto self = weak_self.lock()) {
+                          self->connect();
+                        }
+                      });
+    io_thread_ = std::thread{[this] {
+      setThreadName("validator");
+      auto work_guard = boost::asio::make_work_guard(io_context_);
+      io_context_.run();
+    }};
+  }
+
+  void ValidatorClient::stop() {
+    io_context_.stop();
+    if (io_thread_.joinable()) {
+      io_thread_.join();
+    }
+  }
+
+  void ValidatorClient::connect() {
+    header_.clear();
+    header_done_ = false;
+    parser_ = {};
+    socket_.async_connect(
+        endpoint_,
+        [weak_self{weak_from_this()}](boost::system::error_code ec) {
+          auto self = weak_self.lock();
+          if (not self) {
+            return;
+          }
+          if (ec) {
+            SL_WARN(self->log_, "Can't connect to node: {}", ec.message());
+            self->reconnect();
+            return;
+          }
+          auto request = std::make_shared<std::string>(
+              std::format("GET {} HTTP/1.1\r\nHost: {}\r\n"
+                          "Accept: text/event-stream\r\n\r\n",
+                          kEventsTarget,
+                          self->endpoint_.address().to_string()));
+          boost::asio::async_write(
+              self->socket_,
+              boost::asio::buffer(*request),
+              [weak_self, request](boost::system::error_code ec, size_t) {
+                auto self = weak_self.lock();
+                if (not self) {
+                  return;
+                }
+                if (ec) {
+                  self->reconnect();
+                  return;
+                }
+                self->readEvents();
+              });
+        });
+  }
+
+  void ValidatorClient::reconnect() {
+    boost::system::error_code ec;
+    socket_.close(ec);
+    reconnect_timer_.expires_after(kReconnectDelay);
+    reconnect_timer_.async_wait(
+        [weak_self{weak_from_this()}](boost::system::error_code ec) {
+          if (auto self = weak_self.lock(); self and not ec) {
+            self->connect();
+          }
+        });
+  }
+
+  void ValidatorClient::readEvents() {
+    socket_.async_read_some(
+        boost::asio::buffer(read_buffer_),
+        [weak_self{weak_from_this()}](boost::system::error_code ec,
+                                      size_t size) {
+          auto self = weak_self.lock();
+          if (not self) {
+            return;
+          }
+          if (ec) {
+            SL_WARN(self->log_, "Events of node closed: {}", ec.message());
+            self->reconnect();
+            return;
+          }
+          std::string_view bytes{self->read_buffer_.data(), size};
+          if (not self->header_done_) {
+            self->header_.append(bytes);
+            auto end = self->header_.find("\r\n\r\n");
+            if (end == std::string::npos) {
+              self->readEvents();
+              return;
+            }
+            if (not self->header_.starts_with("HTTP/1.1 200")) {
+              SL_WARN(self->log_,
+                      "Node doesn't serve validator events: {}",
+                      self->header_.substr(0, self->header_.find('\r')));
+              self->reconnect();
+              return;
+            }
+            SL_INFO(self->log_, "Connected to node");
+            self->header_done_ = true;
+            bytes = std::string_view{self->header_}.substr(end + 4);
+          }
+          for (auto &event : self->parser_.feed(bytes)) {
+            self->onEvent(event);
+          }
+          self->readEvents();
+        });
+  }
+
+  void ValidatorClient::onEvent(const http::Event &event) {
+    if (event.event != "attestation_data") {
+      SL_TRACE(log_, "Event {} {}", event.event, event.data);
+      return;
+    }
+    std::string_view hex{event.data};
+    if (hex.starts_with("0x")) {
+      hex.remove_prefix(2);
+    }
+    qtils::ByteVec ssz(hex.size() / 2);
+    if (not hexDecode(hex, ssz)) {
+      SL_WARN(log_, "Invalid attestation data event {}", event.data);
+      return;
+    }
+    auto data = decode<AttestationData>(ssz);
+    if (not data.has_value()) {
+      SL_WARN(log_, "Invalid attestation data: {}", data.error());
+      return;
+    }
+    attest(data.value());
+  }
+
+  void ValidatorClient::attest(const AttestationData &data) {
+    if (attested_slot_.has_value() and data.slot <= *attested_slot_) {
+      SL_WARN(log_, "Slot {} is attested already", data.slot);
+      return;
+    }
+    attested_slot_ = data.slot;
+
+    auto &validators = anchor_state_->validators.data();
+    std::vector<ValidatorIndex> signers;
+    std::vector<crypto::xmss::XmssSignItem> sign_items;
+    auto payload = sszHash(data);
+    for (auto validator_index :
+         validator_registry_->currentValidatorIndices()) {
+      if (validator_index >= validators.size()) {
+        continue;
+      }
+      auto keypair = validator_keys_manifest_->getKeypair(
+          validators.at(validator_index).attestation_pubkey);
+      if (not keypair.has_value()) {
+        continue;
+      }
+      signers.emplace_back(validator_index);
+      sign_items.emplace_back(crypto::xmss::XmssSignItem{
+          .private_key = keypair->private_key,
+          .epoch = static_cast<uint32_t>(data.slot),
+          .message = payload,
+      });
+    }
+    auto signatures = xmss_provider_->signBatch(sign_items);
+    for (auto &&[validator_index, signature] :
+         std::views::zip(signers, signatures)) {
+      SignedAttestation signed_attestation{
+          .validator_id = validator_index,
+          .data = data,
+          .signature = signature,
+      };
+      if (auto res = submit(signed_attestation); res.has_error()) {
+        SL_WARN(log_,
+                "Attestation of validator {} for slot {} not submitted: {}",
+                validator_index,
+                data.slot,
+                res.error());
+        continue;
+      }
+      SL_DEBUG(log_,
+               "Attested slot {} by validator {}, target={}",
+               data.slot,
+               validator_index,
+               data.target);
+    }
+  }
+
+  outcome::result<void> ValidatorClient::submit(
+      const SignedAttestation &signed_attestation) {
+    namespace http = boost::beast::http;
+    OUTCOME_TRY(ssz, encode(signed_attestation));
+    // Own connection, events stream stays open
+    boost::asio::ip::tcp::socket socket{io_context_};
+    boost::system::error_code ec;
+    socket.connect(endpoint_, ec);
+    if (ec) {
+      return std::error_code{ec};
+    }
+    http::request<http::string_body> request{
+        http::verb::post, kAttestationsTarget, 11};
+    request.set(http::field::host, endpoint_.address().to_string());
+    request.set(http::field::content_type, "application/octet-stream");
+    request.body().assign(ssz.begin(), ssz.end());
+    request.prepare_payload();
+    http::write(socket, request, ec);
+    if (ec) {
+      return std::error_code{ec};
+    }
+    boost::beast::flat_buffer buffer;
+    http::response<http::string_body> response;
+    http::read(socket, buffer, response, ec);
+    if (ec) {
+      return std::error_code{ec};
+    }
+    if (response.result() != http::status::ok) {
+      SL_WARN(log_, "Node rejected attestation: {}", response.body());
+      return std::make_error_code(std::errc::invalid_argument);
+    }
+    return outcome::success();
+  }
+}  // namespace lean::app
@@ -0,0 +1,103 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <qtils/shared_ref.hpp>
+
+#include "log/logger.hpp"
+#include "types/attestation_data.hpp"
+#include "types/signed_attestation.hpp"
+#include "utils/http.hpp"
+
+namespace lean {
+  class ValidatorRegistry;
+  struct AnchorState;
+}  // namespace lean
+
+namespace lean::crypto::xmss {
+  class XmssProvider;
+}  // namespace lean::crypto::xmss
+
+namespace lean::app {
+  class Configuration;
+  class StateManager;
+  class ValidatorKeysManifest;
+
+  /**
+   * Validator process, `--validator-client`: holds XMSS keys of validators
+   * and signs their attestations, while node at `--api-host`/`--api-port`
+   * runs networking and fork choice.
+   *
+   * Node pushes "attestation_data" event to `/lean/v0/validator/events`
+   * in interval 1, as SSZ hex, and client posts SSZ signed attestation of
+   * each of its validators to `/lean/v0/validator/attestations`.
+   * Node verifies and gossips them like gossip of other peers.
+   *
+   * Validators and keys are those of `--node-id` of client in genesis, so
+   * node with other id doesn't sign for them too. Blocks are proposed by
+   * nodes only, validators of client only attest.
+   */
+  class ValidatorClient : public std::enable_shared_from_this<ValidatorClient> {
+   public:
+    /// Events stream is reconnected this long after it is closed
+    static constexpr std::chrono::seconds kReconnectDelay{1};
+
+    ValidatorClient(
+        qtils::SharedRef<log::LoggingSystem> logsys,
+        qtils::SharedRef<StateManager> state_manager,
+        qtils::SharedRef<const Configuration> app_config,
+        qtils::SharedRef<ValidatorRegistry> validator_registry,
+        qtils::SharedRef<ValidatorKeysManifest> validator_keys_manifest,
+        qtils::SharedRef<crypto::xmss::XmssProvider> xmss_provider,
+        qtils::SharedRef<AnchorState> anchor_state);
+    ~ValidatorClient();
+
+    /// Sign until SIGINT or SIGTERM
+    void run();
+
+    void start();
+    void stop();
+
+   private:
+    void connect();
+    void reconnect();
+    void readEvents();
+    void onEvent(const http::Event &event);
+    /// Sign data by all validators, once per slot
+    void attest(const AttestationData &data);
+    outcome::result<void> submit(const SignedAttestation &signed_attestation);
+
+    log::Logger log_;
+    qtils::SharedRef<StateManager> state_manager_;
+    boost::asio::ip::tcp::endpoint endpoint_;
+    qtils::SharedRef<ValidatorRegistry> validator_registry_;
+    qtils::SharedRef<ValidatorKeysManifest> validator_keys_manifest_;
+    qtils::SharedRef<crypto::xmss::XmssProvider> xmss_provider_;
+    qtils::SharedRef<AnchorState> anchor_state_;
+    boost::asio::io_context io_context_;
+    boost::asio::ip::tcp::socket socket_{io_context_};
+    boost::asio::steady_timer reconnect_timer_{io_context_};
+    std::array<char, 4096> read_buffer_{};
+    /// Response header of events stream, until it is complete
+    std::string header_;
+    bool header_done_ = false;
+    http::EventParser parser_;
+    /// XMSS key can't sign two messages for one slot
+    std::optional<Slot> attested_slot_;
+    std::thread io_thread_;
+  };
+}  // namespace lean::app
@@ -7,12 +7,19 @@
 #include "app/impl/validator_keys_manifest_impl.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <exception>
 #include <filesystem>
-#include <ranges>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
 
 #include "app/configuration.hpp"
+#include "app/state_manager.hpp"
+#include "crypto/xmss/xmss_keystore.hpp"
 #include "crypto/xmss/xmss_provider_fake.hpp"
 #include "crypto/xmss/xmss_util.hpp"
 #include "executable/qlean_enable_shadow.hpp"
@@ -20,44 +27,112 @@
 
 namespace lean::app {
   ValidatorKeysManifestImpl::ValidatorKeysManifestImpl(
-      const Configuration &config) {
+      const Configuration &config,
+      qtils::SharedRef<StateManager> state_manager)
+      : keys_dir_{config.genesisDir() / "hash-sig-keys"} {
     auto yaml = yaml::read(config.genesisDir() / "annotated_validators.yaml");
     auto yaml_items = yaml.map(config.nodeId());
     for (auto &&yaml_item : yaml_items.list()) {
       auto yaml_pubkey_hex = yaml_item.map("pubkey_hex");
-      auto public_key =
+      auto &entry = entries_.emplace_back();
+      entry.public_key =
           crypto::xmss::XmssPublicKey::fromHex(yaml_pubkey_hex.str()).value();
-      auto privkey_file = yaml_item.map("privkey_file").str();
-      crypto::xmss::XmssKeypair keypair;
+      entry.privkey_file = yaml_item.map("privkey_file").str();
+      index_.emplace(entry.public_key, &entry);
+    }
+
+    auto &keys_config = config.validatorKeys();
+    if (keys_config.keystore.has_value() and not QLEAN_ENABLE_SHADOW) {
+      keystore_ = crypto::xmss::XmssKeystore::open(*keys_config.keystore)
+                      .value();
+      for (auto &entry : entries_) {
+        if (not keystore_->contains(entry.public_key)) {
+          throw std::runtime_error{fmt::format(
+              "Validator key {} not found in keystore {}",
+              entry.public_key.toHex(),
+              keys_config.keystore->string())};
+        }
+      }
+    }
+
+    if (not keys_config.lazy) {
+      state_manager->atPrepareStep("load keys", {}, [this] { loadAll(); });
+    } else if (not keystore_ and not QLEAN_ENABLE_SHADOW) {
+      // Missing file is reported on start, not on first use of key
+      for (auto &entry : entries_) {
+        auto path = keys_dir_ / entry.privkey_file;
+        if (not std::filesystem::exists(path)) {
+          throw std::runtime_error{
+              fmt::format("Validator key file {} not found", path.string())};
+        }
+      }
+    }
+  }
+
+  ValidatorKeysManifestImpl::~ValidatorKeysManifestImpl() = default;
+
+  const crypto::xmss::XmssKeypair &ValidatorKeysManifestImpl::load(
+      const Entry &entry) const {
+    std::call_once(entry.loaded, [&] {
       if constexpr (QLEAN_ENABLE_SHADOW) {
-        keypair = crypto::xmss::XmssProviderFake::loadKeypair(public_key,
-                                                              privkey_file);
+        entry.keypair = crypto::xmss::XmssProviderFake::loadKeypair(
+            entry.public_key, entry.privkey_file);
+      } else if (keystore_) {
+        entry.keypair = keystore_->load(entry.public_key).value();
       } else {
-        keypair = crypto::xmss::loadKeypair(
-                      public_key,
-                      config.genesisDir() / "hash-sig-keys" / privkey_file)
-                      .value();
+        entry.keypair = crypto::xmss::loadKeypair(
+                            entry.public_key, keys_dir_ / entry.privkey_file)
+                            .value();
       }
-      validator_keys_.emplace(public_key, keypair);
+    });
+    return *entry.keypair;
+  }
+
+  void ValidatorKeysManifestImpl::loadAll() const {
+    auto threads = std::min<size_t>(
+        entries_.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::atomic_size_t next = 0;
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    {
+      std::vector<std::jthread> workers;
+      workers.reserve(threads);
+      for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back([&] {
+          for (auto j = next++; j < entries_.size(); j = next++) {
+            try {
+              load(entries_[j]);
+            } catch (...) {
+              std::lock_guard lock{error_mutex};
+              if (not error) {
+                error = std::current_exception();
+              }
+            }
+          }
+        });
+      }
+    }
+    if (error) {
+      std::rethrow_exception(error);
     }
   }
 
   std::optional<crypto::xmss::XmssKeypair>
   ValidatorKeysManifestImpl::getKeypair(
       const crypto::xmss::XmssPublicKey &public_key) const {
-    auto it = validator_keys_.find(public_key);
-    if (it == validator_keys_.end()) {
+    auto it = index_.find(public_key);
+    if (it == index_.end()) {
       return std::nullopt;
     }
-    return it->second;
+    return load(*it->second);
   }
 
   std::vector<crypto::xmss::XmssPublicKey>
   ValidatorKeysManifestImpl::getAllXmssPubkeys() const {
     std::vector<crypto::xmss::XmssPublicKey> pubkeys;
-    pubkeys.reserve(validator_keys_.size());
-    for (const auto &pubkey : validator_keys_ | std::views::keys) {
-      pubkeys.push_back(pubkey);
+    pubkeys.reserve(entries_.size());
+    for (const auto &entry : entries_) {
+      pubkeys.push_back(entry.public_key);
     }
     return pubkeys;
   }
@@ -6,14 +6,39 @@
 
 #pragma once
 
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+#include <qtils/shared_ref.hpp>
+
 #include "app/configuration.hpp"
 #include "app/validator_keys_manifest.hpp"
 
+namespace lean::crypto::xmss {
+  class XmssKeystore;
+}  // namespace lean::crypto::xmss
+
 namespace lean::app {
+  class StateManager;
 
+  /**
+   * Public keys are read from manifest on construction. Private keys are
+   * loaded in parallel by prepare step "load keys", concurrently with other
+   * startup work, or each on first request of its keypair before it.
+   *
+   * In lazy mode there is no prepare step, and key is loaded only on first
+   * request. Keys are read from keystore instead of key files, if it is
+   * configured.
+   */
   class ValidatorKeysManifestImpl : public ValidatorKeysManifest {
    public:
-    explicit ValidatorKeysManifestImpl(const Configuration &config);
+    ValidatorKeysManifestImpl(const Configuration &config,
+                              qtils::SharedRef<StateManager> state_manager);
+    ~ValidatorKeysManifestImpl() override;
 
     [[nodiscard]] std::optional<crypto::xmss::XmssKeypair> getKeypair(
         const crypto::xmss::XmssPublicKey &public_key) const override;
@@ -22,7 +47,23 @@ namespace lean::app {
         const override;
 
    private:
-    std::unordered_map<crypto::xmss::XmssPublicKey, crypto::xmss::XmssKeypair>
-        validator_keys_;
+    struct Entry {
+      crypto::xmss::XmssPublicKey public_key;
+      std::string privkey_file;
+      mutable std::once_flag loaded;
+      mutable std::optional<crypto::xmss::XmssKeypair> keypair;
+    };
+
+    /// Load private key of entry once
+    const crypto::xmss::XmssKeypair &load(const Entry &entry) const;
+
+    /// Load all private keys, by several threads
+    void loadAll() const;
+
+    std::filesystem::path keys_dir_;
+    std::unique_ptr<crypto::xmss::XmssKeystore> keystore_;
+    /// Deque keeps address of entries, which are not movable
+    std::deque<Entry> entries_;
+    std::unordered_map<crypto::xmss::XmssPublicKey, const Entry *> index_;
   };
 }  // namespace lean::app
@@ -7,12 +7,15 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <ranges>
 #include <sstream>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include <boost/asio/io_context.hpp>
 #include <fmt/format.h>
@@ -21,6 +24,8 @@
 #include "app/configuration.hpp"
 #include "injector/dont_inject.hpp"
 #include "log/logger.hpp"
+#include "metrics/metrics.hpp"
+#include "utils/thread_stack.hpp"
 
 namespace soralog {
   class Logger;
@@ -68,17 +73,37 @@ namespace lean {
 
   constexpr auto kWatchdogDefaultTimeout = std::chrono::minutes{15};
 
+  /// Time stalled thread has to respond with its stack
+  constexpr std::chrono::milliseconds kStackCaptureTimeout{100};
+
+  /**
+   * Detects stuck threads and measures lag of event loops.
+   *
+   * Threads pinging with `add` are aborted after timeout without ping.
+   *
+   * Loops registered with `watch` get probe task posted every probe interval,
+   * delay from post to run is exported as loop lag histogram. When probe
+   * stays queued longer than stall threshold, stack of loop thread which ran
+   * previous probe is logged once per stall. It is the stalled thread for
+   * single threaded loops.
+   */
   class Watchdog {
    public:
     using Count = uint32_t;
     using Atomic = std::atomic<Count>;
     using Clock = std::chrono::steady_clock;
     using Timeout = std::chrono::seconds;
+    /// Posts task to event loop
+    using Post = std::function<void(std::function<void()>)>;
 
     Watchdog(std::shared_ptr<log::LoggingSystem> logsys,
-             std::shared_ptr<app::Configuration> config)
+             std::shared_ptr<app::Configuration> config,
+             std::shared_ptr<metrics::Metrics> metrics)
         : logger_(logsys->getLogger("Watchdog", "threads")),
-          granularity_(1 /*config->granularity()*/) {
+          granularity_(1 /*config->granularity()*/),
+          probe_interval_{config->watchdog().probe_interval},
+          stall_threshold_{config->watchdog().stall_threshold},
+          metrics_{std::move(metrics)} {
       // BOOST_ASSERT(granularity != granularity.zero());
     }
 
@@ -92,9 +117,54 @@ namespace lean {
 
     void checkLoop(Timeout timeout) {
       // or `io_context` with timer
+      auto probed = Clock::now();
       while (not stopped_) {
         std::this_thread::sleep_for(granularity_);
         check(timeout);
+        if (Clock::now() - probed >= probe_interval_) {
+          probed = Clock::now();
+          probe();
+        }
+      }
+    }
+
+    /// Measure lag of event loop, `name` labels lag histogram
+    void watch(std::string name, Post post) {
+      auto loop = std::make_shared<Loop>();
+      loop->lag = metrics_->app_loop_lag({{"thread", name}});
+      loop->name = std::move(name);
+      loop->post = std::move(post);
+      std::unique_lock lock{mutex_};
+      loops_.emplace_back(std::move(loop));
+    }
+
+    // periodic probe of watched loops
+    void probe() {
+      std::vector<std::shared_ptr<Loop>> loops;
+      {
+        std::unique_lock lock{mutex_};
+        loops = loops_;
+      }
+      const auto now = Clock::now();
+      for (auto &loop : loops) {
+        if (loop->pending.load()) {
+          auto lag = now - loop->posted;
+          if (stall_threshold_ != stall_threshold_.zero()
+              and lag >= stall_threshold_ and not loop->stall_logged) {
+            loop->stall_logged = true;
+            logStall(*loop, lag);
+          }
+          continue;
+        }
+        loop->posted = now;
+        loop->stall_logged = false;
+        loop->pending = true;
+        loop->post([loop] {
+          auto lag = Clock::now() - loop->posted;
+          loop->lag->observe(std::chrono::duration<double>(lag).count());
+          loop->platform_id = getPlatformThreadId();
+          loop->pending = false;
+        });
       }
     }
 
@@ -142,6 +212,21 @@ namespace lean {
       return Ping{thread.count};
     }
 
+    /// Names of registered threads and watched loops by platform id
+    std::unordered_map<uint64_t, std::string> threadNames() {
+      std::unordered_map<uint64_t, std::string> names;
+      std::unique_lock lock{mutex_};
+      for (auto &thread : threads_ | std::views::values) {
+        names.emplace(thread.platform_id, thread.name);
+      }
+      for (auto &loop : loops_) {
+        if (auto platform_id = loop->platform_id.load(); platform_id != 0) {
+          names.emplace(platform_id, loop->name);
+        }
+      }
+      return names;
+    }
+
     void run(std::shared_ptr<boost::asio::io_context> io) {
       auto ping = add();
       while (not stopped_ and io.use_count() != 1) {
@@ -169,6 +254,45 @@ namespace lean {
     }
 
    private:
+    struct Loop {
+      std::string name;
+      Post post;
+      metrics::Histogram *lag = nullptr;
+      /// Written before post, read by probe
+      Clock::time_point posted;
+      std::atomic_bool pending = false;
+      /// Thread which ran last probe, zero before first one
+      std::atomic_uint64_t platform_id = 0;
+      /// Accessed by watchdog thread only
+      bool stall_logged = false;
+    };
+
+    void logStall(const Loop &loop, Clock::duration lag) {
+      auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(lag);
+      auto platform_id = loop.platform_id.load();
+      auto stack = platform_id != 0
+                     ? captureThreadStack(platform_id, kStackCaptureTimeout)
+                     : std::nullopt;
+      if (not stack.has_value()) {
+        SL_WARN(logger_,
+                "Loop {} stalled for {}ms, stack not captured",
+                loop.name,
+                ms.count());
+        return;
+      }
+      std::string frames;
+      for (auto &frame : stack.value()) {
+        frames += "\n  ";
+        frames += frame;
+      }
+      SL_WARN(logger_,
+              "Loop {} stalled for {}ms, thread platform_id={} stack:{}",
+              loop.name,
+              ms.count(),
+              platform_id,
+              frames);
+    }
+
     struct Thread {
       Clock::time_point last_time;
       Count last_count = 0;
@@ -179,8 +303,12 @@ namespace lean {
 
     std::shared_ptr<soralog::Logger> logger_;
     std::chrono::milliseconds granularity_;
+    std::chrono::milliseconds probe_interval_;
+    std::chrono::milliseconds stall_threshold_;
+    std::shared_ptr<metrics::Metrics> metrics_;
     std::mutex mutex_;
     std::unordered_map<std::thread::id, Thread> threads_;
+    std::vector<std::shared_ptr<Loop>> loops_;
     std::atomic_bool stopped_ = false;
   };
 }  // namespace lean
@@ -6,10 +6,12 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace lean::app {
 
@@ -69,6 +71,16 @@ namespace lean::app {
       ReadyToStop,
     };
 
+    /// Time taken by named prepare step
+    struct PrepareStepTiming {
+      std::string name;
+      /// Since start of stage 'preparations'
+      std::chrono::milliseconds begin;
+      std::chrono::milliseconds duration;
+      /// Step failed, or was skipped as step it depends on failed
+      bool failed = false;
+    };
+
     virtual ~StateManager() = default;
 
     /**
@@ -77,6 +89,19 @@ namespace lean::app {
      */
     virtual void atPrepare(OnPrepare &&cb) = 0;
 
+    /**
+     * @brief Execute {@param cb} at stage 'preparations' of application,
+     * concurrently with other named steps. Runs after steps named in
+     * {@param after} succeeded, and before unnamed callbacks.
+     * @param name unique name of step, e.g. "load keys"
+     */
+    virtual void atPrepareStep(std::string name,
+                               std::vector<std::string> after,
+                               OnPrepare &&cb) = 0;
+
+    /// Timings of named prepare steps, when stage 'preparations' is done
+    virtual std::vector<PrepareStepTiming> prepareStepTimings() const = 0;
+
     /**
      * @brief Execute {@param cb} immediately before start application
      * @param cb
@@ -0,0 +1,61 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+
+#include "types/block_hash.hpp"
+#include "types/slot.hpp"
+#include "types/state.hpp"
+
+namespace lean {
+  /**
+   * Head state advanced by `STF::processSlots` ahead of next slot, so its
+   * state root is cached in background instead of on block import and
+   * production critical path.
+   * Only latest advanced state is kept, as only head is advanced.
+   * Thread safe.
+   */
+  class AdvancedStateCache {
+   public:
+    void put(const BlockHash &parent_root,
+             std::shared_ptr<const State> state) {
+      std::lock_guard lock{mutex_};
+      parent_root_ = parent_root;
+      state_ = std::move(state);
+    }
+
+    /**
+     * State of `parent_root` advanced to slot not after `slot`.
+     * Advancing it further only updates slot, as state root is cached by
+     * first processed slot.
+     * @return nullptr if not advanced
+     */
+    std::shared_ptr<const State> get(const BlockHash &parent_root,
+                                     Slot slot) const {
+      std::lock_guard lock{mutex_};
+      if (state_ == nullptr or parent_root_ != parent_root
+          or state_->slot > slot) {
+        return nullptr;
+      }
+      return state_;
+    }
+
+    /// Whether state of `parent_root` is advanced to `slot` already
+    bool contains(const BlockHash &parent_root, Slot slot) const {
+      std::lock_guard lock{mutex_};
+      return state_ != nullptr and parent_root_ == parent_root
+             and state_->slot == slot;
+    }
+
+   private:
+    mutable std::mutex mutex_;
+    BlockHash parent_root_;
+    std::shared_ptr<const State> state_;
+  };
+}  // namespace lean
@@ -0,0 +1,95 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "types/hash.hpp"
+#include "types/slot.hpp"
+#include "types/validator_index.hpp"
+
+namespace lean {
+  /**
+   * Split of aggregation between aggregators of subnet.
+   *
+   * Aggregators of each attestation data group are ranked by rendezvous
+   * hashing of (slot, data root, aggregator validator index), so all nodes
+   * agree on ranks without coordination, and only groups of aggregator
+   * which joins or leaves move. Aggregator of rank 0 aggregates group in
+   * interval 2. Aggregator of rank 1 is fallback, it aggregates signatures
+   * which no proof covers yet in interval 3, e.g. if assigned aggregator is
+   * offline.
+   */
+  class AggregatorDuty {
+   public:
+    /// Rank of aggregator which aggregates group in interval 2
+    static constexpr size_t kAssigned = 0;
+    /// Rank of aggregator which aggregates group in interval 3, if needed
+    static constexpr size_t kFallback = 1;
+
+    AggregatorDuty() = default;
+
+    /// @param peers validator indices of other aggregators of subnet
+    explicit AggregatorDuty(std::vector<ValidatorIndex> peers)
+        : peers_{std::move(peers)} {
+      std::ranges::sort(peers_);
+      auto duplicates = std::ranges::unique(peers_);
+      peers_.erase(duplicates.begin(), duplicates.end());
+    }
+
+    const std::vector<ValidatorIndex> &peers() const {
+      return peers_;
+    }
+
+    /// Aggregators of group ranked before `self`, 0 without peers
+    size_t rank(ValidatorIndex self, Slot slot, const Hash &data_root) const {
+      auto own = score(self, slot, data_root);
+      size_t rank = 0;
+      for (auto peer : peers_) {
+        if (peer == self) {
+          continue;
+        }
+        auto peer_score = score(peer, slot, data_root);
+        if (peer_score > own or (peer_score == own and peer < self)) {
+          ++rank;
+        }
+      }
+      return rank;
+    }
+
+    /// Same on all platforms, as peers must agree on it
+    static uint64_t score(ValidatorIndex aggregator,
+                          Slot slot,
+                          const Hash &data_root) {
+      auto x = mix(mix(aggregator) ^ slot);
+      for (size_t i = 0; i < data_root.size(); i += sizeof(uint64_t)) {
+        uint64_t word = 0;
+        for (size_t j = 0; j < sizeof(uint64_t); ++j) {
+          word |= uint64_t{data_root[i + j]} << (8 * j);
+        }
+        x = mix(x ^ word);
+      }
+      return x;
+    }
+
+   private:
+    /// splitmix64 finalizer
+    static uint64_t mix(uint64_t x) {
+      x += 0x9e3779b97f4a7c15;
+      x ^= x >> 30;
+      x *= 0xbf58476d1ce4e5b9;
+      x ^= x >> 27;
+      x *= 0x94d049bb133111eb;
+      x ^= x >> 31;
+      return x;
+    }
+
+    std::vector<ValidatorIndex> peers_;
+  };
+}  // namespace lean
@@ -6,6 +6,10 @@
 
 #pragma once
 
+#include <optional>
+#include <span>
+#include <vector>
+
 #include <qtils/outcome.hpp>
 
 #include "storage/buffer_map_types.hpp"
@@ -13,14 +17,37 @@
 #include "types/block_body.hpp"
 #include "types/block_data.hpp"
 #include "types/block_header.hpp"
+#include "types/checkpoint.hpp"
 #include "types/signed_block.hpp"
 #include "types/types.hpp"
 
 namespace lean {
+  struct ForkChoiceSnapshot;
   struct State;
 }
 namespace lean::blockchain {
 
+  /// Checkpoints of block post-state
+  struct StateCheckpoints {
+    Checkpoint justified;
+    Checkpoint finalized;
+  };
+
+  /**
+   * Next missing block of finalized history behind checkpoint sync anchor.
+   * History is backfilled from anchor towards genesis.
+   */
+  struct BackfillCursor : ssz::ssz_container {
+    /// Hash of missing block, anchor itself first, as only its header is
+    /// stored
+    BlockHash hash;
+    /// Missing block has slot below this one
+    Slot before;
+
+    SSZ_CONT(hash, before);
+    bool operator==(const BackfillCursor &) const = default;
+  };
+
   /**
    * A wrapper for a storage of blocks
    * Provides a convenient interface to work with it
@@ -60,6 +87,18 @@ namespace lean::blockchain {
     virtual outcome::result<void> deassignHashToSlot(
         const BlockIndex &block_index) = 0;
 
+    /**
+     * Saves block tree leaves and slot-to-hash records changed by reorg, in
+     * single atomic batch
+     * @param revert blocks to deassign from their slots
+     * @param apply blocks to assign to their slots
+     * @returns success or failure
+     */
+    virtual outcome::result<void> applyTreeChanges(
+        std::vector<BlockHash> leaves,
+        std::span<const BlockIndex> revert,
+        std::span<const BlockIndex> apply) = 0;
+
     /**
      * Tries to get block hashes by slot
      * @returns vector of hashes or error
@@ -139,6 +178,15 @@ namespace lean::blockchain {
     [[nodiscard]] virtual outcome::result<std::optional<BlockHeader>>
     tryGetBlockHeader(const BlockHash &block_hash) const = 0;
 
+    /**
+     * Headers of all stored blocks with slot not below {@param min_slot},
+     * read with single pass over header space. Hashes are computed in
+     * parallel and checked against storage keys.
+     * @returns headers in storage order, or error
+     */
+    [[nodiscard]] virtual outcome::result<std::vector<BlockHeader>>
+    getBlockHeadersFromSlot(Slot min_slot) const = 0;
+
     // -- body --
 
     /**
@@ -180,8 +228,31 @@ namespace lean::blockchain {
     [[nodiscard]] virtual outcome::result<std::optional<State>> getState(
         const BlockHash &block_hash) const = 0;
 
+    /**
+     * Checkpoints of stored post-state of block, read from encoded snapshot
+     * or diff without rebuilding state
+     * @returns nullopt if state is not stored
+     */
+    [[nodiscard]] virtual outcome::result<std::optional<StateCheckpoints>>
+    getStateCheckpoints(const BlockHash &block_hash) const = 0;
+
     virtual outcome::result<void> removeState(const BlockHash &block_hash) = 0;
 
+    /**
+     * Stores state of block as full snapshot, so states of ancestors can be
+     * removed without breaking state of block and its descendants
+     */
+    virtual outcome::result<void> rebaseState(const BlockHash &block_hash) = 0;
+
+    // -- fork choice --
+
+    /// Saves snapshot of fork choice store, replacing previous one
+    virtual outcome::result<void> putForkChoiceSnapshot(
+        const ForkChoiceSnapshot &snapshot) = 0;
+
+    [[nodiscard]] virtual outcome::result<std::optional<ForkChoiceSnapshot>>
+    getForkChoiceSnapshot() const = 0;
+
     // -- combined
 
     /**
@@ -224,10 +295,56 @@ namespace lean::blockchain {
      */
     virtual outcome::result<void> removeBlock(const BlockHash &block_hash) = 0;
 
+    /**
+     * Hides blocks from getters until they are removed with `removeBlock`,
+     * so blocks pruned by finalization are removed later, in background.
+     */
+    virtual void markRemoved(std::span<const BlockIndex> blocks) = 0;
+
+    /**
+     * Marks again blocks marked by previous run and not removed by it,
+     * so they are removed after restart.
+     * @returns hashes of these blocks
+     */
+    virtual outcome::result<std::vector<BlockHash>> restoreMarkedRemoved() = 0;
+
+    /**
+     * Moves signatures and bodies of finalized canonical blocks to ancient
+     * store, if it is enabled; headers stay for lookup by hash.
+     * Blocks go in ascending slot order, ones already there are skipped.
+     * Moved blocks are still returned by block getters.
+     */
+    virtual outcome::result<void> moveToAncient(
+        std::span<const BlockIndex> blocks) = 0;
+
+    /// Next missing block of history, nullopt if history is complete
+    [[nodiscard]] virtual outcome::result<std::optional<BackfillCursor>>
+    getBackfillCursor() const = 0;
+
+    /**
+     * Store blocks of finalized history with their slot-to-hash records, and
+     * advance backfill cursor, in single batch.
+     * @param blocks linked by parent hashes, in descending slot order
+     * @param cursor next missing block, nullopt when history is complete
+     */
+    virtual outcome::result<void> putBackfilledBlocks(
+        std::span<const SignedBlock> blocks,
+        const std::optional<BackfillCursor> &cursor) = 0;
+
     // -- special
 
     [[nodiscard]] virtual outcome::result<SignedBlock> getSignedBlock(
         const BlockHash &block_hash) const = 0;
+
+    /**
+     * Get many signed blocks, reading each block part of all blocks in
+     * single batched storage lookup
+     * @returns block, or std::nullopt if block is unknown, for each hash, in
+     * the same order
+     */
+    [[nodiscard]] virtual outcome::result<
+        std::vector<std::optional<SignedBlock>>>
+    tryGetSignedBlocks(std::span<const BlockHash> block_hashes) const = 0;
   };
 
 }  // namespace lean::blockchain
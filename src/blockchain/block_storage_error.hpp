@@ -24,7 +24,8 @@ namespace lean::blockchain {
     GENESIS_BLOCK_NOT_FOUND,
     FINALIZED_BLOCK_NOT_FOUND,
     BLOCK_TREE_LEAVES_NOT_FOUND,
-    JUSTIFICATION_EMPTY
+    JUSTIFICATION_EMPTY,
+    STATE_NOT_FOUND,
   };
 
 }
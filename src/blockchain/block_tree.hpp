@@ -6,6 +6,11 @@
 
 #pragma once
 
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
 #include "blockchain/block_header_repository.hpp"
 
 namespace lean {
@@ -17,8 +22,33 @@ namespace lean {
 }  // namespace lean
 
 namespace lean::blockchain {
+  struct BackfillCursor;
+
+  /**
+   * Non-finalized block, as kept in memory by block tree
+   */
+  struct BlockTreeEntry {
+    BlockIndex index;
+    BlockHash parent_root;
+    StateRoot state_root;
+  };
+
+  /**
+   * Lowest common ancestor of two blocks with distances to it
+   */
+  struct CommonAncestor {
+    BlockIndex index;
+    /// Number of blocks from first block down to ancestor
+    uint32_t lhs_distance;
+    /// Number of blocks from second block down to ancestor
+    uint32_t rhs_distance;
+  };
+
   class BlockTree : public BlockHeaderRepository {
    public:
+    /// Returns false to stop walk
+    using AncestorVisitor = std::function<bool(const BlockTreeEntry &)>;
+
     [[nodiscard]] virtual const BlockHash &getGenesisBlockHash() const = 0;
 
     /**
@@ -76,7 +106,7 @@ namespace lean::blockchain {
      * peer for the parent block and try to insert it; this operation is to be
      * repeated until a successful insertion happens
      */
-    virtual outcome::result<void> addBlock(SignedBlock signed_block) = 0;
+    virtual outcome::result<void> addBlock(const SignedBlock &signed_block) = 0;
 
     /**
      * Remove leaf
@@ -118,6 +148,21 @@ namespace lean::blockchain {
     getDescendingChainToBlock(const BlockHash &block,
                               uint64_t maximum) const = 0;
 
+    /**
+     * Hash of best chain block at `slot`, in O(1) from in-memory index for
+     * non-finalized slots, or from slot-to-hash record for finalized ones.
+     * @return nullopt if slot is empty or above best block
+     */
+    [[nodiscard]] virtual outcome::result<std::optional<BlockHash>>
+    getCanonicalHash(Slot slot) const = 0;
+
+    /**
+     * Best chain blocks with slots in [start_slot, start_slot + count),
+     * ascending, empty slots are skipped.
+     */
+    [[nodiscard]] virtual outcome::result<std::vector<BlockIndex>>
+    getCanonicalBlocks(Slot start_slot, uint64_t count) const = 0;
+
     [[nodiscard]] virtual bool isFinalized(const BlockIndex &block) const = 0;
 
     /**
@@ -152,6 +197,34 @@ namespace lean::blockchain {
     [[nodiscard]] virtual outcome::result<std::vector<BlockHash>> getChildren(
         const BlockHash &block) const = 0;
 
+    /**
+     * Visit block and its ancestors down to last finalized block (exclusive),
+     * using only in-memory tree, without reading headers from storage.
+     * Nothing is visited if block is not non-finalized block of tree.
+     * @param block to start walk from
+     * @param visit called from block towards finalized, under block tree
+     * lock, so it must not call block tree
+     */
+    virtual void forEachNonFinalizedAncestor(
+        const BlockHash &block, const AncestorVisitor &visit) const = 0;
+
+    /**
+     * Find ancestor of block, or block itself, with greatest slot not above
+     * `slot`, using jump pointers of in-memory tree, in O(log depth).
+     * @return nullopt if block is not in tree, or last finalized block is
+     * above `slot`
+     */
+    [[nodiscard]] virtual std::optional<BlockIndex> getAncestorAtSlot(
+        const BlockHash &block, Slot slot) const = 0;
+
+    /**
+     * Find lowest common ancestor of two blocks of in-memory tree,
+     * in O(log depth).
+     * @return nullopt if any block is not in tree
+     */
+    [[nodiscard]] virtual std::optional<CommonAncestor> getCommonAncestor(
+        const BlockHash &lhs, const BlockHash &rhs) const = 0;
+
     /**
      * Get the last finalized block
      * @return hash of the block
@@ -170,6 +243,31 @@ namespace lean::blockchain {
      */
     virtual outcome::result<std::optional<SignedBlock>> tryGetSignedBlock(
         const BlockHash block_hash) const = 0;
+
+    /**
+     * Get many `SignedBlock` with batched storage reads.
+     * @return block, or std::nullopt if unknown, for each hash in the same
+     * order
+     */
+    virtual outcome::result<std::vector<std::optional<SignedBlock>>>
+    tryGetSignedBlocks(std::span<const BlockHash> block_hashes) const = 0;
+
+    /**
+     * Next missing block of finalized history behind checkpoint sync anchor.
+     * @return nullopt if history is complete
+     */
+    [[nodiscard]] virtual outcome::result<std::optional<BackfillCursor>>
+    getBackfillCursor() const = 0;
+
+    /**
+     * Store blocks of finalized history, fetched backwards from anchor.
+     * They are not added to tree, only served by block getters.
+     * @param blocks linked by parent hashes, in descending slot order
+     * @param cursor next missing block, nullopt when history is complete
+     */
+    virtual outcome::result<void> addBackfilledBlocks(
+        std::span<const SignedBlock> blocks,
+        const std::optional<BackfillCursor> &cursor) = 0;
   };
 
 }  // namespace lean::blockchain
@@ -0,0 +1,123 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/chain_record.hpp"
+
+#include <array>
+#include <string_view>
+
+#include <boost/endian/conversion.hpp>
+
+namespace lean {
+  constexpr std::string_view kMagic = "QLEANREC";
+  constexpr uint32_t kVersion = 1;
+  /// Kind, time and payload size
+  constexpr size_t kRecordHeaderSize = 1 + 8 + 4;
+
+  ChainRecordWriter::ChainRecordWriter(std::ofstream file)
+      : file_{std::move(file)} {}
+
+  outcome::result<ChainRecordWriter> ChainRecordWriter::create(
+      const std::filesystem::path &path) {
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    if (not file) {
+      return ChainRecordError::CANT_OPEN;
+    }
+    std::array<uint8_t, 4> version{};
+    boost::endian::store_little_u32(version.data(), kVersion);
+    file.write(kMagic.data(), kMagic.size());
+    file.write(reinterpret_cast<const char *>(version.data()), version.size());
+    if (not file) {
+      return ChainRecordError::WRITE_FAILED;
+    }
+    return ChainRecordWriter{std::move(file)};
+  }
+
+  outcome::result<void> ChainRecordWriter::write(
+      ChainRecordKind kind,
+      std::chrono::milliseconds time,
+      qtils::BytesIn payload) {
+    std::array<uint8_t, kRecordHeaderSize> header{};
+    header[0] = static_cast<uint8_t>(kind);
+    boost::endian::store_little_u64(&header[1],
+                                   static_cast<uint64_t>(time.count()));
+    boost::endian::store_little_u32(&header[9],
+                                   static_cast<uint32_t>(payload.size()));
+    file_.write(reinterpret_cast<const char *>(header.data()), header.size());
+    file_.write(reinterpret_cast<const char *>(payload.data()),
+                static_cast<std::streamsize>(payload.size()));
+    if (not file_) {
+      return ChainRecordError::WRITE_FAILED;
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> ChainRecordWriter::flush() {
+    file_.flush();
+    if (not file_) {
+      return ChainRecordError::WRITE_FAILED;
+    }
+    return outcome::success();
+  }
+
+  ChainRecordReader::ChainRecordReader(std::ifstream file)
+      : file_{std::move(file)} {}
+
+  outcome::result<ChainRecordReader> ChainRecordReader::open(
+      const std::filesystem::path &path) {
+    std::ifstream file{path, std::ios::binary};
+    if (not file) {
+      return ChainRecordError::CANT_OPEN;
+    }
+    std::array<char, kMagic.size()> magic{};
+    std::array<uint8_t, 4> version{};
+    file.read(magic.data(), magic.size());
+    file.read(reinterpret_cast<char *>(version.data()), version.size());
+    if (not file or std::string_view{magic.data(), magic.size()} != kMagic
+        or boost::endian::load_little_u32(version.data()) != kVersion) {
+      return ChainRecordError::BAD_HEADER;
+    }
+    return ChainRecordReader{std::move(file)};
+  }
+
+  outcome::result<std::optional<ChainRecord>> ChainRecordReader::next() {
+    std::array<uint8_t, kRecordHeaderSize> header{};
+    file_.read(reinterpret_cast<char *>(header.data()), header.size());
+    if (file_.gcount() == 0 and file_.eof()) {
+      return std::nullopt;
+    }
+    if (not file_) {
+      return ChainRecordError::TRUNCATED;
+    }
+    auto kind = static_cast<ChainRecordKind>(header[0]);
+    if (kind < ChainRecordKind::ANCHOR_STATE or kind > ChainRecordKind::TICK) {
+      return ChainRecordError::UNKNOWN_KIND;
+    }
+    ChainRecord record{
+        .kind = kind,
+        .time = std::chrono::milliseconds{
+            boost::endian::load_little_u64(&header[1])},
+        .payload = qtils::ByteVec(boost::endian::load_little_u32(&header[9])),
+    };
+    file_.read(reinterpret_cast<char *>(record.payload.data()),
+               static_cast<std::streamsize>(record.payload.size()));
+    if (not file_) {
+      return ChainRecordError::TRUNCATED;
+    }
+    return record;
+  }
+
+  outcome::result<ChainRecord> readChainRecordingAnchor(
+      const std::filesystem::path &path) {
+    OUTCOME_TRY(reader, ChainRecordReader::open(path));
+    OUTCOME_TRY(record, reader.next());
+    if (not record.has_value()
+        or record->kind != ChainRecordKind::ANCHOR_STATE) {
+      return ChainRecordError::BAD_HEADER;
+    }
+    return std::move(*record);
+  }
+}  // namespace lean
@@ -0,0 +1,106 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+
+#include <qtils/byte_vec.hpp>
+#include <qtils/bytes.hpp>
+#include <qtils/enum_error_code.hpp>
+#include <qtils/outcome.hpp>
+
+namespace lean {
+  enum class ChainRecordError : uint8_t {
+    CANT_OPEN = 1,
+    WRITE_FAILED,
+    BAD_HEADER,
+    UNKNOWN_KIND,
+    TRUNCATED,
+  };
+  Q_ENUM_ERROR_CODE(ChainRecordError) {
+    using E = decltype(e);
+    switch (e) {
+      case E::CANT_OPEN:
+        return "Can't open chain recording file";
+      case E::WRITE_FAILED:
+        return "Can't write chain recording file";
+      case E::BAD_HEADER:
+        return "Not a chain recording file or unsupported version";
+      case E::UNKNOWN_KIND:
+        return "Unknown chain record kind";
+      case E::TRUNCATED:
+        return "Chain recording file is truncated";
+    }
+    abort();
+  }
+
+  /// Kind of `ChainRecord`, values are stored in file
+  enum class ChainRecordKind : uint8_t {
+    /// `State` of last finalized block when recording started
+    ANCHOR_STATE = 1,
+    BLOCK,
+    ATTESTATION,
+    AGGREGATED_ATTESTATION,
+    /// `ForkChoiceStoreMutex::onTick` call, time is its argument
+    TICK,
+  };
+
+  /// Fork choice input and system time it was received at
+  struct ChainRecord {
+    ChainRecordKind kind;
+    std::chrono::milliseconds time;
+    /// SSZ of `SignedBlock`, `SignedAttestation`, etc., empty for tick
+    qtils::ByteVec payload;
+  };
+
+  /**
+   * Chain recording file is header (magic and version) followed by records
+   * `[u8 kind][u64 time ms][u32 payload size][payload]`, integers are
+   * little endian.
+   */
+  class ChainRecordWriter {
+   public:
+    static outcome::result<ChainRecordWriter> create(
+        const std::filesystem::path &path);
+
+    outcome::result<void> write(ChainRecordKind kind,
+                                std::chrono::milliseconds time,
+                                qtils::BytesIn payload);
+    outcome::result<void> flush();
+
+   private:
+    explicit ChainRecordWriter(std::ofstream file);
+
+    std::ofstream file_;
+  };
+
+  /// Reads records written by `ChainRecordWriter` sequentially
+  class ChainRecordReader {
+   public:
+    static outcome::result<ChainRecordReader> open(
+        const std::filesystem::path &path);
+
+    /// Next record, `std::nullopt` at end of file
+    outcome::result<std::optional<ChainRecord>> next();
+
+   private:
+    explicit ChainRecordReader(std::ifstream file);
+
+    std::ifstream file_;
+  };
+
+  /**
+   * First record of recording, its time is when recording started.
+   * Fails if it is not `ANCHOR_STATE`.
+   */
+  outcome::result<ChainRecord> readChainRecordingAnchor(
+      const std::filesystem::path &path);
+}  // namespace lean
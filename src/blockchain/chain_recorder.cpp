@@ -0,0 +1,150 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/chain_recorder.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
+#include "app/configuration.hpp"
+#include "blockchain/block_storage.hpp"
+#include "blockchain/block_storage_error.hpp"
+#include "blockchain/block_tree.hpp"
+#include "clock/clock.hpp"
+#include "serde/serialization.hpp"
+
+namespace lean {
+  ChainRecorder::ChainRecorder(
+      qtils::SharedRef<log::LoggingSystem> logsys,
+      qtils::SharedRef<app::Configuration> app_config,
+      qtils::SharedRef<clock::SystemClock> clock,
+      qtils::SharedRef<blockchain::BlockTree> block_tree,
+      qtils::SharedRef<blockchain::BlockStorage> block_storage)
+      : logger_(logsys->getLogger("ChainRecorder", "fork_choice")),
+        clock_(std::move(clock)) {
+    auto &path = app_config->recordChain();
+    if (not path.has_value()) {
+      return;
+    }
+    auto writer_res = ChainRecordWriter::create(*path);
+    if (writer_res.has_error()) {
+      SL_ERROR(logger_,
+               "Chain is not recorded into {}: {}",
+               path->string(),
+               writer_res.error());
+      return;
+    }
+    writer_.emplace(std::move(writer_res.value()));
+    if (auto res = recordAnchor(*block_tree, *block_storage);
+        res.has_error()) {
+      SL_ERROR(logger_,
+               "Chain is not recorded into {}, can't record anchor: {}",
+               path->string(),
+               res.error());
+      writer_.reset();
+      return;
+    }
+    enabled_ = true;
+    SL_INFO(logger_, "Recording chain into {}", path->string());
+  }
+
+  ChainRecorder::~ChainRecorder() {
+    std::lock_guard lock{mutex_};
+    if (writer_.has_value()) {
+      std::ignore = writer_->flush();
+    }
+  }
+
+  outcome::result<void> ChainRecorder::recordAnchor(
+      const blockchain::BlockTree &block_tree,
+      const blockchain::BlockStorage &block_storage) {
+    auto now = clock_->nowMsec();
+    auto finalized = block_tree.lastFinalized();
+    OUTCOME_TRY(state, block_storage.getState(finalized.hash));
+    if (not state.has_value()) {
+      return blockchain::BlockStorageError::STATE_NOT_FOUND;
+    }
+    encodeInto(*state, buffer_);
+    OUTCOME_TRY(writer_->write(ChainRecordKind::ANCHOR_STATE, now, buffer_));
+
+    // Known non-finalized blocks, parents before children
+    std::vector<blockchain::BlockTreeEntry> entries;
+    std::unordered_set<BlockHash> visited;
+    for (auto &leaf : block_tree.getLeaves()) {
+      block_tree.forEachNonFinalizedAncestor(
+          leaf, [&](const blockchain::BlockTreeEntry &entry) {
+            if (not visited.emplace(entry.index.hash).second) {
+              return false;
+            }
+            entries.emplace_back(entry);
+            return true;
+          });
+    }
+    std::ranges::sort(entries, {}, [](const blockchain::BlockTreeEntry &e) {
+      return e.index.slot;
+    });
+    for (auto &entry : entries) {
+      OUTCOME_TRY(signed_block, block_tree.tryGetSignedBlock(entry.index.hash));
+      if (not signed_block.has_value()) {
+        return blockchain::BlockStorageError::BODY_NOT_FOUND;
+      }
+      encodeInto(*signed_block, buffer_);
+      OUTCOME_TRY(writer_->write(ChainRecordKind::BLOCK, now, buffer_));
+    }
+    SL_INFO(logger_,
+            "Recorded state of finalized block {} and {} non-finalized blocks",
+            finalized,
+            entries.size());
+    return outcome::success();
+  }
+
+  void ChainRecorder::recordBlock(const SignedBlock &signed_block) {
+    record(ChainRecordKind::BLOCK, signed_block);
+  }
+
+  void ChainRecorder::recordAttestation(
+      const SignedAttestation &signed_attestation) {
+    record(ChainRecordKind::ATTESTATION, signed_attestation);
+  }
+
+  void ChainRecorder::recordAggregatedAttestation(
+      const SignedAggregatedAttestation &signed_aggregated_attestation) {
+    record(ChainRecordKind::AGGREGATED_ATTESTATION,
+           signed_aggregated_attestation);
+  }
+
+  void ChainRecorder::recordTick(std::chrono::milliseconds now) {
+    if (not enabled_) {
+      return;
+    }
+    std::lock_guard lock{mutex_};
+    write(ChainRecordKind::TICK, now, {});
+  }
+
+  void ChainRecorder::record(ChainRecordKind kind, const auto &value) {
+    if (not enabled_) {
+      return;
+    }
+    auto now = clock_->nowMsec();
+    std::lock_guard lock{mutex_};
+    encodeInto(value, buffer_);
+    write(kind, now, buffer_);
+  }
+
+  void ChainRecorder::write(ChainRecordKind kind,
+                            std::chrono::milliseconds time,
+                            qtils::BytesIn payload) {
+    if (not writer_.has_value()) {
+      return;
+    }
+    if (auto res = writer_->write(kind, time, payload); res.has_error()) {
+      SL_ERROR(logger_, "Chain recording stopped: {}", res.error());
+      enabled_ = false;
+      writer_.reset();
+    }
+  }
+}  // namespace lean
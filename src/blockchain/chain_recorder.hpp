@@ -0,0 +1,82 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <optional>
+
+#include <qtils/shared_ref.hpp>
+
+#include "blockchain/chain_record.hpp"
+#include "log/logger.hpp"
+#include "types/signed_aggregated_attestation.hpp"
+#include "types/signed_attestation.hpp"
+#include "types/signed_block.hpp"
+
+namespace lean::app {
+  class Configuration;
+}  // namespace lean::app
+
+namespace lean::clock {
+  class SystemClock;
+}  // namespace lean::clock
+
+namespace lean::blockchain {
+  class BlockStorage;
+  class BlockTree;
+}  // namespace lean::blockchain
+
+namespace lean {
+  /**
+   * Records fork choice inputs into `--record-chain` file, for replay by
+   * `ChainReplay`.
+   * Recording starts with state of last finalized block and non-finalized
+   * blocks already known, so replay needs nothing but the file.
+   * Does nothing when option is not set.
+   */
+  class ChainRecorder {
+   public:
+    ChainRecorder(qtils::SharedRef<log::LoggingSystem> logsys,
+                  qtils::SharedRef<app::Configuration> app_config,
+                  qtils::SharedRef<clock::SystemClock> clock,
+                  qtils::SharedRef<blockchain::BlockTree> block_tree,
+                  qtils::SharedRef<blockchain::BlockStorage> block_storage);
+
+    ChainRecorder(const ChainRecorder &) = delete;
+    ChainRecorder &operator=(const ChainRecorder &) = delete;
+
+    ~ChainRecorder();
+
+    bool enabled() const {
+      return enabled_;
+    }
+
+    void recordBlock(const SignedBlock &signed_block);
+    void recordAttestation(const SignedAttestation &signed_attestation);
+    void recordAggregatedAttestation(
+        const SignedAggregatedAttestation &signed_aggregated_attestation);
+    void recordTick(std::chrono::milliseconds now);
+
+   private:
+    outcome::result<void> recordAnchor(
+        const blockchain::BlockTree &block_tree,
+        const blockchain::BlockStorage &block_storage);
+    void record(ChainRecordKind kind, const auto &value);
+    void write(ChainRecordKind kind,
+               std::chrono::milliseconds time,
+               qtils::BytesIn payload);
+
+    log::Logger logger_;
+    qtils::SharedRef<clock::SystemClock> clock_;
+    std::atomic_bool enabled_ = false;
+    std::mutex mutex_;
+    std::optional<ChainRecordWriter> writer_;
+    /// Reused encoding buffer
+    qtils::ByteVec buffer_;
+  };
+}  // namespace lean
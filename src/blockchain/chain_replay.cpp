@@ -0,0 +1,314 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/chain_replay.hpp"
+
+#include <algorithm>
+
+#include <sys/resource.h>
+
+#include <fmt/format.h>
+
+#include "app/configuration.hpp"
+#include "blockchain/chain_record.hpp"
+#include "blockchain/fork_choice.hpp"
+#include "blockchain/state_transition_function.hpp"
+#include "blockchain/stored_chain.hpp"
+#include "serde/serialization.hpp"
+
+namespace lean {
+  constexpr std::array kStageNames{
+      "decode",
+      "load parent state",
+      "block signatures",
+      "state transition",
+      "store state",
+      "add block, update head",
+      "gossip attestation",
+      "gossip aggregation",
+      "tick",
+  };
+
+  constexpr std::array kBlockResultNames{
+      "imported",
+      "known",
+      "failed",
+      "invalid signatures",
+      "state root mismatch",
+  };
+
+  ChainReplay::ChainReplay(
+      qtils::SharedRef<log::LoggingSystem> logsys,
+      qtils::SharedRef<app::Configuration> app_config,
+      qtils::SharedRef<ForkChoiceStore> fork_choice,
+      std::shared_ptr<blockchain::StoredChain> stored_chain)
+      : logger_(logsys->getLogger("ChainReplay", "fork_choice")),
+        app_config_(std::move(app_config)),
+        fork_choice_(std::move(fork_choice)),
+        stored_chain_(std::move(stored_chain)) {
+    // Blocks and attestations of this node are in recording already
+    fork_choice_->dontPropose();
+  }
+
+  outcome::result<void> ChainReplay::run() {
+    return stored_chain_ ? runStored() : runRecording();
+  }
+
+  outcome::result<void> ChainReplay::runRecording() {
+    auto &path = app_config_->replayChain().value();
+    OUTCOME_TRY(reader, ChainRecordReader::open(path));
+    // Anchor state is loaded by `AnchorStateImpl` already
+    OUTCOME_TRY(reader.next());
+    SL_INFO(logger_, "Replaying chain from {}", path.string());
+
+    auto start = Clock::now();
+    while (true) {
+      OUTCOME_TRY(record, reader.next());
+      if (not record.has_value()) {
+        break;
+      }
+      switch (record->kind) {
+        case ChainRecordKind::ANCHOR_STATE:
+          break;
+        case ChainRecordKind::BLOCK: {
+          auto signed_block = ({
+            StageTimer timer{*this, Stage::DECODE};
+            decode<SignedBlock>(record->payload);
+          });
+          OUTCOME_TRY(signed_block);
+          std::ignore = replayBlock(std::move(signed_block.value()));
+          break;
+        }
+        case ChainRecordKind::ATTESTATION: {
+          auto signed_attestation = ({
+            StageTimer timer{*this, Stage::DECODE};
+            decode<SignedAttestation>(record->payload);
+          });
+          OUTCOME_TRY(signed_attestation);
+          replayAttestation(signed_attestation.value());
+          break;
+        }
+        case ChainRecordKind::AGGREGATED_ATTESTATION: {
+          auto signed_aggregated_attestation = ({
+            StageTimer timer{*this, Stage::DECODE};
+            decode<SignedAggregatedAttestation>(record->payload);
+          });
+          OUTCOME_TRY(signed_aggregated_attestation);
+          replayAggregatedAttestation(signed_aggregated_attestation.value());
+          break;
+        }
+        case ChainRecordKind::TICK: {
+          StageTimer timer{*this, Stage::TICK};
+          std::ignore = fork_choice_->onTick(record->time);
+          break;
+        }
+      }
+    }
+    printReport(Clock::now() - start);
+    return outcome::success();
+  }
+
+  outcome::result<void> ChainReplay::runStored() {
+    using Millis = std::chrono::duration<double, std::milli>;
+    auto &config = stored_chain_->anchorState().config;
+    auto &stf_samples = samples_.at(static_cast<size_t>(Stage::STF));
+    fmt::println("{:>10}{:>12}{:>12}  {:<20}  {}",
+                 "slot",
+                 "total ms",
+                 "stf ms",
+                 "result",
+                 "block");
+
+    auto start = Clock::now();
+    for (auto &[slot, hashes] : stored_chain_->slots()) {
+      {
+        StageTimer timer{*this, Stage::TICK};
+        std::ignore =
+            fork_choice_->onTick(Interval::fromSlot(slot, 0).time(config));
+      }
+      for (auto &hash : hashes) {
+        auto signed_block = ({
+          StageTimer timer{*this, Stage::DECODE};
+          stored_chain_->block(hash);
+        });
+        OUTCOME_TRY(signed_block);
+        auto stf_count = stf_samples.size();
+        auto block_start = Clock::now();
+        auto result = replayBlock(std::move(signed_block.value()));
+        auto total = Clock::now() - block_start;
+        auto stf = stf_samples.size() != stf_count ? stf_samples.back()
+                                                   : Clock::duration{};
+        fmt::println("{:>10}{:>12.3f}{:>12.3f}  {:<20}  {}",
+                     slot,
+                     Millis{total}.count(),
+                     Millis{stf}.count(),
+                     kBlockResultNames.at(static_cast<size_t>(result)),
+                     hash);
+      }
+    }
+    printReport(Clock::now() - start);
+    return outcome::success();
+  }
+
+  ChainReplay::BlockResult ChainReplay::replayBlock(SignedBlock signed_block) {
+    auto begin_res = ({
+      StageTimer timer{*this, Stage::LOAD_STATE};
+      fork_choice_->beginBlockImport(std::move(signed_block));
+    });
+    if (begin_res.has_error()) {
+      // Parent was not known when block was received by node too
+      SL_DEBUG(logger_, "Block not imported: {}", begin_res.error());
+      ++blocks_failed_;
+      return BlockResult::FAILED;
+    }
+    if (not begin_res.value().has_value()) {
+      ++blocks_known_;
+      return BlockResult::KNOWN;
+    }
+    auto &block_import = *begin_res.value();
+    auto &parent_state = *block_import.parent_state;
+    if (app_config_->replaySignatures()) {
+      auto valid = ({
+        StageTimer timer{*this, Stage::SIGNATURES};
+        fork_choice_->validateBlockSignatures(block_import.signed_block,
+                                              parent_state);
+      });
+      if (not valid) {
+        SL_DEBUG(logger_,
+                 "Invalid signatures of block {}",
+                 block_import.signed_block.block.index());
+        ++blocks_failed_;
+        return BlockResult::INVALID_SIGNATURES;
+      }
+    }
+    auto apply_res = ({
+      StageTimer timer{*this, Stage::STF};
+      fork_choice_->applyBlockImport(block_import, parent_state);
+    });
+    if (apply_res.has_error()) {
+      ++blocks_failed_;
+      if (apply_res.error() == STF::Error::STATE_ROOT_DOESNT_MATCH) {
+        SL_WARN(logger_,
+                "State root of block {} doesn't match",
+                block_import.signed_block.block.index());
+        ++state_root_mismatches_;
+        return BlockResult::STATE_ROOT_MISMATCH;
+      }
+      SL_DEBUG(logger_, "Block state transition failed: {}", apply_res.error());
+      return BlockResult::FAILED;
+    }
+    {
+      StageTimer timer{*this, Stage::STORAGE};
+      fork_choice_->storeBlockImport(block_import);
+    }
+    auto commit_res = ({
+      StageTimer timer{*this, Stage::HEAD};
+      fork_choice_->commitBlockImport(block_import);
+    });
+    if (commit_res.has_error()) {
+      SL_DEBUG(logger_, "Block not added: {}", commit_res.error());
+      ++blocks_failed_;
+      return BlockResult::FAILED;
+    }
+    ++blocks_imported_;
+    return BlockResult::IMPORTED;
+  }
+
+  void ChainReplay::replayAttestation(
+      const SignedAttestation &signed_attestation) {
+    StageTimer timer{*this, Stage::ATTESTATION};
+    auto res = [&]() -> outcome::result<void> {
+      OUTCOME_TRY(state,
+                  fork_choice_->beginGossipAttestation(signed_attestation));
+      OUTCOME_TRY(
+          fork_choice_->verifyGossipAttestation(*state, signed_attestation));
+      fork_choice_->commitGossipAttestation(signed_attestation);
+      return outcome::success();
+    }();
+    if (res.has_error()) {
+      ++attestations_failed_;
+    }
+  }
+
+  void ChainReplay::replayAggregatedAttestation(
+      const SignedAggregatedAttestation &signed_aggregated_attestation) {
+    StageTimer timer{*this, Stage::AGGREGATED_ATTESTATION};
+    auto res = [&]() -> outcome::result<void> {
+      OUTCOME_TRY(state,
+                  fork_choice_->beginGossipAggregatedAttestation(
+                      signed_aggregated_attestation));
+      if (not fork_choice_->verifyGossipAggregatedAttestation(
+              *state, signed_aggregated_attestation)) {
+        return ForkChoiceStore::Error::INVALID_ATTESTATION;
+      }
+      return fork_choice_->onAggregatedAttestation(
+          signed_aggregated_attestation, false);
+    }();
+    if (res.has_error()) {
+      ++attestations_failed_;
+    }
+  }
+
+  void ChainReplay::printReport(Clock::duration elapsed) const {
+    static_assert(kStageNames.size() == static_cast<size_t>(Stage::COUNT));
+    using Micros = std::chrono::duration<double, std::micro>;
+    auto seconds = std::chrono::duration<double>(elapsed).count();
+
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    auto peak_rss = static_cast<size_t>(usage.ru_maxrss);
+#else
+    auto peak_rss = static_cast<size_t>(usage.ru_maxrss) << 10;
+#endif
+
+    fmt::println("Replayed in {:.3f}s", seconds);
+    fmt::println("Blocks: {} imported, {} known, {} failed, {:.1f} blocks/s",
+                 blocks_imported_,
+                 blocks_known_,
+                 blocks_failed_,
+                 static_cast<double>(blocks_imported_) / seconds);
+    fmt::println("State root mismatches: {}", state_root_mismatches_);
+    fmt::println("Attestations failed: {}", attestations_failed_);
+    fmt::println("Head: {}, finalized: {}",
+                 fork_choice_->getHead(),
+                 fork_choice_->getLatestFinalized());
+    fmt::println("Peak RSS: {} MiB", peak_rss >> 20);
+    fmt::println("{:<24}{:>10}{:>12}{:>12}{:>12}{:>12}{:>12}",
+                 "stage",
+                 "count",
+                 "total ms",
+                 "mean us",
+                 "p50 us",
+                 "p99 us",
+                 "max us");
+    for (size_t i = 0; i < samples_.size(); ++i) {
+      auto sorted = samples_[i];
+      if (sorted.empty()) {
+        continue;
+      }
+      std::ranges::sort(sorted);
+      auto percentile = [&](double q) {
+        auto index =
+            static_cast<size_t>(q * static_cast<double>(sorted.size()));
+        return Micros{sorted[std::min(index, sorted.size() - 1)]}.count();
+      };
+      Clock::duration total{};
+      for (auto &sample : sorted) {
+        total += sample;
+      }
+      auto total_us = Micros{total}.count();
+      fmt::println("{:<24}{:>10}{:>12.1f}{:>12.1f}{:>12.1f}{:>12.1f}{:>12.1f}",
+                   kStageNames.at(i),
+                   sorted.size(),
+                   total_us / 1000,
+                   total_us / static_cast<double>(sorted.size()),
+                   percentile(0.5),
+                   percentile(0.99),
+                   Micros{sorted.back()}.count());
+    }
+  }
+}  // namespace lean
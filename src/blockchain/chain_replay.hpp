@@ -0,0 +1,118 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+#include <qtils/shared_ref.hpp>
+
+#include "log/logger.hpp"
+#include "types/signed_aggregated_attestation.hpp"
+#include "types/signed_attestation.hpp"
+#include "types/signed_block.hpp"
+
+namespace lean::app {
+  class Configuration;
+}  // namespace lean::app
+
+namespace lean::blockchain {
+  class StoredChain;
+}  // namespace lean::blockchain
+
+namespace lean {
+  class ForkChoiceStore;
+
+  /**
+   * Replays `--replay-chain` recording of `ChainRecorder` into fork choice
+   * store, which is fresh store started from anchor state of recording.
+   * Records are applied one by one on caller thread as fast as possible,
+   * recorded ticks advance store time, so stages of block import are
+   * measured separately and storage backends, cache sizes and crypto builds
+   * can be compared on same input.
+   *
+   * With `--replay-db`, blocks stored by other node are replayed slot by
+   * slot instead, with tick at start of each slot, and timing and outcome
+   * of each block is printed too, e.g. to find block which state root
+   * doesn't match.
+   */
+  class ChainReplay {
+   public:
+    ChainReplay(qtils::SharedRef<log::LoggingSystem> logsys,
+                qtils::SharedRef<app::Configuration> app_config,
+                qtils::SharedRef<ForkChoiceStore> fork_choice,
+                std::shared_ptr<blockchain::StoredChain> stored_chain);
+
+    /// Apply whole recording and print statistics to stdout
+    outcome::result<void> run();
+
+   private:
+    enum class Stage : uint8_t {
+      DECODE,
+      LOAD_STATE,
+      SIGNATURES,
+      STF,
+      STORAGE,
+      HEAD,
+      ATTESTATION,
+      AGGREGATED_ATTESTATION,
+      TICK,
+      COUNT,
+    };
+
+    enum class BlockResult : uint8_t {
+      IMPORTED,
+      KNOWN,
+      FAILED,
+      INVALID_SIGNATURES,
+      STATE_ROOT_MISMATCH,
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    /// Adds time of scope to stage samples
+    class StageTimer {
+     public:
+      StageTimer(ChainReplay &replay, Stage stage)
+          : replay_{replay}, stage_{stage}, start_{Clock::now()} {}
+      ~StageTimer() {
+        replay_.samples_.at(static_cast<size_t>(stage_))
+            .emplace_back(Clock::now() - start_);
+      }
+
+      StageTimer(const StageTimer &) = delete;
+      StageTimer &operator=(const StageTimer &) = delete;
+
+     private:
+      // NOLINTNEXTLINE(cppcoreguidelines-avoid-const-or-ref-data-members)
+      ChainReplay &replay_;
+      Stage stage_;
+      Clock::time_point start_;
+    };
+
+    outcome::result<void> runRecording();
+    outcome::result<void> runStored();
+    BlockResult replayBlock(SignedBlock signed_block);
+    void replayAttestation(const SignedAttestation &signed_attestation);
+    void replayAggregatedAttestation(
+        const SignedAggregatedAttestation &signed_aggregated_attestation);
+    void printReport(Clock::duration elapsed) const;
+
+    log::Logger logger_;
+    qtils::SharedRef<app::Configuration> app_config_;
+    qtils::SharedRef<ForkChoiceStore> fork_choice_;
+    std::shared_ptr<blockchain::StoredChain> stored_chain_;
+    std::array<std::vector<Clock::duration>, static_cast<size_t>(Stage::COUNT)>
+        samples_;
+    size_t blocks_imported_ = 0;
+    size_t blocks_known_ = 0;
+    size_t blocks_failed_ = 0;
+    size_t state_root_mismatches_ = 0;
+    size_t attestations_failed_ = 0;
+  };
+}  // namespace lean
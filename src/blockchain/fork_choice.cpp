@@ -7,31 +7,40 @@
 #include "blockchain/fork_choice.hpp"
 
 #include <algorithm>
+#include <deque>
+#include <iterator>
+#include <memory_resource>
+#include <random>
 #include <ranges>
 #include <stdexcept>
 #include <utility>
 #include <vector>
 
+#include <qtils/cxx23/ranges/contains.hpp>
 #include <qtils/to_shared_ptr.hpp>
 #include <qtils/value_or_raise.hpp>
 
 #include "app/chain_spec.hpp"
 #include "app/configuration.hpp"
 #include "app/validator_keys_manifest.hpp"
+#include "blockchain/block_storage.hpp"
 #include "blockchain/genesis_config.hpp"
 #include "blockchain/is_proposer.hpp"
+#include "blockchain/state_root.hpp"
 #include "blockchain/validator_registry.hpp"
 #include "blockchain/validator_subnet.hpp"
+#include "blockchain/vote_tally.hpp"
 #include "crypto/xmss/xmss_provider.hpp"
 #include "impl/block_tree_impl.hpp"
 #include "is_justifiable_slot.hpp"
+#include "log/tracing.hpp"
 #include "metrics/impl/metrics_impl.hpp"
 #include "types/aggregated_attestations.hpp"
 #include "types/attestation.hpp"
 #include "types/fork_choice_api_json.hpp"
 #include "types/signed_block.hpp"
-#include "utils/ceil_div.hpp"
-#include "utils/lru_cache.hpp"
+#include "utils/memory_usage.hpp"
+#include "utils/sharded_lru_cache.hpp"
 #include "utils/retain_if.hpp"
 
 namespace lean {
@@ -64,11 +73,14 @@ namespace lean {
         block_storage_(std::move(block_storage)),
         stf_(std::move(logging_system), block_tree_, metrics_),
         config_(anchor_state->config),
+        states_{app_config->database().state_cache_size,
+                app_config->database().state_warm_cache_size},
         validator_registry_(std::move(validator_registry)),
         validator_keys_manifest_(std::move(validator_keys_manifest)),
         validator_id_{getValidatorId(logger_, *validator_registry_)},
         is_aggregator_{[chain_spec] { return chain_spec->isAggregator(); }},
-        subnet_count_{app_config->cliSubnetCount()} {
+        subnet_count_{app_config->cliSubnetCount()},
+        aggregate_subnets_{app_config->cliAggregateSubnets()} {
     metrics_->stf_latest_justified_slot()->set(
         block_tree_->getLatestJustified().slot);
     metrics_->stf_latest_finalized_slot()->set(
@@ -76,11 +88,37 @@ namespace lean {
 
     SL_TRACE(logger_, "Initialise fork-choice");
 
-    for (auto xmss_pubkey : validator_keys_manifest_->getAllXmssPubkeys()) {
+    auto xmss_pubkeys = validator_keys_manifest_->getAllXmssPubkeys();
+    for (auto xmss_pubkey : xmss_pubkeys) {
       SL_INFO(logger_, "Validator pubkey: {}", xmss_pubkey.toHex());
     }
+    if (auto &follower = app_config->follower(); follower.enabled) {
+      // Own attestations and aggregates must not build on unverified votes
+      if (not xmss_pubkeys.empty() or chain_spec->isAggregator()) {
+        SL_WARN(logger_,
+                "Follower mode ignored, node has validators or aggregates");
+      } else {
+        follow(follower.sample_rate);
+      }
+    }
+
+    // Bootnodes follow validator order, as networking assumes
+    std::vector<ValidatorIndex> aggregator_peers;
+    auto &bootnodes = chain_spec->getBootnodes().getBootnodes();
+    auto own_subnet = validatorSubnet(validator_id_, subnet_count_);
+    for (ValidatorIndex validator_index = 0;
+         validator_index < std::min<size_t>(
+             bootnodes.size(), anchor_state->validators.data().size());
+         ++validator_index) {
+      if (bootnodes[validator_index].is_aggregator
+          and validator_index != validator_id_
+          and validatorSubnet(validator_index, subnet_count_) == own_subnet) {
+        aggregator_peers.emplace_back(validator_index);
+      }
+    }
+    setAggregatorDuty(AggregatorDuty{std::move(aggregator_peers)});
 
-    BOOST_ASSERT(anchor_block->state_root == sszHash(*anchor_state));
+    BOOST_ASSERT(anchor_block->state_root == stateRoot(*anchor_state));
     SL_TRACE(logger_, "Anchor block: {}", anchor_block->index());
     SL_TRACE(logger_, "Anchor state: {}", anchor_block->state_root);
 
@@ -125,6 +163,9 @@ namespace lean {
       }
       anchor_block_slots_.emplace(hash, slot);
     }
+
+    snapshots_enabled_ = true;
+    restoreSnapshot();
   }
 
   // Test constructor implementation
@@ -167,43 +208,116 @@ namespace lean {
     dont_propose_ = true;
   }
 
+  void ForkChoiceStore::follow(double sample_rate) {
+    SL_INFO(logger_,
+            "Following optimistically, verifying {}% of aggregated proofs",
+            sample_rate * 100);
+    std::random_device random;
+    follower_ = Follower{
+        .seed = std::uniform_int_distribution<uint64_t>{}(random),
+        .sample_rate = sample_rate,
+    };
+  }
+
+  bool ForkChoiceStore::followerSamples(const Hash &key) const {
+    // splitmix64 finalizer of seeded key prefix
+    uint64_t x = follower_->seed;
+    for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+      x ^= uint64_t{key[i]} << (8 * i);
+    }
+    x += 0x9e3779b97f4a7c15;
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111eb;
+    x ^= x >> 31;
+    // Top 53 bits as uniform double in [0, 1)
+    return static_cast<double>(x >> 11) * 0x1p-53 < follower_->sample_rate;
+  }
+
+  void ForkChoiceStore::shareStates(std::shared_ptr<SharedStatePool> pool) {
+    states_.share(std::move(pool));
+  }
+
   inline crypto::xmss::XmssMessage attestationPayload(
       const AttestationData &attestation_data) {
     return sszHash(attestation_data);
   }
 
+  /**
+   * Greedy max-coverage: repeatedly pick proof adding most validators not
+   * covered yet, until no proof adds any.
+   * @return selected proofs, in order of selection
+   */
+  inline std::vector<const AggregatedSignatureProof *> selectProofs(
+      const std::vector<AggregatedSignatureProof> &proofs) {
+    std::vector<const AggregatedSignatureProof *> selected;
+    std::vector<const AggregatedSignatureProof *> candidates;
+    for (auto &proof : proofs) {
+      candidates.emplace_back(&proof);
+    }
+    AggregationBits covered;
+    while (not candidates.empty()) {
+      auto best = candidates.end();
+      size_t best_gain = 0;
+      for (auto it = candidates.begin(); it != candidates.end(); ++it) {
+        auto gain = (*it)->participants.countNotIn(covered);
+        if (gain > best_gain) {
+          best_gain = gain;
+          best = it;
+        }
+      }
+      if (best == candidates.end()) {
+        break;
+      }
+      covered.unionWith((*best)->participants);
+      selected.emplace_back(*best);
+      candidates.erase(best);
+    }
+    return selected;
+  }
+
+  struct VerifiedProofKey : ssz::ssz_container {
+    Hash message;
+    Hash proof_root;
+
+    SSZ_CONT(message, proof_root);
+  };
+
   outcome::result<void> ForkChoiceStore::updateSafeTarget() {
     SL_TRACE(logger_, "Update safe target");
     // Get validator count from head state
     OUTCOME_TRY(head_state, getState(head_.root));
 
     // 2/3rd majority min voting weight for target selection
-    auto min_target_score = ceilDiv(head_state->validatorCount() * 2, 3);
+    auto min_target_score =
+        supermajorityThreshold(head_state->validatorCount());
 
     OUTCOME_TRY(lmd_ghost_head,
-                computeLmdGhostHead(block_tree_->getLatestJustified().root,
-                                    latest_new_attestations_,
-                                    min_target_score));
+                findSafeTarget(block_tree_->getLatestJustified().root,
+                               min_target_score));
 
     OUTCOME_TRY(slot, getBlockSlot(lmd_ghost_head));
 
     safe_target_ = {.root = lmd_ghost_head, .slot = slot};
     SL_TRACE(logger_, "Safe target was set to {}", safe_target_);
+    pinStates();
 
     metrics_->fc_safe_target_slot()->set(safe_target_.slot);
+    api_fork_choice_version_.fetch_add(1, std::memory_order_release);
     return outcome::success();
   }
 
   outcome::result<void> ForkChoiceStore::updateHead() {
     SL_TRACE(logger_, "Update head");
+    auto timer = metrics_->fc_update_head_time()->timer();
+    LEAN_TRACE_SPAN("fork_choice", "update head");
     // Run LMD-GHOST fork choice algorithm
     //
     // Selects canonical head by walking the tree from the justified root,
     // choosing the heaviest child at each fork based on attestation weights.
     OUTCOME_TRY(lmd_ghost_head_root,
-                computeLmdGhostHead(block_tree_->getLatestJustified().root,
-                                    latest_known_attestations_,
-                                    0));
+                findHead(block_tree_->getLatestJustified().root));
 
     OUTCOME_TRY(lmd_ghost_head_slot, getBlockSlot(lmd_ghost_head_root));
     Checkpoint lmd_ghost_head = {.root = lmd_ghost_head_root,
@@ -211,57 +325,95 @@ namespace lean {
 
     // Reorg detection
     if (head_.root != lmd_ghost_head.root) {
-      Checkpoint a = head_;
-      Checkpoint b = lmd_ghost_head;
-
-      size_t da = 0;
-      size_t db = 0;
-
-      auto lift_one = [&](Checkpoint &cp, size_t &d) -> outcome::result<void> {
-        OUTCOME_TRY(header, block_tree_->getBlockHeader(cp.root));
-        auto &parent_root = header.parent_root;
-        OUTCOME_TRY(parent_slot, block_tree_->getSlotByHash(parent_root));
-        cp = {.root = parent_root, .slot = parent_slot};
-        ++d;
-        return outcome::success();
-      };
-
-      while (a.root != b.root) {
-        if (a.slot > b.slot) {
-          OUTCOME_TRY(lift_one(a, da));
-          continue;
-        }
-        if (b.slot > a.slot) {
-          OUTCOME_TRY(lift_one(b, db));
-          continue;
-        }
-        OUTCOME_TRY(lift_one(a, da));
-        OUTCOME_TRY(lift_one(b, db));
+      auto fork =
+          block_tree_->getCommonAncestor(head_.root, lmd_ghost_head.root);
+      if (not fork.has_value()) {
+        OUTCOME_TRY(walked, liftToCommonAncestor(head_, lmd_ghost_head));
+        fork = walked;
       }
 
-      const bool lmd_is_descendant_of_head = (a.root == head_.root);
+      const bool lmd_is_descendant_of_head = fork->index.hash == head_.root;
       if (not lmd_is_descendant_of_head) {
         metrics_->fc_fork_choice_reorgs_total()->inc();
-        metrics_->fc_fork_choice_reorg_depth()->observe(
-            static_cast<double>(std::max(da, db)));
+        metrics_->fc_fork_choice_reorg_depth()->observe(static_cast<double>(
+            std::max(fork->lhs_distance, fork->rhs_distance)));
       }
     }
 
-    head_ = lmd_ghost_head;
+    setHead(lmd_ghost_head);
+    return outcome::success();
+  }
+
+  bool ForkChoiceStore::tryExtendHead(const BlockIndex &block,
+                                      const BlockHash &parent_root) {
+    if (parent_root != head_.root) {
+      return false;
+    }
+    auto anchor = block_tree_->getLatestJustified().root;
+    if (anchor == kZeroHash or not block_tree_->has(anchor)) {
+      anchor = block_tree_->lastFinalized().hash;
+    }
+    if (not proto_array_.extendedHead(anchor, head_.root, block.hash)) {
+      return false;
+    }
+    metrics_->fc_head_extensions_total()->inc();
+    setHead({.root = block.hash, .slot = block.slot});
+    return true;
+  }
+
+  void ForkChoiceStore::setHead(const Checkpoint &head) {
+    head_ = head;
     SL_TRACE(logger_, "Head was set to {}", head_);
+    pinStates();
 
     metrics_->fc_head_slot()->set(head_.slot);
-    return outcome::success();
+    // Tree, checkpoints and known votes are updated before head
+    api_fork_choice_version_.fetch_add(1, std::memory_order_release);
+  }
+
+  outcome::result<blockchain::CommonAncestor>
+  ForkChoiceStore::liftToCommonAncestor(Checkpoint a, Checkpoint b) const {
+    uint32_t da = 0;
+    uint32_t db = 0;
+
+    auto lift_one = [&](Checkpoint &cp, uint32_t &d) -> outcome::result<void> {
+      OUTCOME_TRY(header, block_tree_->getBlockHeader(cp.root));
+      auto &parent_root = header.parent_root;
+      OUTCOME_TRY(parent_slot, block_tree_->getSlotByHash(parent_root));
+      cp = {.root = parent_root, .slot = parent_slot};
+      ++d;
+      return outcome::success();
+    };
+
+    while (a.root != b.root) {
+      if (a.slot > b.slot) {
+        OUTCOME_TRY(lift_one(a, da));
+        continue;
+      }
+      if (b.slot > a.slot) {
+        OUTCOME_TRY(lift_one(b, db));
+        continue;
+      }
+      OUTCOME_TRY(lift_one(a, da));
+      OUTCOME_TRY(lift_one(b, db));
+    }
+
+    return blockchain::CommonAncestor{
+        .index = {.slot = a.slot, .hash = a.root},
+        .lhs_distance = da,
+        .rhs_distance = db,
+    };
   }
 
   outcome::result<void> ForkChoiceStore::acceptNewAttestations() {
     SL_TRACE(logger_,
              "Accepting new {} attestations",
              latest_new_attestations_.size());
-    for (auto &[validator, attestation] : latest_new_attestations_) {
-      latest_known_attestations_[validator] = attestation;
+    for (auto &&[validator, attestation] : latest_new_attestations_) {
+      setKnownAttestation(validator, attestation);
     }
     latest_new_attestations_.clear();
+    proto_array_.clearVotes(ProtoArray::VoteSet::NEW);
     return updateHead();
   }
 
@@ -276,19 +428,36 @@ namespace lean {
   outcome::result<std::shared_ptr<const State>> ForkChoiceStore::getState(
       const BlockHash &block_hash) const {
     SL_TRACE(logger_, "Getting state for block {:xx}", block_hash);
-    auto state = states_.get_else(block_hash, [&]() -> outcome::result<State> {
-      SL_TRACE(logger_, "Loading state for block {}", block_hash);
-      OUTCOME_TRY(state_opt, block_storage_->getState(block_hash));
-      if (state_opt.has_value()) {
-        SL_TRACE(logger_, "State for block {} was loaded", block_hash);
-        return state_opt.value();
-      }
+    if (auto state = states_.get(block_hash)) {
+      metrics_->fc_state_cache_hits_total()->inc();
+      return state.value();
+    }
+    metrics_->fc_state_cache_misses_total()->inc();
+    SL_TRACE(logger_, "Loading state for block {}", block_hash);
+    OUTCOME_TRY(state_opt, block_storage_->getState(block_hash));
+    if (not state_opt.has_value()) {
       SL_TRACE(logger_, "State for block {} not found", block_hash);
       return Error::STATE_NOT_FOUND;
-    });
+    }
+    SL_TRACE(logger_, "State for block {} was loaded", block_hash);
+    auto state = states_.put(block_hash, std::move(state_opt.value()));
+    updateMetricStateCache();
     return state;
   }
 
+  void ForkChoiceStore::prefetchState(const BlockHash &block_hash) const {
+    if (states_.contains(block_hash)) {
+      return;
+    }
+    auto state_res = block_storage_->getState(block_hash);
+    if (state_res.has_error() or not state_res.value().has_value()) {
+      return;
+    }
+    SL_TRACE(logger_, "Prefetched state for block {}", block_hash);
+    states_.put(block_hash, std::move(state_res.value().value()));
+    updateMetricStateCache();
+  }
+
   bool ForkChoiceStore::hasBlock(const BlockHash &hash) const {
     return block_tree_->has(hash);
   }
@@ -361,10 +530,16 @@ namespace lean {
     while (true) {
       auto [target_slot, target_parent] =
           get_slot_and_parent(target_block_root);
-      if (isJustifiableSlot(latest_finalized_slot, target_slot)) {
+      auto justifiable_slot =
+          lastJustifiableSlot(latest_finalized_slot, target_slot);
+      if (justifiable_slot == target_slot) {
         break;
       }
-      target_block_root = target_parent;
+      // Slots in between are not justifiable, so skip their blocks at once
+      auto ancestor =
+          block_tree_->getAncestorAtSlot(target_parent, justifiable_slot);
+      target_block_root =
+          ancestor.has_value() ? ancestor->hash : target_parent;
     }
 
     return Checkpoint{
@@ -395,7 +570,18 @@ namespace lean {
 
   outcome::result<SignedBlock> ForkChoiceStore::produceBlockWithSignatures(
       Slot slot, ValidatorIndex proposer_index) {
-    auto metric_time = metrics_->lean_block_building_time_seconds()->timer();
+    OUTCOME_TRY(job, prepareProduction(slot, proposer_index));
+    OUTCOME_TRY(block_import, produceBlock(job));
+    OUTCOME_TRY(commitBlockImport(block_import));
+    // Imported block is moved back, instead of importing copy
+    return std::move(block_import.signed_block);
+  }
+
+  outcome::result<ForkChoiceStore::ProductionJob>
+  ForkChoiceStore::prepareProduction(Slot slot, ValidatorIndex proposer_index) {
+    ProductionJob job{
+        .timer = metrics_->lean_block_building_time_seconds()->timer(),
+    };
 
     // Get parent block and state to build upon
     auto head_root = head_.root;
@@ -411,44 +597,178 @@ namespace lean {
     if (not keypair.has_value()) {
       return Error::NO_KEYPAIR;
     }
+    job.private_key = keypair->private_key;
+
+    auto prepared = std::exchange(prepared_proposal_, std::nullopt);
+    if (prepared.has_value() and prepared->block.slot == slot
+        and prepared->block.proposer_index == proposer_index
+        and prepared->block.parent_root == head_root
+        and prepared->inputs_version == proposal_inputs_version_) {
+      metrics_->lean_block_building_prepared_hits_total()->inc();
+      job.proposal = std::move(*prepared);
+    } else {
+      if (prepared.has_value()) {
+        metrics_->lean_block_building_prepared_misses_total()->inc();
+      }
+      BOOST_OUTCOME_TRY(job.proposal, selectProposal(slot, proposer_index));
+    }
+    return job;
+  }
 
-    BOOST_OUTCOME_TRY(auto aggregated,
-                      getProposalAttestations(slot, proposer_index, head_root));
-
-    // Create the final block with all collected attestations
-    Block block{
-        .slot = slot,
-        .proposer_index = proposer_index,
-        .parent_root = head_root,
-        // Will be updated with computed hash
-        .state_root = {},
-        .body = {.attestations = aggregated.first},
-    };
-    // Apply state transition to get final post-state and compute state root
-    BOOST_OUTCOME_TRY(auto state,
-                      stf_.stateTransition(block, *head_state, false));
-    block.state_root = sszHash(state);
-    block.setHash();
+  outcome::result<ForkChoiceStore::BlockImport> ForkChoiceStore::produceBlock(
+      ProductionJob &job) const {
+    if (not job.proposal.post_state.has_value()) {
+      BOOST_OUTCOME_TRY(job.proposal, buildProposal(std::move(job.proposal)));
+    }
+    auto &proposal = job.proposal;
+    auto &block = proposal.block;
 
     // Sign proposer attestation
     auto payload = sszHash(block);
     crypto::xmss::XmssSignature proposer_signature =
-        xmss_provider_->sign(keypair->private_key, slot, payload);
+        xmss_provider_->sign(job.private_key, block.slot, payload);
     metrics_->lean_pq_sig_attestation_signatures_total()->inc();
-    SignedBlock signed_block{
-        .block = block,
-        .signature =
+    // Post-state is of block just built, so STF and signature verification
+    // of `prepareBlockImport` are skipped
+    BlockImport block_import{
+        .signed_block =
             {
-                .attestation_signatures = aggregated.second,
-                .proposer_signature = proposer_signature,
+                .block = std::move(block),
+                .signature =
+                    {
+                        .attestation_signatures =
+                            std::move(proposal.attestation_signatures),
+                        .proposer_signature = std::move(proposer_signature),
+                    },
             },
+        .parent_state = std::move(proposal.parent_state),
+        .post_state = std::move(*proposal.post_state),
+        .timer = metrics_->fc_block_processing_time()->timer(),
     };
-    BOOST_OUTCOME_TRY(onBlock(signed_block));
+    storeBlockImport(block_import);
+    return block_import;
+  }
 
+  std::vector<ForkChoiceStore::OnTickAction> ForkChoiceStore::commitProduction(
+      ProductionJob job, outcome::result<BlockImport> block_import) {
+    auto slot = job.proposal.block.slot;
+    auto res = block_import.has_value()
+                 ? commitBlockImport(block_import.value())
+                 : outcome::result<void>{block_import.error()};
+    if (job.deadline.has_value()) {
+      job.deadline->stage("produce block");
+    }
+    reportProduction(slot, res);
+    if (res.has_error()) {
+      return {};
+    }
+    auto &produced_block = block_import.value().signed_block;
     metrics_->lean_block_aggregated_payloads()->observe(
-        signed_block.block.body.attestations.size());
+        produced_block.block.body.attestations.size());
+    SL_TRACE(logger_,
+             "👷 Produced block {} with parent {} and state {}",
+             produced_block.block.index(),
+             produced_block.block.parent_root,
+             produced_block.block.state_root);
+    std::vector<OnTickAction> result;
+    result.emplace_back(std::move(produced_block));
+    return result;
+  }
+
+  void ForkChoiceStore::reportProduction(Slot slot,
+                                         const outcome::result<void> &res) {
+    (res.has_value() ? metrics_->lean_block_building_success_total()
+                     : metrics_->lean_block_building_failures_total())
+        ->inc();
+    if (res.has_error()) {
+      SL_ERROR(logger_,
+               "Failed to produce block for slot {}: {}",
+               slot,
+               res.error());
+    }
+  }
+
+  outcome::result<ForkChoiceStore::PreparedProposal>
+  ForkChoiceStore::selectProposal(Slot slot, ValidatorIndex proposer_index) {
+    auto head_root = head_.root;
+    OUTCOME_TRY(head_state, getState(head_root));
+    BOOST_OUTCOME_TRY(auto aggregated,
+                      getProposalAttestations(slot, proposer_index, head_root));
+
+    // Create the final block with all collected attestations
+    return PreparedProposal{
+        .block =
+            {
+                .slot = slot,
+                .proposer_index = proposer_index,
+                .parent_root = head_root,
+                // Will be updated with computed hash
+                .state_root = {},
+                .body = {.attestations = std::move(aggregated.first)},
+            },
+        .attestation_signatures = std::move(aggregated.second),
+        // Reaggregation of attestations above changes version
+        .inputs_version = proposal_inputs_version_,
+        .parent_state = std::move(head_state),
+    };
+  }
 
-    return signed_block;
+  outcome::result<ForkChoiceStore::PreparedProposal>
+  ForkChoiceStore::buildProposal(PreparedProposal proposal) const {
+    auto &block = proposal.block;
+    // Apply state transition to get final post-state and compute state root
+    auto advanced_state = advancedState(block.parent_root, block.slot);
+    BOOST_OUTCOME_TRY(auto state,
+                      stf_.stateTransition(block,
+                                           *proposal.parent_state,
+                                           false,
+                                           advanced_state.get()));
+    block.state_root = stateRoot(state);
+    block.setHash();
+    proposal.post_state = std::move(state);
+    return proposal;
+  }
+
+  void ForkChoiceStore::prepareProposal(
+      Slot slot, std::optional<PreparedProposal> *deferred_proposal) {
+    auto head_state = getState(head_.root);
+    if (head_state.has_error()) {
+      return;
+    }
+    auto proposer_index = slot % head_state.value()->validatorCount();
+    if (not validator_registry_->isCurrentValidator(proposer_index)) {
+      return;
+    }
+    auto proposal = selectProposal(slot, proposer_index);
+    if (proposal.has_value() and deferred_proposal != nullptr) {
+      deferred_proposal->emplace(std::move(proposal.value()));
+      return;
+    }
+    if (proposal.has_value()) {
+      // Built block starts from advanced state, it is needed without waiting
+      advanceState({
+          .parent_root = head_.root,
+          .parent_state = head_state.value(),
+          .slot = slot,
+      });
+      proposal = buildProposal(std::move(proposal.value()));
+    }
+    storeProposal(slot, std::move(proposal));
+  }
+
+  void ForkChoiceStore::storeProposal(
+      Slot slot, outcome::result<PreparedProposal> proposal) {
+    if (proposal.has_error()) {
+      SL_WARN(logger_,
+              "Failed to prepare block for slot {}: {}",
+              slot,
+              proposal.error());
+      return;
+    }
+    SL_DEBUG(logger_,
+             "Prepared block {} ahead of slot",
+             proposal.value().block.index());
+    prepared_proposal_ = std::move(proposal.value());
   }
 
   outcome::result<std::pair<AggregatedAttestations, AttestationSignatures>>
@@ -459,6 +779,9 @@ namespace lean {
         metrics_->lean_block_building_payload_aggregation_time_seconds()
             ->timer();
 
+    auto reaggregation_deadline =
+        std::chrono::steady_clock::now() + kProposalReaggregationBudget;
+
     OUTCOME_TRY(head_state, getState(parent_root));
     struct SourceThenTarget {
       static auto tie(const AttestationData &v) {
@@ -476,53 +799,111 @@ namespace lean {
       }
     };
     std::set<AttestationData, SourceThenTarget> sorted_data;
-    for (auto &data : latest_known_attestations_ | std::views::values) {
-      if (not block_tree_->has(data.head.root)) {
-        continue;
-      }
-      sorted_data.emplace(data);
-    }
+    latest_known_attestations_.forEachData(
+        [&](const AttestationData &data, size_t) {
+          if (block_tree_->has(data.head.root)) {
+            sorted_data.emplace(data);
+          }
+        });
     AggregatedAttestations aggregated_attestations;
     AttestationSignatures aggregated_proofs;
     auto expected_source = head_state->latest_justified;
+    // Slots and block header are processed once, then attestations of each
+    // accepted group are applied on top, simulating justification
+    // incrementally instead of reprocessing whole block per group
+    auto advanced_state = advancedState(parent_root, slot);
+    auto post_state = advanced_state ? *advanced_state : *head_state;
+    if (post_state.slot != slot) {
+      BOOST_OUTCOME_TRY(stf_.processSlots(post_state, slot));
+    }
+    BOOST_OUTCOME_TRY(stf_.processBlock(post_state,
+                                        {
+                                            .slot = slot,
+                                            .proposer_index = proposer_index,
+                                            .parent_root = parent_root,
+                                            .state_root = {},
+                                            .body = {},
+                                        }));
     for (auto &data : sorted_data) {
       if (data.source != expected_source) {
         continue;
       }
-      auto attestations_it = attestations_by_data_.find(sszHash(data));
-      if (attestations_it == attestations_by_data_.end()) {
+      if (aggregated_attestations.size() >= MAX_ATTESTATIONS_DATA) {
         break;
       }
-      auto &attestations = attestations_it->second;
-      // TODO(zeam): producer may aggregate
-      if (attestations.proofs.empty()) {
-        break;
+      auto attestations_it = attestations_by_data_.find(data);
+      if (attestations_it == attestations_by_data_.end()) {
+        continue;
+      }
+      auto selected = selectProofs(attestations_it->second.proofs);
+      if (selected.empty()) {
+        continue;
       }
 
-      for (auto &proof : attestations.proofs) {
-        aggregated_attestations.push_back({
+      std::vector<AggregatedSignatureProof> proofs;
+      if (selected.size() > 1
+          and std::chrono::steady_clock::now() < reaggregation_deadline) {
+        if (auto proof = reaggregateProofs(*head_state, data, selected)) {
+          proofs.emplace_back(std::move(*proof));
+        }
+      }
+      if (proofs.empty()) {
+        for (auto *proof : selected) {
+          proofs.emplace_back(*proof);
+        }
+      } else {
+        // Reuse merged proof for next aggregation and proposals
+        addProofToAggregate({.data = data, .proof = proofs.front()});
+      }
+      // Proofs are in order of coverage gain, drop least useful ones
+      proofs.resize(std::min(
+          proofs.size(),
+          MAX_ATTESTATIONS_DATA - aggregated_attestations.size()));
+
+      AggregatedAttestations group;
+      for (auto &proof : proofs) {
+        group.push_back({
             .aggregation_bits = proof.participants,
             .data = data,
         });
-        aggregated_proofs.push_back(proof);
+        aggregated_attestations.push_back(group.data().back());
+        aggregated_proofs.push_back(std::move(proof));
       }
 
-      auto post_state = *head_state;
-      BOOST_OUTCOME_TRY(stf_.processSlots(post_state, slot));
-      BOOST_OUTCOME_TRY(stf_.processBlock(
-          post_state,
-          {
-              .slot = slot,
-              .proposer_index = proposer_index,
-              .parent_root = parent_root,
-              .state_root = {},
-              .body = {.attestations = aggregated_attestations},
-          }));
+      BOOST_OUTCOME_TRY(stf_.processAttestations(post_state, group));
       expected_source = post_state.latest_justified;
     }
     return std::make_pair(aggregated_attestations, aggregated_proofs);
   }
 
+  std::optional<AggregatedSignatureProof> ForkChoiceStore::reaggregateProofs(
+      const State &state,
+      const AttestationData &data,
+      std::span<const AggregatedSignatureProof *const> proofs) const {
+    std::vector<std::vector<crypto::xmss::XmssPublicKeyRef>> child_public_keys;
+    std::vector<crypto::xmss::XmssAggregatedSignature> child_proofs;
+    AggregationBits participants;
+    for (auto *proof : proofs) {
+      if (not collectPublicKeys(
+              state, *proof, child_public_keys.emplace_back())) {
+        return std::nullopt;
+      }
+      child_proofs.emplace_back(proof->proof_data);
+      participants.unionWith(proof->participants);
+    }
+    auto proof_data =
+        xmss_provider_->aggregateSignatures(child_public_keys,
+                                            child_proofs,
+                                            {},
+                                            {},
+                                            static_cast<uint32_t>(data.slot),
+                                            attestationPayload(data));
+    return AggregatedSignatureProof{
+        .participants = std::move(participants),
+        .proof_data = std::move(proof_data),
+    };
+  }
+
   outcome::result<void> ForkChoiceStore::validateAttestation(
       const Attestation &attestation) {
     auto has_block = [&](const BlockHash &hash) {
@@ -605,6 +986,15 @@ namespace lean {
 
   outcome::result<void> ForkChoiceStore::onGossipAttestation(
       const SignedAttestation &signed_attestation) {
+    BOOST_OUTCOME_TRY(auto state, beginGossipAttestation(signed_attestation));
+    BOOST_OUTCOME_TRY(verifyGossipAttestation(*state, signed_attestation));
+    commitGossipAttestation(signed_attestation);
+    return outcome::success();
+  }
+
+  outcome::result<std::shared_ptr<const State>>
+  ForkChoiceStore::beginGossipAttestation(
+      const SignedAttestation &signed_attestation) {
     Attestation attestation{
         .validator_id = signed_attestation.validator_id,
         .data = signed_attestation.data,
@@ -614,9 +1004,14 @@ namespace lean {
     if (signed_attestation.validator_id >= state->validators.size()) {
       return Error::INVALID_ATTESTATION;
     }
+    return state;
+  }
+
+  outcome::result<void> ForkChoiceStore::verifyGossipAttestation(
+      const State &state, const SignedAttestation &signed_attestation) const {
     auto payload = attestationPayload(signed_attestation.data);
     auto signature_valid = xmss_provider_->verify(
-        state->validators[signed_attestation.validator_id].attestation_pubkey,
+        state.validators[signed_attestation.validator_id].attestation_pubkey,
         payload,
         signed_attestation.data.slot,
         signed_attestation.signature);
@@ -624,21 +1019,56 @@ namespace lean {
     if (not signature_valid) {
       return Error::INVALID_ATTESTATION;
     }
-    if (is_aggregator_()
-        and validatorSubnet(signed_attestation.validator_id, subnet_count_)
-                == validatorSubnet(validator_id_, subnet_count_)) {
+    return outcome::success();
+  }
+
+  void ForkChoiceStore::setAggregatorDuty(AggregatorDuty duty) {
+    aggregator_duty_ = std::move(duty);
+    if (not aggregator_duty_.peers().empty()) {
+      SL_INFO(logger_,
+              "Aggregation of subnet {} is split with {} other aggregators",
+              validatorSubnet(validator_id_, subnet_count_),
+              aggregator_duty_.peers().size());
+    }
+  }
+
+  void ForkChoiceStore::commitGossipAttestation(
+      const SignedAttestation &signed_attestation) {
+    if (not is_aggregator_()) {
+      return;
+    }
+    auto subnet =
+        validatorSubnet(signed_attestation.validator_id, subnet_count_);
+    if (subnet == validatorSubnet(validator_id_, subnet_count_)
+        or qtils::cxx23::ranges::contains(aggregate_subnets_, subnet)) {
       addSignatureToAggregate(signed_attestation.data,
                               signed_attestation.validator_id,
                               signed_attestation.signature);
     }
-    return outcome::success();
   }
 
   outcome::result<void> ForkChoiceStore::onGossipAggregatedAttestation(
       const SignedAggregatedAttestation &signed_aggregated_attestation) {
-    BOOST_OUTCOME_TRY(auto state,
-                      getState(signed_aggregated_attestation.data.target.root));
-    if (not validateAggregatedSignature(*state,
+    BOOST_OUTCOME_TRY(
+        auto state,
+        beginGossipAggregatedAttestation(signed_aggregated_attestation));
+    if (not verifyGossipAggregatedAttestation(*state,
+                                              signed_aggregated_attestation)) {
+      return Error::INVALID_ATTESTATION;
+    }
+    return onAggregatedAttestation(signed_aggregated_attestation, false);
+  }
+
+  outcome::result<std::shared_ptr<const State>>
+  ForkChoiceStore::beginGossipAggregatedAttestation(
+      const SignedAggregatedAttestation &signed_aggregated_attestation) {
+    return getState(signed_aggregated_attestation.data.target.root);
+  }
+
+  bool ForkChoiceStore::verifyGossipAggregatedAttestation(
+      const State &state,
+      const SignedAggregatedAttestation &signed_aggregated_attestation) const {
+    if (not validateAggregatedSignature(state,
                                         signed_aggregated_attestation.data,
                                         signed_aggregated_attestation.proof)) {
       SL_WARN(logger_,
@@ -647,32 +1077,59 @@ namespace lean {
               signed_aggregated_attestation.data.slot,
               fmt::join(signed_aggregated_attestation.proof.participants.iter(),
                         " "));
-      return outcome::success();
+      return false;
     }
-    return onAggregatedAttestation(signed_aggregated_attestation, false);
+    return true;
   }
 
   outcome::result<void> ForkChoiceStore::onAggregatedAttestation(
       const SignedAggregatedAttestation &signed_aggregated_attestation,
       bool is_from_block) {
-    for (auto &&validator_id :
-         signed_aggregated_attestation.proof.participants.iter()) {
-      // Store the aggregated signature payload against (validator_id,
-      // data_root) This is a list because the same (validator_id, data) can
-      // appear in multiple aggregated attestations, especially when we have
-      // aggregator roles. This list can be recursively aggregated by the
-      // block proposer.
+    auto &data = signed_aggregated_attestation.data;
+    auto participants = signed_aggregated_attestation.proof.participants.iter();
+    std::vector<ValidatorIndex> validators{participants.begin(),
+                                           participants.end()};
+    if (validators.empty()) {
+      return outcome::success();
+    }
+
+    // Store the aggregated signature payload against data root, once for all
+    // participants. The same (validator_id, data) can appear in multiple
+    // aggregated attestations, especially when we have aggregator roles.
+    // These proofs can be recursively aggregated by the block proposer.
+    // Follower neither proposes nor aggregates.
+    if (not follower_) {
       addProofToAggregate(signed_aggregated_attestation);
+    }
 
-      // Import the attestation data into forkchoice for latest votes
-      BOOST_OUTCOME_TRY(onAttestation(
-          Attestation{
-              .validator_id = validator_id,
-              .data = signed_aggregated_attestation.data,
-          },
-          is_from_block));
+    // Data is same for all participants, so it is validated once
+    if (auto res = validateAttestation(Attestation{
+            .validator_id = validators.front(),
+            .data = data,
+        });
+        not res.has_value()) {
+      metrics_->fc_attestations_invalid_total()->inc(
+          static_cast<double>(validators.size()));
+      SL_WARN(logger_,
+              "❌ Invalid aggregated attestation of {} validators for "
+              "target={}, source={}: {}",
+              validators.size(),
+              data.target,
+              data.source,
+              res.error());
+      return res;
     }
-    return outcome::success();
+    metrics_->fc_attestations_valid_total()->inc(
+        static_cast<double>(validators.size()));
+    SL_DEBUG(logger_,
+             "⚙️ Processing valid aggregated attestation of {} validators "
+             "for target={}, source={}",
+             validators.size(),
+             data.target,
+             data.source);
+
+    // Import the attestation data into forkchoice for latest votes
+    return applyAttestationVotes(data, validators, is_from_block);
   }
 
   outcome::result<void> ForkChoiceStore::onAttestation(
@@ -712,10 +1169,21 @@ namespace lean {
 
     // Extract the validator index that produced this attestation.
     auto &validator_id = attestation.validator_id;
+    if (validator_id >= VALIDATOR_REGISTRY_LIMIT) {
+      return Error::INVALID_ATTESTATION;
+    }
 
+    return applyAttestationVotes(
+        attestation.data, {&validator_id, 1}, is_from_block);
+  }
+
+  outcome::result<void> ForkChoiceStore::applyAttestationVotes(
+      const AttestationData &data,
+      std::span<const ValidatorIndex> validators,
+      bool is_from_block) {
     // Extract the attestation's slot:
     // - used to decide if this attestation is "newer" than a previous one.
-    auto &attestation_slot = attestation.data.slot;
+    auto &attestation_slot = data.slot;
 
     if (is_from_block) {
       // On-chain attestation processing
@@ -725,30 +1193,34 @@ namespace lean {
       // - They are processed immediately as "known" attestations,
       // - They contribute to fork choice weights.
 
-      // Fetch the currently known attestation for this validator, if any.
-      auto latest_known_attestation =
-          latest_known_attestations_.find(validator_id);
-
-      // Update the known attestation for this validator if:
+      // Update the known attestation for each validator if:
       // - there is no known attestation yet, or
       // - this attestation is from a later slot than the known one.
-      if (latest_known_attestation == latest_known_attestations_.end()
-          or latest_known_attestation->second.slot < attestation_slot) {
-        latest_known_attestations_.insert_or_assign(validator_id,
-                                                    attestation.data);
+      auto updated = latest_known_attestations_.assign(
+          validators, data, [&](const AttestationData *latest_known) {
+            return latest_known == nullptr
+                or latest_known->slot < attestation_slot;
+          });
+      proto_array_.setVotes(updated, data.head);
+      if (not updated.empty()) {
+        proposalInputsChanged();
       }
 
-      // Fetch any pending ("new") attestation for this validator.
-      auto latest_new_attestation = latest_new_attestations_.find(validator_id);
-
-      // Remove the pending attestation if:
-      // - it exists, and
-      // - it is from an equal or earlier slot than this on-chain attestation.
-      //
-      // In that case, the on-chain attestation supersedes it.
-      if (latest_new_attestation != latest_new_attestations_.end()
-          and latest_new_attestation->second.slot <= attestation_slot) {
-        latest_new_attestations_.erase(latest_new_attestation);
+      for (auto validator_id : validators) {
+        // Fetch any pending ("new") attestation for this validator.
+        auto latest_new_attestation =
+            latest_new_attestations_.find(validator_id);
+
+        // Remove the pending attestation if:
+        // - it exists, and
+        // - it is from an equal or earlier slot than this on-chain
+        //   attestation.
+        //
+        // In that case, the on-chain attestation supersedes it.
+        if (latest_new_attestation != nullptr
+            and latest_new_attestation->slot <= attestation_slot) {
+          eraseNewAttestation(validator_id);
+        }
       }
     } else {
       // Network gossip attestation processing
@@ -767,17 +1239,14 @@ namespace lean {
         return Error::INVALID_ATTESTATION;
       }
 
-      // Fetch the previously stored "new" attestation for this validator.
-      auto latest_new_attestation = latest_new_attestations_.find(validator_id);
-
-      // Update the pending attestation for this validator if:
+      // Update the pending attestation for each validator if:
       // - there is no pending attestation yet, or
       // - this one is from a later slot than the pending one.
-      if (latest_new_attestation == latest_new_attestations_.end()
-          or latest_new_attestation->second.slot < attestation_slot) {
-        latest_new_attestations_.insert_or_assign(validator_id,
-                                                  attestation.data);
-      }
+      auto updated = latest_new_attestations_.assign(
+          validators, data, [&](const AttestationData *latest_new) {
+            return latest_new == nullptr or latest_new->slot < attestation_slot;
+          });
+      proto_array_.setVotes(updated, data.head, ProtoArray::VoteSet::NEW);
     }
 
     return outcome::success();
@@ -785,66 +1254,67 @@ namespace lean {
 
   bool ForkChoiceStore::validateBlockSignatures(
       const SignedBlock &signed_block) const {
-    // Unpack the signed block components
-    const auto &block = signed_block.block;
-    const auto &signatures = signed_block.signature;
-
-    // Combine all attestations that need verification
-
-    // This creates a single list containing both:
-    // 1. Block body attestations (from other validators)
-    // 2. Proposer attestation (from the block producer)
-    auto &aggregated_attestations = block.body.attestations;
-    auto &attestation_signatures =
-        signed_block.signature.attestation_signatures;
-
-    // Verify signature count matches attestation count
-    //
-    // Each attestation must have exactly one corresponding signature.
-    //
-    // The ordering must be preserved:
-    // 1. Block body attestations,
-    // 2. The proposer attestation.
-    if (attestation_signatures.size() != aggregated_attestations.size()) {
-      SL_WARN(logger_,
-              "Number of signatures does not match number of attestations: "
-              "{} signatures != {} attestations",
-              attestation_signatures.size(),
-              aggregated_attestations.size());
-      return false;
-    }
-
     // Retrieve parent state to access validator public keys
     //
     // We use the parent state because:
     // - Validator set is determined at the parent block
     // - Public keys must be registered before signing
     // - State root is committed in the block header
-    auto parent_state_res = getState(block.parent_root);
+    auto parent_state_res = getState(signed_block.block.parent_root);
     if (parent_state_res.has_error()) {
       SL_WARN(logger_,
               "Parent state not found for block {}: {}",
-              block.index(),
+              signed_block.block.index(),
               parent_state_res.error());
       return false;
     }
-    auto &parent_state = *parent_state_res.value();
-    const auto &validators = parent_state.validators;
+    return validateBlockSignatures(signed_block, *parent_state_res.value());
+  }
 
-    for (auto &&[aggregated_attestation, aggregated_signature] :
-         std::views::zip(aggregated_attestations, attestation_signatures)) {
-      if (not validateAggregatedSignature(parent_state,
-                                          aggregated_attestation.data,
-                                          aggregated_signature)) {
-        return false;
-      }
+  bool ForkChoiceStore::validateBlockSignatures(
+      const SignedBlock &signed_block, const State &parent_state) const {
+    // Proposer signature is single one, check it before batch of proofs
+    if (not validateProposerSignature(signed_block, parent_state)
+        or not validateBlockAttestationSignatures(signed_block,
+                                                  parent_state)) {
+      return false;
     }
-    auto payload = sszHash(block);
+    SL_TRACE(logger_,
+             "All block signatures are valid in block {}",
+             signed_block.block.index());
+    return true;
+  }
 
-    bool verify_result = xmss_provider_->verify(
-        validators.data().at(block.proposer_index).proposal_pubkey,
-        payload,
-        block.slot,
+  outcome::result<void> ForkChoiceStore::validateBlockProposer(
+      const SignedBlock &signed_block, const State &parent_state) const {
+    auto &block = signed_block.block;
+    if (not isProposer(
+            block.proposer_index, block.slot, parent_state.validatorCount())) {
+      SL_WARN(logger_,
+              "Block {} proposed by validator {} out of turn",
+              block.index(),
+              block.proposer_index);
+      return Error::INVALID_PROPOSER;
+    }
+    if (not validateProposerSignature(signed_block, parent_state)) {
+      return Error::INVALID_ATTESTATION;
+    }
+    return outcome::success();
+  }
+
+  bool ForkChoiceStore::validateProposerSignature(
+      const SignedBlock &signed_block, const State &parent_state) const {
+    auto &block = signed_block.block;
+    if (block.proposer_index >= parent_state.validators.size()) {
+      SL_WARN(logger_, "Proposer index {} out of range", block.proposer_index);
+      return false;
+    }
+    auto payload = sszHash(block);
+
+    bool verify_result = xmss_provider_->verify(
+        parent_state.validators.data().at(block.proposer_index).proposal_pubkey,
+        payload,
+        block.slot,
         signed_block.signature.proposer_signature);
     updateMetricAttestationSignature(verify_result);
 
@@ -854,23 +1324,139 @@ namespace lean {
               block.proposer_index);
       return false;
     }
-    SL_TRACE(
-        logger_, "All block signatures are valid in block {}", block.index());
     return true;
   }
 
-  bool ForkChoiceStore::validateAggregatedSignature(
+  bool ForkChoiceStore::validateBlockAttestationSignatures(
+      const SignedBlock &signed_block, const State &parent_state) const {
+    auto timer = metrics_->fc_block_signatures_time()->timer();
+    LEAN_TRACE_SPAN("fork_choice", "block signatures");
+
+    // Unpack the signed block components
+    const auto &block = signed_block.block;
+
+    // Combine all attestations that need verification
+
+    // This creates a single list containing both:
+    // 1. Block body attestations (from other validators)
+    // 2. Proposer attestation (from the block producer)
+    auto &aggregated_attestations = block.body.attestations;
+    auto &attestation_signatures =
+        signed_block.signature.attestation_signatures;
+
+    // Verify signature count matches attestation count
+    //
+    // Each attestation must have exactly one corresponding signature.
+    //
+    // The ordering must be preserved:
+    // 1. Block body attestations,
+    // 2. The proposer attestation.
+    if (attestation_signatures.size() != aggregated_attestations.size()) {
+      SL_WARN(logger_,
+              "Number of signatures does not match number of attestations: "
+              "{} signatures != {} attestations",
+              attestation_signatures.size(),
+              aggregated_attestations.size());
+      return false;
+    }
+
+    // Verify all aggregated attestations not seen before in one batch.
+    // Transient buffers of block live in one arena, keys of all proofs in
+    // one reserved vector, so spans of verify items stay valid.
+    size_t participants = 0;
+    for (auto &aggregated_signature : attestation_signatures) {
+      participants += aggregated_signature.participants.count();
+    }
+    using VerifyingProof = std::pair<Hash, const AggregatedSignatureProof *>;
+    std::pmr::monotonic_buffer_resource arena{
+        participants * sizeof(crypto::xmss::XmssPublicKeyRef)
+        + attestation_signatures.size()
+              * (sizeof(crypto::xmss::XmssVerifyItem) + sizeof(VerifyingProof))
+        + alignof(std::max_align_t) * 3};
+    std::pmr::vector<crypto::xmss::XmssPublicKeyRef> public_keys{&arena};
+    std::pmr::vector<crypto::xmss::XmssVerifyItem> verify_items{&arena};
+    std::pmr::vector<VerifyingProof> verifying{&arena};
+    public_keys.reserve(participants);
+    verify_items.reserve(aggregated_attestations.size());
+    verifying.reserve(aggregated_attestations.size());
+    for (auto &&[aggregated_attestation, aggregated_signature] :
+         std::views::zip(aggregated_attestations, attestation_signatures)) {
+      auto key =
+          verifiedProofKey(aggregated_attestation.data, aggregated_signature);
+      if (verified_proofs_.get(key).has_value()) {
+        metrics_->fc_verified_proofs_cache_hits_total()->inc();
+        continue;
+      }
+      auto keys_begin = public_keys.size();
+      if (not collectPublicKeys(
+              parent_state, aggregated_signature, public_keys)) {
+        return false;
+      }
+      if (follower_ and not followerSamples(key)) {
+        metrics_->fc_follower_unverified_proofs_total()->inc();
+        continue;
+      }
+      verify_items.emplace_back(crypto::xmss::XmssVerifyItem{
+          .public_keys = std::span{public_keys}.subspan(keys_begin),
+          .epoch = static_cast<uint32_t>(aggregated_attestation.data.slot),
+          .message = attestationPayload(aggregated_attestation.data),
+          .aggregated_signature = aggregated_signature.proof_data.data(),
+      });
+      verifying.emplace_back(key, &aggregated_signature);
+    }
+    auto verify_results = xmss_provider_->verifyBatch(verify_items);
+    for (auto &&[valid, verified] :
+         std::views::zip(verify_results, verifying)) {
+      auto &[key, aggregated_signature] = verified;
+      if (not valid) {
+        SL_WARN(logger_,
+                "Aggregated signature verification failed for validators [{}]",
+                fmt::join(aggregated_signature->participants.iter(), " "));
+        return false;
+      }
+      verified_proofs_.put(key, true);
+    }
+    return true;
+  }
+
+  template <typename PublicKeys>
+  bool ForkChoiceStore::collectPublicKeys(
       const State &state,
-      const AttestationData &attestation,
-      const AggregatedSignatureProof &signature) const {
-    std::vector<crypto::xmss::XmssPublicKey> public_keys;
+      const AggregatedSignatureProof &signature,
+      PublicKeys &public_keys) const {
     for (auto &&validator_id : signature.participants.iter()) {
       if (validator_id >= state.validators.size()) {
         SL_WARN(logger_, "Validator index {} out of range", validator_id);
         return false;
       }
       public_keys.emplace_back(
-          state.validators.data().at(validator_id).attestation_pubkey);
+          &state.validators.data().at(validator_id).attestation_pubkey);
+    }
+    return true;
+  }
+
+  Hash ForkChoiceStore::verifiedProofKey(
+      const AttestationData &attestation,
+      const AggregatedSignatureProof &signature) {
+    return sszHash(VerifiedProofKey{
+        .message = attestationPayload(attestation),
+        .proof_root = sszHash(signature),
+    });
+  }
+
+  bool ForkChoiceStore::validateAggregatedSignature(
+      const State &state,
+      const AttestationData &attestation,
+      const AggregatedSignatureProof &signature) const {
+    auto key = verifiedProofKey(attestation, signature);
+    if (verified_proofs_.get(key).has_value()) {
+      metrics_->fc_verified_proofs_cache_hits_total()->inc();
+      return true;
+    }
+    std::vector<crypto::xmss::XmssPublicKeyRef> public_keys;
+    public_keys.reserve(signature.participants.count());
+    if (not collectPublicKeys(state, signature, public_keys)) {
+      return false;
     }
     auto message = attestationPayload(attestation);
     Epoch epoch = attestation.slot;
@@ -882,21 +1468,29 @@ namespace lean {
               fmt::join(signature.participants.iter(), " "));
       return false;
     }
+    verified_proofs_.put(key, true);
     return true;
   }
 
   outcome::result<void> ForkChoiceStore::onBlock(SignedBlock signed_block) {
+    OUTCOME_TRY(block_import, beginBlockImport(std::move(signed_block)));
+    if (not block_import.has_value()) {
+      return outcome::success();
+    }
+    OUTCOME_TRY(prepareBlockImport(*block_import));
+    return commitBlockImport(*block_import);
+  }
+
+  outcome::result<std::optional<ForkChoiceStore::BlockImport>>
+  ForkChoiceStore::beginBlockImport(SignedBlock &&signed_block) {
     auto &block = signed_block.block;
     block.setHash();
-    auto block_hash = block.hash();
 
     // If the block is already known, ignore it
-    if (block_tree_->has(block_hash)) {
-      return outcome::success();
+    if (block_tree_->has(block.hash())) {
+      return std::nullopt;
     }
 
-    auto &signatures = signed_block.signature;
-
     auto timer = metrics_->fc_block_processing_time()->timer();
 
     // Verify parent-chain is available
@@ -909,30 +1503,142 @@ namespace lean {
     // at this point parent state should be available so node should sync
     // parent-chain if not available before adding block to forkchoice
 
-    auto valid_signatures = validateBlockSignatures(signed_block);
+    return BlockImport{
+        .signed_block = std::move(signed_block),
+        .parent_state = std::move(parent_state),
+        .timer = std::move(timer),
+    };
+  }
+
+  outcome::result<std::vector<ForkChoiceStore::BlockImport>>
+  ForkChoiceStore::beginSegmentImport(std::vector<SignedBlock> signed_blocks) {
+    std::vector<BlockImport> block_imports;
+    block_imports.reserve(signed_blocks.size());
+    std::optional<BlockHash> previous;
+    for (auto &signed_block : signed_blocks) {
+      auto &block = signed_block.block;
+      block.setHash();
+      if (previous.has_value() and block.parent_root != *previous) {
+        return Error::SEGMENT_NOT_CHAINED;
+      }
+      previous = block.hash();
+      if (not block_imports.empty()) {
+        block_imports.emplace_back(BlockImport{
+            .signed_block = std::move(signed_block),
+            .timer = metrics_->fc_block_processing_time()->timer(),
+        });
+        continue;
+      }
+      OUTCOME_TRY(block_import, beginBlockImport(std::move(signed_block)));
+      if (block_import.has_value()) {
+        block_imports.emplace_back(std::move(*block_import));
+      }
+    }
+    return block_imports;
+  }
+
+  outcome::result<void> ForkChoiceStore::prepareBlockImport(
+      BlockImport &block_import) const {
+    auto &signed_block = block_import.signed_block;
+    auto &block = signed_block.block;
+    auto &parent_state = *block_import.parent_state;
+
+    auto valid_signatures = validateBlockSignatures(signed_block, parent_state);
     if (not valid_signatures) {
       SL_WARN(logger_, "Invalid signatures for block {}", block.index());
       return Error::INVALID_ATTESTATION;
     }
 
+    OUTCOME_TRY(applyBlockImport(block_import, parent_state));
+    storeBlockImport(block_import);
+    return outcome::success();
+  }
+
+  outcome::result<void> ForkChoiceStore::applyBlockImport(
+      BlockImport &block_import, const State &parent_state) const {
     // Get post-state from STF (State Transition Function)
-    BOOST_OUTCOME_TRY(auto post_state,
-                      stf_.stateTransition(block, *parent_state, true));
+    LEAN_TRACE_SPAN("fork_choice", "state transition");
+    auto &block = block_import.signed_block.block;
+    auto advanced_state = advancedState(block.parent_root, block.slot);
+    BOOST_OUTCOME_TRY(
+        block_import.post_state,
+        stf_.stateTransition(block, parent_state, true, advanced_state.get()));
+    return outcome::success();
+  }
 
-    // Add block
-    SL_TRACE(logger_, "Adding block {} into block tree", block.index());
-    OUTCOME_TRY(block_tree_->addBlock(signed_block));
+  std::shared_ptr<const State> ForkChoiceStore::advancedState(
+      const BlockHash &parent_root, Slot slot) const {
+    auto state = advanced_state_.get(parent_root, slot);
+    if (state != nullptr) {
+      metrics_->fc_state_advance_hits_total()->inc();
+    } else {
+      metrics_->fc_state_advance_misses_total()->inc();
+    }
+    return state;
+  }
 
-    // Store state
+  void ForkChoiceStore::advanceState(const StateAdvanceJob &job) const {
+    if (advanced_state_.contains(job.parent_root, job.slot)
+        or job.parent_state->slot >= job.slot) {
+      return;
+    }
+    LEAN_TRACE_SPAN("fork_choice", "advance state");
+    auto state = *job.parent_state;
+    auto res = stf_.processSlots(state, job.slot);
+    if (res.has_error()) {
+      SL_WARN(logger_,
+              "Failed to advance state of {} to slot {}: {}",
+              job.parent_root,
+              job.slot,
+              res.error());
+      return;
+    }
+    advanced_state_.put(job.parent_root,
+                        std::make_shared<const State>(std::move(state)));
+  }
+
+  void ForkChoiceStore::storeBlockImport(
+      const BlockImport &block_import) const {
+    auto &block = block_import.signed_block.block;
     SL_TRACE(logger_, "Adding post-state for block {}", block.index());
     // OUTCOME_TRY(block_storage_->putState(block_hash, post_state));
-    auto res = block_storage_->putState(block_hash, post_state);
+    auto res = [&] {
+      auto timer = metrics_->fc_block_put_state_time()->timer();
+      LEAN_TRACE_SPAN("fork_choice", "put state");
+      return block_storage_->putState(block.hash(), block_import.post_state);
+    }();
     if (res.has_error()) {
       SL_WARN(
           logger_, "Failed to store post-state for block {}", block.index());
     } else {
       SL_TRACE(logger_, "Stored post-state for block {}", block.index());
     }
+  }
+
+  outcome::result<void> ForkChoiceStore::commitBlockImport(
+      BlockImport &block_import, bool update_head) {
+    auto &signed_block = block_import.signed_block;
+    auto &block = signed_block.block;
+    auto block_hash = block.hash();
+    auto &post_state = block_import.post_state;
+
+    // Same block may have been imported while lock was released
+    if (block_tree_->has(block_hash)) {
+      return outcome::success();
+    }
+
+    // Add block
+    SL_TRACE(logger_, "Adding block {} into block tree", block.index());
+    {
+      auto timer = metrics_->fc_block_add_time()->timer();
+      LEAN_TRACE_SPAN("fork_choice", "add block");
+      OUTCOME_TRY(block_tree_->addBlock(signed_block));
+      proposalInputsChanged();
+    }
+    if (not proto_array_.empty()) {
+      proto_array_.addBlock({.slot = block.slot, .hash = block_hash},
+                            block.parent_root);
+    }
 
     // If post-state has a higher justified checkpoint, update it to the store.
     if (post_state.latest_justified.slot
@@ -951,10 +1657,12 @@ namespace lean {
           post_state.latest_finalized.slot);
 
       prune(post_state.latest_finalized.slot);
+      proto_array_.prune(post_state.latest_finalized.root);
     }
 
     // Cache state
-    states_.put(block_hash, post_state);
+    states_.put(block_hash, std::move(post_state));
+    updateMetricStateCache();
 
     // Process block body attestations
     auto &aggregated_attestations = signed_block.block.body.attestations;
@@ -977,13 +1685,24 @@ namespace lean {
 
     // IMPORTANT: This must happen BEFORE processing proposer attestation
     // to prevent the proposer from gaining circular weight advantage.
-    OUTCOME_TRY(updateHead());
+    // Common case of block on head with no new votes skips full update
+    if (update_head
+        and not tryExtendHead({.slot = block.slot, .hash = block_hash},
+                              block.parent_root)) {
+      OUTCOME_TRY(updateHead());
+    }
 
     return outcome::success();
   }
 
   std::vector<ForkChoiceStore::OnTickAction> ForkChoiceStore::onTick(
-      std::chrono::milliseconds now) {
+      std::chrono::milliseconds now,
+      std::vector<AggregationJob> *deferred_aggregation,
+      std::optional<StateAdvanceJob> *deferred_state_advance,
+      std::optional<ForkChoiceSnapshot> *deferred_snapshot,
+      std::optional<AttestationJob> *deferred_attestation,
+      std::optional<ProductionJob> *deferred_production,
+      std::optional<PreparedProposal> *deferred_proposal) {
     auto now_interval = Interval::fromTime(now, config_);
     if (not now_interval.has_value()) {
       SL_WARN(logger_, "Can't tick before genesis");
@@ -1001,9 +1720,38 @@ namespace lean {
     auto validator_count = head_state->validatorCount();
 
     std::vector<OnTickAction> result{};
+    auto tick_start = IntervalDeadline::Clock::now();
     while (time_.interval < now_interval->interval) {
       ++time_.interval;
+      // Later intervals of catch-up start after work of previous ones
+      IntervalDeadline deadline{
+          logger_,
+          *metrics_,
+          time_,
+          now - time_.time(config_)
+              + (IntervalDeadline::Clock::now() - tick_start),
+      };
       Slot current_slot = time_.slot();
+      // After stall, duties of slots which are over are obsolete. Only
+      // attestations and safe target are still updated for them.
+      auto stale = current_slot < now_interval->slot();
+      auto run_aggregation = [&](bool fallback) {
+        auto jobs = prepareAggregation(fallback);
+        deadline.stage("prepare aggregation");
+        if (deferred_aggregation != nullptr) {
+          if (not jobs.empty()) {
+            // Finished by `importAggregations` after caller aggregates
+            deferred_deadline_.emplace(std::move(deadline));
+          }
+          std::ranges::move(jobs, std::back_inserter(*deferred_aggregation));
+        } else {
+          std::ranges::move(importAggregations(aggregate(jobs)),
+                            std::back_inserter(result));
+          deadline.stage("aggregate");
+        }
+      };
+      log::recordFlightEvent(
+          log::FlightEventKind::INSTANT, "interval", time_.interval);
       metrics_->fc_current_slot()->set(current_slot);
       if (time_.phase() == 0) {
         [[unlikely]] if (current_slot == 0) {
@@ -1012,11 +1760,15 @@ namespace lean {
         }
         // Slot start
         SL_DEBUG(logger_, "Slot {} started", current_slot);
+        updateMetricMemory();
         auto producer_index = current_slot % validator_count;
         auto is_producer =
-            validator_registry_->currentValidatorIndices().contains(
-                producer_index);
+            validator_registry_->isCurrentValidator(producer_index);
 
+        if (is_producer and not dont_propose_ and stale) {
+          skipStaleDuty("propose", current_slot);
+          continue;
+        }
         if (is_producer and not dont_propose_) {
           SL_TRACE(logger_,
                    "Interval 0 of slot {}: node is producer - try to produce",
@@ -1027,31 +1779,32 @@ namespace lean {
                     "Failed to accept new attestations: {}",
                     ana_res.error());
           }
+          deadline.stage("accept attestations");
 
           SL_TRACE(logger_,
                    "Trying to produced block on slot {} by producer index {}",
                    current_slot,
                    producer_index);
-          auto res = produceBlockWithSignatures(current_slot, producer_index);
-          (res.has_value() ? metrics_->lean_block_building_success_total()
-                           : metrics_->lean_block_building_failures_total())
-              ->inc();
-          if (!res.has_value()) {
-            SL_ERROR(logger_,
-                     "Failed to produce block for slot {}: {}",
-                     current_slot,
-                     res.error());
+          auto job = prepareProduction(current_slot, producer_index);
+          if (job.has_error()) {
+            deadline.stage("produce block");
+            reportProduction(current_slot, job.error());
             continue;
           }
-          auto &produced_block = res.value();
-
-          SL_TRACE(logger_,
-                   "👷 Produced block {} with parent {} and state {}",
-                   produced_block.block.index(),
-                   produced_block.block.parent_root,
-                   produced_block.block.state_root);
-          result.emplace_back(std::move(produced_block));
-
+          if (deferred_production != nullptr) {
+            // Later intervals tick after caller imports block
+            job.value().deadline.emplace(std::move(deadline));
+            deferred_production->emplace(std::move(job.value()));
+            break;
+          }
+          auto block_import = produceBlock(job.value());
+          auto produced =
+              commitProduction(std::move(job.value()), std::move(block_import));
+          deadline.stage("produce block");
+          if (produced.empty()) {
+            continue;
+          }
+          std::ranges::move(produced, std::back_inserter(result));
 
           head_state_res = getState(head_.root);
           if (head_state_res.has_error()) {
@@ -1076,6 +1829,15 @@ namespace lean {
                   "Failed to accept new attestations: {}",
                   ana_res.error());
         }
+        deadline.stage("accept attestations");
+
+        if (stale) {
+          if (not dont_propose_
+              and not validator_registry_->currentValidatorIndices().empty()) {
+            skipStaleDuty("attest", current_slot);
+          }
+          continue;
+        }
 
         Checkpoint head = head_;
         auto target =
@@ -1093,9 +1855,25 @@ namespace lean {
           continue;
         }
 
-        auto metric_time =
-            metrics_->lean_attestations_production_time_seconds()->timer();
-        std::optional<Attestation> attestation;
+        // All validators vote the same way, local ones and ones of
+        // validator processes served by api
+        auto attestation = produceAttestation(
+            current_slot, 0, getLatestJustified(), head_, std::nullopt);
+        auto valid_res = validateAttestation(attestation);
+        if (not valid_res.has_value()) {
+          SL_ERROR(logger_,
+                   "Failed to process attestation for slot {}: {}",
+                   current_slot,
+                   valid_res.error());
+          continue;
+        }
+        attestation_duty_ = attestation.data;
+
+        AttestationJob job{
+            .attestation = attestation,
+            .timer =
+                metrics_->lean_attestations_production_time_seconds()->timer(),
+        };
         for (auto validator_index :
              validator_registry_->currentValidatorIndices()) {
           if (dont_propose_) {
@@ -1108,50 +1886,39 @@ namespace lean {
           if (not keypair.has_value()) {
             continue;
           }
-          if (not attestation.has_value()) {
-            attestation = produceAttestation(current_slot,
-                                             validator_index,
-                                             getLatestJustified(),
-                                             head_,
-                                             std::nullopt);
-          }
-          // sign attestation
-          auto payload = attestationPayload(attestation->data);
-          crypto::xmss::XmssSignature signature =
-              xmss_provider_->sign(keypair->private_key, current_slot, payload);
-          metrics_->lean_pq_sig_attestation_signatures_total()->inc();
-          auto signed_attestation =
-              SignedAttestation::from(*attestation, signature);
-
-          // Dispatching send signed vote-only broadcasts to other peers.
-          // Current peer should process attestation directly
-          auto res = onGossipAttestation(signed_attestation);
-          if (not res.has_value()) {
-            SL_ERROR(logger_,
-                     "Failed to process attestation for slot {}: {}",
-                     current_slot,
-                     res.error());
-            continue;
-          }
-          SL_DEBUG(logger_,
-                   "Produced vote for target={}",
-                   signed_attestation.data.target);
-          result.emplace_back(signed_attestation);
+          job.signers.emplace_back(validator_index);
+          job.sign_items.emplace_back(crypto::xmss::XmssSignItem{
+              .private_key = keypair->private_key,
+              .epoch = static_cast<uint32_t>(current_slot),
+          });
+        }
+        if (job.signers.empty()) {
+          continue;
+        }
+        auto payload = attestationPayload(attestation.data);
+        for (auto &item : job.sign_items) {
+          item.message = payload;
+        }
+
+        if (deferred_attestation != nullptr) {
+          // Finished by `commitAttestations` after caller signs
+          job.deadline.emplace(std::move(deadline));
+          deferred_attestation->emplace(std::move(job));
+        } else {
+          auto signatures = signAttestations(job);
+          deadline.stage("sign attestations");
+          std::ranges::move(
+              commitAttestations(std::move(job), std::move(signatures)),
+              std::back_inserter(result));
+          deadline.stage("commit attestations");
         }
 
       } else if (time_.phase() == 2) {
         SL_TRACE(logger_, "Interval 2 of slot {}: aggregate", current_slot);
-        if (is_aggregator_()) {
-          auto aggregated_attestations = aggregateSignatures();
-          for (auto &aggregated_attestation : aggregated_attestations) {
-            auto res = onGossipAggregatedAttestation(aggregated_attestation);
-            if (not res.has_value()) {
-              SL_WARN(
-                  logger_, "failed to import own aggregation: {}", res.error());
-              continue;
-            }
-            result.emplace_back(aggregated_attestation);
-          }
+        if (is_aggregator_() and stale) {
+          skipStaleDuty("aggregate", current_slot);
+        } else if (is_aggregator_()) {
+          run_aggregation(false);
         }
       } else if (time_.phase() == 3) {
         SL_TRACE(logger_,
@@ -1162,6 +1929,13 @@ namespace lean {
         if (res.has_error()) {
           SL_WARN(logger_, "Failed to update safe-target: {}", res.error());
         }
+        deadline.stage("update safe target");
+
+        // Assigned aggregator of group may be offline
+        if (is_aggregator_() and not stale
+            and not aggregator_duty_.peers().empty()) {
+          run_aggregation(true);
+        }
 
       } else if (time_.phase() == 4) {
         SL_TRACE(logger_,
@@ -1174,11 +1948,89 @@ namespace lean {
                   "Failed to accept new attestations: {}",
                   ana_res.error());
         }
+        deadline.stage("accept attestations");
+
+        // Head is final for interval 0 of next slot unless block arrives
+        // late. Only when caught up, advance for missed slots is wasted.
+        if (time_.interval == now_interval->interval) {
+          if (not dont_propose_) {
+            prepareProposal(current_slot + 1, deferred_proposal);
+            deadline.stage("prepare proposal");
+          }
+          auto advance_head_state = getState(head_.root);
+          if (advance_head_state.has_value()) {
+            StateAdvanceJob job{
+                .parent_root = head_.root,
+                .parent_state = advance_head_state.value(),
+                .slot = current_slot + 1,
+            };
+            if (deferred_state_advance != nullptr) {
+              *deferred_state_advance = std::move(job);
+            } else {
+              advanceState(job);
+              deadline.stage("advance state");
+            }
+          }
+        }
+
+        // Only when caught up, replaying missed intervals saves nothing new
+        if (snapshots_enabled_
+            and (current_slot + 1) % kSnapshotIntervalSlots == 0
+            and time_.interval == now_interval->interval) {
+          auto snapshot = makeSnapshot();
+          deadline.stage("make snapshot");
+          if (deferred_snapshot != nullptr) {
+            *deferred_snapshot = std::move(snapshot);
+          } else {
+            writeSnapshot(snapshot);
+            deadline.stage("save snapshot");
+          }
+        }
       }
     }
     return result;
   }
 
+  std::vector<Signature> ForkChoiceStore::signAttestations(
+      const AttestationJob &job) const {
+    // sign attestations of all local validators concurrently
+    return xmss_provider_->signBatch(job.sign_items);
+  }
+
+  std::vector<ForkChoiceStore::OnTickAction>
+  ForkChoiceStore::commitAttestations(AttestationJob job,
+                                      std::vector<Signature> signatures) {
+    if (job.deadline.has_value()) {
+      job.deadline->stage("sign attestations");
+    }
+    std::vector<OnTickAction> result;
+    auto &attestation = job.attestation;
+    for (auto &&[validator_index, signature] :
+         std::views::zip(job.signers, signatures)) {
+      metrics_->lean_pq_sig_attestation_signatures_total()->inc();
+      attestation.validator_id = validator_index;
+      auto signed_attestation = SignedAttestation::from(attestation, signature);
+
+      // Dispatching send signed vote-only broadcasts to other peers.
+      // Current peer processes own attestation directly, its signature
+      // was just made and is not verified again
+      commitGossipAttestation(signed_attestation);
+      SL_DEBUG(logger_,
+               "Produced vote for target={}",
+               signed_attestation.data.target);
+      result.emplace_back(std::move(signed_attestation));
+    }
+    if (job.deadline.has_value()) {
+      job.deadline->stage("commit attestations");
+    }
+    return result;
+  }
+
+  void ForkChoiceStore::skipStaleDuty(std::string_view duty, Slot slot) {
+    SL_DEBUG(logger_, "Skip {} duty of past slot {}", duty, slot);
+    metrics_->fc_skipped_duties_total({{"duty", std::string{duty}}})->inc();
+  }
+
   outcome::result<BlockHash> ForkChoiceStore::computeLmdGhostHead(
       const BlockHash &start_root,
       const AttestationDataByValidator &attestations,
@@ -1202,7 +2054,7 @@ namespace lean {
 
     // Each entry starts conceptually at zero and then accumulates
     // contributions.
-    std::unordered_map<BlockHash, uint64_t> weights;
+    BlockHashMap<uint64_t> weights;
     auto get_weight = [&](const BlockHash &hash) {
       auto it = weights.find(hash);
       return it != weights.end() ? it->second : 0;
@@ -1211,26 +2063,20 @@ namespace lean {
     // For every vote, follow the chosen head upward through its ancestors.
 
     // Each visited block accumulates one unit of weight from that validator.
-    for (auto &attestation : attestations | std::views::values) {
+    // Validators with same vote are counted at once.
+    attestations.forEachData([&](const AttestationData &attestation,
+                                 size_t voters) {
       // Climb towards the anchor while staying inside the known tree.
       // This naturally handles partial views and ongoing sync.
-      for (auto current = attestation.head.root;;) {
-        auto current_header_res = block_tree_->tryGetBlockHeader(current);
-        if (current_header_res.has_failure()) {
-          break;
-        }
-        auto &current_header_opt = current_header_res.value();
-        if (!current_header_opt) {
-          break;
-        }
-        auto &current_header = current_header_opt.value();
-        if (current_header.slot <= start_slot) {
-          break;
-        }
-        ++weights[current];
-        current = current_header.parent_root;
-      }
-    }
+      block_tree_->forEachNonFinalizedAncestor(
+          attestation.head.root, [&](const blockchain::BlockTreeEntry &block) {
+            if (block.index.slot <= start_slot) {
+              return false;
+            }
+            weights[block.index.hash] += voters;
+            return true;
+          });
+    });
 
     auto head = anchor;
     for (;;) {
@@ -1269,6 +2115,210 @@ namespace lean {
     }
   }
 
+  outcome::result<BlockHash> ForkChoiceStore::findHead(
+      const BlockHash &start_root) {
+    auto anchor = start_root;
+    if (anchor == kZeroHash or not block_tree_->has(anchor)) {
+      anchor = block_tree_->lastFinalized().hash;
+    }
+    if (not proto_array_.contains(anchor)) {
+      OUTCOME_TRY(rebuildProtoArray());
+    }
+    if (auto head = proto_array_.findHead(anchor); head.has_value()) {
+      return head.value();
+    }
+    return computeLmdGhostHead(anchor, latest_known_attestations_, 0);
+  }
+
+  outcome::result<BlockHash> ForkChoiceStore::findSafeTarget(
+      const BlockHash &start_root, uint64_t min_score) {
+    auto anchor = start_root;
+    if (anchor == kZeroHash or not block_tree_->has(anchor)) {
+      anchor = block_tree_->lastFinalized().hash;
+    }
+    if (not proto_array_.contains(anchor)) {
+      OUTCOME_TRY(rebuildProtoArray());
+    }
+    if (auto target = proto_array_.findSafeTarget(anchor, min_score);
+        target.has_value()) {
+      return target.value();
+    }
+    return computeLmdGhostHead(anchor, latest_new_attestations_, min_score);
+  }
+
+  outcome::result<void> ForkChoiceStore::rebuildProtoArray() {
+    SL_TRACE(logger_, "Rebuild proto-array");
+    proto_array_.clear();
+    auto finalized = block_tree_->lastFinalized();
+    if (not block_tree_->has(finalized.hash)) {
+      return outcome::success();
+    }
+    proto_array_.addBlock(finalized, {});
+
+    // Breadth-first, so parent is always inserted before its children
+    std::deque<BlockHash> queue{finalized.hash};
+    while (not queue.empty()) {
+      auto hash = queue.front();
+      queue.pop_front();
+      auto children_res = block_tree_->getChildren(hash);
+      if (children_res.has_failure()) {
+        continue;
+      }
+      for (auto &child : children_res.value()) {
+        OUTCOME_TRY(slot, getBlockSlot(child));
+        proto_array_.addBlock({.slot = slot, .hash = child}, hash);
+        queue.emplace_back(child);
+      }
+    }
+
+    for (auto &&[validator_index, data] : latest_known_attestations_) {
+      proto_array_.setVote(validator_index, data.head);
+    }
+    for (auto &&[validator_index, data] : latest_new_attestations_) {
+      proto_array_.setVote(
+          validator_index, data.head, ProtoArray::VoteSet::NEW);
+    }
+    return outcome::success();
+  }
+
+  void ForkChoiceStore::setKnownAttestation(ValidatorIndex validator_index,
+                                            const AttestationData &data) {
+    latest_known_attestations_.insert_or_assign(validator_index, data);
+    proto_array_.setVote(validator_index, data.head);
+    proposalInputsChanged();
+  }
+
+  void ForkChoiceStore::setNewAttestation(ValidatorIndex validator_index,
+                                          const AttestationData &data) {
+    latest_new_attestations_.insert_or_assign(validator_index, data);
+    proto_array_.setVote(validator_index, data.head, ProtoArray::VoteSet::NEW);
+  }
+
+  void ForkChoiceStore::eraseNewAttestation(ValidatorIndex validator_index) {
+    latest_new_attestations_.erase(validator_index);
+    proto_array_.removeVote(validator_index, ProtoArray::VoteSet::NEW);
+  }
+
+  ForkChoiceSnapshot ForkChoiceStore::makeSnapshot() const {
+    ForkChoiceSnapshot snapshot{
+        .finalized = getLatestFinalized(),
+        .head = head_,
+        .safe_target = safe_target_,
+    };
+    for (auto &&[validator_id, data] : latest_known_attestations_) {
+      snapshot.latest_known_attestations.push_back(
+          Attestation{.validator_id = validator_id, .data = data});
+    }
+    for (auto &&[validator_id, data] : latest_new_attestations_) {
+      snapshot.latest_new_attestations.push_back(
+          Attestation{.validator_id = validator_id, .data = data});
+    }
+    for (auto &attestations : attestations_by_data_ | std::views::values) {
+      AttestationsByDataSnapshot item{.data = attestations.data};
+      for (auto &[validator_id, signature] : attestations.signatures) {
+        item.signatures.push_back(ValidatorSignature{
+            .validator_id = validator_id,
+            .signature = signature,
+        });
+      }
+      for (auto &proof : attestations.proofs) {
+        item.proofs.push_back(proof);
+      }
+      snapshot.attestations_by_data.push_back(std::move(item));
+    }
+    for (auto &hash : states_.keys()) {
+      snapshot.hot_states.push_back(hash);
+    }
+    return snapshot;
+  }
+
+  void ForkChoiceStore::writeSnapshot(
+      const ForkChoiceSnapshot &snapshot) const {
+    if (auto res = block_storage_->putForkChoiceSnapshot(snapshot);
+        res.has_error()) {
+      SL_WARN(logger_, "Can't save fork choice snapshot: {}", res.error());
+      return;
+    }
+    SL_DEBUG(logger_,
+             "Saved fork choice snapshot at head {} with {} votes",
+             snapshot.head,
+             snapshot.latest_known_attestations.size());
+  }
+
+  void ForkChoiceStore::restoreSnapshot() {
+    auto snapshot_res = block_storage_->getForkChoiceSnapshot();
+    if (snapshot_res.has_error()) {
+      SL_WARN(logger_,
+              "Can't load fork choice snapshot: {}",
+              snapshot_res.error());
+      return;
+    }
+    if (not snapshot_res.value().has_value()) {
+      return;
+    }
+    auto &snapshot = snapshot_res.value().value();
+
+    // Blocks may be pruned and finalization may go further since snapshot
+    auto finalized_slot = getLatestFinalized().slot;
+    auto is_actual = [&](const AttestationData &data) {
+      return data.target.slot >= finalized_slot
+         and block_tree_->has(data.head.root)
+         and block_tree_->has(data.target.root);
+    };
+    size_t votes = 0;
+    for (auto &attestation : snapshot.latest_known_attestations) {
+      if (attestation.validator_id < VALIDATOR_REGISTRY_LIMIT
+          and is_actual(attestation.data)) {
+        setKnownAttestation(attestation.validator_id, attestation.data);
+        ++votes;
+      }
+    }
+    for (auto &attestation : snapshot.latest_new_attestations) {
+      if (attestation.validator_id < VALIDATOR_REGISTRY_LIMIT
+          and is_actual(attestation.data)) {
+        setNewAttestation(attestation.validator_id, attestation.data);
+      }
+    }
+    for (auto &item : snapshot.attestations_by_data) {
+      if (not is_actual(item.data)) {
+        continue;
+      }
+      auto &attestations = attestationsByData(item.data);
+      for (auto &signature : item.signatures) {
+        auto inserted = attestations.signatures
+                            .insert_or_assign(signature.validator_id,
+                                              signature.signature)
+                            .second;
+        aggregation_totals_.signatures += inserted ? 1 : 0;
+      }
+      for (auto &proof : item.proofs) {
+        aggregation_totals_.addProof(attestations.proofs.emplace_back(proof));
+      }
+    }
+    updateMetricGossipSignatures();
+
+    // Load least recently used first, so cache keeps original order
+    for (auto &hash : snapshot.hot_states | std::views::reverse) {
+      if (block_tree_->has(hash)) {
+        std::ignore = getState(hash);
+      }
+    }
+
+    if (auto res = updateSafeTarget(); res.has_error()) {
+      SL_WARN(logger_,
+              "Failed safe-target update after restore: {}",
+              res.error());
+    }
+    if (auto res = updateHead(); res.has_error()) {
+      SL_WARN(logger_, "Failed head update after restore: {}", res.error());
+    }
+    SL_INFO(logger_,
+            "Restored fork choice snapshot: {} votes, head {} (was {})",
+            votes,
+            head_,
+            snapshot.head);
+  }
+
   outcome::result<ForkChoiceApiJson> ForkChoiceStore::apiForkChoice() const {
     auto finalized = getLatestFinalized();
     auto head = getHead().root;
@@ -1299,18 +2349,19 @@ namespace lean {
       }
     }
 
-    for (auto &attestation : latest_known_attestations_ | std::views::values) {
-      auto hash = attestation.head.root;
-      while (true) {
-        auto node_it = nodes.find(hash);
-        if (node_it == nodes.end()) {
-          break;
-        }
-        auto &node = node_it->second;
-        ++node.weight;
-        hash = node.parent_root;
-      }
-    }
+    latest_known_attestations_.forEachData(
+        [&](const AttestationData &attestation, size_t voters) {
+          auto hash = attestation.head.root;
+          while (true) {
+            auto node_it = nodes.find(hash);
+            if (node_it == nodes.end()) {
+              break;
+            }
+            auto &node = node_it->second;
+            node.weight += voters;
+            hash = node.parent_root;
+          }
+        });
 
     ForkChoiceApiJson result{
         .head = head,
@@ -1337,8 +2388,13 @@ namespace lean {
         return;
       }
     }
-    attestations.signatures[validator_index] = signature;
-    updateMetricGossipSignatures();
+    auto inserted =
+        attestations.signatures.insert_or_assign(validator_index, signature)
+            .second;
+    if (inserted) {
+      ++aggregation_totals_.signatures;
+      updateMetricGossipSignatures();
+    }
   }
 
   void ForkChoiceStore::addProofToAggregate(
@@ -1348,125 +2404,310 @@ namespace lean {
       return;
     }
     auto &attestations = attestationsByData(data);
+    auto &participants = signed_aggregated_attestation.proof.participants;
+    // Drop proofs covered by new proof
     retain_if(attestations.proofs, [&](const AggregatedSignatureProof &proof) {
-      return std::ranges::any_of(
-                 proof.participants.iter(),
-                 [&](ValidatorIndex i) {
-                   return not signed_aggregated_attestation.proof.participants
-                                  .contains(i);
-                 })
-          or std::ranges::all_of(
-                 signed_aggregated_attestation.proof.participants.iter(),
-                 [&](ValidatorIndex i) {
-                   return proof.participants.contains(i);
-                 });
+      auto retain = not proof.participants.isSubsetOf(participants)
+                 or participants.isSubsetOf(proof.participants);
+      if (not retain) {
+        aggregation_totals_.removeProof(proof);
+      }
+      return retain;
     });
     AggregationBits existing_bits;
     for (auto &proof : attestations.proofs) {
-      for (auto &&i : proof.participants.iter()) {
-        existing_bits.add(i);
-      }
+      existing_bits.unionWith(proof.participants);
     }
-    if (std::ranges::all_of(
-            signed_aggregated_attestation.proof.participants.iter(),
-            [&](ValidatorIndex i) { return existing_bits.contains(i); })) {
+    if (participants.isSubsetOf(existing_bits)) {
+      updateMetricGossipSignatures();
       return;
     }
-    attestations.proofs.emplace_back(signed_aggregated_attestation.proof);
-    for (auto &&validator_index :
-         signed_aggregated_attestation.proof.participants.iter()) {
-      attestations.signatures.erase(validator_index);
+    aggregation_totals_.addProof(
+        attestations.proofs.emplace_back(signed_aggregated_attestation.proof));
+    for (auto &&validator_index : participants.iter()) {
+      aggregation_totals_.signatures -=
+          attestations.signatures.erase(validator_index);
     }
+    proposalInputsChanged();
     updateMetricGossipSignatures();
   }
 
   ForkChoiceStore::AttestationsByData &ForkChoiceStore::attestationsByData(
       const AttestationData &data) {
-    auto key = sszHash(data);
-    auto it = attestations_by_data_.find(key);
+    auto it = attestations_by_data_.find(data);
     if (it == attestations_by_data_.end()) {
-      it = attestations_by_data_.emplace(key, AttestationsByData{.data = data})
+      attestation_data_by_slot_[data.target.slot].emplace_back(data);
+      it = attestations_by_data_
+               .emplace(data,
+                        AttestationsByData{
+                            .data = data,
+                            .root = sszHash(data),
+                        })
                .first;
     }
     return it->second;
   }
 
-  std::vector<SignedAggregatedAttestation>
-  ForkChoiceStore::aggregateSignatures() {
-    auto timer =
-        metrics_->lean_committee_signatures_aggregation_time_seconds()->timer();
+  std::optional<ForkChoiceStore::AggregationJob>
+  ForkChoiceStore::makeAggregationJob(const AttestationsByData &attestations,
+                                      bool with_proofs) const {
+    auto state_res = getState(attestations.data.target.root);
+    if (not state_res.has_value()) {
+      return std::nullopt;
+    }
+    auto &state = *state_res.value();
+    AggregationJob job{
+        .data = attestations.data,
+        .message = attestations.root,
+        .state = state_res.value(),
+    };
+    for (auto &[validator_id, signature] : attestations.signatures) {
+      job.public_keys.emplace_back(
+          &state.validators.data().at(validator_id).attestation_pubkey);
+      job.signatures.emplace_back(signature);
+      job.participants.add(validator_id);
+    }
+    if (not with_proofs) {
+      return job;
+    }
+    for (auto &proof : attestations.proofs) {
+      std::vector<crypto::xmss::XmssPublicKeyRef> public_keys;
+      for (auto &&validator_id : proof.participants.iter()) {
+        public_keys.emplace_back(
+            &state.validators.data().at(validator_id).attestation_pubkey);
+        job.participants.add(validator_id);
+      }
+      job.child_public_keys.emplace_back(std::move(public_keys));
+      job.child_proofs.emplace_back(proof.proof_data);
+    }
+    return job;
+  }
 
-    std::vector<SignedAggregatedAttestation> aggregated_attestations;
+  std::vector<ForkChoiceStore::AggregationJob>
+  ForkChoiceStore::prepareAggregation(bool fallback) const {
+    std::vector<AggregationJob> jobs;
     for (auto &attestations : attestations_by_data_ | std::views::values) {
-      if (attestations.signatures.empty() and attestations.proofs.size() <= 1) {
-        continue;
+      if (fallback) {
+        // Proof of assigned aggregator removes signatures it covers
+        if (attestations.signatures.empty()
+            or aggregationRank(attestations) != AggregatorDuty::kFallback) {
+          continue;
+        }
+      } else {
+        if (attestations.signatures.empty() and attestations.proofs.size() <= 1
+            and not attestations.partial) {
+          continue;
+        }
+        if (aggregationRank(attestations) != AggregatorDuty::kAssigned) {
+          metrics_->lean_committee_aggregation_groups_total(
+                      {{"duty", "skipped"}})
+              ->inc();
+          continue;
+        }
+      }
+      if (auto job = makeAggregationJob(attestations, true)) {
+        metrics_->lean_committee_aggregation_groups_total(
+                    {{"duty", fallback ? "fallback" : "assigned"}})
+            ->inc();
+        jobs.emplace_back(std::move(*job));
       }
-      auto state_res = getState(attestations.data.target.root);
-      if (not state_res.has_value()) {
+    }
+    return jobs;
+  }
+
+  size_t ForkChoiceStore::aggregationRank(
+      const AttestationsByData &attestations) const {
+    // Peers of own subnet don't aggregate extra subnets of this node
+    if (not aggregate_subnets_.empty()) {
+      return AggregatorDuty::kAssigned;
+    }
+    return aggregator_duty_.rank(
+        validator_id_, attestations.data.slot, attestations.root);
+  }
+
+  std::vector<ForkChoiceStore::AggregationJob>
+  ForkChoiceStore::preparePartialAggregation() {
+    std::vector<AggregationJob> jobs;
+    if (not is_aggregator_()) {
+      return jobs;
+    }
+    for (auto &[key, attestations] : attestations_by_data_) {
+      if (attestations.signatures.size() < kPartialAggregationSignatures
+          or partial_aggregations_.contains(key)
+          or aggregationRank(attestations) != AggregatorDuty::kAssigned) {
         continue;
       }
-      auto &state = *state_res.value();
-      std::vector<std::vector<crypto::xmss::XmssPublicKey>> child_public_keys;
-      std::vector<crypto::xmss::XmssAggregatedSignature> child_proofs;
-      std::vector<crypto::xmss::XmssPublicKey> public_keys;
-      std::vector<Signature> signatures;
-      AggregationBits participants;
-      for (auto &[validator_id, signature] : attestations.signatures) {
-        public_keys.emplace_back(
-            state.validators.data().at(validator_id).attestation_pubkey);
-        signatures.emplace_back(signature);
-        participants.add(validator_id);
+      // Only raw signatures, proofs are merged once by interval 2
+      if (auto job = makeAggregationJob(attestations, false)) {
+        partial_aggregations_.emplace(key);
+        jobs.emplace_back(std::move(*job));
       }
-      for (auto &proof : attestations.proofs) {
-        std::vector<crypto::xmss::XmssPublicKey> public_keys;
-        for (auto &&validator_id : proof.participants.iter()) {
-          public_keys.emplace_back(
-              state.validators.data().at(validator_id).attestation_pubkey);
-          participants.add(validator_id);
-        }
-        child_public_keys.emplace_back(std::move(public_keys));
-        child_proofs.emplace_back(proof.proof_data);
+    }
+    return jobs;
+  }
+
+  void ForkChoiceStore::importPartialAggregations(
+      std::span<const AggregationJob> jobs,
+      std::vector<SignedAggregatedAttestation> aggregated_attestations) {
+    for (auto &job : jobs) {
+      partial_aggregations_.erase(job.data);
+    }
+    for (auto &aggregated_attestation : aggregated_attestations) {
+      // Group may have been pruned meanwhile
+      if (not attestations_by_data_.contains(aggregated_attestation.data)) {
+        continue;
       }
-      auto payload = attestationPayload(attestations.data);
-      auto aggregated_signature =
-          xmss_provider_->aggregateSignatures(child_public_keys,
-                                              child_proofs,
-                                              public_keys,
-                                              signatures,
-                                              attestations.data.slot,
-                                              payload);
-      AggregatedSignatureProof proof{
-          .participants = participants,
-          .proof_data = aggregated_signature,
-      };
+      metrics_->lean_committee_partial_aggregations_total()->inc();
+      addProofToAggregate(aggregated_attestation);
+      attestationsByData(aggregated_attestation.data).partial = true;
+    }
+  }
+
+  std::vector<SignedAggregatedAttestation> ForkChoiceStore::aggregate(
+      std::span<const AggregationJob> jobs) const {
+    auto timer =
+        metrics_->lean_committee_signatures_aggregation_time_seconds()->timer();
+
+    // Single proof, e.g. partial one covering all signatures, is ready
+    auto is_ready = [](const AggregationJob &job) {
+      return job.signatures.empty() and job.child_proofs.size() == 1;
+    };
+    std::vector<crypto::xmss::XmssAggregateItem> items;
+    items.reserve(jobs.size());
+    for (auto &job : jobs) {
+      if (is_ready(job)) {
+        continue;
+      }
+      items.emplace_back(crypto::xmss::XmssAggregateItem{
+          .child_public_keys = job.child_public_keys,
+          .child_proofs = job.child_proofs,
+          .public_keys = job.public_keys,
+          .signatures = job.signatures,
+          .epoch = static_cast<uint32_t>(job.data.slot),
+          .message = job.message,
+      });
+    }
+    auto aggregated_signatures = xmss_provider_->aggregateBatch(items);
+
+    std::vector<SignedAggregatedAttestation> aggregated_attestations;
+    aggregated_attestations.reserve(jobs.size());
+    auto aggregated_it = aggregated_signatures.begin();
+    for (auto &job : jobs) {
       aggregated_attestations.emplace_back(SignedAggregatedAttestation{
-          .data = attestations.data,
-          .proof = proof,
+          .data = job.data,
+          .proof =
+              AggregatedSignatureProof{
+                  .participants = job.participants,
+                  .proof_data = is_ready(job) ? job.child_proofs.front()
+                                              : std::move(*aggregated_it++),
+              },
       });
-      attestations.signatures.clear();
-      attestations.proofs.clear();
-      attestations.proofs.emplace_back(proof);
     }
     return aggregated_attestations;
   }
 
+  std::vector<ForkChoiceStore::OnTickAction>
+  ForkChoiceStore::importAggregations(
+      std::vector<SignedAggregatedAttestation> aggregated_attestations) {
+    std::vector<OnTickAction> result;
+    for (auto &aggregated_attestation : aggregated_attestations) {
+      auto res = onGossipAggregatedAttestation(aggregated_attestation);
+      if (not res.has_value()) {
+        SL_WARN(logger_, "failed to import own aggregation: {}", res.error());
+        continue;
+      }
+      attestationsByData(aggregated_attestation.data).partial = false;
+      result.emplace_back(std::move(aggregated_attestation));
+    }
+    if (deferred_deadline_.has_value()) {
+      deferred_deadline_->stage("aggregate");
+      deferred_deadline_.reset();
+    }
+    return result;
+  }
+
   void ForkChoiceStore::prune(Slot finalized_slot) {
-    auto should_retain = [&](const AttestationData &data) {
-      return data.target.slot > finalized_slot;
-    };
-    retain_if(attestations_by_data_,
-              [&](const decltype(attestations_by_data_)::value_type &p) {
-                return should_retain(p.second.data);
-              });
+    auto pruned_end = attestation_data_by_slot_.upper_bound(finalized_slot);
+    for (auto it = attestation_data_by_slot_.begin(); it != pruned_end; ++it) {
+      for (auto &data : it->second) {
+        auto node = attestations_by_data_.extract(data);
+        if (node) {
+          aggregation_totals_.removeGroup(node.mapped());
+        }
+      }
+    }
+    attestation_data_by_slot_.erase(attestation_data_by_slot_.begin(),
+                                    pruned_end);
+    proposalInputsChanged();
     updateMetricGossipSignatures();
   }
 
-  void ForkChoiceStore::updateMetricGossipSignatures() {
-    size_t metric_signatures = 0;
+  void ForkChoiceStore::AggregationTotals::addProof(
+      const AggregatedSignatureProof &proof) {
+    ++proofs;
+    proof_bytes += ssz::size(proof);
+  }
+
+  void ForkChoiceStore::AggregationTotals::removeProof(
+      const AggregatedSignatureProof &proof) {
+    --proofs;
+    proof_bytes -= ssz::size(proof);
+  }
+
+  void ForkChoiceStore::AggregationTotals::removeGroup(
+      const AttestationsByData &attestations) {
+    signatures -= attestations.signatures.size();
+    for (auto &proof : attestations.proofs) {
+      removeProof(proof);
+    }
+  }
+
+  void ForkChoiceStore::pinStates() {
+    states_.pin({
+        head_.root,
+        safe_target_.root,
+        block_tree_->getLatestJustified().root,
+        block_tree_->lastFinalized().hash,
+    });
+  }
+
+  void ForkChoiceStore::updateMetricStateCache() const {
+    auto stats = states_.stats();
+    metrics_->fc_state_cache_states()->set(stats.states);
+    metrics_->fc_state_cache_bytes()->set(stats.bytes);
+    metrics_->fc_state_cache_warm_states()->set(stats.warm_states);
+    metrics_->fc_state_cache_warm_bytes()->set(stats.warm_bytes);
+    auto reported = reported_warm_hits_.exchange(stats.warm_hits);
+    if (stats.warm_hits > reported) {
+      metrics_->fc_state_cache_warm_hits_total()->inc(
+          static_cast<double>(stats.warm_hits - reported));
+    }
+  }
+
+  void ForkChoiceStore::updateMetricMemory() const {
+    auto set = [&](const char *subsystem, size_t bytes) {
+      metrics_->app_memory_usage_bytes({{"subsystem", subsystem}})->set(bytes);
+    };
+    auto state_stats = states_.stats();
+    set("fork_choice_states", state_stats.bytes + state_stats.warm_bytes);
+    set("fork_choice_votes",
+        latest_known_attestations_.byteSize()
+            + latest_new_attestations_.byteSize()
+            + proto_array_.byteSize());
+    auto aggregates = memory_usage::hashBytes(attestations_by_data_);
     for (auto &batch : attestations_by_data_ | std::views::values) {
-      metric_signatures += batch.signatures.size();
+      aggregates += memory_usage::treeBytes(batch.signatures)
+                  + memory_usage::vectorBytes(batch.proofs);
     }
-    metrics_->lean_gossip_signatures()->set(metric_signatures);
+    aggregates += aggregation_totals_.proof_bytes;
+    set("fork_choice_aggregates", aggregates);
+  }
+
+  void ForkChoiceStore::updateMetricGossipSignatures() {
+    metrics_->lean_gossip_signatures()->set(aggregation_totals_.signatures);
+    metrics_->fc_aggregation_proofs()->set(aggregation_totals_.proofs);
+    metrics_->fc_aggregation_proof_bytes()->set(
+        aggregation_totals_.proof_bytes);
   }
 
   void ForkChoiceStore::updateMetricAttestationSignature(bool valid) const {
@@ -6,27 +6,43 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <map>
 #include <memory>
 #include <optional>
+#include <span>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <boost/di.hpp>
 #include <qtils/shared_ref.hpp>
 
+#include "blockchain/advanced_state_cache.hpp"
+#include "blockchain/aggregator_duty.hpp"
+#include "blockchain/interval_deadline.hpp"
+#include "blockchain/proto_array.hpp"
+#include "blockchain/state_cache.hpp"
 #include "blockchain/state_transition_function.hpp"
+#include "blockchain/vote_table.hpp"
 #include "clock/clock.hpp"
 #include "crypto/xmss/xmss_provider.hpp"
 #include "injector/boost_di_inject_traits_many.hpp"
 #include "log/logger.hpp"
+#include "metrics/metrics.hpp"
 #include "types/aggregated_attestations.hpp"
 #include "types/block.hpp"
+#include "types/block_hash_map.hpp"
+#include "types/fork_choice_snapshot.hpp"
 #include "types/hash.hpp"
 #include "types/signed_aggregated_attestation.hpp"
 #include "types/signed_attestation.hpp"
 #include "types/signed_block.hpp"
 #include "types/state.hpp"
 #include "types/validator_index.hpp"
-#include "utils/lru_cache.hpp"
+#include "utils/sharded_lru_cache.hpp"
 #include "utils/tuple_hash.hpp"
 
 namespace lean {
@@ -45,16 +61,13 @@ namespace lean::app {
 namespace lean::blockchain {
   class BlockStorage;
   class BlockTree;
+  struct CommonAncestor;
 }
 
 namespace lean::crypto::xmss {
   class XmssProvider;
 }
 
-namespace lean::metrics {
-  class Metrics;
-}
-
 namespace lean {
   /**
    * Forkchoice store tracking chain state and validator attestations.
@@ -75,8 +88,7 @@ namespace lean {
    */
   class ForkChoiceStore {
    public:
-    using AttestationDataByValidator =
-        std::unordered_map<ValidatorIndex, AttestationData>;
+    using AttestationDataByValidator = VoteTable;
 
     enum class Error {
       CANT_VALIDATE_ATTESTATION_SOURCE_NOT_FOUND,
@@ -88,6 +100,7 @@ namespace lean {
       SIGNATURE_COUNT_MISMATCH,
       TOO_MANY_ATTESTATIONS,
       NO_KEYPAIR,
+      SEGMENT_NOT_CHAINED,
     };
     Q_ENUM_ERROR_CODE_FRIEND(Error) {
       using E = decltype(e);
@@ -110,6 +123,8 @@ namespace lean {
           return "Too many attestations in block";
         case E::NO_KEYPAIR:
           return "No keypair";
+        case E::SEGMENT_NOT_CHAINED:
+          return "Block of segment is not child of previous one";
       }
       abort();
     }
@@ -162,6 +177,23 @@ namespace lean {
 
     void dontPropose();
 
+    /**
+     * Follow chain optimistically: verify only `sample_rate` fraction of
+     * aggregated proofs of blocks, chosen by secret seed so peers can't
+     * predict them, and don't keep proofs of imported attestations, which
+     * are needed only for proposing and aggregation.
+     * Proposer signatures are always verified.
+     */
+    void follow(double sample_rate);
+
+    /// Whether unverified proofs may be imported, see `follow`
+    bool optimistic() const {
+      return follower_.has_value();
+    }
+
+    /// Share post-states with stores of other nodes in same process
+    void shareStates(std::shared_ptr<SharedStatePool> pool);
+
     // Compute the latest block that the validator is allowed to choose as the
     // target
     [[nodiscard]] outcome::result<void> updateSafeTarget();
@@ -181,6 +213,11 @@ namespace lean {
     Checkpoint getHead() const;
     [[nodiscard]] outcome::result<std::shared_ptr<const State>> getState(
         const BlockHash &block_hash) const;
+    /**
+     * Load state into cache, if block is known and state is not cached yet.
+     * Thread safe, doesn't need store lock.
+     */
+    void prefetchState(const BlockHash &block_hash) const;
 
     bool hasBlock(const BlockHash &hash) const;
     [[nodiscard]] outcome::result<Slot> getBlockSlot(
@@ -199,9 +236,6 @@ namespace lean {
     const AttestationDataByValidator &getLatestKnownAttestations() const {
       return latest_known_attestations_;
     }
-    AttestationDataByValidator &getLatestNewVotesRef() {
-      return latest_new_attestations_;
-    }
 
     /**
      * Internal implementation of LMD GHOST fork choice algorithm.
@@ -256,7 +290,7 @@ namespace lean {
      *  2. **Walk Toward Safe**: Move backward (up to
      * `JUSTIFICATION_LOOKBACK_SLOTS` steps) if safe target is newer
      *  3. **Ensure Justifiable**: Continue walking back until slot is
-     * justifiable
+     * justifiable, jumping over non-justifiable slots via block tree
      *  4. **Return Checkpoint**: Create checkpoint from selected block
      *
      *  Justifiability Rules (see Slot.is_justifiable_after)
@@ -365,6 +399,19 @@ namespace lean {
     outcome::result<void> onGossipAttestation(
         const SignedAttestation &signed_attestation);
 
+    /**
+     * `onGossipAttestation` split in stages like block import, so signature
+     * verification doesn't need store lock:
+     * - `beginGossipAttestation` (under lock) validates data and takes state,
+     * - `verifyGossipAttestation` (without lock) verifies signature,
+     * - `commitGossipAttestation` (under lock) stores signature.
+     */
+    outcome::result<std::shared_ptr<const State>> beginGossipAttestation(
+        const SignedAttestation &signed_attestation);
+    outcome::result<void> verifyGossipAttestation(
+        const State &state, const SignedAttestation &signed_attestation) const;
+    void commitGossipAttestation(const SignedAttestation &signed_attestation);
+
     /**
      * Process a signed aggregated attestation received via aggregation topic
      * This method:
@@ -373,6 +420,18 @@ namespace lean {
      */
     outcome::result<void> onGossipAggregatedAttestation(
         const SignedAggregatedAttestation &signed_aggregated_attestation);
+
+    /// `onGossipAggregatedAttestation` split in stages, same as attestation
+    outcome::result<std::shared_ptr<const State>>
+    beginGossipAggregatedAttestation(
+        const SignedAggregatedAttestation &signed_aggregated_attestation);
+    bool verifyGossipAggregatedAttestation(
+        const State &state,
+        const SignedAggregatedAttestation &signed_aggregated_attestation) const;
+    /**
+     * Store proof and import votes of all participants, validating data and
+     * updating vote tables once for whole aggregate, not per participant.
+     */
     outcome::result<void> onAggregatedAttestation(
         const SignedAggregatedAttestation &signed_aggregated_attestation,
         bool is_from_block);
@@ -430,15 +489,241 @@ namespace lean {
     // Processes a new block, updates the store, and triggers a head update.
     outcome::result<void> onBlock(SignedBlock signed_block);
 
+    /**
+     * Block being imported in stages, so expensive checks don't need store
+     * lock:
+     * - `beginBlockImport` (under lock) takes parent state snapshot,
+     * - `prepareBlockImport` (without lock) verifies signatures, applies STF
+     *   and stores post-state,
+     * - `commitBlockImport` (under lock) inserts block and updates head.
+     */
+    struct BlockImport {
+      SignedBlock signed_block;
+      std::shared_ptr<const State> parent_state;
+      State post_state;
+      std::optional<metrics::HistogramTimer> timer;
+    };
+
+    /**
+     * Block is moved into import, and is left intact if already known.
+     * @return nullopt if block is already known
+     */
+    outcome::result<std::optional<BlockImport>> beginBlockImport(
+        SignedBlock &&signed_block);
+
+    /**
+     * Begin import of chain segment, each block is child of previous one.
+     * Known leading blocks are skipped. Only first import has parent state,
+     * parent state of next one is post-state of previous one.
+     */
+    outcome::result<std::vector<BlockImport>> beginSegmentImport(
+        std::vector<SignedBlock> signed_blocks);
+
+    /// Doesn't access mutable store state, may be called without store lock.
+    outcome::result<void> prepareBlockImport(BlockImport &block_import) const;
+
+    /// Apply STF, without signature verification and storing post-state.
+    outcome::result<void> applyBlockImport(BlockImport &block_import,
+                                           const State &parent_state) const;
+
+    /// Store post-state of prepared block.
+    void storeBlockImport(const BlockImport &block_import) const;
+
+    /**
+     * Post-state is moved into cache, block is left in `block_import`, so
+     * caller may keep it without copy.
+     * @param update_head false if caller updates head after whole segment
+     */
+    outcome::result<void> commitBlockImport(BlockImport &block_import,
+                                            bool update_head = true);
+
     using OnTickAction = std::
         variant<SignedAttestation, SignedAggregatedAttestation, SignedBlock>;
 
+    /**
+     * Inputs for aggregation of one attestation data group.
+     * Owns copies and keeps state whose validator keys it refers to, so
+     * aggregation can run without holding store lock.
+     */
+    struct AggregationJob {
+      AttestationData data;
+      /// Signed message, ssz root of `data`
+      Hash message;
+      std::shared_ptr<const State> state;
+      std::vector<std::vector<crypto::xmss::XmssPublicKeyRef>>
+          child_public_keys;
+      std::vector<crypto::xmss::XmssAggregatedSignature> child_proofs;
+      std::vector<crypto::xmss::XmssPublicKeyRef> public_keys;
+      std::vector<Signature> signatures;
+      AggregationBits participants;
+    };
+
+    /// Head state to advance to next slot, see `advanceState`
+    struct StateAdvanceJob {
+      BlockHash parent_root;
+      std::shared_ptr<const State> parent_state;
+      Slot slot;
+    };
+
+    /**
+     * Block with attestations selected on parent state. Post-state and
+     * state root are computed by `buildProposal`, ahead of signing.
+     */
+    struct PreparedProposal {
+      Block block;
+      AttestationSignatures attestation_signatures;
+      /// `proposal_inputs_version_` block was built from
+      uint64_t inputs_version = 0;
+      std::shared_ptr<const State> parent_state;
+      /// Set when block is built
+      std::optional<State> post_state;
+    };
+
+    /// Own interval 0 block with proposer key, see `produceBlock`
+    struct ProductionJob {
+      PreparedProposal proposal;
+      crypto::xmss::XmssPrivateKey private_key;
+      std::optional<metrics::HistogramTimer> timer;
+      std::optional<IntervalDeadline> deadline;
+    };
+
+    /// Own interval 1 attestation with keys of local validators to sign
+    struct AttestationJob {
+      Attestation attestation;
+      std::vector<ValidatorIndex> signers;
+      std::vector<crypto::xmss::XmssSignItem> sign_items;
+      std::optional<metrics::HistogramTimer> timer;
+      std::optional<IntervalDeadline> deadline;
+    };
+
     // Advance forkchoice store time to given timestamp.
     // Ticks store forward interval by interval, performing appropriate
-    // actions for each interval type.
+    // actions for each interval type. Proposal, attestation and aggregation
+    // of slots already over are skipped, e.g. after stall.
     // Args:
     //    time: Target time since genesis.
-    std::vector<OnTickAction> onTick(std::chrono::milliseconds now);
+    //    deferred_aggregation: If set, interval 2 aggregation jobs are
+    //        appended there instead of being aggregated inline. Caller must
+    //        `aggregate` them and pass results to `importAggregations`.
+    //    deferred_state_advance: If set, interval 4 head state advance is
+    //        stored there instead of running inline. Caller must pass it to
+    //        `advanceState`.
+    //    deferred_snapshot: If set, snapshot is stored there instead of
+    //        being encoded and written inline. Caller must pass it to
+    //        `writeSnapshot`.
+    //    deferred_attestation: If set, interval 1 attestation is stored
+    //        there instead of being signed inline. Caller must pass it to
+    //        `signAttestations` and results to `commitAttestations`.
+    //    deferred_production: If set, interval 0 block is stored there
+    //        instead of being built and signed inline, and later intervals
+    //        are not ticked. Caller must pass it to `produceBlock` and
+    //        result to `commitProduction`, then tick again.
+    //    deferred_proposal: If set, interval 4 block prepared for next slot
+    //        is stored there instead of being built inline. Caller must
+    //        pass it to `advanceState` with `deferred_state_advance`, then
+    //        to `buildProposal` and result to `storeProposal`.
+    std::vector<OnTickAction> onTick(
+        std::chrono::milliseconds now,
+        std::vector<AggregationJob> *deferred_aggregation = nullptr,
+        std::optional<StateAdvanceJob> *deferred_state_advance = nullptr,
+        std::optional<ForkChoiceSnapshot> *deferred_snapshot = nullptr,
+        std::optional<AttestationJob> *deferred_attestation = nullptr,
+        std::optional<ProductionJob> *deferred_production = nullptr,
+        std::optional<PreparedProposal> *deferred_proposal = nullptr);
+
+    /// Check proposer of `slot`, take prepared or select new block on head
+    outcome::result<ProductionJob> prepareProduction(
+        Slot slot, ValidatorIndex proposer_index);
+
+    /**
+     * Build block if not prepared, sign it and store its post-state.
+     * Own signatures are not verified again.
+     * Doesn't access store state, so may be called without store lock.
+     */
+    outcome::result<BlockImport> produceBlock(ProductionJob &job) const;
+
+    /// Import own block made by `produceBlock`, to be published
+    std::vector<OnTickAction> commitProduction(
+        ProductionJob job, outcome::result<BlockImport> block_import);
+
+    /**
+     * Apply STF to parent state and compute post-state root.
+     * Thread safe, doesn't need store lock.
+     */
+    outcome::result<PreparedProposal> buildProposal(
+        PreparedProposal proposal) const;
+
+    /// Keep block built by `buildProposal` for next slot production
+    void storeProposal(Slot slot, outcome::result<PreparedProposal> proposal);
+
+    /**
+     * Sign attestation of local validators concurrently.
+     * Doesn't access store state, so may be called without store lock.
+     */
+    std::vector<Signature> signAttestations(const AttestationJob &job) const;
+
+    /// Store own signed attestations, which are not verified again
+    std::vector<OnTickAction> commitAttestations(
+        AttestationJob job, std::vector<Signature> signatures);
+
+    /// Encode and persist snapshot made by `onTick`, without store lock
+    void writeSnapshot(const ForkChoiceSnapshot &snapshot) const;
+
+    /**
+     * Run `STF::processSlots` on head state for next slot ahead of time, so
+     * block import and production there skip state root hashing.
+     * Thread safe, doesn't need store lock.
+     */
+    void advanceState(const StateAdvanceJob &job) const;
+
+    /**
+     * Snapshot signatures and proofs of groups which need aggregation, and
+     * are assigned to this aggregator by `AggregatorDuty`.
+     * @param fallback take groups this aggregator is fallback of, which
+     * have signatures not covered by proof of assigned aggregator
+     */
+    std::vector<AggregationJob> prepareAggregation(bool fallback = false) const;
+
+    /// Other aggregators of own subnet, interval 2 aggregation is split
+    /// with them
+    void setAggregatorDuty(AggregatorDuty duty);
+
+    /// Raw signatures of group which start its partial aggregation
+    static constexpr size_t kPartialAggregationSignatures = 16;
+
+    /**
+     * Snapshot raw signatures of groups which collected many of them, to
+     * aggregate them in background as they arrive. Interval 2 aggregation
+     * then merges ready partial proofs with few remaining signatures.
+     * Group is not taken again until its job is imported.
+     */
+    std::vector<AggregationJob> preparePartialAggregation();
+
+    /**
+     * Keep partial proofs for interval 2 aggregation and proposals.
+     * Unlike `importAggregations`, proofs are not published, as their
+     * signatures are counted already.
+     * @param aggregated_attestations results of `jobs`, empty on failure
+     */
+    void importPartialAggregations(
+        std::span<const AggregationJob> jobs,
+        std::vector<SignedAggregatedAttestation> aggregated_attestations);
+
+    /**
+     * Aggregate jobs, possibly concurrently.
+     * Doesn't access store state, so may be called without store lock.
+     */
+    std::vector<SignedAggregatedAttestation> aggregate(
+        std::span<const AggregationJob> jobs) const;
+
+    /**
+     * Import own aggregations into store.
+     * Aggregated proof replaces signatures and proofs it covers, signatures
+     * received meanwhile are kept for next aggregation.
+     * @return imported aggregations to be published
+     */
+    std::vector<OnTickAction> importAggregations(
+        std::vector<SignedAggregatedAttestation> aggregated_attestations);
 
     Interval time() const {
       return time_;
@@ -446,6 +731,24 @@ namespace lean {
 
     outcome::result<ForkChoiceApiJson> apiForkChoice() const;
 
+    /**
+     * Attestation data of latest interval 1, signed by local validators and
+     * served to validator processes, see `ValidatorClient`.
+     */
+    const std::optional<AttestationData> &attestationDuty() const {
+      return attestation_duty_;
+    }
+
+    /**
+     * Changed when result of `apiForkChoice` may change, i.e. head, safe
+     * target or weights were updated.
+     * Read without lock, so api cache is checked without contending with
+     * block import.
+     */
+    uint64_t apiForkChoiceVersion() const {
+      return api_fork_choice_version_.load(std::memory_order_acquire);
+    }
+
     // Verify all XMSS signatures in a signed block.
     //
     // This method ensures that every attestation included in the block
@@ -463,14 +766,52 @@ namespace lean {
     //     True if all signatures are cryptographically valid.
     bool validateBlockSignatures(const SignedBlock &signed_block) const;
 
+    /// Same as above, with already known parent state
+    bool validateBlockSignatures(const SignedBlock &signed_block,
+                                 const State &parent_state) const;
+
+    /**
+     * Cheap checks of block before attestation signatures and state
+     * transition: expected proposer of slot and its signature.
+     * Invalid gossip block is dropped without slow import steps.
+     */
+    outcome::result<void> validateBlockProposer(
+        const SignedBlock &signed_block, const State &parent_state) const;
+
+    /// Verify aggregated attestation signatures, without proposer signature
+    bool validateBlockAttestationSignatures(const SignedBlock &signed_block,
+                                            const State &parent_state) const;
+
    private:
     struct AttestationsByData {
       AttestationData data;
+      /// Ssz root of `data`, computed once per group
+      Hash root;
       // signatures and public keys must follow bitset order
       std::map<ValidatorIndex, Signature> signatures;
       std::vector<AggregatedSignatureProof> proofs;
+      /// Has own partial proof, to be published by interval 2 aggregation
+      bool partial = false;
     };
 
+    /// Sizes of aggregation pool, kept up to date by each change
+    struct AggregationTotals {
+      size_t signatures = 0;
+      size_t proofs = 0;
+      /// Ssz size of proofs
+      size_t proof_bytes = 0;
+
+      void addProof(const AggregatedSignatureProof &proof);
+      void removeProof(const AggregatedSignatureProof &proof);
+      void removeGroup(const AttestationsByData &attestations);
+    };
+
+    /// Rank of own aggregator for group, see `AggregatorDuty`
+    size_t aggregationRank(const AttestationsByData &attestations) const;
+
+    bool validateProposerSignature(const SignedBlock &signed_block,
+                                   const State &parent_state) const;
+
     void addSignatureToAggregate(const AttestationData &data,
                                  ValidatorIndex validator_index,
                                  const Signature &signature);
@@ -480,12 +821,130 @@ namespace lean {
 
     AttestationsByData &attestationsByData(const AttestationData &data);
 
+    /**
+     * Aggregation job of group, with its proofs as children if
+     * `with_proofs`.
+     * @return nullopt if target state is not available
+     */
+    std::optional<AggregationJob> makeAggregationJob(
+        const AttestationsByData &attestations, bool with_proofs) const;
+
+    /**
+     * Append public keys of proof participants to `public_keys` of any
+     * allocator, false if some index is unknown
+     */
+    template <typename PublicKeys>
+    bool collectPublicKeys(const State &state,
+                           const AggregatedSignatureProof &signature,
+                           PublicKeys &public_keys) const;
+
+    /// Whether follower verifies proof of `verifiedProofKey`
+    bool followerSamples(const Hash &key) const;
+
+    /// Digest of (participants, attestation payload, proof bytes)
+    static Hash verifiedProofKey(const AttestationData &attestation,
+                                 const AggregatedSignatureProof &signature);
+
+    /**
+     * Merge proofs of same attestation data into single proof.
+     * @return nullopt if some participant is unknown
+     */
+    std::optional<AggregatedSignatureProof> reaggregateProofs(
+        const State &state,
+        const AttestationData &data,
+        std::span<const AggregatedSignatureProof *const> proofs) const;
+
     bool validateAggregatedSignature(
         const State &state,
         const AttestationData &attestation,
         const AggregatedSignatureProof &signature) const;
 
-    std::vector<SignedAggregatedAttestation> aggregateSignatures();
+    /**
+     * Select head using incrementally maintained `proto_array_`.
+     * Falls back to `computeLmdGhostHead` if anchor can't be found in it.
+     */
+    outcome::result<BlockHash> findHead(const BlockHash &start_root);
+
+    /**
+     * Move head to imported `block` if it is only child of head and no
+     * known vote moved since head was selected, so head update would
+     * select it too.
+     * @return false if full `updateHead` is needed
+     */
+    bool tryExtendHead(const BlockIndex &block, const BlockHash &parent_root);
+
+    /// Set selected head and publish it
+    void setHead(const Checkpoint &head);
+
+    /**
+     * Select safe target using new votes of `proto_array_`.
+     * Falls back to `computeLmdGhostHead` if anchor can't be found in it.
+     */
+    outcome::result<BlockHash> findSafeTarget(const BlockHash &start_root,
+                                              uint64_t min_score);
+
+    /**
+     * Find common ancestor by walking headers from `a` and `b`.
+     * Used when blocks are not in in-memory block tree.
+     */
+    outcome::result<blockchain::CommonAncestor> liftToCommonAncestor(
+        Checkpoint a, Checkpoint b) const;
+
+    /// Repopulate `proto_array_` from block tree and all attestations.
+    outcome::result<void> rebuildProtoArray();
+
+    void setKnownAttestation(ValidatorIndex validator_index,
+                             const AttestationData &data);
+    void setNewAttestation(ValidatorIndex validator_index,
+                           const AttestationData &data);
+    void eraseNewAttestation(ValidatorIndex validator_index);
+
+    /// Vote update of `onAttestation` for validators of validated `data`
+    outcome::result<void> applyAttestationVotes(
+        const AttestationData &data,
+        std::span<const ValidatorIndex> validators,
+        bool is_from_block);
+
+    /// Select attestations of block on head, see `buildProposal`
+    outcome::result<PreparedProposal> selectProposal(
+        Slot slot, ValidatorIndex proposer_index);
+
+    /**
+     * Build block of `slot` in advance if own validator proposes it, so
+     * its production only signs it, unless head or attestations changed.
+     * Block is not signed, as proposer key may sign only one block per
+     * slot.
+     * @param deferred_proposal if set, block is stored there to be built by
+     * caller, see `onTick`
+     */
+    void prepareProposal(Slot slot,
+                         std::optional<PreparedProposal> *deferred_proposal);
+
+    /// Count block production result of `slot`
+    void reportProduction(Slot slot, const outcome::result<void> &res);
+
+    /// Count duty of slot which is over, skipped on catch-up after stall
+    void skipStaleDuty(std::string_view duty, Slot slot);
+
+    /// Known attestations, proofs or blocks changed, see `prepareProposal`
+    void proposalInputsChanged() {
+      ++proposal_inputs_version_;
+    }
+
+    /// State of `parent_root` advanced by `advanceState`, or nullptr
+    std::shared_ptr<const State> advancedState(const BlockHash &parent_root,
+                                               Slot slot) const;
+
+    /// Keep states of checkpoints used by head and attestation production
+    void pinStates();
+    void updateMetricStateCache() const;
+    /// Estimated memory of states, votes and gossip aggregates, per slot
+    void updateMetricMemory() const;
+
+    /// Copy of votes, aggregation pool and hot state set, to persist
+    ForkChoiceSnapshot makeSnapshot() const;
+    /// Load snapshot of previous run, dropping votes outdated meanwhile
+    void restoreSnapshot();
 
     void prune(Slot finalized_slot);
     void updateMetricGossipSignatures();
@@ -499,6 +958,10 @@ namespace lean {
 
     STF stf_;
     Interval time_;
+    std::optional<PreparedProposal> prepared_proposal_;
+    uint64_t proposal_inputs_version_ = 0;
+    /// Interval 2 waiting for aggregation deferred by `onTick`
+    std::optional<IntervalDeadline> deferred_deadline_;
 
     /// Chain configuration parameters.
     Config config_;
@@ -519,14 +982,41 @@ namespace lean {
      */
     Checkpoint safe_target_;
 
+    /// See `apiForkChoiceVersion`
+    std::atomic_uint64_t api_fork_choice_version_ = 0;
+
     /**
      * For each known block, we keep its post-state.
      *
      * These states carry justified and finalized checkpoints that we use to
      * update the Store's latest justified and latest finalized checkpoints.
+     * Bounded by `database.state_cache_size`, states of head, justified,
+     * finalized and safe-target are pinned. Evicted ones are kept compressed
+     * within `database.state_warm_cache_size`.
      */
-    static constexpr int kStateCacheSize = 16;
-    mutable LruCache<BlockHash, State> states_{kStateCacheSize};
+    static constexpr size_t kStateCacheSize = size_t{512} << 20;
+    mutable StateCache states_{kStateCacheSize};
+    /// Warm hits already added to metric
+    mutable std::atomic_uint64_t reported_warm_hits_ = 0;
+    mutable AdvancedStateCache advanced_state_;
+
+    /**
+     * Time block production may spend merging overlapping proofs of same
+     * attestation data into single proof.
+     */
+    static constexpr std::chrono::milliseconds kProposalReaggregationBudget =
+        INTERVAL_DURATION_MS / 4;
+
+    /**
+     * Aggregated proofs which were already successfully verified.
+     *
+     * The same proof is usually seen on gossip first and then again inside
+     * block body, so block import can skip its verification.
+     * Thread safe, block import verifies signatures without store lock.
+     */
+    static constexpr int kVerifiedProofsCacheSize = 256;
+    mutable ShardedLruCache<Hash, bool> verified_proofs_{
+        kVerifiedProofsCacheSize};
 
     /**
      * Active attestations that contribute to fork choice weights.
@@ -541,6 +1031,13 @@ namespace lean {
      */
     AttestationDataByValidator latest_known_attestations_;
 
+    /**
+     * Weights of `latest_known_attestations_` over non-finalized blocks.
+     * Kept in sync with each vote change, so head lookup does not recount
+     * all votes.
+     */
+    ProtoArray proto_array_;
+
     /**
      * Pending attestations awaiting activation.
      *
@@ -559,8 +1056,19 @@ namespace lean {
      * Accumulates signatures and aggregated proofs to be aggregated
      * in slot interval 2.
      * Grouped by attestation data.
+     * Keyed by data itself, so lookup costs cheap hash of its fields
+     * instead of ssz merkleization.
      */
-    std::unordered_map<Hash, AttestationsByData> attestations_by_data_;
+    std::unordered_map<AttestationData, AttestationsByData>
+        attestations_by_data_;
+    /**
+     * Data of `attestations_by_data_` groups by target slot, so pruning
+     * drops whole slots instead of scanning all groups.
+     */
+    std::map<Slot, std::vector<AttestationData>> attestation_data_by_slot_;
+    AggregationTotals aggregation_totals_;
+    /// Groups with partial aggregation in progress
+    std::unordered_set<AttestationData> partial_aggregations_;
     qtils::SharedRef<ValidatorRegistry> validator_registry_;
     qtils::SharedRef<app::ValidatorKeysManifest> validator_keys_manifest_;
     /**
@@ -569,8 +1077,21 @@ namespace lean {
     ValidatorIndex validator_id_;
     std::function<bool()> is_aggregator_;
     uint64_t subnet_count_;
+    /// Extra subnets aggregated besides subnet of `validator_id_`
+    std::vector<SubnetIndex> aggregate_subnets_;
+    AggregatorDuty aggregator_duty_;
+    std::optional<AttestationData> attestation_duty_;
     bool dont_propose_ = false;
-    std::unordered_map<BlockHash, Slot> anchor_block_slots_;
+    struct Follower {
+      uint64_t seed;
+      double sample_rate;
+    };
+    std::optional<Follower> follower_;
+    BlockHashMap<Slot> anchor_block_slots_;
+
+    /// Snapshot is saved at end of each such number of slots
+    static constexpr Slot kSnapshotIntervalSlots = 4;
+    bool snapshots_enabled_ = false;
   };
 
 }  // namespace lean
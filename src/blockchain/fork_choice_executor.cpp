@@ -0,0 +1,131 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/fork_choice_executor.hpp"
+
+#include "log/flight_recorder.hpp"
+#include "metrics/metrics.hpp"
+#include "utils/thread_placement.hpp"
+
+namespace lean {
+  namespace {
+    thread_local const ForkChoiceExecutor *current_executor = nullptr;
+
+    constexpr std::array kPriorityNames{
+        "tick",
+        "block",
+        "gossip",
+        "background",
+        "query",
+    };
+    static_assert(kPriorityNames.size()
+                  == static_cast<size_t>(ForkChoiceExecutor::Priority::COUNT));
+  }  // namespace
+
+  std::string_view ForkChoiceExecutor::priorityName(Priority priority) {
+    return kPriorityNames.at(static_cast<size_t>(priority));
+  }
+
+  ForkChoiceExecutor::ForkChoiceExecutor(LockStats &stats,
+                                         metrics::Metrics &metrics,
+                                         size_t queue_capacity)
+      : stats_{stats} {
+    for (size_t i = 0; i < queues_.size(); ++i) {
+      metrics::Labels labels{{"priority", std::string{kPriorityNames.at(i)}}};
+      queues_.at(i) = {
+          .commands = std::make_unique<MpmcQueue<Command>>(queue_capacity),
+          .depth = metrics.fc_executor_queue_depth(labels),
+          .wait_time = metrics.fc_executor_wait_time(labels),
+      };
+    }
+    thread_ = std::thread{[this] {
+      setThreadName("fork_choice");
+      current_executor = this;
+      loop();
+    }};
+  }
+
+  ForkChoiceExecutor::~ForkChoiceExecutor() {
+    {
+      std::lock_guard lock{sleep_mutex_};
+      stop_ = true;
+    }
+    sleep_cv_.notify_one();
+    thread_.join();
+  }
+
+  bool ForkChoiceExecutor::isOwnerThread() const {
+    return current_executor == this;
+  }
+
+  void ForkChoiceExecutor::post(Priority priority, Task task) {
+    Command command{
+        .task = std::move(task),
+        .site = LockSiteScope::current(),
+        .queued_at = Clock::now(),
+        .contended = not sleeping_.load() or pending_.load() != 0,
+    };
+    auto &queue = queues_.at(static_cast<size_t>(priority));
+    // Before push, so gauge doesn't go below zero
+    queue.depth->inc();
+    // Backpressure, callers wait for owner thread anyway
+    while (not queue.commands->tryPush(std::move(command))) {
+      std::this_thread::yield();
+    }
+    // Either sleeping owner is seen here, or it sees `pending_` before wait
+    pending_.fetch_add(1);
+    if (sleeping_.load()) {
+      { std::lock_guard lock{sleep_mutex_}; }
+      sleep_cv_.notify_one();
+    }
+  }
+
+  void ForkChoiceExecutor::loop() {
+    Command command;
+    for (;;) {
+      Queue *popped = nullptr;
+      if (pending_.load() != 0) {
+        for (auto &queue : queues_) {
+          if (queue.commands->tryPop(command)) {
+            popped = &queue;
+            break;
+          }
+        }
+      }
+      if (popped != nullptr) {
+        pending_.fetch_sub(1);
+        auto &site = stats_.site(command.site);
+        auto started_at = Clock::now();
+        popped->depth->dec();
+        popped->wait_time->observe(
+            std::chrono::duration<double>(started_at - command.queued_at)
+                .count());
+        if (command.contended) {
+          site.recordWait(started_at - command.queued_at);
+        } else {
+          site.acquisitions.fetch_add(1, std::memory_order_relaxed);
+        }
+        {
+          LockSiteScope scope{command.site};
+          log::FlightSpan span{"fork choice command",
+                               static_cast<uint64_t>(command.site)};
+          command.task();
+        }
+        site.recordHold(Clock::now() - started_at);
+        command.task = nullptr;
+        continue;
+      }
+      std::unique_lock lock{sleep_mutex_};
+      if (stop_ and pending_.load() == 0) {
+        return;
+      }
+      sleeping_.store(true);
+      sleep_cv_.wait(lock, [&] { return stop_ or pending_.load() != 0; });
+      sleeping_.store(false);
+    }
+  }
+
+}  // namespace lean
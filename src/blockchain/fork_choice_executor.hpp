@@ -0,0 +1,151 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <semaphore>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+#include "blockchain/lock_profiler.hpp"
+#include "utils/mpmc_queue.hpp"
+
+namespace lean::metrics {
+  class Gauge;
+  class Histogram;
+  class Metrics;
+}  // namespace lean::metrics
+
+namespace lean {
+
+  /**
+   * Single thread owning fork choice store state.
+   *
+   * Commands are queued to lock-free queue of their priority and run one by
+   * one on owner thread, so they need no lock. Command of highest priority
+   * queued is taken next, so deadline work of slot interval is delayed at
+   * most by one running command, not by gossip or background backlog.
+   *
+   * Queue depth and wait time are exported by priority. Queue wait and run
+   * time of commands are also recorded to lock stats by `LockSiteScope` site
+   * of caller, as for profiled mutex.
+   */
+  class ForkChoiceExecutor {
+   public:
+    enum class Priority : uint8_t {
+      /// Deadline work of ticks: own proposal, attestation and aggregation
+      TICK,
+      /// Blocks received from peers
+      BLOCK,
+      /// Gossip attestations
+      GOSSIP,
+      /// Replay of pending attestations, import of orphan forks
+      BACKGROUND,
+      /// API queries
+      QUERY,
+      COUNT,
+    };
+
+    static std::string_view priorityName(Priority priority);
+
+    ForkChoiceExecutor(LockStats &stats,
+                       metrics::Metrics &metrics,
+                       size_t queue_capacity);
+
+    ForkChoiceExecutor(const ForkChoiceExecutor &) = delete;
+    ForkChoiceExecutor &operator=(const ForkChoiceExecutor &) = delete;
+
+    /// Runs queued commands and joins owner thread
+    ~ForkChoiceExecutor();
+
+    /// Whether current thread is owner thread
+    bool isOwnerThread() const;
+
+    /**
+     * Run `command` on owner thread and wait for its result.
+     * Runs inline when called from owner thread, e.g. by nested command.
+     * Exception thrown by command is rethrown to caller.
+     */
+    template <typename F>
+    std::invoke_result_t<F &> run(Priority priority, F &&command) {
+      using R = std::invoke_result_t<F &>;
+      if (isOwnerThread()) {
+        return command();
+      }
+      using Result =
+          std::conditional_t<std::is_void_v<R>, bool, std::optional<R>>;
+      [[maybe_unused]] Result result{};
+      std::exception_ptr error;
+      std::binary_semaphore done{0};
+      post(priority, [&] {
+        try {
+          if constexpr (std::is_void_v<R>) {
+            command();
+          } else {
+            result.emplace(command());
+          }
+        } catch (...) {
+          error = std::current_exception();
+        }
+        done.release();
+      });
+      done.acquire();
+      if (error) {
+        std::rethrow_exception(error);
+      }
+      if constexpr (not std::is_void_v<R>) {
+        return std::move(*result);
+      }
+    }
+
+   private:
+    using Task = std::function<void()>;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Command {
+      Task task;
+      LockSite site = LockSite::OTHER;
+      Clock::time_point queued_at;
+      /// Owner thread was busy when command was queued
+      bool contended = false;
+    };
+
+    /// Queue command, waits while queue of priority is full
+    void post(Priority priority, Task task);
+
+    void loop();
+
+    struct Queue {
+      std::unique_ptr<MpmcQueue<Command>> commands;
+      metrics::Gauge *depth = nullptr;
+      metrics::Histogram *wait_time = nullptr;
+    };
+
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-const-or-ref-data-members)
+    LockStats &stats_;
+    std::array<Queue, static_cast<size_t>(Priority::COUNT)> queues_;
+    /// Commands queued and not taken yet
+    std::atomic_size_t pending_ = 0;
+    std::atomic_bool sleeping_ = false;
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    /// Guarded by `sleep_mutex_`
+    bool stop_ = false;
+    std::thread thread_;
+  };
+
+}  // namespace lean
@@ -6,59 +6,504 @@
 
 #include "blockchain/fork_choice_mutex.hpp"
 
+#include <algorithm>
+#include <iterator>
+#include <latch>
+
+#include "blockchain/chain_recorder.hpp"
 #include "blockchain/fork_choice.hpp"
 #include "types/fork_choice_api_json.hpp"
+#include "utils/worker_pool.hpp"
 
 namespace lean {
+  /// Commands of each priority queued before caller waits for space
+  constexpr size_t kQueueCapacity = 1024;
+
+  struct ForkChoiceStoreMutex::Checkpoints {
+    Checkpoint finalized;
+    Checkpoint justified;
+  };
+
   ForkChoiceStoreMutex::ForkChoiceStoreMutex(
-      qtils::SharedRef<ForkChoiceStore> fork_choice)
-      : fork_choice_{std::move(fork_choice)} {}
+      qtils::SharedRef<ForkChoiceStore> fork_choice,
+      qtils::SharedRef<WorkerPool> worker_pool,
+      qtils::SharedRef<ChainRecorder> recorder,
+      qtils::SharedRef<LockProfiler> lock_profiler,
+      qtils::SharedRef<metrics::Metrics> metrics)
+      : fork_choice_{std::move(fork_choice)},
+        worker_pool_{std::move(worker_pool)},
+        recorder_{std::move(recorder)},
+        executor_{
+            lock_profiler->lock("fork_choice"), *metrics, kQueueCapacity} {
+    executor_.run(Priority::QUERY, [&] { publishCheckpoints(); });
+  }
 
   Checkpoint ForkChoiceStoreMutex::getLatestFinalized() const {
-    std::shared_lock lock{mutex_};
-    return fork_choice_->getLatestFinalized();
+    return checkpoints_.load()->finalized;
   }
 
   Checkpoint ForkChoiceStoreMutex::getLatestJustified() const {
-    std::shared_lock lock{mutex_};
-    return fork_choice_->getLatestJustified();
+    return checkpoints_.load()->justified;
   }
 
   outcome::result<std::shared_ptr<const State>> ForkChoiceStoreMutex::getState(
       const BlockHash &block_hash) const {
-    std::unique_lock lock{mutex_};
-    return fork_choice_->getState(block_hash);
+    LockSiteScope site{LockSite::GET_STATE};
+    return executor_.run(Priority::QUERY,
+                         [&] { return fork_choice_->getState(block_hash); });
+  }
+
+  void ForkChoiceStoreMutex::prefetchStates(
+      std::vector<BlockHash> block_hashes) const {
+    if (block_hashes.empty()) {
+      return;
+    }
+    // Store lock is not needed, see `ForkChoiceStore::prefetchState`
+    worker_pool_->post([fork_choice{fork_choice_},
+                        block_hashes{std::move(block_hashes)}] {
+      for (auto &block_hash : block_hashes) {
+        fork_choice->prefetchState(block_hash);
+      }
+    });
   }
 
   outcome::result<void> ForkChoiceStoreMutex::onGossipAttestation(
-      const SignedAttestation &signed_attestation) {
-    std::unique_lock lock{mutex_};
-    return fork_choice_->onGossipAttestation(signed_attestation);
+      const SignedAttestation &signed_attestation, Priority priority) {
+    recorder_->recordAttestation(signed_attestation);
+    LockSiteScope site{LockSite::ON_GOSSIP_ATTESTATION};
+    OUTCOME_TRY(state, executor_.run(priority, [&] {
+      return fork_choice_->beginGossipAttestation(signed_attestation);
+    }));
+    // Signature verification is slow, don't block blocks meanwhile
+    OUTCOME_TRY(
+        fork_choice_->verifyGossipAttestation(*state, signed_attestation));
+    executor_.run(priority, [&] {
+      fork_choice_->commitGossipAttestation(signed_attestation);
+      publishCheckpoints();
+      postPartialAggregation();
+    });
+    return outcome::success();
   }
 
   outcome::result<void> ForkChoiceStoreMutex::onGossipAggregatedAttestation(
-      const SignedAggregatedAttestation &signed_aggregated_attestation) {
-    std::unique_lock lock{mutex_};
-    return fork_choice_->onGossipAggregatedAttestation(
-        signed_aggregated_attestation);
+      const SignedAggregatedAttestation &signed_aggregated_attestation,
+      Priority priority) {
+    recorder_->recordAggregatedAttestation(signed_aggregated_attestation);
+    LockSiteScope site{LockSite::ON_GOSSIP_AGGREGATED_ATTESTATION};
+    OUTCOME_TRY(state, executor_.run(priority, [&] {
+      return fork_choice_->beginGossipAggregatedAttestation(
+          signed_aggregated_attestation);
+    }));
+    // Error, so invalid aggregation is not marked seen
+    if (not fork_choice_->verifyGossipAggregatedAttestation(
+            *state, signed_aggregated_attestation)) {
+      return ForkChoiceStore::Error::INVALID_ATTESTATION;
+    }
+    return executor_.run(priority, [&] {
+      auto res = fork_choice_->onAggregatedAttestation(
+          signed_aggregated_attestation, false);
+      publishCheckpoints();
+      return res;
+    });
+  }
+
+  void ForkChoiceStoreMutex::postGossipAttestation(
+      SignedAttestation signed_attestation, OnGossipDone on_done) {
+    worker_pool_->post([weak_self{weak_from_this()},
+                        signed_attestation{std::move(signed_attestation)},
+                        on_done{std::move(on_done)}] {
+      auto self = weak_self.lock();
+      if (not self) {
+        return;
+      }
+      on_done(self->onGossipAttestation(signed_attestation));
+    });
+  }
+
+  void ForkChoiceStoreMutex::postGossipAggregatedAttestation(
+      SignedAggregatedAttestation signed_aggregated_attestation,
+      OnGossipDone on_done) {
+    worker_pool_->post(
+        [weak_self{weak_from_this()},
+         signed_aggregated_attestation{
+             std::move(signed_aggregated_attestation)},
+         on_done{std::move(on_done)}] {
+          auto self = weak_self.lock();
+          if (not self) {
+            return;
+          }
+          on_done(self->onGossipAggregatedAttestation(
+              signed_aggregated_attestation));
+        });
   }
 
   outcome::result<void> ForkChoiceStoreMutex::onBlock(
       SignedBlock signed_block) {
-    std::unique_lock lock{mutex_};
-    return fork_choice_->onBlock(std::move(signed_block));
+    recorder_->recordBlock(signed_block);
+    LockSiteScope site{LockSite::ON_BLOCK};
+    OUTCOME_TRY(block_import, executor_.run(Priority::BLOCK, [&] {
+      return fork_choice_->beginBlockImport(std::move(signed_block));
+    }));
+    if (not block_import.has_value()) {
+      return outcome::success();
+    }
+    // Block of wrong proposer is dropped before slow steps
+    OUTCOME_TRY(fork_choice_->validateBlockProposer(
+        block_import->signed_block, *block_import->parent_state));
+    // Signatures and state transition are slow, don't block attestations.
+    // They are independent, so signatures are verified on worker pool
+    // while state transition runs here.
+    bool valid_signatures = false;
+    std::latch verified{1};
+    worker_pool_->post([&] {
+      valid_signatures = fork_choice_->validateBlockAttestationSignatures(
+          block_import->signed_block, *block_import->parent_state);
+      verified.count_down();
+    });
+    auto applied = fork_choice_->applyBlockImport(*block_import,
+                                                  *block_import->parent_state);
+    worker_pool_->wait(verified);
+    if (not valid_signatures) {
+      return ForkChoiceStore::Error::INVALID_ATTESTATION;
+    }
+    OUTCOME_TRY(applied);
+    fork_choice_->storeBlockImport(*block_import);
+    return executor_.run(Priority::BLOCK, [&] {
+      auto res = fork_choice_->commitBlockImport(*block_import);
+      publishCheckpoints();
+      return res;
+    });
+  }
+
+  ForkChoiceStoreMutex::SegmentImport ForkChoiceStoreMutex::onBlocks(
+      std::vector<SignedBlock> signed_blocks, Priority priority) {
+    auto count = signed_blocks.size();
+    for (auto &signed_block : signed_blocks) {
+      recorder_->recordBlock(signed_block);
+    }
+    LockSiteScope site{LockSite::ON_BLOCK};
+    auto begin_res = executor_.run(priority, [&] {
+      return fork_choice_->beginSegmentImport(std::move(signed_blocks));
+    });
+    if (begin_res.has_error()) {
+      return {.result = begin_res.error()};
+    }
+    auto &block_imports = begin_res.value();
+    auto known = count - block_imports.size();
+    SegmentImport segment{.imported = known};
+    if (block_imports.empty()) {
+      return segment;
+    }
+    // Signatures and state transitions are slow, don't block attestations
+    auto parent_state = [&](size_t i) -> const State & {
+      return i == 0 ? *block_imports[0].parent_state
+                    : block_imports[i - 1].post_state;
+    };
+
+    // Each state transition needs post-state of previous block
+    size_t applied = 0;
+    for (; applied < block_imports.size(); ++applied) {
+      auto res = fork_choice_->applyBlockImport(block_imports[applied],
+                                                parent_state(applied));
+      if (res.has_error()) {
+        segment.result = res.error();
+        break;
+      }
+    }
+
+    // std::vector<bool> can't be written concurrently
+    std::vector<uint8_t> valid(applied);
+    std::latch done{static_cast<std::ptrdiff_t>(applied)};
+    for (size_t i = 0; i < applied; ++i) {
+      worker_pool_->post([&, i] {
+        valid[i] = fork_choice_->validateBlockSignatures(
+            block_imports[i].signed_block, parent_state(i));
+        done.count_down();
+      });
+    }
+    worker_pool_->wait(done);
+    auto verified =
+        static_cast<size_t>(std::ranges::find(valid, 0) - valid.begin());
+    if (verified != applied) {
+      segment.result = ForkChoiceStore::Error::INVALID_ATTESTATION;
+    }
+
+    for (size_t i = 0; i < verified; ++i) {
+      fork_choice_->storeBlockImport(block_imports[i]);
+    }
+
+    executor_.run(priority, [&] {
+      for (size_t i = 0; i < verified; ++i) {
+        auto res = fork_choice_->commitBlockImport(block_imports[i], false);
+        if (res.has_error()) {
+          segment.result = res.error();
+          break;
+        }
+        ++segment.imported;
+      }
+      if (segment.imported != known) {
+        auto res = fork_choice_->updateHead();
+        if (res.has_error() and not segment.result.has_error()) {
+          segment.result = res.error();
+        }
+      }
+      publishCheckpoints();
+    });
+    return segment;
+  }
+
+  ForkChoiceStoreMutex::PendingImport
+  ForkChoiceStoreMutex::onPendingAttestations(
+      const std::vector<SignedAttestation> &signed_attestations,
+      const std::vector<SignedAggregatedAttestation>
+          &signed_aggregated_attestations) {
+    for (auto &signed_attestation : signed_attestations) {
+      recorder_->recordAttestation(signed_attestation);
+    }
+    for (auto &signed_aggregated_attestation :
+         signed_aggregated_attestations) {
+      recorder_->recordAggregatedAttestation(signed_aggregated_attestation);
+    }
+    LockSiteScope site{LockSite::ON_GOSSIP_ATTESTATION};
+    auto ok = [](size_t count) {
+      return std::vector<outcome::result<void>>(count, outcome::success());
+    };
+    PendingImport import{
+        .attestations = ok(signed_attestations.size()),
+        .aggregated_attestations = ok(signed_aggregated_attestations.size()),
+    };
+    std::vector<std::shared_ptr<const State>> states(
+        signed_attestations.size());
+    std::vector<std::shared_ptr<const State>> aggregated_states(
+        signed_aggregated_attestations.size());
+    executor_.run(Priority::BACKGROUND, [&] {
+      for (size_t i = 0; i < signed_attestations.size(); ++i) {
+        auto res = fork_choice_->beginGossipAttestation(signed_attestations[i]);
+        if (res.has_error()) {
+          import.attestations[i] = res.error();
+          continue;
+        }
+        states[i] = std::move(res.value());
+      }
+      for (size_t i = 0; i < signed_aggregated_attestations.size(); ++i) {
+        auto res = fork_choice_->beginGossipAggregatedAttestation(
+            signed_aggregated_attestations[i]);
+        if (res.has_error()) {
+          import.aggregated_attestations[i] = res.error();
+          continue;
+        }
+        aggregated_states[i] = std::move(res.value());
+      }
+    });
+
+    // Signature verification is slow, don't block blocks meanwhile
+    auto began = [](auto &state) { return state != nullptr; };
+    auto tasks = std::ranges::count_if(states, began)
+               + std::ranges::count_if(aggregated_states, began);
+    // std::vector<bool> can't be written concurrently
+    std::vector<uint8_t> aggregated_valid(aggregated_states.size());
+    std::latch done{tasks};
+    for (size_t i = 0; i < states.size(); ++i) {
+      if (states[i] == nullptr) {
+        continue;
+      }
+      worker_pool_->post([&, i] {
+        import.attestations[i] = fork_choice_->verifyGossipAttestation(
+            *states[i], signed_attestations[i]);
+        done.count_down();
+      });
+    }
+    for (size_t i = 0; i < aggregated_states.size(); ++i) {
+      if (aggregated_states[i] == nullptr) {
+        continue;
+      }
+      worker_pool_->post([&, i] {
+        aggregated_valid[i] = fork_choice_->verifyGossipAggregatedAttestation(
+            *aggregated_states[i], signed_aggregated_attestations[i]);
+        done.count_down();
+      });
+    }
+    worker_pool_->wait(done);
+
+    executor_.run(Priority::BACKGROUND, [&] {
+      for (size_t i = 0; i < states.size(); ++i) {
+        if (states[i] != nullptr and import.attestations[i].has_value()) {
+          fork_choice_->commitGossipAttestation(signed_attestations[i]);
+        }
+      }
+      for (size_t i = 0; i < aggregated_states.size(); ++i) {
+        if (aggregated_states[i] == nullptr) {
+          continue;
+        }
+        import.aggregated_attestations[i] =
+            aggregated_valid[i] != 0
+                ? fork_choice_->onAggregatedAttestation(
+                      signed_aggregated_attestations[i], false)
+                : ForkChoiceStore::Error::INVALID_ATTESTATION;
+      }
+      publishCheckpoints();
+      postPartialAggregation();
+    });
+    return import;
   }
 
   std::vector<ForkChoiceStoreMutex::OnTickAction> ForkChoiceStoreMutex::onTick(
       std::chrono::milliseconds now) {
-    std::unique_lock lock{mutex_};
-    return fork_choice_->onTick(now);
+    recorder_->recordTick(now);
+    std::vector<ForkChoiceStore::AggregationJob> jobs;
+    std::optional<ForkChoiceStore::StateAdvanceJob> state_advance;
+    std::optional<ForkChoiceSnapshot> snapshot;
+    std::optional<ForkChoiceStore::AttestationJob> attestation;
+    std::optional<ForkChoiceStore::ProductionJob> production;
+    std::optional<ForkChoiceStore::PreparedProposal> proposal;
+    LockSiteScope site{LockSite::ON_TICK};
+    std::vector<OnTickAction> result;
+    // Signing and hashing wait for worker pool, whose gossip tasks wait for
+    // store, so they run between tick commands
+    do {
+      production.reset();
+      auto ticked = executor_.run(Priority::TICK, [&] {
+        auto actions = fork_choice_->onTick(now,
+                                            &jobs,
+                                            &state_advance,
+                                            &snapshot,
+                                            &attestation,
+                                            &production,
+                                            &proposal);
+        publishCheckpoints();
+        return actions;
+      });
+      std::ranges::move(ticked, std::back_inserter(result));
+      if (production.has_value()) {
+        auto block_import = fork_choice_->produceBlock(*production);
+        auto produced = executor_.run(Priority::TICK, [&] {
+          auto actions = fork_choice_->commitProduction(
+              std::move(*production), std::move(block_import));
+          publishCheckpoints();
+          return actions;
+        });
+        std::ranges::move(produced, std::back_inserter(result));
+      }
+    } while (production.has_value());
+    if (attestation.has_value()) {
+      auto signatures = fork_choice_->signAttestations(*attestation);
+      auto committed = executor_.run(Priority::TICK, [&] {
+        auto actions = fork_choice_->commitAttestations(
+            std::move(*attestation), std::move(signatures));
+        publishCheckpoints();
+        return actions;
+      });
+      std::ranges::move(committed, std::back_inserter(result));
+    }
+    if (proposal.has_value()) {
+      // Prepared block starts from advanced state, so it is advanced first
+      if (state_advance.has_value()) {
+        fork_choice_->advanceState(*state_advance);
+        state_advance.reset();
+      }
+      auto slot = proposal->block.slot;
+      auto built = fork_choice_->buildProposal(std::move(*proposal));
+      executor_.run(Priority::TICK, [&] {
+        fork_choice_->storeProposal(slot, std::move(built));
+      });
+    }
+    if (state_advance.has_value()) {
+      // Store lock is not needed, see `ForkChoiceStore::advanceState`
+      worker_pool_->post(
+          [fork_choice{fork_choice_}, job{std::move(*state_advance)}] {
+            fork_choice->advanceState(job);
+          });
+    }
+    if (snapshot.has_value()) {
+      // Encoding all gossip signatures and proofs is slow
+      worker_pool_->post([fork_choice{fork_choice_},
+                          snapshot{std::move(*snapshot)}] {
+        fork_choice->writeSnapshot(snapshot);
+      });
+    }
+    if (not jobs.empty()) {
+      // Aggregation is slow, don't block gossip and blocks meanwhile
+      auto aggregated_attestations = fork_choice_->aggregate(jobs);
+      auto imported = executor_.run(Priority::TICK, [&] {
+        auto actions = fork_choice_->importAggregations(
+            std::move(aggregated_attestations));
+        publishCheckpoints();
+        return actions;
+      });
+      std::ranges::move(imported, std::back_inserter(result));
+    }
+    if (recorder_->enabled()) {
+      // Replay doesn't produce, so own messages are replayed as received
+      for (auto &action : result) {
+        recordAction(action);
+      }
+    }
+    return result;
+  }
+
+  void ForkChoiceStoreMutex::recordAction(const OnTickAction &action) {
+    if (auto *block = std::get_if<SignedBlock>(&action)) {
+      recorder_->recordBlock(*block);
+    } else if (auto *attestation = std::get_if<SignedAttestation>(&action)) {
+      recorder_->recordAttestation(*attestation);
+    } else if (auto *aggregated =
+                   std::get_if<SignedAggregatedAttestation>(&action)) {
+      recorder_->recordAggregatedAttestation(*aggregated);
+    }
   }
 
   outcome::result<ForkChoiceApiJson> ForkChoiceStoreMutex::apiForkChoice()
       const {
-    std::shared_lock lock{mutex_};
-    return fork_choice_->apiForkChoice();
+    LockSiteScope site{LockSite::API_FORK_CHOICE};
+    return executor_.run(Priority::QUERY,
+                         [&] { return fork_choice_->apiForkChoice(); });
+  }
+
+  std::optional<AttestationData> ForkChoiceStoreMutex::attestationDuty()
+      const {
+    LockSiteScope site{LockSite::QUERY};
+    return executor_.run(Priority::QUERY,
+                         [&] { return fork_choice_->attestationDuty(); });
+  }
+
+  uint64_t ForkChoiceStoreMutex::apiForkChoiceVersion() const {
+    return fork_choice_->apiForkChoiceVersion();
+  }
+
+  bool ForkChoiceStoreMutex::optimistic() const {
+    return fork_choice_->optimistic();
+  }
+
+  void ForkChoiceStoreMutex::postPartialAggregation() {
+    auto jobs = fork_choice_->preparePartialAggregation();
+    if (jobs.empty()) {
+      return;
+    }
+    worker_pool_->post([weak_self{weak_from_this()}, jobs{std::move(jobs)}] {
+      auto self = weak_self.lock();
+      if (not self) {
+        return;
+      }
+      auto aggregated_attestations = self->fork_choice_->aggregate(jobs);
+      self->executor_.run(Priority::BACKGROUND, [&] {
+        self->fork_choice_->importPartialAggregations(
+            jobs, std::move(aggregated_attestations));
+      });
+    });
+  }
+
+  void ForkChoiceStoreMutex::publishCheckpoints() {
+    Checkpoints checkpoints{
+        .finalized = fork_choice_->getLatestFinalized(),
+        .justified = fork_choice_->getLatestJustified(),
+    };
+    auto published = checkpoints_.load();
+    if (published and published->finalized == checkpoints.finalized
+        and published->justified == checkpoints.justified) {
+      return;
+    }
+    checkpoints_.store(
+        std::make_shared<const Checkpoints>(std::move(checkpoints)));
   }
 
 }  // namespace lean
@@ -6,46 +6,141 @@
 
 #pragma once
 
-#include <shared_mutex>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
 
 #include <qtils/shared_ref.hpp>
 
+#include "blockchain/fork_choice_executor.hpp"
+#include "blockchain/lock_profiler.hpp"
 #include "types/block_hash.hpp"
 #include "types/signed_aggregated_attestation.hpp"
 #include "types/signed_attestation.hpp"
 #include "types/signed_block.hpp"
 
+namespace lean::metrics {
+  class Metrics;
+}  // namespace lean::metrics
+
 namespace lean {
+  class ChainRecorder;
   class ForkChoiceStore;
+  class WorkerPool;
   struct Checkpoint;
   struct ForkChoiceApiJson;
   struct State;
 
   /**
-   * Protect public ForkChoiceStore methods called from different threads.
+   * Serialize public ForkChoiceStore methods called from different threads.
    * Keep internal ForkChoiceStore methods public for tests.
+   *
+   * Store state is owned by `ForkChoiceExecutor` thread, short begin and
+   * commit steps of commands run there by priority. Slow steps (signature
+   * verification, state transition, aggregation) run on caller thread or
+   * worker pool in between, as they don't touch shared store state.
+   * Latest checkpoints are read from snapshot published by owner thread.
    */
-  class ForkChoiceStoreMutex {
+  class ForkChoiceStoreMutex
+      : public std::enable_shared_from_this<ForkChoiceStoreMutex> {
    public:
-    ForkChoiceStoreMutex(qtils::SharedRef<ForkChoiceStore> fork_choice);
+    /// Called on worker thread with result of gossip message processing
+    using OnGossipDone = std::function<void(outcome::result<void>)>;
+    using Priority = ForkChoiceExecutor::Priority;
+
+    ForkChoiceStoreMutex(qtils::SharedRef<ForkChoiceStore> fork_choice,
+                         qtils::SharedRef<WorkerPool> worker_pool,
+                         qtils::SharedRef<ChainRecorder> recorder,
+                         qtils::SharedRef<LockProfiler> lock_profiler,
+                         qtils::SharedRef<metrics::Metrics> metrics);
 
     Checkpoint getLatestFinalized() const;
     Checkpoint getLatestJustified() const;
     outcome::result<std::shared_ptr<const State>> getState(
         const BlockHash &block_hash) const;
+    /// Load states into cache on worker pool, without waiting
+    void prefetchStates(std::vector<BlockHash> block_hashes) const;
     outcome::result<void> onGossipAttestation(
-        const SignedAttestation &signed_attestation);
+        const SignedAttestation &signed_attestation,
+        Priority priority = Priority::GOSSIP);
     outcome::result<void> onGossipAggregatedAttestation(
-        const SignedAggregatedAttestation &signed_aggregated_attestation);
+        const SignedAggregatedAttestation &signed_aggregated_attestation,
+        Priority priority = Priority::GOSSIP);
+    /**
+     * Process gossip attestation on worker pool, so signatures of many
+     * attestations are verified on many cores instead of caller thread.
+     */
+    void postGossipAttestation(SignedAttestation signed_attestation,
+                               OnGossipDone on_done);
+    /// Process gossip aggregated attestation on worker pool
+    void postGossipAggregatedAttestation(
+        SignedAggregatedAttestation signed_aggregated_attestation,
+        OnGossipDone on_done);
     outcome::result<void> onBlock(SignedBlock signed_block);
 
+    struct PendingImport {
+      /// Result of each attestation, in order of input
+      std::vector<outcome::result<void>> attestations;
+      std::vector<outcome::result<void>> aggregated_attestations;
+    };
+    /**
+     * Import attestations which waited for their block, as one batch.
+     * Store command runs once to begin and once to commit whole batch,
+     * signatures are verified concurrently on worker pool.
+     */
+    PendingImport onPendingAttestations(
+        const std::vector<SignedAttestation> &signed_attestations,
+        const std::vector<SignedAggregatedAttestation>
+            &signed_aggregated_attestations);
+
+    struct SegmentImport {
+      /// Number of leading blocks imported or known already
+      size_t imported = 0;
+      /// Error of first block not imported
+      outcome::result<void> result = outcome::success();
+    };
+    /**
+     * Import chain segment, each block is child of previous one.
+     * Store command runs once to begin and once to commit whole segment,
+     * head is updated once. Signatures of all blocks are verified
+     * concurrently on worker pool.
+     * @param priority `BACKGROUND` for import of orphan forks
+     */
+    SegmentImport onBlocks(std::vector<SignedBlock> signed_blocks,
+                           Priority priority = Priority::BLOCK);
+
     using OnTickAction = std::
         variant<SignedAttestation, SignedAggregatedAttestation, SignedBlock>;
     std::vector<OnTickAction> onTick(std::chrono::milliseconds now);
     outcome::result<ForkChoiceApiJson> apiForkChoice() const;
+    /// See `ForkChoiceStore::attestationDuty`
+    std::optional<AttestationData> attestationDuty() const;
+    /// Version of `apiForkChoice` result, read without lock
+    uint64_t apiForkChoiceVersion() const;
+    /// See `ForkChoiceStore::optimistic`, set on construction
+    bool optimistic() const;
 
    private:
+    struct Checkpoints;
+
+    void recordAction(const OnTickAction &action);
+
+    /**
+     * Aggregate signatures collected so far on worker pool, without waiting
+     * for result, called on owner thread.
+     */
+    void postPartialAggregation();
+
+    /// Publish latest checkpoints if changed, called on owner thread
+    void publishCheckpoints();
+
     qtils::SharedRef<ForkChoiceStore> fork_choice_;
-    mutable std::shared_mutex mutex_;
+    qtils::SharedRef<WorkerPool> worker_pool_;
+    qtils::SharedRef<ChainRecorder> recorder_;
+    std::atomic<std::shared_ptr<const Checkpoints>> checkpoints_;
+    /// Destroyed first, joins owner thread
+    mutable ForkChoiceExecutor executor_;
   };
 }  // namespace lean
@@ -6,13 +6,14 @@
 
 #include "blockchain/impl/anchor_block_impl.hpp"
 
+#include "blockchain/state_root.hpp"
 #include "types/state.hpp"
 
 namespace lean::blockchain {
 
   AnchorBlockImpl::AnchorBlockImpl(const AnchorState &state) {
     BlockHeader::operator=(state.latest_block_header);
-    state_root = sszHash(state);
+    state_root = stateRoot(state);
     updateHash();
   }
 
@@ -6,22 +6,40 @@
 
 #include "blockchain/impl/anchor_state_impl.hpp"
 
+#include <fmt/ranges.h>
+
 #include "app/configuration.hpp"
 #include "app/state_manager.hpp"
+#include "blockchain/chain_record.hpp"
 #include "blockchain/genesis_config.hpp"
+#include "blockchain/stored_chain.hpp"
 #include "modules/networking/ssl_context.hpp"
 #include "modules/networking/state_sync_client.hpp"
 #include "modules/production/read_config_yaml.hpp"
 #include "qtils/value_or_raise.hpp"
+#include "serde/serialization.hpp"
 
 namespace lean::blockchain {
 
   AnchorStateImpl::AnchorStateImpl(
       qtils::SharedRef<log::LoggingSystem> logsys,
       qtils::SharedRef<const app::Configuration> app_config,
-      qtils::SharedRef<app::StateManager> app_state_mngr) {
-    if (app_config->stateSyncUrl().has_value()) {
-      const auto &state_sync_url = app_config->stateSyncUrl().value();
+      qtils::SharedRef<app::StateManager> app_state_mngr,
+      std::shared_ptr<StoredChain> stored_chain) {
+    if (stored_chain) {
+      static_cast<State &>(*this) = stored_chain->anchorState();
+      return;
+    }
+    if (auto &path = app_config->replayChain(); path.has_value()) {
+      auto record = qtils::valueOrRaise(readChainRecordingAnchor(*path));
+      static_cast<State &>(*this) =
+          qtils::valueOrRaise(decode<State>(record.payload));
+      return;
+    }
+
+    if (not app_config->stateSyncUrls().empty()) {
+      const auto &state_sync_urls = app_config->stateSyncUrls();
+      auto state_sync_url = fmt::format("{}", fmt::join(state_sync_urls, ", "));
       auto logger = logsys->getLogger("StateSyncing", "networking");
 
       SL_INFO(logger,
@@ -34,7 +52,7 @@ namespace lean::blockchain {
       std::shared_ptr<State> state{};
       for (int attempt = 1; attempt <= 3; ++attempt) {
         auto state_res =
-            state_sync_client.fetch(state_sync_url, std::chrono::seconds(600));
+            state_sync_client.fetch(state_sync_urls, std::chrono::seconds(600));
         if (state_res.has_error()) {
           SL_WARN(
               logger,
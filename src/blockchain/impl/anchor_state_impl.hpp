@@ -22,6 +22,7 @@ namespace lean::app {
 }
 
 namespace lean::blockchain {
+  class StoredChain;
 
   class AnchorStateImpl final : public AnchorState, Singleton<AnchorState> {
    public:
@@ -31,7 +32,8 @@ namespace lean::blockchain {
 
     AnchorStateImpl(qtils::SharedRef<log::LoggingSystem> logsys,
                     qtils::SharedRef<const app::Configuration> app_config,
-                    qtils::SharedRef<app::StateManager> app_state_mngr);
+                    qtils::SharedRef<app::StateManager> app_state_mngr,
+                    std::shared_ptr<StoredChain> stored_chain);
   };
 
 }  // namespace lean::blockchain
@@ -33,6 +33,8 @@ OUTCOME_CPP_DEFINE_CATEGORY(lean::blockchain, BlockStorageError, e) {
       return "Block tree leaves not found";
     case E::JUSTIFICATION_EMPTY:
       return "Justification empty";
+    case E::STATE_NOT_FOUND:
+      return "State not found";
   }
   return "Unknown error";
 }
@@ -6,25 +6,54 @@
 
 #include "blockchain/impl/block_storage_impl.hpp"
 
+#include <map>
+#include <ranges>
+
 #include <qtils/cxx23/ranges/contains.hpp>
 
 #include "blockchain/block_storage_error.hpp"
+#include "blockchain/impl/state_diff.hpp"
+#include "blockchain/impl/state_snapshot.hpp"
 #include "blockchain/impl/storage_util.hpp"
+#include "blockchain/state_root.hpp"
+#include "metrics/metrics.hpp"
+#include "serde/parallel_hash.hpp"
 #include "sszpp/ssz++.hpp"
 #include "storage/predefined_keys.hpp"
 #include "types/block_data.hpp"
+#include "types/fork_choice_snapshot.hpp"
 #include "types/state.hpp"
+#include "types/state_view.hpp"
+#include "utils/worker_pool.hpp"
 
 namespace lean::blockchain {
 
+  namespace {
+    /// Decode signature or body stored by `BlockValueCodec`
+    template <typename T>
+    outcome::result<T> decodeValue(qtils::BytesIn stored) {
+      qtils::ByteVec buffer;
+      OUTCOME_TRY(encoded, BlockValueCodec::decode(stored, buffer));
+      return decode<T>(encoded);
+    }
+  }  // namespace
+
   BlockStorageImpl::BlockStorageImpl(
       qtils::SharedRef<log::LoggingSystem> logsys,
       qtils::SharedRef<storage::SpacedStorage> storage,
       qtils::SharedRef<crypto::Hasher> hasher,
+      std::shared_ptr<storage::AncientStore> ancient,
+      std::shared_ptr<BlockValueCodec> codec,
+      std::shared_ptr<metrics::Metrics> metrics,
+      std::shared_ptr<WorkerPool> worker_pool,
       std::shared_ptr<BlockStorageInitializer>)
       : logger_(logsys->getLogger("BlockStorage", "block_storage")),
         storage_(std::move(storage)),
-        hasher_(std::move(hasher)) {}
+        hasher_(std::move(hasher)),
+        ancient_(std::move(ancient)),
+        codec_(std::move(codec)),
+        metrics_(std::move(metrics)),
+        worker_pool_(std::move(worker_pool)) {}
 
   outcome::result<std::vector<BlockHash>> BlockStorageImpl::getBlockTreeLeaves()
       const {
@@ -97,6 +126,69 @@ namespace lean::blockchain {
     return outcome::success();
   }
 
+  outcome::result<void> BlockStorageImpl::applyTreeChanges(
+      std::vector<BlockHash> leaves,
+      std::span<const BlockIndex> revert,
+      std::span<const BlockIndex> apply) {
+    std::ranges::sort(leaves);
+    auto leaves_changed = not block_tree_leaves_.has_value()
+                       or block_tree_leaves_.value() != leaves;
+    if (not leaves_changed and revert.empty() and apply.empty()) {
+      return outcome::success();
+    }
+
+    auto batch = storage_->createBatch();
+    if (leaves_changed) {
+      OUTCOME_TRY(encoded_leaves, encode(leaves));
+      OUTCOME_TRY(batch->put(storage::Space::Default,
+                             storage::kBlockTreeLeavesLookupKey,
+                             qtils::ByteVec{std::move(encoded_leaves)}));
+    }
+
+    // Hashes of changed slots, reorg may revert and apply same slot
+    std::map<Slot, std::vector<BlockHash>> slots;
+    auto slot_hashes =
+        [&](Slot slot) -> outcome::result<std::vector<BlockHash> *> {
+      auto it = slots.find(slot);
+      if (it == slots.end()) {
+        OUTCOME_TRY(hashes, getBlockHash(slot));
+        it = slots.emplace(slot, std::move(hashes)).first;
+      }
+      return &it->second;
+    };
+    for (auto &block : revert) {
+      OUTCOME_TRY(hashes, slot_hashes(block.slot));
+      std::erase(*hashes, block.hash);
+    }
+    for (auto &block : apply) {
+      OUTCOME_TRY(hashes, slot_hashes(block.slot));
+      if (not qtils::cxx23::ranges::contains(*hashes, block.hash)) {
+        hashes->emplace_back(block.hash);
+      }
+    }
+    for (auto &[slot, hashes] : slots) {
+      auto key = slotToHashLookupKey(slot);
+      if (hashes.empty()) {
+        OUTCOME_TRY(batch->remove(storage::Space::SlotToHashes, key));
+      } else {
+        OUTCOME_TRY(encoded_hashes, encode(hashes));
+        OUTCOME_TRY(batch->put(storage::Space::SlotToHashes,
+                               key,
+                               qtils::ByteVec{std::move(encoded_hashes)}));
+      }
+    }
+    OUTCOME_TRY(batch->commit());
+
+    if (leaves_changed) {
+      block_tree_leaves_.emplace(std::move(leaves));
+    }
+    SL_DEBUG(logger_,
+             "Applied block tree changes: {} reverted, {} applied",
+             revert.size(),
+             apply.size());
+    return outcome::success();
+  }
+
   outcome::result<std::vector<BlockHash>> BlockStorageImpl::getBlockHash(
       Slot slot) const {
     auto storage = storage_->getSpace(storage::Space::SlotToHashes);
@@ -115,6 +207,13 @@ namespace lean::blockchain {
 
   outcome::result<bool> BlockStorageImpl::hasBlockHeader(
       const BlockHash &block_hash) const {
+    if (isMarkedRemoved(block_hash)) {
+      return false;
+    }
+    if (auto filter = headerFilter();
+        filter != nullptr and not filter->bloom.mayContain(block_hash)) {
+      return false;
+    }
     return hasInSpace(*storage_, storage::Space::Header, block_hash);
   }
 
@@ -127,12 +226,87 @@ namespace lean::blockchain {
                            storage::Space::Header,
                            block_hash,
                            std::move(encoded_header)));
+    insertIntoHeaderFilter(block_hash);
     return block_hash;
   }
 
+  void BlockStorageImpl::insertIntoHeaderFilter(const BlockHash &block_hash) {
+    // Loaded before current one, which replaces it before it is reset
+    auto building = building_header_filter_.load();
+    auto filter = header_filter_.load();
+    if (filter != nullptr) {
+      filter->bloom.insert(block_hash);
+      filter->count.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Not counted, scan may count it too
+    if (building != nullptr and building != filter) {
+      building->bloom.insert(block_hash);
+    }
+  }
+
+  std::shared_ptr<BlockStorageImpl::HeaderFilter>
+  BlockStorageImpl::headerFilter() const {
+    auto filter = header_filter_.load();
+    if (filter != nullptr
+        and filter->count.load(std::memory_order_relaxed)
+                <= filter->capacity) {
+      return filter;
+    }
+    // Full filter has more false positives, but is still used until
+    // replaced
+    if (not header_filter_requested_.exchange(true)) {
+      auto build = [weak_self{weak_from_this()}] {
+        if (auto self = weak_self.lock()) {
+          self->buildHeaderFilter();
+        }
+      };
+      if (worker_pool_ != nullptr) {
+        worker_pool_->post(std::move(build));
+      } else {
+        build();
+      }
+    }
+    return header_filter_.load();
+  }
+
+  void BlockStorageImpl::buildHeaderFilter() const {
+    auto filter = header_filter_.load();
+    auto count = filter ? filter->count.load(std::memory_order_relaxed) : 0;
+    constexpr size_t kMinCapacity = 1 << 16;
+    auto capacity = std::max(kMinCapacity, 2 * count);
+    auto new_filter = std::make_shared<HeaderFilter>(capacity);
+    // Published before scan, so headers put meanwhile are inserted
+    building_header_filter_.store(new_filter);
+    size_t scanned = 0;
+    auto cursor = storage_->getSpace(storage::Space::Header)->cursor();
+    auto res = [&]() -> outcome::result<void> {
+      OUTCOME_TRY(cursor->seekFirst());
+      while (cursor->isValid()) {
+        new_filter->bloom.insert(cursor->key().value());
+        ++scanned;
+        OUTCOME_TRY(cursor->next());
+      }
+      return outcome::success();
+    }();
+    if (res.has_error()) {
+      SL_WARN(logger_, "Can't build filter of headers: {}", res.error());
+      building_header_filter_.store(nullptr);
+      header_filter_requested_.store(false);
+      return;
+    }
+    new_filter->count.fetch_add(scanned, std::memory_order_relaxed);
+    header_filter_.store(new_filter);
+    building_header_filter_.store(nullptr);
+    header_filter_requested_.store(false);
+    SL_DEBUG(logger_,
+             "Built filter of {} headers, {} bytes",
+             scanned,
+             new_filter->bloom.byteSize());
+  }
+
   outcome::result<BlockHeader> BlockStorageImpl::getBlockHeader(
       const BlockHash &block_hash) const {
-    OUTCOME_TRY(header_opt, fetchBlockHeader(block_hash));
+    OUTCOME_TRY(header_opt, tryGetBlockHeader(block_hash));
     if (header_opt.has_value()) {
       return header_opt.value();
     }
@@ -141,24 +315,78 @@ namespace lean::blockchain {
 
   outcome::result<std::optional<BlockHeader>>
   BlockStorageImpl::tryGetBlockHeader(const BlockHash &block_hash) const {
+    if (isMarkedRemoved(block_hash)) {
+      return std::nullopt;
+    }
     return fetchBlockHeader(block_hash);
   }
 
+  outcome::result<std::vector<BlockHeader>>
+  BlockStorageImpl::getBlockHeadersFromSlot(Slot min_slot) const {
+    std::vector<BlockHeader> headers;
+    std::vector<BlockHash> hashes;
+    auto cursor = storage_->getSpace(storage::Space::Header)->cursor();
+    OUTCOME_TRY(cursor->seekFirst());
+    while (cursor->isValid()) {
+      OUTCOME_TRY(header, decode<BlockHeader>(cursor->value().value()));
+      if (header.slot >= min_slot) {
+        OUTCOME_TRY(hash, BlockHash::fromSpan(cursor->key().value()));
+        headers.emplace_back(std::move(header));
+        hashes.emplace_back(hash);
+      }
+      OUTCOME_TRY(cursor->next());
+    }
+
+    // Hashing dominates decoding of small fixed-size headers
+    std::vector<uint8_t> valid(headers.size());
+    parallelHash(headers.size(), [&](size_t i) {
+      headers[i].updateHash();
+      valid[i] = headers[i].hash() == hashes[i];
+    });
+    for (size_t i = 0; i < headers.size(); ++i) {
+      if (not valid[i]) {
+        SL_ERROR(logger_, "Header stored by wrong hash {:xx}", hashes[i]);
+        return BlockStorageError::INCONSISTENT_DATA;
+      }
+    }
+    SL_DEBUG(logger_,
+             "Loaded {} headers from slot {}",
+             headers.size(),
+             min_slot);
+    return headers;
+  }
+
   outcome::result<void> BlockStorageImpl::putBlockBody(
       const BlockHash &block_hash, const BlockBody &block_body) {
     OUTCOME_TRY(encoded_body, encode(block_body));
-    return putToSpace(
-        *storage_, storage::Space::Body, block_hash, std::move(encoded_body));
+    return putToSpace(*storage_,
+                      storage::Space::Body,
+                      block_hash,
+                      encodeValue(std::move(encoded_body)));
   }
 
   outcome::result<std::optional<BlockBody>> BlockStorageImpl::getBlockBody(
       const BlockHash &block_hash) const {
-    OUTCOME_TRY(encoded_block_body_opt,
-                getFromSpace(*storage_, storage::Space::Body, block_hash));
-    if (encoded_block_body_opt.has_value()) {
-      OUTCOME_TRY(block_body,
-                  decode<BlockBody>(encoded_block_body_opt.value()));
-      return std::make_optional(std::move(block_body));
+    std::optional<BlockBody> block_body;
+    auto read = [&](qtils::BytesIn encoded) -> outcome::result<void> {
+      OUTCOME_TRY(body, decodeValue<BlockBody>(encoded));
+      block_body.emplace(std::move(body));
+      return outcome::success();
+    };
+    OUTCOME_TRY(
+        found,
+        readFromSpace(*storage_, storage::Space::Body, block_hash, read));
+    if (found) {
+      return block_body;
+    }
+    if (ancient_) {
+      OUTCOME_TRY(header_opt, fetchBlockHeader(block_hash));
+      if (header_opt.has_value()) {
+        OUTCOME_TRY(block_opt, fetchAncientBlock(header_opt.value()));
+        if (block_opt.has_value()) {
+          return std::make_optional(std::move(block_opt->block.body));
+        }
+      }
     }
     return std::nullopt;
   }
@@ -171,50 +399,293 @@ namespace lean::blockchain {
 
   outcome::result<void> BlockStorageImpl::putState(const BlockHash &block_hash,
                                                    const State &state) {
-    OUTCOME_TRY(encoded_state, encode(state));
-    return putToSpace(
-        *storage_, storage::Space::State, block_hash, std::move(encoded_state));
+    // Post-state of block references parent block in its latest header
+    auto &parent_hash = state.latest_block_header.parent_root;
+    OUTCOME_TRY(parent, loadState(parent_hash));
+
+    auto snapshot = parent == nullptr
+                 or state.slot % kStateSnapshotInterval == 0
+                 or parent->depth + 1 >= kStateSnapshotInterval
+                 or state.latest_finalized != parent->state.latest_finalized;
+    if (snapshot) {
+      OUTCOME_TRY(putStateSnapshot(block_hash, state));
+      states_.put(block_hash, StoredState{.state = state, .depth = 0});
+      return outcome::success();
+    }
+
+    auto depth = parent->depth + 1;
+    auto diff = makeStateDiff(parent_hash, depth, parent->state, state);
+    OUTCOME_TRY(encoded_diff, encode(diff));
+    SL_TRACE(logger_,
+             "Store state diff of block {:xx}, depth {}, {} bytes",
+             block_hash,
+             depth,
+             encoded_diff.size());
+    OUTCOME_TRY(putToSpace(*storage_,
+                           storage::Space::StateDiff,
+                           block_hash,
+                           std::move(encoded_diff)));
+    states_.put(block_hash, StoredState{.state = state, .depth = depth});
+    return outcome::success();
   }
 
   outcome::result<std::optional<State>> BlockStorageImpl::getState(
       const BlockHash &block_hash) const {
+    OUTCOME_TRY(stored, loadState(block_hash));
+    if (stored != nullptr) {
+      return std::make_optional(stored->state);
+    }
+    return std::nullopt;
+  }
+
+  outcome::result<std::optional<StateCheckpoints>>
+  BlockStorageImpl::getStateCheckpoints(const BlockHash &block_hash) const {
+    if (auto cached = cachedState(block_hash)) {
+      const auto &state = cached.value()->state;
+      return StateCheckpoints{
+          .justified = state.latest_justified,
+          .finalized = state.latest_finalized,
+      };
+    }
     OUTCOME_TRY(encoded_state_opt,
                 getFromSpace(*storage_, storage::Space::State, block_hash));
     if (encoded_state_opt.has_value()) {
-      OUTCOME_TRY(state, decode<State>(encoded_state_opt.value()));
-      return std::make_optional(std::move(state));
+      auto &encoded_state = encoded_state_opt.value();
+      if (auto checkpoints = stateSnapshotCheckpoints(encoded_state)) {
+        auto &[justified, finalized] = checkpoints.value();
+        return StateCheckpoints{
+            .justified = justified,
+            .finalized = finalized,
+        };
+      }
+      // Full state stored before validators were stored apart
+      OUTCOME_TRY(view, StateView::make(encoded_state));
+      return StateCheckpoints{
+          .justified = view.latestJustified(),
+          .finalized = view.latestFinalized(),
+      };
+    }
+    OUTCOME_TRY(encoded_diff_opt,
+                getFromSpace(*storage_, storage::Space::StateDiff, block_hash));
+    if (encoded_diff_opt.has_value()) {
+      OUTCOME_TRY(checkpoints,
+                  stateDiffCheckpoints(encoded_diff_opt.value()));
+      auto &[justified, finalized] = checkpoints;
+      return StateCheckpoints{
+          .justified = justified,
+          .finalized = finalized,
+      };
     }
     return std::nullopt;
   }
 
   outcome::result<void> BlockStorageImpl::removeState(
       const BlockHash &block_hash) {
-    auto space = storage_->getSpace(storage::Space::State);
+    states_.erase(block_hash);
+    OUTCOME_TRY(storage_->getSpace(storage::Space::State)->remove(block_hash));
+    auto space = storage_->getSpace(storage::Space::StateDiff);
     return space->remove(block_hash);
   }
 
+  outcome::result<void> BlockStorageImpl::rebaseState(
+      const BlockHash &block_hash) {
+    OUTCOME_TRY(encoded_diff_opt,
+                getFromSpace(*storage_, storage::Space::StateDiff, block_hash));
+    if (not encoded_diff_opt.has_value()) {
+      // Already snapshot, or no state at all
+      return outcome::success();
+    }
+    OUTCOME_TRY(stored, loadState(block_hash));
+    if (stored == nullptr) {
+      return BlockStorageError::STATE_NOT_FOUND;
+    }
+    // Copy, so merkle cache of shared state is not touched
+    auto state = stored->state;
+    OUTCOME_TRY(putStateSnapshot(block_hash, state));
+    OUTCOME_TRY(
+        removeFromSpace(*storage_, storage::Space::StateDiff, block_hash));
+    states_.put(block_hash, StoredState{.state = stored->state, .depth = 0});
+    SL_TRACE(logger_, "State of block {:xx} is rebased", block_hash);
+    return outcome::success();
+  }
+
+  outcome::result<void> BlockStorageImpl::putForkChoiceSnapshot(
+      const ForkChoiceSnapshot &snapshot) {
+    auto space = storage_->getSpace(storage::Space::ForkChoice);
+    OUTCOME_TRY(encoded_snapshot, encode(snapshot));
+    return space->put(storage::kForkChoiceSnapshotLookupKey,
+                      std::move(encoded_snapshot));
+  }
+
+  outcome::result<std::optional<ForkChoiceSnapshot>>
+  BlockStorageImpl::getForkChoiceSnapshot() const {
+    auto space = storage_->getSpace(storage::Space::ForkChoice);
+    OUTCOME_TRY(encoded_opt,
+                space->tryGet(storage::kForkChoiceSnapshotLookupKey));
+    if (not encoded_opt.has_value()) {
+      return std::nullopt;
+    }
+    OUTCOME_TRY(snapshot, decode<ForkChoiceSnapshot>(encoded_opt.value()));
+    return snapshot;
+  }
+
+  outcome::result<std::shared_ptr<const BlockStorageImpl::StoredState>>
+  BlockStorageImpl::loadState(const BlockHash &block_hash) const {
+    // Collect diffs down to cached state or full snapshot
+    std::vector<StateDiff> diffs;
+    std::shared_ptr<const StoredState> base;
+    auto hash = block_hash;
+    while (true) {
+      if (auto cached = cachedState(hash)) {
+        base = std::move(cached.value());
+        break;
+      }
+      OUTCOME_TRY(encoded_state_opt,
+                  getFromSpace(*storage_, storage::Space::State, hash));
+      if (encoded_state_opt.has_value()) {
+        OUTCOME_TRY(state, decodeStateSnapshot(encoded_state_opt.value()));
+        base = std::make_shared<const StoredState>(
+            StoredState{.state = std::move(state), .depth = 0});
+        break;
+      }
+      OUTCOME_TRY(encoded_diff_opt,
+                  getFromSpace(*storage_, storage::Space::StateDiff, hash));
+      if (not encoded_diff_opt.has_value()) {
+        if (not diffs.empty()) {
+          SL_WARN(logger_,
+                  "State of block {:xx} is missing, "
+                  "can't rebuild state of block {:xx}",
+                  hash,
+                  block_hash);
+        }
+        return nullptr;
+      }
+      OUTCOME_TRY(diff, decode<StateDiff>(encoded_diff_opt.value()));
+      hash = diff.parent;
+      diffs.emplace_back(std::move(diff));
+    }
+
+    if (diffs.empty()) {
+      return base;
+    }
+    auto state = base->state;
+    for (auto &diff : diffs | std::views::reverse) {
+      OUTCOME_TRY(next, applyStateDiff(state, diff));
+      state = std::move(next);
+    }
+    return states_.put(
+        block_hash,
+        StoredState{.state = std::move(state), .depth = diffs.front().depth});
+  }
+
+  std::optional<std::shared_ptr<const BlockStorageImpl::StoredState>>
+  BlockStorageImpl::cachedState(const BlockHash &block_hash) const {
+    auto cached = states_.get(block_hash);
+    if (metrics_ == nullptr) {
+      return cached;
+    }
+    auto stats = states_.stats();
+    std::lock_guard lock{states_reported_mutex_};
+    auto report = [&](const char *result, uint64_t total, uint64_t &reported) {
+      if (total > reported) {
+        metrics_->block_storage_state_cache_total({{"result", result}})
+            ->inc(static_cast<double>(total - reported));
+        reported = total;
+      }
+    };
+    report("hit", stats.hits, states_reported_.hits);
+    report("miss", stats.misses, states_reported_.misses);
+    report("rejected", stats.rejected, states_reported_.rejected);
+    return cached;
+  }
+
+  outcome::result<void> BlockStorageImpl::putStateSnapshot(
+      const BlockHash &block_hash, const State &state) {
+    auto validators_root = validatorsRoot(state);
+    OUTCOME_TRY(
+        has_validators,
+        hasInSpace(*storage_, storage::Space::Subtree, validators_root));
+    if (not has_validators) {
+      OUTCOME_TRY(encoded_validators, encode(state.validators));
+      SL_DEBUG(logger_,
+               "Store validators {:xx}, {} bytes",
+               validators_root,
+               encoded_validators.size());
+      OUTCOME_TRY(putToSpace(*storage_,
+                             storage::Space::Subtree,
+                             validators_root,
+                             std::move(encoded_validators)));
+    }
+    OUTCOME_TRY(encoded_snapshot,
+                encode(makeStateSnapshot(state, validators_root)));
+    return putToSpace(*storage_,
+                      storage::Space::State,
+                      block_hash,
+                      std::move(encoded_snapshot));
+  }
+
+  outcome::result<State> BlockStorageImpl::decodeStateSnapshot(
+      qtils::BytesIn encoded) const {
+    // Offsets of full state stored before validators were stored apart
+    // don't match layout of snapshot
+    if (not stateSnapshotCheckpoints(encoded).has_value()) {
+      return decode<State>(encoded);
+    }
+    OUTCOME_TRY(snapshot, decode<StateSnapshot>(encoded));
+    OUTCOME_TRY(validators, loadValidators(snapshot.validators_root));
+    return stateFromSnapshot(snapshot, validators);
+  }
+
+  outcome::result<ValidatorList> BlockStorageImpl::loadValidators(
+      const BlockHash &root) const {
+    {
+      std::lock_guard lock{validators_mutex_};
+      if (validators_.has_value() and validators_->first == root) {
+        return validators_->second;
+      }
+    }
+    OUTCOME_TRY(encoded_opt,
+                getFromSpace(*storage_, storage::Space::Subtree, root));
+    if (not encoded_opt.has_value()) {
+      SL_WARN(logger_, "Validators {:xx} of stored state are missing", root);
+      return BlockStorageError::STATE_NOT_FOUND;
+    }
+    OUTCOME_TRY(validators, decode<ValidatorList>(encoded_opt.value()));
+    std::lock_guard lock{validators_mutex_};
+    validators_.emplace(root, validators);
+    return validators;
+  }
+
   outcome::result<BlockHash> BlockStorageImpl::putBlock(
       const BlockData &block) {
     auto adding_res = [&]() -> outcome::result<BlockHash> {
-      // insert provided block's parts into the database
-      OUTCOME_TRY(block_hash, putBlockHeader(*block.header));
+      // insert provided block's parts into the database, in one batch, so
+      // they are committed together
+      auto batch = storage_->createBatch();
+      auto &header = *block.header;
+      OUTCOME_TRY(encoded_header, encode(header));
+      header.updateHash();
+      auto block_hash = header.hash();
+      OUTCOME_TRY(batch->put(storage::Space::Header,
+                             block_hash,
+                             qtils::ByteVec{std::move(encoded_header)}));
 
       if (block.signature.has_value()) {
         OUTCOME_TRY(encoded_attestation, encode(*block.signature));
-        OUTCOME_TRY(putToSpace(*storage_,
-                               storage::Space::Signature,
+        OUTCOME_TRY(batch->put(storage::Space::Signature,
                                block_hash,
-                               std::move(encoded_attestation)));
+                               encodeValue(std::move(encoded_attestation))));
       }
 
       if (block.body.has_value()) {
         OUTCOME_TRY(encoded_body, encode(*block.body));
-        OUTCOME_TRY(putToSpace(*storage_,
-                               storage::Space::Body,
+        OUTCOME_TRY(batch->put(storage::Space::Body,
                                block_hash,
-                               std::move(encoded_body)));
+                               encodeValue(std::move(encoded_body))));
       }
 
+      OUTCOME_TRY(batch->commit());
+      insertIntoHeaderFilter(block_hash);
       return block_hash;
     }();
 
@@ -241,29 +712,57 @@ namespace lean::blockchain {
       data.header.emplace(header);
     }
 
+    // Signature and body of finalized block may be moved to ancient store
+    std::optional<std::optional<SignedBlock>> ancient_block;
+    auto from_ancient =
+        [&]() -> outcome::result<std::optional<SignedBlock> *> {
+      if (not ancient_) {
+        return nullptr;
+      }
+      if (not ancient_block.has_value()) {
+        OUTCOME_TRY(header, getBlockHeader(block_hash));
+        OUTCOME_TRY(block_opt, fetchAncientBlock(header));
+        ancient_block.emplace(std::move(block_opt));
+      }
+      return &ancient_block.value();
+    };
+
     // Block signature
     if (parts & BlockParts::SIGNATURES) {
-      OUTCOME_TRY(
-          encoded_signature_opt,
-          getFromSpace(*storage_, storage::Space::Signature, block_hash));
-      if (encoded_signature_opt.has_value()) {
-        OUTCOME_TRY(signature,
-                    decode<BlockSignatures>(encoded_signature_opt.value()));
+      auto read = [&](qtils::BytesIn encoded) -> outcome::result<void> {
+        OUTCOME_TRY(signature, decodeValue<BlockSignatures>(encoded));
         data.signature.emplace(std::move(signature));
-      } else {
-        return BlockStorageError::SIGNATURE_NOT_FOUND;
+        return outcome::success();
+      };
+      OUTCOME_TRY(
+          found,
+          readFromSpace(
+              *storage_, storage::Space::Signature, block_hash, read));
+      if (not found) {
+        OUTCOME_TRY(block_opt, from_ancient());
+        if (block_opt == nullptr or not block_opt->has_value()) {
+          return BlockStorageError::SIGNATURE_NOT_FOUND;
+        }
+        data.signature.emplace((*block_opt)->signature);
       }
     }
 
     // Block body
     if (parts & BlockParts::BODY) {
-      OUTCOME_TRY(encoded_body_opt,
-                  getFromSpace(*storage_, storage::Space::Body, block_hash));
-      if (encoded_body_opt.has_value()) {
-        OUTCOME_TRY(body, decode<BlockBody>(encoded_body_opt.value()));
+      auto read = [&](qtils::BytesIn encoded) -> outcome::result<void> {
+        OUTCOME_TRY(body, decodeValue<BlockBody>(encoded));
         data.body.emplace(std::move(body));
-      } else {
-        return BlockStorageError::BODY_NOT_FOUND;
+        return outcome::success();
+      };
+      OUTCOME_TRY(
+          found,
+          readFromSpace(*storage_, storage::Space::Body, block_hash, read));
+      if (not found) {
+        OUTCOME_TRY(block_opt, from_ancient());
+        if (block_opt == nullptr or not block_opt->has_value()) {
+          return BlockStorageError::BODY_NOT_FOUND;
+        }
+        data.body.emplace(std::move((*block_opt)->block.body));
       }
     }
 
@@ -291,11 +790,202 @@ namespace lean::blockchain {
     return block;
   }
 
+  outcome::result<std::vector<std::optional<SignedBlock>>>
+  BlockStorageImpl::tryGetSignedBlocks(
+      std::span<const BlockHash> block_hashes) const {
+    std::vector<qtils::ByteView> keys{block_hashes.begin(),
+                                      block_hashes.end()};
+    OUTCOME_TRY(
+        encoded_headers,
+        storage_->getSpace(storage::Space::Header)->tryGetMany(keys));
+    OUTCOME_TRY(
+        encoded_signatures,
+        storage_->getSpace(storage::Space::Signature)->tryGetMany(keys));
+    OUTCOME_TRY(encoded_bodies,
+                storage_->getSpace(storage::Space::Body)->tryGetMany(keys));
+
+    std::vector<std::optional<SignedBlock>> blocks;
+    blocks.reserve(block_hashes.size());
+    // Blocks moved to ancient store, read at once
+    std::vector<size_t> ancient_indices;
+    std::vector<BlockHeader> ancient_headers;
+    for (size_t i = 0; i < block_hashes.size(); ++i) {
+      auto &block = blocks.emplace_back();
+      if (not encoded_headers[i].has_value()
+          or isMarkedRemoved(block_hashes[i])) {
+        continue;
+      }
+      OUTCOME_TRY(header, decode<BlockHeader>(encoded_headers[i].value()));
+      if (not encoded_signatures[i].has_value()
+          or not encoded_bodies[i].has_value()) {
+        if (not ancient_) {
+          return encoded_signatures[i].has_value()
+                   ? BlockStorageError::BODY_NOT_FOUND
+                   : BlockStorageError::SIGNATURE_NOT_FOUND;
+        }
+        ancient_indices.emplace_back(i);
+        ancient_headers.emplace_back(header);
+        continue;
+      }
+      OUTCOME_TRY(signature,
+                  decodeValue<BlockSignatures>(encoded_signatures[i].value()));
+      OUTCOME_TRY(body, decodeValue<BlockBody>(encoded_bodies[i].value()));
+      auto &signed_block = block.emplace();
+      signed_block.block.parent_root = header.parent_root;
+      signed_block.block.slot = header.slot;
+      signed_block.block.proposer_index = header.proposer_index;
+      signed_block.block.state_root = header.state_root;
+      signed_block.signature = std::move(signature);
+      signed_block.block.body = std::move(body);
+    }
+    if (not ancient_headers.empty()) {
+      OUTCOME_TRY(ancient_blocks, fetchAncientBlocks(ancient_headers));
+      for (size_t j = 0; j < ancient_indices.size(); ++j) {
+        if (not ancient_blocks[j].has_value()) {
+          return BlockStorageError::BODY_NOT_FOUND;
+        }
+        blocks[ancient_indices[j]] = std::move(ancient_blocks[j]);
+      }
+    }
+    return blocks;
+  }
+
+  outcome::result<void> BlockStorageImpl::moveToAncient(
+      std::span<const BlockIndex> blocks) {
+    if (not ancient_) {
+      return outcome::success();
+    }
+    std::vector<BlockIndex> moved;
+    for (auto &block : blocks) {
+      if (block.slot < ancient_->endKey()) {
+        continue;
+      }
+      OUTCOME_TRY(signed_block, getSignedBlock(block.hash));
+      OUTCOME_TRY(encoded, encode(signed_block));
+      OUTCOME_TRY(ancient_->append(block.slot, encoded));
+      moved.emplace_back(block);
+    }
+    if (moved.empty()) {
+      return outcome::success();
+    }
+
+    // Blocks are removed from database only after they are on disk
+    OUTCOME_TRY(ancient_->sync());
+    auto batch = storage_->createBatch();
+    for (auto &block : moved) {
+      OUTCOME_TRY(batch->remove(storage::Space::Signature, block.hash));
+      OUTCOME_TRY(batch->remove(storage::Space::Body, block.hash));
+    }
+    OUTCOME_TRY(batch->commit());
+    SL_DEBUG(logger_,
+             "Moved {} finalized blocks to ancient store, up to {}",
+             moved.size(),
+             moved.back());
+    return outcome::success();
+  }
+
+  outcome::result<std::optional<BackfillCursor>>
+  BlockStorageImpl::getBackfillCursor() const {
+    auto space = storage_->getSpace(storage::Space::Default);
+    OUTCOME_TRY(encoded_opt, space->tryGet(storage::kBackfillCursorLookupKey));
+    if (not encoded_opt.has_value()) {
+      return std::nullopt;
+    }
+    OUTCOME_TRY(cursor, decode<BackfillCursor>(encoded_opt.value()));
+    return cursor;
+  }
+
+  outcome::result<void> BlockStorageImpl::putBackfilledBlocks(
+      std::span<const SignedBlock> blocks,
+      const std::optional<BackfillCursor> &cursor) {
+    auto batch = storage_->createBatch();
+    for (auto &signed_block : blocks) {
+      auto header = signed_block.block.getHeader();
+      OUTCOME_TRY(encoded_header, encode(header));
+      header.updateHash();
+      auto &block_hash = header.hash();
+      OUTCOME_TRY(batch->put(storage::Space::Header,
+                             block_hash,
+                             qtils::ByteVec{std::move(encoded_header)}));
+      OUTCOME_TRY(encoded_signature, encode(signed_block.signature));
+      OUTCOME_TRY(batch->put(storage::Space::Signature,
+                             block_hash,
+                             encodeValue(std::move(encoded_signature))));
+      OUTCOME_TRY(encoded_body, encode(signed_block.block.body));
+      OUTCOME_TRY(batch->put(storage::Space::Body,
+                             block_hash,
+                             encodeValue(std::move(encoded_body))));
+      // Finalized slot has single block
+      OUTCOME_TRY(encoded_hashes, encode(std::vector{block_hash}));
+      OUTCOME_TRY(batch->put(storage::Space::SlotToHashes,
+                             slotToHashLookupKey(header.slot),
+                             qtils::ByteVec{std::move(encoded_hashes)}));
+    }
+    if (cursor.has_value()) {
+      OUTCOME_TRY(encoded_cursor, encode(cursor.value()));
+      OUTCOME_TRY(batch->put(storage::Space::Default,
+                             storage::kBackfillCursorLookupKey,
+                             qtils::ByteVec{std::move(encoded_cursor)}));
+    } else {
+      OUTCOME_TRY(batch->remove(storage::Space::Default,
+                                storage::kBackfillCursorLookupKey));
+    }
+    OUTCOME_TRY(batch->commit());
+    // After write, as in `putBlockHeader`
+    for (auto &signed_block : blocks) {
+      insertIntoHeaderFilter(signed_block.block.hash());
+    }
+    if (not blocks.empty()) {
+      SL_DEBUG(logger_,
+               "Backfilled {} blocks of history, down to {}",
+               blocks.size(),
+               blocks.back().block.index());
+    }
+    return outcome::success();
+  }
+
+  outcome::result<std::vector<std::optional<SignedBlock>>>
+  BlockStorageImpl::fetchAncientBlocks(
+      std::span<const BlockHeader> headers) const {
+    std::vector<std::optional<SignedBlock>> blocks(headers.size());
+    if (not ancient_) {
+      return blocks;
+    }
+    std::vector<uint64_t> slots;
+    slots.reserve(headers.size());
+    for (auto &header : headers) {
+      slots.emplace_back(header.slot);
+    }
+    OUTCOME_TRY(encoded_blocks, ancient_->getMany(slots));
+    for (size_t i = 0; i < headers.size(); ++i) {
+      if (not encoded_blocks[i].has_value()) {
+        continue;
+      }
+      OUTCOME_TRY(block, decode<SignedBlock>(encoded_blocks[i].value()));
+      // Only canonical block of slot is there, state root tells it apart
+      auto &header = headers[i];
+      if (block.block.parent_root != header.parent_root
+          or block.block.state_root != header.state_root
+          or block.block.proposer_index != header.proposer_index) {
+        continue;
+      }
+      blocks[i].emplace(std::move(block));
+    }
+    return blocks;
+  }
+
+  outcome::result<std::optional<SignedBlock>>
+  BlockStorageImpl::fetchAncientBlock(const BlockHeader &header) const {
+    OUTCOME_TRY(blocks, fetchAncientBlocks(std::span{&header, 1}));
+    return std::move(blocks.front());
+  }
+
   outcome::result<void> BlockStorageImpl::removeBlock(
       const BlockHash &block_hash) {
     // Check if block still in storage
     OUTCOME_TRY(header_opt, fetchBlockHeader(block_hash));
     if (not header_opt) {
+      unmarkRemoved(block_hash);
       return outcome::success();
     }
     const auto &header = header_opt.value();
@@ -330,16 +1020,13 @@ namespace lean::blockchain {
       return res;
     }
 
-    {
-      // Remove the state block
-      auto storage_space = storage_->getSpace(storage::Space::State);
-      if (auto res = storage_space->remove(block_index.hash); res.has_error()) {
-        SL_ERROR(logger_,
-                 "Couldn't remove state of block {} from the storage: {}",
-                 block_index,
-                 res.error());
-        return res;
-      }
+    // Remove the state block
+    if (auto res = removeState(block_index.hash); res.has_error()) {
+      SL_ERROR(logger_,
+               "Couldn't remove state of block {} from the storage: {}",
+               block_index,
+               res.error());
+      return res;
     }
 
     {  // Remove the signatures block
@@ -375,22 +1062,95 @@ namespace lean::blockchain {
       }
     }
 
+    unmarkRemoved(block_hash);
     logger_->info("Removed block {}", block_index);
 
     return outcome::success();
   }
 
+  void BlockStorageImpl::markRemoved(std::span<const BlockIndex> blocks) {
+    if (blocks.empty()) {
+      return;
+    }
+    std::lock_guard lock{removed_mutex_};
+    for (auto &block : blocks) {
+      removed_.emplace(block.hash);
+    }
+    removed_count_.store(removed_.size(), std::memory_order_release);
+    storeMarkedRemoved();
+  }
+
+  outcome::result<std::vector<BlockHash>>
+  BlockStorageImpl::restoreMarkedRemoved() {
+    auto default_space = storage_->getSpace(storage::Space::Default);
+    OUTCOME_TRY(encoded_opt,
+                default_space->tryGet(storage::kMarkedRemovedLookupKey));
+    if (not encoded_opt.has_value()) {
+      return std::vector<BlockHash>{};
+    }
+    OUTCOME_TRY(hashes, decode<std::vector<BlockHash>>(encoded_opt.value()));
+    std::lock_guard lock{removed_mutex_};
+    removed_.insert(hashes.begin(), hashes.end());
+    removed_count_.store(removed_.size(), std::memory_order_release);
+    return hashes;
+  }
+
+  void BlockStorageImpl::unmarkRemoved(const BlockHash &block_hash) {
+    if (removed_count_.load(std::memory_order_acquire) == 0) {
+      return;
+    }
+    std::lock_guard lock{removed_mutex_};
+    if (removed_.erase(block_hash) == 0) {
+      return;
+    }
+    removed_count_.store(removed_.size(), std::memory_order_release);
+    storeMarkedRemoved();
+  }
+
+  void BlockStorageImpl::storeMarkedRemoved() {
+    auto default_space = storage_->getSpace(storage::Space::Default);
+    outcome::result<void> res = outcome::success();
+    if (removed_.empty()) {
+      res = default_space->remove(storage::kMarkedRemovedLookupKey);
+    } else {
+      auto encoded =
+          encode(std::vector<BlockHash>{removed_.begin(), removed_.end()});
+      res = default_space->put(storage::kMarkedRemovedLookupKey,
+                               qtils::ByteVec{std::move(encoded.value())});
+    }
+    if (res.has_error()) {
+      SL_WARN(logger_, "Can't store blocks marked removed: {}", res.error());
+    }
+  }
+
+  bool BlockStorageImpl::isMarkedRemoved(const BlockHash &block_hash) const {
+    if (removed_count_.load(std::memory_order_acquire) == 0) {
+      return false;
+    }
+    std::lock_guard lock{removed_mutex_};
+    return removed_.contains(block_hash);
+  }
+
+  qtils::ByteVec BlockStorageImpl::encodeValue(qtils::ByteVec encoded) const {
+    if (codec_ == nullptr) {
+      return encoded;
+    }
+    return codec_->encode(std::move(encoded));
+  }
+
   outcome::result<std::optional<BlockHeader>>
   BlockStorageImpl::fetchBlockHeader(const BlockHash &block_hash) const {
-    OUTCOME_TRY(encoded_header_opt,
-                getFromSpace(*storage_, storage::Space::Header, block_hash));
-    if (encoded_header_opt.has_value()) {
-      auto &encoded_header = encoded_header_opt.value();
-      OUTCOME_TRY(header, decode<BlockHeader>(encoded_header));
-      BOOST_ASSERT((header.updateHash(), header.hash() == block_hash));
-      return std::make_optional(header);
-    }
-    return std::nullopt;
+    std::optional<BlockHeader> header;
+    auto read = [&](qtils::BytesIn encoded) -> outcome::result<void> {
+      OUTCOME_TRY(decoded, decode<BlockHeader>(encoded));
+      header.emplace(std::move(decoded));
+      return outcome::success();
+    };
+    OUTCOME_TRY(
+        readFromSpace(*storage_, storage::Space::Header, block_hash, read));
+    BOOST_ASSERT(not header.has_value()
+                 or (header->updateHash(), header->hash() == block_hash));
+    return header;
   }
 
 }  // namespace lean::blockchain
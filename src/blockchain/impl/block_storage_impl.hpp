@@ -6,20 +6,45 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+
 #include "blockchain/block_storage.hpp"
 #include "blockchain/impl/block_storage_initializer.hpp"
+#include "blockchain/impl/block_value_codec.hpp"
+#include "blockchain/impl/state_snapshot.hpp"
 #include "log/logger.hpp"
+#include "storage/ancient_store.hpp"
 #include "storage/spaced_storage.hpp"
+#include "utils/blocked_bloom_filter.hpp"
+#include "utils/tiny_lfu_cache.hpp"
+
+namespace lean {
+  class WorkerPool;
+}  // namespace lean
+
+namespace lean::metrics {
+  class Metrics;
+}  // namespace lean::metrics
 
 namespace lean::blockchain {
 
-  class BlockStorageImpl : public BlockStorage, Singleton<BlockStorage> {
+  class BlockStorageImpl
+      : public BlockStorage,
+        Singleton<BlockStorage>,
+        public std::enable_shared_from_this<BlockStorageImpl> {
    public:
     friend class BlockStorageInitializer;
 
     BlockStorageImpl(qtils::SharedRef<log::LoggingSystem> logsys,
                      qtils::SharedRef<storage::SpacedStorage> storage,
                      qtils::SharedRef<crypto::Hasher> hasher,
+                     std::shared_ptr<storage::AncientStore> ancient,
+                     std::shared_ptr<BlockValueCodec> codec,
+                     std::shared_ptr<metrics::Metrics> metrics,
+                     std::shared_ptr<WorkerPool> worker_pool,
                      std::shared_ptr<BlockStorageInitializer>);
 
     ~BlockStorageImpl() override = default;
@@ -36,6 +61,11 @@ namespace lean::blockchain {
     outcome::result<void> deassignHashToSlot(
         const BlockIndex &block_index) override;
 
+    outcome::result<void> applyTreeChanges(
+        std::vector<BlockHash> leaves,
+        std::span<const BlockIndex> revert,
+        std::span<const BlockIndex> apply) override;
+
     outcome::result<std::vector<BlockHash>> getBlockHash(
         Slot slot) const override;
 
@@ -55,6 +85,9 @@ namespace lean::blockchain {
     outcome::result<std::optional<BlockHeader>> tryGetBlockHeader(
         const BlockHash &block_hash) const override;
 
+    outcome::result<std::vector<BlockHeader>> getBlockHeadersFromSlot(
+        Slot min_slot) const override;
+
     // -- body --
 
     outcome::result<void> putBlockBody(const BlockHash &block_hash,
@@ -73,8 +106,21 @@ namespace lean::blockchain {
     outcome::result<std::optional<State>> getState(
         const BlockHash &block_hash) const override;
 
+    outcome::result<std::optional<StateCheckpoints>> getStateCheckpoints(
+        const BlockHash &block_hash) const override;
+
     outcome::result<void> removeState(const BlockHash &block_hash) override;
 
+    outcome::result<void> rebaseState(const BlockHash &block_hash) override;
+
+    // -- fork choice --
+
+    outcome::result<void> putForkChoiceSnapshot(
+        const ForkChoiceSnapshot &snapshot) override;
+
+    outcome::result<std::optional<ForkChoiceSnapshot>> getForkChoiceSnapshot()
+        const override;
+
     // -- combined
 
     outcome::result<BlockHash> putBlock(const BlockData &block) override;
@@ -84,21 +130,144 @@ namespace lean::blockchain {
 
     outcome::result<void> removeBlock(const BlockHash &block_hash) override;
 
+    outcome::result<void> moveToAncient(
+        std::span<const BlockIndex> blocks) override;
+
+    outcome::result<std::optional<BackfillCursor>> getBackfillCursor()
+        const override;
+
+    outcome::result<void> putBackfilledBlocks(
+        std::span<const SignedBlock> blocks,
+        const std::optional<BackfillCursor> &cursor) override;
+
+    void markRemoved(std::span<const BlockIndex> blocks) override;
+
+    outcome::result<std::vector<BlockHash>> restoreMarkedRemoved() override;
+
     // -- special
 
     outcome::result<SignedBlock> getSignedBlock(
         const BlockHash &block_hash) const override;
 
+    outcome::result<std::vector<std::optional<SignedBlock>>>
+    tryGetSignedBlocks(std::span<const BlockHash> block_hashes) const override;
+
    private:
+    /// Stored value of signature or body, as is without codec
+    qtils::ByteVec encodeValue(qtils::ByteVec encoded) const;
+
+    /// Header of block, even if block is marked removed
     outcome::result<std::optional<BlockHeader>> fetchBlockHeader(
         const BlockHash &block_hash) const;
 
+    /// Filter of stored headers, rebuilt if missing or full
+    struct HeaderFilter {
+      explicit HeaderFilter(size_t capacity)
+          : bloom{capacity}, capacity{capacity} {}
+
+      BlockedBloomFilter bloom;
+      size_t capacity;
+      std::atomic_size_t count = 0;
+    };
+    /**
+     * Filter with all stored headers, or nullptr while first one is built.
+     * Full or missing filter is rebuilt on worker pool, or inline without
+     * pool.
+     */
+    std::shared_ptr<HeaderFilter> headerFilter() const;
+    /// Scan stored headers into new filter, and replace current one
+    void buildHeaderFilter() const;
+    /// After header write, so filter being built either inserts it or reads it
+    void insertIntoHeaderFilter(const BlockHash &block_hash);
+
+    bool isMarkedRemoved(const BlockHash &block_hash) const;
+    void unmarkRemoved(const BlockHash &block_hash);
+    /// Persist `removed_`, under `removed_mutex_`
+    void storeMarkedRemoved();
+
+    /**
+     * Blocks moved to ancient store, by their headers.
+     * @return nullopt for block not found there
+     */
+    outcome::result<std::vector<std::optional<SignedBlock>>>
+    fetchAncientBlocks(std::span<const BlockHeader> headers) const;
+
+    outcome::result<std::optional<SignedBlock>> fetchAncientBlock(
+        const BlockHeader &header) const;
+
+    /// State with number of diffs it is rebuilt from
+    struct StoredState {
+      State state;
+      uint64_t depth;
+    };
+
+    /**
+     * Load state, applying chain of diffs to nearest full snapshot.
+     * @return nullptr if state or some state of chain is missing
+     */
+    outcome::result<std::shared_ptr<const StoredState>> loadState(
+        const BlockHash &block_hash) const;
+
+    /// Look up state cache, and report its hits, misses and rejections
+    std::optional<std::shared_ptr<const StoredState>> cachedState(
+        const BlockHash &block_hash) const;
+
+    /// Store full state, with validators list stored apart by its root
+    outcome::result<void> putStateSnapshot(const BlockHash &block_hash,
+                                           const State &state);
+
+    outcome::result<State> decodeStateSnapshot(qtils::BytesIn encoded) const;
+
+    outcome::result<ValidatorList> loadValidators(const BlockHash &root) const;
+
+    /// Full snapshot is stored at least once per this number of slots
+    static constexpr uint64_t kStateSnapshotInterval = 32;
+    static constexpr size_t kStateCacheSize = 4;
+    /// Half of state cache keeps recent states, parents of next diffs
+    static constexpr size_t kStateCacheWindowPercent = 50;
+
     log::Logger logger_;
 
     qtils::SharedRef<storage::SpacedStorage> storage_;
 
     std::shared_ptr<crypto::Hasher> hasher_;
 
+    /// Signatures and bodies of finalized canonical blocks, if enabled
+    std::shared_ptr<storage::AncientStore> ancient_;
+
+    /// Compresses signatures and bodies, if enabled
+    std::shared_ptr<BlockValueCodec> codec_;
+
+    std::shared_ptr<metrics::Metrics> metrics_;
+
+    std::shared_ptr<WorkerPool> worker_pool_;
+
     mutable std::optional<std::vector<BlockHash>> block_tree_leaves_;
+
+    /// Recently stored or rebuilt states, parents for next diffs.
+    /// Old states rebuilt once for api or sync don't push out reused ones.
+    mutable TinyLfuCache<BlockHash, StoredState> states_{{
+        .capacity = kStateCacheSize,
+        .window_percent = kStateCacheWindowPercent,
+    }};
+    /// Stats of `states_` already added to metrics
+    mutable std::mutex states_reported_mutex_;
+    mutable TinyLfuCache<BlockHash, StoredState>::Stats states_reported_;
+
+    /// Headers are never looked up in database for most unknown hashes
+    mutable std::atomic<std::shared_ptr<HeaderFilter>> header_filter_;
+    /// Filter being built, headers put meanwhile are inserted there too
+    mutable std::atomic<std::shared_ptr<HeaderFilter>> building_header_filter_;
+    mutable std::atomic_bool header_filter_requested_ = false;
+
+    /// Blocks pruned by finalization, but not removed yet
+    mutable std::mutex removed_mutex_;
+    std::unordered_set<BlockHash> removed_;
+    /// Size of `removed_`, to skip lock while it is empty
+    std::atomic_size_t removed_count_ = 0;
+
+    /// Last loaded validators list, same for most snapshots
+    mutable std::mutex validators_mutex_;
+    mutable std::optional<std::pair<BlockHash, ValidatorList>> validators_;
   };
 }  // namespace lean::blockchain
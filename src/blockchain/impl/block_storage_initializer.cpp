@@ -14,6 +14,7 @@
 #include "blockchain/block_storage_error.hpp"
 #include "blockchain/impl/block_storage_impl.hpp"
 #include "blockchain/impl/storage_util.hpp"
+#include "storage/predefined_keys.hpp"
 #include "types/block.hpp"
 #include "types/state.hpp"
 
@@ -27,7 +28,8 @@ namespace lean::blockchain {
       qtils::SharedRef<app::ChainSpec> chain_spec,
       qtils::SharedRef<crypto::Hasher> hasher) {
     // temporary instance of block storage
-    BlockStorageImpl block_storage(std::move(logsys), storage, hasher, {});
+    BlockStorageImpl block_storage(
+        std::move(logsys), storage, hasher, nullptr, nullptr, nullptr, {});
 
     auto anchor_block_hash = anchor_block->hash();
 
@@ -87,6 +89,28 @@ namespace lean::blockchain {
         qtils::raise(state_res.error());
       }
 
+      if (anchor_block->slot != 0) {
+        // Checkpoint sync anchor, history behind it is backfilled from peers
+        // and has no states
+        auto backfill_res = block_storage.putBackfilledBlocks(
+            {},
+            BackfillCursor{
+                .hash = anchor_block_hash,
+                .before = anchor_block->slot + 1,
+            });
+        if (backfill_res.has_value()) {
+          backfill_res = storage->getSpace(storage::Space::Default)
+                             ->put(storage::kPrunedStateSlotLookupKey,
+                                   encode(anchor_block->slot).value());
+        }
+        if (backfill_res.has_error()) {
+          block_storage.logger_->critical(
+              "Database error at store backfill cursor: {}",
+              backfill_res.error());
+          qtils::raise(backfill_res.error());
+        }
+      }
+
       block_storage.logger_->info("Anchor block {}, state {}",
                                   anchor_block->index(),
                                   anchor_block->state_root);
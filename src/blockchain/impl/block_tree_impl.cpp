@@ -8,6 +8,7 @@
 
 #include <queue>
 #include <stack>
+#include <utility>
 
 #include <qtils/cxx23/ranges/contains.hpp>
 
@@ -22,23 +23,33 @@
 #include "types/signed_block.hpp"
 
 namespace lean::blockchain {
-  BlockTreeImpl::SafeBlockTreeData::SafeBlockTreeData(BlockTreeData data)
-      : block_tree_data_{std::move(data)} {}
+  BlockTreeImpl::SafeBlockTreeData::SafeBlockTreeData(BlockTreeData data,
+                                                      LockStats &lock_stats)
+      : block_tree_data_{std::move(data)}, mutex_{lock_stats} {}
 
   BlockTreeImpl::BlockTreeImpl(
       qtils::SharedRef<log::LoggingSystem> logsys,
       qtils::SharedRef<BlockStorage> storage,
       qtils::SharedRef<crypto::Hasher> hasher,
       std::shared_ptr<Subscription> se_manager,
-      qtils::SharedRef<BlockTreeInitializer> initializer)
+      qtils::SharedRef<BlockTreeInitializer> initializer,
+      qtils::SharedRef<LockProfiler> lock_profiler)
       : log_(logsys->getLogger("BlockTree", "block_tree")),
         se_manager_(std::move(se_manager)),
-        block_tree_data_{{
-            .storage_ = std::move(storage),
-            .tree_ = std::make_unique<CachedTree>(
-                initializer->latestFinalizedAtStart()),
-            .hasher_ = std::move(hasher),
-        }} {
+        storage_{storage},
+        block_tree_data_{
+            {
+                .storage_ = std::move(storage),
+                .tree_ = std::make_unique<CachedTree>(
+                    initializer->latestFinalizedAtStart()),
+                .canonical_ = CanonicalIndex{
+                    initializer->latestFinalizedAtStart()},
+                .hasher_ = std::move(hasher),
+            },
+            lock_profiler->lock("block_tree"),
+        } {
+    block_tree_data_.exclusiveAccess(
+        [&](const BlockTreeData &p) { publishSnapshot(p); });
     SL_TRACE(log_,
              "Block {} set as last finalized",
              initializer->latestFinalizedAtStart());
@@ -98,13 +109,12 @@ namespace lean::blockchain {
           if (not parent_opt.has_value()) {
             return BlockTreeError::NO_PARENT;
           }
-          const auto &parent = parent_opt.value();
+          auto parent = parent_opt.value();
           OUTCOME_TRY(p.storage_->putBlockHeader(header));
 
           // update local meta with the new block
-          auto new_node = std::make_shared<TreeNode>(header.index(), parent);
-
-          auto reorg = p.tree_->add(new_node);
+          auto reorg =
+              p.tree_->add(header.index(), header.state_root, parent);
           OUTCOME_TRY(reorgAndPrune(p, {std::move(reorg), {}}));
 
           auto header_ptr = std::make_shared<BlockHeader>(header);
@@ -117,7 +127,8 @@ namespace lean::blockchain {
         });
   }
 
-  outcome::result<void> BlockTreeImpl::addBlock(SignedBlock signed_block) {
+  outcome::result<void> BlockTreeImpl::addBlock(
+      const SignedBlock &signed_block) {
     auto &block = signed_block.block;
 
     return block_tree_data_.exclusiveAccess(
@@ -127,7 +138,7 @@ namespace lean::blockchain {
           if (not parent_opt.has_value()) {
             return BlockTreeError::NO_PARENT;
           }
-          const auto &parent = parent_opt.value();
+          auto parent = parent_opt.value();
 
           auto header = block.getHeader();
           header.updateHash();
@@ -149,9 +160,8 @@ namespace lean::blockchain {
           BOOST_ASSERT(block_hash == header.hash());
 
           // Update local meta with the block
-          auto new_node = std::make_shared<TreeNode>(header.index(), parent);
-
-          auto reorg = p.tree_->add(new_node);
+          auto reorg =
+              p.tree_->add(header.index(), header.state_root, parent);
           OUTCOME_TRY(reorgAndPrune(p, {std::move(reorg), {}}));
 
           auto msg = std::make_shared<const messages::NewLeaf>(
@@ -268,12 +278,11 @@ namespace lean::blockchain {
                "Trying to add block {} into block tree",
                BlockIndex(block_header.slot, block_hash));
     }
-    auto &parent = parent_opt.value();
+    auto parent = parent_opt.value();
 
     // Update local meta with the block
-    auto new_node = std::make_shared<TreeNode>(block_header.index(), parent);
-
-    auto reorg = p.tree_->add(new_node);
+    auto reorg =
+        p.tree_->add(block_header.index(), block_header.state_root, parent);
     OUTCOME_TRY(reorgAndPrune(p, {std::move(reorg), {}}));
 
     SL_VERBOSE(log_,
@@ -308,27 +317,33 @@ namespace lean::blockchain {
           }
           const auto node_opt = p.tree_->find(block_hash);
           if (node_opt.has_value()) {
-            auto &node = node_opt.value();
+            auto node = node_opt.value();
+            // Node ids are renumbered by finalization
+            auto index = p.tree_->node(node).index;
 
-            SL_DEBUG(log_, "Finalizing block {}", node->index);
+            SL_DEBUG(log_, "Finalizing block {}", index);
 
             OUTCOME_TRY(header, p.storage_->getBlockHeader(block_hash));
 
             // Block which is finalized as ancestors of last finalized
             std::vector<BlockIndex> retired_blocks;
-            for (auto parent = node->parent(); parent;
-                 parent = parent->parent()) {
-              retired_blocks.emplace_back(parent->index);
+            for (auto parent = p.tree_->parent(node); parent;
+                 parent = p.tree_->parent(*parent)) {
+              retired_blocks.emplace_back(p.tree_->node(*parent).index);
             }
 
+            // Non-canonical blocks are removed from storage by pruner, and
+            // are hidden until then
             auto changes = p.tree_->finalize(node);
+            auto pruned = std::exchange(changes.prune, {});
             OUTCOME_TRY(reorgAndPrune(p, changes));
+            p.storage_->markRemoved(pruned);
 
             auto msg = std::make_shared<messages::Finalized>(
-                header.index(), std::move(retired_blocks));
+                header.index(), std::move(retired_blocks), std::move(pruned));
             se_manager_->notify(EventTypes::BlockFinalized, msg);
 
-            log_->info("Finalized block {}", node->index);
+            log_->info("Finalized block {}", index);
 
           } else {
             OUTCOME_TRY(header, p.storage_->getBlockHeader(block_hash));
@@ -357,18 +372,19 @@ namespace lean::blockchain {
           }
           const auto node_opt = p.tree_->find(block_hash);
           if (node_opt.has_value()) {
-            auto &node = node_opt.value();
+            auto node = node_opt.value();
 
-            SL_DEBUG(log_, "Justifying block {}", node->index);
+            SL_DEBUG(log_, "Justifying block {}", p.tree_->node(node).index);
 
             OUTCOME_TRY(header, p.storage_->getBlockHeader(block_hash));
 
             // Block which is justified as ancestors of last justified, and
             // especially last finalized
-            for (auto parent = node->parent(); parent;
-                 parent = parent->parent()) {
-              if (parent->index == getLastJustifiedNoLock(p)) {
+            for (auto parent = p.tree_->parent(node); parent;
+                 parent = p.tree_->parent(*parent)) {
+              if (p.tree_->node(*parent).index == getLastJustifiedNoLock(p)) {
                 p.tree_->setJustified(node);
+                publishSnapshot(p);
                 return outcome::success();
               };
             }
@@ -397,39 +413,27 @@ namespace lean::blockchain {
   }
 
   bool BlockTreeImpl::has(const BlockHash &hash) const {
-    return block_tree_data_.sharedAccess([&](const BlockTreeData &p) {
-      return p.tree_->find(hash) or p.storage_->hasBlockHeader(hash).value();
-    });
-  }
-
-  outcome::result<BlockHeader> BlockTreeImpl::getBlockHeaderNoLock(
-      const BlockTreeData &p, const BlockHash &block_hash) const {
-    return p.storage_->getBlockHeader(block_hash);
+    return snapshot()->nodes.contains(hash)
+        or storage_->hasBlockHeader(hash).value();
   }
 
   outcome::result<BlockHeader> BlockTreeImpl::getBlockHeader(
       const BlockHash &block_hash) const {
-    return block_tree_data_.sharedAccess(
-        [&](const BlockTreeData &p) -> outcome::result<BlockHeader> {
-          return getBlockHeaderNoLock(p, block_hash);
-        });
+    // Storage is thread safe, headers are immutable
+    return storage_->getBlockHeader(block_hash);
   }
 
   outcome::result<std::optional<BlockHeader>> BlockTreeImpl::tryGetBlockHeader(
       const BlockHash &block_hash) const {
-    return block_tree_data_.sharedAccess(
-        [&](const BlockTreeData &p)
-            -> outcome::result<std::optional<BlockHeader>> {
-          auto header = p.storage_->getBlockHeader(block_hash);
-          if (header) {
-            return header.value();
-          }
-          const auto &header_error = header.error();
-          if (header_error == BlockTreeError::HEADER_NOT_FOUND) {
-            return std::nullopt;
-          }
-          return header_error;
-        });
+    auto header = storage_->getBlockHeader(block_hash);
+    if (header) {
+      return header.value();
+    }
+    const auto &header_error = header.error();
+    if (header_error == BlockTreeError::HEADER_NOT_FOUND) {
+      return std::nullopt;
+    }
+    return header_error;
   }
 
   outcome::result<BlockBody> BlockTreeImpl::getBlockBody(
@@ -455,41 +459,24 @@ namespace lean::blockchain {
                         block_header_res.error());
             return BlockTreeError::HEADER_NOT_FOUND;
           }
-          auto start_block_number = block_header_res.value().slot;
-
-          if (maximum == 1) {
-            return std::vector{block};
-          }
-
-          auto current_depth = bestBlockNoLock(p).slot;
+          auto start_slot = block_header_res.value().slot;
 
-          if (start_block_number >= current_depth) {
+          // Block of other fork has no best chain to continue
+          OUTCOME_TRY(canonical, getCanonicalHashNoLock(p, start_slot));
+          if (canonical != block or maximum <= 1) {
             return std::vector{block};
           }
 
-          auto count = std::min<uint64_t>(
-              current_depth - start_block_number + 1, maximum);
-
-          Slot finish_block_number = start_block_number + count - 1;
-
-          auto finish_block_hash_res =
-              p.storage_->getBlockHash(finish_block_number);
-          if (finish_block_hash_res.has_error()) {
-            log_->error("cannot retrieve block with number {}: {}",
-                        finish_block_number,
-                        finish_block_hash_res.error());
-            return BlockTreeError::HEADER_NOT_FOUND;
-          }
-          const auto &finish_block_hash = finish_block_hash_res.value()[0];
-
-          OUTCOME_TRY(
-              chain,
-              getDescendingChainToBlockNoLock(p, finish_block_hash, count));
-
-          if (chain.back() != block) {
-            return std::vector{block};
+          auto best_slot = bestBlockNoLock(p).slot;
+          std::vector<BlockHash> chain{block};
+          for (auto slot = start_slot + 1;
+               slot <= best_slot and chain.size() < maximum;
+               ++slot) {
+            OUTCOME_TRY(hash, getCanonicalHashNoLock(p, slot));
+            if (hash.has_value()) {
+              chain.emplace_back(hash.value());
+            }
           }
-          std::ranges::reverse(chain);
           return chain;
         });
   }
@@ -506,13 +493,13 @@ namespace lean::blockchain {
     if (auto node_opt = p.tree_->find(hash); node_opt.has_value()) {
       auto node = node_opt.value();
       while (maximum > chain.size()) {
-        auto parent = node->parent();
+        auto parent = p.tree_->parent(node);
         if (not parent) {
-          hash = node->index.hash;
+          hash = p.tree_->node(node).index.hash;
           break;
         }
-        chain.emplace_back(node->index.hash);
-        node = parent;
+        chain.emplace_back(p.tree_->node(node).index.hash);
+        node = *parent;
       }
     }
 
@@ -546,6 +533,46 @@ namespace lean::blockchain {
     });
   }
 
+  outcome::result<std::optional<BlockHash>>
+  BlockTreeImpl::getCanonicalHashNoLock(const BlockTreeData &p,
+                                        Slot slot) const {
+    if (slot >= p.canonical_.firstSlot()) {
+      return p.canonical_.get(slot);
+    }
+    // Slot-to-hash records of finalized slots keep only finalized chain
+    OUTCOME_TRY(hashes, p.storage_->getBlockHash(slot));
+    if (hashes.empty()) {
+      return std::nullopt;
+    }
+    return hashes.front();
+  }
+
+  outcome::result<std::optional<BlockHash>> BlockTreeImpl::getCanonicalHash(
+      Slot slot) const {
+    return block_tree_data_.sharedAccess([&](const BlockTreeData &p) {
+      return getCanonicalHashNoLock(p, slot);
+    });
+  }
+
+  outcome::result<std::vector<BlockIndex>> BlockTreeImpl::getCanonicalBlocks(
+      Slot start_slot, uint64_t count) const {
+    return block_tree_data_.sharedAccess(
+        [&](const BlockTreeData &p)
+            -> outcome::result<std::vector<BlockIndex>> {
+          auto best_slot = bestBlockNoLock(p).slot;
+          std::vector<BlockIndex> blocks;
+          for (auto slot = start_slot;
+               slot <= best_slot and slot - start_slot < count;
+               ++slot) {
+            OUTCOME_TRY(hash, getCanonicalHashNoLock(p, slot));
+            if (hash.has_value()) {
+              blocks.emplace_back(BlockIndex{.slot = slot, .hash = *hash});
+            }
+          }
+          return blocks;
+        });
+  }
+
   // outcome::result<std::vector<BlockHash>> BlockTreeImpl::getChainByBlocks(
   //     const BlockHash &ancestor, const BlockHash &descendant) const {
   //   return block_tree_data_.sharedAccess(
@@ -656,14 +683,12 @@ namespace lean::blockchain {
   // }
 
   bool BlockTreeImpl::isFinalized(const BlockIndex &block) const {
-    return block_tree_data_.sharedAccess([&](const BlockTreeData &p) {
-      if (block.slot > getLastFinalizedNoLock(p).slot) {
-        return false;
-      }
-      auto res = p.storage_->getBlockHash(block.slot);
-      return res.has_value() and not res.value().empty()
-         and res.value().front() == block.hash;
-    });
+    if (block.slot > snapshot()->finalized.slot) {
+      return false;
+    }
+    auto res = storage_->getBlockHash(block.slot);
+    return res.has_value() and not res.value().empty()
+       and res.value().front() == block.hash;
   }
 
   BlockIndex BlockTreeImpl::bestBlockNoLock(const BlockTreeData &p) const {
@@ -671,8 +696,7 @@ namespace lean::blockchain {
   }
 
   BlockIndex BlockTreeImpl::bestBlock() const {
-    return block_tree_data_.sharedAccess(
-        [&](const BlockTreeData &p) { return bestBlockNoLock(p); });
+    return snapshot()->best;
   }
 
   outcome::result<BlockIndex> BlockTreeImpl::getBestContaining(
@@ -704,14 +728,8 @@ namespace lean::blockchain {
         });
   }
 
-  std::vector<BlockHash> BlockTreeImpl::getLeavesNoLock(
-      const BlockTreeData &p) const {
-    return p.tree_->leafHashes();
-  }
-
   std::vector<BlockHash> BlockTreeImpl::getLeaves() const {
-    return block_tree_data_.sharedAccess(
-        [&](const BlockTreeData &p) { return getLeavesNoLock(p); });
+    return snapshot()->leaves;
   }
 
   // std::vector<BlockIndex> BlockTreeImpl::getLeavesInfo() const {
@@ -721,21 +739,76 @@ namespace lean::blockchain {
 
   outcome::result<std::vector<BlockHash>> BlockTreeImpl::getChildren(
       const BlockHash &block) const {
+    auto snapshot = this->snapshot();
+    if (auto it = snapshot->nodes.find(block); it != snapshot->nodes.end()) {
+      return it->second.children;
+    }
+    OUTCOME_TRY(header, storage_->getBlockHeader(block));
+
+    // TODO slot of children may be greater then parent's by more then one
+    return storage_->getBlockHash(header.slot + 1);
+  }
+
+  void BlockTreeImpl::forEachNonFinalizedAncestor(
+      const BlockHash &block, const AncestorVisitor &visit) const {
+    block_tree_data_.sharedAccess([&](const BlockTreeData &p) {
+      auto &tree = *p.tree_;
+      auto node_opt = tree.find(block);
+      if (not node_opt.has_value()) {
+        return;
+      }
+      // Finalized root is only node without parent
+      for (auto node = node_opt.value(), parent = tree.parent(node);
+           parent.has_value();
+           node = parent.value(), parent = tree.parent(node)) {
+        auto &tree_node = tree.node(node);
+        if (not visit({
+                .index = tree_node.index,
+                .parent_root = tree.node(parent.value()).index.hash,
+                .state_root = tree_node.state_root,
+            })) {
+          return;
+        }
+      }
+    });
+  }
+
+  std::optional<BlockIndex> BlockTreeImpl::getAncestorAtSlot(
+      const BlockHash &block, Slot slot) const {
     return block_tree_data_.sharedAccess(
-        [&](const BlockTreeData &p) -> outcome::result<std::vector<BlockHash>> {
-          if (auto node_opt = p.tree_->find(block); node_opt.has_value()) {
-            const auto &node = node_opt.value();
-            std::vector<BlockHash> result;
-            result.reserve(node->children.size());
-            for (const auto &child : node->children) {
-              result.push_back(child->index.hash);
-            }
-            return result;
+        [&](const BlockTreeData &p) -> std::optional<BlockIndex> {
+          auto &tree = *p.tree_;
+          auto node = tree.find(block);
+          if (not node.has_value()) {
+            return std::nullopt;
           }
-          OUTCOME_TRY(header, p.storage_->getBlockHeader(block));
+          auto ancestor = tree.ancestorAtSlot(node.value(), slot);
+          if (not ancestor.has_value()) {
+            return std::nullopt;
+          }
+          return tree.node(ancestor.value()).index;
+        });
+  }
 
-          // TODO slot of children may be greater then parent's by more then one
-          return p.storage_->getBlockHash(header.slot + 1);
+  std::optional<CommonAncestor> BlockTreeImpl::getCommonAncestor(
+      const BlockHash &lhs, const BlockHash &rhs) const {
+    return block_tree_data_.sharedAccess(
+        [&](const BlockTreeData &p) -> std::optional<CommonAncestor> {
+          auto &tree = *p.tree_;
+          auto lhs_node = tree.find(lhs);
+          auto rhs_node = tree.find(rhs);
+          if (not lhs_node.has_value() or not rhs_node.has_value()) {
+            return std::nullopt;
+          }
+          auto &ancestor = tree.node(
+              tree.commonAncestor(lhs_node.value(), rhs_node.value()));
+          auto lhs_depth = tree.node(lhs_node.value()).depth;
+          auto rhs_depth = tree.node(rhs_node.value()).depth;
+          return CommonAncestor{
+              .index = ancestor.index,
+              .lhs_distance = lhs_depth - ancestor.depth,
+              .rhs_distance = rhs_depth - ancestor.depth,
+          };
         });
   }
 
@@ -745,8 +818,7 @@ namespace lean::blockchain {
   }
 
   BlockIndex BlockTreeImpl::lastFinalized() const {
-    return block_tree_data_.sharedAccess(
-        [&](const BlockTreeData &p) { return getLastFinalizedNoLock(p); });
+    return snapshot()->finalized;
   }
 
   BlockIndex BlockTreeImpl::getLastJustifiedNoLock(
@@ -755,10 +827,8 @@ namespace lean::blockchain {
   }
 
   Checkpoint BlockTreeImpl::getLatestJustified() const {
-    return block_tree_data_.sharedAccess([&](const BlockTreeData &p) {
-      auto justified = getLastJustifiedNoLock(p);
-      return Checkpoint{.root = justified.hash, .slot = justified.slot};
-    });
+    auto justified = snapshot()->justified;
+    return Checkpoint{.root = justified.hash, .slot = justified.slot};
   }
 
   outcome::result<std::optional<SignedBlock>> BlockTreeImpl::tryGetSignedBlock(
@@ -777,16 +847,48 @@ namespace lean::blockchain {
         });
   }
 
+  outcome::result<std::vector<std::optional<SignedBlock>>>
+  BlockTreeImpl::tryGetSignedBlocks(
+      std::span<const BlockHash> block_hashes) const {
+    return block_tree_data_.sharedAccess([&](const BlockTreeData &p) {
+      return p.storage_->tryGetSignedBlocks(block_hashes);
+    });
+  }
+
+  outcome::result<std::optional<BackfillCursor>>
+  BlockTreeImpl::getBackfillCursor() const {
+    return block_tree_data_.sharedAccess([&](const BlockTreeData &p) {
+      return p.storage_->getBackfillCursor();
+    });
+  }
+
+  outcome::result<void> BlockTreeImpl::addBackfilledBlocks(
+      std::span<const SignedBlock> blocks,
+      const std::optional<BackfillCursor> &cursor) {
+    // History is below finalized block, tree doesn't change
+    return block_tree_data_.sharedAccess([&](const BlockTreeData &p) {
+      return p.storage_->putBackfilledBlocks(blocks, cursor);
+    });
+  }
+
   outcome::result<void> BlockTreeImpl::reorgAndPrune(
-      const BlockTreeData &p, const ReorgAndPrune &changes) {
-    OUTCOME_TRY(p.storage_->setBlockTreeLeaves(p.tree_->leafHashes()));
+      BlockTreeData &p, const ReorgAndPrune &changes) {
+    // Tree is changed already, even if storage fails below
+    publishSnapshot(p);
+    std::span<const BlockIndex> revert, apply;
     if (changes.reorg) {
-      for (auto &block : changes.reorg->revert) {
-        OUTCOME_TRY(p.storage_->deassignHashToSlot(block));
-      }
-      for (auto &block : changes.reorg->apply) {
-        OUTCOME_TRY(p.storage_->assignHashToSlot(block));
-      }
+      revert = changes.reorg->revert;
+      apply = changes.reorg->apply;
+    }
+    OUTCOME_TRY(
+        p.storage_->applyTreeChanges(p.tree_->leafHashes(), revert, apply));
+
+    p.canonical_.reorg(revert, apply);
+    p.canonical_.finalize(p.tree_->finalized());
+    // Finalization reorgs only to finalized block, then picks best among its
+    // descendants
+    if (p.canonical_.last() != p.tree_->best()) {
+      p.canonical_.rebuild(*p.tree_);
     }
 
     // remove from storage
@@ -801,20 +903,44 @@ namespace lean::blockchain {
 
   outcome::result<Slot> BlockTreeImpl::getSlotByHash(
       const BlockHash &block_hash) const {
-    auto slot_opt = block_tree_data_.sharedAccess(
-        [&](const BlockTreeData &p) -> std::optional<Slot> {
-          if (auto node = p.tree_->find(block_hash)) {
-            return node.value()->index.slot;
-          }
-          return std::nullopt;
-        });
-    if (slot_opt.has_value()) {
-      return slot_opt.value();
+    auto snapshot = this->snapshot();
+    if (auto it = snapshot->nodes.find(block_hash);
+        it != snapshot->nodes.end()) {
+      return it->second.slot;
     }
     OUTCOME_TRY(header, getBlockHeader(block_hash));
     return header.slot;
   }
 
+  void BlockTreeImpl::publishSnapshot(const BlockTreeData &p) {
+    auto &tree = *p.tree_;
+    auto snapshot = std::make_shared<Snapshot>(Snapshot{
+        .finalized = tree.finalized(),
+        .justified = tree.justified(),
+        .best = tree.best(),
+        .leaves = tree.leafHashes(),
+        .nodes = {},
+    });
+    std::vector<TreeNodeId> queue{tree.find(snapshot->finalized.hash).value()};
+    while (not queue.empty()) {
+      auto &node = tree.node(queue.back());
+      queue.pop_back();
+      auto &snapshot_node = snapshot->nodes[node.index.hash];
+      snapshot_node.slot = node.index.slot;
+      snapshot_node.children.reserve(node.children.size());
+      for (auto child : node.children) {
+        snapshot_node.children.emplace_back(tree.node(child).index.hash);
+        queue.emplace_back(child);
+      }
+    }
+    snapshot_.store(std::move(snapshot), std::memory_order_release);
+  }
+
+  std::shared_ptr<const BlockTreeImpl::Snapshot> BlockTreeImpl::snapshot()
+      const {
+    return snapshot_.load(std::memory_order_acquire);
+  }
+
   // outcome::result<BlockHash> BlockTreeImpl::getHashByNumber(
   //     Slot number) const {
   //   OUTCOME_TRY(block_hash_opt, getBlockHash(number));
@@ -6,18 +6,22 @@
 
 #pragma once
 
+#include <atomic>
 #include <thread>
 
 #include <qtils/final_action.hpp>
+#include <qtils/shared_ref.hpp>
 
 #include "blockchain/block_storage.hpp"
 #include "blockchain/block_tree.hpp"
 #include "blockchain/impl/block_tree_initializer.hpp"
 #include "blockchain/impl/cached_tree.hpp"
+#include "blockchain/impl/canonical_index.hpp"
+#include "blockchain/lock_profiler.hpp"
 #include "log/logger.hpp"
-#include "se/impl/common.hpp"
 #include "se/subscription.hpp"
 #include "se/subscription_fwd.hpp"
+#include "types/block_hash_map.hpp"
 
 namespace lean::metrics {
   class Registry;
@@ -44,7 +48,8 @@ namespace lean::blockchain {
                   qtils::SharedRef<BlockStorage> storage,
                   qtils::SharedRef<crypto::Hasher> hasher,
                   std::shared_ptr<Subscription> se_manager,
-                  qtils::SharedRef<BlockTreeInitializer> initializer);
+                  qtils::SharedRef<BlockTreeInitializer> initializer,
+                  qtils::SharedRef<LockProfiler> lock_profiler);
 
     ~BlockTreeImpl() override = default;
 
@@ -63,7 +68,7 @@ namespace lean::blockchain {
 
     outcome::result<void> addBlockHeader(const BlockHeader &header) override;
 
-    outcome::result<void> addBlock(SignedBlock signed_block) override;
+    outcome::result<void> addBlock(const SignedBlock &signed_block) override;
 
     outcome::result<void> removeLeaf(const BlockHash &block_hash) override;
 
@@ -83,6 +88,12 @@ namespace lean::blockchain {
     outcome::result<std::vector<BlockHash>> getDescendingChainToBlock(
         const BlockHash &block, uint64_t maximum) const override;
 
+    outcome::result<std::optional<BlockHash>> getCanonicalHash(
+        Slot slot) const override;
+
+    outcome::result<std::vector<BlockIndex>> getCanonicalBlocks(
+        Slot start_slot, uint64_t count) const override;
+
     // outcome::result<std::vector<BlockHash>> getChainByBlocks(
     //     const BlockHash &ancestor,
     //     const BlockHash &descendant) const override;
@@ -103,6 +114,15 @@ namespace lean::blockchain {
     outcome::result<std::vector<BlockHash>> getChildren(
         const BlockHash &block) const override;
 
+    void forEachNonFinalizedAncestor(
+        const BlockHash &block, const AncestorVisitor &visit) const override;
+
+    std::optional<BlockIndex> getAncestorAtSlot(const BlockHash &block,
+                                                Slot slot) const override;
+
+    std::optional<CommonAncestor> getCommonAncestor(
+        const BlockHash &lhs, const BlockHash &rhs) const override;
+
     BlockIndex lastFinalized() const override;
 
     Checkpoint getLatestJustified() const override;
@@ -110,6 +130,16 @@ namespace lean::blockchain {
     outcome::result<std::optional<SignedBlock>> tryGetSignedBlock(
         const BlockHash block_hash) const override;
 
+    outcome::result<std::vector<std::optional<SignedBlock>>>
+    tryGetSignedBlocks(std::span<const BlockHash> block_hashes) const override;
+
+    outcome::result<std::optional<BackfillCursor>> getBackfillCursor()
+        const override;
+
+    outcome::result<void> addBackfilledBlocks(
+        std::span<const SignedBlock> blocks,
+        const std::optional<BackfillCursor> &cursor) override;
+
     // BlockHeaderRepository methods
 
     outcome::result<Slot> getSlotByHash(
@@ -119,15 +149,38 @@ namespace lean::blockchain {
     struct BlockTreeData {
       qtils::SharedRef<BlockStorage> storage_;
       std::unique_ptr<CachedTree> tree_;
+      /// Best chain of `tree_` by slot
+      CanonicalIndex canonical_;
       qtils::SharedRef<crypto::Hasher> hasher_;
       std::optional<BlockHash> genesis_block_hash_;
     };
 
-    outcome::result<void> reorgAndPrune(const BlockTreeData &p,
+    /**
+     * Immutable copy of in-memory tree metadata, published after each tree
+     * mutation, so hot readers load it wait-free instead of taking lock.
+     */
+    struct Snapshot {
+      struct Node {
+        Slot slot;
+        std::vector<BlockHash> children;
+      };
+      BlockIndex finalized;
+      BlockIndex justified;
+      BlockIndex best;
+      std::vector<BlockHash> leaves;
+      /// Non-finalized blocks and finalized root
+      BlockHashMap<Node> nodes;
+    };
+
+    /// Called by writer under exclusive lock
+    void publishSnapshot(const BlockTreeData &p);
+    std::shared_ptr<const Snapshot> snapshot() const;
+
+    outcome::result<void> reorgAndPrune(BlockTreeData &p,
                                         const ReorgAndPrune &changes);
 
-    outcome::result<BlockHeader> getBlockHeaderNoLock(
-        const BlockTreeData &p, const BlockHash &block_hash) const;
+    outcome::result<std::optional<BlockHash>> getCanonicalHashNoLock(
+        const BlockTreeData &p, Slot slot) const;
 
     BlockIndex getLastFinalizedNoLock(const BlockTreeData &p) const;
     BlockIndex getLastJustifiedNoLock(const BlockTreeData &p) const;
@@ -136,7 +189,6 @@ namespace lean::blockchain {
     // bool hasDirectChainNoLock(const BlockTreeData &p,
     //                           const BlockHash &ancestor,
     //                           const BlockHash &descendant);
-    std::vector<BlockHash> getLeavesNoLock(const BlockTreeData &p) const;
 
     outcome::result<std::vector<BlockHash>> getDescendingChainToBlockNoLock(
         const BlockTreeData &p,
@@ -150,7 +202,7 @@ namespace lean::blockchain {
 
     class SafeBlockTreeData {
      public:
-      explicit SafeBlockTreeData(BlockTreeData data);
+      SafeBlockTreeData(BlockTreeData data, LockStats &lock_stats);
 
       template <typename F>
       decltype(auto) exclusiveAccess(F &&f) {
@@ -158,16 +210,14 @@ namespace lean::blockchain {
         // not be unlocked until this function exits
         if (exclusive_owner_.load(std::memory_order_acquire)
             == std::this_thread::get_id()) {
-          return f(block_tree_data_.unsafeGet());
+          return f(block_tree_data_);
         }
-        return block_tree_data_.exclusiveAccess(
-            [&f, this](BlockTreeData &data) {
-              exclusive_owner_ = std::this_thread::get_id();
-              qtils::FinalAction reset([&] {
-                exclusive_owner_ = decltype(std::this_thread::get_id()){};
-              });
-              return f(data);
-            });
+        std::unique_lock lock{mutex_};
+        exclusive_owner_ = std::this_thread::get_id();
+        qtils::FinalAction reset([&] {
+          exclusive_owner_ = decltype(std::this_thread::get_id()){};
+        });
+        return f(block_tree_data_);
       }
 
       template <typename F>
@@ -176,21 +226,26 @@ namespace lean::blockchain {
         // not be unlocked until this function exits
         if (exclusive_owner_.load(std::memory_order_acquire)
             == std::this_thread::get_id()) {
-          return f(block_tree_data_.unsafeGet());
+          return f(block_tree_data_);
         }
-        return block_tree_data_.sharedAccess(std::forward<F>(f));
+        std::shared_lock lock{mutex_};
+        return f(block_tree_data_);
       }
 
      private:
-      se::utils::SafeObject<BlockTreeData> block_tree_data_;
+      BlockTreeData block_tree_data_;
+      mutable ProfiledSharedMutex mutex_;
       std::atomic<std::thread::id> exclusive_owner_ =
           decltype(std::this_thread::get_id()){};
     };
 
     log::Logger log_;
     std::shared_ptr<Subscription> se_manager_;
+    /// Thread safe, read without tree lock
+    qtils::SharedRef<BlockStorage> storage_;
 
     SafeBlockTreeData block_tree_data_;
+    std::atomic<std::shared_ptr<const Snapshot>> snapshot_;
   };
 
 }  // namespace lean::blockchain
@@ -7,6 +7,7 @@
 #include "blockchain/impl/block_tree_initializer.hpp"
 
 #include <set>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <qtils/error_throw.hpp>
@@ -15,7 +16,6 @@
 #include "blockchain/block_storage_error.hpp"
 #include "blockchain/block_tree_error.hpp"
 #include "log/logger.hpp"
-#include "types/state.hpp"
 
 namespace lean::blockchain {
 
@@ -173,29 +173,28 @@ namespace lean::blockchain {
         break;
       }
 
-      auto state_res = storage->getState(block_index.hash);
-      if (state_res.has_error()) {
+      // Only checkpoints are read, state is loaded later on demand
+      auto checkpoints_res = storage->getStateCheckpoints(block_index.hash);
+      if (checkpoints_res.has_error()) {
         SL_CRITICAL(logger,
-                    "Can't get header of existing non-finalized block {}: {}",
+                    "Can't get state of existing non-finalized block {}: {}",
                     block_index,
-                    state_res.error());
+                    checkpoints_res.error());
+        qtils::raise(BlockTreeError::BLOCK_TREE_CORRUPTED);
       }
-      if (state_res.value().has_value()) {
-        auto &state = state_res.value().value();
+      if (checkpoints_res.value().has_value()) {
+        auto &checkpoints = checkpoints_res.value().value();
         SL_TRACE(logger,
                  "Gotten from state: finalized {}, justified {}",
-                 state.latest_finalized,
-                 state.latest_justified);
-        last_finalized_block_index = {state.latest_finalized.slot,
-                                      state.latest_finalized.root};
-        last_justified_block_index = {state.latest_justified.slot,
-                                      state.latest_justified.root};
+                 checkpoints.finalized,
+                 checkpoints.justified);
+        last_finalized_block_index = {checkpoints.finalized.slot,
+                                      checkpoints.finalized.root};
+        last_justified_block_index = {checkpoints.justified.slot,
+                                      checkpoints.justified.root};
         break;
       }
-      SL_WARN(logger,
-              "State not found for block {}: {}",
-              block_index,
-              state_res.error());
+      SL_WARN(logger, "State not found for block {}", block_index);
     }
 
     // Get its header
@@ -229,6 +228,31 @@ namespace lean::blockchain {
             last_known_block,
             last_finalized_block_index);
 
+    // Index non-finalized headers by single pass over storage, instead of
+    // reading them one by one while walking back from leaves
+    auto headers_res =
+        storage->getBlockHeadersFromSlot(last_finalized_block_index.slot);
+    if (headers_res.has_error()) {
+      SL_CRITICAL(logger,
+                  "Failed to load non-finalized block headers: {}",
+                  headers_res.error());
+      qtils::raise(headers_res.error());
+    }
+    std::unordered_map<BlockHash, BlockHeader> headers;
+    headers.reserve(headers_res.value().size());
+    for (auto &header : headers_res.value()) {
+      auto hash = header.hash();
+      headers.emplace(hash, std::move(header));
+    }
+    // Blocks below finalized slot are rarely visited, e.g. on dead forks
+    auto get_header =
+        [&](const BlockHash &hash) -> outcome::result<BlockHeader> {
+      if (auto it = headers.find(hash); it != headers.end()) {
+        return it->second;
+      }
+      return storage->getBlockHeader(hash);
+    };
+
     // Load non-finalized block from block storage
     std::map<BlockIndex, BlockHeader> collected;
 
@@ -251,7 +275,7 @@ namespace lean::blockchain {
             break;
           }
 
-          auto header_res = storage->getBlockHeader(block_hash);
+          auto header_res = get_header(block_hash);
           if (header_res.has_error()) {
             SL_CRITICAL(
                 logger,
@@ -283,13 +307,13 @@ namespace lean::blockchain {
             for (;;) {
               dead.emplace(fork);
 
-              auto f_res = storage->getBlockHeader(fork.hash);
+              auto f_res = get_header(fork.hash);
               if (f_res.has_error()) {
                 break;
               }
               const auto &fork_header = f_res.value();
 
-              auto m_res = storage->getBlockHeader(main.hash);
+              auto m_res = get_header(main.hash);
               if (m_res.has_error()) {
                 break;
               }
@@ -0,0 +1,68 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/impl/block_value_codec.hpp"
+
+#include <algorithm>
+
+#include <snappy.h>
+
+#include "blockchain/block_storage_error.hpp"
+
+namespace lean::blockchain {
+
+  namespace {
+    constexpr size_t kMarkerSize = 4;
+    /// Bodies and signatures are far below wire message limit
+    constexpr size_t kMaxUncompressedSize = size_t{16} << 20;
+
+    bool isCompressed(qtils::BytesIn stored) {
+      return stored.size() >= kMarkerSize
+         and std::ranges::all_of(stored.first(kMarkerSize),
+                                 [](uint8_t byte) { return byte == 0; });
+    }
+  }  // namespace
+
+  qtils::ByteVec BlockValueCodec::encode(qtils::ByteVec encoded) const {
+    if (not compress_) {
+      return encoded;
+    }
+    qtils::ByteVec stored(kMarkerSize
+                          + ::snappy::MaxCompressedLength(encoded.size()));
+    size_t size = 0;
+    ::snappy::RawCompress(reinterpret_cast<const char *>(encoded.data()),
+                          encoded.size(),
+                          reinterpret_cast<char *>(stored.data() + kMarkerSize),
+                          &size);
+    // Incompressible value, e.g. only signatures, is kept as is
+    if (kMarkerSize + size >= encoded.size()) {
+      return encoded;
+    }
+    stored.resize(kMarkerSize + size);
+    return stored;
+  }
+
+  outcome::result<qtils::BytesIn> BlockValueCodec::decode(
+      qtils::BytesIn stored, qtils::ByteVec &buffer) {
+    if (not isCompressed(stored)) {
+      return stored;
+    }
+    auto compressed = stored.subspan(kMarkerSize);
+    auto data = reinterpret_cast<const char *>(compressed.data());
+    size_t size = 0;
+    if (not ::snappy::GetUncompressedLength(data, compressed.size(), &size)
+        or size > kMaxUncompressedSize) {
+      return BlockStorageError::INCONSISTENT_DATA;
+    }
+    buffer.resize(size);
+    if (not ::snappy::RawUncompress(
+            data, compressed.size(), reinterpret_cast<char *>(buffer.data()))) {
+      return BlockStorageError::INCONSISTENT_DATA;
+    }
+    return qtils::BytesIn{buffer};
+  }
+
+}  // namespace lean::blockchain
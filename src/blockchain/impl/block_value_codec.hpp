@@ -0,0 +1,40 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <qtils/byte_vec.hpp>
+#include <qtils/outcome.hpp>
+
+namespace lean::blockchain {
+
+  /**
+   * Encoding of block bodies and signatures in database.
+   *
+   * Values are stored either as SSZ, or snappy compressed like on wire,
+   * behind marker of four zero bytes. SSZ of these containers starts with
+   * offset of their first variable field, which is never zero, so both
+   * encodings are read regardless of setting they were written with.
+   */
+  class BlockValueCodec {
+   public:
+    explicit BlockValueCodec(bool compress) : compress_{compress} {}
+
+    /// Value to store for SSZ encoded block part
+    qtils::ByteVec encode(qtils::ByteVec encoded) const;
+
+    /**
+     * SSZ encoded block part of stored value.
+     * @param buffer holds result if value is compressed
+     */
+    static outcome::result<qtils::BytesIn> decode(qtils::BytesIn stored,
+                                                  qtils::ByteVec &buffer);
+
+   private:
+    bool compress_;
+  };
+
+}  // namespace lean::blockchain
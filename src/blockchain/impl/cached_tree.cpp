@@ -6,141 +6,176 @@
 
 #include "blockchain/impl/cached_tree.hpp"
 
+#include <algorithm>
 #include <deque>
+#include <functional>
 #include <ranges>
 #include <set>
 
-#include <qtils/shared_ref.hpp>
+#include <boost/assert.hpp>
 
 namespace lean::blockchain {
   bool Reorg::empty() const {
     return revert.empty() and apply.empty();
   }
 
-  TreeNode::TreeNode(const BlockIndex &info) : index{info} {}
-
-  TreeNode::TreeNode(const BlockIndex &info,
-                     const qtils::SharedRef<TreeNode> &parent)
-      : index{info},
-        weak_parent{std::shared_ptr<TreeNode>(parent)},
-        depth(parent->depth + 1),
-        reverted{parent->reverted} {}
-
-  std::shared_ptr<TreeNode> TreeNode::parent() const {
-    return weak_parent.lock();
-  }
-
-  void TreeNode::detach() {
-    return weak_parent.reset();
-  }
-
   BlockWeight TreeNode::weight() const {
     return index.slot;
   }
 
-  Reorg reorg(qtils::SharedRef<TreeNode> from, qtils::SharedRef<TreeNode> to) {
+  /// Nodes ordered from highest slot
+  using Candidates = std::set<std::pair<Slot, TreeNodeId>, std::greater<>>;
+
+  // `nodes_.at(TreeNode::kNoParent)` throws, when walk passes finalized root
+
+  Reorg CachedTree::reorg(TreeNodeId from, TreeNodeId to) const {
     Reorg reorg;
     while (from != to) {
-      if (from->index.slot > to->index.slot) {
-        reorg.revert.emplace_back(from->index);
-        from = from->parent();
-        [[unlikely]] if (not from) { throw std::bad_weak_ptr{}; }
-
+      auto &from_node = nodes_.at(from);
+      auto &to_node = nodes_.at(to);
+      if (from_node.index.slot > to_node.index.slot) {
+        reorg.revert.emplace_back(from_node.index);
+        from = from_node.parent;
       } else {
-        reorg.apply.emplace_back(to->index);
-        to = to->parent();
-        [[unlikely]] if (not from) { throw std::bad_weak_ptr{}; }
+        reorg.apply.emplace_back(to_node.index);
+        to = to_node.parent;
       }
     }
-    reorg.common = to->index;
+    reorg.common = nodes_.at(to).index;
     std::ranges::reverse(reorg.apply);
     return reorg;
   }
 
   template <typename F>
-  bool descend(qtils::SharedRef<TreeNode> from,
-               const qtils::SharedRef<TreeNode> &to,
-               const F &f) {
+  bool CachedTree::descend(TreeNodeId from,
+                           TreeNodeId to,
+                           const F &f) const {
+    auto to_slot = nodes_.at(to).index.slot;
     while (from != to) {
-      if (from->index.slot <= to->index.slot) {
+      auto &node = nodes_.at(from);
+      if (node.index.slot <= to_slot) {
         return false;
       }
-      f(from);
-      from = from->parent();
-      [[unlikely]] if (not from) { throw std::bad_weak_ptr{}; }
+      f(node);
+      from = node.parent;
     }
     return true;
   }
 
-  bool canDescend(const qtils::SharedRef<TreeNode> &from,
-                  const qtils::SharedRef<TreeNode> &to) {
-    return descend(from, to, [](const qtils::SharedRef<TreeNode> &) {});
+  bool CachedTree::canDescend(TreeNodeId from, TreeNodeId to) const {
+    auto to_depth = nodes_.at(to).depth;
+    if (nodes_.at(from).depth < to_depth) {
+      return false;
+    }
+    return ancestorAtDepth(from, to_depth) == to;
   }
 
-  bool CachedTree::chooseBest(const qtils::SharedRef<TreeNode> &node) {
-    if (node->reverted) {
+  TreeNodeId CachedTree::childJump(TreeNodeId parent) const {
+    // Two consecutive jumps of same length are merged into one longer jump
+    auto &node = nodes_.at(parent);
+    auto &jump = nodes_[node.jump];
+    if (node.depth - jump.depth == jump.depth - nodes_[jump.jump].depth) {
+      return jump.jump;
+    }
+    return parent;
+  }
+
+  std::optional<TreeNodeId> CachedTree::ancestorAtSlot(TreeNodeId id,
+                                                       Slot slot) const {
+    if (nodes_[root_].index.slot > slot) {
+      return std::nullopt;
+    }
+    // Slots strictly decrease towards root, which is not above `slot`
+    while (nodes_.at(id).index.slot > slot) {
+      auto &node = nodes_[id];
+      id = nodes_[node.jump].index.slot > slot ? node.jump : node.parent;
+    }
+    return id;
+  }
+
+  TreeNodeId CachedTree::ancestorAtDepth(TreeNodeId id, uint32_t depth) const {
+    BOOST_ASSERT(depth >= nodes_[root_].depth);
+    while (nodes_.at(id).depth > depth) {
+      auto &node = nodes_[id];
+      id = nodes_[node.jump].depth >= depth ? node.jump : node.parent;
+    }
+    return id;
+  }
+
+  TreeNodeId CachedTree::commonAncestor(TreeNodeId lhs, TreeNodeId rhs) const {
+    auto depth = std::min(nodes_.at(lhs).depth, nodes_.at(rhs).depth);
+    lhs = ancestorAtDepth(lhs, depth);
+    rhs = ancestorAtDepth(rhs, depth);
+    // Jump length depends only on depth, so both sides jump in step
+    while (lhs != rhs) {
+      auto &lhs_node = nodes_[lhs];
+      auto &rhs_node = nodes_[rhs];
+      if (lhs_node.jump != rhs_node.jump) {
+        lhs = lhs_node.jump;
+        rhs = rhs_node.jump;
+      } else {
+        lhs = lhs_node.parent;
+        rhs = rhs_node.parent;
+      }
+    }
+    return lhs;
+  }
+
+  bool CachedTree::chooseBest(TreeNodeId id) {
+    auto &node = nodes_.at(id);
+    if (node.reverted) {
       return false;
     }
-    BOOST_ASSERT(not best_->reverted);
-    if (node->weight() > best_->weight()) {
-      best_ = node;
+    BOOST_ASSERT(not nodes_[best_].reverted);
+    if (node.weight() > nodes_[best_].weight()) {
+      best_ = id;
       return true;
     }
     return false;
   }
 
-  struct Cmp {
-    bool operator()(const qtils::SharedRef<TreeNode> &lhs,
-                    const qtils::SharedRef<TreeNode> &rhs) const {
-      BOOST_ASSERT(lhs and rhs);
-      return rhs->index.slot < lhs->index.slot;
-    }
-  };
-
   void CachedTree::forceRefreshBest() {
-    std::set<qtils::SharedRef<TreeNode>, Cmp> candidates;
+    Candidates candidates;
     for (const auto &key : leaves_ | std::views::keys) {
-      auto node = find(key);
-      BOOST_ASSERT(node.has_value());
-      candidates.emplace(std::move(node.value()));
+      auto id = ids_.at(key);
+      candidates.emplace(nodes_[id].index.slot, id);
     }
 
     best_ = root_;
     while (not candidates.empty()) {
-      auto node = candidates.extract(candidates.begin());
-      BOOST_ASSERT(not node.empty());
+      auto id = candidates.begin()->second;
+      candidates.erase(candidates.begin());
 
-      auto &tree_node = node.value();
-      if (tree_node->reverted) {
-        if (auto parent = tree_node->parent()) {
-          candidates.emplace(std::move(parent));
+      auto &node = nodes_[id];
+      if (node.reverted) {
+        if (node.parent != TreeNode::kNoParent) {
+          candidates.emplace(nodes_[node.parent].index.slot, node.parent);
         }
         continue;
       }
 
-      if (best_->weight() < tree_node->weight()) {
-        best_ = tree_node;
+      if (nodes_[best_].weight() < node.weight()) {
+        best_ = id;
       }
     }
   }
 
   CachedTree::CachedTree(const BlockIndex &root)
-      : root_{std::make_shared<TreeNode>(root)},
-        justified_(root_),
-        best_{root_},
-        nodes_{{root.hash, root_}} {
+      : nodes_{TreeNode{.index = root}},
+        justified_{root},
+        ids_{{root.hash, root_}} {
     leaves_.emplace(root.hash, root.slot);
   }
 
   BlockIndex CachedTree::finalized() const {
-    return root_->index;
+    return nodes_[root_].index;
   }
   BlockIndex CachedTree::justified() const {
-    return justified_->index;;
+    return justified_;
   }
 
   BlockIndex CachedTree::best() const {
-    return best_->index;
+    return nodes_[best_].index;
   }
 
   size_t CachedTree::leafCount() const {
@@ -170,115 +205,140 @@ namespace lean::blockchain {
     return leaves_.contains(hash);
   }
 
-  BlockIndex CachedTree::bestWith(
-      const qtils::SharedRef<TreeNode> &required) const {
-    std::set<qtils::SharedRef<TreeNode>, Cmp> candidates;
+  BlockIndex CachedTree::bestWith(TreeNodeId required) const {
+    Candidates candidates;
     for (const auto &leaf : leaves_ | std::views::keys) {
-      auto node_opt = find(leaf);
-      BOOST_ASSERT(node_opt.has_value());
-      candidates.emplace(std::move(node_opt.value()));
+      auto id = ids_.at(leaf);
+      candidates.emplace(nodes_[id].index.slot, id);
     }
+    auto required_slot = nodes_.at(required).index.slot;
     auto best = required;
     while (not candidates.empty()) {
-      auto _node = candidates.extract(candidates.begin());
-      auto &node = _node.value();
-      if (node->index.slot <= required->index.slot) {
+      auto id = candidates.begin()->second;
+      candidates.erase(candidates.begin());
+      auto &node = nodes_[id];
+      if (node.index.slot <= required_slot) {
         continue;
       }
-      if (node->reverted) {
-        if (auto parent = node->parent()) {
-          candidates.emplace(std::move(parent));
+      if (node.reverted) {
+        if (node.parent != TreeNode::kNoParent) {
+          candidates.emplace(nodes_[node.parent].index.slot, node.parent);
         }
         continue;
       }
-      if (node->weight() > best->weight()) {
-        if (canDescend(node, required)) {
-          best = node;
+      if (node.weight() > nodes_[best].weight()) {
+        if (canDescend(id, required)) {
+          best = id;
         }
       }
     }
-    return best->index;
+    return nodes_[best].index;
   }
 
-  std::optional<qtils::SharedRef<TreeNode>> CachedTree::find(
-      const BlockHash &hash) const {
-    if (auto it = nodes_.find(hash); it != nodes_.end()) {
+  std::optional<TreeNodeId> CachedTree::find(const BlockHash &hash) const {
+    if (auto it = ids_.find(hash); it != ids_.end()) {
       return it->second;
     }
     return std::nullopt;
   }
 
-  std::optional<Reorg> CachedTree::add(
-      const qtils::SharedRef<TreeNode> &new_node) {
-    if (nodes_.contains(new_node->index.hash)) {
+  const TreeNode &CachedTree::node(TreeNodeId id) const {
+    return nodes_.at(id);
+  }
+
+  std::optional<TreeNodeId> CachedTree::parent(TreeNodeId id) const {
+    auto parent = nodes_.at(id).parent;
+    if (parent == TreeNode::kNoParent) {
+      return std::nullopt;
+    }
+    return parent;
+  }
+
+  std::optional<Reorg> CachedTree::add(const BlockIndex &index,
+                                       const StateRoot &state_root,
+                                       TreeNodeId parent) {
+    if (ids_.contains(index.hash)) {
       return std::nullopt;
     }
-    BOOST_ASSERT(new_node->children.empty());
-    auto parent = new_node->parent();
-    [[unlikely]] if (not parent) { throw std::bad_weak_ptr{}; }
-    BOOST_ASSERT(not std::ranges::contains(parent->children, new_node));
-
-    new_node->depth = parent->depth + 1;
-
-    parent->children.emplace_back(new_node);
-    nodes_.emplace(new_node->index.hash, new_node);
-    leaves_.erase(parent->index.hash);
-    leaves_.emplace(new_node->index.hash, new_node->index.slot);
-    if (not new_node->reverted and new_node->weight() > best_->weight()) {
+    TreeNode new_node{
+        .index = index,
+        .state_root = state_root,
+        .parent = parent,
+        .jump = childJump(parent),
+        .depth = nodes_.at(parent).depth + 1,
+        .reverted = nodes_[parent].reverted,
+    };
+    TreeNodeId id;
+    if (free_.empty()) {
+      id = static_cast<TreeNodeId>(nodes_.size());
+      nodes_.emplace_back(std::move(new_node));
+    } else {
+      id = free_.back();
+      free_.pop_back();
+      nodes_[id] = std::move(new_node);
+    }
+
+    // Taken after `emplace_back`, which may reallocate arena
+    auto &parent_node = nodes_[parent];
+    BOOST_ASSERT(not std::ranges::contains(parent_node.children, id));
+    parent_node.children.emplace_back(id);
+    ids_.emplace(index.hash, id);
+    leaves_.erase(parent_node.index.hash);
+    leaves_.emplace(index.hash, index.slot);
+    if (not nodes_[id].reverted
+        and nodes_[id].weight() > nodes_[best_].weight()) {
       auto old_best = best_;
-      best_ = new_node;
+      best_ = id;
       return reorg(old_best, best_);
     }
     return std::nullopt;
   }
 
-  ReorgAndPrune CachedTree::finalize(
-      const qtils::SharedRef<TreeNode> &new_finalized) {
-    BOOST_ASSERT(new_finalized->index.slot >= root_->index.slot);
+  ReorgAndPrune CachedTree::finalize(TreeNodeId new_finalized) {
+    BOOST_ASSERT(nodes_.at(new_finalized).index.slot
+                 >= nodes_[root_].index.slot);
     if (new_finalized == root_) {
       return {};
     }
-    BOOST_ASSERT(new_finalized->parent());
+    BOOST_ASSERT(nodes_[new_finalized].parent != TreeNode::kNoParent);
     ReorgAndPrune changes;
     if (not canDescend(best_, new_finalized)) {
       changes.reorg = reorg(best_, new_finalized);
     }
-    std::deque<std::shared_ptr<TreeNode>> queue;
-    for (std::shared_ptr<TreeNode> finalized_child = new_finalized,
-                                   parent = finalized_child->parent();
-         parent;
-         finalized_child = parent, parent = parent->parent()) {
-      for (auto &child : parent->children) {
+    std::deque<TreeNodeId> queue;
+    for (TreeNodeId finalized_child = new_finalized,
+                    parent = nodes_[finalized_child].parent;
+         parent != TreeNode::kNoParent;
+         finalized_child = parent, parent = nodes_[parent].parent) {
+      for (auto child : nodes_[parent].children) {
         if (child == finalized_child) {
           continue;
         }
         queue.emplace_back(child);
       }
-      parent->children.clear();
-      nodes_.erase(parent->index.hash);
+      ids_.erase(nodes_[parent].index.hash);
     }
     while (not queue.empty()) {
-      auto parent = std::move(queue.front());
+      auto &node = nodes_[queue.front()];
       queue.pop_front();
-      changes.prune.emplace_back(parent->index);
-      for (auto &child : parent->children) {
+      changes.prune.emplace_back(node.index);
+      for (auto child : node.children) {
         queue.emplace_back(child);
       }
-      if (parent->children.empty()) {
-        leaves_.erase(parent->index.hash);
+      if (node.children.empty()) {
+        leaves_.erase(node.index.hash);
       }
-      parent->children.clear();
-      nodes_.erase(parent->index.hash);
+      ids_.erase(node.index.hash);
     }
     std::ranges::reverse(changes.prune);
     root_ = new_finalized;
-    root_->detach();
+    nodes_[root_].parent = TreeNode::kNoParent;
     if (changes.reorg) {
       forceRefreshBest();
       size_t offset = changes.reorg->apply.size();
-      [[maybe_unused]] auto ok = descend(
-          best_, new_finalized, [&](const std::shared_ptr<TreeNode> &node) {
-            changes.reorg->apply.emplace_back(node->index);
+      [[maybe_unused]] auto ok =
+          descend(best_, new_finalized, [&](const TreeNode &node) {
+            changes.reorg->apply.emplace_back(node.index);
           });
       BOOST_ASSERT(ok);
       std::reverse(
@@ -286,39 +346,73 @@ namespace lean::blockchain {
           changes.reorg->apply.begin() + offset,
           changes.reorg->apply.end());
     }
+    compact();
     return changes;
   }
 
-  void CachedTree::setJustified(
-      const qtils::SharedRef<TreeNode> &new_justified) {
-    justified_ = new_justified;
+  void CachedTree::compact() {
+    std::vector<TreeNode> nodes;
+    nodes.reserve(ids_.size());
+    std::vector<TreeNodeId> new_ids(nodes_.size(), TreeNode::kNoParent);
+    new_ids[root_] = 0;
+    nodes.emplace_back(std::move(nodes_[root_]));
+    nodes.back().jump = 0;
+    // Breadth-first, so parent is already moved when its children are
+    for (TreeNodeId id = 0; id < nodes.size(); ++id) {
+      for (size_t i = 0; i < nodes[id].children.size(); ++i) {
+        auto old_child = nodes[id].children[i];
+        auto child = static_cast<TreeNodeId>(nodes.size());
+        new_ids[old_child] = child;
+        nodes.emplace_back(std::move(nodes_[old_child]));
+        nodes.back().parent = id;
+        nodes[id].children[i] = child;
+      }
+    }
+    BOOST_ASSERT(nodes.size() == ids_.size());
+    for (auto &id : ids_ | std::views::values) {
+      id = new_ids[id];
+    }
+    root_ = 0;
+    best_ = new_ids[best_];
+    BOOST_ASSERT(best_ != TreeNode::kNoParent);
+    nodes_ = std::move(nodes);
+    free_.clear();
+    // Jumps may point above new root, rebuild them from root in same order
+    for (TreeNodeId id = 1; id < nodes_.size(); ++id) {
+      nodes_[id].jump = childJump(nodes_[id].parent);
+    }
+  }
+
+  void CachedTree::setJustified(TreeNodeId new_justified) {
+    justified_ = nodes_.at(new_justified).index;
   }
 
   ReorgAndPrune CachedTree::removeLeaf(const BlockHash &hash) {
     ReorgAndPrune changes;
-    auto node_it = nodes_.find(hash);
-    BOOST_ASSERT(node_it != nodes_.end());
-    auto &node = node_it->second;
-    BOOST_ASSERT(node);
+    auto id_it = ids_.find(hash);
+    BOOST_ASSERT(id_it != ids_.end());
+    auto id = id_it->second;
     auto leaf_it = leaves_.find(hash);
     BOOST_ASSERT(leaf_it != leaves_.end());
-    BOOST_ASSERT(node->children.empty());
-    auto parent = node->parent();
-    [[unlikely]] if (not parent) { throw std::bad_weak_ptr{}; }
-    auto child_it = std::ranges::find(parent->children, node);
-    BOOST_ASSERT(child_it != parent->children.end());
-    changes.prune.emplace_back(node->index);
-    parent->children.erase(child_it);
-    if (parent->children.empty()) {
-      leaves_.emplace(parent->index.hash, parent->index.slot);
-    }
+    auto &node = nodes_[id];
+    BOOST_ASSERT(node.children.empty());
+    auto &parent = nodes_.at(node.parent);
+    auto child_it = std::ranges::find(parent.children, id);
+    BOOST_ASSERT(child_it != parent.children.end());
+    changes.prune.emplace_back(node.index);
+    parent.children.erase(child_it);
+    // Erase first, emplace into flat map invalidates iterators
     leaves_.erase(leaf_it);
-    if (node == best_) {
-      auto old_best = node;
+    ids_.erase(id_it);
+    if (parent.children.empty()) {
+      leaves_.emplace(parent.index.hash, parent.index.slot);
+    }
+    if (id == best_) {
       forceRefreshBest();
-      changes.reorg = reorg(old_best, best_);
+      changes.reorg = reorg(id, best_);
     }
-    nodes_.erase(node_it);
+    nodes_[id] = {};
+    free_.emplace_back(id);
     return changes;
   }
 
@@ -327,18 +421,17 @@ namespace lean::blockchain {
     if (best_ != root_) {
       changes.reorg = reorg(best_, root_);
     }
-    std::deque<std::shared_ptr<TreeNode>> queue{root_};
+    std::deque<TreeNodeId> queue{root_};
     while (not queue.empty()) {
-      auto parent = std::move(queue.front());
+      auto parent = queue.front();
       queue.pop_front();
-      for (auto &child : parent->children) {
-        changes.prune.emplace_back(child->index);
+      for (auto child : nodes_[parent].children) {
+        changes.prune.emplace_back(nodes_[child].index);
         queue.emplace_back(child);
       }
-      parent->children.clear();
     }
     std::ranges::reverse(changes.prune);
-    *this = CachedTree{root_->index};
+    *this = CachedTree{nodes_[root_].index};
     return changes;
   }
 }  // namespace lean::blockchain
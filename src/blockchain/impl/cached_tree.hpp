@@ -6,13 +6,26 @@
 
 #pragma once
 
-#include <qtils/shared_ref.hpp>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <tuple>
+#include <vector>
 
+#include "types/block_hash_map.hpp"
 #include "types/block_index.hpp"
+#include "types/types.hpp"
 
 namespace lean::blockchain {
   using BlockWeight = std::tuple<Slot>;
 
+  /**
+   * Position of node in `CachedTree` arena.
+   * Ids are renumbered when tree is finalized, so they must not be kept
+   * across `CachedTree::finalize` calls.
+   */
+  using TreeNodeId = uint32_t;
+
   /**
    * Used to update hashes of best chain by number.
    */
@@ -38,35 +51,35 @@ namespace lean::blockchain {
    * convenience - we would only ask the database for some info, when directly
    * requested
    */
-  class TreeNode {
-   public:
-    explicit TreeNode(const BlockIndex &info);
-    TreeNode(const BlockIndex &info, const qtils::SharedRef<TreeNode> &parent);
+  struct TreeNode {
+    static constexpr TreeNodeId kNoParent =
+        std::numeric_limits<TreeNodeId>::max();
 
-    [[nodiscard]] std::shared_ptr<TreeNode> parent() const;
-    void detach();
     [[nodiscard]] BlockWeight weight() const;
 
-    const BlockIndex index;
-
-   private:
-    std::weak_ptr<TreeNode> weak_parent;
-
-   public:
+    BlockIndex index;
+    StateRoot state_root{};
+    TreeNodeId parent = kNoParent;
+    /// Skip pointer to ancestor, root points to itself
+    TreeNodeId jump = 0;
     uint32_t depth = 0;
-    bool contains_approved_para_block = false;
     bool reverted = false;  // TODO Looks like actually unused
 
-    std::vector<qtils::SharedRef<TreeNode>> children{};
+    std::vector<TreeNodeId> children{};
   };
 
-  Reorg reorg(qtils::SharedRef<TreeNode> from, qtils::SharedRef<TreeNode> to);
-
-  bool canDescend(const qtils::SharedRef<TreeNode> &from,
-                  const qtils::SharedRef<TreeNode> &to);
-
   /**
-   * Non-finalized part of the block tree
+   * Non-finalized part of the block tree.
+   *
+   * Nodes are stored in single arena and reference each other by id, so
+   * ancestor walks don't touch reference counters or allocator.
+   * Nodes carry slot, parent and state root, so non-finalized ancestors are
+   * walked without reading headers from storage.
+   * Finalization drops pruned nodes and compacts arena.
+   *
+   * Each node also keeps skew-binary jump pointer (Myers, "An applicative
+   * random-access stack"), so ancestor and common ancestor queries take
+   * O(log depth) steps instead of walking parents one by one.
    */
   class CachedTree {
    public:
@@ -79,13 +92,20 @@ namespace lean::blockchain {
     [[nodiscard]] std::vector<BlockHash> leafHashes() const;
     [[nodiscard]] std::vector<BlockIndex> leafInfo() const;
     [[nodiscard]] bool isLeaf(const BlockHash &hash) const;
-    [[nodiscard]] BlockIndex bestWith(
-        const qtils::SharedRef<TreeNode> &required) const;
-    [[nodiscard]] std::optional<qtils::SharedRef<TreeNode>> find(
-        const BlockHash &hash) const;
-    std::optional<Reorg> add(const qtils::SharedRef<TreeNode> &new_node);
-    ReorgAndPrune finalize(const qtils::SharedRef<TreeNode> &new_finalized);
-    void setJustified(const qtils::SharedRef<TreeNode> &new_justified);
+    [[nodiscard]] BlockIndex bestWith(TreeNodeId required) const;
+    [[nodiscard]] std::optional<TreeNodeId> find(const BlockHash &hash) const;
+
+    /// Node reference is invalidated by any tree modification
+    [[nodiscard]] const TreeNode &node(TreeNodeId id) const;
+
+    /// Parent of node, nullopt for finalized root
+    [[nodiscard]] std::optional<TreeNodeId> parent(TreeNodeId id) const;
+
+    std::optional<Reorg> add(const BlockIndex &index,
+                             const StateRoot &state_root,
+                             TreeNodeId parent);
+    ReorgAndPrune finalize(TreeNodeId new_finalized);
+    void setJustified(TreeNodeId new_justified);
 
     /**
      * Can't remove finalized root.
@@ -100,17 +120,49 @@ namespace lean::blockchain {
     /// Force find and update the actual best block
     void forceRefreshBest();
 
+    [[nodiscard]] Reorg reorg(TreeNodeId from, TreeNodeId to) const;
+
+    /// `to` is ancestor of `from` or same node
+    [[nodiscard]] bool canDescend(TreeNodeId from, TreeNodeId to) const;
+
+    /**
+     * Ancestor of node, or node itself, with greatest slot not above `slot`.
+     * @return nullopt if finalized root is above `slot`
+     */
+    [[nodiscard]] std::optional<TreeNodeId> ancestorAtSlot(TreeNodeId id,
+                                                           Slot slot) const;
+
+    /// Ancestor of node, or node itself, at `depth`, not below root depth
+    [[nodiscard]] TreeNodeId ancestorAtDepth(TreeNodeId id,
+                                             uint32_t depth) const;
+
+    /// Lowest common ancestor of two nodes
+    [[nodiscard]] TreeNodeId commonAncestor(TreeNodeId lhs,
+                                            TreeNodeId rhs) const;
+
    private:
+    template <typename F>
+    bool descend(TreeNodeId from, TreeNodeId to, const F &f) const;
+
     /**
      * Compare node weight with best and replace if heavier.
      * @return true if heavier and replaced.
      */
-    bool chooseBest(const qtils::SharedRef<TreeNode> &node);
-
-    qtils::SharedRef<TreeNode> root_;
-    qtils::SharedRef<TreeNode> justified_;
-    qtils::SharedRef<TreeNode> best_;
-    std::unordered_map<BlockHash, qtils::SharedRef<TreeNode>> nodes_;
-    std::unordered_map<BlockHash, Slot> leaves_;
+    bool chooseBest(TreeNodeId id);
+
+    /// Jump pointer for child of `parent`
+    [[nodiscard]] TreeNodeId childJump(TreeNodeId parent) const;
+
+    /// Keep only root and its descendants, renumbered in breadth-first order
+    void compact();
+
+    std::vector<TreeNode> nodes_;
+    /// Slots of removed leaves, reused by `add` until next compaction
+    std::vector<TreeNodeId> free_;
+    TreeNodeId root_ = 0;
+    TreeNodeId best_ = 0;
+    BlockIndex justified_;
+    BlockHashMap<TreeNodeId> ids_;
+    BlockHashMap<Slot> leaves_;
   };
 }  // namespace lean::blockchain
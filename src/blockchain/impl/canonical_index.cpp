@@ -0,0 +1,96 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/impl/canonical_index.hpp"
+
+#include <algorithm>
+
+#include <boost/assert.hpp>
+
+namespace lean::blockchain {
+  CanonicalIndex::CanonicalIndex(const BlockIndex &finalized)
+      : first_slot_{finalized.slot}, hashes_{finalized.hash} {}
+
+  void CanonicalIndex::reorg(std::span<const BlockIndex> revert,
+                             std::span<const BlockIndex> apply) {
+    for (auto &block : revert) {
+      if (covers(block.slot) and get(block.slot) == block.hash) {
+        hashes_[block.slot - first_slot_].reset();
+      }
+    }
+    for (auto &block : apply) {
+      if (block.slot < first_slot_) {
+        continue;
+      }
+      auto offset = block.slot - first_slot_;
+      if (offset >= hashes_.size()) {
+        hashes_.resize(offset + 1);
+      }
+      hashes_[offset] = block.hash;
+    }
+    trim();
+  }
+
+  void CanonicalIndex::finalize(const BlockIndex &finalized) {
+    if (finalized.slot < first_slot_) {
+      *this = CanonicalIndex{finalized};
+      return;
+    }
+    auto drop = std::min<size_t>(finalized.slot - first_slot_, hashes_.size());
+    hashes_.erase(hashes_.begin(),
+                  hashes_.begin() + static_cast<ptrdiff_t>(drop));
+    first_slot_ = finalized.slot;
+    if (hashes_.empty()) {
+      hashes_.resize(1);
+    }
+    hashes_.front() = finalized.hash;
+    trim();
+  }
+
+  void CanonicalIndex::rebuild(const CachedTree &tree) {
+    auto finalized = tree.finalized();
+    first_slot_ = finalized.slot;
+    hashes_.clear();
+    auto id = tree.find(tree.best().hash);
+    BOOST_ASSERT(id.has_value());
+    hashes_.resize(tree.best().slot - first_slot_ + 1);
+    for (; id.has_value(); id = tree.parent(*id)) {
+      auto &index = tree.node(*id).index;
+      hashes_[index.slot - first_slot_] = index.hash;
+    }
+  }
+
+  Slot CanonicalIndex::firstSlot() const {
+    return first_slot_;
+  }
+
+  std::optional<BlockIndex> CanonicalIndex::last() const {
+    if (not hashes_.back().has_value()) {
+      return std::nullopt;
+    }
+    return BlockIndex{
+        .slot = first_slot_ + hashes_.size() - 1,
+        .hash = hashes_.back().value(),
+    };
+  }
+
+  bool CanonicalIndex::covers(Slot slot) const {
+    return slot >= first_slot_ and slot - first_slot_ < hashes_.size();
+  }
+
+  std::optional<BlockHash> CanonicalIndex::get(Slot slot) const {
+    if (not covers(slot)) {
+      return std::nullopt;
+    }
+    return hashes_[slot - first_slot_];
+  }
+
+  void CanonicalIndex::trim() {
+    while (hashes_.size() > 1 and not hashes_.back().has_value()) {
+      hashes_.pop_back();
+    }
+  }
+}  // namespace lean::blockchain
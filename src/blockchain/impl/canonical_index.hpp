@@ -0,0 +1,57 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <deque>
+#include <optional>
+#include <span>
+
+#include "blockchain/impl/cached_tree.hpp"
+#include "types/block_index.hpp"
+
+namespace lean::blockchain {
+  /**
+   * Hashes of best chain blocks by slot, from finalized slot up to best
+   * slot, so canonical block at slot is found in O(1) without walking the
+   * tree or reading headers.
+   * Updated incrementally by reorgs of `CachedTree`, finalized slots are
+   * dropped from front, as slot-to-hash records of storage serve them.
+   */
+  class CanonicalIndex {
+   public:
+    explicit CanonicalIndex(const BlockIndex &finalized);
+
+    /// Unassign reverted blocks and assign applied ones
+    void reorg(std::span<const BlockIndex> revert,
+               std::span<const BlockIndex> apply);
+
+    /// Drop slots before new finalized block
+    void finalize(const BlockIndex &finalized);
+
+    /// Fill from best chain of tree, when reorgs didn't reach its best block
+    void rebuild(const CachedTree &tree);
+
+    /// First indexed slot, finalized one
+    [[nodiscard]] Slot firstSlot() const;
+
+    /// Highest indexed block, nullopt if finalized block was reverted
+    [[nodiscard]] std::optional<BlockIndex> last() const;
+
+    /// Whether `slot` is in indexed range
+    [[nodiscard]] bool covers(Slot slot) const;
+
+    /// @return nullopt if slot has no best chain block or is not indexed
+    [[nodiscard]] std::optional<BlockHash> get(Slot slot) const;
+
+   private:
+    /// Drop empty slots after last assigned one
+    void trim();
+
+    Slot first_slot_;
+    std::deque<std::optional<BlockHash>> hashes_;
+  };
+}  // namespace lean::blockchain
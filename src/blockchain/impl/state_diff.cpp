@@ -0,0 +1,151 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/impl/state_diff.hpp"
+
+#include <algorithm>
+
+#include "blockchain/block_storage_error.hpp"
+#include "serde/ssz_view.hpp"
+
+namespace lean::blockchain {
+
+  namespace {
+    void diffList(const auto &parent,
+                  const auto &list,
+                  uint64_t &keep,
+                  auto &tail) {
+      auto &from = parent.data();
+      auto &to = list.data();
+      keep = std::distance(from.begin(), std::ranges::mismatch(from, to).in1);
+      tail.data().assign(to.begin() + keep, to.end());
+    }
+
+    /// `to` is data of rebuilt list
+    outcome::result<void> patchList(const auto &parent,
+                                    uint64_t keep,
+                                    const auto &tail,
+                                    auto &to) {
+      auto &from = parent.data();
+      if (keep > from.size()) {
+        return BlockStorageError::INCONSISTENT_DATA;
+      }
+      to.clear();
+      to.reserve(keep + tail.size());
+      to.insert(to.end(), from.begin(), from.begin() + keep);
+      to.insert(to.end(), tail.data().begin(), tail.data().end());
+      return outcome::success();
+    }
+
+    /// Unchanged list is shared with parent state
+    template <typename T, size_t N>
+    outcome::result<void> patchList(const CowList<T, N> &parent,
+                                    uint64_t keep,
+                                    const auto &tail,
+                                    CowList<T, N> &list) {
+      if (keep == parent.size() and tail.size() == 0) {
+        list = parent;
+        return outcome::success();
+      }
+      return patchList(parent, keep, tail, list.mut().data());
+    }
+  }  // namespace
+
+  StateDiff makeStateDiff(const BlockHash &parent,
+                          uint64_t depth,
+                          const State &parent_state,
+                          const State &state) {
+    StateDiff diff{
+        .parent = parent,
+        .depth = depth,
+        .config = state.config,
+        .slot = state.slot,
+        .latest_block_header = state.latest_block_header,
+        .latest_justified = state.latest_justified,
+        .latest_finalized = state.latest_finalized,
+    };
+    diffList(parent_state.historical_block_hashes,
+             state.historical_block_hashes,
+             diff.historical_block_hashes_keep,
+             diff.historical_block_hashes_tail);
+    diffList(parent_state.justified_slots,
+             state.justified_slots,
+             diff.justified_slots_keep,
+             diff.justified_slots_tail);
+    diffList(parent_state.validators,
+             state.validators,
+             diff.validators_keep,
+             diff.validators_tail);
+    diffList(parent_state.justifications_roots,
+             state.justifications_roots,
+             diff.justifications_roots_keep,
+             diff.justifications_roots_tail);
+    diffList(parent_state.justifications_validators,
+             state.justifications_validators,
+             diff.justifications_validators_keep,
+             diff.justifications_validators_tail);
+    return diff;
+  }
+
+  outcome::result<State> applyStateDiff(const State &parent_state,
+                                        const StateDiff &diff) {
+    State state;
+    state.config = diff.config;
+    state.slot = diff.slot;
+    state.latest_block_header = diff.latest_block_header;
+    state.latest_justified = diff.latest_justified;
+    state.latest_finalized = diff.latest_finalized;
+    OUTCOME_TRY(patchList(parent_state.historical_block_hashes,
+                          diff.historical_block_hashes_keep,
+                          diff.historical_block_hashes_tail,
+                          state.historical_block_hashes));
+    OUTCOME_TRY(patchList(parent_state.justified_slots,
+                          diff.justified_slots_keep,
+                          diff.justified_slots_tail,
+                          state.justified_slots.data()));
+    OUTCOME_TRY(patchList(parent_state.validators,
+                          diff.validators_keep,
+                          diff.validators_tail,
+                          state.validators));
+    OUTCOME_TRY(patchList(parent_state.justifications_roots,
+                          diff.justifications_roots_keep,
+                          diff.justifications_roots_tail,
+                          state.justifications_roots));
+    OUTCOME_TRY(patchList(parent_state.justifications_validators,
+                          diff.justifications_validators_keep,
+                          diff.justifications_validators_tail,
+                          state.justifications_validators));
+    return state;
+  }
+
+  outcome::result<std::pair<Checkpoint, Checkpoint>> stateDiffCheckpoints(
+      qtils::BytesIn encoded_diff) {
+    using View = SszContainerView<17>;
+    static const View::FieldSizes sizes{
+        sizeof(BlockHash),
+        sizeof(uint64_t),
+        ssz::size(Config{}),
+        sizeof(Slot),
+        ssz::size(BlockHeader{}),
+        ssz::size(Checkpoint{}),
+        ssz::size(Checkpoint{}),
+        sizeof(uint64_t),
+        View::kVariable,
+        sizeof(uint64_t),
+        View::kVariable,
+        sizeof(uint64_t),
+        View::kVariable,
+        sizeof(uint64_t),
+        View::kVariable,
+        sizeof(uint64_t),
+        View::kVariable,
+    };
+    OUTCOME_TRY(view, View::make(encoded_diff, sizes));
+    return std::make_pair(view.fixedField<Checkpoint>(5),
+                          view.fixedField<Checkpoint>(6));
+  }
+
+}  // namespace lean::blockchain
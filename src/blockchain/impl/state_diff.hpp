@@ -0,0 +1,85 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <qtils/outcome.hpp>
+
+#include "types/state.hpp"
+
+namespace lean::blockchain {
+
+  /**
+   * Compact delta of block post-state against its parent post-state.
+   *
+   * Lists are stored as length of common prefix with parent list (`*_keep`)
+   * and remaining elements (`*_tail`). Between adjacent blocks lists are
+   * mostly appended to, so tails are short.
+   */
+  struct StateDiff : ssz::ssz_variable_size_container {
+    /// Block whose state this diff is based on
+    BlockHash parent;
+    /// Number of diffs from this one down to full snapshot
+    uint64_t depth;
+
+    Config config;
+    Slot slot;
+    BlockHeader latest_block_header;
+    Checkpoint latest_justified;
+    Checkpoint latest_finalized;
+
+    uint64_t historical_block_hashes_keep;
+    ssz::list<BlockHash, HISTORICAL_ROOTS_LIMIT> historical_block_hashes_tail;
+    uint64_t justified_slots_keep;
+    ssz::list<bool, HISTORICAL_ROOTS_LIMIT> justified_slots_tail;
+    uint64_t validators_keep;
+    Validators validators_tail;
+    uint64_t justifications_roots_keep;
+    ssz::list<BlockHash, HISTORICAL_ROOTS_LIMIT> justifications_roots_tail;
+    uint64_t justifications_validators_keep;
+    ssz::list<bool, HISTORICAL_ROOTS_LIMIT * VALIDATOR_REGISTRY_LIMIT>
+        justifications_validators_tail;
+
+    SSZ_CONT(parent,
+             depth,
+             config,
+             slot,
+             latest_block_header,
+             latest_justified,
+             latest_finalized,
+             historical_block_hashes_keep,
+             historical_block_hashes_tail,
+             justified_slots_keep,
+             justified_slots_tail,
+             validators_keep,
+             validators_tail,
+             justifications_roots_keep,
+             justifications_roots_tail,
+             justifications_validators_keep,
+             justifications_validators_tail);
+  };
+
+  /// Make diff which turns `parent_state` into `state`
+  StateDiff makeStateDiff(const BlockHash &parent,
+                          uint64_t depth,
+                          const State &parent_state,
+                          const State &state);
+
+  /**
+   * Rebuild state from parent state and diff.
+   * @return error if diff does not match parent state
+   */
+  outcome::result<State> applyStateDiff(const State &parent_state,
+                                        const StateDiff &diff);
+
+  /**
+   * Latest justified and finalized checkpoints of encoded diff, read from
+   * its fixed part without decoding list tails.
+   */
+  outcome::result<std::pair<Checkpoint, Checkpoint>> stateDiffCheckpoints(
+      qtils::BytesIn encoded_diff);
+
+}  // namespace lean::blockchain
@@ -0,0 +1,65 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/impl/state_snapshot.hpp"
+
+#include "serde/ssz_view.hpp"
+
+namespace lean::blockchain {
+
+  StateSnapshot makeStateSnapshot(const State &state,
+                                  const BlockHash &validators_root) {
+    StateSnapshot snapshot;
+    snapshot.config = state.config;
+    snapshot.slot = state.slot;
+    snapshot.latest_block_header = state.latest_block_header;
+    snapshot.latest_justified = state.latest_justified;
+    snapshot.latest_finalized = state.latest_finalized;
+    snapshot.historical_block_hashes = state.historical_block_hashes;
+    snapshot.justified_slots = state.justified_slots;
+    snapshot.validators_root = validators_root;
+    snapshot.justifications_roots = state.justifications_roots;
+    snapshot.justifications_validators = state.justifications_validators;
+    return snapshot;
+  }
+
+  State stateFromSnapshot(const StateSnapshot &snapshot,
+                          const ValidatorList &validators) {
+    State state;
+    state.config = snapshot.config;
+    state.slot = snapshot.slot;
+    state.latest_block_header = snapshot.latest_block_header;
+    state.latest_justified = snapshot.latest_justified;
+    state.latest_finalized = snapshot.latest_finalized;
+    state.historical_block_hashes = snapshot.historical_block_hashes;
+    state.justified_slots = snapshot.justified_slots;
+    state.validators = validators;
+    state.justifications_roots = snapshot.justifications_roots;
+    state.justifications_validators = snapshot.justifications_validators;
+    return state;
+  }
+
+  outcome::result<std::pair<Checkpoint, Checkpoint>> stateSnapshotCheckpoints(
+      qtils::BytesIn encoded_snapshot) {
+    using View = SszContainerView<10>;
+    static const View::FieldSizes sizes{
+        ssz::size(Config{}),
+        sizeof(Slot),
+        ssz::size(BlockHeader{}),
+        ssz::size(Checkpoint{}),
+        ssz::size(Checkpoint{}),
+        View::kVariable,
+        View::kVariable,
+        sizeof(BlockHash),
+        View::kVariable,
+        View::kVariable,
+    };
+    OUTCOME_TRY(view, View::make(encoded_snapshot, sizes));
+    return std::make_pair(view.fixedField<Checkpoint>(3),
+                          view.fixedField<Checkpoint>(4));
+  }
+
+}  // namespace lean::blockchain
@@ -0,0 +1,65 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <qtils/outcome.hpp>
+
+#include "types/state.hpp"
+
+namespace lean::blockchain {
+
+  using ValidatorList = decltype(State::validators);
+
+  /**
+   * Full state as stored in `Space::State`.
+   *
+   * Validators list, which is the largest part of state and rarely changes,
+   * is stored once in `Space::Subtree` by its hash tree root, and snapshot
+   * references it by root.
+   */
+  struct StateSnapshot : ssz::ssz_variable_size_container {
+    Config config;
+    Slot slot;
+    BlockHeader latest_block_header;
+    Checkpoint latest_justified;
+    Checkpoint latest_finalized;
+
+    decltype(State::historical_block_hashes) historical_block_hashes;
+    decltype(State::justified_slots) justified_slots;
+    /// Root of validators list in `Space::Subtree`
+    BlockHash validators_root;
+    decltype(State::justifications_roots) justifications_roots;
+    decltype(State::justifications_validators) justifications_validators;
+
+    SSZ_CONT(config,
+             slot,
+             latest_block_header,
+             latest_justified,
+             latest_finalized,
+             historical_block_hashes,
+             justified_slots,
+             validators_root,
+             justifications_roots,
+             justifications_validators);
+  };
+
+  /// Lists are shared with `state`
+  StateSnapshot makeStateSnapshot(const State &state,
+                                  const BlockHash &validators_root);
+
+  /// Lists are shared with `snapshot` and `validators`
+  State stateFromSnapshot(const StateSnapshot &snapshot,
+                          const ValidatorList &validators);
+
+  /**
+   * Latest justified and finalized checkpoints of encoded snapshot, read
+   * from its fixed part without decoding lists.
+   */
+  outcome::result<std::pair<Checkpoint, Checkpoint>> stateSnapshotCheckpoints(
+      qtils::BytesIn encoded_snapshot);
+
+}  // namespace lean::blockchain
@@ -0,0 +1,257 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/impl/storage_pruner.hpp"
+
+#include <ranges>
+
+#include "app/configuration.hpp"
+#include "app/state_manager.hpp"
+#include "blockchain/block_storage.hpp"
+#include "se/impl/subscription_manager.hpp"
+#include "se/subscription.hpp"
+#include "serde/serialization.hpp"
+#include "storage/predefined_keys.hpp"
+#include "storage/spaced_storage.hpp"
+#include "utils/thread_placement.hpp"
+
+namespace lean::blockchain {
+
+  StoragePruner::StoragePruner(
+      qtils::SharedRef<log::LoggingSystem> logsys,
+      qtils::SharedRef<app::StateManager> state_manager,
+      qtils::SharedRef<Subscription> se_manager,
+      qtils::SharedRef<app::Configuration> app_config,
+      qtils::SharedRef<BlockStorage> block_storage,
+      qtils::SharedRef<storage::SpacedStorage> storage)
+      : logger_(logsys->getLogger("Pruner", "block_storage")),
+        se_manager_(std::move(se_manager)),
+        block_storage_(std::move(block_storage)),
+        storage_(std::move(storage)),
+        retention_(app_config->database().state_retention),
+        archive_interval_(app_config->database().state_archive_interval) {
+    state_manager->takeControl(*this);
+  }
+
+  StoragePruner::~StoragePruner() {
+    stop();
+  }
+
+  void StoragePruner::prepare() {
+    on_block_finalized_ =
+        se::SubscriberCreator<qtils::Empty,
+                              std::shared_ptr<const messages::Finalized>>::
+            create<EventTypes::BlockFinalized>(
+                *se_manager_,
+                SubscriptionEngineHandlers::kTest,
+                [this](auto &, auto msg) { onFinalized(std::move(msg)); });
+    on_slot_interval_started_ = se::SubscriberCreator<
+        qtils::Empty,
+        std::shared_ptr<const messages::SlotIntervalStarted>>::
+        create<EventTypes::SlotIntervalStarted>(
+            *se_manager_,
+            SubscriptionEngineHandlers::kTest,
+            [this](auto &, auto msg) {
+              storage_->throttleBackgroundIo(msg->interval.phase()
+                                             < kFirstRelaxedPhase);
+            });
+  }
+
+  void StoragePruner::start() {
+    thread_ = std::thread{[this] {
+      setThreadName("pruner");
+      run();
+    }};
+  }
+
+  void StoragePruner::stop() {
+    {
+      std::lock_guard lock{mutex_};
+      stop_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  void StoragePruner::onFinalized(
+      std::shared_ptr<const messages::Finalized> msg) {
+    {
+      std::lock_guard lock{mutex_};
+      queue_.emplace_back(std::move(msg));
+    }
+    cv_.notify_one();
+  }
+
+  void StoragePruner::run() {
+    removeMarkedBefore();
+    std::unique_lock lock{mutex_};
+    while (true) {
+      cv_.wait(lock, [&] { return stop_ or not queue_.empty(); });
+      if (queue_.empty()) {
+        break;
+      }
+      auto msg = std::move(queue_.front());
+      queue_.pop_front();
+      lock.unlock();
+      prune(*msg);
+      lock.lock();
+    }
+  }
+
+  void StoragePruner::removeMarkedBefore() {
+    auto hashes_res = block_storage_->restoreMarkedRemoved();
+    if (hashes_res.has_error()) {
+      SL_WARN(logger_,
+              "Can't restore blocks pruned by previous run: {}",
+              hashes_res.error());
+      return;
+    }
+    for (auto &hash : hashes_res.value()) {
+      if (auto res = block_storage_->removeBlock(hash); res.has_error()) {
+        SL_WARN(logger_,
+                "Can't remove non-canonical block {}: {}",
+                hash,
+                res.error());
+      }
+    }
+    if (not hashes_res.value().empty()) {
+      SL_INFO(logger_,
+              "Removed {} non-canonical blocks pruned by previous run",
+              hashes_res.value().size());
+    }
+  }
+
+  void StoragePruner::prune(const messages::Finalized &msg) {
+    for (auto &block : msg.pruned) {
+      if (auto res = block_storage_->removeBlock(block.hash);
+          res.has_error()) {
+        SL_WARN(logger_,
+                "Can't remove non-canonical block {}: {}",
+                block,
+                res.error());
+      }
+    }
+    if (not msg.pruned.empty()) {
+      SL_DEBUG(logger_, "Removed {} non-canonical blocks", msg.pruned.size());
+    }
+
+    // Retired blocks go from parent of finalized down to previous finalized
+    std::vector<BlockIndex> retired{msg.retired.rbegin(), msg.retired.rend()};
+    if (auto res = block_storage_->moveToAncient(retired); res.has_error()) {
+      SL_WARN(logger_,
+              "Can't move finalized blocks to ancient store: {}",
+              res.error());
+    }
+
+    if (retention_ == 0) {
+      return;
+    }
+    if (not restored_) {
+      restoreFinalized(msg.retired.empty() ? msg.finalized
+                                           : msg.retired.back());
+    }
+    for (auto &block : retired) {
+      if (finalized_.empty() or finalized_.back().slot < block.slot) {
+        finalized_.emplace_back(block);
+      }
+    }
+    pruneStates(msg.finalized);
+  }
+
+  void StoragePruner::pruneStates(const BlockIndex &finalized) {
+    if (finalized.slot <= retention_) {
+      return;
+    }
+    auto cutoff = finalized.slot - retention_;
+    size_t count = 0;
+    while (count < finalized_.size() and finalized_[count].slot < cutoff) {
+      ++count;
+    }
+    if (count == 0) {
+      return;
+    }
+    const auto &keep =
+        count < finalized_.size() ? finalized_[count] : finalized;
+
+    // Older states are removed only if kept ones don't depend on them
+    if (auto res = block_storage_->rebaseState(keep.hash); res.has_error()) {
+      SL_WARN(logger_, "Can't rebase state of block {}: {}", keep, res.error());
+      return;
+    }
+    // Archived states are rebased too, before states they depend on are
+    // removed
+    std::vector<BlockIndex> removed;
+    for (auto &block : finalized_ | std::views::take(count)) {
+      if (archive_interval_ != 0
+          and block.slot / archive_interval_ != archived_bucket_) {
+        auto res = block_storage_->rebaseState(block.hash);
+        if (res.has_value()) {
+          archived_bucket_ = block.slot / archive_interval_;
+          continue;
+        }
+        SL_WARN(
+            logger_, "Can't archive state of block {}: {}", block, res.error());
+      }
+      removed.emplace_back(block);
+    }
+    for (auto &block : removed) {
+      if (auto res = block_storage_->removeState(block.hash);
+          res.has_error()) {
+        SL_WARN(logger_,
+                "Can't remove state of finalized block {}: {}",
+                block,
+                res.error());
+      }
+    }
+    auto encoded_slot = encode(keep.slot).value();
+    if (auto res = storage_->getSpace(storage::Space::Default)
+                       ->put(storage::kPrunedStateSlotLookupKey,
+                             std::move(encoded_slot));
+        res.has_error()) {
+      SL_WARN(logger_, "Can't store pruned state slot: {}", res.error());
+    }
+    SL_DEBUG(logger_,
+             "Removed {} and archived {} states of blocks before {}",
+             removed.size(),
+             count - removed.size(),
+             keep);
+    finalized_.erase(finalized_.begin(),
+                     finalized_.begin() + static_cast<ptrdiff_t>(count));
+  }
+
+  void StoragePruner::restoreFinalized(const BlockIndex &oldest) {
+    restored_ = true;
+
+    // States before this slot were removed by previous run
+    Slot pruned_slot = 0;
+    auto space = storage_->getSpace(storage::Space::Default);
+    auto encoded_slot_res = space->tryGet(storage::kPrunedStateSlotLookupKey);
+    if (encoded_slot_res.has_value() and encoded_slot_res.value()) {
+      if (auto slot_res = decode<Slot>(encoded_slot_res.value()->view())) {
+        pruned_slot = slot_res.value();
+      }
+    }
+
+    std::deque<BlockIndex> restored;
+    auto header_res = block_storage_->getBlockHeader(oldest.hash);
+    while (header_res.has_value() and header_res.value().slot > pruned_slot) {
+      auto parent = header_res.value().parent_root;
+      header_res = block_storage_->getBlockHeader(parent);
+      if (header_res.has_error() or header_res.value().slot < pruned_slot) {
+        break;
+      }
+      restored.emplace_front(header_res.value().slot, parent);
+    }
+    SL_DEBUG(logger_,
+             "Restored {} finalized blocks with states since slot {}",
+             restored.size(),
+             pruned_slot);
+    finalized_.insert(finalized_.begin(), restored.begin(), restored.end());
+  }
+
+}  // namespace lean::blockchain
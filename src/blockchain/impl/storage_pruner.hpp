@@ -0,0 +1,119 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include <qtils/empty.hpp>
+#include <qtils/shared_ref.hpp>
+
+#include "log/logger.hpp"
+#include "modules/shared/prodution_types.tmp.hpp"
+#include "se/subscription_fwd.hpp"
+#include "types/block_index.hpp"
+
+namespace lean::app {
+  class Configuration;
+  class StateManager;
+}  // namespace lean::app
+
+namespace lean::storage {
+  class SpacedStorage;
+}  // namespace lean::storage
+
+namespace lean::blockchain {
+  class BlockStorage;
+
+  /**
+   * Removes data not needed after finalization, on own thread:
+   * - blocks of non-canonical branches dropped by finalization,
+   * - states of finalized blocks more than `database.state_retention` slots
+   *   behind last finalized; their headers, bodies and signatures are kept,
+   * - signatures and bodies of finalized canonical blocks, moved to ancient
+   *   store if it is enabled.
+   *
+   * Oldest kept state is rebased to full snapshot before older states are
+   * removed, so state diffs of kept blocks stay resolvable. State of first
+   * finalized block of each `database.state_archive_interval` slots is
+   * kept as snapshot too, so `StateRegenerator` can replay removed states
+   * from it.
+   *
+   * Background I/O of storage is throttled in intervals 0-2 of slot, when
+   * blocks are proposed, attestations signed and aggregated, and relaxed in
+   * intervals 3-4.
+   */
+  class StoragePruner {
+   public:
+    StoragePruner(qtils::SharedRef<log::LoggingSystem> logsys,
+                  qtils::SharedRef<app::StateManager> state_manager,
+                  qtils::SharedRef<Subscription> se_manager,
+                  qtils::SharedRef<app::Configuration> app_config,
+                  qtils::SharedRef<BlockStorage> block_storage,
+                  qtils::SharedRef<storage::SpacedStorage> storage);
+
+    StoragePruner(const StoragePruner &) = delete;
+    StoragePruner &operator=(const StoragePruner &) = delete;
+
+    ~StoragePruner();
+
+    void prepare();
+    void start();
+    /// Processes queued finalizations and joins thread
+    void stop();
+
+    /// Queue pruning after finalization
+    void onFinalized(std::shared_ptr<const messages::Finalized> msg);
+
+    static constexpr uint64_t kFirstRelaxedPhase = 3;
+
+   private:
+    void run();
+    /// Remove blocks pruned by finalization of previous run, but not removed
+    void removeMarkedBefore();
+    void prune(const messages::Finalized &msg);
+    void pruneStates(const BlockIndex &finalized);
+
+    /// Collect canonical blocks between previous run pruning and `oldest`
+    void restoreFinalized(const BlockIndex &oldest);
+
+    log::Logger logger_;
+    qtils::SharedRef<Subscription> se_manager_;
+    qtils::SharedRef<BlockStorage> block_storage_;
+    qtils::SharedRef<storage::SpacedStorage> storage_;
+    const uint64_t retention_;
+    const uint64_t archive_interval_;
+
+    std::shared_ptr<
+        BaseSubscriber<qtils::Empty,
+                       std::shared_ptr<const messages::Finalized>>>
+        on_block_finalized_;
+    std::shared_ptr<
+        BaseSubscriber<qtils::Empty,
+                       std::shared_ptr<const messages::SlotIntervalStarted>>>
+        on_slot_interval_started_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::shared_ptr<const messages::Finalized>> queue_;
+    bool stop_ = false;
+    std::thread thread_;
+
+    /// Accessed by pruner thread only
+    bool restored_ = false;
+    /// Finalized canonical blocks whose states are kept, by slot
+    std::deque<BlockIndex> finalized_;
+    /// Slot of last archived state divided by archive interval, not
+    /// restored, so first interval after restart may archive one more state
+    std::optional<uint64_t> archived_bucket_;
+  };
+
+}  // namespace lean::blockchain
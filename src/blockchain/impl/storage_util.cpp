@@ -41,6 +41,16 @@ namespace lean::blockchain {
     return target_space->tryGet(block_hash);
   }
 
+  outcome::result<bool> readFromSpace(
+      storage::SpacedStorage &storage,
+      storage::Space space,
+      const BlockHash &block_hash,
+      const std::function<outcome::result<void>(const qtils::ByteVecOrView &)>
+          &read) {
+    auto target_space = storage.getSpace(space);
+    return target_space->tryRead(block_hash, read);
+  }
+
   outcome::result<void> removeFromSpace(storage::SpacedStorage &storage,
                                         storage::Space space,
                                         const BlockHash &block_hash) {
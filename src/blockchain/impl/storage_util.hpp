@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include <qtils/byte_vec.hpp>
 
 #include "types/types.hpp"
@@ -91,6 +93,18 @@ namespace lean::blockchain {
       storage::Space space,
       const BlockHash &block_hash);
 
+  /**
+   * Pass an entry to `read` without copying it out of the database
+   * @param read - decodes the entry, which is valid only during the call
+   * @return error, or true if the entry exists, false if does not
+   */
+  outcome::result<bool> readFromSpace(
+      storage::SpacedStorage &storage,
+      storage::Space space,
+      const BlockHash &block_hash,
+      const std::function<outcome::result<void>(const qtils::ByteVecOrView &)>
+          &read);
+
   /**
    * Remove an entry from the key space \param space and corresponding lookup
    * keys
@@ -6,6 +6,7 @@
 
 #include "blockchain/impl/validator_registry_impl.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 #include <utility>
 
@@ -48,10 +49,10 @@ namespace lean {
             yaml::read(config.genesisDir() / "annotated_validators.yaml"),
             config.nodeId()} {}
 
-  std::optional<std::string> ValidatorRegistryImpl::nodeIdByIndex(
+  std::optional<std::string_view> ValidatorRegistryImpl::nodeIdByIndex(
       ValidatorIndex index) const {
-    if (auto it = index_to_node_.find(index); it != index_to_node_.end()) {
-      return it->second;
+    if (index < index_to_node_.size() and not index_to_node_[index].empty()) {
+      return index_to_node_[index];
     }
     return std::nullopt;
   }
@@ -64,7 +65,7 @@ namespace lean {
     }
     if (auto it = node_to_indices_.find(std::string(node_id));
         it != node_to_indices_.end() and not it->second.empty()) {
-      return ValidatorIndices{it->second.begin(), it->second.end()};
+      return it->second;
     }
     return std::nullopt;
   }
@@ -74,12 +75,18 @@ namespace lean {
     return current_validator_indices_;
   }
 
+  bool ValidatorRegistryImpl::isCurrentValidator(ValidatorIndex index) const {
+    return index < is_current_validator_.size()
+       and is_current_validator_[index];
+  }
+
   ValidatorRegistry::ValidatorIndices
   ValidatorRegistryImpl::allValidatorsIndices() const {
     ValidatorIndices all_indices;
-    all_indices.reserve(index_to_node_.size());
-    for (const auto &[idx, _] : index_to_node_) {
-      all_indices.insert(idx);
+    for (ValidatorIndex index = 0; index < index_to_node_.size(); ++index) {
+      if (not index_to_node_[index].empty()) {
+        all_indices.emplace_back(index);
+      }
     }
     return all_indices;
   }
@@ -110,16 +117,20 @@ namespace lean {
       node_indices.reserve(node_indices.size() + indices.size());
 
       for (auto idx : indices) {
-        auto it = index_to_node_.find(idx);
-        if (it != index_to_node_.end()) {
-          if (it->second != node_id) {
+        if (idx >= index_to_node_.size()) {
+          index_to_node_.resize(idx + 1);
+        }
+        auto &node = index_to_node_[idx];
+        if (not node.empty()) {
+          if (node != node_id) {
             qtils::raise(ValidatorRegistryError::ALREADY_ASSIGNED);
           }
           continue;
         }
-        index_to_node_.emplace(idx, node_id);
+        node = node_id;
         node_indices.emplace_back(idx);
       }
+      std::ranges::sort(node_indices);
     }
 
     if (current_node_id_.empty()) {
@@ -130,6 +141,10 @@ namespace lean {
     if (auto opt_indices = validatorIndicesForNodeId(current_node_id_);
         opt_indices.has_value()) {
       current_validator_indices_ = opt_indices.value();
+      is_current_validator_.resize(current_validator_indices_.back() + 1);
+      for (auto index : current_validator_indices_) {
+        is_current_validator_[index] = true;
+      }
       SL_INFO(logger_,
               "Node '{}' mapped to validator indices {}",
               current_node_id_,
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <string>
 #include <unordered_map>
 
 #include <boost/di.hpp>
@@ -51,9 +52,12 @@ namespace lean {
     [[nodiscard]] const ValidatorIndices &currentValidatorIndices()
         const override;
 
+    [[nodiscard]] bool isCurrentValidator(
+        ValidatorIndex index) const override;
+
     [[nodiscard]] ValidatorIndices allValidatorsIndices() const override;
 
-    [[nodiscard]] std::optional<std::string> nodeIdByIndex(
+    [[nodiscard]] std::optional<std::string_view> nodeIdByIndex(
         ValidatorIndex index) const override;
 
     [[nodiscard]] std::optional<ValidatorIndices> validatorIndicesForNodeId(
@@ -68,9 +72,11 @@ namespace lean {
     log::Logger logger_;
     qtils::SharedRef<metrics::Metrics> metrics_;
     std::string current_node_id_;
-    std::unordered_map<ValidatorIndex, std::string> index_to_node_;
-    std::unordered_map<std::string, std::vector<ValidatorIndex>>
-        node_to_indices_;
+    /// Node id by validator index, empty if not assigned
+    std::vector<std::string> index_to_node_;
+    std::unordered_map<std::string, ValidatorIndices> node_to_indices_;
     ValidatorIndices current_validator_indices_;
+    /// Bit by validator index, set for validators of this node
+    std::vector<bool> is_current_validator_;
   };
 }  // namespace lean
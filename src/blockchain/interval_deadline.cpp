@@ -0,0 +1,92 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/interval_deadline.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include <fmt/format.h>
+
+#include "log/flight_recorder.hpp"
+#include "metrics/metrics.hpp"
+
+namespace lean {
+  namespace {
+    double millis(IntervalDeadline::Clock::duration duration) {
+      return std::chrono::duration<double, std::milli>(duration).count();
+    }
+  }  // namespace
+
+  IntervalDeadline::IntervalDeadline(log::Logger logger,
+                                     metrics::Metrics &metrics,
+                                     Interval interval,
+                                     Clock::duration start_lag)
+      : logger_{std::move(logger)},
+        metrics_{&metrics},
+        interval_{interval},
+        start_lag_{std::max(start_lag, Clock::duration::zero())},
+        start_{Clock::now()},
+        stage_start_{start_} {}
+
+  IntervalDeadline::IntervalDeadline(IntervalDeadline &&other) noexcept
+      : logger_{std::move(other.logger_)},
+        metrics_{std::exchange(other.metrics_, nullptr)},
+        interval_{other.interval_},
+        start_lag_{other.start_lag_},
+        start_{other.start_},
+        stage_start_{other.stage_start_},
+        stages_{std::move(other.stages_)} {}
+
+  IntervalDeadline::~IntervalDeadline() {
+    finish();
+  }
+
+  void IntervalDeadline::stage(std::string_view name) {
+    auto now = Clock::now();
+    stages_.emplace_back(name, now - stage_start_);
+    stage_start_ = now;
+  }
+
+  void IntervalDeadline::finish() {
+    if (metrics_ == nullptr) {
+      return;
+    }
+    auto *metrics = std::exchange(metrics_, nullptr);
+    auto work = Clock::now() - start_;
+    metrics::Labels labels{{"phase", std::to_string(interval_.phase())}};
+    metrics->fc_interval_start_lag_time(labels)->observe(
+        std::chrono::duration<double>(start_lag_).count());
+    metrics->fc_interval_budget_usage(labels)->observe(
+        millis(work) / millis(INTERVAL_DURATION_MS));
+    if (start_lag_ + work <= INTERVAL_DURATION_MS) {
+      return;
+    }
+    metrics->fc_interval_deadlines_missed_total(labels)->inc();
+    std::string breakdown;
+    for (auto &[name, duration] : stages_) {
+      fmt::format_to(std::back_inserter(breakdown),
+                     "{}{} {:.1f}ms",
+                     breakdown.empty() ? "" : ", ",
+                     name,
+                     millis(duration));
+    }
+    std::string dump;
+    if (auto path = log::dumpFlightRecorderToFile("deadline")) {
+      dump = fmt::format(", flight recording {}", path->string());
+    }
+    SL_WARN(logger_,
+            "⏰ Slot {} interval {} missed deadline: started {:.1f}ms late, "
+            "worked {:.1f}ms of {}ms ({}){}",
+            interval_.slot(),
+            interval_.phase(),
+            millis(start_lag_),
+            millis(work),
+            INTERVAL_DURATION_MS.count(),
+            breakdown,
+            dump);
+  }
+}  // namespace lean
@@ -0,0 +1,61 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "log/logger.hpp"
+#include "types/slot.hpp"
+
+namespace lean::metrics {
+  class Metrics;
+}  // namespace lean::metrics
+
+namespace lean {
+  /**
+   * Measures work of fork choice interval against its budget,
+   * `INTERVAL_DURATION_MS`.
+   * Start lag is time between scheduled interval start and start of work.
+   * Deadline is missed when work ends after next interval started, e.g.
+   * block produced in interval 0 is published in interval 1.
+   * Stage breakdown is logged for missed deadlines.
+   * Result is recorded by `finish` or destructor.
+   */
+  class IntervalDeadline {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    IntervalDeadline(log::Logger logger,
+                     metrics::Metrics &metrics,
+                     Interval interval,
+                     Clock::duration start_lag);
+    IntervalDeadline(IntervalDeadline &&other) noexcept;
+    ~IntervalDeadline();
+
+    IntervalDeadline(const IntervalDeadline &) = delete;
+    IntervalDeadline &operator=(const IntervalDeadline &) = delete;
+    IntervalDeadline &operator=(IntervalDeadline &&) = delete;
+
+    /// End stage `name`, which started at end of previous stage
+    void stage(std::string_view name);
+
+    void finish();
+
+   private:
+    log::Logger logger_;
+    /// Null when finished or moved from
+    metrics::Metrics *metrics_;
+    Interval interval_;
+    Clock::duration start_lag_;
+    Clock::time_point start_;
+    Clock::time_point stage_start_;
+    std::vector<std::pair<std::string_view, Clock::duration>> stages_;
+  };
+}  // namespace lean
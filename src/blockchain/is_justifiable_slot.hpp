@@ -6,20 +6,103 @@
 
 #pragma once
 
-#include <cmath>
+#include <algorithm>
+#include <array>
 
 #include <boost/assert.hpp>
 
+#include "types/constants.hpp"
 #include "types/slot.hpp"
 
 namespace lean {
-  inline bool isJustifiableSlot(Slot finalized_slot, Slot candidate) {
-    BOOST_ASSERT(candidate >= finalized_slot);
-    auto delta = candidate - finalized_slot;
-    return delta <= 5
-        // any x^2
-        or fmod(sqrt(delta), 1) == 0
-        // any x^2+x
-        or fmod(sqrt(delta + 0.25), 1) == 0.5;
+  namespace justifiable_slot_detail {
+    constexpr Slot isqrt(Slot value) {
+      Slot root = 0;
+      for (Slot bit = Slot{1} << 31; bit != 0; bit >>= 1) {
+        auto next = root | bit;
+        if (next * next <= value) {
+          root = next;
+        }
+      }
+      return root;
+    }
+
+    /// Greatest justifiable delta not above `delta`, without table
+    constexpr Slot lastJustifiableDelta(Slot delta) {
+      if (delta <= 5) {
+        return delta;
+      }
+      // x^2 <= x^2+x < (x+1)^2
+      auto root = isqrt(delta);
+      auto pronic = root * root + root;
+      return pronic <= delta ? pronic : root * root;
+    }
+
+    /// Table covers deltas within history of state
+    constexpr Slot kTableLimit = HISTORICAL_ROOTS_LIMIT;
+
+    /// Visit justifiable deltas up to `kTableLimit` in ascending order
+    constexpr void forEachJustifiableDelta(auto &&visit) {
+      for (Slot delta = 0; delta <= 5; ++delta) {
+        visit(delta);
+      }
+      for (Slot x = 2; x * x <= kTableLimit; ++x) {
+        for (auto delta : {x * x, x * x + x}) {
+          if (delta > 5 and delta <= kTableLimit) {
+            visit(delta);
+          }
+        }
+      }
+    }
+
+    constexpr size_t tableSize() {
+      size_t size = 0;
+      forEachJustifiableDelta([&](Slot) { ++size; });
+      return size;
+    }
+
+    /// Sorted justifiable deltas up to `kTableLimit`
+    constexpr auto kTable = [] {
+      std::array<Slot, tableSize()> table{};
+      size_t size = 0;
+      forEachJustifiableDelta([&](Slot delta) { table[size++] = delta; });
+      return table;
+    }();
+  }  // namespace justifiable_slot_detail
+
+  /**
+   * Greatest justifiable slot not above `slot`.
+   * Deltas from finalized slot are looked up in precomputed table.
+   */
+  constexpr Slot lastJustifiableSlot(Slot finalized_slot, Slot slot) {
+    namespace detail = justifiable_slot_detail;
+    BOOST_ASSERT(slot >= finalized_slot);
+    auto delta = slot - finalized_slot;
+    if (delta > detail::kTableLimit) {
+      return finalized_slot + detail::lastJustifiableDelta(delta);
+    }
+    auto it = std::ranges::upper_bound(detail::kTable, delta);
+    return finalized_slot + *std::prev(it);
+  }
+
+  constexpr bool isJustifiableSlot(Slot finalized_slot, Slot candidate) {
+    return lastJustifiableSlot(finalized_slot, candidate) == candidate;
+  }
+
+  /// Greatest justifiable slot below `candidate`
+  constexpr Slot prevJustifiableSlot(Slot finalized_slot, Slot candidate) {
+    BOOST_ASSERT(candidate > finalized_slot);
+    return lastJustifiableSlot(finalized_slot, candidate - 1);
+  }
+
+  /// Whether any slot between `begin` and `end`, excluding both, is
+  /// justifiable
+  constexpr bool anyJustifiableSlotBetween(Slot finalized_slot,
+                                           Slot begin,
+                                           Slot end) {
+    if (end <= begin + 1) {
+      return false;
+    }
+    return prevJustifiableSlot(finalized_slot, end) > begin;
   }
 }  // namespace lean
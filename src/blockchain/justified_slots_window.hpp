@@ -0,0 +1,99 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+#include "types/slot.hpp"
+
+namespace lean {
+  /**
+   * `State::justified_slots` addressed by slot.
+   * List stores flags of slots after finalized one, so finalization drops
+   * flags from its front. Window only advances its base on finalization,
+   * and dropped flags are erased from list once by `commit`, instead of on
+   * each finalization step of block. Lookup, update, extension and
+   * finalization are O(1).
+   */
+  class JustifiedSlotsWindow {
+   public:
+    JustifiedSlotsWindow(std::vector<bool> &bits, Slot finalized_slot)
+        : bits_{bits}, finalized_slot_{finalized_slot} {}
+
+    JustifiedSlotsWindow(const JustifiedSlotsWindow &) = delete;
+    JustifiedSlotsWindow &operator=(const JustifiedSlotsWindow &) = delete;
+
+    Slot finalizedSlot() const {
+      return finalized_slot_;
+    }
+
+    /// Flags tracked after finalized slot
+    size_t size() const {
+      return bits_.size() - dropped_;
+    }
+
+    /**
+     * Slots at or before finalized one are justified.
+     * @return nullopt if slot is not tracked yet
+     */
+    std::optional<bool> isJustified(Slot slot) const {
+      if (slot <= finalized_slot_) {
+        return true;
+      }
+      auto index = slot - finalized_slot_ - 1;
+      if (index >= size()) {
+        return std::nullopt;
+      }
+      return bits_[dropped_ + index];
+    }
+
+    /// Mark tracked slot justified, finalized slots are left as is
+    void setJustified(Slot slot) {
+      if (slot <= finalized_slot_) {
+        return;
+      }
+      bits_.at(dropped_ + (slot - finalized_slot_ - 1)) = true;
+    }
+
+    /// Track slots up to `slot`, new slots are not justified
+    void extendTo(Slot slot) {
+      if (slot <= finalized_slot_) {
+        return;
+      }
+      auto size = slot - finalized_slot_;
+      if (size > this->size()) {
+        bits_.resize(dropped_ + size, false);
+      }
+    }
+
+    /**
+     * Move finalized slot, flags before it are erased by `commit`.
+     * Distance is unsigned like shift of list, so earlier slot drops all
+     * flags.
+     */
+    void finalize(Slot finalized_slot) {
+      auto delta = finalized_slot - finalized_slot_;
+      dropped_ += std::min<size_t>(size(), delta);
+      finalized_slot_ = finalized_slot;
+    }
+
+    /// Erase dropped flags, so list starts after finalized slot
+    void commit() {
+      bits_.erase(bits_.begin(),
+                  bits_.begin() + static_cast<ptrdiff_t>(dropped_));
+      dropped_ = 0;
+    }
+
+   private:
+    std::vector<bool> &bits_;
+    Slot finalized_slot_;
+    /// Flags at front of `bits_` before finalized slot
+    size_t dropped_ = 0;
+  };
+}  // namespace lean
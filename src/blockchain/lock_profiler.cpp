@@ -0,0 +1,175 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/lock_profiler.hpp"
+
+#include <algorithm>
+
+#include "metrics/metrics.hpp"
+
+namespace lean {
+  constexpr std::array kLockSiteNames{
+      "other",
+      "onBlock",
+      "onGossipAttestation",
+      "onGossipAggregatedAttestation",
+      "onTick",
+      "apiForkChoice",
+      "getState",
+      "query",
+  };
+  static_assert(kLockSiteNames.size() == static_cast<size_t>(LockSite::COUNT));
+
+  std::string_view lockSiteName(LockSite site) {
+    return kLockSiteNames.at(static_cast<size_t>(site));
+  }
+
+  thread_local LockSite LockSiteScope::current_ = LockSite::OTHER;
+
+  namespace {
+    uint64_t nanos(ProfiledSharedMutex::Clock::duration duration) {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+          .count();
+    }
+
+    double seconds(ProfiledSharedMutex::Clock::duration duration) {
+      return std::chrono::duration<double>(duration).count();
+    }
+  }  // namespace
+
+  void LockStats::Site::recordWait(std::chrono::steady_clock::duration wait) {
+    auto ns = nanos(wait);
+    acquisitions.fetch_add(1, std::memory_order_relaxed);
+    contended.fetch_add(1, std::memory_order_relaxed);
+    wait_ns.fetch_add(ns, std::memory_order_relaxed);
+    auto max = max_wait_ns.load(std::memory_order_relaxed);
+    while (max < ns
+           and not max_wait_ns.compare_exchange_weak(
+               max, ns, std::memory_order_relaxed)) {}
+    wait_time->observe(seconds(wait));
+  }
+
+  void LockStats::Site::recordHold(std::chrono::steady_clock::duration hold) {
+    hold_ns.fetch_add(nanos(hold), std::memory_order_relaxed);
+    hold_time->observe(seconds(hold));
+  }
+
+  LockStats::LockStats(std::string name, metrics::Metrics &metrics)
+      : name_{std::move(name)} {
+    for (size_t i = 0; i < sites_.size(); ++i) {
+      metrics::Labels labels{
+          {"lock", name_},
+          {"site", std::string{kLockSiteNames.at(i)}},
+      };
+      sites_.at(i).wait_time = metrics.lock_wait_time(labels);
+      sites_.at(i).hold_time = metrics.lock_hold_time(labels);
+    }
+  }
+
+  LockProfiler::LockProfiler(qtils::SharedRef<metrics::Metrics> metrics)
+      : metrics_{std::move(metrics)} {}
+
+  LockStats &LockProfiler::lock(std::string name) {
+    std::lock_guard lock{mutex_};
+    return locks_.emplace_back(std::move(name), *metrics_);
+  }
+
+  std::vector<LockContenderJson> LockProfiler::topContenders(
+      size_t limit) const {
+    constexpr auto kRelaxed = std::memory_order_relaxed;
+    std::vector<LockContenderJson> contenders;
+    {
+      std::lock_guard lock{mutex_};
+      for (auto &stats : locks_) {
+        for (size_t i = 0; i < kLockSiteNames.size(); ++i) {
+          auto &site = stats.site(static_cast<LockSite>(i));
+          auto acquisitions = site.acquisitions.load(kRelaxed);
+          if (acquisitions == 0) {
+            continue;
+          }
+          contenders.emplace_back(LockContenderJson{
+              .lock = stats.name(),
+              .site = std::string{kLockSiteNames.at(i)},
+              .acquisitions = acquisitions,
+              .contended = site.contended.load(kRelaxed),
+              .wait_us = site.wait_ns.load(kRelaxed) / 1000,
+              .max_wait_us = site.max_wait_ns.load(kRelaxed) / 1000,
+              .hold_us = site.hold_ns.load(kRelaxed) / 1000,
+          });
+        }
+      }
+    }
+    std::ranges::sort(contenders, std::ranges::greater{}, [](auto &item) {
+      return std::pair{item.wait_us, item.hold_us};
+    });
+    if (contenders.size() > limit) {
+      contenders.resize(limit);
+    }
+    return contenders;
+  }
+
+  void ProfiledSharedMutex::lock() {
+    auto &site = stats_.site(LockSiteScope::current());
+    if (mutex_.try_lock()) {
+      site.acquisitions.fetch_add(1, std::memory_order_relaxed);
+      locked_at_ = Clock::now();
+    } else {
+      auto wait_start = Clock::now();
+      mutex_.lock();
+      locked_at_ = contended(site, wait_start);
+    }
+    locked_site_ = &site;
+  }
+
+  bool ProfiledSharedMutex::try_lock() {
+    if (not mutex_.try_lock()) {
+      return false;
+    }
+    auto &site = stats_.site(LockSiteScope::current());
+    site.acquisitions.fetch_add(1, std::memory_order_relaxed);
+    locked_at_ = Clock::now();
+    locked_site_ = &site;
+    return true;
+  }
+
+  void ProfiledSharedMutex::unlock() {
+    auto hold = Clock::now() - locked_at_;
+    auto *site = locked_site_;
+    mutex_.unlock();
+    site->recordHold(hold);
+  }
+
+  void ProfiledSharedMutex::lock_shared() {
+    auto &site = stats_.site(LockSiteScope::current());
+    if (mutex_.try_lock_shared()) {
+      site.acquisitions.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    auto wait_start = Clock::now();
+    mutex_.lock_shared();
+    contended(site, wait_start);
+  }
+
+  bool ProfiledSharedMutex::try_lock_shared() {
+    if (not mutex_.try_lock_shared()) {
+      return false;
+    }
+    stats_.site(LockSiteScope::current())
+        .acquisitions.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  void ProfiledSharedMutex::unlock_shared() {
+    mutex_.unlock_shared();
+  }
+
+  ProfiledSharedMutex::Clock::time_point ProfiledSharedMutex::contended(
+      LockStats::Site &site, Clock::time_point wait_start) {
+    auto now = Clock::now();
+    site.recordWait(now - wait_start);
+    return now;
+  }
+}  // namespace lean
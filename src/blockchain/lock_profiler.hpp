@@ -0,0 +1,183 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <qtils/shared_ref.hpp>
+
+#include "serde/json_fwd.hpp"
+
+namespace lean::metrics {
+  class Histogram;
+  class Metrics;
+}  // namespace lean::metrics
+
+namespace lean {
+  /// Entry point which takes lock, contention is attributed to it
+  enum class LockSite : uint8_t {
+    OTHER,
+    ON_BLOCK,
+    ON_GOSSIP_ATTESTATION,
+    ON_GOSSIP_AGGREGATED_ATTESTATION,
+    ON_TICK,
+    API_FORK_CHOICE,
+    GET_STATE,
+    /// Other reads, e.g. attestation duty
+    QUERY,
+    COUNT,
+  };
+
+  std::string_view lockSiteName(LockSite site);
+
+  /**
+   * Sets lock site of current thread for scope.
+   * Locks taken by callees, like block tree lock taken by fork choice, are
+   * attributed to same site.
+   */
+  class LockSiteScope {
+   public:
+    explicit LockSiteScope(LockSite site) : previous_{current_} {
+      current_ = site;
+    }
+    ~LockSiteScope() {
+      current_ = previous_;
+    }
+
+    LockSiteScope(const LockSiteScope &) = delete;
+    LockSiteScope &operator=(const LockSiteScope &) = delete;
+
+    static LockSite current() {
+      return current_;
+    }
+
+   private:
+    static thread_local LockSite current_;
+    LockSite previous_;
+  };
+
+  /// Contention of lock by site, as returned by admin API
+  struct LockContenderJson {
+    std::string lock;
+    std::string site;
+    uint64_t acquisitions;
+    uint64_t contended;
+    uint64_t wait_us;
+    uint64_t max_wait_us;
+    uint64_t hold_us;
+
+    JSON_FIELDS(
+        lock, site, acquisitions, contended, wait_us, max_wait_us, hold_us);
+  };
+
+  /**
+   * Counters of one lock, updated by `ProfiledSharedMutex`, or by
+   * `ForkChoiceExecutor` for queue wait and run time of its commands.
+   */
+  class LockStats {
+   public:
+    struct Site {
+      /// Record contended acquisition
+      void recordWait(std::chrono::steady_clock::duration wait);
+      void recordHold(std::chrono::steady_clock::duration hold);
+
+      std::atomic_uint64_t acquisitions = 0;
+      std::atomic_uint64_t contended = 0;
+      std::atomic_uint64_t wait_ns = 0;
+      std::atomic_uint64_t max_wait_ns = 0;
+      std::atomic_uint64_t hold_ns = 0;
+      metrics::Histogram *wait_time = nullptr;
+      metrics::Histogram *hold_time = nullptr;
+    };
+
+    LockStats(std::string name, metrics::Metrics &metrics);
+
+    const std::string &name() const {
+      return name_;
+    }
+
+    Site &site(LockSite site) {
+      return sites_.at(static_cast<size_t>(site));
+    }
+    const Site &site(LockSite site) const {
+      return sites_.at(static_cast<size_t>(site));
+    }
+
+   private:
+    std::string name_;
+    std::array<Site, static_cast<size_t>(LockSite::COUNT)> sites_;
+  };
+
+  /**
+   * Owns stats of profiled locks.
+   * Exports wait and hold time as `lean_lock_*_time_seconds` histograms
+   * labeled by lock and site, and top contenders for admin API.
+   */
+  class LockProfiler {
+   public:
+    explicit LockProfiler(qtils::SharedRef<metrics::Metrics> metrics);
+
+    /// Stats of new lock, called once per lock on construction
+    LockStats &lock(std::string name);
+
+    /// Sites with most total wait time, across all locks
+    std::vector<LockContenderJson> topContenders(size_t limit) const;
+
+   private:
+    qtils::SharedRef<metrics::Metrics> metrics_;
+    mutable std::mutex mutex_;
+    /// Deque keeps references stable
+    std::deque<LockStats> locks_;
+  };
+
+  /**
+   * `std::shared_mutex` recording wait time and exclusive hold time by
+   * `LockSiteScope` site.
+   * Uncontended acquisition costs one clock read and one relaxed counter
+   * increment, wait is measured only when `try_lock` fails, so mutex may
+   * stay profiled in production.
+   * Hold time of shared locks is not measured, several threads hold them at
+   * once.
+   */
+  class ProfiledSharedMutex {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ProfiledSharedMutex(LockStats &stats) : stats_{stats} {}
+
+    ProfiledSharedMutex(const ProfiledSharedMutex &) = delete;
+    ProfiledSharedMutex &operator=(const ProfiledSharedMutex &) = delete;
+
+    void lock();
+    bool try_lock();
+    void unlock();
+
+    void lock_shared();
+    bool try_lock_shared();
+    void unlock_shared();
+
+   private:
+    /// Record wait of contended acquisition, returns time of acquisition
+    static Clock::time_point contended(LockStats::Site &site,
+                                       Clock::time_point wait_start);
+
+    std::shared_mutex mutex_;
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-const-or-ref-data-members)
+    LockStats &stats_;
+    /// Written by exclusive owner only
+    LockStats::Site *locked_site_ = nullptr;
+    Clock::time_point locked_at_;
+  };
+}  // namespace lean
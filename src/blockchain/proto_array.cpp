@@ -0,0 +1,372 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/proto_array.hpp"
+
+#include <algorithm>
+#include <ranges>
+#include <utility>
+
+#include "utils/memory_usage.hpp"
+
+namespace lean {
+  bool ProtoArray::empty() const {
+    return nodes_.empty();
+  }
+
+  size_t ProtoArray::size() const {
+    return nodes_.size();
+  }
+
+  size_t ProtoArray::byteSize() const {
+    auto bytes = memory_usage::vectorBytes(nodes_)
+               + memory_usage::hashBytes(indices_)
+               + memory_usage::vectorBytes(deltas_)
+               + memory_usage::treeBytes(dirty_);
+    for (auto &node : nodes_) {
+      bytes += memory_usage::vectorBytes(node.children);
+    }
+    for (size_t set = 0; set < kVoteSets; ++set) {
+      bytes += memory_usage::hashBytes(votes_[set])
+             + memory_usage::hashBytes(pending_votes_[set]);
+      for (auto &pending : pending_votes_[set] | std::views::values) {
+        bytes += memory_usage::vectorBytes(pending.validators);
+      }
+    }
+    return bytes;
+  }
+
+  bool ProtoArray::contains(const BlockHash &hash) const {
+    return indices_.contains(hash);
+  }
+
+  void ProtoArray::clear() {
+    nodes_.clear();
+    indices_.clear();
+    for (size_t set = 0; set < kVoteSets; ++set) {
+      votes_[set].clear();
+      pending_votes_[set].clear();
+    }
+    deltas_.clear();
+    deltas_end_ = {};
+    dirty_.clear();
+  }
+
+  bool ProtoArray::addBlock(const BlockIndex &block,
+                            const BlockHash &parent_root) {
+    if (indices_.contains(block.hash)) {
+      return true;
+    }
+    std::optional<NodeIndex> parent;
+    if (not nodes_.empty()) {
+      auto parent_it = indices_.find(parent_root);
+      if (parent_it == indices_.end()) {
+        return false;
+      }
+      parent = parent_it->second;
+    }
+
+    auto index = nodes_.size();
+    nodes_.emplace_back(Node{
+        .index = block,
+        .parent = parent,
+        .best_descendant = index,
+    });
+    indices_.emplace(block.hash, index);
+    deltas_.emplace_back();
+    if (parent.has_value()) {
+      nodes_[*parent].children.emplace_back(index);
+      dirty_.emplace(*parent);
+    }
+
+    // Count votes which arrived before the block itself
+    for (auto set : {VoteSet::KNOWN, VoteSet::NEW}) {
+      auto &votes = votes_[setIndex(set)];
+      auto node = pending_votes_[setIndex(set)].extract(block.hash);
+      if (not node) {
+        continue;
+      }
+      for (auto validator_index : node.mapped().validators) {
+        auto vote_it = votes.find(validator_index);
+        if (vote_it == votes.end()) {
+          continue;
+        }
+        auto &vote = vote_it->second;
+        if (vote.root != block.hash or vote.node.has_value()) {
+          continue;
+        }
+        vote.node = index;
+        addDelta(index, set, 1);
+      }
+    }
+    return true;
+  }
+
+  void ProtoArray::setVote(ValidatorIndex validator_index,
+                           const Checkpoint &head,
+                           VoteSet set) {
+    setVotes({&validator_index, 1}, head, set);
+  }
+
+  void ProtoArray::setVotes(std::span<const ValidatorIndex> validators,
+                            const Checkpoint &head,
+                            VoteSet set) {
+    std::optional<NodeIndex> node;
+    if (auto index_it = indices_.find(head.root); index_it != indices_.end()) {
+      node = index_it->second;
+    }
+    int64_t added = 0;
+    for (auto validator_index : validators) {
+      auto [vote_it, inserted] = votes_[setIndex(set)].try_emplace(
+          validator_index, Vote{.root = head.root});
+      auto &vote = vote_it->second;
+      if (not inserted) {
+        if (vote.root == head.root) {
+          continue;
+        }
+        if (vote.node.has_value()) {
+          addDelta(*vote.node, set, -1);
+        }
+        vote.root = head.root;
+      }
+      vote.node = node;
+      if (node.has_value()) {
+        ++added;
+      } else {
+        auto &pending = pending_votes_[setIndex(set)][head.root];
+        pending.slot = head.slot;
+        pending.validators.emplace_back(validator_index);
+      }
+    }
+    if (added != 0) {
+      addDelta(*node, set, added);
+    }
+  }
+
+  size_t ProtoArray::pendingBlocks(VoteSet set) const {
+    return pending_votes_[setIndex(set)].size();
+  }
+
+  void ProtoArray::removeVote(ValidatorIndex validator_index, VoteSet set) {
+    auto node = votes_[setIndex(set)].extract(validator_index);
+    if (node and node.mapped().node.has_value()) {
+      addDelta(*node.mapped().node, set, -1);
+    }
+    // Stale pending entry is skipped by `addBlock`
+  }
+
+  void ProtoArray::clearVotes(VoteSet set) {
+    for (auto &vote : votes_[setIndex(set)] | std::views::values) {
+      if (vote.node.has_value()) {
+        addDelta(*vote.node, set, -1);
+      }
+    }
+    votes_[setIndex(set)].clear();
+    pending_votes_[setIndex(set)].clear();
+  }
+
+  std::optional<BlockHash> ProtoArray::findHead(const BlockHash &root) {
+    applyScoreChanges();
+    auto index_it = indices_.find(root);
+    if (index_it == indices_.end()) {
+      return std::nullopt;
+    }
+    return nodes_[nodes_[index_it->second].best_descendant].index.hash;
+  }
+
+  std::optional<BlockHash> ProtoArray::findSafeTarget(const BlockHash &root,
+                                                      uint64_t min_score) {
+    applyScoreChanges();
+    auto index_it = indices_.find(root);
+    if (index_it == indices_.end()) {
+      return std::nullopt;
+    }
+    auto set = setIndex(VoteSet::NEW);
+    auto index = index_it->second;
+    while (true) {
+      std::optional<NodeIndex> best_child;
+      for (auto child : nodes_[index].children) {
+        auto &lhs = nodes_[child];
+        if (lhs.weights[set] < min_score) {
+          continue;
+        }
+        if (not best_child.has_value()) {
+          best_child = child;
+          continue;
+        }
+        auto &rhs = nodes_[*best_child];
+        // Most attestations, then lexicographically highest hash
+        if (lhs.weights[set] > rhs.weights[set]
+            or (lhs.weights[set] == rhs.weights[set]
+                and rhs.index.hash < lhs.index.hash)) {
+          best_child = child;
+        }
+      }
+      if (not best_child.has_value()) {
+        return nodes_[index].index.hash;
+      }
+      index = *best_child;
+    }
+  }
+
+  std::optional<BlockHash> ProtoArray::extendedHead(
+      const BlockHash &root,
+      const BlockHash &head,
+      const BlockHash &block) const {
+    auto root_it = indices_.find(root);
+    auto head_it = indices_.find(head);
+    auto block_it = indices_.find(block);
+    if (root_it == indices_.end() or head_it == indices_.end()
+        or block_it == indices_.end()) {
+      return std::nullopt;
+    }
+    auto &head_node = nodes_[head_it->second];
+    // Only best child of `head` is stale, and it can only be `block`
+    if (deltas_end_[setIndex(VoteSet::KNOWN)] != 0 or dirty_.size() != 1
+        or *dirty_.begin() != head_it->second
+        or head_node.children.size() != 1
+        or head_node.children.front() != block_it->second
+        or nodes_[root_it->second].best_descendant != head_it->second) {
+      return std::nullopt;
+    }
+    return block;
+  }
+
+  std::optional<uint64_t> ProtoArray::weight(const BlockHash &hash,
+                                             VoteSet set) const {
+    auto index_it = indices_.find(hash);
+    if (index_it == indices_.end()) {
+      return std::nullopt;
+    }
+    return nodes_[index_it->second].weights[setIndex(set)];
+  }
+
+  void ProtoArray::prune(const BlockHash &finalized_root) {
+    auto finalized_it = indices_.find(finalized_root);
+    if (finalized_it == indices_.end() or finalized_it->second == 0) {
+      return;
+    }
+    applyScoreChanges();
+
+    auto finalized_index = finalized_it->second;
+    // Blocks not after finalized slot and not in array never become known
+    auto finalized_slot = nodes_[finalized_index].index.slot;
+    for (auto &pending : pending_votes_) {
+      std::erase_if(pending, [&](const auto &item) {
+        return item.second.slot <= finalized_slot;
+      });
+    }
+    std::vector<std::optional<NodeIndex>> remap(nodes_.size());
+    std::vector<Node> nodes;
+    for (auto i = finalized_index; i < nodes_.size(); ++i) {
+      auto &node = nodes_[i];
+      if (i != finalized_index
+          and not(node.parent.has_value() and remap[*node.parent])) {
+        continue;
+      }
+      remap[i] = nodes.size();
+      nodes.emplace_back(std::move(node));
+    }
+
+    // Descendants of kept node are kept too, so all remaps below are set
+    indices_.clear();
+    for (auto &node : nodes) {
+      if (node.parent.has_value()) {
+        node.parent = remap[*node.parent];
+      }
+      for (auto &child : node.children) {
+        child = *remap[child];
+      }
+      if (node.best_child.has_value()) {
+        node.best_child = *remap[*node.best_child];
+      }
+      node.best_descendant = *remap[node.best_descendant];
+      indices_.emplace(node.index.hash, indices_.size());
+    }
+    nodes_ = std::move(nodes);
+    deltas_.resize(nodes_.size());
+
+    for (auto &votes : votes_) {
+      for (auto &vote : votes | std::views::values) {
+        if (vote.node.has_value()) {
+          vote.node = remap[*vote.node];
+        }
+      }
+    }
+  }
+
+  void ProtoArray::addDelta(NodeIndex index, VoteSet set, int64_t delta) {
+    deltas_[index][setIndex(set)] += delta;
+    auto &end = deltas_end_[setIndex(set)];
+    end = std::max(end, index + 1);
+  }
+
+  void ProtoArray::applyScoreChanges() {
+    // Children always have greater index than parent, so one pass in
+    // descending order visits each affected node once, bottom-up.
+    // Both vote sets are propagated by the same pass.
+    constexpr Deltas kNoDelta{};
+    for (auto index = std::ranges::max(deltas_end_); index-- != 0;) {
+      auto delta = std::exchange(deltas_[index], kNoDelta);
+      if (delta == kNoDelta) {
+        continue;
+      }
+      auto &node = nodes_[index];
+      for (size_t set = 0; set < kVoteSets; ++set) {
+        node.weights[set] = static_cast<uint64_t>(
+            static_cast<int64_t>(node.weights[set]) + delta[set]);
+      }
+      if (node.parent.has_value()) {
+        auto &parent_delta = deltas_[*node.parent];
+        for (size_t set = 0; set < kVoteSets; ++set) {
+          parent_delta[set] += delta[set];
+        }
+        // Best child follows known votes only
+        if (delta[setIndex(VoteSet::KNOWN)] != 0) {
+          dirty_.emplace(*node.parent);
+        }
+      }
+    }
+    deltas_end_ = {};
+
+    while (not dirty_.empty()) {
+      auto index = *dirty_.begin();
+      dirty_.erase(dirty_.begin());
+      if (updateBestChild(index) and nodes_[index].parent.has_value()) {
+        dirty_.emplace(*nodes_[index].parent);
+      }
+    }
+  }
+
+  bool ProtoArray::updateBestChild(NodeIndex index) {
+    auto &node = nodes_[index];
+    std::optional<NodeIndex> best_child;
+    for (auto child : node.children) {
+      if (not best_child.has_value()) {
+        best_child = child;
+        continue;
+      }
+      auto &lhs = nodes_[child];
+      auto &rhs = nodes_[*best_child];
+      auto set = setIndex(VoteSet::KNOWN);
+      // Most attestations, then lexicographically highest hash
+      if (lhs.weights[set] > rhs.weights[set]
+          or (lhs.weights[set] == rhs.weights[set]
+              and rhs.index.hash < lhs.index.hash)) {
+        best_child = child;
+      }
+    }
+    auto best_descendant =
+        best_child.has_value() ? nodes_[*best_child].best_descendant : index;
+    if (best_child == node.best_child
+        and best_descendant == node.best_descendant) {
+      return false;
+    }
+    node.best_child = best_child;
+    node.best_descendant = best_descendant;
+    return true;
+  }
+}  // namespace lean
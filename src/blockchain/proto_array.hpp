@@ -0,0 +1,172 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "types/block_hash_map.hpp"
+#include "types/block_index.hpp"
+#include "types/checkpoint.hpp"
+#include "types/validator_index.hpp"
+
+namespace lean {
+  /**
+   * Incremental index of the non-finalized block tree used by LMD GHOST.
+   *
+   * Nodes are stored in a flat vector, parent always precedes its children.
+   * Each node keeps the weight of its subtree and the best descendant, chosen
+   * by the same rule as `ForkChoiceStore::computeLmdGhostHead` (heaviest child,
+   * lexicographically larger hash on ties).
+   *
+   * Votes are tracked per validator. Moving a vote only records a delta
+   * in flat array by node index; deltas are propagated on the next
+   * `findHead` by one backward pass over that array instead of a full
+   * recount.
+   *
+   * Known (head) and new (safe target) votes are separate vote sets with own
+   * subtree weights, propagated by the same pass over changed nodes.
+   */
+  class ProtoArray {
+   public:
+    using NodeIndex = size_t;
+
+    enum class VoteSet : uint8_t {
+      /// Votes counted by `findHead`
+      KNOWN,
+      /// Votes counted by `findSafeTarget`
+      NEW,
+    };
+    static constexpr size_t kVoteSets = 2;
+
+    using Weights = std::array<uint64_t, kVoteSets>;
+
+    struct Node {
+      BlockIndex index;
+      std::optional<NodeIndex> parent;
+      std::vector<NodeIndex> children;
+      /// Subtree weight by vote set
+      Weights weights{};
+      /// Best child and descendant by known votes
+      std::optional<NodeIndex> best_child;
+      NodeIndex best_descendant;
+    };
+
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] size_t size() const;
+    /// Estimated memory used by nodes and votes
+    [[nodiscard]] size_t byteSize() const;
+    [[nodiscard]] bool contains(const BlockHash &hash) const;
+
+    /// Forget all nodes and votes
+    void clear();
+
+    /**
+     * Insert block as child of known parent.
+     * When array is empty, the block becomes its root.
+     * @return false if parent is unknown (block is ignored)
+     */
+    bool addBlock(const BlockIndex &block, const BlockHash &parent_root);
+
+    /**
+     * Move vote of validator in vote set to block `head`.
+     * Vote for still unknown block is counted as soon as block is added,
+     * unless block slot is finalized before.
+     */
+    void setVote(ValidatorIndex validator_index,
+                 const Checkpoint &head,
+                 VoteSet set = VoteSet::KNOWN);
+
+    /// `setVote` of each of `validators`, head is looked up once
+    void setVotes(std::span<const ValidatorIndex> validators,
+                  const Checkpoint &head,
+                  VoteSet set = VoteSet::KNOWN);
+
+    /// Number of unknown blocks with votes of vote set
+    [[nodiscard]] size_t pendingBlocks(VoteSet set = VoteSet::KNOWN) const;
+
+    /// Remove vote of validator from vote set
+    void removeVote(ValidatorIndex validator_index, VoteSet set);
+
+    /// Remove all votes of vote set
+    void clearVotes(VoteSet set);
+
+    /**
+     * Apply pending vote deltas and return best descendant of `root`.
+     * @return nullopt if `root` is unknown
+     */
+    [[nodiscard]] std::optional<BlockHash> findHead(const BlockHash &root);
+
+    /**
+     * Apply pending vote deltas and walk from `root` to heaviest child by
+     * new votes, while child has at least `min_score` new votes.
+     * Same rule as `ForkChoiceStore::computeLmdGhostHead` with `min_score`.
+     * @return nullopt if `root` is unknown
+     */
+    [[nodiscard]] std::optional<BlockHash> findSafeTarget(
+        const BlockHash &root, uint64_t min_score);
+
+    /**
+     * Head from `root` after `block` was added as only child of `head`,
+     * found without applying pending changes: no known vote moved since
+     * last `findHead`, and `head` was best descendant of `root`.
+     * @return nullopt if full `findHead` is needed
+     */
+    [[nodiscard]] std::optional<BlockHash> extendedHead(
+        const BlockHash &root,
+        const BlockHash &head,
+        const BlockHash &block) const;
+
+    /// Subtree weight of block (after pending deltas applied)
+    [[nodiscard]] std::optional<uint64_t> weight(
+        const BlockHash &hash, VoteSet set = VoteSet::KNOWN) const;
+
+    /**
+     * Drop all nodes which are not `finalized_root` or its descendants,
+     * and votes for unknown blocks not after finalized slot.
+     */
+    void prune(const BlockHash &finalized_root);
+
+   private:
+    struct Vote {
+      BlockHash root;
+      std::optional<NodeIndex> node;
+    };
+
+    using Deltas = std::array<int64_t, kVoteSets>;
+
+    static size_t setIndex(VoteSet set) {
+      return static_cast<size_t>(set);
+    }
+
+    void addDelta(NodeIndex index, VoteSet set, int64_t delta);
+    void applyScoreChanges();
+    bool updateBestChild(NodeIndex index);
+
+    std::vector<Node> nodes_;
+    BlockHashMap<NodeIndex> indices_;
+    std::array<std::unordered_map<ValidatorIndex, Vote>, kVoteSets> votes_;
+    struct PendingVotes {
+      Slot slot = 0;
+      std::vector<ValidatorIndex> validators;
+    };
+    /// Votes for blocks which are not in array yet
+    std::array<std::unordered_map<BlockHash, PendingVotes>, kVoteSets>
+        pending_votes_;
+    /// Pending weight changes by node index, parallel to `nodes_`
+    std::vector<Deltas> deltas_;
+    /// Nodes from this index on have no pending changes, by vote set
+    std::array<NodeIndex, kVoteSets> deltas_end_{};
+    /// Nodes whose best child must be re-evaluated
+    std::set<NodeIndex, std::greater<>> dirty_;
+  };
+}  // namespace lean
@@ -0,0 +1,59 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "types/block_hash.hpp"
+
+namespace lean {
+  struct State;
+
+  /**
+   * Post-states shared by state caches of many nodes in one process, e.g.
+   * simulated ones.
+   * Post-state of block is same on each node, so cache which got state
+   * already held by another cache keeps shared instance and drops own copy.
+   * States are immutable once cached, pool keeps weak references only.
+   */
+  class SharedStatePool {
+   public:
+    /// @return state of `hash` held by any cache, or `state` if none
+    std::shared_ptr<const State> intern(const BlockHash &hash,
+                                        std::shared_ptr<const State> state) {
+      std::lock_guard lock{mutex_};
+      auto &entry = states_[hash];
+      if (auto shared = entry.lock()) {
+        ++shared_;
+        return shared;
+      }
+      entry = state;
+      // Drop expired entries once map doubled since previous cleanup
+      if (states_.size() >= 2 * live_after_cleanup_) {
+        std::erase_if(states_,
+                      [](const auto &pair) { return pair.second.expired(); });
+        live_after_cleanup_ = std::max<size_t>(states_.size(), 16);
+      }
+      return state;
+    }
+
+    /// Number of `intern` calls which returned already shared state
+    size_t sharedCount() const {
+      std::lock_guard lock{mutex_};
+      return shared_;
+    }
+
+   private:
+    mutable std::mutex mutex_;
+    std::unordered_map<BlockHash, std::weak_ptr<const State>> states_;
+    size_t live_after_cleanup_ = 16;
+    size_t shared_ = 0;
+  };
+}  // namespace lean
@@ -0,0 +1,248 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/state_cache.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+#include <snappy.h>
+
+#include "blockchain/shared_state_pool.hpp"
+#include "serde/serialization.hpp"
+#include "types/state.hpp"
+
+namespace lean {
+
+  StateCache::StateCache(size_t max_bytes, size_t warm_max_bytes)
+      : max_bytes_{max_bytes}, warm_max_bytes_{warm_max_bytes} {}
+
+  size_t StateCache::byteSize(const State &state) {
+    return sizeof(State)
+         + state.historical_block_hashes.size() * sizeof(BlockHash)
+         + state.justified_slots.size()
+         + state.validators.size() * sizeof(Validator)
+         + state.justifications_roots.size() * sizeof(BlockHash)
+         + state.justifications_validators.size();
+  }
+
+  std::optional<std::shared_ptr<const State>> StateCache::get(
+      const BlockHash &hash) {
+    {
+      std::shared_lock lock{mutex_};
+      auto it = entries_.find(hash);
+      if (it != entries_.end()) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        touch(it->second);
+        return it->second.state;
+      }
+    }
+    if (auto state = promote(hash)) {
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      warm_hits_.fetch_add(1, std::memory_order_relaxed);
+      return put(hash, std::move(state.value()));
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+  }
+
+  bool StateCache::contains(const BlockHash &hash) const {
+    {
+      std::shared_lock lock{mutex_};
+      if (entries_.contains(hash)) {
+        return true;
+      }
+    }
+    std::unique_lock lock{warm_mutex_};
+    return warm_.contains(hash);
+  }
+
+  std::shared_ptr<const State> StateCache::put(const BlockHash &hash,
+                                               State state) {
+    auto bytes = byteSize(state);
+    std::shared_ptr<const State> state_ptr =
+        std::make_shared<const State>(std::move(state));
+    if (pool_) {
+      state_ptr = pool_->intern(hash, std::move(state_ptr));
+    }
+    Evicted evicted;
+    {
+      std::unique_lock lock{mutex_};
+      auto &entry = entries_[hash];
+      bytes_ -= entry.bytes;
+      entry.state = state_ptr;
+      entry.bytes = bytes;
+      bytes_ += bytes;
+      touch(entry);
+      evicted = evict(hash);
+    }
+    if (warm_max_bytes_ != 0) {
+      std::unique_lock lock{warm_mutex_};
+      if (auto it = warm_.find(hash); it != warm_.end()) {
+        warm_bytes_ -= it->second.compressed.size();
+        warm_order_.erase(it->second.order);
+        warm_.erase(it);
+      }
+    }
+    demote(std::move(evicted));
+    return state_ptr;
+  }
+
+  void StateCache::share(std::shared_ptr<SharedStatePool> pool) {
+    pool_ = std::move(pool);
+  }
+
+  void StateCache::pin(std::vector<BlockHash> hashes) {
+    Evicted evicted;
+    {
+      std::unique_lock lock{mutex_};
+      pinned_.clear();
+      pinned_.insert(hashes.begin(), hashes.end());
+      evicted = evict({});
+    }
+    demote(std::move(evicted));
+  }
+
+  std::vector<BlockHash> StateCache::keys() const {
+    std::vector<std::pair<uint64_t, BlockHash>> stamped;
+    {
+      std::shared_lock lock{mutex_};
+      stamped.reserve(entries_.size());
+      for (auto &[hash, entry] : entries_) {
+        stamped.emplace_back(entry.tick.load(std::memory_order_relaxed), hash);
+      }
+    }
+    std::ranges::sort(stamped, [](const auto &lhs, const auto &rhs) {
+      return lhs.first > rhs.first;
+    });
+    std::vector<BlockHash> keys;
+    keys.reserve(stamped.size());
+    for (auto &item : stamped) {
+      keys.emplace_back(item.second);
+    }
+    return keys;
+  }
+
+  StateCache::Stats StateCache::stats() const {
+    Stats stats{
+        .hits = hits_.load(std::memory_order_relaxed),
+        .misses = misses_.load(std::memory_order_relaxed),
+        .warm_hits = warm_hits_.load(std::memory_order_relaxed),
+    };
+    {
+      std::shared_lock lock{mutex_};
+      stats.states = entries_.size();
+      stats.bytes = bytes_;
+    }
+    std::unique_lock lock{warm_mutex_};
+    stats.warm_states = warm_.size();
+    stats.warm_bytes = warm_bytes_;
+    return stats;
+  }
+
+  void StateCache::touch(Entry &entry) {
+    entry.tick.store(ticks_.fetch_add(1, std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
+  }
+
+  StateCache::Evicted StateCache::evict(const BlockHash &keep) {
+    Evicted evicted;
+    // Just stored state is kept even if it exceeds budget alone
+    while (bytes_ > max_bytes_) {
+      auto oldest = entries_.end();
+      for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if (it->first == keep or pinned_.contains(it->first)) {
+          continue;
+        }
+        if (oldest == entries_.end()
+            or it->second.tick.load(std::memory_order_relaxed)
+                   < oldest->second.tick.load(std::memory_order_relaxed)) {
+          oldest = it;
+        }
+      }
+      if (oldest == entries_.end()) {
+        break;
+      }
+      bytes_ -= oldest->second.bytes;
+      evicted.emplace_back(oldest->first, std::move(oldest->second.state));
+      entries_.erase(oldest);
+    }
+    return evicted;
+  }
+
+  void StateCache::demote(Evicted evicted) {
+    if (warm_max_bytes_ == 0) {
+      return;
+    }
+    qtils::ByteVec encoded;
+    for (auto &[hash, state] : evicted) {
+      encodeInto(*state, encoded);
+      qtils::ByteVec compressed(::snappy::MaxCompressedLength(encoded.size()));
+      size_t size = 0;
+      ::snappy::RawCompress(reinterpret_cast<const char *>(encoded.data()),
+                            encoded.size(),
+                            reinterpret_cast<char *>(compressed.data()),
+                            &size);
+      if (size > warm_max_bytes_) {
+        continue;
+      }
+      compressed.resize(size);
+      compressed.shrink_to_fit();
+
+      std::unique_lock lock{warm_mutex_};
+      if (warm_.contains(hash)) {
+        continue;
+      }
+      warm_order_.push_back(hash);
+      warm_bytes_ += compressed.size();
+      warm_.emplace(hash,
+                    WarmEntry{
+                        .compressed = std::move(compressed),
+                        .order = std::prev(warm_order_.end()),
+                    });
+      while (warm_bytes_ > warm_max_bytes_) {
+        auto it = warm_.find(warm_order_.front());
+        warm_bytes_ -= it->second.compressed.size();
+        warm_.erase(it);
+        warm_order_.pop_front();
+      }
+    }
+  }
+
+  std::optional<State> StateCache::promote(const BlockHash &hash) {
+    if (warm_max_bytes_ == 0) {
+      return std::nullopt;
+    }
+    qtils::ByteVec compressed;
+    {
+      std::unique_lock lock{warm_mutex_};
+      auto it = warm_.find(hash);
+      if (it == warm_.end()) {
+        return std::nullopt;
+      }
+      compressed = std::move(it->second.compressed);
+      warm_bytes_ -= compressed.size();
+      warm_order_.erase(it->second.order);
+      warm_.erase(it);
+    }
+    auto data = reinterpret_cast<const char *>(compressed.data());
+    size_t size = 0;
+    if (not ::snappy::GetUncompressedLength(data, compressed.size(), &size)) {
+      return std::nullopt;
+    }
+    qtils::ByteVec encoded(size);
+    auto out = reinterpret_cast<char *>(encoded.data());
+    if (not ::snappy::RawUncompress(data, compressed.size(), out)) {
+      return std::nullopt;
+    }
+    auto state = decode<State>(encoded);
+    if (state.has_error()) {
+      return std::nullopt;
+    }
+    return std::move(state.value());
+  }
+
+}  // namespace lean
@@ -0,0 +1,128 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <qtils/byte_vec.hpp>
+
+#include "types/block_hash.hpp"
+
+namespace lean {
+  class SharedStatePool;
+  struct State;
+
+  /**
+   * LRU cache of post-states, bounded by estimated memory size instead of
+   * number of states, as state size grows with history and validator count.
+   *
+   * Pinned states (head, justified, finalized, safe target) are never
+   * evicted, so lookups by many attestation targets can't push them out.
+   * Pinned states are counted in size, budget may be exceeded by them only.
+   *
+   * States evicted from memory tier are demoted to warm tier, which keeps
+   * them SSZ encoded and snappy compressed within its own budget, so those
+   * recently left by head (e.g. reorg candidates) are restored without
+   * database reads and diff replay. Warm hit promotes state back. States
+   * evicted from warm tier are left to block storage.
+   *
+   * Thread safe. Lookup takes shared lock only and marks recency with
+   * atomic stamp, so concurrent readers don't serialize. Demoted states are
+   * compressed after memory tier lock is released.
+   */
+  class StateCache {
+   public:
+    struct Stats {
+      uint64_t hits = 0;
+      uint64_t misses = 0;
+      size_t states = 0;
+      size_t bytes = 0;
+      /// Lookups served by warm tier, counted in `hits` too
+      uint64_t warm_hits = 0;
+      size_t warm_states = 0;
+      size_t warm_bytes = 0;
+    };
+
+    /// Warm tier is disabled if `warm_max_bytes` is zero
+    explicit StateCache(size_t max_bytes, size_t warm_max_bytes = 0);
+
+    /// Approximate memory used by state lists
+    static size_t byteSize(const State &state);
+
+    std::optional<std::shared_ptr<const State>> get(const BlockHash &hash);
+
+    /// Check presence in any tier, not counted as hit or miss and not
+    /// touching order
+    bool contains(const BlockHash &hash) const;
+
+    std::shared_ptr<const State> put(const BlockHash &hash, State state);
+
+    /// Keep states shared with other caches of `pool`, set before use
+    void share(std::shared_ptr<SharedStatePool> pool);
+
+    /// Replace set of pinned states, previously pinned may be evicted again
+    void pin(std::vector<BlockHash> hashes);
+
+    /// Keys of memory tier from most to least recently used
+    std::vector<BlockHash> keys() const;
+
+    Stats stats() const;
+
+   private:
+    struct Entry {
+      std::shared_ptr<const State> state;
+      size_t bytes = 0;
+      std::atomic_uint64_t tick = 0;
+    };
+
+    using Evicted =
+        std::vector<std::pair<BlockHash, std::shared_ptr<const State>>>;
+
+    struct WarmEntry {
+      qtils::ByteVec compressed;
+      std::list<BlockHash>::iterator order;
+    };
+
+    void touch(Entry &entry);
+
+    /// Evict least recently used not pinned states until within budget.
+    /// Called under exclusive lock.
+    Evicted evict(const BlockHash &keep);
+
+    /// Compress evicted states into warm tier
+    void demote(Evicted evicted);
+
+    /// Take state out of warm tier
+    std::optional<State> promote(const BlockHash &hash);
+
+    const size_t max_bytes_;
+    std::shared_ptr<SharedStatePool> pool_;
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<BlockHash, Entry> entries_;
+    std::unordered_set<BlockHash> pinned_;
+    size_t bytes_ = 0;
+    std::atomic_uint64_t ticks_ = 0;
+    std::atomic_uint64_t hits_ = 0;
+    std::atomic_uint64_t misses_ = 0;
+
+    const size_t warm_max_bytes_;
+    mutable std::mutex warm_mutex_;
+    std::unordered_map<BlockHash, WarmEntry> warm_;
+    /// From least to most recently demoted, warm hit takes state out
+    std::list<BlockHash> warm_order_;
+    size_t warm_bytes_ = 0;
+    std::atomic_uint64_t warm_hits_ = 0;
+  };
+}  // namespace lean
@@ -0,0 +1,169 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/state_regenerator.hpp"
+
+#include <algorithm>
+#include <thread>
+
+#include <qtils/final_action.hpp>
+
+#include "blockchain/block_storage.hpp"
+#include "metrics/metrics.hpp"
+#include "utils/bounded_channel.hpp"
+#include "utils/thread_placement.hpp"
+
+namespace lean::blockchain {
+
+  StateRegenerator::StateRegenerator(
+      qtils::SharedRef<log::LoggingSystem> logsys,
+      qtils::SharedRef<BlockStorage> block_storage,
+      qtils::SharedRef<BlockTree> block_tree,
+      qtils::SharedRef<metrics::Metrics> metrics)
+      : logger_(logsys->getLogger("StateRegenerator", "block_storage")),
+        block_storage_(std::move(block_storage)),
+        metrics_(metrics),
+        stf_(std::move(logsys), std::move(block_tree), std::move(metrics)) {}
+
+  outcome::result<std::optional<StateRegenerator::StatePtr>>
+  StateRegenerator::getState(const BlockHash &block_hash) {
+    OUTCOME_TRY(stored, block_storage_->getState(block_hash));
+    if (stored.has_value()) {
+      return std::make_shared<const State>(std::move(stored.value()));
+    }
+
+    std::promise<Result> promise;
+    std::shared_future<Result> pending;
+    {
+      std::lock_guard lock{mutex_};
+      if (auto it = pending_.find(block_hash); it != pending_.end()) {
+        pending = it->second;
+      } else {
+        pending_.emplace(block_hash, promise.get_future().share());
+      }
+    }
+    if (pending.valid()) {
+      metrics_->stf_state_regenerations_total({{"result", "coalesced"}})
+          ->inc();
+      return pending.get();
+    }
+
+    auto result = regenerate(block_hash);
+    const char *label = "replayed";
+    if (result.has_error()) {
+      label = "error";
+      SL_WARN(logger_,
+              "Can't regenerate state of block {}: {}",
+              block_hash,
+              result.error());
+    } else if (not result.value().has_value()) {
+      label = "missing";
+    }
+    metrics_->stf_state_regenerations_total({{"result", label}})->inc();
+    promise.set_value(result);
+    std::lock_guard lock{mutex_};
+    pending_.erase(block_hash);
+    return result;
+  }
+
+  StateRegenerator::Result StateRegenerator::regenerate(
+      const BlockHash &block_hash) {
+    if (auto cached = checkpoints_.get(block_hash)) {
+      return cached.value();
+    }
+
+    // Blocks after nearest ancestor with state, from requested one back
+    std::vector<BlockHash> blocks;
+    StatePtr base;
+    auto hash = block_hash;
+    while (not base) {
+      if (blocks.size() == kMaxReplayBlocks) {
+        return Error::TOO_FAR;
+      }
+      OUTCOME_TRY(header, block_storage_->tryGetBlockHeader(hash));
+      if (not header.has_value()) {
+        return std::nullopt;
+      }
+      blocks.emplace_back(hash);
+      hash = header->parent_root;
+      if (auto cached = checkpoints_.get(hash)) {
+        base = std::move(cached.value());
+        break;
+      }
+      // Cheap check, not to decode states of blocks without them
+      OUTCOME_TRY(checkpoints, block_storage_->getStateCheckpoints(hash));
+      if (checkpoints.has_value()) {
+        OUTCOME_TRY(state, block_storage_->getState(hash));
+        if (not state.has_value()) {
+          return std::nullopt;
+        }
+        base = std::make_shared<const State>(std::move(state.value()));
+      }
+    }
+    std::ranges::reverse(blocks);
+
+    SL_DEBUG(logger_,
+             "Regenerate state of block {} by replaying {} blocks on state "
+             "of slot {}",
+             block_hash,
+             blocks.size(),
+             base->slot);
+    auto timer = metrics_->stf_state_regeneration_time()->timer();
+    return replay(blocks, *base);
+  }
+
+  StateRegenerator::Result StateRegenerator::replay(
+      std::span<const BlockHash> blocks, State state) {
+    using Batch = outcome::result<std::vector<std::optional<SignedBlock>>>;
+
+    // Reads next batches while current one is replayed
+    BoundedChannel<Batch> channel{kReadAhead};
+    std::thread reader{[&] {
+      setThreadName("replay");
+      for (size_t i = 0; i < blocks.size(); i += kReadBatch) {
+        auto batch =
+            blocks.subspan(i, std::min(kReadBatch, blocks.size() - i));
+        if (not channel.send(block_storage_->tryGetSignedBlocks(batch))) {
+          break;
+        }
+      }
+      channel.close();
+    }};
+    // Early return stops reader
+    qtils::FinalAction join_reader{[&] {
+      channel.close();
+      reader.join();
+    }};
+
+    size_t replayed = 0;
+    while (replayed < blocks.size()) {
+      auto received = channel.receiveBatch(1);
+      if (received.empty()) {
+        return std::nullopt;
+      }
+      OUTCOME_TRY(batch, std::move(received.front()));
+      for (auto &signed_block : batch) {
+        if (not signed_block.has_value()) {
+          SL_DEBUG(logger_, "Block {} to replay is missing", blocks[replayed]);
+          return std::nullopt;
+        }
+        ++replayed;
+        // Intermediate roots are not known without hashing, only requested
+        // block's root is checked
+        auto last = replayed == blocks.size();
+        OUTCOME_TRY(next,
+                    stf_.stateTransition(signed_block->block, state, last));
+        state = std::move(next);
+        metrics_->stf_state_regeneration_blocks_total()->inc();
+        if (replayed % kCheckpointInterval == 0 and not last) {
+          checkpoints_.put(blocks[replayed - 1], state);
+        }
+      }
+    }
+    return std::make_shared<const State>(std::move(state));
+  }
+
+}  // namespace lean::blockchain
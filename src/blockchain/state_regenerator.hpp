@@ -0,0 +1,102 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+
+#include <qtils/enum_error_code.hpp>
+#include <qtils/outcome.hpp>
+#include <qtils/shared_ref.hpp>
+
+#include "blockchain/state_transition_function.hpp"
+#include "log/logger.hpp"
+#include "types/block_hash_map.hpp"
+#include "types/state.hpp"
+#include "types/types.hpp"
+#include "utils/lru_cache.hpp"
+
+namespace lean::metrics {
+  class Metrics;
+}  // namespace lean::metrics
+
+namespace lean::blockchain {
+  class BlockStorage;
+  class BlockTree;
+
+  /**
+   * Historical states removed by state pruning, rebuilt by replaying stored
+   * blocks on nearest ancestor with stored state, e.g. snapshot archived
+   * every `database.state_archive_interval` slots.
+   *
+   * Blocks are read in batches by reader thread ahead of replay, so storage
+   * reads overlap STF. Signatures were verified on import and are not
+   * checked again, state root is checked once for requested block.
+   * Every `kCheckpointInterval` replayed states are cached, so queries of
+   * nearby blocks replay from closer state. Concurrent queries of same
+   * block share one replay. Replay is limited to `kMaxReplayBlocks`.
+   */
+  class StateRegenerator {
+   public:
+    enum class Error : uint8_t {
+      TOO_FAR = 1,
+    };
+    Q_ENUM_ERROR_CODE_FRIEND(Error) {
+      using E = decltype(e);
+      switch (e) {
+        case E::TOO_FAR:
+          return "No stored state within replay limit of block";
+      }
+      abort();
+    }
+
+    static constexpr size_t kMaxReplayBlocks = 8192;
+    /// Blocks of single storage read
+    static constexpr size_t kReadBatch = 64;
+    /// Batches read ahead of replay
+    static constexpr size_t kReadAhead = 2;
+    static constexpr size_t kCheckpointInterval = 64;
+    static constexpr size_t kCheckpointCacheSize = 16;
+
+    using StatePtr = std::shared_ptr<const State>;
+
+    StateRegenerator(qtils::SharedRef<log::LoggingSystem> logsys,
+                     qtils::SharedRef<BlockStorage> block_storage,
+                     qtils::SharedRef<BlockTree> block_tree,
+                     qtils::SharedRef<metrics::Metrics> metrics);
+
+    /**
+     * Stored state of block, or state regenerated by replay.
+     * Called from any thread, replay blocks caller.
+     * @return nullopt if block is unknown or has no ancestor with stored
+     * state
+     */
+    outcome::result<std::optional<StatePtr>> getState(
+        const BlockHash &block_hash);
+
+   private:
+    using Result = outcome::result<std::optional<StatePtr>>;
+
+    Result regenerate(const BlockHash &block_hash);
+    /// Apply `blocks`, oldest first, to `state`
+    Result replay(std::span<const BlockHash> blocks, State state);
+
+    log::Logger logger_;
+    qtils::SharedRef<BlockStorage> block_storage_;
+    qtils::SharedRef<metrics::Metrics> metrics_;
+    STF stf_;
+
+    SmallLruCache<BlockHash, State, true> checkpoints_{kCheckpointCacheSize};
+
+    std::mutex mutex_;
+    /// Replays in progress, by block
+    BlockHashMap<std::shared_future<Result>> pending_;
+  };
+}  // namespace lean::blockchain
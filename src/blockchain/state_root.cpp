@@ -0,0 +1,150 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/state_root.hpp"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "serde/parallel_hash.hpp"
+#include "serde/serialization.hpp"
+#include "utils/ceil_div.hpp"
+
+namespace lean {
+  namespace {
+    using Chunk = MerkleCache::Chunk;
+
+    /// Changed validators hashed by one parallel task
+    constexpr size_t kParallelValidators = 256;
+
+    /**
+     * Root of `tree` with given leaves.
+     * Shared tree is copied only if some leaf has changed.
+     */
+    Chunk treeRoot(Cow<MerkleCache> &tree, size_t size, const auto &leaf) {
+      const auto &current = *tree;
+      auto changed = current.dirty() or current.size() != size;
+      for (size_t i = 0; not changed and i < size; ++i) {
+        changed = current.leaf(i) != leaf(i);
+      }
+      if (not changed) {
+        return current.cachedRoot();
+      }
+      auto &changed_tree = tree.mut();
+      changed_tree.resize(size);
+      for (size_t i = 0; i < size; ++i) {
+        changed_tree.set(i, leaf(i));
+      }
+      return changed_tree.root();
+    }
+
+    Chunk hashesRoot(Cow<MerkleCache> &tree, const auto &list) {
+      auto &hashes = list.data();
+      auto root = treeRoot(
+          tree, hashes.size(), [&](size_t i) -> auto & { return hashes[i]; });
+      return MerkleCache::mixInLength(root, hashes.size());
+    }
+
+    Chunk bitsRoot(Cow<MerkleCache> &tree, const auto &list) {
+      auto &bits = list.data();
+      auto chunks = StateMerkleCache::bitChunks(bits.size());
+      auto root = treeRoot(tree, chunks, [&](size_t i) {
+        Chunk chunk{};
+        auto end = std::min<size_t>(bits.size(), (i + 1) * 256);
+        for (auto bit = i * 256; bit < end; ++bit) {
+          if (bits[bit]) {
+            chunk[(bit % 256) / 8] |= 1 << (bit % 8);
+          }
+        }
+        return chunk;
+      });
+      return MerkleCache::mixInLength(root, bits.size());
+    }
+
+    Chunk validatorsRoot(StateMerkleCache &cache, const auto &list) {
+      auto &validators = list.data();
+      if (*cache.hashed_validators == validators
+          and not cache.validators->dirty()) {
+        return MerkleCache::mixInLength(cache.validators->cachedRoot(),
+                                        validators.size());
+      }
+      auto &hashed = cache.hashed_validators.mut();
+      auto &tree = cache.validators.mut();
+      hashed.resize(std::min(hashed.size(), validators.size()));
+      tree.resize(validators.size());
+      std::vector<size_t> changed;
+      for (size_t i = 0; i < validators.size(); ++i) {
+        if (i >= hashed.size() or hashed[i] != validators[i]) {
+          changed.emplace_back(i);
+        }
+      }
+      std::vector<Chunk> roots(changed.size());
+      auto hash_validators = [&](size_t task) {
+        auto begin = task * kParallelValidators;
+        auto end = std::min(changed.size(), begin + kParallelValidators);
+        for (auto j = begin; j < end; ++j) {
+          roots[j] = sszHash(validators[changed[j]]);
+        }
+      };
+      auto tasks = ceilDiv(changed.size(), kParallelValidators);
+      if (tasks < 2) {
+        for (size_t task = 0; task < tasks; ++task) {
+          hash_validators(task);
+        }
+      } else {
+        parallelHash(tasks, hash_validators);
+      }
+      for (size_t j = 0; j < changed.size(); ++j) {
+        auto i = changed[j];
+        tree.set(i, roots[j]);
+        if (i < hashed.size()) {
+          hashed[i] = validators[i];
+        } else {
+          hashed.emplace_back(validators[i]);
+        }
+      }
+      return MerkleCache::mixInLength(tree.root(), validators.size());
+    }
+
+    Chunk uintChunk(uint64_t value) {
+      Chunk chunk{};
+      for (size_t i = 0; i < sizeof(value); ++i) {
+        chunk[i] = static_cast<uint8_t>(value >> (8 * i));
+      }
+      return chunk;
+    }
+  }  // namespace
+
+  BlockHash stateRoot(const State &state) {
+    auto &cache = state.merkle_cache;
+    // 10 fields padded to 16 leaves
+    std::array<Chunk, 16> nodes{
+        sszHash(state.config),
+        uintChunk(state.slot),
+        sszHash(state.latest_block_header),
+        sszHash(state.latest_justified),
+        sszHash(state.latest_finalized),
+        hashesRoot(cache.historical_block_hashes,
+                   state.historical_block_hashes),
+        bitsRoot(cache.justified_slots, state.justified_slots),
+        validatorsRoot(cache, state.validators),
+        hashesRoot(cache.justifications_roots, state.justifications_roots),
+        bitsRoot(cache.justifications_validators,
+                 state.justifications_validators),
+    };
+    for (auto size = nodes.size(); size > 1; size /= 2) {
+      for (size_t i = 0; i < size / 2; ++i) {
+        nodes[i] = MerkleCache::hash(nodes[2 * i], nodes[2 * i + 1]);
+      }
+    }
+    return nodes[0];
+  }
+
+  BlockHash validatorsRoot(const State &state) {
+    return validatorsRoot(state.merkle_cache, state.validators);
+  }
+}  // namespace lean
@@ -0,0 +1,21 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "types/state.hpp"
+
+namespace lean {
+  /**
+   * Same as `sszHash(state)`, but large lists are merkleized with
+   * `state.merkle_cache`, so only chunks changed since previous call on this
+   * state (or state it was copied from) are rehashed.
+   */
+  BlockHash stateRoot(const State &state);
+
+  /// Root of `state.validators`, computed with `state.merkle_cache`
+  BlockHash validatorsRoot(const State &state);
+}  // namespace lean
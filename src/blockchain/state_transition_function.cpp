@@ -6,110 +6,177 @@
 
 #include "blockchain/state_transition_function.hpp"
 
+#include <algorithm>
+#include <numeric>
+
 #include <boost/assert.hpp>
 #include <soralog/macro.hpp>
 
 #include "blockchain/is_justifiable_slot.hpp"
+#include "blockchain/justified_slots_window.hpp"
+#include "blockchain/state_root.hpp"
+#include "blockchain/vote_tally.hpp"
 #include "metrics/metrics.hpp"
 #include "types/aggregated_attestations.hpp"
 #include "types/state.hpp"
-#include "utils/retain_if.hpp"
 
 namespace lean {
-  // Return the relative bitfield index for justification tracking.
-  // Slots at or before the finalized boundary are treated as justified.
-  // Those slots do not have an index in the tracked bitfield.
-  inline std::optional<Slot> justifiedIndexAfter(Slot finalized_slot,
-                                                 Slot slot) {
-    if (slot <= finalized_slot) {
-      return std::nullopt;
-    }
-    return slot - finalized_slot - 1;
-  }
+  STF::STF(qtils::SharedRef<log::LoggingSystem> logging_system,
+           qtils::SharedRef<blockchain::BlockTree> block_tree,
+           qtils::SharedRef<metrics::Metrics> metrics)
+      : logger_(logging_system->getLogger("STF", "stf")),
+        block_tree_(std::move(block_tree)),
+        metrics_(std::move(metrics)) {}
 
-  // Extend the tracking capacity to cover a new target slot.
-  // This prepares the state to process a new block by ensuring the
-  // bitfield is long enough to store its justification status.
-  // Gaps are filled with False (unjustified).
-  inline void extendToSlot(std::vector<bool> &bits,
-                           Slot finalized_slot,
-                           Slot target_slot) {
-    auto index = justifiedIndexAfter(finalized_slot, target_slot);
-    if (not index.has_value()) {
-      return;
+  /**
+   * Pending justification votes, edited in place in the state lists:
+   * sorted `justifications_roots`, and `justifications_validators` with
+   * `validatorCount()` votes per root, placed back-to-back in same order.
+   *
+   * Corresponds to `justifications` map of Python spec, but the lists are
+   * never unflattened into map and flattened back.
+   * Slots and vote counts of roots are kept in `State::justifications_index`,
+   * which is rebuilt only if it doesn't match roots of state.
+   */
+  class JustificationsView {
+   public:
+    explicit JustificationsView(State &state)
+        : roots_{state.justifications_roots.mut().data()},
+          votes_{state.justifications_validators.mut().data()},
+          validator_count_{state.validatorCount()},
+          rows_{state.justifications_index.rows} {
+      BOOST_ASSERT(votes_.size() == roots_.size() * validator_count_);
+      if (not std::ranges::is_sorted(roots_)) {
+        sort();
+      }
+      if (not indexed()) {
+        reindex(state);
+      }
     }
-    auto size = *index + 1;
-    if (size <= bits.size()) {
-      return;
+
+    /// Index of root at `slot`, inserted with no votes if missing
+    size_t getOrInsert(const BlockHash &root, Slot slot) {
+      auto it = std::ranges::lower_bound(roots_, root);
+      size_t index = it - roots_.begin();
+      if (it != roots_.end() and *it == root) {
+        return index;
+      }
+      roots_.insert(it, root);
+      votes_.insert(votes_.begin() + index * validator_count_,
+                    validator_count_,
+                    false);
+      rows_.emplace(root, JustificationsIndex::Row{.slot = slot, .votes = 0});
+      return index;
     }
-    bits.resize(size, false);
-  }
 
-  // Determine if a specific slot is considered justified.
-  // The check follows these rules:
-  // - Slots at or before the finalized boundary are implicitly justified.
-  // - Future slots are checked against the tracked bitfield.
-  inline std::optional<bool> isSlotJustified(const std::vector<bool> &bits,
-                                             Slot finalized_slot,
-                                             Slot target_slot) {
-    auto index = justifiedIndexAfter(finalized_slot, target_slot);
-    if (not index.has_value()) {
+    /// @return false if validator index is out of range
+    bool vote(size_t index, ValidatorIndex validator_index) {
+      if (validator_index >= validator_count_) {
+        return false;
+      }
+      auto bit = votes_[index * validator_count_ + validator_index];
+      if (not bit) {
+        bit = true;
+        ++rows_.at(roots_[index]).votes;
+      }
       return true;
     }
-    if (*index >= bits.size()) {
-      return std::nullopt;
+
+    /// Number of votes for root
+    size_t count(size_t index) const {
+      return rows_.at(roots_[index]).votes;
     }
-    return bits[*index];
-  }
 
-  // Return a new bitfield with the justification status updated.
-  // This method follows the immutable pattern:
-  // - Returns 'self' if the slot is finalized (immutable).
-  // - Returns a clone with the specific bit updated for active slots.
-  inline void withJustified(std::vector<bool> &bits,
-                            Slot finalized_slot,
-                            Slot target_slot) {
-    auto index = justifiedIndexAfter(finalized_slot, target_slot);
-    if (not index.has_value()) {
-      return;
+    void erase(size_t index) {
+      rows_.erase(roots_[index]);
+      roots_.erase(roots_.begin() + index);
+      auto begin = votes_.begin() + index * validator_count_;
+      votes_.erase(begin, begin + validator_count_);
     }
-    bits.at(*index) = true;
-  }
 
-  inline void shiftWindow(std::vector<bool> &bits, Slot delta) {
-    bits.erase(bits.begin(),
-               bits.begin() + std::min<size_t>(bits.size(), delta));
-  }
+    /// Keep only roots with slot after `finalized_slot`
+    void retainAfter(Slot finalized_slot) {
+      size_t kept = 0;
+      for (size_t i = 0; i < roots_.size(); ++i) {
+        auto row_it = rows_.find(roots_[i]);
+        if (row_it->second.slot <= finalized_slot) {
+          rows_.erase(row_it);
+          continue;
+        }
+        if (kept != i) {
+          moveSegment(i, kept);
+        }
+        ++kept;
+      }
+      roots_.resize(kept);
+      votes_.resize(kept * validator_count_);
+    }
 
-  STF::STF(qtils::SharedRef<log::LoggingSystem> logging_system,
-           qtils::SharedRef<blockchain::BlockTree> block_tree,
-           qtils::SharedRef<metrics::Metrics> metrics)
-      : logger_(logging_system->getLogger("STF", "stf")),
-        block_tree_(std::move(block_tree)),
-        metrics_(std::move(metrics)) {}
+   private:
+    void moveSegment(size_t from, size_t to) {
+      roots_[to] = roots_[from];
+      auto begin = votes_.begin() + from * validator_count_;
+      std::copy(begin,
+                begin + validator_count_,
+                votes_.begin() + to * validator_count_);
+    }
 
-  using Justifications = std::map<BlockHash, std::vector<bool>>;
+    /// Lists produced by spec are sorted, other order is only normalized
+    void sort() {
+      std::vector<size_t> order(roots_.size());
+      std::iota(order.begin(), order.end(), 0);
+      std::ranges::sort(order, std::less{}, [&](size_t i) -> auto & {
+        return roots_[i];
+      });
+      std::vector<BlockHash> roots;
+      std::vector<bool> votes;
+      roots.reserve(roots_.size());
+      votes.reserve(votes_.size());
+      for (auto i : order) {
+        roots.emplace_back(roots_[i]);
+        auto begin = votes_.begin() + i * validator_count_;
+        votes.insert(votes.end(), begin, begin + validator_count_);
+      }
+      roots_ = std::move(roots);
+      votes_ = std::move(votes);
+    }
 
-  /**
-   * Saves a map of `root -> justifications` back into the state's flattened
-   * data structure.
-   *
-   * Corresponds to flatten_justifications_map in Python spec.
-   */
-  inline void setJustifications(State &state,
-                                const Justifications &justifications) {
-    auto &roots = state.justifications_roots.data();
-    auto &validators = state.justifications_validators.data();
-    roots.clear();
-    roots.reserve(justifications.size());
-    validators.clear();
-    validators.reserve(justifications.size() * state.validatorCount());
-    for (auto &[root, bits] : justifications) {
-      BOOST_ASSERT(bits.size() == state.validatorCount());
-      roots.push_back(root);
-      validators.insert(validators.end(), bits.begin(), bits.end());
+    bool indexed() const {
+      return rows_.size() == roots_.size()
+         and std::ranges::all_of(roots_, [&](const BlockHash &root) {
+               return rows_.contains(root);
+             });
     }
-  }
+
+    /// Find slots of roots in history and count their votes
+    void reindex(const State &state) {
+      rows_.clear();
+      for (size_t i = 0; i < roots_.size(); ++i) {
+        auto begin = votes_.begin() + i * validator_count_;
+        rows_.emplace(
+            roots_[i],
+            JustificationsIndex::Row{
+                // Root missing from history is dropped on finalization
+                .slot = 0,
+                .votes = countVotes(begin, validator_count_),
+            });
+      }
+      // Latest slot of root, zero hash is never voted for
+      for (auto slot = state.latest_finalized.slot + 1;
+           slot < state.historical_block_hashes.size();
+           ++slot) {
+        auto row_it = rows_.find(state.historical_block_hashes[slot]);
+        if (row_it != rows_.end()) {
+          row_it->second.slot = slot;
+        }
+      }
+    }
+
+    std::vector<BlockHash> &roots_;
+    std::vector<bool> &votes_;
+    size_t validator_count_;
+    std::unordered_map<BlockHash, JustificationsIndex::Row> &rows_;
+  };
 
   State STF::generateGenesisState(const Config &config,
                                   std::vector<Validator> validators) {
@@ -126,7 +193,7 @@ namespace lean {
     result.latest_block_header = header;
     result.latest_justified = Checkpoint{.root = kZeroHash, .slot = 0};
     result.latest_finalized = Checkpoint{.root = kZeroHash, .slot = 0};
-    result.validators = std::move(validators);
+    result.validators.mut() = std::move(validators);
 
     // result.historical_block_hashes;
     // result.justified_slots;
@@ -141,23 +208,29 @@ namespace lean {
     result.slot = state.slot;
     result.proposer_index = 0;
     result.parent_root = kZeroHash;
-    result.state_root = sszHash(state);
+    result.state_root = stateRoot(state);
     result.body = BlockBody{};
     return result;
   }
 
-  outcome::result<State> STF::stateTransition(const Block &block,
-                                              const State &parent_state,
-                                              bool check_state_root) const {
+  outcome::result<State> STF::stateTransition(
+      const Block &block,
+      const State &parent_state,
+      bool check_state_root,
+      const State *advanced_parent_state) const {
     auto timer = metrics_->stf_state_transition_time()->timer();
-    auto state = parent_state;
-    // Process slots (including those with no blocks) since block
-    OUTCOME_TRY(processSlots(state, block.slot));
+    auto state = advanced_parent_state != nullptr ? *advanced_parent_state
+                                                  : parent_state;
+    // Process slots (including those with no blocks) since block, advanced
+    // state may have reached block slot already
+    if (advanced_parent_state == nullptr or state.slot != block.slot) {
+      OUTCOME_TRY(processSlots(state, block.slot));
+    }
     // Process block
     OUTCOME_TRY(processBlock(state, block));
     // Verify state root
     if (check_state_root) {
-      auto state_root = sszHash(state);
+      auto state_root = stateRoot(state);
       if (block.state_root != state_root) {
         return Error::STATE_ROOT_DOESNT_MATCH;
       }
@@ -171,33 +244,33 @@ namespace lean {
       return Error::INVALID_SLOT;
     }
 
-    // Step through each missing slot:
-    while (state.slot < slot) {
-      // Per-Slot Housekeeping & Slot Increment
-      //
-      // This performs two tasks for each empty slot:
-      //
-      // 1. State Root Caching (Conditional):
-      //    Check if the latest block header has an empty state root.
-      //    This is true only for the *first* empty slot immediately
-      //    following a block.
-      //
-      //    - If it is empty, we must cache the pre-block state root
-      //      (the hash of the state *before* this slot increment) into that
-      //      header.
-      //
-      //    - If the state root is *not* empty, it means we are in a
-      //      sequence of empty slots, and no action is needed.
-      //
-      // 2. Slot Increment:
-      //    Always increment the slot number by one.
-      //
-      if (state.latest_block_header.state_root == kZeroHash) {
-        state.latest_block_header.state_root = sszHash(state);
-      }
-      ++state.slot;
-      metrics_->stf_slots_processed_total()->inc();
+    // Per-Slot Housekeeping & Slot Increment
+    //
+    // Stepping through each missing slot performs two tasks:
+    //
+    // 1. State Root Caching (Conditional):
+    //    Check if the latest block header has an empty state root.
+    //    This is true only for the *first* empty slot immediately
+    //    following a block.
+    //
+    //    - If it is empty, we must cache the pre-block state root
+    //      (the hash of the state *before* this slot increment) into that
+    //      header.
+    //
+    //    - If the state root is *not* empty, it means we are in a
+    //      sequence of empty slots, and no action is needed.
+    //
+    // 2. Slot Increment:
+    //    Always increment the slot number by one.
+    //
+    // Only the first step can cache root, so the rest of steps collapse into
+    // single jump to target slot.
+    if (state.latest_block_header.state_root == kZeroHash) {
+      state.latest_block_header.state_root = stateRoot(state);
     }
+    metrics_->stf_slots_processed_total()->inc(
+        static_cast<double>(slot - state.slot));
+    state.slot = slot;
     return outcome::success();
   }
 
@@ -256,11 +329,11 @@ namespace lean {
     //
     // Now that we can vote on parent, push it at its correct slot index in the
     // structures.
-    state.historical_block_hashes.push_back(parent_root);
+    state.historical_block_hashes.mut().push_back(parent_root);
 
     // If there were empty slots, push zero hash for those ancestors
     for (auto i = num_empty_slots; i > 0; --i) {
-      state.historical_block_hashes.push_back(kZeroHash);
+      state.historical_block_hashes.mut().push_back(kZeroHash);
     }
 
     // Update the list of justified slot flags.
@@ -271,10 +344,11 @@ namespace lean {
     // finalized boundary up to the last materialized slot is fully tracked
     // and addressable. The current block's slot is not materialized until
     // its header is fully processed, so we stop at slot (block.slot - 1).
+    // Gaps are filled with False (unjustified).
     auto last_materialized_slot = block.slot - 1;
-    extendToSlot(state.justified_slots.data(),
-                 state.latest_finalized.slot,
-                 last_materialized_slot);
+    JustifiedSlotsWindow{state.justified_slots.data(),
+                         state.latest_finalized.slot}
+        .extendTo(last_materialized_slot);
 
     // Construct the new latest block header.
     //
@@ -306,49 +380,15 @@ namespace lean {
     //
     // The flattened vote list is organized so that votes from all validators
     // for each block root appear together, and those groups are simply placed
-    // back-to-back.
-    //
-    // To work with attestations, we must rebuild the intuitive structure:
-    //   "for each block root, here is the list of validator votes for it".
-    //
-    // Reconstructing this is done by cutting the long vote list into
-    // consecutive segments, where:
-    //   - each segment corresponds to one block root,
-    //   - each segment has length equal to the number of validators,
-    //   - and the ordering of block roots is preserved.
-    Justifications justifications;
-    if (state.justifications_roots.size() > 0) {
-      auto &roots = state.justifications_roots.data();
-      auto &flat_justifications = state.justifications_validators.data();
-      size_t offset = 0;
-      BOOST_ASSERT(flat_justifications.size()
-                   == roots.size() * state.validatorCount());
-      for (auto &root : roots) {
-        auto next_offset = offset + state.validatorCount();
-        std::vector<bool> bits{
-            flat_justifications.begin() + offset,
-            flat_justifications.begin() + next_offset,
-        };
-        justifications[root] = std::move(bits);
-        offset = next_offset;
-      }
-    }
+    // back-to-back. Votes are updated in place in these lists.
+    JustificationsView justifications{state};
 
     // Track state changes to be applied at the end
     auto latest_justified = state.latest_justified;
     auto latest_finalized = state.latest_finalized;
-    auto &justified_slots = state.justified_slots.data();
-
-    // Map roots to their latest slot for pruning.
-    // Votes for zero hash are ignored, so we only need the most recent slot
-    // where a root appears to decide whether it is still unfinalized.
-    std::unordered_map<BlockHash, Slot> root_to_slot;
-    for (auto slot = latest_finalized.slot + 1;
-         slot < state.historical_block_hashes.size();
-         ++slot) {
-      auto &root = state.historical_block_hashes[slot];
-      root_to_slot[root] = slot;
-    }
+    // Justified slot flags relative to `latest_finalized`
+    JustifiedSlotsWindow justified_slots{state.justified_slots.data(),
+                                         latest_finalized.slot};
 
     // Process each attestation in the block.
     for (auto &attestation : attestations) {
@@ -370,9 +410,7 @@ namespace lean {
       }
 
       // Source slot must be justified
-      if (not isSlotJustified(
-                  justified_slots, latest_finalized.slot, source_slot)
-                  .value()) {
+      if (not justified_slots.isJustified(source_slot).value()) {
         continue;
       }
 
@@ -381,8 +419,7 @@ namespace lean {
       // we don't want to re-introduce the target again for remaining votes if
       // the slot is already justified and its tracking already cleared out
       // from justifications map
-      if (isSlotJustified(justified_slots, latest_finalized.slot, target_slot)
-              .value()) {
+      if (justified_slots.isJustified(target_slot).value()) {
         continue;
       }
 
@@ -412,23 +449,16 @@ namespace lean {
       }
 
       // Track attempts to justify new hashes
-      auto justifications_it = justifications.find(target.root);
-      if (justifications_it == justifications.end()) {
-        justifications_it =
-            justifications.emplace(target.root, std::vector<bool>{}).first;
-        justifications_it->second.resize(state.validatorCount());
-      }
+      auto justification_index =
+          justifications.getOrInsert(target.root, target_slot);
 
       for (auto &&validator_id : attestation.aggregation_bits.iter()) {
-        if (validator_id >= justifications_it->second.size()) {
+        if (not justifications.vote(justification_index, validator_id)) {
           return Error::INVALID_VOTER;
         }
-        if (not justifications_it->second.at(validator_id)) {
-          justifications_it->second.at(validator_id) = true;
-        }
       }
 
-      size_t count = std::ranges::count(justifications_it->second, true);
+      size_t count = justifications.count(justification_index);
 
       // If 2/3 attested to the same new valid hash to justify
       // in 3sf mini this is strict equality, but we have updated it to >=
@@ -436,21 +466,15 @@ namespace lean {
       // // 3 to prevent integer division which could lead to less than 2/3 of
       // validators justifying specially if the num_validators is low in
       // testing scenarios
-      if (3 * count >= 2 * state.validatorCount()) {
+      if (count >= supermajorityThreshold(state.validatorCount())) {
         latest_justified = target;
-        withJustified(justified_slots, latest_finalized.slot, target_slot);
-        justifications.erase(target.root);
+        justified_slots.setJustified(target_slot);
+        justifications.erase(justification_index);
 
         // Finalization: if the target is the next valid justifiable
         // hash after the source
-        auto any = false;
-        for (auto slot = source_slot + 1; slot < target_slot; ++slot) {
-          if (isJustifiableSlot(latest_finalized.slot, slot)) {
-            any = true;
-            break;
-          }
-        }
-        if (not any) {
+        if (not anyJustifiableSlotBetween(
+                latest_finalized.slot, source_slot, target_slot)) {
           auto old_finalized_slot = latest_finalized.slot;
           latest_finalized = source;
           //? metrics_->stf_latest_finalized_slot()->set(latest_finalized.slot);
@@ -458,25 +482,21 @@ namespace lean {
           // Rebase/prune justification tracking across the new finalized
           // boundary. The state stores justified slot flags starting at
           // (finalized_slot + 1), so when finalization advances by `delta`, we
-          // drop the first `delta` bits. We also prune any pending
-          // justifications whose latest slot is now finalized (latest <=
-          // finalized_slot).
+          // drop the first `delta` bits, once at the end of block. We also
+          // prune any pending justifications whose latest slot is now
+          // finalized (latest <= finalized_slot).
           auto delta = latest_finalized.slot - old_finalized_slot;
           if (delta > 0) {
-            shiftWindow(justified_slots, delta);
-            retain_if(justifications, [&](const Justifications::value_type &p) {
-              return root_to_slot.at(p.first) > latest_finalized.slot;
-            });
+            justified_slots.finalize(latest_finalized.slot);
+            justifications.retainAfter(latest_finalized.slot);
           }
         }
       }
       metrics_->stf_attestations_processed_total()->inc();
     }
 
-    // Flatten and set updated justifications back to the state
-    setJustifications(state, justifications);
-
     // Apply tracked state changes
+    justified_slots.commit();
     state.latest_justified = latest_justified;
     state.latest_finalized = latest_finalized;
 
@@ -77,23 +77,32 @@ namespace lean {
 
     /**
      * Apply block to parent state.
+     * @param advanced_parent_state `parent_state` already advanced by
+     * `processSlots` to slot not after block slot, or nullptr
      * @returns new state
      */
     [[nodiscard]] outcome::result<State> stateTransition(
         const Block &block,
         const State &parent_state,
-        bool check_state_root) const;
+        bool check_state_root,
+        const State *advanced_parent_state = nullptr) const;
 
     outcome::result<void> processSlots(State &state, Slot slot) const;
     outcome::result<void> processBlock(State &state, const Block &block) const;
 
+    /**
+     * Apply attestations to justifications of state.
+     * Applying attestations in several calls has same effect as applying
+     * them all at once.
+     */
+    outcome::result<void> processAttestations(
+        State &state, const AggregatedAttestations &attestations) const;
+
    private:
     outcome::result<void> processBlockHeader(State &state,
                                              const Block &block) const;
     outcome::result<void> processOperations(State &state,
                                             const BlockBody &body) const;
-    outcome::result<void> processAttestations(
-        State &state, const AggregatedAttestations &attestations) const;
     [[nodiscard]] bool validateProposerIndex(const State &state,
                                              const Block &block) const;
 
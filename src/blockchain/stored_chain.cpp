@@ -0,0 +1,91 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/stored_chain.hpp"
+
+#include <algorithm>
+
+#include "app/configuration.hpp"
+#include "blockchain/impl/block_storage_impl.hpp"
+#include "blockchain/impl/block_value_codec.hpp"
+#include "crypto/hasher/hasher_impl.hpp"
+#include "log/formatters/filepath.hpp"
+#include "log/logger.hpp"
+#include "qtils/value_or_raise.hpp"
+#include "storage/ancient_store.hpp"
+#include "storage/rocksdb/rocksdb.hpp"
+
+namespace lean::blockchain {
+
+  StoredChain::StoredChain(
+      qtils::SharedRef<log::LoggingSystem> logsys,
+      qtils::SharedRef<const app::Configuration> app_config) {
+    auto logger = logsys->getLogger("StoredChain", "fork_choice");
+    auto database = app_config->database();
+    database.directory = app_config->replayDb().value();
+    database.in_memory = false;
+    database.statistics = false;
+    if (not std::filesystem::is_directory(database.directory)) {
+      SL_CRITICAL(logger, "No database at {}", database.directory);
+      qtils::raise(StoredChainError::NO_DATABASE);
+    }
+    db_ = std::make_shared<storage::RocksDb>(logsys, database, nullptr);
+    std::shared_ptr<storage::AncientStore> ancient;
+    if (auto path = database.directory / "ancient"; exists(path)) {
+      ancient = qtils::valueOrRaise(storage::AncientStore::open(path));
+    }
+    block_storage_ = std::make_shared<BlockStorageImpl>(
+        logsys,
+        db_,
+        std::make_shared<crypto::HasherImpl>(),
+        std::move(ancient),
+        std::make_shared<BlockValueCodec>(database.compress_blocks),
+        nullptr,
+        nullptr,
+        nullptr);
+
+    // Genesis block is not replayed
+    auto from = std::max<Slot>(app_config->replaySlots().from, 1);
+    auto &to = app_config->replaySlots().to;
+    auto it = qtils::valueOrRaise(block_storage_->seekLastSlot());
+    auto found = [&] {
+      for (; it.isValid(); --it) {
+        auto slot = it.slot();
+        auto hashes = it.hashes();
+        if (slot < from) {
+          for (auto &hash : hashes) {
+            auto state = qtils::valueOrRaise(block_storage_->getState(hash));
+            if (state.has_value()) {
+              anchor_state_ = std::move(state.value());
+              return true;
+            }
+          }
+        }
+        if (not to.has_value() or slot <= *to) {
+          slots_.emplace_back(slot, std::move(hashes));
+        }
+      }
+      return false;
+    }();
+    if (not found) {
+      SL_CRITICAL(logger, "No state stored before slot {}", from);
+      qtils::raise(StoredChainError::NO_ANCHOR_STATE);
+    }
+    std::ranges::reverse(slots_);
+    SL_INFO(logger,
+            "Replaying {} slots of {} from state of slot {}",
+            slots_.size(),
+            database.directory,
+            anchor_state_.slot);
+  }
+
+  StoredChain::~StoredChain() = default;
+
+  outcome::result<SignedBlock> StoredChain::block(
+      const BlockHash &hash) const {
+    return block_storage_->getSignedBlock(hash);
+  }
+}  // namespace lean::blockchain
@@ -0,0 +1,87 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <qtils/enum_error_code.hpp>
+#include <qtils/outcome.hpp>
+#include <qtils/shared_ref.hpp>
+
+#include "types/signed_block.hpp"
+#include "types/state.hpp"
+
+namespace lean::app {
+  class Configuration;
+}  // namespace lean::app
+
+namespace lean::log {
+  class LoggingSystem;
+}  // namespace lean::log
+
+namespace lean::storage {
+  class RocksDb;
+}  // namespace lean::storage
+
+namespace lean::blockchain {
+  class BlockStorage;
+
+  enum class StoredChainError : uint8_t {
+    NO_DATABASE = 1,
+    NO_ANCHOR_STATE,
+  };
+  Q_ENUM_ERROR_CODE(StoredChainError) {
+    using E = decltype(e);
+    switch (e) {
+      case E::NO_DATABASE:
+        return "Replayed database directory doesn't exist";
+      case E::NO_ANCHOR_STATE:
+        return "No state stored before first replayed slot";
+    }
+    abort();
+  }
+
+  /**
+   * Blocks stored in database of other node, `--replay-db`, opened beside
+   * database of this node.
+   *
+   * States are not stored for every block, so replay starts from anchor:
+   * latest stored state of slot before first replayed one. Blocks between
+   * anchor and first replayed slot are replayed too, as parents.
+   */
+  class StoredChain {
+   public:
+    /// Hashes of blocks stored at slot
+    struct SlotBlocks {
+      Slot slot;
+      std::vector<BlockHash> hashes;
+    };
+
+    StoredChain(qtils::SharedRef<log::LoggingSystem> logsys,
+                qtils::SharedRef<const app::Configuration> app_config);
+
+    ~StoredChain();
+
+    const State &anchorState() const {
+      return anchor_state_;
+    }
+
+    /// Slots with blocks after anchor, ascending
+    const std::vector<SlotBlocks> &slots() const {
+      return slots_;
+    }
+
+    outcome::result<SignedBlock> block(const BlockHash &hash) const;
+
+   private:
+    std::shared_ptr<storage::RocksDb> db_;
+    std::shared_ptr<BlockStorage> block_storage_;
+    State anchor_state_;
+    std::vector<SlotBlocks> slots_;
+  };
+}  // namespace lean::blockchain
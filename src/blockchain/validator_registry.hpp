@@ -6,23 +6,34 @@
 
 #pragma once
 
-#include <unordered_set>
+#include <optional>
+#include <string_view>
+#include <vector>
 
 #include "types/validator_index.hpp"
 
 namespace lean {
   class ValidatorRegistry {
    public:
-    using ValidatorIndices = std::unordered_set<ValidatorIndex>;
+    /// Validator indices in ascending order
+    using ValidatorIndices = std::vector<ValidatorIndex>;
 
     virtual ~ValidatorRegistry() = default;
 
     [[nodiscard]] virtual const ValidatorIndices &currentValidatorIndices()
         const = 0;
 
+    /**
+     * Whether validator is run by this node.
+     * Proposer duty of slot is `isCurrentValidator(slot % validator_count)`.
+     */
+    [[nodiscard]] virtual bool isCurrentValidator(
+        ValidatorIndex index) const = 0;
+
     [[nodiscard]] virtual ValidatorIndices allValidatorsIndices() const = 0;
 
-    [[nodiscard]] virtual std::optional<std::string> nodeIdByIndex(
+    /// Name stays valid while registry exists
+    [[nodiscard]] virtual std::optional<std::string_view> nodeIdByIndex(
         ValidatorIndex index) const = 0;
 
     [[nodiscard]] virtual std::optional<ValidatorIndices>
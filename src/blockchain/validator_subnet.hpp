@@ -6,6 +6,9 @@
 
 #pragma once
 
+#include <set>
+#include <span>
+
 #include "types/config.hpp"
 #include "types/validator_index.hpp"
 
@@ -18,4 +21,23 @@ namespace lean {
                                      uint64_t subnet_count) {
     return validator_index % subnet_count;
   }
+
+  /**
+   * Attestation subnets node takes attestations from: subnets of its
+   * validators, and, while node is aggregator, extra subnets it aggregates.
+   */
+  inline std::set<SubnetIndex> attestationSubnets(
+      std::span<const ValidatorIndex> validator_indices,
+      uint64_t subnet_count,
+      bool is_aggregator,
+      std::span<const SubnetIndex> aggregate_subnets) {
+    std::set<SubnetIndex> subnets;
+    for (auto validator_index : validator_indices) {
+      subnets.emplace(validatorSubnet(validator_index, subnet_count));
+    }
+    if (is_aggregator) {
+      subnets.insert(aggregate_subnets.begin(), aggregate_subnets.end());
+    }
+    return subnets;
+  }
 }  // namespace lean
@@ -0,0 +1,118 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/vote_table.hpp"
+
+#include <stdexcept>
+
+#include <boost/assert.hpp>
+#include <boost/container_hash/hash.hpp>
+
+#include "types/constants.hpp"
+#include "utils/memory_usage.hpp"
+
+namespace lean {
+
+  size_t VoteTable::DataHash::operator()(const AttestationData &data) const {
+    size_t seed = 0;
+    boost::hash_combine(seed, data.slot);
+    for (auto *checkpoint : {&data.head, &data.target, &data.source}) {
+      boost::hash_combine(seed, checkpoint->slot);
+      boost::hash_combine(seed, std::hash<BlockHash>{}(checkpoint->root));
+    }
+    return seed;
+  }
+
+  VoteTable::VoteTable(
+      std::initializer_list<std::pair<ValidatorIndex, AttestationData>>
+          votes) {
+    for (auto &[validator, data] : votes) {
+      insert_or_assign(validator, data);
+    }
+  }
+
+  void VoteTable::clear() {
+    votes_.clear();
+    data_.clear();
+    free_.clear();
+    index_.clear();
+    size_ = 0;
+  }
+
+  const AttestationData *VoteTable::find(ValidatorIndex validator) const {
+    if (validator >= votes_.size() or votes_[validator] == kNoVote) {
+      return nullptr;
+    }
+    return &data_[votes_[validator]].data;
+  }
+
+  const AttestationData &VoteTable::at(ValidatorIndex validator) const {
+    auto data = find(validator);
+    if (data == nullptr) {
+      throw std::out_of_range{"VoteTable::at"};
+    }
+    return *data;
+  }
+
+  void VoteTable::insert_or_assign(ValidatorIndex validator,
+                                   const AttestationData &data) {
+    BOOST_ASSERT(validator < VALIDATOR_REGISTRY_LIMIT);
+    if (validator >= votes_.size()) {
+      votes_.resize(validator + 1, kNoVote);
+    }
+    auto &vote = votes_[validator];
+    if (vote != kNoVote) {
+      if (data_[vote].data == data) {
+        return;
+      }
+      release(vote);
+    } else {
+      ++size_;
+    }
+    vote = intern(data);
+  }
+
+  bool VoteTable::erase(ValidatorIndex validator) {
+    if (validator >= votes_.size() or votes_[validator] == kNoVote) {
+      return false;
+    }
+    release(votes_[validator]);
+    votes_[validator] = kNoVote;
+    --size_;
+    return true;
+  }
+
+  uint32_t VoteTable::intern(const AttestationData &data) {
+    auto it = index_.find(data);
+    if (it == index_.end()) {
+      uint32_t index = 0;
+      if (free_.empty()) {
+        index = data_.size();
+        data_.emplace_back(Entry{.data = data});
+      } else {
+        index = free_.back();
+        free_.pop_back();
+        data_[index].data = data;
+      }
+      it = index_.emplace(data, index).first;
+    }
+    ++data_[it->second].voters;
+    return it->second;
+  }
+
+  void VoteTable::release(uint32_t index) {
+    auto &entry = data_[index];
+    if (--entry.voters == 0) {
+      index_.erase(entry.data);
+      free_.emplace_back(index);
+    }
+  }
+
+  size_t VoteTable::byteSize() const {
+    return memory_usage::vectorBytes(votes_) + memory_usage::vectorBytes(data_)
+         + memory_usage::vectorBytes(free_) + memory_usage::hashBytes(index_);
+  }
+}  // namespace lean
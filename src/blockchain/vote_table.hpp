@@ -0,0 +1,198 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "types/attestation_data.hpp"
+#include "types/validator_index.hpp"
+
+namespace lean {
+  /**
+   * Latest attestation data of each validator.
+   *
+   * Validator indices are dense, so votes are kept in array indexed by
+   * validator, pointing into table of distinct attestation data. Validators
+   * voting the same way (usual case) share one entry, and counting weights
+   * iterates distinct data with number of voters instead of every vote.
+   */
+  class VoteTable {
+   public:
+    struct Vote {
+      ValidatorIndex validator;
+      const AttestationData &data;
+    };
+
+    class Iterator {
+     public:
+      using difference_type = std::ptrdiff_t;
+      using value_type = Vote;
+
+      Iterator() = default;
+      Iterator(const VoteTable *table, size_t index)
+          : table_{table}, index_{index} {
+        skip();
+      }
+
+      Vote operator*() const {
+        return {
+            .validator = index_,
+            .data = table_->data_[table_->votes_[index_]].data,
+        };
+      }
+
+      Iterator &operator++() {
+        ++index_;
+        skip();
+        return *this;
+      }
+
+      Iterator operator++(int) {
+        auto copy = *this;
+        ++*this;
+        return copy;
+      }
+
+      bool operator==(const Iterator &other) const {
+        return index_ == other.index_;
+      }
+
+     private:
+      void skip() {
+        while (index_ < table_->votes_.size()
+               and table_->votes_[index_] == kNoVote) {
+          ++index_;
+        }
+      }
+
+      const VoteTable *table_ = nullptr;
+      size_t index_ = 0;
+    };
+
+    VoteTable() = default;
+    VoteTable(std::initializer_list<std::pair<ValidatorIndex, AttestationData>>
+                  votes);
+
+    size_t size() const {
+      return size_;
+    }
+
+    bool empty() const {
+      return size_ == 0;
+    }
+
+    void clear();
+
+    bool contains(ValidatorIndex validator) const {
+      return find(validator) != nullptr;
+    }
+
+    /// Vote of validator, or nullptr
+    const AttestationData *find(ValidatorIndex validator) const;
+
+    /// Vote of validator, throws `std::out_of_range` if absent
+    const AttestationData &at(ValidatorIndex validator) const;
+
+    void insert_or_assign(ValidatorIndex validator,
+                          const AttestationData &data);
+
+    bool erase(ValidatorIndex validator);
+
+    /**
+     * Set vote of each of `validators` to `data` where `replace(vote)` is
+     * true, `vote` is nullptr if validator has none.
+     * Data is interned once, so participants of aggregate cost one lookup
+     * instead of one per validator.
+     * @return validators whose vote changed
+     */
+    template <typename F>
+    std::vector<ValidatorIndex> assign(
+        std::span<const ValidatorIndex> validators,
+        const AttestationData &data,
+        const F &replace) {
+      std::vector<ValidatorIndex> assigned;
+      // Held while assigning, so `release` of previous votes can't free it
+      auto index = intern(data);
+      for (auto validator : validators) {
+        if (not replace(find(validator))) {
+          continue;
+        }
+        if (validator >= votes_.size()) {
+          votes_.resize(validator + 1, kNoVote);
+        }
+        auto &vote = votes_[validator];
+        if (vote == index) {
+          continue;
+        }
+        if (vote != kNoVote) {
+          release(vote);
+        } else {
+          ++size_;
+        }
+        vote = index;
+        ++data_[index].voters;
+        assigned.emplace_back(validator);
+      }
+      release(index);
+      return assigned;
+    }
+
+    Iterator begin() const {
+      return {this, 0};
+    }
+
+    Iterator end() const {
+      return {this, votes_.size()};
+    }
+
+    /// Call `f(data, voters)` for each distinct attestation data
+    template <typename F>
+    void forEachData(const F &f) const {
+      for (auto &entry : data_) {
+        if (entry.voters != 0) {
+          f(entry.data, entry.voters);
+        }
+      }
+    }
+
+    /// Number of distinct attestation data
+    size_t distinctCount() const {
+      return index_.size();
+    }
+
+    /// Estimated memory used by table
+    size_t byteSize() const;
+
+   private:
+    static constexpr uint32_t kNoVote = UINT32_MAX;
+
+    struct DataHash {
+      size_t operator()(const AttestationData &data) const;
+    };
+
+    struct Entry {
+      AttestationData data;
+      uint32_t voters = 0;
+    };
+
+    uint32_t intern(const AttestationData &data);
+    void release(uint32_t index);
+
+    /// Index in `data_` by validator
+    std::vector<uint32_t> votes_;
+    std::vector<Entry> data_;
+    /// Unused `data_` entries
+    std::vector<uint32_t> free_;
+    std::unordered_map<AttestationData, uint32_t, DataHash> index_;
+    size_t size_ = 0;
+  };
+
+}  // namespace lean
@@ -0,0 +1,29 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lean {
+  /**
+   * Least number of votes out of `validator_count` which is 2/3 majority,
+   * shared by safe target selection and justification.
+   * Same as `3 * votes >= 2 * validator_count`.
+   */
+  constexpr uint64_t supermajorityThreshold(uint64_t validator_count) {
+    return (validator_count * 2 + 2) / 3;
+  }
+
+  /// Number of set bits among `count` bits starting at `first`
+  inline size_t countVotes(std::vector<bool>::const_iterator first,
+                           size_t count) {
+    return std::count(first, first + static_cast<ptrdiff_t>(count), true);
+  }
+}  // namespace lean
@@ -23,4 +23,25 @@ namespace lean::clock {
   class SteadyClockImpl : public SteadyClock,
                           public ClockImpl<std::chrono::steady_clock> {};
 
+  /// System clock stopped at given time, e.g. at start of replayed recording
+  class FrozenSystemClock : public SystemClock {
+   public:
+    explicit FrozenSystemClock(std::chrono::milliseconds time) : time_{time} {}
+
+    TimePoint now() const override {
+      return TimePoint{time_};
+    }
+
+    uint64_t nowSec() const override {
+      return std::chrono::duration_cast<std::chrono::seconds>(time_).count();
+    }
+
+    std::chrono::milliseconds nowMsec() const override {
+      return time_;
+    }
+
+   private:
+    std::chrono::milliseconds time_;
+  };
+
 }  // namespace lean::clock
@@ -0,0 +1,79 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+#include "storage/db_snapshot.hpp"
+
+/**
+ * Archive database directory not written to, e.g. checkpoint made by
+ * "/lean/v0/admin/db_snapshot" API, or extract archive into new database
+ * directory. "-" archive is stdout or stdin, so snapshot can be streamed,
+ * e.g. `curl ... | qlean db import - <db_dir>`.
+ */
+inline int cmdDbSnapshot(auto &&getArg) {
+  auto help =
+      [exe{std::filesystem::path{getArg(0).value()}.filename().string()}] {
+        fmt::println(std::cerr,
+                     "Usage: {0} db snapshot (db_directory) (archive|-)\n"
+                     "       {0} db import (archive|-) (db_directory)",
+                     exe);
+        return EXIT_FAILURE;
+      };
+  auto arg_from = getArg(3);
+  auto arg_to = getArg(4);
+  if (not arg_from.has_value() or not arg_to.has_value()) {
+    return help();
+  }
+
+  if (getArg(2) == "snapshot") {
+    std::filesystem::path directory{*arg_from};
+    if (not std::filesystem::is_directory(directory)) {
+      fmt::println(std::cerr, "No database at {}", *arg_from);
+      return EXIT_FAILURE;
+    }
+    std::ofstream file;
+    if (*arg_to != "-") {
+      file.open(std::filesystem::path{*arg_to},
+                std::ios::binary | std::ios::trunc);
+    }
+    auto res = lean::storage::exportDbSnapshot(
+        directory, *arg_to == "-" ? std::cout : file);
+    if (res.has_error()) {
+      fmt::println(std::cerr, "{}: {}", *arg_to, res.error().message());
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  if (getArg(2) == "import") {
+    std::ifstream file;
+    if (*arg_from != "-") {
+      file.open(std::filesystem::path{*arg_from}, std::ios::binary);
+      if (not file.is_open()) {
+        fmt::println(std::cerr, "Can't read {}", *arg_from);
+        return EXIT_FAILURE;
+      }
+    }
+    auto res = lean::storage::importDbSnapshot(
+        *arg_from == "-" ? std::cin : file, std::filesystem::path{*arg_to});
+    if (res.has_error()) {
+      fmt::println(std::cerr, "{}: {}", *arg_to, res.error().message());
+      return EXIT_FAILURE;
+    }
+    fmt::println(std::cerr, "Database imported into {}", *arg_to);
+    return EXIT_SUCCESS;
+  }
+
+  return help();
+}
@@ -0,0 +1,87 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+
+#include "log/flight_recorder.hpp"
+
+/// Print events of flight recording merged from all threads by time
+inline int cmdFlightDecode(auto &&getArg) {
+  auto path = getArg(2);
+  if (not path.has_value()) {
+    fmt::println(std::cerr, "Usage: flight-decode <recording>");
+    return EXIT_FAILURE;
+  }
+  std::ifstream file{std::filesystem::path{*path}, std::ios::binary};
+  std::string dump{std::istreambuf_iterator<char>{file}, {}};
+  if (not file.is_open()) {
+    fmt::println(std::cerr, "Can't read {}", *path);
+    return EXIT_FAILURE;
+  }
+  auto recording = lean::log::decodeFlightRecording(dump);
+  if (recording.has_error()) {
+    fmt::println(std::cerr, "{}: {}", *path, recording.error().message());
+    return EXIT_FAILURE;
+  }
+
+  struct Line {
+    std::chrono::nanoseconds time;
+    const lean::log::FlightRecording::Thread *thread;
+    const lean::log::FlightRecording::Event *event;
+  };
+  std::vector<Line> lines;
+  for (auto &thread : recording.value().threads) {
+    for (auto &event : thread.events) {
+      lines.emplace_back(Line{event.time, &thread, &event});
+    }
+  }
+  std::ranges::stable_sort(lines, {}, &Line::time);
+
+  auto wall_offset =
+      recording.value().system_time - recording.value().steady_time;
+  // Open spans of each thread, to print duration at end
+  std::map<uint64_t, std::vector<std::chrono::nanoseconds>> open_spans;
+  for (auto &[time, thread, event] : lines) {
+    std::chrono::sys_time<std::chrono::microseconds> wall{
+        std::chrono::duration_cast<std::chrono::microseconds>(time
+                                                              + wall_offset)};
+    std::string duration;
+    auto &spans = open_spans[thread->id];
+    if (event->kind == lean::log::FlightEventKind::BEGIN) {
+      spans.emplace_back(time);
+    } else if (event->kind == lean::log::FlightEventKind::END
+               and not spans.empty()) {
+      duration = fmt::format(
+          " {:.3f}ms",
+          std::chrono::duration<double, std::milli>(time - spans.back())
+              .count());
+      spans.pop_back();
+    }
+    constexpr std::array kKinds{"instant", "begin", "end"};
+    fmt::println("{:%FT%T} {}#{} {:<7} {} {}{}",
+                 wall,
+                 thread->name,
+                 thread->id,
+                 kKinds.at(static_cast<size_t>(event->kind)),
+                 event->name,
+                 event->arg,
+                 duration);
+  }
+  return EXIT_SUCCESS;
+}
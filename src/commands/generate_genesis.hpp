@@ -6,9 +6,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
+#include <optional>
 #include <print>
+#include <thread>
+#include <vector>
 
 #include <fmt/format.h>
 #include <yaml-cpp/yaml.h>
@@ -21,7 +27,9 @@ inline int cmdGenerateGenesis(auto &&getArg) {
   auto cmd = [](std::filesystem::path genesis_directory,
                 size_t validator_count,
                 size_t subnet_count,
-                bool shadow) {
+                bool shadow,
+                size_t threads,
+                std::optional<uint64_t> fixed_genesis_time) {
     auto build_yaml = [](std::filesystem::path path, auto &&build) {
       std::ofstream file{path};
       YAML::Node yaml;
@@ -46,12 +54,6 @@ inline int cmdGenerateGenesis(auto &&getArg) {
       return EXIT_FAILURE;
     }
 
-    auto now = shadow
-                 ? std::chrono::seconds{946684800}
-                 : std::chrono::duration_cast<std::chrono::seconds>(
-                       std::chrono::system_clock::now().time_since_epoch());
-    uint64_t genesis_time = (now + std::chrono::seconds{3}).count();
-
     const auto xmss_activation_epoch = 0;
     const auto xmss_active_epoch_log = 18;
     const auto xmss_active_epoch =
@@ -64,42 +66,115 @@ inline int cmdGenerateGenesis(auto &&getArg) {
 
     auto fake_xmss = shadow;
 
-    std::vector<lean::crypto::xmss::XmssPublicKey> xmss_public_keys;
+    std::vector<lean::crypto::xmss::XmssPublicKey> xmss_public_keys(
+        validator_count);
     if (not fake_xmss) {
-      for (size_t index = 0; index < validator_count; ++index) {
-        auto xmss_public_key_path =
-            hashsig_directory / xmss_public_key_name(index);
-        auto xmss_private_key_path =
-            hashsig_directory / xmss_private_key_name(index);
-        if (std::filesystem::exists(xmss_public_key_path)
-            and std::filesystem::exists(xmss_private_key_path)) {
-          auto keypair_result = lean::crypto::xmss::loadKeypair(
-              xmss_private_key_path, xmss_public_key_path);
-          if (not keypair_result) {
-            fmt::println(std::cerr,
-                         "Error loading XMSS keypair: {}",
-                         keypair_result.error().message());
-            fmt::println(std::cerr, "  {}", xmss_public_key_path.string());
-            fmt::println(std::cerr, "  {}", xmss_private_key_path.string());
-            return EXIT_FAILURE;
+      // Keys of validators are generated by several threads. Private key
+      // is written before public one, both through temporary file, so run
+      // interrupted at any point is resumed from keys written completely.
+      std::atomic_size_t next = 0;
+      std::atomic_bool failed = false;
+      std::mutex progress_mutex;
+      size_t loaded = 0;
+      size_t generated = 0;
+      auto started = std::chrono::steady_clock::now();
+      auto progress = [&](bool generated_now) {
+        std::lock_guard lock{progress_mutex};
+        ++(generated_now ? generated : loaded);
+        auto done = loaded + generated;
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now() - started);
+        // Loaded keys take no time, left ones are estimated by generated
+        std::chrono::seconds eta{0};
+        if (generated != 0) {
+          eta = elapsed * static_cast<int64_t>(validator_count - done)
+              / static_cast<int64_t>(generated);
+        }
+        constexpr size_t kWidth = 30;
+        auto filled = kWidth * done / validator_count;
+        fmt::print(std::cerr,
+                   "\rXMSS keys [{}{}] {}/{}, {} loaded, {}s elapsed, "
+                   "~{}s left ",
+                   std::string(filled, '#'),
+                   std::string(kWidth - filled, ' '),
+                   done,
+                   validator_count,
+                   loaded,
+                   elapsed.count(),
+                   eta.count());
+        if (done == validator_count) {
+          fmt::println(std::cerr, "");
+        }
+      };
+      auto write_atomic = [&](const std::filesystem::path &path,
+                              qtils::BytesIn bytes) {
+        auto tmp = path;
+        tmp += ".tmp";
+        write(tmp, bytes);
+        std::filesystem::rename(tmp, path);
+      };
+      auto keygen = [&] {
+        lean::crypto::xmss::XmssProviderImpl provider;
+        for (auto index = next++; index < validator_count and not failed;
+             index = next++) try {
+          auto xmss_public_key_path =
+              hashsig_directory / xmss_public_key_name(index);
+          auto xmss_private_key_path =
+              hashsig_directory / xmss_private_key_name(index);
+          if (std::filesystem::exists(xmss_public_key_path)
+              and std::filesystem::exists(xmss_private_key_path)) {
+            auto keypair_result = lean::crypto::xmss::loadKeypair(
+                xmss_private_key_path, xmss_public_key_path);
+            if (not keypair_result) {
+              std::lock_guard lock{progress_mutex};
+              fmt::println(std::cerr,
+                           "\nError loading XMSS keypair: {}",
+                           keypair_result.error().message());
+              fmt::println(std::cerr, "  {}", xmss_public_key_path.string());
+              fmt::println(std::cerr, "  {}", xmss_private_key_path.string());
+              failed = true;
+              return;
+            }
+            xmss_public_keys.at(index) = keypair_result.value().public_key;
+            progress(false);
+          } else {
+            auto keypair = provider.generateKeypair(xmss_activation_epoch,
+                                                    xmss_active_epoch);
+            write_atomic(xmss_private_key_path,
+                         lean::crypto::xmss::toBytes(keypair.private_key));
+            write_atomic(xmss_public_key_path, keypair.public_key);
+            xmss_public_keys.at(index) = keypair.public_key;
+            progress(true);
           }
-          auto &keypair = keypair_result.value();
-          xmss_public_keys.emplace_back(keypair.public_key);
-        } else {
-          fmt::println(
-              std::cerr, "Generating XMSS keypair for validator {}", index);
-          auto keypair = lean::crypto::xmss::XmssProviderImpl{}.generateKeypair(
-              xmss_activation_epoch, xmss_active_epoch);
-          write(xmss_private_key_path,
-                lean::crypto::xmss::toBytes(keypair.private_key));
-          write(xmss_public_key_path, keypair.public_key);
-          xmss_public_keys.emplace_back(keypair.public_key);
+        } catch (const std::exception &e) {
+          std::lock_guard lock{progress_mutex};
+          fmt::println(std::cerr,
+                       "\nError generating XMSS keypair {}: {}",
+                       index,
+                       e.what());
+          failed = true;
+          return;
+        }
+      };
+      {
+        std::vector<std::jthread> workers;
+        for (size_t i = 0; i < std::min(threads, validator_count); ++i) {
+          workers.emplace_back(keygen);
         }
       }
-    } else {
-      xmss_public_keys.resize(validator_count);
+      if (failed) {
+        return EXIT_FAILURE;
+      }
     }
 
+    // After keygen, which takes long for many validators
+    auto now = shadow
+                 ? std::chrono::seconds{946684800}
+                 : std::chrono::duration_cast<std::chrono::seconds>(
+                       std::chrono::system_clock::now().time_since_epoch());
+    uint64_t genesis_time = fixed_genesis_time.value_or(
+        (now + std::chrono::seconds{3}).count());
+
     build_yaml(
         hashsig_directory / "validator-keys-manifest.yaml",
         [&](YAML::Node &yaml) {
@@ -185,7 +260,8 @@ inline int cmdGenerateGenesis(auto &&getArg) {
       [exe{std::filesystem::path{getArg(0).value()}.filename().string()}] {
         fmt::println(std::cerr,
                      "Usage: {} generate-genesis (genesis_directory) "
-                     "(validator_count) (subnet_count) (shadow?)",
+                     "(validator_count) (subnet_count) (shadow?) "
+                     "[--threads (count)] [--genesis-time (unix_seconds)]",
                      exe);
         return EXIT_FAILURE;
       };
@@ -210,10 +286,27 @@ inline int cmdGenerateGenesis(auto &&getArg) {
   if (subnet_count == 0) {
     return help();
   }
-  auto arg_5 = getArg(5);
-  auto shadow = arg_5 == "shadow";
-  if (arg_5.has_value() and not shadow) {
-    return help();
+  auto shadow = false;
+  size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  std::optional<uint64_t> genesis_time;
+  for (size_t i = 5; auto arg = getArg(i); ++i) {
+    if (arg == "shadow" and i == 5) {
+      shadow = true;
+    } else if (arg == "--threads" and getArg(i + 1)) {
+      threads = std::stoul(std::string{*getArg(++i)});
+      if (threads == 0) {
+        return help();
+      }
+    } else if (arg == "--genesis-time" and getArg(i + 1)) {
+      genesis_time = std::stoull(std::string{*getArg(++i)});
+    } else {
+      return help();
+    }
   }
-  return cmd(genesis_directory, validator_count, subnet_count, shadow);
+  return cmd(genesis_directory,
+             validator_count,
+             subnet_count,
+             shadow,
+             threads,
+             genesis_time);
 }
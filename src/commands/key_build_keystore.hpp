@@ -0,0 +1,84 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+#include <yaml-cpp/yaml.h>
+
+#include "crypto/xmss/xmss_keystore.hpp"
+#include "crypto/xmss/xmss_util.hpp"
+
+/**
+ * Pack private keys of validators of node into keystore, which node loads
+ * with "--validator-keystore" faster than separate key files.
+ */
+inline int cmdKeyBuildKeystore(auto &&getArg) {
+  auto help =
+      [exe{std::filesystem::path{getArg(0).value()}.filename().string()}] {
+        fmt::println(std::cerr,
+                     "Usage: {} key build-keystore (genesis_directory) "
+                     "(node_id) (output?)",
+                     exe);
+        return EXIT_FAILURE;
+      };
+  auto arg_genesis = getArg(3);
+  auto arg_node_id = getArg(4);
+  if (not arg_genesis.has_value() or not arg_node_id.has_value()) {
+    return help();
+  }
+  std::filesystem::path genesis_directory{*arg_genesis};
+  std::string node_id{*arg_node_id};
+  auto keys_directory = genesis_directory / "hash-sig-keys";
+  auto arg_output = getArg(5);
+  auto output = arg_output.has_value()
+                  ? std::filesystem::path{*arg_output}
+                  : keys_directory / fmt::format("{}.keystore", node_id);
+
+  std::vector<lean::crypto::xmss::XmssKeypair> keypairs;
+  try {
+    auto yaml = YAML::LoadFile(
+        (genesis_directory / "annotated_validators.yaml").string());
+    for (auto &&yaml_item : yaml[node_id]) {
+      auto public_key = lean::crypto::xmss::XmssPublicKey::fromHex(
+                            yaml_item["pubkey_hex"].as<std::string>())
+                            .value();
+      auto path = keys_directory / yaml_item["privkey_file"].as<std::string>();
+      auto keypair_result = lean::crypto::xmss::loadKeypair(public_key, path);
+      if (not keypair_result) {
+        fmt::println(std::cerr,
+                     "Error loading XMSS key {}: {}",
+                     path.string(),
+                     keypair_result.error().message());
+        return EXIT_FAILURE;
+      }
+      keypairs.emplace_back(std::move(keypair_result.value()));
+    }
+  } catch (const std::exception &e) {
+    fmt::println(std::cerr, "Error reading validators: {}", e.what());
+    return EXIT_FAILURE;
+  }
+  if (keypairs.empty()) {
+    fmt::println(std::cerr, "No validators of node {}", node_id);
+    return EXIT_FAILURE;
+  }
+
+  auto write_result = lean::crypto::xmss::XmssKeystore::write(output, keypairs);
+  if (not write_result) {
+    fmt::println(std::cerr,
+                 "Error writing keystore {}: {}",
+                 output.string(),
+                 write_result.error().message());
+    return EXIT_FAILURE;
+  }
+  fmt::println("{}", output.string());
+  return EXIT_SUCCESS;
+}
@@ -6,6 +6,8 @@
 
 #include "crypto/sha/sha256.hpp"
 
+#include <boost/assert.hpp>
+#include <hashtree.h>
 #include <openssl/sha.h>
 
 namespace lean::crypto {
@@ -23,4 +25,12 @@ namespace lean::crypto {
     SHA256_Final(out.data(), &ctx);
     return out;
   }
+
+  void sha256Pairs(std::span<Hash256> output, qtils::ByteView input) {
+    BOOST_ASSERT(input.size() == 2 * sizeof(Hash256) * output.size());
+    if (output.empty()) {
+      return;
+    }
+    hashtree_hash(output.front().data(), input.data(), output.size());
+  }
 }  // namespace lean::crypto
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <span>
 #include <string_view>
 
 #include "crypto/hash_types.hpp"
@@ -26,4 +27,14 @@ namespace lean::crypto {
    */
   Hash256 sha256(qtils::ByteView input);
 
+  /**
+   * Take SHA-256 hashes of consecutive 64-byte blocks, e.g. pairs of merkle
+   * tree children.
+   * Blocks are hashed by multi-buffer SHA-NI, AVX2 or AVX-512 kernel,
+   * chosen at runtime for current CPU.
+   * @param input `output.size()` blocks of 64 bytes
+   * @param output hash of each block
+   */
+  void sha256Pairs(std::span<Hash256> output, qtils::ByteView input);
+
 }  // namespace lean::crypto
@@ -0,0 +1,113 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+
+namespace lean::crypto::xmss {
+  /**
+   * Estimate of proving time, as `base + signature * n + child * m` for
+   * `n` raw signatures and `m` child proofs.
+   * Learned from measured building times by normalized least mean squares,
+   * so it follows the machine without calibration.
+   */
+  class AggregationCostModel {
+   public:
+    struct Coefficients {
+      double base = 0.02;
+      double signature = 0.005;
+      double child = 0.05;
+    };
+
+    /// Weight of new observation
+    static constexpr double kLearningRate = 0.2;
+
+    double estimate(size_t signatures, size_t children) const {
+      std::lock_guard lock{mutex_};
+      return estimate(coefficients_, signatures, children);
+    }
+
+    /// Learn from building time of proof
+    void observe(size_t signatures, size_t children, double seconds) {
+      std::lock_guard lock{mutex_};
+      auto &c = coefficients_;
+      auto error = seconds - estimate(c, signatures, children);
+      auto n = static_cast<double>(signatures);
+      auto m = static_cast<double>(children);
+      auto step = kLearningRate * error / (1 + n * n + m * m);
+      c.base = std::max(0.0, c.base + step);
+      c.signature = std::max(0.0, c.signature + step * n);
+      c.child = std::max(0.0, c.child + step * m);
+    }
+
+    Coefficients coefficients() const {
+      std::lock_guard lock{mutex_};
+      return coefficients_;
+    }
+
+   private:
+    static double estimate(const Coefficients &c,
+                           size_t signatures,
+                           size_t children) {
+      return c.base + c.signature * static_cast<double>(signatures)
+           + c.child * static_cast<double>(children);
+    }
+
+    mutable std::mutex mutex_;
+    Coefficients coefficients_;
+  };
+
+  /**
+   * How to prove one group: raw signatures are split into `leaves`
+   * balanced batches proved in parallel, then leaf proofs and existing
+   * child proofs are merged by levels of at most `kMaxFanIn` children.
+   * Single leaf without merge is flat aggregation.
+   */
+  struct AggregationPlan {
+    /// Leaf batches need at least this many signatures to be worth proof
+    static constexpr size_t kMinLeafSignatures = 8;
+    /// Children of one merge proof
+    static constexpr size_t kMaxFanIn = 8;
+
+    size_t leaves = 1;
+    /// Estimated wall time, seconds
+    double seconds = 0;
+
+    bool flat() const {
+      return leaves <= 1;
+    }
+
+    /**
+     * Plan with least estimated wall time.
+     * @param threads workers available to this group
+     */
+    static AggregationPlan make(const AggregationCostModel &cost,
+                                size_t signatures,
+                                size_t children,
+                                size_t threads) {
+      AggregationPlan best{.seconds = cost.estimate(signatures, children)};
+      auto max_leaves =
+          std::min(std::max<size_t>(threads, 1),
+                   signatures / kMinLeafSignatures);
+      for (size_t leaves = 2; leaves <= max_leaves; ++leaves) {
+        auto per_leaf = (signatures + leaves - 1) / leaves;
+        auto seconds = cost.estimate(per_leaf, 0);
+        // Merges of one level run in parallel, levels run in sequence
+        for (auto proofs = leaves + children; proofs > 1;
+             proofs = (proofs + kMaxFanIn - 1) / kMaxFanIn) {
+          seconds += cost.estimate(0, std::min(proofs, kMaxFanIn));
+        }
+        if (seconds < best.seconds) {
+          best = {.leaves = leaves, .seconds = seconds};
+        }
+      }
+      return best;
+    }
+  };
+}  // namespace lean::crypto::xmss
@@ -7,6 +7,8 @@
 #pragma once
 
 #include <memory>
+#include <span>
+#include <vector>
 
 #include <c_hash_sig/c_hash_sig.h>
 #include <qtils/bytes.hpp>
@@ -18,8 +20,44 @@ namespace lean::crypto::xmss {
     XmssPrivateKey private_key;
     XmssPublicKey public_key;
   };
+  /**
+   * Public key owned elsewhere, e.g. by validators of immutable state.
+   * Participant lists refer to keys instead of copying them.
+   */
+  using XmssPublicKeyRef = const XmssPublicKey *;
   using XmssMessage = qtils::ByteArr<PQ_MESSAGE_SIZE>;
   using XmssSignature = qtils::ByteArr<PQ_SIGNATURE_SIZE>;
   using XmssAggregatedSignature = qtils::ByteVec;
   using XmssAggregatedSignatureIn = qtils::ByteView;
+
+  /**
+   * Single aggregated signature verification request.
+   * Refers to memory owned by caller.
+   */
+  struct XmssVerifyItem {
+    std::span<const XmssPublicKeyRef> public_keys;
+    uint32_t epoch;
+    XmssMessage message;
+    XmssAggregatedSignatureIn aggregated_signature;
+  };
+
+  /// Single signing request
+  struct XmssSignItem {
+    XmssPrivateKey private_key;
+    uint32_t epoch;
+    XmssMessage message;
+  };
+
+  /**
+   * Single signature aggregation request.
+   * Refers to memory owned by caller.
+   */
+  struct XmssAggregateItem {
+    std::span<const std::vector<XmssPublicKeyRef>> child_public_keys;
+    std::span<const XmssAggregatedSignature> child_proofs;
+    std::span<const XmssPublicKeyRef> public_keys;
+    std::span<const XmssSignature> signatures;
+    uint32_t epoch;
+    XmssMessage message;
+  };
 }  // namespace lean::crypto::xmss
@@ -0,0 +1,89 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * C ABI of XMSS accelerator plugin, loaded by `--xmss-accelerator`.
+ * Plugin is shared library, e.g. GPU or FPGA prover and verifier, built
+ * against same hash-sig parameters as node. It exports
+ * `QLEAN_XMSS_ACCELERATOR_SYMBOL` of type `QleanXmssAcceleratorOpen`.
+ * Node calls plugin from single thread, with batches of jobs.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define QLEAN_XMSS_ACCELERATOR_ABI 1
+#define QLEAN_XMSS_ACCELERATOR_SYMBOL "qlean_xmss_accelerator"
+
+/// Bytes owned by node, or by plugin for proofs it returns
+typedef struct {
+  const uint8_t *data;
+  size_t size;
+} QleanXmssBytes;
+
+/// Verification of aggregated signature
+typedef struct {
+  /// `public_key_count` pointers to serialized public keys
+  const uint8_t *const *public_keys;
+  size_t public_key_count;
+  uint32_t epoch;
+  const uint8_t *message;
+  QleanXmssBytes proof;
+} QleanXmssVerifyJob;
+
+/// Aggregation of signatures and child proofs into single proof
+typedef struct {
+  /// Public keys of all children, `child_public_key_counts[i]` of child i
+  const uint8_t *const *child_public_keys;
+  const size_t *child_public_key_counts;
+  const QleanXmssBytes *child_proofs;
+  size_t child_count;
+  /// `count` pointers to public keys and to their signatures
+  const uint8_t *const *public_keys;
+  const uint8_t *const *signatures;
+  size_t count;
+  uint32_t epoch;
+  const uint8_t *message;
+  size_t log_inv_rate;
+} QleanXmssAggregateJob;
+
+typedef struct {
+  uint32_t abi_version;
+  /// Device name for logs, e.g. "cuda:0"
+  const char *name;
+  /// Sizes plugin was built with, must match node
+  size_t public_key_size;
+  size_t signature_size;
+  size_t message_size;
+  void *ctx;
+  /// Write 1 into `results[i]` if job i is valid, 0 otherwise.
+  /// May be null if device doesn't verify. @return 0 on success
+  int (*verify)(void *ctx,
+                const QleanXmssVerifyJob *jobs,
+                size_t count,
+                uint8_t *results);
+  /// Write proof of job i into `proofs[i]`, released by `free_proof`.
+  /// May be null if device doesn't aggregate. @return 0 on success
+  int (*aggregate)(void *ctx,
+                   const QleanXmssAggregateJob *jobs,
+                   size_t count,
+                   QleanXmssBytes *proofs);
+  void (*free_proof)(void *ctx, QleanXmssBytes proof);
+} QleanXmssAccelerator;
+
+/// @return null if plugin doesn't support `abi_version` or finds no device
+typedef const QleanXmssAccelerator *(*QleanXmssAcceleratorOpen)(
+    uint32_t abi_version);
+
+#ifdef __cplusplus
+}
+#endif
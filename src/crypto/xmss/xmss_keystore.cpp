@@ -0,0 +1,143 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "crypto/xmss/xmss_keystore.hpp"
+
+#include <bit>
+#include <cstring>
+#include <fstream>
+
+#include "crypto/xmss/xmss_util.hpp"
+
+OUTCOME_CPP_DEFINE_CATEGORY(lean::crypto::xmss, XmssKeystoreError, e) {
+  using E = lean::crypto::xmss::XmssKeystoreError;
+  switch (e) {
+    case E::BadFormat:
+      return "Bad keystore format";
+    case E::KeyNotFound:
+      return "Key not found in keystore";
+    case E::WriteFailed:
+      return "Failed to write keystore";
+  }
+  return "Unknown XmssKeystoreError";
+}
+
+namespace lean::crypto::xmss {
+  static_assert(std::endian::native == std::endian::little,
+                "Keystore integers are stored in native little endian order");
+
+  namespace {
+    constexpr std::string_view kMagic = "QLEANKS1";
+
+    constexpr size_t kIndexEntrySize =
+        std::tuple_size_v<XmssPublicKey> + 2 * sizeof(uint64_t);
+    constexpr size_t kHeaderSize = kMagic.size() + sizeof(uint64_t);
+
+    uint64_t readU64(std::span<const uint8_t> bytes) {
+      uint64_t value = 0;
+      std::memcpy(&value, bytes.data(), sizeof(value));
+      return value;
+    }
+
+    void appendU64(qtils::ByteVec &out, uint64_t value) {
+      auto bytes = std::bit_cast<std::array<uint8_t, sizeof(value)>>(value);
+      out.insert(out.end(), bytes.begin(), bytes.end());
+    }
+  }  // namespace
+
+  XmssKeystore::XmssKeystore(MappedFile file) : file_{std::move(file)} {}
+
+  outcome::result<std::unique_ptr<XmssKeystore>> XmssKeystore::open(
+      const std::filesystem::path &path) {
+    BOOST_OUTCOME_TRY(auto file, MappedFile::open(path));
+    std::unique_ptr<XmssKeystore> keystore{new XmssKeystore{std::move(file)}};
+    auto bytes = keystore->file_.bytes();
+    if (bytes.size() < kHeaderSize
+        or std::memcmp(bytes.data(), kMagic.data(), kMagic.size()) != 0) {
+      return XmssKeystoreError::BadFormat;
+    }
+    auto count = readU64(bytes.subspan(kMagic.size()));
+    if (count > (bytes.size() - kHeaderSize) / kIndexEntrySize) {
+      return XmssKeystoreError::BadFormat;
+    }
+    auto index = bytes.subspan(kHeaderSize, count * kIndexEntrySize);
+    for (uint64_t i = 0; i < count; ++i) {
+      auto entry = index.subspan(i * kIndexEntrySize, kIndexEntrySize);
+      auto public_key = XmssPublicKey::fromSpan(
+                            entry.first(std::tuple_size_v<XmssPublicKey>))
+                            .value();
+      auto offset = readU64(entry.subspan(public_key.size()));
+      auto size = readU64(entry.subspan(public_key.size() + sizeof(uint64_t)));
+      if (offset > bytes.size() or size > bytes.size() - offset) {
+        return XmssKeystoreError::BadFormat;
+      }
+      keystore->keys_.emplace(public_key, bytes.subspan(offset, size));
+    }
+    return keystore;
+  }
+
+  outcome::result<void> XmssKeystore::write(
+      const std::filesystem::path &path,
+      std::span<const XmssKeypair> keypairs) {
+    std::vector<qtils::ByteVec> secret_keys;
+    secret_keys.reserve(keypairs.size());
+    for (auto &keypair : keypairs) {
+      secret_keys.emplace_back(toBytes(keypair.private_key));
+    }
+
+    qtils::ByteVec out;
+    out.insert(out.end(), kMagic.begin(), kMagic.end());
+    appendU64(out, keypairs.size());
+    uint64_t offset = kHeaderSize + keypairs.size() * kIndexEntrySize;
+    for (size_t i = 0; i < keypairs.size(); ++i) {
+      auto &public_key = keypairs[i].public_key;
+      out.insert(out.end(), public_key.begin(), public_key.end());
+      appendU64(out, offset);
+      appendU64(out, secret_keys[i].size());
+      offset += secret_keys[i].size();
+    }
+    for (auto &secret_key : secret_keys) {
+      out.insert(out.end(), secret_key.begin(), secret_key.end());
+    }
+
+    // Written aside and renamed, so node never sees partial keystore
+    auto tmp = path;
+    tmp += ".tmp";
+    {
+      std::ofstream file{tmp, std::ios::binary | std::ios::trunc};
+      file.write(reinterpret_cast<const char *>(out.data()),
+                 static_cast<std::streamsize>(out.size()));
+      file.flush();
+      if (not file) {
+        return XmssKeystoreError::WriteFailed;
+      }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+      return XmssKeystoreError::WriteFailed;
+    }
+    return outcome::success();
+  }
+
+  bool XmssKeystore::contains(const XmssPublicKey &public_key) const {
+    return keys_.contains(public_key);
+  }
+
+  outcome::result<XmssKeypair> XmssKeystore::load(
+      const XmssPublicKey &public_key) const {
+    auto it = keys_.find(public_key);
+    if (it == keys_.end()) {
+      return XmssKeystoreError::KeyNotFound;
+    }
+    BOOST_OUTCOME_TRY(auto private_key, secretKeyFromBytes(it->second));
+    return XmssKeypair{
+        .private_key = std::move(private_key),
+        .public_key = public_key,
+    };
+  }
+
+}  // namespace lean::crypto::xmss
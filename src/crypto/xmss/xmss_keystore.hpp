@@ -0,0 +1,59 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <unordered_map>
+
+#include <qtils/enum_error_code.hpp>
+#include <qtils/outcome.hpp>
+
+#include "crypto/xmss/types.hpp"
+#include "utils/mapped_file.hpp"
+
+namespace lean::crypto::xmss {
+
+  enum class XmssKeystoreError : uint8_t {
+    BadFormat,
+    KeyNotFound,
+    WriteFailed,
+  };
+
+  /**
+   * Compact binary keystore of validator keys of node, built by
+   * `qlean key build-keystore`.
+   *
+   * Layout: magic, key count, index of public key with offset and size of
+   * secret key, then secret keys in bytes encoding. File is memory mapped,
+   * secret key is parsed only when loaded, without reading other keys.
+   */
+  class XmssKeystore {
+   public:
+    static outcome::result<std::unique_ptr<XmssKeystore>> open(
+        const std::filesystem::path &path);
+
+    static outcome::result<void> write(const std::filesystem::path &path,
+                                       std::span<const XmssKeypair> keypairs);
+
+    bool contains(const XmssPublicKey &public_key) const;
+
+    /// Parse keypair, thread safe
+    outcome::result<XmssKeypair> load(const XmssPublicKey &public_key) const;
+
+   private:
+    explicit XmssKeystore(MappedFile file);
+
+    MappedFile file_;
+    /// Secret key bytes by public key, point into `file_`
+    std::unordered_map<XmssPublicKey, std::span<const uint8_t>> keys_;
+  };
+
+}  // namespace lean::crypto::xmss
+
+OUTCOME_HPP_DECLARE_ERROR(lean::crypto::xmss, XmssKeystoreError);
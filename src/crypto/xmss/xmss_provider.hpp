@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "crypto/xmss/types.hpp"
 
 namespace lean::crypto::xmss {
@@ -17,6 +19,12 @@ namespace lean::crypto::xmss {
     virtual XmssKeypair generateKeypair(uint64_t activation_epoch,
                                         uint64_t num_active_epochs) = 0;
 
+    /**
+     * Sign `message` for `epoch`.
+     * Binding exposes signing as single `pq_sign` call, epoch state of
+     * secret key can't be prepared separately. Key must never sign two
+     * different messages for one epoch, so signing can't be done ahead.
+     */
     virtual XmssSignature sign(XmssPrivateKey xmss_private_key,
                                uint32_t epoch,
                                const XmssMessage &message) = 0;
@@ -27,17 +35,71 @@ namespace lean::crypto::xmss {
                         const XmssSignature &xmss_signature) = 0;
 
     [[nodiscard]] virtual XmssAggregatedSignature aggregateSignatures(
-        std::span<const std::vector<XmssPublicKey>> child_public_keys,
+        std::span<const std::vector<XmssPublicKeyRef>> child_public_keys,
         std::span<const XmssAggregatedSignature> child_proofs,
-        std::span<const XmssPublicKey> public_keys,
+        std::span<const XmssPublicKeyRef> public_keys,
         std::span<const XmssSignature> signatures,
         uint32_t epoch,
         const XmssMessage &message) const = 0;
 
     [[nodiscard]] virtual bool verifyAggregatedSignatures(
-        std::span<const XmssPublicKey> public_keys,
+        std::span<const XmssPublicKeyRef> public_keys,
         uint32_t epoch,
         const XmssMessage &message,
         XmssAggregatedSignatureIn aggregated_signature) const = 0;
+
+    /**
+     * Verify many aggregated signatures at once.
+     * Implementation may verify items concurrently.
+     * @return verification result for each item, in the same order
+     */
+    [[nodiscard]] virtual std::vector<bool> verifyBatch(
+        std::span<const XmssVerifyItem> items) const {
+      std::vector<bool> results;
+      results.reserve(items.size());
+      for (auto &item : items) {
+        results.emplace_back(
+            verifyAggregatedSignatures(item.public_keys,
+                                       item.epoch,
+                                       item.message,
+                                       item.aggregated_signature));
+      }
+      return results;
+    }
+
+    /**
+     * Sign many messages at once, with different private keys.
+     * Implementation may sign items concurrently.
+     * @return signature for each item, in the same order
+     */
+    [[nodiscard]] virtual std::vector<XmssSignature> signBatch(
+        std::span<const XmssSignItem> items) {
+      std::vector<XmssSignature> results;
+      results.reserve(items.size());
+      for (auto &item : items) {
+        results.emplace_back(sign(item.private_key, item.epoch, item.message));
+      }
+      return results;
+    }
+
+    /**
+     * Aggregate signatures of many independent groups at once.
+     * Implementation may aggregate items concurrently.
+     * @return aggregated signature for each item, in the same order
+     */
+    [[nodiscard]] virtual std::vector<XmssAggregatedSignature> aggregateBatch(
+        std::span<const XmssAggregateItem> items) const {
+      std::vector<XmssAggregatedSignature> results;
+      results.reserve(items.size());
+      for (auto &item : items) {
+        results.emplace_back(aggregateSignatures(item.child_public_keys,
+                                                 item.child_proofs,
+                                                 item.public_keys,
+                                                 item.signatures,
+                                                 item.epoch,
+                                                 item.message));
+      }
+      return results;
+    }
   };
 }  // namespace lean::crypto::xmss
@@ -0,0 +1,479 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "crypto/xmss/xmss_provider_accelerated.hpp"
+
+#include <chrono>
+#include <stdexcept>
+
+#include <dlfcn.h>
+
+#include "app/configuration.hpp"
+#include "crypto/xmss/xmss_provider_impl.hpp"
+#include "metrics/metrics.hpp"
+#include "utils/thread_placement.hpp"
+
+namespace lean::crypto::xmss {
+  outcome::result<std::shared_ptr<XmssAccelerator>> XmssAccelerator::open(
+      const std::filesystem::path &path) {
+    auto *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr) {
+      return XmssAcceleratorError::OPEN;
+    }
+    std::shared_ptr<void> library{handle, dlclose};
+    auto open = reinterpret_cast<QleanXmssAcceleratorOpen>(
+        dlsym(handle, QLEAN_XMSS_ACCELERATOR_SYMBOL));
+    if (open == nullptr) {
+      return XmssAcceleratorError::SYMBOL;
+    }
+    auto *api = open(QLEAN_XMSS_ACCELERATOR_ABI);
+    if (api == nullptr) {
+      return XmssAcceleratorError::NO_DEVICE;
+    }
+    if (api->abi_version != QLEAN_XMSS_ACCELERATOR_ABI) {
+      return XmssAcceleratorError::ABI_VERSION;
+    }
+    if (api->public_key_size != PQ_PUBLIC_KEY_SIZE
+        or api->signature_size != PQ_SIGNATURE_SIZE
+        or api->message_size != PQ_MESSAGE_SIZE) {
+      return XmssAcceleratorError::PARAMETERS;
+    }
+    return std::make_shared<XmssAccelerator>(*api, std::move(library));
+  }
+
+  XmssAccelerator::XmssAccelerator(const QleanXmssAccelerator &api,
+                                   std::shared_ptr<void> library)
+      : library_{std::move(library)}, api_{&api} {}
+
+  std::string_view XmssAccelerator::name() const {
+    return api_->name != nullptr ? api_->name : "";
+  }
+
+  bool XmssAccelerator::canVerify() const {
+    return api_->verify != nullptr;
+  }
+
+  bool XmssAccelerator::canAggregate() const {
+    return api_->aggregate != nullptr;
+  }
+
+  std::optional<std::vector<bool>> XmssAccelerator::verify(
+      std::span<const XmssVerifyItem> items) const {
+    std::vector<const uint8_t *> keys;
+    std::vector<size_t> offsets;
+    offsets.reserve(items.size());
+    for (auto &item : items) {
+      offsets.emplace_back(keys.size());
+      for (auto *key : item.public_keys) {
+        keys.emplace_back(key->data());
+      }
+    }
+    std::vector<QleanXmssVerifyJob> jobs;
+    jobs.reserve(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+      auto &item = items[i];
+      jobs.emplace_back(QleanXmssVerifyJob{
+          .public_keys = keys.data() + offsets[i],
+          .public_key_count = item.public_keys.size(),
+          .epoch = item.epoch,
+          .message = item.message.data(),
+          .proof = {item.aggregated_signature.data(),
+                    item.aggregated_signature.size()},
+      });
+    }
+    std::vector<uint8_t> results(items.size());
+    if (api_->verify(api_->ctx, jobs.data(), jobs.size(), results.data())
+        != 0) {
+      return std::nullopt;
+    }
+    return std::vector<bool>(results.begin(), results.end());
+  }
+
+  std::optional<std::vector<XmssAggregatedSignature>>
+  XmssAccelerator::aggregate(std::span<const XmssAggregateItem> items) const {
+    // Arrays of all items, referred by jobs once they stop growing
+    struct Offsets {
+      size_t child_keys;
+      size_t children;
+      size_t keys;
+    };
+    std::vector<const uint8_t *> keys;
+    std::vector<const uint8_t *> signatures;
+    std::vector<size_t> child_key_counts;
+    std::vector<QleanXmssBytes> child_proofs;
+    std::vector<Offsets> offsets;
+    offsets.reserve(items.size());
+    for (auto &item : items) {
+      if (item.child_public_keys.size() != item.child_proofs.size()) {
+        throw std::logic_error{
+            "XmssAccelerator::aggregate child public key and proof count "
+            "mismatch"};
+      }
+      if (item.public_keys.size() != item.signatures.size()) {
+        throw std::logic_error{
+            "XmssAccelerator::aggregate public key and signature count "
+            "mismatch"};
+      }
+      offsets.emplace_back(Offsets{
+          .child_keys = keys.size(),
+          .children = child_proofs.size(),
+          .keys = 0,
+      });
+      for (auto &child_keys : item.child_public_keys) {
+        for (auto *key : child_keys) {
+          keys.emplace_back(key->data());
+        }
+        child_key_counts.emplace_back(child_keys.size());
+      }
+      for (auto &proof : item.child_proofs) {
+        child_proofs.emplace_back(QleanXmssBytes{proof.data(), proof.size()});
+      }
+      offsets.back().keys = keys.size();
+      for (auto *key : item.public_keys) {
+        keys.emplace_back(key->data());
+      }
+      for (auto &signature : item.signatures) {
+        signatures.emplace_back(signature.data());
+      }
+    }
+    std::vector<QleanXmssAggregateJob> jobs;
+    jobs.reserve(items.size());
+    size_t signatures_offset = 0;
+    for (size_t i = 0; i < items.size(); ++i) {
+      auto &item = items[i];
+      auto &offset = offsets[i];
+      jobs.emplace_back(QleanXmssAggregateJob{
+          .child_public_keys = keys.data() + offset.child_keys,
+          .child_public_key_counts = child_key_counts.data() + offset.children,
+          .child_proofs = child_proofs.data() + offset.children,
+          .child_count = item.child_proofs.size(),
+          .public_keys = keys.data() + offset.keys,
+          .signatures = signatures.data() + signatures_offset,
+          .count = item.signatures.size(),
+          .epoch = item.epoch,
+          .message = item.message.data(),
+          .log_inv_rate = XmssProviderImpl::kLogInvRate,
+      });
+      signatures_offset += item.signatures.size();
+    }
+    std::vector<QleanXmssBytes> proofs(items.size());
+    if (api_->aggregate(api_->ctx, jobs.data(), jobs.size(), proofs.data())
+        != 0) {
+      return std::nullopt;
+    }
+    std::vector<XmssAggregatedSignature> results;
+    results.reserve(proofs.size());
+    for (auto &proof : proofs) {
+      results.emplace_back(std::span{proof.data, proof.size});
+      api_->free_proof(api_->ctx, proof);
+    }
+    return results;
+  }
+
+  namespace {
+    std::shared_ptr<XmssAccelerator> openAccelerator(
+        log::LoggingSystem &logsys, const app::Configuration &app_config) {
+      auto &path = app_config.xmssAccelerator();
+      if (not path.has_value()) {
+        return nullptr;
+      }
+      auto log = logsys.getLogger("XmssAccelerator", "crypto");
+      auto accelerator = XmssAccelerator::open(*path);
+      if (accelerator.has_error()) {
+        SL_WARN(log,
+                "Xmss accelerator {} is not loaded, using CPU: {}",
+                path->string(),
+                accelerator.error());
+        return nullptr;
+      }
+      SL_INFO(log,
+              "Xmss accelerator {} loaded, device {}",
+              path->string(),
+              accelerator.value()->name());
+      return accelerator.value();
+    }
+  }  // namespace
+
+  size_t XmssProviderAccelerated::Job::size() const {
+    return kind == Kind::VERIFY ? verify_items.size()
+                                : aggregate_items.size();
+  }
+
+  XmssProviderAccelerated::XmssProviderAccelerated(
+      qtils::SharedRef<log::LoggingSystem> logsys,
+      qtils::SharedRef<const app::Configuration> app_config,
+      qtils::SharedRef<metrics::Metrics> metrics,
+      qtils::SharedRef<XmssProviderImpl> cpu)
+      : XmssProviderAccelerated(std::move(cpu),
+                                openAccelerator(*logsys, *app_config),
+                                std::move(metrics)) {}
+
+  XmssProviderAccelerated::XmssProviderAccelerated(
+      qtils::SharedRef<XmssProvider> cpu,
+      std::shared_ptr<XmssAccelerator> accelerator,
+      std::shared_ptr<metrics::Metrics> metrics)
+      : cpu_{std::move(cpu)},
+        accelerator_{std::move(accelerator)},
+        metrics_{std::move(metrics)} {
+    if (metrics_) {
+      for (auto kind : {Kind::VERIFY, Kind::AGGREGATE}) {
+        for (auto backend : {Backend::DEVICE, Backend::CPU}) {
+          items_[static_cast<size_t>(kind)][static_cast<size_t>(backend)] =
+              metrics_->lean_xmss_accelerator_items({
+                  {"kind", kind == Kind::VERIFY ? "verify" : "aggregate"},
+                  {"backend", backend == Backend::DEVICE ? "device" : "cpu"},
+              });
+        }
+      }
+    }
+    if (accelerator_) {
+      device_thread_ = std::thread{[this] {
+        setThreadName("accelerator");
+        deviceLoop();
+      }};
+    }
+  }
+
+  XmssProviderAccelerated::~XmssProviderAccelerated() {
+    {
+      std::lock_guard lock{mutex_};
+      stopped_ = true;
+    }
+    queued_.notify_all();
+    if (device_thread_.joinable()) {
+      device_thread_.join();
+    }
+  }
+
+  XmssKeypair XmssProviderAccelerated::generateKeypair(
+      uint64_t activation_epoch, uint64_t num_active_epochs) {
+    return cpu_->generateKeypair(activation_epoch, num_active_epochs);
+  }
+
+  XmssSignature XmssProviderAccelerated::sign(XmssPrivateKey xmss_private_key,
+                                              uint32_t epoch,
+                                              const XmssMessage &message) {
+    return cpu_->sign(std::move(xmss_private_key), epoch, message);
+  }
+
+  bool XmssProviderAccelerated::verify(const XmssPublicKey &xmss_public_key,
+                                       const XmssMessage &message,
+                                       uint32_t epoch,
+                                       const XmssSignature &xmss_signature) {
+    return cpu_->verify(xmss_public_key, message, epoch, xmss_signature);
+  }
+
+  XmssAggregatedSignature XmssProviderAccelerated::aggregateSignatures(
+      std::span<const std::vector<XmssPublicKeyRef>> child_public_keys,
+      std::span<const XmssAggregatedSignature> child_proofs,
+      std::span<const XmssPublicKeyRef> public_keys,
+      std::span<const XmssSignature> signatures,
+      uint32_t epoch,
+      const XmssMessage &message) const {
+    XmssAggregateItem item{
+        .child_public_keys = child_public_keys,
+        .child_proofs = child_proofs,
+        .public_keys = public_keys,
+        .signatures = signatures,
+        .epoch = epoch,
+        .message = message,
+    };
+    return std::move(aggregateBatch(std::span{&item, 1}).front());
+  }
+
+  bool XmssProviderAccelerated::verifyAggregatedSignatures(
+      std::span<const XmssPublicKeyRef> public_keys,
+      uint32_t epoch,
+      const XmssMessage &message,
+      XmssAggregatedSignatureIn aggregated_signature) const {
+    XmssVerifyItem item{
+        .public_keys = public_keys,
+        .epoch = epoch,
+        .message = message,
+        .aggregated_signature = aggregated_signature,
+    };
+    return verifyBatch(std::span{&item, 1}).front();
+  }
+
+  std::vector<XmssSignature> XmssProviderAccelerated::signBatch(
+      std::span<const XmssSignItem> items) {
+    return cpu_->signBatch(items);
+  }
+
+  std::vector<bool> XmssProviderAccelerated::verifyBatch(
+      std::span<const XmssVerifyItem> items) const {
+    if (items.empty()) {
+      return {};
+    }
+    if (accelerator_ and accelerator_->canVerify()) {
+      Job job{.kind = Kind::VERIFY, .verify_items = items};
+      if (runOnDevice(job)) {
+        count(Kind::VERIFY, Backend::DEVICE, items.size());
+        if (metrics_) {
+          for (auto valid : job.verified) {
+            if (valid) {
+              metrics_->lean_pq_sig_aggregated_signatures_valid_total()->inc();
+            } else {
+              metrics_->lean_pq_sig_aggregated_signatures_invalid_total()
+                  ->inc();
+            }
+          }
+        }
+        return std::move(job.verified);
+      }
+    }
+    count(Kind::VERIFY, Backend::CPU, items.size());
+    return cpu_->verifyBatch(items);
+  }
+
+  std::vector<XmssAggregatedSignature> XmssProviderAccelerated::aggregateBatch(
+      std::span<const XmssAggregateItem> items) const {
+    if (items.empty()) {
+      return {};
+    }
+    if (accelerator_ and accelerator_->canAggregate()) {
+      Job job{.kind = Kind::AGGREGATE, .aggregate_items = items};
+      if (runOnDevice(job)) {
+        count(Kind::AGGREGATE, Backend::DEVICE, items.size());
+        if (metrics_) {
+          for (auto &item : items) {
+            metrics_->pq_sig_attestations_in_aggregated_signatures_total()
+                ->inc(static_cast<double>(item.signatures.size()));
+          }
+          metrics_->pq_sig_aggregated_signatures_total()->inc(
+              static_cast<double>(items.size()));
+        }
+        return std::move(job.aggregated);
+      }
+    }
+    count(Kind::AGGREGATE, Backend::CPU, items.size());
+    return cpu_->aggregateBatch(items);
+  }
+
+  bool XmssProviderAccelerated::runOnDevice(Job &job) const {
+    std::unique_lock lock{mutex_};
+    // Single batch larger than limit still goes to idle device
+    if (not queue_.empty() and queued_items_ + job.size() > kMaxQueueItems) {
+      return false;
+    }
+    queue_.emplace_back(&job);
+    queued_items_ += job.size();
+    if (metrics_) {
+      metrics_->lean_xmss_accelerator_queue_items()->set(
+          static_cast<double>(queued_items_));
+    }
+    queued_.notify_one();
+    done_.wait(lock, [&] { return job.done; });
+    return not job.failed;
+  }
+
+  void XmssProviderAccelerated::deviceLoop() {
+    std::unique_lock lock{mutex_};
+    while (true) {
+      queued_.wait(lock, [&] { return stopped_ or not queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      // Oldest job picks kind, later jobs of that kind join its batch
+      auto kind = queue_.front()->kind;
+      std::vector<Job *> batch;
+      size_t items = 0;
+      for (auto it = queue_.begin(); it != queue_.end();) {
+        auto *job = *it;
+        if (job->kind != kind) {
+          ++it;
+          continue;
+        }
+        if (not batch.empty() and items + job->size() > kMaxBatchItems) {
+          break;
+        }
+        batch.emplace_back(job);
+        items += job->size();
+        it = queue_.erase(it);
+      }
+      queued_items_ -= items;
+      if (metrics_) {
+        metrics_->lean_xmss_accelerator_queue_items()->set(
+            static_cast<double>(queued_items_));
+      }
+      lock.unlock();
+      runBatch(batch);
+      lock.lock();
+      for (auto *job : batch) {
+        job->done = true;
+      }
+      done_.notify_all();
+    }
+  }
+
+  void XmssProviderAccelerated::runBatch(const std::vector<Job *> &jobs) {
+    auto kind = jobs.front()->kind;
+    auto started = std::chrono::steady_clock::now();
+    size_t items = 0;
+    bool ok = false;
+    // Errors of invalid items are thrown again by CPU provider to caller
+    try {
+      if (kind == Kind::VERIFY) {
+        std::vector<XmssVerifyItem> batch;
+        for (auto *job : jobs) {
+          batch.insert(
+              batch.end(), job->verify_items.begin(), job->verify_items.end());
+        }
+        items = batch.size();
+        if (auto results = accelerator_->verify(batch)) {
+          auto it = results->begin();
+          for (auto *job : jobs) {
+            job->verified.assign(it, it + job->size());
+            it += job->size();
+          }
+          ok = true;
+        }
+      } else {
+        std::vector<XmssAggregateItem> batch;
+        for (auto *job : jobs) {
+          batch.insert(batch.end(),
+                       job->aggregate_items.begin(),
+                       job->aggregate_items.end());
+        }
+        items = batch.size();
+        if (auto results = accelerator_->aggregate(batch)) {
+          auto it = results->begin();
+          for (auto *job : jobs) {
+            job->aggregated.assign(std::make_move_iterator(it),
+                                   std::make_move_iterator(it + job->size()));
+            it += job->size();
+          }
+          ok = true;
+        }
+      }
+    } catch (...) {
+      ok = false;
+    }
+    for (auto *job : jobs) {
+      job->failed = not ok;
+    }
+    if (metrics_) {
+      std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - started;
+      metrics_->lean_xmss_accelerator_busy_seconds()->inc(elapsed.count());
+      metrics_->lean_xmss_accelerator_batch_items()->observe(
+          static_cast<double>(items));
+      if (not ok) {
+        metrics_->lean_xmss_accelerator_failures()->inc();
+      }
+    }
+  }
+
+  void XmssProviderAccelerated::count(Kind kind,
+                                      Backend backend,
+                                      size_t items) const {
+    auto *counter =
+        items_[static_cast<size_t>(kind)][static_cast<size_t>(backend)];
+    if (counter != nullptr) {
+      counter->inc(static_cast<double>(items));
+    }
+  }
+}  // namespace lean::crypto::xmss
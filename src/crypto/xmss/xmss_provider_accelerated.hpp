@@ -0,0 +1,197 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <qtils/enum_error_code.hpp>
+#include <qtils/outcome.hpp>
+#include <qtils/shared_ref.hpp>
+
+#include "crypto/xmss/xmss_accelerator.h"
+#include "crypto/xmss/xmss_provider.hpp"
+#include "log/logger.hpp"
+
+namespace lean::app {
+  class Configuration;
+}  // namespace lean::app
+
+namespace lean::metrics {
+  class Counter;
+  class Metrics;
+}  // namespace lean::metrics
+
+namespace lean::crypto::xmss {
+  class XmssProviderImpl;
+
+  enum class XmssAcceleratorError : uint8_t {
+    OPEN = 1,
+    SYMBOL,
+    NO_DEVICE,
+    ABI_VERSION,
+    PARAMETERS,
+  };
+  Q_ENUM_ERROR_CODE(XmssAcceleratorError) {
+    using E = decltype(e);
+    switch (e) {
+      case E::OPEN:
+        return "Can't load xmss accelerator library";
+      case E::SYMBOL:
+        return "Library doesn't export " QLEAN_XMSS_ACCELERATOR_SYMBOL;
+      case E::NO_DEVICE:
+        return "Xmss accelerator found no device";
+      case E::ABI_VERSION:
+        return "Xmss accelerator is built for other ABI version";
+      case E::PARAMETERS:
+        return "Xmss accelerator is built for other hash-sig parameters";
+    }
+    abort();
+  }
+
+  /// Accelerator plugin, see "crypto/xmss/xmss_accelerator.h"
+  class XmssAccelerator {
+   public:
+    /// Load plugin library and check it matches node
+    static outcome::result<std::shared_ptr<XmssAccelerator>> open(
+        const std::filesystem::path &path);
+
+    /// @param library keeps `api` loaded, null if it is linked into process
+    XmssAccelerator(const QleanXmssAccelerator &api,
+                    std::shared_ptr<void> library = nullptr);
+
+    std::string_view name() const;
+    bool canVerify() const;
+    bool canAggregate() const;
+
+    /// @return nullopt if device failed
+    std::optional<std::vector<bool>> verify(
+        std::span<const XmssVerifyItem> items) const;
+
+    /// @return nullopt if device failed
+    std::optional<std::vector<XmssAggregatedSignature>> aggregate(
+        std::span<const XmssAggregateItem> items) const;
+
+   private:
+    std::shared_ptr<void> library_;
+    const QleanXmssAccelerator *api_;
+  };
+
+  /**
+   * Offloads aggregated signature verification and aggregation to device
+   * of accelerator plugin, `--xmss-accelerator`.
+   * Concurrent callers, e.g. block import and aggregation of each group,
+   * queue their batches, and device thread runs all queued items of one
+   * kind as single plugin call, up to `kMaxBatchItems`, so device gets
+   * large batches across blocks and groups.
+   * Items run on CPU provider instead if plugin doesn't support their
+   * kind, if queue is full, or if plugin call fails. Signing and key
+   * generation always run on CPU.
+   */
+  class XmssProviderAccelerated : public XmssProvider {
+   public:
+    /// Items of single plugin call
+    static constexpr size_t kMaxBatchItems = 256;
+    /// Items waiting for device, more run on CPU meanwhile
+    static constexpr size_t kMaxQueueItems = 1024;
+
+    XmssProviderAccelerated(
+        qtils::SharedRef<log::LoggingSystem> logsys,
+        qtils::SharedRef<const app::Configuration> app_config,
+        qtils::SharedRef<metrics::Metrics> metrics,
+        qtils::SharedRef<XmssProviderImpl> cpu);
+
+    /// All items run on `cpu` if `accelerator` is null
+    XmssProviderAccelerated(qtils::SharedRef<XmssProvider> cpu,
+                            std::shared_ptr<XmssAccelerator> accelerator,
+                            std::shared_ptr<metrics::Metrics> metrics);
+
+    ~XmssProviderAccelerated() override;
+
+    XmssKeypair generateKeypair(uint64_t activation_epoch,
+                                uint64_t num_active_epochs) override;
+
+    XmssSignature sign(XmssPrivateKey xmss_private_key,
+                       uint32_t epoch,
+                       const XmssMessage &message) override;
+
+    bool verify(const XmssPublicKey &xmss_public_key,
+                const XmssMessage &message,
+                uint32_t epoch,
+                const XmssSignature &xmss_signature) override;
+
+    [[nodiscard]] XmssAggregatedSignature aggregateSignatures(
+        std::span<const std::vector<XmssPublicKeyRef>> child_public_keys,
+        std::span<const XmssAggregatedSignature> child_proofs,
+        std::span<const XmssPublicKeyRef> public_keys,
+        std::span<const XmssSignature> signatures,
+        uint32_t epoch,
+        const XmssMessage &message) const override;
+    [[nodiscard]] bool verifyAggregatedSignatures(
+        std::span<const XmssPublicKeyRef> public_keys,
+        uint32_t epoch,
+        const XmssMessage &message,
+        XmssAggregatedSignatureIn aggregated_signature) const override;
+    [[nodiscard]] std::vector<XmssSignature> signBatch(
+        std::span<const XmssSignItem> items) override;
+    [[nodiscard]] std::vector<bool> verifyBatch(
+        std::span<const XmssVerifyItem> items) const override;
+    [[nodiscard]] std::vector<XmssAggregatedSignature> aggregateBatch(
+        std::span<const XmssAggregateItem> items) const override;
+
+   private:
+    enum class Kind : uint8_t { VERIFY, AGGREGATE };
+    enum class Backend : uint8_t { DEVICE, CPU };
+
+    /// Batch of single caller, waiting in queue
+    struct Job {
+      Kind kind;
+      std::span<const XmssVerifyItem> verify_items;
+      std::span<const XmssAggregateItem> aggregate_items;
+      std::vector<bool> verified;
+      std::vector<XmssAggregatedSignature> aggregated;
+      bool done = false;
+      /// Device failed, caller runs items on CPU
+      bool failed = false;
+
+      size_t size() const;
+    };
+
+    /// Queue job and wait for device thread
+    /// @return false if job must run on CPU
+    bool runOnDevice(Job &job) const;
+    void deviceLoop();
+    /// Run jobs of one kind as single plugin call
+    void runBatch(const std::vector<Job *> &jobs);
+    void count(Kind kind, Backend backend, size_t items) const;
+
+    qtils::SharedRef<XmssProvider> cpu_;
+    std::shared_ptr<XmssAccelerator> accelerator_;
+    std::shared_ptr<metrics::Metrics> metrics_;
+    /// Items by kind and backend
+    metrics::Counter *items_[2][2]{};
+
+    mutable std::mutex mutex_;
+    /// Wakes device thread
+    mutable std::condition_variable queued_;
+    /// Wakes callers
+    mutable std::condition_variable done_;
+    mutable std::deque<Job *> queue_;
+    mutable size_t queued_items_ = 0;
+    bool stopped_ = false;
+    std::thread device_thread_;
+  };
+}  // namespace lean::crypto::xmss
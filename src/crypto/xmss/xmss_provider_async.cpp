@@ -0,0 +1,48 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "crypto/xmss/xmss_provider_async.hpp"
+
+#include "utils/worker_pool.hpp"
+
+namespace lean::crypto::xmss {
+  XmssProviderAsync::XmssProviderAsync(
+      qtils::SharedRef<XmssProvider> provider,
+      qtils::SharedRef<WorkerPool> worker_pool)
+      : provider_{std::move(provider)},
+        worker_pool_{std::move(worker_pool)} {}
+
+  XmssProviderAsync::Coro<std::optional<bool>> XmssProviderAsync::verify(
+      XmssPublicKey public_key,
+      XmssMessage message,
+      uint32_t epoch,
+      XmssSignature signature,
+      Cancel cancel) {
+    co_return co_await run(
+        [&] {
+          return provider_->verify(public_key, message, epoch, signature);
+        },
+        std::move(cancel));
+  }
+
+  XmssProviderAsync::Coro<std::optional<std::vector<bool>>>
+  XmssProviderAsync::verifyBatch(std::span<const XmssVerifyItem> items,
+                                 Cancel cancel) {
+    co_return co_await run([&] { return provider_->verifyBatch(items); },
+                           std::move(cancel));
+  }
+
+  XmssProviderAsync::Coro<std::optional<std::vector<XmssAggregatedSignature>>>
+  XmssProviderAsync::aggregateBatch(std::span<const XmssAggregateItem> items,
+                                    Cancel cancel) {
+    co_return co_await run([&] { return provider_->aggregateBatch(items); },
+                           std::move(cancel));
+  }
+
+  void XmssProviderAsync::post(std::function<void()> task) {
+    worker_pool_->post(std::move(task));
+  }
+}  // namespace lean::crypto::xmss
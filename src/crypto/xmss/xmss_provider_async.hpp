@@ -0,0 +1,124 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <qtils/shared_ref.hpp>
+
+#include "crypto/xmss/xmss_provider.hpp"
+
+namespace lean {
+  class WorkerPool;
+}  // namespace lean
+
+namespace lean::crypto::xmss {
+  /**
+   * Cancellation of crypto work which is no longer needed, e.g. block was
+   * imported from another peer meanwhile.
+   * Work not started yet is skipped, started work runs to completion, as
+   * prover and verifier can't be interrupted.
+   */
+  class XmssCancel {
+   public:
+    void cancel() {
+      cancelled_.store(true, std::memory_order_relaxed);
+    }
+
+    bool cancelled() const {
+      return cancelled_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    std::atomic_bool cancelled_ = false;
+  };
+
+  /**
+   * Awaitable `XmssProvider`, compatible with `libp2p::Coro`.
+   * Work runs on worker pool, awaiting coroutine resumes on its own
+   * executor, so io thread keeps processing messages meanwhile.
+   * Spans of items must outlive `co_await`.
+   * Awaited result is nullopt if work was cancelled before it started.
+   */
+  class XmssProviderAsync {
+   public:
+    template <typename T>
+    using Coro = boost::asio::awaitable<T>;
+    using Cancel = std::shared_ptr<const XmssCancel>;
+
+    XmssProviderAsync(qtils::SharedRef<XmssProvider> provider,
+                      qtils::SharedRef<WorkerPool> worker_pool);
+
+    Coro<std::optional<bool>> verify(XmssPublicKey public_key,
+                                     XmssMessage message,
+                                     uint32_t epoch,
+                                     XmssSignature signature,
+                                     Cancel cancel = nullptr);
+
+    Coro<std::optional<std::vector<bool>>> verifyBatch(
+        std::span<const XmssVerifyItem> items, Cancel cancel = nullptr);
+
+    Coro<std::optional<std::vector<XmssAggregatedSignature>>> aggregateBatch(
+        std::span<const XmssAggregateItem> items, Cancel cancel = nullptr);
+
+   private:
+    void post(std::function<void()> task);
+
+    /// Run `fn` on worker pool, rethrow its exception in awaiting coroutine
+    template <typename F>
+    Coro<std::optional<std::invoke_result_t<F>>> run(F fn, Cancel cancel) {
+      using Result = std::optional<std::invoke_result_t<F>>;
+      auto executor = co_await boost::asio::this_coro::executor;
+      co_return co_await boost::asio::async_initiate<
+          decltype(boost::asio::use_awaitable),
+          void(std::exception_ptr, Result)>(
+          [&](auto handler) {
+            // Pool tasks must be copyable, handler is move only
+            auto shared_handler =
+                std::make_shared<decltype(handler)>(std::move(handler));
+            post([work{boost::asio::make_work_guard(executor)},
+                  shared_handler,
+                  fn{std::move(fn)},
+                  cancel{std::move(cancel)}]() mutable {
+              std::exception_ptr error;
+              Result result;
+              if (not cancel or not cancel->cancelled()) {
+                try {
+                  result.emplace(fn());
+                } catch (...) {
+                  error = std::current_exception();
+                }
+              }
+              boost::asio::post(
+                  work.get_executor(),
+                  [shared_handler, error, result{std::move(result)}]() mutable {
+                    std::move (*shared_handler)(error, std::move(result));
+                  });
+            });
+          },
+          boost::asio::use_awaitable);
+    }
+
+    qtils::SharedRef<XmssProvider> provider_;
+    qtils::SharedRef<WorkerPool> worker_pool_;
+  };
+}  // namespace lean::crypto::xmss
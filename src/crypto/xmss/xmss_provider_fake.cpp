@@ -6,6 +6,8 @@
 
 #include "crypto/xmss/xmss_provider_fake.hpp"
 
+#include <algorithm>
+#include <array>
 #include <random>
 #include <thread>
 
@@ -15,17 +17,46 @@
 #include "utils/tuple_hash.hpp"
 
 namespace lean::crypto::xmss {
-  constexpr size_t kAggregatedSignatureSize = 263161;
-
-  void randomBytesSeed(qtils::BytesOut out, uint32_t seed) {
+  void XmssProviderFake::randomBytesSeed(qtils::BytesOut out,
+                                         uint32_t seed) {
     std::independent_bits_engine<std::default_random_engine, 8, uint8_t> random(
         seed);
     std::ranges::generate(out, random);
   }
 
+  FakeCryptoPool::FakeCryptoPool(size_t lanes)
+      : lanes_(std::max<size_t>(lanes, 1)) {}
+
+  FakeCryptoPool::Clock::time_point FakeCryptoPool::schedule(
+      std::span<const Clock::duration> costs, Clock::time_point now) {
+    std::lock_guard lock{mutex_};
+    auto finish = now;
+    for (auto &cost : costs) {
+      auto &lane = *std::ranges::min_element(lanes_);
+      lane = std::max(lane, now) + cost;
+      finish = std::max(finish, lane);
+    }
+    return finish;
+  }
+
+  void FakeCryptoPool::run(std::span<const Clock::duration> costs) {
+    std::this_thread::sleep_until(schedule(costs, Clock::now()));
+  }
+
+  size_t fakeCryptoLanes(const app::Configuration &config) {
+    if (auto threads = config.fakeXmssThreads(); threads != 0) {
+      return threads;
+    }
+    if (auto threads = config.workerThreads(); threads != 0) {
+      return threads;
+    }
+    return std::thread::hardware_concurrency();
+  }
+
   XmssProviderFake::XmssProviderFake(
       qtils::SharedRef<app::Configuration> app_config)
-      : app_config_{std::move(app_config)} {}
+      : app_config_{std::move(app_config)},
+        pool_{fakeCryptoLanes(*app_config_)} {}
 
   XmssKeypair XmssProviderFake::generateKeypair(uint64_t, uint64_t) {
     abort();
@@ -52,39 +83,105 @@ namespace lean::crypto::xmss {
     return true;
   }
 
-  XmssAggregatedSignature XmssProviderFake::aggregateSignatures(
-      std::span<const std::vector<XmssPublicKey>> child_public_keys,
+  XmssAggregatedSignature fakeAggregatedSignature(
+      std::span<const std::vector<XmssPublicKeyRef>> child_public_keys,
       std::span<const XmssAggregatedSignature> child_proofs,
-      std::span<const XmssPublicKey> public_keys,
+      std::span<const XmssPublicKeyRef> public_keys,
       std::span<const XmssSignature> signatures,
       uint32_t epoch,
-      const XmssMessage &message) const {
+      const XmssMessage &message) {
     size_t seed = 0;
-    boost::hash_combine(seed, child_public_keys);
+    // Keys are hashed by value, so signature doesn't depend on addresses
+    for (auto &keys : child_public_keys) {
+      for (auto *key : keys) {
+        boost::hash_combine(seed, *key);
+      }
+    }
     boost::hash_combine(seed, child_proofs);
-    boost::hash_combine(seed, public_keys);
+    for (auto *key : public_keys) {
+      boost::hash_combine(seed, *key);
+    }
     boost::hash_combine(seed, signatures);
     boost::hash_combine(seed, epoch);
     boost::hash_combine(seed, message);
     XmssAggregatedSignature signature;
-    signature.resize(kAggregatedSignatureSize);
-    randomBytesSeed(signature, seed);
-    std::this_thread::sleep_for(std::chrono::duration<double>{
-        public_keys.size() / app_config_->fakeXmssAggregateSignaturesRate()});
+    signature.resize(XmssProviderFake::kAggregatedSignatureSize);
+    XmssProviderFake::randomBytesSeed(signature, seed);
+    return signature;
+  }
+
+  XmssAggregatedSignature XmssProviderFake::aggregateSignatures(
+      std::span<const std::vector<XmssPublicKeyRef>> child_public_keys,
+      std::span<const XmssAggregatedSignature> child_proofs,
+      std::span<const XmssPublicKeyRef> public_keys,
+      std::span<const XmssSignature> signatures,
+      uint32_t epoch,
+      const XmssMessage &message) const {
+    auto signature = fakeAggregatedSignature(child_public_keys,
+                                             child_proofs,
+                                             public_keys,
+                                             signatures,
+                                             epoch,
+                                             message);
+    pool_.run(std::array{aggregateCost(public_keys.size())});
     return signature;
   }
 
   bool XmssProviderFake::verifyAggregatedSignatures(
-      std::span<const XmssPublicKey> public_keys,
+      std::span<const XmssPublicKeyRef> public_keys,
       uint32_t,
       const XmssMessage &,
       XmssAggregatedSignatureIn) const {
-    std::this_thread::sleep_for(std::chrono::duration<double>{
-        public_keys.size()
-        / app_config_->fakeXmssVerifyAggregatedSignaturesRate()});
+    pool_.run(std::array{verifyCost(public_keys.size())});
     return true;
   }
 
+  std::vector<bool> XmssProviderFake::verifyBatch(
+      std::span<const XmssVerifyItem> items) const {
+    std::vector<FakeCryptoPool::Clock::duration> costs;
+    costs.reserve(items.size());
+    for (auto &item : items) {
+      costs.emplace_back(verifyCost(item.public_keys.size()));
+    }
+    pool_.run(costs);
+    return std::vector<bool>(items.size(), true);
+  }
+
+  std::vector<XmssAggregatedSignature> XmssProviderFake::aggregateBatch(
+      std::span<const XmssAggregateItem> items) const {
+    std::vector<FakeCryptoPool::Clock::duration> costs;
+    std::vector<XmssAggregatedSignature> results;
+    costs.reserve(items.size());
+    results.reserve(items.size());
+    for (auto &item : items) {
+      costs.emplace_back(aggregateCost(item.public_keys.size()));
+      results.emplace_back(fakeAggregatedSignature(item.child_public_keys,
+                                                   item.child_proofs,
+                                                   item.public_keys,
+                                                   item.signatures,
+                                                   item.epoch,
+                                                   item.message));
+    }
+    pool_.run(costs);
+    return results;
+  }
+
+  FakeCryptoPool::Clock::duration XmssProviderFake::aggregateCost(
+      size_t signatures) const {
+    return std::chrono::duration_cast<FakeCryptoPool::Clock::duration>(
+        std::chrono::duration<double>{
+            static_cast<double>(signatures)
+            / app_config_->fakeXmssAggregateSignaturesRate()});
+  }
+
+  FakeCryptoPool::Clock::duration XmssProviderFake::verifyCost(
+      size_t public_keys) const {
+    return std::chrono::duration_cast<FakeCryptoPool::Clock::duration>(
+        std::chrono::duration<double>{
+            static_cast<double>(public_keys)
+            / app_config_->fakeXmssVerifyAggregatedSignaturesRate()});
+  }
+
   XmssKeypair XmssProviderFake::loadKeypair(const XmssPublicKey &public_key,
                                             std::string_view private_key_path) {
     size_t key_index = std::hash<std::string_view>{}(private_key_path);
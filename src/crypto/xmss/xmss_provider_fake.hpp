@@ -6,6 +6,10 @@
 
 #pragma once
 
+#include <chrono>
+#include <mutex>
+#include <vector>
+
 #include <qtils/shared_ref.hpp>
 
 #include "crypto/xmss/xmss_provider.hpp"
@@ -15,17 +19,49 @@ namespace lean::app {
 }  // namespace lean::app
 
 namespace lean::crypto::xmss {
+  /**
+   * Simulated crypto worker pool.
+   * Jobs take lane which frees first, and queue behind its previous jobs,
+   * so concurrent and batched work costs as on pool of `lanes` threads.
+   */
+  class FakeCryptoPool {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FakeCryptoPool(size_t lanes);
+
+    /// Schedule jobs, @return when last of them finishes
+    Clock::time_point schedule(std::span<const Clock::duration> costs,
+                               Clock::time_point now);
+
+    /// Schedule jobs and sleep until they finish
+    void run(std::span<const Clock::duration> costs);
+
+   private:
+    std::mutex mutex_;
+    /// When each lane finishes its queued jobs
+    std::vector<Clock::time_point> lanes_;
+  };
+
   /**
    * Fake xmss provider implementation.
    * Used for shadow simulations.
    * `sign` returns pseudo-random `signature` seeded by `epoch` and `message`,
    * to prevent snappy from efficiently compressing zeros.
    * `verify` always return true.
+   * Aggregation and aggregated verification cost time on `FakeCryptoPool`
+   * of `fakeXmssThreads` lanes.
    */
   class XmssProviderFake : public XmssProvider {
    public:
+    /// Size of real aggregated signature
+    static constexpr size_t kAggregatedSignatureSize = 263161;
+
     XmssProviderFake(qtils::SharedRef<app::Configuration> app_config);
 
+    /// Pseudo-random bytes, which snappy can't compress
+    static void randomBytesSeed(qtils::BytesOut out, uint32_t seed);
+
     // XmssProvider
     XmssKeypair generateKeypair(uint64_t, uint64_t) override;
     XmssSignature sign(XmssPrivateKey,
@@ -36,22 +72,30 @@ namespace lean::crypto::xmss {
                 uint32_t,
                 const XmssSignature &) override;
     XmssAggregatedSignature aggregateSignatures(
-        std::span<const std::vector<XmssPublicKey>> child_public_keys,
+        std::span<const std::vector<XmssPublicKeyRef>> child_public_keys,
         std::span<const XmssAggregatedSignature> child_proofs,
-        std::span<const XmssPublicKey> public_keys,
+        std::span<const XmssPublicKeyRef> public_keys,
         std::span<const XmssSignature> signatures,
         uint32_t epoch,
         const XmssMessage &message) const override;
     bool verifyAggregatedSignatures(
-        std::span<const XmssPublicKey> public_keys,
+        std::span<const XmssPublicKeyRef> public_keys,
         uint32_t epoch,
         const XmssMessage &message,
         XmssAggregatedSignatureIn aggregated_signature) const override;
+    std::vector<bool> verifyBatch(
+        std::span<const XmssVerifyItem> items) const override;
+    std::vector<XmssAggregatedSignature> aggregateBatch(
+        std::span<const XmssAggregateItem> items) const override;
 
     static XmssKeypair loadKeypair(const XmssPublicKey &public_key,
                                    std::string_view private_key_path);
 
    private:
+    FakeCryptoPool::Clock::duration aggregateCost(size_t signatures) const;
+    FakeCryptoPool::Clock::duration verifyCost(size_t public_keys) const;
+
     qtils::SharedRef<app::Configuration> app_config_;
+    mutable FakeCryptoPool pool_;
   };
 }  // namespace lean::crypto::xmss
@@ -7,7 +7,10 @@
 #include "crypto/xmss/xmss_provider_impl.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <cstring>
+#include <exception>
+#include <latch>
 #include <memory>
 #include <ranges>
 #include <stdexcept>
@@ -16,12 +19,19 @@
 
 #include "crypto/xmss/ffi.hpp"
 #include "metrics/metrics.hpp"
+#include "utils/worker_pool.hpp"
 
 namespace lean::crypto::xmss {
-  constexpr size_t LOG_INV_RATE_PROD = 2;
+  XmssProviderImpl::XmssProviderImpl() = default;
 
-  XmssProviderImpl::XmssProviderImpl(qtils::SharedRef<metrics::Metrics> metrics)
-      : use_metrics_(true), metrics_(std::move(metrics)) {}
+  XmssProviderImpl::XmssProviderImpl(
+      qtils::SharedRef<metrics::Metrics> metrics,
+      qtils::SharedRef<WorkerPool> worker_pool)
+      : use_metrics_(true),
+        metrics_(std::move(metrics)),
+        worker_pool_(std::move(worker_pool)) {}
+
+  XmssProviderImpl::~XmssProviderImpl() = default;
 
   XmssKeypair XmssProviderImpl::generateKeypair(uint64_t activation_epoch,
                                                 uint64_t num_active_epochs) {
@@ -92,12 +102,7 @@ namespace lean::crypto::xmss {
       timer.emplace(metrics_->pq_sig_attestation_verification_time()->timer());
     }
 
-    // Deserialize public key
-    PQPublicKey *public_key_raw = nullptr;
-    ffi::asOutcome(
-        pq_public_key_from_bytes(xmss_public_key.data(), &public_key_raw))
-        .value();
-    ffi::PublicKey public_key{public_key_raw};
+    auto public_key = parsePublicKey(xmss_public_key);
 
     // Deserialize signature
     PQSignature *signature_raw = nullptr;
@@ -108,7 +113,7 @@ namespace lean::crypto::xmss {
 
     // Verify signature
     int verify_result =
-        pq_verify(public_key.get(), epoch, message.data(), signature.get());
+        pq_verify(public_key->get(), epoch, message.data(), signature.get());
 
     if (verify_result < 0) {
       throw std::runtime_error("Error during XMSS signature verification");
@@ -117,6 +122,18 @@ namespace lean::crypto::xmss {
     return verify_result == 1;
   }
 
+  std::shared_ptr<const ffi::PublicKey> XmssProviderImpl::parsePublicKey(
+      const XmssPublicKey &xmss_public_key) const {
+    if (auto cached = public_keys_.get(xmss_public_key)) {
+      return cached.value();
+    }
+    PQPublicKey *public_key_raw = nullptr;
+    ffi::asOutcome(
+        pq_public_key_from_bytes(xmss_public_key.data(), &public_key_raw))
+        .value();
+    return public_keys_.put(xmss_public_key, ffi::PublicKey{public_key_raw});
+  }
+
   auto manyToRaw(const auto &items) {
     std::vector<const uint8_t *> items_raw;
     items_raw.reserve(items.size());
@@ -126,10 +143,20 @@ namespace lean::crypto::xmss {
     return items_raw;
   }
 
+  std::vector<const uint8_t *> keysToRaw(
+      std::span<const XmssPublicKeyRef> keys) {
+    std::vector<const uint8_t *> keys_raw;
+    keys_raw.reserve(keys.size());
+    for (auto *key : keys) {
+      keys_raw.emplace_back(key->data());
+    }
+    return keys_raw;
+  }
+
   XmssAggregatedSignature XmssProviderImpl::aggregateSignatures(
-      std::span<const std::vector<XmssPublicKey>> child_public_keys,
+      std::span<const std::vector<XmssPublicKeyRef>> child_public_keys,
       std::span<const XmssAggregatedSignature> child_proofs,
-      std::span<const XmssPublicKey> public_keys,
+      std::span<const XmssPublicKeyRef> public_keys,
       std::span<const XmssSignature> signatures,
       uint32_t epoch,
       const XmssMessage &message) const {
@@ -151,16 +178,12 @@ namespace lean::crypto::xmss {
           "XmssProviderImpl::aggregateSignatures public key and signature "
           "count mismatch"};
     }
-    auto public_keys_raw = manyToRaw(public_keys);
+    auto public_keys_raw = keysToRaw(public_keys);
     auto signatures_raw = manyToRaw(signatures);
     std::vector<std::vector<const uint8_t *>> ffi_public_keys;
     ffi_public_keys.reserve(child_proofs.size());
     for (auto &keys : child_public_keys) {
-      auto &ffi_keys = ffi_public_keys.emplace_back();
-      ffi_keys.reserve(keys.size());
-      for (auto &key : keys) {
-        ffi_keys.emplace_back(key.data());
-      }
+      ffi_public_keys.emplace_back(keysToRaw(keys));
     }
     std::vector<PQChildProof> ffi_children;
     ffi_children.reserve(child_proofs.size());
@@ -173,6 +196,7 @@ namespace lean::crypto::xmss {
           .public_keys_count = public_keys.size(),
       });
     }
+    auto started = std::chrono::steady_clock::now();
     auto ffi_bytevec = pq_aggregate_signatures(ffi_children.data(),
                                                ffi_children.size(),
                                                public_keys.size(),
@@ -180,12 +204,16 @@ namespace lean::crypto::xmss {
                                                signatures_raw.data(),
                                                epoch,
                                                message.data(),
-                                               LOG_INV_RATE_PROD);
+                                               kLogInvRate);
     XmssAggregatedSignature aggregated_signature{std::span{
         ffi_bytevec.ptr,
         ffi_bytevec.size,
     }};
     PQByteVec_drop(ffi_bytevec);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - started;
+    aggregation_cost_.observe(
+        signatures.size(), child_proofs.size(), elapsed.count());
 
     if (use_metrics_) {
       metrics_->pq_sig_attestations_in_aggregated_signatures_total()->inc(
@@ -198,7 +226,7 @@ namespace lean::crypto::xmss {
   }
 
   bool XmssProviderImpl::verifyAggregatedSignatures(
-      std::span<const XmssPublicKey> public_keys,
+      std::span<const XmssPublicKeyRef> public_keys,
       uint32_t epoch,
       const XmssMessage &message,
       XmssAggregatedSignatureIn aggregated_signature) const {
@@ -209,7 +237,7 @@ namespace lean::crypto::xmss {
           metrics_->pq_sig_aggregated_signatures_verification_time()->timer());
     }
 
-    auto public_keys_raw = manyToRaw(public_keys);
+    auto public_keys_raw = keysToRaw(public_keys);
     bool is_valid =
         pq_verify_aggregated_signatures(public_keys.size(),
                                         public_keys_raw.data(),
@@ -228,4 +256,241 @@ namespace lean::crypto::xmss {
     return is_valid;
   }
 
+  std::vector<XmssSignature> XmssProviderImpl::signBatch(
+      std::span<const XmssSignItem> items) {
+    if (items.size() <= 1) {
+      return XmssProvider::signBatch(items);
+    }
+
+    std::vector<XmssSignature> results(items.size());
+    std::vector<std::exception_ptr> errors(items.size());
+    std::latch done{static_cast<std::ptrdiff_t>(items.size())};
+    auto &pool = workerPool();
+    for (size_t i = 0; i < items.size(); ++i) {
+      pool.post(
+          [&, i] {
+            auto &item = items[i];
+            try {
+              results[i] = sign(item.private_key, item.epoch, item.message);
+            } catch (...) {
+              errors[i] = std::current_exception();
+            }
+            done.count_down();
+          },
+          i);
+    }
+    pool.wait(done);
+    for (auto &error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+    return results;
+  }
+
+  std::vector<bool> XmssProviderImpl::verifyBatch(
+      std::span<const XmssVerifyItem> items) const {
+    if (items.size() <= 1) {
+      return XmssProvider::verifyBatch(items);
+    }
+    pq_setup_verifier();
+
+    // std::vector<bool> can't be written concurrently
+    std::vector<uint8_t> results(items.size());
+    std::latch done{static_cast<std::ptrdiff_t>(items.size())};
+    auto &pool = workerPool();
+    for (size_t i = 0; i < items.size(); ++i) {
+      pool.post(
+          [&, i] {
+            auto &item = items[i];
+            results[i] = verifyAggregatedSignatures(item.public_keys,
+                                                    item.epoch,
+                                                    item.message,
+                                                    item.aggregated_signature);
+            done.count_down();
+          },
+          i);
+    }
+    pool.wait(done);
+    return {results.begin(), results.end()};
+  }
+
+  /// Run `fn(i)` for each index on pool, rethrow first error
+  void runConcurrently(WorkerPool &pool, size_t count, const auto &fn) {
+    std::vector<std::exception_ptr> errors(count);
+    std::latch done{static_cast<std::ptrdiff_t>(count)};
+    for (size_t i = 0; i < count; ++i) {
+      pool.post(
+          [&, i] {
+            try {
+              fn(i);
+            } catch (...) {
+              errors[i] = std::current_exception();
+            }
+            done.count_down();
+          },
+          i);
+    }
+    pool.wait(done);
+    for (auto &error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+  std::vector<XmssAggregatedSignature> XmssProviderImpl::aggregateBatch(
+      std::span<const XmssAggregateItem> items) const {
+    auto &pool = workerPool();
+    // Groups are proved concurrently, each may split over its share of pool
+    auto threads =
+        std::max<size_t>(pool.size() / std::max<size_t>(items.size(), 1), 1);
+    std::vector<AggregationPlan> plans;
+    plans.reserve(items.size());
+    for (auto &item : items) {
+      plans.emplace_back(AggregationPlan::make(aggregation_cost_,
+                                               item.signatures.size(),
+                                               item.child_proofs.size(),
+                                               threads));
+    }
+    if (items.size() <= 1
+        and std::ranges::all_of(plans, &AggregationPlan::flat)) {
+      return XmssProvider::aggregateBatch(items);
+    }
+    pq_setup_prover();
+
+    // Leaves are whole flat items, or balanced batches of raw signatures
+    struct Leaf {
+      size_t item;
+      size_t begin;
+      size_t end;
+    };
+    std::vector<Leaf> leaves;
+    for (size_t i = 0; i < items.size(); ++i) {
+      auto count = items[i].signatures.size();
+      auto &plan = plans[i];
+      for (size_t j = 0; j < plan.leaves; ++j) {
+        leaves.emplace_back(Leaf{
+            .item = i,
+            .begin = count * j / plan.leaves,
+            .end = count * (j + 1) / plan.leaves,
+        });
+      }
+    }
+    std::vector<XmssAggregatedSignature> leaf_proofs(leaves.size());
+    runConcurrently(pool, leaves.size(), [&](size_t k) {
+      auto &leaf = leaves[k];
+      auto &item = items[leaf.item];
+      auto size = leaf.end - leaf.begin;
+      auto flat = plans[leaf.item].flat();
+      leaf_proofs[k] = aggregateSignatures(
+          flat ? item.child_public_keys
+               : std::span<const std::vector<XmssPublicKeyRef>>{},
+          flat ? item.child_proofs : std::span<const XmssAggregatedSignature>{},
+          item.public_keys.subspan(leaf.begin, size),
+          item.signatures.subspan(leaf.begin, size),
+          item.epoch,
+          item.message);
+    });
+
+    // Proofs of each item yet to merge, with their public keys
+    struct Tree {
+      std::vector<std::vector<XmssPublicKeyRef>> public_keys;
+      std::vector<XmssAggregatedSignature> proofs;
+    };
+    std::vector<Tree> trees(items.size());
+    for (auto &&[leaf, proof] : std::views::zip(leaves, leaf_proofs)) {
+      auto &item = items[leaf.item];
+      auto &tree = trees[leaf.item];
+      tree.public_keys.emplace_back(
+          item.public_keys.begin() + leaf.begin,
+          item.public_keys.begin() + leaf.end);
+      tree.proofs.emplace_back(std::move(proof));
+    }
+    for (auto &&[item, plan, tree] : std::views::zip(items, plans, trees)) {
+      if (plan.flat()) {
+        continue;
+      }
+      tree.public_keys.insert(tree.public_keys.end(),
+                              item.child_public_keys.begin(),
+                              item.child_public_keys.end());
+      tree.proofs.insert(tree.proofs.end(),
+                         item.child_proofs.begin(),
+                         item.child_proofs.end());
+    }
+
+    // Merge levels until each item has single proof
+    while (true) {
+      struct Merge {
+        size_t item;
+        size_t begin;
+        size_t end;
+      };
+      std::vector<Merge> merges;
+      for (size_t i = 0; i < trees.size(); ++i) {
+        auto &tree = trees[i];
+        if (tree.proofs.size() <= 1) {
+          continue;
+        }
+        for (size_t begin = 0; begin < tree.proofs.size();
+             begin += AggregationPlan::kMaxFanIn) {
+          merges.emplace_back(Merge{
+              .item = i,
+              .begin = begin,
+              .end = std::min(begin + AggregationPlan::kMaxFanIn,
+                              tree.proofs.size()),
+          });
+        }
+      }
+      if (merges.empty()) {
+        break;
+      }
+      std::vector<XmssAggregatedSignature> merged(merges.size());
+      runConcurrently(pool, merges.size(), [&](size_t k) {
+        auto &merge = merges[k];
+        auto &tree = trees[merge.item];
+        auto size = merge.end - merge.begin;
+        merged[k] = aggregateSignatures(
+            std::span{tree.public_keys}.subspan(merge.begin, size),
+            std::span{tree.proofs}.subspan(merge.begin, size),
+            {},
+            {},
+            items[merge.item].epoch,
+            items[merge.item].message);
+      });
+      std::vector<Tree> next(trees.size());
+      for (auto &&[merge, proof] : std::views::zip(merges, merged)) {
+        auto &tree = trees[merge.item];
+        auto &keys = next[merge.item].public_keys.emplace_back();
+        for (size_t j = merge.begin; j < merge.end; ++j) {
+          keys.insert(keys.end(),
+                      tree.public_keys[j].begin(),
+                      tree.public_keys[j].end());
+        }
+        next[merge.item].proofs.emplace_back(std::move(proof));
+      }
+      for (auto &&[tree, next_tree] : std::views::zip(trees, next)) {
+        if (not next_tree.proofs.empty()) {
+          tree = std::move(next_tree);
+        }
+      }
+    }
+
+    std::vector<XmssAggregatedSignature> results;
+    results.reserve(items.size());
+    for (auto &tree : trees) {
+      results.emplace_back(std::move(tree.proofs.front()));
+    }
+    return results;
+  }
+
+  WorkerPool &XmssProviderImpl::workerPool() const {
+    std::call_once(worker_pool_once_, [&] {
+      if (not worker_pool_) {
+        worker_pool_ = std::make_shared<WorkerPool>(0);
+      }
+    });
+    return *worker_pool_;
+  }
+
 }  // namespace lean::crypto::xmss
@@ -6,9 +6,18 @@
 
 #pragma once
 
+#include <mutex>
+
 #include <qtils/shared_ref.hpp>
 
+#include "crypto/xmss/aggregation_planner.hpp"
+#include "crypto/xmss/ffi.hpp"
 #include "crypto/xmss/xmss_provider.hpp"
+#include "utils/sharded_lru_cache.hpp"
+
+namespace lean {
+  class WorkerPool;
+}
 
 namespace lean::metrics {
   class Metrics;
@@ -18,11 +27,15 @@ namespace lean::crypto::xmss {
 
   class XmssProviderImpl : public XmssProvider {
    public:
-    XmssProviderImpl() = default;
+    /// Log of inverse rate of aggregation proofs
+    static constexpr size_t kLogInvRate = 2;
+
+    XmssProviderImpl();
 
-    explicit XmssProviderImpl(qtils::SharedRef<metrics::Metrics> metrics);
+    XmssProviderImpl(qtils::SharedRef<metrics::Metrics> metrics,
+                     qtils::SharedRef<WorkerPool> worker_pool);
 
-    ~XmssProviderImpl() override = default;
+    ~XmssProviderImpl() override;
 
     XmssKeypair generateKeypair(uint64_t activation_epoch,
                                 uint64_t num_active_epochs) override;
@@ -37,21 +50,45 @@ namespace lean::crypto::xmss {
                 const XmssSignature &xmss_signature) override;
 
     [[nodiscard]] XmssAggregatedSignature aggregateSignatures(
-        std::span<const std::vector<XmssPublicKey>> child_public_keys,
+        std::span<const std::vector<XmssPublicKeyRef>> child_public_keys,
         std::span<const XmssAggregatedSignature> child_proofs,
-        std::span<const XmssPublicKey> public_keys,
+        std::span<const XmssPublicKeyRef> public_keys,
         std::span<const XmssSignature> signatures,
         uint32_t epoch,
         const XmssMessage &message) const override;
     [[nodiscard]] bool verifyAggregatedSignatures(
-        std::span<const XmssPublicKey> public_keys,
+        std::span<const XmssPublicKeyRef> public_keys,
         uint32_t epoch,
         const XmssMessage &message,
         XmssAggregatedSignatureIn aggregated_signature) const override;
+    [[nodiscard]] std::vector<XmssSignature> signBatch(
+        std::span<const XmssSignItem> items) override;
+    [[nodiscard]] std::vector<bool> verifyBatch(
+        std::span<const XmssVerifyItem> items) const override;
+    [[nodiscard]] std::vector<XmssAggregatedSignature> aggregateBatch(
+        std::span<const XmssAggregateItem> items) const override;
 
    private:
+    /// Parsed keys, enough for attestation and proposal keys of validators
+    static constexpr size_t kPublicKeyCacheSize = 8192;
+
+    /// Deserialize public key once, validators keys are same across
+    /// verifications
+    std::shared_ptr<const ffi::PublicKey> parsePublicKey(
+        const XmssPublicKey &xmss_public_key) const;
+
+    /// Worker pool for batch verification and aggregation, own pool is
+    /// started on first use if none was injected
+    WorkerPool &workerPool() const;
+
+    /// Learned from building times, plans splitting of large groups
+    mutable AggregationCostModel aggregation_cost_;
     bool use_metrics_ = false;
     std::shared_ptr<metrics::Metrics> metrics_;
+    mutable std::once_flag worker_pool_once_;
+    mutable std::shared_ptr<WorkerPool> worker_pool_;
+    mutable ShardedLruCache<XmssPublicKey, ffi::PublicKey> public_keys_{
+        kPublicKeyCacheSize};
   };
 
 }  // namespace lean::crypto::xmss
@@ -16,6 +16,7 @@
 
 #include "crypto/xmss/ffi.hpp"
 #include "qtils/read_file.hpp"
+#include "utils/mapped_file.hpp"
 
 OUTCOME_CPP_DEFINE_CATEGORY(lean::crypto::xmss, XmssUtilError, e) {
   using E = lean::crypto::xmss::XmssUtilError;
@@ -56,27 +57,34 @@ namespace lean::crypto::xmss {
       return public_key_bytes;
     }
 
-    // Parse secret key from JSON file
+    // Parse secret key from JSON or bytes file
     outcome::result<XmssPrivateKey> loadSecretKey(
         const std::filesystem::path &path) {
-      BOOST_OUTCOME_TRY(auto bytes, qtils::readBytes(path));
-
-      PQSecretKey *secret_key_raw = nullptr;
+      BOOST_OUTCOME_TRY(auto file, MappedFile::open(path));
+      auto bytes = file.bytes();
 
       if (path.extension() != ".json") {
-        BOOST_OUTCOME_TRY(ffi::asOutcome(pq_secret_key_from_bytes(
-            bytes.data(), bytes.size(), &secret_key_raw)));
-      } else {
-        BOOST_OUTCOME_TRY(ffi::asOutcome(pq_secret_key_from_json(
-            bytes.data(), bytes.size(), &secret_key_raw)));
+        return secretKeyFromBytes(bytes);
       }
 
+      PQSecretKey *secret_key_raw = nullptr;
+      BOOST_OUTCOME_TRY(ffi::asOutcome(pq_secret_key_from_json(
+          bytes.data(), bytes.size(), &secret_key_raw)));
+
       ffi::SecretKey secret_key{secret_key_raw};
 
       return XmssPrivateKey{std::move(secret_key)};
     }
   }  // namespace
 
+  outcome::result<XmssPrivateKey> secretKeyFromBytes(qtils::BytesIn bytes) {
+    PQSecretKey *secret_key_raw = nullptr;
+    BOOST_OUTCOME_TRY(ffi::asOutcome(
+        pq_secret_key_from_bytes(bytes.data(), bytes.size(), &secret_key_raw)));
+    ffi::SecretKey secret_key{secret_key_raw};
+    return XmssPrivateKey{std::move(secret_key)};
+  }
+
   outcome::result<XmssKeypair> loadKeypair(
       const std::filesystem::path &secret_key_path,
       const std::filesystem::path &public_key_path) {
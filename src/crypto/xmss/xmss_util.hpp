@@ -35,6 +35,9 @@ namespace lean::crypto::xmss {
       const XmssPublicKey &public_key,
       const std::filesystem::path &secret_key_path);
 
+  /// Parse secret key from bytes encoding, as `toBytes` returns
+  outcome::result<XmssPrivateKey> secretKeyFromBytes(qtils::BytesIn bytes);
+
   std::string toJson(const XmssPrivateKey &sk);
   std::string toJson(const XmssPublicKey &pk_bytes);
   qtils::ByteVec toBytes(const XmssPrivateKey &sk);
@@ -9,6 +9,7 @@
 #include <iostream>
 #include <memory>
 #include <system_error>
+#include <vector>
 
 #include <fmt/format.h>
 #include <qtils/final_action.hpp>
@@ -18,14 +19,22 @@
 #include "app/application.hpp"
 #include "app/configuration.hpp"
 #include "app/configurator.hpp"
+#include "app/impl/api_replica.hpp"
+#include "app/impl/validator_client.hpp"
+#include "blockchain/chain_replay.hpp"
+#include "commands/db_snapshot.hpp"
+#include "commands/flight_decode.hpp"
 #include "commands/generate_genesis.hpp"
+#include "commands/key_build_keystore.hpp"
 #include "commands/key_generate_node_key.hpp"
 #include "injector/node_injector.hpp"
 #include "loaders/loader.hpp"
 #include "log/logger.hpp"
+#include "log/tracing.hpp"
 #include "modules/module_loader.hpp"
 #include "se/subscription.hpp"
 #include "types/config.hpp"
+#include "utils/thread_placement.hpp"
 
 using std::string_view_literals::operator""sv;
 
@@ -66,6 +75,48 @@ namespace {
     return EXIT_SUCCESS;
   }
 
+  int run_replay(std::shared_ptr<LoggingSystem> logsys,
+                 std::shared_ptr<Configuration> appcfg) {
+    auto injector = std::make_unique<NodeInjector>(logsys, appcfg);
+
+    auto logger = logsys->getLogger("Main", lean::log::defaultGroupName);
+    auto replay = injector->injectChainReplay();
+    if (auto res = replay->run(); res.has_error()) {
+      SL_CRITICAL(logger, "Chain replay failed: {}", res.error());
+      logger->flush();
+      return EXIT_FAILURE;
+    }
+    logger->flush();
+
+    return EXIT_SUCCESS;
+  }
+
+  int run_validator_client(std::shared_ptr<LoggingSystem> logsys,
+                           std::shared_ptr<Configuration> appcfg) {
+    auto injector = std::make_unique<NodeInjector>(logsys, appcfg);
+
+    auto logger = logsys->getLogger("Main", lean::log::defaultGroupName);
+    auto client = injector->injectValidatorClient();
+    client->run();
+    logger->flush();
+
+    return EXIT_SUCCESS;
+  }
+
+  int run_api_replica(std::shared_ptr<LoggingSystem> logsys,
+                      std::shared_ptr<Configuration> appcfg) {
+    auto logger = logsys->getLogger("Main", lean::log::defaultGroupName);
+    auto replica = std::make_shared<lean::app::ApiReplica>(logsys, appcfg);
+    if (auto res = replica->run(); res.has_error()) {
+      SL_CRITICAL(logger, "Api replica failed: {}", res.error());
+      logger->flush();
+      return EXIT_FAILURE;
+    }
+    logger->flush();
+
+    return EXIT_SUCCESS;
+  }
+
 }  // namespace
 
 int main(int argc, const char **argv, const char **env) {
@@ -74,7 +125,7 @@ int main(int argc, const char **argv, const char **env) {
 
   backward::SignalHandling print_stack_on_signal;
 
-  soralog::util::setThreadName("lean-node");
+  lean::setThreadName("lean-node");
 
   auto getArg = [&](size_t i) {
     return static_cast<ptrdiff_t>(i) < argc
@@ -103,9 +154,32 @@ int main(int argc, const char **argv, const char **env) {
     cmdKeyGenerateNodeKey();
     return EXIT_SUCCESS;
   }
+  if (getArg(1) == "key" and getArg(2) == "build-keystore") {
+    return cmdKeyBuildKeystore(getArg);
+  }
   if (getArg(1) == "generate-genesis") {
     return cmdGenerateGenesis(getArg);
   }
+  if (getArg(1) == "flight-decode") {
+    return cmdFlightDecode(getArg);
+  }
+  if (getArg(1) == "db") {
+    return cmdDbSnapshot(getArg);
+  }
+
+  // `replay <db_dir> [options]` is node run with `--replay-db <db_dir>`,
+  // `api-replica <db_dir> [options]` with `--api-replica-db <db_dir>`
+  std::vector<const char *> replay_args;
+  if (getArg(1) == "replay" or getArg(1) == "api-replica") {
+    if (not getArg(2).has_value()) {
+      wrong_usage();
+      return EXIT_FAILURE;
+    }
+    replay_args.assign(argv, argv + argc);
+    replay_args.at(1) =
+        getArg(1) == "replay" ? "--replay-db" : "--api-replica-db";
+    argv = replay_args.data();
+  }
 
   auto app_configurator =
       std::make_unique<lean::app::Configurator>(argc, argv, env);
@@ -181,6 +255,8 @@ int main(int argc, const char **argv, const char **env) {
 
     config_res.value();
   });
+  lean::setThreadPlacements(app_configuration->threads());
+  lean::placeThreads();
 
   int exit_code;
   auto logger = logging_system->getLogger("Main", lean::log::defaultGroupName);
@@ -189,8 +265,32 @@ int main(int argc, const char **argv, const char **env) {
     std::string_view name{argv[1]};
 
     if (name.substr(0, 1) == "-") {
+      if (app_configuration->traceAtStart()) {
+        auto &path = app_configuration->traceFile();
+        if (auto res = lean::log::startTracing(path); res.has_error()) {
+          SL_ERROR(
+              logger, "Can't start tracing into {}: {}", path, res.error());
+        } else {
+          SL_INFO(logger, "Tracing into {}", path);
+        }
+      }
+      qtils::FinalAction stop_tracing{[] { lean::log::stopTracing(); }};
+      lean::log::startFlightRecorder(
+          app_configuration->flightRecorderEvents(),
+          app_configuration->basePath() / "flight_recorder");
+
       // The first argument isn't subcommand, run as node
-      exit_code = run_node(logging_system, app_configuration);
+      auto replay = app_configuration->replayChain().has_value()
+                 or app_configuration->replayDb().has_value();
+      if (app_configuration->apiReplicaDb().has_value()) {
+        exit_code = run_api_replica(logging_system, app_configuration);
+      } else if (app_configuration->validatorClient()) {
+        exit_code = run_validator_client(logging_system, app_configuration);
+      } else if (replay) {
+        exit_code = run_replay(logging_system, app_configuration);
+      } else {
+        exit_code = run_node(logging_system, app_configuration);
+      }
     }
 
     // else if (false and name == "subcommand-1"s) {
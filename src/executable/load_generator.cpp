@@ -0,0 +1,641 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Gossip load generator: connects to one node, publishes signed
+ * attestations and aggregations at configured rate, and reports how node
+ * keeps up, from its metrics endpoint.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/http/empty_body.hpp>
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/http/write.hpp>
+#include <boost/program_options.hpp>
+#include <fmt/format.h>
+#include <libp2p/coro/spawn.hpp>
+#include <libp2p/host/basic_host.hpp>
+#include <libp2p/injector/host_injector.hpp>
+#include <libp2p/log/logger.hpp>
+#include <libp2p/transport/quic/transport.hpp>
+#include <qtils/to_shared_ptr.hpp>
+#include <soralog/impl/configurator_from_yaml.hpp>
+#include <soralog/logging_system.hpp>
+
+#include "blockchain/validator_subnet.hpp"
+#include "crypto/xmss/xmss_provider_fake.hpp"
+#include "crypto/xmss/xmss_provider_impl.hpp"
+#include "crypto/xmss/xmss_util.hpp"
+#include "modules/networking/get_node_key.hpp"
+#include "modules/networking/gossip.hpp"
+#include "modules/networking/ssz_snappy.hpp"
+#include "serde/json.hpp"
+#include "serde/yaml.hpp"
+#include "types/constants.hpp"
+#include "types/fork_choice_api_json.hpp"
+#include "types/signed_aggregated_attestation.hpp"
+#include "types/signed_attestation.hpp"
+
+namespace {
+  using Clock = std::chrono::system_clock;
+  using lean::crypto::xmss::XmssKeypair;
+  using lean::crypto::xmss::XmssProviderFake;
+  using lean::crypto::xmss::XmssSignature;
+
+  constexpr auto kLogConfig = R"(
+sinks:
+  - name: console
+    type: console
+    stream: stderr
+    color: true
+groups:
+  - name: main
+    sink: console
+    level: warning
+    is_fallback: true
+    children:
+      - name: libp2p
+)";
+
+  struct Options {
+    std::filesystem::path genesis_dir;
+    libp2p::multi::Multiaddress peer;
+    std::string api_text;
+    boost::asio::ip::tcp::endpoint api;
+    double rate = 0;
+    size_t first_validator = 0;
+    std::optional<size_t> validator_count;
+    uint64_t subnet_count = 1;
+    bool aggregate = false;
+    bool fake_xmss = false;
+    std::chrono::seconds duration{0};
+    std::chrono::seconds report_interval{4};
+  };
+
+  std::optional<Options> parseOptions(int argc, const char **argv) {
+    namespace po = boost::program_options;
+    Options options;
+    std::string genesis_dir;
+    std::string peer;
+    std::string api;
+    size_t duration = 0;
+    size_t report_interval = 0;
+    size_t validator_count = 0;
+    po::options_description description{
+        "Publishes gossip to one node and reports its processing lag.\n"
+        "Validators must not be used by running nodes, or their "
+        "attestations conflict.\nOptions"};
+    description.add_options()
+      ("help,h", "show help")
+      ("genesis", po::value(&genesis_dir)->required(),
+       "generate-genesis output directory")
+      ("peer", po::value(&peer)->required(),
+       "multiaddress of node with /p2p/ peer id")
+      ("api", po::value(&api)->default_value("127.0.0.1:9667"),
+       "host:port of node http api and metrics")
+      ("rate", po::value(&options.rate)->default_value(1000),
+       "attestations per second, capped by validators per slot")
+      ("first-validator", po::value(&options.first_validator),
+       "first validator index to attest with")
+      ("validator-count", po::value(&validator_count),
+       "number of validators to attest with, all by default")
+      ("subnet-count", po::value(&options.subnet_count)->default_value(1),
+       "attestation subnets of network")
+      ("aggregate", po::bool_switch(&options.aggregate),
+       "also publish aggregation of each subnet every slot")
+      ("fake-xmss", po::bool_switch(&options.fake_xmss),
+       "publish fake signatures, for nodes of shadow build")
+      ("duration", po::value(&duration)->default_value(0),
+       "seconds to run, 0 is until killed")
+      ("report-interval", po::value(&report_interval)->default_value(4),
+       "seconds between reports");
+    po::variables_map vm;
+    try {
+      po::store(po::parse_command_line(argc, argv, description), vm);
+      if (vm.contains("help")) {
+        std::cout << description << "\n";
+        return std::nullopt;
+      }
+      po::notify(vm);
+    } catch (const std::exception &e) {
+      fmt::println(std::cerr, "{}\n", e.what());
+      std::cerr << description << "\n";
+      return std::nullopt;
+    }
+    options.genesis_dir = genesis_dir;
+    auto peer_res = libp2p::multi::Multiaddress::create(peer);
+    if (not peer_res or not peer_res.value().getPeerId()) {
+      fmt::println(std::cerr, "Invalid --peer {}", peer);
+      return std::nullopt;
+    }
+    options.peer = peer_res.value();
+    auto colon = api.rfind(':');
+    boost::system::error_code ec;
+    auto address = boost::asio::ip::make_address(api.substr(0, colon), ec);
+    if (colon == std::string::npos or ec) {
+      fmt::println(std::cerr, "Invalid --api {}", api);
+      return std::nullopt;
+    }
+    options.api_text = api;
+    options.api = {address,
+                   static_cast<uint16_t>(std::stoul(api.substr(colon + 1)))};
+    if (vm.contains("validator-count")) {
+      options.validator_count = validator_count;
+    }
+    if (options.subnet_count == 0 or options.rate <= 0) {
+      fmt::println(std::cerr, "--subnet-count and --rate must be positive");
+      return std::nullopt;
+    }
+    options.duration = std::chrono::seconds{duration};
+    options.report_interval =
+        std::chrono::seconds{std::max<size_t>(report_interval, 1)};
+    return options;
+  }
+
+  /// Body of successful response, nullopt on any error
+  std::optional<std::string> httpGet(
+      const boost::asio::ip::tcp::endpoint &endpoint, const char *target) {
+    namespace http = boost::beast::http;
+    boost::asio::io_context io_context;
+    boost::asio::ip::tcp::socket socket{io_context};
+    boost::system::error_code ec;
+    socket.connect(endpoint, ec);
+    if (ec) {
+      return std::nullopt;
+    }
+    http::request<http::empty_body> request{http::verb::get, target, 11};
+    request.set(http::field::host, endpoint.address().to_string());
+    http::write(socket, request, ec);
+    boost::beast::flat_buffer buffer;
+    http::response<http::string_body> response;
+    if (not ec) {
+      http::read(socket, buffer, response, ec);
+    }
+    if (ec or response.result() != http::status::ok) {
+      return std::nullopt;
+    }
+    return std::move(response.body());
+  }
+
+  /// Sum of samples of each metric in prometheus text, over all labels
+  std::map<std::string, double, std::less<>> parseMetrics(
+      std::string_view text) {
+    std::map<std::string, double, std::less<>> metrics;
+    while (not text.empty()) {
+      auto end = text.find('\n');
+      auto line = text.substr(0, end);
+      text.remove_prefix(end == text.npos ? text.size() : end + 1);
+      if (line.empty() or line.starts_with('#')) {
+        continue;
+      }
+      auto name_end = line.find_first_of("{ ");
+      auto value_begin = line.rfind(' ');
+      if (name_end == line.npos or value_begin == line.npos) {
+        continue;
+      }
+      try {
+        metrics[std::string{line.substr(0, name_end)}] +=
+            std::stod(std::string{line.substr(value_begin + 1)});
+      } catch (const std::exception &) {
+      }
+    }
+    return metrics;
+  }
+
+  struct Validator {
+    lean::ValidatorIndex index;
+    XmssKeypair keypair;
+  };
+
+  /// Keys listed in validator keys manifest written by generate-genesis
+  std::vector<Validator> loadValidators(const Options &options) {
+    auto keys_dir = options.genesis_dir / "hash-sig-keys";
+    auto yaml = lean::yaml::read(keys_dir / "validator-keys-manifest.yaml");
+    std::vector<Validator> validators;
+    for (auto &&yaml_item : yaml.map("validators").list()) {
+      auto index = yaml_item.map("index").num<lean::ValidatorIndex>();
+      auto last = options.validator_count
+                    ? options.first_validator + *options.validator_count
+                    : std::numeric_limits<size_t>::max();
+      if (index < options.first_validator or index >= last) {
+        continue;
+      }
+      auto public_key = lean::crypto::xmss::XmssPublicKey::fromHex(
+                            yaml_item.map("pubkey_hex").str())
+                            .value();
+      auto private_key_file = yaml_item.map("privkey_file").str();
+      validators.emplace_back(Validator{
+          .index = index,
+          .keypair = options.fake_xmss
+                       ? XmssProviderFake::loadKeypair(public_key,
+                                                       private_key_file)
+                       : lean::crypto::xmss::loadKeypair(
+                             public_key, keys_dir / private_key_file)
+                             .value(),
+      });
+    }
+    return validators;
+  }
+
+  /// Counters shared by publisher and reporter
+  struct Counters {
+    std::atomic_uint64_t attestations = 0;
+    std::atomic_uint64_t aggregations = 0;
+    std::atomic_uint64_t skipped_slots = 0;
+  };
+
+  class LoadGenerator {
+   public:
+    LoadGenerator(Options options, std::vector<Validator> validators)
+        : options_{std::move(options)},
+          validators_{std::move(validators)},
+          genesis_time_{std::chrono::seconds{
+              lean::yaml::read(options_.genesis_dir / "config.yaml")
+                  .map("GENESIS_TIME")
+                  .num<uint64_t>()}} {}
+
+    /// Connect to node and join topics, on io thread
+    void start() {
+      libp2p::protocol::gossip::Config gossip_config;
+      gossip_config.validation_mode =
+          libp2p::protocol::gossip::ValidationMode::Anonymous;
+      gossip_config.message_authenticity =
+          libp2p::protocol::gossip::MessageAuthenticity::Anonymous;
+      // Same ids as node, so its duplicate detection works on our messages
+      gossip_config.message_id_fn =
+          [](const libp2p::protocol::gossip::Message &message) {
+            std::optional<qtils::BytesIn> uncompressed;
+            auto uncompressed_res = lean::snappy::uncompress(message.data);
+            if (uncompressed_res) {
+              uncompressed = uncompressed_res.value();
+            }
+            return lean::modules::gossipMessageId(message, uncompressed);
+          };
+      auto injector = qtils::toSharedPtr(libp2p::injector::makeHostInjector(
+          libp2p::injector::useKeyPair(lean::randomKeyPair()),
+          libp2p::injector::useGossipConfig(std::move(gossip_config)),
+          libp2p::injector::useTransportAdaptors<
+              libp2p::transport::QuicTransport>()));
+      injector_ = injector;
+      io_context_ =
+          injector->create<std::shared_ptr<boost::asio::io_context>>();
+      host_ = injector->create<std::shared_ptr<libp2p::host::BasicHost>>();
+      gossip_ =
+          injector->create<std::shared_ptr<libp2p::protocol::gossip::Gossip>>();
+      // Quic dials from socket of listener
+      auto listen = libp2p::multi::Multiaddress::create(
+                        "/ip4/0.0.0.0/udp/0/quic-v1")
+                        .value();
+      if (auto r = host_->listen(listen); not r) {
+        fmt::println(std::cerr, "Listening {} failed: {}", listen, r.error());
+      }
+      host_->start();
+      gossip_->start();
+
+      for (lean::SubnetIndex subnet = 0; subnet < options_.subnet_count;
+           ++subnet) {
+        attestation_topics_.emplace_back(
+            join(std::format("attestation_{}", subnet)));
+      }
+      aggregation_topic_ = join("aggregation");
+      join("block");
+
+      libp2p::peer::PeerInfo peer_info{
+          .id = libp2p::PeerId::fromBase58(*options_.peer.getPeerId()).value(),
+          .addresses = {options_.peer},
+      };
+      libp2p::coroSpawn(
+          *io_context_,
+          [host{host_}, peer_info]() -> libp2p::Coro<void> {
+            if (auto r = co_await host->connect(peer_info); not r) {
+              fmt::println(std::cerr,
+                           "Connecting {} failed: {}",
+                           peer_info.id.toBase58(),
+                           r.error());
+            }
+          });
+    }
+
+    boost::asio::io_context &ioContext() {
+      return *io_context_;
+    }
+
+    /// Publish until `deadline`, on calling thread
+    void run(std::optional<Clock::time_point> deadline) {
+      auto slot = currentSlot() + 1;
+      while (not deadline or Clock::now() < *deadline) {
+        // Attestations are produced at second interval of slot
+        std::this_thread::sleep_until(slotStart(slot)
+                                      + lean::INTERVAL_DURATION_MS);
+        if (currentSlot() > slot) {
+          // Signing didn't fit into slot, don't publish stale slots
+          ++counters_.skipped_slots;
+          slot = currentSlot() + 1;
+          continue;
+        }
+        publishSlot(slot);
+        ++slot;
+      }
+    }
+
+    /// Print lag of node every report interval, until `deadline`
+    void report(std::optional<Clock::time_point> deadline) {
+      std::optional<std::map<std::string, double, std::less<>>> previous;
+      uint64_t sent_previous = 0;
+      auto seconds = std::chrono::duration<double>(options_.report_interval)
+                         .count();
+      while (not deadline or Clock::now() < *deadline) {
+        std::this_thread::sleep_for(options_.report_interval);
+        auto sent = counters_.attestations.load();
+        auto text = httpGet(options_.api, "/metrics");
+        if (not text) {
+          fmt::println("metrics of {} unavailable", options_.api_text);
+          continue;
+        }
+        auto metrics = parseMetrics(*text);
+        auto value = [&](std::string_view name) {
+          auto it = metrics.find(name);
+          return it == metrics.end() ? 0.0 : it->second;
+        };
+        auto rate = [&](std::string_view name) {
+          if (not previous) {
+            return 0.0;
+          }
+          auto it = previous->find(name);
+          auto before = it == previous->end() ? 0.0 : it->second;
+          return (value(name) - before) / seconds;
+        };
+        fmt::println(
+            "sent {:.0f}/s, node received {:.0f}/s, valid {:.0f}/s, "
+            "invalid {:.0f}/s, head lag {} slots, finalized lag {} slots, "
+            "aggregations {}, skipped slots {}",
+            static_cast<double>(sent - sent_previous) / seconds,
+            rate("lean_gossip_subnet_attestations_total"),
+            rate("lean_attestations_valid_total"),
+            rate("lean_attestations_invalid_total"),
+            value("lean_current_slot") - value("lean_head_slot"),
+            value("lean_current_slot") - value("lean_latest_finalized_slot"),
+            counters_.aggregations.load(),
+            counters_.skipped_slots.load());
+        previous = std::move(metrics);
+        sent_previous = sent;
+      }
+    }
+
+   private:
+    std::shared_ptr<libp2p::protocol::gossip::Topic> join(
+        std::string_view type) {
+      auto topic = gossip_->subscribe(lean::modules::gossipTopic(type));
+      // Messages of node are not needed, but must be consumed
+      libp2p::coroSpawn(*io_context_, [topic]() -> libp2p::Coro<void> {
+        while (co_await topic->receiveMessage()) {
+        }
+      });
+      return topic;
+    }
+
+    Clock::time_point slotStart(lean::Slot slot) const {
+      return genesis_time_ + slot * lean::SLOT_DURATION_MS;
+    }
+
+    lean::Slot currentSlot() const {
+      auto now = Clock::now();
+      if (now < genesis_time_) {
+        return 0;
+      }
+      return (now - genesis_time_) / lean::SLOT_DURATION_MS;
+    }
+
+    /// Attestation data like validator of node would make
+    std::optional<lean::AttestationData> attestationData(lean::Slot slot) {
+      auto text = httpGet(options_.api, "/lean/v0/fork_choice");
+      if (not text) {
+        return std::nullopt;
+      }
+      lean::ForkChoiceApiJson fork_choice;
+      try {
+        lean::json::decode(lean::json::NameCase::SNAKE, fork_choice, *text);
+      } catch (const std::exception &) {
+        return std::nullopt;
+      }
+      auto checkpoint = [&](const lean::BlockHash &root) {
+        lean::Checkpoint checkpoint{.root = root};
+        for (auto &node : fork_choice.nodes) {
+          if (node.root == root) {
+            checkpoint.slot = node.slot;
+          }
+        }
+        return checkpoint;
+      };
+      return lean::AttestationData{
+          .slot = slot,
+          .head = checkpoint(fork_choice.head),
+          .target = checkpoint(fork_choice.safe_target),
+          .source = fork_choice.justified,
+      };
+    }
+
+    void publishSlot(lean::Slot slot) {
+      auto data = attestationData(slot);
+      if (not data) {
+        fmt::println(std::cerr,
+                     "fork choice of {} unavailable",
+                     options_.api_text);
+        return;
+      }
+      auto per_slot = static_cast<size_t>(
+          options_.rate
+          * std::chrono::duration<double>(lean::SLOT_DURATION_MS).count());
+      per_slot = std::clamp<size_t>(per_slot, 1, validators_.size());
+      // Rotate validators, so all of them attest over slots
+      std::vector<const Validator *> attesters;
+      for (size_t i = 0; i < per_slot; ++i) {
+        attesters.emplace_back(
+            &validators_[(slot * per_slot + i) % validators_.size()]);
+      }
+
+      auto message = lean::sszHash(*data);
+      auto epoch = static_cast<uint32_t>(slot);
+      std::vector<XmssSignature> signatures;
+      if (options_.fake_xmss) {
+        for (auto *attester : attesters) {
+          XmssProviderFake::randomBytesSeed(
+              signatures.emplace_back(),
+              static_cast<uint32_t>(attester->index ^ slot));
+        }
+      } else {
+        std::vector<lean::crypto::xmss::XmssSignItem> items;
+        for (auto *attester : attesters) {
+          items.emplace_back(lean::crypto::xmss::XmssSignItem{
+              .private_key = attester->keypair.private_key,
+              .epoch = epoch,
+              .message = message,
+          });
+        }
+        signatures = provider_.signBatch(items);
+      }
+
+      // Spread over rest of the slot
+      auto begin = Clock::now();
+      auto window = slotStart(slot + 1) - begin;
+      for (size_t i = 0; i < attesters.size(); ++i) {
+        std::this_thread::sleep_until(
+            begin + window * i / attesters.size());
+        lean::SignedAttestation signed_attestation{
+            .validator_id = attesters[i]->index,
+            .data = *data,
+            .signature = signatures[i],
+        };
+        auto subnet = lean::validatorSubnet(attesters[i]->index,
+                                            options_.subnet_count);
+        publish(attestation_topics_.at(subnet),
+                lean::encodeSszSnappy(signed_attestation));
+        ++counters_.attestations;
+      }
+
+      if (options_.aggregate) {
+        publishAggregations(*data, attesters, signatures);
+      }
+    }
+
+    void publishAggregations(const lean::AttestationData &data,
+                             std::span<const Validator *const> attesters,
+                             std::span<const XmssSignature> signatures) {
+      struct Group {
+        std::vector<lean::crypto::xmss::XmssPublicKeyRef> public_keys;
+        std::vector<XmssSignature> signatures;
+        lean::AggregationBits participants;
+      };
+      std::vector<Group> groups(options_.subnet_count);
+      for (size_t i = 0; i < attesters.size(); ++i) {
+        auto &group = groups.at(lean::validatorSubnet(attesters[i]->index,
+                                                      options_.subnet_count));
+        group.public_keys.emplace_back(&attesters[i]->keypair.public_key);
+        group.signatures.emplace_back(signatures[i]);
+        group.participants.add(attesters[i]->index);
+      }
+      std::erase_if(groups, [](const Group &group) {
+        return group.signatures.empty();
+      });
+      std::vector<lean::crypto::xmss::XmssAggregatedSignature> proofs;
+      if (options_.fake_xmss) {
+        for (auto &group : groups) {
+          auto &proof = proofs.emplace_back(
+              XmssProviderFake::kAggregatedSignatureSize);
+          XmssProviderFake::randomBytesSeed(
+              proof, static_cast<uint32_t>(group.signatures.size()));
+        }
+      } else {
+        std::vector<lean::crypto::xmss::XmssAggregateItem> items;
+        for (auto &group : groups) {
+          items.emplace_back(lean::crypto::xmss::XmssAggregateItem{
+              .public_keys = group.public_keys,
+              .signatures = group.signatures,
+              .epoch = static_cast<uint32_t>(data.slot),
+              .message = lean::sszHash(data),
+          });
+        }
+        proofs = provider_.aggregateBatch(items);
+      }
+      for (auto &&[group, proof] : std::views::zip(groups, proofs)) {
+        lean::SignedAggregatedAttestation aggregated{
+            .data = data,
+            .proof =
+                {
+                    .participants = std::move(group.participants),
+                    .proof_data = std::move(proof),
+                },
+        };
+        publish(aggregation_topic_, lean::encodeSszSnappy(aggregated));
+        ++counters_.aggregations;
+      }
+    }
+
+    void publish(std::shared_ptr<libp2p::protocol::gossip::Topic> topic,
+                 qtils::ByteVec message) {
+      boost::asio::post(
+          *io_context_,
+          [topic{std::move(topic)}, message{std::move(message)}]() mutable {
+            topic->publish(std::move(message));
+          });
+    }
+
+    Options options_;
+    std::vector<Validator> validators_;
+    Clock::time_point genesis_time_;
+    lean::crypto::xmss::XmssProviderImpl provider_;
+    Counters counters_;
+    std::shared_ptr<void> injector_;
+    std::shared_ptr<boost::asio::io_context> io_context_;
+    std::shared_ptr<libp2p::host::BasicHost> host_;
+    std::shared_ptr<libp2p::protocol::gossip::Gossip> gossip_;
+    std::vector<std::shared_ptr<libp2p::protocol::gossip::Topic>>
+        attestation_topics_;
+    std::shared_ptr<libp2p::protocol::gossip::Topic> aggregation_topic_;
+  };
+}  // namespace
+
+int main(int argc, const char **argv) {
+  setlinebuf(stdout);
+
+  auto options = parseOptions(argc, argv);
+  if (not options) {
+    return EXIT_FAILURE;
+  }
+
+  auto logging_system = std::make_shared<soralog::LoggingSystem>(
+      std::make_shared<soralog::ConfiguratorFromYAML>(std::string{kLogConfig}));
+  if (auto r = logging_system->configure(); r.has_error) {
+    fmt::println(std::cerr, "{}", r.message);
+    return EXIT_FAILURE;
+  }
+  libp2p::log::setLoggingSystem(logging_system);
+
+  std::vector<Validator> validators;
+  try {
+    validators = loadValidators(*options);
+  } catch (const std::exception &e) {
+    fmt::println(std::cerr, "Loading validator keys failed: {}", e.what());
+    return EXIT_FAILURE;
+  }
+  if (validators.empty()) {
+    fmt::println(std::cerr, "No validators selected");
+    return EXIT_FAILURE;
+  }
+  fmt::println("Loaded {} validator keys", validators.size());
+
+  std::optional<Clock::time_point> deadline;
+  if (options->duration.count() != 0) {
+    deadline = Clock::now() + options->duration;
+  }
+  LoadGenerator generator{*options, std::move(validators)};
+  generator.start();
+  auto work = boost::asio::make_work_guard(generator.ioContext());
+  std::jthread io_thread{[&] { generator.ioContext().run(); }};
+  std::jthread reporter{[&] { generator.report(deadline); }};
+  generator.run(deadline);
+  reporter.join();
+  generator.ioContext().stop();
+  return EXIT_SUCCESS;
+}
@@ -25,8 +25,11 @@
 #include "app/impl/http_server.hpp"
 #include "app/impl/state_manager_impl.hpp"
 #include "app/impl/timeline_impl.hpp"
+#include "app/impl/validator_client.hpp"
 #include "app/impl/validator_keys_manifest_impl.hpp"
 #include "app/impl/watchdog.hpp"
+#include "blockchain/chain_record.hpp"
+#include "blockchain/chain_replay.hpp"
 #include "blockchain/fork_choice.hpp"
 #include "blockchain/fork_choice_mutex.hpp"
 #include "blockchain/genesis_config.hpp"
@@ -34,9 +37,12 @@
 #include "blockchain/impl/anchor_state_impl.hpp"
 #include "blockchain/impl/block_storage_impl.hpp"
 #include "blockchain/impl/block_tree_impl.hpp"
+#include "blockchain/impl/block_value_codec.hpp"
 #include "blockchain/impl/validator_registry_impl.hpp"
+#include "blockchain/stored_chain.hpp"
 #include "clock/impl/clock_impl.hpp"
 #include "crypto/hasher/hasher_impl.hpp"
+#include "crypto/xmss/xmss_provider_accelerated.hpp"
 #include "crypto/xmss/xmss_provider_fake.hpp"
 #include "crypto/xmss/xmss_provider_impl.hpp"
 #include "executable/qlean_enable_shadow.hpp"
@@ -49,10 +55,16 @@
 #include "modules/module.hpp"
 #include "se/impl/async_dispatcher_impl.hpp"
 #include "se/subscription.hpp"
+#include "serde/parallel_hash.hpp"
+#include "storage/ancient_store.hpp"
+#include "storage/in_memory/hashed_memory_spaced_storage.hpp"
 #include "storage/in_memory/in_memory_spaced_storage.hpp"
 #include "storage/in_memory/in_memory_storage.hpp"
 #include "storage/rocksdb/rocksdb.hpp"
+#include "storage/write_behind_storage.hpp"
 #include "types/config.hpp"
+#include "types/slot.hpp"
+#include "utils/worker_pool.hpp"
 
 namespace {
   namespace di = boost::di;
@@ -88,16 +100,85 @@ namespace {
         di::bind<log::LoggingSystem>.to(logsys),
         di::bind<app::StateManager>.to<app::StateManagerImpl>(),
         di::bind<app::Application>.to<app::ApplicationImpl>(),
-        di::bind<clock::SystemClock>.to<clock::SystemClockImpl>(),
+        bind_by_lambda<clock::SystemClock>([](const auto &injector)
+            -> std::shared_ptr<clock::SystemClock> {
+          auto &config = injector.template create<const app::Configuration &>();
+          if (auto &path = config.replayChain(); path.has_value()) {
+            // Replay starts at time recording started
+            auto anchor = readChainRecordingAnchor(*path);
+            if (anchor.has_value()) {
+              return std::make_shared<clock::FrozenSystemClock>(
+                  anchor.value().time);
+            }
+          }
+          if (config.replayDb().has_value()) {
+            // Replay of stored blocks starts at anchor slot
+            auto &state = injector.template create<const AnchorState &>();
+            return std::make_shared<clock::FrozenSystemClock>(
+                Interval::fromSlot(state.slot, 0).time(state.config));
+          }
+          return std::make_shared<clock::SystemClockImpl>();
+        }),
         di::bind<clock::SteadyClock>.to<clock::SteadyClockImpl>(),
         di::bind<Watchdog>.to<Watchdog>(),
+        bind_by_lambda<WorkerPool>([](const auto &injector) {
+          auto worker_pool = std::make_shared<WorkerPool>(
+              injector.template create<const app::Configuration &>()
+                  .workerThreads());
+          setHashWorkerPool(worker_pool);
+          return worker_pool;
+        }),
         di::bind<Dispatcher>.to<se::AsyncDispatcher<kHandlersCount, kThreadPoolSize>>(),
         di::bind<metrics::Registry>.to<metrics::PrometheusRegistry>(),
         di::bind<metrics::Metrics>.to<metrics::MetricsImpl>(),
         di::bind<metrics::Handler>.to<metrics::PrometheusHandler>(),
         di::bind<storage::BufferStorage>.to<storage::InMemoryStorage>(),
-        //di::bind<storage::SpacedStorage>.to<storage::InMemorySpacedStorage>(),
-        di::bind<storage::SpacedStorage>.to<storage::RocksDb>(),
+        bind_by_lambda<storage::SpacedStorage>([](const auto &injector)
+            -> std::shared_ptr<storage::SpacedStorage> {
+          auto &config = injector.template create<const app::Configuration &>();
+          if (config.database().in_memory) {
+            using MemoryBackend =
+                app::Configuration::DatabaseConfig::MemoryBackend;
+            if (config.database().in_memory_backend
+                == MemoryBackend::Ordered) {
+              return std::make_shared<storage::InMemorySpacedStorage>();
+            }
+            return std::make_shared<storage::HashedMemorySpacedStorage>();
+          }
+          return std::make_shared<storage::WriteBehindStorage>(
+              injector.template create<qtils::SharedRef<log::LoggingSystem>>(),
+              injector.template create<qtils::SharedRef<storage::RocksDb>>());
+        }),
+        bind_by_lambda<storage::AncientStore>([](const auto &injector)
+            -> std::shared_ptr<storage::AncientStore> {
+          auto &config = injector.template create<const app::Configuration &>();
+          if (config.database().in_memory
+              or not config.database().ancient_store) {
+            return nullptr;
+          }
+          auto res = storage::AncientStore::open(
+              config.database().directory / "ancient");
+          if (res.has_error()) {
+            qtils::raise(res.error());
+          }
+          return std::move(res.value());
+        }),
+        bind_by_lambda<blockchain::BlockValueCodec>([](const auto &injector) {
+          auto &config = injector.template create<const app::Configuration &>();
+          return std::make_shared<blockchain::BlockValueCodec>(
+              config.database().compress_blocks);
+        }),
+        bind_by_lambda<blockchain::StoredChain>([](const auto &injector)
+            -> std::shared_ptr<blockchain::StoredChain> {
+          auto &config = injector.template create<const app::Configuration &>();
+          if (not config.replayDb().has_value()) {
+            return nullptr;
+          }
+          return std::make_shared<blockchain::StoredChain>(
+              injector.template create<qtils::SharedRef<log::LoggingSystem>>(),
+              injector.template create<
+                  qtils::SharedRef<const app::Configuration>>());
+        }),
         di::bind<app::ChainSpec>.to<app::ChainSpecImpl>(),
         di::bind<crypto::Hasher>.to<crypto::HasherImpl>(),
         di::bind<AnchorState>.to<blockchain::AnchorStateImpl>(),
@@ -107,7 +188,17 @@ namespace {
         di::bind<blockchain::BlockTree>.to<blockchain::BlockTreeImpl>(),
         di::bind<ValidatorRegistry>.to<ValidatorRegistryImpl>(),
         di::bind<app::ValidatorKeysManifest>.to<app::ValidatorKeysManifestImpl>(),
-        di::bind<crypto::xmss::XmssProvider>.to<InjectXmssProvider>(),
+        bind_by_lambda<crypto::xmss::XmssProvider>([](const auto &injector)
+            -> std::shared_ptr<crypto::xmss::XmssProvider> {
+          auto &config = injector.template create<const app::Configuration &>();
+          if (not QLEAN_ENABLE_SHADOW
+              and config.xmssAccelerator().has_value()) {
+            return injector.template create<
+                std::shared_ptr<crypto::xmss::XmssProviderAccelerated>>();
+          }
+          return injector.template create<
+              std::shared_ptr<InjectXmssProvider>>();
+        }),
 
         // user-defined overrides...
         std::forward<decltype(args)>(args)...);
@@ -149,6 +240,15 @@ namespace lean::injector {
         .template create<std::shared_ptr<app::Application>>();
   }
 
+  std::shared_ptr<ChainReplay> NodeInjector::injectChainReplay() {
+    return pimpl_->injector_.template create<std::shared_ptr<ChainReplay>>();
+  }
+
+  std::shared_ptr<app::ValidatorClient> NodeInjector::injectValidatorClient() {
+    return pimpl_->injector_
+        .template create<std::shared_ptr<app::ValidatorClient>>();
+  }
+
   void NodeInjector::register_loader(std::shared_ptr<modules::Module> module) {
     auto logsys = pimpl_->injector_
                       .template create<std::shared_ptr<log::LoggingSystem>>();
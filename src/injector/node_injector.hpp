@@ -10,6 +10,10 @@
 
 #include "se/subscription.hpp"
 
+namespace lean {
+  class ChainReplay;
+}  // namespace lean
+
 namespace lean::log {
   class LoggingSystem;
 }  // namespace lean::log
@@ -17,6 +21,7 @@ namespace lean::log {
 namespace lean::app {
   class Configuration;
   class Application;
+  class ValidatorClient;
 }  // namespace lean::app
 
 namespace lean::loaders {
@@ -39,6 +44,10 @@ namespace lean::injector {
                           std::shared_ptr<app::Configuration> app_config);
 
     std::shared_ptr<app::Application> injectApplication();
+    /// Replay of `--replay-chain` or `--replay-db`, instead of application
+    std::shared_ptr<ChainReplay> injectChainReplay();
+    /// Validator process of `--validator-client`, instead of application
+    std::shared_ptr<app::ValidatorClient> injectValidatorClient();
     void register_loader(std::shared_ptr<modules::Module> module);
 
    protected:
@@ -0,0 +1,41 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "modules/networking/interfaces.hpp"
+#include "modules/qlean_direct_modules.hpp"
+
+namespace lean::loaders {
+
+  /**
+   * Typed interfaces of started modules, so loaders call each other's
+   * modules directly with `QLEAN_DIRECT_MODULES` build option.
+   * Hot path messages, i.e. blocks and votes to gossip, skip SE message
+   * dispatch and its thread hop; lifecycle and timer events still go
+   * through SE. Modules are bound when their loaders start, before node
+   * runs, and are not rebound.
+   */
+  class ModuleBindings {
+   public:
+    void bindNetworking(std::weak_ptr<modules::Networking> networking) {
+      if constexpr (QLEAN_DIRECT_MODULES) {
+        networking_ = std::move(networking);
+      }
+    }
+
+    /// @return null if networking is not bound, caller dispatches by SE
+    std::shared_ptr<modules::Networking> networking() const {
+      return networking_.lock();
+    }
+
+   private:
+    std::weak_ptr<modules::Networking> networking_;
+  };
+
+}  // namespace lean::loaders
@@ -11,6 +11,7 @@
 #include <qtils/empty.hpp>
 #include <soralog/logging_system.hpp>
 
+#include "loaders/impl/module_bindings.hpp"
 #include "loaders/loader.hpp"
 #include "log/logger.hpp"
 #include "modules/networking/networking.hpp"
@@ -20,6 +21,7 @@
 namespace lean {
   class ForkChoiceStoreMutex;
   class ValidatorRegistry;
+  class Watchdog;
 }  // namespace lean
 
 namespace lean::blockchain {
@@ -31,6 +33,10 @@ namespace lean::app {
   class Configuration;
 }  // namespace lean::app
 
+namespace lean::storage {
+  class SpacedStorage;
+}  // namespace lean::storage
+
 namespace lean::loaders {
 
   class NetworkingLoader final
@@ -46,6 +52,9 @@ namespace lean::loaders {
     qtils::SharedRef<GenesisConfig> genesis_config_;
     qtils::SharedRef<app::ChainSpec> chain_spec_;
     qtils::SharedRef<app::Configuration> app_config_;
+    qtils::SharedRef<Watchdog> watchdog_;
+    qtils::SharedRef<storage::SpacedStorage> storage_;
+    qtils::SharedRef<ModuleBindings> bindings_;
 
     std::shared_ptr<lean::modules::NetworkingImpl> module_internal_;
 
@@ -65,6 +74,10 @@ namespace lean::loaders {
                        modules::Networking,
                        &modules::Networking::onSendSignedAggregatedAttestation>
         subscription_send_signed_aggregated_attestation_;
+    SimpleSubscription<messages::SendGossipBatch,
+                       modules::Networking,
+                       &modules::Networking::onSendGossipBatch>
+        subscription_send_gossip_batch_;
 
    public:
     NetworkingLoader(std::shared_ptr<log::LoggingSystem> logsys,
@@ -76,7 +89,10 @@ namespace lean::loaders {
                      qtils::SharedRef<ValidatorRegistry> validator_registry,
                      qtils::SharedRef<GenesisConfig> genesis_config,
                      qtils::SharedRef<app::ChainSpec> chain_spec,
-                     qtils::SharedRef<app::Configuration> app_config)
+                     qtils::SharedRef<app::Configuration> app_config,
+                     qtils::SharedRef<Watchdog> watchdog,
+                     qtils::SharedRef<storage::SpacedStorage> storage,
+                     qtils::SharedRef<ModuleBindings> bindings)
         : Loader(std::move(logsys), std::move(se_manager)),
           logger_(logsys_->getLogger("Networking", "networking_module")),
           metrics_{std::move(metrics)},
@@ -86,7 +102,10 @@ namespace lean::loaders {
           validator_registry_{std::move(validator_registry)},
           genesis_config_{std::move(genesis_config)},
           chain_spec_{std::move(chain_spec)},
-          app_config_{std::move(app_config)} {}
+          app_config_{std::move(app_config)},
+          watchdog_{std::move(watchdog)},
+          storage_{std::move(storage)},
+          bindings_{std::move(bindings)} {}
 
     NetworkingLoader(const NetworkingLoader &) = delete;
     NetworkingLoader &operator=(const NetworkingLoader &) = delete;
@@ -105,7 +124,9 @@ namespace lean::loaders {
                                                        validator_registry_,
                                                        genesis_config_,
                                                        chain_spec_,
-                                                       app_config_);
+                                                       app_config_,
+                                                       watchdog_,
+                                                       storage_);
 
       on_init_complete_ = se::SubscriberCreator<qtils::Empty>::template create<
           EventTypes::NetworkingIsLoaded>(
@@ -126,6 +147,9 @@ namespace lean::loaders {
       subscription_send_signed_vote_.subscribe(*se_manager_, module_internal_);
       subscription_send_signed_aggregated_attestation_.subscribe(
           *se_manager_, module_internal_);
+      subscription_send_gossip_batch_.subscribe(*se_manager_, module_internal_);
+      // Subscriptions stay for other senders, e.g. http api
+      bindings_->bindNetworking(module_internal_);
 
       se_manager_->notify(lean::EventTypes::NetworkingIsLoaded);
     }
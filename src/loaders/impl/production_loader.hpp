@@ -8,6 +8,7 @@
 
 #include <qtils/empty.hpp>
 
+#include "loaders/impl/module_bindings.hpp"
 #include "loaders/loader.hpp"
 #include "log/logger.hpp"
 #include "modules/production/production.hpp"
@@ -27,6 +28,7 @@ namespace lean::loaders {
     qtils::SharedRef<crypto::Hasher> hasher_;
     qtils::SharedRef<ForkChoiceStoreMutex> fork_choice_store_;
     qtils::SharedRef<clock::SystemClock> clock_;
+    qtils::SharedRef<ModuleBindings> bindings_;
 
     std::shared_ptr<lean::modules::ProductionModuleImpl> module_internal_;
 
@@ -55,12 +57,14 @@ namespace lean::loaders {
                      qtils::SharedRef<blockchain::BlockTree> block_tree,
                      qtils::SharedRef<crypto::Hasher> hasher,
                      qtils::SharedRef<ForkChoiceStoreMutex> fork_choice_store,
-                     qtils::SharedRef<clock::SystemClock> clock)
+                     qtils::SharedRef<clock::SystemClock> clock,
+                     qtils::SharedRef<ModuleBindings> bindings)
         : Loader(std::move(logsys), std::move(se_manager)),
           block_tree_(std::move(block_tree)),
           hasher_(std::move(hasher)),
           fork_choice_store_(std::move(fork_choice_store)),
-          clock_(clock) {}
+          clock_(clock),
+          bindings_(std::move(bindings)) {}
 
     ProductionLoader(const ProductionLoader &) = delete;
     ProductionLoader &operator=(const ProductionLoader &) = delete;
@@ -94,10 +98,11 @@ namespace lean::loaders {
                 module_internal_->on_slot_interval_started(std::move(msg));
               });
 
+      // Leaves added while module is busy, e.g. during catch-up, are stale
       on_leave_update_ =
           se::SubscriberCreator<qtils::Empty,
                                 std::shared_ptr<const messages::NewLeaf>>::
-              create<EventTypes::BlockAdded>(
+              createLatestWins<EventTypes::BlockAdded>(
                   *se_manager_,
                   SubscriptionEngineHandlers::kTest,
                   [this](auto &, auto msg) {
@@ -123,17 +128,43 @@ namespace lean::loaders {
 
     void dispatchSendSignedBlock(
         std::shared_ptr<const messages::SendSignedBlock> message) override {
+      if (auto networking = bindings_->networking()) {
+        networking->onSendSignedBlock(std::move(message));
+        return;
+      }
       dispatchDerive(*se_manager_, message);
     }
 
     void dispatchSendSignedVote(
         std::shared_ptr<const messages::SendSignedVote> message) override {
+      if (auto networking = bindings_->networking()) {
+        networking->onSendSignedVote(std::move(message));
+        return;
+      }
       dispatchDerive(*se_manager_, message);
     }
 
     void dispatchSendSignedAggregatedAttestation(
         std::shared_ptr<const messages::SendSignedAggregatedAttestation>
             message) override {
+      if (auto networking = bindings_->networking()) {
+        networking->onSendSignedAggregatedAttestation(std::move(message));
+        return;
+      }
+      dispatchDerive(*se_manager_, message);
+    }
+
+    void dispatchSendGossipBatch(
+        std::shared_ptr<const messages::SendGossipBatch> message) override {
+      if (auto networking = bindings_->networking()) {
+        networking->onSendGossipBatch(std::move(message));
+        return;
+      }
+      dispatchDerive(*se_manager_, message);
+    }
+
+    void dispatchAttestationDuty(
+        std::shared_ptr<const messages::AttestationDuty> message) override {
       dispatchDerive(*se_manager_, message);
     }
   };
@@ -0,0 +1,352 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "log/flight_recorder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <fmt/format.h>
+#include <soralog/util.hpp>
+
+namespace lean::log {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+  std::atomic_bool flight_recorder_enabled = false;
+
+  namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::string_view kMagic = "QLFLIGHT";
+    constexpr uint32_t kVersion = 1;
+    /// Words of event in ring: time, kind, name, arg
+    constexpr size_t kEventWords = 4;
+    /// Rings of exited threads kept for dumps
+    constexpr size_t kMaxExitedRings = 8;
+    constexpr auto kAutoDumpPeriod = std::chrono::minutes{1};
+
+    /**
+     * Events of one thread, written only by it.
+     * Reader copies events, then drops ones which writer might have
+     * overwritten meanwhile, as seqlock does.
+     * One spare slot is written next, so `capacity` events stay readable.
+     */
+    struct Ring {
+      explicit Ring(size_t capacity)
+          : capacity{capacity},
+            slots{capacity + 1},
+            words{std::make_unique<uint64_t[]>(slots * kEventWords)} {}
+
+      size_t capacity;
+      size_t slots;
+      std::unique_ptr<uint64_t[]> words;
+      /// Events written by thread
+      std::atomic_uint64_t head = 0;
+      uint64_t thread_id = 0;
+      std::string thread_name;
+      std::atomic_bool exited = false;
+    };
+
+    struct Recorder {
+      std::mutex mutex;
+      /// Incremented on start and stop, threads register again
+      std::atomic_uint64_t generation = 1;
+      size_t capacity = 0;
+      std::filesystem::path dump_directory;
+      std::vector<std::shared_ptr<Ring>> rings;
+      std::optional<Clock::time_point> last_auto_dump;
+    };
+
+    Recorder &recorder() {
+      static Recorder recorder;
+      return recorder;
+    }
+
+    struct ThreadRing {
+      std::shared_ptr<Ring> ring;
+      uint64_t generation = 0;
+
+      ~ThreadRing() {
+        if (ring) {
+          ring->exited = true;
+        }
+      }
+    };
+
+    thread_local ThreadRing thread_ring;
+
+    uint64_t threadId() {
+      static std::atomic_uint64_t next_id = 1;
+      thread_local auto id = next_id.fetch_add(1);
+      return id;
+    }
+
+    void registerThread(ThreadRing &local) {
+      auto &rec = recorder();
+      std::lock_guard lock{rec.mutex};
+      local.generation = rec.generation.load();
+      local.ring.reset();
+      if (rec.capacity == 0) {
+        return;
+      }
+      std::erase_if(rec.rings, [&, exited = size_t{0}](auto &ring) mutable {
+        return ring->exited.load() and ++exited > kMaxExitedRings;
+      });
+      local.ring = std::make_shared<Ring>(rec.capacity);
+      local.ring->thread_id = threadId();
+      local.ring->thread_name = soralog::util::getThreadName();
+      rec.rings.emplace_back(local.ring);
+    }
+
+    uint64_t load(uint64_t &word) {
+      return std::atomic_ref{word}.load(std::memory_order_relaxed);
+    }
+
+    void store(uint64_t &word, uint64_t value) {
+      std::atomic_ref{word}.store(value, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    void append(std::string &out, T value) {
+      out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    void appendString(std::string &out, std::string_view value) {
+      append(out, static_cast<uint32_t>(value.size()));
+      out.append(value);
+    }
+
+    std::chrono::nanoseconds sinceEpoch(auto time) {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+          time.time_since_epoch());
+    }
+  }  // namespace
+
+  void startFlightRecorder(size_t events_per_thread,
+                           std::filesystem::path dump_directory) {
+    auto &rec = recorder();
+    std::lock_guard lock{rec.mutex};
+    flight_recorder_enabled = false;
+    rec.capacity = events_per_thread;
+    rec.dump_directory = std::move(dump_directory);
+    rec.rings.clear();
+    rec.generation.fetch_add(1);
+    flight_recorder_enabled = events_per_thread != 0;
+  }
+
+  void recordFlightEventImpl(FlightEventKind kind,
+                             const char *name,
+                             uint64_t arg) {
+    auto &local = thread_ring;
+    if (local.generation != recorder().generation.load(
+            std::memory_order_relaxed)) [[unlikely]] {
+      registerThread(local);
+    }
+    if (not local.ring) {
+      return;
+    }
+    auto &ring = *local.ring;
+    auto head = ring.head.load(std::memory_order_relaxed);
+    auto *event = &ring.words[(head % ring.slots) * kEventWords];
+    store(event[0], sinceEpoch(Clock::now()).count());
+    store(event[1], static_cast<uint64_t>(kind));
+    store(event[2], reinterpret_cast<uintptr_t>(name));
+    store(event[3], arg);
+    ring.head.store(head + 1, std::memory_order_release);
+  }
+
+  outcome::result<std::string> dumpFlightRecorder() {
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+      auto &rec = recorder();
+      std::lock_guard lock{rec.mutex};
+      if (rec.capacity == 0) {
+        return FlightRecorderError::DISABLED;
+      }
+      rings = rec.rings;
+    }
+
+    struct Copy {
+      std::shared_ptr<Ring> ring;
+      std::vector<uint64_t> words;
+      uint64_t first = 0;
+      uint64_t end = 0;
+    };
+    std::vector<Copy> copies;
+    // Names are string literals, their addresses are stable
+    std::unordered_map<uint64_t, uint32_t> name_indices;
+    std::vector<const char *> names;
+    for (auto &ring : rings) {
+      auto &copy = copies.emplace_back(Copy{.ring = ring});
+      auto head = ring->head.load(std::memory_order_acquire);
+      auto count = std::min<uint64_t>(head, ring->capacity);
+      copy.words.resize(count * kEventWords);
+      for (uint64_t seq = head - count; seq < head; ++seq) {
+        auto *event = &ring->words[(seq % ring->slots) * kEventWords];
+        auto *out = &copy.words[(seq - head + count) * kEventWords];
+        for (size_t i = 0; i < kEventWords; ++i) {
+          out[i] = load(event[i]);
+        }
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      // Event being written now may overwrite slot of `written - slots`
+      auto written = ring->head.load(std::memory_order_relaxed);
+      auto valid_from =
+          written >= ring->capacity ? written - ring->capacity : 0;
+      copy.first = std::max(head - count, valid_from);
+      copy.end = head;
+      for (auto seq = copy.first; seq < copy.end; ++seq) {
+        auto name = copy.words[(seq - head + count) * kEventWords + 2];
+        if (name_indices.emplace(name, names.size()).second) {
+          // NOLINTNEXTLINE(performance-no-int-to-ptr)
+          names.emplace_back(reinterpret_cast<const char *>(name));
+        }
+      }
+      // Keep words from first valid event
+      copy.words.erase(
+          copy.words.begin(),
+          copy.words.begin()
+              + static_cast<ptrdiff_t>((copy.first - head + count)
+                                       * kEventWords));
+    }
+
+    std::string out;
+    out.append(kMagic);
+    append(out, kVersion);
+    append(out, static_cast<uint64_t>(sinceEpoch(Clock::now()).count()));
+    append(out,
+           static_cast<uint64_t>(
+               sinceEpoch(std::chrono::system_clock::now()).count()));
+    append(out, static_cast<uint32_t>(names.size()));
+    for (auto *name : names) {
+      appendString(out, name);
+    }
+    append(out, static_cast<uint32_t>(copies.size()));
+    for (auto &copy : copies) {
+      append(out, copy.ring->thread_id);
+      appendString(out, copy.ring->thread_name);
+      append(out, static_cast<uint32_t>(copy.end - copy.first));
+      for (size_t i = 0; i < copy.words.size(); i += kEventWords) {
+        append(out, copy.words[i]);
+        append(out, copy.words[i + 3]);
+        append(out, name_indices.at(copy.words[i + 2]));
+        append(out, static_cast<uint8_t>(copy.words[i + 1]));
+      }
+    }
+    return out;
+  }
+
+  std::optional<std::filesystem::path> dumpFlightRecorderToFile(
+      std::string_view reason) {
+    std::filesystem::path directory;
+    {
+      auto &rec = recorder();
+      std::lock_guard lock{rec.mutex};
+      auto now = Clock::now();
+      if (rec.capacity == 0
+          or (rec.last_auto_dump.has_value()
+              and now - *rec.last_auto_dump < kAutoDumpPeriod)) {
+        return std::nullopt;
+      }
+      rec.last_auto_dump = now;
+      directory = rec.dump_directory;
+    }
+    auto dump = dumpFlightRecorder();
+    if (dump.has_error()) {
+      return std::nullopt;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::system_clock::now().time_since_epoch())
+                      .count();
+    auto path = directory / fmt::format("flight-{}-{}.bin", millis, reason);
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    file.write(dump.value().data(),
+               static_cast<std::streamsize>(dump.value().size()));
+    if (not file) {
+      return std::nullopt;
+    }
+    return path;
+  }
+
+  outcome::result<FlightRecording> decodeFlightRecording(
+      std::string_view dump) {
+    auto take = [&](size_t size) -> outcome::result<std::string_view> {
+      if (dump.size() < size) {
+        return FlightRecorderError::BAD_FILE;
+      }
+      auto part = dump.substr(0, size);
+      dump.remove_prefix(size);
+      return part;
+    };
+    auto read = [&]<typename T>(T &value) -> outcome::result<void> {
+      OUTCOME_TRY(part, take(sizeof(T)));
+      std::memcpy(&value, part.data(), sizeof(T));
+      return outcome::success();
+    };
+    auto readString = [&](std::string &value) -> outcome::result<void> {
+      uint32_t size = 0;
+      OUTCOME_TRY(read(size));
+      OUTCOME_TRY(part, take(size));
+      value = part;
+      return outcome::success();
+    };
+
+    OUTCOME_TRY(magic, take(kMagic.size()));
+    uint32_t version = 0;
+    OUTCOME_TRY(read(version));
+    if (magic != kMagic or version != kVersion) {
+      return FlightRecorderError::BAD_FILE;
+    }
+    FlightRecording recording;
+    uint64_t steady_time = 0;
+    uint64_t system_time = 0;
+    OUTCOME_TRY(read(steady_time));
+    OUTCOME_TRY(read(system_time));
+    recording.steady_time = std::chrono::nanoseconds{steady_time};
+    recording.system_time = std::chrono::nanoseconds{system_time};
+    uint32_t name_count = 0;
+    OUTCOME_TRY(read(name_count));
+    std::vector<std::string> names(name_count);
+    for (auto &name : names) {
+      OUTCOME_TRY(readString(name));
+    }
+    uint32_t thread_count = 0;
+    OUTCOME_TRY(read(thread_count));
+    for (uint32_t i = 0; i < thread_count; ++i) {
+      auto &thread = recording.threads.emplace_back();
+      OUTCOME_TRY(read(thread.id));
+      OUTCOME_TRY(readString(thread.name));
+      uint32_t event_count = 0;
+      OUTCOME_TRY(read(event_count));
+      for (uint32_t j = 0; j < event_count; ++j) {
+        uint64_t time = 0;
+        uint64_t arg = 0;
+        uint32_t name = 0;
+        uint8_t kind = 0;
+        OUTCOME_TRY(read(time));
+        OUTCOME_TRY(read(arg));
+        OUTCOME_TRY(read(name));
+        OUTCOME_TRY(read(kind));
+        if (name >= names.size()
+            or kind > static_cast<uint8_t>(FlightEventKind::END)) {
+          return FlightRecorderError::BAD_FILE;
+        }
+        thread.events.emplace_back(FlightRecording::Event{
+            .time = std::chrono::nanoseconds{time},
+            .kind = static_cast<FlightEventKind>(kind),
+            .name = names[name],
+            .arg = arg,
+        });
+      }
+    }
+    return recording;
+  }
+}  // namespace lean::log
@@ -0,0 +1,133 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <qtils/enum_error_code.hpp>
+#include <qtils/outcome.hpp>
+
+namespace lean::log {
+  enum class FlightRecorderError : uint8_t {
+    DISABLED = 1,
+    BAD_FILE,
+  };
+  Q_ENUM_ERROR_CODE(FlightRecorderError) {
+    using E = decltype(e);
+    switch (e) {
+      case E::DISABLED:
+        return "Flight recorder is disabled";
+      case E::BAD_FILE:
+        return "Not a flight recording or unsupported version";
+    }
+    abort();
+  }
+
+  enum class FlightEventKind : uint8_t {
+    INSTANT,
+    BEGIN,
+    END,
+  };
+
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+  extern std::atomic_bool flight_recorder_enabled;
+
+  inline bool flightRecorderEnabled() {
+    return flight_recorder_enabled.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Start keeping last `events_per_thread` events of each thread, 0 stops.
+   * Automatic dumps are written into `dump_directory`.
+   */
+  void startFlightRecorder(size_t events_per_thread,
+                           std::filesystem::path dump_directory);
+
+  /**
+   * Append event to ring buffer of current thread, overwriting oldest one.
+   * Buffer is allocated on first event of thread, then recording takes no
+   * lock and no allocation, so it stays on hot paths.
+   * `name` must be string literal, only its address is recorded.
+   */
+  void recordFlightEventImpl(FlightEventKind kind,
+                             const char *name,
+                             uint64_t arg);
+
+  inline void recordFlightEvent(FlightEventKind kind,
+                                const char *name,
+                                uint64_t arg = 0) {
+    if (flightRecorderEnabled()) [[unlikely]] {
+      recordFlightEventImpl(kind, name, arg);
+    }
+  }
+
+  /// Binary recording of events currently in ring buffers of all threads
+  outcome::result<std::string> dumpFlightRecorder();
+
+  /**
+   * Write dump into dump directory, e.g. on missed interval deadline.
+   * At most one dump per minute is written, so repeated misses don't slow
+   * node further.
+   * @return path of file, nullopt if disabled, rate limited or failed
+   */
+  std::optional<std::filesystem::path> dumpFlightRecorderToFile(
+      std::string_view reason);
+
+  /// Dump decoded by `decodeFlightRecording`
+  struct FlightRecording {
+    struct Event {
+      /// Steady clock
+      std::chrono::nanoseconds time;
+      FlightEventKind kind;
+      std::string name;
+      uint64_t arg;
+    };
+    struct Thread {
+      uint64_t id;
+      std::string name;
+      std::vector<Event> events;
+    };
+    /// Steady and system clock at dump, to show events in wall time
+    std::chrono::nanoseconds steady_time;
+    std::chrono::nanoseconds system_time;
+    std::vector<Thread> threads;
+  };
+
+  outcome::result<FlightRecording> decodeFlightRecording(
+      std::string_view dump);
+
+  /// Scope recorded as begin and end events, `name` is string literal
+  class FlightSpan {
+   public:
+    explicit FlightSpan(const char *name, uint64_t arg = 0)
+        : name_{flightRecorderEnabled() ? name : nullptr}, arg_{arg} {
+      if (name_ != nullptr) [[unlikely]] {
+        recordFlightEventImpl(FlightEventKind::BEGIN, name_, arg_);
+      }
+    }
+
+    FlightSpan(const FlightSpan &) = delete;
+    FlightSpan &operator=(const FlightSpan &) = delete;
+
+    ~FlightSpan() {
+      if (name_ != nullptr) [[unlikely]] {
+        recordFlightEventImpl(FlightEventKind::END, name_, arg_);
+      }
+    }
+
+   private:
+    const char *name_;
+    uint64_t arg_;
+  };
+}  // namespace lean::log
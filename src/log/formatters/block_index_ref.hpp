@@ -6,10 +6,13 @@
 
 #pragma once
 
+#include <array>
+#include <string_view>
 #include <type_traits>
 
 #include "types/block_hash.hpp"
 #include "types/slot.hpp"
+#include "utils/hex.hpp"
 
 namespace lean {
 
@@ -205,7 +208,10 @@ struct fmt::formatter<lean::BlockIndexRef> {
 
     auto write_content = [&] {
       if (long_form) {
-        out = fmt::format_to(out, "{:0xx} @ {}", v.hash, v.slot);
+        std::array<char, 2 * sizeof(lean::BlockHash)> hex;
+        lean::hexEncode(v.hash, hex.data());
+        out = fmt::format_to(
+            out, "0x{} @ {}", std::string_view{hex.data(), hex.size()}, v.slot);
       } else {
         out = fmt::format_to(out, "{:0x} @ {}", v.hash, v.slot);
       }
@@ -0,0 +1,59 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+namespace lean::log {
+  /**
+   * Limits messages of one call site to `burst` per `window`.
+   * Lock-free, shared by all threads of call site.
+   */
+  class LogRateLimiter {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t kDefaultBurst = 10;
+    static constexpr Clock::duration kDefaultWindow = std::chrono::seconds{1};
+
+    LogRateLimiter(size_t burst = kDefaultBurst,
+                   Clock::duration window = kDefaultWindow)
+        : burst_{burst}, window_{window.count()} {}
+
+    /**
+     * Returns number of messages suppressed since last passed one,
+     * or nullopt if message must be suppressed.
+     */
+    std::optional<size_t> acquire(Clock::time_point now = Clock::now()) {
+      auto now_ticks = now.time_since_epoch().count();
+      auto start = window_start_.load(std::memory_order_relaxed);
+      if ((start == kNever or now_ticks - start >= window_)
+          and window_start_.compare_exchange_strong(
+              start, now_ticks, std::memory_order_relaxed)) {
+        passed_.store(0, std::memory_order_relaxed);
+      }
+      if (passed_.fetch_add(1, std::memory_order_relaxed) < burst_) {
+        return suppressed_.exchange(0, std::memory_order_relaxed);
+      }
+      suppressed_.fetch_add(1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+
+   private:
+    static constexpr int64_t kNever = std::numeric_limits<int64_t>::min();
+
+    size_t burst_;
+    int64_t window_;
+    std::atomic<int64_t> window_start_{kNever};
+    std::atomic_size_t passed_{0};
+    std::atomic_size_t suppressed_{0};
+  };
+}  // namespace lean::log
@@ -17,6 +17,8 @@
 #include <soralog/macro.hpp>
 
 #include "injector/dont_inject.hpp"
+#include "log/log_max_level.hpp"
+#include "log/log_rate_limiter.hpp"
 #include "utils/ctor_limiters.hpp"
 
 namespace lean::log {
@@ -24,6 +26,10 @@ namespace lean::log {
 
   using Logger = qtils::SharedRef<soralog::Logger>;
 
+  /// Logs more verbose than this are removed by compiler, see
+  /// `QLEAN_LOG_MAX_LEVEL` build option
+  constexpr Level kMaxLevel = QLEAN_LOG_MAX_LEVEL;
+
   enum class Error : uint8_t { WRONG_LEVEL = 1, WRONG_GROUP, WRONG_LOGGER };
 
   outcome::result<Level> str2lvl(std::string_view str);
@@ -91,3 +97,80 @@ namespace lean::log {
 }  // namespace lean::log
 
 OUTCOME_HPP_DECLARE_ERROR(lean::log, Error);
+
+/**
+ * Logs with level known at compile time, instead of soralog macros.
+ * Calls more verbose than `kMaxLevel` are discarded by compiler, but still
+ * type checked. Level of logger is checked before format arguments are
+ * evaluated, so arguments of disabled levels cost nothing.
+ */
+#define SL_LOG_AT(LOGGER, LEVEL, FMT, ...)                \
+  do {                                                    \
+    if constexpr ((LEVEL) <= ::lean::log::kMaxLevel) {    \
+      auto &&level_logger_ = (LOGGER);                    \
+      if (level_logger_->level() >= (LEVEL)) {            \
+        level_logger_->log((LEVEL), FMT, ##__VA_ARGS__);  \
+      }                                                   \
+    }                                                     \
+  } while (false)
+
+#undef SL_TRACE
+#undef SL_DEBUG
+#undef SL_VERBOSE
+#undef SL_INFO
+#undef SL_WARN
+#undef SL_ERROR
+#undef SL_CRITICAL
+
+#define SL_TRACE(LOGGER, FMT, ...) \
+  SL_LOG_AT((LOGGER), ::soralog::Level::TRACE, FMT, ##__VA_ARGS__)
+#define SL_DEBUG(LOGGER, FMT, ...) \
+  SL_LOG_AT((LOGGER), ::soralog::Level::DEBUG, FMT, ##__VA_ARGS__)
+#define SL_VERBOSE(LOGGER, FMT, ...) \
+  SL_LOG_AT((LOGGER), ::soralog::Level::VERBOSE, FMT, ##__VA_ARGS__)
+#define SL_INFO(LOGGER, FMT, ...) \
+  SL_LOG_AT((LOGGER), ::soralog::Level::INFO, FMT, ##__VA_ARGS__)
+#define SL_WARN(LOGGER, FMT, ...) \
+  SL_LOG_AT((LOGGER), ::soralog::Level::WARN, FMT, ##__VA_ARGS__)
+#define SL_ERROR(LOGGER, FMT, ...) \
+  SL_LOG_AT((LOGGER), ::soralog::Level::ERROR, FMT, ##__VA_ARGS__)
+#define SL_CRITICAL(LOGGER, FMT, ...) \
+  SL_LOG_AT((LOGGER), ::soralog::Level::CRITICAL, FMT, ##__VA_ARGS__)
+
+/**
+ * Logs like `SL_*` macros, but at most `LogRateLimiter::kDefaultBurst`
+ * messages per second of each call site, e.g. per gossip message logs.
+ * Number of suppressed messages is appended to next passed message.
+ * Format arguments are not evaluated for suppressed messages, and calls
+ * more verbose than `kMaxLevel` are discarded like `SL_LOG_AT`.
+ */
+#define SL_LOG_LIMITED(LOGGER, LEVEL, FMT, ...)                  \
+  do {                                                           \
+    if constexpr ((LEVEL) <= ::lean::log::kMaxLevel) {           \
+      auto &&limited_logger_ = (LOGGER);                         \
+      if (limited_logger_->level() >= (LEVEL)) {                 \
+        static ::lean::log::LogRateLimiter limiter_;             \
+        if (auto suppressed_ = limiter_.acquire()) {             \
+          if (*suppressed_ == 0) {                               \
+            limited_logger_->log((LEVEL), FMT, ##__VA_ARGS__);   \
+          } else {                                               \
+            limited_logger_->log((LEVEL),                        \
+                                 FMT " (+{} suppressed)",        \
+                                 ##__VA_ARGS__,                  \
+                                 *suppressed_);                  \
+          }                                                      \
+        }                                                        \
+      }                                                          \
+    }                                                            \
+  } while (false)
+
+#define SL_TRACE_LIMITED(LOGGER, FMT, ...) \
+  SL_LOG_LIMITED((LOGGER), ::soralog::Level::TRACE, FMT, ##__VA_ARGS__)
+#define SL_DEBUG_LIMITED(LOGGER, FMT, ...) \
+  SL_LOG_LIMITED((LOGGER), ::soralog::Level::DEBUG, FMT, ##__VA_ARGS__)
+#define SL_VERBOSE_LIMITED(LOGGER, FMT, ...) \
+  SL_LOG_LIMITED((LOGGER), ::soralog::Level::VERBOSE, FMT, ##__VA_ARGS__)
+#define SL_INFO_LIMITED(LOGGER, FMT, ...) \
+  SL_LOG_LIMITED((LOGGER), ::soralog::Level::INFO, FMT, ##__VA_ARGS__)
+#define SL_WARN_LIMITED(LOGGER, FMT, ...) \
+  SL_LOG_LIMITED((LOGGER), ::soralog::Level::WARN, FMT, ##__VA_ARGS__)
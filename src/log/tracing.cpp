@@ -0,0 +1,117 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "log/tracing.hpp"
+
+#include <fstream>
+#include <mutex>
+#include <utility>
+
+#include <fmt/format.h>
+#include <soralog/util.hpp>
+#include <unistd.h>
+
+namespace lean::log {
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+  std::atomic_bool tracing_enabled = false;
+
+  namespace {
+    struct TraceFile {
+      std::mutex mutex;
+      std::ofstream file;
+      /// Incremented on each start, to name threads again in new trace
+      uint64_t session = 0;
+      /// No events written yet, so next one is not preceded by comma
+      bool empty = true;
+      std::string line;
+
+      std::string_view separator() {
+        return std::exchange(empty, false) ? "" : ",";
+      }
+    };
+
+    TraceFile &traceFile() {
+      static TraceFile trace_file;
+      return trace_file;
+    }
+
+    uint64_t threadId() {
+      static std::atomic_uint64_t next_id = 1;
+      thread_local auto id = next_id.fetch_add(1);
+      return id;
+    }
+
+    double micros(TraceSpan::Clock::time_point time) {
+      return std::chrono::duration<double, std::micro>(time.time_since_epoch())
+          .count();
+    }
+  }  // namespace
+
+  outcome::result<void> startTracing(const std::filesystem::path &path) {
+    auto &trace = traceFile();
+    std::lock_guard lock{trace.mutex};
+    if (trace.file.is_open()) {
+      tracing_enabled = false;
+      trace.file << "\n]\n";
+      trace.file.close();
+    }
+    trace.file.open(path, std::ios::trunc);
+    if (not trace.file) {
+      return TracingError::CANT_OPEN;
+    }
+    trace.file << "[";
+    trace.empty = true;
+    ++trace.session;
+    tracing_enabled = true;
+    return outcome::success();
+  }
+
+  void stopTracing() {
+    auto &trace = traceFile();
+    std::lock_guard lock{trace.mutex};
+    tracing_enabled = false;
+    if (trace.file.is_open()) {
+      trace.file << "\n]\n";
+      trace.file.close();
+    }
+  }
+
+  void TraceSpan::write() const {
+    auto end = Clock::now();
+    auto tid = threadId();
+    thread_local uint64_t named_in_session = 0;
+    auto &trace = traceFile();
+    std::lock_guard lock{trace.mutex};
+    // Tracing may be stopped while span was open
+    if (not trace.file.is_open()) {
+      return;
+    }
+    auto &line = trace.line;
+    line.clear();
+    auto pid = getpid();
+    if (named_in_session != trace.session) {
+      named_in_session = trace.session;
+      fmt::format_to(std::back_inserter(line),
+                     "{}\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":{},"
+                     "\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+                     trace.separator(),
+                     pid,
+                     tid,
+                     soralog::util::getThreadName());
+    }
+    fmt::format_to(std::back_inserter(line),
+                   "{}\n{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\","
+                   "\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":{},\"tid\":{}}}",
+                   trace.separator(),
+                   name_,
+                   category_,
+                   micros(start_),
+                   micros(end) - micros(start_),
+                   pid,
+                   tid);
+    trace.file << line;
+  }
+}  // namespace lean::log
@@ -0,0 +1,97 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <string_view>
+
+#include <qtils/enum_error_code.hpp>
+#include <qtils/outcome.hpp>
+
+#include "log/flight_recorder.hpp"
+
+namespace lean::log {
+  enum class TracingError : uint8_t {
+    CANT_OPEN = 1,
+  };
+  Q_ENUM_ERROR_CODE(TracingError) {
+    using E = decltype(e);
+    switch (e) {
+      case E::CANT_OPEN:
+        return "Can't open trace file";
+    }
+    abort();
+  }
+
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+  extern std::atomic_bool tracing_enabled;
+
+  /**
+   * Start writing spans into `path` as Chrome trace event JSON, loadable
+   * by Perfetto UI and chrome://tracing and convertible to OpenTelemetry.
+   * Previous trace in `path` is replaced.
+   */
+  outcome::result<void> startTracing(const std::filesystem::path &path);
+
+  /// Stop tracing and complete trace file
+  void stopTracing();
+
+  inline bool tracingEnabled() {
+    return tracing_enabled.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Writes complete event of scope into trace, if tracing is enabled when
+   * span starts.
+   * Disabled span costs one relaxed atomic load, so spans may stay on hot
+   * paths in release builds, unlike `LEAN_PROFILE_START`.
+   * `name` and `category` must be string literals, they are not escaped.
+   */
+  class TraceSpan {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    TraceSpan(std::string_view category, std::string_view name)
+        : enabled_{tracingEnabled()} {
+      if (enabled_) [[unlikely]] {
+        category_ = category;
+        name_ = name;
+        start_ = Clock::now();
+      }
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+    ~TraceSpan() {
+      if (enabled_) [[unlikely]] {
+        write();
+      }
+    }
+
+   private:
+    void write() const;
+
+    bool enabled_;
+    std::string_view category_;
+    std::string_view name_;
+    Clock::time_point start_;
+  };
+}  // namespace lean::log
+
+#define LEAN_TRACE_CONCAT_IMPL(a, b) a##b
+#define LEAN_TRACE_CONCAT(a, b) LEAN_TRACE_CONCAT_IMPL(a, b)
+
+/// Trace rest of scope as span `name` of `category`, also in flight recorder
+#define LEAN_TRACE_SPAN(category, name)                                   \
+  ::lean::log::TraceSpan LEAN_TRACE_CONCAT(_trace_span_, __LINE__){       \
+      (category), (name)};                                                \
+  ::lean::log::FlightSpan LEAN_TRACE_CONCAT(_flight_span_, __LINE__) {    \
+    (name)                                                                \
+  }
@@ -0,0 +1,109 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "metrics/histogram_buckets.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <functional>
+
+namespace lean::metrics {
+  namespace {
+    /// Guards against typos like "exp:1:2:1e9"
+    constexpr size_t kMaxBuckets = 256;
+
+    template <typename T>
+    std::optional<T> parseNumber(std::string_view text) {
+      T value{};
+      auto end = text.data() + text.size();
+      auto [ptr, ec] = std::from_chars(text.data(), end, value);
+      if (text.empty() or ec != std::errc{} or ptr != end) {
+        return std::nullopt;
+      }
+      return value;
+    }
+
+    /// Split by `separator`, keeping empty parts
+    std::vector<std::string_view> split(std::string_view text,
+                                        char separator) {
+      std::vector<std::string_view> parts;
+      while (true) {
+        auto pos = text.find(separator);
+        parts.emplace_back(text.substr(0, pos));
+        if (pos == std::string_view::npos) {
+          return parts;
+        }
+        text.remove_prefix(pos + 1);
+      }
+    }
+  }  // namespace
+
+  std::vector<double> exponentialBuckets(double start,
+                                         double factor,
+                                         size_t count) {
+    std::vector<double> buckets;
+    buckets.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      buckets.emplace_back(start * std::pow(factor, static_cast<double>(i)));
+    }
+    return buckets;
+  }
+
+  std::vector<double> linearBuckets(double start, double width, size_t count) {
+    std::vector<double> buckets;
+    buckets.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      buckets.emplace_back(start + width * static_cast<double>(i));
+    }
+    return buckets;
+  }
+
+  std::optional<std::vector<double>> parseHistogramBuckets(
+      std::string_view spec) {
+    std::vector<double> buckets;
+    auto parts = split(spec, ':');
+    if (parts.size() == 4 and (parts[0] == "exp" or parts[0] == "lin")) {
+      auto start = parseNumber<double>(parts[1]);
+      auto step = parseNumber<double>(parts[2]);
+      auto count = parseNumber<size_t>(parts[3]);
+      if (not start or not step or not count or *count == 0
+          or *count > kMaxBuckets) {
+        return std::nullopt;
+      }
+      if (parts[0] == "exp") {
+        if (*start <= 0 or *step <= 1) {
+          return std::nullopt;
+        }
+        buckets = exponentialBuckets(*start, *step, *count);
+      } else {
+        if (*step <= 0) {
+          return std::nullopt;
+        }
+        buckets = linearBuckets(*start, *step, *count);
+      }
+    } else if (parts.size() == 1) {
+      for (auto part : split(spec, ',')) {
+        auto boundary = parseNumber<double>(part);
+        if (not boundary) {
+          return std::nullopt;
+        }
+        buckets.emplace_back(*boundary);
+      }
+    } else {
+      return std::nullopt;
+    }
+    if (buckets.size() > kMaxBuckets
+        or std::ranges::adjacent_find(buckets, std::greater_equal{})
+               != buckets.end()
+        or not std::ranges::all_of(
+            buckets, [](double boundary) { return std::isfinite(boundary); })) {
+      return std::nullopt;
+    }
+    return buckets;
+  }
+
+}  // namespace lean::metrics
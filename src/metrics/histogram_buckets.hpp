@@ -0,0 +1,35 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace lean::metrics {
+
+  /// `count` boundaries from `start`, each next is `factor` times greater
+  std::vector<double> exponentialBuckets(double start,
+                                         double factor,
+                                         size_t count);
+
+  /// `count` boundaries from `start`, each next is `width` greater
+  std::vector<double> linearBuckets(double start, double width, size_t count);
+
+  /**
+   * Parse histogram bucket boundaries overriding ones of `.def` file:
+   * - "0.001,0.0025,0.005": boundaries, ascending;
+   * - "exp:<start>:<factor>:<count>": `exponentialBuckets`, so range of
+   *   latencies is covered with same relative resolution;
+   * - "lin:<start>:<width>:<count>": `linearBuckets`.
+   * @return nullopt if malformed or not ascending
+   */
+  std::optional<std::vector<double>> parseHistogramBuckets(
+      std::string_view spec);
+
+}  // namespace lean::metrics
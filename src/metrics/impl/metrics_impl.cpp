@@ -6,30 +6,98 @@
 
 #include "metrics/impl/metrics_impl.hpp"
 
+#include "app/configuration.hpp"
 #include "metrics/registry.hpp"
 
 namespace lean::metrics {
+  namespace {
+    /// Metric of `metrics.drop`
+    class NoopGauge final : public Gauge {
+     public:
+      double value() const override {
+        return 0;
+      }
+      void inc() override {}
+      void inc(double) override {}
+      void dec() override {}
+      void dec(double) override {}
+      void set(double) override {}
+    };
+
+    class NoopCounter final : public Counter {
+     public:
+      double value() const override {
+        return 0;
+      }
+      void inc() override {}
+      void inc(double) override {}
+    };
+
+    class NoopHistogram final : public Histogram {
+     public:
+      void observe(double) override {}
+    };
+
+    NoopGauge noop_gauge;
+    NoopCounter noop_counter;
+    NoopHistogram noop_histogram;
+  }  // namespace
 
 #define UNWRAP(...) __VA_ARGS__
 
-  MetricsImpl::MetricsImpl(std::shared_ptr<Registry> registry)
-      : registry_{std::move(registry)} {
-#define METRIC_GAUGE(field, name, help)       \
-  registry_->registerGaugeFamily(name, help); \
-  metric_##field##_ = registry_->registerGaugeMetric(name);
+  MetricsImpl::MetricsImpl(
+      std::shared_ptr<Registry> registry,
+      qtils::SharedRef<const app::Configuration> app_config)
+      : registry_{std::move(registry)},
+        histogram_buckets_{app_config->metrics().buckets},
+        dropped_{app_config->metrics().drop} {
+#define METRIC_GAUGE(field, name, help)                       \
+  metric_##field##_ = &noop_gauge;                            \
+  if (not dropped(name)) {                                    \
+    registry_->registerGaugeFamily(name, help);               \
+    metric_##field##_ = registry_->registerGaugeMetric(name); \
+  }
 #define METRIC_GAUGE_LABELS(field, name, help, label_names) \
-  registry_->registerGaugeFamily(name, help);
-#define METRIC_COUNTER(field, name, help)       \
-  registry_->registerCounterFamily(name, help); \
-  metric_##field##_ = registry_->registerCounterMetric(name);
+  drop_##field##_ = dropped(name);                          \
+  if (not drop_##field##_) {                                \
+    registry_->registerGaugeFamily(name, help);             \
+  }
+#define METRIC_COUNTER(field, name, help)                       \
+  metric_##field##_ = &noop_counter;                            \
+  if (not dropped(name)) {                                      \
+    registry_->registerCounterFamily(name, help);               \
+    metric_##field##_ = registry_->registerCounterMetric(name); \
+  }
 #define METRIC_COUNTER_LABELS(field, name, help, label_names) \
-  registry_->registerCounterFamily(name, help);
-#define METRIC_HISTOGRAM(field, name, help, buckets) \
-  registry_->registerHistogramFamily(name, help);    \
-  metric_##field##_ =                                \
-      registry_->registerHistogramMetric(name, {UNWRAP buckets});
+  drop_##field##_ = dropped(name);                            \
+  if (not drop_##field##_) {                                  \
+    registry_->registerCounterFamily(name, help);             \
+  }
+#define METRIC_HISTOGRAM(field, name, help, buckets)        \
+  metric_##field##_ = &noop_histogram;                      \
+  if (not dropped(name)) {                                  \
+    registry_->registerHistogramFamily(name, help);         \
+    metric_##field##_ = registry_->registerHistogramMetric( \
+        name, bucketBoundaries(name, {UNWRAP buckets}));    \
+  }
 #define METRIC_HISTOGRAM_LABELS(field, name, help, buckets, label_names) \
-  registry_->registerHistogramFamily(name, help);
+  drop_##field##_ = dropped(name);                                       \
+  buckets_##field##_ = bucketBoundaries(name, {UNWRAP buckets});         \
+  if (not drop_##field##_) {                                             \
+    registry_->registerHistogramFamily(name, help);                      \
+  }
+#define METRIC_COUNTER_SHARDED(field, name, help)               \
+  if (not dropped(name)) {                                      \
+    registry_->registerShardedCounter(name, help, *field());    \
+  }
+#define METRIC_HISTOGRAM_SHARDED(field, name, help, buckets)      \
+  if (auto it = histogram_buckets_.find(name);                    \
+      it != histogram_buckets_.end()) {                           \
+    field()->setBucketBoundaries(it->second);                     \
+  }                                                               \
+  if (not dropped(name)) {                                        \
+    registry_->registerShardedHistogram(name, help, *field());    \
+  }
 
 #include "metrics/all_metrics.def"
 
@@ -39,6 +107,21 @@ namespace lean::metrics {
 #undef METRIC_COUNTER_LABELS
 #undef METRIC_HISTOGRAM
 #undef METRIC_HISTOGRAM_LABELS
+#undef METRIC_COUNTER_SHARDED
+#undef METRIC_HISTOGRAM_SHARDED
+  }
+
+  std::vector<double> MetricsImpl::bucketBoundaries(
+      const std::string &name, std::vector<double> defined) const {
+    if (auto it = histogram_buckets_.find(name);
+        it != histogram_buckets_.end()) {
+      return it->second;
+    }
+    return defined;
+  }
+
+  bool MetricsImpl::dropped(const std::string &name) const {
+    return dropped_.contains(name);
   }
 
 #define METRIC_GAUGE(field, name, help) \
@@ -47,6 +130,9 @@ namespace lean::metrics {
   }
 #define METRIC_GAUGE_LABELS(field, name, help, label_names) \
   Gauge *MetricsImpl::field(const Labels &labels) {         \
+    if (drop_##field##_) {                                  \
+      return &noop_gauge;                                   \
+    }                                                       \
     return registry_->registerGaugeMetric(name, labels);    \
   }
 #define METRIC_COUNTER(field, name, help) \
@@ -55,18 +141,25 @@ namespace lean::metrics {
   }
 #define METRIC_COUNTER_LABELS(field, name, help, label_names) \
   Counter *MetricsImpl::field(const Labels &labels)  {         \
+    if (drop_##field##_) {                                    \
+      return &noop_counter;                                   \
+    }                                                         \
     return registry_->registerCounterMetric(name, labels);    \
   }
 #define METRIC_HISTOGRAM(field, name, help, buckets) \
   Histogram *MetricsImpl::field()  const{                  \
     return metric_##field##_;                        \
   }
-#define METRIC_HISTOGRAM_LABELS(field, name, help, buckets, label_names)   \
-  Histogram *MetricsImpl::field(const Labels &labels) {                    \
-    static const std::vector<double> bucket_boundaries = {UNWRAP buckets}; \
-    return registry_->registerHistogramMetric(                             \
-        name, bucket_boundaries, labels);                                  \
+#define METRIC_HISTOGRAM_LABELS(field, name, help, buckets, label_names) \
+  Histogram *MetricsImpl::field(const Labels &labels) {                  \
+    if (drop_##field##_) {                                               \
+      return &noop_histogram;                                            \
+    }                                                                    \
+    return registry_->registerHistogramMetric(                           \
+        name, buckets_##field##_, labels);                               \
   }
+#define METRIC_COUNTER_SHARDED(field, name, help)
+#define METRIC_HISTOGRAM_SHARDED(field, name, help, buckets)
 
 #include "metrics/all_metrics.def"
 
@@ -76,4 +169,6 @@ namespace lean::metrics {
 #undef METRIC_COUNTER_LABELS
 #undef METRIC_HISTOGRAM
 #undef METRIC_HISTOGRAM_LABELS
+#undef METRIC_COUNTER_SHARDED
+#undef METRIC_HISTOGRAM_SHARDED
 }  // namespace lean::metrics
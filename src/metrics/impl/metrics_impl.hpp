@@ -6,10 +6,18 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
+#include <set>
+
+#include <qtils/shared_ref.hpp>
 
 #include "metrics/metrics.hpp"
 
+namespace lean::app {
+  class Configuration;
+}  // namespace lean::app
+
 namespace lean::metrics {
   class Registry;
 
@@ -19,13 +27,25 @@ namespace lean::metrics {
    * This class contains all metrics from all modules (application, fork choice,
    * state transition, etc.) Metrics are initialized once in the constructor and
    * accessed directly as member variables.
+   *
+   * Buckets of histograms are overridden by `metrics.buckets` config,
+   * metrics of `metrics.drop` are not exported and their updates do nothing,
+   * e.g. to turn off high cardinality labelled ones.
    */
   class MetricsImpl : public Metrics {
    public:
-    explicit MetricsImpl(std::shared_ptr<Registry> registry);
+    MetricsImpl(std::shared_ptr<Registry> registry,
+                qtils::SharedRef<const app::Configuration> app_config);
 
    private:
+    /// Configured buckets of histogram, or `defined` ones
+    std::vector<double> bucketBoundaries(const std::string &name,
+                                         std::vector<double> defined) const;
+    bool dropped(const std::string &name) const;
+
     std::shared_ptr<Registry> registry_;
+    std::map<std::string, std::vector<double>> histogram_buckets_;
+    std::set<std::string> dropped_;
 
    public:
 #define METRIC_GAUGE(field, name, help) \
@@ -35,6 +55,9 @@ namespace lean::metrics {
  public:                                \
   Gauge *field() const override;
 #define METRIC_GAUGE_LABELS(field, name, help, ...) \
+ private:                                           \
+  bool drop_##field##_ = false;                     \
+                                                    \
  public:                                            \
   Gauge *field(const Labels &labels) override;
 #define METRIC_COUNTER(field, name, help) \
@@ -44,6 +67,9 @@ namespace lean::metrics {
  public:                                  \
   Counter *field() const override;
 #define METRIC_COUNTER_LABELS(field, name, help, ...) \
+ private:                                             \
+  bool drop_##field##_ = false;                       \
+                                                      \
  public:                                              \
   Counter *field(const Labels &labels) override;
 #define METRIC_HISTOGRAM(field, name, help, ...) \
@@ -53,8 +79,14 @@ namespace lean::metrics {
  public:                                         \
   Histogram *field() const override;
 #define METRIC_HISTOGRAM_LABELS(field, name, help, ...) \
+ private:                                               \
+  bool drop_##field##_ = false;                         \
+  std::vector<double> buckets_##field##_;               \
+                                                        \
  public:                                                \
   Histogram *field(const Labels &labels) override;
+#define METRIC_COUNTER_SHARDED(field, name, help)
+#define METRIC_HISTOGRAM_SHARDED(field, name, help, ...)
 
 #include "metrics/all_metrics.def"
 
@@ -64,6 +96,8 @@ namespace lean::metrics {
 #undef METRIC_COUNTER_LABELS
 #undef METRIC_HISTOGRAM
 #undef METRIC_HISTOGRAM_LABELS
+#undef METRIC_COUNTER_SHARDED
+#undef METRIC_HISTOGRAM_SHARDED
   };
 
 }  // namespace lean::metrics
@@ -6,8 +6,11 @@
 
 #include "metrics/impl/prometheus/handler_impl.hpp"
 
+#include <algorithm>
+
 #include <prometheus/text_serializer.h>
 
+#include "app/configuration.hpp"
 #include "log/logger.hpp"
 #include "registry_impl.hpp"
 #include "utils/retain_if.hpp"
@@ -36,13 +39,56 @@ std::vector<MetricFamily> CollectMetrics(
   return collected_metrics;
 }
 
+/// Whether families are serialized to same text
+bool SameFamily(const MetricFamily &lhs, const MetricFamily &rhs) {
+  using prometheus::ClientMetric;
+  auto same_labels = [](const std::vector<ClientMetric::Label> &lhs,
+                        const std::vector<ClientMetric::Label> &rhs) {
+    return std::ranges::equal(lhs, rhs, [](auto &l, auto &r) {
+      return l.name == r.name and l.value == r.value;
+    });
+  };
+  auto same_metric = [&](const ClientMetric &l, const ClientMetric &r) {
+    return same_labels(l.label, r.label) and l.timestamp_ms == r.timestamp_ms
+       and l.counter.value == r.counter.value
+       and l.gauge.value == r.gauge.value
+       and l.untyped.value == r.untyped.value
+       and l.histogram.sample_count == r.histogram.sample_count
+       and l.histogram.sample_sum == r.histogram.sample_sum
+       and std::ranges::equal(l.histogram.bucket,
+                              r.histogram.bucket,
+                              [](auto &lb, auto &rb) {
+                                return lb.cumulative_count
+                                           == rb.cumulative_count
+                                   and lb.upper_bound == rb.upper_bound;
+                              })
+       and l.summary.sample_count == r.summary.sample_count
+       and l.summary.sample_sum == r.summary.sample_sum
+       and std::ranges::equal(
+           l.summary.quantile, r.summary.quantile, [](auto &lq, auto &rq) {
+             return lq.quantile == rq.quantile and lq.value == rq.value;
+           });
+  };
+  return lhs.name == rhs.name and lhs.help == rhs.help
+     and lhs.type == rhs.type
+     and std::ranges::equal(lhs.metric, rhs.metric, same_metric);
+}
+
 namespace lean::metrics {
 
   PrometheusHandler::PrometheusHandler(
-      std::shared_ptr<log::LoggingSystem> logsys)
-      : logger_{logsys->getLogger("PrometheusHandler", "metrics")} {}
+      std::shared_ptr<log::LoggingSystem> logsys,
+      qtils::SharedRef<const app::Configuration> app_config)
+      : logger_{logsys->getLogger("PrometheusHandler", "metrics")},
+        cache_ttl_{app_config->metrics().cache_ttl} {}
 
   std::string PrometheusHandler::collect() {
+    std::lock_guard cache_lock{cache_mutex_};
+    auto now = Clock::now();
+    if (collected_at_.has_value() and now - *collected_at_ < cache_ttl_) {
+      return text_;
+    }
+
     std::vector<MetricFamily> metrics;
 
     {
@@ -52,7 +98,31 @@ namespace lean::metrics {
 
     const TextSerializer serializer;
 
-    return serializer.Serialize(metrics);
+    std::string text;
+    std::unordered_map<std::string, SerializedFamily> families;
+    families.reserve(metrics.size());
+    std::vector<MetricFamily> single(1);
+    for (auto &family : metrics) {
+      auto it = families_.find(family.name);
+      std::string family_text;
+      if (it != families_.end() and SameFamily(it->second.family, family)) {
+        family_text = std::move(it->second.text);
+      } else {
+        single.front() = std::move(family);
+        family_text = serializer.Serialize(single);
+        family = std::move(single.front());
+      }
+      text += family_text;
+      families.emplace(family.name,
+                       SerializedFamily{
+                           .family = std::move(family),
+                           .text = std::move(family_text),
+                       });
+    }
+    families_ = std::move(families);
+    text_ = text;
+    collected_at_ = now;
+    return text;
   }
 
   // it is called once on init
@@ -60,6 +130,7 @@ namespace lean::metrics {
     auto *pregistry = dynamic_cast<PrometheusRegistry *>(&registry);
     if (pregistry) {
       registerCollectable(pregistry->registry());
+      registerCollectable(pregistry->sharded());
     }
   }
 
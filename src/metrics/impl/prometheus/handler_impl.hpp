@@ -6,20 +6,38 @@
 
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string_view>
+#include <unordered_map>
 
 #include <prometheus/collectable.h>
+#include <prometheus/metric_family.h>
+#include <qtils/shared_ref.hpp>
 
 #include "log/logger.hpp"
 #include "metrics/handler.hpp"
 
+namespace lean::app {
+  class Configuration;
+}  // namespace lean::app
+
 namespace lean::metrics {
 
+  /**
+   * Text exposition of registered collectables.
+   * Text is reused by scrapes within `metrics.cache_ttl` of previous one,
+   * and text of family is reused while its values don't change, as
+   * formatting of labelled families takes most of scrape.
+   */
   class PrometheusHandler : public Handler {
    public:
-    explicit PrometheusHandler(std::shared_ptr<log::LoggingSystem> logsys);
+    using Clock = std::chrono::steady_clock;
+
+    PrometheusHandler(std::shared_ptr<log::LoggingSystem> logsys,
+                      qtils::SharedRef<const app::Configuration> app_config);
     ~PrometheusHandler() override = default;
 
     void registerCollectable(Registry &registry) override;
@@ -33,9 +51,21 @@ namespace lean::metrics {
     static void cleanupStalePointers(
         std::vector<std::weak_ptr<prometheus::Collectable>> &collectables);
 
+    /// Family with text it was serialized to
+    struct SerializedFamily {
+      prometheus::MetricFamily family;
+      std::string text;
+    };
+
     std::shared_ptr<soralog::Logger> logger_;
+    std::chrono::milliseconds cache_ttl_;
     std::mutex collectables_mutex_;
     std::vector<std::weak_ptr<prometheus::Collectable>> collectables_;
+    /// Serializes scrapes, concurrent scrapers wait for one serialization
+    std::mutex cache_mutex_;
+    std::optional<Clock::time_point> collected_at_;
+    std::string text_;
+    std::unordered_map<std::string, SerializedFamily> families_;
   };
 
 }  // namespace lean::metrics
@@ -6,10 +6,63 @@
 
 #include "metrics/impl/prometheus/registry_impl.hpp"
 
+#include <limits>
+
 #include "metrics/handler.hpp"
 #include "metrics/registry.hpp"
 
 namespace lean::metrics {
+  void ShardedCollectable::add(const std::string &name,
+                               const std::string &help,
+                               const ShardedCounter &counter) {
+    std::lock_guard lock{mutex_};
+    counters_.emplace_back(name, help, &counter);
+  }
+
+  void ShardedCollectable::add(const std::string &name,
+                               const std::string &help,
+                               const ShardedHistogram &histogram) {
+    std::lock_guard lock{mutex_};
+    histograms_.emplace_back(name, help, &histogram);
+  }
+
+  std::vector<prometheus::MetricFamily> ShardedCollectable::Collect() const {
+    std::lock_guard lock{mutex_};
+    std::vector<prometheus::MetricFamily> families;
+    families.reserve(counters_.size() + histograms_.size());
+    for (auto &[name, help, counter] : counters_) {
+      auto &family = families.emplace_back(prometheus::MetricFamily{
+          .name = name,
+          .help = help,
+          .type = prometheus::MetricType::Counter,
+      });
+      family.metric.emplace_back().counter.value = counter->value();
+    }
+    for (auto &[name, help, histogram] : histograms_) {
+      auto &family = families.emplace_back(prometheus::MetricFamily{
+          .name = name,
+          .help = help,
+          .type = prometheus::MetricType::Histogram,
+      });
+      auto &metric = family.metric.emplace_back().histogram;
+      auto snapshot = histogram->collect();
+      auto &bounds = histogram->bucketBoundaries();
+      uint64_t cumulative = 0;
+      for (size_t i = 0; i < snapshot.counts.size(); ++i) {
+        cumulative += snapshot.counts[i];
+        metric.bucket.emplace_back(prometheus::ClientMetric::Bucket{
+            .cumulative_count = cumulative,
+            .upper_bound = i < bounds.size()
+                             ? bounds[i]
+                             : std::numeric_limits<double>::infinity(),
+        });
+      }
+      metric.sample_count = cumulative;
+      metric.sample_sum = snapshot.sum;
+    }
+    return families;
+  }
+
   void PrometheusRegistry::setHandler(Handler &handler) {
     handler.registerCollectable(*this);
   }
@@ -74,4 +127,18 @@ namespace lean::metrics {
     return registerMetric<Summary>(name, labels, q, max_age, age_buckets);
   }
 
+  void PrometheusRegistry::registerShardedCounter(
+      const std::string &name,
+      const std::string &help,
+      const ShardedCounter &counter) {
+    sharded()->add(name, help, counter);
+  }
+
+  void PrometheusRegistry::registerShardedHistogram(
+      const std::string &name,
+      const std::string &help,
+      const ShardedHistogram &histogram) {
+    sharded()->add(name, help, histogram);
+  }
+
 }  // namespace lean::metrics
@@ -9,9 +9,11 @@
 #include <forward_list>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <tuple>
 #include <type_traits>
 
+#include <prometheus/collectable.h>
 #include <prometheus/counter.h>
 #include <prometheus/family.h>
 #include <prometheus/gauge.h>
@@ -68,6 +70,31 @@ namespace lean::metrics {
 
   }  // namespace
 
+  /// Merges sharded metrics into metric families on scrape
+  class ShardedCollectable : public prometheus::Collectable {
+   public:
+    void add(const std::string &name,
+             const std::string &help,
+             const ShardedCounter &counter);
+    void add(const std::string &name,
+             const std::string &help,
+             const ShardedHistogram &histogram);
+
+    std::vector<prometheus::MetricFamily> Collect() const override;
+
+   private:
+    template <typename T>
+    struct Entry {
+      std::string name;
+      std::string help;
+      const T *metric;
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<Entry<ShardedCounter>> counters_;
+    std::vector<Entry<ShardedHistogram>> histograms_;
+  };
+
   class PrometheusRegistry : public Registry {
     friend class PrometheusHandler;
 
@@ -115,6 +142,11 @@ namespace lean::metrics {
       return registry;
     }
 
+    static std::shared_ptr<ShardedCollectable> sharded() {
+      static auto sharded = std::make_shared<ShardedCollectable>();
+      return sharded;
+    }
+
    public:
     // Handler has access to internal prometheus registry and gathers metrics,
     // prepares them for sending by http
@@ -160,6 +192,14 @@ namespace lean::metrics {
         int age_buckets,
         const std::map<std::string, std::string> &labels) override;
 
+    void registerShardedCounter(const std::string &name,
+                                const std::string &help,
+                                const ShardedCounter &counter) override;
+
+    void registerShardedHistogram(const std::string &name,
+                                  const std::string &help,
+                                  const ShardedHistogram &histogram) override;
+
     // it is used for test purposes
     template <typename T>
     static typename MetricInfo<T>::type *internalMetric(T *metric) {
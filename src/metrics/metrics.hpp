@@ -6,9 +6,13 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace lean::metrics {
   using Labels = std::map<std::string, std::string>;
@@ -128,6 +132,80 @@ namespace lean::metrics {
     HistogramTimer timer();
   };
 
+  /// Shards of `ShardedCounter` and `ShardedHistogram`
+  constexpr size_t kMetricShards = 16;
+
+  /// Shard of current thread, threads are assigned round robin
+  size_t metricShard();
+
+  /**
+   * @brief Counter for hot paths, updated by many threads.
+   *
+   * Each thread increments own cache line, shards are summed on scrape.
+   */
+  class ShardedCounter final : public Counter {
+   public:
+    [[nodiscard]] double value() const override;
+
+    void inc() override {
+      inc(1);
+    }
+
+    void inc(double val) override {
+      if (val < 0) {
+        return;
+      }
+      shards_.at(metricShard()).value.fetch_add(val,
+                                                std::memory_order_relaxed);
+    }
+
+   private:
+    struct alignas(64) Shard {
+      std::atomic<double> value = 0;
+    };
+
+    std::array<Shard, kMetricShards> shards_;
+  };
+
+  /**
+   * @brief Histogram for hot paths, updated by many threads.
+   *
+   * Unlike prometheus-cpp histogram, observation doesn't lock mutex.
+   * Each thread updates own buckets, shards are merged on scrape.
+   */
+  class ShardedHistogram final : public Histogram {
+   public:
+    /// Merged buckets, last one is +Inf
+    struct Snapshot {
+      std::vector<uint64_t> counts;
+      double sum = 0;
+    };
+
+    explicit ShardedHistogram(std::vector<double> bucket_boundaries);
+
+    /// Replace buckets, only before histogram is observed or collected
+    void setBucketBoundaries(std::vector<double> bucket_boundaries);
+
+    void observe(double value) override;
+
+    const std::vector<double> &bucketBoundaries() const {
+      return bucket_boundaries_;
+    }
+
+    Snapshot collect() const;
+
+   private:
+    struct alignas(64) Shard {
+      std::unique_ptr<std::atomic_uint64_t[]> counts;
+      std::atomic<double> sum = 0;
+    };
+
+    std::vector<double> bucket_boundaries_;
+    std::array<Shard, kMetricShards> shards_;
+  };
+
+#define LEAN_METRICS_UNWRAP(...) __VA_ARGS__
+
   /**
    * @brief Metrics interface that holds all application metrics
    *
@@ -147,6 +225,24 @@ namespace lean::metrics {
   virtual Histogram *field() const = 0;
 #define METRIC_HISTOGRAM_LABELS(field, name, help, ...) \
   virtual Histogram *field(const Labels &labels) = 0;
+// Sharded metrics are not virtual, so hot paths call them directly
+#define METRIC_COUNTER_SHARDED(field, name, help) \
+ private:                                         \
+  mutable ShardedCounter sharded_##field##_;      \
+                                                  \
+ public:                                          \
+  ShardedCounter *field() const {                 \
+    return &sharded_##field##_;                   \
+  }
+#define METRIC_HISTOGRAM_SHARDED(field, name, help, buckets)    \
+ private:                                                       \
+  mutable ShardedHistogram sharded_##field##_{                  \
+      std::vector<double>{LEAN_METRICS_UNWRAP buckets}};        \
+                                                                \
+ public:                                                        \
+  ShardedHistogram *field() const {                             \
+    return &sharded_##field##_;                                 \
+  }
 
 #include "metrics/all_metrics.def"
 
@@ -157,6 +253,8 @@ namespace lean::metrics {
 #undef METRIC_COUNTER_LABELS
 #undef METRIC_HISTOGRAM
 #undef METRIC_HISTOGRAM_LABELS
+#undef METRIC_COUNTER_SHARDED
+#undef METRIC_HISTOGRAM_SHARDED
   };
 
   /**
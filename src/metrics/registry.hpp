@@ -17,6 +17,8 @@ namespace lean::metrics {
   class Gauge;
   class Handler;
   class Histogram;
+  class ShardedCounter;
+  class ShardedHistogram;
   class Summary;
 
   /**
@@ -106,6 +108,23 @@ namespace lean::metrics {
         std::chrono::milliseconds max_age = std::chrono::seconds{60},
         int age_buckets = 5,
         const std::map<std::string, std::string> &labels = {}) = 0;
+
+    /**
+     * @brief export sharded counter owned by caller
+     * @note counter must stay alive while registry is scraped
+     */
+    virtual void registerShardedCounter(const std::string &name,
+                                        const std::string &help,
+                                        const ShardedCounter &counter) = 0;
+
+    /**
+     * @brief export sharded histogram owned by caller
+     * @note histogram must stay alive while registry is scraped
+     */
+    virtual void registerShardedHistogram(
+        const std::string &name,
+        const std::string &help,
+        const ShardedHistogram &histogram) = 0;
   };
 
 }  // namespace lean::metrics
@@ -0,0 +1,63 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+
+#include "metrics/metrics.hpp"
+
+namespace lean::metrics {
+  size_t metricShard() {
+    static std::atomic_size_t next_shard = 0;
+    thread_local size_t shard =
+        next_shard.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+    return shard;
+  }
+
+  double ShardedCounter::value() const {
+    double value = 0;
+    for (auto &shard : shards_) {
+      value += shard.value.load(std::memory_order_relaxed);
+    }
+    return value;
+  }
+
+  ShardedHistogram::ShardedHistogram(std::vector<double> bucket_boundaries) {
+    setBucketBoundaries(std::move(bucket_boundaries));
+  }
+
+  void ShardedHistogram::setBucketBoundaries(
+      std::vector<double> bucket_boundaries) {
+    bucket_boundaries_ = std::move(bucket_boundaries);
+    for (auto &shard : shards_) {
+      // Value initialization zeroes counters
+      shard.counts = std::make_unique<std::atomic_uint64_t[]>(
+          bucket_boundaries_.size() + 1);
+      shard.sum = 0;
+    }
+  }
+
+  void ShardedHistogram::observe(double value) {
+    // Bucket is first with upper bound not less than value, or +Inf
+    auto bucket = static_cast<size_t>(
+        std::ranges::lower_bound(bucket_boundaries_, value)
+        - bucket_boundaries_.begin());
+    auto &shard = shards_.at(metricShard());
+    shard.counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  ShardedHistogram::Snapshot ShardedHistogram::collect() const {
+    Snapshot snapshot;
+    snapshot.counts.resize(bucket_boundaries_.size() + 1);
+    for (auto &shard : shards_) {
+      for (size_t i = 0; i < snapshot.counts.size(); ++i) {
+        snapshot.counts[i] += shard.counts[i].load(std::memory_order_relaxed);
+      }
+      snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+    }
+    return snapshot;
+  }
+}  // namespace lean::metrics
@@ -0,0 +1,74 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "modules/networking/attestation_push_protocol.hpp"
+
+#include <libp2p/coro/spawn.hpp>
+#include <libp2p/host/basic_host.hpp>
+
+#include "modules/networking/response_status.hpp"
+#include "modules/networking/ssz_snappy.hpp"
+
+namespace lean::modules {
+  constexpr auto kTrafficProtocol = TrafficShaper::Protocol::AttestationPush;
+
+  AttestationPushProtocol::AttestationPushProtocol(
+      std::shared_ptr<boost::asio::io_context> io_context,
+      std::shared_ptr<libp2p::host::BasicHost> host,
+      qtils::SharedRef<TrafficShaper> traffic,
+      OnAttestation on_attestation)
+      : io_context_{std::move(io_context)},
+        host_{std::move(host)},
+        traffic_{std::move(traffic)},
+        on_attestation_{std::move(on_attestation)} {}
+
+  libp2p::StreamProtocols AttestationPushProtocol::getProtocolIds() const {
+    return {std::string{kProtocolId}};
+  }
+
+  void AttestationPushProtocol::handle(std::shared_ptr<libp2p::Stream> stream) {
+    libp2p::coroSpawn(
+        *io_context_,
+        [self{shared_from_this()}, stream]() -> libp2p::Coro<void> {
+          std::ignore = co_await self->coroHandle(stream);
+        });
+  }
+
+  void AttestationPushProtocol::start() {
+    host_->listenProtocol(shared_from_this());
+  }
+
+  libp2p::CoroOutcome<void> AttestationPushProtocol::push(
+      libp2p::PeerId peer_id, SignedAttestation attestation) {
+    BOOST_OUTCOME_CO_TRY(
+        auto stream, co_await host_->newStream(peer_id, getProtocolIds()));
+    auto encoded = encode(attestation).value();
+    auto framed = snappy::compressFramed(encoded);
+    traffic_->record(kTrafficProtocol,
+                     TrafficShaper::Direction::Out,
+                     peer_id,
+                     framed.size());
+    BOOST_OUTCOME_CO_TRY(
+        co_await snappy::coWriteFramed(stream, encoded.size(), framed));
+    BOOST_OUTCOME_CO_TRY(co_await readResponseStatus(stream));
+    co_return outcome::success();
+  }
+
+  libp2p::CoroOutcome<void> AttestationPushProtocol::coroHandle(
+      std::shared_ptr<libp2p::Stream> stream) {
+    auto peer_id = stream->remotePeerId();
+    size_t bytes = 0;
+    BOOST_OUTCOME_CO_TRY(auto encoded,
+                         co_await snappy::coUncompressFramed(
+                             stream, kDecodeBudget<SignedAttestation>, &bytes));
+    traffic_->record(
+        kTrafficProtocol, TrafficShaper::Direction::In, peer_id, bytes);
+    BOOST_OUTCOME_CO_TRY(auto attestation, decode<SignedAttestation>(encoded));
+    BOOST_OUTCOME_CO_TRY(co_await writeResponseStatus(stream));
+    on_attestation_(std::move(attestation), peer_id);
+    co_return outcome::success();
+  }
+}  // namespace lean::modules
@@ -0,0 +1,71 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string_view>
+
+#include <libp2p/protocol/base_protocol.hpp>
+#include <qtils/shared_ref.hpp>
+
+#include "modules/networking/traffic_shaper.hpp"
+#include "types/signed_attestation.hpp"
+
+namespace boost::asio {
+  class io_context;
+}  // namespace boost::asio
+
+namespace libp2p::host {
+  class BasicHost;
+}  // namespace libp2p::host
+
+namespace lean::modules {
+  /**
+   * Direct delivery of own attestations to aggregators of their subnet.
+   *
+   * Attestation is still gossiped, but aggregator gets it in one hop instead
+   * of after mesh propagation, so more signatures arrive before
+   * aggregation. Protocol is specific to this client, so attestations are
+   * pushed only to peers advertising it by identify.
+   * Received attestations are checked as gossip ones.
+   */
+  class AttestationPushProtocol
+      : public std::enable_shared_from_this<AttestationPushProtocol>,
+        public libp2p::protocol::BaseProtocol {
+   public:
+    static constexpr std::string_view kProtocolId =
+        "/qlean/req/attestation_push/1/ssz_snappy";
+
+    using OnAttestation =
+        std::function<void(SignedAttestation &&, const libp2p::PeerId &)>;
+
+    AttestationPushProtocol(std::shared_ptr<boost::asio::io_context> io_context,
+                            std::shared_ptr<libp2p::host::BasicHost> host,
+                            qtils::SharedRef<TrafficShaper> traffic,
+                            OnAttestation on_attestation);
+
+    // BaseProtocol
+    libp2p::StreamProtocols getProtocolIds() const override;
+    void handle(std::shared_ptr<libp2p::Stream> stream) override;
+
+    void start();
+
+    /// Send attestation to connected peer, and wait for acknowledgement
+    libp2p::CoroOutcome<void> push(libp2p::PeerId peer_id,
+                                   SignedAttestation attestation);
+
+   private:
+    libp2p::CoroOutcome<void> coroHandle(
+        std::shared_ptr<libp2p::Stream> stream);
+
+    std::shared_ptr<boost::asio::io_context> io_context_;
+    std::shared_ptr<libp2p::host::BasicHost> host_;
+    qtils::SharedRef<TrafficShaper> traffic_;
+    OnAttestation on_attestation_;
+  };
+}  // namespace lean::modules
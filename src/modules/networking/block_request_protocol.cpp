@@ -6,69 +6,356 @@
 
 #include "modules/networking/block_request_protocol.hpp"
 
+#include <algorithm>
+#include <ranges>
+
 #include <libp2p/basic/read_varint.hpp>
 #include <libp2p/basic/write_varint.hpp>
 #include <libp2p/coro/spawn.hpp>
 #include <libp2p/host/basic_host.hpp>
 
 #include "blockchain/block_tree.hpp"
+#include "modules/networking/req_resp_metrics.hpp"
 #include "modules/networking/response_status.hpp"
 #include "modules/networking/ssz_snappy.hpp"
 
 namespace lean::modules {
+  /**
+   * Blocks read from storage and written at once.
+   * Stream is written in batches, so io thread serves other work between
+   * them, and memory of large requests is bounded.
+   */
+  constexpr size_t kServeBatchSize = 64;
+
+  /**
+   * Read at most `max_count` response chunks.
+   * Response is complete when stream ends, so read error after some chunks
+   * are received is not an error.
+   * @param timing gets first byte time and compressed bytes of chunks
+   */
+  libp2p::CoroOutcome<std::vector<BlockResponse>> readBlockResponses(
+      std::shared_ptr<libp2p::Stream> stream,
+      size_t max_count,
+      ReqRespMetrics::Request &timing) {
+    std::vector<BlockResponse> responses;
+    while (responses.size() < max_count) {
+      auto status_res = co_await readResponseStatus(stream);
+      if (not status_res.has_value()) {
+        if (responses.empty()) {
+          co_return status_res.error();
+        }
+        break;
+      }
+      if (not timing.first_byte.has_value()) {
+        timing.first_byte = ReqRespMetrics::Clock::now();
+      }
+      BOOST_OUTCOME_CO_TRY(
+          auto encoded,
+          co_await snappy::coUncompressFramed(
+              stream, kDecodeBudget<BlockResponse>, &timing.bytes));
+      BOOST_OUTCOME_CO_TRY(auto response, decode<BlockResponse>(encoded));
+      responses.emplace_back(std::move(response));
+    }
+    co_return responses;
+  }
+
+  /**
+   * Write request and read at most `max_count` response chunks, resetting
+   * stream after `timeout`.
+   */
+  template <typename Request>
+  libp2p::CoroOutcome<std::vector<BlockResponse>> requestBlocks(
+      boost::asio::io_context &io_context,
+      StreamPool &stream_pool,
+      TrafficShaper &traffic,
+      TrafficShaper::Protocol protocol,
+      ReqRespMetrics &metrics,
+      std::chrono::milliseconds timeout,
+      const libp2p::PeerId &peer_id,
+      const Request &request,
+      size_t max_count) {
+    ReqRespMetrics::Request timing;
+    std::optional<StreamDeadline> deadline;
+    auto responses_res =
+        co_await [&]() -> libp2p::CoroOutcome<std::vector<BlockResponse>> {
+      BOOST_OUTCOME_CO_TRY(auto stream, co_await stream_pool.take(peer_id));
+      deadline.emplace(io_context, stream, timeout);
+      auto encoded = encode(request).value();
+      auto framed = snappy::compressFramed(encoded);
+      traffic.record(
+          protocol, TrafficShaper::Direction::Out, peer_id, framed.size());
+      BOOST_OUTCOME_CO_TRY(
+          co_await snappy::coWriteFramed(stream, encoded.size(), framed));
+      timing.sent = ReqRespMetrics::Clock::now();
+      co_return co_await readBlockResponses(stream, max_count, timing);
+    }();
+    traffic.record(
+        protocol, TrafficShaper::Direction::In, peer_id, timing.bytes);
+    auto expired = deadline.has_value() and deadline->expired();
+    auto result = expired ? ReqRespMetrics::Result::TIMEOUT
+                : not responses_res.has_value()
+                    ? ReqRespMetrics::Result::ERROR
+                : responses_res.value().size() < max_count
+                    ? ReqRespMetrics::Result::PARTIAL
+                    : ReqRespMetrics::Result::SUCCESS;
+    metrics.onRequest(peer_id, timing, result);
+    co_return responses_res;
+  }
+
+  /// Write response chunk, once it fits upload limits
+  libp2p::CoroOutcome<void> writeBlockResponse(
+      std::shared_ptr<libp2p::Stream> stream,
+      std::shared_ptr<const EncodedBlock> block,
+      TrafficShaper &traffic,
+      TrafficShaper::Protocol protocol) {
+    co_await traffic.serve(
+        protocol, stream->remotePeerId(), block->framed.size());
+    BOOST_OUTCOME_CO_TRY(co_await writeResponseStatus(stream));
+    BOOST_OUTCOME_CO_TRY(
+        co_await snappy::coWriteFramed(stream, block->size, block->framed));
+    co_return outcome::success();
+  }
+
+  EncodedBlockCache::EncodedBlockCache(size_t max_size) : blocks_{max_size} {}
+
+  size_t EncodedBlockCache::byteSize() const {
+    return blocks_.byteSize(
+        [](const EncodedBlock &block) { return block.framed.capacity(); });
+  }
+
+  outcome::result<std::vector<std::shared_ptr<const EncodedBlock>>>
+  EncodedBlockCache::get(blockchain::BlockTree &block_tree,
+                         std::span<const BlockHash> block_hashes) {
+    std::vector<std::shared_ptr<const EncodedBlock>> blocks;
+    blocks.reserve(block_hashes.size());
+    std::vector<size_t> missing;
+    std::vector<BlockHash> missing_hashes;
+    for (auto &block_hash : block_hashes) {
+      if (auto cached = blocks_.get(block_hash)) {
+        blocks.emplace_back(cached.value());
+      } else {
+        missing.emplace_back(blocks.size());
+        missing_hashes.emplace_back(block_hash);
+        blocks.emplace_back(nullptr);
+      }
+    }
+    if (missing.empty()) {
+      return blocks;
+    }
+    BOOST_OUTCOME_TRY(auto loaded,
+                      block_tree.tryGetSignedBlocks(missing_hashes));
+    for (auto &&[i, block] : std::views::zip(missing, loaded)) {
+      if (not block.has_value()) {
+        continue;
+      }
+      auto slot = block->block.slot;
+      blocks[i] = blocks_.put(
+          block_hashes[i],
+          withSszScratch(block.value(), [&](qtils::BytesIn encoded) {
+            return EncodedBlock{
+                .slot = slot,
+                .size = encoded.size(),
+                .framed = snappy::compressFramed(encoded),
+            };
+          }));
+    }
+    return blocks;
+  }
+
+  std::optional<ServedStreams::Slot> ServedStreams::acquire(
+      const libp2p::PeerId &peer_id) {
+    auto &count = streams_[peer_id];
+    if (count >= kMaxStreamsPerPeer) {
+      return std::nullopt;
+    }
+    ++count;
+    return Slot{this, [peer_id](ServedStreams *self) {
+                  auto it = self->streams_.find(peer_id);
+                  if (--it->second == 0) {
+                    self->streams_.erase(it);
+                  }
+                }};
+  }
+
   BlockRequestProtocol::BlockRequestProtocol(
       std::shared_ptr<boost::asio::io_context> io_context,
       std::shared_ptr<libp2p::host::BasicHost> host,
-      qtils::SharedRef<blockchain::BlockTree> block_tree)
+      qtils::SharedRef<blockchain::BlockTree> block_tree,
+      qtils::SharedRef<EncodedBlockCache> encoded_blocks,
+      qtils::SharedRef<ServedStreams> served_streams,
+      qtils::SharedRef<StreamPool> stream_pool,
+      qtils::SharedRef<TrafficShaper> traffic,
+      qtils::SharedRef<ReqRespMetrics> metrics)
       : io_context_{std::move(io_context)},
         host_{std::move(host)},
-        block_tree_{std::move(block_tree)} {}
+        block_tree_{std::move(block_tree)},
+        encoded_blocks_{std::move(encoded_blocks)},
+        served_streams_{std::move(served_streams)},
+        stream_pool_{std::move(stream_pool)},
+        traffic_{std::move(traffic)},
+        metrics_{std::move(metrics)} {}
 
   libp2p::StreamProtocols BlockRequestProtocol::getProtocolIds() const {
-    return {"/leanconsensus/req/blocks_by_root/1/ssz_snappy"};
+    return {std::string{kProtocolId}};
   }
 
   void BlockRequestProtocol::handle(std::shared_ptr<libp2p::Stream> stream) {
-    libp2p::coroSpawn(
-        *io_context_,
-        [self{shared_from_this()}, stream]() -> libp2p::Coro<void> {
-          std::ignore = co_await self->coroRespond(stream);
-        });
+    auto slot = served_streams_->acquire(stream->remotePeerId());
+    if (not slot.has_value()) {
+      stream->reset();
+      return;
+    }
+    libp2p::coroSpawn(*io_context_,
+                      [self{shared_from_this()},
+                       stream,
+                       slot{std::move(slot.value())}]() -> libp2p::Coro<void> {
+                        std::ignore = co_await self->coroRespond(stream);
+                      });
   }
 
   void BlockRequestProtocol::start() {
     host_->listenProtocol(shared_from_this());
   }
 
-  libp2p::CoroOutcome<BlockResponse> BlockRequestProtocol::request(
-      libp2p::PeerId peer_id, BlockRequest request) {
-    BOOST_OUTCOME_CO_TRY(auto stream,
-                         co_await host_->newStream(peer_id, getProtocolIds()));
-    BOOST_OUTCOME_CO_TRY(
-        co_await snappy::coCompressFramed(stream, encode(request).value()));
-    BOOST_OUTCOME_CO_TRY(co_await readResponseStatus(stream));
-    BOOST_OUTCOME_CO_TRY(auto encoded,
-                         co_await snappy::coUncompressFramed(stream));
-    BOOST_OUTCOME_CO_TRY(auto response, decode<BlockResponse>(encoded));
-    co_return response;
+  libp2p::CoroOutcome<std::vector<BlockResponse>>
+  BlockRequestProtocol::request(libp2p::PeerId peer_id, BlockRequest request) {
+    co_return co_await requestBlocks(*io_context_,
+                                     *stream_pool_,
+                                     *traffic_,
+                                     kTrafficProtocol,
+                                     *metrics_,
+                                     kResponseTimeout,
+                                     peer_id,
+                                     request,
+                                     request.roots.size());
   }
 
   libp2p::CoroOutcome<void> BlockRequestProtocol::coroRespond(
       std::shared_ptr<libp2p::Stream> stream) {
+    size_t bytes = 0;
     BOOST_OUTCOME_CO_TRY(auto encoded,
-                         co_await snappy::coUncompressFramed(stream));
+                         co_await snappy::coUncompressFramed(
+                             stream, kDecodeBudget<BlockRequest>, &bytes));
+    traffic_->record(kTrafficProtocol,
+                     TrafficShaper::Direction::In,
+                     stream->remotePeerId(),
+                     bytes);
     BOOST_OUTCOME_CO_TRY(auto request, decode<BlockRequest>(encoded));
-    for (auto &block_hash : request.roots) {
-      BOOST_OUTCOME_CO_TRY(auto block,
-                           block_tree_->tryGetSignedBlock(block_hash));
-      if (not block.has_value()) {
-        // TODO: how to respond?
-        continue;
+    std::span<const BlockHash> roots = request.roots.data();
+    size_t served = 0;
+    while (not roots.empty()) {
+      auto batch = roots.first(std::min(roots.size(), kServeBatchSize));
+      roots = roots.subspan(batch.size());
+      BOOST_OUTCOME_CO_TRY(auto blocks,
+                           encoded_blocks_->get(*block_tree_, batch));
+      for (auto &block : blocks) {
+        // Unknown blocks are omitted from response, peer matches received
+        // blocks by root
+        if (block == nullptr) {
+          continue;
+        }
+        BOOST_OUTCOME_CO_TRY(co_await writeBlockResponse(
+            stream, block, *traffic_, kTrafficProtocol));
+        ++served;
+      }
+    }
+    metrics_->onServed(request.roots.size(), served);
+    co_return outcome::success();
+  }
+
+  BlockRangeRequestProtocol::BlockRangeRequestProtocol(
+      std::shared_ptr<boost::asio::io_context> io_context,
+      std::shared_ptr<libp2p::host::BasicHost> host,
+      qtils::SharedRef<blockchain::BlockTree> block_tree,
+      qtils::SharedRef<EncodedBlockCache> encoded_blocks,
+      qtils::SharedRef<ServedStreams> served_streams,
+      qtils::SharedRef<StreamPool> stream_pool,
+      qtils::SharedRef<TrafficShaper> traffic,
+      qtils::SharedRef<ReqRespMetrics> metrics)
+      : io_context_{std::move(io_context)},
+        host_{std::move(host)},
+        block_tree_{std::move(block_tree)},
+        encoded_blocks_{std::move(encoded_blocks)},
+        served_streams_{std::move(served_streams)},
+        stream_pool_{std::move(stream_pool)},
+        traffic_{std::move(traffic)},
+        metrics_{std::move(metrics)} {}
+
+  libp2p::StreamProtocols BlockRangeRequestProtocol::getProtocolIds() const {
+    return {std::string{kProtocolId}};
+  }
+
+  void BlockRangeRequestProtocol::handle(
+      std::shared_ptr<libp2p::Stream> stream) {
+    auto slot = served_streams_->acquire(stream->remotePeerId());
+    if (not slot.has_value()) {
+      stream->reset();
+      return;
+    }
+    libp2p::coroSpawn(*io_context_,
+                      [self{shared_from_this()},
+                       stream,
+                       slot{std::move(slot.value())}]() -> libp2p::Coro<void> {
+                        std::ignore = co_await self->coroRespond(stream);
+                      });
+  }
+
+  void BlockRangeRequestProtocol::start() {
+    host_->listenProtocol(shared_from_this());
+  }
+
+  libp2p::CoroOutcome<std::vector<BlockResponse>>
+  BlockRangeRequestProtocol::request(libp2p::PeerId peer_id,
+                                     BlocksByRangeRequest request) {
+    co_return co_await requestBlocks(
+        *io_context_,
+        *stream_pool_,
+        *traffic_,
+        kTrafficProtocol,
+        *metrics_,
+        kResponseTimeout,
+        peer_id,
+        request,
+        std::min<uint64_t>(request.count, MAX_REQUEST_BLOCKS));
+  }
+
+  libp2p::CoroOutcome<void> BlockRangeRequestProtocol::coroRespond(
+      std::shared_ptr<libp2p::Stream> stream) {
+    size_t bytes = 0;
+    BOOST_OUTCOME_CO_TRY(
+        auto encoded,
+        co_await snappy::coUncompressFramed(
+            stream, kDecodeBudget<BlocksByRangeRequest>, &bytes));
+    traffic_->record(kTrafficProtocol,
+                     TrafficShaper::Direction::In,
+                     stream->remotePeerId(),
+                     bytes);
+    BOOST_OUTCOME_CO_TRY(auto request, decode<BlocksByRangeRequest>(encoded));
+    auto count = std::min<uint64_t>(request.count, MAX_REQUEST_BLOCKS);
+    if (count == 0) {
+      co_return outcome::success();
+    }
+    BOOST_OUTCOME_CO_TRY(
+        auto canonical,
+        block_tree_->getCanonicalBlocks(request.start_slot, count));
+    std::vector<BlockHash> chain;
+    chain.reserve(canonical.size());
+    for (auto &block : canonical) {
+      chain.emplace_back(block.hash);
+    }
+    std::span<const BlockHash> hashes = chain;
+    while (not hashes.empty()) {
+      auto batch = hashes.first(std::min(hashes.size(), kServeBatchSize));
+      hashes = hashes.subspan(batch.size());
+      BOOST_OUTCOME_CO_TRY(auto blocks,
+                           encoded_blocks_->get(*block_tree_, batch));
+      for (auto &block : blocks) {
+        if (block == nullptr) {
+          continue;
+        }
+        BOOST_OUTCOME_CO_TRY(co_await writeBlockResponse(
+            stream, block, *traffic_, kTrafficProtocol));
       }
-      BlockResponse &response = block.value();
-      BOOST_OUTCOME_CO_TRY(co_await writeResponseStatus(stream));
-      BOOST_OUTCOME_CO_TRY(co_await snappy::coCompressFramed(
-          stream, encode(block.value()).value()));
     }
     co_return outcome::success();
   }
@@ -6,12 +6,23 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include <libp2p/protocol/base_protocol.hpp>
 #include <qtils/shared_ref.hpp>
 
+#include "modules/networking/stream_pool.hpp"
+#include "modules/networking/traffic_shaper.hpp"
 #include "modules/networking/types.hpp"
+#include "types/block_hash.hpp"
+#include "types/slot.hpp"
+#include "utils/sharded_lru_cache.hpp"
 
 namespace boost::asio {
   class io_context;
@@ -26,13 +37,147 @@ namespace lean::blockchain {
 }  // namespace lean::blockchain
 
 namespace lean::modules {
+  class ReqRespMetrics;
+
+  /**
+   * Response chunk payload of block, as written to wire.
+   */
+  struct EncodedBlock {
+    Slot slot;
+    /// Size of SSZ encoded block
+    size_t size;
+    /// Snappy framed SSZ encoded block
+    qtils::ByteVec framed;
+  };
+
+  /**
+   * Encoded blocks served to peers.
+   * Blocks are immutable, so block is read, encoded and compressed once and
+   * then bytes are shared by all requests of both block protocols.
+   */
+  class EncodedBlockCache {
+   public:
+    static constexpr size_t kDefaultSize = 256;
+
+    explicit EncodedBlockCache(size_t max_size = kDefaultSize);
+
+    /**
+     * Cached encodings of blocks, blocks missing in cache are read from
+     * block tree in one batched lookup and encoded.
+     * @return encoded block, or nullptr if unknown, for each hash in the
+     * same order
+     */
+    outcome::result<std::vector<std::shared_ptr<const EncodedBlock>>> get(
+        blockchain::BlockTree &block_tree,
+        std::span<const BlockHash> block_hashes);
+
+    /// Estimated memory used by cached encodings
+    size_t byteSize() const;
+
+   private:
+    ShardedLruCache<BlockHash, EncodedBlock> blocks_;
+  };
+
+  /**
+   * Limits number of concurrent streams served to each peer by block and
+   * state protocols, so few syncing peers can't keep io thread busy with
+   * responses.
+   * Used from io thread only.
+   */
+  class ServedStreams {
+   public:
+    /// Our own client opens up to 2 blocks by root, 1 blocks by range and
+    /// 1 state streams to peer, and keeps spare stream of each protocol
+    static constexpr size_t kMaxStreamsPerPeer = 8;
+
+    /// Releases stream slot of peer when destroyed
+    using Slot = std::shared_ptr<void>;
+
+    /// Slot for stream, or std::nullopt when peer has too many streams
+    std::optional<Slot> acquire(const libp2p::PeerId &peer_id);
+
+   private:
+    std::unordered_map<libp2p::PeerId, size_t> streams_;
+  };
+
+  /**
+   * Blocks by root request-response protocol.
+   * Responds with known blocks of requested roots, one response chunk per
+   * block.
+   */
   class BlockRequestProtocol
       : public std::enable_shared_from_this<BlockRequestProtocol>,
         public libp2p::protocol::BaseProtocol {
    public:
+    static constexpr std::string_view kProtocolId =
+        "/leanconsensus/req/blocks_by_root/1/ssz_snappy";
+    static constexpr auto kTrafficProtocol =
+        TrafficShaper::Protocol::BlocksByRoot;
+    /// Up to `MAX_REQUEST_BLOCKS` blocks
+    static constexpr std::chrono::seconds kResponseTimeout{10};
+
     BlockRequestProtocol(std::shared_ptr<boost::asio::io_context> io_context,
                          std::shared_ptr<libp2p::host::BasicHost> host,
-                         qtils::SharedRef<blockchain::BlockTree> block_tree);
+                         qtils::SharedRef<blockchain::BlockTree> block_tree,
+                         qtils::SharedRef<EncodedBlockCache> encoded_blocks,
+                         qtils::SharedRef<ServedStreams> served_streams,
+                         qtils::SharedRef<StreamPool> stream_pool,
+                         qtils::SharedRef<TrafficShaper> traffic,
+                         qtils::SharedRef<ReqRespMetrics> metrics);
+
+    // BaseProtocol
+    libp2p::StreamProtocols getProtocolIds() const override;
+    void handle(std::shared_ptr<libp2p::Stream> stream) override;
+
+    void start();
+
+    /**
+     * Request all `request.roots` in single stream.
+     * Unknown to peer blocks are missing in response.
+     */
+    libp2p::CoroOutcome<std::vector<BlockResponse>> request(
+        libp2p::PeerId peer_id, BlockRequest request);
+
+   private:
+    libp2p::CoroOutcome<void> coroRespond(
+        std::shared_ptr<libp2p::Stream> stream);
+
+    std::shared_ptr<boost::asio::io_context> io_context_;
+    std::shared_ptr<libp2p::host::BasicHost> host_;
+    qtils::SharedRef<blockchain::BlockTree> block_tree_;
+    qtils::SharedRef<EncodedBlockCache> encoded_blocks_;
+    qtils::SharedRef<ServedStreams> served_streams_;
+    /// Pre-negotiated streams of requests
+    qtils::SharedRef<StreamPool> stream_pool_;
+    qtils::SharedRef<TrafficShaper> traffic_;
+    qtils::SharedRef<ReqRespMetrics> metrics_;
+  };
+
+  /**
+   * Blocks by slot range request-response protocol.
+   * Responds with blocks of best chain in ascending slot order.
+   * Used to catch up quickly when peer is far ahead.
+   */
+  class BlockRangeRequestProtocol
+      : public std::enable_shared_from_this<BlockRangeRequestProtocol>,
+        public libp2p::protocol::BaseProtocol {
+   public:
+    static constexpr std::string_view kProtocolId =
+        "/leanconsensus/req/blocks_by_range/1/ssz_snappy";
+    static constexpr auto kTrafficProtocol =
+        TrafficShaper::Protocol::BlocksByRange;
+    /// Range sync batch may be throttled by peer upload limits
+    static constexpr std::chrono::seconds kResponseTimeout{30};
+
+    BlockRangeRequestProtocol(
+        std::shared_ptr<boost::asio::io_context> io_context,
+        std::shared_ptr<libp2p::host::BasicHost> host,
+        qtils::SharedRef<blockchain::BlockTree> block_tree,
+        qtils::SharedRef<EncodedBlockCache> encoded_blocks,
+        qtils::SharedRef<ServedStreams> served_streams,
+        qtils::SharedRef<StreamPool> stream_pool,
+        qtils::SharedRef<TrafficShaper> traffic,
+        qtils::SharedRef<ReqRespMetrics> metrics);
 
     // BaseProtocol
     libp2p::StreamProtocols getProtocolIds() const override;
@@ -40,8 +185,8 @@ namespace lean::modules {
 
     void start();
 
-    libp2p::CoroOutcome<BlockResponse> request(libp2p::PeerId peer_id,
-                                               BlockRequest request);
+    libp2p::CoroOutcome<std::vector<BlockResponse>> request(
+        libp2p::PeerId peer_id, BlocksByRangeRequest request);
 
    private:
     libp2p::CoroOutcome<void> coroRespond(
@@ -50,5 +195,11 @@ namespace lean::modules {
     std::shared_ptr<boost::asio::io_context> io_context_;
     std::shared_ptr<libp2p::host::BasicHost> host_;
     qtils::SharedRef<blockchain::BlockTree> block_tree_;
+    qtils::SharedRef<EncodedBlockCache> encoded_blocks_;
+    qtils::SharedRef<ServedStreams> served_streams_;
+    /// Pre-negotiated streams of requests
+    qtils::SharedRef<StreamPool> stream_pool_;
+    qtils::SharedRef<TrafficShaper> traffic_;
+    qtils::SharedRef<ReqRespMetrics> metrics_;
   };
 }  // namespace lean::modules
@@ -0,0 +1,64 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "modules/networking/types.hpp"
+#include "serde/snappy.hpp"
+#include "types/signed_aggregated_attestation.hpp"
+#include "types/signed_attestation.hpp"
+
+namespace lean {
+  /// SSZ offset of variable size field
+  constexpr size_t kSszOffsetSize = 4;
+
+  /**
+   * Largest uncompressed SSZ of message type accepted from peers.
+   * Checked against declared snappy length before buffer is allocated, so
+   * peer can't make node allocate more than message could take. SSZ list
+   * lengths come from offsets within that buffer, so decoded lists are
+   * bounded by budget too, not by type limits.
+   * Size of fixed containers is bounded by `sizeof`.
+   */
+  template <typename T>
+  constexpr size_t kDecodeBudget = snappy::kDefaultMaxSize;
+
+  template <>
+  constexpr size_t kDecodeBudget<StatusMessage> = sizeof(StatusMessage);
+
+  template <>
+  constexpr size_t kDecodeBudget<BlockRequest> =
+      kSszOffsetSize + MAX_REQUEST_BLOCKS * sizeof(BlockHash);
+
+  template <>
+  constexpr size_t kDecodeBudget<BlocksByRangeRequest> =
+      sizeof(BlocksByRangeRequest);
+
+  template <>
+  constexpr size_t kDecodeBudget<StateRequest> = sizeof(StateRequest);
+
+  template <>
+  constexpr size_t kDecodeBudget<StateResponse> =
+      2 * sizeof(uint64_t) + kSszOffsetSize + MAX_STATE_CHUNK_SIZE;
+
+  template <>
+  constexpr size_t kDecodeBudget<PeerExchangeRequest> =
+      sizeof(PeerExchangeRequest);
+
+  template <>
+  constexpr size_t kDecodeBudget<PeerExchangeResponse> =
+      kSszOffsetSize
+      + (MAX_PEER_EXCHANGE_PEERS + 1)
+            * (3 * kSszOffsetSize + 64 + 256 + sizeof(SubnetBits) + 1);
+
+  template <>
+  constexpr size_t kDecodeBudget<SignedAttestation> = sizeof(SignedAttestation);
+
+  template <>
+  constexpr size_t kDecodeBudget<SignedAggregatedAttestation> =
+      sizeof(AttestationData) + 3 * kSszOffsetSize
+      + VALIDATOR_REGISTRY_LIMIT / 8 + 1 + kMaxLeanAggregatedSignatureSize;
+}  // namespace lean
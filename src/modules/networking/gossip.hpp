@@ -0,0 +1,58 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <format>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <boost/endian/conversion.hpp>
+#include <libp2p/crypto/sha/sha256.hpp>
+#include <libp2p/protocol/gossip/gossip.hpp>
+#include <qtils/byte_arr.hpp>
+
+namespace lean::modules {
+  /// Full gossip topic of message `type`, e.g. "block" or "attestation_0"
+  inline std::string gossipTopic(std::string_view type) {
+    return std::format("/leanconsensus/12345678/{}/ssz_snappy", type);
+  }
+
+  /// Hash topic prefixed by its size
+  inline void gossipHashTopic(libp2p::crypto::Sha256 &hasher,
+                              qtils::BytesIn topic) {
+    qtils::ByteArr<sizeof(uint64_t)> size;
+    boost::endian::store_little_u64(size.data(), topic.size());
+    hasher.write(size).value();
+    hasher.write(topic).value();
+  }
+
+  /**
+   * Message id of lean gossip, first 20 bytes of sha256 of domain, topic and
+   * uncompressed data, or of compressed data if it isn't valid snappy.
+   * @param uncompressed data of message, nullopt if it failed to uncompress
+   */
+  inline libp2p::protocol::gossip::MessageId gossipMessageId(
+      const libp2p::protocol::gossip::Message &message,
+      std::optional<qtils::BytesIn> uncompressed) {
+    constexpr qtils::ByteArr<4> MESSAGE_DOMAIN_INVALID_SNAPPY{0, 0, 0, 0};
+    constexpr qtils::ByteArr<4> MESSAGE_DOMAIN_VALID_SNAPPY{1, 0, 0, 0};
+    libp2p::crypto::Sha256 hasher;
+    if (uncompressed.has_value()) {
+      gossipHashTopic(hasher, message.topic);
+      hasher.write(MESSAGE_DOMAIN_VALID_SNAPPY).value();
+      hasher.write(*uncompressed).value();
+    } else {
+      hasher.write(MESSAGE_DOMAIN_INVALID_SNAPPY).value();
+      gossipHashTopic(hasher, message.topic);
+      hasher.write(message.data).value();
+    }
+    auto hash = hasher.digest().value();
+    hash.resize(20);
+    return hash;
+  }
+}  // namespace lean::modules
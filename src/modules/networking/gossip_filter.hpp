@@ -0,0 +1,202 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <string_view>
+#include <vector>
+
+#include "blockchain/validator_subnet.hpp"
+#include "serde/serialization.hpp"
+#include "types/signed_aggregated_attestation.hpp"
+#include "types/signed_attestation.hpp"
+
+namespace lean::modules {
+  /**
+   * Cheap checks of gossip attestations before fork choice.
+   *
+   * Rejects without store lock and signature verification:
+   * - inconsistent checkpoints,
+   * - attestations from subnets node doesn't subscribe to,
+   * - attestations older than finalized slot,
+   * - attestations already accepted from validator for slot, by per-slot
+   *   bitset of validators, and aggregations of already accepted
+   *   participants.
+   *
+   * Messages are marked seen only after fork choice accepted them, so invalid
+   * copy can't shadow valid one. Copies of aggregation arriving while it is
+   * verified wait for its result.
+   */
+  class GossipFilter {
+   public:
+    enum class Verdict {
+      Accept,
+      Invalid,
+      WrongSubnet,
+      Stale,
+      Duplicate,
+    };
+
+    static std::string_view name(Verdict verdict) {
+      switch (verdict) {
+        case Verdict::Accept:
+          return "accept";
+        case Verdict::Invalid:
+          return "invalid";
+        case Verdict::WrongSubnet:
+          return "wrong subnet";
+        case Verdict::Stale:
+          return "stale";
+        case Verdict::Duplicate:
+          return "duplicate";
+      }
+      abort();
+    }
+
+    explicit GossipFilter(uint64_t subnet_count)
+        : subnet_count_{subnet_count} {}
+
+    /// Subnets attestations are accepted from
+    void setSubnets(std::set<SubnetIndex> subnets) {
+      subnets_ = std::move(subnets);
+    }
+
+    Verdict check(const SignedAttestation &signed_attestation,
+                  Slot finalized_slot) {
+      auto verdict = checkData(signed_attestation.data, finalized_slot);
+      if (verdict != Verdict::Accept) {
+        return verdict;
+      }
+      auto subnet =
+          validatorSubnet(signed_attestation.validator_id, subnet_count_);
+      if (not subnets_.contains(subnet)) {
+        return Verdict::WrongSubnet;
+      }
+      auto it = seen_attestations_.find(signed_attestation.data.slot);
+      if (it != seen_attestations_.end()) {
+        auto &seen = it->second;
+        auto validator = signed_attestation.validator_id;
+        if (validator < seen.size() and seen[validator]) {
+          return Verdict::Duplicate;
+        }
+      }
+      return Verdict::Accept;
+    }
+
+    Verdict check(
+        const SignedAggregatedAttestation &signed_aggregated_attestation,
+        Slot finalized_slot) {
+      auto &data = signed_aggregated_attestation.data;
+      auto verdict = checkData(data, finalized_slot);
+      if (verdict != Verdict::Accept) {
+        return verdict;
+      }
+      auto it = seen_aggregations_.find({data.slot, sszHash(data)});
+      if (it != seen_aggregations_.end()) {
+        for (auto &participants : it->second) {
+          if (signed_aggregated_attestation.proof.participants.isSubsetOf(
+                  participants)) {
+            return Verdict::Duplicate;
+          }
+        }
+      }
+      return Verdict::Accept;
+    }
+
+    void markSeen(const SignedAttestation &signed_attestation) {
+      auto &seen = seen_attestations_[signed_attestation.data.slot];
+      auto validator = signed_attestation.validator_id;
+      if (validator >= seen.size()) {
+        seen.resize(validator + 1);
+      }
+      seen[validator] = true;
+    }
+
+    void markSeen(
+        const SignedAggregatedAttestation &signed_aggregated_attestation) {
+      auto &data = signed_aggregated_attestation.data;
+      seen_aggregations_[{data.slot, sszHash(data)}].emplace_back(
+          signed_aggregated_attestation.proof.participants);
+    }
+
+    /**
+     * Start verification of aggregation, unless copy with same participants
+     * of same data is verified already. Then aggregation waits for result
+     * of that copy instead of being verified again.
+     * @return false if aggregation waits for copy
+     */
+    bool beginVerification(
+        const SignedAggregatedAttestation &signed_aggregated_attestation) {
+      auto [it, inserted] = verifying_aggregations_.try_emplace(
+          verifyingKey(signed_aggregated_attestation));
+      if (not inserted) {
+        it->second.emplace_back(signed_aggregated_attestation);
+      }
+      return inserted;
+    }
+
+    /**
+     * End verification started by `beginVerification`.
+     * @return copies waited for it, to be verified if it failed
+     */
+    std::vector<SignedAggregatedAttestation> endVerification(
+        const SignedAggregatedAttestation &signed_aggregated_attestation) {
+      auto node = verifying_aggregations_.extract(
+          verifyingKey(signed_aggregated_attestation));
+      if (not node) {
+        return {};
+      }
+      return std::move(node.mapped());
+    }
+
+   private:
+    using VerifyingKey = std::pair<BlockHash, BlockHash>;
+
+    static VerifyingKey verifyingKey(
+        const SignedAggregatedAttestation &signed_aggregated_attestation) {
+      return {sszHash(signed_aggregated_attestation.data),
+              sszHash(signed_aggregated_attestation.proof.participants)};
+    }
+
+    Verdict checkData(const AttestationData &data, Slot finalized_slot) {
+      if (data.source.slot > data.target.slot
+          or data.head.slot < data.target.slot) {
+        return Verdict::Invalid;
+      }
+      if (data.slot < finalized_slot) {
+        return Verdict::Stale;
+      }
+      prune(finalized_slot);
+      return Verdict::Accept;
+    }
+
+    /// Forget slots before finalized, they are rejected as stale anyway
+    void prune(Slot finalized_slot) {
+      if (finalized_slot <= pruned_slot_) {
+        return;
+      }
+      pruned_slot_ = finalized_slot;
+      seen_attestations_.erase(seen_attestations_.begin(),
+                               seen_attestations_.lower_bound(finalized_slot));
+      seen_aggregations_.erase(
+          seen_aggregations_.begin(),
+          seen_aggregations_.lower_bound({finalized_slot, BlockHash{}}));
+    }
+
+    uint64_t subnet_count_;
+    std::set<SubnetIndex> subnets_;
+    Slot pruned_slot_ = 0;
+    /// Bit per validator index, by slot
+    std::map<Slot, std::vector<bool>> seen_attestations_;
+    std::map<std::pair<Slot, BlockHash>, std::vector<AggregationBits>>
+        seen_aggregations_;
+    /// Copies waiting for aggregation being verified, by data and participants
+    std::map<VerifyingKey, std::vector<SignedAggregatedAttestation>>
+        verifying_aggregations_;
+  };
+}  // namespace lean::modules
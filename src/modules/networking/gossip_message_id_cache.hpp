@@ -0,0 +1,53 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <deque>
+#include <unordered_map>
+
+#include <qtils/bytes.hpp>
+
+namespace lean::modules {
+  /**
+   * Ids of recently seen gossip messages by hash of their raw bytes.
+   *
+   * Most gossip messages are duplicates of message received from other mesh
+   * peer. Message id is hash of uncompressed payload, so computing it
+   * requires uncompressing. Cache is looked up by cryptographic hash of
+   * topic and compressed bytes first, so id of duplicate is found without
+   * uncompressing it. Oldest ids are evicted first.
+   * Not thread safe, intended to be used as `thread_local`.
+   */
+  template <typename Id>
+  class GossipMessageIdCache {
+   public:
+    using Key = qtils::ByteArr<32>;
+
+    static constexpr size_t kEntries = 4096;
+
+    /// Id of message with raw hash `key`, nullptr if not seen recently
+    const Id *find(const Key &key) const {
+      auto it = ids_.find(key);
+      return it == ids_.end() ? nullptr : &it->second;
+    }
+
+    void insert(const Key &key, Id id) {
+      if (not ids_.emplace(key, std::move(id)).second) {
+        return;
+      }
+      order_.emplace_back(key);
+      if (order_.size() > kEntries) {
+        ids_.erase(order_.front());
+        order_.pop_front();
+      }
+    }
+
+   private:
+    std::unordered_map<Key, Id> ids_;
+    std::deque<Key> order_;
+  };
+}  // namespace lean::modules
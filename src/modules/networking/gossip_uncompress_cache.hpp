@@ -0,0 +1,75 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+
+#include "modules/networking/decode_budget.hpp"
+#include "serde/serialization.hpp"
+#include "serde/snappy.hpp"
+
+namespace lean::modules {
+  /**
+   * Recently uncompressed gossip messages.
+   *
+   * Gossip uncompresses message for message id, and then again for decoding.
+   * Cache keeps few last results so second uncompress is lookup.
+   * Buffers are reused, so steady traffic doesn't allocate.
+   * Not thread safe, intended to be used as `thread_local`.
+   */
+  class GossipUncompressCache {
+   public:
+    static constexpr size_t kEntries = 8;
+
+    /**
+     * Uncompress `compressed` or return cached result.
+     * Returned bytes are valid until `kEntries` other messages are
+     * uncompressed.
+     * @param max_size limit of uncompressed size, also of cached result
+     */
+    outcome::result<qtils::BytesIn> uncompress(
+        qtils::BytesIn compressed, size_t max_size = snappy::kDefaultMaxSize) {
+      auto it = std::ranges::find_if(entries_, [&](const Entry &entry) {
+        return entry.valid and qtils::ByteView{entry.compressed} == compressed;
+      });
+      if (it != entries_.end()) {
+        if (it->uncompressed.size() > max_size) {
+          return snappy::SnappyError::UNCOMPRESS_TOO_LONG;
+        }
+        return it->uncompressed;
+      }
+      auto &entry = entries_[next_];
+      next_ = (next_ + 1) % kEntries;
+      entry.valid = false;
+      BOOST_OUTCOME_TRY(
+          snappy::uncompressInto(compressed, entry.uncompressed, max_size));
+      entry.compressed.assign(compressed.begin(), compressed.end());
+      entry.valid = true;
+      return entry.uncompressed;
+    }
+
+    /// Same as `lean::decodeSszSnappy`, but uncompresses through cache
+    template <typename T>
+    outcome::result<std::pair<T, size_t>> decodeSszSnappy(
+        qtils::BytesIn compressed, size_t max_size = kDecodeBudget<T>) {
+      BOOST_OUTCOME_TRY(auto uncompressed, uncompress(compressed, max_size));
+      BOOST_OUTCOME_TRY(auto decoded, decode<T>(uncompressed));
+      return std::make_pair(std::move(decoded), uncompressed.size());
+    }
+
+   private:
+    struct Entry {
+      bool valid = false;
+      qtils::ByteVec compressed;
+      qtils::ByteVec uncompressed;
+    };
+
+    std::array<Entry, kEntries> entries_;
+    size_t next_ = 0;
+  };
+}  // namespace lean::modules
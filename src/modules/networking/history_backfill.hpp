@@ -0,0 +1,144 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <ranges>
+#include <unordered_set>
+#include <vector>
+
+#include <libp2p/peer/peer_id.hpp>
+
+#include "blockchain/block_storage.hpp"
+#include "modules/networking/traffic_shaper.hpp"
+#include "modules/networking/types.hpp"
+#include "types/constants.hpp"
+#include "types/signed_block.hpp"
+
+namespace lean::modules {
+  /**
+   * Download of finalized history behind checkpoint sync anchor, backwards
+   * from anchor by slot ranges.
+   * Ranges are linked by parent hashes to block we miss, signatures are not
+   * verified, as history is finalized and block hash covers body.
+   * Range of skipped slots only is empty, so window grows until range
+   * reaches missing block, peer which responds with empty range of max
+   * window doesn't keep history.
+   * Fetched bytes take tokens of budget, next range waits for them.
+   * Not thread safe, used from io thread.
+   */
+  class HistoryBackfill {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Slots of first range, blocks with signatures are large
+    static constexpr uint64_t kInitialWindow = 64;
+
+    /// @param rate budget in bytes per second, 0 is unlimited
+    HistoryBackfill(std::optional<blockchain::BackfillCursor> cursor,
+                    uint64_t rate,
+                    Clock::time_point now)
+        : cursor_{std::move(cursor)}, budget_{rate, now}, ready_at_{now} {
+      finishAtGenesis();
+    }
+
+    /// Next missing block, nullopt when history is complete
+    const std::optional<blockchain::BackfillCursor> &cursor() const {
+      return cursor_;
+    }
+
+    /// Whether next range may be requested now
+    bool ready(Clock::time_point now) const {
+      return cursor_.has_value() and not in_flight_ and now >= ready_at_;
+    }
+
+    /// Peer which may have missing block, @return false to skip peer
+    bool canServe(const libp2p::PeerId &peer_id) const {
+      return not no_history_.contains(peer_id);
+    }
+
+    /// Range of slots before cursor
+    BlocksByRangeRequest begin() {
+      in_flight_ = true;
+      auto before = cursor_->before;
+      auto start = before > window_ + 1 ? before - window_ : 1;
+      return {.start_slot = start, .count = before - start};
+    }
+
+    /// Request failed, range is requested again from other peer
+    void onFailure(const libp2p::PeerId &peer_id) {
+      in_flight_ = false;
+      no_history_.emplace(peer_id);
+    }
+
+    /**
+     * Take blocks of range linked to missing block, in descending slot
+     * order, and move cursor behind them.
+     * @return linked blocks to store with new cursor, or empty
+     */
+    std::vector<SignedBlock> onResponse(const libp2p::PeerId &peer_id,
+                                        std::vector<SignedBlock> blocks,
+                                        Clock::time_point now) {
+      in_flight_ = false;
+      size_t bytes = 0;
+      for (auto &block : blocks) {
+        bytes += ssz::size(block);
+      }
+      ready_at_ = now + budget_.take(bytes, now);
+      if (blocks.empty()) {
+        if (window_ >= MAX_REQUEST_BLOCKS) {
+          no_history_.emplace(peer_id);
+        } else {
+          window_ = std::min(window_ * 2, MAX_REQUEST_BLOCKS);
+        }
+        return {};
+      }
+      std::ranges::sort(blocks, std::ranges::greater{}, [](auto &block) {
+        return block.block.slot;
+      });
+      std::vector<SignedBlock> linked;
+      for (auto &block : blocks) {
+        block.block.setHash();
+        if (block.block.hash() != cursor_->hash
+            or block.block.slot >= cursor_->before) {
+          continue;
+        }
+        cursor_ = blockchain::BackfillCursor{
+            .hash = block.block.parent_root,
+            .before = block.block.slot,
+        };
+        linked.emplace_back(std::move(block));
+      }
+      if (linked.empty()) {
+        // Highest block of range is not ours, peer is on other chain
+        no_history_.emplace(peer_id);
+        return {};
+      }
+      window_ = kInitialWindow;
+      finishAtGenesis();
+      return linked;
+    }
+
+   private:
+    /// Genesis is stored as header only by all nodes, it can't be fetched
+    void finishAtGenesis() {
+      if (cursor_.has_value() and cursor_->before <= 1) {
+        cursor_.reset();
+      }
+    }
+
+    std::optional<blockchain::BackfillCursor> cursor_;
+    TokenBucket budget_;
+    Clock::time_point ready_at_;
+    uint64_t window_ = kInitialWindow;
+    bool in_flight_ = false;
+    /// Peers which don't keep history before cursor
+    std::unordered_set<libp2p::PeerId> no_history_;
+  };
+}  // namespace lean::modules
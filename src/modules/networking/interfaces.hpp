@@ -42,6 +42,8 @@ namespace lean::modules {
     virtual void onSendSignedAggregatedAttestation(
         std::shared_ptr<const messages::SendSignedAggregatedAttestation>
             message) = 0;
+    virtual void onSendGossipBatch(
+        std::shared_ptr<const messages::SendGossipBatch> message) = 0;
   };
 
 }  // namespace lean::modules
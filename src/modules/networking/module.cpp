@@ -9,6 +9,10 @@
 #define MODULE_C_API extern "C" __attribute__((visibility("default")))
 #define MODULE_API __attribute__((visibility("default")))
 
+namespace lean {
+  class Watchdog;
+}  // namespace lean
+
 namespace lean::app {
   class ChainSpec;
   class Configuration;
@@ -45,7 +49,8 @@ MODULE_C_API std::weak_ptr<lean::modules::Networking> query_module_instance(
     qtils::SharedRef<lean::ValidatorRegistry> validator_registry,
     qtils::SharedRef<lean::GenesisConfig> genesis_config,
     qtils::SharedRef<lean::app::ChainSpec> chain_spec,
-    qtils::SharedRef<lean::app::Configuration> app_config) {
+    qtils::SharedRef<lean::app::Configuration> app_config,
+    qtils::SharedRef<lean::Watchdog> watchdog) {
   if (!module_instance) {
     module_instance =
         lean::modules::NetworkingImpl::create_shared(loader,
@@ -57,7 +62,8 @@ MODULE_C_API std::weak_ptr<lean::modules::Networking> query_module_instance(
                                                      validator_registry,
                                                      genesis_config,
                                                      chain_spec,
-                                                     app_config);
+                                                     app_config,
+                                                     watchdog);
   }
   return module_instance;
 }
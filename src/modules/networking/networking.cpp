@@ -12,8 +12,10 @@
 #include <memory>
 #include <queue>
 #include <ranges>
+#include <span>
 #include <stdexcept>
 
+#include <boost/asio/steady_timer.hpp>
 #include <boost/endian/conversion.hpp>
 #include <libp2p/coro/spawn.hpp>
 #include <libp2p/coro/timer_loop.hpp>
@@ -28,71 +30,147 @@
 #include <libp2p/protocol/ping.hpp>
 #include <libp2p/transport/quic/transport.hpp>
 #include <libp2p/transport/tcp/tcp_util.hpp>
+#include <qtils/cxx23/ranges/contains.hpp>
 #include <qtils/to_shared_ptr.hpp>
 
 #include "app/build_version.hpp"
 #include "app/chain_spec.hpp"
 #include "app/configuration.hpp"
+#include "app/impl/watchdog.hpp"
 #include "blockchain/block_tree.hpp"
 #include "blockchain/fork_choice_mutex.hpp"
 #include "blockchain/genesis_config.hpp"
 #include "blockchain/validator_registry.hpp"
 #include "blockchain/validator_subnet.hpp"
 #include "lean_interop_test.hpp"
+#include "log/tracing.hpp"
 #include "metrics/metrics.hpp"
+#include "modules/networking/attestation_push_protocol.hpp"
 #include "modules/networking/block_request_protocol.hpp"
+#include "modules/networking/gossip.hpp"
+#include "modules/networking/gossip_message_id_cache.hpp"
+#include "modules/networking/gossip_uncompress_cache.hpp"
+#include "modules/networking/history_backfill.hpp"
+#include "modules/networking/peer_exchange.hpp"
+#include "modules/networking/peer_exchange_protocol.hpp"
+#include "modules/networking/req_resp_metrics.hpp"
 #include "modules/networking/ssz_snappy.hpp"
+#include "modules/networking/state_request_protocol.hpp"
 #include "modules/networking/status_protocol.hpp"
+#include "modules/networking/traffic_shaper.hpp"
 #include "modules/networking/types.hpp"
+#include "serde/parallel_hash.hpp"
 #include "ssl_context.hpp"
 #include "state_sync_client.hpp"
+#include "storage/spaced_storage.hpp"
+#include "types/block_view.hpp"
+#include "types/slot.hpp"
+#include "utils/thread_placement.hpp"
 
 namespace lean::modules {
   constexpr std::chrono::seconds kConnectToPeersTimer{5};
+  constexpr std::chrono::seconds kMemoryAccountingTimer{10};
+  /// Period of resubscribing attestation subnets, e.g. after aggregator
+  /// duty is toggled by API
+  constexpr std::chrono::seconds kAttestationSubnetsTimer{1};
   constexpr std::chrono::milliseconds kInitBackoff = std::chrono::seconds{10};
   constexpr std::chrono::milliseconds kMaxBackoff = std::chrono::minutes{5};
+  /// Idle connections without streams are closed after this time
+  constexpr std::chrono::seconds kNoStreamsInterval{10};
+  /// Period of status exchange with connected warm peers, shorter than
+  /// `kNoStreamsInterval`, so their connections are not idle
+  constexpr std::chrono::seconds kWarmPeerKeepAlive{4};
+  /// Backoff of warm peer after disconnect, to redial soon after it
+  /// restarts
+  constexpr std::chrono::milliseconds kWarmPeerBackoff =
+      std::chrono::seconds{1};
+  /// Period of peer exchange queries, while own subnets lack peers
+  constexpr std::chrono::seconds kDiscoveryTimer{5};
+  /// Connected peers wanted on each own subnet
+  constexpr size_t kDiscoverySubnetPeers = 4;
+  /// Peers queried by each discovery round
+  constexpr size_t kDiscoveryQueries = 2;
+  /// Discovery doesn't add peers once this many discovered ones are known
+  constexpr size_t kMaxDiscoveredPeers = 256;
+  /// Discovered peers known by advert of single responder
+  constexpr size_t kMaxDiscoveredPeersPerResponder = 16;
+  /// Discovered peer is forgotten after this many dial failures in a row
+  constexpr size_t kMaxDiscoveredPeerDialFailures = 3;
+  constexpr std::chrono::seconds kPeerStoreFlushTimer{30};
+  /// Period of checking whether next history range may be requested
+  constexpr std::chrono::seconds kBackfillTimer{1};
+  /// Slot phases free of block production, attestation and aggregation,
+  /// as in `StoragePruner::kFirstRelaxedPhase`
+  constexpr uint64_t kFirstBackfillPhase = 3;
+  /// Stored peers seen within this time are dialed first at start
+  constexpr std::chrono::milliseconds kPeerStoreMaxAge = std::chrono::hours{24};
+  /// Delay before racing next address of peer, as in happy eyeballs
+  constexpr std::chrono::milliseconds kAddressStagger{250};
+  /// Delay before dialing next bootstrap candidate, unless dial fails
+  constexpr std::chrono::milliseconds kBootstrapDialStagger{200};
+  /// Bootstrap is done when this many peers are connected, gossip mesh
+  /// degree
+  constexpr size_t kBootstrapMeshPeers = 8;
 
   constexpr auto kRetryRequestBlock = std::chrono::seconds{3};
+  /// Max number of block by root requests in flight to single peer
+  constexpr size_t kMaxBlockRequestsInFlightPerPeer = 2;
+  /// Use range sync when peer head is further ahead than this
+  constexpr Slot kRangeSyncDistance = 8;
+  /// Blocks per range request, blocks with signatures are large
+  constexpr uint64_t kRangeSyncBatch = 16;
+  /// Blocks per range request in bulk sync mode
+  constexpr uint64_t kBulkRangeSyncBatch = 64;
+  /// Max number of gossip attestations queued for verification on worker
+  /// pool, more are dropped instead of growing queue under flood
+  constexpr size_t kMaxGossipVerificationsInFlight = 4096;
+
+  /// Shared by message id function and topic decoding on io thread
+  GossipUncompressCache &gossipUncompressCache() {
+    thread_local GossipUncompressCache cache;
+    return cache;
+  }
 
-  template <typename T>
-  std::vector<typename T::mapped_type> consumeMultimap(
-      T &multimap, const typename T::key_type &key) {
-    auto [begin, end] = multimap.equal_range(key);
-    std::vector<typename T::mapped_type> vector;
-    for (auto &value : std::ranges::subrange{begin, end} | std::views::values) {
-      vector.emplace_back(value);
-    }
-    multimap.erase(begin, end);
-    return vector;
+  /// Bit of subnet in ENR `attnets`, subnets after 64th are not advertised
+  SubnetBits subnetBit(SubnetIndex subnet) {
+    return subnet < 64 ? SubnetBits{1} << subnet : 0;
+  }
+
+  SubnetBits subnetBits(const std::set<SubnetIndex> &subnets) {
+    SubnetBits bits = 0;
+    for (auto subnet : subnets) {
+      bits |= subnetBit(subnet);
+    }
+    return bits;
   }
 
-  inline auto gossipTopic(std::string_view type) {
-    return std::format("/leanconsensus/12345678/{}/ssz_snappy", type);
+  using GossipIdCache =
+      GossipMessageIdCache<libp2p::protocol::gossip::MessageId>;
+
+  GossipIdCache &gossipIdCache() {
+    thread_local GossipIdCache cache;
+    return cache;
   }
 
   libp2p::protocol::gossip::MessageId gossipMessageId(
       const libp2p::protocol::gossip::Message &message) {
-    constexpr qtils::ByteArr<4> MESSAGE_DOMAIN_INVALID_SNAPPY{0, 0, 0, 0};
-    constexpr qtils::ByteArr<4> MESSAGE_DOMAIN_VALID_SNAPPY{1, 0, 0, 0};
-    libp2p::crypto::Sha256 hasher;
-    auto hash_topic = [&] {
-      qtils::ByteArr<sizeof(uint64_t)> size;
-      boost::endian::store_little_u64(size.data(), message.topic.size());
-      hasher.write(size).value();
-      hasher.write(message.topic).value();
-    };
-    if (auto uncompressed_res = snappy::uncompress(message.data)) {
-      auto &uncompressed = uncompressed_res.value();
-      hash_topic();
-      hasher.write(MESSAGE_DOMAIN_VALID_SNAPPY).value();
-      hasher.write(uncompressed).value();
-    } else {
-      hasher.write(MESSAGE_DOMAIN_INVALID_SNAPPY).value();
-      hash_topic();
-      hasher.write(message.data).value();
+    // Duplicate is found by hash of raw bytes, without uncompressing
+    libp2p::crypto::Sha256 raw_hasher;
+    gossipHashTopic(raw_hasher, message.topic);
+    raw_hasher.write(message.data).value();
+    auto raw_hash =
+        GossipIdCache::Key::fromSpan(raw_hasher.digest().value()).value();
+    if (auto id = gossipIdCache().find(raw_hash)) {
+      return *id;
     }
-    auto hash = hasher.digest().value();
-    hash.resize(20);
+
+    std::optional<qtils::BytesIn> uncompressed;
+    if (auto uncompressed_res =
+            gossipUncompressCache().uncompress(message.data)) {
+      uncompressed = uncompressed_res.value();
+    }
+    auto hash = modules::gossipMessageId(message, uncompressed);
+    gossipIdCache().insert(raw_hash, hash);
     return hash;
   }
 
@@ -106,7 +184,9 @@ namespace lean::modules {
       qtils::SharedRef<ValidatorRegistry> validator_registry,
       qtils::SharedRef<GenesisConfig> genesis_config,
       qtils::SharedRef<app::ChainSpec> chain_spec,
-      qtils::SharedRef<app::Configuration> config)
+      qtils::SharedRef<app::Configuration> config,
+      qtils::SharedRef<Watchdog> watchdog,
+      qtils::SharedRef<storage::SpacedStorage> storage)
       : loader_(loader),
         logger_(logging_system->getLogger("Networking", "networking_module")),
         metrics_{std::move(metrics)},
@@ -117,7 +197,11 @@ namespace lean::modules {
         genesis_config_{std::move(genesis_config)},
         chain_spec_{std::move(chain_spec)},
         config_{std::move(config)},
+        watchdog_{std::move(watchdog)},
+        traffic_{
+            std::make_shared<TrafficShaper>(*metrics_, config_->network())},
         random_{std::random_device{}()},
+        peer_store_{storage->getSpace(storage::Space::Peer)},
         subnet_count_{config_->cliSubnetCount()} {
     libp2p::log::setLoggingSystem(logging_system->getSoralog());
   }
@@ -140,17 +224,18 @@ namespace lean::modules {
         std::make_shared<libp2p::crypto::marshaller::KeyMarshaller>(nullptr)};
     auto peer_id = identity_manager.getId();
 
-    std::unordered_set<SubnetIndex> subnets;
-    for (auto &validator_index :
-         validator_registry_->currentValidatorIndices()) {
-      subnets.emplace(validatorSubnet(validator_index, subnet_count_));
+    auto own_subnets =
+        attestationSubnets(validator_registry_->currentValidatorIndices(),
+                           subnet_count_,
+                           false,
+                           {});
+    auto subnets = wantedAttestationSubnets();
+    gossip_filter_.emplace(subnet_count_);
+
+    if (not own_subnets.empty()) {
+      metrics_->lean_attestation_committee_subnet()->set(
+          *own_subnets.begin());
     }
-    if (subnets.size() != 1) {
-      SL_FATAL(logger_, "multiple validators on same node are not supported");
-    }
-    auto subnet_id = *subnets.begin();
-
-    metrics_->lean_attestation_committee_subnet()->set(subnet_id);
     metrics_->lean_attestation_committee_count()->set(subnet_count_);
 
     SL_INFO(logger_, "Networking loaded with PeerId {}", peer_id.toBase58());
@@ -173,15 +258,18 @@ namespace lean::modules {
           message.data.size());
       return gossipMessageId(message);
     };
-    gossip_config.protocol_versions.erase(
-        libp2p::protocol::gossip::kProtocolGossipsubv1_2);
+    // Gossipsub v1.2 is kept enabled: on receiving large message, e.g.
+    // block, IDONTWANT with its id is sent to mesh peers before validation,
+    // so they don't forward duplicates of it. Id is computed once per
+    // message, uncompressed data is reused by decoding via
+    // `gossipUncompressCache`.
 
     // Use a shorter no-streams interval to close idle connections faster.
     // This helps nodes rejoin the gossip mesh more quickly after a restart,
     // especially if they reconnect before the old connection on the peer's side
     // has timed out.
     libp2p::muxer::MuxedConnectionConfig mux_config;
-    mux_config.no_streams_interval = std::chrono::seconds{10};
+    mux_config.no_streams_interval = kNoStreamsInterval;
 
     auto identify_config = std::make_shared<libp2p::protocol::IdentifyConfig>();
     identify_config->agent_version = "qlean/" + buildVersion();
@@ -268,9 +356,20 @@ namespace lean::modules {
         if (bootnode.peer_id == peer_id) {
           continue;
         }
-        if (bootnode.is_aggregator
-            and subnets.contains(
-                validatorSubnet(validator_index, subnet_count_))) {
+        auto aggregator_subnet =
+            validatorSubnet(validator_index, subnet_count_);
+        if (bootnode.is_aggregator) {
+          aggregators_by_subnet_.emplace(aggregator_subnet, bootnode.peer_id);
+        }
+        warm_peers_.emplace(bootnode.peer_id);
+        peer_roles_.emplace(
+            bootnode.peer_id,
+            PeerRole{
+                .subnets = bootnode.attnets.value_or(
+                    subnetBit(aggregator_subnet)),
+                .is_aggregator = bootnode.is_aggregator,
+            });
+        if (bootnode.is_aggregator and subnets.contains(aggregator_subnet)) {
           subnet_aggregators_.emplace(bootnode.peer_id);
         } else {
           connectable_peers_.emplace_back(bootnode.peer_id);
@@ -314,6 +413,13 @@ namespace lean::modules {
                   result.error());
         }
       }
+    } else {
+      SL_DEBUG(logger_, "No bootnodes configured");
+    }
+
+    restorePeers(peer_id);
+    startBootstrap();
+    if (not peer_states_.empty()) {
       libp2p::timerLoop(
           *io_context_, kConnectToPeersTimer, [weak_self{weak_from_this()}] {
             auto self = weak_self.lock();
@@ -323,9 +429,34 @@ namespace lean::modules {
             self->connectToPeers();
             return true;
           });
-    } else {
-      SL_DEBUG(logger_, "No bootnodes configured");
+      libp2p::timerLoop(
+          *io_context_, kWarmPeerKeepAlive, [weak_self{weak_from_this()}] {
+            auto self = weak_self.lock();
+            if (not self) {
+              return false;
+            }
+            self->keepWarmPeersAlive();
+            return true;
+          });
+      libp2p::timerLoop(
+          *io_context_, kDiscoveryTimer, [weak_self{weak_from_this()}] {
+            auto self = weak_self.lock();
+            if (not self) {
+              return false;
+            }
+            self->discoverPeers();
+            return true;
+          });
     }
+    libp2p::timerLoop(
+        *io_context_, kPeerStoreFlushTimer, [weak_self{weak_from_this()}] {
+          auto self = weak_self.lock();
+          if (not self) {
+            return false;
+          }
+          self->flushPeers();
+          return true;
+        });
 
     // Restore peer connection handlers and protocol startup
     auto on_peer_connected = [host, weak_self{weak_from_this()}](
@@ -376,11 +507,17 @@ namespace lean::modules {
           }
           // Connectable | Connecting | Backoff => Connected
           state.state = PeerState::Connected{};
+          if (auto discovered_it = self->discovered_peers_.find(peer_id);
+              discovered_it != self->discovered_peers_.end()) {
+            discovered_it->second.dial_failures = 0;
+          }
           SL_INFO(
               self->logger_, "Peer {} marked Connected", peer_id.toBase58());
         }
       }
+      self->peer_scores_.add(peer_id);
       self->updateMetricConnectedPeerCount();
+      self->onBootstrapPeerConnected();
       self->loader_.dispatch_peer_connected(
           qtils::toSharedPtr(messages::PeerConnectedMessage{peer_id}));
       if (connection->isInitiator()) {
@@ -438,7 +575,8 @@ namespace lean::modules {
       if (state_it != self->peer_states_.end()) {
         auto &state = state_it->second;
         if (std::holds_alternative<PeerState::Connected>(state.state)) {
-          auto backoff = kInitBackoff;
+          auto warm = self->warm_peers_.contains(peer_id);
+          auto backoff = warm ? kWarmPeerBackoff : kInitBackoff;
           SL_DEBUG(
               self->logger_,
               "Peer {} state transition: Connected -> Backoff (backoff={}ms)",
@@ -452,12 +590,23 @@ namespace lean::modules {
           };
           SL_DEBUG(
               self->logger_, "Peer {} backoff_until set", peer_id.toBase58());
+          self->scheduleBackoff(peer_id, backoff);
         }
       } else {
         SL_DEBUG(self->logger_,
                  "on_peer_disconnected: unknown peer {}",
                  peer_id.toBase58());
       }
+      self->queued_block_requests_.erase(peer_id);
+      self->rememberPeer(peer_id);
+      self->peer_scores_.remove(peer_id);
+      if (auto traffic = self->traffic_->remove(peer_id)) {
+        SL_DEBUG(self->logger_,
+                 "Peer {} traffic: received {} bytes, sent {} bytes",
+                 peer_id.toBase58(),
+                 traffic->in,
+                 traffic->out);
+      }
       self->host_->getPeerRepository().getUserAgentRepository().updateTtl(
           peer_id, libp2p::peer::ttl::kTransient);
       self->updateMetricConnectedPeerCount();
@@ -509,6 +658,16 @@ namespace lean::modules {
             .getChannel<libp2p::event::network::OnConnectionClosedChannel>()
             .subscribe(on_connection_closed);
 
+    auto req_resp_metrics = [&](std::string protocol) {
+      return std::make_shared<ReqRespMetrics>(
+          metrics_,
+          std::move(protocol),
+          [weak_self{weak_from_this()}](const libp2p::PeerId &peer_id) {
+            auto self = weak_self.lock();
+            return self ? self->peerClient(peer_id) : "unknown";
+          });
+    };
+
     status_protocol_ = std::make_shared<StatusProtocol>(
         io_context_,
         host,
@@ -526,13 +685,128 @@ namespace lean::modules {
             return;
           }
           self->receiveStatus(message);
-        });
+        },
+        req_resp_metrics("status"));
     status_protocol_->start();
 
-    block_request_protocol_ =
-        std::make_shared<BlockRequestProtocol>(io_context_, host, block_tree_);
+    encoded_blocks_ = std::make_shared<EncodedBlockCache>();
+    auto served_streams = std::make_shared<ServedStreams>();
+    auto stream_pool = [&](std::string_view protocol_id,
+                           std::string_view protocol) {
+      auto label = [&](std::string_view reused) {
+        return metrics::Labels{{"protocol", std::string{protocol}},
+                               {"reused", std::string{reused}}};
+      };
+      return std::make_shared<StreamPool>(
+          io_context_,
+          host,
+          libp2p::StreamProtocols{std::string{protocol_id}},
+          metrics_->lean_req_streams(label("false")),
+          metrics_->lean_req_streams(label("true")),
+          metrics_->lean_req_stream_setup_time_seconds(
+              {{"protocol", std::string{protocol}}}));
+    };
+
+    block_request_protocol_ = std::make_shared<BlockRequestProtocol>(
+        io_context_,
+        host,
+        block_tree_,
+        encoded_blocks_,
+        served_streams,
+        stream_pool(BlockRequestProtocol::kProtocolId, "blocks_by_root"),
+        traffic_,
+        req_resp_metrics("blocks_by_root"));
     block_request_protocol_->start();
 
+    block_range_request_protocol_ = std::make_shared<BlockRangeRequestProtocol>(
+        io_context_,
+        host,
+        block_tree_,
+        encoded_blocks_,
+        served_streams,
+        stream_pool(BlockRangeRequestProtocol::kProtocolId, "blocks_by_range"),
+        traffic_,
+        req_resp_metrics("blocks_by_range"));
+    block_range_request_protocol_->start();
+
+    state_request_protocol_ = std::make_shared<StateRequestProtocol>(
+        io_context_,
+        host,
+        block_tree_,
+        [fork_choice_store{fork_choice_store_}](const BlockHash &block_hash) {
+          return fork_choice_store->getState(block_hash);
+        },
+        served_streams,
+        stream_pool(StateRequestProtocol::kProtocolId, "state_by_root"),
+        traffic_,
+        req_resp_metrics("state_by_root"));
+    state_request_protocol_->start();
+
+    attestation_push_protocol_ = std::make_shared<AttestationPushProtocol>(
+        io_context_,
+        host,
+        traffic_,
+        [weak_self{weak_from_this()}](SignedAttestation &&signed_attestation,
+                                      const libp2p::PeerId &peer_id) {
+          auto self = weak_self.lock();
+          if (not self) {
+            return;
+          }
+          self->metrics_->lean_attestation_push({{"result", "received"}})
+              ->inc();
+          self->receiveGossipAttestation(std::move(signed_attestation),
+                                         peer_id);
+        });
+    attestation_push_protocol_->start();
+
+    peer_exchange_protocol_ = std::make_shared<PeerExchangeProtocol>(
+        io_context_,
+        host,
+        traffic_,
+        [weak_self{weak_from_this()}](const PeerExchangeRequest &request) {
+          auto self = weak_self.lock();
+          if (not self) {
+            return PeerExchangeResponse{};
+          }
+          return self->peerExchangeResponse(request);
+        });
+    peer_exchange_protocol_->start();
+
+    libp2p::timerLoop(
+        *io_context_, kMemoryAccountingTimer, [weak_self{weak_from_this()}] {
+          auto self = weak_self.lock();
+          if (not self) {
+            return false;
+          }
+          self->updateMetricMemory();
+          return true;
+        });
+
+    if (auto cursor_res = block_tree_->getBackfillCursor();
+        cursor_res.has_error()) {
+      SL_WARN(logger_, "Backfill cursor error: {}", cursor_res.error());
+    } else if (cursor_res.value().has_value()) {
+      backfill_ = std::make_unique<HistoryBackfill>(
+          cursor_res.value(), config_->network().backfill_rate, Clock::now());
+    }
+    if (backfill_ and backfill_->cursor().has_value()) {
+      SL_INFO(logger_,
+              "Backfill finalized history before slot {}",
+              backfill_->cursor()->before);
+      metrics_->lean_backfill_slot()->set(backfill_->cursor()->before);
+      libp2p::timerLoop(
+          *io_context_, kBackfillTimer, [weak_self{weak_from_this()}] {
+            auto self = weak_self.lock();
+            if (not self or not self->backfill_) {
+              return false;
+            }
+            self->backfillHistory();
+            return true;
+          });
+    } else {
+      backfill_.reset();
+    }
+
     gossip_ =
         injector->create<std::shared_ptr<libp2p::protocol::gossip::Gossip>>();
     ping_ = injector->create<std::shared_ptr<libp2p::protocol::Ping>>();
@@ -555,110 +829,48 @@ namespace lean::modules {
           signed_block.block.setHash();
           self->receiveBlock(received_from, std::move(signed_block));
         });
-    gossip_votes_topic_ = gossipSubscribe<SignedAttestation>(
-        std::format("attestation_{}", subnet_id),
-        metrics_->lean_gossip_attestation_size_bytes(),
-        [weak_self{weak_from_this()}](SignedAttestation &&signed_attestation,
-                                      std::optional<libp2p::PeerId> peer_id) {
+    updateAttestationSubnets();
+    libp2p::timerLoop(
+        *io_context_, kAttestationSubnetsTimer, [weak_self{weak_from_this()}] {
           auto self = weak_self.lock();
           if (not self) {
-            return;
-          }
-
-          SL_DEBUG(self->logger_,
-                   "Received vote for target={} 🗳️ from peer={} 👤 "
-                   "validator_id={} ✅",
-                   signed_attestation.data.target,
-                   peer_id.has_value() ? peer_id->toBase58() : "unknown",
-                   signed_attestation.validator_id);
-
-          auto &head = signed_attestation.data.head;
-          if (not self->block_tree_->has(head.root)) {
-            if (head.slot <= self->block_tree_->lastFinalized().slot) {
-              SL_WARN(self->logger_, "Pending attestation for finalized fork");
-              return;
-            }
-            SL_INFO(self->logger_,
-                    "Pending attestation from validator {} for head {}",
-                    signed_attestation.validator_id,
-                    head);
-            self->attestation_cache_.emplace(head.root, signed_attestation);
-            if (peer_id.has_value()) {
-              self->requestBlock(*peer_id, head.root);
-            }
-            return;
-          }
-          auto res =
-              self->fork_choice_store_->onGossipAttestation(signed_attestation);
-          if (not res.has_value()) {
-            SL_WARN(self->logger_,
-                    "Error processing vote for target={}: {}",
-                    signed_attestation.data.target,
-                    res.error());
-            return;
+            return false;
           }
+          self->updateAttestationSubnets();
+          return true;
         });
-    gossip_signed_aggregated_attestation_topic_ =
-        gossipSubscribe<SignedAggregatedAttestation>(
-            "aggregation",
-            metrics_->lean_gossip_aggregation_size_bytes(),
-            [weak_self{weak_from_this()}](
-                SignedAggregatedAttestation &&signed_aggregated_attestation,
-                std::optional<libp2p::PeerId> peer_id) {
-              auto self = weak_self.lock();
-              if (not self) {
-                return;
-              }
-
-              SL_DEBUG(
-                  self->logger_,
-                  "Received aggregated attestation for target={} 🗳️ from "
-                  "peer={} 👤 "
-                  "validator_ids=[{}] ✅",
-                  signed_aggregated_attestation.data.target,
-                  peer_id.has_value() ? peer_id->toBase58() : "unknown",
-                  fmt::join(
-                      signed_aggregated_attestation.proof.participants.iter(),
-                      " "));
-
-              auto &head = signed_aggregated_attestation.data.head;
-              if (not self->block_tree_->has(head.root)) {
-                if (head.slot <= self->block_tree_->lastFinalized().slot) {
-                  SL_WARN(self->logger_,
-                          "Pending aggregated attestation for finalized fork");
+    // Follower takes votes from blocks, skipping verification of each
+    // aggregate twice
+    if (not fork_choice_store_->optimistic()) {
+      gossip_signed_aggregated_attestation_topic_ =
+          gossipSubscribe<SignedAggregatedAttestation>(
+              "aggregation",
+              metrics_->lean_gossip_aggregation_size_bytes(),
+              [weak_self{weak_from_this()}](
+                  SignedAggregatedAttestation &&signed_aggregated_attestation,
+                  std::optional<libp2p::PeerId> peer_id) {
+                auto self = weak_self.lock();
+                if (not self) {
                   return;
                 }
-                SL_INFO(
-                    self->logger_,
-                    "Pending attestation from validators [{}] for head {}",
-                    fmt::join(
-                        signed_aggregated_attestation.proof.participants.iter(),
-                        " "),
-                    head);
-                self->aggregated_attestation_cache_.emplace(
-                    head.root, signed_aggregated_attestation);
-                if (peer_id.has_value()) {
-                  self->requestBlock(*peer_id, head.root);
-                }
-                return;
-              }
-              auto res =
-                  self->fork_choice_store_->onGossipAggregatedAttestation(
-                      signed_aggregated_attestation);
-              if (not res.has_value()) {
-                SL_WARN(
-                    self->logger_,
-                    "Error processing aggregated attestation for target={}: {}",
-                    signed_aggregated_attestation.data.target,
-                    res.error());
-                return;
-              }
-            });
+                self->receiveGossipAggregatedAttestation(
+                    std::move(signed_aggregated_attestation),
+                    std::move(peer_id));
+              });
+    }
 
     io_thread_.emplace([io_context{io_context_}] {
+      setThreadName("io");
       auto work_guard = boost::asio::make_work_guard(*io_context);
       io_context->run();
     });
+    watchdog_->watch("io",
+                     [io_context{std::weak_ptr{io_context_}}](
+                         std::function<void()> probe) {
+                       if (auto io = io_context.lock()) {
+                         boost::asio::post(*io, std::move(probe));
+                       }
+                     });
 
     ssl_context_ = std::make_shared<AsioSslContext>();
     state_sync_client_ =
@@ -682,8 +894,8 @@ namespace lean::modules {
                "📣 Gossiped block in slot {} hash={:0xx} 🔗",
                slot_hash.slot,
                slot_hash.hash);
-      self->gossip_blocks_topic_->publish(
-          encodeSszSnappy(message->notification));
+      self->gossipPublish(*self->gossip_blocks_topic_,
+                          encodeSszSnappy(message->notification));
     });
   }
 
@@ -698,8 +910,20 @@ namespace lean::modules {
       SL_DEBUG(self->logger_,
                "📣 Gossiped vote for target={} 🗳️",
                message->notification.data.target);
-      self->gossip_votes_topic_->publish(
-          encodeSszSnappy(message->notification));
+      auto subnet = validatorSubnet(message->notification.validator_id,
+                                    self->subnet_count_);
+      auto it = self->attestation_topics_.find(subnet);
+      if (it == self->attestation_topics_.end()) {
+        SL_WARN(self->logger_,
+                "Vote of validator {} not gossiped, not subscribed to "
+                "subnet {}",
+                message->notification.validator_id,
+                subnet);
+        return;
+      }
+      self->gossipPublish(*it->second,
+                          encodeSszSnappy(message->notification));
+      self->pushToAggregators(message->notification);
     });
   }
 
@@ -715,9 +939,353 @@ namespace lean::modules {
       SL_DEBUG(self->logger_,
                "📣 Gossiped aggregated attestation for target={} 🗳️",
                message->notification.data.target);
-      self->gossip_signed_aggregated_attestation_topic_->publish(
-          encodeSszSnappy(message->notification));
+      if (not self->gossip_signed_aggregated_attestation_topic_) {
+        return;
+      }
+      self->gossipPublish(*self->gossip_signed_aggregated_attestation_topic_,
+                          encodeSszSnappy(message->notification));
+    });
+  }
+
+  void NetworkingImpl::onSendGossipBatch(
+      std::shared_ptr<const messages::SendGossipBatch> message) {
+    auto &votes = message->votes;
+    auto &aggregations = message->aggregations;
+    for (auto &vote : votes) {
+      SL_INFO(logger_,
+              "{}",
+              leanInteropTestLog("PUBLISH-ATTESTATION", leanInteropTest(vote)));
+    }
+    for (auto &aggregation : aggregations) {
+      SL_INFO(logger_,
+              "{}",
+              leanInteropTestLog("PUBLISH-AGGREGATION",
+                                 leanInteropTest(aggregation)));
+    }
+
+    // Encode and compress off io thread, each message by own worker task
+    std::vector<qtils::ByteVec> encoded(votes.size() + aggregations.size());
+    parallelHash(encoded.size(), [&](size_t i) {
+      encoded[i] = i < votes.size()
+                     ? encodeSszSnappy(votes[i])
+                     : encodeSszSnappy(aggregations[i - votes.size()]);
     });
+    // Send queue of each subnet topic, in order of production
+    std::map<SubnetIndex, std::vector<qtils::ByteVec>> vote_queues;
+    for (size_t i = 0; i < votes.size(); ++i) {
+      auto subnet = validatorSubnet(votes[i].validator_id, subnet_count_);
+      vote_queues[subnet].emplace_back(std::move(encoded[i]));
+    }
+    encoded.erase(encoded.begin(),
+                  encoded.begin() + static_cast<std::ptrdiff_t>(votes.size()));
+
+    boost::asio::post(
+        *io_context_,
+        [self{shared_from_this()},
+         message,
+         vote_queues{std::move(vote_queues)},
+         aggregation_queue{std::move(encoded)}]() mutable {
+          for (auto &[subnet, queue] : vote_queues) {
+            auto it = self->attestation_topics_.find(subnet);
+            if (it == self->attestation_topics_.end()) {
+              SL_WARN(self->logger_,
+                      "{} votes not gossiped, not subscribed to subnet {}",
+                      queue.size(),
+                      subnet);
+              continue;
+            }
+            for (auto &vote : queue) {
+              self->gossipPublish(*it->second, std::move(vote));
+            }
+          }
+          for (auto &vote : message->votes) {
+            self->pushToAggregators(vote);
+          }
+          for (auto &aggregation : aggregation_queue) {
+            if (not self->gossip_signed_aggregated_attestation_topic_) {
+              break;
+            }
+            self->gossipPublish(
+                *self->gossip_signed_aggregated_attestation_topic_,
+                std::move(aggregation));
+          }
+          SL_DEBUG(self->logger_,
+                   "📣 Gossiped batch of votes to {} subnets and {} "
+                   "aggregated attestations 🗳️",
+                   vote_queues.size(),
+                   aggregation_queue.size());
+        });
+  }
+
+  std::set<SubnetIndex> NetworkingImpl::wantedAttestationSubnets() const {
+    return attestationSubnets(validator_registry_->currentValidatorIndices(),
+                              subnet_count_,
+                              chain_spec_->isAggregator(),
+                              config_->cliAggregateSubnets());
+  }
+
+  void NetworkingImpl::updateAttestationSubnets() {
+    auto subnets = wantedAttestationSubnets();
+    for (auto it = attestation_topics_.begin();
+         it != attestation_topics_.end();) {
+      if (subnets.contains(it->first)) {
+        ++it;
+        continue;
+      }
+      SL_INFO(logger_, "Unsubscribed from attestation subnet {}", it->first);
+      metrics_->lean_attestation_subnet_subscribed(
+                  {{"subnet", std::to_string(it->first)}})
+          ->set(0);
+      it = attestation_topics_.erase(it);
+    }
+    for (auto subnet : subnets) {
+      if (attestation_topics_.contains(subnet)) {
+        continue;
+      }
+      // Each subnet has own receive coroutine, so its messages are decoded
+      // and sent for verification independently of other subnets
+      auto received = metrics_->lean_gossip_subnet_attestations(
+          {{"subnet", std::to_string(subnet)}});
+      attestation_topics_.emplace(
+          subnet,
+          gossipSubscribe<SignedAttestation>(
+              std::format("attestation_{}", subnet),
+              metrics_->lean_gossip_attestation_size_bytes(),
+              [weak_self{weak_from_this()}, subnet, received](
+                  SignedAttestation &&signed_attestation,
+                  std::optional<libp2p::PeerId> peer_id) {
+                auto self = weak_self.lock();
+                if (not self) {
+                  return;
+                }
+                // Messages still queued after unsubscribe
+                if (not self->attestation_topics_.contains(subnet)) {
+                  return;
+                }
+                received->inc();
+                self->receiveGossipAttestation(std::move(signed_attestation),
+                                               std::move(peer_id));
+              }));
+      metrics_->lean_attestation_subnet_subscribed(
+                  {{"subnet", std::to_string(subnet)}})
+          ->set(1);
+      SL_INFO(logger_, "Subscribed to attestation subnet {}", subnet);
+    }
+    gossip_filter_->setSubnets(std::move(subnets));
+  }
+
+  void NetworkingImpl::receiveGossipAttestation(
+      SignedAttestation &&signed_attestation,
+      std::optional<libp2p::PeerId> peer_id) {
+    SL_DEBUG_LIMITED(
+        logger_,
+        "Received vote for target={} 🗳️ from peer={} 👤 "
+        "validator_id={} ✅",
+        signed_attestation.data.target,
+        peer_id.has_value() ? peer_id->toBase58() : "unknown",
+        signed_attestation.validator_id);
+
+    auto verdict = gossip_filter_->check(signed_attestation,
+                                         block_tree_->lastFinalized().slot);
+    if (verdict != GossipFilter::Verdict::Accept) {
+      SL_DEBUG(logger_,
+               "Dropped vote from validator {}: {}",
+               signed_attestation.validator_id,
+               GossipFilter::name(verdict));
+      return;
+    }
+
+    auto &head = signed_attestation.data.head;
+    if (not block_tree_->has(head.root)) {
+      if (head.slot <= block_tree_->lastFinalized().slot) {
+        SL_WARN(logger_, "Pending attestation for finalized fork");
+        return;
+      }
+      // Head will come with range sync, which doesn't replay it
+      if (sync_mode_.bulk()) {
+        return;
+      }
+      if (not attestation_cache_.add(signed_attestation, peer_id)) {
+        SL_DEBUG(logger_,
+                 "Dropped pending attestation from validator {}, "
+                 "pending pool or peer quota is full",
+                 signed_attestation.validator_id);
+        return;
+      }
+      SL_INFO_LIMITED(logger_,
+                      "Pending attestation from validator {} for head {}",
+                      signed_attestation.validator_id,
+                      head);
+      if (peer_id.has_value()) {
+        requestBlock(*peer_id, head.root);
+      }
+      return;
+    }
+    if (not beginGossipVerification()) {
+      return;
+    }
+    fork_choice_store_->postGossipAttestation(
+        signed_attestation,
+        [weak_self{weak_from_this()},
+         signed_attestation](outcome::result<void> res) {
+          auto self = weak_self.lock();
+          if (not self) {
+            return;
+          }
+          boost::asio::post(
+              *self->io_context_, [self, signed_attestation, res] {
+                --self->gossip_verifications_in_flight_;
+                if (not res.has_value()) {
+                  SL_WARN(self->logger_,
+                          "Error processing vote for target={}: {}",
+                          signed_attestation.data.target,
+                          res.error());
+                  return;
+                }
+                self->gossip_filter_->markSeen(signed_attestation);
+              });
+        });
+  }
+
+  void NetworkingImpl::receiveGossipAggregatedAttestation(
+      SignedAggregatedAttestation &&signed_aggregated_attestation,
+      std::optional<libp2p::PeerId> peer_id) {
+    SL_DEBUG_LIMITED(
+        logger_,
+        "Received aggregated attestation for target={} 🗳️ from peer={} 👤 "
+        "validator_ids=[{}] ✅",
+        signed_aggregated_attestation.data.target,
+        peer_id.has_value() ? peer_id->toBase58() : "unknown",
+        fmt::join(signed_aggregated_attestation.proof.participants.iter(),
+                  " "));
+
+    auto verdict = gossip_filter_->check(signed_aggregated_attestation,
+                                         block_tree_->lastFinalized().slot);
+    if (verdict != GossipFilter::Verdict::Accept) {
+      SL_DEBUG(logger_,
+               "Dropped aggregated attestation for target={}: {}",
+               signed_aggregated_attestation.data.target,
+               GossipFilter::name(verdict));
+      return;
+    }
+
+    auto &head = signed_aggregated_attestation.data.head;
+    if (not block_tree_->has(head.root)) {
+      if (head.slot <= block_tree_->lastFinalized().slot) {
+        SL_WARN(logger_, "Pending aggregated attestation for finalized fork");
+        return;
+      }
+      // Head will come with range sync, which doesn't replay it
+      if (sync_mode_.bulk()) {
+        return;
+      }
+      if (not aggregated_attestation_cache_.add(signed_aggregated_attestation,
+                                                peer_id)) {
+        SL_DEBUG(logger_,
+                 "Dropped pending aggregated attestation, pending pool or "
+                 "peer quota is full");
+        return;
+      }
+      SL_INFO_LIMITED(
+          logger_,
+          "Pending attestation from validators [{}] for head {}",
+          fmt::join(signed_aggregated_attestation.proof.participants.iter(),
+                    " "),
+          head);
+      if (peer_id.has_value()) {
+        requestBlock(*peer_id, head.root);
+      }
+      return;
+    }
+    // Same aggregation from other peer is verified once
+    if (not gossip_filter_->beginVerification(signed_aggregated_attestation)) {
+      SL_DEBUG(logger_,
+               "Aggregated attestation for target={} waits for verified copy",
+               signed_aggregated_attestation.data.target);
+      return;
+    }
+    if (not beginGossipVerification()) {
+      gossip_filter_->endVerification(signed_aggregated_attestation);
+      return;
+    }
+    fork_choice_store_->postGossipAggregatedAttestation(
+        signed_aggregated_attestation,
+        [weak_self{weak_from_this()},
+         signed_aggregated_attestation](outcome::result<void> res) {
+          auto self = weak_self.lock();
+          if (not self) {
+            return;
+          }
+          boost::asio::post(
+              *self->io_context_, [self, signed_aggregated_attestation, res] {
+                --self->gossip_verifications_in_flight_;
+                auto copies = self->gossip_filter_->endVerification(
+                    signed_aggregated_attestation);
+                if (not res.has_value()) {
+                  SL_WARN(self->logger_,
+                          "Error processing aggregated attestation for "
+                          "target={}: {}",
+                          signed_aggregated_attestation.data.target,
+                          res.error());
+                  // Copies may carry valid proof
+                  for (auto &copy : copies) {
+                    self->receiveGossipAggregatedAttestation(std::move(copy),
+                                                             std::nullopt);
+                  }
+                  return;
+                }
+                self->gossip_filter_->markSeen(signed_aggregated_attestation);
+              });
+        });
+  }
+
+  template <typename T>
+  void NetworkingImpl::observeGossipArrival(
+      std::string_view topic,
+      const T &message,
+      const std::optional<libp2p::PeerId> &peer_id) {
+    auto client = peer_id.has_value() ? peerClient(*peer_id) : "unknown";
+    auto key = fmt::format("{}/{}", topic, client);
+    auto it = gossip_arrival_metrics_.find(key);
+    if (it == gossip_arrival_metrics_.end()) {
+      metrics::Labels labels{{"topic", std::string{topic}},
+                             {"client", client}};
+      GossipArrivalMetrics histograms;
+      if constexpr (std::is_same_v<T, SignedBlock>) {
+        histograms.delay = metrics_->lean_gossip_block_arrival_delay(labels);
+        histograms.inclusion_distance =
+            metrics_->lean_attestation_inclusion_distance(labels);
+      } else if constexpr (std::is_same_v<T, SignedAttestation>) {
+        histograms.delay =
+            metrics_->lean_gossip_attestation_arrival_delay(labels);
+      } else {
+        histograms.delay =
+            metrics_->lean_gossip_aggregation_arrival_delay(labels);
+      }
+      it = gossip_arrival_metrics_.emplace(std::move(key), histograms).first;
+    }
+    auto &histograms = it->second;
+
+    auto slot_start = [&](Slot slot) {
+      return Interval::fromSlot(slot, 0).time(*genesis_config_);
+    };
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+    auto delay = [&](Slot slot) {
+      return std::chrono::duration<double>(now - slot_start(slot)).count();
+    };
+    if constexpr (std::is_same_v<T, SignedBlock>) {
+      auto slot = message.block.slot;
+      histograms.delay->observe(delay(slot));
+      for (auto &attestation : message.block.body.attestations) {
+        if (attestation.data.slot < slot) {
+          histograms.inclusion_distance->observe(
+              static_cast<double>(slot - attestation.data.slot));
+        }
+      }
+    } else {
+      histograms.delay->observe(delay(message.data.slot));
+    }
   }
 
   template <typename T>
@@ -728,12 +1296,34 @@ namespace lean::modules {
     auto topic = gossip_->subscribe(gossipTopic(type));
     libp2p::coroSpawn(
         *io_context_,
-        [this, type, metric, f{std::move(f)}, topic]() -> libp2p::Coro<void> {
+        [this,
+         type{std::string{type}},
+         metric,
+         f{std::move(f)},
+         topic]() -> libp2p::Coro<void> {
           while (auto raw_result = co_await topic->receiveMessage()) {
             auto &raw = raw_result.value();
-            if (auto r = decodeSszSnappy<T>(raw.data)) {
+            log::recordFlightEvent(log::FlightEventKind::INSTANT,
+                                   "gossip received",
+                                   raw.data.size());
+            traffic_->record(TrafficShaper::Protocol::Gossip,
+                             TrafficShaper::Direction::In,
+                             raw.received_from,
+                             raw.data.size());
+            if constexpr (std::is_same_v<T, SignedBlock>) {
+              if (gossipBlockIsFinalized(raw.data)) {
+                continue;
+              }
+            }
+            auto r = [&] {
+              auto timer = metrics_->lean_gossip_decode_time_seconds()->timer();
+              LEAN_TRACE_SPAN("networking", "gossip decode");
+              return gossipUncompressCache().decodeSszSnappy<T>(raw.data);
+            }();
+            if (r) {
               auto &[decoded, size] = r.value();
               metric->observe(size);
+              observeGossipArrival(type, decoded, raw.received_from);
               f(std::move(decoded), raw.received_from);
             } else {
               SL_WARN(this->logger_,
@@ -746,6 +1336,92 @@ namespace lean::modules {
     return topic;
   }
 
+  void NetworkingImpl::gossipPublish(libp2p::protocol::gossip::Topic &topic,
+                                     qtils::ByteVec message) {
+    // Sent once per mesh peer, but fan-out is not known here
+    traffic_->record(TrafficShaper::Protocol::Gossip,
+                     TrafficShaper::Direction::Out,
+                     std::nullopt,
+                     message.size());
+    log::recordFlightEvent(
+        log::FlightEventKind::INSTANT, "gossip publish", message.size());
+    topic.publish(std::move(message));
+  }
+
+  void NetworkingImpl::pushToAggregators(
+      const SignedAttestation &signed_attestation) {
+    if (not config_->network().direct_attestations) {
+      return;
+    }
+    auto subnet =
+        validatorSubnet(signed_attestation.validator_id, subnet_count_);
+    auto &peer_repo = host_->getPeerRepository();
+    auto [begin, end] = aggregators_by_subnet_.equal_range(subnet);
+    for (auto it = begin; it != end; ++it) {
+      auto &peer_id = it->second;
+      auto state_it = peer_states_.find(peer_id);
+      if (state_it == peer_states_.end()
+          or not std::holds_alternative<PeerState::Connected>(
+              state_it->second.state)) {
+        continue;
+      }
+      // Protocol is specific to this client, peer advertises it by identify
+      auto protocols = peer_repo.getProtocolRepository().getProtocols(peer_id);
+      if (not protocols.has_value()
+          or not qtils::cxx23::ranges::contains(
+              protocols.value(), AttestationPushProtocol::kProtocolId)) {
+        continue;
+      }
+      libp2p::coroSpawn(
+          *io_context_,
+          [self{shared_from_this()}, peer_id, signed_attestation]()
+              -> libp2p::Coro<void> {
+            auto res = co_await self->attestation_push_protocol_->push(
+                peer_id, signed_attestation);
+            auto result = res.has_value() ? "sent" : "failed";
+            self->metrics_->lean_attestation_push({{"result", result}})->inc();
+            if (not res.has_value()) {
+              SL_DEBUG(self->logger_,
+                       "Push attestation to {} error: {}",
+                       peer_id.toBase58(),
+                       res.error());
+            }
+          });
+    }
+  }
+
+  bool NetworkingImpl::gossipBlockIsFinalized(qtils::BytesIn compressed) {
+    // Decoding fails later again and is reported there
+    auto uncompressed = gossipUncompressCache().uncompress(compressed);
+    if (not uncompressed) {
+      return false;
+    }
+    auto view = SignedBlockView::make(uncompressed.value());
+    if (not view) {
+      return false;
+    }
+    auto slot = view.value().block().slot();
+    if (slot > block_tree_->lastFinalized().slot) {
+      return false;
+    }
+    SL_TRACE(logger_,
+             "Gossip block {} was ignored before decoding as block of "
+             "finalised slot",
+             slot);
+    return true;
+  }
+
+  bool NetworkingImpl::beginGossipVerification() {
+    if (gossip_verifications_in_flight_ >= kMaxGossipVerificationsInFlight) {
+      SL_DEBUG(logger_,
+               "Dropped gossip attestation, {} verifications in flight",
+               gossip_verifications_in_flight_);
+      return false;
+    }
+    ++gossip_verifications_in_flight_;
+    return true;
+  }
+
   void NetworkingImpl::receiveStatus(
       const messages::StatusMessageReceived &message) {
     BlockIndex finalized{
@@ -760,10 +1436,17 @@ namespace lean::modules {
         or not statusFinalizedIsGood(head)) {
       return;
     }
+    peer_scores_.onHead(message.from_peer, head.slot);
+    updateSyncMode();
     if (head.slot > block_tree_->lastFinalized().slot
         and not block_tree_->has(head.hash)) {
-      SL_TRACE(logger_, "receiveStatus {} => request", head.slot);
-      requestBlock(message.from_peer, head.hash);
+      if (head.slot > block_tree_->bestBlock().slot + kRangeSyncDistance) {
+        SL_TRACE(logger_, "receiveStatus {} => request range", head.slot);
+        requestBlockRange(message.from_peer, head);
+      } else {
+        SL_TRACE(logger_, "receiveStatus {} => request", head.slot);
+        requestBlock(message.from_peer, head.hash);
+      }
     }
     loader_.dispatchStatusMessageReceived(qtils::toSharedPtr(message));
   }
@@ -773,11 +1456,11 @@ namespace lean::modules {
     // find missing block or parent
     auto finalized = block_tree_->lastFinalized();
     while (true) {
-      auto block_it = block_cache_.find(block_hash);
-      if (block_it == block_cache_.end()) {
+      auto cached_block = orphan_blocks_.find(block_hash);
+      if (cached_block == nullptr) {
         break;
       }
-      auto &block = block_it->second.block.block;
+      auto &block = cached_block->block;
       // ignore finalized fork
       if (block.slot <= finalized.slot) {
         return;
@@ -797,34 +1480,203 @@ namespace lean::modules {
     }
     requested_at = now;
 
-    auto name_it = peer_name_.find(peer_id);
-    auto peer_name =
-        name_it != peer_name_.end() ? name_it->second : peer_id.toBase58();
-    SL_INFO(logger_, "request block {} from {}", block_hash, peer_name);
+    // Peers ahead of us likely have the block
+    auto target =
+        peer_scores_.choose(peer_id, block_tree_->bestBlock().slot + 1);
+    SL_DEBUG(logger_,
+             "queue block request {} to {}",
+             block_hash,
+             target.toBase58());
+    queued_block_requests_[target].emplace_back(block_hash);
+    flushBlockRequests(target);
+
+    timer_wheel_.add(
+        peer_scores_.hedgeDelay(target),
+        [weak_self{weak_from_this()}, target, block_hash, requested_at{now}] {
+          auto self = weak_self.lock();
+          if (not self) {
+            return;
+          }
+          boost::asio::post(*self->io_context_,
+                            [weak_self, target, block_hash, requested_at] {
+                              auto self = weak_self.lock();
+                              if (not self) {
+                                return;
+                              }
+                              self->hedgeBlockRequest(
+                                  target, block_hash, requested_at);
+                            });
+        });
+  }
 
-    libp2p::coroSpawn(
-        *io_context_,
-        [self{shared_from_this()}, peer_id, block_hash, peer_name]()
-            -> libp2p::Coro<void> {
-          auto response_res = co_await self->block_request_protocol_->request(
-              peer_id, {.roots = {{block_hash}}});
-          self->block_requested_at_.erase(block_hash);
-          if (response_res.has_value()) {
-            auto &block = response_res.value();
-            SL_DEBUG(self->logger_,
-                     "request block {} from {} success, slot {}",
-                     block_hash,
+  void NetworkingImpl::hedgeBlockRequest(const libp2p::PeerId &peer_id,
+                                         const BlockHash &block_hash,
+                                         Clock::time_point requested_at) {
+    // Response was received, or block was requested again
+    auto requested_it = block_requested_at_.find(block_hash);
+    if (requested_it == block_requested_at_.end()
+        or requested_it->second != requested_at) {
+      return;
+    }
+    if (block_tree_->has(block_hash)
+        or orphan_blocks_.contains(block_hash)) {
+      return;
+    }
+    auto other = peer_scores_.best(block_tree_->bestBlock().slot + 1, peer_id);
+    if (not other.has_value()) {
+      return;
+    }
+    SL_DEBUG(logger_,
+             "hedge block request {}, {} is slow, ask {}",
+             block_hash,
+             peer_id.toBase58(),
+             other->toBase58());
+    queued_block_requests_[*other].emplace_back(block_hash);
+    flushBlockRequests(*other);
+  }
+
+  void NetworkingImpl::flushBlockRequests(const libp2p::PeerId &peer_id) {
+    auto queue_it = queued_block_requests_.find(peer_id);
+    if (queue_it == queued_block_requests_.end()) {
+      return;
+    }
+    auto &in_flight = block_requests_in_flight_[peer_id];
+    if (in_flight >= kMaxBlockRequestsInFlightPerPeer) {
+      return;
+    }
+    ++in_flight;
+    BlockRequest request;
+    auto &queue = queue_it->second;
+    if (queue.size() <= MAX_REQUEST_BLOCKS) {
+      request.roots.data() = std::move(queue);
+      queued_block_requests_.erase(queue_it);
+    } else {
+      auto batch_end = queue.begin() + MAX_REQUEST_BLOCKS;
+      request.roots.data().assign(queue.begin(), batch_end);
+      queue.erase(queue.begin(), batch_end);
+    }
+
+    auto name_it = peer_name_.find(peer_id);
+    auto peer_name =
+        name_it != peer_name_.end() ? name_it->second : peer_id.toBase58();
+    SL_INFO_LIMITED(logger_,
+                    "request {} blocks from {}",
+                    request.roots.size(),
+                    peer_name);
+
+    libp2p::coroSpawn(
+        *io_context_,
+        [self{shared_from_this()}, peer_id, request, peer_name]()
+            -> libp2p::Coro<void> {
+          auto started = Clock::now();
+          auto response_res =
+              co_await self->block_request_protocol_->request(peer_id, request);
+          auto in_flight_it = self->block_requests_in_flight_.find(peer_id);
+          if (--in_flight_it->second == 0) {
+            self->block_requests_in_flight_.erase(in_flight_it);
+          }
+          if (response_res.has_value()) {
+            self->peer_scores_.onResponse(
+                peer_id,
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    Clock::now() - started),
+                request.roots.size(),
+                response_res.value().size());
+          } else {
+            self->peer_scores_.onFailure(peer_id);
+          }
+          for (auto &block_hash : request.roots) {
+            self->block_requested_at_.erase(block_hash);
+          }
+          if (response_res.has_value()) {
+            auto &blocks = response_res.value();
+            SL_DEBUG(self->logger_,
+                     "request {} blocks from {} success, received {}",
+                     request.roots.size(),
                      peer_name,
-                     block.block.slot);
-            block.block.setHash();
-            self->receiveBlock(peer_id, std::move(block));
+                     blocks.size());
+            for (auto &block : blocks) {
+              block.block.setHash();
+              self->receiveBlock(peer_id, std::move(block));
+            }
           } else {
             SL_WARN(self->logger_,
-                    "request block {} from {} error: {}",
-                    block_hash,
+                    "request {} blocks from {} error: {}",
+                    request.roots.size(),
                     peer_name,
                     response_res.error());
           }
+          self->flushBlockRequests(peer_id);
+        });
+  }
+
+  void NetworkingImpl::requestBlockRange(const libp2p::PeerId &peer_id,
+                                         const BlockIndex &peer_head) {
+    auto start_slot = block_tree_->bestBlock().slot + 1;
+    auto batch = sync_mode_.bulk() ? kBulkRangeSyncBatch : kRangeSyncBatch;
+    auto count = std::min(batch, peer_head.slot + 1 - start_slot);
+    // Route batch to much better peer having whole batch, if it is idle
+    auto target = peer_scores_.choose(peer_id, start_slot + count - 1);
+    if (range_sync_peers_.contains(target)) {
+      target = peer_id;
+    }
+    if (not range_sync_peers_.emplace(target).second) {
+      return;
+    }
+    SL_DEBUG(logger_,
+             "request blocks range [{}, {}) from {}",
+             start_slot,
+             start_slot + count,
+             target.toBase58());
+
+    libp2p::coroSpawn(
+        *io_context_,
+        [self{shared_from_this()},
+         peer_id,
+         target,
+         peer_head,
+         start_slot,
+         count]() -> libp2p::Coro<void> {
+          auto started = Clock::now();
+          auto response_res =
+              co_await self->block_range_request_protocol_->request(
+                  target, {.start_slot = start_slot, .count = count});
+          self->range_sync_peers_.erase(target);
+          if (not response_res.has_value()) {
+            self->peer_scores_.onFailure(target);
+            SL_WARN(self->logger_,
+                    "request blocks range from {} error: {}",
+                    target.toBase58(),
+                    response_res.error());
+            // Peer may not support range requests
+            self->requestBlock(peer_id, peer_head.hash);
+            co_return;
+          }
+          auto &blocks = response_res.value();
+          self->peer_scores_.onResponse(
+              target,
+              std::chrono::duration_cast<std::chrono::microseconds>(
+                  Clock::now() - started),
+              count,
+              blocks.size());
+          auto best_before = self->block_tree_->bestBlock().slot;
+          if (self->sync_mode_.bulk()) {
+            self->receiveBlockRange(target, std::move(blocks));
+          } else {
+            // Blocks are ordered by slot, so each block parent is either
+            // imported or cached already.
+            for (auto &block : blocks) {
+              block.block.setHash();
+              self->receiveBlock(target, std::move(block));
+            }
+          }
+          auto best = self->block_tree_->bestBlock().slot;
+          if (best <= best_before) {
+            // Range did not extend our chain, fetch peer head by root
+            self->requestBlock(peer_id, peer_head.hash);
+          } else if (peer_head.slot > best + kRangeSyncDistance) {
+            self->requestBlockRange(peer_id, peer_head);
+          }
         });
   }
 
@@ -838,13 +1690,16 @@ namespace lean::modules {
              block_index,
              signed_block.block.parent_root,
              from_peer.has_value() ? from_peer->toBase58() : "unknown");
+    if (from_peer.has_value()) {
+      peer_scores_.onHead(*from_peer, block_index.slot);
+    }
 
     // Ignore cached block
-    if (block_cache_.contains(block_index.hash)) {
+    if (orphan_blocks_.contains(block_index.hash)) {
       SL_TRACE(logger_,
                "receiveBlock {} => Block was ignored as cached",
                block_index.slot);
-      if (from_peer) {
+      if (from_peer and not sync_mode_.bulk()) {
         requestBlock(*from_peer, parent_hash);
       }
       return;
@@ -866,80 +1721,164 @@ namespace lean::modules {
           block_index.slot);
 
       // Forget cached children
-      auto [child_begin, child_end] =
-          block_children_.equal_range(block_index.hash);
-      for (auto &child :
-           std::ranges::subrange{child_begin, child_end} | std::views::values) {
-        consumeBlockTree(false, child, nullptr);
+      for (auto &child : orphan_blocks_.children(block_index.hash)) {
+        discardOrphanBlocks(child);
       }
       return;
     }
 
-    auto child_it = block_children_.emplace(parent_hash, block_index.hash);
-    block_cache_.emplace(block_index.hash,
-                         BlockCacheItem{
-                             .child_it = child_it,
-                             .block = std::move(signed_block),
-                         });
+    auto &cached_block = orphan_blocks_.add(std::move(signed_block)).block;
 
     if (from_peer) {
-      requestBlock(*from_peer, parent_hash);
+      // Fetch missing ancestors by range instead of walking back by root
+      if (sync_mode_.bulk()
+          and block_index.slot
+                  > block_tree_->bestBlock().slot + kRangeSyncDistance) {
+        if (not block_tree_->has(parent_hash)) {
+          requestBlockRange(*from_peer, block_index);
+        }
+      } else {
+        requestBlock(*from_peer, parent_hash);
+      }
     }
 
     // If the parent isn't in the tree-cache block and request of parent
     if (not block_tree_->has(parent_hash)) {
+      if (config_->database().state_prefetch) {
+        prefetchStates(cached_block);
+      }
       return;
     }
 
-    auto consume = [&](bool good,
-                       SignedBlock block,
-                       std::vector<SignedAttestation> attestations,
-                       std::vector<SignedAggregatedAttestation>
-                           aggregated_attestations) {
-      auto block_res = fork_choice_store_->onBlock(block);
-      if (not block_res.has_value()) {
-        SL_WARN(logger_,
-                "❌ Error importing block={}: {}",
-                block.block.index(),
-                block_res.error());
-        return false;
-      }
-      SL_INFO(logger_, "✅ Imported block {}", block.block.index());
-
-      for (auto &attestation : attestations) {
-        SL_INFO(logger_,
-                "Import pending attestation from validator {}",
-                attestation.validator_id);
-        auto res = fork_choice_store_->onGossipAttestation(attestation);
-        if (not res.has_value()) {
-          SL_WARN(logger_,
-                  "Error importing pending attestation from validator {}: {}",
-                  attestation.validator_id,
-                  res.error());
-        }
-      }
+    importOrphanBlocks(block_index.hash);
+    updateSyncMode();
 
-      for (auto &attestation : aggregated_attestations) {
-        SL_INFO(logger_,
-                "Import pending attestation from validators [{}]",
-                fmt::join(attestation.proof.participants.iter(), " "));
-        auto res =
-            fork_choice_store_->onGossipAggregatedAttestation(attestation);
-        if (not res.has_value()) {
-          SL_WARN(
-              logger_,
-              "Error importing pending attestation from validators [{}]: {}",
-              fmt::join(attestation.proof.participants.iter(), " "),
-              res.error());
-        }
+    // Cleanup cache from blocks of finalized forks
+    prune();
+  }
+
+  void NetworkingImpl::receiveBlockRange(const libp2p::PeerId &peer_id,
+                                         std::vector<SignedBlock> &&blocks) {
+    auto finalized_slot = block_tree_->lastFinalized().slot;
+    // Cached blocks with imported parent, segments start at them
+    std::vector<BlockHash> roots;
+    std::optional<BlockHash> missing_parent;
+    for (auto &block : blocks) {
+      block.block.setHash();
+      auto block_index = block.block.index();
+      peer_scores_.onHead(peer_id, block_index.slot);
+      if (block_index.slot <= finalized_slot
+          or orphan_blocks_.contains(block_index.hash)
+          or block_tree_->has(block_index.hash)) {
+        continue;
       }
+      auto parent_hash = block.block.parent_root;
+      if (block_tree_->has(parent_hash)) {
+        roots.emplace_back(block_index.hash);
+      } else if (not missing_parent.has_value()
+                 and not orphan_blocks_.contains(parent_hash)) {
+        missing_parent = parent_hash;
+      }
+      orphan_blocks_.add(std::move(block));
+    }
+    SL_DEBUG(logger_,
+             "Received range of {} blocks from {}, {} segments",
+             blocks.size(),
+             peer_id.toBase58(),
+             roots.size());
+    for (auto &root : roots) {
+      importOrphanBlocks(root);
+    }
+    // Range starts on fork we don't have
+    if (missing_parent.has_value()) {
+      requestBlock(peer_id, *missing_parent);
+    }
+    updateSyncMode();
+    prune();
+  }
 
-      return true;
-    };
-    consumeBlockTree(true, block_index.hash, consume);
+  void NetworkingImpl::updateSyncMode() {
+    auto best = block_tree_->bestBlock().slot;
+    auto peers_head = peer_scores_.headSlot();
+    if (not sync_mode_.update(best, peers_head)) {
+      return;
+    }
+    SL_INFO(logger_,
+            "Sync mode {}, best block {}, peers head {}",
+            SyncMode::name(sync_mode_.mode()),
+            best,
+            peers_head);
+    metrics_->lean_sync_mode()->set(sync_mode_.bulk() ? 1 : 0);
+  }
 
-    // Cleanup cache from blocks of finalized forks
-    prune();
+  void NetworkingImpl::backfillHistory() {
+    if (not backfill_ or not backfill_->ready(Clock::now())
+        or sync_mode_.bulk()) {
+      return;
+    }
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+    auto interval = Interval::fromTime(now, *genesis_config_);
+    if (not interval.has_value() or interval->phase() < kFirstBackfillPhase) {
+      return;
+    }
+    auto peer_id = peer_scores_.bestIf(
+        backfill_->cursor()->before, [&](const libp2p::PeerId &peer_id) {
+          return backfill_->canServe(peer_id)
+             and not range_sync_peers_.contains(peer_id);
+        });
+    if (not peer_id.has_value()) {
+      return;
+    }
+    auto request = backfill_->begin();
+    SL_DEBUG(logger_,
+             "backfill blocks range [{}, {}) from {}",
+             request.start_slot,
+             request.start_slot + request.count,
+             peer_id->toBase58());
+    libp2p::coroSpawn(
+        *io_context_,
+        [self{shared_from_this()},
+         peer_id{*peer_id},
+         request]() -> libp2p::Coro<void> {
+          auto response_res =
+              co_await self->block_range_request_protocol_->request(peer_id,
+                                                                    request);
+          if (not self->backfill_) {
+            co_return;
+          }
+          if (not response_res.has_value()) {
+            SL_DEBUG(self->logger_,
+                     "backfill blocks range from {} error: {}",
+                     peer_id.toBase58(),
+                     response_res.error());
+            self->backfill_->onFailure(peer_id);
+            co_return;
+          }
+          auto blocks = self->backfill_->onResponse(
+              peer_id, std::move(response_res.value()), Clock::now());
+          if (blocks.empty()) {
+            co_return;
+          }
+          auto &cursor = self->backfill_->cursor();
+          if (auto res = self->block_tree_->addBackfilledBlocks(blocks, cursor);
+              res.has_error()) {
+            SL_ERROR(self->logger_,
+                     "Backfill stopped, failed to store blocks: {}",
+                     res.error());
+            self->backfill_.reset();
+            co_return;
+          }
+          if (not cursor.has_value()) {
+            SL_INFO(self->logger_, "Backfill of finalized history is done");
+            self->metrics_->lean_backfill_slot()->set(0);
+            self->backfill_.reset();
+            co_return;
+          }
+          self->metrics_->lean_backfill_slot()->set(cursor->before);
+          // Continue while relaxed phase lasts
+          self->backfillHistory();
+        });
   }
 
   bool NetworkingImpl::statusFinalizedIsGood(const BlockIndex &slot_hash) {
@@ -949,33 +1888,55 @@ namespace lean::modules {
     return slot_hash.slot > block_tree_->lastFinalized().slot;
   }
 
-  void NetworkingImpl::connectToPeers() {
-    auto now = Clock::now();
+  /// Dial of peer, its addresses are raced with staggered starts
+  struct NetworkingImpl::PeerDial {
+    libp2p::PeerId peer_id;
+    /// Peer info with single address for each attempt, QUIC ones first
+    std::vector<libp2p::peer::PeerInfo> attempts;
+    /// Attempts started
+    size_t next = 0;
+    size_t in_flight = 0;
+    bool connected = false;
+    /// Bootstrap doesn't need peer anymore, remaining attempts are skipped
+    bool cancelled = false;
+    /// Starts next attempt
+    std::shared_ptr<boost::asio::steady_timer> timer;
+  };
+
+  struct NetworkingImpl::Bootstrap {
+    Clock::time_point started;
+    /// Peers to dial, in order
+    std::vector<libp2p::PeerId> candidates;
+    size_t next = 0;
+    /// Connected peers to reach
+    size_t target = 0;
+    bool first_peer = false;
+    /// Starts next dial
+    std::optional<boost::asio::steady_timer> timer;
+    std::vector<std::weak_ptr<PeerDial>> dials;
+  };
+
+  size_t NetworkingImpl::wantedPeerCount() const {
     auto want = peer_states_.size();
     if (auto &limit = config_->maxBootnodes()) {
       want = std::min(want, *limit);
     }
+    return want;
+  }
+
+  void NetworkingImpl::connectToPeers() {
+    // Candidates are dialed with staggered starts while bootstrapping
+    if (bootstrap_ and bootstrap_->next < bootstrap_->candidates.size()) {
+      return;
+    }
+    auto want = wantedPeerCount();
     SL_TRACE(logger_, "connectToPeers: computed want={}", want);
     size_t active = 0;
+    // Backoff expiry is timed by `scheduleBackoff`
     for (auto &state : peer_states_ | std::views::values) {
       if (std::holds_alternative<PeerState::Connecting>(state.state)
           or std::holds_alternative<PeerState::Connected>(state.state)) {
         ++active;
-      } else if (auto *backoff =
-                     std::get_if<PeerState::Backoff>(&state.state)) {
-        if (backoff->backoff_until <= now) {
-          // Backoff => Connectable
-          SL_DEBUG(logger_,
-                   "Peer {} backoff expired (backoff={}ms) => Connectable",
-                   state.info.id.toBase58(),
-                   std::chrono::duration_cast<std::chrono::milliseconds>(
-                       backoff->backoff)
-                       .count());
-          state.state = PeerState::Connectable{.backoff = backoff->backoff};
-          if (not subnet_aggregators_.contains(state.info.id)) {
-            connectable_peers_.emplace_back(state.info.id);
-          }
-        }
       }
     }
     SL_TRACE(logger_,
@@ -984,48 +1945,7 @@ namespace lean::modules {
              connectable_peers_.size());
     auto connect = [&](PeerState &state) {
       ++active;
-      auto &connectable = std::get<PeerState::Connectable>(state.state);
-      // Connectable => Connecting
-      state.state = PeerState::Connecting{.backoff = connectable.backoff};
-      libp2p::coroSpawn(
-          *io_context_,
-          [weak_self{weak_from_this()},
-           host{host_},
-           peer_info{state.info}]() -> libp2p::Coro<void> {
-            auto r = co_await host->connect(peer_info);
-            auto self = weak_self.lock();
-            if (not self) {
-              co_return;
-            }
-            SL_TRACE(self->logger_,
-                     "connectToPeers: connection attempt finished for peer {}",
-                     peer_info.id.toBase58());
-            auto &state = self->peer_states_.at(peer_info.id);
-            if (not r.has_value()) {
-              SL_WARN(self->logger_,
-                      "connect={} error: {}",
-                      peer_info.id.toBase58(),
-                      r.error());
-              if (auto *connecting =
-                      std::get_if<PeerState::Connecting>(&state.state)) {
-                // Connecting => Backoff
-                state.state = PeerState::Backoff{
-                    .backoff = std::min(2 * connecting->backoff, kMaxBackoff),
-                    .backoff_until = Clock::now() + connecting->backoff,
-                };
-                SL_DEBUG(self->logger_,
-                         "Peer {} moved to Backoff (new backoff={}ms)",
-                         peer_info.id.toBase58(),
-                         std::chrono::duration_cast<std::chrono::milliseconds>(
-                             std::min(2 * connecting->backoff, kMaxBackoff))
-                             .count());
-              }
-            } else {
-              SL_INFO(self->logger_,
-                      "Successfully connected to peer {}",
-                      peer_info.id.toBase58());
-            }
-          });
+      dialPeer(state);
     };
     for (auto &peer_id : subnet_aggregators_) {
       auto &state = peer_states_.at(peer_id);
@@ -1040,9 +1960,22 @@ namespace lean::modules {
                want,
                active);
     }
+    // Candidates on own subnets are moved to back, and are dialed first
+    auto subnets = subnetBits(wantedAttestationSubnets());
+    size_t on_subnets =
+        std::ranges::partition(connectable_peers_,
+                               [&](const libp2p::PeerId &peer_id) {
+                                 return not peerOnSubnets(peer_id, subnets);
+                               })
+            .size();
     while (active < want and not connectable_peers_.empty()) {
-      size_t i = std::uniform_int_distribution<size_t>{
-          0, connectable_peers_.size() - 1}(random_);
+      auto size = connectable_peers_.size();
+      auto first = on_subnets != 0 ? size - on_subnets : 0;
+      size_t i =
+          std::uniform_int_distribution<size_t>{first, size - 1}(random_);
+      if (on_subnets != 0) {
+        --on_subnets;
+      }
       std::swap(connectable_peers_.at(i), connectable_peers_.back());
       auto peer_id = std::move(connectable_peers_.back());
       connectable_peers_.pop_back();
@@ -1056,14 +1989,598 @@ namespace lean::modules {
     }
   }
 
+  void NetworkingImpl::keepWarmPeersAlive() {
+    auto &connections = host_->getNetwork().getConnectionManager();
+    for (auto &peer_id : warm_peers_) {
+      auto &state = peer_states_.at(peer_id);
+      if (not std::holds_alternative<PeerState::Connected>(state.state)) {
+        continue;
+      }
+      auto connection = connections.getBestConnectionForPeer(peer_id);
+      if (not connection) {
+        continue;
+      }
+      libp2p::coroSpawn(*io_context_,
+                        [status_protocol{status_protocol_},
+                         connection]() -> libp2p::Coro<void> {
+                          std::ignore =
+                              co_await status_protocol->connect(connection);
+                        });
+    }
+  }
+
+  bool NetworkingImpl::peerOnSubnets(const libp2p::PeerId &peer_id,
+                                     SubnetBits subnets) const {
+    auto it = peer_roles_.find(peer_id);
+    return it != peer_roles_.end() and (it->second.subnets & subnets) != 0;
+  }
+
+  PeerExchangeResponse NetworkingImpl::peerExchangeResponse(
+      const PeerExchangeRequest &request) const {
+    auto advert = [](const libp2p::PeerId &peer_id, const PeerRole &role) {
+      PeerAdvert advert{
+          .subnets = role.subnets,
+          .is_aggregator = role.is_aggregator,
+      };
+      auto bytes = peer_id.toVector();
+      advert.peer_id.data().assign(bytes.begin(), bytes.end());
+      return advert;
+    };
+    PeerExchangeResponse response;
+    response.peers.push_back(
+        advert(host_->getId(),
+               PeerRole{
+                   .subnets = subnetBits(wantedAttestationSubnets()),
+                   .is_aggregator = chain_spec_->isAggregator(),
+               }));
+
+    std::vector<PeerExchangeCandidate> candidates;
+    candidates.reserve(peer_states_.size());
+    for (auto &[peer_id, state] : peer_states_) {
+      if (state.info.addresses.empty()
+          or state.info.addresses.front().getBytesAddress().size()
+                 > kMaxPeerAddressSize) {
+        continue;
+      }
+      auto role_it = peer_roles_.find(peer_id);
+      auto &candidate = candidates.emplace_back(PeerExchangeCandidate{
+          .advert = advert(peer_id,
+                           role_it != peer_roles_.end() ? role_it->second
+                                                        : PeerRole{}),
+          .connected =
+              std::holds_alternative<PeerState::Connected>(state.state),
+      });
+      auto &address = state.info.addresses.front().getBytesAddress();
+      candidate.advert.address.data().assign(address.begin(), address.end());
+    }
+    for (auto &item : rankPeerAdverts(std::move(candidates), request)) {
+      response.peers.push_back(std::move(item));
+    }
+    return response;
+  }
+
+  void NetworkingImpl::discoverPeers() {
+    if (discovered_peers_.size() >= kMaxDiscoveredPeers) {
+      return;
+    }
+    // Own subnets with not enough connected peers
+    SubnetBits lacking = 0;
+    for (auto subnet : wantedAttestationSubnets()) {
+      auto connected = std::ranges::count_if(peer_states_, [&](auto &item) {
+        return std::holds_alternative<PeerState::Connected>(item.second.state)
+           and peerOnSubnets(item.first, subnetBit(subnet));
+      });
+      if (static_cast<size_t>(connected) < kDiscoverySubnetPeers) {
+        lacking |= subnetBit(subnet);
+      }
+    }
+    if (lacking == 0) {
+      return;
+    }
+
+    auto &protocol_repo = host_->getPeerRepository().getProtocolRepository();
+    std::vector<libp2p::PeerId> supported;
+    for (auto &[peer_id, state] : peer_states_) {
+      if (not std::holds_alternative<PeerState::Connected>(state.state)) {
+        continue;
+      }
+      // Protocol is specific to this client, peer advertises it by identify
+      auto protocols = protocol_repo.getProtocols(peer_id);
+      if (protocols.has_value()
+          and qtils::cxx23::ranges::contains(
+              protocols.value(), PeerExchangeProtocol::kProtocolId)) {
+        supported.emplace_back(peer_id);
+      }
+    }
+    std::ranges::shuffle(supported, random_);
+    if (supported.size() > kDiscoveryQueries) {
+      supported.resize(kDiscoveryQueries);
+    }
+    PeerExchangeRequest request{
+        .subnets = lacking,
+        .count = MAX_PEER_EXCHANGE_PEERS,
+    };
+    for (auto &peer_id : supported) {
+      libp2p::coroSpawn(
+          *io_context_,
+          [self{shared_from_this()}, peer_id, request]()
+              -> libp2p::Coro<void> {
+            auto res =
+                co_await self->peer_exchange_protocol_->request(peer_id,
+                                                                request);
+            if (not res.has_value()) {
+              self->metrics_->lean_peer_exchange({{"result", "failed"}})
+                  ->inc();
+              SL_DEBUG(self->logger_,
+                       "Peer exchange with {} failed: {}",
+                       peer_id,
+                       res.error());
+              co_return;
+            }
+            self->onPeerExchange(peer_id, res.value());
+          });
+    }
+  }
+
+  void NetworkingImpl::onPeerExchange(const libp2p::PeerId &from,
+                                      const PeerExchangeResponse &response) {
+    auto &adverts = response.peers.data();
+    if (adverts.empty()) {
+      return;
+    }
+    // First advert is responder's own
+    peer_roles_[from] = PeerRole{
+        .subnets = adverts.front().subnets,
+        .is_aggregator = adverts.front().is_aggregator,
+    };
+    // Single responder can't fill discovered peers with unreachable ones
+    auto from_responder = static_cast<size_t>(
+        std::ranges::count(discovered_peers_ | std::views::values,
+                           from,
+                           &DiscoveredPeer::responder));
+    size_t discovered = 0;
+    for (auto &advert : std::span{adverts}.subspan(1)) {
+      if (discovered_peers_.size() >= kMaxDiscoveredPeers
+          or from_responder >= kMaxDiscoveredPeersPerResponder) {
+        break;
+      }
+      auto peer_id = libp2p::PeerId::fromBytes(advert.peer_id.data());
+      if (not peer_id.has_value() or peer_id.value() == host_->getId()
+          or peer_states_.contains(peer_id.value())) {
+        continue;
+      }
+      auto address = libp2p::Multiaddress::create(advert.address.data());
+      if (not address.has_value()) {
+        continue;
+      }
+      peer_roles_.emplace(peer_id.value(),
+                          PeerRole{
+                              .subnets = advert.subnets,
+                              .is_aggregator = advert.is_aggregator,
+                          });
+      peer_states_.emplace(
+          peer_id.value(),
+          PeerState{
+              .info = {.id = peer_id.value(),
+                       .addresses = {std::move(address.value())}},
+              .state = PeerState::Connectable{.backoff = kInitBackoff},
+          });
+      discovered_peers_.emplace(peer_id.value(),
+                                DiscoveredPeer{.responder = from});
+      connectable_peers_.emplace_back(peer_id.value());
+      ++from_responder;
+      ++discovered;
+    }
+    if (discovered == 0) {
+      return;
+    }
+    metrics_->lean_peer_exchange({{"result", "discovered"}})
+        ->inc(static_cast<double>(discovered));
+    SL_DEBUG(logger_, "Discovered {} peers from {}", discovered, from);
+    connectToPeers();
+  }
+
+  std::shared_ptr<NetworkingImpl::PeerDial> NetworkingImpl::dialPeer(
+      PeerState &state) {
+    auto &connectable = std::get<PeerState::Connectable>(state.state);
+    // Connectable => Connecting
+    state.state = PeerState::Connecting{.backoff = connectable.backoff};
+    auto dial = std::make_shared<PeerDial>(PeerDial{.peer_id = state.info.id});
+    auto addresses = state.info.addresses;
+    std::ranges::stable_partition(
+        addresses, [](const libp2p::multi::Multiaddress &address) {
+          return libp2p::transport::detail::asQuic(address).has_value();
+        });
+    for (auto &address : addresses) {
+      dial->attempts.push_back({.id = state.info.id, .addresses = {address}});
+    }
+    if (dial->attempts.empty()) {
+      // Addresses are taken from peer repository
+      dial->attempts.emplace_back(state.info);
+    }
+    dialNextAddress(dial);
+    return dial;
+  }
+
+  void NetworkingImpl::dialNextAddress(const std::shared_ptr<PeerDial> &dial) {
+    if (dial->connected or dial->cancelled
+        or dial->next >= dial->attempts.size()) {
+      return;
+    }
+    auto peer_info = dial->attempts.at(dial->next);
+    ++dial->next;
+    ++dial->in_flight;
+    if (dial->next < dial->attempts.size()) {
+      dial->timer = std::make_shared<boost::asio::steady_timer>(
+          *io_context_, kAddressStagger);
+      dial->timer->async_wait([weak_self{weak_from_this()},
+                               dial](boost::system::error_code ec) {
+        auto self = weak_self.lock();
+        if (ec or not self) {
+          return;
+        }
+        self->dialNextAddress(dial);
+      });
+    }
+    libp2p::coroSpawn(
+        *io_context_,
+        [weak_self{weak_from_this()},
+         host{host_},
+         dial,
+         peer_info{std::move(peer_info)}]() -> libp2p::Coro<void> {
+          auto r = co_await host->connect(peer_info);
+          auto self = weak_self.lock();
+          if (not self) {
+            co_return;
+          }
+          --dial->in_flight;
+          SL_TRACE(self->logger_,
+                   "connectToPeers: connection attempt finished for peer {}",
+                   peer_info.id.toBase58());
+          if (r.has_value()) {
+            if (not dial->connected) {
+              dial->connected = true;
+              if (dial->timer) {
+                dial->timer->cancel();
+              }
+              SL_INFO(self->logger_,
+                      "Successfully connected to peer {}",
+                      peer_info.id.toBase58());
+            }
+            co_return;
+          }
+          SL_WARN(self->logger_,
+                  "connect={} error: {}",
+                  peer_info.id.toBase58(),
+                  r.error());
+          if (dial->connected) {
+            co_return;
+          }
+          if (not dial->cancelled and dial->next < dial->attempts.size()) {
+            // Next address without waiting for delay
+            dial->timer->cancel();
+            self->dialNextAddress(dial);
+            co_return;
+          }
+          if (dial->in_flight == 0) {
+            self->onDialFailed(*dial);
+          }
+        });
+  }
+
+  void NetworkingImpl::onDialFailed(const PeerDial &dial) {
+    auto &state = peer_states_.at(dial.peer_id);
+    auto *connecting = std::get_if<PeerState::Connecting>(&state.state);
+    if (not connecting) {
+      return;
+    }
+    auto backoff = connecting->backoff;
+    if (dial.cancelled) {
+      // Connecting => Connectable, left to connect timer
+      state.state = PeerState::Connectable{.backoff = backoff};
+      if (not subnet_aggregators_.contains(dial.peer_id)) {
+        connectable_peers_.emplace_back(dial.peer_id);
+      }
+      return;
+    }
+    if (auto it = discovered_peers_.find(dial.peer_id);
+        it != discovered_peers_.end()
+        and ++it->second.dial_failures >= kMaxDiscoveredPeerDialFailures) {
+      // Connecting => forgotten, so unreachable adverts don't stay known
+      SL_DEBUG(logger_,
+               "Discovered peer {} forgotten after {} dial failures",
+               dial.peer_id.toBase58(),
+               it->second.dial_failures);
+      discovered_peers_.erase(it);
+      peer_roles_.erase(dial.peer_id);
+      peer_states_.erase(dial.peer_id);
+      if (bootstrap_) {
+        bootstrapNext();
+      }
+      return;
+    }
+    // Connecting => Backoff
+    auto next_backoff = std::min(2 * backoff, kMaxBackoff);
+    state.state = PeerState::Backoff{
+        .backoff = next_backoff,
+        .backoff_until = Clock::now() + backoff,
+    };
+    SL_DEBUG(logger_,
+             "Peer {} moved to Backoff (new backoff={}ms)",
+             dial.peer_id.toBase58(),
+             next_backoff.count());
+    scheduleBackoff(dial.peer_id, backoff);
+    // Failed candidate is replaced at once
+    if (bootstrap_) {
+      bootstrapNext();
+    }
+  }
+
+  void NetworkingImpl::scheduleBackoff(const libp2p::PeerId &peer_id,
+                                       std::chrono::milliseconds backoff) {
+    timer_wheel_.add(backoff, [weak_self{weak_from_this()}, peer_id] {
+      auto self = weak_self.lock();
+      if (not self) {
+        return;
+      }
+      boost::asio::post(*self->io_context_, [weak_self, peer_id] {
+        auto self = weak_self.lock();
+        if (not self) {
+          return;
+        }
+        self->onBackoffExpired(peer_id);
+      });
+    });
+  }
+
+  void NetworkingImpl::onBackoffExpired(const libp2p::PeerId &peer_id) {
+    auto state_it = peer_states_.find(peer_id);
+    if (state_it == peer_states_.end()) {
+      return;
+    }
+    auto &state = state_it->second;
+    auto *backoff = std::get_if<PeerState::Backoff>(&state.state);
+    // Timer of earlier backoff fires before later backoff expires
+    if (backoff == nullptr or backoff->backoff_until > Clock::now()) {
+      return;
+    }
+    // Backoff => Connectable
+    SL_DEBUG(logger_,
+             "Peer {} backoff expired (backoff={}ms) => Connectable",
+             peer_id.toBase58(),
+             backoff->backoff.count());
+    state.state = PeerState::Connectable{.backoff = backoff->backoff};
+    if (not subnet_aggregators_.contains(peer_id)) {
+      connectable_peers_.emplace_back(peer_id);
+    }
+    // Warm peer is redialed once backoff expires, not on connect timer
+    if (warm_peers_.contains(peer_id)) {
+      connectToPeers();
+    }
+  }
+
+  void NetworkingImpl::startBootstrap() {
+    auto target = std::min(kBootstrapMeshPeers, wantedPeerCount());
+    if (target == 0) {
+      return;
+    }
+    auto bootstrap = std::make_shared<Bootstrap>();
+    bootstrap->started = Clock::now();
+    bootstrap->target = target;
+    bootstrap->timer.emplace(*io_context_);
+    // Aggregators of own subnets, then recently seen peers with lowest
+    // response time, then others in random order
+    auto &candidates = bootstrap->candidates;
+    candidates.assign(subnet_aggregators_.begin(), subnet_aggregators_.end());
+    for (auto &peer_id : peer_store_.best(PeerStore::SystemClock::now(),
+                                          kPeerStoreMaxAge,
+                                          peer_store_.records().size())) {
+      candidates.emplace_back(peer_id);
+    }
+    auto others = connectable_peers_;
+    std::ranges::shuffle(others, random_);
+    candidates.insert(candidates.end(), others.begin(), others.end());
+    SL_INFO(logger_,
+            "Bootstrap: dialing {} candidates until {} peers are connected",
+            candidates.size(),
+            target);
+    bootstrap_ = std::move(bootstrap);
+    bootstrapNext();
+  }
+
+  void NetworkingImpl::bootstrapNext() {
+    auto bootstrap = bootstrap_;
+    while (bootstrap->next < bootstrap->candidates.size()) {
+      auto &peer_id = bootstrap->candidates.at(bootstrap->next);
+      ++bootstrap->next;
+      auto state_it = peer_states_.find(peer_id);
+      if (state_it == peer_states_.end()
+          or not std::holds_alternative<PeerState::Connectable>(
+              state_it->second.state)) {
+        continue;
+      }
+      std::erase(connectable_peers_, peer_id);
+      bootstrap->dials.emplace_back(dialPeer(state_it->second));
+      break;
+    }
+    if (bootstrap->next >= bootstrap->candidates.size()) {
+      return;
+    }
+    // Cancels wait of previous dial, if started early by failure
+    bootstrap->timer->expires_after(kBootstrapDialStagger);
+    bootstrap->timer->async_wait(
+        [weak_self{weak_from_this()}](boost::system::error_code ec) {
+          auto self = weak_self.lock();
+          if (ec or not self or not self->bootstrap_) {
+            return;
+          }
+          self->bootstrapNext();
+        });
+  }
+
+  void NetworkingImpl::onBootstrapPeerConnected() {
+    auto bootstrap = bootstrap_;
+    if (not bootstrap) {
+      return;
+    }
+    auto elapsed =
+        std::chrono::duration<double>(Clock::now() - bootstrap->started)
+            .count();
+    if (not bootstrap->first_peer) {
+      bootstrap->first_peer = true;
+      metrics_->lean_network_time_to_first_peer_seconds()->set(elapsed);
+      SL_INFO(logger_, "Bootstrap: first peer connected in {:.3f}s", elapsed);
+    }
+    if (host_->getConnectedPeers().size() < bootstrap->target) {
+      return;
+    }
+    metrics_->lean_network_time_to_mesh_seconds()->set(elapsed);
+    SL_INFO(logger_,
+            "Bootstrap: {} peers connected in {:.3f}s",
+            bootstrap->target,
+            elapsed);
+    // Losing dials are cancelled, other candidates are left to connect timer
+    bootstrap->timer->cancel();
+    for (auto &weak_dial : bootstrap->dials) {
+      if (auto dial = weak_dial.lock(); dial and not dial->connected) {
+        dial->cancelled = true;
+        if (dial->timer) {
+          dial->timer->cancel();
+        }
+      }
+    }
+    bootstrap_.reset();
+  }
+
+  void NetworkingImpl::restorePeers(const libp2p::PeerId &own_peer_id) {
+    if (auto r = peer_store_.load(); not r.has_value()) {
+      SL_WARN(logger_, "Failed to load stored peers: {}", r.error());
+      return;
+    }
+    auto &peer_repo = host_->getPeerRepository();
+    size_t restored = 0;
+    for (auto &[peer_id, record] : peer_store_.records()) {
+      if (peer_id == own_peer_id) {
+        continue;
+      }
+      std::vector<libp2p::multi::Multiaddress> addresses;
+      for (auto &bytes : record.addresses.data()) {
+        if (auto address = libp2p::multi::Multiaddress::create(bytes.data())) {
+          addresses.emplace_back(std::move(address.value()));
+        }
+      }
+      if (addresses.empty()) {
+        continue;
+      }
+      std::vector<libp2p::peer::ProtocolName> protocols;
+      for (auto &protocol : record.protocols.data()) {
+        protocols.emplace_back(protocol.data().begin(), protocol.data().end());
+      }
+      std::ignore = peer_repo.getAddressRepository().upsertAddresses(
+          peer_id,
+          std::span<const libp2p::multi::Multiaddress>(addresses),
+          libp2p::peer::ttl::kRecentlyConnected);
+      std::ignore = peer_repo.getProtocolRepository().addProtocols(
+          peer_id, std::span<const libp2p::peer::ProtocolName>(protocols));
+      // Bootnodes keep addresses from chain spec
+      if (peer_states_.contains(peer_id)) {
+        continue;
+      }
+      peer_states_.emplace(
+          peer_id,
+          PeerState{
+              .info = {.id = peer_id, .addresses = std::move(addresses)},
+              .state = PeerState::Connectable{.backoff = kInitBackoff},
+          });
+      connectable_peers_.emplace_back(peer_id);
+      ++restored;
+    }
+    SL_INFO(logger_, "Restored {} stored peers", restored);
+  }
+
+  void NetworkingImpl::rememberPeer(const libp2p::PeerId &peer_id) {
+    auto &peer_repo = host_->getPeerRepository();
+    PeerRecord record;
+    auto addresses = peer_repo.getAddressRepository().getAddresses(peer_id);
+    if (not addresses.has_value() or addresses.value().empty()) {
+      if (auto state_it = peer_states_.find(peer_id);
+          state_it != peer_states_.end()) {
+        addresses = state_it->second.info.addresses;
+      }
+    }
+    if (addresses.has_value()) {
+      for (auto &address : addresses.value()) {
+        auto &bytes = address.getBytesAddress();
+        if (record.addresses.size() >= kMaxPeerAddresses) {
+          break;
+        }
+        if (bytes.size() > kMaxPeerAddressSize) {
+          continue;
+        }
+        ssz::list<uint8_t, kMaxPeerAddressSize> item;
+        item.data().assign(bytes.begin(), bytes.end());
+        record.addresses.push_back(std::move(item));
+      }
+    }
+    if (record.addresses.data().empty()) {
+      return;
+    }
+    record.last_seen_ms = PeerStore::toMs(PeerStore::SystemClock::now());
+    auto score = peer_scores_.get(peer_id);
+    record.rtt_us = static_cast<uint64_t>(
+        (score ? score->rtt : PeerScore::kInitialRtt).count());
+    auto protocols = peer_repo.getProtocolRepository().getProtocols(peer_id);
+    if (protocols.has_value()) {
+      for (auto &protocol : protocols.value()) {
+        if (record.protocols.size() >= kMaxPeerProtocols) {
+          break;
+        }
+        if (protocol.size() > kMaxPeerProtocolSize) {
+          continue;
+        }
+        ssz::list<uint8_t, kMaxPeerProtocolSize> item;
+        item.data().assign(protocol.begin(), protocol.end());
+        record.protocols.push_back(std::move(item));
+      }
+    }
+    peer_store_.put(peer_id, std::move(record));
+  }
+
+  void NetworkingImpl::flushPeers() {
+    for (auto &peer_id : host_->getConnectedPeers()) {
+      rememberPeer(peer_id);
+    }
+    if (auto r = peer_store_.flush(); not r.has_value()) {
+      SL_WARN(logger_, "Failed to store peers: {}", r.error());
+    }
+  }
+
+  std::string NetworkingImpl::peerClient(const libp2p::PeerId &peer_id) const {
+    const auto &ua_repo = host_->getPeerRepository().getUserAgentRepository();
+    auto ua = ua_repo.getUserAgent(peer_id).value_or("");
+    // To lower case + drop version if any
+    for (size_t i = 0; i < ua.size(); ++i) {
+      auto &ch = ua[i];
+      if (ch == '/') {
+        ua.resize(i);
+        break;
+      }
+      if (ch >= 'A' and ch <= 'Z') {
+        ch = static_cast<char>(ch - 'A' + 'a');
+      }
+    }
+    if (ua.empty()) {
+      ua = "unknown";
+    }
+    return ua;
+  }
+
   void NetworkingImpl::updateMetricConnectedPeerCount() {
     // currently metrics don't forget labels, explicitly reset their count
     for (auto &count : connected_peer_count_by_name_ | std::views::values) {
       count = 0;
     }
 
-    const auto &ua_repo = host_->getPeerRepository().getUserAgentRepository();
-
     for (const auto &peer_id : host_->getConnectedPeers()) {
       auto name_it = peer_name_.find(peer_id);
       if (name_it != peer_name_.end()) {
@@ -1071,22 +2588,7 @@ namespace lean::modules {
         continue;
       }
 
-      auto ua = ua_repo.getUserAgent(peer_id).value_or("");
-      // To lower case + drop version if any
-      for (size_t i = 0; i < ua.size(); ++i) {
-        auto &ch = ua[i];
-        if (ch == '/') {
-          ua.resize(i);
-          break;
-        }
-        if (ch >= 'A' and ch <= 'Z') {
-          ch = static_cast<char>(ch - 'A' + 'a');
-        }
-      }
-      if (ua.empty()) {
-        ua = "unknown";
-      }
-      ++connected_peer_count_by_name_[ua];
+      ++connected_peer_count_by_name_[peerClient(peer_id)];
     }
 
     for (const auto &[kind, number] : connected_peer_count_by_name_) {
@@ -1098,55 +2600,135 @@ namespace lean::modules {
             connected_peer_count_by_name_));
   }
 
+  void NetworkingImpl::updateMetricMemory() {
+    auto set = [&](const char *subsystem, size_t bytes) {
+      metrics_->app_memory_usage_bytes({{"subsystem", subsystem}})->set(bytes);
+    };
+    set("network_orphan_blocks", orphan_blocks_.byteSize());
+    set("network_pending_attestations",
+        attestation_cache_.byteSize()
+            + aggregated_attestation_cache_.byteSize());
+    set("network_encoded_blocks", encoded_blocks_->byteSize());
+    set("network_encoded_state", state_request_protocol_->byteSize());
+  }
+
+  void NetworkingImpl::prefetchStates(const Block &block) {
+    // Attestations replayed and aggregated after import look up target states
+    std::vector<BlockHash> hashes;
+    for (auto &attestation : block.body.attestations) {
+      auto &target = attestation.data.target.root;
+      if (block_tree_->has(target)
+          and not qtils::cxx23::ranges::contains(hashes, target)) {
+        hashes.emplace_back(target);
+      }
+    }
+    fork_choice_store_->prefetchStates(std::move(hashes));
+  }
+
   void NetworkingImpl::prune() {
     auto finalized = block_tree_->lastFinalized();
-    std::erase_if(block_cache_,
-                  [&](const decltype(block_cache_)::value_type &p) {
-                    if (p.second.block.block.slot <= finalized.slot) {
-                      block_children_.erase(p.second.child_it);
-                      return true;
-                    }
-                    return false;
-                  });
-    std::erase_if(attestation_cache_,
-                  [&](const decltype(attestation_cache_)::value_type &p) {
-                    return p.second.data.head.slot <= finalized.slot;
-                  });
-    std::erase_if(
-        aggregated_attestation_cache_,
-        [&](const decltype(aggregated_attestation_cache_)::value_type &p) {
-          return p.second.data.head.slot <= finalized.slot;
-        });
+    orphan_blocks_.prune(finalized.slot);
+    attestation_cache_.expire(finalized.slot);
+    aggregated_attestation_cache_.expire(finalized.slot);
   }
 
-  void NetworkingImpl::consumeBlockTree(bool init_good,
-                                        BlockHash init_hash,
-                                        BlockConsumer consume) {
-    std::deque queue{std::make_pair(init_good, init_hash)};
+  void NetworkingImpl::importOrphanBlocks(const BlockHash &hash) {
+    std::deque queue{hash};
+    // Segment of received block, then forks of cached orphans
+    auto priority = ForkChoiceStoreMutex::Priority::BLOCK;
     while (not queue.empty()) {
-      const auto [good, hash] = queue.front();
+      auto segment = orphan_blocks_.takeSegment(queue.front());
       queue.pop_front();
-      auto block_it = block_cache_.find(hash);
-      if (block_it == block_cache_.end()) {
-        SL_FATAL(logger_, "consumeBlockTree inconsistent block {}", hash);
-      }
-      auto block = std::move(block_it->second.block);
-      block_children_.erase(block_it->second.child_it);
-      block_cache_.erase(block_it);
-      auto attestations = consumeMultimap(attestation_cache_, hash);
-      auto aggregated_attestations =
-          consumeMultimap(aggregated_attestation_cache_, hash);
-      const auto new_good = consume
-                              ? consume(good,
-                                        std::move(block),
-                                        std::move(attestations),
-                                        std::move(aggregated_attestations))
-                              : good;
-      auto [child_begin, child_end] = block_children_.equal_range(hash);
-      for (auto &child :
-           std::ranges::subrange{child_begin, child_end} | std::views::values) {
-        queue.emplace_back(new_good, child);
+      if (segment.empty()) {
+        continue;
+      }
+      std::vector<BlockIndex> indices;
+      indices.reserve(segment.size());
+      for (auto &block : segment) {
+        indices.emplace_back(block.block.index());
+      }
+
+      auto import =
+          fork_choice_store_->onBlocks(std::move(segment), priority);
+      priority = ForkChoiceStoreMutex::Priority::BACKGROUND;
+      for (auto &index : std::span{indices}.first(import.imported)) {
+        SL_INFO_LIMITED(logger_, "✅ Imported block {}", index);
+        importPendingAttestations(index.hash);
       }
+      if (import.imported != indices.size()) {
+        SL_WARN(logger_,
+                "❌ Error importing block={}: {}",
+                indices[import.imported],
+                import.result.error());
+        // Descendants of invalid block can't be imported
+        for (auto &index : std::span{indices}.subspan(import.imported)) {
+          attestation_cache_.take(index.hash);
+          aggregated_attestation_cache_.take(index.hash);
+        }
+        for (auto &child : orphan_blocks_.children(indices.back().hash)) {
+          discardOrphanBlocks(child);
+        }
+        continue;
+      }
+      std::ranges::move(orphan_blocks_.children(indices.back().hash),
+                        std::back_inserter(queue));
+    }
+  }
+
+  void NetworkingImpl::importPendingAttestations(const BlockHash &hash) {
+    auto finalized_slot = block_tree_->lastFinalized().slot;
+    // Same vote may have been accepted meanwhile for another head
+    auto accepted = [&](auto &&attestations) {
+      std::erase_if(attestations, [&](auto &attestation) {
+        return gossip_filter_->check(attestation, finalized_slot)
+            != GossipFilter::Verdict::Accept;
+      });
+      return std::move(attestations);
+    };
+    auto attestations = accepted(attestation_cache_.take(hash));
+    auto aggregated_attestations =
+        accepted(aggregated_attestation_cache_.take(hash));
+    if (attestations.empty() and aggregated_attestations.empty()) {
+      return;
+    }
+
+    auto import = fork_choice_store_->onPendingAttestations(
+        attestations, aggregated_attestations);
+    size_t imported = 0;
+    std::optional<outcome::result<void>> first_error;
+    auto collect = [&](auto &batch, auto &results) {
+      for (size_t i = 0; i < batch.size(); ++i) {
+        if (not results[i].has_value()) {
+          if (not first_error.has_value()) {
+            first_error = results[i];
+          }
+          continue;
+        }
+        ++imported;
+        gossip_filter_->markSeen(batch[i]);
+      }
+    };
+    collect(attestations, import.attestations);
+    collect(aggregated_attestations, import.aggregated_attestations);
+    auto total = attestations.size() + aggregated_attestations.size();
+    SL_INFO_LIMITED(logger_,
+                    "Imported {} of {} pending attestations for block {:0xx}",
+                    imported,
+                    total,
+                    hash);
+    if (first_error.has_value()) {
+      SL_WARN(logger_,
+              "Error importing {} pending attestations for block {:0xx}: {}",
+              total - imported,
+              hash,
+              first_error->error());
+    }
+  }
+
+  void NetworkingImpl::discardOrphanBlocks(const BlockHash &hash) {
+    for (auto &removed : orphan_blocks_.discard(hash)) {
+      attestation_cache_.take(removed);
+      aggregated_attestation_cache_.take(removed);
     }
   }
 }  // namespace lean::modules
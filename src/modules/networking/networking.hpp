@@ -6,17 +6,26 @@
 
 #pragma once
 
+#include <map>
 #include <random>
+#include <set>
 #include <thread>
 #include <unordered_set>
 
 #include <libp2p/event/bus.hpp>
 #include <libp2p/peer/peer_info.hpp>
 #include <log/logger.hpp>
+#include <modules/networking/gossip_filter.hpp>
 #include <modules/networking/interfaces.hpp>
+#include <modules/networking/orphan_blocks.hpp>
+#include <modules/networking/peer_scores.hpp>
+#include <modules/networking/peer_store.hpp>
+#include <modules/networking/pending_attestations.hpp>
+#include <modules/networking/sync_mode.hpp>
 #include <qtils/create_smart_pointer_macros.hpp>
 #include <qtils/shared_ref.hpp>
 #include <utils/ctor_limiters.hpp>
+#include <utils/timer_wheel.hpp>
 
 namespace boost::asio {
   class io_context;
@@ -41,7 +50,10 @@ namespace lean {
   class StateSyncClient;
   class ForkChoiceStoreMutex;
   struct GenesisConfig;
+  struct PeerExchangeRequest;
+  struct PeerExchangeResponse;
   class ValidatorRegistry;
+  class Watchdog;
 }  // namespace lean
 
 namespace lean::app {
@@ -50,6 +62,10 @@ namespace lean::app {
   class Configuration;
 }  // namespace lean::app
 
+namespace lean::storage {
+  class SpacedStorage;
+}  // namespace lean::storage
+
 namespace lean::blockchain {
   class BlockTree;
 }  // namespace lean::blockchain
@@ -61,7 +77,14 @@ namespace lean::metrics {
 
 namespace lean::modules {
   class StatusProtocol;
+  class AttestationPushProtocol;
+  class PeerExchangeProtocol;
   class BlockRequestProtocol;
+  class BlockRangeRequestProtocol;
+  class StateRequestProtocol;
+  class EncodedBlockCache;
+  class HistoryBackfill;
+  class TrafficShaper;
 
   using Clock = std::chrono::steady_clock;
 
@@ -112,6 +135,13 @@ namespace lean::modules {
     std::variant<Connectable, Connecting, Connected, Backoff> state;
   };
 
+  /// Attestation subnets and role of peer, from ENR or peer exchange
+  struct PeerRole {
+    /// Bit per subnet, as ENR `attnets`
+    uint64_t subnets = 0;
+    bool is_aggregator = false;
+  };
+
   /**
    * Network module.
    *
@@ -134,7 +164,9 @@ namespace lean::modules {
                    qtils::SharedRef<ValidatorRegistry> validator_registry,
                    qtils::SharedRef<GenesisConfig> genesis_config,
                    qtils::SharedRef<app::ChainSpec> chain_spec,
-                   qtils::SharedRef<app::Configuration> config);
+                   qtils::SharedRef<app::Configuration> config,
+                   qtils::SharedRef<Watchdog> watchdog,
+                   qtils::SharedRef<storage::SpacedStorage> storage);
 
    public:
     CREATE_SHARED_METHOD(NetworkingImpl);
@@ -151,40 +183,145 @@ namespace lean::modules {
     void onSendSignedAggregatedAttestation(
         std::shared_ptr<const messages::SendSignedAggregatedAttestation>
             message) override;
+    void onSendGossipBatch(
+        std::shared_ptr<const messages::SendGossipBatch> message) override;
 
    private:
-    using BlockChildren = std::unordered_multimap<BlockHash, BlockHash>;
-
-    struct BlockCacheItem {
-      BlockChildren::iterator child_it;
-      SignedBlock block;
-    };
+    struct PeerDial;
+    struct Bootstrap;
 
     template <typename T>
     std::shared_ptr<libp2p::protocol::gossip::Topic> gossipSubscribe(
         std::string_view type, metrics::Histogram *metric, auto f);
+    /// Arrival delay of gossip message, and inclusion distance for blocks
+    template <typename T>
+    void observeGossipArrival(std::string_view topic,
+                              const T &message,
+                              const std::optional<libp2p::PeerId> &peer_id);
+    /// Client of peer by user agent, lower case without version
+    std::string peerClient(const libp2p::PeerId &peer_id) const;
+
+    /// Subnets of own validators, and aggregated ones while aggregator
+    std::set<SubnetIndex> wantedAttestationSubnets() const;
+    /// Subscribe to wanted attestation subnets and leave others
+    void updateAttestationSubnets();
+    void receiveGossipAttestation(SignedAttestation &&signed_attestation,
+                                  std::optional<libp2p::PeerId> peer_id);
+    void receiveGossipAggregatedAttestation(
+        SignedAggregatedAttestation &&signed_aggregated_attestation,
+        std::optional<libp2p::PeerId> peer_id);
+
+    /**
+     * Check slot of gossip block through `SignedBlockView`, so blocks of
+     * finalized slots are dropped without decoding signatures and body.
+     */
+    bool gossipBlockIsFinalized(qtils::BytesIn compressed);
+    /// Publish encoded message, and account it
+    void gossipPublish(libp2p::protocol::gossip::Topic &topic,
+                       qtils::ByteVec message);
+    /// Send own attestation to connected aggregators of its subnet, if
+    /// enabled, in addition to gossip
+    void pushToAggregators(const SignedAttestation &signed_attestation);
 
+    /**
+     * Count gossip attestation sent for verification on worker pool.
+     * @return false if too many verifications are in flight already
+     */
+    bool beginGossipVerification();
     void receiveStatus(const messages::StatusMessageReceived &message);
+    /**
+     * Request missing block or its missing ancestor from `peer_id`, or from
+     * much better scoring peer.
+     * Same block is requested from another peer, if first doesn't respond
+     * within hedge delay.
+     */
     void requestBlock(const libp2p::PeerId &peer_id, BlockHash block_hash);
+    /// Request block from other peer, if still waiting for `peer_id`
+    void hedgeBlockRequest(const libp2p::PeerId &peer_id,
+                           const BlockHash &block_hash,
+                           Clock::time_point requested_at);
+    /**
+     * Send queued block requests of peer in batches, while number of
+     * requests in flight is below limit.
+     */
+    void flushBlockRequests(const libp2p::PeerId &peer_id);
+    /**
+     * Request consecutive blocks after our best block, until peer head is
+     * reached.
+     */
+    void requestBlockRange(const libp2p::PeerId &peer_id,
+                           const BlockIndex &peer_head);
     void receiveBlock(std::optional<libp2p::PeerId> peer_id,
                       SignedBlock &&block);
+    /**
+     * Cache whole range response and import it by segments, instead of
+     * importing blocks one by one.
+     */
+    void receiveBlockRange(const libp2p::PeerId &peer_id,
+                           std::vector<SignedBlock> &&blocks);
+    /// Switch sync mode by distance to head of peers
+    void updateSyncMode();
+    /**
+     * Request next range of finalized history behind checkpoint sync
+     * anchor, in relaxed phases of slot, outside of bulk sync and within
+     * bandwidth budget.
+     */
+    void backfillHistory();
     bool statusFinalizedIsGood(const BlockIndex &slot_hash);
     /**
      * Called periodically to connect to more peers if there are not enough
      * connections.
      */
     void connectToPeers();
+    /// Backoff => Connectable once backoff of peer expires
+    void scheduleBackoff(const libp2p::PeerId &peer_id,
+                         std::chrono::milliseconds backoff);
+    void onBackoffExpired(const libp2p::PeerId &peer_id);
+    /// Max peers to connect to, from bootnodes and stored peers
+    size_t wantedPeerCount() const;
+    /// Exchange status with connected warm peers, so they stay connected
+    void keepWarmPeersAlive();
+    /// Peer is known to be on any of `subnets`
+    bool peerOnSubnets(const libp2p::PeerId &peer_id, uint64_t subnets) const;
+    /// Respond to peer exchange, own role first
+    PeerExchangeResponse peerExchangeResponse(
+        const PeerExchangeRequest &request) const;
+    /// Query connected peers for peers of own subnets lacking peers
+    void discoverPeers();
+    /// Add unknown peers of response as connectable, with their roles
+    void onPeerExchange(const libp2p::PeerId &from,
+                        const PeerExchangeResponse &response);
+    /// Connectable => Connecting, and connect to peer
+    std::shared_ptr<PeerDial> dialPeer(PeerState &state);
+    /// Connect to next address of peer, next one is raced after delay
+    void dialNextAddress(const std::shared_ptr<PeerDial> &dial);
+    void onDialFailed(const PeerDial &dial);
+    /// Dial candidates with staggered starts, until mesh peers connect
+    void startBootstrap();
+    void bootstrapNext();
+    void onBootstrapPeerConnected();
+    /// Add stored peers to connectable ones, and dial best recent of them
+    void restorePeers(const libp2p::PeerId &own_peer_id);
+    /// Update stored record of peer from peer repository and scores
+    void rememberPeer(const libp2p::PeerId &peer_id);
+    /// Remember connected peers and write changed records
+    void flushPeers();
     void updateMetricConnectedPeerCount();
+    /// Estimated memory of caches, called periodically
+    void updateMetricMemory();
+    /// Load states needed after import of block waiting for parent
+    void prefetchStates(const Block &block);
     void prune();
 
-    using BlockConsumer =
-        std::function<bool(bool,
-                           SignedBlock,
-                           std::vector<SignedAttestation>,
-                           std::vector<SignedAggregatedAttestation>)>;
-    void consumeBlockTree(bool init_good,
-                          BlockHash init_hash,
-                          BlockConsumer consume);
+    /**
+     * Import cached block `hash` with imported parent, and its cached
+     * descendants, by chain segments.
+     */
+    void importOrphanBlocks(const BlockHash &hash);
+    /// Import attestations waiting for just imported block
+    void importPendingAttestations(const BlockHash &hash);
+    /// Forget cached block `hash`, its descendants and their attestations
+    void discardOrphanBlocks(const BlockHash &hash);
 
     NetworkingLoader &loader_;
     log::Logger logger_;
@@ -196,31 +333,55 @@ namespace lean::modules {
     qtils::SharedRef<GenesisConfig> genesis_config_;
     qtils::SharedRef<app::ChainSpec> chain_spec_;
     qtils::SharedRef<app::Configuration> config_;
+    qtils::SharedRef<Watchdog> watchdog_;
     std::shared_ptr<void> injector_;
     std::shared_ptr<boost::asio::io_context> io_context_;
     std::optional<std::thread> io_thread_;
+    /**
+     * Backoff and block request retry timers of all peers, tasks are posted
+     * to `io_context_`.
+     */
+    TimerWheel timer_wheel_;
     libp2p::event::Handle on_peer_connected_sub_;
     libp2p::event::Handle on_peer_disconnected_sub_;
     libp2p::event::Handle on_connection_closed_sub_;
     std::shared_ptr<StatusProtocol> status_protocol_;
+    std::shared_ptr<EncodedBlockCache> encoded_blocks_;
+    std::shared_ptr<TrafficShaper> traffic_;
     std::shared_ptr<BlockRequestProtocol> block_request_protocol_;
+    std::shared_ptr<BlockRangeRequestProtocol> block_range_request_protocol_;
+    std::shared_ptr<StateRequestProtocol> state_request_protocol_;
+    std::shared_ptr<AttestationPushProtocol> attestation_push_protocol_;
+    std::shared_ptr<PeerExchangeProtocol> peer_exchange_protocol_;
     std::shared_ptr<libp2p::protocol::gossip::Gossip> gossip_;
     std::shared_ptr<libp2p::protocol::Ping> ping_;
     std::shared_ptr<libp2p::host::BasicHost> host_;
     std::shared_ptr<libp2p::protocol::Identify> identify_;
     std::shared_ptr<libp2p::protocol::gossip::Topic> gossip_blocks_topic_;
-    std::shared_ptr<libp2p::protocol::gossip::Topic> gossip_votes_topic_;
+    /// Topics of subscribed attestation subnets
+    std::map<SubnetIndex, std::shared_ptr<libp2p::protocol::gossip::Topic>>
+        attestation_topics_;
+    /// Null for optimistic follower
     std::shared_ptr<libp2p::protocol::gossip::Topic>
         gossip_signed_aggregated_attestation_topic_;
     std::unordered_map<BlockHash, Clock::time_point> block_requested_at_;
-    std::unordered_map<BlockHash, BlockCacheItem> block_cache_;
-    BlockChildren block_children_;
-    std::unordered_multimap<BlockHash, SignedAttestation> attestation_cache_;
-    std::unordered_multimap<BlockHash, SignedAggregatedAttestation>
+    std::unordered_map<libp2p::PeerId, std::vector<BlockHash>>
+        queued_block_requests_;
+    /// Only peers with block requests in flight, erased at zero
+    std::unordered_map<libp2p::PeerId, size_t> block_requests_in_flight_;
+    /**
+     * Peers with range request in flight.
+     */
+    std::unordered_set<libp2p::PeerId> range_sync_peers_;
+    OrphanBlocks orphan_blocks_;
+    PendingAttestations<SignedAttestation> attestation_cache_;
+    PendingAttestations<SignedAggregatedAttestation>
         aggregated_attestation_cache_;
     std::default_random_engine random_;
     std::shared_ptr<AsioSslContext> ssl_context_;
     std::unique_ptr<StateSyncClient> state_sync_client_;
+    /// Nullptr when history is complete
+    std::unique_ptr<HistoryBackfill> backfill_;
     /**
      * Array of connectable peers to pick random peer from.
      */
@@ -229,10 +390,49 @@ namespace lean::modules {
      * Bootnode peers states.
      */
     std::unordered_map<libp2p::PeerId, PeerState> peer_states_;
+    /// Known subnets and roles of peers
+    std::unordered_map<libp2p::PeerId, PeerRole> peer_roles_;
+    struct DiscoveredPeer {
+      /// Peer which advertised it
+      libp2p::PeerId responder;
+      /// Dial failures in a row
+      size_t dial_failures = 0;
+    };
+    /// Peers added to `peer_states_` by peer exchange
+    std::unordered_map<libp2p::PeerId, DiscoveredPeer> discovered_peers_;
+    /**
+     * Block request performance of connected peers.
+     */
+    PeerScores peer_scores_;
+    SyncMode sync_mode_;
+    /// Peers known from previous runs
+    PeerStore peer_store_;
     std::unordered_map<libp2p::PeerId, std::string> peer_name_;
     std::unordered_map<std::string, size_t> connected_peer_count_by_name_;
+    struct GossipArrivalMetrics {
+      metrics::Histogram *delay;
+      metrics::Histogram *inclusion_distance = nullptr;
+    };
+    /// Labelled histograms by topic and client, see `observeGossipArrival`
+    std::unordered_map<std::string, GossipArrivalMetrics>
+        gossip_arrival_metrics_;
     std::unordered_set<libp2p::PeerId> subnet_aggregators_;
+    /**
+     * Bootnodes, including aggregators. Their idle connections are kept
+     * open by status exchange, and they are redialed soon after
+     * disconnect.
+     */
+    std::unordered_set<libp2p::PeerId> warm_peers_;
+    /// Aggregator bootnodes by subnet of their validator
+    std::multimap<SubnetIndex, libp2p::PeerId> aggregators_by_subnet_;
     uint64_t subnet_count_;
+    std::optional<GossipFilter> gossip_filter_;
+    /// Staggered dialing at start, reset once done
+    std::shared_ptr<Bootstrap> bootstrap_;
+    /**
+     * Gossip attestations being verified on worker pool.
+     */
+    size_t gossip_verifications_in_flight_ = 0;
   };
 
 }  // namespace lean::modules
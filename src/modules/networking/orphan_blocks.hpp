@@ -0,0 +1,157 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <deque>
+#include <iterator>
+#include <ranges>
+#include <unordered_map>
+#include <vector>
+
+#include "types/block_hash.hpp"
+#include "types/signed_block.hpp"
+#include "types/slot.hpp"
+#include "utils/memory_usage.hpp"
+
+namespace lean::modules {
+  /**
+   * Pool of received blocks waiting for their unknown parent.
+   *
+   * Blocks are indexed by parent, so when parent is imported, its cached
+   * descendants are taken as chain segments: segment continues while block
+   * has single cached child, and whole segment is imported in one batch.
+   * Not thread safe, used from io thread.
+   */
+  class OrphanBlocks {
+   public:
+    size_t size() const {
+      return blocks_.size();
+    }
+
+    /// Estimated memory used by cached blocks
+    size_t byteSize() const {
+      auto bytes = memory_usage::hashBytes(blocks_)
+                 + memory_usage::hashBytes(children_);
+      for (auto &item : blocks_ | std::views::values) {
+        bytes += ssz::size(item.block);
+      }
+      return bytes;
+    }
+
+    bool contains(const BlockHash &hash) const {
+      return blocks_.contains(hash);
+    }
+
+    /// Cached block, or nullptr
+    const SignedBlock *find(const BlockHash &hash) const {
+      auto it = blocks_.find(hash);
+      return it != blocks_.end() ? &it->second.block : nullptr;
+    }
+
+    /// Add block with hash set, whose parent is not imported yet
+    const SignedBlock &add(SignedBlock signed_block) {
+      auto hash = signed_block.block.hash();
+      if (auto it = blocks_.find(hash); it != blocks_.end()) {
+        return it->second.block;
+      }
+      auto child_it = children_.emplace(signed_block.block.parent_root, hash);
+      return blocks_
+          .emplace(hash,
+                   Item{
+                       .child_it = child_it,
+                       .block = std::move(signed_block),
+                   })
+          .first->second.block;
+    }
+
+    /// Hashes of cached children of `parent_hash`
+    std::vector<BlockHash> children(const BlockHash &parent_hash) const {
+      std::vector<BlockHash> hashes;
+      auto [begin, end] = children_.equal_range(parent_hash);
+      for (auto it = begin; it != end; ++it) {
+        hashes.emplace_back(it->second);
+      }
+      return hashes;
+    }
+
+    /**
+     * Remove and return chain segment starting at cached block `hash`, each
+     * block being child of previous one.
+     * Children of last block stay cached, as heads of next segments.
+     */
+    std::vector<SignedBlock> takeSegment(BlockHash hash) {
+      std::vector<SignedBlock> segment;
+      while (true) {
+        auto it = blocks_.find(hash);
+        if (it == blocks_.end()) {
+          break;
+        }
+        segment.emplace_back(take(it));
+        auto [begin, end] = children_.equal_range(hash);
+        if (begin == end or std::next(begin) != end) {
+          break;
+        }
+        hash = begin->second;
+      }
+      return segment;
+    }
+
+    /**
+     * Remove cached block `hash` and its cached descendants.
+     * @return hashes of removed blocks
+     */
+    std::vector<BlockHash> discard(const BlockHash &hash) {
+      std::vector<BlockHash> removed;
+      std::deque queue{hash};
+      while (not queue.empty()) {
+        auto current = queue.front();
+        queue.pop_front();
+        auto it = blocks_.find(current);
+        if (it == blocks_.end()) {
+          continue;
+        }
+        take(it);
+        removed.emplace_back(current);
+        auto [begin, end] = children_.equal_range(current);
+        for (auto child_it = begin; child_it != end; ++child_it) {
+          queue.emplace_back(child_it->second);
+        }
+      }
+      return removed;
+    }
+
+    /// Remove blocks with slot not after `slot`
+    void prune(Slot slot) {
+      std::erase_if(blocks_, [&](const auto &item) {
+        if (item.second.block.block.slot <= slot) {
+          children_.erase(item.second.child_it);
+          return true;
+        }
+        return false;
+      });
+    }
+
+   private:
+    using Children = std::unordered_multimap<BlockHash, BlockHash>;
+
+    struct Item {
+      Children::iterator child_it;
+      SignedBlock block;
+    };
+
+    SignedBlock take(std::unordered_map<BlockHash, Item>::iterator it) {
+      auto block = std::move(it->second.block);
+      children_.erase(it->second.child_it);
+      blocks_.erase(it);
+      return block;
+    }
+
+    std::unordered_map<BlockHash, Item> blocks_;
+    /// Hashes of cached blocks by parent hash
+    Children children_;
+  };
+}  // namespace lean::modules
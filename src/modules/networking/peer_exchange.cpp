@@ -0,0 +1,38 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "modules/networking/peer_exchange.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <span>
+#include <tuple>
+
+namespace lean {
+  std::vector<PeerAdvert> rankPeerAdverts(
+      std::vector<PeerExchangeCandidate> candidates,
+      const PeerExchangeRequest &request) {
+    auto count = std::min<size_t>(
+        {request.count, MAX_PEER_EXCHANGE_PEERS, candidates.size()});
+    std::ranges::partial_sort(
+        candidates,
+        candidates.begin() + static_cast<ptrdiff_t>(count),
+        std::greater{},
+        [&](const PeerExchangeCandidate &candidate) {
+          return std::tuple{
+              (candidate.advert.subnets & request.subnets) != 0,
+              candidate.advert.is_aggregator,
+              candidate.connected,
+          };
+        });
+    std::vector<PeerAdvert> adverts;
+    adverts.reserve(count);
+    for (auto &candidate : std::span{candidates}.first(count)) {
+      adverts.emplace_back(std::move(candidate.advert));
+    }
+    return adverts;
+  }
+}  // namespace lean
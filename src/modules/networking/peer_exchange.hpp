@@ -0,0 +1,28 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "modules/networking/types.hpp"
+
+namespace lean {
+  /// Known peer which may be advertised by peer exchange response
+  struct PeerExchangeCandidate {
+    PeerAdvert advert;
+    bool connected = false;
+  };
+
+  /**
+   * Pick adverts for peer exchange response, at most `request.count` and
+   * `MAX_PEER_EXCHANGE_PEERS`. Peers on requested subnets come first,
+   * then aggregators, then connected peers.
+   */
+  std::vector<PeerAdvert> rankPeerAdverts(
+      std::vector<PeerExchangeCandidate> candidates,
+      const PeerExchangeRequest &request);
+}  // namespace lean
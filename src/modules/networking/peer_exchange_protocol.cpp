@@ -0,0 +1,93 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "modules/networking/peer_exchange_protocol.hpp"
+
+#include <libp2p/coro/spawn.hpp>
+#include <libp2p/host/basic_host.hpp>
+
+#include "modules/networking/req_resp_metrics.hpp"
+#include "modules/networking/response_status.hpp"
+#include "modules/networking/ssz_snappy.hpp"
+
+namespace lean::modules {
+  constexpr auto kTrafficProtocol = TrafficShaper::Protocol::PeerExchange;
+
+  PeerExchangeProtocol::PeerExchangeProtocol(
+      std::shared_ptr<boost::asio::io_context> io_context,
+      std::shared_ptr<libp2p::host::BasicHost> host,
+      qtils::SharedRef<TrafficShaper> traffic,
+      GetPeers get_peers)
+      : io_context_{std::move(io_context)},
+        host_{std::move(host)},
+        traffic_{std::move(traffic)},
+        get_peers_{std::move(get_peers)} {}
+
+  libp2p::StreamProtocols PeerExchangeProtocol::getProtocolIds() const {
+    return {std::string{kProtocolId}};
+  }
+
+  void PeerExchangeProtocol::handle(std::shared_ptr<libp2p::Stream> stream) {
+    libp2p::coroSpawn(
+        *io_context_,
+        [self{shared_from_this()}, stream]() -> libp2p::Coro<void> {
+          std::ignore = co_await self->coroHandle(stream);
+        });
+  }
+
+  void PeerExchangeProtocol::start() {
+    host_->listenProtocol(shared_from_this());
+  }
+
+  libp2p::CoroOutcome<PeerExchangeResponse> PeerExchangeProtocol::request(
+      libp2p::PeerId peer_id, PeerExchangeRequest request) {
+    BOOST_OUTCOME_CO_TRY(
+        auto stream, co_await host_->newStream(peer_id, getProtocolIds()));
+    StreamDeadline deadline{*io_context_, stream, kResponseTimeout};
+    auto encoded = encode(request).value();
+    auto framed = snappy::compressFramed(encoded);
+    traffic_->record(kTrafficProtocol,
+                     TrafficShaper::Direction::Out,
+                     peer_id,
+                     framed.size());
+    BOOST_OUTCOME_CO_TRY(
+        co_await snappy::coWriteFramed(stream, encoded.size(), framed));
+    BOOST_OUTCOME_CO_TRY(co_await readResponseStatus(stream));
+    size_t bytes = 0;
+    BOOST_OUTCOME_CO_TRY(
+        auto response_encoded,
+        co_await snappy::coUncompressFramed(
+            stream, kDecodeBudget<PeerExchangeResponse>, &bytes));
+    traffic_->record(
+        kTrafficProtocol, TrafficShaper::Direction::In, peer_id, bytes);
+    BOOST_OUTCOME_CO_TRY(auto response,
+                         decode<PeerExchangeResponse>(response_encoded));
+    co_return response;
+  }
+
+  libp2p::CoroOutcome<void> PeerExchangeProtocol::coroHandle(
+      std::shared_ptr<libp2p::Stream> stream) {
+    auto peer_id = stream->remotePeerId();
+    size_t bytes = 0;
+    BOOST_OUTCOME_CO_TRY(
+        auto encoded,
+        co_await snappy::coUncompressFramed(
+            stream, kDecodeBudget<PeerExchangeRequest>, &bytes));
+    traffic_->record(
+        kTrafficProtocol, TrafficShaper::Direction::In, peer_id, bytes);
+    BOOST_OUTCOME_CO_TRY(auto request, decode<PeerExchangeRequest>(encoded));
+    auto [encoded_size, framed] =
+        withSszScratch(get_peers_(request), [](qtils::BytesIn encoded) {
+          return std::make_pair(encoded.size(),
+                                snappy::compressFramed(encoded));
+        });
+    co_await traffic_->serve(kTrafficProtocol, peer_id, framed.size());
+    BOOST_OUTCOME_CO_TRY(co_await writeResponseStatus(stream));
+    BOOST_OUTCOME_CO_TRY(
+        co_await snappy::coWriteFramed(stream, encoded_size, framed));
+    co_return outcome::success();
+  }
+}  // namespace lean::modules
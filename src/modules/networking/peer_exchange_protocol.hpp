@@ -0,0 +1,71 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string_view>
+
+#include <libp2p/protocol/base_protocol.hpp>
+#include <qtils/shared_ref.hpp>
+
+#include "modules/networking/traffic_shaper.hpp"
+#include "modules/networking/types.hpp"
+
+namespace boost::asio {
+  class io_context;
+}  // namespace boost::asio
+
+namespace libp2p::host {
+  class BasicHost;
+}  // namespace libp2p::host
+
+namespace lean::modules {
+  /**
+   * Discovery of peers by attestation subnet and aggregator role.
+   *
+   * Peer answers with its own subnets and role, then with peers it knows,
+   * those on requested subnets and aggregators first. Protocol is specific
+   * to this client, so only peers advertising it by identify are queried.
+   */
+  class PeerExchangeProtocol
+      : public std::enable_shared_from_this<PeerExchangeProtocol>,
+        public libp2p::protocol::BaseProtocol {
+   public:
+    static constexpr std::string_view kProtocolId =
+        "/qlean/req/peer_exchange/1/ssz_snappy";
+    static constexpr std::chrono::seconds kResponseTimeout{5};
+
+    using GetPeers =
+        std::function<PeerExchangeResponse(const PeerExchangeRequest &)>;
+
+    PeerExchangeProtocol(std::shared_ptr<boost::asio::io_context> io_context,
+                         std::shared_ptr<libp2p::host::BasicHost> host,
+                         qtils::SharedRef<TrafficShaper> traffic,
+                         GetPeers get_peers);
+
+    // BaseProtocol
+    libp2p::StreamProtocols getProtocolIds() const override;
+    void handle(std::shared_ptr<libp2p::Stream> stream) override;
+
+    void start();
+
+    /// Request peers from connected peer
+    libp2p::CoroOutcome<PeerExchangeResponse> request(
+        libp2p::PeerId peer_id, PeerExchangeRequest request);
+
+   private:
+    libp2p::CoroOutcome<void> coroHandle(
+        std::shared_ptr<libp2p::Stream> stream);
+
+    std::shared_ptr<boost::asio::io_context> io_context_;
+    std::shared_ptr<libp2p::host::BasicHost> host_;
+    qtils::SharedRef<TrafficShaper> traffic_;
+    GetPeers get_peers_;
+  };
+}  // namespace lean::modules
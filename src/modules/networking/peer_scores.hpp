@@ -0,0 +1,190 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <ranges>
+#include <unordered_map>
+
+#include <libp2p/peer/peer_id.hpp>
+
+#include "types/slot.hpp"
+
+namespace lean::modules {
+  /**
+   * Block request performance of connected peer.
+   * Averages are exponential moving, so recent requests dominate.
+   */
+  struct PeerScore {
+    static constexpr std::chrono::microseconds kInitialRtt =
+        std::chrono::milliseconds{500};
+
+    /// Response time of block requests
+    std::chrono::microseconds rtt = kInitialRtt;
+    /// Fraction of requested blocks delivered
+    double success_rate = 1;
+    /// Blocks delivered per second of response time
+    double blocks_per_second = 0;
+    /// Failed requests since last successful one
+    size_t recent_failures = 0;
+    /// Highest slot peer is known to have, from status and blocks
+    Slot head_slot = 0;
+
+    /// Expected time to get block from peer, lower is better
+    std::chrono::microseconds cost() const {
+      auto rate = std::max(success_rate, 0.05);
+      return std::chrono::microseconds{static_cast<int64_t>(
+          static_cast<double>(rtt.count()) * (1 + recent_failures) / rate)};
+    }
+  };
+
+  /**
+   * Performance of connected peers, to route block requests and range sync
+   * batches to fast and reliable peers.
+   * Not thread safe, used from io thread.
+   */
+  class PeerScores {
+   public:
+    /// Weight of newest sample in averages
+    static constexpr double kAlpha = 0.2;
+    static constexpr std::chrono::milliseconds kMinHedgeDelay{250};
+    static constexpr std::chrono::milliseconds kMaxHedgeDelay{2000};
+
+    void add(const libp2p::PeerId &peer_id) {
+      peers_.try_emplace(peer_id);
+    }
+
+    void remove(const libp2p::PeerId &peer_id) {
+      peers_.erase(peer_id);
+    }
+
+    /// Score of connected peer, or nullptr
+    const PeerScore *get(const libp2p::PeerId &peer_id) const {
+      auto it = peers_.find(peer_id);
+      return it != peers_.end() ? &it->second : nullptr;
+    }
+
+    void onHead(const libp2p::PeerId &peer_id, Slot slot) {
+      if (auto score = find(peer_id)) {
+        score->head_slot = std::max(score->head_slot, slot);
+      }
+    }
+
+    /// Peer responded with `received` of `requested` blocks
+    void onResponse(const libp2p::PeerId &peer_id,
+                    std::chrono::microseconds elapsed,
+                    size_t requested,
+                    size_t received) {
+      auto score = find(peer_id);
+      if (score == nullptr) {
+        return;
+      }
+      score->rtt = std::chrono::microseconds{static_cast<int64_t>(
+          (1 - kAlpha) * static_cast<double>(score->rtt.count())
+          + kAlpha * static_cast<double>(elapsed.count()))};
+      if (requested != 0) {
+        auto delivered = static_cast<double>(std::min(received, requested))
+                       / static_cast<double>(requested);
+        score->success_rate =
+            (1 - kAlpha) * score->success_rate + kAlpha * delivered;
+      }
+      auto seconds = std::max(
+          std::chrono::duration<double>(elapsed).count(), 1e-3);
+      score->blocks_per_second =
+          (1 - kAlpha) * score->blocks_per_second
+          + kAlpha * static_cast<double>(received) / seconds;
+      if (received != 0) {
+        score->recent_failures = 0;
+      } else {
+        ++score->recent_failures;
+      }
+    }
+
+    /// Request to peer failed or timed out
+    void onFailure(const libp2p::PeerId &peer_id) {
+      if (auto score = find(peer_id)) {
+        score->success_rate = (1 - kAlpha) * score->success_rate;
+        ++score->recent_failures;
+      }
+    }
+
+    /// Highest head of connected peers
+    Slot headSlot() const {
+      Slot head = 0;
+      for (auto &score : peers_ | std::views::values) {
+        head = std::max(head, score.head_slot);
+      }
+      return head;
+    }
+
+    /**
+     * Lowest cost peer with head at least `min_head`.
+     * @param exclude peer to skip, e.g. already asked
+     */
+    std::optional<libp2p::PeerId> best(
+        Slot min_head,
+        const std::optional<libp2p::PeerId> &exclude = std::nullopt) const {
+      return bestIf(min_head, [&](const libp2p::PeerId &peer_id) {
+        return peer_id != exclude;
+      });
+    }
+
+    /// Lowest cost peer with head at least `min_head`, accepted by `filter`
+    std::optional<libp2p::PeerId> bestIf(Slot min_head,
+                                         const auto &filter) const {
+      const std::pair<const libp2p::PeerId, PeerScore> *best = nullptr;
+      for (auto &item : peers_) {
+        if (item.second.head_slot < min_head or not filter(item.first)) {
+          continue;
+        }
+        if (best == nullptr or item.second.cost() < best->second.cost()) {
+          best = &item;
+        }
+      }
+      if (best == nullptr) {
+        return std::nullopt;
+      }
+      return best->first;
+    }
+
+    /**
+     * Prefer `peer_id`, unless other peer with head at least `min_head` is
+     * more than twice cheaper.
+     */
+    libp2p::PeerId choose(const libp2p::PeerId &peer_id, Slot min_head) const {
+      auto best_peer = best(min_head, peer_id);
+      if (not best_peer.has_value()) {
+        return peer_id;
+      }
+      auto cost = [&](const libp2p::PeerId &peer_id) {
+        auto score = get(peer_id);
+        return score != nullptr ? score->cost() : PeerScore{}.cost();
+      };
+      return 2 * cost(*best_peer) < cost(peer_id) ? *best_peer : peer_id;
+    }
+
+    /// Time to wait for response of peer before asking another peer too
+    std::chrono::milliseconds hedgeDelay(const libp2p::PeerId &peer_id) const {
+      auto score = get(peer_id);
+      auto rtt = score != nullptr ? score->rtt : PeerScore::kInitialRtt;
+      return std::clamp(
+          std::chrono::duration_cast<std::chrono::milliseconds>(2 * rtt),
+          kMinHedgeDelay,
+          kMaxHedgeDelay);
+    }
+
+   private:
+    PeerScore *find(const libp2p::PeerId &peer_id) {
+      auto it = peers_.find(peer_id);
+      return it != peers_.end() ? &it->second : nullptr;
+    }
+
+    std::unordered_map<libp2p::PeerId, PeerScore> peers_;
+  };
+}  // namespace lean::modules
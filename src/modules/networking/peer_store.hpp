@@ -0,0 +1,176 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <libp2p/peer/peer_id.hpp>
+#include <sszpp/container.hpp>
+#include <sszpp/lists.hpp>
+
+#include "serde/serialization.hpp"
+#include "storage/buffer_map_types.hpp"
+
+namespace lean::modules {
+  constexpr size_t kMaxPeerAddresses = 16;
+  constexpr size_t kMaxPeerAddressSize = 256;
+  constexpr size_t kMaxPeerProtocols = 64;
+  constexpr size_t kMaxPeerProtocolSize = 256;
+
+  /**
+   * Persisted knowledge of peer, to reconnect to good peers after restart.
+   */
+  struct PeerRecord : ssz::ssz_variable_size_container {
+    /// Multiaddresses of peer, in binary form
+    ssz::list<ssz::list<uint8_t, kMaxPeerAddressSize>, kMaxPeerAddresses>
+        addresses;
+    /// Unix time in milliseconds when peer was last connected
+    uint64_t last_seen_ms = 0;
+    /// Block request response time, lower is better
+    uint64_t rtt_us = 0;
+    /// Protocols peer supports, as reported by identify
+    ssz::list<ssz::list<uint8_t, kMaxPeerProtocolSize>, kMaxPeerProtocols>
+        protocols;
+
+    SSZ_CONT(addresses, last_seen_ms, rtt_us, protocols);
+  };
+
+  /**
+   * Peers known from previous runs, stored in `Space::Peer` by peer id.
+   *
+   * Records are updated in memory by io thread and written by `flush`, so
+   * connection events don't write to storage. Only `kMaxPeers` most
+   * recently seen peers are kept.
+   * Not thread safe, used from io thread.
+   */
+  class PeerStore {
+   public:
+    static constexpr size_t kMaxPeers = 1024;
+
+    using SystemClock = std::chrono::system_clock;
+
+    explicit PeerStore(std::shared_ptr<storage::BufferStorage> space)
+        : space_{std::move(space)} {}
+
+    /// Read stored records, records which can't be decoded are dropped
+    outcome::result<void> load() {
+      auto cursor = space_->cursor();
+      OUTCOME_TRY(cursor->seekFirst());
+      while (cursor->isValid()) {
+        auto key = cursor->key().value();
+        auto peer_id = libp2p::PeerId::fromBytes(key);
+        auto record = decode<PeerRecord>(cursor->value().value());
+        if (peer_id.has_value() and record.has_value()) {
+          records_.emplace(std::move(peer_id.value()),
+                           std::move(record.value()));
+        } else {
+          removed_.emplace_back(std::move(key));
+        }
+        OUTCOME_TRY(cursor->next());
+      }
+      return outcome::success();
+    }
+
+    const std::unordered_map<libp2p::PeerId, PeerRecord> &records() const {
+      return records_;
+    }
+
+    /// Replace record of peer, written by next `flush`
+    void put(const libp2p::PeerId &peer_id, PeerRecord record) {
+      records_.insert_or_assign(peer_id, std::move(record));
+      dirty_.emplace(peer_id);
+    }
+
+    /**
+     * Peers seen within `max_age`, lowest response time first, and most
+     * recently seen first among peers with same response time.
+     */
+    std::vector<libp2p::PeerId> best(SystemClock::time_point now,
+                                     std::chrono::milliseconds max_age,
+                                     size_t limit) const {
+      auto since_ms = toMs(now - max_age);
+      std::vector<std::pair<libp2p::PeerId, const PeerRecord *>> recent;
+      for (auto &[peer_id, record] : records_) {
+        if (record.addresses.data().empty()
+            or record.last_seen_ms < since_ms) {
+          continue;
+        }
+        recent.emplace_back(peer_id, &record);
+      }
+      std::ranges::sort(recent, [](auto &l, auto &r) {
+        if (l.second->rtt_us != r.second->rtt_us) {
+          return l.second->rtt_us < r.second->rtt_us;
+        }
+        return l.second->last_seen_ms > r.second->last_seen_ms;
+      });
+      std::vector<libp2p::PeerId> peers;
+      for (auto &peer_id : recent | std::views::keys) {
+        if (peers.size() >= limit) {
+          break;
+        }
+        peers.emplace_back(peer_id);
+      }
+      return peers;
+    }
+
+    /// Write changed records, and forget least recently seen over limit
+    outcome::result<void> flush() {
+      if (records_.size() > kMaxPeers) {
+        std::vector<std::pair<uint64_t, libp2p::PeerId>> by_age;
+        for (auto &[peer_id, record] : records_) {
+          by_age.emplace_back(record.last_seen_ms, peer_id);
+        }
+        auto forget = by_age.size() - kMaxPeers;
+        std::ranges::nth_element(
+            by_age, by_age.begin() + static_cast<std::ptrdiff_t>(forget));
+        for (auto &peer_id : std::span{by_age}.first(forget)
+                                 | std::views::values) {
+          records_.erase(peer_id);
+          dirty_.erase(peer_id);
+          removed_.emplace_back(peer_id.toVector());
+        }
+      }
+      if (dirty_.empty() and removed_.empty()) {
+        return outcome::success();
+      }
+      auto batch = space_->batch();
+      for (auto &key : removed_) {
+        OUTCOME_TRY(batch->remove(key));
+      }
+      for (auto &peer_id : dirty_) {
+        OUTCOME_TRY(value, encode(records_.at(peer_id)));
+        OUTCOME_TRY(batch->put(peer_id.toVector(), std::move(value)));
+      }
+      OUTCOME_TRY(batch->commit());
+      removed_.clear();
+      dirty_.clear();
+      return outcome::success();
+    }
+
+    static uint64_t toMs(SystemClock::time_point time) {
+      return static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              time.time_since_epoch())
+              .count());
+    }
+
+   private:
+    std::shared_ptr<storage::BufferStorage> space_;
+    std::unordered_map<libp2p::PeerId, PeerRecord> records_;
+    /// Peers with records changed since last flush
+    std::unordered_set<libp2p::PeerId> dirty_;
+    /// Keys to remove on next flush
+    std::vector<qtils::ByteVec> removed_;
+  };
+}  // namespace lean::modules
@@ -0,0 +1,168 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <concepts>
+#include <map>
+#include <optional>
+#include <ranges>
+#include <unordered_map>
+#include <vector>
+
+#include <libp2p/peer/peer_id.hpp>
+#include <sszpp/container.hpp>
+
+#include "types/block_hash.hpp"
+#include "types/slot.hpp"
+#include "utils/memory_usage.hpp"
+
+namespace lean::modules {
+  /**
+   * Bounded pool of gossip attestations waiting for their unknown head
+   * block.
+   *
+   * Attestations are grouped by head root, so block arrival takes its group
+   * with single lookup. Groups are also indexed by head slot, for expiry by
+   * finalized slot and for eviction of oldest group when pool is full.
+   * Each peer may keep limited number of attestations, so peer spamming
+   * random roots can't push out attestations of other peers.
+   * Not thread safe, used from io thread.
+   *
+   * @tparam T attestation type with `data.head` checkpoint
+   */
+  template <typename T>
+  class PendingAttestations {
+   public:
+    static constexpr size_t kDefaultMaxSize = 16384;
+    static constexpr size_t kDefaultMaxPerPeer = 1024;
+
+    explicit PendingAttestations(size_t max_size = kDefaultMaxSize,
+                                 size_t max_per_peer = kDefaultMaxPerPeer)
+        : max_size_{max_size}, max_per_peer_{max_per_peer} {}
+
+    size_t size() const {
+      return size_;
+    }
+
+    /// Estimated memory used by pending attestations
+    size_t byteSize() const {
+      auto bytes = memory_usage::hashBytes(groups_)
+                 + memory_usage::treeBytes(by_slot_)
+                 + memory_usage::hashBytes(per_peer_);
+      for (auto &group : groups_ | std::views::values) {
+        bytes += memory_usage::vectorBytes(group.entries);
+        if constexpr (std::derived_from<T, ssz::ssz_variable_size_container>) {
+          for (auto &entry : group.entries) {
+            bytes += ssz::size(entry.attestation);
+          }
+        }
+      }
+      return bytes;
+    }
+
+    /**
+     * Add attestation received from `peer_id`.
+     * Oldest groups are evicted when pool is full.
+     * @return false if peer quota is exhausted, or attestation is older than
+     * all pending ones in full pool
+     */
+    bool add(const T &attestation,
+             const std::optional<libp2p::PeerId> &peer_id) {
+      auto &head = attestation.data.head;
+      if (peer_id.has_value()) {
+        auto it = per_peer_.find(*peer_id);
+        if (it != per_peer_.end() and it->second >= max_per_peer_) {
+          return false;
+        }
+      }
+      while (size_ >= max_size_) {
+        auto oldest = by_slot_.begin();
+        if (oldest == by_slot_.end() or head.slot <= oldest->first) {
+          return false;
+        }
+        auto group_it = groups_.find(oldest->second);
+        release(group_it->second);
+        groups_.erase(group_it);
+      }
+      auto [group_it, inserted] = groups_.try_emplace(head.root);
+      auto &group = group_it->second;
+      if (inserted) {
+        group.slot_it = by_slot_.emplace(head.slot, head.root);
+      } else if (head.slot < group.slot_it->first) {
+        // Index group by lowest claimed slot, so it expires with it
+        by_slot_.erase(group.slot_it);
+        group.slot_it = by_slot_.emplace(head.slot, head.root);
+      }
+      group.entries.emplace_back(Entry{
+          .attestation = attestation,
+          .peer_id = peer_id,
+      });
+      if (peer_id.has_value()) {
+        ++per_peer_[*peer_id];
+      }
+      ++size_;
+      return true;
+    }
+
+    /// Remove and return attestations for head `root`
+    std::vector<T> take(const BlockHash &root) {
+      std::vector<T> attestations;
+      auto group_it = groups_.find(root);
+      if (group_it == groups_.end()) {
+        return attestations;
+      }
+      attestations.reserve(group_it->second.entries.size());
+      for (auto &entry : group_it->second.entries) {
+        attestations.emplace_back(std::move(entry.attestation));
+      }
+      release(group_it->second);
+      groups_.erase(group_it);
+      return attestations;
+    }
+
+    /// Remove attestations with head slot not after `slot`
+    void expire(Slot slot) {
+      while (not by_slot_.empty() and by_slot_.begin()->first <= slot) {
+        auto group_it = groups_.find(by_slot_.begin()->second);
+        release(group_it->second);
+        groups_.erase(group_it);
+      }
+    }
+
+   private:
+    struct Entry {
+      T attestation;
+      std::optional<libp2p::PeerId> peer_id;
+    };
+
+    struct Group {
+      std::vector<Entry> entries;
+      std::multimap<Slot, BlockHash>::iterator slot_it;
+    };
+
+    /// Forget group counts and slot index, caller erases group
+    void release(const Group &group) {
+      for (auto &entry : group.entries) {
+        if (entry.peer_id.has_value()) {
+          auto it = per_peer_.find(*entry.peer_id);
+          if (--it->second == 0) {
+            per_peer_.erase(it);
+          }
+        }
+      }
+      size_ -= group.entries.size();
+      by_slot_.erase(group.slot_it);
+    }
+
+    size_t max_size_;
+    size_t max_per_peer_;
+    size_t size_ = 0;
+    std::unordered_map<BlockHash, Group> groups_;
+    std::multimap<Slot, BlockHash> by_slot_;
+    std::unordered_map<libp2p::PeerId, size_t> per_peer_;
+  };
+}  // namespace lean::modules
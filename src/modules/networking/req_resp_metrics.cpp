@@ -0,0 +1,106 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "modules/networking/req_resp_metrics.hpp"
+
+#include <boost/asio/steady_timer.hpp>
+
+#include "metrics/metrics.hpp"
+
+namespace lean::modules {
+  namespace {
+    double seconds(ReqRespMetrics::Clock::duration duration) {
+      return std::chrono::duration<double>(duration).count();
+    }
+
+    std::string_view resultName(ReqRespMetrics::Result result) {
+      using E = ReqRespMetrics::Result;
+      switch (result) {
+        case E::SUCCESS:
+          return "success";
+        case E::PARTIAL:
+          return "partial";
+        case E::TIMEOUT:
+          return "timeout";
+        case E::ERROR:
+          return "error";
+      }
+      abort();
+    }
+  }  // namespace
+
+  ReqRespMetrics::ReqRespMetrics(qtils::SharedRef<metrics::Metrics> metrics,
+                                 std::string protocol,
+                                 PeerClient peer_client)
+      : metrics_{std::move(metrics)},
+        protocol_{std::move(protocol)},
+        peer_client_{std::move(peer_client)} {}
+
+  void ReqRespMetrics::onRequest(const libp2p::PeerId &peer_id,
+                                 const Request &request,
+                                 Result result) {
+    auto now = Clock::now();
+    metrics::Labels labels{{"protocol", protocol_},
+                           {"client", peer_client_(peer_id)}};
+    if (request.sent.has_value()) {
+      metrics_->lean_req_stream_open_time(labels)->observe(
+          seconds(*request.sent - request.started));
+      if (request.first_byte.has_value()) {
+        metrics_->lean_req_first_byte_time(labels)->observe(
+            seconds(*request.first_byte - *request.sent));
+      }
+    }
+    if (result == Result::SUCCESS or result == Result::PARTIAL) {
+      metrics_->lean_req_response_time(labels)->observe(
+          seconds(now - request.started));
+      metrics_->lean_req_response_size(labels)->observe(
+          static_cast<double>(request.bytes));
+    }
+    labels.emplace("result", resultName(result));
+    metrics_->lean_req_results(labels)->inc();
+  }
+
+  void ReqRespMetrics::onServed(size_t requested, size_t served) {
+    if (served >= requested) {
+      return;
+    }
+    metrics::Labels labels{{"protocol", protocol_}};
+    metrics_->lean_resp_partial(labels)->inc();
+    metrics_->lean_resp_skipped_blocks(labels)->inc(
+        static_cast<double>(requested - served));
+  }
+
+  struct StreamDeadline::State {
+    explicit State(boost::asio::io_context &io_context) : timer{io_context} {}
+
+    boost::asio::steady_timer timer;
+    bool expired = false;
+  };
+
+  StreamDeadline::StreamDeadline(boost::asio::io_context &io_context,
+                                 std::shared_ptr<libp2p::Stream> stream,
+                                 std::chrono::milliseconds timeout)
+      : state_{std::make_shared<State>(io_context)} {
+    state_->timer.expires_after(timeout);
+    state_->timer.async_wait(
+        [state{state_}, stream{std::move(stream)}](
+            boost::system::error_code ec) {
+          if (ec) {
+            return;
+          }
+          state->expired = true;
+          stream->reset();
+        });
+  }
+
+  StreamDeadline::~StreamDeadline() {
+    state_->timer.cancel();
+  }
+
+  bool StreamDeadline::expired() const {
+    return state_->expired;
+  }
+}  // namespace lean::modules
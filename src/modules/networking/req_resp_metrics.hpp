@@ -0,0 +1,96 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <libp2p/protocol/base_protocol.hpp>
+#include <qtils/shared_ref.hpp>
+
+namespace boost::asio {
+  class io_context;
+}  // namespace boost::asio
+
+namespace lean::metrics {
+  class Metrics;
+}  // namespace lean::metrics
+
+namespace lean::modules {
+  /**
+   * Latency, size and outcome of requests and served responses of one
+   * request-response protocol, by protocol and client of peer.
+   * Used from io thread only.
+   */
+  class ReqRespMetrics {
+   public:
+    using Clock = std::chrono::steady_clock;
+    /// Client of peer, e.g. `zeam`, see `NetworkingImpl::peerClient`
+    using PeerClient = std::function<std::string(const libp2p::PeerId &)>;
+
+    enum class Result : uint8_t {
+      SUCCESS,
+      /// Some of requested response chunks are missing
+      PARTIAL,
+      TIMEOUT,
+      ERROR,
+    };
+
+    /// Timing of one outgoing request, filled while request goes
+    struct Request {
+      Clock::time_point started = Clock::now();
+      /// Stream is taken and request is written
+      std::optional<Clock::time_point> sent;
+      /// First byte of response is read
+      std::optional<Clock::time_point> first_byte;
+      /// Compressed bytes of response
+      size_t bytes = 0;
+    };
+
+    ReqRespMetrics(qtils::SharedRef<metrics::Metrics> metrics,
+                   std::string protocol,
+                   PeerClient peer_client);
+
+    /// Observe finished request to peer
+    void onRequest(const libp2p::PeerId &peer_id,
+                   const Request &request,
+                   Result result);
+
+    /// Observe served response with `served` of `requested` chunks
+    void onServed(size_t requested, size_t served);
+
+   private:
+    qtils::SharedRef<metrics::Metrics> metrics_;
+    std::string protocol_;
+    PeerClient peer_client_;
+  };
+
+  /**
+   * Resets stream unless response is read within timeout, so request to peer
+   * stuck in middle of response can't hang forever.
+   */
+  class StreamDeadline {
+   public:
+    StreamDeadline(boost::asio::io_context &io_context,
+                   std::shared_ptr<libp2p::Stream> stream,
+                   std::chrono::milliseconds timeout);
+    StreamDeadline(const StreamDeadline &) = delete;
+    StreamDeadline &operator=(const StreamDeadline &) = delete;
+    /// Cancels timer
+    ~StreamDeadline();
+
+    /// Stream was reset by timeout
+    bool expired() const;
+
+   private:
+    struct State;
+    std::shared_ptr<State> state_;
+  };
+}  // namespace lean::modules
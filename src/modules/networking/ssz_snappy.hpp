@@ -6,29 +6,52 @@
 
 #pragma once
 
+#include "modules/networking/decode_budget.hpp"
 #include "serde/serialization.hpp"
 #include "serde/snappy.hpp"
 
 namespace lean {
+  /**
+   * Run `f` with SSZ encoding of `t` in thread local scratch buffer, so
+   * encoding doesn't allocate once buffer has grown.
+   */
+  auto withSszScratch(const auto &t, const auto &f) {
+    thread_local qtils::ByteVec scratch;
+    encodeInto(t, scratch);
+    auto result = f(qtils::BytesIn{scratch});
+    // Don't keep memory of rare huge messages
+    if (scratch.capacity() > snappy::kDefaultMaxSize) {
+      scratch = {};
+    }
+    return result;
+  }
+
   auto encodeSszSnappy(const auto &t) {
-    return snappy::compress(encode(t).value());
+    return withSszScratch(t, [](qtils::BytesIn encoded) {
+      return snappy::compress(encoded);
+    });
   }
 
   template <typename T>
   outcome::result<std::pair<T, size_t>> decodeSszSnappy(
-      qtils::BytesIn compressed) {
-    BOOST_OUTCOME_TRY(auto uncompressed, snappy::uncompress(compressed));
+      qtils::BytesIn compressed, size_t max_size = kDecodeBudget<T>) {
+    BOOST_OUTCOME_TRY(auto uncompressed,
+                      snappy::uncompress(compressed, max_size));
     BOOST_OUTCOME_TRY(auto decoded, decode<T>(uncompressed));
     return std::make_pair(std::move(decoded), uncompressed.size());
   }
 
   auto encodeSszSnappyFramed(const auto &t) {
-    return snappy::compressFramed(encode(t).value());
+    return withSszScratch(t, [](qtils::BytesIn encoded) {
+      return snappy::compressFramed(encoded);
+    });
   }
 
   template <typename T>
-  outcome::result<T> decodeSszSnappyFramed(qtils::BytesIn compressed) {
-    BOOST_OUTCOME_TRY(auto uncompressed, snappy::uncompressFramed(compressed));
+  outcome::result<T> decodeSszSnappyFramed(
+      qtils::BytesIn compressed, size_t max_size = kDecodeBudget<T>) {
+    BOOST_OUTCOME_TRY(auto uncompressed,
+                      snappy::uncompressFramed(compressed, max_size));
     return decode<T>(uncompressed);
   }
 }  // namespace lean
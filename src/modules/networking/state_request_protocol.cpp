@@ -0,0 +1,355 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "modules/networking/state_request_protocol.hpp"
+
+#include <algorithm>
+#include <optional>
+
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <libp2p/coro/spawn.hpp>
+#include <libp2p/host/basic_host.hpp>
+
+#include "blockchain/block_tree.hpp"
+#include "modules/networking/block_request_protocol.hpp"
+#include "modules/networking/req_resp_metrics.hpp"
+#include "modules/networking/response_status.hpp"
+#include "modules/networking/ssz_snappy.hpp"
+#include "utils/ceil_div.hpp"
+
+namespace lean::modules {
+  struct StateRequestProtocol::Fetch {
+    /// Bytes `[next, end)` are not received yet
+    struct Range {
+      uint64_t next;
+      uint64_t end;
+    };
+
+    std::vector<libp2p::PeerId> peers;
+    BlockHash root;
+    OnState on_state;
+    qtils::ByteVec ssz;
+    std::vector<Range> ranges;
+  };
+
+  /**
+   * Read at most `max_count` response chunks.
+   * Response is complete when stream ends, so read error after some chunks
+   * are received is not an error.
+   */
+  libp2p::CoroOutcome<std::vector<StateResponse>> readStateResponses(
+      std::shared_ptr<libp2p::Stream> stream,
+      size_t max_count,
+      ReqRespMetrics::Request &timing) {
+    std::vector<StateResponse> responses;
+    while (responses.size() < max_count) {
+      auto status_res = co_await readResponseStatus(stream);
+      if (not status_res.has_value()) {
+        if (responses.empty()) {
+          co_return status_res.error();
+        }
+        break;
+      }
+      if (not timing.first_byte.has_value()) {
+        timing.first_byte = ReqRespMetrics::Clock::now();
+      }
+      BOOST_OUTCOME_CO_TRY(
+          auto encoded,
+          co_await snappy::coUncompressFramed(
+              stream, kDecodeBudget<StateResponse>, &timing.bytes));
+      BOOST_OUTCOME_CO_TRY(auto response, decode<StateResponse>(encoded));
+      responses.emplace_back(std::move(response));
+    }
+    co_return responses;
+  }
+
+  StateRequestProtocol::StateRequestProtocol(
+      std::shared_ptr<boost::asio::io_context> io_context,
+      std::shared_ptr<libp2p::host::BasicHost> host,
+      qtils::SharedRef<blockchain::BlockTree> block_tree,
+      GetState get_state,
+      qtils::SharedRef<ServedStreams> served_streams,
+      qtils::SharedRef<StreamPool> stream_pool,
+      qtils::SharedRef<TrafficShaper> traffic,
+      qtils::SharedRef<ReqRespMetrics> metrics)
+      : io_context_{std::move(io_context)},
+        host_{std::move(host)},
+        block_tree_{std::move(block_tree)},
+        get_state_{std::move(get_state)},
+        served_streams_{std::move(served_streams)},
+        stream_pool_{std::move(stream_pool)},
+        traffic_{std::move(traffic)},
+        metrics_{std::move(metrics)} {}
+
+  libp2p::StreamProtocols StateRequestProtocol::getProtocolIds() const {
+    return {std::string{kProtocolId}};
+  }
+
+  void StateRequestProtocol::handle(std::shared_ptr<libp2p::Stream> stream) {
+    auto slot = served_streams_->acquire(stream->remotePeerId());
+    if (not slot.has_value()) {
+      stream->reset();
+      return;
+    }
+    libp2p::coroSpawn(*io_context_,
+                      [self{shared_from_this()},
+                       stream,
+                       slot{std::move(slot.value())}]() -> libp2p::Coro<void> {
+                        std::ignore = co_await self->coroRespond(stream);
+                      });
+  }
+
+  void StateRequestProtocol::start() {
+    host_->listenProtocol(shared_from_this());
+  }
+
+  size_t StateRequestProtocol::byteSize() const {
+    return encoded_state_ ? encoded_state_->ssz.capacity() : 0;
+  }
+
+  libp2p::CoroOutcome<std::vector<StateResponse>>
+  StateRequestProtocol::request(libp2p::PeerId peer_id, StateRequest request) {
+    auto max_count = ceilDiv(request.length, MAX_STATE_CHUNK_SIZE);
+    ReqRespMetrics::Request timing;
+    std::optional<StreamDeadline> deadline;
+    auto responses_res =
+        co_await [&]() -> libp2p::CoroOutcome<std::vector<StateResponse>> {
+      BOOST_OUTCOME_CO_TRY(auto stream, co_await stream_pool_->take(peer_id));
+      deadline.emplace(*io_context_, stream, kResponseTimeout);
+      auto encoded = encode(request).value();
+      auto framed = snappy::compressFramed(encoded);
+      traffic_->record(kTrafficProtocol,
+                       TrafficShaper::Direction::Out,
+                       peer_id,
+                       framed.size());
+      BOOST_OUTCOME_CO_TRY(
+          co_await snappy::coWriteFramed(stream, encoded.size(), framed));
+      timing.sent = ReqRespMetrics::Clock::now();
+      co_return co_await readStateResponses(stream, max_count, timing);
+    }();
+    traffic_->record(
+        kTrafficProtocol, TrafficShaper::Direction::In, peer_id, timing.bytes);
+    auto expired = deadline.has_value() and deadline->expired();
+    auto result = expired ? ReqRespMetrics::Result::TIMEOUT
+                : not responses_res.has_value()
+                    ? ReqRespMetrics::Result::ERROR
+                : responses_res.value().size() < max_count
+                    ? ReqRespMetrics::Result::PARTIAL
+                    : ReqRespMetrics::Result::SUCCESS;
+    metrics_->onRequest(peer_id, timing, result);
+    co_return responses_res;
+  }
+
+  void StateRequestProtocol::fetch(std::vector<libp2p::PeerId> peers,
+                                   BlockHash root,
+                                   OnState on_state) {
+    if (peers.empty()) {
+      on_state(StateRequestError::NO_PEERS);
+      return;
+    }
+    auto fetch = std::make_shared<Fetch>(Fetch{
+        .peers = std::move(peers),
+        .root = root,
+        .on_state = std::move(on_state),
+    });
+    libp2p::coroSpawn(
+        *io_context_,
+        [self{shared_from_this()}, fetch]() -> libp2p::Coro<void> {
+          co_await self->coroFetch(fetch);
+        });
+  }
+
+  outcome::result<std::shared_ptr<const StateRequestProtocol::EncodedState>>
+  StateRequestProtocol::encodedState(const BlockHash &root) {
+    // Previous finalized state stays cached until next one is requested, so
+    // peer fetching it across finalization can resume
+    if (encoded_state_ and encoded_state_->root == root) {
+      return encoded_state_;
+    }
+    if (block_tree_->lastFinalized().hash != root) {
+      return nullptr;
+    }
+    BOOST_OUTCOME_TRY(auto state, get_state_(root));
+    BOOST_OUTCOME_TRY(auto ssz, encode(*state));
+    encoded_state_ = std::make_shared<const EncodedState>(EncodedState{
+        .root = root,
+        .ssz = std::move(ssz),
+    });
+    return encoded_state_;
+  }
+
+  libp2p::CoroOutcome<void> StateRequestProtocol::coroRespond(
+      std::shared_ptr<libp2p::Stream> stream) {
+    size_t bytes = 0;
+    BOOST_OUTCOME_CO_TRY(auto encoded,
+                         co_await snappy::coUncompressFramed(
+                             stream, kDecodeBudget<StateRequest>, &bytes));
+    traffic_->record(kTrafficProtocol,
+                     TrafficShaper::Direction::In,
+                     stream->remotePeerId(),
+                     bytes);
+    BOOST_OUTCOME_CO_TRY(auto request, decode<StateRequest>(encoded));
+    auto requested = ceilDiv(request.length, MAX_STATE_CHUNK_SIZE);
+    BOOST_OUTCOME_CO_TRY(auto state, encodedState(request.root));
+    // Empty response tells peer that state is not served
+    if (state == nullptr or request.offset >= state->ssz.size()) {
+      metrics_->onServed(requested, 0);
+      co_return outcome::success();
+    }
+    auto end = request.offset
+             + std::min({request.length,
+                         kMaxRequestSize,
+                         state->ssz.size() - request.offset});
+    size_t served = 0;
+    for (auto offset = request.offset; offset < end;) {
+      auto size = std::min(end - offset, MAX_STATE_CHUNK_SIZE);
+      StateResponse response{
+          .size = state->ssz.size(),
+          .offset = offset,
+      };
+      auto part = std::span{state->ssz}.subspan(offset, size);
+      response.data.data().assign(part.begin(), part.end());
+      offset += size;
+      auto [encoded_size, framed] =
+          withSszScratch(response, [](qtils::BytesIn encoded) {
+            return std::make_pair(encoded.size(),
+                                  snappy::compressFramed(encoded));
+          });
+      co_await traffic_->serve(
+          kTrafficProtocol, stream->remotePeerId(), framed.size());
+      BOOST_OUTCOME_CO_TRY(co_await writeResponseStatus(stream));
+      BOOST_OUTCOME_CO_TRY(
+          co_await snappy::coWriteFramed(stream, encoded_size, framed));
+      ++served;
+    }
+    metrics_->onServed(requested, served);
+    co_return outcome::success();
+  }
+
+  libp2p::CoroOutcome<void> StateRequestProtocol::coroFetchRange(
+      std::shared_ptr<Fetch> fetch, size_t range_index) {
+    auto &range = fetch->ranges.at(range_index);
+    size_t failures = 0;
+    for (size_t attempt = 0; range.next < range.end; ++attempt) {
+      auto &peer_id =
+          fetch->peers[(range_index + attempt) % fetch->peers.size()];
+      auto length = std::min(range.end - range.next, kMaxRequestSize);
+      auto responses_res = co_await request(peer_id,
+                                            {
+                                                .root = fetch->root,
+                                                .offset = range.next,
+                                                .length = length,
+                                            });
+      auto end = range.next + length;
+      if (responses_res.has_value()) {
+        for (auto &response : responses_res.value()) {
+          auto &data = response.data.data();
+          if (response.size != fetch->ssz.size()
+              or response.offset != range.next or data.empty()
+              or data.size() > end - range.next) {
+            break;
+          }
+          std::ranges::copy(
+              data,
+              fetch->ssz.begin() + static_cast<ptrdiff_t>(range.next));
+          range.next += data.size();
+        }
+      }
+      if (range.next != end and ++failures > kMaxResumes) {
+        co_return responses_res.has_error() ? responses_res.error()
+                                            : StateRequestError::BAD_CHUNK;
+      }
+    }
+    co_return outcome::success();
+  }
+
+  libp2p::Coro<void> StateRequestProtocol::coroFetch(
+      std::shared_ptr<Fetch> fetch) {
+    auto result = co_await [&]() -> libp2p::CoroOutcome<State> {
+      // First chunk tells size of state
+      std::optional<StateResponse> first;
+      outcome::result<void> first_res = StateRequestError::UNKNOWN_STATE;
+      for (auto &peer_id : fetch->peers) {
+        auto responses_res = co_await request(
+            peer_id,
+            {.root = fetch->root, .offset = 0, .length = MAX_STATE_CHUNK_SIZE});
+        if (responses_res.has_error()) {
+          first_res = responses_res.error();
+          continue;
+        }
+        auto &responses = responses_res.value();
+        if (responses.empty() or responses.front().offset != 0
+            or responses.front().size > kMaxStateSize
+            or responses.front().data.size() > responses.front().size) {
+          first_res = StateRequestError::BAD_CHUNK;
+          continue;
+        }
+        first = std::move(responses.front());
+        break;
+      }
+      if (not first.has_value()) {
+        co_return first_res.error();
+      }
+      auto &received = first->data.data();
+      fetch->ssz.resize(first->size);
+      std::ranges::copy(received, fetch->ssz.begin());
+
+      // Rest is split into ranges, one per peer
+      auto rest = fetch->ssz.size() - received.size();
+      auto range_size =
+          std::max<uint64_t>(ceilDiv(rest, fetch->peers.size()), 1);
+      for (uint64_t next = received.size(); next < fetch->ssz.size();
+           next += range_size) {
+        fetch->ranges.emplace_back(Fetch::Range{
+            .next = next,
+            .end = std::min<uint64_t>(next + range_size, fetch->ssz.size()),
+        });
+      }
+      if (not fetch->ranges.empty()) {
+        boost::asio::steady_timer done{
+            *io_context_, boost::asio::steady_timer::time_point::max()};
+        auto running = fetch->ranges.size();
+        outcome::result<void> ranges_res = outcome::success();
+        for (size_t i = 0; i < fetch->ranges.size(); ++i) {
+          libp2p::coroSpawn(
+              *io_context_,
+              [self{shared_from_this()},
+               fetch,
+               i,
+               &done,
+               &running,
+               &ranges_res]() -> libp2p::Coro<void> {
+                auto range_res = co_await self->coroFetchRange(fetch, i);
+                if (range_res.has_error() and not ranges_res.has_error()) {
+                  ranges_res = range_res.error();
+                }
+                if (--running == 0) {
+                  done.cancel();
+                }
+              });
+        }
+        boost::system::error_code ec;
+        co_await done.async_wait(
+            boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+        BOOST_OUTCOME_CO_TRY(ranges_res);
+      }
+
+      BOOST_OUTCOME_CO_TRY(auto state, decode<State>(fetch->ssz));
+      fetch->ssz = {};
+      // Finalized block root commits to state through `state_root` of header
+      auto header = state.latest_block_header;
+      header.state_root = sszHash(state);
+      header.updateHash();
+      if (header.hash() != fetch->root) {
+        co_return StateRequestError::VALIDATION_FAILED;
+      }
+      co_return state;
+    }();
+    fetch->on_state(std::move(result));
+  }
+}  // namespace lean::modules
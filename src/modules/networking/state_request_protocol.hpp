@@ -0,0 +1,158 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include <libp2p/protocol/base_protocol.hpp>
+#include <qtils/enum_error_code.hpp>
+#include <qtils/shared_ref.hpp>
+
+#include "modules/networking/stream_pool.hpp"
+#include "modules/networking/traffic_shaper.hpp"
+#include "modules/networking/types.hpp"
+#include "types/block_hash.hpp"
+#include "types/state.hpp"
+
+namespace boost::asio {
+  class io_context;
+}  // namespace boost::asio
+
+namespace libp2p::host {
+  class BasicHost;
+}  // namespace libp2p::host
+
+namespace lean::blockchain {
+  class BlockTree;
+}  // namespace lean::blockchain
+
+namespace lean::modules {
+  class ReqRespMetrics;
+  class ServedStreams;
+
+  enum class StateRequestError : uint8_t {
+    NO_PEERS = 1,
+    UNKNOWN_STATE,
+    BAD_CHUNK,
+    VALIDATION_FAILED,
+  };
+  Q_ENUM_ERROR_CODE(StateRequestError) {
+    using E = decltype(e);
+    switch (e) {
+      case E::NO_PEERS:
+        return "No peers to fetch state from";
+      case E::UNKNOWN_STATE:
+        return "Peer doesn't serve requested state";
+      case E::BAD_CHUNK:
+        return "State response chunk doesn't match request";
+      case E::VALIDATION_FAILED:
+        return "State doesn't match requested finalized root";
+    }
+    abort();
+  }
+
+  /**
+   * Finalized state request-response protocol, checkpoint sync without
+   * trusted http api.
+   * Responds with requested range of SSZ encoded finalized state, split into
+   * response chunks of up to `MAX_STATE_CHUNK_SIZE` bytes.
+   * Only state of our latest finalized block is served, it is encoded once
+   * per finalization and shared by all requests.
+   */
+  class StateRequestProtocol
+      : public std::enable_shared_from_this<StateRequestProtocol>,
+        public libp2p::protocol::BaseProtocol {
+   public:
+    using GetState = std::function<outcome::result<
+        std::shared_ptr<const State>>(const BlockHash &block_hash)>;
+    /// Called on io thread with fetched and validated state
+    using OnState = std::function<void(outcome::result<State>)>;
+
+    static constexpr std::string_view kProtocolId =
+        "/leanconsensus/req/state_by_root/1/ssz_snappy";
+    static constexpr auto kTrafficProtocol = TrafficShaper::Protocol::State;
+    /// Bytes of state requested in single stream
+    static constexpr uint64_t kMaxRequestSize = 16 * MAX_STATE_CHUNK_SIZE;
+    /// Up to `kMaxRequestSize` bytes, throttled by peer upload limits
+    static constexpr std::chrono::seconds kResponseTimeout{60};
+    /// Larger state size reported by peer is not allocated
+    static constexpr uint64_t kMaxStateSize = 1 << 30;
+    /// Range is moved to next peer after failed request
+    static constexpr size_t kMaxResumes = 5;
+
+    StateRequestProtocol(std::shared_ptr<boost::asio::io_context> io_context,
+                         std::shared_ptr<libp2p::host::BasicHost> host,
+                         qtils::SharedRef<blockchain::BlockTree> block_tree,
+                         GetState get_state,
+                         qtils::SharedRef<ServedStreams> served_streams,
+                         qtils::SharedRef<StreamPool> stream_pool,
+                         qtils::SharedRef<TrafficShaper> traffic,
+                         qtils::SharedRef<ReqRespMetrics> metrics);
+
+    // BaseProtocol
+    libp2p::StreamProtocols getProtocolIds() const override;
+    void handle(std::shared_ptr<libp2p::Stream> stream) override;
+
+    void start();
+
+    /**
+     * Request range of encoded state in single stream.
+     * Response is cut short when stream fails, received chunks are kept, so
+     * request is resumed from end of last chunk.
+     */
+    libp2p::CoroOutcome<std::vector<StateResponse>> request(
+        libp2p::PeerId peer_id, StateRequest request);
+
+    /**
+     * Fetch state of finalized block `root` from `peers`, which reported it
+     * as finalized in status.
+     * First chunk tells size of state, the rest is split into ranges, one
+     * per peer, fetched in parallel. Failed range is resumed from received
+     * offset at next peer.
+     * State is validated against `root` through `state_root` of its latest
+     * block header.
+     */
+    void fetch(std::vector<libp2p::PeerId> peers,
+               BlockHash root,
+               OnState on_state);
+
+    /// Estimated memory used by encoded finalized state
+    size_t byteSize() const;
+
+   private:
+    struct EncodedState {
+      BlockHash root;
+      qtils::ByteVec ssz;
+    };
+    struct Fetch;
+
+    /// Encoding of our latest finalized state, nullptr if not `root`
+    outcome::result<std::shared_ptr<const EncodedState>> encodedState(
+        const BlockHash &root);
+
+    libp2p::CoroOutcome<void> coroRespond(
+        std::shared_ptr<libp2p::Stream> stream);
+    libp2p::Coro<void> coroFetch(std::shared_ptr<Fetch> fetch);
+    libp2p::CoroOutcome<void> coroFetchRange(std::shared_ptr<Fetch> fetch,
+                                             size_t range);
+
+    std::shared_ptr<boost::asio::io_context> io_context_;
+    std::shared_ptr<libp2p::host::BasicHost> host_;
+    qtils::SharedRef<blockchain::BlockTree> block_tree_;
+    GetState get_state_;
+    qtils::SharedRef<ServedStreams> served_streams_;
+    /// Pre-negotiated streams of requests
+    qtils::SharedRef<StreamPool> stream_pool_;
+    qtils::SharedRef<TrafficShaper> traffic_;
+    qtils::SharedRef<ReqRespMetrics> metrics_;
+    std::shared_ptr<const EncodedState> encoded_state_;
+  };
+}  // namespace lean::modules
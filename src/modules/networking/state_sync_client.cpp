@@ -7,10 +7,19 @@
 
 #include "modules/networking/state_sync_client.hpp"
 
-#include <future>
+#include <algorithm>
+#include <charconv>
+#include <format>
+#include <limits>
+#include <map>
 #include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string_view>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <boost/asio/awaitable.hpp>
 #include <boost/asio/co_spawn.hpp>
@@ -26,10 +35,13 @@
 #include <boost/beast/version.hpp>
 #include <boost/url.hpp>
 #include <openssl/ssl.h>
+#include <qtils/byte_vec.hpp>
 #include <qtils/final_action.hpp>
 
 #include "app/state_manager.hpp"
 #include "modules/networking/ssl_context.hpp"
+#include "serde/serialization.hpp"
+#include "utils/ceil_div.hpp"
 
 namespace net = boost::asio;
 namespace ssl = boost::asio::ssl;
@@ -61,6 +73,8 @@ OUTCOME_CPP_DEFINE_CATEGORY(lean, StateSyncError, e) {
       return "deserialization failed";
     case E::ValidationFailed:
       return "validation failed";
+    case E::NoAgreement:
+      return "sources don't agree on finalized state";
   }
   return "Unknown error";
 }
@@ -146,7 +160,7 @@ namespace lean {
       }
     };
 
-    outcome::result<State> map_aborted(const CancelState &cs) {
+    StateSyncError map_aborted(const CancelState &cs) {
       const auto r = cs.reason.load(std::memory_order_acquire);
       if (r == CancelReason::Timeout) {
         return StateSyncError::Timeout;
@@ -192,11 +206,76 @@ namespace lean {
       }
     }
 
+    /// Body read directly into this buffer, per chunk
+    constexpr size_t kChunkSize = 64 * 1024;
+
+    /**
+     * Part of state body downloaded from one source.
+     * Received bytes are kept across reconnects to resume with range.
+     */
+    struct Download {
+      const UrlParts *source = nullptr;
+      /// HEAD only learns `etag` and `content_length`
+      http::verb method = http::verb::get;
+      /// Buffer of whole body, shared by parallel downloads of its ranges
+      qtils::ByteVec *body = nullptr;
+      /// Range [first, end) of body, open range grows `body`
+      size_t first = 0;
+      std::optional<size_t> end;
+      /// Bytes received after `first`
+      size_t received = 0;
+      /// Validator of representation being downloaded, resume needs it
+      std::string etag;
+      std::optional<uint64_t> content_length;
+
+      bool done() const {
+        return end.has_value() and first + received == end.value();
+      }
+    };
+
+    /// Parse start of "bytes <first>-<last>/<size>"
+    std::optional<size_t> content_range_first(std::string_view range) {
+      constexpr std::string_view kUnit = "bytes ";
+      if (not range.starts_with(kUnit)) {
+        return std::nullopt;
+      }
+      range.remove_prefix(kUnit.size());
+      size_t first = 0;
+      auto [end, ec] =
+          std::from_chars(range.data(), range.data() + range.size(), first);
+      if (ec != std::errc{} or end == range.data() + range.size()
+          or *end != '-') {
+        return std::nullopt;
+      }
+      return first;
+    }
+
+    /**
+     * Root in ETag of lean api is finalized block root, which commits to
+     * state through `state_root` of header.
+     * State without such ETag can't be checked, so it is rejected.
+     */
+    bool validate_state(const State &state, std::string_view etag) {
+      if (etag.size() < 2 or etag.front() != '"' or etag.back() != '"') {
+        return false;
+      }
+      auto root_res =
+          BlockHash::fromHexWithPrefix(etag.substr(1, etag.size() - 2));
+      if (not root_res.has_value()) {
+        return false;
+      }
+      auto header = state.latest_block_header;
+      header.state_root = sszHash(state);
+      header.updateHash();
+      return header.hash() == root_res.value();
+    }
+
     template <typename Stream>
-    net::awaitable<outcome::result<State>> do_http_flow(
+    net::awaitable<outcome::result<void>> do_http_flow(
         tcp::resolver &resolver,
         Stream &stream,
         const UrlParts &parts,
+        Download &download,
         const std::chrono::seconds timeout,
         const std::atomic_flag &is_shutting_down,
         const bool do_tls_handshake) {
@@ -276,6 +355,16 @@ namespace lean {
       req.set(http::field::host, parts.host);
       req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
       req.set(http::field::accept, "application/octet-stream");
+      req.method(download.method);
+      const auto resume_from = download.first + download.received;
+      if (download.end.has_value()) {
+        req.set(http::field::range,
+                std::format("bytes={}-{}", resume_from, *download.end - 1));
+        req.set(http::field::if_range, download.etag);
+      } else if (resume_from != 0) {
+        req.set(http::field::range, std::format("bytes={}-", resume_from));
+        req.set(http::field::if_range, download.etag);
+      }
 
       co_await http::async_write(
           stream, req, net::redirect_error(net::use_awaitable, ec));
@@ -287,10 +376,12 @@ namespace lean {
       }
 
       beast::flat_buffer buffer;
-      http::response<http::vector_body<std::uint8_t>> res;
+      http::response_parser<http::buffer_body> parser;
+      parser.body_limit(std::numeric_limits<std::uint64_t>::max());
+      parser.skip(download.method == http::verb::head);
 
-      co_await http::async_read(
-          stream, buffer, res, net::redirect_error(net::use_awaitable, ec));
+      co_await http::async_read_header(
+          stream, buffer, parser, net::redirect_error(net::use_awaitable, ec));
       if (ec) {
         if (ec == net::error::operation_aborted) {
           co_return map_aborted(*cancel_state);
@@ -298,19 +389,79 @@ namespace lean {
         co_return StateSyncError::Network;
       }
 
-      timeout_timer.cancel();
-      shutdown_timer.cancel();
-
-      if (res.result() != http::status::ok) {
+      auto &res = parser.get();
+      if (download.method == http::verb::head) {
+        if (res.result() != http::status::ok) {
+          co_return StateSyncError::HttpBadStatus;
+        }
+        download.etag = res[http::field::etag];
+        download.content_length = parser.content_length();
+      } else if (res.result() == http::status::ok
+                 and not download.end.has_value()) {
+        // Full body, range was ignored or representation has changed
+        download.body->clear();
+        download.received = 0;
+        download.etag = res[http::field::etag];
+        if (auto length = parser.content_length()) {
+          download.body->reserve(length.value());
+        }
+      } else if (res.result() != http::status::partial_content
+                 or (resume_from == 0 and not download.end.has_value())
+                 or content_range_first(res[http::field::content_range])
+                        != resume_from) {
         co_return StateSyncError::HttpBadStatus;
+      } else if (auto length = parser.content_length();
+                 length and not download.end.has_value()) {
+        download.body->reserve(resume_from + length.value());
       }
-      auto &encoded_state = res.body();
 
-      auto state_res = decode<State>(encoded_state);
-      if (state_res.has_error()) {
-        co_return StateSyncError::DeserializeFailed;
+      // Read body chunks in place, so received part survives network failure
+      auto &body = *download.body;
+      while (not parser.is_done()) {
+        auto offset = download.first + download.received;
+        size_t chunk_size = kChunkSize;
+        if (download.end.has_value()) {
+          if (offset >= *download.end) {
+            // More than requested range
+            co_return StateSyncError::HttpBadStatus;
+          }
+          chunk_size = std::min(kChunkSize, *download.end - offset);
+        } else {
+          // Stay within reserved capacity, to not reallocate on last chunk
+          auto capacity = body.capacity();
+          if (capacity > offset) {
+            chunk_size = std::min(kChunkSize, capacity - offset);
+          }
+          body.resize(offset + chunk_size);
+        }
+        res.body().data = body.data() + offset;
+        res.body().size = chunk_size;
+        co_await http::async_read(stream,
+                                  buffer,
+                                  parser,
+                                  net::redirect_error(net::use_awaitable, ec));
+        download.received += chunk_size - res.body().size;
+        if (not download.end.has_value()) {
+          body.resize(download.first + download.received);
+        }
+        if (ec == http::error::need_buffer) {
+          ec = {};
+        }
+        if (ec) {
+          if (ec == net::error::operation_aborted) {
+            co_return map_aborted(*cancel_state);
+          }
+          co_return StateSyncError::Network;
+        }
+      }
+      if (download.method != http::verb::head and download.end.has_value()
+          and not download.done()) {
+        // Server closed range early
+        co_return StateSyncError::Network;
       }
-      auto st = state_res.value();
+
+      timeout_timer.cancel();
+      shutdown_timer.cancel();
 
       if constexpr (not std::is_same_v<Stream, beast::tcp_stream>) {
         if (do_tls_handshake) {
@@ -319,11 +470,12 @@ namespace lean {
         }
       }
 
-      co_return st;
+      co_return outcome::success();
     }
 
-    net::awaitable<outcome::result<State>> fetch_http_async(
+    net::awaitable<outcome::result<void>> fetch_http_async(
         const UrlParts &parts,
+        Download &download,
         const std::chrono::seconds timeout,
         const std::atomic_flag &is_shutting_down) {
       auto ex = co_await net::this_coro::executor;
@@ -332,12 +484,13 @@ namespace lean {
       beast::tcp_stream stream(ex);
 
       co_return co_await do_http_flow(
-          resolver, stream, parts, timeout, is_shutting_down, false);
+          resolver, stream, parts, download, timeout, is_shutting_down, false);
     }
 
-    net::awaitable<outcome::result<State>> fetch_https_async(
+    net::awaitable<outcome::result<void>> fetch_https_async(
         ssl::context &ssl_ctx,
         const UrlParts &parts,
+        Download &download,
         const std::chrono::seconds timeout,
         const std::atomic_flag &is_shutting_down) {
       auto ex = co_await net::this_coro::executor;
@@ -358,7 +511,199 @@ namespace lean {
       }
 
       co_return co_await do_http_flow(
-          resolver, stream, parts, timeout, is_shutting_down, true);
+          resolver, stream, parts, download, timeout, is_shutting_down, true);
+    }
+
+    net::awaitable<outcome::result<void>> fetch_async(
+        ssl::context &ssl_ctx,
+        Download &download,
+        const std::chrono::seconds timeout,
+        const std::atomic_flag &is_shutting_down) {
+      const auto &parts = *download.source;
+      if (parts.scheme == "https") {
+        co_return co_await fetch_https_async(
+            ssl_ctx, parts, download, timeout, is_shutting_down);
+      }
+      co_return co_await fetch_http_async(
+          parts, download, timeout, is_shutting_down);
+    }
+
+    /// Sources agreeing on most common ETag
+    struct Agreement {
+      std::string etag;
+      uint64_t size = 0;
+      std::vector<const UrlParts *> sources;
+    };
+
+    std::vector<outcome::result<void>> run_parallel(
+        ssl::context &ssl_ctx,
+        const std::atomic_flag &is_shutting_down,
+        std::span<Download *const> downloads,
+        std::chrono::seconds timeout) {
+      std::vector<outcome::result<void>> results(
+          downloads.size(), outcome::result<void>{StateSyncError::Network});
+      net::io_context io(1);
+      for (size_t i = 0; i < downloads.size(); ++i) {
+        net::co_spawn(
+            io,
+            [&, i]() -> net::awaitable<void> {
+              try {
+                results[i] = co_await fetch_async(
+                    ssl_ctx, *downloads[i], timeout, is_shutting_down);
+              } catch (...) {
+                results[i] = StateSyncError::Network;
+              }
+              co_return;
+            },
+            net::detached);
+      }
+      io.run();
+      return results;
+    }
+
+    outcome::result<void> fetch_single(
+        ssl::context &ssl_ctx,
+        const std::atomic_flag &is_shutting_down,
+        const UrlParts &source,
+        qtils::ByteVec &body,
+        std::string &etag,
+        std::chrono::seconds timeout) {
+      Download download{.source = &source, .body = &body};
+      Download *downloads[] = {&download};
+      for (size_t resumes = 0;; ++resumes) {
+        auto received = download.received;
+        auto download_res =
+            run_parallel(ssl_ctx, is_shutting_down, downloads, timeout).front();
+        if (download_res.has_value()) {
+          break;
+        }
+        // Resume only interrupted transfer which has made progress
+        if (download_res.error() != StateSyncError::Network
+            or download.etag.empty() or download.received == received
+            or resumes == StateSyncClient::kMaxResumes) {
+          return download_res.error();
+        }
+      }
+      etag = std::move(download.etag);
+      return outcome::success();
+    }
+
+    outcome::result<void> fetch_multi(
+        ssl::context &ssl_ctx,
+        const std::atomic_flag &is_shutting_down,
+        std::span<const UrlParts> sources,
+        qtils::ByteVec &body,
+        std::string &etag,
+        std::chrono::seconds timeout) {
+      // Ask all sources which state they serve
+      std::vector<Download> probes;
+      std::vector<Download *> probe_ptrs;
+      probes.reserve(sources.size());
+      for (auto &source : sources) {
+        probe_ptrs.emplace_back(&probes.emplace_back(Download{
+            .source = &source,
+            .method = http::verb::head,
+        }));
+      }
+      auto probe_results =
+          run_parallel(ssl_ctx, is_shutting_down, probe_ptrs, timeout);
+
+      std::map<std::string, Agreement> votes;
+      size_t responded = 0;
+      for (size_t i = 0; i < probes.size(); ++i) {
+        auto &probe = probes[i];
+        if (probe_results[i].has_error()) {
+          continue;
+        }
+        ++responded;
+        if (probe.etag.empty() or not probe.content_length.has_value()) {
+          continue;
+        }
+        auto &vote = votes[probe.etag];
+        if (vote.sources.empty()) {
+          vote.etag = probe.etag;
+          vote.size = probe.content_length.value();
+        } else if (vote.size != probe.content_length.value()) {
+          // Same ETag with different size, source is broken
+          continue;
+        }
+        vote.sources.emplace_back(probe.source);
+      }
+      if (responded == 0) {
+        return probe_results.front().error();
+      }
+      const Agreement *best = nullptr;
+      for (auto &vote : votes | std::views::values) {
+        if (not best or vote.sources.size() > best->sources.size()) {
+          best = &vote;
+        }
+      }
+      if (not best) {
+        // Sources can't be compared, download whole body from first responding
+        for (size_t i = 0; i < probes.size(); ++i) {
+          if (probe_results[i].has_value()) {
+            return fetch_single(ssl_ctx,
+                                is_shutting_down,
+                                *probes[i].source,
+                                body,
+                                etag,
+                                timeout);
+          }
+        }
+        return StateSyncError::Network;
+      }
+      if (best->sources.size() * 2 <= responded) {
+        return StateSyncError::NoAgreement;
+      }
+
+      // Split body into ranges, one per agreeing source
+      auto &agreed = best->sources;
+      body.resize(best->size);
+      auto range_size = std::max<size_t>(ceilDiv(best->size, agreed.size()), 1);
+      std::vector<Download> ranges;
+      for (size_t first = 0; first < best->size; first += range_size) {
+        ranges.emplace_back(Download{
+            .body = &body,
+            .first = first,
+            .end = std::min<size_t>(first + range_size, best->size),
+            .etag = best->etag,
+        });
+      }
+
+      // Unfinished ranges move to next source on each round
+      for (size_t round = 0;; ++round) {
+        std::vector<Download *> pending;
+        for (size_t i = 0; i < ranges.size(); ++i) {
+          if (not ranges[i].done()) {
+            ranges[i].source = agreed[(i + round) % agreed.size()];
+            pending.emplace_back(&ranges[i]);
+          }
+        }
+        if (pending.empty()) {
+          break;
+        }
+        auto results =
+            run_parallel(ssl_ctx, is_shutting_down, pending, timeout);
+        for (size_t i = 0; i < pending.size(); ++i) {
+          if (results[i].has_error()
+              and (results[i].error() != StateSyncError::Network
+                   or round == StateSyncClient::kMaxResumes)) {
+            if (results[i].error() != StateSyncError::HttpBadStatus) {
+              return results[i].error();
+            }
+            // Range requests are not supported or state has changed
+            body.clear();
+            return fetch_single(ssl_ctx,
+                                is_shutting_down,
+                                *agreed.front(),
+                                body,
+                                etag,
+                                timeout);
+          }
+        }
+      }
+      etag = best->etag;
+      return outcome::success();
     }
 
   }  // namespace
@@ -376,6 +721,11 @@ namespace lean {
 
   outcome::result<State> StateSyncClient::fetch(const std::string &url,
                                                 std::chrono::seconds timeout) {
+    return fetch(std::vector{url}, timeout);
+  }
+
+  outcome::result<State> StateSyncClient::fetch(
+      const std::vector<std::string> &urls, std::chrono::seconds timeout) {
     if (busy_.test_and_set(std::memory_order_acq_rel)) {
       return StateSyncError::Busy;
     }
@@ -385,46 +735,40 @@ namespace lean {
     if (is_shutting_down_.test()) {
       return StateSyncError::ShuttingDown;
     }
+    if (urls.empty()) {
+      return StateSyncError::InvalidUrl;
+    }
 
-    OUTCOME_TRY(url_parts, parse_url(url));
-
-    net::io_context io(1);
-
-    auto prom = std::make_shared<std::promise<outcome::result<State>>>();
-    auto fut = prom->get_future();
-
-    auto run_task = [&](auto &&task) {
-      using Task = std::decay_t<decltype(task)>;
-      net::co_spawn(
-          io,
-          [t = Task(std::forward<decltype(task)>(task)),
-           p = prom]() mutable -> net::awaitable<void> {
-            try {
-              p->set_value(co_await std::move(t));
-            } catch (...) {
-              p->set_value(StateSyncError::Network);
-            }
-            co_return;
-          },
-          net::detached);
-    };
+    std::vector<UrlParts> sources;
+    sources.reserve(urls.size());
+    for (auto &url : urls) {
+      OUTCOME_TRY(url_parts, parse_url(url));
+      sources.emplace_back(std::move(url_parts));
+    }
 
-    if (url_parts.scheme == "https") {
-      run_task(
-          fetch_https_async(*ssl_ctx_, url_parts, timeout, is_shutting_down_));
-    } else if (url_parts.scheme == "http") {
-      run_task(fetch_http_async(url_parts, timeout, is_shutting_down_));
+    qtils::ByteVec body;
+    std::string etag;
+    if (sources.size() == 1) {
+      OUTCOME_TRY(fetch_single(*ssl_ctx_,
+                               is_shutting_down_,
+                               sources.front(),
+                               body,
+                               etag,
+                               timeout));
     } else {
-      return StateSyncError::UnsupportedScheme;
+      OUTCOME_TRY(fetch_multi(
+          *ssl_ctx_, is_shutting_down_, sources, body, etag, timeout));
     }
 
-    io.run();
-
-    try {
-      return fut.get();
-    } catch (const std::exception &) {
-      return StateSyncError::Network;
+    auto state_res = decode<State>(body);
+    if (state_res.has_error()) {
+      return StateSyncError::DeserializeFailed;
+    }
+    body = {};
+    if (not validate_state(state_res.value(), etag)) {
+      return StateSyncError::ValidationFailed;
     }
+    return std::move(state_res.value());
   }
 
 }  // namespace lean
@@ -9,6 +9,7 @@
 #include <atomic>
 #include <chrono>
 #include <string>
+#include <vector>
 
 #include <qtils/outcome.hpp>
 #include <qtils/shared_ref.hpp>
@@ -36,19 +37,38 @@ namespace lean {
     Network,
     HttpBadStatus,
     DeserializeFailed,
-    ValidationFailed
+    ValidationFailed,
+    NoAgreement
   };
 
   class StateSyncClient final : Singleton<StateSyncClient> {
    public:
+    /// Reconnects with range request after network failure mid-body
+    static constexpr size_t kMaxResumes = 5;
+
     StateSyncClient(qtils::SharedRef<AsioSslContext> ssl_ctx,
                     qtils::SharedRef<app::StateManager> state_manager);
 
     void stop();
 
+    /**
+     * Download state and decode it.
+     * Body is read in chunks into single buffer, and interrupted download is
+     * resumed with range request. State is validated against finalized root
+     * from ETag, state without valid ETag is rejected.
+     */
     outcome::result<State> fetch(const std::string &url,
                                  std::chrono::seconds timeout);
 
+    /**
+     * Download state from several sources.
+     * All sources are asked for ETag of their finalized state in parallel,
+     * state agreed by majority of responding sources is downloaded in
+     * parallel ranges, one per agreeing source.
+     */
+    outcome::result<State> fetch(const std::vector<std::string> &urls,
+                                 std::chrono::seconds timeout);
+
    private:
     qtils::SharedRef<AsioSslContext> ssl_ctx_;
     qtils::SharedRef<app::StateManager> state_manager_;
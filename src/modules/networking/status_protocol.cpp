@@ -9,6 +9,7 @@
 #include <libp2p/coro/spawn.hpp>
 #include <libp2p/host/basic_host.hpp>
 
+#include "modules/networking/req_resp_metrics.hpp"
 #include "modules/networking/response_status.hpp"
 #include "modules/networking/ssz_snappy.hpp"
 
@@ -17,11 +18,13 @@ namespace lean::modules {
       std::shared_ptr<boost::asio::io_context> io_context,
       std::shared_ptr<libp2p::host::BasicHost> host,
       GetStatus get_status,
-      OnStatus on_status)
+      OnStatus on_status,
+      qtils::SharedRef<ReqRespMetrics> metrics)
       : io_context_{std::move(io_context)},
         host_{std::move(host)},
         get_status_{std::move(get_status)},
-        on_status_{std::move(on_status)} {}
+        on_status_{std::move(on_status)},
+        metrics_{std::move(metrics)} {}
 
   libp2p::StreamProtocols StatusProtocol::getProtocolIds() const {
     return {"/leanconsensus/req/status/1/ssz_snappy"};
@@ -41,19 +44,35 @@ namespace lean::modules {
 
   libp2p::CoroOutcome<void> StatusProtocol::connect(
       std::shared_ptr<libp2p::connection::CapableConnection> connection) {
-    BOOST_OUTCOME_CO_TRY(
-        auto stream, co_await host_->newStream(connection, getProtocolIds()));
-    BOOST_OUTCOME_CO_TRY(co_await write(stream));
-    BOOST_OUTCOME_CO_TRY(co_await readResponseStatus(stream));
-    BOOST_OUTCOME_CO_TRY(co_await read(stream));
-    co_return outcome::success();
+    ReqRespMetrics::Request timing;
+    std::optional<StreamDeadline> deadline;
+    auto res = co_await [&]() -> libp2p::CoroOutcome<void> {
+      BOOST_OUTCOME_CO_TRY(
+          auto stream,
+          co_await host_->newStream(connection, getProtocolIds()));
+      deadline.emplace(*io_context_, stream, kResponseTimeout);
+      BOOST_OUTCOME_CO_TRY(co_await write(stream));
+      timing.sent = ReqRespMetrics::Clock::now();
+      BOOST_OUTCOME_CO_TRY(co_await readResponseStatus(stream));
+      timing.first_byte = ReqRespMetrics::Clock::now();
+      BOOST_OUTCOME_CO_TRY(co_await read(stream, &timing.bytes));
+      co_return outcome::success();
+    }();
+    metrics_->onRequest(connection->remotePeer(),
+                        timing,
+                        deadline.has_value() and deadline->expired()
+                            ? ReqRespMetrics::Result::TIMEOUT
+                        : res.has_value() ? ReqRespMetrics::Result::SUCCESS
+                                          : ReqRespMetrics::Result::ERROR);
+    co_return res;
   }
 
   libp2p::CoroOutcome<void> StatusProtocol::read(
-      std::shared_ptr<libp2p::Stream> stream) {
+      std::shared_ptr<libp2p::Stream> stream, size_t *bytes) {
     auto peer_id = stream->remotePeerId();
     BOOST_OUTCOME_CO_TRY(auto encoded,
-                         co_await snappy::coUncompressFramed(stream));
+                         co_await snappy::coUncompressFramed(
+                             stream, kDecodeBudget<StatusMessage>, bytes));
     BOOST_OUTCOME_CO_TRY(auto status, decode<StatusMessage>(encoded));
     on_status_(messages::StatusMessageReceived{
         .from_peer = peer_id,
@@ -6,9 +6,11 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 
 #include <libp2p/protocol/base_protocol.hpp>
+#include <qtils/shared_ref.hpp>
 
 #include "modules/shared/networking_types.tmp.hpp"
 
@@ -21,16 +23,21 @@ namespace libp2p::host {
 }  // namespace libp2p::host
 
 namespace lean::modules {
+  class ReqRespMetrics;
+
   class StatusProtocol : public std::enable_shared_from_this<StatusProtocol>,
                          public libp2p::protocol::BaseProtocol {
    public:
     using GetStatus = std::function<StatusMessage()>;
     using OnStatus = std::function<void(messages::StatusMessageReceived)>;
 
+    static constexpr std::chrono::seconds kResponseTimeout{10};
+
     StatusProtocol(std::shared_ptr<boost::asio::io_context> io_context,
                    std::shared_ptr<libp2p::host::BasicHost> host,
                    GetStatus get_status,
-                   OnStatus on_status);
+                   OnStatus on_status,
+                   qtils::SharedRef<ReqRespMetrics> metrics);
 
     // BaseProtocol
     libp2p::StreamProtocols getProtocolIds() const override;
@@ -42,7 +49,9 @@ namespace lean::modules {
         std::shared_ptr<libp2p::connection::CapableConnection> connection);
 
    private:
-    libp2p::CoroOutcome<void> read(std::shared_ptr<libp2p::Stream> stream);
+    /// @param bytes incremented by compressed bytes of status, if not null
+    libp2p::CoroOutcome<void> read(std::shared_ptr<libp2p::Stream> stream,
+                                   size_t *bytes = nullptr);
     libp2p::CoroOutcome<void> write(std::shared_ptr<libp2p::Stream> stream);
     libp2p::CoroOutcome<void> coroHandle(
         std::shared_ptr<libp2p::Stream> stream);
@@ -51,5 +60,6 @@ namespace lean::modules {
     std::shared_ptr<libp2p::host::BasicHost> host_;
     GetStatus get_status_;
     OnStatus on_status_;
+    qtils::SharedRef<ReqRespMetrics> metrics_;
   };
 }  // namespace lean::modules
@@ -0,0 +1,95 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "modules/networking/stream_pool.hpp"
+
+#include <boost/asio/steady_timer.hpp>
+#include <libp2p/coro/spawn.hpp>
+#include <libp2p/host/basic_host.hpp>
+
+#include "metrics/metrics.hpp"
+
+namespace lean::modules {
+  StreamPool::StreamPool(std::shared_ptr<boost::asio::io_context> io_context,
+                         std::shared_ptr<libp2p::host::BasicHost> host,
+                         libp2p::StreamProtocols protocols,
+                         metrics::Counter *opened,
+                         metrics::Counter *reused,
+                         metrics::Histogram *setup_time)
+      : io_context_{std::move(io_context)},
+        host_{std::move(host)},
+        protocols_{std::move(protocols)},
+        opened_{opened},
+        reused_{reused},
+        setup_time_{setup_time} {}
+
+  libp2p::CoroOutcome<std::shared_ptr<libp2p::Stream>> StreamPool::take(
+      const libp2p::PeerId &peer_id) {
+    std::shared_ptr<libp2p::Stream> stream;
+    if (auto it = spare_.find(peer_id); it != spare_.end()) {
+      stream = std::move(it->second);
+      spare_.erase(it);
+      if (stream->isClosed()) {
+        stream.reset();
+      }
+    }
+    refill(peer_id);
+    if (stream) {
+      reused_->inc();
+      co_return stream;
+    }
+    auto started = Clock::now();
+    BOOST_OUTCOME_CO_TRY(auto new_stream,
+                         co_await host_->newStream(peer_id, protocols_));
+    setup_time_->observe(
+        std::chrono::duration<double>(Clock::now() - started).count());
+    opened_->inc();
+    co_return new_stream;
+  }
+
+  void StreamPool::refill(const libp2p::PeerId &peer_id) {
+    if (spare_.contains(peer_id) or not refilling_.emplace(peer_id).second) {
+      return;
+    }
+    libp2p::coroSpawn(
+        *io_context_,
+        [weak_self{weak_from_this()}, peer_id]() -> libp2p::Coro<void> {
+          auto self = weak_self.lock();
+          if (not self) {
+            co_return;
+          }
+          auto started = Clock::now();
+          auto stream_res =
+              co_await self->host_->newStream(peer_id, self->protocols_);
+          self->refilling_.erase(peer_id);
+          if (not stream_res.has_value()) {
+            co_return;
+          }
+          self->setup_time_->observe(
+              std::chrono::duration<double>(Clock::now() - started).count());
+          auto stream = std::move(stream_res.value());
+          if (not self->spare_.emplace(peer_id, stream).second) {
+            stream->reset();
+            co_return;
+          }
+          auto timer = std::make_shared<boost::asio::steady_timer>(
+              *self->io_context_, kMaxIdle);
+          timer->async_wait([weak_self, timer, peer_id, stream](
+                                boost::system::error_code ec) {
+            auto self = weak_self.lock();
+            if (ec or not self) {
+              return;
+            }
+            // Not taken
+            auto it = self->spare_.find(peer_id);
+            if (it != self->spare_.end() and it->second == stream) {
+              self->spare_.erase(it);
+              stream->reset();
+            }
+          });
+        });
+  }
+}  // namespace lean::modules
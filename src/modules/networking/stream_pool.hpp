@@ -0,0 +1,72 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <libp2p/protocol/base_protocol.hpp>
+
+namespace boost::asio {
+  class io_context;
+}  // namespace boost::asio
+
+namespace libp2p::host {
+  class BasicHost;
+}  // namespace libp2p::host
+
+namespace lean::metrics {
+  class Counter;
+  class Histogram;
+}  // namespace lean::metrics
+
+namespace lean::modules {
+  /**
+   * Pre-negotiated outgoing streams of request-response protocol.
+   *
+   * Protocol sends single request per stream, so stream can't be reused
+   * after response. Instead, when stream is taken for request to peer,
+   * spare stream to same peer is opened in background, so next request of
+   * sequential sync doesn't wait for stream setup and protocol negotiation.
+   * Spare stream not taken within `kMaxIdle` is reset, so peers don't keep
+   * idle streams open for long.
+   * Used from io thread only.
+   */
+  class StreamPool : public std::enable_shared_from_this<StreamPool> {
+   public:
+    static constexpr std::chrono::seconds kMaxIdle{5};
+
+    StreamPool(std::shared_ptr<boost::asio::io_context> io_context,
+               std::shared_ptr<libp2p::host::BasicHost> host,
+               libp2p::StreamProtocols protocols,
+               metrics::Counter *opened,
+               metrics::Counter *reused,
+               metrics::Histogram *setup_time);
+
+    /// Spare stream to peer if any, otherwise new one
+    libp2p::CoroOutcome<std::shared_ptr<libp2p::Stream>> take(
+        const libp2p::PeerId &peer_id);
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    /// Open spare stream to peer in background, if not opened yet
+    void refill(const libp2p::PeerId &peer_id);
+
+    std::shared_ptr<boost::asio::io_context> io_context_;
+    std::shared_ptr<libp2p::host::BasicHost> host_;
+    libp2p::StreamProtocols protocols_;
+    metrics::Counter *opened_;
+    metrics::Counter *reused_;
+    metrics::Histogram *setup_time_;
+    std::unordered_map<libp2p::PeerId, std::shared_ptr<libp2p::Stream>> spare_;
+    /// Peers spare stream is being opened to
+    std::unordered_set<libp2p::PeerId> refilling_;
+  };
+}  // namespace lean::modules
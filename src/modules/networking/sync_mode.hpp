@@ -0,0 +1,77 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "types/slot.hpp"
+
+namespace lean::modules {
+  /**
+   * Whether node follows chain by gossip or catches up by range sync.
+   *
+   * Far behind peers, gossip attestations and blocks refer to heads node
+   * doesn't have, so caching them and fetching their parents by root only
+   * wastes memory and requests. In `Bulk` mode blocks are fetched by larger
+   * range batches and imported as segments, and attestations for unknown
+   * heads are dropped.
+   * Mode switches with hysteresis, so it doesn't flap near threshold.
+   */
+  class SyncMode {
+   public:
+    enum class Mode : uint8_t {
+      Gossip,
+      Bulk,
+    };
+
+    /// Switch to bulk when peers head is further ahead than this
+    static constexpr Slot kEnterBulkDistance = 32;
+    /// Switch back to gossip when peers head is not further than this
+    static constexpr Slot kExitBulkDistance = 8;
+
+    static std::string_view name(Mode mode) {
+      switch (mode) {
+        case Mode::Gossip:
+          return "gossip";
+        case Mode::Bulk:
+          return "bulk";
+      }
+      return "unknown";
+    }
+
+    Mode mode() const {
+      return mode_;
+    }
+
+    bool bulk() const {
+      return mode_ == Mode::Bulk;
+    }
+
+    /**
+     * Update mode by distance from our best block to peers head.
+     * @return whether mode changed
+     */
+    bool update(Slot best, Slot peers_head) {
+      auto distance = peers_head > best ? peers_head - best : 0;
+      auto mode = mode_;
+      if (distance > kEnterBulkDistance) {
+        mode = Mode::Bulk;
+      } else if (distance <= kExitBulkDistance) {
+        mode = Mode::Gossip;
+      }
+      if (mode == mode_) {
+        return false;
+      }
+      mode_ = mode;
+      return true;
+    }
+
+   private:
+    Mode mode_ = Mode::Gossip;
+  };
+}  // namespace lean::modules
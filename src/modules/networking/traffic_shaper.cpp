@@ -0,0 +1,112 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "modules/networking/traffic_shaper.hpp"
+
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/asio/use_awaitable.hpp>
+
+#include "metrics/metrics.hpp"
+
+namespace lean::modules {
+  std::string_view TrafficShaper::name(Protocol protocol) {
+    switch (protocol) {
+      case Protocol::Gossip:
+        return "gossip";
+      case Protocol::BlocksByRoot:
+        return "blocks_by_root";
+      case Protocol::BlocksByRange:
+        return "blocks_by_range";
+      case Protocol::AttestationPush:
+        return "attestation_push";
+      case Protocol::State:
+        return "state";
+      case Protocol::PeerExchange:
+        return "peer_exchange";
+      case Protocol::COUNT:
+        break;
+    }
+    return "unknown";
+  }
+
+  TrafficShaper::TrafficShaper(metrics::Metrics &metrics,
+                               const app::Configuration::NetworkConfig &config)
+      : peer_serve_rate_{config.peer_serve_rate},
+        upload_{config.upload_rate, Clock::now()} {
+    for (size_t i = 0; i < bytes_.size(); ++i) {
+      std::string protocol{name(static_cast<Protocol>(i))};
+      bytes_[i][static_cast<size_t>(Direction::In)] =
+          metrics.lean_network_bytes(
+              {{"protocol", protocol}, {"direction", "in"}});
+      bytes_[i][static_cast<size_t>(Direction::Out)] =
+          metrics.lean_network_bytes(
+              {{"protocol", protocol}, {"direction", "out"}});
+      throttled_[i] =
+          metrics.lean_network_throttled_seconds({{"protocol", protocol}});
+    }
+  }
+
+  void TrafficShaper::record(Protocol protocol,
+                             Direction direction,
+                             const std::optional<libp2p::PeerId> &peer_id,
+                             size_t bytes) {
+    auto now = Clock::now();
+    bytes_[static_cast<size_t>(protocol)][static_cast<size_t>(direction)]->inc(
+        static_cast<double>(bytes));
+    if (direction == Direction::Out and protocol == Protocol::Gossip) {
+      std::ignore = upload_.take(bytes, now);
+    }
+    if (peer_id.has_value()) {
+      auto &traffic = peer(*peer_id, now);
+      (direction == Direction::In ? traffic.in : traffic.out) += bytes;
+    }
+  }
+
+  libp2p::Coro<void> TrafficShaper::serve(Protocol protocol,
+                                          const libp2p::PeerId &peer_id,
+                                          size_t bytes) {
+    auto now = Clock::now();
+    auto &traffic = peer(peer_id, now);
+    auto delay =
+        std::max(upload_.take(bytes, now), traffic.serve.take(bytes, now));
+    traffic.out += bytes;
+    bytes_[static_cast<size_t>(protocol)][static_cast<size_t>(Direction::Out)]
+        ->inc(static_cast<double>(bytes));
+    if (delay <= Clock::duration::zero()) {
+      co_return;
+    }
+    throttled_[static_cast<size_t>(protocol)]->inc(
+        std::chrono::duration<double>(delay).count());
+    boost::asio::steady_timer timer{co_await boost::asio::this_coro::executor,
+                                    delay};
+    boost::system::error_code ec;
+    co_await timer.async_wait(
+        boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+  }
+
+  std::optional<TrafficShaper::PeerTraffic> TrafficShaper::remove(
+      const libp2p::PeerId &peer_id) {
+    auto node = peers_.extract(peer_id);
+    if (node.empty()) {
+      return std::nullopt;
+    }
+    return std::move(node.mapped());
+  }
+
+  TrafficShaper::PeerTraffic &TrafficShaper::peer(
+      const libp2p::PeerId &peer_id, Clock::time_point now) {
+    auto it = peers_.find(peer_id);
+    if (it == peers_.end()) {
+      it = peers_
+               .emplace(peer_id,
+                        PeerTraffic{.serve = {peer_serve_rate_, now}})
+               .first;
+    }
+    return it->second;
+  }
+}  // namespace lean::modules
@@ -0,0 +1,141 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+
+#include <libp2p/coro/coro.hpp>
+#include <libp2p/peer/peer_id.hpp>
+
+#include "app/configuration.hpp"
+
+namespace lean::metrics {
+  class Counter;
+  class Metrics;
+}  // namespace lean::metrics
+
+namespace lean::modules {
+  /**
+   * Token bucket of bytes.
+   * Taking more than available leaves debt delaying next takes, so large
+   * block isn't starved by small messages.
+   */
+  class TokenBucket {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    /// @param rate bytes per second, 0 is unlimited
+    TokenBucket(uint64_t rate, Clock::time_point now)
+        : rate_{static_cast<double>(rate)},
+          // One second of traffic
+          burst_{rate_},
+          tokens_{burst_},
+          updated_{now} {}
+
+    /// Take `bytes`, @return time until balance is not negative
+    Clock::duration take(size_t bytes, Clock::time_point now) {
+      if (rate_ == 0) {
+        return {};
+      }
+      auto elapsed = std::chrono::duration<double>(now - updated_).count();
+      updated_ = now;
+      tokens_ = std::min(burst_, tokens_ + std::max(elapsed, 0.0) * rate_);
+      tokens_ -= static_cast<double>(bytes);
+      if (tokens_ >= 0) {
+        return {};
+      }
+      return std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(-tokens_ / rate_));
+    }
+
+   private:
+    double rate_;
+    double burst_;
+    double tokens_;
+    Clock::time_point updated_;
+  };
+
+  /**
+   * Byte accounting by protocol and peer, and shaping of blocks served to
+   * peers.
+   *
+   * Gossip is sent without waiting, but takes upload tokens too, so served
+   * blocks yield to gossip when upload is saturated. Served response chunks
+   * wait for both upload limit and limit of peer.
+   * Per peer totals are kept in memory only, peer id labels would grow
+   * metrics without bound.
+   * Used from io thread only.
+   */
+  class TrafficShaper {
+   public:
+    using Clock = TokenBucket::Clock;
+
+    enum class Protocol : uint8_t {
+      Gossip,
+      BlocksByRoot,
+      BlocksByRange,
+      AttestationPush,
+      State,
+      PeerExchange,
+      COUNT,
+    };
+
+    enum class Direction : uint8_t {
+      In,
+      Out,
+      COUNT,
+    };
+
+    /// Bytes exchanged with peer
+    struct PeerTraffic {
+      uint64_t in = 0;
+      uint64_t out = 0;
+      TokenBucket serve;
+    };
+
+    static std::string_view name(Protocol protocol);
+
+    TrafficShaper(metrics::Metrics &metrics,
+                  const app::Configuration::NetworkConfig &config);
+
+    /// Account bytes, gossip sent takes upload tokens without waiting
+    void record(Protocol protocol,
+                Direction direction,
+                const std::optional<libp2p::PeerId> &peer_id,
+                size_t bytes);
+
+    /**
+     * Wait until response chunk of `bytes` fits upload limit and serve
+     * limit of peer, and account it.
+     */
+    libp2p::Coro<void> serve(Protocol protocol,
+                             const libp2p::PeerId &peer_id,
+                             size_t bytes);
+
+    /// Forget disconnected peer, @return bytes exchanged with it
+    std::optional<PeerTraffic> remove(const libp2p::PeerId &peer_id);
+
+   private:
+    PeerTraffic &peer(const libp2p::PeerId &peer_id, Clock::time_point now);
+
+    uint64_t peer_serve_rate_;
+    TokenBucket upload_;
+    std::unordered_map<libp2p::PeerId, PeerTraffic> peers_;
+    std::array<std::array<metrics::Counter *,
+                          static_cast<size_t>(Direction::COUNT)>,
+               static_cast<size_t>(Protocol::COUNT)>
+        bytes_{};
+    std::array<metrics::Counter *, static_cast<size_t>(Protocol::COUNT)>
+        throttled_{};
+  };
+}  // namespace lean::modules
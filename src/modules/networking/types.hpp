@@ -23,5 +23,67 @@ namespace lean {
     SSZ_AND_JSON_FIELDS(roots);
   };
 
+  /**
+   * Request blocks of canonical chain with slot in
+   * `[start_slot, start_slot + count)`.
+   */
+  struct BlocksByRangeRequest : ssz::ssz_container {
+    Slot start_slot;
+    uint64_t count;
+
+    SSZ_AND_JSON_FIELDS(start_slot, count);
+  };
+
   using BlockResponse = SignedBlock;
+
+  /**
+   * Request bytes `[offset, offset + length)` of SSZ encoded state of
+   * finalized block `root`.
+   */
+  struct StateRequest : ssz::ssz_container {
+    BlockHash root;
+    uint64_t offset;
+    uint64_t length;
+
+    SSZ_AND_JSON_FIELDS(root, offset, length);
+  };
+
+  /// Part of SSZ encoded state starting at `offset`, of `size` bytes total
+  struct StateResponse : ssz::ssz_variable_size_container {
+    uint64_t size;
+    uint64_t offset;
+    ssz::list<uint8_t, MAX_STATE_CHUNK_SIZE> data;
+
+    SSZ_AND_JSON_FIELDS(size, offset, data);
+  };
+
+  /// Bit per attestation subnet, as ENR `attnets`
+  using SubnetBits = uint64_t;
+
+  /// Request peers known to responder, on `subnets` first
+  struct PeerExchangeRequest : ssz::ssz_container {
+    SubnetBits subnets;
+    uint64_t count;
+
+    SSZ_AND_JSON_FIELDS(subnets, count);
+  };
+
+  /// Peer with its attestation subnets and aggregator role
+  struct PeerAdvert : ssz::ssz_variable_size_container {
+    /// Encoded `libp2p::PeerId`
+    ssz::list<uint8_t, 64> peer_id;
+    /// Encoded multiaddress
+    ssz::list<uint8_t, 256> address;
+    SubnetBits subnets;
+    bool is_aggregator;
+
+    SSZ_AND_JSON_FIELDS(peer_id, address, subnets, is_aggregator);
+  };
+
+  /// Responder itself first, then peers ranked for request
+  struct PeerExchangeResponse : ssz::ssz_variable_size_container {
+    ssz::list<PeerAdvert, MAX_PEER_EXCHANGE_PEERS + 1> peers;
+
+    SSZ_AND_JSON_FIELDS(peers);
+  };
 }  // namespace lean
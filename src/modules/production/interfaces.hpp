@@ -13,6 +13,7 @@
 namespace lean::messages {
   struct SlotStarted;
   struct SlotIntervalStarted;
+  struct AttestationDuty;
   struct Finalized;
   struct NewLeaf;
 }  // namespace lean::messages
@@ -36,6 +37,12 @@ namespace lean::modules {
     virtual void dispatchSendSignedAggregatedAttestation(
         std::shared_ptr<const messages::SendSignedAggregatedAttestation>
             message) = 0;
+
+    virtual void dispatchSendGossipBatch(
+        std::shared_ptr<const messages::SendGossipBatch> message) = 0;
+
+    virtual void dispatchAttestationDuty(
+        std::shared_ptr<const messages::AttestationDuty> message) = 0;
   };
 
   struct ProductionModule {
@@ -45,28 +45,36 @@ namespace lean::modules {
     // advance fork choice store to current time
     auto res = fork_choice_store_->onTick(clock_->nowMsec());
 
-    // dispatch all votes and blocks produced during advance time
+    // dispatch all votes and blocks produced during advance time,
+    // votes and aggregations are gossiped together by one batch
+    auto batch = std::make_shared<messages::SendGossipBatch>();
     for (auto &vote_or_block : res) {
       qtils::visit_in_place(
           vote_or_block,
-          [&](const SignedAttestation &v) {
-            loader_.dispatchSendSignedVote(
-                std::make_shared<messages::SendSignedVote>(v));
+          [&](SignedAttestation &v) {
+            batch->votes.emplace_back(std::move(v));
           },
-          [&](const SignedAggregatedAttestation &v) {
-            loader_.dispatchSendSignedAggregatedAttestation(
-                std::make_shared<messages::SendSignedAggregatedAttestation>(v));
+          [&](SignedAggregatedAttestation &v) {
+            batch->aggregations.emplace_back(std::move(v));
           },
-          [&](const SignedBlock &v) {
+          [&](SignedBlock &v) {
+            // Block is imported by fork choice already, send it without copy
             loader_.dispatchSendSignedBlock(
-                std::make_shared<messages::SendSignedBlock>(v));
-            auto res = block_tree_->addBlock(v);
-            if (!res.has_value()) {
-              SL_ERROR(
-                  logger_, "Failed to add produced block: {}", res.error());
-            }
+                std::make_shared<messages::SendSignedBlock>(std::move(v)));
           });
     }
+    if (not batch->votes.empty() or not batch->aggregations.empty()) {
+      loader_.dispatchSendGossipBatch(std::move(batch));
+    }
+
+    // Validator processes sign same data as local validators
+    if (msg->interval.phase() == 1) {
+      auto data = fork_choice_store_->attestationDuty();
+      if (data.has_value() and data->slot == msg->interval.slot()) {
+        loader_.dispatchAttestationDuty(
+            std::make_shared<messages::AttestationDuty>(data.value()));
+      }
+    }
   }
 
   void ProductionModuleImpl::on_leave_update(
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <libp2p/peer/peer_id.hpp>
 
 #include "modules/networking/types.hpp"
@@ -54,4 +56,13 @@ namespace lean::messages {
 
   using SendSignedAggregatedAttestation =
       BroadcastNotification<SignedAggregatedAttestation>;
+
+  /**
+   * Attestations and aggregations produced by one tick, encoded in parallel
+   * and published by single io task.
+   */
+  struct SendGossipBatch {
+    std::vector<SignedAttestation> votes;
+    std::vector<SignedAggregatedAttestation> aggregations;
+  };
 }  // namespace lean::messages
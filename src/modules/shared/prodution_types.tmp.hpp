@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "types/attestation_data.hpp"
 #include "types/block_header.hpp"
 #include "types/types.hpp"
 
@@ -19,6 +20,11 @@ namespace lean::messages {
     Interval interval;
   };
 
+  /// Attestation data of slot, for validator processes to sign
+  struct AttestationDuty {
+    AttestationData data;
+  };
+
   struct NewLeaf {
     BlockHeader header;
     bool best = false;
@@ -26,7 +32,11 @@ namespace lean::messages {
 
   struct Finalized {
     BlockIndex finalized;
+    /// Ancestors of finalized block which left block tree
     std::vector<BlockIndex> retired;
+    /// Non-canonical blocks dropped from block tree, left for pruner to
+    /// remove from storage
+    std::vector<BlockIndex> pruned;
   };
 
 }  // namespace lean::messages
@@ -6,13 +6,21 @@
 
 #pragma once
 
+#include <qtils/shared_ref.hpp>
+
 #include "common.hpp"
 #include "dispatcher.hpp"
 #include "thread_handler.hpp"
 #include "utils/ctor_limiters.hpp"
+#include "utils/worker_pool.hpp"
 
 namespace lean::se {
 
+  /**
+   * Dispatcher with dedicated serial handler per fixed tid.
+   * `kExecuteInPool` tasks run on shared `WorkerPool`, `kPoolSize` is size of
+   * own pool only when none is provided.
+   */
   template <uint32_t kCount, uint32_t kPoolSize>
   class AsyncDispatcher final : public Dispatcher, NonCopyable, NonMovable {
    public:
@@ -28,9 +36,11 @@ namespace lean::se {
     };
 
     SchedulerContext handlers_[kHandlersCount];
-    SchedulerContext pool_[kPoolThreadsCount];
+    std::shared_ptr<WorkerPool> worker_pool_;
+    /// Keeps delayed pool tasks until their deadline, then posts them to pool
+    std::shared_ptr<ThreadHandler> pool_timer_;
 
-    std::atomic_int64_t temporary_handlers_tasks_counter_;
+    std::atomic_int64_t pool_tasks_counter_;
     std::atomic<bool> is_disposed_;
 
     struct BoundContexts {
@@ -70,36 +80,40 @@ namespace lean::se {
         return;
       }
 
-      std::optional<typename Parent::Task> opt_task = std::move(task);
-      for (auto &handler : pool_) {
-        if (opt_task =
-                handler.handler->uploadIfFree(timeout, std::move(*opt_task));
-            !opt_task) {
-          return;
-        }
+      if (timeout.count() == 0) {
+        postToPool(std::move(task));
+        return;
       }
+      pool_timer_->addDelayed(
+          timeout, [this, task{std::move(task)}]() mutable {
+            if (!is_disposed_.load()) {
+              postToPool(std::move(task));
+            }
+          });
+    }
 
-      auto h = std::make_shared<ThreadHandler>();
-      ++temporary_handlers_tasks_counter_;
-      h->addDelayed(timeout, [this, h, task{std::move(*opt_task)}]() mutable {
+    void postToPool(typename Parent::Task &&task) {
+      ++pool_tasks_counter_;
+      worker_pool_->post([this, task{std::move(task)}] {
         if (!is_disposed_.load()) {
           task();
         }
-        --temporary_handlers_tasks_counter_;
-        h->dispose(false);
+        --pool_tasks_counter_;
       });
     }
 
    public:
-    AsyncDispatcher() {
-      temporary_handlers_tasks_counter_.store(0);
+    AsyncDispatcher()
+        : AsyncDispatcher(std::make_shared<WorkerPool>(kPoolThreadsCount)) {}
+
+    explicit AsyncDispatcher(qtils::SharedRef<WorkerPool> worker_pool)
+        : worker_pool_{std::move(worker_pool)},
+          pool_timer_{std::make_shared<ThreadHandler>()} {
+      pool_tasks_counter_.store(0);
       is_disposed_ = false;
       for (auto &h : handlers_) {
         h.handler = std::make_shared<ThreadHandler>();
       }
-      for (auto &h : pool_) {
-        h.handler = std::make_shared<ThreadHandler>();
-      }
     }
 
     void dispose() override {
@@ -107,11 +121,9 @@ namespace lean::se {
       for (auto &h : handlers_) {
         h.handler->dispose();
       }
-      for (auto &h : pool_) {
-        h.handler->dispose();
-      }
+      pool_timer_->dispose();
 
-      while (temporary_handlers_tasks_counter_.load() != 0) {
+      while (pool_tasks_counter_.load() != 0) {
         std::this_thread::sleep_for(std::chrono::microseconds(0ull));
       }
     }
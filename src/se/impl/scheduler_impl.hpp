@@ -20,6 +20,7 @@
 #include "common.hpp"
 #include "scheduler.hpp"
 #include "utils/ctor_limiters.hpp"
+#include "utils/mpmc_queue.hpp"
 
 namespace lean::se {
 
@@ -36,19 +37,36 @@ namespace lean::se {
     };
     using TaskContainer = std::deque<TimedTask>;
 
+    /// Immediate tasks kept lock-free, until ring overflows
+    static constexpr size_t kImmediateCapacity = 1024;
+
     /// Flag shows if thread loop should continue processing or exit
     std::atomic_flag proceed_;
 
     mutable std::mutex tasks_cs_;
 
-    /// List of tasks to be performed
+    /// List of delayed and repeated tasks to be performed
     TaskContainer tasks_;
 
+    /// Deadline of first of `tasks_`, checked without lock
+    std::atomic<Time::rep> first_deadline_;
+
+    /// Immediate tasks, fast path without `tasks_cs_`
+    MpmcQueue<Task> immediate_{kImmediateCapacity};
+
+    /// Immediate tasks which didn't fit into `immediate_`, guarded by
+    /// `tasks_cs_`. While not empty, immediate tasks go here to keep order.
+    std::deque<Task> overflow_;
+    std::atomic_size_t overflow_size_;
+
     /// Event that is set when loop should make some work or exit
     utils::WaitForSingleObject event_;
 
+    /// Loop is going to wait for `event_`, so producers must set it
+    std::atomic_bool sleeping_;
+
     /// Flag that shows if current handler is in task execution state
-    bool is_busy_;
+    std::atomic_bool is_busy_;
 
     std::thread::id id_;
 
@@ -75,23 +93,60 @@ namespace lean::se {
       tasks_.insert(after, std::move(t));
     }
 
+    void updateFirstDeadline() {
+      checkLocked();
+      first_deadline_.store(
+          tasks_.empty() ? Time::duration::max().count()
+                         : (tasks_.front().created + tasks_.front().timeout)
+                               .time_since_epoch()
+                               .count(),
+          std::memory_order_relaxed);
+    }
+
     bool extractExpired(TimedTask &task) {
-      std::lock_guard lock(tasks_cs_);
       const Timepoint before = now();
+      if (before.time_since_epoch().count()
+          < first_deadline_.load(std::memory_order_relaxed)) {
+        return false;
+      }
+      std::lock_guard lock(tasks_cs_);
       if (!tasks_.empty()) {
         auto &first_task = tasks_.front();
         const auto timepoint = first_task.created + first_task.timeout;
         if (timepoint <= before) {
           task = std::move(first_task);
           tasks_.pop_front();
+          updateFirstDeadline();
           is_busy_ = true;
           return true;
         }
       }
-      is_busy_ = false;
       return false;
     }
 
+    bool extractImmediate(Task &task) {
+      if (immediate_.tryPop(task)) {
+        is_busy_ = true;
+        return true;
+      }
+      if (overflow_size_.load() == 0) {
+        return false;
+      }
+      std::lock_guard lock(tasks_cs_);
+      if (overflow_.empty()) {
+        return false;
+      }
+      task = std::move(overflow_.front());
+      overflow_.pop_front();
+      --overflow_size_;
+      is_busy_ = true;
+      return true;
+    }
+
+    bool hasImmediate() const {
+      return not immediate_.empty() or overflow_size_.load() != 0;
+    }
+
     ///@returns time duration from now till first task will be executed
     std::chrono::microseconds untilFirst() const {
       std::lock_guard lock(tasks_cs_);
@@ -117,38 +172,75 @@ namespace lean::se {
       }
 
       insert(after(task.created + task.timeout), std::move(task));
+      updateFirstDeadline();
       event_.set();
     }
 
+    void addImmediate(Task &&task) {
+      is_busy_ = true;
+      if (overflow_size_.load() != 0
+          or not immediate_.tryPush(std::move(task))) {
+        std::lock_guard lock(tasks_cs_);
+        overflow_.emplace_back(std::move(task));
+        ++overflow_size_;
+      }
+      // Pairs with fence in `process`, either producer sees `sleeping_` or
+      // loop sees new task
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (sleeping_.load()) {
+        event_.set();
+      }
+    }
+
+    void execute(const Task &task) {
+      try {
+        task();
+      } catch (std::exception &e) {
+        std::cerr << "Exception during task execution: " << e.what()
+                  << std::endl;
+      } catch (...) {
+        std::cerr << "Unknown exception during task execution\n";
+      }
+    }
+
    public:
-    SchedulerBase() : is_busy_(false) {
+    SchedulerBase()
+        : first_deadline_(Time::duration::max().count()),
+          overflow_size_(0),
+          sleeping_(false),
+          is_busy_(false) {
       proceed_.test_and_set();
     }
 
     uint32_t process() {
       id_ = std::this_thread::get_id();
       TimedTask task{};
+      Task immediate;
       do {
         if (extractExpired(task)) {
-          try {
-            if (task.task) {
-              if (!task.predic) {
-                task.task();
-              } else if (task.predic()) {
-                task.task();
-                std::lock_guard lock(tasks_cs_);
-                task.created = now();
-                add(std::move(task));
-              }
+          if (task.task) {
+            if (!task.predic) {
+              execute(task.task);
+            } else if (task.predic()) {
+              execute(task.task);
+              std::lock_guard lock(tasks_cs_);
+              task.created = now();
+              add(std::move(task));
             }
-          } catch (std::exception &e) {
-            std::cerr << "Exception during task execution: " << e.what()
-                      << std::endl;
-          } catch (...) {
-            std::cerr << "Unknown exception during task execution\n";
           }
+        } else if (extractImmediate(immediate)) {
+          if (immediate) {
+            execute(immediate);
+          }
+          immediate = nullptr;
         } else {
-          event_.wait(untilFirst());
+          is_busy_ = false;
+          sleeping_ = true;
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          if (not hasImmediate()) {
+            event_.wait(untilFirst());
+          }
+          sleeping_ = false;
         }
 
       } while (proceed_.test_and_set());
@@ -161,22 +253,30 @@ namespace lean::se {
     }
 
     bool isBusy() const override {
-      std::lock_guard lock(tasks_cs_);
       return is_busy_;
     }
 
     std::optional<Task> uploadIfFree(std::chrono::microseconds timeout,
                                      Task &&task) override {
-      std::lock_guard lock(tasks_cs_);
-      if (is_busy_) {
+      bool expected = false;
+      if (not is_busy_.compare_exchange_strong(expected, true)) {
         return std::move(task);
       }
 
+      if (timeout == std::chrono::microseconds(0ull)) {
+        addImmediate(std::move(task));
+        return std::nullopt;
+      }
+      std::lock_guard lock(tasks_cs_);
       add(TimedTask{now(), timeout, nullptr, std::move(task)});
       return std::nullopt;
     }
 
     void addDelayed(std::chrono::microseconds timeout, Task &&t) override {
+      if (timeout == std::chrono::microseconds(0ull)) {
+        addImmediate(std::move(t));
+        return;
+      }
       std::lock_guard lock(tasks_cs_);
       add(TimedTask{now(), timeout, nullptr, std::move(t)});
     }
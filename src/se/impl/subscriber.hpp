@@ -16,6 +16,16 @@ namespace lean::se {
 
   using SubscriptionSetId = uint32_t;
 
+  /// How events queued up while subscriber is busy are delivered
+  enum class Coalescing : uint8_t {
+    /// Each event separately
+    None,
+    /// Latest of queued events only
+    LatestWins,
+    /// All queued events at once, to batch callback
+    Accumulate,
+  };
+
   /**
    * Base implementation of subscription system's subscriber.
    * @tparam EventKey type to specify notified events
@@ -43,6 +53,22 @@ namespace lean::se {
     virtual void on_notify(SubscriptionSetId set_id,
                            const EventType &key,
                            Arguments &&...args) = 0;
+
+    /**
+     * Queue event of coalescing subscription, merging it with events not
+     * delivered yet. Called on notifying thread.
+     * @return true if delivery task has to be scheduled
+     */
+    virtual bool enqueue(SubscriptionSetId set_id,
+                         const EventType &key,
+                         const Arguments &...args) = 0;
+
+    /**
+     * Deliver events merged by `enqueue`
+     * @param set_id the id of the subscription set
+     * @param key notified event
+     */
+    virtual void deliver(SubscriptionSetId set_id, const EventType &key) = 0;
   };
 
 }  // namespace lean::se
@@ -8,8 +8,12 @@
 
 #include <atomic>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include "subscriber.hpp"
 #include "subscription_engine.hpp"
@@ -50,6 +54,14 @@ namespace lean::se {
                            const typename Parent::EventType &,
                            Arguments &&...)>;
 
+    /// Events merged while subscriber was busy, oldest first
+    using Batch = std::vector<std::tuple<Arguments...>>;
+    using BatchCallbackFnType =
+        std::function<void(SubscriptionSetId,
+                           ReceiverType &,
+                           const typename Parent::EventType &,
+                           Batch)>;
+
    private:
     using SubscriptionsContainer =
         std::unordered_map<typename Parent::EventType,
@@ -75,6 +87,20 @@ namespace lean::se {
     /// Stored notification callback
     CallbackFnType on_notify_callback_;
 
+    /// Callback of `Coalescing::Accumulate` subscriptions
+    BatchCallbackFnType on_batch_callback_;
+
+    Coalescing coalescing_ = Coalescing::None;
+
+    /// Events of coalescing subscriptions waiting for delivery task
+    struct Pending {
+      Batch events;
+      bool scheduled = false;
+    };
+    std::mutex pending_cs_;
+    std::map<std::pair<SubscriptionSetId, typename Parent::EventType>, Pending>
+        pending_;
+
     template <typename... SubscriberConstructorArgs>
     SubscriberImpl(const SubscriptionEnginePtr &ptr,
                    SubscriberConstructorArgs &&...args)
@@ -102,6 +128,19 @@ namespace lean::se {
       on_notify_callback_ = std::move(f);
     }
 
+    /// Callback receiving all events merged by `Coalescing::Accumulate`
+    void setBatchCallback(BatchCallbackFnType &&f) {
+      on_batch_callback_ = std::move(f);
+    }
+
+    /**
+     * Merge events queued up while subscriber is busy, instead of delivering
+     * each separately. Must be set before subscribing.
+     */
+    void setCoalescing(Coalescing coalescing) {
+      coalescing_ = coalescing;
+    }
+
     SubscriptionSetId generateSubscriptionSetId() {
       return ++next_id_;
     }
@@ -117,8 +156,11 @@ namespace lean::se {
         /// Here we check first local subscriptions because of strong connection
         /// with SubscriptionEngine.
         if (inserted) {
-          it->second =
-              engine->subscribe(tid, id, key, Parent::weak_from_this());
+          it->second = engine->subscribe(tid,
+                                         id,
+                                         key,
+                                         Parent::weak_from_this(),
+                                         coalescing_ != Coalescing::None);
         }
       }
     }
@@ -188,6 +230,45 @@ namespace lean::se {
       }
     }
 
+    bool enqueue(SubscriptionSetId set_id,
+                 const typename Parent::EventType &key,
+                 const Arguments &...args) override {
+      std::lock_guard lock(pending_cs_);
+      auto &pending = pending_[{set_id, key}];
+      if (coalescing_ == Coalescing::LatestWins) {
+        pending.events.clear();
+      }
+      pending.events.emplace_back(args...);
+      return not std::exchange(pending.scheduled, true);
+    }
+
+    void deliver(SubscriptionSetId set_id,
+                 const typename Parent::EventType &key) override {
+      Batch events;
+      {
+        std::lock_guard lock(pending_cs_);
+        auto it = pending_.find({set_id, key});
+        if (it == pending_.end()) {
+          return;
+        }
+        // Events arriving from now on schedule next delivery
+        events = std::move(it->second.events);
+        pending_.erase(it);
+      }
+      if (events.empty()) {
+        return;
+      }
+      if (coalescing_ == Coalescing::Accumulate) {
+        if (nullptr != on_batch_callback_) {
+          on_batch_callback_(set_id, object_, key, std::move(events));
+        }
+        return;
+      }
+      std::apply(
+          [&](auto &...args) { on_notify(set_id, key, std::move(args)...); },
+          events.back());
+    }
+
     ReceiverType &get() {
       return object_;
     }
@@ -7,10 +7,12 @@
 #pragma once
 
 #include <assert.h>
+#include <atomic>
 #include <list>
 #include <memory>
-#include <shared_mutex>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include "common.hpp"
 #include "subscriber.hpp"
@@ -47,17 +49,22 @@ namespace lean::se {
     using DispatcherType = typename std::decay<Dispatcher>::type;
     using DispatcherPtr = std::shared_ptr<DispatcherType>;
 
+    /// Thread, subscription set, subscriber, whether events are coalesced
+    using SubscriberEntry = std::tuple<typename Dispatcher::Tid,
+                                       SubscriptionSetId,
+                                       SubscriberWeakPtr,
+                                       bool>;
+
     /// List is preferable here because this container iterators remain
     /// alive after removal from the middle of the container
     /// using custom allocator
-    using SubscribersContainer = std::list<std::tuple<typename Dispatcher::Tid,
-                                                      SubscriptionSetId,
-                                                      SubscriberWeakPtr>>;
+    using SubscribersContainer = std::list<SubscriberEntry>;
     using IteratorType = typename SubscribersContainer::iterator;
 
    public:
     explicit SubscriptionEngine(const DispatcherPtr &dispatcher)
-        : dispatcher_(dispatcher) {
+        : dispatcher_(dispatcher),
+          snapshot_(std::make_shared<const SnapshotMap>()) {
       assert(dispatcher_);
     }
     ~SubscriptionEngine() = default;
@@ -67,15 +74,15 @@ namespace lean::se {
     }
 
    private:
-    /// List of subscribers for a single event key
-    struct SubscriptionContext final {
-      std::mutex subscribers_list_cs;
-      SubscribersContainer subscribers_list;
-    };
+    /// Immutable copy of subscribers of single event key
+    using Snapshot = std::vector<SubscriberEntry>;
+    using SnapshotMap =
+        std::unordered_map<EventKeyType, std::shared_ptr<const Snapshot>>;
     using KeyValueContainer =
-        std::unordered_map<EventKeyType, SubscriptionContext>;
+        std::unordered_map<EventKeyType, SubscribersContainer>;
 
-    mutable std::shared_mutex subscribers_map_cs_;
+    /// Guards changes of subscribers, notification doesn't take it
+    mutable std::mutex subscribers_map_cs_;
 
     /// Associative container with lists of subscribers by the event key
     KeyValueContainer subscribers_map_;
@@ -83,6 +90,43 @@ namespace lean::se {
     /// Thread handlers dispatcher
     DispatcherPtr dispatcher_;
 
+    /// Subscribers by event key as of last change, replaced as whole
+    /// (RCU-style) on subscribe and unsubscribe, so notifications just load
+    /// pointer and iterate it
+    std::atomic<std::shared_ptr<const SnapshotMap>> snapshot_;
+
+    /// Publish subscribers of `key`, called under `subscribers_map_cs_`
+    void publish(const EventKeyType &key) {
+      auto snapshot = std::make_shared<SnapshotMap>(
+          *snapshot_.load(std::memory_order_relaxed));
+      if (auto it = subscribers_map_.find(key); it != subscribers_map_.end()) {
+        (*snapshot)[key] = std::make_shared<const Snapshot>(it->second.begin(),
+                                                            it->second.end());
+      } else {
+        snapshot->erase(key);
+      }
+      snapshot_.store(std::move(snapshot), std::memory_order_release);
+    }
+
+    /// Drop expired subscribers of `key`, if no change is in progress
+    void pruneExpired(const EventKeyType &key) {
+      std::unique_lock lock(subscribers_map_cs_, std::try_to_lock);
+      if (not lock.owns_lock()) {
+        return;
+      }
+      auto it = subscribers_map_.find(key);
+      if (subscribers_map_.end() == it) {
+        return;
+      }
+      std::erase_if(it->second, [](const SubscriberEntry &entry) {
+        return std::get<2>(entry).expired();
+      });
+      if (it->second.empty()) {
+        subscribers_map_.erase(it);
+      }
+      publish(key);
+    }
+
    public:
     /**
      * Stores Subscriber object to retrieve later notifications
@@ -91,6 +135,8 @@ namespace lean::se {
      * subscriptions
      * @param key notification event key that this subscriber will listen to
      * @param ptr subscriber weak pointer
+     * @param coalesce whether events are merged by subscriber until delivery
+     * task runs, see `Subscriber::enqueue`
      * @return a position in an internal container with subscribers(!!! it must
      * be kept valid in case the other subscriber will be deleted from this
      * container)
@@ -98,14 +144,15 @@ namespace lean::se {
     IteratorType subscribe(typename Dispatcher::Tid tid,
                            SubscriptionSetId set_id,
                            const EventKeyType &key,
-                           SubscriberWeakPtr ptr) {
-      std::unique_lock lock(subscribers_map_cs_);
-      auto &subscribers_context = subscribers_map_[key];
-
-      std::lock_guard l(subscribers_context.subscribers_list_cs);
-      return subscribers_context.subscribers_list.emplace(
-          subscribers_context.subscribers_list.end(),
-          std::make_tuple(tid, set_id, std::move(ptr)));
+                           SubscriberWeakPtr ptr,
+                           bool coalesce = false) {
+      std::lock_guard lock(subscribers_map_cs_);
+      auto &subscribers_list = subscribers_map_[key];
+      auto it = subscribers_list.emplace(
+          subscribers_list.end(),
+          std::make_tuple(tid, set_id, std::move(ptr), coalesce));
+      publish(key);
+      return it;
     }
 
     /**
@@ -114,15 +161,14 @@ namespace lean::se {
      * @param it_remove iterator to the subscribers position
      */
     void unsubscribe(const EventKeyType &key, const IteratorType &it_remove) {
-      std::unique_lock lock(subscribers_map_cs_);
+      std::lock_guard lock(subscribers_map_cs_);
       auto it = subscribers_map_.find(key);
       if (subscribers_map_.end() != it) {
-        auto &subscribers_context = it->second;
-        std::lock_guard l(subscribers_context.subscribers_list_cs);
-        subscribers_context.subscribers_list.erase(it_remove);
-        if (subscribers_context.subscribers_list.empty()) {
+        it->second.erase(it_remove);
+        if (it->second.empty()) {
           subscribers_map_.erase(it);
         }
+        publish(key);
       }
     }
 
@@ -132,11 +178,9 @@ namespace lean::se {
      * @return number of subscribers
      */
     size_t size(const EventKeyType &key) const {
-      std::shared_lock lock(subscribers_map_cs_);
-      if (auto it = subscribers_map_.find(key); it != subscribers_map_.end()) {
-        auto &subscribers_context = it->second;
-        std::lock_guard l(subscribers_context.subscribers_list_cs);
-        return subscribers_context.subscribers_list.size();
+      auto snapshot = snapshot_.load(std::memory_order_acquire);
+      if (auto it = snapshot->find(key); it != snapshot->end()) {
+        return it->second->size();
       }
       return 0ull;
     }
@@ -146,12 +190,10 @@ namespace lean::se {
      * @return number of subscribers
      */
     size_t size() const {
-      std::shared_lock lock(subscribers_map_cs_);
+      auto snapshot = snapshot_.load(std::memory_order_acquire);
       size_t count = 0ull;
-      for (auto &it : subscribers_map_) {
-        auto &subscribers_context = it->second;
-        std::lock_guard l(subscribers_context.subscribers_list_cs);
-        count += subscribers_context.subscribers_list.size();
+      for (auto &it : *snapshot) {
+        count += it.second->size();
       }
       return count;
     }
@@ -168,7 +210,8 @@ namespace lean::se {
     }
 
     /**
-     * Notify the event subscribers after a specified delay
+     * Notify the event subscribers after a specified delay.
+     * Takes no locks, subscribers are read from last published snapshot.
      * @tparam EventParams notification event type
      * @param timeout delay before subscribers will be notified
      * @param key notification event to be executed
@@ -183,39 +226,51 @@ namespace lean::se {
         return;
       }
 
-      std::shared_lock lock(subscribers_map_cs_);
-      auto it = subscribers_map_.find(key);
-      if (subscribers_map_.end() == it) {
+      auto snapshot = snapshot_.load(std::memory_order_acquire);
+      auto it = snapshot->find(key);
+      if (snapshot->end() == it) {
         return;
       }
 
-      auto &subscribers_container = it->second;
-      std::lock_guard l(subscribers_container.subscribers_list_cs);
-      for (auto it_sub = subscribers_container.subscribers_list.begin();
-           it_sub != subscribers_container.subscribers_list.end();) {
-        auto wsub = std::get<2>(*it_sub);
-        auto id = std::get<1>(*it_sub);
-
-        if (!wsub.expired()) {
-          dispatcher->addDelayed(std::get<0>(*it_sub),
-                                 timeout,
-                                 [wsub(std::move(wsub)),
-                                  id(id),
-                                  key(key),
-                                  args = std::make_tuple(args...)]() mutable {
-                                   if (auto sub = wsub.lock()) {
-                                     std::apply(
-                                         [&](auto &&...args) {
-                                           sub->on_notify(
-                                               id, key, std::move(args)...);
-                                         },
-                                         std::move(args));
-                                   }
-                                 });
-          ++it_sub;
-        } else {
-          it_sub = subscribers_container.subscribers_list.erase(it_sub);
+      bool has_expired = false;
+      for (auto &[tid, id, wsub, coalesce] : *it->second) {
+        if (coalesce) {
+          // Delivery task already queued picks this event up
+          auto sub = wsub.lock();
+          if (not sub) {
+            has_expired = true;
+          } else if (sub->enqueue(id, key, args...)) {
+            dispatcher->addDelayed(
+                tid, timeout, [wsub(wsub), id(id), key(key)] {
+                  if (auto sub = wsub.lock()) {
+                    sub->deliver(id, key);
+                  }
+                });
+          }
+          continue;
         }
+        if (wsub.expired()) {
+          has_expired = true;
+          continue;
+        }
+        dispatcher->addDelayed(tid,
+                               timeout,
+                               [wsub(wsub),
+                                id(id),
+                                key(key),
+                                args = std::make_tuple(args...)]() mutable {
+                                 if (auto sub = wsub.lock()) {
+                                   std::apply(
+                                       [&](auto &&...args) {
+                                         sub->on_notify(
+                                             id, key, std::move(args)...);
+                                       },
+                                       std::move(args));
+                                 }
+                               });
+      }
+      if (has_expired) {
+        pruneExpired(key);
       }
     }
   };
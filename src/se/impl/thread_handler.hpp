@@ -10,9 +10,9 @@
 #include <thread>
 
 #include <fmt/format.h>
-#include <soralog/util.hpp>
 
 #include "scheduler_impl.hpp"
+#include "utils/thread_placement.hpp"
 
 namespace lean::se {
 
@@ -26,7 +26,7 @@ namespace lean::se {
           [](ThreadHandler *__this) {
             static std::atomic_size_t counter = 0;
             auto tname = fmt::format("worker.{}", ++counter);
-            soralog::util::setThreadName(tname);
+            setThreadName(tname);
             return __this->process();
           },
           this);
@@ -105,6 +105,64 @@ namespace lean::se {
       return create(
           se, tid, key, std::forward<F>(callback), std::forward<Args>(args)...);
     }
+
+    /**
+     * @brief Like `create`, but events queued up while callback is busy or
+     * not scheduled yet are dropped except latest one.
+     *
+     * For state updates where only latest value matters, e.g. new best leaf
+     * during catch-up.
+     */
+    template <EventTypes key, typename F, typename... Args>
+    static auto createLatestWins(Subscription &se,
+                                 SubscriptionEngineHandlers tid,
+                                 F &&callback,
+                                 Args &&...args) {
+      auto subscriber = BaseSubscriber<ContextType, EventData...>::create(
+          se.getEngine<EventTypes, EventData...>(),
+          std::forward<Args>(args)...);
+      subscriber->setCallback(
+          [f{std::forward<F>(callback)}](auto /*set_id*/,
+                                         auto &context,
+                                         auto event_key,
+                                         EventData... args) mutable {
+            assert(key == event_key);
+            std::forward<F>(f)(context, std::move(args)...);
+          });
+      subscriber->setCoalescing(se::Coalescing::LatestWins);
+      subscriber->subscribe(0, key, static_cast<Dispatcher::Tid>(tid));
+      return subscriber;
+    }
+
+    /**
+     * @brief Like `create`, but events queued up while callback is busy or
+     * not scheduled yet are delivered at once.
+     *
+     * The callback must be invocable with arguments:
+     * (ContextType&, std::vector<std::tuple<EventData...>>).
+     */
+    template <EventTypes key, typename F, typename... Args>
+    static auto createAccumulating(Subscription &se,
+                                   SubscriptionEngineHandlers tid,
+                                   F &&callback,
+                                   Args &&...args) {
+      using SubscriberType = BaseSubscriber<ContextType, EventData...>;
+      auto subscriber = SubscriberType::create(
+          se.getEngine<EventTypes, EventData...>(),
+          std::forward<Args>(args)...);
+      subscriber->setBatchCallback(
+          [f{std::forward<F>(callback)}](auto /*set_id*/,
+                                         auto &context,
+                                         auto event_key,
+                                         typename SubscriberType::Batch
+                                             events) mutable {
+            assert(key == event_key);
+            std::forward<F>(f)(context, std::move(events));
+          });
+      subscriber->setCoalescing(se::Coalescing::Accumulate);
+      subscriber->subscribe(0, key, static_cast<Dispatcher::Tid>(tid));
+      return subscriber;
+    }
   };
 }  // namespace lean::se
 
@@ -337,6 +337,12 @@ namespace lean::enr {
 
   inline void encodeContent(rlp::Encoder &rlp, const Enr &enr) {
     rlp.uint(enr.sequence);
+    if (enr.attnets.has_value()) {
+      rlp.str("attnets");
+      qtils::ByteArr<sizeof(Attnets)> attnets;
+      boost::endian::store_little_u64(attnets.data(), *enr.attnets);
+      rlp.bytes(attnets);
+    }
     rlp.str("id");
     rlp.str("v4");
     rlp.str("ip");
@@ -406,6 +412,13 @@ namespace lean::enr {
                         kv_is_aggregator->second.readBool());
     }
 
+    auto kv_attnets = kv.find("attnets");
+    if (kv_attnets != kv.end()) {
+      BOOST_OUTCOME_TRY(auto attnets,
+                        kv_attnets->second.bytes_n<sizeof(Attnets)>());
+      enr.attnets = boost::endian::load_little_u64(attnets.data());
+    }
+
     libp2p::crypto::secp256k1::Secp256k1ProviderImpl secp256k1{nullptr};
     BOOST_OUTCOME_TRY(
         auto valid_signature,
@@ -421,7 +434,8 @@ namespace lean::enr {
   outcome::result<std::string> encode(const libp2p::crypto::KeyPair &keypair,
                                       Ip ip,
                                       Port port,
-                                      std::optional<bool> is_aggregator) {
+                                      std::optional<bool> is_aggregator,
+                                      std::optional<Attnets> attnets) {
     if (keypair.privateKey.type != libp2p::crypto::Key::Type::Secp256k1) {
       return Error::EXPECTED_SECP256K1_KEYPAIR;
     }
@@ -439,6 +453,7 @@ namespace lean::enr {
         .ip = ip,
         .port = port,
         .is_aggregator_optional = is_aggregator,
+        .attnets = attnets,
     };
 
     libp2p::crypto::secp256k1::Secp256k1ProviderImpl secp256k1{nullptr};
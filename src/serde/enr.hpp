@@ -23,6 +23,8 @@ namespace lean::enr {
   using Secp256k1PublicKey = qtils::ByteArr<33>;
   using Ip = qtils::ByteArr<4>;
   using Port = uint16_t;
+  /// Bit per attestation subnet, as SSZ `Bitvector[64]` of `attnets`
+  using Attnets = uint64_t;
 
   Ip makeIp(uint32_t i);
   Ip makeIp(std::string_view base, uint32_t i);
@@ -35,6 +37,8 @@ namespace lean::enr {
     std::optional<Ip> ip;
     std::optional<Port> port;
     std::optional<bool> is_aggregator_optional;
+    /// Attestation subnets node subscribes to
+    std::optional<Attnets> attnets;
 
     libp2p::PeerId peerId() const;
     libp2p::Multiaddress listenAddress() const;
@@ -50,5 +54,6 @@ namespace lean::enr {
   outcome::result<std::string> encode(const libp2p::crypto::KeyPair &keypair,
                                       Ip ip,
                                       Port port,
-                                      std::optional<bool> is_aggregator);
+                                      std::optional<bool> is_aggregator,
+                                      std::optional<Attnets> attnets = {});
 }  // namespace lean::enr
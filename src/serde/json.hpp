@@ -18,6 +18,7 @@
 #include <sszpp/lists.hpp>
 
 #include "serde/json_fwd.hpp"
+#include "serde/json_writer.hpp"
 
 #define JSON_ASSERT(c) \
   if (not(c)) json.error()
@@ -55,7 +56,15 @@ namespace lean::json {
     std::vector<std::string> keys;
   };
 
+  /// Json text of `v`, streamed without intermediate document
   std::string encode(NameCase name_case, const auto &v) {
+    std::string out;
+    encodeInto(name_case, v, out);
+    return out;
+  }
+
+  /// Json text of `v` built through rapidjson document
+  std::string encodeDocument(NameCase name_case, const auto &v) {
     rapidjson::Document document;
     encode(JsonOut{name_case, document, document.GetAllocator()}, v);
     rapidjson::StringBuffer stream;
@@ -91,7 +100,7 @@ namespace lean::json {
 
   template <size_t N>
   void encode(JsonOut json, const qtils::ByteArr<N> &v) {
-    encode(json, fmt::format("{:0xx}", qtils::Hex{v}));
+    encode(json, hex0x(v));
   }
 
   template <size_t I, typename T>
@@ -162,7 +171,7 @@ namespace lean::json {
 
   template <size_t N>
   void decode(JsonIn json, qtils::ByteArr<N> &v) {
-    v = qtils::ByteArr<N>::fromHexWithPrefix(decodeStr(json)).value();
+    JSON_ASSERT(hexDecode(decodeStr(json), v));
   }
 
   template <typename T>
@@ -0,0 +1,150 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <concepts>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <qtils/byte_arr.hpp>
+
+#include "serde/json_fwd.hpp"
+#include "utils/hex.hpp"
+
+namespace lean::json {
+  /**
+   * Streaming json output driven by `JSON_FIELDS`.
+   * Appends text to `out` without building document, output matches
+   * compact rapidjson writer.
+   */
+  struct JsonWriter {
+    NameCase name_case;
+    std::string &out;
+  };
+
+  /// Append "0x" and hex of `bytes`
+  inline void writeHex(std::string &out, std::span<const uint8_t> bytes) {
+    auto offset = out.size();
+    out.resize(offset + 2 + 2 * bytes.size());
+    out[offset] = '0';
+    out[offset + 1] = 'x';
+    hexEncode(bytes, out.data() + offset + 2);
+  }
+
+  template <std::integral T>
+  void write(JsonWriter json, const T &v) {
+    if constexpr (std::is_same_v<T, bool>) {
+      json.out.append(v ? "true" : "false");
+    } else {
+      std::array<char, std::numeric_limits<T>::digits10 + 3> buffer;
+      auto end = std::to_chars(buffer.begin(), buffer.end(), v).ptr;
+      json.out.append(buffer.data(), end);
+    }
+  }
+
+  inline void write(JsonWriter json, std::string_view v) {
+    auto &out = json.out;
+    out.reserve(out.size() + v.size() + 2);
+    out.push_back('"');
+    // Copy runs of characters which need no escape at once
+    size_t run = 0;
+    for (size_t i = 0; i < v.size(); ++i) {
+      auto c = static_cast<unsigned char>(v[i]);
+      if (c >= 0x20 and c != '"' and c != '\\') {
+        continue;
+      }
+      out.append(v.substr(run, i - run));
+      run = i + 1;
+      out.push_back('\\');
+      switch (c) {
+        case '"':
+        case '\\':
+          out.push_back(static_cast<char>(c));
+          break;
+        case '\b':
+          out.push_back('b');
+          break;
+        case '\f':
+          out.push_back('f');
+          break;
+        case '\n':
+          out.push_back('n');
+          break;
+        case '\r':
+          out.push_back('r');
+          break;
+        case '\t':
+          out.push_back('t');
+          break;
+        default:
+          out.append("u00");
+          out.append(&hex_detail::kPairs[2 * c], 2);
+      }
+    }
+    out.append(v.substr(run));
+    out.push_back('"');
+  }
+
+  inline void write(JsonWriter json, const std::string &v) {
+    write(json, std::string_view{v});
+  }
+
+  template <typename T>
+  void write(JsonWriter json, const std::vector<T> &v) {
+    json.out.push_back('[');
+    for (size_t i = 0; i < v.size(); ++i) {
+      if (i != 0) {
+        json.out.push_back(',');
+      }
+      write(json, v[i]);
+    }
+    json.out.push_back(']');
+  }
+
+  template <size_t N>
+  void write(JsonWriter json, const qtils::ByteArr<N> &v) {
+    json.out.push_back('"');
+    writeHex(json.out, v);
+    json.out.push_back('"');
+  }
+
+  template <size_t I, typename T>
+  void writeFields(JsonWriter json, const T &fields, const auto &field_names) {
+    if constexpr (I != 0) {
+      json.out.push_back(',');
+    }
+    write(json, std::string_view{field_names.at(I)[json.name_case]});
+    json.out.push_back(':');
+    write(json, std::get<I>(fields));
+    if constexpr (I + 1 < std::tuple_size_v<T>) {
+      writeFields<I + 1>(json, fields, field_names);
+    }
+  }
+
+  template <typename T>
+    requires requires(const T &v) {
+      v.fieldNames();
+      v.fields();
+    }
+  void write(JsonWriter json, const T &v) {
+    json.out.push_back('{');
+    writeFields<0>(json, v.fields(), v.fieldNames());
+    json.out.push_back('}');
+  }
+
+  /// Append json of `v` to `out`, reusing its capacity
+  void encodeInto(NameCase name_case, const auto &v, std::string &out) {
+    write(JsonWriter{name_case, out}, v);
+  }
+}  // namespace lean::json
@@ -0,0 +1,123 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "serde/merkle_cache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <utility>
+
+#include "crypto/sha/sha256.hpp"
+#include "serde/parallel_hash.hpp"
+
+namespace lean {
+  static_assert(sizeof(MerkleCache::Chunk) == sizeof(Hash256));
+
+  MerkleCache::Chunk MerkleCache::root() {
+    if (layers_[0].empty()) {
+      dirty_.clear();
+      return cachedRoot();
+    }
+    std::ranges::sort(dirty_);
+    auto unique = std::ranges::unique(dirty_);
+    dirty_.erase(unique.begin(), unique.end());
+
+    std::vector<size_t> parents;
+    // Runs of full pairs as first parent and number of parents
+    std::vector<std::pair<size_t, size_t>> runs;
+    for (size_t height = 0; height + 1 < layers_.size(); ++height) {
+      auto &layer = layers_[height];
+      auto &parent_layer = layers_[height + 1];
+      parent_layer.resize((layer.size() + 1) / 2);
+      parents.clear();
+      for (auto i : dirty_) {
+        auto parent = i / 2;
+        if (parents.empty() or parents.back() != parent) {
+          parents.emplace_back(parent);
+        }
+      }
+      // Children of consecutive parents are consecutive, so each run of
+      // parents is hashed by one multi-buffer call
+      runs.clear();
+      size_t pairs = 0;
+      for (size_t begin = 0; begin < parents.size();) {
+        auto end = begin + 1;
+        while (end < parents.size() and parents[end] == parents[end - 1] + 1) {
+          ++end;
+        }
+        auto first = parents[begin];
+        auto count = end - begin;
+        // Last parent of odd layer has no right child
+        auto full = first < layer.size() / 2
+                      ? std::min(count, layer.size() / 2 - first)
+                      : 0;
+        for (size_t offset = 0; offset < full; offset += kParallelPairs) {
+          runs.emplace_back(first + offset,
+                            std::min(kParallelPairs, full - offset));
+        }
+        pairs += full;
+        if (full != count) {
+          auto parent = first + full;
+          parent_layer[parent] = hash(layer[2 * parent], zeroHash(height));
+        }
+        begin = end;
+      }
+      auto hash_run = [&](size_t i) {
+        auto [first, count] = runs[i];
+        crypto::sha256Pairs(
+            std::span{parent_layer}.subspan(first, count),
+            {layer[2 * first].data(), 2 * sizeof(Chunk) * count});
+      };
+      if (pairs < 2 * kParallelPairs) {
+        for (size_t i = 0; i < runs.size(); ++i) {
+          hash_run(i);
+        }
+      } else {
+        parallelHash(runs.size(), hash_run);
+      }
+      std::swap(dirty_, parents);
+    }
+    dirty_.clear();
+    return cachedRoot();
+  }
+
+  const MerkleCache::Chunk &MerkleCache::cachedRoot() const {
+    BOOST_ASSERT(dirty_.empty());
+    if (layers_[0].empty()) {
+      return zeroHash(layers_.size() - 1);
+    }
+    return layers_.back()[0];
+  }
+
+  MerkleCache::Chunk MerkleCache::hash(const Chunk &left,
+                                       const Chunk &right) {
+    std::array<uint8_t, 2 * sizeof(Chunk)> pair;
+    std::ranges::copy(left, pair.begin());
+    std::ranges::copy(right, pair.begin() + sizeof(Chunk));
+    return crypto::sha256(pair);
+  }
+
+  MerkleCache::Chunk MerkleCache::mixInLength(const Chunk &root,
+                                              uint64_t length) {
+    Chunk chunk{};
+    for (size_t i = 0; i < sizeof(length); ++i) {
+      chunk[i] = static_cast<uint8_t>(length >> (8 * i));
+    }
+    return hash(root, chunk);
+  }
+
+  const MerkleCache::Chunk &MerkleCache::zeroHash(size_t height) {
+    static const auto zero_hashes = [] {
+      std::array<Chunk, 65> zero_hashes{};
+      for (size_t i = 1; i < zero_hashes.size(); ++i) {
+        zero_hashes[i] = hash(zero_hashes[i - 1], zero_hashes[i - 1]);
+      }
+      return zero_hashes;
+    }();
+    return zero_hashes.at(height);
+  }
+}  // namespace lean
@@ -0,0 +1,102 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <qtils/byte_arr.hpp>
+
+namespace lean {
+  /**
+   * Incremental merkle tree of fixed depth, as used by SSZ `merkleize` with
+   * limit.
+   *
+   * All inner nodes are kept, leaves after `size()` are zero chunks.
+   * Changing leaves marks them dirty, so `root` rehashes only paths from
+   * changed leaves instead of whole tree.
+   */
+  class MerkleCache {
+   public:
+    using Chunk = qtils::ByteArr<32>;
+
+    /**
+     * Pairs hashed by one parallel task.
+     * Layers with fewer than twice as many dirty pairs are hashed serially.
+     */
+    static constexpr size_t kParallelPairs = 4096;
+
+    /// Depth of tree for `chunk_limit` leaves
+    static constexpr size_t depthFor(uint64_t chunk_limit) {
+      return std::bit_width(chunk_limit - 1);
+    }
+
+    explicit MerkleCache(size_t depth) : layers_(depth + 1) {}
+
+    size_t size() const {
+      return layers_[0].size();
+    }
+
+    /// Set number of leaves, new leaves are zero chunks
+    void resize(size_t size) {
+      auto &leaves = layers_[0];
+      BOOST_ASSERT(size <= (uint64_t{1} << (layers_.size() - 1)));
+      if (size < leaves.size()) {
+        std::erase_if(dirty_, [&](size_t i) { return i >= size; });
+        if (size != 0) {
+          // Right sibling of last leaf becomes zero chunk
+          dirty_.emplace_back(size - 1);
+        }
+      } else {
+        for (auto i = leaves.size(); i < size; ++i) {
+          dirty_.emplace_back(i);
+        }
+      }
+      leaves.resize(size);
+    }
+
+    /// Set leaf value, leaf path is rehashed only if value has changed
+    void set(size_t index, const Chunk &leaf) {
+      auto &current = layers_[0].at(index);
+      if (current != leaf) {
+        current = leaf;
+        dirty_.emplace_back(index);
+      }
+    }
+
+    const Chunk &leaf(size_t index) const {
+      return layers_[0].at(index);
+    }
+
+    /// Some leaves have changed since last `root` call
+    bool dirty() const {
+      return not dirty_.empty();
+    }
+
+    /// Rehash dirty paths and return root
+    Chunk root();
+
+    /// Root computed by last `root` call, tree must not be dirty
+    const Chunk &cachedRoot() const;
+
+    static Chunk hash(const Chunk &left, const Chunk &right);
+
+    /// SSZ `mix_in_length`
+    static Chunk mixInLength(const Chunk &root, uint64_t length);
+
+    /// Root of subtree with zero leaves at given height
+    static const Chunk &zeroHash(size_t height);
+
+   private:
+    /// `layers_[0]` are leaves, `layers_[depth]` is root
+    std::vector<std::vector<Chunk>> layers_;
+    /// Indices of changed leaves
+    std::vector<size_t> dirty_;
+  };
+}  // namespace lean
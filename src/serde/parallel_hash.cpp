@@ -0,0 +1,40 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "serde/parallel_hash.hpp"
+
+#include <atomic>
+#include <latch>
+
+#include "utils/worker_pool.hpp"
+
+namespace lean {
+  namespace {
+    std::atomic<std::weak_ptr<WorkerPool>> hash_worker_pool;
+  }  // namespace
+
+  void setHashWorkerPool(std::weak_ptr<WorkerPool> worker_pool) {
+    hash_worker_pool.store(std::move(worker_pool));
+  }
+
+  void parallelHash(size_t count, const std::function<void(size_t)> &f) {
+    auto pool = count > 1 ? hash_worker_pool.load().lock() : nullptr;
+    if (not pool) {
+      for (size_t i = 0; i < count; ++i) {
+        f(i);
+      }
+      return;
+    }
+    std::latch done{static_cast<std::ptrdiff_t>(count)};
+    for (size_t i = 0; i < count; ++i) {
+      pool->post([&, i] {
+        f(i);
+        done.count_down();
+      });
+    }
+    pool->wait(done);
+  }
+}  // namespace lean
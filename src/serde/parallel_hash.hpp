@@ -0,0 +1,30 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace lean {
+  class WorkerPool;
+
+  /**
+   * Install process-wide worker pool for merkleization of large lists.
+   * Roots are computed by free functions deep inside state transition, so
+   * pool is installed once at startup instead of being passed through.
+   * Pool is not owned, hashing is serial without it.
+   */
+  void setHashWorkerPool(std::weak_ptr<WorkerPool> worker_pool);
+
+  /**
+   * Call `f(i)` for each `i` in `[0, count)`.
+   * Calls are spread over hash worker pool if it is installed, otherwise
+   * they run on caller thread.
+   */
+  void parallelHash(size_t count, const std::function<void(size_t)> &f);
+}  // namespace lean
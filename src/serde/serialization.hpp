@@ -6,7 +6,10 @@
 
 #pragma once
 
+#include <bit>
+#include <cstring>
 #include <system_error>
+#include <type_traits>
 
 #include <qtils/byte_vec.hpp>
 #include <qtils/bytes.hpp>
@@ -26,18 +29,48 @@ namespace lean {
     abort();
   }
 
+  /**
+   * Fixed-size container opted in by `using ssz_packed = std::true_type`,
+   * whose memory layout is its ssz encoding, so it is encoded and decoded
+   * by single copy.
+   * Layout is verified at compile time: fields must be little-endian
+   * integers, byte arrays or such containers, without padding. `bool`
+   * fields are not allowed, as decoding wouldn't validate them.
+   */
+  template <typename T>
+  concept SszPacked = T::ssz_packed::value and std::is_trivially_copyable_v<T>
+                  and std::endian::native == std::endian::little
+                  and sizeof(T) == T{}.ssz_size();
+
+  /// Encode into `out`, reusing its capacity
+  template <typename T>
+  void encodeInto(const T &v, qtils::ByteVec &out) {
+    if constexpr (SszPacked<T>) {
+      out.resize(sizeof(T));
+      std::memcpy(out.data(), &v, sizeof(T));
+      return;
+    }
+    out.resize(ssz::size(v));
+    ssz::serialize(reinterpret_cast<std::byte *>(out.data()), v);
+  }
+
   template <typename T>
   outcome::result<qtils::ByteVec> encode(const T &v) {
-    auto b = ssz::serialize(v);  // std::vector<std::byte>
-    qtils::ByteVec out(b.size());
-    std::transform(b.begin(), b.end(), out.begin(), [](std::byte x) {
-      return std::to_integer<uint8_t>(x);
-    });
+    qtils::ByteVec out;
+    encodeInto(v, out);
     return out;
   }
 
   template <typename T>
   outcome::result<T> decode(qtils::BytesIn data) {
+    if constexpr (SszPacked<T>) {
+      if (data.size() != sizeof(T)) {
+        return outcome::failure(SszError::DecodeError);
+      }
+      T v;
+      std::memcpy(&v, data.data(), sizeof(T));
+      return v;
+    }
     try {
       return ssz::deserialize<T>(
           reinterpret_cast<std::span<std::byte> &>(data));
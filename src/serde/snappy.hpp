@@ -49,6 +49,35 @@ namespace lean::snappy {
   constexpr auto kMaxBlockSize = size_t{1} << 16;
   constexpr auto kDefaultMaxSize = size_t{4} << 20;
 
+  /**
+   * Upper bound of uncompressed size of `compressed_size` bytes.
+   * Each snappy element expands at most 3 bytes of copy into 64 bytes, so
+   * larger declared length is rejected before buffer is allocated.
+   */
+  constexpr size_t maxUncompressedLength(size_t compressed_size) {
+    return compressed_size * 64 / 3;
+  }
+
+  /**
+   * Check declared uncompressed length against `max_size` and
+   * `compressed` size, without uncompressing.
+   */
+  inline outcome::result<size_t> uncompressedLength(qtils::BytesIn compressed,
+                                                    size_t max_size) {
+    size_t size = 0;
+    if (not ::snappy::GetUncompressedLength(
+            qtils::byte2str(compressed.data()), compressed.size(), &size)) {
+      return SnappyError::UNCOMPRESS_INVALID;
+    }
+    if (size > max_size) {
+      return SnappyError::UNCOMPRESS_TOO_LONG;
+    }
+    if (size > maxUncompressedLength(compressed.size())) {
+      return SnappyError::UNCOMPRESS_INVALID;
+    }
+    return size;
+  }
+
   constexpr qtils::ByteArr<6> kStreamIdentifier{'s', 'N', 'a', 'P', 'p', 'Y'};
 
   enum ChunkType : uint8_t {
@@ -58,30 +87,47 @@ namespace lean::snappy {
     Padding = 0xFE,
   };
 
+  /// Append compressed `input` to `out`, without intermediate buffer
+  inline void compressAppend(qtils::BytesIn input, qtils::ByteVec &out) {
+    auto offset = out.size();
+    out.resize(offset + ::snappy::MaxCompressedLength(input.size()));
+    size_t size = 0;
+    ::snappy::RawCompress(qtils::byte2str(input.data()),
+                          input.size(),
+                          reinterpret_cast<char *>(out.data() + offset),
+                          &size);
+    out.resize(offset + size);
+  }
+
   inline qtils::ByteVec compress(qtils::BytesIn input) {
-    std::string compressed;
-    ::snappy::Compress(
-        qtils::byte2str(input.data()), input.size(), &compressed);
-    return qtils::ByteVec{qtils::str2byte(std::as_const(compressed))};
+    qtils::ByteVec compressed;
+    compressAppend(input, compressed);
+    return compressed;
   }
 
-  inline outcome::result<qtils::ByteVec> uncompress(
-      qtils::BytesIn compressed, size_t max_size = kDefaultMaxSize) {
-    size_t size = 0;
-    if (not ::snappy::GetUncompressedLength(
-            qtils::byte2str(compressed.data()), compressed.size(), &size)) {
-      return SnappyError::UNCOMPRESS_INVALID;
-    }
-    if (size > max_size) {
-      return SnappyError::UNCOMPRESS_TOO_LONG;
-    }
-    std::string uncompressed;
-    if (not ::snappy::Uncompress(qtils::byte2str(compressed.data()),
-                                 compressed.size(),
-                                 &uncompressed)) {
+  /**
+   * Uncompress into `out`, reusing its capacity.
+   * `out` is unspecified on failure.
+   */
+  inline outcome::result<void> uncompressInto(
+      qtils::BytesIn compressed,
+      qtils::ByteVec &out,
+      size_t max_size = kDefaultMaxSize) {
+    BOOST_OUTCOME_TRY(auto size, uncompressedLength(compressed, max_size));
+    out.resize(size);
+    if (not ::snappy::RawUncompress(qtils::byte2str(compressed.data()),
+                                    compressed.size(),
+                                    reinterpret_cast<char *>(out.data()))) {
       return SnappyError::UNCOMPRESS_INVALID;
     }
-    return qtils::ByteVec{qtils::str2byte(std::as_const(uncompressed))};
+    return outcome::success();
+  }
+
+  inline outcome::result<qtils::ByteVec> uncompress(
+      qtils::BytesIn compressed, size_t max_size = kDefaultMaxSize) {
+    qtils::ByteVec uncompressed;
+    BOOST_OUTCOME_TRY(uncompressInto(compressed, uncompressed, max_size));
+    return uncompressed;
   }
 
   using Crc32 = qtils::ByteArr<4>;
@@ -93,28 +139,58 @@ namespace lean::snappy {
     return crc;
   }
 
+  /// Upper bound of `compressFramed` output size
+  inline size_t maxCompressedFramedLength(size_t size) {
+    auto chunks = (size + kMaxBlockSize - 1) / kMaxBlockSize;
+    return kHeaderSize + kStreamIdentifier.size()
+         + chunks * (kHeaderSize + Crc32::size())
+         + ::snappy::MaxCompressedLength(size);
+  }
+
+  inline void appendFrameHeader(qtils::ByteVec &out,
+                                ChunkType type,
+                                size_t size) {
+    out.putUint8(type);
+    qtils::ByteArr<3> size_bytes;
+    boost::endian::store_little_u24(size_bytes.data(), size);
+    out.put(size_bytes);
+  }
+
+  inline void appendStreamIdentifier(qtils::ByteVec &out) {
+    appendFrameHeader(out, ChunkType::Stream, kStreamIdentifier.size());
+    out.put(kStreamIdentifier);
+  }
+
+  /// Append frame of `chunk` not longer than `kMaxBlockSize` to `out`
+  inline void appendCompressedFrame(qtils::BytesIn chunk,
+                                    qtils::ByteVec &out) {
+    auto crc = hashCrc32(chunk);
+    // Chunk is compressed in place, header size is patched after
+    auto header = out.size();
+    appendFrameHeader(out, ChunkType::Compressed, 0);
+    out.put(crc);
+    compressAppend(chunk, out);
+    boost::endian::store_little_u24(out.data() + header + 1,
+                                    out.size() - header - kHeaderSize);
+  }
+
   inline qtils::ByteVec compressFramed(qtils::BytesIn input) {
     qtils::ByteVec framed;
-    auto write_header = [&](ChunkType type, size_t size) {
-      framed.putUint8(type);
-      qtils::ByteArr<3> size_bytes;
-      boost::endian::store_little_u24(size_bytes.data(), size);
-      framed.put(size_bytes);
-    };
-    write_header(ChunkType::Stream, kStreamIdentifier.size());
-    framed.put(kStreamIdentifier);
+    framed.reserve(maxCompressedFramedLength(input.size()));
+    appendStreamIdentifier(framed);
     while (not input.empty()) {
       auto chunk = input.first(std::min(input.size(), kMaxBlockSize));
-      auto crc = hashCrc32(chunk);
       input = input.subspan(chunk.size());
-      auto compressed = compress(chunk);
-      write_header(ChunkType::Compressed, Crc32::size() + compressed.size());
-      framed.put(crc);
-      framed.put(compressed);
+      appendCompressedFrame(chunk, framed);
     }
     return framed;
   }
 
+  /// Largest frame content, of compressed `kMaxBlockSize` chunk
+  inline size_t maxFrameContentSize() {
+    return Crc32::size() + ::snappy::MaxCompressedLength(kMaxBlockSize);
+  }
+
   inline std::optional<size_t> chunkNeedBytes(qtils::BytesIn input) {
     if (input.size() < kHeaderSize) {
       return std::nullopt;
@@ -122,6 +198,55 @@ namespace lean::snappy {
     return kHeaderSize + boost::endian::load_little_u24(input.data() + 1);
   }
 
+  /**
+   * Append content of frame to `out`, uncompressing it in place.
+   * `out` is unspecified on failure.
+   * @param max_size limit of appended bytes
+   */
+  inline outcome::result<void> uncompressFrameAppend(ChunkType type,
+                                                     qtils::BytesIn content,
+                                                     qtils::ByteVec &out,
+                                                     size_t max_size) {
+    if (type == ChunkType::Stream) {
+      if (qtils::ByteView{content} != kStreamIdentifier) {
+        return SnappyError::UNCOMPRESS_UNKNOWN_IDENTIFIER;
+      }
+      return outcome::success();
+    }
+    if (type == ChunkType::Padding) {
+      return outcome::success();
+    }
+    if (type != ChunkType::Compressed and type != ChunkType::Uncompressed) {
+      return SnappyError::UNCOMPRESS_UNKNOWN_TYPE;
+    }
+    if (content.size() < Crc32::size()) {
+      return SnappyError::UNCOMPRESS_TRUNCATED;
+    }
+    auto expected_crc = content.first(Crc32::size());
+    auto data = content.subspan(Crc32::size());
+    auto offset = out.size();
+    if (type == ChunkType::Compressed) {
+      BOOST_OUTCOME_TRY(auto size, uncompressedLength(data, max_size));
+      out.resize(offset + size);
+      if (not ::snappy::RawUncompress(
+              qtils::byte2str(data.data()),
+              data.size(),
+              reinterpret_cast<char *>(out.data() + offset))) {
+        return SnappyError::UNCOMPRESS_INVALID;
+      }
+    } else {
+      if (data.size() > max_size) {
+        return SnappyError::UNCOMPRESS_TOO_LONG;
+      }
+      out.put(data);
+    }
+    auto actual_crc = hashCrc32(std::span{out}.subspan(offset));
+    if (qtils::ByteView{actual_crc} != expected_crc) {
+      return SnappyError::UNCOMPRESS_CRC_MISMATCH;
+    }
+    return outcome::success();
+  }
+
   inline outcome::result<qtils::ByteVec> uncompressFramed(
       qtils::BytesIn compressed, size_t max_size = kDefaultMaxSize) {
     qtils::ByteVec result;
@@ -131,69 +256,92 @@ namespace lean::snappy {
         return SnappyError::UNCOMPRESS_TRUNCATED;
       }
       auto type = ChunkType{compressed[0]};
-      auto size = boost::endian::load_little_u24(compressed.data() + 1);
-      auto content = compressed.subspan(kHeaderSize, size);
-      compressed = compressed.subspan(kHeaderSize + size);
-      if (type == ChunkType::Stream) {
-        if (qtils::ByteView{content} != kStreamIdentifier) {
-          return SnappyError::UNCOMPRESS_UNKNOWN_IDENTIFIER;
-        }
-      } else if (type == ChunkType::Compressed
-                 or type == ChunkType::Uncompressed) {
-        qtils::ByteVec buffer;
-        auto expected_crc = content.first(Crc32::size());
-        auto uncompressed = content.subspan(Crc32::size());
-        if (type == ChunkType::Compressed) {
-          BOOST_OUTCOME_TRY(
-              buffer,
-              uncompress(uncompressed,
-                         libp2p::saturating_sub(max_size, result.size())));
-          uncompressed = buffer;
-        }
-        auto actual_crc = hashCrc32(uncompressed);
-        if (qtils::ByteView{actual_crc} != expected_crc) {
-          return SnappyError::UNCOMPRESS_CRC_MISMATCH;
-        }
-        result.put(uncompressed);
-      } else if (type == ChunkType::Padding) {
-        // skip padding
-      } else {
-        return SnappyError::UNCOMPRESS_UNKNOWN_TYPE;
-      }
+      auto content = compressed.subspan(kHeaderSize, *need - kHeaderSize);
+      compressed = compressed.subspan(*need);
+      BOOST_OUTCOME_TRY(uncompressFrameAppend(
+          type,
+          content,
+          result,
+          libp2p::saturating_sub(max_size, result.size())));
     }
     return result;
   }
 
+  /**
+   * Read varint size prefixed framed message.
+   * @param read_size incremented by compressed bytes read, if not null
+   */
   inline libp2p::CoroOutcome<qtils::ByteVec> coUncompressFramed(
       std::shared_ptr<libp2p::Stream> stream,
-      size_t max_size = kDefaultMaxSize) {
+      size_t max_size = kDefaultMaxSize,
+      size_t *read_size = nullptr) {
     BOOST_OUTCOME_CO_TRY(auto size, co_await libp2p::readVarint(stream));
     if (size > max_size) {
       co_return SnappyError::UNCOMPRESS_TOO_LONG;
     }
+    // Declared size is not trusted, result grows with received frames
     qtils::ByteVec result;
+    result.reserve(std::min(size, kMaxBlockSize));
+    // Each frame is read into same buffer, then uncompressed into result
+    qtils::ByteVec frame;
     while (result.size() < size) {
-      qtils::ByteVec chunk;
-      chunk.resize(kHeaderSize);
-      BOOST_OUTCOME_CO_TRY(co_await libp2p::read(stream, chunk));
-      auto need = chunkNeedBytes(chunk).value();
-      chunk.resize(need);
-      BOOST_OUTCOME_CO_TRY(
-          co_await libp2p::read(stream, std::span{chunk}.subspan(kHeaderSize)));
+      frame.resize(kHeaderSize);
+      BOOST_OUTCOME_CO_TRY(co_await libp2p::read(stream, frame));
+      auto need = chunkNeedBytes(frame).value();
+      if (need - kHeaderSize > maxFrameContentSize()) {
+        co_return SnappyError::UNCOMPRESS_TOO_LONG;
+      }
+      frame.resize(need);
       BOOST_OUTCOME_CO_TRY(
-          auto uncompressed,
-          uncompressFramed(chunk, libp2p::saturating_sub(size, result.size())));
-      result.put(uncompressed);
+          co_await libp2p::read(stream, std::span{frame}.subspan(kHeaderSize)));
+      if (read_size != nullptr) {
+        *read_size += frame.size();
+      }
+      BOOST_OUTCOME_CO_TRY(uncompressFrameAppend(
+          ChunkType{frame[0]},
+          std::span{frame}.subspan(kHeaderSize),
+          result,
+          size - result.size()));
     }
     co_return result;
   }
 
+  /**
+   * Write message already compressed by `compressFramed`.
+   * @param size uncompressed message size
+   */
+  inline libp2p::CoroOutcome<void> coWriteFramed(
+      std::shared_ptr<libp2p::Stream> stream,
+      size_t size,
+      qtils::BytesIn compressed) {
+    BOOST_OUTCOME_CO_TRY(
+        co_await libp2p::write(stream, libp2p::EncodeVarint{size}));
+    BOOST_OUTCOME_CO_TRY(co_await libp2p::write(stream, compressed));
+    co_return outcome::success();
+  }
+
+  /**
+   * Write varint size prefixed framed message.
+   * Each chunk is written once compressed into reused buffer, so first
+   * bytes are sent before whole message is compressed.
+   */
   inline libp2p::CoroOutcome<void> coCompressFramed(
       std::shared_ptr<libp2p::Stream> stream, qtils::BytesIn message) {
-    auto compressed = compressFramed(message);
     BOOST_OUTCOME_CO_TRY(
         co_await libp2p::write(stream, libp2p::EncodeVarint{message.size()}));
-    BOOST_OUTCOME_CO_TRY(co_await libp2p::write(stream, compressed));
+    qtils::ByteVec frame;
+    frame.reserve(maxCompressedFramedLength(
+        std::min(message.size(), kMaxBlockSize)));
+    appendStreamIdentifier(frame);
+    do {
+      auto chunk = message.first(std::min(message.size(), kMaxBlockSize));
+      message = message.subspan(chunk.size());
+      if (not chunk.empty()) {
+        appendCompressedFrame(chunk, frame);
+      }
+      BOOST_OUTCOME_CO_TRY(co_await libp2p::write(stream, frame));
+      frame.clear();
+    } while (not message.empty());
     co_return outcome::success();
   }
 }  // namespace lean::snappy
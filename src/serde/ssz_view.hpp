@@ -0,0 +1,158 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "serde/serialization.hpp"
+
+namespace lean {
+  /**
+   * Borrowed SSZ encoding of container with `N` fields.
+   *
+   * Fixed part of encoding holds fixed-size fields in place, and 4-byte
+   * offsets of variable-size fields, whose bytes follow in same order.
+   * Only sizes and offsets are checked on creation, fields are decoded on
+   * access, so reading few fields of large container doesn't materialize
+   * its lists.
+   *
+   * Bytes must outlive view, e.g. `OwnedOrView<ByteVec>` value read from
+   * storage, or uncompressed gossip message.
+   */
+  template <size_t N>
+  class SszContainerView {
+   public:
+    /// Size of fixed-size field, or `kVariable` for variable-size field
+    using FieldSizes = std::array<size_t, N>;
+    static constexpr size_t kVariable = 0;
+    static constexpr size_t kOffsetSize = 4;
+
+    static outcome::result<SszContainerView> make(qtils::BytesIn bytes,
+                                                  const FieldSizes &sizes) {
+      SszContainerView view;
+      view.bytes_ = bytes;
+      size_t fixed_size = 0;
+      for (auto size : sizes) {
+        fixed_size += size == kVariable ? kOffsetSize : size;
+      }
+      if (bytes.size() < fixed_size) {
+        return SszError::DecodeError;
+      }
+      // Previous variable-size field ends where next one begins
+      std::optional<size_t> variable;
+      size_t position = 0;
+      for (size_t i = 0; i < N; ++i) {
+        if (sizes[i] != kVariable) {
+          view.begin_[i] = position;
+          view.end_[i] = position + sizes[i];
+          position += sizes[i];
+          continue;
+        }
+        size_t offset = readOffset(bytes, position);
+        position += kOffsetSize;
+        if (offset > bytes.size()) {
+          return SszError::DecodeError;
+        }
+        if (not variable.has_value()) {
+          // First variable-size field starts right after fixed part
+          if (offset != fixed_size) {
+            return SszError::DecodeError;
+          }
+        } else {
+          if (offset < view.begin_[*variable]) {
+            return SszError::DecodeError;
+          }
+          view.end_[*variable] = offset;
+        }
+        view.begin_[i] = offset;
+        variable = i;
+      }
+      if (variable.has_value()) {
+        view.end_[*variable] = bytes.size();
+      } else if (bytes.size() != fixed_size) {
+        return SszError::DecodeError;
+      }
+      return view;
+    }
+
+    qtils::BytesIn bytes() const {
+      return bytes_;
+    }
+
+    /// Encoded field `i`
+    qtils::BytesIn field(size_t i) const {
+      return bytes_.subspan(begin_.at(i), end_.at(i) - begin_.at(i));
+    }
+
+    template <typename T>
+    outcome::result<T> decodeField(size_t i) const {
+      return decode<T>(field(i));
+    }
+
+    /**
+     * Decode fixed-size field, which can't fail after size was checked by
+     * `make`.
+     */
+    template <typename T>
+    T fixedField(size_t i) const {
+      return decode<T>(field(i)).value();
+    }
+
+   private:
+    SszContainerView() = default;
+
+    static size_t readOffset(qtils::BytesIn bytes, size_t position) {
+      size_t offset = 0;
+      for (size_t i = 0; i < kOffsetSize; ++i) {
+        offset |= static_cast<size_t>(bytes[position + i]) << (8 * i);
+      }
+      return offset;
+    }
+
+    qtils::BytesIn bytes_;
+    std::array<size_t, N> begin_{};
+    std::array<size_t, N> end_{};
+  };
+
+  /**
+   * Borrowed SSZ encoding of list of fixed-size elements, elements are
+   * decoded on access.
+   */
+  template <typename T>
+  class SszFixedListView {
+   public:
+    static outcome::result<SszFixedListView> make(qtils::BytesIn bytes,
+                                                  size_t element_size) {
+      if (element_size == 0 or bytes.size() % element_size != 0) {
+        return SszError::DecodeError;
+      }
+      return SszFixedListView{bytes, element_size};
+    }
+
+    size_t size() const {
+      return bytes_.size() / element_size_;
+    }
+
+    /// Element `i`, or nullopt if out of range
+    std::optional<T> at(size_t i) const {
+      if (i >= size()) {
+        return std::nullopt;
+      }
+      return decode<T>(bytes_.subspan(i * element_size_, element_size_))
+          .value();
+    }
+
+   private:
+    SszFixedListView(qtils::BytesIn bytes, size_t element_size)
+        : bytes_{bytes}, element_size_{element_size} {}
+
+    qtils::BytesIn bytes_;
+    size_t element_size_;
+  };
+}  // namespace lean
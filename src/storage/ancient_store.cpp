@@ -0,0 +1,257 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ancient_store.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <mutex>
+#include <numeric>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "storage/storage_error.hpp"
+
+namespace lean::storage {
+  static_assert(std::endian::native == std::endian::little,
+                "Index entries are stored in native little endian order");
+
+  namespace {
+    constexpr size_t kEntrySize = sizeof(uint64_t);
+    /// Index file starts with first key
+    constexpr size_t kIndexHeaderSize = sizeof(uint64_t);
+    /// Adjacent records are read at once up to this size
+    constexpr uint64_t kMaxReadSize = 16 << 20;
+
+    outcome::result<void> readAll(int fd,
+                                  uint64_t offset,
+                                  std::span<std::byte> out) {
+      while (not out.empty()) {
+        auto r =
+            ::pread(fd, out.data(), out.size(), static_cast<off_t>(offset));
+        if (r < 0 and errno == EINTR) {
+          continue;
+        }
+        if (r <= 0) {
+          return StorageError::IO_ERROR;
+        }
+        out = out.subspan(static_cast<size_t>(r));
+        offset += static_cast<uint64_t>(r);
+      }
+      return outcome::success();
+    }
+
+    outcome::result<void> writeAll(int fd,
+                                   uint64_t offset,
+                                   std::span<const std::byte> in) {
+      while (not in.empty()) {
+        auto r =
+            ::pwrite(fd, in.data(), in.size(), static_cast<off_t>(offset));
+        if (r < 0 and errno == EINTR) {
+          continue;
+        }
+        if (r <= 0) {
+          return StorageError::IO_ERROR;
+        }
+        in = in.subspan(static_cast<size_t>(r));
+        offset += static_cast<uint64_t>(r);
+      }
+      return outcome::success();
+    }
+
+    outcome::result<uint64_t> fileSize(int fd) {
+      struct stat st{};
+      if (::fstat(fd, &st) != 0) {
+        return StorageError::IO_ERROR;
+      }
+      return static_cast<uint64_t>(st.st_size);
+    }
+
+    outcome::result<void> truncate(int fd, uint64_t size) {
+      if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        return StorageError::IO_ERROR;
+      }
+      return outcome::success();
+    }
+
+    outcome::result<int> openFile(const std::filesystem::path &path) {
+      auto fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+      if (fd < 0) {
+        return StorageError::IO_ERROR;
+      }
+      return fd;
+    }
+  }  // namespace
+
+  outcome::result<std::unique_ptr<AncientStore>> AncientStore::open(
+      const std::filesystem::path &directory) {
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+      return StorageError::DB_PATH_NOT_CREATED;
+    }
+    OUTCOME_TRY(data_fd, openFile(directory / "data"));
+    auto index_fd_res = openFile(directory / "index");
+    if (index_fd_res.has_error()) {
+      ::close(data_fd);
+      return index_fd_res.error();
+    }
+    std::unique_ptr<AncientStore> store{
+        new AncientStore{data_fd, index_fd_res.value()}};
+
+    OUTCOME_TRY(index_size, fileSize(store->index_fd_));
+    OUTCOME_TRY(data_size, fileSize(store->data_fd_));
+    if (index_size >= kIndexHeaderSize) {
+      OUTCOME_TRY(readAll(store->index_fd_,
+                          0,
+                          std::as_writable_bytes(std::span{
+                              &store->first_key_, 1})));
+      store->ends_.resize((index_size - kIndexHeaderSize) / kEntrySize);
+      OUTCOME_TRY(readAll(store->index_fd_,
+                          kIndexHeaderSize,
+                          std::as_writable_bytes(std::span{store->ends_})));
+    }
+
+    // Keep records both fully written and indexed
+    uint64_t end = 0;
+    size_t count = 0;
+    while (count < store->ends_.size() and store->ends_[count] >= end
+           and store->ends_[count] <= data_size) {
+      end = store->ends_[count];
+      ++count;
+    }
+    store->ends_.resize(count);
+    OUTCOME_TRY(truncate(store->index_fd_,
+                         count == 0 ? 0
+                                    : kIndexHeaderSize + count * kEntrySize));
+    OUTCOME_TRY(truncate(store->data_fd_, end));
+    return store;
+  }
+
+  AncientStore::AncientStore(int data_fd, int index_fd)
+      : data_fd_{data_fd}, index_fd_{index_fd} {}
+
+  AncientStore::~AncientStore() {
+    ::close(data_fd_);
+    ::close(index_fd_);
+  }
+
+  std::optional<uint64_t> AncientStore::firstKey() const {
+    std::shared_lock lock{mutex_};
+    if (ends_.empty()) {
+      return std::nullopt;
+    }
+    return first_key_;
+  }
+
+  uint64_t AncientStore::endKey() const {
+    std::shared_lock lock{mutex_};
+    return first_key_ + ends_.size();
+  }
+
+  outcome::result<void> AncientStore::append(uint64_t key,
+                                             qtils::BytesIn value) {
+    std::unique_lock lock{mutex_};
+    auto first = ends_.empty();
+    if (first) {
+      first_key_ = key;
+    } else if (key < first_key_ + ends_.size()) {
+      return StorageError::INVALID_ARGUMENT;
+    }
+    auto begin = first ? 0 : ends_.back();
+    OUTCOME_TRY(writeAll(data_fd_, begin, std::as_bytes(value)));
+
+    auto count = ends_.size();
+    std::vector<uint64_t> entries(key - first_key_ - count + 1, begin);
+    entries.back() = begin + value.size();
+    if (first) {
+      OUTCOME_TRY(writeAll(
+          index_fd_, 0, std::as_bytes(std::span{&first_key_, 1})));
+    }
+    OUTCOME_TRY(writeAll(index_fd_,
+                         kIndexHeaderSize + count * kEntrySize,
+                         std::as_bytes(std::span{entries})));
+    ends_.insert(ends_.end(), entries.begin(), entries.end());
+    return outcome::success();
+  }
+
+  outcome::result<void> AncientStore::sync() {
+    if (::fdatasync(data_fd_) != 0 or ::fdatasync(index_fd_) != 0) {
+      return StorageError::IO_ERROR;
+    }
+    return outcome::success();
+  }
+
+  std::optional<AncientStore::Range> AncientStore::range(uint64_t key) const {
+    if (key < first_key_ or key - first_key_ >= ends_.size()) {
+      return std::nullopt;
+    }
+    auto i = key - first_key_;
+    Range range{.begin = i == 0 ? 0 : ends_[i - 1], .end = ends_[i]};
+    if (range.begin == range.end) {
+      return std::nullopt;
+    }
+    return range;
+  }
+
+  outcome::result<void> AncientStore::read(uint64_t offset,
+                                           std::span<uint8_t> out) const {
+    return readAll(data_fd_, offset, std::as_writable_bytes(out));
+  }
+
+  outcome::result<std::optional<qtils::ByteVec>> AncientStore::get(
+      uint64_t key) const {
+    OUTCOME_TRY(values, getMany(std::span{&key, 1}));
+    return std::move(values.front());
+  }
+
+  outcome::result<std::vector<std::optional<qtils::ByteVec>>>
+  AncientStore::getMany(std::span<const uint64_t> keys) const {
+    std::vector<std::optional<Range>> ranges;
+    ranges.reserve(keys.size());
+    {
+      std::shared_lock lock{mutex_};
+      for (auto key : keys) {
+        ranges.emplace_back(range(key));
+      }
+    }
+
+    std::vector<size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::erase_if(order, [&](size_t i) { return not ranges[i]; });
+    std::ranges::sort(order, {}, [&](size_t i) { return ranges[i]->begin; });
+
+    std::vector<std::optional<qtils::ByteVec>> values(keys.size());
+    qtils::ByteVec buffer;
+    for (size_t run = 0; run < order.size();) {
+      // Records following each other in data file
+      auto begin = ranges[order[run]]->begin;
+      auto end = ranges[order[run]]->end;
+      auto run_end = run + 1;
+      while (run_end < order.size()) {
+        auto &next = *ranges[order[run_end]];
+        if (next.begin != end or next.end - begin > kMaxReadSize) {
+          break;
+        }
+        end = next.end;
+        ++run_end;
+      }
+      buffer.resize(end - begin);
+      OUTCOME_TRY(read(begin, buffer));
+      for (auto i : std::span{order}.subspan(run, run_end - run)) {
+        auto &range = *ranges[i];
+        values[i].emplace(buffer.begin() + (range.begin - begin),
+                          buffer.begin() + (range.end - begin));
+      }
+      run = run_end;
+    }
+    return values;
+  }
+
+}  // namespace lean::storage
@@ -0,0 +1,85 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <vector>
+
+#include <qtils/byte_vec.hpp>
+#include <qtils/outcome.hpp>
+
+namespace lean::storage {
+
+  /**
+   * Append-only store of immutable records keyed by ascending number, e.g.
+   * finalized canonical blocks by slot.
+   *
+   * Records are appended one after another to data file, index file keeps
+   * end offset of record of each key since first one, skipped keys get
+   * empty records. Record is found with single index lookup, and records of
+   * adjacent keys are read with single sequential read.
+   *
+   * Data is written before index, so tail not covered by index after crash
+   * is truncated on open.
+   *
+   * Appends are serialized by caller, reads are thread safe.
+   */
+  class AncientStore {
+   public:
+    static outcome::result<std::unique_ptr<AncientStore>> open(
+        const std::filesystem::path &directory);
+
+    AncientStore(const AncientStore &) = delete;
+    AncientStore &operator=(const AncientStore &) = delete;
+
+    ~AncientStore();
+
+    /// First key, if any record was appended
+    std::optional<uint64_t> firstKey() const;
+
+    /// Key next after last appended one, records must be appended from it
+    uint64_t endKey() const;
+
+    /// Append record, keys between end key and `key` get empty records
+    outcome::result<void> append(uint64_t key, qtils::BytesIn value);
+
+    /// Flush appended records to disk
+    outcome::result<void> sync();
+
+    /// Record of key, nullopt if not stored or empty
+    outcome::result<std::optional<qtils::ByteVec>> get(uint64_t key) const;
+
+    /// Records of keys, adjacent ones are read at once
+    outcome::result<std::vector<std::optional<qtils::ByteVec>>> getMany(
+        std::span<const uint64_t> keys) const;
+
+   private:
+    AncientStore(int data_fd, int index_fd);
+
+    /// Byte range of record in data file
+    struct Range {
+      uint64_t begin;
+      uint64_t end;
+    };
+    std::optional<Range> range(uint64_t key) const;
+
+    outcome::result<void> read(uint64_t offset, std::span<uint8_t> out) const;
+
+    int data_fd_;
+    int index_fd_;
+
+    mutable std::shared_mutex mutex_;
+    uint64_t first_key_ = 0;
+    /// End offset of record of each key since `first_key_`
+    std::vector<uint64_t> ends_;
+  };
+
+}  // namespace lean::storage
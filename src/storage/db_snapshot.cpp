@@ -0,0 +1,405 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/db_snapshot.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/endian/conversion.hpp>
+#include <fcntl.h>
+#include <qtils/final_action.hpp>
+#include <unistd.h>
+
+#include "serde/snappy.hpp"
+#include "storage/spaced_storage.hpp"
+#include "utils/async_file_io.hpp"
+#include "utils/ceil_div.hpp"
+
+namespace lean::storage {
+  namespace fs = std::filesystem;
+
+  namespace {
+    constexpr qtils::ByteArr<8> kMagic{'Q', 'L', 'E', 'A', 'N', 'D', 'B', '1'};
+    constexpr size_t kMaxPathSize = 4096;
+    /// Chunks read while previous ones are compressed
+    constexpr size_t kReadAhead = 8;
+
+    /// Written by RocksDB on open, not part of database
+    bool isRuntimeFile(const fs::path &relative) {
+      auto name = relative.filename().string();
+      return not relative.has_parent_path()
+         and (name == "LOCK" or name.starts_with("LOG"));
+    }
+
+    /// Relative path inside extracted directory
+    bool isSafePath(const fs::path &path) {
+      if (path.empty() or not path.is_relative()) {
+        return false;
+      }
+      for (auto &part : path) {
+        if (part == "..") {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /// Snappy frames of `kMaxBlockSize` chunks of written bytes
+    class FramedWriter {
+     public:
+      explicit FramedWriter(std::ostream &out) : out_{out} {
+        snappy::appendStreamIdentifier(frame_);
+        writeFrame();
+      }
+
+      void write(qtils::BytesIn bytes) {
+        while (not bytes.empty()) {
+          auto n =
+              std::min(bytes.size(), snappy::kMaxBlockSize - chunk_.size());
+          chunk_.put(bytes.first(n));
+          bytes = bytes.subspan(n);
+          if (chunk_.size() == snappy::kMaxBlockSize) {
+            flushChunk();
+          }
+        }
+      }
+
+      outcome::result<void> finish() {
+        if (not chunk_.empty()) {
+          flushChunk();
+        }
+        out_.flush();
+        if (not out_) {
+          return DbSnapshotError::IO;
+        }
+        return outcome::success();
+      }
+
+     private:
+      void flushChunk() {
+        snappy::appendCompressedFrame(chunk_, frame_);
+        chunk_.clear();
+        writeFrame();
+      }
+
+      void writeFrame() {
+        out_.write(qtils::byte2str(frame_.data()),
+                   static_cast<std::streamsize>(frame_.size()));
+        frame_.clear();
+      }
+
+      std::ostream &out_;
+      qtils::ByteVec chunk_;
+      qtils::ByteVec frame_;
+    };
+
+    /// Bytes of snappy frames read one frame at a time
+    class FramedReader {
+     public:
+      explicit FramedReader(std::istream &in) : in_{in} {}
+
+      outcome::result<void> read(std::span<uint8_t> out) {
+        while (not out.empty()) {
+          if (offset_ == chunk_.size()) {
+            OUTCOME_TRY(nextChunk());
+          }
+          auto n = std::min(out.size(), chunk_.size() - offset_);
+          std::copy_n(chunk_.data() + offset_, n, out.data());
+          offset_ += n;
+          out = out.subspan(n);
+        }
+        return outcome::success();
+      }
+
+     private:
+      outcome::result<void> nextChunk() {
+        chunk_.clear();
+        offset_ = 0;
+        while (chunk_.empty()) {
+          qtils::ByteArr<snappy::kHeaderSize> header;
+          OUTCOME_TRY(readRaw(header));
+          auto type = snappy::ChunkType{header[0]};
+          // Stream must start with identifier
+          if (first_ and type != snappy::ChunkType::Stream) {
+            return DbSnapshotError::INVALID;
+          }
+          first_ = false;
+          auto size = boost::endian::load_little_u24(header.data() + 1);
+          if (size > snappy::maxFrameContentSize()) {
+            return DbSnapshotError::INVALID;
+          }
+          frame_.resize(size);
+          OUTCOME_TRY(readRaw(frame_));
+          OUTCOME_TRY(snappy::uncompressFrameAppend(
+              type, frame_, chunk_, snappy::kMaxBlockSize));
+        }
+        return outcome::success();
+      }
+
+      outcome::result<void> readRaw(std::span<uint8_t> out) {
+        in_.read(qtils::byte2str(out.data()),
+                 static_cast<std::streamsize>(out.size()));
+        if (in_.gcount() != static_cast<std::streamsize>(out.size())) {
+          return DbSnapshotError::INVALID;
+        }
+        return outcome::success();
+      }
+
+      std::istream &in_;
+      bool first_ = true;
+      qtils::ByteVec frame_;
+      qtils::ByteVec chunk_;
+      size_t offset_ = 0;
+    };
+
+    /// Chunks of files read by `AsyncFileIo` ahead of their compression
+    class ReadAhead {
+     public:
+      ReadAhead() {
+        std::vector<std::span<uint8_t>> spans;
+        for (auto &buffer : buffers_) {
+          buffer.resize(snappy::kMaxBlockSize);
+          spans.emplace_back(buffer);
+        }
+        fixed_ = io_.registerBuffers(spans).has_value();
+      }
+
+      /**
+       * Call `consume` with chunks of first `size` bytes of file in order.
+       * @return error if file is shorter, e.g. truncated while read
+       */
+      outcome::result<void> read(
+          int fd,
+          uint64_t size,
+          const std::function<void(qtils::BytesIn)> &consume) {
+        uint64_t chunks = ceilDiv(size, snappy::kMaxBlockSize);
+        auto chunk_size = [&](uint64_t chunk) {
+          return std::min<uint64_t>(snappy::kMaxBlockSize,
+                                    size - chunk * snappy::kMaxBlockSize);
+        };
+        std::array<std::optional<AsyncFileIo::Results>, kReadAhead> results;
+        uint64_t submitted = 0;
+        uint64_t consumed = 0;
+        auto failed = false;
+        while (consumed < chunks and not failed) {
+          for (; submitted < chunks and submitted < consumed + kReadAhead;
+               ++submitted) {
+            auto slot = submitted % kReadAhead;
+            results[slot].reset();
+            io_.submit(
+                {{
+                    .fd = fd,
+                    .offset = submitted * snappy::kMaxBlockSize,
+                    .buffer =
+                        std::span{buffers_[slot]}.first(chunk_size(submitted)),
+                    .fixed_buffer = fixed_ ? std::optional<uint16_t>(slot)
+                                           : std::nullopt,
+                }},
+                io_context_.get_executor(),
+                [&results, slot](AsyncFileIo::Results r) {
+                  results[slot] = std::move(r);
+                });
+          }
+          auto slot = consumed % kReadAhead;
+          while (not results[slot].has_value()) {
+            io_context_.run_one();
+          }
+          auto &result = results[slot]->at(0);
+          if (result.has_error() or result.value() != chunk_size(consumed)) {
+            failed = true;
+            continue;
+          }
+          consume(std::span{buffers_[slot]}.first(result.value()));
+          ++consumed;
+        }
+        // Reads in flight use buffers and results
+        io_context_.run();
+        io_context_.restart();
+        if (failed) {
+          return DbSnapshotError::IO;
+        }
+        return outcome::success();
+      }
+
+     private:
+      boost::asio::io_context io_context_;
+      AsyncFileIo io_{kReadAhead};
+      std::array<qtils::ByteVec, kReadAhead> buffers_;
+      bool fixed_ = false;
+    };
+
+    void writeU32(FramedWriter &writer, uint32_t value) {
+      qtils::ByteArr<4> bytes;
+      boost::endian::store_little_u32(bytes.data(), value);
+      writer.write(bytes);
+    }
+
+    void writeU64(FramedWriter &writer, uint64_t value) {
+      qtils::ByteArr<8> bytes;
+      boost::endian::store_little_u64(bytes.data(), value);
+      writer.write(bytes);
+    }
+
+    outcome::result<uint32_t> readU32(FramedReader &reader) {
+      qtils::ByteArr<4> bytes;
+      OUTCOME_TRY(reader.read(bytes));
+      return boost::endian::load_little_u32(bytes.data());
+    }
+
+    outcome::result<uint64_t> readU64(FramedReader &reader) {
+      qtils::ByteArr<8> bytes;
+      OUTCOME_TRY(reader.read(bytes));
+      return boost::endian::load_little_u64(bytes.data());
+    }
+
+    outcome::result<void> extract(FramedReader &reader,
+                                  const fs::path &directory) {
+      qtils::ByteArr<kMagic.size()> magic;
+      OUTCOME_TRY(reader.read(magic));
+      if (qtils::ByteView{magic} != kMagic) {
+        return DbSnapshotError::INVALID;
+      }
+      qtils::ByteVec buffer(snappy::kMaxBlockSize);
+      while (true) {
+        OUTCOME_TRY(path_size, readU32(reader));
+        if (path_size == 0) {
+          return outcome::success();
+        }
+        if (path_size > kMaxPathSize) {
+          return DbSnapshotError::INVALID;
+        }
+        qtils::ByteVec path_bytes(path_size);
+        OUTCOME_TRY(reader.read(path_bytes));
+        fs::path relative{std::string{qtils::byte2str(path_bytes)}};
+        if (not isSafePath(relative)) {
+          return DbSnapshotError::INVALID;
+        }
+        OUTCOME_TRY(size, readU64(reader));
+
+        auto path = directory / relative;
+        std::error_code ec;
+        fs::create_directories(path.parent_path(), ec);
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        while (size != 0) {
+          auto n = std::min<uint64_t>(size, buffer.size());
+          auto bytes = std::span{buffer}.first(n);
+          OUTCOME_TRY(reader.read(bytes));
+          file.write(qtils::byte2str(bytes.data()),
+                     static_cast<std::streamsize>(n));
+          size -= n;
+        }
+        file.close();
+        if (not file) {
+          return DbSnapshotError::IO;
+        }
+      }
+    }
+  }  // namespace
+
+  outcome::result<void> checkpointDatabase(SpacedStorage &storage,
+                                           const fs::path &directory,
+                                           const fs::path &target) {
+    if (exists(target)) {
+      return DbSnapshotError::EXISTS;
+    }
+    OUTCOME_TRY(storage.checkpoint(target));
+    auto ancient = directory / "ancient";
+    if (not exists(ancient)) {
+      return outcome::success();
+    }
+    // Index is copied before data, so copied data covers every copied index
+    // entry, and record appended in between is truncated on open
+    std::error_code ec;
+    fs::create_directory(target / "ancient", ec);
+    for (auto name : {"index", "data"}) {
+      if (not ec and exists(ancient / name)) {
+        fs::copy_file(ancient / name, target / "ancient" / name, ec);
+      }
+    }
+    if (ec) {
+      return DbSnapshotError::IO;
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> exportDbSnapshot(const fs::path &directory,
+                                         std::ostream &out) {
+    std::error_code ec;
+    std::vector<fs::path> files;
+    for (auto it = fs::recursive_directory_iterator{directory, ec};
+         not ec and it != fs::recursive_directory_iterator{};
+         it.increment(ec)) {
+      if (not it->is_regular_file()) {
+        continue;
+      }
+      auto relative = it->path().lexically_relative(directory);
+      if (not isRuntimeFile(relative)) {
+        files.emplace_back(std::move(relative));
+      }
+    }
+    if (ec) {
+      return DbSnapshotError::IO;
+    }
+    std::ranges::sort(files);
+
+    FramedWriter writer{out};
+    writer.write(kMagic);
+    ReadAhead read_ahead;
+    for (auto &relative : files) {
+      auto path_str = relative.generic_string();
+      auto size = fs::file_size(directory / relative, ec);
+      if (ec) {
+        return DbSnapshotError::IO;
+      }
+      writeU32(writer, path_str.size());
+      writer.write(qtils::str2byte(path_str));
+      writeU64(writer, size);
+      auto fd = ::open((directory / relative).c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0) {
+        return DbSnapshotError::IO;
+      }
+      qtils::FinalAction close_fd{[fd] { ::close(fd); }};
+      OUTCOME_TRY(read_ahead.read(
+          fd, size, [&](qtils::BytesIn chunk) { writer.write(chunk); }));
+    }
+    writeU32(writer, 0);
+    return writer.finish();
+  }
+
+  outcome::result<void> importDbSnapshot(std::istream &in,
+                                         const fs::path &directory) {
+    if (exists(directory)) {
+      return DbSnapshotError::EXISTS;
+    }
+    auto temporary = directory;
+    temporary += ".import";
+    std::error_code ec;
+    fs::remove_all(temporary, ec);
+    fs::create_directories(temporary, ec);
+    if (ec) {
+      return DbSnapshotError::IO;
+    }
+    FramedReader reader{in};
+    auto res = extract(reader, temporary);
+    if (res.has_value()) {
+      fs::rename(temporary, directory, ec);
+      if (not ec) {
+        return outcome::success();
+      }
+      res = DbSnapshotError::IO;
+    }
+    fs::remove_all(temporary, ec);
+    return res;
+  }
+}  // namespace lean::storage
@@ -0,0 +1,65 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <iosfwd>
+
+#include <qtils/enum_error_code.hpp>
+#include <qtils/outcome.hpp>
+
+namespace lean::storage {
+  class SpacedStorage;
+
+  enum class DbSnapshotError : uint8_t {
+    EXISTS = 1,
+    IO,
+    INVALID,
+  };
+  Q_ENUM_ERROR_CODE(DbSnapshotError) {
+    using E = decltype(e);
+    switch (e) {
+      case E::EXISTS:
+        return "Target directory already exists";
+      case E::IO:
+        return "Can't read or write snapshot files";
+      case E::INVALID:
+        return "Invalid snapshot archive";
+    }
+    abort();
+  }
+
+  /**
+   * Consistent copy of node database `directory` in new `target`, made
+   * while node keeps writing to it: checkpoint of `storage`, then copy of
+   * ancient store, covering all blocks moved out of checkpointed storage.
+   * Fork choice snapshot is stored in database, so node started on copy
+   * resumes from it.
+   */
+  outcome::result<void> checkpointDatabase(
+      SpacedStorage &storage,
+      const std::filesystem::path &directory,
+      const std::filesystem::path &target);
+
+  /**
+   * Write files of database `directory` not written to, e.g. checkpoint or
+   * database of stopped node, as snappy framed archive.
+   * Archive content is magic, then each file as 32-bit path size, relative
+   * path, 64-bit file size and file bytes, then 32-bit zero.
+   */
+  outcome::result<void> exportDbSnapshot(
+      const std::filesystem::path &directory, std::ostream &out);
+
+  /**
+   * Extract archive into new `directory`.
+   * Files are written into temporary sibling directory, renamed to
+   * `directory` once archive is complete, so interrupted import leaves no
+   * partial database.
+   */
+  outcome::result<void> importDbSnapshot(
+      std::istream &in, const std::filesystem::path &directory);
+}  // namespace lean::storage
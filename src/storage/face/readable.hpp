@@ -6,6 +6,11 @@
 
 #pragma once
 
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
 #include <qtils/outcome.hpp>
 
 #include "storage/face/owned_or_view.hpp"
@@ -44,5 +49,40 @@ namespace lean::storage::face {
      */
     [[nodiscard]] virtual outcome::result<std::optional<OwnedOrView<V>>> tryGet(
         const View<K> &key) const = 0;
+
+    /**
+     * @brief Get values of many keys at once
+     * Implementation may read keys in single batched lookup.
+     * @return V or std::nullopt for each key, in the same order
+     */
+    [[nodiscard]] virtual outcome::result<
+        std::vector<std::optional<OwnedOrView<V>>>>
+    tryGetMany(std::span<const View<K>> keys) const {
+      std::vector<std::optional<OwnedOrView<V>>> values;
+      values.reserve(keys.size());
+      for (auto &key : keys) {
+        OUTCOME_TRY(value, tryGet(key));
+        values.emplace_back(std::move(value));
+      }
+      return values;
+    }
+
+    /**
+     * @brief Pass value of key to `read` without copying it, where
+     * implementation can expose value in place.
+     * Value is valid only during `read`.
+     * @return false if key is not found, or error of storage or `read`
+     */
+    [[nodiscard]] virtual outcome::result<bool> tryRead(
+        const View<K> &key,
+        const std::function<outcome::result<void>(const OwnedOrView<V> &)>
+            &read) const {
+      OUTCOME_TRY(value, tryGet(key));
+      if (not value.has_value()) {
+        return false;
+      }
+      OUTCOME_TRY(read(value.value()));
+      return true;
+    }
   };
 }  // namespace lean::storage::face
@@ -0,0 +1,98 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "storage/in_memory/hashed_memory_storage.hpp"
+#include "storage/spaced_storage.hpp"
+
+namespace lean::storage {
+
+  /**
+   * Spaces of `HashedMemoryStorage`, for shadow simulations and ephemeral
+   * nodes. Only `SlotToHashes` is sought by key, so only it keeps ordered
+   * index. Spaces are created upfront, so storage is safe to share between
+   * threads.
+   */
+  class HashedMemorySpacedStorage : public SpacedStorage {
+   public:
+    HashedMemorySpacedStorage() {
+      for (size_t i = 0; i < SpacesCount; ++i) {
+        auto ordered = static_cast<Space>(i) == Space::SlotToHashes;
+        spaces_.at(i) = std::make_shared<HashedMemoryStorage>(ordered);
+      }
+    }
+
+    std::shared_ptr<BufferStorage> getSpace(Space space) override {
+      return spaces_.at(static_cast<size_t>(space));
+    }
+
+    /// Writes are applied space by space, each under single lock
+    std::unique_ptr<SpacedBatch> createBatch() override {
+      return std::make_unique<Batch>(*this);
+    }
+
+    MemoryUsage memoryUsage() const override {
+      size_t size = 0;
+      for (auto &space : spaces_) {
+        size += space->byteSizeHint().value_or(0);
+      }
+      return {{"values", size}};
+    }
+
+   private:
+    class Batch : public SpacedBatch {
+     public:
+      explicit Batch(HashedMemorySpacedStorage &storage) : storage_{storage} {}
+
+      outcome::result<void> put(Space space,
+                                const ByteView &key,
+                                ByteVecOrView &&value) override {
+        writes(space).emplace_back(ByteVec{key},
+                                   std::move(value).intoByteVec());
+        return outcome::success();
+      }
+
+      outcome::result<void> remove(Space space, const ByteView &key) override {
+        writes(space).emplace_back(ByteVec{key}, std::nullopt);
+        return outcome::success();
+      }
+
+      outcome::result<void> commit() override {
+        for (size_t i = 0; i < SpacesCount; ++i) {
+          if (not writes_.at(i).empty()) {
+            OUTCOME_TRY(storage_.spaces_.at(i)->apply(writes_.at(i)));
+          }
+        }
+        return outcome::success();
+      }
+
+      void clear() override {
+        for (auto &writes : writes_) {
+          writes.clear();
+        }
+      }
+
+     private:
+      std::vector<HashedMemoryStorage::Write> &writes(Space space) {
+        return writes_.at(static_cast<size_t>(space));
+      }
+
+      // NOLINTNEXTLINE(cppcoreguidelines-avoid-const-or-ref-data-members)
+      HashedMemorySpacedStorage &storage_;
+      std::array<std::vector<HashedMemoryStorage::Write>, SpacesCount>
+          writes_;
+    };
+
+    std::array<std::shared_ptr<HashedMemoryStorage>, SpacesCount> spaces_;
+  };
+
+}  // namespace lean::storage
@@ -0,0 +1,404 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/in_memory/hashed_memory_storage.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+
+#include "storage/storage_error.hpp"
+
+namespace lean::storage {
+
+  namespace {
+    constexpr size_t kInitialCapacity = 64;
+    /// Arena chunk, larger values get chunk of their own
+    constexpr size_t kChunkSize = size_t{1} << 20;
+  }  // namespace
+
+  /// Batch applied under single lock of storage
+  class HashedMemoryBatch : public BufferBatch {
+   public:
+    explicit HashedMemoryBatch(HashedMemoryStorage &db) : db_{db} {}
+
+    outcome::result<void> put(const ByteView &key,
+                              ByteVecOrView &&value) override {
+      writes_.emplace_back(ByteVec{key}, std::move(value).intoByteVec());
+      return outcome::success();
+    }
+
+    outcome::result<void> remove(const ByteView &key) override {
+      writes_.emplace_back(ByteVec{key}, std::nullopt);
+      return outcome::success();
+    }
+
+    outcome::result<void> commit() override {
+      return db_.apply(writes_);
+    }
+
+    void clear() override {
+      writes_.clear();
+    }
+
+   private:
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-const-or-ref-data-members)
+    HashedMemoryStorage &db_;
+    std::vector<HashedMemoryStorage::Write> writes_;
+  };
+
+  /**
+   * Cursor over ordered index of storage, or over sorted snapshot of keys.
+   * Current key is looked up again on each step, so cursor survives writes.
+   */
+  class HashedMemoryCursor : public BufferStorageCursor {
+   public:
+    using Key = HashedMemoryStorage::Key;
+    static constexpr auto kMaxKeySize = HashedMemoryStorage::kMaxKeySize;
+
+    explicit HashedMemoryCursor(HashedMemoryStorage &db) : db_{db} {
+      std::shared_lock lock{db_.mutex_};
+      if (not db_.ordered_.has_value()) {
+        for (auto &slot : db_.slots_) {
+          if (slot.state == HashedMemoryStorage::SlotState::Used) {
+            snapshot_.emplace(slot.key);
+          }
+        }
+      }
+    }
+
+    outcome::result<bool> seekFirst() override {
+      std::shared_lock lock{db_.mutex_};
+      return position(keys().begin(), true);
+    }
+
+    outcome::result<bool> seek(const ByteView &key) override {
+      std::shared_lock lock{db_.mutex_};
+      auto &keys = this->keys();
+      // Longer key is greater than stored keys sharing its prefix
+      auto prefix = Key::make(key.first(std::min(key.size(), kMaxKeySize)));
+      auto it = keys.lower_bound(*prefix);
+      if (key.size() > kMaxKeySize and it != keys.end() and *it == *prefix) {
+        ++it;
+      }
+      return position(it, true);
+    }
+
+    outcome::result<bool> seekLast() override {
+      std::shared_lock lock{db_.mutex_};
+      auto &keys = this->keys();
+      return position(keys.empty() ? keys.end() : std::prev(keys.end()),
+                      false);
+    }
+
+    bool isValid() const override {
+      return kv_.has_value();
+    }
+
+    outcome::result<void> next() override {
+      std::shared_lock lock{db_.mutex_};
+      position(keys().upper_bound(kv_->first), true);
+      return outcome::success();
+    }
+
+    outcome::result<void> prev() override {
+      std::shared_lock lock{db_.mutex_};
+      auto &keys = this->keys();
+      auto it = keys.lower_bound(kv_->first);
+      position(it == keys.begin() ? keys.end() : std::prev(it), false);
+      return outcome::success();
+    }
+
+    std::optional<ByteVec> key() const override {
+      if (kv_) {
+        return ByteVec{kv_->first.view()};
+      }
+      return std::nullopt;
+    }
+
+    std::optional<ByteVecOrView> value() const override {
+      if (kv_) {
+        return ByteView{kv_->second};
+      }
+      return std::nullopt;
+    }
+
+   private:
+    using Keys = std::set<Key>;
+
+    const Keys &keys() const {
+      return db_.ordered_.has_value() ? *db_.ordered_ : snapshot_;
+    }
+
+    /// Keys removed after snapshot are skipped in direction of movement
+    bool position(Keys::const_iterator it, bool forward) {
+      auto &keys = this->keys();
+      kv_.reset();
+      while (it != keys.end()) {
+        if (auto slot = db_.find(*it)) {
+          kv_.emplace(*it,
+                      ByteVec{ByteView{slot->value.data, slot->value.size}});
+          break;
+        }
+        if (forward) {
+          ++it;
+        } else {
+          it = it == keys.begin() ? keys.end() : std::prev(it);
+        }
+      }
+      return isValid();
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-const-or-ref-data-members)
+    HashedMemoryStorage &db_;
+    Keys snapshot_;
+    std::optional<std::pair<Key, ByteVec>> kv_;
+  };
+
+  std::optional<HashedMemoryStorage::Key> HashedMemoryStorage::Key::make(
+      qtils::BytesIn key) {
+    if (key.size() > kMaxKeySize) {
+      return std::nullopt;
+    }
+    Key result;
+    std::ranges::copy(key, result.bytes.begin());
+    result.size = key.size();
+    return result;
+  }
+
+  HashedMemoryStorage::HashedMemoryStorage(bool ordered)
+      : slots_(kInitialCapacity) {
+    if (ordered) {
+      ordered_.emplace();
+    }
+  }
+
+  outcome::result<ByteVecOrView> HashedMemoryStorage::get(
+      const ByteView &key) const {
+    OUTCOME_TRY(value, tryGet(key));
+    if (not value.has_value()) {
+      return StorageError::NOT_FOUND;
+    }
+    return std::move(value.value());
+  }
+
+  outcome::result<std::optional<ByteVecOrView>> HashedMemoryStorage::tryGet(
+      const ByteView &key) const {
+    auto fixed_key = Key::make(key);
+    if (not fixed_key.has_value()) {
+      return std::nullopt;
+    }
+    std::shared_lock lock{mutex_};
+    auto slot = find(*fixed_key);
+    if (slot == nullptr) {
+      return std::nullopt;
+    }
+    return ByteVec{ByteView{slot->value.data, slot->value.size}};
+  }
+
+  outcome::result<void> HashedMemoryStorage::put(const ByteView &key,
+                                                 ByteVecOrView &&value) {
+    auto fixed_key = Key::make(key);
+    if (not fixed_key.has_value()) {
+      return StorageError::INVALID_ARGUMENT;
+    }
+    auto bytes = std::move(value).intoByteVec();
+    std::unique_lock lock{mutex_};
+    putLocked(*fixed_key, ByteView{bytes});
+    return outcome::success();
+  }
+
+  outcome::result<bool> HashedMemoryStorage::contains(
+      const ByteView &key) const {
+    auto fixed_key = Key::make(key);
+    if (not fixed_key.has_value()) {
+      return false;
+    }
+    std::shared_lock lock{mutex_};
+    return find(*fixed_key) != nullptr;
+  }
+
+  outcome::result<void> HashedMemoryStorage::remove(const ByteView &key) {
+    auto fixed_key = Key::make(key);
+    if (not fixed_key.has_value()) {
+      return outcome::success();
+    }
+    std::unique_lock lock{mutex_};
+    removeLocked(*fixed_key);
+    return outcome::success();
+  }
+
+  std::unique_ptr<BufferBatch> HashedMemoryStorage::batch() {
+    return std::make_unique<HashedMemoryBatch>(*this);
+  }
+
+  std::unique_ptr<HashedMemoryStorage::Cursor> HashedMemoryStorage::cursor() {
+    return std::make_unique<HashedMemoryCursor>(*this);
+  }
+
+  std::optional<size_t> HashedMemoryStorage::byteSizeHint() const {
+    std::shared_lock lock{mutex_};
+    return size_;
+  }
+
+  outcome::result<void> HashedMemoryStorage::apply(
+      const std::vector<Write> &writes) {
+    std::vector<Key> keys;
+    keys.reserve(writes.size());
+    for (auto &[key, value] : writes) {
+      auto fixed_key = Key::make(key);
+      if (not fixed_key.has_value()) {
+        return StorageError::INVALID_ARGUMENT;
+      }
+      keys.emplace_back(*fixed_key);
+    }
+    std::unique_lock lock{mutex_};
+    for (size_t i = 0; i < writes.size(); ++i) {
+      auto &value = writes[i].second;
+      if (value.has_value()) {
+        putLocked(keys[i], ByteView{*value});
+      } else {
+        removeLocked(keys[i]);
+      }
+    }
+    return outcome::success();
+  }
+
+  size_t HashedMemoryStorage::hash(const Key &key) {
+    return std::hash<std::string_view>{}(std::string_view{
+        reinterpret_cast<const char *>(key.bytes.data()),  // NOLINT
+        key.size});
+  }
+
+  const HashedMemoryStorage::Slot *HashedMemoryStorage::find(
+      const Key &key) const {
+    auto mask = slots_.size() - 1;
+    for (auto i = hash(key) & mask;; i = (i + 1) & mask) {
+      auto &slot = slots_[i];
+      if (slot.state == SlotState::Empty) {
+        return nullptr;
+      }
+      if (slot.state == SlotState::Used and slot.key == key) {
+        return &slot;
+      }
+    }
+  }
+
+  void HashedMemoryStorage::putLocked(const Key &key, ByteView value) {
+    // Keep at least 1/8 of slots empty, so probing terminates early
+    if ((occupied_ + 1) * 8 > slots_.size() * 7) {
+      // Grow if half is live, otherwise only drop removed slots
+      rehash(count_ * 2 >= slots_.size() ? slots_.size() * 2 : slots_.size());
+    }
+    auto mask = slots_.size() - 1;
+    Slot *free = nullptr;
+    for (auto i = hash(key) & mask;; i = (i + 1) & mask) {
+      auto &slot = slots_[i];
+      if (slot.state == SlotState::Used and slot.key == key) {
+        garbage_ += slot.value.size;
+        size_ -= slot.value.size;
+        slot.value = allocate(value);
+        size_ += value.size();
+        compact();
+        return;
+      }
+      if (slot.state == SlotState::Removed) {
+        if (free == nullptr) {
+          free = &slot;
+        }
+        continue;
+      }
+      if (slot.state == SlotState::Empty) {
+        if (free == nullptr) {
+          free = &slot;
+          ++occupied_;
+        }
+        break;
+      }
+    }
+    free->key = key;
+    free->value = allocate(value);
+    free->state = SlotState::Used;
+    ++count_;
+    size_ += value.size();
+    if (ordered_.has_value()) {
+      ordered_->emplace(key);
+    }
+  }
+
+  void HashedMemoryStorage::removeLocked(const Key &key) {
+    auto slot = const_cast<Slot *>(find(key));  // NOLINT
+    if (slot == nullptr) {
+      return;
+    }
+    slot->state = SlotState::Removed;
+    --count_;
+    size_ -= slot->value.size;
+    garbage_ += slot->value.size;
+    slot->value = {};
+    if (ordered_.has_value()) {
+      ordered_->erase(key);
+    }
+    compact();
+  }
+
+  void HashedMemoryStorage::rehash(size_t capacity) {
+    auto old = std::exchange(slots_, std::vector<Slot>(capacity));
+    auto mask = capacity - 1;
+    for (auto &slot : old) {
+      if (slot.state != SlotState::Used) {
+        continue;
+      }
+      auto i = hash(slot.key) & mask;
+      while (slots_[i].state != SlotState::Empty) {
+        i = (i + 1) & mask;
+      }
+      slots_[i] = slot;
+    }
+    occupied_ = count_;
+  }
+
+  HashedMemoryStorage::Value HashedMemoryStorage::allocate(ByteView value) {
+    if (value.empty()) {
+      return {};
+    }
+    uint8_t *data = nullptr;
+    if (value.size() > kChunkSize / 2) {
+      // Own chunk is kept before current one
+      auto chunk = std::make_unique<uint8_t[]>(value.size());
+      data = chunk.get();
+      chunks_.insert(chunks_.empty() ? chunks_.end() : std::prev(chunks_.end()),
+                     std::move(chunk));
+    } else {
+      if (chunks_.empty() or chunk_used_ + value.size() > chunk_size_) {
+        chunks_.emplace_back(std::make_unique<uint8_t[]>(kChunkSize));
+        chunk_used_ = 0;
+        chunk_size_ = kChunkSize;
+      }
+      data = chunks_.back().get() + chunk_used_;
+      chunk_used_ += value.size();
+    }
+    std::memcpy(data, value.data(), value.size());
+    return {data, value.size()};
+  }
+
+  void HashedMemoryStorage::compact() {
+    if (garbage_ <= size_ or garbage_ < kChunkSize) {
+      return;
+    }
+    auto old_chunks = std::exchange(chunks_, {});
+    chunk_used_ = 0;
+    chunk_size_ = 0;
+    for (auto &slot : slots_) {
+      if (slot.state == SlotState::Used) {
+        slot.value = allocate(ByteView{slot.value.data, slot.value.size});
+      }
+    }
+    garbage_ = 0;
+  }
+
+}  // namespace lean::storage
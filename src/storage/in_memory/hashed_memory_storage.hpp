@@ -0,0 +1,129 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <vector>
+
+#include <qtils/byte_vec.hpp>
+#include <qtils/outcome.hpp>
+
+#include "storage/buffer_map_types.hpp"
+
+namespace lean::storage {
+
+  /**
+   * Ephemeral storage for shadow simulations and nodes without database.
+   *
+   * Keys of up to `kMaxKeySize` bytes (hashes, slots, predefined keys) are
+   * kept inline in open-addressing hash table, values are copied to arena.
+   * Space of overwritten and removed values is reclaimed by compaction once
+   * it exceeds live data.
+   *
+   * Keys are kept ordered only if `ordered` is set, e.g. for slot lookup.
+   * Otherwise cursor iterates over sorted snapshot of keys made on its
+   * creation.
+   *
+   * Thread safe, values are returned by copy.
+   */
+  class HashedMemoryStorage : public BufferStorage {
+   public:
+    static constexpr size_t kMaxKeySize = 32;
+
+    explicit HashedMemoryStorage(bool ordered);
+
+    [[nodiscard]] outcome::result<ByteVecOrView> get(
+        const ByteView &key) const override;
+
+    [[nodiscard]] outcome::result<std::optional<ByteVecOrView>> tryGet(
+        const ByteView &key) const override;
+
+    outcome::result<void> put(const ByteView &key,
+                              ByteVecOrView &&value) override;
+
+    [[nodiscard]] outcome::result<bool> contains(
+        const ByteView &key) const override;
+
+    outcome::result<void> remove(const ByteView &key) override;
+
+    std::unique_ptr<BufferBatch> batch() override;
+
+    std::unique_ptr<Cursor> cursor() override;
+
+    [[nodiscard]] std::optional<size_t> byteSizeHint() const override;
+
+    /// Write of batch, nullopt value removes key
+    using Write = std::pair<ByteVec, std::optional<ByteVec>>;
+
+    /// Apply writes under single lock
+    outcome::result<void> apply(const std::vector<Write> &writes);
+
+   private:
+    friend class HashedMemoryCursor;
+
+    struct Key {
+      std::array<uint8_t, kMaxKeySize> bytes{};
+      uint8_t size = 0;
+
+      static std::optional<Key> make(qtils::BytesIn key);
+      ByteView view() const {
+        return ByteView{bytes.data(), size};
+      }
+      bool operator==(const Key &other) const {
+        return std::ranges::equal(view(), other.view());
+      }
+      auto operator<=>(const Key &other) const {
+        return std::lexicographical_compare_three_way(
+            bytes.begin(), bytes.begin() + size,
+            other.bytes.begin(), other.bytes.begin() + other.size);
+      }
+    };
+
+    /// Value bytes in arena
+    struct Value {
+      uint8_t *data = nullptr;
+      size_t size = 0;
+    };
+
+    enum class SlotState : uint8_t { Empty, Used, Removed };
+
+    struct Slot {
+      Key key;
+      Value value;
+      SlotState state = SlotState::Empty;
+    };
+
+    static size_t hash(const Key &key);
+    /// Slot holding key, or nullptr
+    const Slot *find(const Key &key) const;
+    void putLocked(const Key &key, ByteView value);
+    void removeLocked(const Key &key);
+    void rehash(size_t capacity);
+    Value allocate(ByteView value);
+    void compact();
+
+    mutable std::shared_mutex mutex_;
+    std::vector<Slot> slots_;
+    /// Used and removed slots, for load factor
+    size_t occupied_ = 0;
+    size_t count_ = 0;
+    /// Bytes of live values
+    size_t size_ = 0;
+    /// Bytes of overwritten and removed values still in arena
+    size_t garbage_ = 0;
+    std::vector<std::unique_ptr<uint8_t[]>> chunks_;
+    size_t chunk_used_ = 0;
+    size_t chunk_size_ = 0;
+    std::optional<std::set<Key>> ordered_;
+  };
+
+}  // namespace lean::storage
@@ -15,7 +15,11 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
+#include <optional>
+#include <tuple>
+#include <vector>
 
 #include "in_memory_storage.hpp"
 #include "storage/buffer_map_types.hpp"
@@ -51,7 +55,56 @@ namespace lean::storage {
           .first->second;
     }
 
+    /**
+     * @brief Create batch applying writes space by space on commit.
+     *
+     * In-memory storage can't fail in the middle, so it is atomic enough.
+     */
+    std::unique_ptr<SpacedBatch> createBatch() override {
+      return std::make_unique<InMemorySpacedBatch>(*this);
+    }
+
    private:
+    class InMemorySpacedBatch : public SpacedBatch {
+     public:
+      explicit InMemorySpacedBatch(InMemorySpacedStorage &storage)
+          : storage_{storage} {}
+
+      outcome::result<void> put(Space space,
+                                const ByteView &key,
+                                ByteVecOrView &&value) override {
+        writes_.emplace_back(
+            space, ByteVec{key}, std::move(value).intoByteVec());
+        return outcome::success();
+      }
+
+      outcome::result<void> remove(Space space, const ByteView &key) override {
+        writes_.emplace_back(space, ByteVec{key}, std::nullopt);
+        return outcome::success();
+      }
+
+      outcome::result<void> commit() override {
+        for (auto &[space, key, value] : writes_) {
+          auto storage = storage_.getSpace(space);
+          if (value.has_value()) {
+            OUTCOME_TRY(storage->put(key, ByteView{*value}));
+          } else {
+            OUTCOME_TRY(storage->remove(key));
+          }
+        }
+        return outcome::success();
+      }
+
+      void clear() override {
+        writes_.clear();
+      }
+
+     private:
+      // NOLINTNEXTLINE(cppcoreguidelines-avoid-const-or-ref-data-members)
+      InMemorySpacedStorage &storage_;
+      std::vector<std::tuple<Space, ByteVec, std::optional<ByteVec>>> writes_;
+    };
+
     /// Map of storage spaces to their corresponding in-memory storages
     std::map<Space, std::shared_ptr<InMemoryStorage>> spaces_;
   };
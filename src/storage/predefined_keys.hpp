@@ -16,4 +16,19 @@ namespace lean::storage {
   inline const qtils::ByteVec kBlockTreeLeavesLookupKey =
       ":lean:block_tree_leaves"_vec;
 
+  /// Slot of oldest finalized block with state kept by pruner
+  inline const qtils::ByteVec kPrunedStateSlotLookupKey =
+      ":lean:pruned_state_slot"_vec;
+
+  /// Blocks pruned by finalization, not removed by pruner yet
+  inline const qtils::ByteVec kMarkedRemovedLookupKey =
+      ":lean:marked_removed"_vec;
+
+  inline const qtils::ByteVec kForkChoiceSnapshotLookupKey =
+      ":lean:fork_choice_snapshot"_vec;
+
+  /// Next missing block of history behind checkpoint sync anchor
+  inline const qtils::ByteVec kBackfillCursorLookupKey =
+      ":lean:backfill_cursor"_vec;
+
 }  // namespace lean::storage
@@ -7,14 +7,17 @@
 #include "storage/rocksdb/rocksdb.hpp"
 
 #include <algorithm>
+#include <array>
 #include <iterator>
 #include <ranges>
 
-#include <app/configuration.hpp>
 #include <qtils/cxx23/ranges/contains.hpp>
 #include <qtils/error_throw.hpp>
 #include <rocksdb/filter_policy.h>
+#include <rocksdb/slice_transform.h>
 #include <rocksdb/table.h>
+#include <rocksdb/utilities/checkpoint.h>
+#include <rocksdb/utilities/table_properties_collectors.h>
 #include <soralog/macro.hpp>
 
 #include "storage/rocksdb/rocksdb_batch.hpp"
@@ -27,11 +30,63 @@
 namespace lean::storage {
   namespace fs = std::filesystem;
 
-  rocksdb::ColumnFamilyOptions configureColumn(uint64_t memory_budget) {
+  using DatabaseConfig = app::Configuration::DatabaseConfig;
+  using Compression = DatabaseConfig::Compression;
+  using SpaceProfile = DatabaseConfig::SpaceProfile;
+
+  rocksdb::CompressionType compressionType(Compression compression) {
+    switch (compression) {
+      case Compression::None:
+        return rocksdb::kNoCompression;
+      case Compression::Lz4:
+        return rocksdb::kLZ4Compression;
+      case Compression::Zstd:
+        return rocksdb::kZSTD;
+    }
+    return rocksdb::kLZ4Compression;
+  }
+
+  /// Sliding window of entries and deletions within it to compact file
+  constexpr size_t kCompactionDeletionWindow = 128;
+  constexpr size_t kCompactionDeletionTrigger = 64;
+
+  rocksdb::ColumnFamilyOptions configureColumn(uint64_t memory_budget,
+                                               const SpaceProfile &profile) {
     rocksdb::ColumnFamilyOptions options;
     options.OptimizeLevelStyleCompaction(memory_budget);
-    auto table_options = RocksDb::tableOptionsConfiguration();
+    // Optimization above sets compression per level, keep it uniform instead
+    options.compression_per_level.clear();
+    options.compression = compressionType(profile.compression);
+    if (profile.compression == Compression::Zstd) {
+      options.bottommost_compression = rocksdb::kZSTD;
+    }
+
+    auto table_options = RocksDb::tableOptionsConfiguration(
+        RocksDb::kDefaultLruCacheSizeMiB, profile.block_size_kib);
+    if (profile.bloom_bits_per_key == 0) {
+      table_options.filter_policy.reset();
+    } else {
+      table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(
+          static_cast<double>(profile.bloom_bits_per_key), false));
+    }
+    if (profile.prefix_length != 0) {
+      options.prefix_extractor.reset(
+          rocksdb::NewFixedPrefixTransform(profile.prefix_length));
+      options.memtable_prefix_bloom_size_ratio = 0.1;
+    }
     options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+    if (profile.blob_files) {
+      options.enable_blob_files = true;
+      options.min_blob_size = profile.min_blob_size;
+      options.blob_compression_type = options.compression;
+      options.enable_blob_garbage_collection = true;
+    }
+
+    // Pruning removes keys in bulk, compact files dense with tombstones
+    options.table_properties_collector_factories.emplace_back(
+        rocksdb::NewCompactOnDeletionCollectorFactory(
+            kCompactionDeletionWindow, kCompactionDeletionTrigger));
     return options;
   }
 
@@ -42,6 +97,7 @@ namespace lean::storage {
       const std::unordered_map<std::string, int32_t> &column_ttl,
       const std::unordered_map<std::string, double> &column_cache_sizes,
       uint64_t memory_budget,
+      const DatabaseConfig &db_config,
       log::Logger &log) {
     double distributed_cache_part = 0;
     size_t count = 0;
@@ -72,29 +128,60 @@ namespace lean::storage {
       } else {
         cache_size = other_spaces_cache_size;
       }
-      auto column_options = configureColumn(cache_size);
+      const auto &profile = db_config.profile(space_name);
+      auto column_options = configureColumn(cache_size, profile);
       column_family_descriptors.emplace_back(space_name, column_options);
-      SL_DEBUG(
-          log,
-          "Column family '{}' configured with ttl={}sec, cache_size={:.0f}Mb",
-          space_name,
-          ttl,
-          static_cast<double>(cache_size) / 1024.0 / 1024.0);
+      SL_DEBUG(log,
+               "Column family '{}' configured with ttl={}sec, "
+               "cache_size={:.0f}Mb, block_size={}KiB, bloom_bits={}, "
+               "compression={}, blob_files={}, prefix_length={}",
+               space_name,
+               ttl,
+               static_cast<double>(cache_size) / 1024.0 / 1024.0,
+               profile.block_size_kib,
+               profile.bloom_bits_per_key,
+               static_cast<int>(profile.compression),
+               profile.blob_files,
+               profile.prefix_length);
     }
   }
 
   RocksDb::RocksDb(qtils::SharedRef<log::LoggingSystem> logsys,
-                   qtils::SharedRef<app::Configuration> app_config)
+                   qtils::SharedRef<app::Configuration> app_config,
+                   std::shared_ptr<metrics::Metrics> metrics)
+      : RocksDb(
+            std::move(logsys), app_config->database(), std::move(metrics)) {}
+
+  RocksDb::RocksDb(qtils::SharedRef<log::LoggingSystem> logsys,
+                   const app::Configuration::DatabaseConfig &config,
+                   std::shared_ptr<metrics::Metrics> metrics)
       : logger_(logsys->getLogger("RocksDB", "storage")) {
     ro_.fill_cache = false;
+    // Cursors iterate across prefixes of columns with prefix extractor,
+    // point reads still use prefix bloom
+    ro_.total_order_seek = true;
 
-    const auto &path = app_config->database().directory;
+    const auto &path = config.directory;
 
     auto options = rocksdb::Options{};
     options.create_if_missing = true;
     options.optimize_filters_for_hits = true;
     options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(
         storage::RocksDb::tableOptionsConfiguration()));
+    if (config.statistics and metrics) {
+      metrics_ = std::make_unique<RocksDbMetrics>(std::move(metrics));
+      metrics_->configure(options);
+    }
+    if (config.critical_io_rate != 0) {
+      critical_io_rate_ = static_cast<int64_t>(config.critical_io_rate);
+      // Flushes are served before compactions within limit
+      rate_limiter_.reset(
+          rocksdb::NewGenericRateLimiter(kRelaxedIoRate,
+                                         100'000,
+                                         10,
+                                         rocksdb::RateLimiter::Mode::kAllIo));
+      options.rate_limiter = rate_limiter_;
+    }
 
     // Setting limit for open rocksdb files to a half of system soft limit
     auto soft_limit = getFdLimit(logger_);
@@ -105,21 +192,34 @@ namespace lean::storage {
     // NOLINTNEXTLINE(cppcoreguidelines-narrowing-conversions)
     options.max_open_files = soft_limit.value() / 2;
 
-    const auto no_db_presented = not exists(path);
-
-    std::error_code ec;
-    create_directories(path, ec);
-    if (ec) {
-      SL_CRITICAL(logger_, "Can't create DB directory: {}", ec);
-      qtils::raise(ec);
-    }
+    const auto &secondary = config.secondary_directory;
+    if (secondary.has_value()) {
+      // Database of other process, which may be running or not
+      if (not is_directory(path)) {
+        SL_CRITICAL(logger_, "No database at {}", path.native());
+        qtils::raise(StorageError::IO_ERROR);
+      }
+      options.create_if_missing = false;
+      // Secondary instance keeps all table files open
+      options.max_open_files = -1;
+      if (auto res = createDirectory(*secondary, logger_); res.has_error()) {
+        qtils::raise(res.error());
+      }
+    } else {
+      std::error_code ec;
+      create_directories(path, ec);
+      if (ec) {
+        SL_CRITICAL(logger_, "Can't create DB directory: {}", ec);
+        qtils::raise(ec);
+      }
 
-    if (auto res = createDirectory(path, logger_); res.has_error()) {
-      SL_CRITICAL(logger_,
-                  "Can't create DB directory ({}): {}",
-                  path.native(),
-                  res.error());
-      qtils::raise(ec);
+      if (auto res = createDirectory(path, logger_); res.has_error()) {
+        SL_CRITICAL(logger_,
+                    "Can't create DB directory ({}): {}",
+                    path.native(),
+                    res.error());
+        qtils::raise(res.error());
+      }
     }
 
     std::vector<std::string> existing_families;
@@ -139,8 +239,15 @@ namespace lean::storage {
         | std::views::transform([](int i) -> std::string {
             return std::string(spaceName(static_cast<Space>(i)));
           });
-    std::ranges::copy(required_families,
-                      std::inserter(all_families, all_families.end()));
+    if (secondary.has_value()) {
+      // Column families are created by primary instance only
+      std::ranges::copy(existing_families,
+                        std::inserter(all_families, all_families.end()));
+      existing_families.clear();
+    } else {
+      std::ranges::copy(required_families,
+                        std::inserter(all_families, all_families.end()));
+    }
 
     for (auto &existing_family : existing_families) {
       auto [_, was_inserted] = all_families.insert(existing_family);
@@ -162,7 +269,7 @@ namespace lean::storage {
         // {"trie_node", 0.9}  // 90%
     };
 
-    const auto memory_budget = app_config->database().cache_size;
+    const auto memory_budget = config.cache_size;
 
     std::vector<rocksdb::ColumnFamilyDescriptor> column_family_descriptors;
     configureColumnFamilies(column_family_descriptors,
@@ -170,12 +277,22 @@ namespace lean::storage {
                             column_ttl,
                             column_cache_size,
                             memory_budget,
+                            config,
                             logger_);
 
-    options.create_missing_column_families = true;
-
-    qtils::raise_on_err(openDatabase(
-        options, path, column_family_descriptors, *this, logger_));
+    options.create_missing_column_families = not secondary.has_value();
+
+    if (secondary.has_value()) {
+      qtils::raise_on_err(openSecondary(options,
+                                        path,
+                                        *secondary,
+                                        column_family_descriptors,
+                                        *this,
+                                        logger_));
+    } else {
+      qtils::raise_on_err(openDatabase(
+          options, path, column_family_descriptors, *this, logger_));
+    }
 
     // Print size of each column family
     SL_VERBOSE(logger_, "Current column family sizes:");
@@ -243,6 +360,67 @@ namespace lean::storage {
     return outcome::success();
   }
 
+  outcome::result<void> RocksDb::openSecondary(
+      const rocksdb::Options &options,
+      const std::filesystem::path &path,
+      const std::filesystem::path &secondary_path,
+      const std::vector<rocksdb::ColumnFamilyDescriptor>
+          &column_family_descriptors,
+      RocksDb &rocks_db,
+      log::Logger &log) {
+    const auto status =
+        rocksdb::DB::OpenAsSecondary(options,
+                                     path.native(),
+                                     secondary_path.native(),
+                                     column_family_descriptors,
+                                     &rocks_db.column_family_handles_,
+                                     &rocks_db.db_);
+    if (not status.ok()) {
+      SL_ERROR(log,
+               "Can't open database in {} as secondary: {}",
+               path.native(),
+               status.ToString());
+      return status_as_error(status, log);
+    }
+    rocks_db.secondary_ = true;
+    return outcome::success();
+  }
+
+  outcome::result<void> RocksDb::catchUp() {
+    if (not secondary_) {
+      return outcome::success();
+    }
+    auto status = db_->TryCatchUpWithPrimary();
+    if (not status.ok()) {
+      SL_WARN(logger_, "Can't catch up with primary: {}", status.ToString());
+      return status_as_error(status, logger_);
+    }
+    return outcome::success();
+  }
+
+  outcome::result<void> RocksDb::checkpoint(
+      const std::filesystem::path &directory) {
+    if (secondary_) {
+      return StorageError::NOT_SUPPORTED;
+    }
+    rocksdb::Checkpoint *raw = nullptr;
+    auto status = rocksdb::Checkpoint::Create(db_, &raw);
+    std::unique_ptr<rocksdb::Checkpoint> checkpoint{raw};
+    if (status.ok()) {
+      // Memtables are flushed, so checkpoint doesn't need WAL replay
+      status = checkpoint->CreateCheckpoint(directory.native());
+    }
+    if (not status.ok()) {
+      SL_WARN(logger_,
+              "Can't create checkpoint in {}: {}",
+              directory.native(),
+              status.ToString());
+      return status_as_error(status, logger_);
+    }
+    SL_INFO(logger_, "Created checkpoint in {}", directory.native());
+    return outcome::success();
+  }
+
   std::shared_ptr<BufferStorage> RocksDb::getSpace(Space space) {
     if (spaces_.contains(space)) {
       return spaces_[space];
@@ -262,6 +440,64 @@ namespace lean::storage {
     return space_ptr;
   }
 
+  std::unique_ptr<SpacedBatch> RocksDb::createBatch() {
+    return std::make_unique<RocksDbSpacedBatch>(weak_from_this(), logger_);
+  }
+
+  SpacedStorage::MemoryUsage RocksDb::memoryUsage() const {
+    static const std::array<std::pair<const char *, const char *>, 3>
+        kProperties{{
+            {"rocksdb_memtables", "rocksdb.cur-size-all-mem-tables"},
+            {"rocksdb_block_cache", "rocksdb.block-cache-usage"},
+            {"rocksdb_table_readers", "rocksdb.estimate-table-readers-mem"},
+        }};
+    MemoryUsage usage;
+    for (auto &[name, property] : kProperties) {
+      uint64_t value = 0;
+      if (db_->GetAggregatedIntProperty(property, &value)) {
+        usage.emplace_back(name, value);
+      }
+    }
+    return usage;
+  }
+
+  void RocksDb::updateMetrics() const {
+    if (metrics_) {
+      metrics_->update(*db_, column_family_handles_);
+    }
+  }
+
+  void RocksDb::throttleBackgroundIo(bool throttle) {
+    if (throttle == io_throttled_) {
+      return;
+    }
+    io_throttled_ = throttle;
+    int64_t io_bytes = 0;
+    if (rate_limiter_) {
+      rate_limiter_->SetBytesPerSecond(throttle ? critical_io_rate_
+                                                : kRelaxedIoRate);
+      io_bytes = rate_limiter_->GetTotalBytesThrough();
+    }
+    if (metrics_) {
+      metrics_->throttled(throttle, io_bytes - io_bytes_);
+    }
+    io_bytes_ = io_bytes;
+  }
+
+  outcome::result<RocksDb::ColumnFamilyHandlePtr> RocksDb::getColumnHandle(
+      Space space) const {
+    auto space_name = spaceName(space);
+    auto column = std::ranges::find_if(
+        column_family_handles_,
+        [&space_name](const ColumnFamilyHandlePtr &handle) {
+          return handle->GetName() == space_name;
+        });
+    if (column_family_handles_.end() == column) {
+      return StorageError::INVALID_ARGUMENT;
+    }
+    return *column;
+  }
+
   void RocksDb::dropColumn(lean::storage::Space space) {
     auto space_name = spaceName(space);
     auto column_it = std::ranges::find_if(
@@ -389,7 +625,9 @@ namespace lean::storage {
 
   outcome::result<bool> RocksDbSpace::contains(const ByteView &key) const {
     OUTCOME_TRY(rocks, use());
-    std::string value;
+    RocksDbMetrics::Sample sample{
+        rocks->metrics_.get(), column_->GetName(), RocksDbMetrics::Op::Get};
+    rocksdb::PinnableSlice value;
     auto status = rocks->db_->Get(rocks->ro_, column_, make_slice(key), &value);
     if (status.ok()) {
       return true;
@@ -404,13 +642,13 @@ namespace lean::storage {
 
   outcome::result<ByteVecOrView> RocksDbSpace::get(const ByteView &key) const {
     OUTCOME_TRY(rocks, use());
-    std::string value;
+    RocksDbMetrics::Sample sample{
+        rocks->metrics_.get(), column_->GetName(), RocksDbMetrics::Op::Get};
+    rocksdb::PinnableSlice value;
     auto status = rocks->db_->Get(rocks->ro_, column_, make_slice(key), &value);
     if (status.ok()) {
-      // cannot move string content to a buffer
-      return ByteVec(
-          reinterpret_cast<uint8_t *>(value.data()),                  // NOLINT
-          reinterpret_cast<uint8_t *>(value.data()) + value.size());  // NOLINT
+      auto data = reinterpret_cast<const uint8_t *>(value.data());  // NOLINT
+      return ByteVec(data, data + value.size());
     }
     return status_as_error(status, logger_);
   }
@@ -418,13 +656,14 @@ namespace lean::storage {
   outcome::result<std::optional<ByteVecOrView>> RocksDbSpace::tryGet(
       const ByteView &key) const {
     OUTCOME_TRY(rocks, use());
-    std::string value;
+    RocksDbMetrics::Sample sample{
+        rocks->metrics_.get(), column_->GetName(), RocksDbMetrics::Op::Get};
+    rocksdb::PinnableSlice value;
     auto status = rocks->db_->Get(rocks->ro_, column_, make_slice(key), &value);
     if (status.ok()) {
-      auto buf = ByteVec(
-          reinterpret_cast<uint8_t *>(value.data()),                  // NOLINT
-          reinterpret_cast<uint8_t *>(value.data()) + value.size());  // NOLINT
-      return std::make_optional(ByteVecOrView(std::move(buf)));
+      auto data = reinterpret_cast<const uint8_t *>(value.data());  // NOLINT
+      return std::make_optional(
+          ByteVecOrView(ByteVec(data, data + value.size())));
     }
 
     if (status.IsNotFound()) {
@@ -434,9 +673,66 @@ namespace lean::storage {
     return status_as_error(status, logger_);
   }
 
+  outcome::result<std::vector<std::optional<ByteVecOrView>>>
+  RocksDbSpace::tryGetMany(std::span<const ByteView> keys) const {
+    OUTCOME_TRY(rocks, use());
+    RocksDbMetrics::Sample sample{rocks->metrics_.get(),
+                                  column_->GetName(),
+                                  RocksDbMetrics::Op::MultiGet};
+    std::vector<rocksdb::Slice> slices;
+    slices.reserve(keys.size());
+    for (auto &key : keys) {
+      slices.emplace_back(make_slice(key));
+    }
+    std::vector<rocksdb::PinnableSlice> values(keys.size());
+    std::vector<rocksdb::Status> statuses(keys.size());
+    rocks->db_->MultiGet(rocks->ro_,
+                         column_,
+                         keys.size(),
+                         slices.data(),
+                         values.data(),
+                         statuses.data());
+    std::vector<std::optional<ByteVecOrView>> result;
+    result.reserve(keys.size());
+    for (auto &&[value, status] : std::views::zip(values, statuses)) {
+      if (status.IsNotFound()) {
+        result.emplace_back(std::nullopt);
+        continue;
+      }
+      if (not status.ok()) {
+        return status_as_error(status, logger_);
+      }
+      auto data = reinterpret_cast<const uint8_t *>(value.data());  // NOLINT
+      result.emplace_back(ByteVec(data, data + value.size()));
+    }
+    return result;
+  }
+
+  outcome::result<bool> RocksDbSpace::tryRead(
+      const ByteView &key,
+      const std::function<outcome::result<void>(const ByteVecOrView &)> &read)
+      const {
+    OUTCOME_TRY(rocks, use());
+    RocksDbMetrics::Sample sample{
+        rocks->metrics_.get(), column_->GetName(), RocksDbMetrics::Op::Get};
+    rocksdb::PinnableSlice value;
+    auto status = rocks->db_->Get(rocks->ro_, column_, make_slice(key), &value);
+    if (status.IsNotFound()) {
+      return false;
+    }
+    if (not status.ok()) {
+      return status_as_error(status, logger_);
+    }
+    auto data = reinterpret_cast<const uint8_t *>(value.data());  // NOLINT
+    OUTCOME_TRY(read(ByteVecOrView{ByteView{data, value.size()}}));
+    return true;
+  }
+
   outcome::result<void> RocksDbSpace::put(const ByteView &key,
                                           ByteVecOrView &&value) {
     OUTCOME_TRY(rocks, use());
+    RocksDbMetrics::Sample sample{
+        rocks->metrics_.get(), column_->GetName(), RocksDbMetrics::Op::Write};
     auto status = rocks->db_->Put(
         rocks->wo_, column_, make_slice(key), make_slice(std::move(value)));
     if (status.ok()) {
@@ -448,6 +744,8 @@ namespace lean::storage {
 
   outcome::result<void> RocksDbSpace::remove(const ByteView &key) {
     OUTCOME_TRY(rocks, use());
+    RocksDbMetrics::Sample sample{
+        rocks->metrics_.get(), column_->GetName(), RocksDbMetrics::Op::Write};
     auto status = rocks->db_->Delete(rocks->wo_, column_, make_slice(key));
     if (status.ok()) {
       return outcome::success();
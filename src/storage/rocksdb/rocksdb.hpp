@@ -9,18 +9,22 @@
 #include <filesystem>
 
 #include <boost/container/flat_map.hpp>
+#include <boost/di.hpp>
 #include <qtils/shared_ref.hpp>
 #include <rocksdb/db.h>
+#include <rocksdb/rate_limiter.h>
 #include <rocksdb/table.h>
 #include <rocksdb/utilities/db_ttl.h>
 
+#include "app/configuration.hpp"
 #include "log/logger.hpp"
 #include "storage/buffer_map_types.hpp"
+#include "storage/rocksdb/rocksdb_metrics.hpp"
 #include "storage/spaced_storage.hpp"
 #include "utils/ctor_limiters.hpp"
 
-namespace lean::app {
-  class Configuration;
+namespace lean::metrics {
+  class Metrics;
 }
 
 namespace lean::storage {
@@ -32,17 +36,56 @@ namespace lean::storage {
     using ColumnFamilyHandlePtr = rocksdb::ColumnFamilyHandle *;
 
    public:
+    BOOST_DI_INJECT_TRAITS(qtils::SharedRef<log::LoggingSystem>,
+                           qtils::SharedRef<app::Configuration>,
+                           std::shared_ptr<metrics::Metrics>);
+
+    /// Statistics are exported if `database.statistics` is set and
+    /// `metrics` is given
+    RocksDb(qtils::SharedRef<log::LoggingSystem> logsys,
+            qtils::SharedRef<app::Configuration> app_config,
+            std::shared_ptr<metrics::Metrics> metrics);
+
+    /// Database of `config`, e.g. other node database to read from
     RocksDb(qtils::SharedRef<log::LoggingSystem> logsys,
-            qtils::SharedRef<app::Configuration> app_config);
+            const app::Configuration::DatabaseConfig &config,
+            std::shared_ptr<metrics::Metrics> metrics);
 
     ~RocksDb() override;
 
     static constexpr uint32_t kDefaultStateCacheSizeMiB = 512;
     static constexpr uint32_t kDefaultLruCacheSizeMiB = 512;
     static constexpr uint32_t kDefaultBlockSizeKiB = 32;
+    /// Background I/O limit out of critical intervals, high enough not to
+    /// slow compaction down
+    static constexpr int64_t kRelaxedIoRate = int64_t{4} << 30;
 
     std::shared_ptr<BufferStorage> getSpace(Space space) override;
 
+    std::unique_ptr<SpacedBatch> createBatch() override;
+
+    /// Memtables, block caches and table readers of all column families
+    MemoryUsage memoryUsage() const override;
+
+    /// Column family properties and statistics, if enabled
+    void updateMetrics() const override;
+
+    /// Switch rate limiter of flushes and compactions between
+    /// `database.critical_io_rate` and `kRelaxedIoRate`
+    void throttleBackgroundIo(bool throttle) override;
+
+    /**
+     * Read writes of primary instance since open or previous call, if
+     * opened as secondary by `database.secondary_directory`.
+     * Secondary instance is read-only.
+     */
+    outcome::result<void> catchUp();
+
+    /// RocksDB checkpoint, SST files are hard-linked if `directory` is on
+    /// same filesystem. Not supported by secondary instance.
+    outcome::result<void> checkpoint(
+        const std::filesystem::path &directory) override;
+
     /**
      * Implementation-specific way to erase the whole space data.
      * Not exposed at SpacedStorage level as only used in pruner.
@@ -62,6 +105,7 @@ namespace lean::storage {
 
     friend class RocksDbSpace;
     friend class RocksDbBatch;
+    friend class RocksDbSpacedBatch;
 
    private:
     struct DatabaseGuard {
@@ -84,6 +128,8 @@ namespace lean::storage {
       log::Logger log_;
     };
 
+    outcome::result<ColumnFamilyHandlePtr> getColumnHandle(Space space) const;
+
     static outcome::result<void> createDirectory(
         const std::filesystem::path &absolute_path, log::Logger &log);
 
@@ -95,11 +141,29 @@ namespace lean::storage {
         RocksDb &rocks_db,
         log::Logger &log);
 
+    static outcome::result<void> openSecondary(
+        const rocksdb::Options &options,
+        const std::filesystem::path &path,
+        const std::filesystem::path &secondary_path,
+        const std::vector<rocksdb::ColumnFamilyDescriptor>
+            &column_family_descriptors,
+        RocksDb &rocks_db,
+        log::Logger &log);
+
     rocksdb::DB *db_{};
+    bool secondary_ = false;
     std::vector<ColumnFamilyHandlePtr> column_family_handles_;
     boost::container::flat_map<Space, std::shared_ptr<BufferStorage>> spaces_;
     rocksdb::ReadOptions ro_;
     rocksdb::WriteOptions wo_;
+    /// Null if statistics are disabled
+    std::unique_ptr<RocksDbMetrics> metrics_;
+    /// Null if background I/O is not throttled
+    std::shared_ptr<rocksdb::RateLimiter> rate_limiter_;
+    int64_t critical_io_rate_ = 0;
+    bool io_throttled_ = false;
+    /// Bytes through rate limiter at last switch
+    int64_t io_bytes_ = 0;
     log::Logger logger_;
   };
 
@@ -124,6 +188,15 @@ namespace lean::storage {
     outcome::result<std::optional<ByteVecOrView>> tryGet(
         const ByteView &key) const override;
 
+    outcome::result<std::vector<std::optional<ByteVecOrView>>> tryGetMany(
+        std::span<const ByteView> keys) const override;
+
+    /// Value is read from pinned block cache memory, without copy
+    outcome::result<bool> tryRead(
+        const ByteView &key,
+        const std::function<outcome::result<void>(const ByteVecOrView &)>
+            &read) const override;
+
     outcome::result<void> put(const ByteView &key,
                               ByteVecOrView &&value) override;
 
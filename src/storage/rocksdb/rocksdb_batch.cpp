@@ -30,6 +30,9 @@ namespace lean::storage {
     if (!rocks) {
       return StorageError::STORAGE_GONE;
     }
+    RocksDbMetrics::Sample sample{rocks->metrics_.get(),
+                                  db_.column_->GetName(),
+                                  RocksDbMetrics::Op::Write};
     auto status = rocks->db_->Write(rocks->wo_, &batch_);
     if (status.ok()) {
       return outcome::success();
@@ -41,4 +44,50 @@ namespace lean::storage {
   void RocksDbBatch::clear() {
     batch_.Clear();
   }
+
+  RocksDbSpacedBatch::RocksDbSpacedBatch(std::weak_ptr<RocksDb> db,
+                                         log::Logger logger)
+      : db_(std::move(db)), logger_(std::move(logger)) {}
+
+  outcome::result<void> RocksDbSpacedBatch::put(Space space,
+                                                const ByteView &key,
+                                                ByteVecOrView &&value) {
+    auto rocks = db_.lock();
+    if (!rocks) {
+      return StorageError::STORAGE_GONE;
+    }
+    OUTCOME_TRY(column, rocks->getColumnHandle(space));
+    batch_.Put(column, make_slice(key), make_slice(std::move(value)));
+    return outcome::success();
+  }
+
+  outcome::result<void> RocksDbSpacedBatch::remove(Space space,
+                                                   const ByteView &key) {
+    auto rocks = db_.lock();
+    if (!rocks) {
+      return StorageError::STORAGE_GONE;
+    }
+    OUTCOME_TRY(column, rocks->getColumnHandle(space));
+    batch_.Delete(column, make_slice(key));
+    return outcome::success();
+  }
+
+  outcome::result<void> RocksDbSpacedBatch::commit() {
+    auto rocks = db_.lock();
+    if (!rocks) {
+      return StorageError::STORAGE_GONE;
+    }
+    RocksDbMetrics::Sample sample{
+        rocks->metrics_.get(), "batch", RocksDbMetrics::Op::Write};
+    auto status = rocks->db_->Write(rocks->wo_, &batch_);
+    if (status.ok()) {
+      return outcome::success();
+    }
+
+    return status_as_error(status, logger_);
+  }
+
+  void RocksDbSpacedBatch::clear() {
+    batch_.Clear();
+  }
 }  // namespace lean::storage
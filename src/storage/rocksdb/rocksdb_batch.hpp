@@ -34,4 +34,29 @@ namespace lean::storage {
     log::Logger &logger_;
     rocksdb::WriteBatch batch_;
   };
+
+  /**
+   * Batch over several column families, written to WAL as one record.
+   */
+  class RocksDbSpacedBatch : public SpacedBatch {
+   public:
+    ~RocksDbSpacedBatch() override = default;
+
+    RocksDbSpacedBatch(std::weak_ptr<RocksDb> db, log::Logger logger);
+
+    outcome::result<void> put(Space space,
+                              const ByteView &key,
+                              ByteVecOrView &&value) override;
+
+    outcome::result<void> remove(Space space, const ByteView &key) override;
+
+    outcome::result<void> commit() override;
+
+    void clear() override;
+
+   private:
+    std::weak_ptr<RocksDb> db_;
+    log::Logger logger_;
+    rocksdb::WriteBatch batch_;
+  };
 }  // namespace lean::storage
@@ -0,0 +1,183 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/rocksdb/rocksdb_metrics.hpp"
+
+#include <map>
+#include <optional>
+#include <string>
+
+#include <rocksdb/perf_context.h>
+#include <rocksdb/perf_level.h>
+
+#include "metrics/metrics.hpp"
+
+namespace lean::storage {
+
+  namespace {
+    constexpr double kMicrosInSecond = 1e6;
+    constexpr double kNanosInSecond = 1e9;
+    /// RocksDB reports compaction stats in GiB
+    constexpr double kBytesInGiB = double(uint64_t{1} << 30);
+
+    const char *phaseName(bool throttled) {
+      return throttled ? "critical" : "relaxed";
+    }
+
+    const char *opName(RocksDbMetrics::Op op) {
+      switch (op) {
+        case RocksDbMetrics::Op::Get:
+          return "get";
+        case RocksDbMetrics::Op::MultiGet:
+          return "multi_get";
+        case RocksDbMetrics::Op::Write:
+          return "write";
+      }
+      return "unknown";
+    }
+
+    /// Value of `rocksdb.cfstats` map property entry, if present
+    std::optional<double> mapValue(
+        const std::map<std::string, std::string> &stats,
+        const std::string &key) {
+      auto it = stats.find(key);
+      if (it == stats.end()) {
+        return std::nullopt;
+      }
+      try {
+        return std::stod(it->second);
+      } catch (const std::exception &) {
+        return std::nullopt;
+      }
+    }
+  }  // namespace
+
+  RocksDbMetrics::RocksDbMetrics(qtils::SharedRef<metrics::Metrics> metrics)
+      : metrics_{std::move(metrics)},
+        statistics_{rocksdb::CreateDBStatistics()} {}
+
+  void RocksDbMetrics::configure(rocksdb::Options &options) const {
+    options.statistics = statistics_;
+  }
+
+  void RocksDbMetrics::update(
+      rocksdb::DB &db,
+      std::span<rocksdb::ColumnFamilyHandle *const> columns) const {
+    for (auto *column : columns) {
+      const auto &space = column->GetName();
+      uint64_t value = 0;
+      if (db.GetIntProperty(
+              column, rocksdb::DB::Properties::kCurSizeAllMemTables, &value)) {
+        metrics_->db_memtable_bytes({{"space", space}})->set(value);
+      }
+      if (db.GetIntProperty(
+              column,
+              rocksdb::DB::Properties::kEstimatePendingCompactionBytes,
+              &value)) {
+        metrics_->db_pending_compaction_bytes({{"space", space}})->set(value);
+      }
+      std::map<std::string, std::string> stats;
+      if (not db.GetMapProperty(
+              column, rocksdb::DB::Properties::kCFStats, &stats)) {
+        continue;
+      }
+      auto compaction = [&](const char *direction, const std::string &key) {
+        if (auto gib = mapValue(stats, key)) {
+          metrics_
+              ->db_compaction_bytes({{"space", space},
+                                     {"direction", direction}})
+              ->set(gib.value() * kBytesInGiB);
+        }
+      };
+      compaction("read", "compaction.Sum.ReadGB");
+      compaction("write", "compaction.Sum.WriteGB");
+      auto stalls = [&](const char *kind, const std::string &key) {
+        if (auto count = mapValue(stats, key)) {
+          metrics_->db_write_stalls({{"space", space}, {"kind", kind}})
+              ->set(count.value());
+        }
+      };
+      stalls("slowdown", "io_stalls.total_slowdown");
+      stalls("stop", "io_stalls.total_stop");
+    }
+
+    auto ticker = [&](rocksdb::Tickers type) {
+      return static_cast<double>(statistics_->getAndResetTickerCount(type));
+    };
+    updateStalls();
+    metrics_->db_block_cache_total({{"result", "hit"}})
+        ->inc(ticker(rocksdb::BLOCK_CACHE_HIT));
+    metrics_->db_block_cache_total({{"result", "miss"}})
+        ->inc(ticker(rocksdb::BLOCK_CACHE_MISS));
+    metrics_->db_wal_syncs_total()->inc(ticker(rocksdb::WAL_FILE_SYNCED));
+  }
+
+  void RocksDbMetrics::throttled(bool throttle, int64_t io_bytes) const {
+    metrics_->db_background_io_bytes_total({{"phase", phaseName(throttled_)}})
+        ->inc(static_cast<double>(io_bytes));
+    updateStalls();
+    throttled_ = throttle;
+  }
+
+  void RocksDbMetrics::updateStalls() const {
+    auto seconds =
+        static_cast<double>(
+            statistics_->getAndResetTickerCount(rocksdb::STALL_MICROS))
+        / kMicrosInSecond;
+    metrics_->db_stall_seconds_total()->inc(seconds);
+    metrics_->db_phase_stall_seconds_total({{"phase", phaseName(throttled_)}})
+        ->inc(seconds);
+  }
+
+  RocksDbMetrics::Sample::Sample(const RocksDbMetrics *metrics,
+                                 std::string_view space,
+                                 Op op)
+      : space_{space}, op_{op} {
+    thread_local uint32_t operations = 0;
+    if (metrics == nullptr or ++operations % kSampleInterval != 0) {
+      return;
+    }
+    metrics_ = metrics;
+    rocksdb::SetPerfLevel(rocksdb::PerfLevel::kEnableTimeExceptForMutex);
+    rocksdb::get_perf_context()->Reset();
+    start_ = std::chrono::steady_clock::now();
+  }
+
+  RocksDbMetrics::Sample::~Sample() {
+    if (metrics_ == nullptr) {
+      return;
+    }
+    auto elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start_)
+                       .count();
+    rocksdb::SetPerfLevel(rocksdb::PerfLevel::kDisable);
+    const auto &perf = *rocksdb::get_perf_context();
+    auto &metrics = *metrics_->metrics_;
+    std::string space{space_};
+    metrics
+        .db_operation_seconds({{"space", space}, {"op", opName(op_)}})
+        ->observe(elapsed);
+    if (op_ == Op::Write) {
+      auto stage = [&](const char *name, uint64_t nanos) {
+        metrics
+            .db_write_stage_seconds_total({{"space", space}, {"stage", name}})
+            ->inc(static_cast<double>(nanos) / kNanosInSecond);
+      };
+      stage("wal", perf.write_wal_time);
+      stage("memtable", perf.write_memtable_time);
+      stage("delay", perf.write_delay_time);
+      return;
+    }
+    auto lookups = [&](const char *result, uint64_t count) {
+      metrics
+          .db_block_cache_lookups_total({{"space", space}, {"result", result}})
+          ->inc(static_cast<double>(count));
+    };
+    lookups("hit", perf.block_cache_hit_count);
+    lookups("miss", perf.block_read_count);
+  }
+
+}  // namespace lean::storage
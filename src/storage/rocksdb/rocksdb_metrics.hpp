@@ -0,0 +1,85 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <span>
+#include <string_view>
+
+#include <qtils/shared_ref.hpp>
+#include <rocksdb/db.h>
+#include <rocksdb/statistics.h>
+
+namespace lean::metrics {
+  class Metrics;
+}  // namespace lean::metrics
+
+namespace lean::storage {
+
+  /**
+   * Exports RocksDB internals to metrics, enabled by `database.statistics`.
+   *
+   * Every `kSampleInterval`th operation of thread runs with perf context.
+   * Its duration, block cache hits and misses of reads, and WAL, memtable and
+   * delay time of writes are reported by space. Column family properties and
+   * `rocksdb::Statistics` tickers are exported periodically. Background I/O
+   * and write stalls are also reported by slot phase, critical or relaxed.
+   */
+  class RocksDbMetrics {
+   public:
+    static constexpr uint32_t kSampleInterval = 16;
+
+    enum class Op : uint8_t { Get, MultiGet, Write };
+
+    explicit RocksDbMetrics(qtils::SharedRef<metrics::Metrics> metrics);
+
+    /// Enable statistics of database opened with `options`
+    void configure(rocksdb::Options &options) const;
+
+    /// Export column family properties and tickers gathered since last call
+    void update(rocksdb::DB &db,
+                std::span<rocksdb::ColumnFamilyHandle *const> columns) const;
+
+    /**
+     * Account phase which ends, as background I/O is throttled or not.
+     * @param io_bytes - bytes through rate limiter during ended phase
+     */
+    void throttled(bool throttle, int64_t io_bytes) const;
+
+    /**
+     * Measures operation with perf context, if it is sampled.
+     * `space` is column family name, or "batch" for writes to several.
+     */
+    class Sample {
+     public:
+      Sample(const RocksDbMetrics *metrics, std::string_view space, Op op);
+      ~Sample();
+
+      Sample(const Sample &) = delete;
+      Sample &operator=(const Sample &) = delete;
+
+     private:
+      /// Null if operation is not sampled
+      const RocksDbMetrics *metrics_ = nullptr;
+      std::string_view space_;
+      Op op_;
+      std::chrono::steady_clock::time_point start_;
+    };
+
+   private:
+    /// Export stall time since last call, in total and of current phase
+    void updateStalls() const;
+
+    qtils::SharedRef<metrics::Metrics> metrics_;
+    std::shared_ptr<rocksdb::Statistics> statistics_;
+    /// Whether current phase is critical
+    mutable std::atomic_bool throttled_ = false;
+  };
+
+}  // namespace lean::storage
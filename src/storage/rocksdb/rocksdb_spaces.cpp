@@ -24,6 +24,10 @@ namespace lean::storage {
       "signature",
       "extrinsic",
       "state",
+      "state_diff",
+      "fork_choice",
+      "subtree",
+      "peer",
   };
   constexpr std::span<const std::string_view> kNames = kNamesArr;
 
@@ -15,13 +15,40 @@
 
 #pragma once
 
+#include <filesystem>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "storage/buffer_map_types.hpp"
 #include "storage/spaces.hpp"
+#include "storage/storage_error.hpp"
 
 namespace lean::storage {
 
+  /**
+   * @class SpacedBatch
+   * @brief Batch of writes to several storage spaces.
+   *
+   * Accumulated writes are applied together on commit, atomically if backend
+   * supports it.
+   */
+  class SpacedBatch {
+   public:
+    virtual ~SpacedBatch() = default;
+
+    virtual outcome::result<void> put(Space space,
+                                      const ByteView &key,
+                                      ByteVecOrView &&value) = 0;
+
+    virtual outcome::result<void> remove(Space space, const ByteView &key) = 0;
+
+    virtual outcome::result<void> commit() = 0;
+
+    virtual void clear() = 0;
+  };
+
   /**
    * @class SpacedStorage
    * @brief Abstract interface for accessing different logical storage spaces.
@@ -41,6 +68,43 @@ namespace lean::storage {
      * @return a pointer buffer storage for a space
      */
     virtual std::shared_ptr<BufferStorage> getSpace(Space space) = 0;
+
+    /**
+     * Create batch for writing to several spaces at once
+     * @return an empty batch
+     */
+    virtual std::unique_ptr<SpacedBatch> createBatch() = 0;
+
+    /// Estimated memory in bytes by component, e.g. memtables
+    using MemoryUsage = std::vector<std::pair<std::string, size_t>>;
+
+    /**
+     * Estimate memory used by storage, for memory accounting
+     * @return memory used by each component, empty if unknown
+     */
+    virtual MemoryUsage memoryUsage() const {
+      return {};
+    }
+
+    /// Export internal statistics to metrics, if storage collects any.
+    /// Called periodically.
+    virtual void updateMetrics() const {}
+
+    /**
+     * Limit background I/O, e.g. compaction, during latency critical
+     * intervals of slot, or lift limit after them.
+     * Called on each slot interval.
+     */
+    virtual void throttleBackgroundIo(bool throttle) {}
+
+    /**
+     * Consistent copy of storage in new `directory`, made while storage
+     * keeps being written to, e.g. for snapshot of node database.
+     */
+    virtual outcome::result<void> checkpoint(
+        const std::filesystem::path &directory) {
+      return StorageError::NOT_SUPPORTED;
+    }
   };
 
 }  // namespace lean::storage
@@ -37,6 +37,10 @@ namespace lean::storage {
     Signature,
     Body,
     State,
+    StateDiff,  ///< Per-block state deltas against parent state
+    ForkChoice,  ///< Snapshot of fork choice store for fast restart
+    Subtree,     ///< State subtrees by hash tree root, shared by states
+    Peer,        ///< Known network peers, to reconnect after restart
     // ... append here
 
     Total  ///< Total number of defined spaces (must be last)
@@ -0,0 +1,447 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/write_behind_storage.hpp"
+
+#include <iterator>
+#include <utility>
+
+#include <soralog/macro.hpp>
+
+#include "storage/storage_error.hpp"
+#include "utils/memory_usage.hpp"
+#include "utils/thread_placement.hpp"
+
+namespace lean::storage {
+
+  /// Batch of writes, queued as one group on commit
+  class WriteBehindBatch : public SpacedBatch {
+   public:
+    explicit WriteBehindBatch(std::weak_ptr<WriteBehindStorage> storage)
+        : storage_{std::move(storage)} {}
+
+    outcome::result<void> put(Space space,
+                              const ByteView &key,
+                              ByteVecOrView &&value) override {
+      writes_.emplace_back(WriteBehindStorage::Write{
+          .space = space,
+          .key = ByteVec{key},
+          .value = std::move(value).intoByteVec(),
+      });
+      return outcome::success();
+    }
+
+    outcome::result<void> remove(Space space, const ByteView &key) override {
+      writes_.emplace_back(WriteBehindStorage::Write{
+          .space = space,
+          .key = ByteVec{key},
+          .value = std::nullopt,
+      });
+      return outcome::success();
+    }
+
+    outcome::result<void> commit() override {
+      auto storage = storage_.lock();
+      if (not storage) {
+        return StorageError::STORAGE_GONE;
+      }
+      storage->enqueue(std::exchange(writes_, {}));
+      return outcome::success();
+    }
+
+    void clear() override {
+      writes_.clear();
+    }
+
+   private:
+    std::weak_ptr<WriteBehindStorage> storage_;
+    std::vector<WriteBehindStorage::Write> writes_;
+  };
+
+  /// Batch of single space
+  class WriteBehindSpaceBatch : public BufferBatch {
+   public:
+    WriteBehindSpaceBatch(std::weak_ptr<WriteBehindStorage> storage,
+                          Space space)
+        : batch_{std::move(storage)}, space_{space} {}
+
+    outcome::result<void> put(const ByteView &key,
+                              ByteVecOrView &&value) override {
+      return batch_.put(space_, key, std::move(value));
+    }
+
+    outcome::result<void> remove(const ByteView &key) override {
+      return batch_.remove(space_, key);
+    }
+
+    outcome::result<void> commit() override {
+      return batch_.commit();
+    }
+
+    void clear() override {
+      batch_.clear();
+    }
+
+   private:
+    WriteBehindBatch batch_;
+    Space space_;
+  };
+
+  /// Space reading overlay first, then backend
+  class WriteBehindSpace : public BufferStorage {
+   public:
+    WriteBehindSpace(std::weak_ptr<WriteBehindStorage> storage,
+                     Space space,
+                     std::shared_ptr<BufferStorage> backend)
+        : storage_{std::move(storage)},
+          space_{space},
+          backend_{std::move(backend)} {}
+
+    outcome::result<bool> contains(const ByteView &key) const override {
+      OUTCOME_TRY(storage, use());
+      if (auto value = storage->overlaid(space_, key)) {
+        return value->has_value();
+      }
+      return backend_->contains(key);
+    }
+
+    outcome::result<ByteVecOrView> get(const ByteView &key) const override {
+      OUTCOME_TRY(storage, use());
+      if (auto value = storage->overlaid(space_, key)) {
+        if (not value->has_value()) {
+          return StorageError::NOT_FOUND;
+        }
+        return ByteVecOrView{std::move(value->value())};
+      }
+      return backend_->get(key);
+    }
+
+    outcome::result<std::optional<ByteVecOrView>> tryGet(
+        const ByteView &key) const override {
+      OUTCOME_TRY(storage, use());
+      if (auto value = storage->overlaid(space_, key)) {
+        if (not value->has_value()) {
+          return std::nullopt;
+        }
+        return ByteVecOrView{std::move(value->value())};
+      }
+      return backend_->tryGet(key);
+    }
+
+    /// Keys missing in overlay are read from backend in one batch
+    outcome::result<std::vector<std::optional<ByteVecOrView>>> tryGetMany(
+        std::span<const ByteView> keys) const override {
+      OUTCOME_TRY(storage, use());
+      std::vector<std::optional<ByteVecOrView>> values(keys.size());
+      std::vector<ByteView> missed_keys;
+      std::vector<size_t> missed;
+      for (size_t i = 0; i < keys.size(); ++i) {
+        if (auto value = storage->overlaid(space_, keys[i])) {
+          if (value->has_value()) {
+            values[i].emplace(std::move(value->value()));
+          }
+          continue;
+        }
+        missed_keys.emplace_back(keys[i]);
+        missed.emplace_back(i);
+      }
+      if (missed.empty()) {
+        return values;
+      }
+      OUTCOME_TRY(backend_values, backend_->tryGetMany(missed_keys));
+      for (size_t j = 0; j < missed.size(); ++j) {
+        values[missed[j]] = std::move(backend_values[j]);
+      }
+      return values;
+    }
+
+    outcome::result<bool> tryRead(
+        const ByteView &key,
+        const std::function<outcome::result<void>(const ByteVecOrView &)>
+            &read) const override {
+      OUTCOME_TRY(storage, use());
+      if (auto value = storage->overlaid(space_, key)) {
+        if (not value->has_value()) {
+          return false;
+        }
+        OUTCOME_TRY(read(ByteVecOrView{std::move(value->value())}));
+        return true;
+      }
+      return backend_->tryRead(key, read);
+    }
+
+    outcome::result<void> put(const ByteView &key,
+                              ByteVecOrView &&value) override {
+      WriteBehindSpaceBatch batch{storage_, space_};
+      OUTCOME_TRY(batch.put(key, std::move(value)));
+      return batch.commit();
+    }
+
+    outcome::result<void> remove(const ByteView &key) override {
+      WriteBehindSpaceBatch batch{storage_, space_};
+      OUTCOME_TRY(batch.remove(key));
+      return batch.commit();
+    }
+
+    std::unique_ptr<BufferBatch> batch() override {
+      return std::make_unique<WriteBehindSpaceBatch>(storage_, space_);
+    }
+
+    /// Backend cursor doesn't see overlay, so pending writes are flushed first
+    std::unique_ptr<Cursor> cursor() override {
+      auto storage = storage_.lock();
+      if (not storage) {
+        throw StorageError::STORAGE_GONE;
+      }
+      if (auto res = storage->flush(); res.has_error()) {
+        SL_ERROR(storage->logger_,
+                 "Cursor may miss pending writes: {}",
+                 res.error());
+      }
+      return backend_->cursor();
+    }
+
+    std::optional<size_t> byteSizeHint() const override {
+      return backend_->byteSizeHint();
+    }
+
+   private:
+    outcome::result<std::shared_ptr<WriteBehindStorage>> use() const {
+      auto storage = storage_.lock();
+      if (not storage) {
+        return StorageError::STORAGE_GONE;
+      }
+      return storage;
+    }
+
+    std::weak_ptr<WriteBehindStorage> storage_;
+    Space space_;
+    std::shared_ptr<BufferStorage> backend_;
+  };
+
+  WriteBehindStorage::WriteBehindStorage(
+      qtils::SharedRef<log::LoggingSystem> logsys,
+      qtils::SharedRef<SpacedStorage> backend,
+      std::chrono::milliseconds commit_delay)
+      : logger_{logsys->getLogger("WriteBehind", "storage")},
+        backend_{std::move(backend)},
+        commit_delay_{commit_delay} {
+    for (size_t i = 0; i < SpacesCount; ++i) {
+      backend_spaces_[i] = backend_->getSpace(static_cast<Space>(i));
+    }
+    thread_ = std::thread{[this] {
+      setThreadName("db.commit");
+      run();
+    }};
+  }
+
+  WriteBehindStorage::~WriteBehindStorage() {
+    {
+      std::lock_guard lock{mutex_};
+      stop_ = true;
+    }
+    commit_cv_.notify_one();
+    thread_.join();
+  }
+
+  std::shared_ptr<BufferStorage> WriteBehindStorage::getSpace(Space space) {
+    auto index = static_cast<size_t>(space);
+    std::lock_guard lock{mutex_};
+    auto &space_ptr = spaces_.at(index);
+    if (not space_ptr) {
+      space_ptr = std::make_shared<WriteBehindSpace>(
+          weak_from_this(), space, backend_spaces_.at(index));
+    }
+    return space_ptr;
+  }
+
+  std::unique_ptr<SpacedBatch> WriteBehindStorage::createBatch() {
+    return std::make_unique<WriteBehindBatch>(weak_from_this());
+  }
+
+  outcome::result<void> WriteBehindStorage::flush() {
+    std::unique_lock lock{mutex_};
+    auto target = queued_seq_;
+    if (durable_seq_ >= target) {
+      return outcome::success();
+    }
+    auto failures = failures_;
+    flush_requested_ = true;
+    commit_cv_.notify_one();
+    durable_cv_.wait(lock, [&] {
+      return durable_seq_ >= target or failures_ != failures;
+    });
+    if (durable_seq_ >= target) {
+      return outcome::success();
+    }
+    return last_error_;
+  }
+
+  SpacedStorage::MemoryUsage WriteBehindStorage::memoryUsage() const {
+    auto usage = backend_->memoryUsage();
+    size_t bytes = 0;
+    {
+      std::lock_guard lock{mutex_};
+      for (auto &overlay : overlay_) {
+        bytes += memory_usage::treeBytes(overlay);
+        for (auto &[key, entry] : overlay) {
+          bytes += key.capacity();
+          if (entry.value.has_value()) {
+            bytes += entry.value->capacity();
+          }
+        }
+      }
+      bytes += memory_usage::vectorBytes(queue_);
+      for (auto &write : queue_) {
+        bytes += write.key.capacity();
+        if (write.value.has_value()) {
+          bytes += write.value->capacity();
+        }
+      }
+    }
+    usage.emplace_back("write_behind_overlay", bytes);
+    return usage;
+  }
+
+  void WriteBehindStorage::updateMetrics() const {
+    backend_->updateMetrics();
+  }
+
+  void WriteBehindStorage::throttleBackgroundIo(bool throttle) {
+    backend_->throttleBackgroundIo(throttle);
+  }
+
+  outcome::result<void> WriteBehindStorage::checkpoint(
+      const std::filesystem::path &directory) {
+    OUTCOME_TRY(flush());
+    return backend_->checkpoint(directory);
+  }
+
+  size_t WriteBehindStorage::pendingWrites() const {
+    std::lock_guard lock{mutex_};
+    return queue_.size() + in_flight_;
+  }
+
+  std::string_view WriteBehindStorage::overlayKey(const ByteView &key) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    return {reinterpret_cast<const char *>(key.data()), key.size()};
+  }
+
+  void WriteBehindStorage::enqueue(std::vector<Write> writes) {
+    if (writes.empty()) {
+      return;
+    }
+    std::unique_lock lock{mutex_};
+    auto seq = ++queued_seq_;
+    for (auto &write : writes) {
+      auto &overlay = overlay_.at(static_cast<size_t>(write.space));
+      auto key = overlayKey(write.key);
+      auto it = overlay.find(key);
+      if (it == overlay.end()) {
+        it = overlay.emplace(std::string{key}, OverlayEntry{}).first;
+      }
+      it->second = {.value = write.value, .seq = seq};
+    }
+    queue_.insert(queue_.end(),
+                  std::make_move_iterator(writes.begin()),
+                  std::make_move_iterator(writes.end()));
+    if (not deadline_.has_value()) {
+      deadline_ = Clock::now() + commit_delay_;
+      lock.unlock();
+      commit_cv_.notify_one();
+    }
+  }
+
+  std::optional<std::optional<ByteVec>> WriteBehindStorage::overlaid(
+      Space space, const ByteView &key) const {
+    std::lock_guard lock{mutex_};
+    auto &overlay = overlay_.at(static_cast<size_t>(space));
+    auto it = overlay.find(overlayKey(key));
+    if (it == overlay.end()) {
+      return std::nullopt;
+    }
+    return it->second.value;
+  }
+
+  void WriteBehindStorage::run() {
+    std::unique_lock lock{mutex_};
+    while (true) {
+      if (queue_.empty()) {
+        if (stop_) {
+          break;
+        }
+        commit_cv_.wait(lock, [&] { return stop_ or not queue_.empty(); });
+        continue;
+      }
+      if (not stop_ and not flush_requested_ and Clock::now() < *deadline_) {
+        commit_cv_.wait_until(
+            lock, *deadline_, [&] { return stop_ or flush_requested_; });
+        continue;
+      }
+
+      // Take everything gathered so far as one group
+      flush_requested_ = false;
+      deadline_.reset();
+      auto writes = std::exchange(queue_, {});
+      auto seq = queued_seq_;
+      in_flight_ = writes.size();
+      lock.unlock();
+      auto res = commit(writes);
+      lock.lock();
+      in_flight_ = 0;
+
+      if (res.has_error()) {
+        ++failures_;
+        last_error_ = res;
+        durable_cv_.notify_all();
+        if (stop_) {
+          SL_CRITICAL(logger_,
+                      "Can't commit {} writes on shutdown: {}",
+                      writes.size(),
+                      res.error());
+          break;
+        }
+        SL_ERROR(logger_,
+                 "Can't commit {} writes, retry in {}ms: {}",
+                 writes.size(),
+                 kRetryDelay.count(),
+                 res.error());
+        // Keep order, newer writes go after failed ones
+        writes.insert(writes.end(),
+                      std::make_move_iterator(queue_.begin()),
+                      std::make_move_iterator(queue_.end()));
+        queue_ = std::move(writes);
+        deadline_ = Clock::now() + kRetryDelay;
+        continue;
+      }
+
+      durable_seq_ = seq;
+      for (auto &write : writes) {
+        auto &overlay = overlay_.at(static_cast<size_t>(write.space));
+        auto it = overlay.find(overlayKey(write.key));
+        if (it != overlay.end() and it->second.seq <= seq) {
+          overlay.erase(it);
+        }
+      }
+      durable_cv_.notify_all();
+    }
+  }
+
+  outcome::result<void> WriteBehindStorage::commit(
+      const std::vector<Write> &writes) {
+    SL_TRACE(logger_, "Commit {} writes", writes.size());
+    auto batch = backend_->createBatch();
+    for (auto &write : writes) {
+      if (write.value.has_value()) {
+        OUTCOME_TRY(batch->put(write.space, write.key, ByteView{*write.value}));
+      } else {
+        OUTCOME_TRY(batch->remove(write.space, write.key));
+      }
+    }
+    return batch->commit();
+  }
+
+}  // namespace lean::storage
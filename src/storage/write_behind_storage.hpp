@@ -0,0 +1,143 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <qtils/shared_ref.hpp>
+
+#include "log/logger.hpp"
+#include "storage/spaced_storage.hpp"
+#include "utils/ctor_limiters.hpp"
+
+namespace lean::storage {
+
+  /**
+   * Write-behind decorator of spaced storage.
+   *
+   * Writes are applied to in-memory overlay and return immediately.
+   * Background thread commits them to backend, all writes gathered during
+   * commit window go into one backend batch. Writes of one `SpacedBatch`,
+   * e.g. header, signature and body of block, always go into same backend
+   * batch, while separate writes, e.g. state of block, may be committed by
+   * next batch. Reads see overlay first, so written data stays visible
+   * until it is durable in backend.
+   */
+  class WriteBehindStorage
+      : public SpacedStorage,
+        public std::enable_shared_from_this<WriteBehindStorage>,
+        NonCopyable,
+        NonMovable {
+   public:
+    /// Time to gather writes before commit
+    static constexpr std::chrono::milliseconds kCommitDelay{10};
+    /// Delay before retry of failed commit
+    static constexpr std::chrono::milliseconds kRetryDelay{1000};
+
+    WriteBehindStorage(qtils::SharedRef<log::LoggingSystem> logsys,
+                       qtils::SharedRef<SpacedStorage> backend,
+                       std::chrono::milliseconds commit_delay = kCommitDelay);
+
+    /// Commits pending writes and joins thread
+    ~WriteBehindStorage() override;
+
+    std::shared_ptr<BufferStorage> getSpace(Space space) override;
+
+    std::unique_ptr<SpacedBatch> createBatch() override;
+
+    /// Memory of backend and of writes not committed to it yet
+    MemoryUsage memoryUsage() const override;
+
+    void updateMetrics() const override;
+
+    void throttleBackgroundIo(bool throttle) override;
+
+    /// Checkpoint of backend after pending writes are committed
+    outcome::result<void> checkpoint(
+        const std::filesystem::path &directory) override;
+
+    /**
+     * Commit pending writes without waiting for commit window.
+     * @return error of commit, if writes made before call are not durable
+     */
+    outcome::result<void> flush();
+
+    /// Number of writes not committed to backend yet
+    size_t pendingWrites() const;
+
+    friend class WriteBehindSpace;
+    friend class WriteBehindBatch;
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Write {
+      Space space;
+      ByteVec key;
+      /// Nullopt for removal
+      std::optional<ByteVec> value;
+    };
+
+    struct OverlayEntry {
+      std::optional<ByteVec> value;
+      /// Sequence number of last write, entry is erased when it is durable
+      uint64_t seq;
+    };
+
+    using Overlay = std::map<std::string, OverlayEntry, std::less<>>;
+
+    static std::string_view overlayKey(const ByteView &key);
+
+    /// Queue writes as one group
+    void enqueue(std::vector<Write> writes);
+
+    /**
+     * Find key in overlay.
+     * @return nullopt if key is not overlaid, otherwise pending value
+     */
+    std::optional<std::optional<ByteVec>> overlaid(Space space,
+                                                   const ByteView &key) const;
+
+    void run();
+
+    outcome::result<void> commit(const std::vector<Write> &writes);
+
+    log::Logger logger_;
+    qtils::SharedRef<SpacedStorage> backend_;
+    std::array<std::shared_ptr<BufferStorage>, SpacesCount> backend_spaces_;
+    const std::chrono::milliseconds commit_delay_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable commit_cv_;
+    std::condition_variable durable_cv_;
+    std::array<std::shared_ptr<BufferStorage>, SpacesCount> spaces_;
+    std::array<Overlay, SpacesCount> overlay_;
+    /// Writes not taken by committer yet
+    std::vector<Write> queue_;
+    size_t in_flight_ = 0;
+    /// Commit time of queued writes
+    std::optional<Clock::time_point> deadline_;
+    uint64_t queued_seq_ = 0;
+    uint64_t durable_seq_ = 0;
+    /// Number of failed commits, to wake `flush` waiting in vain
+    uint64_t failures_ = 0;
+    outcome::result<void> last_error_ = outcome::success();
+    bool flush_requested_ = false;
+    bool stop_ = false;
+    std::thread thread_;
+  };
+
+}  // namespace lean::storage
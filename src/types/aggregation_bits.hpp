@@ -6,7 +6,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <iterator>
 #include <ranges>
+#include <span>
+#include <vector>
 
 #include <sszpp/lists.hpp>
 #include <sszpp/wrapper.hpp>
@@ -16,12 +22,70 @@
 #include "types/validator_index.hpp"
 
 namespace lean {
+  /**
+   * SSZ bitlist of validators.
+   *
+   * Serialized as `bits`, set operations use word-packed copy of `bits`.
+   * `bits` must be changed only through methods (or decoding), so packed
+   * copy stays in sync.
+   */
   struct AggregationBits : ssz::ssz_variable_size_container {
+    using Word = uint64_t;
+    static constexpr size_t kWordBits = 64;
+
+    /// Iterates set bits in ascending order, skipping zero words
+    class SetBitsIterator {
+     public:
+      using iterator_concept = std::forward_iterator_tag;
+      using iterator_category = std::input_iterator_tag;
+      using value_type = ValidatorIndex;
+      using difference_type = std::ptrdiff_t;
+
+      SetBitsIterator() = default;
+      SetBitsIterator(std::span<const Word> words, size_t word_index)
+          : words_{words}, word_index_{word_index} {
+        if (word_index_ < words_.size()) {
+          word_ = words_[word_index_];
+          skipZeroWords();
+        }
+      }
+
+      ValidatorIndex operator*() const {
+        return word_index_ * kWordBits + std::countr_zero(word_);
+      }
+
+      SetBitsIterator &operator++() {
+        word_ &= word_ - 1;
+        skipZeroWords();
+        return *this;
+      }
+
+      SetBitsIterator operator++(int) {
+        auto copy = *this;
+        ++*this;
+        return copy;
+      }
+
+      bool operator==(const SetBitsIterator &other) const {
+        return word_index_ == other.word_index_ and word_ == other.word_;
+      }
+
+     private:
+      void skipZeroWords() {
+        while (word_ == 0 and ++word_index_ < words_.size()) {
+          word_ = words_[word_index_];
+        }
+      }
+
+      std::span<const Word> words_;
+      size_t word_index_ = 0;
+      Word word_ = 0;
+    };
+
     auto iter() const {
-      return std::views::iota(ValidatorIndex{0}, ValidatorIndex{bits.size()})
-           | std::views::filter([this](ValidatorIndex validator_index) {
-               return bits.data()[validator_index];
-             });
+      auto &words = this->words();
+      return std::ranges::subrange{SetBitsIterator{words, 0},
+                                   SetBitsIterator{words, words.size()}};
     }
 
     bool contains(ValidatorIndex validator_index) const {
@@ -29,15 +93,127 @@ namespace lean {
     }
 
     void add(ValidatorIndex validator_index) {
+      syncWords();
       if (bits.size() <= validator_index) {
         bits.data().resize(validator_index + 1);
+        words_.resize(wordCount(bits.size()));
+        words_size_ = bits.size();
       }
       bits.data()[validator_index] = true;
+      words_[validator_index / kWordBits] |=
+          Word{1} << (validator_index % kWordBits);
+    }
+
+    /// Number of set bits
+    size_t count() const {
+      size_t count = 0;
+      for (auto word : words()) {
+        count += std::popcount(word);
+      }
+      return count;
+    }
+
+    /// Add all bits of `other`
+    void unionWith(const AggregationBits &other) {
+      for (auto validator_index : other.iter()) {
+        add(validator_index);
+      }
+    }
+
+    /// Number of set bits which are not set in `other`
+    size_t countNotIn(const AggregationBits &other) const {
+      auto &lhs = words();
+      auto &rhs = other.words();
+      size_t count = 0;
+      for (size_t i = 0; i < lhs.size(); ++i) {
+        auto mask = i < rhs.size() ? rhs[i] : Word{0};
+        count += std::popcount(lhs[i] & ~mask);
+      }
+      return count;
+    }
+
+    /// All set bits are set in `other` too
+    bool isSubsetOf(const AggregationBits &other) const {
+      auto &lhs = words();
+      auto &rhs = other.words();
+      for (size_t i = 0; i < lhs.size(); ++i) {
+        auto mask = i < rhs.size() ? rhs[i] : Word{0};
+        if ((lhs[i] & ~mask) != 0) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /// Some bit is set in both
+    bool intersects(const AggregationBits &other) const {
+      auto &lhs = words();
+      auto &rhs = other.words();
+      for (size_t i = 0; i < std::min(lhs.size(), rhs.size()); ++i) {
+        if ((lhs[i] & rhs[i]) != 0) {
+          return true;
+        }
+      }
+      return false;
     }
 
     ssz::list<bool, VALIDATOR_REGISTRY_LIMIT> bits;
 
-    SSZ_AND_JSON_WRAPPER(bits);
-    bool operator==(const AggregationBits &) const = default;
+    // Same as `SSZ_WRAPPER(bits)`, but packed copy is rebuilt after decoding
+    constexpr std::size_t ssz_size() const noexcept {
+      return ssz::size(bits);
+    }
+    constexpr void serialize(ssz::ssz_iterator auto result) const {
+      ssz::serialize(result, bits);
+    }
+    void deserialize(const std::ranges::sized_range auto &bytes) {
+      ssz::deserialize(bytes, bits);
+      rebuildWords();
+    }
+    void hash_tree_root(ssz::ssz_iterator auto result,
+                        size_t cpu_count = 0) const {
+      ssz::hash_tree_root(result, bits, cpu_count);
+    }
+    void assert_consistent_variable_size() const {
+      auto t = std::tie(bits);
+      static_assert(variable_size::value
+                    or ssz::tuple_all_fixed_size<decltype(t)>::value);
+    }
+    JSON_WRAPPER(bits);
+
+    bool operator==(const AggregationBits &other) const {
+      return bits == other.bits;
+    }
+
+   private:
+    static size_t wordCount(size_t bit_count) {
+      return (bit_count + kWordBits - 1) / kWordBits;
+    }
+
+    const std::vector<Word> &words() const {
+      syncWords();
+      return words_;
+    }
+
+    /// Rebuild packed copy if `bits` were resized externally
+    void syncWords() const {
+      if (words_size_ != bits.size()) {
+        rebuildWords();
+      }
+    }
+
+    void rebuildWords() const {
+      auto &data = bits.data();
+      words_.assign(wordCount(data.size()), 0);
+      for (size_t i = 0; i < data.size(); ++i) {
+        if (data[i]) {
+          words_[i / kWordBits] |= Word{1} << (i % kWordBits);
+        }
+      }
+      words_size_ = data.size();
+    }
+
+    mutable std::vector<Word> words_;
+    mutable size_t words_size_ = 0;
   };
 }  // namespace lean
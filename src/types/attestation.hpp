@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <type_traits>
+
 #include <sszpp/container.hpp>
 
 #include "serde/json_fwd.hpp"
@@ -17,6 +19,9 @@ namespace lean {
     ValidatorIndex validator_id;
     AttestationData data;
 
+    /// Encoded by single copy, see `SszPacked`
+    using ssz_packed = std::true_type;
+
     SSZ_AND_JSON_FIELDS(validator_id, data);
     bool operator==(const Attestation &) const = default;
   };
@@ -6,6 +6,11 @@
 
 #pragma once
 
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+
+#include <boost/container_hash/hash.hpp>
 #include <sszpp/container.hpp>
 
 #include "serde/json_fwd.hpp"
@@ -19,7 +24,26 @@ namespace lean {
     Checkpoint target;
     Checkpoint source;
 
+    /// Encoded by single copy, see `SszPacked`
+    using ssz_packed = std::true_type;
+
     SSZ_AND_JSON_FIELDS(slot, head, target, source);
     bool operator==(const AttestationData &) const = default;
   };
 }  // namespace lean
+
+/// Cheap hash of fields, roots are uniform so their prefix is enough
+template <>
+struct std::hash<lean::AttestationData> {
+  size_t operator()(const lean::AttestationData &data) const noexcept {
+    size_t result = 0;
+    boost::hash_combine(result, data.slot);
+    for (auto *checkpoint : {&data.head, &data.target, &data.source}) {
+      size_t prefix = 0;
+      std::memcpy(&prefix, checkpoint->root.data(), sizeof(prefix));
+      boost::hash_combine(result, prefix);
+      boost::hash_combine(result, checkpoint->slot);
+    }
+    return result;
+  }
+};
@@ -6,10 +6,28 @@
 
 #pragma once
 
+#include <cstring>
+#include <type_traits>
+
 #include <qtils/byte_arr.hpp>
 
 namespace lean {
   using BlockHash = qtils::ByteArr<32>;
 
   constexpr BlockHash kZeroHash;
+
+  /**
+   * Hash of block hash for hash tables.
+   * Block hashes are uniform, so their first 8 bytes are good hash already.
+   */
+  struct BlockHashHasher {
+    /// Tells boost flat containers to skip extra mixing
+    using is_avalanching = std::true_type;
+
+    size_t operator()(const BlockHash &hash) const noexcept {
+      size_t result = 0;
+      std::memcpy(&result, hash.data(), sizeof(result));
+      return result;
+    }
+  };
 }  // namespace lean
@@ -0,0 +1,25 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <boost/unordered/unordered_flat_map.hpp>
+#include <boost/unordered/unordered_flat_set.hpp>
+
+#include "types/block_hash.hpp"
+
+namespace lean {
+  /**
+   * Open addressing hash map keyed by block hash, for hot lookups.
+   * Unlike `std::unordered_map`, insertion invalidates references and
+   * iterators, so keep values small and don't hold them across inserts.
+   */
+  template <typename T>
+  using BlockHashMap = boost::unordered_flat_map<BlockHash, T, BlockHashHasher>;
+
+  /// Open addressing hash set of block hashes, see `BlockHashMap`
+  using BlockHashSet = boost::unordered_flat_set<BlockHash, BlockHashHasher>;
+}  // namespace lean
@@ -30,12 +30,8 @@ namespace lean {
 template <>
 struct std::hash<lean::BlockIndex> {
   std::size_t operator()(const lean::BlockIndex &s) const noexcept {
-    std::size_t h = std::hash<lean::Slot>{}(s.slot);
-    for (auto b : s.hash) {
-      h ^= std::hash<std::uint8_t>{}(b) + 0x9e3779b97f4a7c15ULL + (h << 6)
-         + (h >> 2);
-    }
-    return h;
+    // Slot is determined by hash, mixing it in only separates equal hashes
+    return lean::BlockHashHasher{}(s.hash) ^ std::hash<lean::Slot>{}(s.slot);
   }
 };
 
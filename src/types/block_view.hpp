@@ -0,0 +1,93 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "serde/ssz_view.hpp"
+#include "types/signed_block.hpp"
+
+namespace lean {
+  /**
+   * Encoded `Block`, header fields are read without decoding body.
+   */
+  class BlockView {
+   public:
+    static outcome::result<BlockView> make(qtils::BytesIn bytes) {
+      BOOST_OUTCOME_TRY(auto view, View::make(bytes, kSizes));
+      return BlockView{view};
+    }
+
+    Slot slot() const {
+      return view_.fixedField<Slot>(0);
+    }
+    ProposerIndex proposerIndex() const {
+      return view_.fixedField<ProposerIndex>(1);
+    }
+    BlockHash parentRoot() const {
+      return view_.fixedField<BlockHash>(2);
+    }
+    BlockHash stateRoot() const {
+      return view_.fixedField<BlockHash>(3);
+    }
+    outcome::result<BlockBody> body() const {
+      return view_.decodeField<BlockBody>(4);
+    }
+
+    outcome::result<Block> decode() const {
+      return lean::decode<Block>(view_.bytes());
+    }
+
+   private:
+    using View = SszContainerView<5>;
+    static constexpr View::FieldSizes kSizes{
+        sizeof(Slot),
+        sizeof(ProposerIndex),
+        sizeof(BlockHash),
+        sizeof(BlockHash),
+        View::kVariable,
+    };
+
+    explicit BlockView(View view) : view_{view} {}
+
+    View view_;
+  };
+
+  /**
+   * Encoded `SignedBlock`, e.g. gossip message checked before full decoding.
+   */
+  class SignedBlockView {
+   public:
+    static outcome::result<SignedBlockView> make(qtils::BytesIn bytes) {
+      BOOST_OUTCOME_TRY(auto view, View::make(bytes, kSizes));
+      BOOST_OUTCOME_TRY(auto block, BlockView::make(view.field(0)));
+      return SignedBlockView{view, block};
+    }
+
+    const BlockView &block() const {
+      return block_;
+    }
+    outcome::result<BlockSignatures> signature() const {
+      return view_.decodeField<BlockSignatures>(1);
+    }
+
+    outcome::result<SignedBlock> decode() const {
+      return lean::decode<SignedBlock>(view_.bytes());
+    }
+
+   private:
+    using View = SszContainerView<2>;
+    static constexpr View::FieldSizes kSizes{
+        View::kVariable,
+        View::kVariable,
+    };
+
+    SignedBlockView(View view, BlockView block)
+        : view_{view}, block_{block} {}
+
+    View view_;
+    BlockView block_;
+  };
+}  // namespace lean
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <type_traits>
+
 #include <sszpp/ssz++.hpp>
 
 #include "log/formatters/block_index_ref.hpp"
@@ -17,6 +19,9 @@ namespace lean {
     BlockHash root;
     Slot slot = 0;
 
+    /// Encoded by single copy, see `SszPacked`
+    using ssz_packed = std::true_type;
+
     static Checkpoint from(const auto &v) {
       return Checkpoint{.root = v.hash(), .slot = v.slot};
     }
@@ -35,6 +35,10 @@ namespace lean {
 
   /// Maximum number of blocks in a single request
   static constexpr uint64_t MAX_REQUEST_BLOCKS = 1 << 10;  // 1024
+  /// Maximum size of state part in single state response chunk
+  static constexpr uint64_t MAX_STATE_CHUNK_SIZE = 1 << 20;  // 1 MiB
+  /// Maximum number of peers in single peer exchange response
+  static constexpr uint64_t MAX_PEER_EXCHANGE_PEERS = 16;
 
   using DomainType = qtils::ByteArr<4>;
 
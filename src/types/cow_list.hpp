@@ -0,0 +1,100 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <ranges>
+#include <tuple>
+
+#include <sszpp/lists.hpp>
+#include <sszpp/wrapper.hpp>
+
+#include "utils/cow.hpp"
+
+namespace lean {
+  /**
+   * SSZ list shared between copies until modified.
+   *
+   * Derived state shares lists it doesn't change with parent state.
+   * Read with `data()`, modify with `mut()`.
+   * Serialized same as `ssz::list<T, N>`.
+   */
+  template <typename T, size_t N>
+  struct CowList : ssz::ssz_variable_size_container {
+    using List = ssz::list<T, N>;
+
+    CowList() = default;
+    CowList(List list) : list_{std::move(list)} {}
+
+    const List &get() const {
+      return *list_;
+    }
+
+    const auto &data() const {
+      return list_->data();
+    }
+
+    size_t size() const {
+      return list_->size();
+    }
+
+    bool empty() const {
+      return data().empty();
+    }
+
+    decltype(auto) operator[](size_t index) const {
+      return data()[index];
+    }
+
+    auto begin() const {
+      return data().begin();
+    }
+
+    auto end() const {
+      return data().end();
+    }
+
+    /// List for modification, copied first if shared
+    List &mut() {
+      return list_.mut();
+    }
+
+    // Same as `SSZ_WRAPPER`, for list behind pointer
+    constexpr std::size_t ssz_size() const noexcept {
+      return ssz::size(get());
+    }
+    constexpr void serialize(ssz::ssz_iterator auto result) const {
+      ssz::serialize(result, get());
+    }
+    void deserialize(const std::ranges::sized_range auto &bytes) {
+      ssz::deserialize(bytes, mut());
+    }
+    void hash_tree_root(ssz::ssz_iterator auto result,
+                        size_t cpu_count = 0) const {
+      ssz::hash_tree_root(result, get(), cpu_count);
+    }
+    void assert_consistent_variable_size() const {
+      auto t = std::tie(get());
+      static_assert(variable_size::value
+                    or ssz::tuple_all_fixed_size<decltype(t)>::value);
+    }
+
+    // Same as `JSON_WRAPPER`
+    auto &wrappedField() const {
+      return get();
+    }
+    auto &wrappedField() {
+      return mut();
+    }
+
+    bool operator==(const CowList &other) const {
+      return list_ == other.list_;
+    }
+
+   private:
+    Cow<List> list_;
+  };
+}  // namespace lean
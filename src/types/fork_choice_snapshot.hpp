@@ -0,0 +1,64 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <sszpp/container.hpp>
+#include <sszpp/lists.hpp>
+
+#include "types/aggregated_signature_proof.hpp"
+#include "types/attestation.hpp"
+#include "types/attestation_data.hpp"
+#include "types/block_hash.hpp"
+#include "types/checkpoint.hpp"
+#include "types/constants.hpp"
+#include "types/signature.hpp"
+#include "types/validator_index.hpp"
+
+namespace lean {
+
+  struct ValidatorSignature : ssz::ssz_container {
+    ValidatorIndex validator_id;
+    Signature signature;
+
+    SSZ_CONT(validator_id, signature);
+  };
+
+  /// Signatures and proofs gathered for one attestation data
+  struct AttestationsByDataSnapshot : ssz::ssz_variable_size_container {
+    AttestationData data;
+    ssz::list<ValidatorSignature, VALIDATOR_REGISTRY_LIMIT> signatures;
+    ssz::list<AggregatedSignatureProof, VALIDATOR_REGISTRY_LIMIT> proofs;
+
+    SSZ_CONT(data, signatures, proofs);
+  };
+
+  /**
+   * Part of fork choice store which is not stored elsewhere, so restarted
+   * node doesn't need to learn votes again.
+   */
+  struct ForkChoiceSnapshot : ssz::ssz_variable_size_container {
+    /// Finalized checkpoint when snapshot was taken
+    Checkpoint finalized;
+    Checkpoint head;
+    Checkpoint safe_target;
+    ssz::list<Attestation, VALIDATOR_REGISTRY_LIMIT> latest_known_attestations;
+    ssz::list<Attestation, VALIDATOR_REGISTRY_LIMIT> latest_new_attestations;
+    ssz::list<AttestationsByDataSnapshot, VALIDATOR_REGISTRY_LIMIT>
+        attestations_by_data;
+    /// Blocks with cached states, most recently used first
+    ssz::list<BlockHash, VALIDATOR_REGISTRY_LIMIT> hot_states;
+
+    SSZ_CONT(finalized,
+             head,
+             safe_target,
+             latest_known_attestations,
+             latest_new_attestations,
+             attestations_by_data,
+             hot_states);
+  };
+
+}  // namespace lean
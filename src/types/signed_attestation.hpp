@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <type_traits>
+
 #include <sszpp/container.hpp>
 
 #include "serde/json_fwd.hpp"
@@ -19,6 +21,9 @@ namespace lean {
     AttestationData data;
     Signature signature;
 
+    /// Encoded by single copy, unless signature size leaves padding
+    using ssz_packed = std::true_type;
+
     static SignedAttestation from(const auto &attestation,
                                   const auto &signature) {
       return SignedAttestation{
@@ -6,15 +6,74 @@
 
 #pragma once
 
+#include <unordered_map>
+#include <vector>
+
 #include "serde/json_fwd.hpp"
+#include "serde/merkle_cache.hpp"
 #include "types/block_header.hpp"
 #include "types/checkpoint.hpp"
 #include "types/config.hpp"
 #include "types/constants.hpp"
+#include "types/cow_list.hpp"
+#include "types/validator.hpp"
 #include "types/validator_index.hpp"
-#include "types/validators.hpp"
+#include "utils/cow.hpp"
 
 namespace lean {
+  /**
+   * Merkle trees of large `State` lists, reused between `stateRoot` calls.
+   * Shared with state copies until changed, so child state rehashes only
+   * changed chunks.
+   * Not serialized and ignored by comparison.
+   */
+  struct StateMerkleCache {
+    static constexpr uint64_t bitChunks(uint64_t bits) {
+      return (bits + 255) / 256;
+    }
+
+    Cow<MerkleCache> historical_block_hashes{
+        MerkleCache{MerkleCache::depthFor(HISTORICAL_ROOTS_LIMIT)}};
+    Cow<MerkleCache> justified_slots{
+        MerkleCache{MerkleCache::depthFor(bitChunks(HISTORICAL_ROOTS_LIMIT))}};
+    Cow<MerkleCache> validators{
+        MerkleCache{MerkleCache::depthFor(VALIDATOR_REGISTRY_LIMIT)}};
+    /// Validators whose roots are in `validators` tree
+    Cow<std::vector<Validator>> hashed_validators;
+    Cow<MerkleCache> justifications_roots{
+        MerkleCache{MerkleCache::depthFor(HISTORICAL_ROOTS_LIMIT)}};
+    Cow<MerkleCache> justifications_validators{
+        MerkleCache{MerkleCache::depthFor(
+            bitChunks(HISTORICAL_ROOTS_LIMIT * VALIDATOR_REGISTRY_LIMIT))}};
+
+    bool operator==(const StateMerkleCache &) const {
+      return true;
+    }
+  };
+
+  /**
+   * Derived data of pending justifications, maintained by STF together with
+   * `justifications_roots`, so attestations are processed without scanning
+   * history or counting votes.
+   * Rebuilt by STF when it doesn't match justification roots of state, e.g.
+   * for decoded state.
+   * Not serialized and ignored by comparison.
+   */
+  struct JustificationsIndex {
+    struct Row {
+      /// Slot of root in `historical_block_hashes`
+      Slot slot;
+      /// Number of validators voted for root
+      size_t votes;
+    };
+
+    std::unordered_map<BlockHash, Row> rows;
+
+    bool operator==(const JustificationsIndex &) const {
+      return true;
+    }
+  };
+
   struct State : ssz::ssz_variable_size_container {
     State() = default;
     State(const State &) = default;
@@ -26,15 +85,16 @@ namespace lean {
     Checkpoint latest_justified;
     Checkpoint latest_finalized;
 
-    ssz::list<BlockHash, HISTORICAL_ROOTS_LIMIT> historical_block_hashes;
+    // Large lists are shared between state copies until modified
+    CowList<BlockHash, HISTORICAL_ROOTS_LIMIT> historical_block_hashes;
     ssz::list<bool, HISTORICAL_ROOTS_LIMIT> justified_slots;
 
-    Validators validators;
+    CowList<Validator, VALIDATOR_REGISTRY_LIMIT> validators;
 
     // Diverged from 3SF-mini.py:
     // Flattened `justifications: Dict[str, List[bool]]` for SSZ compatibility
-    ssz::list<BlockHash, HISTORICAL_ROOTS_LIMIT> justifications_roots;
-    ssz::list<bool, HISTORICAL_ROOTS_LIMIT * VALIDATOR_REGISTRY_LIMIT>
+    CowList<BlockHash, HISTORICAL_ROOTS_LIMIT> justifications_roots;
+    CowList<bool, HISTORICAL_ROOTS_LIMIT * VALIDATOR_REGISTRY_LIMIT>
         justifications_validators;
 
     SSZ_AND_JSON_FIELDS(config,
@@ -52,6 +112,12 @@ namespace lean {
     ValidatorIndex validatorCount() const {
       return validators.size();
     }
+
+    /// Used by `stateRoot`, not thread safe
+    mutable StateMerkleCache merkle_cache;
+
+    /// Used by `STF::processAttestations`
+    JustificationsIndex justifications_index;
   };
 
   struct AnchorState : State {
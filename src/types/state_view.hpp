@@ -0,0 +1,87 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "serde/ssz_view.hpp"
+#include "types/state.hpp"
+
+namespace lean {
+  /**
+   * Encoded `State`, header fields and single list elements are read without
+   * decoding lists of whole state.
+   */
+  class StateView {
+   public:
+    static outcome::result<StateView> make(qtils::BytesIn bytes) {
+      BOOST_OUTCOME_TRY(auto view, View::make(bytes, sizes()));
+      BOOST_OUTCOME_TRY(
+          auto historical_block_hashes,
+          SszFixedListView<BlockHash>::make(view.field(5), sizeof(BlockHash)));
+      BOOST_OUTCOME_TRY(auto validators,
+                        SszFixedListView<Validator>::make(
+                            view.field(7), ssz::size(Validator{})));
+      return StateView{view, historical_block_hashes, validators};
+    }
+
+    Config config() const {
+      return view_.fixedField<Config>(0);
+    }
+    Slot slot() const {
+      return view_.fixedField<Slot>(1);
+    }
+    BlockHeader latestBlockHeader() const {
+      return view_.fixedField<BlockHeader>(2);
+    }
+    Checkpoint latestJustified() const {
+      return view_.fixedField<Checkpoint>(3);
+    }
+    Checkpoint latestFinalized() const {
+      return view_.fixedField<Checkpoint>(4);
+    }
+
+    const SszFixedListView<BlockHash> &historicalBlockHashes() const {
+      return historical_block_hashes_;
+    }
+    const SszFixedListView<Validator> &validators() const {
+      return validators_;
+    }
+
+    outcome::result<State> decode() const {
+      return lean::decode<State>(view_.bytes());
+    }
+
+   private:
+    using View = SszContainerView<10>;
+
+    static const View::FieldSizes &sizes() {
+      static const View::FieldSizes sizes{
+          ssz::size(Config{}),
+          sizeof(Slot),
+          ssz::size(BlockHeader{}),
+          ssz::size(Checkpoint{}),
+          ssz::size(Checkpoint{}),
+          View::kVariable,
+          View::kVariable,
+          View::kVariable,
+          View::kVariable,
+          View::kVariable,
+      };
+      return sizes;
+    }
+
+    StateView(View view,
+              SszFixedListView<BlockHash> historical_block_hashes,
+              SszFixedListView<Validator> validators)
+        : view_{view},
+          historical_block_hashes_{historical_block_hashes},
+          validators_{validators} {}
+
+    View view_;
+    SszFixedListView<BlockHash> historical_block_hashes_;
+    SszFixedListView<Validator> validators_;
+  };
+}  // namespace lean
@@ -0,0 +1,430 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/async_file_io.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <system_error>
+
+#include <boost/asio/execution/outstanding_work.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/prefer.hpp>
+#include <fmt/format.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#include "utils/thread_placement.hpp"
+
+namespace lean {
+  namespace {
+    /// Longest single transfer, longer requests continue after it
+    constexpr size_t kMaxTransfer = size_t{1} << 30;
+    /// `user_data` of request waking reaper on destruction
+    constexpr uint64_t kWakeReaper = 0;
+
+    std::error_code lastError() {
+      return {errno, std::generic_category()};
+    }
+  }  // namespace
+
+  struct AsyncFileIo::Batch {
+    std::vector<Request> requests;
+    /// Bytes transferred by each request so far
+    std::vector<size_t> done;
+    Results results;
+    /// `user_data` of each request
+    std::vector<Pending> slots;
+    std::atomic_size_t remaining;
+    boost::asio::any_io_executor executor;
+    Handler handler;
+  };
+
+#ifdef __linux__
+  struct AsyncFileIo::Ring {
+    ~Ring() {
+      if (sqes != nullptr) {
+        ::munmap(sqes, params.sq_entries * sizeof(io_uring_sqe));
+      }
+      if (cq_ptr != nullptr and cq_ptr != sq_ptr) {
+        ::munmap(cq_ptr, cq_size);
+      }
+      if (sq_ptr != nullptr) {
+        ::munmap(sq_ptr, sq_size);
+      }
+      if (fd >= 0) {
+        ::close(fd);
+      }
+    }
+
+    static std::unique_ptr<Ring> create(uint32_t entries) {
+      auto ring = std::make_unique<Ring>();
+      ring->fd = static_cast<int>(
+          ::syscall(__NR_io_uring_setup, entries, &ring->params));
+      if (ring->fd < 0) {
+        return nullptr;
+      }
+      auto &p = ring->params;
+      ring->sq_size = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+      ring->cq_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+      auto single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+      if (single) {
+        ring->sq_size = ring->cq_size = std::max(ring->sq_size, ring->cq_size);
+      }
+      auto map = [&](size_t size, off_t offset) -> uint8_t * {
+        auto ptr = ::mmap(nullptr,
+                          size,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE,
+                          ring->fd,
+                          offset);
+        return ptr == MAP_FAILED ? nullptr : static_cast<uint8_t *>(ptr);
+      };
+      auto *sq = map(ring->sq_size, IORING_OFF_SQ_RING);
+      if (sq == nullptr) {
+        return nullptr;
+      }
+      ring->sq_ptr = sq;
+      auto *cq = single ? sq : map(ring->cq_size, IORING_OFF_CQ_RING);
+      if (cq == nullptr) {
+        return nullptr;
+      }
+      ring->cq_ptr = cq;
+      auto *sqes = map(p.sq_entries * sizeof(io_uring_sqe), IORING_OFF_SQES);
+      if (sqes == nullptr) {
+        return nullptr;
+      }
+      ring->sqes = reinterpret_cast<io_uring_sqe *>(sqes);
+
+      ring->sq_tail = reinterpret_cast<uint32_t *>(sq + p.sq_off.tail);
+      ring->sq_mask = *reinterpret_cast<uint32_t *>(sq + p.sq_off.ring_mask);
+      ring->sq_array = reinterpret_cast<uint32_t *>(sq + p.sq_off.array);
+      ring->cq_head = reinterpret_cast<uint32_t *>(cq + p.cq_off.head);
+      ring->cq_tail = reinterpret_cast<uint32_t *>(cq + p.cq_off.tail);
+      ring->cq_mask = *reinterpret_cast<uint32_t *>(cq + p.cq_off.ring_mask);
+      ring->cqes = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+      return ring;
+    }
+
+    /// Next submission queue entry, caller keeps entries below queue depth
+    io_uring_sqe &push() {
+      auto index = sq_local_tail & sq_mask;
+      sq_array[index] = index;
+      ++sq_local_tail;
+      ++unsubmitted;
+      auto &sqe = sqes[index];
+      sqe = {};
+      return sqe;
+    }
+
+    /// Publish pushed entries and submit them
+    void submit() {
+      std::atomic_ref{*sq_tail}.store(sq_local_tail,
+                                      std::memory_order_release);
+      auto submitted = ::syscall(
+          __NR_io_uring_enter, fd, unsubmitted, 0, 0, nullptr, 0);
+      // Entries not taken yet are submitted by next call
+      if (submitted > 0) {
+        unsubmitted -= static_cast<uint32_t>(submitted);
+      }
+    }
+
+    int fd = -1;
+    io_uring_params params{};
+    uint8_t *sq_ptr = nullptr;
+    uint8_t *cq_ptr = nullptr;
+    size_t sq_size = 0;
+    size_t cq_size = 0;
+    io_uring_sqe *sqes = nullptr;
+    uint32_t *sq_tail = nullptr;
+    uint32_t sq_mask = 0;
+    uint32_t *sq_array = nullptr;
+    uint32_t *cq_head = nullptr;
+    uint32_t *cq_tail = nullptr;
+    uint32_t cq_mask = 0;
+    io_uring_cqe *cqes = nullptr;
+    uint32_t sq_local_tail = 0;
+    uint32_t unsubmitted = 0;
+  };
+#else
+  struct AsyncFileIo::Ring {
+    static std::unique_ptr<Ring> create(uint32_t) {
+      return nullptr;
+    }
+  };
+#endif
+
+  AsyncFileIo::AsyncFileIo(uint32_t queue_depth, bool use_io_uring)
+      : queue_depth_{std::max<uint32_t>(queue_depth, 1)} {
+    if (use_io_uring) {
+      ring_ = Ring::create(queue_depth_);
+    }
+    if (ring_) {
+      threads_.emplace_back([this] {
+        setThreadName("file_io");
+        reap();
+      });
+      return;
+    }
+    for (size_t i = 0; i < kFallbackThreads; ++i) {
+      threads_.emplace_back([this, i] {
+        setThreadName(fmt::format("file_io.{}", i));
+        runFallback();
+      });
+    }
+  }
+
+  AsyncFileIo::~AsyncFileIo() {
+    {
+      std::unique_lock lock{mutex_};
+      cv_.wait(lock, [&] { return pending_.empty() and in_flight_ == 0; });
+      stop_ = true;
+#ifdef __linux__
+      if (ring_) {
+        auto &sqe = ring_->push();
+        sqe.opcode = IORING_OP_NOP;
+        sqe.user_data = kWakeReaper;
+        ring_->submit();
+      }
+#endif
+    }
+    cv_.notify_all();
+    for (auto &thread : threads_) {
+      thread.join();
+    }
+  }
+
+  outcome::result<void> AsyncFileIo::registerBuffers(
+      std::span<const std::span<uint8_t>> buffers) {
+#ifdef __linux__
+    if (not ring_) {
+      return outcome::success();
+    }
+    std::vector<iovec> iovecs;
+    iovecs.reserve(buffers.size());
+    for (auto &buffer : buffers) {
+      iovecs.emplace_back(iovec{buffer.data(), buffer.size()});
+    }
+    std::lock_guard lock{mutex_};
+    ::syscall(__NR_io_uring_register,
+              ring_->fd,
+              IORING_UNREGISTER_BUFFERS,
+              nullptr,
+              0);
+    if (iovecs.empty()) {
+      return outcome::success();
+    }
+    if (::syscall(__NR_io_uring_register,
+                  ring_->fd,
+                  IORING_REGISTER_BUFFERS,
+                  iovecs.data(),
+                  iovecs.size())
+        < 0) {
+      return lastError();
+    }
+#endif
+    return outcome::success();
+  }
+
+  void AsyncFileIo::submit(std::vector<Request> batch,
+                           boost::asio::any_io_executor executor,
+                           Handler handler) {
+    if (batch.empty()) {
+      boost::asio::post(executor, [handler{std::move(handler)}] {
+        handler({});
+      });
+      return;
+    }
+    auto size = batch.size();
+    auto *state = new Batch{
+        .requests = std::move(batch),
+        .done = std::vector<size_t>(size),
+        .results = Results(size, outcome::success(0)),
+        .slots = {},
+        .remaining = size,
+        // Keeps io context running until handler is posted
+        .executor = boost::asio::prefer(
+            std::move(executor),
+            boost::asio::execution::outstanding_work.tracked),
+        .handler = std::move(handler),
+    };
+    state->slots.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+      state->slots.emplace_back(Pending{state, i});
+    }
+    {
+      std::lock_guard lock{mutex_};
+      pending_.insert(pending_.end(), state->slots.begin(), state->slots.end());
+      if (ring_) {
+        fill();
+        return;
+      }
+    }
+    cv_.notify_all();
+  }
+
+  void AsyncFileIo::complete(Batch *batch,
+                             size_t index,
+                             outcome::result<size_t> result) {
+    batch->results[index] = result;
+    if (--batch->remaining != 0) {
+      return;
+    }
+    std::unique_ptr<Batch> owned{batch};
+    auto executor = std::move(owned->executor);
+    boost::asio::post(executor,
+                      [handler{std::move(owned->handler)},
+                       results{std::move(owned->results)}]() mutable {
+                        handler(std::move(results));
+                      });
+  }
+
+  void AsyncFileIo::fill() {
+#ifdef __linux__
+    uint32_t pushed = 0;
+    while (not pending_.empty() and in_flight_ < queue_depth_) {
+      auto [batch, index] = pending_.front();
+      pending_.pop_front();
+      auto &request = batch->requests[index];
+      auto done = batch->done[index];
+      auto &sqe = ring_->push();
+      if (request.fixed_buffer.has_value()) {
+        sqe.opcode =
+            request.write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+        sqe.buf_index = *request.fixed_buffer;
+      } else {
+        sqe.opcode = request.write ? IORING_OP_WRITE : IORING_OP_READ;
+      }
+      sqe.fd = request.fd;
+      sqe.off = request.offset + done;
+      sqe.addr = reinterpret_cast<uint64_t>(request.buffer.data() + done);
+      sqe.len = static_cast<uint32_t>(
+          std::min(request.buffer.size() - done, kMaxTransfer));
+      sqe.user_data = reinterpret_cast<uint64_t>(&batch->slots[index]);
+      ++in_flight_;
+      ++pushed;
+    }
+    if (pushed != 0 or ring_->unsubmitted != 0) {
+      ring_->submit();
+    }
+#endif
+  }
+
+  void AsyncFileIo::reap() {
+#ifdef __linux__
+    struct Completion {
+      Pending *slot;
+      int32_t res;
+    };
+    std::vector<Completion> completions;
+    auto stop = false;
+    while (not stop) {
+      ::syscall(__NR_io_uring_enter,
+                ring_->fd,
+                0,
+                1,
+                IORING_ENTER_GETEVENTS,
+                nullptr,
+                0);
+      auto head = *ring_->cq_head;
+      auto tail =
+          std::atomic_ref{*ring_->cq_tail}.load(std::memory_order_acquire);
+      completions.clear();
+      for (; head != tail; ++head) {
+        auto &cqe = ring_->cqes[head & ring_->cq_mask];
+        if (cqe.user_data == kWakeReaper) {
+          stop = true;
+          continue;
+        }
+        completions.emplace_back(Completion{
+            reinterpret_cast<Pending *>(cqe.user_data), cqe.res});
+      }
+      std::atomic_ref{*ring_->cq_head}.store(head, std::memory_order_release);
+
+      std::vector<std::pair<Pending, outcome::result<size_t>>> finished;
+      {
+        std::lock_guard lock{mutex_};
+        for (auto &[slot, res] : completions) {
+          --in_flight_;
+          auto &[batch, index] = *slot;
+          auto &done = batch->done[index];
+          if (res < 0) {
+            finished.emplace_back(
+                *slot, std::error_code{-res, std::generic_category()});
+            continue;
+          }
+          done += static_cast<size_t>(res);
+          // Short transfer continues, unless end of file is reached
+          if (res != 0 and done < batch->requests[index].buffer.size()) {
+            pending_.push_front(*slot);
+            continue;
+          }
+          finished.emplace_back(*slot, done);
+        }
+        fill();
+      }
+      cv_.notify_all();
+      for (auto &[slot, result] : finished) {
+        complete(slot.batch, slot.index, result);
+      }
+    }
+#endif
+  }
+
+  void AsyncFileIo::runFallback() {
+    while (true) {
+      Pending slot{};
+      {
+        std::unique_lock lock{mutex_};
+        cv_.wait(lock, [&] { return stop_ or not pending_.empty(); });
+        if (pending_.empty()) {
+          return;
+        }
+        slot = pending_.front();
+        pending_.pop_front();
+        ++in_flight_;
+      }
+      auto &request = slot.batch->requests[slot.index];
+      size_t done = 0;
+      outcome::result<size_t> result = outcome::success(0);
+      while (done < request.buffer.size()) {
+        auto *data = request.buffer.data() + done;
+        auto size = std::min(request.buffer.size() - done, kMaxTransfer);
+        auto offset = static_cast<off_t>(request.offset + done);
+        auto n = request.write ? ::pwrite(request.fd, data, size, offset)
+                               : ::pread(request.fd, data, size, offset);
+        if (n < 0 and errno == EINTR) {
+          continue;
+        }
+        if (n < 0) {
+          result = lastError();
+          break;
+        }
+        if (n == 0) {
+          break;
+        }
+        done += static_cast<size_t>(n);
+      }
+      if (result.has_value()) {
+        result = done;
+      }
+      complete(slot.batch, slot.index, result);
+      {
+        std::lock_guard lock{mutex_};
+        --in_flight_;
+      }
+      cv_.notify_all();
+    }
+  }
+
+}  // namespace lean
@@ -0,0 +1,133 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/async_result.hpp>
+#include <qtils/outcome.hpp>
+
+namespace lean {
+
+  /**
+   * Batched positional file reads and writes, completed on asio executor,
+   * so large file work of event loop thread doesn't block it.
+   *
+   * Uses io_uring on Linux, whole batch is submitted with single syscall
+   * and completions are reaped by own thread. If io_uring is unavailable,
+   * e.g. disabled by seccomp or sysctl, requests run on own threads with
+   * `pread`/`pwrite`.
+   *
+   * Requests of batch are not ordered. Submission never blocks, requests
+   * beyond queue depth wait in queue.
+   */
+  class AsyncFileIo {
+   public:
+    static constexpr uint32_t kDefaultQueueDepth = 64;
+    static constexpr size_t kFallbackThreads = 4;
+
+    struct Request {
+      int fd;
+      uint64_t offset;
+      /// Read into or written from until end of file or error
+      std::span<uint8_t> buffer;
+      bool write = false;
+      /// Index of registered buffer containing `buffer`
+      std::optional<uint16_t> fixed_buffer;
+    };
+    /// Bytes transferred by each request of batch, less at end of file
+    using Results = std::vector<outcome::result<size_t>>;
+    using Handler = std::function<void(Results)>;
+
+    /// @param use_io_uring false forces thread fallback, e.g. in tests
+    explicit AsyncFileIo(uint32_t queue_depth = kDefaultQueueDepth,
+                         bool use_io_uring = true);
+
+    AsyncFileIo(const AsyncFileIo &) = delete;
+    AsyncFileIo &operator=(const AsyncFileIo &) = delete;
+
+    /// Waits for submitted requests, their handlers are still posted
+    ~AsyncFileIo();
+
+    /// Whether requests go through io_uring
+    bool ioUring() const {
+      return ring_ != nullptr;
+    }
+
+    /**
+     * Register buffers, so kernel doesn't map pages of their requests each
+     * time. Replaces previously registered buffers, must be called without
+     * fixed requests in flight.
+     */
+    outcome::result<void> registerBuffers(
+        std::span<const std::span<uint8_t>> buffers);
+
+    /// Run `batch`, then post `handler` with results to `executor`
+    void submit(std::vector<Request> batch,
+                boost::asio::any_io_executor executor,
+                Handler handler);
+
+    /// `submit` with completion token, e.g. `boost::asio::use_awaitable`
+    template <typename Token>
+    auto asyncSubmit(std::vector<Request> batch,
+                     boost::asio::any_io_executor executor,
+                     Token &&token) {
+      return boost::asio::async_initiate<Token, void(Results)>(
+          [this](auto handler,
+                 std::vector<Request> batch,
+                 boost::asio::any_io_executor executor) {
+            // Handler of token may be move-only
+            auto shared =
+                std::make_shared<decltype(handler)>(std::move(handler));
+            submit(std::move(batch),
+                   std::move(executor),
+                   [shared](Results results) {
+                     std::move (*shared)(std::move(results));
+                   });
+          },
+          token,
+          std::move(batch),
+          std::move(executor));
+    }
+
+   private:
+    struct Batch;
+    struct Ring;
+    /// Request of batch waiting for io_uring queue slot or fallback thread
+    struct Pending {
+      Batch *batch;
+      size_t index;
+    };
+
+    void complete(Batch *batch, size_t index, outcome::result<size_t> result);
+    /// Move pending requests into submission queue, under `mutex_`
+    void fill();
+    void reap();
+    void runFallback();
+
+    std::unique_ptr<Ring> ring_;
+    uint32_t queue_depth_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Pending> pending_;
+    /// Requests in io_uring queue
+    uint32_t in_flight_ = 0;
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+  };
+
+}  // namespace lean
@@ -0,0 +1,104 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include <qtils/bytes.hpp>
+
+namespace lean {
+
+  /**
+   * Blocked bloom filter for keys which are already hashes, e.g. block
+   * hashes.
+   *
+   * Key sets one bit in each of 8 words of single 64-byte block, so lookup
+   * touches one cache line. With 10 bits per key false positive rate is
+   * about 1%.
+   *
+   * Inserts and lookups are thread safe, bits are set with relaxed atomics.
+   */
+  class BlockedBloomFilter {
+   public:
+    static constexpr size_t kBitsPerKey = 10;
+
+    explicit BlockedBloomFilter(size_t capacity)
+        : size_{std::max<size_t>(
+              1, (capacity * kBitsPerKey + kBlockBits - 1) / kBlockBits)},
+          blocks_{std::make_unique<Block[]>(size_)} {}
+
+    BlockedBloomFilter(const BlockedBloomFilter &) = delete;
+    BlockedBloomFilter &operator=(const BlockedBloomFilter &) = delete;
+
+    void insert(qtils::BytesIn key) {
+      auto [block, bits] = locate(key);
+      for (size_t i = 0; i < kWords; ++i) {
+        block.words[i].fetch_or(bits[i], std::memory_order_relaxed);
+      }
+    }
+
+    /// False if key was never inserted
+    bool mayContain(qtils::BytesIn key) const {
+      auto [block, bits] = locate(key);
+      for (size_t i = 0; i < kWords; ++i) {
+        auto word = block.words[i].load(std::memory_order_relaxed);
+        if ((word & bits[i]) != bits[i]) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    size_t byteSize() const {
+      return size_ * sizeof(Block);
+    }
+
+   private:
+    static constexpr size_t kWords = 8;
+    static constexpr size_t kBlockBits = kWords * 64;
+
+    struct alignas(64) Block {
+      std::array<std::atomic_uint64_t, kWords> words{};
+    };
+
+    static uint64_t mix(uint64_t x) {
+      // splitmix64 finalizer, in case key is not uniform
+      x ^= x >> 30;
+      x *= 0xbf58476d1ce4e5b9;
+      x ^= x >> 27;
+      x *= 0x94d049bb133111eb;
+      x ^= x >> 31;
+      return x;
+    }
+
+    std::pair<Block &, std::array<uint64_t, kWords>> locate(
+        qtils::BytesIn key) const {
+      std::array<uint64_t, 2> halves{};
+      std::memcpy(halves.data(),
+                  key.data(),
+                  std::min(key.size(), sizeof(halves)));
+      auto h1 = mix(halves[0] ^ key.size());
+      auto h2 = mix(halves[1] ^ h1);
+      auto index = static_cast<size_t>(
+          (static_cast<unsigned __int128>(h1) * size_) >> 64);
+      std::array<uint64_t, kWords> bits{};
+      for (size_t i = 0; i < kWords; ++i) {
+        bits[i] = uint64_t{1} << ((h2 >> (6 * i)) & 63);
+      }
+      return {blocks_[index], bits};
+    }
+
+    size_t size_;
+    std::unique_ptr<Block[]> blocks_;
+  };
+
+}  // namespace lean
@@ -0,0 +1,217 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/asio/use_awaitable.hpp>
+
+namespace lean {
+
+  /**
+   * Bounded multi-producer single-consumer channel between pipeline stages.
+   *
+   * Unlike single-slot `Channel`, keeps up to `capacity` values and makes
+   * overflow explicit: `trySend` fails when full, `send` waits for space or
+   * drops value by policy. Consumer takes values in batches, blocking with
+   * `receiveBatch` or from coroutine with `asyncReceiveBatch`, which doesn't
+   * occupy thread of executor while waiting.
+   *
+   * Producers on io thread must not wait, they use `trySend` or dropping
+   * policy.
+   */
+  template <typename T>
+  class BoundedChannel {
+   public:
+    /// What `send` does when channel is full
+    enum class Overflow : uint8_t {
+      /// Wait for consumer to free space
+      Wait,
+      /// Drop value being sent
+      DropNewest,
+      /// Drop oldest queued value to make space
+      DropOldest,
+    };
+
+    explicit BoundedChannel(size_t capacity, Overflow overflow = Overflow::Wait)
+        : capacity_{std::max<size_t>(capacity, 1)}, overflow_{overflow} {}
+
+    BoundedChannel(const BoundedChannel &) = delete;
+    BoundedChannel &operator=(const BoundedChannel &) = delete;
+
+    size_t capacity() const {
+      return capacity_;
+    }
+
+    size_t size() const {
+      std::lock_guard lock{mutex_};
+      return queue_.size();
+    }
+
+    /// Values dropped by overflow policy
+    size_t dropped() const {
+      std::lock_guard lock{mutex_};
+      return dropped_;
+    }
+
+    /// @return false if channel is full or closed, `value` is not moved from
+    bool trySend(T &&value) {
+      std::unique_lock lock{mutex_};
+      if (closed_ or queue_.size() >= capacity_) {
+        return false;
+      }
+      push(lock, std::move(value));
+      return true;
+    }
+
+    /// @return false if channel is closed or value was dropped
+    bool send(T &&value) {
+      std::unique_lock lock{mutex_};
+      if (closed_) {
+        return false;
+      }
+      if (queue_.size() >= capacity_) {
+        switch (overflow_) {
+          case Overflow::Wait:
+            not_full_.wait(lock, [&] {
+              return closed_ or queue_.size() < capacity_;
+            });
+            if (closed_) {
+              return false;
+            }
+            break;
+          case Overflow::DropNewest:
+            ++dropped_;
+            return false;
+          case Overflow::DropOldest:
+            queue_.pop_front();
+            ++dropped_;
+            break;
+        }
+      }
+      push(lock, std::move(value));
+      return true;
+    }
+
+    /// Up to `max` queued values, oldest first, without waiting
+    std::vector<T> tryReceiveBatch(size_t max) {
+      std::unique_lock lock{mutex_};
+      return pop(lock, max);
+    }
+
+    /// Wait for values, empty only if channel is closed and drained
+    std::vector<T> receiveBatch(size_t max) {
+      std::unique_lock lock{mutex_};
+      not_empty_.wait(lock, [&] { return closed_ or not queue_.empty(); });
+      return pop(lock, max);
+    }
+
+    /**
+     * Await values from coroutine, empty only if closed and drained.
+     * Executor of coroutine must be serial, e.g. io_context run by single
+     * thread or strand.
+     */
+    boost::asio::awaitable<std::vector<T>> asyncReceiveBatch(size_t max) {
+      auto executor = co_await boost::asio::this_coro::executor;
+      auto timer = std::make_shared<boost::asio::steady_timer>(executor);
+      for (;;) {
+        timer->expires_at(boost::asio::steady_timer::time_point::max());
+        {
+          std::unique_lock lock{mutex_};
+          if (closed_ or not queue_.empty()) {
+            waker_.reset();
+            co_return pop(lock, max);
+          }
+          waker_ = timer;
+        }
+        // Woken by expiry set on send or close, even if set before wait
+        boost::system::error_code ec;
+        co_await timer->async_wait(
+            boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+      }
+    }
+
+    /// Wake consumer and waiting producers, further sends fail
+    void close() {
+      std::shared_ptr<boost::asio::steady_timer> waker;
+      {
+        std::lock_guard lock{mutex_};
+        closed_ = true;
+        waker = std::move(waker_);
+      }
+      not_empty_.notify_all();
+      not_full_.notify_all();
+      wake(std::move(waker));
+    }
+
+    bool closed() const {
+      std::lock_guard lock{mutex_};
+      return closed_;
+    }
+
+   private:
+    void push(std::unique_lock<std::mutex> &lock, T &&value) {
+      queue_.emplace_back(std::move(value));
+      auto waker = std::move(waker_);
+      lock.unlock();
+      not_empty_.notify_one();
+      wake(std::move(waker));
+    }
+
+    std::vector<T> pop(std::unique_lock<std::mutex> &lock, size_t max) {
+      std::vector<T> values;
+      auto count = std::min(max, queue_.size());
+      values.reserve(count);
+      for (size_t i = 0; i < count; ++i) {
+        values.emplace_back(std::move(queue_.front()));
+        queue_.pop_front();
+      }
+      lock.unlock();
+      if (count != 0) {
+        not_full_.notify_all();
+      }
+      return values;
+    }
+
+    /// Timer is expired on its executor, as timers aren't thread safe
+    static void wake(std::shared_ptr<boost::asio::steady_timer> waker) {
+      if (not waker) {
+        return;
+      }
+      auto executor = waker->get_executor();
+      boost::asio::post(executor, [waker{std::move(waker)}] {
+        waker->expires_at(boost::asio::steady_timer::time_point::min());
+      });
+    }
+
+    const size_t capacity_;
+    const Overflow overflow_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<T> queue_;
+    size_t dropped_ = 0;
+    bool closed_ = false;
+    /// Timer coroutine consumer waits on
+    std::shared_ptr<boost::asio::steady_timer> waker_;
+  };
+
+}  // namespace lean
@@ -0,0 +1,52 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+
+namespace lean {
+
+  /**
+   * Copy-on-write value.
+   * Copies share same value until one of them is modified through `mut`.
+   * Moving is copying, so moved-from object keeps valid value.
+   */
+  template <typename T>
+  class Cow {
+   public:
+    Cow() : value_{std::make_shared<T>()} {}
+
+    explicit Cow(T value) : value_{std::make_shared<T>(std::move(value))} {}
+
+    Cow(const Cow &) = default;
+    Cow &operator=(const Cow &) = default;
+
+    const T &operator*() const {
+      return *value_;
+    }
+
+    const T *operator->() const {
+      return value_.get();
+    }
+
+    /// Value for modification, copied first if shared
+    T &mut() {
+      if (value_.use_count() != 1) {
+        value_ = std::make_shared<T>(*value_);
+      }
+      return *value_;
+    }
+
+    bool operator==(const Cow &other) const {
+      return value_ == other.value_ or *value_ == *other.value_;
+    }
+
+   private:
+    std::shared_ptr<T> value_;
+  };
+
+}  // namespace lean
@@ -0,0 +1,246 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/cpu_profiler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fmt/format.h>
+
+#ifdef __linux__
+#include <csignal>
+#include <ctime>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+#endif
+
+namespace lean {
+
+#ifdef __linux__
+
+  namespace {
+    constexpr size_t kMaxFrames = 64;
+    /// Bound of sample buffer, about 17 MiB
+    constexpr size_t kMaxSamples = 1 << 15;
+    /// Frames of signal handler and its trampoline
+    constexpr int kHandlerFrames = 2;
+
+    struct Sample {
+      std::array<void *, kMaxFrames> frames;
+      int size;
+      pid_t tid;
+    };
+
+    /// Profile in progress, shared with signal handler
+    struct Profile {
+      std::vector<Sample> samples;
+      std::atomic_size_t next = 0;
+      std::atomic_bool active = false;
+      /// Handlers running, waited for before samples are read
+      std::atomic_int running = 0;
+    };
+
+    Profile profile;
+
+    void onSignal(int) {
+      auto saved_errno = errno;
+      profile.running.fetch_add(1);
+      if (profile.active.load()) {
+        auto i = profile.next.fetch_add(1);
+        if (i < profile.samples.size()) {
+          auto &sample = profile.samples[i];
+          sample.size = backtrace(sample.frames.data(), kMaxFrames);
+          // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+          sample.tid = static_cast<pid_t>(syscall(SYS_gettid));
+        }
+      }
+      profile.running.fetch_sub(1);
+      errno = saved_errno;
+    }
+
+    void install() {
+      // First call of `backtrace` loads unwinder, not safe in handler
+      std::array<void *, 1> frame{};
+      backtrace(frame.data(), frame.size());
+      // Handler stays installed, signals of deleted timers may be pending
+      struct sigaction action{};
+      action.sa_handler = onSignal;
+      action.sa_flags = SA_RESTART;
+      sigemptyset(&action.sa_mask);
+      sigaction(SIGPROF, &action, nullptr);
+    }
+
+    /// CPU clock of thread by its id, as `pthread_getcpuclockid` makes it
+    clockid_t threadCpuClock(pid_t tid) {
+      constexpr clockid_t kPerThread = 4;
+      constexpr clockid_t kSched = 2;
+      return (~static_cast<clockid_t>(tid) << 3) | kPerThread | kSched;
+    }
+
+    /// Threads of process with their OS names
+    std::unordered_map<pid_t, std::string> processThreads() {
+      std::unordered_map<pid_t, std::string> threads;
+      std::error_code ec;
+      for (auto &entry :
+           std::filesystem::directory_iterator{"/proc/self/task", ec}) {
+        pid_t tid = 0;
+        auto file_name = entry.path().filename().string();
+        auto end = file_name.data() + file_name.size();
+        if (std::from_chars(file_name.data(), end, tid).ptr != end) {
+          continue;
+        }
+        std::ifstream comm{entry.path() / "comm"};
+        std::getline(comm, threads[tid]);
+      }
+      return threads;
+    }
+
+    std::string symbolize(void *address) {
+      Dl_info info{};
+      if (dladdr(address, &info) == 0) {
+        return fmt::format("{}", address);
+      }
+      if (info.dli_sname == nullptr) {
+        auto offset = static_cast<char *>(address)
+                    - static_cast<char *>(info.dli_fbase);
+        return fmt::format(
+            "{}+{:#x}",
+            std::filesystem::path{info.dli_fname}.filename().string(),
+            offset);
+      }
+      int status = 0;
+      std::unique_ptr<char, decltype(&free)> demangled{
+          abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status),
+          &free};
+      return status == 0 ? demangled.get() : info.dli_sname;
+    }
+  }  // namespace
+
+  outcome::result<std::string> profileCpu(std::chrono::milliseconds duration,
+                                          uint32_t frequency,
+                                          const ThreadNames &thread_names) {
+    static std::once_flag installed;
+    std::call_once(installed, install);
+    static std::mutex mutex;
+    std::unique_lock lock{mutex, std::try_to_lock};
+    if (not lock.owns_lock()) {
+      return CpuProfilerError::BUSY;
+    }
+    frequency = std::max<uint32_t>(frequency, 1);
+
+    auto threads = processThreads();
+    // Samples of all threads are limited by CPU time of process
+    auto cpus = std::max(std::thread::hardware_concurrency(), 1u);
+    auto expected = std::chrono::duration<double>(duration).count()
+                  * frequency * cpus;
+    profile.samples.resize(
+        std::min(kMaxSamples, static_cast<size_t>(expected) + 1));
+    profile.next = 0;
+    profile.active = true;
+
+    itimerspec period{};
+    period.it_interval.tv_nsec = 1'000'000'000 / frequency;
+    if (frequency == 1) {
+      period.it_interval = {.tv_sec = 1, .tv_nsec = 0};
+    }
+    period.it_value = period.it_interval;
+    std::vector<timer_t> timers;
+    for (auto &tid : threads | std::views::keys) {
+      sigevent event{};
+      event.sigev_notify = SIGEV_THREAD_ID;
+      event.sigev_signo = SIGPROF;
+      event.sigev_notify_thread_id = tid;
+      timer_t timer{};
+      // Thread might have exited since listed
+      if (timer_create(threadCpuClock(tid), &event, &timer) != 0) {
+        continue;
+      }
+      timers.emplace_back(timer);
+      timer_settime(timer, 0, &period, nullptr);
+    }
+    if (not timers.empty()) {
+      std::this_thread::sleep_for(duration);
+    }
+    for (auto &timer : timers) {
+      timer_delete(timer);
+    }
+    profile.active = false;
+    while (profile.running.load() != 0) {
+      std::this_thread::yield();
+    }
+    if (timers.empty()) {
+      return CpuProfilerError::TIMER;
+    }
+
+    auto count = std::min(profile.next.load(), profile.samples.size());
+    std::unordered_map<void *, std::string> symbols;
+    std::unordered_map<pid_t, std::string> names;
+    std::map<std::string, size_t> stacks;
+    std::string stack;
+    for (auto &sample : std::span{profile.samples}.first(count)) {
+      auto name_it = names.find(sample.tid);
+      if (name_it == names.end()) {
+        auto name = thread_names ? thread_names(sample.tid) : std::nullopt;
+        if (not name) {
+          auto thread_it = threads.find(sample.tid);
+          name = thread_it != threads.end() ? thread_it->second
+                                            : std::to_string(sample.tid);
+        }
+        name_it = names.emplace(sample.tid, std::move(*name)).first;
+      }
+      stack = name_it->second;
+      for (auto i = sample.size - 1; i >= kHandlerFrames; --i) {
+        auto address = sample.frames.at(i);
+        auto symbol_it = symbols.find(address);
+        if (symbol_it == symbols.end()) {
+          symbol_it = symbols.emplace(address, symbolize(address)).first;
+        }
+        stack += ';';
+        stack += symbol_it->second;
+      }
+      ++stacks[stack];
+    }
+    std::vector<Sample>{}.swap(profile.samples);
+
+    std::string folded;
+    for (auto &[frames, samples] : stacks) {
+      fmt::format_to(std::back_inserter(folded), "{} {}\n", frames, samples);
+    }
+    return folded;
+  }
+
+#else
+
+  outcome::result<std::string> profileCpu(std::chrono::milliseconds,
+                                          uint32_t,
+                                          const ThreadNames &) {
+    return CpuProfilerError::UNSUPPORTED;
+  }
+
+#endif
+
+}  // namespace lean
@@ -0,0 +1,55 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+
+#include <qtils/enum_error_code.hpp>
+#include <qtils/outcome.hpp>
+
+namespace lean {
+  enum class CpuProfilerError : uint8_t {
+    BUSY = 1,
+    UNSUPPORTED,
+    TIMER,
+  };
+  Q_ENUM_ERROR_CODE(CpuProfilerError) {
+    using E = decltype(e);
+    switch (e) {
+      case E::BUSY:
+        return "CPU profiling is already running";
+      case E::UNSUPPORTED:
+        return "CPU profiling is not supported on platform";
+      case E::TIMER:
+        return "Can't create CPU time timer";
+    }
+    abort();
+  }
+
+  /// Name of thread by platform id, nullopt to use its OS name
+  using ThreadNames = std::function<std::optional<std::string>(uint64_t)>;
+
+  /**
+   * Sample stacks of all threads of process by their CPU time.
+   *
+   * Each thread gets timer of its CPU clock firing `frequency` times per CPU
+   * second, signal handler records return addresses into buffer allocated
+   * before start. So idle threads are not sampled, and samples are
+   * symbolized only after `duration`. Timers exist only while profiling,
+   * there is no cost otherwise. Threads started later are not sampled.
+   *
+   * @return folded stacks, "thread;outermost;...;innermost count" per line,
+   * as flamegraph.pl and speedscope take them
+   */
+  outcome::result<std::string> profileCpu(std::chrono::milliseconds duration,
+                                          uint32_t frequency,
+                                          const ThreadNames &thread_names);
+}  // namespace lean
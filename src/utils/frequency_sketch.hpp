@@ -0,0 +1,98 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace lean {
+
+  /**
+   * Count-min sketch of recent key frequencies, for TinyLFU admission.
+   *
+   * Key increments one 4-bit counter in each of 4 rows, its frequency is
+   * minimum of them, so collisions only overestimate. After 10 increments
+   * per key of capacity all counters are halved, so frequency follows
+   * recent accesses, not whole history.
+   *
+   * Not thread safe.
+   */
+  class FrequencySketch {
+   public:
+    static constexpr uint8_t kMaxFrequency = 15;
+
+    explicit FrequencySketch(size_t capacity)
+        : table_(std::bit_ceil(std::max<size_t>(capacity, 16)) / 4),
+          mask_{table_.size() * kCountersPerWord - 1},
+          sample_size_{10 * std::max<size_t>(capacity, 1)} {}
+
+    /// Count access to key with hash `hash`
+    void increment(uint64_t hash) {
+      auto incremented = false;
+      for (size_t row = 0; row < kRows; ++row) {
+        auto [word, shift] = locate(hash, row);
+        if (((table_[word] >> shift) & kMaxFrequency) != kMaxFrequency) {
+          table_[word] += uint64_t{1} << shift;
+          incremented = true;
+        }
+      }
+      if (incremented and ++additions_ >= sample_size_) {
+        reset();
+      }
+    }
+
+    /// Estimated recent accesses of key with hash `hash`, up to 15
+    uint8_t frequency(uint64_t hash) const {
+      auto frequency = kMaxFrequency;
+      for (size_t row = 0; row < kRows; ++row) {
+        auto [word, shift] = locate(hash, row);
+        frequency = std::min<uint8_t>(
+            frequency, (table_[word] >> shift) & kMaxFrequency);
+      }
+      return frequency;
+    }
+
+    size_t byteSize() const {
+      return table_.size() * sizeof(uint64_t);
+    }
+
+   private:
+    static constexpr size_t kRows = 4;
+    static constexpr size_t kCountersPerWord = 16;
+
+    static uint64_t mix(uint64_t x) {
+      // splitmix64 finalizer, as `std::hash` of integers is identity
+      x ^= x >> 30;
+      x *= 0xbf58476d1ce4e5b9;
+      x ^= x >> 27;
+      x *= 0x94d049bb133111eb;
+      x ^= x >> 31;
+      return x;
+    }
+
+    std::pair<size_t, size_t> locate(uint64_t hash, size_t row) const {
+      auto index = mix(hash + row * 0x9e3779b97f4a7c15) & mask_;
+      return {index / kCountersPerWord, (index % kCountersPerWord) * 4};
+    }
+
+    /// Halve all counters
+    void reset() {
+      for (auto &word : table_) {
+        word = (word >> 1) & 0x7777777777777777;
+      }
+      additions_ /= 2;
+    }
+
+    std::vector<uint64_t> table_;
+    size_t mask_;
+    size_t sample_size_;
+    size_t additions_ = 0;
+  };
+
+}  // namespace lean
@@ -0,0 +1,217 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/heap.hpp"
+
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(QLEAN_ALLOCATOR_JEMALLOC)
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <sstream>
+
+#include <jemalloc/jemalloc.h>
+#include <unistd.h>
+#elif defined(QLEAN_ALLOCATOR_MIMALLOC)
+#include <mimalloc.h>
+#elif defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace lean {
+
+#if defined(QLEAN_ALLOCATOR_JEMALLOC)
+
+  namespace {
+    /// Value of jemalloc control, zero if it is not available
+    template <typename T>
+    T readControl(const char *name) {
+      T value{};
+      auto size = sizeof(value);
+      if (mallctl(name, &value, &size, nullptr, 0) != 0) {
+        return T{};
+      }
+      return value;
+    }
+  }  // namespace
+
+  std::string_view heapAllocator() {
+    return "jemalloc";
+  }
+
+  std::optional<HeapStats> heapStats() {
+    // Statistics are cached by jemalloc until epoch is advanced
+    uint64_t epoch = 1;
+    auto size = sizeof(epoch);
+    mallctl("epoch", &epoch, &size, &epoch, size);
+    HeapStats stats{
+        .allocated = readControl<size_t>("stats.allocated"),
+        .active = readControl<size_t>("stats.active"),
+        .resident = readControl<size_t>("stats.resident"),
+        .retained = readControl<size_t>("stats.retained"),
+    };
+    auto page = readControl<size_t>("arenas.page");
+    auto arenas = readControl<unsigned>("arenas.narenas");
+    stats.arenas.reserve(arenas);
+    for (unsigned arena = 0; arena < arenas; ++arena) {
+      auto name = std::format("stats.arenas.{}.pactive", arena);
+      stats.arenas.emplace_back(readControl<size_t>(name.c_str()) * page);
+    }
+    return stats;
+  }
+
+  void purgeHeap() {
+    auto name = std::format("arena.{}.purge", MALLCTL_ARENAS_ALL);
+    mallctl(name.c_str(), nullptr, nullptr, nullptr, 0);
+  }
+
+  outcome::result<std::string> heapProfile() {
+    std::string out;
+    if (not readControl<bool>("opt.prof")) {
+      malloc_stats_print(
+          [](void *arg, const char *text) {
+            static_cast<std::string *>(arg)->append(text);
+          },
+          &out,
+          nullptr);
+      return out;
+    }
+    auto path = std::filesystem::temp_directory_path()
+              / std::format("qlean.{}.heap", getpid());
+    auto *filename = path.c_str();
+    if (mallctl("prof.dump", nullptr, nullptr, &filename, sizeof(filename))
+        != 0) {
+      return HeapError::PROFILE;
+    }
+    std::ifstream file{path, std::ios::binary};
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    return buffer.str();
+  }
+
+#elif defined(QLEAN_ALLOCATOR_MIMALLOC)
+
+  std::string_view heapAllocator() {
+    return "mimalloc";
+  }
+
+  std::optional<HeapStats> heapStats() {
+    // Allocated bytes are counted only by debug build of mimalloc
+    HeapStats stats;
+    mi_process_info(nullptr,
+                    nullptr,
+                    nullptr,
+                    &stats.resident,
+                    nullptr,
+                    &stats.active,
+                    nullptr,
+                    nullptr);
+    return stats;
+  }
+
+  void purgeHeap() {
+    mi_collect(true);
+  }
+
+  outcome::result<std::string> heapProfile() {
+    std::string out;
+    mi_stats_print_out(
+        [](const char *text, void *arg) {
+          static_cast<std::string *>(arg)->append(text);
+        },
+        &out);
+    return out;
+  }
+
+#elif defined(__GLIBC__)
+
+  namespace {
+    /// Size of `<system type="current">` of each `<heap>` of `malloc_info`
+    std::vector<size_t> arenaSizes(std::string_view info) {
+      constexpr std::string_view kHeap{"<heap nr="};
+      constexpr std::string_view kCurrent{"<system type=\"current\" size=\""};
+      std::vector<size_t> sizes;
+      for (auto pos = info.find(kHeap); pos != std::string_view::npos;
+           pos = info.find(kHeap, pos)) {
+        auto end = info.find("</heap>", pos);
+        auto current = info.find(kCurrent, pos);
+        if (end == std::string_view::npos or current > end) {
+          break;
+        }
+        auto *begin = info.data() + current + kCurrent.size();
+        size_t size = 0;
+        std::from_chars(begin, info.data() + end, size);
+        sizes.emplace_back(size);
+        pos = end;
+      }
+      return sizes;
+    }
+  }  // namespace
+
+  std::string_view heapAllocator() {
+    return "glibc";
+  }
+
+  std::optional<HeapStats> heapStats() {
+    // glibc doesn't know which of its pages are resident
+    auto info = mallinfo2();
+    HeapStats stats{
+        .allocated = info.uordblks + info.hblkhd,
+        .active = info.arena + info.hblkhd,
+        .retained = info.fordblks,
+    };
+    if (auto report = heapProfile(); report.has_value()) {
+      stats.arenas = arenaSizes(report.value());
+    }
+    return stats;
+  }
+
+  void purgeHeap() {
+    malloc_trim(0);
+  }
+
+  outcome::result<std::string> heapProfile() {
+    char *buffer = nullptr;
+    size_t size = 0;
+    auto *stream = open_memstream(&buffer, &size);
+    if (stream == nullptr) {
+      return HeapError::PROFILE;
+    }
+    auto res = malloc_info(0, stream);
+    fclose(stream);
+    std::string out{buffer, size};
+    // NOLINTNEXTLINE(cppcoreguidelines-no-malloc)
+    free(buffer);
+    if (res != 0) {
+      return HeapError::PROFILE;
+    }
+    return out;
+  }
+
+#else
+
+  std::string_view heapAllocator() {
+    return "system";
+  }
+
+  std::optional<HeapStats> heapStats() {
+    return std::nullopt;
+  }
+
+  void purgeHeap() {}
+
+  outcome::result<std::string> heapProfile() {
+    return HeapError::UNSUPPORTED;
+  }
+
+#endif
+
+}  // namespace lean
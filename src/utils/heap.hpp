@@ -0,0 +1,65 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <qtils/enum_error_code.hpp>
+#include <qtils/outcome.hpp>
+
+namespace lean {
+  enum class HeapError : uint8_t {
+    UNSUPPORTED = 1,
+    PROFILE,
+  };
+  Q_ENUM_ERROR_CODE(HeapError) {
+    using E = decltype(e);
+    switch (e) {
+      case E::UNSUPPORTED:
+        return "Heap statistics are not supported by allocator";
+      case E::PROFILE:
+        return "Can't write heap profile";
+    }
+    abort();
+  }
+
+  /// Memory of heap allocator, field is zero if allocator doesn't report it
+  struct HeapStats {
+    /// Bytes in allocations of application
+    size_t allocated = 0;
+    /// Bytes of pages containing allocations
+    size_t active = 0;
+    /// Bytes of pages mapped by allocator and resident
+    size_t resident = 0;
+    /// Bytes mapped by allocator but not used, to be purged
+    size_t retained = 0;
+    /// Bytes of pages used by each arena
+    std::vector<size_t> arenas;
+  };
+
+  /// Allocator linked by `QLEAN_ALLOCATOR`: "glibc", "mimalloc", "jemalloc",
+  /// or "system" if statistics of system allocator are not supported
+  std::string_view heapAllocator();
+
+  /// Statistics of allocator, nullopt if it can't report them
+  std::optional<HeapStats> heapStats();
+
+  /// Return free pages of all arenas and thread caches to OS
+  void purgeHeap();
+
+  /**
+   * Profile of allocations if allocator samples them, i.e. jemalloc with
+   * `MALLOC_CONF=prof:true`, in jeprof format; otherwise detailed
+   * statistics of allocator in its own text format.
+   */
+  outcome::result<std::string> heapProfile();
+}  // namespace lean
@@ -0,0 +1,168 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) and defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/**
+ * Hex codec of hashes and keys for logs, json and configs.
+ * 16 bytes are converted per step by SSE2 on x86-64 or NEON on arm64,
+ * which are baseline there, so no runtime dispatch is needed.
+ * Encoding is lowercase, decoding accepts either case.
+ */
+namespace lean {
+  namespace hex_detail {
+    /// Two lowercase hex digits of each byte
+    inline constexpr auto kPairs = [] {
+      constexpr std::string_view digits = "0123456789abcdef";
+      std::array<char, 512> pairs{};
+      for (size_t i = 0; i < 256; ++i) {
+        pairs[2 * i] = digits[i >> 4];
+        pairs[2 * i + 1] = digits[i & 15];
+      }
+      return pairs;
+    }();
+
+    /// Value of hex digit, or 0xff
+    inline constexpr auto kValues = [] {
+      std::array<uint8_t, 256> values{};
+      values.fill(0xff);
+      for (uint8_t i = 0; i < 10; ++i) {
+        values['0' + i] = i;
+      }
+      for (uint8_t i = 0; i < 6; ++i) {
+        values['a' + i] = 10 + i;
+        values['A' + i] = 10 + i;
+      }
+      return values;
+    }();
+  }  // namespace hex_detail
+
+  /// Write `2 * bytes.size()` lowercase hex digits to `out`
+  inline void hexEncode(std::span<const uint8_t> bytes, char *out) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const auto low_mask = _mm_set1_epi8(0x0f);
+    const auto nine = _mm_set1_epi8(9);
+    const auto zero = _mm_set1_epi8('0');
+    const auto letter = _mm_set1_epi8('a' - '0' - 10);
+    auto digits = [&](__m128i nibbles) {
+      auto is_letter = _mm_cmpgt_epi8(nibbles, nine);
+      return _mm_add_epi8(_mm_add_epi8(nibbles, zero),
+                          _mm_and_si128(is_letter, letter));
+    };
+    for (; i + 16 <= bytes.size(); i += 16) {
+      auto v = _mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(bytes.data() + i));
+      auto hi = digits(_mm_and_si128(_mm_srli_epi16(v, 4), low_mask));
+      auto lo = digits(_mm_and_si128(v, low_mask));
+      auto *p = reinterpret_cast<__m128i *>(out + 2 * i);
+      _mm_storeu_si128(p, _mm_unpacklo_epi8(hi, lo));
+      _mm_storeu_si128(p + 1, _mm_unpackhi_epi8(hi, lo));
+    }
+#elif defined(__aarch64__) and defined(__ARM_NEON)
+    const auto table = vld1q_u8(
+        reinterpret_cast<const uint8_t *>("0123456789abcdef"));
+    for (; i + 16 <= bytes.size(); i += 16) {
+      auto v = vld1q_u8(bytes.data() + i);
+      uint8x16x2_t pair{{
+          vqtbl1q_u8(table, vshrq_n_u8(v, 4)),
+          vqtbl1q_u8(table, vandq_u8(v, vdupq_n_u8(0x0f))),
+      }};
+      vst2q_u8(reinterpret_cast<uint8_t *>(out + 2 * i), pair);
+    }
+#endif
+    for (; i < bytes.size(); ++i) {
+      out[2 * i] = hex_detail::kPairs[2 * bytes[i]];
+      out[2 * i + 1] = hex_detail::kPairs[2 * bytes[i] + 1];
+    }
+  }
+
+  /// Lowercase hex of `bytes` with "0x" prefix
+  inline std::string hex0x(std::span<const uint8_t> bytes) {
+    std::string hex(2 + 2 * bytes.size(), '\0');
+    hex[0] = '0';
+    hex[1] = 'x';
+    hexEncode(bytes, hex.data() + 2);
+    return hex;
+  }
+
+  /**
+   * Decode exactly `out.size()` bytes from `hex`, optionally prefixed by
+   * "0x".
+   * @return false if length or digit is invalid, `out` is unspecified then
+   */
+  inline bool hexDecode(std::string_view hex, std::span<uint8_t> out) {
+    if (hex.starts_with("0x")) {
+      hex.remove_prefix(2);
+    }
+    if (hex.size() != 2 * out.size()) {
+      return false;
+    }
+    size_t i = 0;
+#if defined(__SSE2__)
+    const auto zero = _mm_set1_epi8('0');
+    const auto ten = _mm_set1_epi8(10);
+    const auto six = _mm_set1_epi8(6);
+    const auto lower = _mm_set1_epi8(0x20);
+    const auto letter = _mm_set1_epi8('a');
+    const auto low_byte = _mm_set1_epi16(0x00ff);
+    // Unsigned `a < b` of bytes
+    auto below = [](__m128i a, __m128i b) {
+      return _mm_cmpeq_epi8(_mm_max_epu8(a, b), b);
+    };
+    auto values = [&](__m128i c, __m128i &invalid) {
+      auto digit = _mm_sub_epi8(c, zero);
+      auto alpha = _mm_sub_epi8(_mm_or_si128(c, lower), letter);
+      auto is_digit = _mm_andnot_si128(_mm_cmpeq_epi8(digit, ten),
+                                       below(digit, ten));
+      auto is_alpha = _mm_andnot_si128(_mm_cmpeq_epi8(alpha, six),
+                                       below(alpha, six));
+      invalid = _mm_or_si128(
+          invalid, _mm_andnot_si128(_mm_or_si128(is_digit, is_alpha),
+                                    _mm_set1_epi8(-1)));
+      return _mm_or_si128(_mm_and_si128(is_digit, digit),
+                          _mm_and_si128(is_alpha, _mm_add_epi8(alpha, ten)));
+    };
+    auto invalid = _mm_setzero_si128();
+    for (; i + 16 <= out.size(); i += 16) {
+      auto *p = reinterpret_cast<const __m128i *>(hex.data() + 2 * i);
+      auto a = values(_mm_loadu_si128(p), invalid);
+      auto b = values(_mm_loadu_si128(p + 1), invalid);
+      // First digit of pair is low byte of 16 bit lane
+      auto pack = [&](__m128i v) {
+        return _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v, low_byte), 4),
+                            _mm_srli_epi16(v, 8));
+      };
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out.data() + i),
+                       _mm_packus_epi16(pack(a), pack(b)));
+    }
+    if (_mm_movemask_epi8(invalid) != 0) {
+      return false;
+    }
+#endif
+    for (; i < out.size(); ++i) {
+      auto hi = hex_detail::kValues[static_cast<uint8_t>(hex[2 * i])];
+      auto lo = hex_detail::kValues[static_cast<uint8_t>(hex[2 * i + 1])];
+      if ((hi | lo) == 0xff) {
+        return false;
+      }
+      out[i] = (hi << 4) | lo;
+    }
+    return true;
+  }
+}  // namespace lean
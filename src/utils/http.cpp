@@ -6,41 +6,303 @@
 
 #include "utils/http.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <deque>
+#include <format>
+#include <mutex>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/write.hpp>
 #include <boost/beast/core/flat_buffer.hpp>
 #include <boost/beast/core/tcp_stream.hpp>
+#include <boost/beast/http/chunk_encode.hpp>
+#include <boost/beast/http/empty_body.hpp>
 #include <boost/beast/http/read.hpp>
+#include <boost/beast/http/span_body.hpp>
 #include <boost/beast/http/string_body.hpp>
 #include <boost/beast/http/write.hpp>
 #include <libp2p/coro/asio.hpp>
 #include <libp2p/coro/spawn.hpp>
+#include <qtils/final_action.hpp>
 
 namespace lean::http {
+  /// Inclusive range of bytes, open if `last` is not set
+  struct ByteRange {
+    size_t first;
+    std::optional<size_t> last;
+  };
+
+  /// Parse "bytes=<first>-[<last>]", other range forms are not supported
+  static std::optional<ByteRange> parseRange(std::string_view range) {
+    constexpr std::string_view kUnit = "bytes=";
+    if (not range.starts_with(kUnit)) {
+      return std::nullopt;
+    }
+    range.remove_prefix(kUnit.size());
+    const auto *end = range.data() + range.size();
+    ByteRange result{};
+    auto [dash, ec] = std::from_chars(range.data(), end, result.first);
+    if (ec != std::errc{} or dash == end or *dash != '-') {
+      return std::nullopt;
+    }
+    if (dash + 1 != end) {
+      size_t last = 0;
+      auto [last_end, last_ec] = std::from_chars(dash + 1, end, last);
+      if (last_ec != std::errc{} or last_end != end or last < result.first) {
+        return std::nullopt;
+      }
+      result.last = last;
+    }
+    return result;
+  }
+
+  /// Accessed on executor of connection only
+  struct EventStream::Connection {
+    explicit Connection(const boost::asio::any_io_executor &executor)
+        : executor{executor}, wake{executor} {}
+
+    boost::asio::any_io_executor executor;
+    std::deque<std::shared_ptr<const qtils::ByteVec>> queue;
+    bool overflow = false;
+    /// Cancelled when event is queued
+    boost::asio::steady_timer wake;
+  };
+
+  void EventStream::publish(std::string_view event, std::string_view data) {
+    auto text = std::format("event: {}\ndata: {}\n\n", event, data);
+    auto bytes =
+        std::make_shared<const qtils::ByteVec>(text.begin(), text.end());
+    std::lock_guard lock{mutex_};
+    std::erase_if(connections_, [&](const std::weak_ptr<Connection> &weak) {
+      auto connection = weak.lock();
+      if (not connection) {
+        return true;
+      }
+      auto &executor = connection->executor;
+      boost::asio::post(
+          executor, [connection{std::move(connection)}, bytes] {
+            if (connection->queue.size() >= kMaxQueuedEvents) {
+              connection->overflow = true;
+            } else {
+              connection->queue.emplace_back(bytes);
+            }
+            connection->wake.cancel();
+          });
+      return false;
+    });
+  }
+
+  std::shared_ptr<EventStream::Connection> EventStream::connect(
+      const boost::asio::any_io_executor &executor) {
+    auto connection = std::make_shared<Connection>(executor);
+    std::lock_guard lock{mutex_};
+    connections_.emplace_back(connection);
+    return connection;
+  }
+
+  size_t EventStream::connections() const {
+    std::lock_guard lock{mutex_};
+    return connections_.size();
+  }
+
+  libp2p::Coro<void> writeEvents(log::Logger log,
+                                 boost::beast::tcp_stream &stream,
+                                 unsigned version,
+                                 std::shared_ptr<EventStream> events) {
+    // Connection is closed by client, or on error
+    stream.expires_never();
+    auto connection = events->connect(stream.get_executor());
+    boost::beast::http::response<boost::beast::http::empty_body> response{
+        boost::beast::http::status::ok, version};
+    response.set(boost::beast::http::field::content_type, "text/event-stream");
+    response.set(boost::beast::http::field::cache_control, "no-cache");
+    response.set(boost::beast::http::field::connection, "close");
+    boost::beast::http::response_serializer<boost::beast::http::empty_body>
+        serializer{response};
+    auto write_res =
+        libp2p::coroOutcome(co_await boost::beast::http::async_write_header(
+            stream, serializer, libp2p::useCoroOutcome));
+    auto keep_alive = std::make_shared<const qtils::ByteVec>(
+        qtils::ByteVec{':', '\n', '\n'});
+    while (write_res.has_value() and not connection->overflow) {
+      std::shared_ptr<const qtils::ByteVec> bytes;
+      if (not connection->queue.empty()) {
+        bytes = std::move(connection->queue.front());
+        connection->queue.pop_front();
+      } else {
+        connection->wake.expires_after(EventStream::kKeepAlive);
+        auto wait_res = libp2p::coroOutcome(
+            co_await connection->wake.async_wait(libp2p::useCoroOutcome));
+        if (not wait_res.has_value()) {
+          // Cancelled by queued event
+          continue;
+        }
+        bytes = keep_alive;
+      }
+      write_res = libp2p::coroOutcome(co_await boost::asio::async_write(
+          stream, boost::asio::buffer(*bytes), libp2p::useCoroOutcome));
+    }
+    if (not write_res.has_value()) {
+      SL_DEBUG(log, "http event stream closed: {}", write_res.error());
+    } else {
+      SL_WARN(log, "http event stream closed, client is too slow");
+    }
+  }
+
+  /// @return whether response was written
+  libp2p::Coro<bool> writeChunked(log::Logger log,
+                                  boost::beast::tcp_stream &stream,
+                                  ChunkedResponse &chunked,
+                                  bool header_only,
+                                  bool keep_alive) {
+    boost::beast::http::response<boost::beast::http::empty_body> response{
+        std::move(chunked.header)};
+    response.chunked(true);
+    response.keep_alive(keep_alive);
+    boost::beast::http::response_serializer<boost::beast::http::empty_body>
+        serializer{response};
+    auto write_res =
+        libp2p::coroOutcome(co_await boost::beast::http::async_write_header(
+            stream, serializer, libp2p::useCoroOutcome));
+    if (header_only) {
+      co_return write_res.has_value();
+    }
+    while (write_res.has_value()) {
+      auto part_res = chunked.next();
+      if (not part_res.has_value()) {
+        // Client sees body cut short without last chunk
+        SL_WARN(log, "http chunked response error: {}", part_res.error());
+        co_return false;
+      }
+      auto &part = part_res.value();
+      if (not part) {
+        write_res =
+            libp2p::coroOutcome(co_await boost::asio::async_write(
+                stream,
+                boost::beast::http::make_chunk_last(),
+                libp2p::useCoroOutcome));
+        break;
+      }
+      if (part->empty()) {
+        // Empty chunk would be taken as last one
+        continue;
+      }
+      write_res = libp2p::coroOutcome(co_await boost::asio::async_write(
+          stream,
+          boost::beast::http::make_chunk(boost::asio::buffer(*part)),
+          libp2p::useCoroOutcome));
+    }
+    if (not write_res.has_value()) {
+      SL_WARN(log, "http write response error: {}", write_res.error());
+      co_return false;
+    }
+    co_return true;
+  }
+
+  /// @return whether response was written
+  template <typename ResponseBody>
+  libp2p::Coro<bool> write(
+      log::Logger log,
+      boost::beast::tcp_stream &stream,
+      boost::beast::http::response<ResponseBody> &response,
+      bool header_only,
+      bool keep_alive) {
+    response.content_length(response.body().size());
+    response.keep_alive(keep_alive);
+    boost::beast::http::response_serializer<ResponseBody> serializer{response};
+    // Response to HEAD has length of body, but not body itself
+    outcome::result<size_t> write_res = outcome::success(0);
+    if (header_only) {
+      write_res = libp2p::coroOutcome(
+          co_await boost::beast::http::async_write_header(
+              stream, serializer, libp2p::useCoroOutcome));
+    } else {
+      write_res =
+          libp2p::coroOutcome(co_await boost::beast::http::async_write(
+              stream, serializer, libp2p::useCoroOutcome));
+    }
+    if (not write_res.has_value()) {
+      SL_WARN(log, "http write response error: {}", write_res.error());
+      co_return false;
+    }
+    co_return true;
+  }
+
+  /// Answer requests of connection, until client closes it or asks to
   inline libp2p::Coro<void> serve(log::Logger log,
                                   boost::asio::ip::tcp::socket socket,
                                   ServerConfig config) {
     boost::beast::tcp_stream stream{std::move(socket)};
-    stream.expires_after(config.operation_timeout);
-    boost::beast::http::request_parser<Body> parser;
-    parser.body_limit(config.max_request_size);
     boost::beast::flat_buffer buffer;
-    auto read_res = libp2p::coroOutcome(co_await boost::beast::http::async_read(
-        stream, buffer, parser, libp2p::useCoroOutcome));
-    if (not read_res.has_value()) {
-      SL_WARN(log, "http read request error: {}", read_res.error());
-      co_return;
-    }
-    auto &&request = parser.release();
-    auto response = config.on_request(std::move(request));
-    response.content_length(response.body().size());
-    response.set(boost::beast::http::field::connection, "close");
-    auto write_res =
-        libp2p::coroOutcome(co_await boost::beast::http::async_write(
-            stream, response, libp2p::useCoroOutcome));
-    if (not write_res.has_value()) {
-      SL_WARN(log, "http write response error: {}", write_res.error());
+    for (auto first = true;; first = false) {
+      // Same timeout for idle connection waiting for next request
+      stream.expires_after(config.operation_timeout);
+      boost::beast::http::request_parser<Body> parser;
+      parser.body_limit(config.max_request_size);
+      auto read_res =
+          libp2p::coroOutcome(co_await boost::beast::http::async_read(
+              stream, buffer, parser, libp2p::useCoroOutcome));
+      if (not read_res.has_value()) {
+        // Idle connection is closed by client or by timeout
+        if (first) {
+          SL_WARN(log, "http read request error: {}", read_res.error());
+        }
+        co_return;
+      }
+      auto &&request = parser.release();
+      auto header_only = request.method() == boost::beast::http::verb::head;
+      auto version = request.version();
+      auto keep_alive = request.keep_alive();
+      auto any_response = config.on_request(std::move(request));
+      auto written = false;
+      if (auto *shared = std::get_if<SharedResponse>(&any_response)) {
+        // `shared` keeps body alive until write completes
+        using SpanBody = boost::beast::http::span_body<const uint8_t>;
+        boost::beast::http::response<SpanBody> response{
+            std::move(shared->header)};
+        if (shared->body and shared->offset < shared->body->size()) {
+          auto size = std::min(shared->size.value_or(shared->body->size()),
+                               shared->body->size() - shared->offset);
+          response.body() = {shared->body->data() + shared->offset, size};
+        }
+        written =
+            co_await write(log, stream, response, header_only, keep_alive);
+      } else if (auto *chunked =
+                     std::get_if<ChunkedResponse>(&any_response)) {
+        written = co_await writeChunked(
+            log, stream, *chunked, header_only, keep_alive);
+      } else if (auto *events =
+                     std::get_if<EventStreamResponse>(&any_response)) {
+        co_await writeEvents(log, stream, version, std::move(events->stream));
+        co_return;
+      } else {
+        written = co_await write(log,
+                                 stream,
+                                 std::get<Response>(any_response),
+                                 header_only,
+                                 keep_alive);
+      }
+      if (not written or not keep_alive) {
+        co_return;
+      }
     }
   }
 
+  /// Answer "503" to connection over `ServerConfig::max_connections`
+  inline libp2p::Coro<void> reject(log::Logger log,
+                                   boost::asio::ip::tcp::socket socket,
+                                   ServerConfig config) {
+    boost::beast::tcp_stream stream{std::move(socket)};
+    stream.expires_after(config.operation_timeout);
+    Response response{boost::beast::http::status::service_unavailable, 11};
+    response.set(boost::beast::http::field::retry_after, "1");
+    co_await write(log, stream, response, false, false);
+  }
+
   outcome::result<void> serve(log::Logger log,
                               boost::asio::io_context &io_context,
                               ServerConfig config) {
@@ -67,21 +329,148 @@ namespace lean::http {
         io_context,
         [log, &io_context, config, acceptor{std::move(acceptor)}]() mutable
             -> libp2p::Coro<void> {
+          auto connections = std::make_shared<std::atomic_size_t>(0);
           while (true) {
-            auto accept_res = libp2p::coroOutcome(
-                co_await acceptor.async_accept(libp2p::useCoroOutcome));
+            // Each connection is served on own strand, so connections are
+            // served in parallel when io context runs on several threads
+            auto accept_res =
+                libp2p::coroOutcome(co_await acceptor.async_accept(
+                    boost::asio::make_strand(io_context),
+                    libp2p::useCoroOutcome));
             if (not accept_res.has_value()) {
               SL_WARN(log, "tcp accept error: {}", accept_res.error());
               break;
             }
             auto &socket = accept_res.value();
-            libp2p::coroSpawn(io_context,
-                              [log, config, socket{std::move(socket)}]() mutable
-                                  -> libp2p::Coro<void> {
-                                co_await serve(log, std::move(socket), config);
-                              });
+            auto executor = socket.get_executor();
+            if (connections->fetch_add(1) >= config.max_connections) {
+              connections->fetch_sub(1);
+              SL_DEBUG(log,
+                       "http connection rejected, {} connections",
+                       config.max_connections);
+              libp2p::coroSpawn(executor,
+                                [log, config, socket{std::move(socket)}]()
+                                    mutable -> libp2p::Coro<void> {
+                                  co_await reject(
+                                      log, std::move(socket), config);
+                                });
+              continue;
+            }
+            libp2p::coroSpawn(
+                executor,
+                [log, config, connections, socket{std::move(socket)}]() mutable
+                    -> libp2p::Coro<void> {
+                  qtils::FinalAction release{
+                      [&] { connections->fetch_sub(1); }};
+                  co_await serve(log, std::move(socket), config);
+                });
           }
         });
     return outcome::success();
   }
+
+  AnyResponse sharedBodyResponse(const Request &request,
+                                 std::shared_ptr<const qtils::ByteVec> body,
+                                 std::string_view etag,
+                                 std::string_view content_type,
+                                 std::shared_ptr<const void> hold) {
+    if (request[boost::beast::http::field::if_none_match] == etag) {
+      Response response;
+      response.version(request.version());
+      response.result(boost::beast::http::status::not_modified);
+      response.set(boost::beast::http::field::etag, etag);
+      return response;
+    }
+    auto size = body->size();
+    SharedResponse shared{
+        .body = std::move(body),
+        .hold = std::move(hold),
+    };
+    shared.header.version(request.version());
+    shared.header.result(boost::beast::http::status::ok);
+    auto if_range = request[boost::beast::http::field::if_range];
+    auto range = parseRange(request[boost::beast::http::field::range]);
+    if (range and (if_range.empty() or if_range == etag)) {
+      if (range->first >= size) {
+        Response response;
+        response.version(request.version());
+        response.result(boost::beast::http::status::range_not_satisfiable);
+        response.set(boost::beast::http::field::content_range,
+                     std::format("bytes */{}", size));
+        return response;
+      }
+      auto last = std::min(range->last.value_or(size - 1), size - 1);
+      shared.offset = range->first;
+      shared.size = last - range->first + 1;
+      shared.header.result(boost::beast::http::status::partial_content);
+      shared.header.set(
+          boost::beast::http::field::content_range,
+          std::format("bytes {}-{}/{}", range->first, last, size));
+    }
+    shared.header.set(boost::beast::http::field::content_type, content_type);
+    shared.header.set(boost::beast::http::field::etag, etag);
+    return shared;
+  }
+
+  std::string_view targetPath(std::string_view target) {
+    return target.substr(0, target.find('?'));
+  }
+
+  std::optional<std::string_view> queryParam(std::string_view target,
+                                             std::string_view name) {
+    auto question = target.find('?');
+    if (question == std::string_view::npos) {
+      return std::nullopt;
+    }
+    auto query = target.substr(question + 1);
+    while (not query.empty()) {
+      auto amp = query.find('&');
+      auto param = query.substr(0, amp);
+      query = amp == std::string_view::npos ? std::string_view{}
+                                            : query.substr(amp + 1);
+      if (param.starts_with(name) and param.size() > name.size()
+          and param[name.size()] == '=') {
+        return param.substr(name.size() + 1);
+      }
+    }
+    return std::nullopt;
+  }
+
+  std::vector<Event> EventParser::feed(std::string_view bytes) {
+    std::vector<Event> events;
+    buffer_.append(bytes);
+    std::string_view buffer{buffer_};
+    for (auto end = buffer.find('\n'); end != std::string_view::npos;
+         end = buffer.find('\n')) {
+      auto line = buffer.substr(0, end);
+      buffer.remove_prefix(end + 1);
+      if (line.ends_with('\r')) {
+        line.remove_suffix(1);
+      }
+      if (line.empty()) {
+        if (not event_.data.empty() or not event_.event.empty()) {
+          events.emplace_back(std::move(event_));
+        }
+        event_ = {};
+        continue;
+      }
+      auto colon = line.find(':');
+      auto field = line.substr(0, colon);
+      auto value = colon == std::string_view::npos ? std::string_view{}
+                                                   : line.substr(colon + 1);
+      if (value.starts_with(' ')) {
+        value.remove_prefix(1);
+      }
+      if (field == "event") {
+        event_.event = value;
+      } else if (field == "data") {
+        if (not event_.data.empty()) {
+          event_.data += '\n';
+        }
+        event_.data += value;
+      }
+    }
+    buffer_.erase(0, buffer_.size() - buffer.size());
+    return events;
+  }
 }  // namespace lean::http
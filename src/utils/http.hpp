@@ -6,11 +6,20 @@
 
 #pragma once
 
+#include <chrono>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
 
 #include <boost/asio/ip/tcp.hpp>
-#include <boost/beast/http/message_fwd.hpp>
+#include <boost/beast/http/message.hpp>
 #include <boost/beast/http/string_body_fwd.hpp>
+#include <qtils/byte_vec.hpp>
 
 #include "log/logger.hpp"
 
@@ -22,7 +31,71 @@ namespace lean::http {
   using Body = boost::beast::http::string_body;
   using Request = boost::beast::http::request<Body>;
   using Response = boost::beast::http::response<Body>;
-  using OnRequest = std::function<Response(Request)>;
+
+  /**
+   * Response with immutable body shared between requests.
+   * Body is written to socket directly, without copying into response.
+   */
+  struct SharedResponse {
+    boost::beast::http::response_header<> header;
+    std::shared_ptr<const qtils::ByteVec> body;
+    /// Released after response is written, e.g. to limit parallel downloads
+    std::shared_ptr<const void> hold;
+    /// Part of body sent, for range requests; till end if `size` is not set
+    size_t offset = 0;
+    std::optional<size_t> size;
+  };
+
+  /**
+   * Server-sent events, fanned out to all connected clients.
+   * Event is formatted once and its bytes are shared by all connections.
+   * Thread safe, events are queued on executor of each connection.
+   */
+  class EventStream {
+   public:
+    /// Events queued for slow client, which is disconnected on overflow
+    static constexpr size_t kMaxQueuedEvents = 64;
+    /// Comment is sent to idle clients, so closed connections are noticed
+    static constexpr auto kKeepAlive = std::chrono::seconds{15};
+
+    struct Connection;
+
+    /// Send "event: <event>\ndata: <data>\n\n" to all clients
+    void publish(std::string_view event, std::string_view data);
+
+    /// Connection of client, removed from stream when released
+    std::shared_ptr<Connection> connect(
+        const boost::asio::any_io_executor &executor);
+
+    size_t connections() const;
+
+   private:
+    mutable std::mutex mutex_;
+    std::vector<std::weak_ptr<Connection>> connections_;
+  };
+
+  /// Keep connection open and write events of `stream` to it
+  struct EventStreamResponse {
+    std::shared_ptr<EventStream> stream;
+  };
+
+  /**
+   * Body of unknown size produced part by part, sent with chunked transfer
+   * encoding, so large bodies are not kept in memory at once.
+   * `next` is called on executor of connection, after previous part is
+   * written, and returns nullptr after last part.
+   */
+  struct ChunkedResponse {
+    using Next =
+        std::function<outcome::result<std::shared_ptr<const qtils::ByteVec>>()>;
+
+    boost::beast::http::response_header<> header;
+    Next next;
+  };
+
+  using AnyResponse = std::
+      variant<Response, SharedResponse, EventStreamResponse, ChunkedResponse>;
+  using OnRequest = std::function<AnyResponse(Request)>;
 
   struct ServerConfig {
     boost::asio::ip::tcp::endpoint endpoint;
@@ -31,6 +104,10 @@ namespace lean::http {
     static constexpr size_t kDefaultRequestSize = 10000u;
     size_t max_request_size{kDefaultRequestSize};
 
+    static constexpr size_t kDefaultMaxConnections = 256;
+    /// More connections are answered "503" and closed
+    size_t max_connections{kDefaultMaxConnections};
+
     using Duration = std::chrono::nanoseconds;
     static constexpr Duration kDefaultTimeout = std::chrono::seconds{30};
     Duration operation_timeout{kDefaultTimeout};
@@ -39,4 +116,45 @@ namespace lean::http {
   outcome::result<void> serve(log::Logger log,
                               boost::asio::io_context &io_context,
                               ServerConfig config);
+
+  /**
+   * Response with `body` shared between requests, "304" if client has
+   * `etag` version already.
+   * Single "bytes=<first>-[<last>]" range is sent if requested, and
+   * `If-Range` is empty or matches `etag`, e.g. to resume download.
+   * @param hold released after response is written
+   */
+  AnyResponse sharedBodyResponse(const Request &request,
+                                 std::shared_ptr<const qtils::ByteVec> body,
+                                 std::string_view etag,
+                                 std::string_view content_type,
+                                 std::shared_ptr<const void> hold = nullptr);
+
+  /// Path of request target, without query
+  std::string_view targetPath(std::string_view target);
+
+  /// Value of "<name>=<value>" query parameter of request target, not decoded
+  std::optional<std::string_view> queryParam(std::string_view target,
+                                             std::string_view name);
+
+  /// Server-sent event, as written by `EventStream`
+  struct Event {
+    std::string event;
+    std::string data;
+  };
+
+  /**
+   * Splits server-sent events stream into events as bytes arrive.
+   * Fields other than "event" and "data" and comments are skipped, lines of
+   * multiline data are joined by "\n".
+   */
+  class EventParser {
+   public:
+    /// Events completed by `bytes`
+    std::vector<Event> feed(std::string_view bytes);
+
+   private:
+    std::string buffer_;
+    Event event_;
+  };
 }  // namespace lean::http
@@ -168,6 +168,21 @@ namespace lean {
       return res.as_failure();
     }
 
+    /// Keys from most to least recently used
+    std::vector<Key> keys() const {
+      LockGuard lg(*this);
+      auto entries = cache_;
+      std::ranges::sort(entries, [](const auto &lhs, const auto &rhs) {
+        return rhs < lhs;
+      });
+      std::vector<Key> keys;
+      keys.reserve(entries.size());
+      for (auto &entry : entries) {
+        keys.emplace_back(entry.key);
+      }
+      return keys;
+    }
+
     void erase(const Key &key) {
       LockGuard lg(*this);
       auto it = std::ranges::find_if(
@@ -0,0 +1,96 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <qtils/outcome.hpp>
+
+namespace lean {
+
+  /**
+   * Read-only memory mapping of whole file.
+   * Pages are read on first access, so large file can be opened cheaply and
+   * parsed in parts.
+   */
+  class MappedFile {
+   public:
+    static outcome::result<MappedFile> open(
+        const std::filesystem::path &path) {
+      auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0) {
+        return std::error_code{errno, std::generic_category()};
+      }
+      struct stat st{};
+      if (::fstat(fd, &st) != 0) {
+        std::error_code ec{errno, std::generic_category()};
+        ::close(fd);
+        return ec;
+      }
+      auto size = static_cast<size_t>(st.st_size);
+      void *data = nullptr;
+      if (size != 0) {
+        data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+          std::error_code ec{errno, std::generic_category()};
+          ::close(fd);
+          return ec;
+        }
+      }
+      // Mapping stays valid after descriptor is closed
+      ::close(fd);
+      return MappedFile{data, size};
+    }
+
+    MappedFile(MappedFile &&other) noexcept
+        : data_{std::exchange(other.data_, nullptr)},
+          size_{std::exchange(other.size_, 0)} {}
+
+    MappedFile &operator=(MappedFile &&other) noexcept {
+      if (this != &other) {
+        unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+      }
+      return *this;
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile() {
+      unmap();
+    }
+
+    std::span<const uint8_t> bytes() const {
+      return {static_cast<const uint8_t *>(data_), size_};
+    }
+
+   private:
+    MappedFile(void *data, size_t size) : data_{data}, size_{size} {}
+
+    void unmap() {
+      if (data_ != nullptr) {
+        ::munmap(data_, size_);
+      }
+    }
+
+    void *data_ = nullptr;
+    size_t size_ = 0;
+  };
+
+}  // namespace lean
@@ -0,0 +1,40 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Estimates of memory used by standard containers, for memory accounting
+ * metrics. Heap memory owned by elements is not included.
+ */
+namespace lean::memory_usage {
+  /// Allocator bookkeeping of each node of node based container
+  constexpr size_t kNodeOverhead = 2 * sizeof(void *);
+
+  template <typename C>
+  size_t vectorBytes(const C &vector) {
+    return vector.capacity() * sizeof(typename C::value_type);
+  }
+
+  /// `std::unordered_map`, `std::unordered_set` and multi variants
+  template <typename C>
+  size_t hashBytes(const C &container) {
+    return container.size()
+             * (sizeof(typename C::value_type) + sizeof(void *)
+                + kNodeOverhead)
+         + container.bucket_count() * sizeof(void *);
+  }
+
+  /// `std::map`, `std::set` and multi variants
+  template <typename C>
+  size_t treeBytes(const C &container) {
+    return container.size()
+         * (sizeof(typename C::value_type) + 4 * sizeof(void *)
+            + kNodeOverhead);
+  }
+}  // namespace lean::memory_usage
@@ -0,0 +1,110 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+namespace lean {
+
+  /**
+   * Bounded lock-free multi-producer multi-consumer queue.
+   *
+   * Ring of cells with sequence numbers (D. Vyukov), producers and consumers
+   * claim cells with single CAS on their position counter.
+   * FIFO for each producer, `tryPush` fails instead of blocking when full.
+   */
+  template <typename T>
+  class MpmcQueue {
+   public:
+    /// @param capacity rounded up to power of two
+    explicit MpmcQueue(size_t capacity)
+        : mask_{std::bit_ceil(std::max<size_t>(capacity, 2)) - 1},
+          cells_{std::make_unique<Cell[]>(mask_ + 1)} {
+      for (size_t i = 0; i <= mask_; ++i) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    MpmcQueue(const MpmcQueue &) = delete;
+    MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+    size_t capacity() const {
+      return mask_ + 1;
+    }
+
+    /// @return false if queue is full, `value` is not moved from then
+    bool tryPush(T &&value) {
+      auto pos = push_pos_.load(std::memory_order_relaxed);
+      for (;;) {
+        auto &cell = cells_[pos & mask_];
+        auto sequence = cell.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+        if (diff == 0) {
+          if (push_pos_.compare_exchange_weak(
+                  pos, pos + 1, std::memory_order_relaxed)) {
+            cell.value.emplace(std::move(value));
+            cell.sequence.store(pos + 1, std::memory_order_release);
+            return true;
+          }
+        } else if (diff < 0) {
+          return false;
+        } else {
+          pos = push_pos_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    /// @return false if queue is empty
+    bool tryPop(T &value) {
+      auto pos = pop_pos_.load(std::memory_order_relaxed);
+      for (;;) {
+        auto &cell = cells_[pos & mask_];
+        auto sequence = cell.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(sequence - (pos + 1));
+        if (diff == 0) {
+          if (pop_pos_.compare_exchange_weak(
+                  pos, pos + 1, std::memory_order_relaxed)) {
+            value = std::move(*cell.value);
+            cell.value.reset();
+            cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+            return true;
+          }
+        } else if (diff < 0) {
+          return false;
+        } else {
+          pos = pop_pos_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    /// Approximate, exact only when no concurrent operations
+    bool empty() const {
+      return pop_pos_.load(std::memory_order_acquire)
+          >= push_pos_.load(std::memory_order_acquire);
+    }
+
+   private:
+    struct Cell {
+      std::atomic<size_t> sequence;
+      std::optional<T> value;
+    };
+
+    // Separate cache lines, so producers and consumers don't share one
+    static constexpr size_t kCacheLine = 64;
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(kCacheLine) std::atomic<size_t> push_pos_ = 0;
+    alignas(kCacheLine) std::atomic<size_t> pop_pos_ = 0;
+  };
+
+}  // namespace lean
@@ -0,0 +1,190 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <qtils/outcome.hpp>
+
+#include "utils/memory_usage.hpp"
+
+namespace lean {
+
+  /**
+   * Thread safe LRU cache for concurrent readers, with `LruCache` API.
+   *
+   * Keys are spread by hash over shards with own locks, so threads working
+   * with different keys rarely contend. Lookup takes shared lock only:
+   * recency is relaxed atomic stamp of entry, not list reordering, and is
+   * taken into account when shard evicts under exclusive lock.
+   * Eviction is per shard, so cache is LRU approximately, which suits
+   * capacities much larger than number of shards.
+   *
+   * Unlike `LruCache`, equal values of different keys are not deduplicated.
+   */
+  template <typename Key,
+            typename Value,
+            typename Hash = std::hash<Key>,
+            size_t MaxShards = 16>
+  class ShardedLruCache {
+   public:
+    explicit ShardedLruCache(size_t max_size)
+        : shards_(std::min(max_size, MaxShards)) {
+      BOOST_ASSERT(max_size > 0);
+      // Spread capacity, so total is `max_size`
+      for (size_t i = 0; i < shards_.size(); ++i) {
+        shards_[i].max_size =
+            max_size / shards_.size() + (i < max_size % shards_.size());
+      }
+    }
+
+    std::optional<std::shared_ptr<const Value>> get(const Key &key) const {
+      auto &shard = shardOf(key);
+      std::shared_lock lock{shard.mutex};
+      auto it = shard.entries.find(key);
+      if (it == shard.entries.end()) {
+        return std::nullopt;
+      }
+      it->second.tick.store(
+          shard.ticks.fetch_add(1, std::memory_order_relaxed) + 1,
+          std::memory_order_relaxed);
+      return it->second.value;
+    }
+
+    template <typename ValueArg>
+    std::shared_ptr<const Value> put(const Key &key, ValueArg &&value) {
+      static_assert(std::is_convertible_v<ValueArg, Value>
+                    or std::is_constructible_v<Value, ValueArg>);
+      auto value_ptr =
+          std::make_shared<const Value>(std::forward<ValueArg>(value));
+      auto &shard = shardOf(key);
+      std::unique_lock lock{shard.mutex};
+      auto it = shard.entries.find(key);
+      if (it == shard.entries.end()) {
+        if (shard.entries.size() >= shard.max_size) {
+          shard.evict();
+        }
+        it = shard.entries.try_emplace(key).first;
+      }
+      it->second.value = value_ptr;
+      it->second.tick.store(
+          shard.ticks.fetch_add(1, std::memory_order_relaxed) + 1,
+          std::memory_order_relaxed);
+      return value_ptr;
+    }
+
+    outcome::result<std::shared_ptr<const Value>> get_else(
+        const Key &key, const std::function<outcome::result<Value>()> &func) {
+      if (auto opt = get(key); opt.has_value()) {
+        return opt.value();
+      }
+      auto res = func();
+      if (res.has_value()) {
+        return put(key, std::move(res.value()));
+      }
+      return res.as_failure();
+    }
+
+    /// Keys from most to least recently used
+    std::vector<Key> keys() const {
+      std::vector<std::pair<uint64_t, Key>> stamped;
+      for (auto &shard : shards_) {
+        std::shared_lock lock{shard.mutex};
+        for (auto &[key, entry] : shard.entries) {
+          stamped.emplace_back(entry.tick.load(std::memory_order_relaxed),
+                               key);
+        }
+      }
+      std::ranges::sort(stamped, [](const auto &lhs, const auto &rhs) {
+        return lhs.first > rhs.first;
+      });
+      std::vector<Key> keys;
+      keys.reserve(stamped.size());
+      for (auto &item : stamped) {
+        keys.emplace_back(std::move(item.second));
+      }
+      return keys;
+    }
+
+    void erase(const Key &key) {
+      auto &shard = shardOf(key);
+      std::unique_lock lock{shard.mutex};
+      shard.entries.erase(key);
+    }
+
+    void erase_if(const std::function<bool(const Key &key, const Value &value)>
+                      &predicate) {
+      for (auto &shard : shards_) {
+        std::unique_lock lock{shard.mutex};
+        std::erase_if(shard.entries, [&](const auto &item) {
+          return predicate(item.first, *item.second.value);
+        });
+      }
+    }
+
+    /**
+     * Estimated memory used by cache.
+     * @param value_bytes heap memory owned by value
+     */
+    size_t byteSize(
+        const std::function<size_t(const Value &value)> &value_bytes) const {
+      size_t bytes = 0;
+      for (auto &shard : shards_) {
+        std::shared_lock lock{shard.mutex};
+        bytes += memory_usage::hashBytes(shard.entries)
+               + shard.entries.size() * sizeof(Value);
+        for (auto &[key, entry] : shard.entries) {
+          bytes += value_bytes(*entry.value);
+        }
+      }
+      return bytes;
+    }
+
+   private:
+    struct Entry {
+      std::shared_ptr<const Value> value;
+      std::atomic_uint64_t tick = 0;
+    };
+
+    struct Shard {
+      /// Called under exclusive lock
+      void evict() {
+        auto oldest = std::ranges::min_element(
+            entries, {}, [](const auto &item) {
+              return item.second.tick.load(std::memory_order_relaxed);
+            });
+        if (oldest != entries.end()) {
+          entries.erase(oldest);
+        }
+      }
+
+      mutable std::shared_mutex mutex;
+      size_t max_size = 0;
+      // Stamps are per shard and compared only within shard on eviction,
+      // `keys()` ordering across shards is approximate
+      mutable std::atomic_uint64_t ticks = 0;
+      std::unordered_map<Key, Entry, Hash> entries;
+    };
+
+    Shard &shardOf(const Key &key) const {
+      return shards_[Hash{}(key) % shards_.size()];
+    }
+
+    mutable std::vector<Shard> shards_;
+  };
+
+}  // namespace lean
@@ -0,0 +1,226 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/thread_placement.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <soralog/util.hpp>
+
+namespace lean {
+  namespace {
+    std::mutex placements_mutex;
+    ThreadPlacements placements;
+
+    std::optional<ThreadPlacement> placementOf(std::string_view name) {
+      std::lock_guard lock{placements_mutex};
+      auto it = placements.find(threadClass(name));
+      if (it == placements.end()) {
+        return std::nullopt;
+      }
+      return it->second;
+    }
+
+    void apply(pid_t tid,
+               std::string_view name,
+               const ThreadPlacement &placement) {
+      if (not placement.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (auto cpu : placement.cpus) {
+          if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+          }
+        }
+        if (::sched_setaffinity(tid, sizeof(set), &set) != 0) {
+          std::cerr << "Can't pin thread " << name << " to CPUs "
+                    << formatCpuList(placement.cpus) << ": "
+                    << std::strerror(errno) << '\n';
+        }
+      }
+      if (placement.nice.has_value()) {
+        // Linux applies priority of PRIO_PROCESS to single thread
+        if (::setpriority(PRIO_PROCESS, tid, *placement.nice) != 0) {
+          std::cerr << "Can't set nice " << *placement.nice << " of thread "
+                    << name << ": " << std::strerror(errno) << '\n';
+        }
+      }
+      if (placement.realtime_priority.has_value()) {
+        sched_param param{.sched_priority = *placement.realtime_priority};
+        if (::sched_setscheduler(tid, SCHED_FIFO, &param) != 0) {
+          std::cerr << "Can't set realtime priority "
+                    << *placement.realtime_priority << " of thread " << name
+                    << ": " << std::strerror(errno) << '\n';
+        }
+      }
+    }
+
+    std::string readLine(const std::filesystem::path &path) {
+      std::ifstream file{path};
+      std::string line;
+      std::getline(file, line);
+      return line;
+    }
+
+    /// Call `f(tid, name)` for each thread of process
+    void forEachThread(const auto &f) {
+      std::error_code ec;
+      for (auto &entry :
+           std::filesystem::directory_iterator{"/proc/self/task", ec}) {
+        uint64_t tid = 0;
+        auto file_name = entry.path().filename().string();
+        auto end = file_name.data() + file_name.size();
+        if (std::from_chars(file_name.data(), end, tid).ptr != end) {
+          continue;
+        }
+        f(tid, entry.path(), readLine(entry.path() / "comm"));
+      }
+    }
+  }  // namespace
+
+  std::string_view threadClass(std::string_view name) {
+    return name.substr(0, name.find_first_of(".:"));
+  }
+
+  std::optional<std::vector<uint32_t>> parseCpuList(std::string_view list) {
+    std::vector<uint32_t> cpus;
+    auto number = [&](std::string_view &s) -> std::optional<uint32_t> {
+      uint32_t value = 0;
+      auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+      if (ec != std::errc{}) {
+        return std::nullopt;
+      }
+      s.remove_prefix(ptr - s.data());
+      return value;
+    };
+    while (true) {
+      auto first = number(list);
+      if (not first) {
+        return std::nullopt;
+      }
+      auto last = first;
+      if (list.starts_with('-')) {
+        list.remove_prefix(1);
+        last = number(list);
+        if (not last or *last < *first) {
+          return std::nullopt;
+        }
+      }
+      for (auto cpu = *first; cpu <= *last; ++cpu) {
+        cpus.emplace_back(cpu);
+      }
+      if (list.empty()) {
+        break;
+      }
+      if (not list.starts_with(',')) {
+        return std::nullopt;
+      }
+      list.remove_prefix(1);
+    }
+    std::ranges::sort(cpus);
+    auto duplicates = std::ranges::unique(cpus);
+    cpus.erase(duplicates.begin(), duplicates.end());
+    return cpus;
+  }
+
+  std::string formatCpuList(const std::vector<uint32_t> &cpus) {
+    std::string list;
+    for (size_t i = 0; i < cpus.size();) {
+      auto j = i;
+      while (j + 1 < cpus.size() and cpus[j + 1] == cpus[j] + 1) {
+        ++j;
+      }
+      if (not list.empty()) {
+        list += ',';
+      }
+      list += std::to_string(cpus[i]);
+      if (j != i) {
+        list += '-';
+        list += std::to_string(cpus[j]);
+      }
+      i = j + 1;
+    }
+    return list;
+  }
+
+  void setThreadPlacements(ThreadPlacements new_placements) {
+    std::lock_guard lock{placements_mutex};
+    placements = std::move(new_placements);
+  }
+
+  void setThreadName(const std::string &name) {
+    soralog::util::setThreadName(name);
+    if (auto placement = placementOf(name)) {
+      apply(::gettid(), name, *placement);
+    }
+  }
+
+  void placeThreads() {
+    forEachThread([](uint64_t tid, const auto &, const std::string &name) {
+      if (auto placement = placementOf(name)) {
+        apply(static_cast<pid_t>(tid), name, *placement);
+      }
+    });
+  }
+
+  std::vector<ThreadJson> listThreads() {
+    std::vector<ThreadJson> threads;
+    forEachThread([&](uint64_t tid,
+                      const std::filesystem::path &path,
+                      const std::string &name) {
+      ThreadJson thread{
+          .tid = tid,
+          .name = name,
+          .thread_class = std::string{threadClass(name)},
+          .cpu = -1,
+          .affinity = "",
+          .nice = 0,
+      };
+      // Fields after command name, which may contain spaces
+      auto stat = readLine(path / "stat");
+      auto comm_end = stat.rfind(')');
+      if (comm_end != std::string::npos) {
+        std::istringstream fields{stat.substr(comm_end + 1)};
+        std::vector<std::string> values{std::istream_iterator<std::string>{
+                                            fields},
+                                        {}};
+        // Fields 19 and 39 of proc_pid_stat(5), first one here is 3
+        if (values.size() > 36) {
+          thread.nice = std::stoll(values[16]);
+          thread.cpu = std::stoll(values[36]);
+        }
+      }
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      if (::sched_getaffinity(static_cast<pid_t>(tid), sizeof(set), &set)
+          == 0) {
+        std::vector<uint32_t> cpus;
+        for (uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+          if (CPU_ISSET(cpu, &set)) {
+            cpus.emplace_back(cpu);
+          }
+        }
+        thread.affinity = formatCpuList(cpus);
+      }
+      threads.emplace_back(std::move(thread));
+    });
+    std::ranges::sort(threads, {}, &ThreadJson::tid);
+    return threads;
+  }
+
+}  // namespace lean
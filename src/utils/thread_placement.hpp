@@ -0,0 +1,74 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "serde/json_fwd.hpp"
+
+namespace lean {
+
+  /// CPU placement of class of threads
+  struct ThreadPlacement {
+    /// CPUs threads may run on, empty doesn't pin
+    std::vector<uint32_t> cpus;
+    /// Scheduling priority (nice value) of threads
+    std::optional<int> nice;
+    /// SCHED_FIFO priority 1..99, e.g. of tick thread, overrides nice
+    std::optional<int> realtime_priority;
+  };
+
+  /// Placements by thread class
+  using ThreadPlacements = std::map<std::string, ThreadPlacement, std::less<>>;
+
+  /// Thread of process, as returned by admin API
+  struct ThreadJson {
+    uint64_t tid;
+    std::string name;
+    std::string thread_class;
+    /// CPU thread ran on last
+    int64_t cpu;
+    /// CPUs thread may run on, in cpulist format
+    std::string affinity;
+    int64_t nice;
+
+    JSON_FIELDS(tid, name, thread_class, cpu, affinity, nice);
+  };
+
+  /// Class of thread name, up to first '.' or ':', e.g. `pool` of `pool.3`
+  std::string_view threadClass(std::string_view name);
+
+  /// Parse cpulist like "0-3,8", nullopt if malformed
+  std::optional<std::vector<uint32_t>> parseCpuList(std::string_view list);
+
+  std::string formatCpuList(const std::vector<uint32_t> &cpus);
+
+  /**
+   * Set placements, called on start before node threads are spawned.
+   * Applied to threads named by `setThreadName`.
+   */
+  void setThreadPlacements(ThreadPlacements placements);
+
+  /// Name current thread and apply placement of its class
+  void setThreadName(const std::string &name);
+
+  /**
+   * Apply placements to all threads of process by their names, including
+   * threads not started by node (RocksDB background threads).
+   */
+  void placeThreads();
+
+  /// All threads of process and CPUs they run on
+  std::vector<ThreadJson> listThreads();
+
+}  // namespace lean
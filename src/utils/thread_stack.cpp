@@ -0,0 +1,128 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/thread_stack.hpp"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#ifdef __linux__
+#include <csignal>
+#include <ctime>
+
+#include <execinfo.h>
+#include <semaphore.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace lean {
+
+#ifdef __linux__
+
+  namespace {
+    constexpr size_t kMaxFrames = 64;
+
+    /// State of capture in progress, shared with signal handler
+    struct Capture {
+      std::array<void *, kMaxFrames> frames{};
+      std::atomic_int size = 0;
+      /// Thread to capture, handler ignores signal sent to other thread
+      std::atomic<pid_t> tid = 0;
+      sem_t done{};
+    };
+
+    Capture capture;
+
+    void onSignal(int) {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+      if (capture.tid.load() != static_cast<pid_t>(syscall(SYS_gettid))) {
+        return;
+      }
+      auto saved_errno = errno;
+      capture.size = backtrace(capture.frames.data(), kMaxFrames);
+      capture.tid = 0;
+      sem_post(&capture.done);
+      errno = saved_errno;
+    }
+
+    int captureSignal() {
+      return SIGRTMIN;
+    }
+
+    void install() {
+      sem_init(&capture.done, 0, 0);
+      // First call of `backtrace` loads unwinder, not safe in handler
+      std::array<void *, 1> frame{};
+      backtrace(frame.data(), frame.size());
+      struct sigaction action{};
+      action.sa_handler = onSignal;
+      action.sa_flags = SA_RESTART;
+      sigemptyset(&action.sa_mask);
+      sigaction(captureSignal(), &action, nullptr);
+    }
+
+    bool wait(std::chrono::milliseconds timeout) {
+      timespec deadline{};
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      auto ns = deadline.tv_nsec
+              + std::chrono::nanoseconds{timeout}.count();
+      deadline.tv_sec += ns / 1'000'000'000;
+      deadline.tv_nsec = ns % 1'000'000'000;
+      while (sem_timedwait(&capture.done, &deadline) != 0) {
+        if (errno != EINTR) {
+          return false;
+        }
+      }
+      return true;
+    }
+  }  // namespace
+
+  std::optional<std::vector<std::string>> captureThreadStack(
+      uint64_t tid, std::chrono::milliseconds timeout) {
+    static std::once_flag installed;
+    std::call_once(installed, install);
+    static std::mutex mutex;
+    std::lock_guard lock{mutex};
+
+    // Drop completion of previous capture timed out, if it came later
+    while (sem_trywait(&capture.done) == 0) {}
+    capture.size = 0;
+    capture.tid = static_cast<pid_t>(tid);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+    if (syscall(SYS_tgkill, getpid(), static_cast<pid_t>(tid), captureSignal())
+        != 0) {
+      capture.tid = 0;
+      return std::nullopt;
+    }
+    if (not wait(timeout)) {
+      capture.tid = 0;
+      return std::nullopt;
+    }
+
+    auto size = capture.size.load();
+    std::unique_ptr<char *, decltype(&free)> symbols{
+        backtrace_symbols(capture.frames.data(), size), &free};
+    std::vector<std::string> frames;
+    // Skip frames of signal handler
+    for (int i = 2; i < size; ++i) {
+      frames.emplace_back(symbols ? symbols.get()[i] : "?");
+    }
+    return frames;
+  }
+
+#else
+
+  std::optional<std::vector<std::string>> captureThreadStack(
+      uint64_t, std::chrono::milliseconds) {
+    return std::nullopt;
+  }
+
+#endif
+
+}  // namespace lean
@@ -0,0 +1,31 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace lean {
+
+  /**
+   * Capture stack of running thread of process, e.g. of stalled event loop.
+   *
+   * Thread is interrupted with signal, its handler records return addresses
+   * and resumes thread. Addresses are symbolized by caller, so thread is
+   * stopped only for unwinding. Captures are serialized.
+   *
+   * @param tid platform id of thread, as `gettid` returns
+   * @return symbolized frames, innermost first; nullopt if thread is gone,
+   * didn't respond in `timeout` or capture is not supported on platform
+   */
+  std::optional<std::vector<std::string>> captureThreadStack(
+      uint64_t tid, std::chrono::milliseconds timeout);
+
+}  // namespace lean
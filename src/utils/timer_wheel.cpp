@@ -0,0 +1,202 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/timer_wheel.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <utility>
+
+#include "utils/thread_placement.hpp"
+
+namespace lean {
+  constexpr uint64_t kNoWake = std::numeric_limits<uint64_t>::max();
+
+  TimerWheel::TimerWheel() : start_{Clock::now()} {
+    thread_ = std::thread{[this] {
+      setThreadName("timer");
+      run();
+    }};
+  }
+
+  TimerWheel::~TimerWheel() {
+    {
+      std::lock_guard lock{mutex_};
+      stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+  }
+
+  TimerWheel::TimerId TimerWheel::addAt(Clock::time_point deadline,
+                                        Task task) {
+    std::unique_lock lock{mutex_};
+    if (timers_.empty()) {
+      // Nothing to process, skip idle ticks
+      now_tick_ = std::max(now_tick_, tickOf(Clock::now()));
+    }
+    // Round up, so timer never fires before deadline
+    auto expiry = tickOf(deadline);
+    if (timeOf(expiry) < deadline) {
+      ++expiry;
+    }
+    expiry = std::max(expiry, now_tick_ + 1);
+
+    auto id = next_id_++;
+    auto &timer = timers_[id];
+    timer.expiry = expiry;
+    timer.task = std::move(task);
+    place(id, timer);
+    if (expiry < wake_tick_) {
+      lock.unlock();
+      cv_.notify_one();
+    }
+    return id;
+  }
+
+  TimerWheel::TimerId TimerWheel::add(std::chrono::milliseconds delay,
+                                      Task task) {
+    return addAt(Clock::now() + delay, std::move(task));
+  }
+
+  bool TimerWheel::cancel(TimerId id) {
+    std::lock_guard lock{mutex_};
+    auto it = timers_.find(id);
+    if (it == timers_.end()) {
+      return false;
+    }
+    unplace(it->second);
+    timers_.erase(it);
+    return true;
+  }
+
+  size_t TimerWheel::size() const {
+    std::lock_guard lock{mutex_};
+    return timers_.size();
+  }
+
+  uint64_t TimerWheel::tickOf(Clock::time_point time) const {
+    if (time <= start_) {
+      return 0;
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time - start_)
+         / kTick;
+  }
+
+  TimerWheel::Clock::time_point TimerWheel::timeOf(uint64_t tick) const {
+    return start_ + kTick * static_cast<int64_t>(tick);
+  }
+
+  void TimerWheel::place(TimerId id, Timer &timer) {
+    // Expired timer is placed to current slot, `advance` processes it next
+    auto expiry = std::max(timer.expiry, now_tick_);
+    auto delta = expiry - now_tick_;
+    size_t level = 0;
+    while (level < kLevels - 1
+           and delta >= (1ull << (kSlotBits * (level + 1)))) {
+      ++level;
+    }
+    if (delta >= (1ull << (kSlotBits * kLevels))) {
+      // Beyond wheel span, timer is placed again when its slot is reached
+      expiry = now_tick_ + (1ull << (kSlotBits * kLevels)) - 1;
+    }
+    auto slot = (expiry >> (kSlotBits * level)) & kSlotMask;
+    auto &list = slots_[level][slot];
+    timer.level = static_cast<uint8_t>(level);
+    timer.slot = static_cast<uint8_t>(slot);
+    timer.position = list.emplace(list.end(), id);
+    occupied_[level] |= 1ull << slot;
+  }
+
+  void TimerWheel::unplace(const Timer &timer) {
+    auto &list = slots_[timer.level][timer.slot];
+    list.erase(timer.position);
+    if (list.empty()) {
+      occupied_[timer.level] &= ~(1ull << timer.slot);
+    }
+  }
+
+  void TimerWheel::advance(std::vector<Task> &expired) {
+    ++now_tick_;
+    auto take = [&](size_t level, uint64_t slot) {
+      occupied_[level] &= ~(1ull << slot);
+      return std::exchange(slots_[level][slot], {});
+    };
+    // Higher levels first, they may refill lower level slots reached now
+    for (size_t level = kLevels - 1; level > 0; --level) {
+      auto shift = kSlotBits * level;
+      if ((now_tick_ & ((1ull << shift) - 1)) != 0) {
+        continue;
+      }
+      for (auto id : take(level, (now_tick_ >> shift) & kSlotMask)) {
+        place(id, timers_.at(id));
+      }
+    }
+    for (auto id : take(0, now_tick_ & kSlotMask)) {
+      auto it = timers_.find(id);
+      if (it->second.expiry > now_tick_) {
+        place(id, it->second);
+        continue;
+      }
+      expired.emplace_back(std::move(it->second.task));
+      timers_.erase(it);
+    }
+  }
+
+  std::optional<uint64_t> TimerWheel::nextEventTick() const {
+    if (timers_.empty()) {
+      return std::nullopt;
+    }
+    auto lap = now_tick_ & ~kSlotMask;
+    auto offset = (now_tick_ & kSlotMask) + 1;
+    if (offset < kSlots) {
+      if (auto ahead = occupied_[0] >> offset; ahead != 0) {
+        return lap + offset + std::countr_zero(ahead);
+      }
+    }
+    // Earlier slots and higher levels are handled starting from next lap
+    return lap + kSlots;
+  }
+
+  void TimerWheel::run() {
+    std::vector<Task> expired;
+    std::unique_lock lock{mutex_};
+    while (not stop_) {
+      auto target = tickOf(Clock::now());
+      while (now_tick_ < target and not timers_.empty()) {
+        advance(expired);
+      }
+      if (not expired.empty()) {
+        wake_tick_ = 0;
+        lock.unlock();
+        for (auto &task : expired) {
+          try {
+            task();
+          } catch (std::exception &e) {
+            std::cerr << "Exception during timer execution: " << e.what()
+                      << std::endl;
+          } catch (...) {
+            std::cerr << "Unknown exception during timer execution\n";
+          }
+        }
+        expired.clear();
+        lock.lock();
+        continue;
+      }
+      if (auto next = nextEventTick()) {
+        wake_tick_ = *next;
+        cv_.wait_until(lock, timeOf(*next));
+      } else {
+        wake_tick_ = kNoWake;
+        cv_.wait(lock, [&] { return stop_ or not timers_.empty(); });
+      }
+    }
+  }
+
+}  // namespace lean
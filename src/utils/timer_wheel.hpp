@@ -0,0 +1,105 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace lean {
+
+  /**
+   * Hierarchical timer wheel with own thread.
+   *
+   * Four levels of 64 slots, level `l` slot covers `64^l` ticks, timers are
+   * moved to lower level when its slot is reached. Insert and cancel are O(1)
+   * regardless of number of pending timers. Timers never fire early and fire
+   * not later than one tick after deadline, unless previous tasks are slow.
+   * Tasks run on wheel thread and must be short, heavy work should be posted
+   * elsewhere.
+   */
+  class TimerWheel {
+   public:
+    using Clock = std::chrono::steady_clock;
+    using Task = std::function<void()>;
+    using TimerId = uint64_t;
+
+    static constexpr std::chrono::milliseconds kTick{1};
+
+    TimerWheel();
+
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    /// Drops pending timers and joins thread
+    ~TimerWheel();
+
+    TimerId addAt(Clock::time_point deadline, Task task);
+    TimerId add(std::chrono::milliseconds delay, Task task);
+
+    /// @return false if timer already fired or was cancelled
+    bool cancel(TimerId id);
+
+    /// Number of pending timers
+    size_t size() const;
+
+   private:
+    static constexpr size_t kLevels = 4;
+    static constexpr size_t kSlotBits = 6;
+    static constexpr size_t kSlots = 1 << kSlotBits;
+    static constexpr uint64_t kSlotMask = kSlots - 1;
+
+    using Slot = std::list<TimerId>;
+
+    struct Timer {
+      uint64_t expiry;
+      Task task;
+      uint8_t level;
+      uint8_t slot;
+      Slot::iterator position;
+    };
+
+    uint64_t tickOf(Clock::time_point time) const;
+    Clock::time_point timeOf(uint64_t tick) const;
+
+    /// Put timer to slot by its expiry relative to `now_tick_`
+    void place(TimerId id, Timer &timer);
+    void unplace(const Timer &timer);
+
+    /// Process one tick, appending expired tasks
+    void advance(std::vector<Task> &expired);
+
+    /// First tick when something has to be done, if any timer is pending
+    std::optional<uint64_t> nextEventTick() const;
+
+    void run();
+
+    const Clock::time_point start_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    /// Last processed tick
+    uint64_t now_tick_ = 0;
+    /// Tick thread sleeps until, to wake it only for earlier timers
+    uint64_t wake_tick_ = 0;
+    TimerId next_id_ = 1;
+    std::unordered_map<TimerId, Timer> timers_;
+    std::array<std::array<Slot, kSlots>, kLevels> slots_;
+    /// Bit per non-empty slot
+    std::array<uint64_t, kLevels> occupied_{};
+    std::thread thread_;
+  };
+
+}  // namespace lean
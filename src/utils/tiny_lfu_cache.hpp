@@ -0,0 +1,315 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <qtils/outcome.hpp>
+
+#include "utils/frequency_sketch.hpp"
+
+namespace lean {
+
+  /**
+   * Cache with `LruCache` API and W-TinyLFU admission, for caches which
+   * scans (bulk serving, old states walked by api clients) would flush.
+   *
+   * New entries go to window LRU. Entry leaving window enters main
+   * segmented LRU only if it was accessed more often recently than main
+   * entry it would evict, as estimated by frequency sketch, so entries used
+   * once don't push out ones used repeatedly. Main entries accessed again
+   * move from probation to protected segment.
+   *
+   * Capacity is in entries, or in weight of values, e.g. bytes, if weigher
+   * is given.
+   *
+   * Unlike `LruCache`, equal values of different keys are not deduplicated.
+   * Thread safe.
+   */
+  template <typename Key, typename Value, typename Hash = std::hash<Key>>
+  class TinyLfuCache {
+   public:
+    using Weigher = std::function<size_t(const Value &value)>;
+
+    struct Config {
+      /// Total weight of entries
+      size_t capacity;
+      /// Weight of value, 1 if not set
+      Weigher weigher;
+      /// Part of capacity for new entries, larger favors recency
+      size_t window_percent = 1;
+      /// Entries to track frequency of, `capacity` if zero
+      size_t expected_entries = 0;
+    };
+
+    struct Stats {
+      uint64_t hits = 0;
+      uint64_t misses = 0;
+      /// Entries dropped on leaving window, as less frequent than main ones
+      uint64_t rejected = 0;
+      size_t entries = 0;
+      size_t weight = 0;
+    };
+
+    explicit TinyLfuCache(size_t capacity)
+        : TinyLfuCache(Config{.capacity = capacity}) {}
+
+    explicit TinyLfuCache(Config config)
+        : weigher_{std::move(config.weigher)},
+          window_capacity_{std::max<size_t>(
+              1, config.capacity * config.window_percent / 100)},
+          main_capacity_{config.capacity
+                         - std::min(config.capacity, window_capacity_)},
+          protected_capacity_{main_capacity_ * kProtectedPercent / 100},
+          sketch_{config.expected_entries != 0 ? config.expected_entries
+                                               : config.capacity} {
+      BOOST_ASSERT(config.capacity > 0);
+      BOOST_ASSERT(config.window_percent <= 100);
+    }
+
+    std::optional<std::shared_ptr<const Value>> get(const Key &key) {
+      std::lock_guard lock{mutex_};
+      sketch_.increment(Hash{}(key));
+      auto it = index_.find(key);
+      if (it == index_.end()) {
+        ++stats_.misses;
+        return std::nullopt;
+      }
+      ++stats_.hits;
+      touch(it->second);
+      return it->second->value;
+    }
+
+    /// Access without counting hit or miss and without touching order
+    bool contains(const Key &key) const {
+      std::lock_guard lock{mutex_};
+      return index_.contains(key);
+    }
+
+    template <typename ValueArg>
+    std::shared_ptr<const Value> put(const Key &key, ValueArg &&value) {
+      static_assert(std::is_convertible_v<ValueArg, Value>
+                    or std::is_constructible_v<Value, ValueArg>);
+      auto value_ptr =
+          std::make_shared<const Value>(std::forward<ValueArg>(value));
+      std::lock_guard lock{mutex_};
+      sketch_.increment(Hash{}(key));
+      insert(key, value_ptr);
+      return value_ptr;
+    }
+
+    outcome::result<std::shared_ptr<const Value>> get_else(
+        const Key &key, const std::function<outcome::result<Value>()> &func) {
+      if (auto opt = get(key); opt.has_value()) {
+        return opt.value();
+      }
+      auto res = func();
+      if (not res.has_value()) {
+        return res.as_failure();
+      }
+      auto value_ptr = std::make_shared<const Value>(std::move(res.value()));
+      // Access is counted by `get` already
+      std::lock_guard lock{mutex_};
+      insert(key, value_ptr);
+      return value_ptr;
+    }
+
+    /// Keys of window, protected and probation segments, each from most to
+    /// least recently used
+    std::vector<Key> keys() const {
+      std::lock_guard lock{mutex_};
+      std::vector<Key> keys;
+      keys.reserve(index_.size());
+      for (auto *segment : {&window_, &protected_, &probation_}) {
+        for (auto &entry : segment->entries) {
+          keys.emplace_back(entry.key);
+        }
+      }
+      return keys;
+    }
+
+    void erase(const Key &key) {
+      std::lock_guard lock{mutex_};
+      auto it = index_.find(key);
+      if (it != index_.end()) {
+        remove(it->second);
+      }
+    }
+
+    void erase_if(const std::function<bool(const Key &key, const Value &value)>
+                      &predicate) {
+      std::lock_guard lock{mutex_};
+      for (auto *segment : {&window_, &protected_, &probation_}) {
+        for (auto it = segment->entries.begin();
+             it != segment->entries.end();) {
+          auto entry = it++;
+          if (predicate(entry->key, *entry->value)) {
+            remove(entry);
+          }
+        }
+      }
+    }
+
+    Stats stats() const {
+      std::lock_guard lock{mutex_};
+      auto stats = stats_;
+      stats.entries = index_.size();
+      stats.weight = window_.weight + probation_.weight + protected_.weight;
+      return stats;
+    }
+
+   private:
+    /// Part of main capacity for entries accessed again in main
+    static constexpr size_t kProtectedPercent = 80;
+
+    enum class SegmentId : uint8_t { WINDOW, PROBATION, PROTECTED };
+
+    struct Entry {
+      Key key;
+      std::shared_ptr<const Value> value;
+      size_t weight;
+      SegmentId segment;
+    };
+    using Iterator = typename std::list<Entry>::iterator;
+
+    /// LRU list, front is most recently used
+    struct Segment {
+      std::list<Entry> entries;
+      size_t weight = 0;
+    };
+
+    Segment &segmentOf(SegmentId id) {
+      switch (id) {
+        case SegmentId::WINDOW:
+          return window_;
+        case SegmentId::PROBATION:
+          return probation_;
+        case SegmentId::PROTECTED:
+          break;
+      }
+      return protected_;
+    }
+
+    size_t weigh(const Value &value) const {
+      return weigher_ ? weigher_(value) : 1;
+    }
+
+    /// Move entry to front of segment `to`
+    void move(Iterator entry, SegmentId to) {
+      auto &from_segment = segmentOf(entry->segment);
+      auto &to_segment = segmentOf(to);
+      from_segment.weight -= entry->weight;
+      to_segment.weight += entry->weight;
+      entry->segment = to;
+      to_segment.entries.splice(
+          to_segment.entries.begin(), from_segment.entries, entry);
+    }
+
+    void remove(Iterator entry) {
+      auto &segment = segmentOf(entry->segment);
+      segment.weight -= entry->weight;
+      index_.erase(entry->key);
+      segment.entries.erase(entry);
+    }
+
+    void touch(Iterator entry) {
+      if (entry->segment == SegmentId::WINDOW) {
+        move(entry, SegmentId::WINDOW);
+        return;
+      }
+      move(entry, SegmentId::PROTECTED);
+      // Least recently used protected entries get second chance in probation
+      while (protected_.weight > protected_capacity_
+             and protected_.entries.size() > 1) {
+        move(std::prev(protected_.entries.end()), SegmentId::PROBATION);
+      }
+    }
+
+    void insert(const Key &key, std::shared_ptr<const Value> value) {
+      auto weight = weigh(*value);
+      if (auto it = index_.find(key); it != index_.end()) {
+        auto &entry = it->second;
+        auto &segment = segmentOf(entry->segment);
+        segment.weight = segment.weight - entry->weight + weight;
+        entry->value = std::move(value);
+        entry->weight = weight;
+        touch(entry);
+      } else {
+        window_.entries.emplace_front(Entry{
+            .key = key,
+            .value = std::move(value),
+            .weight = weight,
+            .segment = SegmentId::WINDOW,
+        });
+        window_.weight += weight;
+        index_.emplace(key, window_.entries.begin());
+      }
+      evict();
+    }
+
+    /// Main entry to evict for candidate, probation before protected
+    std::optional<Iterator> victim(Iterator candidate) {
+      for (auto *segment : {&probation_, &protected_}) {
+        for (auto it = segment->entries.rbegin();
+             it != segment->entries.rend();
+             ++it) {
+          auto entry = std::prev(it.base());
+          if (entry != candidate) {
+            return entry;
+          }
+        }
+      }
+      return std::nullopt;
+    }
+
+    /// Move entries over window capacity to main, if they are admitted
+    void evict() {
+      while (window_.weight > window_capacity_) {
+        auto candidate = std::prev(window_.entries.end());
+        move(candidate, SegmentId::PROBATION);
+        if (candidate->weight > main_capacity_) {
+          ++stats_.rejected;
+          remove(candidate);
+          continue;
+        }
+        auto frequency = sketch_.frequency(Hash{}(candidate->key));
+        while (probation_.weight + protected_.weight > main_capacity_) {
+          auto evicted = victim(candidate);
+          if (not evicted.has_value()
+              or sketch_.frequency(Hash{}((*evicted)->key)) >= frequency) {
+            ++stats_.rejected;
+            remove(candidate);
+            break;
+          }
+          remove(*evicted);
+        }
+      }
+    }
+
+    Weigher weigher_;
+    const size_t window_capacity_;
+    const size_t main_capacity_;
+    const size_t protected_capacity_;
+    mutable std::mutex mutex_;
+    FrequencySketch sketch_;
+    std::unordered_map<Key, Iterator, Hash> index_;
+    Segment window_;
+    Segment probation_;
+    Segment protected_;
+    Stats stats_;
+  };
+
+}  // namespace lean
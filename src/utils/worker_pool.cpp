@@ -0,0 +1,143 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/worker_pool.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+#include <fmt/format.h>
+
+#include "utils/thread_placement.hpp"
+
+namespace lean {
+  namespace {
+    struct CurrentWorker {
+      const WorkerPool *pool = nullptr;
+      size_t index = 0;
+    };
+    thread_local CurrentWorker current_worker;
+  }  // namespace
+
+  WorkerPool::WorkerPool(size_t thread_count) {
+    if (thread_count == 0) {
+      thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers_.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+      workers_.emplace_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < thread_count; ++i) {
+      workers_[i]->thread = std::thread{[this, i] {
+        setThreadName(fmt::format("pool.{}", i));
+        current_worker = {.pool = this, .index = i};
+        run(i);
+      }};
+    }
+  }
+
+  WorkerPool::~WorkerPool() {
+    {
+      std::lock_guard lock{sleep_mutex_};
+      stop_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto &worker : workers_) {
+      worker->thread.join();
+    }
+  }
+
+  size_t WorkerPool::size() const {
+    return workers_.size();
+  }
+
+  void WorkerPool::post(Task task, std::optional<size_t> affinity) {
+    size_t index = 0;
+    if (affinity.has_value()) {
+      index = affinity.value() % workers_.size();
+    } else if (current_worker.pool == this) {
+      index = current_worker.index;
+    } else {
+      index = next_worker_.fetch_add(1) % workers_.size();
+    }
+    {
+      auto &worker = *workers_[index];
+      std::lock_guard lock{worker.mutex};
+      worker.tasks.emplace_back(std::move(task));
+    }
+    // Either sleeping worker is seen here, or it sees `pending_` before wait
+    pending_.fetch_add(1);
+    if (sleeping_.load() != 0) {
+      { std::lock_guard lock{sleep_mutex_}; }
+      sleep_cv_.notify_one();
+    }
+  }
+
+  void WorkerPool::wait(std::latch &latch) {
+    if (current_worker.pool == this) {
+      Task task;
+      while (not latch.try_wait() and pop(current_worker.index, task)) {
+        execute(task);
+        task = nullptr;
+      }
+    }
+    latch.wait();
+  }
+
+  void WorkerPool::run(size_t index) {
+    Task task;
+    for (;;) {
+      if (pop(index, task)) {
+        execute(task);
+        task = nullptr;
+        continue;
+      }
+      std::unique_lock lock{sleep_mutex_};
+      if (stop_ and pending_.load() == 0) {
+        return;
+      }
+      sleeping_.fetch_add(1);
+      sleep_cv_.wait(lock, [&] { return stop_ or pending_.load() != 0; });
+      sleeping_.fetch_sub(1);
+    }
+  }
+
+  bool WorkerPool::pop(size_t index, Task &task) {
+    if (pending_.load() == 0) {
+      return false;
+    }
+    for (size_t i = 0; i < workers_.size(); ++i) {
+      auto &worker = *workers_[(index + i) % workers_.size()];
+      std::lock_guard lock{worker.mutex};
+      if (worker.tasks.empty()) {
+        continue;
+      }
+      if (i == 0) {
+        task = std::move(worker.tasks.front());
+        worker.tasks.pop_front();
+      } else {
+        task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+      }
+      pending_.fetch_sub(1);
+      return true;
+    }
+    return false;
+  }
+
+  void WorkerPool::execute(const Task &task) {
+    try {
+      task();
+    } catch (std::exception &e) {
+      std::cerr << "Exception during task execution: " << e.what()
+                << std::endl;
+    } catch (...) {
+      std::cerr << "Unknown exception during task execution\n";
+    }
+  }
+
+}  // namespace lean
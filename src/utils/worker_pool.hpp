@@ -0,0 +1,85 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace lean {
+
+  /**
+   * Work-stealing thread pool, shared by subsystems with CPU-heavy tasks
+   * (signature verification and aggregation, subscription engine pool
+   * tasks), so they don't spawn own threads.
+   *
+   * Each worker has own queue. Task goes to worker chosen by affinity hint,
+   * to current worker when posted from pool thread, or round robin.
+   * Idle workers steal tasks from other queues.
+   */
+  class WorkerPool {
+   public:
+    using Task = std::function<void()>;
+
+    /// @param thread_count number of workers, 0 means number of CPUs
+    explicit WorkerPool(size_t thread_count);
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    /// Runs remaining tasks and joins workers
+    ~WorkerPool();
+
+    size_t size() const;
+
+    /**
+     * Queue task for execution.
+     * @param affinity prefer worker `affinity % size()`, tasks with same hint
+     * tend to run on same thread
+     */
+    void post(Task task, std::optional<size_t> affinity = std::nullopt);
+
+    /**
+     * Wait for `latch`.
+     * Pool thread runs queued tasks meanwhile, so waiting for tasks posted
+     * from pool task can't starve pool.
+     */
+    void wait(std::latch &latch);
+
+   private:
+    struct Worker {
+      std::mutex mutex;
+      std::deque<Task> tasks;
+      std::thread thread;
+    };
+
+    void run(size_t index);
+
+    /// Take own oldest task, or steal newest task of other worker
+    bool pop(size_t index, Task &task);
+
+    static void execute(const Task &task);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic_size_t next_worker_ = 0;
+    /// Tasks queued and not taken yet
+    std::atomic_size_t pending_ = 0;
+    std::atomic_size_t sleeping_ = 0;
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    /// Guarded by `sleep_mutex_`
+    bool stop_ = false;
+  };
+
+}  // namespace lean
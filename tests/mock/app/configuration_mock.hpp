@@ -21,9 +21,10 @@ namespace lean::app {
     MOCK_METHOD(const std::string&, nodeId, (), (const, override));
     MOCK_METHOD(const std::filesystem::path&, basePath, (), (const, override));
     MOCK_METHOD(const std::filesystem::path&, bootnodesFile, (), (const, override));
-    MOCK_METHOD(const std::optional<std::string>&, stateSyncUrl, (), (const, override));
+    MOCK_METHOD(const std::vector<std::string>&, stateSyncUrls, (), (const, override));
     MOCK_METHOD(bool, cliIsAggregator, (), (const, override));
     MOCK_METHOD(uint64_t, cliSubnetCount, (), (const, override));
+    MOCK_METHOD(const std::vector<uint64_t>&, cliAggregateSubnets, (), (const, override));
 
     MOCK_METHOD(const DatabaseConfig &, database, (), (const, override));
 
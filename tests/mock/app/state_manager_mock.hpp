@@ -19,6 +19,21 @@ namespace lean::app {
       atPrepare(cb);
     }
 
+    MOCK_METHOD(void,
+                atPrepareStep,
+                (std::string, std::vector<std::string>, OnPrepare),
+                ());
+    void atPrepareStep(std::string name,
+                       std::vector<std::string> after,
+                       OnPrepare &&cb) override {
+      atPrepareStep(std::move(name), std::move(after), cb);
+    }
+
+    MOCK_METHOD(std::vector<PrepareStepTiming>,
+                prepareStepTimings,
+                (),
+                (const, override));
+
     MOCK_METHOD(void, atLaunch, (OnLaunch), ());
     void atLaunch(OnLaunch &&cb) override {
       atLaunch(cb);
@@ -50,6 +65,12 @@ namespace lean::app {
       queue_.first.emplace_back(cb);
     }
 
+    void atPrepareStep(std::string,
+                       std::vector<std::string>,
+                       OnPrepare &&cb) override {
+      queue_.first.emplace_back(cb);
+    }
+
     void atLaunch(OnLaunch &&cb) override {
       queue_.second.emplace_back(cb);
     }
@@ -9,6 +9,7 @@
 #include <gmock/gmock.h>
 
 #include "blockchain/block_storage.hpp"
+#include "types/fork_choice_snapshot.hpp"
 
 namespace lean::blockchain {
 
@@ -34,6 +35,13 @@ namespace lean::blockchain {
                 (const BlockIndex &),
                 (override));
 
+    MOCK_METHOD(outcome::result<void>,
+                applyTreeChanges,
+                (std::vector<BlockHash>,
+                 std::span<const BlockIndex>,
+                 std::span<const BlockIndex>),
+                (override));
+
     MOCK_METHOD(outcome::result<std::vector<BlockHash>>,
                 getBlockHash,
                 (Slot),
@@ -61,6 +69,11 @@ namespace lean::blockchain {
                 (const BlockHash &),
                 (const, override));
 
+    MOCK_METHOD(outcome::result<std::vector<BlockHeader>>,
+                getBlockHeadersFromSlot,
+                (Slot),
+                (const, override));
+
     MOCK_METHOD(outcome::result<void>,
                 putBlockBody,
                 (const BlockHash &, const BlockBody &),
@@ -91,11 +104,31 @@ namespace lean::blockchain {
                 (const BlockHash &block_hash),
                 (const, override));
 
+    MOCK_METHOD(outcome::result<std::optional<StateCheckpoints>>,
+                getStateCheckpoints,
+                (const BlockHash &block_hash),
+                (const, override));
+
     MOCK_METHOD(outcome::result<void>,
                 removeState,
                 (const BlockHash &block_hash),
                 (override));
 
+    MOCK_METHOD(outcome::result<void>,
+                rebaseState,
+                (const BlockHash &block_hash),
+                (override));
+
+    MOCK_METHOD(outcome::result<void>,
+                putForkChoiceSnapshot,
+                (const ForkChoiceSnapshot &snapshot),
+                (override));
+
+    MOCK_METHOD(outcome::result<std::optional<ForkChoiceSnapshot>>,
+                getForkChoiceSnapshot,
+                (),
+                (const, override));
+
     MOCK_METHOD(outcome::result<BlockData>,
                 getBlock,
                 (const BlockHash &, BlockParts),
@@ -106,10 +139,41 @@ namespace lean::blockchain {
                 (const BlockHash &),
                 (override));
 
+    MOCK_METHOD(void,
+                markRemoved,
+                (std::span<const BlockIndex>),
+                (override));
+
+    MOCK_METHOD(outcome::result<std::vector<BlockHash>>,
+                restoreMarkedRemoved,
+                (),
+                (override));
+
+    MOCK_METHOD(outcome::result<void>,
+                moveToAncient,
+                (std::span<const BlockIndex>),
+                (override));
+
+    MOCK_METHOD(outcome::result<std::optional<BackfillCursor>>,
+                getBackfillCursor,
+                (),
+                (const, override));
+
+    MOCK_METHOD(outcome::result<void>,
+                putBackfilledBlocks,
+                (std::span<const SignedBlock>,
+                 const std::optional<BackfillCursor> &),
+                (override));
+
     MOCK_METHOD(outcome::result<SignedBlock>,
                 getSignedBlock,
                 (const BlockHash &),
                 (const, override));
+
+    MOCK_METHOD(outcome::result<std::vector<std::optional<SignedBlock>>>,
+                tryGetSignedBlocks,
+                (std::span<const BlockHash>),
+                (const, override));
   };
 
 }  // namespace lean::blockchain
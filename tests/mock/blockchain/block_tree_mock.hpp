@@ -8,6 +8,7 @@
 
 #include <gmock/gmock.h>
 
+#include "blockchain/block_storage.hpp"
 #include "blockchain/block_tree.hpp"
 #include "types/block_body.hpp"
 #include "types/signed_block.hpp"
@@ -53,7 +54,10 @@ namespace lean::blockchain {
                 (const BlockHash &block_hash, const BlockHeader &block_header),
                 (override));
 
-    MOCK_METHOD(outcome::result<void>, addBlock, (SignedBlock), (override));
+    MOCK_METHOD(outcome::result<void>,
+                addBlock,
+                (const SignedBlock &),
+                (override));
 
     MOCK_METHOD(outcome::result<void>,
                 removeLeaf,
@@ -80,6 +84,16 @@ namespace lean::blockchain {
                 (const BlockHash &block, uint64_t maximum),
                 (const, override));
 
+    MOCK_METHOD(outcome::result<std::optional<BlockHash>>,
+                getCanonicalHash,
+                (Slot slot),
+                (const, override));
+
+    MOCK_METHOD(outcome::result<std::vector<BlockIndex>>,
+                getCanonicalBlocks,
+                (Slot start_slot, uint64_t count),
+                (const, override));
+
     MOCK_METHOD(bool,
                 isFinalized,
                 (const BlockIndex &block),
@@ -99,6 +113,21 @@ namespace lean::blockchain {
                 (const BlockHash &block),
                 (const, override));
 
+    MOCK_METHOD(void,
+                forEachNonFinalizedAncestor,
+                (const BlockHash &block, const AncestorVisitor &visit),
+                (const, override));
+
+    MOCK_METHOD(std::optional<BlockIndex>,
+                getAncestorAtSlot,
+                (const BlockHash &block, Slot slot),
+                (const, override));
+
+    MOCK_METHOD(std::optional<CommonAncestor>,
+                getCommonAncestor,
+                (const BlockHash &lhs, const BlockHash &rhs),
+                (const, override));
+
     MOCK_METHOD(BlockIndex, lastFinalized, (), (const, override));
     MOCK_METHOD(Checkpoint, getLatestJustified, (), (const, override));
 
@@ -106,6 +135,22 @@ namespace lean::blockchain {
                 tryGetSignedBlock,
                 (const BlockHash block_hash),
                 (const, override));
+
+    MOCK_METHOD(outcome::result<std::vector<std::optional<SignedBlock>>>,
+                tryGetSignedBlocks,
+                (std::span<const BlockHash> block_hashes),
+                (const, override));
+
+    MOCK_METHOD(outcome::result<std::optional<BackfillCursor>>,
+                getBackfillCursor,
+                (),
+                (const, override));
+
+    MOCK_METHOD(outcome::result<void>,
+                addBackfilledBlocks,
+                (std::span<const SignedBlock>,
+                 const std::optional<BackfillCursor> &),
+                (override));
   };
 
 }  // namespace lean::blockchain
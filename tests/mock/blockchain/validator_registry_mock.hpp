@@ -17,8 +17,9 @@ namespace lean {
                 currentValidatorIndices,
                 (),
                 (const, override));
+    MOCK_METHOD(bool, isCurrentValidator, (ValidatorIndex), (const, override));
     MOCK_METHOD(ValidatorIndices, allValidatorsIndices, (), (const, override));
-    MOCK_METHOD(std::optional<std::string>,
+    MOCK_METHOD(std::optional<std::string_view>,
                 nodeIdByIndex,
                 (ValidatorIndex),
                 (const, override));
@@ -27,16 +27,16 @@ namespace lean::crypto::xmss {
                 (override));
     MOCK_METHOD(XmssAggregatedSignature,
                 aggregateSignatures,
-                (std::span<const std::vector<XmssPublicKey>>,
+                (std::span<const std::vector<XmssPublicKeyRef>>,
                  std::span<const XmssAggregatedSignature>,
-                 std::span<const XmssPublicKey>,
+                 std::span<const XmssPublicKeyRef>,
                  std::span<const XmssSignature>,
                  uint32_t,
                  const XmssMessage &),
                 (const, override));
     MOCK_METHOD(bool,
                 verifyAggregatedSignatures,
-                (std::span<const XmssPublicKey>,
+                (std::span<const XmssPublicKeyRef>,
                  uint32_t,
                  const XmssMessage &,
                  XmssAggregatedSignatureIn),
@@ -61,6 +61,8 @@ namespace lean::metrics {
   Histogram *field(const Labels &labels) override {     \
     return &histogram_;                                 \
   }
+#define METRIC_COUNTER_SHARDED(field, name, help)
+#define METRIC_HISTOGRAM_SHARDED(field, name, help, ...)
 
 #include "metrics/all_metrics.def"
 
@@ -71,6 +73,8 @@ namespace lean::metrics {
 #undef METRIC_COUNTER_LABELS
 #undef METRIC_HISTOGRAM
 #undef METRIC_HISTOGRAM_LABELS
+#undef METRIC_COUNTER_SHARDED
+#undef METRIC_HISTOGRAM_SHARDED
 
    private:
     mutable GaugeMock gauge_;
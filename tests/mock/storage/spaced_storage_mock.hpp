@@ -15,6 +15,8 @@ namespace lean::storage {
   class SpacedStorageMock : public SpacedStorage {
    public:
     MOCK_METHOD(std::shared_ptr<BufferStorage>, getSpace, (Space), (override));
+
+    MOCK_METHOD(std::unique_ptr<SpacedBatch>, createBatch, (), (override));
   };
 
 }  // namespace lean::storage
@@ -6,6 +6,10 @@
 
 #include "blockchain/fork_choice.hpp"
 
+#include <map>
+
+#include <qtils/cxx23/ranges/contains.hpp>
+
 #include "blockchain/impl/anchor_block_impl.hpp"
 #include "blockchain/impl/anchor_state_impl.hpp"
 #include "fork_choice_test_json.hpp"
@@ -126,15 +130,28 @@ TEST_P(ForkChoiceTest, ForkChoice) {
 
   auto app_config = std::make_shared<lean::app::ConfigurationMock>();
   EXPECT_CALL(*app_config, cliSubnetCount()).WillOnce(testing::Return(1));
+  std::vector<uint64_t> aggregate_subnets;
+  EXPECT_CALL(*app_config, cliAggregateSubnets())
+      .WillOnce(testing::ReturnRef(aggregate_subnets));
 
   lean::ValidatorRegistry::ValidatorIndices validator_indices{0};
   auto validator_registry = std::make_shared<lean::ValidatorRegistryMock>();
   EXPECT_CALL(*validator_registry, currentValidatorIndices())
       .Times(testing::AnyNumber())
       .WillRepeatedly(testing::ReturnRef(validator_indices));
+  EXPECT_CALL(*validator_registry, isCurrentValidator(testing::_))
+      .Times(testing::AnyNumber())
+      .WillRepeatedly([&](lean::ValidatorIndex index) {
+        return qtils::cxx23::ranges::contains(validator_indices, index);
+      });
+  // Names returned as views must outlive the registry calls
+  std::map<lean::ValidatorIndex, std::string> node_names;
   EXPECT_CALL(*validator_registry, nodeIdByIndex(_))
-      .WillRepeatedly(
-          [](lean::ValidatorIndex i) { return std::format("node_{}", i); });
+      .WillRepeatedly([&](lean::ValidatorIndex i) {
+        return std::optional<std::string_view>{
+            node_names.try_emplace(i, std::format("node_{}", i))
+                .first->second};
+      });
 
   auto chain_spec = std::make_shared<lean::app::ChainSpecMock>();
   EXPECT_CALL(*chain_spec, isAggregator()).WillOnce(testing::Return(true));
@@ -184,11 +201,25 @@ TEST_P(ForkChoiceTest, ForkChoice) {
       .WillRepeatedly([&](BlockHash hash) { return blocks.at(hash); });
   EXPECT_CALL(*block_tree, tryGetBlockHeader(_))
       .WillRepeatedly([&](BlockHash hash) { return blocks.at(hash); });
+  EXPECT_CALL(*block_tree, forEachNonFinalizedAncestor(_, _))
+      .WillRepeatedly([&](const BlockHash &hash, const auto &visit) {
+        for (auto it = blocks.find(hash);
+             it != blocks.end() and it->second.slot > last_finalized.slot;
+             it = blocks.find(it->second.parent_root)) {
+          if (not visit({
+                  .index = {it->second.slot, it->first},
+                  .parent_root = it->second.parent_root,
+                  .state_root = it->second.state_root,
+              })) {
+            break;
+          }
+        }
+      });
   EXPECT_CALL(*block_tree, getChildren(_)).WillRepeatedly([&](BlockHash hash) {
     return children[hash];
   });
   EXPECT_CALL(*block_tree, addBlock(_))
-      .WillRepeatedly([&](lean::SignedBlock block) {
+      .WillRepeatedly([&](const lean::SignedBlock &block) {
         auto header = block.block.getHeader();
         header.updateHash();
         blocks.emplace(header.hash(), header);
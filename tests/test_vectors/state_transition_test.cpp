@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include "blockchain/state_root.hpp"
 #include "blockchain/state_transition_function.hpp"
 #include "mock/blockchain/block_tree_mock.hpp"
 #include "mock/metrics_mock.hpp"
@@ -96,3 +97,53 @@ TEST_P(StateTransitionTest, StateTransition) {
     }
   }
 }
+
+/// Reference `STF::processSlots`, stepping one slot at a time
+void processSlotsStepwise(lean::State &state, lean::Slot slot) {
+  while (state.slot < slot) {
+    if (state.latest_block_header.state_root == lean::kZeroHash) {
+      state.latest_block_header.state_root = lean::stateRoot(state);
+    }
+    ++state.slot;
+  }
+}
+
+/**
+ * @given fixture states before each block, and after last one
+ * @when slots are processed with jump to target slot
+ * @then state equals one produced by stepping through each slot
+ */
+TEST_P(StateTransitionTest, ProcessSlotsMatchesStepwise) {
+  auto &[name, fixture] = GetParam();
+  auto logsys = testutil::prepareLoggers();
+  auto block_tree = std::make_shared<lean::blockchain::BlockTreeMock>();
+  EXPECT_CALL(*block_tree, getLatestJustified()).Times(testing::AnyNumber());
+  EXPECT_CALL(*block_tree, lastFinalized()).Times(testing::AnyNumber());
+  lean::STF stf{
+      logsys,
+      block_tree,
+      std::make_shared<lean::metrics::MetricsMock>(),
+  };
+  auto check = [&](const lean::State &state, lean::Slot slot) {
+    auto expected = state;
+    processSlotsStepwise(expected, slot);
+    auto actual = state;
+    ASSERT_TRUE(stf.processSlots(actual, slot).has_value());
+    EXPECT_EQ(actual.slot, expected.slot);
+    EXPECT_EQ(actual.latest_block_header, expected.latest_block_header);
+    EXPECT_EQ(lean::stateRoot(actual), lean::stateRoot(expected));
+  };
+  auto state = fixture.pre;
+  for (auto &block : fixture.blocks) {
+    if (block.slot <= state.slot) {
+      break;
+    }
+    check(state, block.slot);
+    if (stf.processSlots(state, block.slot).has_error()
+        or stf.processBlock(state, block).has_error()) {
+      break;
+    }
+  }
+  // Long liveness gap
+  check(state, state.slot + 100);
+}
@@ -5,6 +5,9 @@
  */
 
 #include "blockchain/fork_choice.hpp"
+
+#include <qtils/cxx23/ranges/contains.hpp>
+
 #include "crypto/xmss/xmss_provider_impl.hpp"
 #include "mock/app/validator_keys_manifest_mock.hpp"
 #include "mock/blockchain/block_storage_mock.hpp"
@@ -27,6 +30,11 @@ TEST_P(VerifySignaturesTest, VerifySignatures) {
   EXPECT_CALL(*validator_registry, currentValidatorIndices())
       .Times(testing::AnyNumber())
       .WillRepeatedly(testing::ReturnRef(validator_indices));
+  EXPECT_CALL(*validator_registry, isCurrentValidator(testing::_))
+      .Times(testing::AnyNumber())
+      .WillRepeatedly([&](lean::ValidatorIndex index) {
+        return qtils::cxx23::ranges::contains(validator_indices, index);
+      });
   auto block_storage = std::make_shared<lean::blockchain::BlockStorageMock>();
   EXPECT_CALL(*block_storage, getState(fixture.signed_block.block.parent_root))
       .WillOnce(testing::Return(fixture.anchor_state));
@@ -14,7 +14,8 @@ namespace test {
 
     rocks_.reset();
     ASSERT_NO_THROW(
-        rocks_ = std::make_shared<lean::storage::RocksDb>(logsys, app_config));
+        rocks_ = std::make_shared<lean::storage::RocksDb>(
+            logsys, app_config, nullptr));
 
     db_ = rocks_->getSpace(lean::storage::Space::Default);
     ASSERT_TRUE(db_) << "BaseRocksDB_Test: db is nullptr";
@@ -264,3 +264,77 @@ TEST_F(StateManagerTest, Run_CallSequence) {
   std::thread main([&] { EXPECT_NO_THROW(app_state_manager->run()); });
   main.join();
 }
+
+/**
+ * @given prepare steps without dependencies between them
+ * @when stage 'prepare' runs
+ * @then steps run at same time, and their timings are reported
+ */
+TEST_F(StateManagerTest, PrepareSteps_Concurrent) {
+  std::atomic_size_t started = 0;
+  auto step = [&] {
+    ++started;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (started != 2 and std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::yield();
+    }
+    return started == 2;
+  };
+  app_state_manager->atPrepareStep("load keys", {}, step);
+  app_state_manager->atPrepareStep("open db", {}, step);
+
+  app_state_manager->doPrepare();
+  EXPECT_EQ(app_state_manager->state(), StateManager::State::ReadyToStart);
+  auto timings = app_state_manager->prepareStepTimings();
+  ASSERT_EQ(timings.size(), 2);
+  EXPECT_FALSE(timings[0].failed);
+  EXPECT_FALSE(timings[1].failed);
+}
+
+/**
+ * @given prepare steps depending on each other, and failing step
+ * @when stage 'prepare' runs
+ * @then steps run after their dependencies, dependents of failed step are
+ * skipped and stage fails
+ */
+TEST_F(StateManagerTest, PrepareSteps_Dependencies) {
+  std::mutex mutex;
+  std::vector<std::string> order;
+  auto step = [&](std::string name, bool success) {
+    return [&, name, success] {
+      std::lock_guard lock{mutex};
+      order.emplace_back(name);
+      return success;
+    };
+  };
+  app_state_manager->atPrepareStep("block tree", {"db"}, step("tree", true));
+  app_state_manager->atPrepareStep("db", {}, step("db", true));
+  app_state_manager->atPrepareStep("keys", {}, step("keys", false));
+  app_state_manager->atPrepareStep("sign", {"keys"}, step("sign", true));
+  EXPECT_CALL(*prepare_cb, call()).Times(0);
+  app_state_manager->atPrepare([&] { return prepare_cb->operator()(); });
+
+  app_state_manager->doPrepare();
+  EXPECT_EQ(app_state_manager->state(), StateManager::State::ShuttingDown);
+  auto db = std::ranges::find(order, "db");
+  auto tree = std::ranges::find(order, "tree");
+  ASSERT_NE(tree, order.end());
+  EXPECT_LT(db, tree);
+  EXPECT_EQ(std::ranges::count(order, "sign"), 0);
+  EXPECT_EQ(app_state_manager->prepareStepTimings().size(), 4);
+}
+
+/**
+ * @given prepare steps depending on unknown step or on each other
+ * @when stage 'prepare' runs
+ * @then exception is thrown
+ */
+TEST_F(StateManagerTest, PrepareSteps_BadDependencies) {
+  app_state_manager->atPrepareStep("a", {"b"}, [] {});
+  app_state_manager->atPrepareStep("b", {"a"}, [] {});
+  EXPECT_THROW(app_state_manager->doPrepare(), AppStateException);
+
+  app_state_manager->reset();
+  app_state_manager->atPrepareStep("a", {"missing"}, [] {});
+  EXPECT_THROW(app_state_manager->doPrepare(), AppStateException);
+}
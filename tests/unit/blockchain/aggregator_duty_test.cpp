@@ -0,0 +1,110 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/aggregator_duty.hpp"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using lean::AggregatorDuty;
+using lean::Hash;
+using lean::ValidatorIndex;
+
+Hash testRoot(uint64_t i) {
+  Hash root;
+  for (size_t j = 0; j < root.size(); ++j) {
+    root[j] = static_cast<uint8_t>(i * 31 + j);
+  }
+  return root;
+}
+
+/// Duty of `self` among `aggregators`
+AggregatorDuty dutyOf(ValidatorIndex self,
+                      const std::vector<ValidatorIndex> &aggregators) {
+  std::vector<ValidatorIndex> peers;
+  for (auto aggregator : aggregators) {
+    if (aggregator != self) {
+      peers.emplace_back(aggregator);
+    }
+  }
+  return AggregatorDuty{peers};
+}
+
+/**
+ * @given aggregator without peers
+ * @then it is assigned all groups
+ */
+TEST(AggregatorDutyTest, AloneIsAssigned) {
+  AggregatorDuty duty;
+  for (uint64_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(duty.rank(3, i, testRoot(i)), AggregatorDuty::kAssigned);
+  }
+}
+
+/**
+ * @given several aggregators, each knowing others as peers
+ * @when each ranks itself for many groups
+ * @then each group has exactly one assigned and one fallback aggregator,
+ * and groups are spread evenly
+ */
+TEST(AggregatorDutyTest, RanksArePermutation) {
+  std::vector<ValidatorIndex> aggregators{1, 4, 7, 10};
+  std::map<ValidatorIndex, size_t> assigned;
+  constexpr size_t kGroups = 4000;
+  for (uint64_t i = 0; i < kGroups; ++i) {
+    auto root = testRoot(i);
+    std::vector<size_t> ranks;
+    for (auto self : aggregators) {
+      auto rank = dutyOf(self, aggregators).rank(self, i / 4, root);
+      ranks.emplace_back(rank);
+      if (rank == AggregatorDuty::kAssigned) {
+        ++assigned[self];
+      }
+    }
+    std::ranges::sort(ranks);
+    EXPECT_EQ(ranks, (std::vector<size_t>{0, 1, 2, 3}));
+  }
+  for (auto self : aggregators) {
+    EXPECT_GT(assigned[self], kGroups / aggregators.size() * 8 / 10) << self;
+  }
+}
+
+/**
+ * @given groups assigned among three aggregators
+ * @when fourth aggregator joins
+ * @then groups move only to new aggregator
+ */
+TEST(AggregatorDutyTest, JoinMovesOnlyToNewAggregator) {
+  std::vector<ValidatorIndex> aggregators{2, 5, 9};
+  auto joined = aggregators;
+  joined.emplace_back(12);
+  for (uint64_t i = 0; i < 1000; ++i) {
+    auto root = testRoot(i);
+    for (auto self : aggregators) {
+      auto before = dutyOf(self, aggregators).rank(self, i, root);
+      auto after = dutyOf(self, joined).rank(self, i, root);
+      EXPECT_TRUE(after == before or after == before + 1);
+      if (before == AggregatorDuty::kAssigned
+          and after != AggregatorDuty::kAssigned) {
+        EXPECT_EQ(dutyOf(12, joined).rank(12, i, root),
+                  AggregatorDuty::kAssigned);
+      }
+    }
+  }
+}
+
+/// Peers must agree on scores, whatever platform they run on
+TEST(AggregatorDutyTest, ScoreIsStable) {
+  EXPECT_EQ(AggregatorDuty::score(1, 2, testRoot(3)),
+            AggregatorDuty::score(1, 2, testRoot(3)));
+  EXPECT_NE(AggregatorDuty::score(1, 2, testRoot(3)),
+            AggregatorDuty::score(2, 2, testRoot(3)));
+  EXPECT_NE(AggregatorDuty::score(1, 2, testRoot(3)),
+            AggregatorDuty::score(1, 3, testRoot(3)));
+}
@@ -20,6 +20,8 @@
 #include "mock/storage/spaced_storage_mock.hpp"
 #include "qtils/error_throw.hpp"
 #include "sszpp/ssz++.hpp"
+#include "storage/in_memory/in_memory_spaced_storage.hpp"
+#include "storage/in_memory/in_memory_storage.hpp"
 #include "storage/storage_error.hpp"
 #include "testutil/literals.hpp"
 #include "testutil/prepare_loggers.hpp"
@@ -35,11 +37,16 @@ using lean::BlockHeader;
 using lean::decode;
 using lean::encode;
 using lean::app::ChainSpecMock;
+using lean::SignedBlock;
+using lean::blockchain::BackfillCursor;
 using lean::blockchain::BlockStorageError;
 using lean::blockchain::BlockStorageImpl;
 using lean::blockchain::BlockStorageInitializer;
 using lean::crypto::HasherMock;
+using lean::storage::BufferStorageCursor;
 using lean::storage::BufferStorageMock;
+using lean::storage::InMemoryStorage;
+using lean::storage::InMemorySpacedStorage;
 using lean::storage::Space;
 using lean::storage::SpacedStorageMock;
 using qtils::ByteVec;
@@ -48,6 +55,92 @@ using testing::_;
 using testing::Ref;
 using testing::Return;
 
+/// Batch writing into spaces of mock storage on commit
+class SpacesBatch : public lean::storage::SpacedBatch {
+ public:
+  explicit SpacesBatch(lean::storage::SpacedStorage &storage)
+      : storage_{storage} {}
+
+  outcome::result<void> put(Space space,
+                            const ByteView &key,
+                            qtils::ByteVecOrView &&value) override {
+    writes_.emplace_back(space, ByteVec{key}, std::move(value).intoByteVec());
+    return outcome::success();
+  }
+
+  outcome::result<void> remove(Space space, const ByteView &key) override {
+    writes_.emplace_back(space, ByteVec{key}, std::nullopt);
+    return outcome::success();
+  }
+
+  outcome::result<void> commit() override {
+    for (auto &[space, key, value] : writes_) {
+      auto storage = storage_.getSpace(space);
+      if (value.has_value()) {
+        OUTCOME_TRY(storage->put(key, ByteView{*value}));
+      } else {
+        OUTCOME_TRY(storage->remove(key));
+      }
+    }
+    return outcome::success();
+  }
+
+  void clear() override {
+    writes_.clear();
+  }
+
+ private:
+  lean::storage::SpacedStorage &storage_;
+  std::vector<std::tuple<Space, ByteVec, std::optional<ByteVec>>> writes_;
+};
+
+/// Cursor which calls `on_next` once, to write while storage is scanned
+class HookedCursor : public BufferStorageCursor {
+ public:
+  HookedCursor(std::unique_ptr<BufferStorageCursor> cursor,
+               std::function<void()> on_next)
+      : cursor_{std::move(cursor)}, on_next_{std::move(on_next)} {}
+
+  outcome::result<bool> seekFirst() override {
+    return cursor_->seekFirst();
+  }
+
+  outcome::result<bool> seek(const ByteView &key) override {
+    return cursor_->seek(key);
+  }
+
+  outcome::result<bool> seekLast() override {
+    return cursor_->seekLast();
+  }
+
+  bool isValid() const override {
+    return cursor_->isValid();
+  }
+
+  outcome::result<void> next() override {
+    if (auto on_next = std::exchange(on_next_, nullptr)) {
+      on_next();
+    }
+    return cursor_->next();
+  }
+
+  outcome::result<void> prev() override {
+    return cursor_->prev();
+  }
+
+  std::optional<ByteVec> key() const override {
+    return cursor_->key();
+  }
+
+  std::optional<qtils::ByteVecOrView> value() const override {
+    return cursor_->value();
+  }
+
+ private:
+  std::unique_ptr<BufferStorageCursor> cursor_;
+  std::function<void()> on_next_;
+};
+
 class BlockStorageTest : public testing::Test {
  public:
   static void SetUpTestCase() {
@@ -66,8 +159,10 @@ class BlockStorageTest : public testing::Test {
         Space::Header,
         Space::Body,
         Space::State,
+        Space::StateDiff,
         Space::Attestation,
         Space::Signature,
+        Space::Subtree,
     };
 
     for (auto space : required_spaces) {
@@ -80,6 +175,13 @@ class BlockStorageTest : public testing::Test {
           .WillRepeatedly(Return(outcome::success()));
       EXPECT_CALL(*storage, tryGetMock(_)).WillRepeatedly(Return(std::nullopt));
     }
+    ON_CALL(*spaced_storage, createBatch()).WillByDefault([this] {
+      return std::make_unique<SpacesBatch>(*spaced_storage);
+    });
+    // Filter of headers is built by scanning them
+    ON_CALL(*spaces[Space::Header], cursor()).WillByDefault([this] {
+      return stored_headers->cursor();
+    });
   }
 
   BlockHash regular_block_hash{"regular"_arr32};
@@ -101,6 +203,9 @@ class BlockStorageTest : public testing::Test {
   qtils::SharedRef<SpacedStorageMock> spaced_storage =
       std::make_shared<SpacedStorageMock>();
   std::map<Space, std::shared_ptr<BufferStorageMock>> spaces;
+  /// Headers seen by scan of header space
+  std::shared_ptr<InMemoryStorage> stored_headers =
+      std::make_shared<InMemoryStorage>();
 
   qtils::SharedRef<BlockStorageImpl> createWithGenesis() {
     // calculate hash of genesis block at put block header
@@ -108,8 +213,14 @@ class BlockStorageTest : public testing::Test {
     ON_CALL(*hasher, sha2_256(encoded_header.view()))
         .WillByDefault(Return(genesis_block_hash));
 
-    auto new_block_storage = std::make_shared<BlockStorageImpl>(
-        logsys, spaced_storage, hasher, nullptr);
+    auto new_block_storage = std::make_shared<BlockStorageImpl>(logsys,
+                                                                spaced_storage,
+                                                                hasher,
+                                                                nullptr,
+                                                                nullptr,
+                                                                nullptr,
+                                                                nullptr,
+                                                                nullptr);
 
     return new_block_storage;
   }
@@ -141,7 +252,8 @@ TEST_F(BlockStorageTest, CreateWithEmptyStorage) {
   EXPECT_CALL(*empty_storage, put(_, _))
       .WillRepeatedly(Return(outcome::success()));
 
-  ASSERT_NO_THROW(BlockStorageImpl x(logsys, spaced_storage, hasher, {}));
+  ASSERT_NO_THROW(BlockStorageImpl x(
+      logsys, spaced_storage, hasher, nullptr, nullptr, nullptr, {}));
 }
 
 /**
@@ -161,7 +273,8 @@ TEST_F(BlockStorageTest, CreateWithExistingGenesis) {
       logsys, spaced_storage, anchor_block, anchor_state, chain_spec, hasher));
 
   // Create block storage
-  ASSERT_NO_THROW(BlockStorageImpl(logsys, spaced_storage, hasher, {}));
+  ASSERT_NO_THROW(BlockStorageImpl(
+      logsys, spaced_storage, hasher, nullptr, nullptr, nullptr, {}));
 }
 
 /**
@@ -208,8 +321,15 @@ TEST_F(BlockStorageTest, PutBlock) {
  */
 TEST_F(BlockStorageTest, GetBlockNotFound) {
   std::shared_ptr<BlockStorageImpl> block_storage;
-  ASSERT_NO_THROW(block_storage = std::make_shared<BlockStorageImpl>(
-                      logsys, spaced_storage, hasher, nullptr));
+  ASSERT_NO_THROW(
+      block_storage = std::make_shared<BlockStorageImpl>(logsys,
+                                                         spaced_storage,
+                                                         hasher,
+                                                         nullptr,
+                                                         nullptr,
+                                                         nullptr,
+                                                         nullptr,
+                                                         nullptr));
 
   EXPECT_OUTCOME_ERROR(get_res,
                        block_storage->getBlockHeader(genesis_block_hash),
@@ -223,8 +343,15 @@ TEST_F(BlockStorageTest, GetBlockNotFound) {
  */
 TEST_F(BlockStorageTest, TryGetBlockNotFound) {
   std::shared_ptr<BlockStorageImpl> block_storage;
-  ASSERT_NO_THROW(block_storage = std::make_shared<BlockStorageImpl>(
-                      logsys, spaced_storage, hasher, nullptr));
+  ASSERT_NO_THROW(
+      block_storage = std::make_shared<BlockStorageImpl>(logsys,
+                                                         spaced_storage,
+                                                         hasher,
+                                                         nullptr,
+                                                         nullptr,
+                                                         nullptr,
+                                                         nullptr,
+                                                         nullptr));
 
   ASSERT_OUTCOME_SUCCESS(try_get_res,
                          block_storage->tryGetBlockHeader(genesis_block_hash));
@@ -298,6 +425,8 @@ TEST_F(BlockStorageTest, Remove) {
       .WillOnce(Return(outcome::success()));
   EXPECT_CALL(*spaces[Space::State], remove(ByteView{hash}))
       .WillOnce(Return(outcome::success()));
+  EXPECT_CALL(*spaces[Space::StateDiff], remove(ByteView{hash}))
+      .WillOnce(Return(outcome::success()));
   EXPECT_CALL(*spaces[Space::Signature], remove(ByteView{hash}))
       .WillOnce(Return(outcome::success()));
 
@@ -308,3 +437,107 @@ TEST_F(BlockStorageTest, Remove) {
 
   ASSERT_OUTCOME_SUCCESS(block_storage->removeBlock(hash));
 }
+
+/**
+ * @given block storage with backfill cursor
+ * @when backfilled blocks are stored with next cursor
+ * @then blocks are found by hash and slot, and cursor is moved, until it is
+ * removed when history is complete
+ */
+TEST_F(BlockStorageTest, PutBackfilledBlocks) {
+  auto storage = std::make_shared<InMemorySpacedStorage>();
+  auto block_storage = std::make_shared<BlockStorageImpl>(
+      logsys, storage, hasher, nullptr, nullptr, nullptr, nullptr, nullptr);
+
+  ASSERT_OUTCOME_SUCCESS(empty, block_storage->getBackfillCursor());
+  EXPECT_FALSE(empty.has_value());
+
+  // Descending, as fetched backwards from anchor
+  std::vector<SignedBlock> blocks(2);
+  blocks[1].block.slot = 3;
+  blocks[1].block.parent_root = "parent"_arr32;
+  blocks[1].block.setHash();
+  blocks[0].block.slot = 5;
+  blocks[0].block.parent_root = blocks[1].block.hash();
+  blocks[0].block.setHash();
+  BackfillCursor anchor{.hash = blocks[0].block.hash(), .before = 6};
+  ASSERT_OUTCOME_SUCCESS(block_storage->putBackfilledBlocks({}, anchor));
+  ASSERT_OUTCOME_SUCCESS(stored, block_storage->getBackfillCursor());
+  EXPECT_EQ(stored, anchor);
+
+  BackfillCursor next{.hash = "parent"_arr32, .before = 3};
+  ASSERT_OUTCOME_SUCCESS(block_storage->putBackfilledBlocks(blocks, next));
+  ASSERT_OUTCOME_SUCCESS(moved, block_storage->getBackfillCursor());
+  EXPECT_EQ(moved, next);
+
+  for (auto &signed_block : blocks) {
+    auto hash = signed_block.block.hash();
+    auto slot = signed_block.block.slot;
+    ASSERT_OUTCOME_SUCCESS(hashes, block_storage->getBlockHash(slot));
+    EXPECT_EQ(hashes, std::vector{hash});
+    ASSERT_OUTCOME_SUCCESS(found,
+                           block_storage->tryGetSignedBlocks({&hash, 1}));
+    ASSERT_TRUE(found[0].has_value());
+    EXPECT_EQ(found[0]->block.parent_root, signed_block.block.parent_root);
+  }
+
+  ASSERT_OUTCOME_SUCCESS(block_storage->putBackfilledBlocks({}, std::nullopt));
+  ASSERT_OUTCOME_SUCCESS(done, block_storage->getBackfillCursor());
+  EXPECT_FALSE(done.has_value());
+}
+
+/**
+ * @given block storage with stored header, and no filter of headers yet
+ * @when filter is built by lookup, and other header is put and looked up
+ * while stored headers are scanned
+ * @then lookups during scan are answered by database, and after scan both
+ * headers are found, while unknown header is rejected by filter alone
+ */
+TEST_F(BlockStorageTest, HeaderFilterRebuildWithConcurrentPut) {
+  auto &header_space = *spaces[Space::Header];
+  EXPECT_CALL(header_space, put(_, _))
+      .WillRepeatedly([this](const ByteView &key, const ByteVec &value) {
+        return stored_headers->put(key, ByteVec{value});
+      });
+  EXPECT_CALL(header_space, contains(_))
+      .WillRepeatedly([this](const ByteView &key) {
+        return stored_headers->contains(key);
+      });
+  // Without worker pool, filter is built inline by lookup
+  auto block_storage = std::make_shared<BlockStorageImpl>(logsys,
+                                                          spaced_storage,
+                                                          hasher,
+                                                          nullptr,
+                                                          nullptr,
+                                                          nullptr,
+                                                          nullptr,
+                                                          nullptr);
+
+  BlockHeader stored_header;
+  stored_header.slot = 1;
+  ASSERT_OUTCOME_SUCCESS(stored_hash,
+                         block_storage->putBlockHeader(stored_header));
+  BlockHeader put_header;
+  put_header.slot = 2;
+  std::optional<BlockHash> put_hash;
+  BlockHash unknown_hash{"unknown"_arr32};
+
+  EXPECT_CALL(header_space, cursor()).WillOnce([&] {
+    return std::make_unique<HookedCursor>(stored_headers->cursor(), [&] {
+      EXPECT_EQ(block_storage->hasBlockHeader(stored_hash).value(), true);
+      EXPECT_EQ(block_storage->hasBlockHeader(unknown_hash).value(), false);
+      put_hash = block_storage->putBlockHeader(put_header).value();
+    });
+  });
+  ASSERT_OUTCOME_SUCCESS(found_stored,
+                         block_storage->hasBlockHeader(stored_hash));
+  EXPECT_TRUE(found_stored);
+  ASSERT_TRUE(put_hash.has_value());
+  ASSERT_OUTCOME_SUCCESS(found_put, block_storage->hasBlockHeader(*put_hash));
+  EXPECT_TRUE(found_put);
+
+  EXPECT_CALL(header_space, contains(ByteView{unknown_hash})).Times(0);
+  ASSERT_OUTCOME_SUCCESS(found_unknown,
+                         block_storage->hasBlockHeader(unknown_hash));
+  EXPECT_FALSE(found_unknown);
+}
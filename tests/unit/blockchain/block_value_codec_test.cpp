@@ -0,0 +1,69 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/impl/block_value_codec.hpp"
+
+#include <gtest/gtest.h>
+#include <qtils/test/outcome.hpp>
+
+#include "blockchain/block_storage_error.hpp"
+
+using lean::blockchain::BlockStorageError;
+using lean::blockchain::BlockValueCodec;
+using qtils::ByteVec;
+
+/// Starts like SSZ container with first variable field at offset 4
+ByteVec sszLike(size_t size, uint8_t fill) {
+  ByteVec value(size, fill);
+  value[0] = 4;
+  value[1] = value[2] = value[3] = 0;
+  return value;
+}
+
+/**
+ * @given codec with compression enabled
+ * @when compressible value is encoded
+ * @then it is stored smaller and decoded back
+ */
+TEST(BlockValueCodecTest, Compressed) {
+  BlockValueCodec codec{true};
+  auto value = sszLike(1000, 7);
+  auto stored = codec.encode(value);
+  EXPECT_LT(stored.size(), value.size());
+
+  ByteVec buffer;
+  ASSERT_OUTCOME_SUCCESS(decoded, BlockValueCodec::decode(stored, buffer));
+  EXPECT_EQ(ByteVec(decoded.begin(), decoded.end()), value);
+}
+
+/**
+ * @given codec with compression disabled
+ * @when value is encoded
+ * @then it is stored as is, and decoded without copy
+ */
+TEST(BlockValueCodecTest, AsIs) {
+  BlockValueCodec codec{false};
+  auto value = sszLike(1000, 7);
+  auto stored = codec.encode(value);
+  EXPECT_EQ(stored, value);
+
+  ByteVec buffer;
+  ASSERT_OUTCOME_SUCCESS(decoded, BlockValueCodec::decode(stored, buffer));
+  EXPECT_EQ(decoded.data(), stored.data());
+  EXPECT_TRUE(buffer.empty());
+}
+
+/**
+ * @given compressed value with broken payload
+ * @when it is decoded
+ * @then error is returned
+ */
+TEST(BlockValueCodecTest, Corrupted) {
+  ByteVec stored{0, 0, 0, 0, 0xff, 0xff, 0xff, 0xff, 0xff};
+  ByteVec buffer;
+  ASSERT_OUTCOME_ERROR(BlockValueCodec::decode(stored, buffer),
+                       BlockStorageError::INCONSISTENT_DATA);
+}
@@ -0,0 +1,181 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/impl/cached_tree.hpp"
+
+#include <gtest/gtest.h>
+
+using lean::BlockHash;
+using lean::BlockIndex;
+using lean::blockchain::CachedTree;
+using lean::blockchain::TreeNodeId;
+
+BlockHash testHash(uint8_t i) {
+  BlockHash hash;
+  hash[0] = i;
+  return hash;
+}
+
+BlockIndex testBlock(uint8_t i, lean::Slot slot) {
+  return {.slot = slot, .hash = testHash(i)};
+}
+
+void addBlock(CachedTree &tree, uint8_t i, lean::Slot slot, uint8_t parent) {
+  auto parent_id = tree.find(testHash(parent));
+  ASSERT_TRUE(parent_id.has_value());
+  tree.add(testBlock(i, slot), {}, parent_id.value());
+}
+
+TreeNodeId findBlock(const CachedTree &tree, uint8_t i) {
+  return tree.find(testHash(i)).value();
+}
+
+/**
+ *       1 - 2 - 4
+ *      /
+ *     0
+ *      \
+ *       3
+ */
+CachedTree makeTree() {
+  CachedTree tree{testBlock(0, 0)};
+  addBlock(tree, 1, 1, 0);
+  addBlock(tree, 2, 2, 1);
+  addBlock(tree, 3, 2, 0);
+  addBlock(tree, 4, 3, 2);
+  return tree;
+}
+
+TEST(CachedTreeTest, Add) {
+  auto tree = makeTree();
+  EXPECT_EQ(tree.best(), testBlock(4, 3));
+  EXPECT_EQ(tree.leafCount(), 2);
+  EXPECT_TRUE(tree.isLeaf(testHash(3)));
+  EXPECT_TRUE(tree.isLeaf(testHash(4)));
+
+  auto &root = tree.node(findBlock(tree, 0));
+  ASSERT_EQ(root.children.size(), 2);
+  EXPECT_EQ(tree.node(root.children[0]).index, testBlock(1, 1));
+  EXPECT_EQ(tree.node(root.children[1]).index, testBlock(3, 2));
+  EXPECT_EQ(tree.node(findBlock(tree, 4)).depth, 3);
+  EXPECT_EQ(tree.parent(findBlock(tree, 4)), findBlock(tree, 2));
+  EXPECT_FALSE(tree.parent(findBlock(tree, 0)).has_value());
+}
+
+TEST(CachedTreeTest, ReorgAndDescend) {
+  auto tree = makeTree();
+  auto reorg = tree.reorg(findBlock(tree, 4), findBlock(tree, 3));
+  EXPECT_EQ(reorg.common, testBlock(0, 0));
+  EXPECT_EQ(reorg.revert,
+            (std::vector{testBlock(4, 3), testBlock(2, 2), testBlock(1, 1)}));
+  EXPECT_EQ(reorg.apply, std::vector{testBlock(3, 2)});
+
+  EXPECT_TRUE(tree.canDescend(findBlock(tree, 4), findBlock(tree, 1)));
+  EXPECT_FALSE(tree.canDescend(findBlock(tree, 4), findBlock(tree, 3)));
+  EXPECT_EQ(tree.bestWith(findBlock(tree, 3)), testBlock(3, 2));
+}
+
+/**
+ * Finalization prunes other branches and renumbers remaining nodes.
+ */
+TEST(CachedTreeTest, FinalizeCompacts) {
+  auto tree = makeTree();
+  auto changes = tree.finalize(findBlock(tree, 1));
+  EXPECT_FALSE(changes.reorg.has_value());
+  EXPECT_EQ(changes.prune, std::vector{testBlock(3, 2)});
+
+  EXPECT_EQ(tree.finalized(), testBlock(1, 1));
+  EXPECT_EQ(tree.best(), testBlock(4, 3));
+  EXPECT_FALSE(tree.find(testHash(0)).has_value());
+  EXPECT_FALSE(tree.find(testHash(3)).has_value());
+  EXPECT_EQ(findBlock(tree, 1), 0);
+  EXPECT_EQ(findBlock(tree, 2), 1);
+  EXPECT_EQ(findBlock(tree, 4), 2);
+  EXPECT_EQ(tree.parent(findBlock(tree, 4)), findBlock(tree, 2));
+  EXPECT_EQ(tree.leafHashes(), std::vector{testHash(4)});
+
+  addBlock(tree, 5, 4, 4);
+  EXPECT_EQ(tree.best(), testBlock(5, 4));
+}
+
+/**
+ * Finalizing other branch reverts best chain.
+ */
+TEST(CachedTreeTest, FinalizeReorg) {
+  auto tree = makeTree();
+  auto changes = tree.finalize(findBlock(tree, 3));
+  ASSERT_TRUE(changes.reorg.has_value());
+  EXPECT_EQ(changes.reorg->common, testBlock(0, 0));
+  EXPECT_EQ(changes.reorg->apply, std::vector{testBlock(3, 2)});
+  EXPECT_EQ(changes.prune,
+            (std::vector{testBlock(4, 3), testBlock(2, 2), testBlock(1, 1)}));
+  EXPECT_EQ(tree.best(), testBlock(3, 2));
+  EXPECT_EQ(tree.leafCount(), 1);
+}
+
+/**
+ * Removed leaf slot is reused by next added block.
+ */
+TEST(CachedTreeTest, RemoveLeaf) {
+  auto tree = makeTree();
+  auto removed = findBlock(tree, 4);
+  auto changes = tree.removeLeaf(testHash(4));
+  EXPECT_EQ(changes.prune, std::vector{testBlock(4, 3)});
+  ASSERT_TRUE(changes.reorg.has_value());
+  EXPECT_EQ(changes.reorg->revert.front(), testBlock(4, 3));
+  EXPECT_TRUE(tree.isLeaf(testHash(2)));
+  EXPECT_FALSE(tree.find(testHash(4)).has_value());
+
+  addBlock(tree, 5, 3, 3);
+  EXPECT_EQ(findBlock(tree, 5), removed);
+  EXPECT_EQ(tree.best(), testBlock(5, 3));
+}
+
+/**
+ * Jump pointers find ancestors by slot and depth, and common ancestor,
+ * on long chain with fork, also after compaction.
+ *
+ *     0 - 1 - ... - 50 - ... - 100
+ *                    \
+ *                     101 - ... - 130
+ */
+TEST(CachedTreeTest, JumpAncestors) {
+  CachedTree tree{testBlock(0, 0)};
+  for (uint8_t i = 1; i <= 100; ++i) {
+    addBlock(tree, i, i * 2, i - 1);
+  }
+  addBlock(tree, 101, 101, 50);
+  for (uint8_t i = 102; i <= 130; ++i) {
+    addBlock(tree, i, i, i - 1);
+  }
+
+  auto ancestor_at_slot = [&](uint8_t i, lean::Slot slot) {
+    return tree.node(tree.ancestorAtSlot(findBlock(tree, i), slot).value())
+        .index;
+  };
+  EXPECT_EQ(ancestor_at_slot(100, 200), testBlock(100, 200));
+  EXPECT_EQ(ancestor_at_slot(100, 77), testBlock(38, 76));
+  EXPECT_EQ(ancestor_at_slot(100, 0), testBlock(0, 0));
+  EXPECT_EQ(ancestor_at_slot(130, 100), testBlock(50, 100));
+  EXPECT_EQ(ancestor_at_slot(130, 120), testBlock(120, 120));
+
+  EXPECT_EQ(tree.ancestorAtDepth(findBlock(tree, 130), 51),
+            findBlock(tree, 101));
+  EXPECT_EQ(tree.commonAncestor(findBlock(tree, 100), findBlock(tree, 130)),
+            findBlock(tree, 50));
+  EXPECT_EQ(tree.commonAncestor(findBlock(tree, 77), findBlock(tree, 33)),
+            findBlock(tree, 33));
+  EXPECT_TRUE(tree.canDescend(findBlock(tree, 130), findBlock(tree, 7)));
+  EXPECT_FALSE(tree.canDescend(findBlock(tree, 130), findBlock(tree, 51)));
+  EXPECT_FALSE(tree.canDescend(findBlock(tree, 7), findBlock(tree, 130)));
+
+  tree.finalize(findBlock(tree, 40));
+  EXPECT_FALSE(tree.ancestorAtSlot(findBlock(tree, 130), 79).has_value());
+  EXPECT_EQ(ancestor_at_slot(130, 80), testBlock(40, 80));
+  EXPECT_EQ(ancestor_at_slot(99, 150), testBlock(75, 150));
+  EXPECT_EQ(tree.commonAncestor(findBlock(tree, 99), findBlock(tree, 125)),
+            findBlock(tree, 50));
+}
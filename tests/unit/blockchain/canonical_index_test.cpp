@@ -0,0 +1,99 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/impl/canonical_index.hpp"
+
+#include <gtest/gtest.h>
+
+using lean::BlockHash;
+using lean::BlockIndex;
+using lean::blockchain::CachedTree;
+using lean::blockchain::CanonicalIndex;
+
+BlockIndex testBlock(uint8_t i, lean::Slot slot) {
+  BlockHash hash;
+  hash[0] = i;
+  return {.slot = slot, .hash = hash};
+}
+
+/// Add block to tree and apply its reorg to index, as block tree does
+void addBlock(CachedTree &tree,
+              CanonicalIndex &index,
+              const BlockIndex &block,
+              const BlockIndex &parent) {
+  auto reorg = tree.add(block, {}, tree.find(parent.hash).value());
+  if (reorg.has_value()) {
+    index.reorg(reorg->revert, reorg->apply);
+  }
+}
+
+/**
+ *     0 - 1 - _ - 3
+ *      \
+ *       - 2' - 4'
+ * @given index of best chain, with empty slot
+ * @when heavier fork is added
+ * @then reverted slots are unassigned, applied are assigned
+ */
+TEST(CanonicalIndexTest, Reorg) {
+  auto b0 = testBlock(0, 0);
+  auto b1 = testBlock(1, 1);
+  auto b3 = testBlock(3, 3);
+  auto b2 = testBlock(2, 2);
+  auto b4 = testBlock(4, 4);
+  CachedTree tree{b0};
+  CanonicalIndex index{b0};
+  addBlock(tree, index, b1, b0);
+  addBlock(tree, index, b3, b1);
+  EXPECT_EQ(index.get(1), b1.hash);
+  EXPECT_FALSE(index.get(2).has_value());
+  EXPECT_EQ(index.get(3), b3.hash);
+  EXPECT_EQ(index.last(), b3);
+
+  addBlock(tree, index, b2, b0);
+  EXPECT_EQ(index.last(), b3);
+  addBlock(tree, index, b4, b2);
+  EXPECT_EQ(index.get(0), b0.hash);
+  EXPECT_FALSE(index.get(1).has_value());
+  EXPECT_EQ(index.get(2), b2.hash);
+  EXPECT_FALSE(index.get(3).has_value());
+  EXPECT_EQ(index.get(4), b4.hash);
+  EXPECT_EQ(index.last(), tree.best());
+  EXPECT_FALSE(index.covers(5));
+}
+
+/**
+ * @given index of best chain
+ * @when block is finalized, and index is rebuilt from tree
+ * @then slots before finalized are dropped, rebuilt index is same
+ */
+TEST(CanonicalIndexTest, FinalizeAndRebuild) {
+  auto b0 = testBlock(0, 0);
+  auto b1 = testBlock(1, 1);
+  auto b2 = testBlock(2, 2);
+  auto b4 = testBlock(4, 4);
+  CachedTree tree{b0};
+  CanonicalIndex index{b0};
+  addBlock(tree, index, b1, b0);
+  addBlock(tree, index, b2, b1);
+  addBlock(tree, index, b4, b2);
+
+  auto changes = tree.finalize(tree.find(b2.hash).value());
+  EXPECT_FALSE(changes.reorg.has_value());
+  index.finalize(tree.finalized());
+  EXPECT_EQ(index.firstSlot(), 2);
+  EXPECT_FALSE(index.covers(1));
+  EXPECT_EQ(index.get(2), b2.hash);
+  EXPECT_EQ(index.get(4), b4.hash);
+
+  CanonicalIndex rebuilt{b0};
+  rebuilt.rebuild(tree);
+  EXPECT_EQ(rebuilt.firstSlot(), 2);
+  for (lean::Slot slot = 2; slot <= 4; ++slot) {
+    EXPECT_EQ(rebuilt.get(slot), index.get(slot));
+  }
+  EXPECT_EQ(rebuilt.last(), b4);
+}
@@ -0,0 +1,98 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/chain_record.hpp"
+
+#include <fstream>
+
+#include <gtest/gtest.h>
+#include <qtils/test/outcome.hpp>
+
+#include "testutil/storage/base_fs_test.hpp"
+
+using lean::ChainRecordError;
+using lean::ChainRecordKind;
+using lean::ChainRecordReader;
+using lean::ChainRecordWriter;
+using std::chrono_literals::operator""ms;
+
+struct ChainRecordTest : public test::BaseFS_Test {
+  ChainRecordTest() : test::BaseFS_Test("/tmp/lean-test-chain-record") {}
+
+  fs::path path() const {
+    return base_path / "chain.rec";
+  }
+};
+
+/**
+ * @given file with anchor, block and tick records
+ * @when file is read
+ * @then same records are read in same order, then end of file
+ */
+TEST_F(ChainRecordTest, RoundTrip) {
+  qtils::ByteVec state{1, 2, 3};
+  qtils::ByteVec block{4, 5};
+  {
+    ASSERT_OUTCOME_SUCCESS(writer, ChainRecordWriter::create(path()));
+    ASSERT_OUTCOME_SUCCESS(
+        writer.write(ChainRecordKind::ANCHOR_STATE, 10ms, state));
+    ASSERT_OUTCOME_SUCCESS(writer.write(ChainRecordKind::BLOCK, 20ms, block));
+    ASSERT_OUTCOME_SUCCESS(writer.write(ChainRecordKind::TICK, 30ms, {}));
+  }
+
+  ASSERT_OUTCOME_SUCCESS(anchor, lean::readChainRecordingAnchor(path()));
+  EXPECT_EQ(anchor.time, 10ms);
+  EXPECT_EQ(anchor.payload, state);
+
+  ASSERT_OUTCOME_SUCCESS(reader, ChainRecordReader::open(path()));
+  ASSERT_OUTCOME_SUCCESS(record1, reader.next());
+  ASSERT_TRUE(record1.has_value());
+  EXPECT_EQ(record1->kind, ChainRecordKind::ANCHOR_STATE);
+  ASSERT_OUTCOME_SUCCESS(record2, reader.next());
+  ASSERT_TRUE(record2.has_value());
+  EXPECT_EQ(record2->kind, ChainRecordKind::BLOCK);
+  EXPECT_EQ(record2->time, 20ms);
+  EXPECT_EQ(record2->payload, block);
+  ASSERT_OUTCOME_SUCCESS(record3, reader.next());
+  ASSERT_TRUE(record3.has_value());
+  EXPECT_EQ(record3->kind, ChainRecordKind::TICK);
+  EXPECT_EQ(record3->time, 30ms);
+  EXPECT_TRUE(record3->payload.empty());
+  ASSERT_OUTCOME_SUCCESS(end, reader.next());
+  EXPECT_FALSE(end.has_value());
+}
+
+/**
+ * @given file with record cut in the middle of payload, as after crash
+ * @when file is read
+ * @then complete records are read, then truncated error
+ */
+TEST_F(ChainRecordTest, Truncated) {
+  {
+    ASSERT_OUTCOME_SUCCESS(writer, ChainRecordWriter::create(path()));
+    ASSERT_OUTCOME_SUCCESS(
+        writer.write(ChainRecordKind::ANCHOR_STATE, 10ms, qtils::ByteVec{1}));
+    ASSERT_OUTCOME_SUCCESS(
+        writer.write(ChainRecordKind::BLOCK, 20ms, qtils::ByteVec(100)));
+  }
+  fs::resize_file(path(), fs::file_size(path()) - 1);
+
+  ASSERT_OUTCOME_SUCCESS(reader, ChainRecordReader::open(path()));
+  ASSERT_OUTCOME_SUCCESS(record, reader.next());
+  ASSERT_TRUE(record.has_value());
+  EXPECT_OUTCOME_ERROR(reader.next(), ChainRecordError::TRUNCATED);
+}
+
+/**
+ * @given file which is not chain recording
+ * @when file is opened
+ * @then bad header error
+ */
+TEST_F(ChainRecordTest, BadHeader) {
+  std::ofstream{path()} << "not a recording";
+  EXPECT_OUTCOME_ERROR(ChainRecordReader::open(path()),
+                       ChainRecordError::BAD_HEADER);
+}
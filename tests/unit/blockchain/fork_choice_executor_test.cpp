@@ -0,0 +1,94 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/fork_choice_executor.hpp"
+
+#include <latch>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "mock/metrics_mock.hpp"
+
+using lean::ForkChoiceExecutor;
+using lean::LockProfiler;
+using lean::LockSite;
+using lean::LockSiteScope;
+using Priority = lean::ForkChoiceExecutor::Priority;
+using std::chrono_literals::operator""ms;
+
+struct ForkChoiceExecutorTest : testing::Test {
+  std::shared_ptr<lean::metrics::MetricsMock> metrics =
+      std::make_shared<lean::metrics::MetricsMock>();
+  LockProfiler profiler{metrics};
+  ForkChoiceExecutor executor{profiler.lock("test"), *metrics, 16};
+};
+
+/**
+ * @given executor
+ * @when commands are run, nested and throwing
+ * @then they run on owner thread, results and exceptions reach caller
+ */
+TEST_F(ForkChoiceExecutorTest, Run) {
+  EXPECT_FALSE(executor.isOwnerThread());
+  auto result = executor.run(Priority::BLOCK, [&] {
+    EXPECT_TRUE(executor.isOwnerThread());
+    return executor.run(Priority::QUERY, [] { return 1; }) + 1;
+  });
+  EXPECT_EQ(result, 2);
+  EXPECT_THROW(executor.run(Priority::TICK,
+                            [] { throw std::runtime_error{"command"}; }),
+               std::runtime_error);
+}
+
+/**
+ * @given owner thread busy with command
+ * @when commands of different priorities are queued meanwhile
+ * @then higher priority ones run first, wait is attributed to caller site
+ */
+TEST_F(ForkChoiceExecutorTest, Priority) {
+  std::latch started{1};
+  std::latch release{1};
+  std::thread busy{[&] {
+    executor.run(Priority::QUERY, [&] {
+      started.count_down();
+      release.wait();
+    });
+  }};
+  started.wait();
+
+  std::vector<Priority> order;
+  std::vector<std::thread> callers;
+  for (auto priority : {Priority::QUERY,
+                        Priority::BACKGROUND,
+                        Priority::GOSSIP,
+                        Priority::TICK}) {
+    callers.emplace_back([&, priority] {
+      LockSiteScope site{LockSite::ON_TICK};
+      executor.run(priority, [&] { order.emplace_back(priority); });
+    });
+    // Each caller is queued before next one
+    std::this_thread::sleep_for(10ms);
+  }
+  release.count_down();
+  for (auto &caller : callers) {
+    caller.join();
+  }
+  busy.join();
+  EXPECT_EQ(order,
+            (std::vector{Priority::TICK,
+                         Priority::GOSSIP,
+                         Priority::BACKGROUND,
+                         Priority::QUERY}));
+
+  auto contenders = profiler.topContenders(1);
+  ASSERT_EQ(contenders.size(), 1);
+  EXPECT_EQ(contenders[0].site, "onTick");
+  EXPECT_EQ(contenders[0].contended, 4);
+  EXPECT_GT(contenders[0].wait_us, 0);
+}
@@ -9,8 +9,13 @@
 #include <gtest/gtest.h>
 
 #include <format>
+#include <set>
+
+#include <qtils/cxx23/ranges/contains.hpp>
 
 #include "blockchain/block_tree.hpp"
+#include "blockchain/impl/anchor_block_impl.hpp"
+#include "blockchain/impl/anchor_state_impl.hpp"
 #include "blockchain/is_justifiable_slot.hpp"
 #include "blockchain/state_transition_function.hpp"
 #include "mock/app/validator_keys_manifest_mock.hpp"
@@ -61,11 +66,11 @@ Attestation makeAttestation(const Block &source, const Block &target) {
 
 std::optional<Checkpoint> getAttestation(
     const ForkChoiceStore::AttestationDataByValidator &votes) {
-  auto it = votes.find(0);
-  if (it == votes.end()) {
+  auto vote = votes.find(0);
+  if (vote == nullptr) {
     return std::nullopt;
   }
-  return it->second.target;
+  return vote->target;
 }
 
 auto getAttestationTarget(const ForkChoiceStore &store) {
@@ -88,12 +93,19 @@ auto createTestStore(
     std::unordered_map<BlockHash, State> states = {},
     ForkChoiceStore::AttestationDataByValidator latest_known_attestations = {},
     ForkChoiceStore::AttestationDataByValidator latest_new_attestations = {},
-    ValidatorIndex validator_index = 0) {
+    ValidatorIndex validator_index = 0,
+    std::shared_ptr<lean::crypto::xmss::XmssProviderMock> xmss_provider =
+        std::make_shared<lean::crypto::xmss::XmssProviderMock>()) {
   auto validator_registry = std::make_shared<lean::ValidatorRegistryMock>();
   static lean::ValidatorRegistry::ValidatorIndices validators{0};
   EXPECT_CALL(*validator_registry, currentValidatorIndices())
       .Times(testing::AnyNumber())
       .WillRepeatedly(testing::ReturnRef(validators));
+  EXPECT_CALL(*validator_registry, isCurrentValidator(testing::_))
+      .Times(testing::AnyNumber())
+      .WillRepeatedly([&](lean::ValidatorIndex index) {
+        return qtils::cxx23::ranges::contains(validators, index);
+      });
   EXPECT_CALL(*validator_registry, allValidatorsIndices())
       .Times(testing::AnyNumber())
       .WillRepeatedly(testing::Return(validators));
@@ -105,7 +117,6 @@ auto createTestStore(
       .WillRepeatedly(testing::Return(std::nullopt));
   auto validator_keys_manifest =
       std::make_shared<lean::app::ValidatorKeysManifestMock>();
-  auto xmss_provider = std::make_shared<lean::crypto::xmss::XmssProviderMock>();
   auto block_tree = std::make_shared<lean::blockchain::BlockTreeMock>();
   auto block_storage = std::make_shared<lean::blockchain::BlockStorageMock>();
 
@@ -127,6 +138,20 @@ auto createTestStore(
         }
         return std::nullopt;
       });
+  ON_CALL(*block_tree, forEachNonFinalizedAncestor(testing::_, testing::_))
+      .WillByDefault([blocks](const BlockHash &hash, const auto &visit) {
+        for (auto it = blocks.find(hash); it != blocks.end();
+             it = blocks.find(it->second.block.parent_root)) {
+          auto &block = it->second.block;
+          if (not visit({
+                  .index = {block.slot, it->first},
+                  .parent_root = block.parent_root,
+                  .state_root = block.state_root,
+              })) {
+            break;
+          }
+        }
+      });
   ON_CALL(*block_tree, getChildren(testing::_))
       .WillByDefault([blocks](const auto &hash)
                          -> outcome::result<std::vector<BlockHash>> {
@@ -197,7 +222,7 @@ std::vector<Block> makeBlocks(Slot count) {
 auto makeStateWithSingleValidator(const Config &cfg) {
   State state;
   state.config = cfg;
-  state.validators.push_back(lean::Validator{});
+  state.validators.mut().push_back(lean::Validator{});
   state.latest_justified = state.latest_finalized = Checkpoint{};
   return state;
 }
@@ -345,12 +370,12 @@ TEST(TestForkChoiceHeadFunction, test_get_fork_choice_head_with_votes) {
   auto &target = blocks.at(2);
 
   ForkChoiceStore::AttestationDataByValidator attestations;
-  attestations[0] = {
+  attestations.insert_or_assign(0, {
       .slot = target.slot,
       .head = Checkpoint::from(target),
       .target = Checkpoint::from(target),
       .source = Checkpoint::from(root),
-  };
+  });
 
   auto store = createTestStore(kDefaultTime,
                                config,
@@ -397,12 +422,12 @@ TEST(TestForkChoiceHeadFunction, test_get_fork_choice_head_with_min_score) {
   auto &target = blocks.at(2);
 
   ForkChoiceStore::AttestationDataByValidator attestations;
-  attestations[0] = {
+  attestations.insert_or_assign(0, {
       .slot = target.slot,
       .head = Checkpoint::from(target),
       .target = Checkpoint::from(target),
       .source = Checkpoint::from(root),
-  };
+  });
 
   auto store = createTestStore(kDefaultTime,
                                config,
@@ -425,12 +450,12 @@ TEST(TestForkChoiceHeadFunction, test_get_fork_choice_head_multiple_votes) {
 
   ForkChoiceStore::AttestationDataByValidator attestations;
   for (int i = 0; i < 3; ++i) {
-    attestations[i] = {
+    attestations.insert_or_assign(i, {
         .slot = target.slot,
         .head = Checkpoint::from(target),
         .target = Checkpoint::from(target),
         .source = Checkpoint::from(root),
-    };
+    });
   }
 
   auto store = createTestStore(kDefaultTime,
@@ -713,3 +738,253 @@ TEST(TestHeadSelection, test_produce_block_basic) {
   ASSERT_OUTCOME_ERROR(sample_store.produceBlockWithSignatures(1, 1),
                        ForkChoiceStore::Error::STATE_NOT_FOUND);
 }
+
+// Test that known leading blocks of segment are skipped.
+TEST(TestSegmentImport, test_known_segment_is_skipped) {
+  auto blocks = makeBlocks(3);
+  auto store = createTestStore(kDefaultTime,
+                               config,
+                               blocks.at(2).index(),
+                               blocks.at(0).index(),
+                               {},
+                               makeBlockMap(blocks));
+
+  ASSERT_OUTCOME_SUCCESS(
+      block_imports,
+      store.beginSegmentImport({
+          SignedBlock{.block = blocks.at(1)},
+          SignedBlock{.block = blocks.at(2)},
+      }));
+  EXPECT_TRUE(block_imports.empty());
+}
+
+// Test that segment with block not child of previous one is rejected.
+TEST(TestSegmentImport, test_segment_not_chained) {
+  auto blocks = makeBlocks(3);
+  auto store = createTestStore(kDefaultTime,
+                               config,
+                               blocks.at(2).index(),
+                               blocks.at(0).index(),
+                               {},
+                               makeBlockMap(blocks));
+
+  ASSERT_OUTCOME_ERROR(store.beginSegmentImport({
+                           SignedBlock{.block = blocks.at(0)},
+                           SignedBlock{.block = blocks.at(2)},
+                       }),
+                       ForkChoiceStore::Error::SEGMENT_NOT_CHAINED);
+}
+
+// Test that block of proposer out of turn is rejected before signatures.
+TEST(TestBlockProposer, test_proposer_out_of_turn) {
+  auto store = createTestStore({.interval = 0}, config);
+  auto state = makeStateWithSingleValidator(config);
+  state.validators.mut().push_back(lean::Validator{});
+  SignedBlock signed_block;
+  signed_block.block.slot = 1;
+  signed_block.block.proposer_index = 0;
+
+  ASSERT_OUTCOME_ERROR(store.validateBlockProposer(signed_block, state),
+                       ForkChoiceStore::Error::INVALID_PROPOSER);
+}
+
+// Test that aggregation with invalid proof is rejected, so it is not marked
+// seen by gossip filter.
+TEST(TestAggregatedAttestation, test_invalid_gossip_aggregation) {
+  auto blocks = makeBlocks(3);
+  auto &source = blocks.at(1);
+  auto &target = blocks.at(2);
+  auto store =
+      createTestStore(kDefaultTime,
+                      config,
+                      {},
+                      {},
+                      {},
+                      makeBlockMap(blocks),
+                      {{target.hash(), makeStateWithSingleValidator(config)}});
+  lean::SignedAggregatedAttestation signed_aggregated_attestation{
+      .data = makeAttestation(source, target).data,
+  };
+  signed_aggregated_attestation.proof.participants.add(0);
+
+  // Verification by xmss mock fails
+  ASSERT_OUTCOME_ERROR(
+      store.onGossipAggregatedAttestation(signed_aggregated_attestation),
+      ForkChoiceStore::Error::INVALID_ATTESTATION);
+}
+
+// Test that successfully verified proof is cached, so it is verified once,
+// and that failed and other proofs are verified again.
+TEST(TestAggregatedAttestation, test_verified_proof_cache) {
+  auto xmss_provider = std::make_shared<lean::crypto::xmss::XmssProviderMock>();
+  auto store = createTestStore(
+      kDefaultTime, config, {}, {}, {}, {}, {}, {}, {}, 0, xmss_provider);
+  auto state = makeStateWithSingleValidator(config);
+  auto blocks = makeBlocks(3);
+  lean::SignedAggregatedAttestation aggregation{
+      .data = makeAttestation(blocks.at(1), blocks.at(2)).data,
+  };
+  aggregation.proof.participants.add(0);
+  aggregation.proof.proof_data = qtils::ByteVec{1};
+  auto other = aggregation;
+  other.proof.proof_data = qtils::ByteVec{2};
+
+  EXPECT_CALL(*xmss_provider,
+              verifyAggregatedSignatures(
+                  testing::_, testing::_, testing::_, testing::_))
+      .WillOnce(testing::Return(false))
+      .WillOnce(testing::Return(true))
+      .WillOnce(testing::Return(false));
+  // Miss, failed verification is not cached
+  EXPECT_FALSE(store.verifyGossipAggregatedAttestation(state, aggregation));
+  // Miss, verified
+  EXPECT_TRUE(store.verifyGossipAggregatedAttestation(state, aggregation));
+  // Hit, not verified again
+  EXPECT_TRUE(store.verifyGossipAggregatedAttestation(state, aggregation));
+  // Miss, other proof bytes
+  EXPECT_FALSE(store.verifyGossipAggregatedAttestation(state, other));
+}
+
+/// Store with parent state for proposal, and blocks to attest
+struct ProposalSetup {
+  ForkChoiceStore store;
+  BlockHash parent_root;
+  Checkpoint source;
+  std::vector<Block> heads;
+};
+
+ProposalSetup makeProposalSetup(
+    size_t validator_count,
+    Slot head_count,
+    std::shared_ptr<lean::crypto::xmss::XmssProviderMock> xmss_provider) {
+  auto blocks = makeBlocks(head_count + 1);
+  std::vector<lean::Validator> validators;
+  validators.resize(validator_count);
+  auto state = lean::STF::generateGenesisState(config, validators);
+  // Votes have source from block tree, not zero hash of genesis state
+  auto source = Checkpoint::from(blocks.at(0));
+  state.latest_justified = source;
+  auto parent = lean::blockchain::AnchorBlockImpl{
+      lean::blockchain::AnchorStateImpl{state}};
+  auto block_map = makeBlockMap(blocks);
+  blocks.erase(blocks.begin());
+  return {
+      .store = createTestStore(kDefaultTime,
+                               config,
+                               {},
+                               {},
+                               {},
+                               std::move(block_map),
+                               {{parent.hash(), state}},
+                               {},
+                               {},
+                               0,
+                               xmss_provider),
+      .parent_root = parent.hash(),
+      .source = source,
+      .heads = std::move(blocks),
+  };
+}
+
+lean::SignedAggregatedAttestation makeAggregation(
+    const Checkpoint &source,
+    const Block &head,
+    std::initializer_list<ValidatorIndex> participants,
+    uint8_t proof_tag) {
+  lean::SignedAggregatedAttestation aggregation{
+      .data =
+          {
+              .slot = head.slot,
+              .head = Checkpoint::from(head),
+              .target = source,
+              .source = source,
+          },
+  };
+  for (auto validator_index : participants) {
+    aggregation.proof.participants.add(validator_index);
+  }
+  aggregation.proof.proof_data = qtils::ByteVec{proof_tag};
+  return aggregation;
+}
+
+// Test that proofs are picked by greedy coverage gain, skipping proof which
+// adds no validators after others are picked, and merged into one.
+TEST(TestProposalAttestations, test_greedy_proof_selection) {
+  auto xmss_provider = std::make_shared<lean::crypto::xmss::XmssProviderMock>();
+  auto setup = makeProposalSetup(8, 1, xmss_provider);
+  auto &head = setup.heads.at(0);
+  // Each proof adds validators when stored, so all are kept
+  for (auto &aggregation : {
+           makeAggregation(setup.source, head, {2, 3}, 1),
+           makeAggregation(setup.source, head, {0, 1, 2}, 2),
+           makeAggregation(setup.source, head, {3, 4, 5}, 3),
+       }) {
+    ASSERT_OUTCOME_SUCCESS(setup.store.onAggregatedAttestation(aggregation,
+                                                               true));
+  }
+
+  EXPECT_CALL(*xmss_provider,
+              aggregateSignatures(testing::_,
+                                  testing::_,
+                                  testing::_,
+                                  testing::_,
+                                  testing::_,
+                                  testing::_))
+      .WillOnce(testing::WithArg<1>(
+          [](std::span<const lean::crypto::xmss::XmssAggregatedSignature>
+                 child_proofs) {
+            // Largest gain first, first proof adds nothing after them
+            EXPECT_EQ(child_proofs.size(), 2);
+            EXPECT_EQ(child_proofs[0], qtils::ByteVec{2});
+            EXPECT_EQ(child_proofs[1], qtils::ByteVec{3});
+            return qtils::ByteVec{4};
+          }));
+  Slot slot = 2;
+  ASSERT_OUTCOME_SUCCESS(
+      proposal,
+      setup.store.getProposalAttestations(
+          slot, slot % 8, setup.parent_root));
+  auto &[attestations, proofs] = proposal;
+  ASSERT_EQ(attestations.size(), 1);
+  ASSERT_EQ(proofs.size(), 1);
+  auto &participants = attestations.data().at(0).aggregation_bits;
+  EXPECT_EQ(participants.count(), 6);
+  for (ValidatorIndex i = 0; i < 6; ++i) {
+    EXPECT_TRUE(participants.contains(i));
+  }
+  EXPECT_EQ(proofs.data().at(0).participants, participants);
+}
+
+// Test that block gets at most MAX_ATTESTATIONS_DATA aggregated attestations,
+// even if more attestation data have proofs.
+TEST(TestProposalAttestations, test_proposal_attestations_limit) {
+  constexpr size_t kDataCount = lean::MAX_ATTESTATIONS_DATA + 2;
+  auto setup = makeProposalSetup(
+      kDataCount,
+      kDataCount,
+      std::make_shared<lean::crypto::xmss::XmssProviderMock>());
+  for (ValidatorIndex i = 0; i < kDataCount; ++i) {
+    ASSERT_OUTCOME_SUCCESS(setup.store.onAggregatedAttestation(
+        makeAggregation(
+            setup.source, setup.heads.at(i), {i}, static_cast<uint8_t>(i)),
+        true));
+  }
+
+  Slot slot = kDataCount + 1;
+  ASSERT_OUTCOME_SUCCESS(
+      proposal,
+      setup.store.getProposalAttestations(
+          slot, slot % kDataCount, setup.parent_root));
+  auto &[attestations, proofs] = proposal;
+  EXPECT_EQ(attestations.size(), lean::MAX_ATTESTATIONS_DATA);
+  EXPECT_EQ(proofs.size(), lean::MAX_ATTESTATIONS_DATA);
+  // Each data is included once, with single proof of its validator
+  std::set<ValidatorIndex> included;
+  for (auto &attestation : attestations) {
+    EXPECT_EQ(attestation.aggregation_bits.count(), 1);
+    for (auto validator_index : attestation.aggregation_bits.iter()) {
+      included.emplace(validator_index);
+    }
+  }
+  EXPECT_EQ(included.size(), lean::MAX_ATTESTATIONS_DATA);
+}
@@ -0,0 +1,72 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/interval_deadline.hpp"
+
+#include <map>
+
+#include <gtest/gtest.h>
+
+#include "mock/metrics_mock.hpp"
+#include "testutil/prepare_loggers.hpp"
+
+using lean::Interval;
+using lean::IntervalDeadline;
+using std::chrono_literals::operator""ms;
+
+/// Counts missed deadlines by phase
+class DeadlineMetricsMock : public lean::metrics::MetricsMock {
+ public:
+  class CountingCounter : public lean::metrics::CounterMock {
+   public:
+    void inc() override {
+      ++count;
+    }
+    size_t count = 0;
+  };
+
+  lean::metrics::Counter *fc_interval_deadlines_missed_total(
+      const lean::metrics::Labels &labels) override {
+    return &missed[labels.at("phase")];
+  }
+
+  std::map<std::string, CountingCounter> missed;
+};
+
+struct IntervalDeadlineTest : testing::Test {
+  lean::log::Logger logger =
+      testutil::prepareLoggers()->getLogger("IntervalDeadline", "testing");
+  DeadlineMetricsMock metrics;
+};
+
+/**
+ * @given interval started on time
+ * @when work is shorter than interval
+ * @then deadline is not missed
+ */
+TEST_F(IntervalDeadlineTest, InTime) {
+  IntervalDeadline{logger, metrics, Interval::fromSlot(1, 0), 10ms}.finish();
+  EXPECT_TRUE(metrics.missed.empty());
+}
+
+/**
+ * @given interval which started later than its duration
+ * @when work ends
+ * @then deadline of its phase is missed once, also if moved
+ */
+TEST_F(IntervalDeadlineTest, StartedTooLate) {
+  {
+    IntervalDeadline deadline{logger,
+                              metrics,
+                              Interval::fromSlot(1, 2),
+                              lean::INTERVAL_DURATION_MS + 1ms};
+    deadline.stage("prepare aggregation");
+    IntervalDeadline moved{std::move(deadline)};
+    moved.stage("aggregate");
+  }
+  ASSERT_EQ(metrics.missed.size(), 1);
+  EXPECT_EQ(metrics.missed["2"].count, 1);
+}
@@ -0,0 +1,84 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/justified_slots_window.hpp"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using lean::JustifiedSlotsWindow;
+
+/**
+ * @given window after finalized slot 10
+ * @when slots are extended and justified
+ * @then finalized slots are justified, untracked slots are unknown
+ */
+TEST(JustifiedSlotsWindowTest, Lookup) {
+  std::vector<bool> bits;
+  JustifiedSlotsWindow window{bits, 10};
+  EXPECT_EQ(window.isJustified(5), true);
+  EXPECT_EQ(window.isJustified(10), true);
+  EXPECT_EQ(window.isJustified(11), std::nullopt);
+
+  window.extendTo(14);
+  EXPECT_EQ(bits.size(), 4);
+  window.setJustified(12);
+  window.setJustified(8);
+  EXPECT_EQ(window.isJustified(11), false);
+  EXPECT_EQ(window.isJustified(12), true);
+  EXPECT_EQ(window.isJustified(15), std::nullopt);
+  EXPECT_EQ(bits, (std::vector{false, true, false, false}));
+  EXPECT_THROW(window.setJustified(15), std::out_of_range);
+}
+
+/**
+ * @given window with justified slots
+ * @when finalization advances several times
+ * @then slots are addressed from new finalized slot, and list is shifted
+ * once on commit
+ */
+TEST(JustifiedSlotsWindowTest, Finalize) {
+  // slots 11..16
+  std::vector<bool> bits{true, false, true, false, true, false};
+  JustifiedSlotsWindow window{bits, 10};
+  window.finalize(11);
+  window.finalize(13);
+  EXPECT_EQ(window.finalizedSlot(), 13);
+  EXPECT_EQ(window.size(), 3);
+  EXPECT_EQ(bits.size(), 6);
+  EXPECT_EQ(window.isJustified(14), false);
+  EXPECT_EQ(window.isJustified(15), true);
+  window.setJustified(16);
+  window.extendTo(18);
+  EXPECT_EQ(window.isJustified(18), false);
+
+  window.commit();
+  EXPECT_EQ(bits, (std::vector{false, true, true, false, false}));
+  EXPECT_EQ(window.isJustified(15), true);
+}
+
+/**
+ * @given window with fewer slots than finalization advances
+ * @when finalized slot passes all tracked slots, or moves back
+ * @then all flags are dropped, as by shift of list
+ */
+TEST(JustifiedSlotsWindowTest, FinalizePastWindow) {
+  std::vector<bool> bits{true, true};
+  JustifiedSlotsWindow window{bits, 10};
+  window.finalize(20);
+  EXPECT_EQ(window.size(), 0);
+  window.extendTo(22);
+  window.setJustified(22);
+  window.commit();
+  EXPECT_EQ(bits, (std::vector{false, true}));
+
+  JustifiedSlotsWindow back{bits, 20};
+  back.finalize(15);
+  EXPECT_EQ(back.size(), 0);
+  back.commit();
+  EXPECT_TRUE(bits.empty());
+}
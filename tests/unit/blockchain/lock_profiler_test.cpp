@@ -0,0 +1,97 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/lock_profiler.hpp"
+
+#include <algorithm>
+#include <latch>
+#include <mutex>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "mock/metrics_mock.hpp"
+
+using lean::LockProfiler;
+using lean::LockSite;
+using lean::LockSiteScope;
+using lean::ProfiledSharedMutex;
+using std::chrono_literals::operator""ms;
+
+struct LockProfilerTest : testing::Test {
+  LockProfiler profiler{std::make_shared<lean::metrics::MetricsMock>()};
+};
+
+/**
+ * @given profiled mutex
+ * @when it is locked without contention from different sites
+ * @then acquisitions are counted by site, without contention
+ */
+TEST_F(LockProfilerTest, Uncontended) {
+  ProfiledSharedMutex mutex{profiler.lock("test")};
+  {
+    LockSiteScope site{LockSite::ON_BLOCK};
+    std::unique_lock lock{mutex};
+  }
+  {
+    LockSiteScope site{LockSite::ON_TICK};
+    std::shared_lock lock1{mutex};
+    std::shared_lock lock2{mutex};
+  }
+  EXPECT_EQ(LockSiteScope::current(), LockSite::OTHER);
+
+  auto contenders = profiler.topContenders(10);
+  ASSERT_EQ(contenders.size(), 2);
+  for (auto &contender : contenders) {
+    EXPECT_EQ(contender.lock, "test");
+    EXPECT_EQ(contender.contended, 0);
+    EXPECT_EQ(contender.wait_us, 0);
+  }
+  auto on_block = std::ranges::find(contenders, "onBlock", [](auto &item) {
+    return item.site;
+  });
+  ASSERT_NE(on_block, contenders.end());
+  EXPECT_EQ(on_block->acquisitions, 1);
+  auto on_tick = std::ranges::find(contenders, "onTick", [](auto &item) {
+    return item.site;
+  });
+  ASSERT_NE(on_tick, contenders.end());
+  EXPECT_EQ(on_tick->acquisitions, 2);
+}
+
+/**
+ * @given profiled mutex held by one thread
+ * @when other thread locks it
+ * @then wait is attributed to site of waiting thread, hold to owner
+ */
+TEST_F(LockProfilerTest, Contended) {
+  ProfiledSharedMutex mutex{profiler.lock("test")};
+  std::latch locked{1};
+  std::thread owner{[&] {
+    LockSiteScope site{LockSite::ON_BLOCK};
+    std::unique_lock lock{mutex};
+    locked.count_down();
+    std::this_thread::sleep_for(20ms);
+  }};
+  locked.wait();
+  {
+    LockSiteScope site{LockSite::API_FORK_CHOICE};
+    std::shared_lock lock{mutex};
+  }
+  owner.join();
+
+  auto contenders = profiler.topContenders(1);
+  ASSERT_EQ(contenders.size(), 1);
+  EXPECT_EQ(contenders[0].site, "apiForkChoice");
+  EXPECT_EQ(contenders[0].contended, 1);
+  EXPECT_GT(contenders[0].wait_us, 0);
+  EXPECT_EQ(contenders[0].max_wait_us, contenders[0].wait_us);
+
+  auto all = profiler.topContenders(10);
+  ASSERT_EQ(all.size(), 2);
+  EXPECT_EQ(all[1].site, "onBlock");
+  EXPECT_GE(all[1].hold_us, 10000);
+}
@@ -0,0 +1,228 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/proto_array.hpp"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using lean::BlockHash;
+using lean::BlockIndex;
+using lean::ProtoArray;
+
+BlockHash testHash(uint8_t i) {
+  BlockHash hash;
+  hash[0] = i;
+  return hash;
+}
+
+BlockIndex testBlock(uint8_t i, lean::Slot slot) {
+  return {.slot = slot, .hash = testHash(i)};
+}
+
+lean::Checkpoint testHead(uint8_t i, lean::Slot slot) {
+  return {.root = testHash(i), .slot = slot};
+}
+
+/**
+ *       1 - 2 - 4
+ *      /
+ *     0
+ *      \
+ *       3
+ */
+ProtoArray makeTree() {
+  ProtoArray array;
+  EXPECT_TRUE(array.addBlock(testBlock(0, 0), {}));
+  EXPECT_TRUE(array.addBlock(testBlock(1, 1), testHash(0)));
+  EXPECT_TRUE(array.addBlock(testBlock(2, 2), testHash(1)));
+  EXPECT_TRUE(array.addBlock(testBlock(3, 2), testHash(0)));
+  EXPECT_TRUE(array.addBlock(testBlock(4, 3), testHash(2)));
+  return array;
+}
+
+/**
+ * @given tree without votes
+ * @when head is requested
+ * @then tie is broken by lexicographically larger hash
+ */
+TEST(ProtoArrayTest, NoVotesTieBreak) {
+  auto array = makeTree();
+  EXPECT_EQ(array.findHead(testHash(0)), testHash(3));
+  EXPECT_EQ(array.findHead(testHash(1)), testHash(4));
+  EXPECT_EQ(array.findHead(testHash(5)), std::nullopt);
+}
+
+/**
+ * @given tree
+ * @when votes are added and moved between branches
+ * @then head follows the heaviest branch and weights are updated
+ */
+TEST(ProtoArrayTest, VotesMoveHead) {
+  auto array = makeTree();
+  array.setVote(0, testHead(4, 3));
+  array.setVote(1, testHead(2, 2));
+  EXPECT_EQ(array.findHead(testHash(0)), testHash(4));
+  EXPECT_EQ(array.weight(testHash(1)), 2);
+  EXPECT_EQ(array.weight(testHash(3)), 0);
+
+  array.setVote(0, testHead(3, 2));
+  array.setVote(2, testHead(3, 2));
+  EXPECT_EQ(array.findHead(testHash(0)), testHash(3));
+  EXPECT_EQ(array.weight(testHash(1)), 1);
+  EXPECT_EQ(array.weight(testHash(3)), 2);
+  EXPECT_EQ(array.weight(testHash(0)), 3);
+}
+
+/**
+ * @given vote for unknown block
+ * @when block is added later
+ * @then vote is counted
+ */
+TEST(ProtoArrayTest, PendingVote) {
+  auto array = makeTree();
+  array.setVote(0, testHead(5, 3));
+  array.setVote(1, testHead(4, 3));
+  EXPECT_EQ(array.findHead(testHash(0)), testHash(4));
+
+  EXPECT_TRUE(array.addBlock(testBlock(5, 3), testHash(3)));
+  array.setVote(2, testHead(5, 3));
+  EXPECT_EQ(array.findHead(testHash(0)), testHash(5));
+  EXPECT_EQ(array.weight(testHash(3)), 2);
+
+  EXPECT_FALSE(array.addBlock(testBlock(7, 4), testHash(6)));
+}
+
+/**
+ * @given tree with votes
+ * @when batch of votes is moved to one block, some of it unknown yet
+ * @then weights are same as for separate votes
+ */
+TEST(ProtoArrayTest, SetVotesBatch) {
+  auto array = makeTree();
+  array.setVote(0, testHead(3, 2));
+  std::vector<lean::ValidatorIndex> validators{0, 1, 2};
+  array.setVotes(validators, testHead(4, 3));
+  EXPECT_EQ(array.findHead(testHash(0)), testHash(4));
+  EXPECT_EQ(array.weight(testHash(1)), 3);
+  EXPECT_EQ(array.weight(testHash(3)), 0);
+
+  array.setVotes(validators, testHead(5, 3));
+  EXPECT_EQ(array.weight(testHash(1)), 0);
+  EXPECT_TRUE(array.addBlock(testBlock(5, 3), testHash(3)));
+  EXPECT_EQ(array.findHead(testHash(0)), testHash(5));
+  EXPECT_EQ(array.weight(testHash(3)), 3);
+}
+
+/**
+ * @given tree with votes on both branches
+ * @when tree is pruned to finalized block
+ * @then non-descendants are dropped and head is preserved
+ */
+TEST(ProtoArrayTest, Prune) {
+  auto array = makeTree();
+  array.setVote(0, testHead(4, 3));
+  array.setVote(1, testHead(3, 2));
+  array.prune(testHash(1));
+  EXPECT_EQ(array.size(), 3u);
+  EXPECT_FALSE(array.contains(testHash(0)));
+  EXPECT_FALSE(array.contains(testHash(3)));
+  EXPECT_EQ(array.findHead(testHash(1)), testHash(4));
+  EXPECT_EQ(array.weight(testHash(1)), 1);
+
+  array.setVote(0, testHead(2, 2));
+  EXPECT_TRUE(array.addBlock(testBlock(5, 3), testHash(2)));
+  EXPECT_EQ(array.findHead(testHash(1)), testHash(5));
+}
+
+/**
+ * @given votes for unknown blocks at and after slot of finalized block
+ * @when tree is pruned to finalized block
+ * @then only votes for blocks after finalized slot are kept, and counted
+ * once block is added
+ */
+TEST(ProtoArrayTest, PrunePendingVotes) {
+  auto array = makeTree();
+  array.setVote(0, testHead(5, 1));
+  array.setVote(1, testHead(6, 2));
+  array.setVote(2, testHead(7, 4));
+  array.setVote(2, testHead(8, 3), ProtoArray::VoteSet::NEW);
+  EXPECT_EQ(array.pendingBlocks(), 3);
+  EXPECT_EQ(array.pendingBlocks(ProtoArray::VoteSet::NEW), 1);
+
+  array.prune(testHash(2));
+  EXPECT_EQ(array.pendingBlocks(), 1);
+  EXPECT_EQ(array.pendingBlocks(ProtoArray::VoteSet::NEW), 1);
+  EXPECT_TRUE(array.addBlock(testBlock(7, 4), testHash(4)));
+  EXPECT_EQ(array.pendingBlocks(), 0);
+  EXPECT_EQ(array.findHead(testHash(2)), testHash(7));
+  EXPECT_EQ(array.weight(testHash(2)), 1);
+}
+
+/**
+ * @given tree with known votes on one branch and new votes on other
+ * @when head and safe target are requested
+ * @then head follows known votes, safe target follows new votes above
+ * threshold, and clearing new votes leaves head intact
+ */
+TEST(ProtoArrayTest, SafeTargetByNewVotes) {
+  using VoteSet = ProtoArray::VoteSet;
+  auto array = makeTree();
+  array.setVote(0, testHead(4, 3));
+  array.setVote(0, testHead(3, 2), VoteSet::NEW);
+  array.setVote(1, testHead(3, 2), VoteSet::NEW);
+  array.setVote(2, testHead(2, 2), VoteSet::NEW);
+  EXPECT_EQ(array.findHead(testHash(0)), testHash(4));
+  EXPECT_EQ(array.weight(testHash(3), VoteSet::NEW), 2);
+  EXPECT_EQ(array.weight(testHash(3)), 0);
+  EXPECT_EQ(array.findSafeTarget(testHash(0), 2), testHash(3));
+  EXPECT_EQ(array.findSafeTarget(testHash(0), 3), testHash(0));
+
+  array.removeVote(1, VoteSet::NEW);
+  EXPECT_EQ(array.findSafeTarget(testHash(0), 1), testHash(3));
+  array.setVote(1, testHead(4, 3), VoteSet::NEW);
+  EXPECT_EQ(array.findSafeTarget(testHash(0), 2), testHash(2));
+  EXPECT_EQ(array.findSafeTarget(testHash(0), 1), testHash(4));
+
+  array.clearVotes(VoteSet::NEW);
+  EXPECT_EQ(array.findSafeTarget(testHash(0), 0), testHash(3));
+  EXPECT_EQ(array.weight(testHash(0), VoteSet::NEW), 0);
+  EXPECT_EQ(array.findHead(testHash(0)), testHash(4));
+}
+
+/**
+ * @given tree with head selected
+ * @when blocks are added on head and off head, votes move
+ * @then head is extended without update only while it matches `findHead`
+ */
+TEST(ProtoArrayTest, ExtendedHead) {
+  auto array = makeTree();
+  array.setVote(0, testHead(4, 3));
+  EXPECT_EQ(array.findHead(testHash(0)), testHash(4));
+
+  EXPECT_TRUE(array.addBlock(testBlock(5, 4), testHash(4)));
+  EXPECT_EQ(array.extendedHead(testHash(0), testHash(4), testHash(5)),
+            testHash(5));
+  // New votes don't affect head
+  array.setVote(1, testHead(3, 2), ProtoArray::VoteSet::NEW);
+  EXPECT_EQ(array.extendedHead(testHash(0), testHash(4), testHash(5)),
+            testHash(5));
+  EXPECT_EQ(array.findHead(testHash(0)), testHash(5));
+
+  EXPECT_TRUE(array.addBlock(testBlock(6, 5), testHash(5)));
+  array.setVote(1, testHead(3, 2));
+  EXPECT_EQ(array.extendedHead(testHash(0), testHash(5), testHash(6)),
+            std::nullopt);
+  // Tie is broken by larger hash
+  EXPECT_EQ(array.findHead(testHash(0)), testHash(3));
+
+  // Block off head
+  EXPECT_TRUE(array.addBlock(testBlock(7, 6), testHash(6)));
+  EXPECT_EQ(array.extendedHead(testHash(0), testHash(6), testHash(7)),
+            std::nullopt);
+  EXPECT_EQ(array.findHead(testHash(0)), testHash(3));
+}
@@ -0,0 +1,150 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/state_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include "blockchain/shared_state_pool.hpp"
+
+#include "types/state.hpp"
+
+using lean::BlockHash;
+using lean::State;
+using lean::StateCache;
+
+BlockHash testHash(uint8_t i) {
+  BlockHash hash;
+  hash[0] = i;
+  return hash;
+}
+
+State testState(lean::Slot slot) {
+  State state;
+  state.slot = slot;
+  return state;
+}
+
+/// Budget for `count` empty states
+size_t budget(size_t count) {
+  return StateCache::byteSize(State{}) * count;
+}
+
+/**
+ * @given cache with budget for two states
+ * @when third state is put
+ * @then least recently used state is evicted and size stays within budget
+ */
+TEST(StateCacheTest, EvictsLeastRecentlyUsed) {
+  StateCache cache{budget(2)};
+  cache.put(testHash(1), testState(1));
+  cache.put(testHash(2), testState(2));
+  ASSERT_TRUE(cache.get(testHash(1)).has_value());
+  cache.put(testHash(3), testState(3));
+
+  EXPECT_TRUE(cache.contains(testHash(1)));
+  EXPECT_FALSE(cache.contains(testHash(2)));
+  EXPECT_TRUE(cache.contains(testHash(3)));
+  EXPECT_EQ(cache.keys(), (std::vector{testHash(3), testHash(1)}));
+
+  auto stats = cache.stats();
+  EXPECT_EQ(stats.states, 2);
+  EXPECT_EQ(stats.bytes, budget(2));
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 0);
+}
+
+/**
+ * @given cache with pinned state
+ * @when more states than budget allows are put
+ * @then pinned state is kept, and evicted after unpinning
+ */
+TEST(StateCacheTest, KeepsPinned) {
+  StateCache cache{budget(2)};
+  cache.put(testHash(1), testState(1));
+  cache.pin({testHash(1)});
+  for (uint8_t i = 2; i < 5; ++i) {
+    cache.put(testHash(i), testState(i));
+  }
+  EXPECT_TRUE(cache.contains(testHash(1)));
+  EXPECT_TRUE(cache.contains(testHash(4)));
+  EXPECT_EQ(cache.stats().states, 2);
+
+  cache.pin({testHash(4)});
+  cache.put(testHash(5), testState(5));
+  EXPECT_FALSE(cache.contains(testHash(1)));
+  EXPECT_TRUE(cache.contains(testHash(4)));
+  EXPECT_TRUE(cache.contains(testHash(5)));
+}
+
+/**
+ * @given empty cache
+ * @when missing state is requested and then put
+ * @then miss is counted, and replaced state doesn't count twice in size
+ */
+TEST(StateCacheTest, CountsMissesAndReplaces) {
+  StateCache cache{budget(4)};
+  EXPECT_FALSE(cache.get(testHash(1)).has_value());
+  cache.put(testHash(1), testState(1));
+  cache.put(testHash(1), testState(2));
+
+  auto state = cache.get(testHash(1));
+  ASSERT_TRUE(state.has_value());
+  EXPECT_EQ(state.value()->slot, 2);
+  auto stats = cache.stats();
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.states, 1);
+  EXPECT_EQ(stats.bytes, budget(1));
+}
+
+/**
+ * @given cache with budget for one state and warm tier
+ * @when second state is put and first one is requested
+ * @then first state is restored from warm tier and second one is demoted
+ */
+TEST(StateCacheTest, PromotesFromWarmTier) {
+  StateCache cache{budget(1), size_t{1} << 20};
+  cache.put(testHash(1), testState(1));
+  cache.put(testHash(2), testState(2));
+  EXPECT_TRUE(cache.contains(testHash(1)));
+  EXPECT_EQ(cache.keys(), (std::vector{testHash(2)}));
+  auto stats = cache.stats();
+  EXPECT_EQ(stats.warm_states, 1);
+  EXPECT_GT(stats.warm_bytes, 0);
+
+  auto state = cache.get(testHash(1));
+  ASSERT_TRUE(state.has_value());
+  EXPECT_EQ(state.value()->slot, 1);
+  EXPECT_EQ(cache.keys(), (std::vector{testHash(1)}));
+  stats = cache.stats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.warm_hits, 1);
+  EXPECT_EQ(stats.misses, 0);
+  EXPECT_EQ(stats.warm_states, 1);
+  EXPECT_TRUE(cache.contains(testHash(2)));
+}
+
+/**
+ * @given two caches sharing pool
+ * @when both put state of same block
+ * @then second cache keeps instance of first one
+ */
+TEST(StateCacheTest, SharesStatesOfPool) {
+  auto pool = std::make_shared<lean::SharedStatePool>();
+  StateCache cache1{budget(2)};
+  StateCache cache2{budget(2)};
+  cache1.share(pool);
+  cache2.share(pool);
+  auto state1 = cache1.put(testHash(1), testState(1));
+  auto state2 = cache2.put(testHash(1), testState(1));
+  EXPECT_EQ(state1, state2);
+  EXPECT_EQ(pool->sharedCount(), 1);
+
+  auto other = cache2.put(testHash(2), testState(2));
+  EXPECT_NE(other, state1);
+  EXPECT_EQ(pool->sharedCount(), 1);
+}
@@ -0,0 +1,104 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/impl/state_diff.hpp"
+
+#include <gtest/gtest.h>
+#include <qtils/test/outcome.hpp>
+
+#include "sszpp/ssz++.hpp"
+
+using lean::BlockHash;
+using lean::State;
+using lean::blockchain::applyStateDiff;
+using lean::blockchain::makeStateDiff;
+using lean::blockchain::StateDiff;
+using lean::blockchain::stateDiffCheckpoints;
+
+BlockHash testHash(uint8_t i) {
+  BlockHash hash;
+  hash[0] = i;
+  return hash;
+}
+
+State makeParent() {
+  State state;
+  state.slot = 3;
+  for (uint8_t i = 0; i < 3; ++i) {
+    state.historical_block_hashes.mut().data().emplace_back(testHash(i));
+    state.justified_slots.data().emplace_back(i == 0);
+  }
+  state.validators.mut().data().resize(4);
+  state.justifications_roots.mut().data().emplace_back(testHash(1));
+  state.justifications_validators.mut().data().assign(4, false);
+  return state;
+}
+
+/**
+ * @given parent state and child state with appended and modified lists
+ * @when diff is made and applied to parent state
+ * @then child state is rebuilt, unchanged prefixes are not stored
+ */
+TEST(StateDiffTest, RoundTrip) {
+  auto parent = makeParent();
+  auto state = parent;
+  state.slot = 4;
+  state.latest_justified.slot = 2;
+  state.historical_block_hashes.mut().data().emplace_back(testHash(3));
+  state.justified_slots.data()[2] = true;
+  state.justified_slots.data().emplace_back(false);
+  state.justifications_roots.mut().data().clear();
+  state.justifications_validators.mut().data().clear();
+
+  auto diff = makeStateDiff(testHash(3), 1, parent, state);
+  EXPECT_EQ(diff.historical_block_hashes_keep, 3);
+  EXPECT_EQ(diff.historical_block_hashes_tail.size(), 1);
+  EXPECT_EQ(diff.justified_slots_keep, 2);
+  EXPECT_EQ(diff.validators_keep, 4);
+  EXPECT_EQ(diff.validators_tail.size(), 0);
+  EXPECT_EQ(diff.justifications_roots_keep, 0);
+
+  auto encoded = lean::encode(diff).value();
+  ASSERT_OUTCOME_SUCCESS(decoded, lean::decode<StateDiff>(encoded));
+  ASSERT_OUTCOME_SUCCESS(rebuilt, applyStateDiff(parent, decoded));
+  EXPECT_EQ(rebuilt, state);
+  // Unchanged list is shared with parent
+  EXPECT_EQ(&rebuilt.validators.data(), &parent.validators.data());
+}
+
+/**
+ * @given diff made against longer parent state
+ * @when diff is applied to unrelated shorter state
+ * @then error is returned
+ */
+TEST(StateDiffTest, Inconsistent) {
+  auto parent = makeParent();
+  auto state = parent;
+  state.historical_block_hashes.mut().data().emplace_back(testHash(3));
+  auto diff = makeStateDiff(testHash(3), 1, parent, state);
+  EXPECT_FALSE(applyStateDiff(State{}, diff).has_value());
+}
+
+/**
+ * @given encoded diff
+ * @when checkpoints are read without decoding diff
+ * @then they match checkpoints of diff
+ */
+TEST(StateDiffTest, Checkpoints) {
+  auto parent = makeParent();
+  auto state = parent;
+  state.latest_justified.slot = 2;
+  state.latest_justified.root = testHash(2);
+  state.latest_finalized.slot = 1;
+  state.historical_block_hashes.mut().data().emplace_back(testHash(3));
+  auto encoded = lean::encode(makeStateDiff(testHash(3), 1, parent, state));
+
+  ASSERT_OUTCOME_SUCCESS(checkpoints, stateDiffCheckpoints(encoded.value()));
+  EXPECT_EQ(checkpoints.first, state.latest_justified);
+  EXPECT_EQ(checkpoints.second, state.latest_finalized);
+  EXPECT_FALSE(stateDiffCheckpoints(qtils::BytesIn{encoded.value()}.first(40))
+                   .has_value());
+}
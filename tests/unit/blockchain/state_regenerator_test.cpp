@@ -0,0 +1,173 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/state_regenerator.hpp"
+
+#include <gtest/gtest.h>
+
+#include "blockchain/impl/anchor_block_impl.hpp"
+#include "blockchain/impl/anchor_state_impl.hpp"
+#include "mock/blockchain/block_storage_mock.hpp"
+#include "mock/blockchain/block_tree_mock.hpp"
+#include "mock/metrics_mock.hpp"
+#include "testutil/prepare_loggers.hpp"
+#include "types/state.hpp"
+
+using lean::Block;
+using lean::BlockHash;
+using lean::SignedBlock;
+using lean::State;
+using lean::blockchain::BlockStorageMock;
+using lean::blockchain::BlockTreeMock;
+using lean::blockchain::StateCheckpoints;
+using lean::blockchain::StateRegenerator;
+using testing::_;
+using testing::AnyNumber;
+using testing::Invoke;
+using testing::Return;
+
+class StateRegeneratorTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    EXPECT_CALL(*block_tree_, getLatestJustified()).Times(AnyNumber());
+    EXPECT_CALL(*block_tree_, lastFinalized()).Times(AnyNumber());
+    lean::STF stf(logsys_, block_tree_, metrics_);
+
+    std::vector<lean::Validator> validators;
+    validators.resize(2);
+    genesis_state_ = lean::STF::generateGenesisState({}, validators);
+    auto genesis = lean::blockchain::AnchorBlockImpl{
+        lean::blockchain::AnchorStateImpl{genesis_state_}};
+    genesis_ = genesis.hash();
+    states_.emplace_back(genesis_state_);
+    auto parent = genesis_;
+    for (lean::Slot slot = 1; slot <= kBlocks; ++slot) {
+      Block block{
+          .slot = slot,
+          .proposer_index = slot % validators.size(),
+          .parent_root = parent,
+      };
+      auto state = stf.stateTransition(block, states_.back(), false).value();
+      block.state_root = lean::sszHash(state);
+      block.setHash();
+      parent = block.hash();
+      blocks_.emplace_back(block);
+      states_.emplace_back(std::move(state));
+    }
+
+    // Only genesis state is stored
+    ON_CALL(*block_storage_, getState(_))
+        .WillByDefault(Invoke([this](const BlockHash &hash)
+                                  -> outcome::result<std::optional<State>> {
+          if (hash == genesis_) {
+            return genesis_state_;
+          }
+          return std::nullopt;
+        }));
+    ON_CALL(*block_storage_, getStateCheckpoints(_))
+        .WillByDefault(
+            Invoke([this](const BlockHash &hash)
+                       -> outcome::result<std::optional<StateCheckpoints>> {
+              if (hash == genesis_) {
+                return StateCheckpoints{};
+              }
+              return std::nullopt;
+            }));
+    ON_CALL(*block_storage_, tryGetBlockHeader(_))
+        .WillByDefault(Invoke(
+            [this](const BlockHash &hash)
+                -> outcome::result<std::optional<lean::BlockHeader>> {
+              if (auto *block = find(hash)) {
+                return block->getHeader();
+              }
+              return std::nullopt;
+            }));
+    ON_CALL(*block_storage_, tryGetSignedBlocks(_))
+        .WillByDefault(Invoke(
+            [this](std::span<const BlockHash> hashes)
+                -> outcome::result<std::vector<std::optional<SignedBlock>>> {
+              read_.emplace_back(hashes.size());
+              std::vector<std::optional<SignedBlock>> result;
+              for (auto &hash : hashes) {
+                if (auto *block = find(hash)) {
+                  result.emplace_back(SignedBlock{.block = *block});
+                } else {
+                  result.emplace_back();
+                }
+              }
+              return result;
+            }));
+  }
+
+  const Block *find(const BlockHash &hash) const {
+    for (auto &block : blocks_) {
+      if (block.hash() == hash) {
+        return &block;
+      }
+    }
+    return nullptr;
+  }
+
+  static constexpr lean::Slot kBlocks = 100;
+
+  std::shared_ptr<BlockStorageMock> block_storage_ =
+      std::make_shared<testing::NiceMock<BlockStorageMock>>();
+  std::shared_ptr<BlockTreeMock> block_tree_ =
+      std::make_shared<BlockTreeMock>();
+  std::shared_ptr<lean::metrics::MetricsMock> metrics_ =
+      std::make_shared<lean::metrics::MetricsMock>();
+  qtils::SharedRef<lean::log::LoggingSystem> logsys_ =
+      testutil::prepareLoggers();
+
+  BlockHash genesis_;
+  State genesis_state_;
+  std::vector<Block> blocks_;
+  /// Post-state of genesis and of each block
+  std::vector<State> states_;
+  /// Size of each block read
+  std::vector<size_t> read_;
+};
+
+/**
+ * @given chain with only genesis state stored
+ * @when state of block is queried, then state of block after checkpoint
+ * @then states are replayed from genesis, then from cached checkpoint
+ */
+TEST_F(StateRegeneratorTest, Replay) {
+  StateRegenerator regenerator{logsys_, block_storage_, block_tree_, metrics_};
+
+  auto state = regenerator.getState(blocks_[89].hash()).value();
+  ASSERT_TRUE(state.has_value());
+  EXPECT_EQ(**state, states_[90]);
+  EXPECT_EQ(read_, (std::vector<size_t>{64, 26}));
+
+  read_.clear();
+  state = regenerator.getState(blocks_[69].hash()).value();
+  ASSERT_TRUE(state.has_value());
+  EXPECT_EQ(**state, states_[70]);
+  EXPECT_EQ(read_, (std::vector<size_t>{6}));
+}
+
+/**
+ * @given chain with only genesis state stored
+ * @when state of unknown block is queried
+ * @then nothing is found
+ */
+TEST_F(StateRegeneratorTest, UnknownBlock) {
+  StateRegenerator regenerator{logsys_, block_storage_, block_tree_, metrics_};
+  EXPECT_EQ(regenerator.getState(BlockHash{}).value(), std::nullopt);
+}
+
+/**
+ * @given block whose state root doesn't match its replayed state
+ * @when its state is queried
+ * @then query fails
+ */
+TEST_F(StateRegeneratorTest, StateRootMismatch) {
+  blocks_.back().state_root = {};
+  StateRegenerator regenerator{logsys_, block_storage_, block_tree_, metrics_};
+  EXPECT_TRUE(regenerator.getState(blocks_.back().hash()).has_error());
+}
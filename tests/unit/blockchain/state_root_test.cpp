@@ -0,0 +1,89 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/state_root.hpp"
+
+#include <gtest/gtest.h>
+
+#include "serde/parallel_hash.hpp"
+#include "serde/serialization.hpp"
+#include "utils/worker_pool.hpp"
+
+using lean::BlockHash;
+using lean::State;
+using lean::stateRoot;
+
+BlockHash testHash(uint8_t i) {
+  BlockHash hash;
+  hash[0] = i;
+  return hash;
+}
+
+/**
+ * @given state with non-empty lists
+ * @when lists are appended, changed and truncated between root calculations
+ * @then cached root always equals full `sszHash`
+ */
+TEST(StateRootTest, MatchesSszHash) {
+  State state;
+  EXPECT_EQ(stateRoot(state), lean::sszHash(state));
+
+  state.validators.mut().data().resize(3);
+  for (uint8_t i = 0; i < 40; ++i) {
+    state.historical_block_hashes.mut().data().emplace_back(testHash(i));
+    state.justified_slots.data().emplace_back(i % 3 == 0);
+  }
+  state.justifications_roots.mut().data().emplace_back(testHash(1));
+  state.justifications_validators.mut().data().assign(300, true);
+  EXPECT_EQ(stateRoot(state), lean::sszHash(state));
+
+  // Copy shares lists until they are modified
+  auto child = state;
+  EXPECT_EQ(&child.validators.data(), &state.validators.data());
+  ++child.slot;
+  child.historical_block_hashes.mut().data().emplace_back(testHash(40));
+  child.justified_slots.data()[7] = true;
+  child.validators.mut().data()[1].index = 1;
+  EXPECT_NE(&child.validators.data(), &state.validators.data());
+  child.justifications_validators.mut().data().resize(10);
+  EXPECT_EQ(stateRoot(child), lean::sszHash(child));
+
+  child.justifications_roots.mut().data().clear();
+  child.justifications_validators.mut().data().clear();
+  child.historical_block_hashes.mut().data().resize(5);
+  EXPECT_EQ(stateRoot(child), lean::sszHash(child));
+
+  // Parent cache is not affected by child changes
+  EXPECT_EQ(stateRoot(state), lean::sszHash(state));
+}
+
+/**
+ * @given hash worker pool and state with lists large enough for parallel
+ * hashing
+ * @when root is calculated
+ * @then it equals serial `sszHash`
+ */
+TEST(StateRootTest, ParallelMatchesSszHash) {
+  auto worker_pool = std::make_shared<lean::WorkerPool>(4);
+  lean::setHashWorkerPool(worker_pool);
+
+  State state;
+  auto &validators = state.validators.mut().data();
+  validators.resize(1000);
+  for (size_t i = 0; i < validators.size(); ++i) {
+    validators[i].index = i;
+  }
+  auto &hashes = state.historical_block_hashes.mut().data();
+  for (size_t i = 0; i < 20000; ++i) {
+    BlockHash hash;
+    hash[0] = static_cast<uint8_t>(i);
+    hash[1] = static_cast<uint8_t>(i >> 8);
+    hashes.emplace_back(hash);
+  }
+  EXPECT_EQ(stateRoot(state), lean::sszHash(state));
+
+  lean::setHashWorkerPool({});
+}
@@ -0,0 +1,77 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/impl/state_snapshot.hpp"
+
+#include <gtest/gtest.h>
+#include <qtils/test/outcome.hpp>
+
+#include "blockchain/state_root.hpp"
+#include "sszpp/ssz++.hpp"
+
+using lean::BlockHash;
+using lean::State;
+using lean::blockchain::makeStateSnapshot;
+using lean::blockchain::StateSnapshot;
+using lean::blockchain::stateFromSnapshot;
+using lean::blockchain::stateSnapshotCheckpoints;
+
+BlockHash testHash(uint8_t i) {
+  BlockHash hash;
+  hash[0] = i;
+  return hash;
+}
+
+State makeState() {
+  State state;
+  state.slot = 3;
+  state.latest_justified.slot = 2;
+  state.latest_finalized.root = testHash(1);
+  for (uint8_t i = 0; i < 3; ++i) {
+    state.historical_block_hashes.mut().data().emplace_back(testHash(i));
+    state.justified_slots.data().emplace_back(i == 0);
+  }
+  state.validators.mut().data().resize(4);
+  state.validators.mut().data()[3].index = 3;
+  state.justifications_roots.mut().data().emplace_back(testHash(2));
+  state.justifications_validators.mut().data().assign(4, true);
+  return state;
+}
+
+/**
+ * @given state
+ * @when it is stored as snapshot referencing its validators by root
+ * @then state is rebuilt from snapshot and validators, checkpoints are read
+ * without decoding
+ */
+TEST(StateSnapshotTest, RoundTrip) {
+  auto state = makeState();
+  auto root = lean::validatorsRoot(state);
+  EXPECT_EQ(root, lean::sszHash(state.validators));
+
+  auto encoded = lean::encode(makeStateSnapshot(state, root)).value();
+  ASSERT_OUTCOME_SUCCESS(snapshot, lean::decode<StateSnapshot>(encoded));
+  EXPECT_EQ(snapshot.validators_root, root);
+  auto validators =
+      lean::decode<decltype(State::validators)>(
+          lean::encode(state.validators).value())
+          .value();
+  EXPECT_EQ(stateFromSnapshot(snapshot, validators), state);
+
+  ASSERT_OUTCOME_SUCCESS(checkpoints, stateSnapshotCheckpoints(encoded));
+  EXPECT_EQ(checkpoints.first, state.latest_justified);
+  EXPECT_EQ(checkpoints.second, state.latest_finalized);
+}
+
+/**
+ * @given full state encoded before validators were stored apart
+ * @when layout of snapshot is checked
+ * @then it doesn't match, so storage falls back to full state
+ */
+TEST(StateSnapshotTest, FullStateIsNotSnapshot) {
+  auto encoded = lean::encode(makeState()).value();
+  EXPECT_FALSE(stateSnapshotCheckpoints(encoded).has_value());
+}
@@ -6,13 +6,21 @@
 
 #include "blockchain/state_transition_function.hpp"
 
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+#include <unordered_map>
+
 #include <gtest/gtest.h>
 
 #include "blockchain/impl/anchor_block_impl.hpp"
 #include "blockchain/impl/anchor_state_impl.hpp"
+#include "blockchain/is_justifiable_slot.hpp"
 #include "mock/blockchain/block_tree_mock.hpp"
 #include "mock/metrics_mock.hpp"
 #include "testutil/prepare_loggers.hpp"
+#include "types/aggregated_attestations.hpp"
 #include "types/config.hpp"
 #include "types/state.hpp"
 
@@ -55,3 +63,384 @@ TEST(STF, Test) {
   EXPECT_EQ(state2_apply, state2);
   block2.setHash();
 }
+
+/**
+ * @given state with pending justification
+ * @when attestations are processed with kept index, and with index dropped
+ * as for decoded state
+ * @then both produce same state, justified after 2/3 of votes
+ */
+TEST(STF, JustificationsIndex) {
+  auto block_tree = std::make_shared<lean::blockchain::BlockTreeMock>();
+  EXPECT_CALL(*block_tree, getLatestJustified()).Times(testing::AnyNumber());
+  EXPECT_CALL(*block_tree, lastFinalized()).Times(testing::AnyNumber());
+  lean::STF stf(testutil::prepareLoggers(),
+                block_tree,
+                std::make_shared<lean::metrics::MetricsMock>());
+
+  std::vector<lean::Validator> validators;
+  validators.resize(4);
+  auto state0 = lean::STF::generateGenesisState({}, validators);
+  auto block0 = lean::blockchain::AnchorBlockImpl{
+      lean::blockchain::AnchorStateImpl{state0}};
+  lean::Block block1{
+      .slot = 1,
+      .proposer_index = 1,
+      .parent_root = block0.hash(),
+  };
+  auto state1 = stf.stateTransition(block1, state0, false).value();
+  block1.state_root = lean::sszHash(state1);
+  block1.setHash();
+  lean::Block block2{
+      .slot = 2,
+      .proposer_index = 2,
+      .parent_root = block1.hash(),
+  };
+  auto state = stf.stateTransition(block2, state1, false).value();
+
+  lean::Checkpoint source{.root = block0.hash(), .slot = 0};
+  lean::Checkpoint target{.root = block1.hash(), .slot = 1};
+  auto attestations = [&](lean::ValidatorIndex validator_index) {
+    lean::AggregatedAttestation attestation{
+        .data = {.slot = 2, .head = target, .target = target, .source = source},
+    };
+    attestation.aggregation_bits.add(validator_index);
+    lean::AggregatedAttestations result;
+    result.push_back(attestation);
+    return result;
+  };
+
+  ASSERT_TRUE(stf.processAttestations(state, attestations(0)).has_value());
+  auto decoded = state;
+  decoded.justifications_index = {};
+  for (auto *item : {&state, &decoded}) {
+    ASSERT_TRUE(stf.processAttestations(*item, attestations(1)).has_value());
+    EXPECT_EQ(item->justifications_roots.size(), 1);
+    EXPECT_EQ(item->latest_justified, source);
+    ASSERT_TRUE(stf.processAttestations(*item, attestations(2)).has_value());
+    EXPECT_EQ(item->latest_justified, target);
+    EXPECT_EQ(item->justifications_roots.size(), 0);
+  }
+  EXPECT_EQ(lean::sszHash(state), lean::sszHash(decoded));
+}
+
+/**
+ * @given finalized slot
+ * @when justifiable slots are looked up, within table and beyond it
+ * @then they are deltas up to 5, squares and pronic numbers
+ */
+TEST(STF, JustifiableSlots) {
+  auto justifiable = [](lean::Slot delta) {
+    for (lean::Slot x = 0; x * x <= delta; ++x) {
+      if (x * x == delta or x * x + x == delta) {
+        return true;
+      }
+    }
+    return delta <= 5;
+  };
+  lean::Slot finalized = 10;
+  lean::Slot last = finalized;
+  for (auto delta : {0, 1, 6, 7, 111, 1000, 262'142, 262'144, 263'000}) {
+    lean::Slot slot = finalized + delta;
+    EXPECT_EQ(lean::isJustifiableSlot(finalized, slot), justifiable(delta));
+    last = slot;
+    while (not justifiable(last - finalized)) {
+      --last;
+    }
+    EXPECT_EQ(lean::lastJustifiableSlot(finalized, slot), last);
+  }
+  EXPECT_EQ(lean::prevJustifiableSlot(finalized, finalized + 9),
+            finalized + 6);
+  EXPECT_TRUE(lean::anyJustifiableSlotBetween(finalized, 15, 17));
+  EXPECT_FALSE(lean::anyJustifiableSlotBetween(finalized, 16, 19));
+  EXPECT_FALSE(lean::anyJustifiableSlotBetween(finalized, 16, 17));
+}
+
+/**
+ * @given parent state advanced by `processSlots` to slot of block, and to
+ * slot before it
+ * @when block is applied to advanced state
+ * @then post-state is same as without advance
+ */
+TEST(STF, AdvancedParentState) {
+  lean::STF stf(testutil::prepareLoggers(),
+                std::make_shared<lean::blockchain::BlockTreeMock>(),
+                std::make_shared<lean::metrics::MetricsMock>());
+
+  std::vector<lean::Validator> validators;
+  validators.resize(2);
+  auto state0 = lean::STF::generateGenesisState({}, validators);
+  auto block0 = lean::blockchain::AnchorBlockImpl{
+      lean::blockchain::AnchorStateImpl{state0}};
+  auto advanced = state0;
+  ASSERT_TRUE(stf.processSlots(advanced, 1).has_value());
+
+  for (lean::Slot slot : {1, 3}) {
+    lean::Block block{
+        .slot = slot,
+        .proposer_index = slot % 2,
+        .parent_root = block0.hash(),
+    };
+    auto expected = stf.stateTransition(block, state0, false).value();
+    block.state_root = lean::sszHash(expected);
+    auto state = stf.stateTransition(block, state0, true, &advanced);
+    ASSERT_TRUE(state.has_value());
+    EXPECT_EQ(state.value(), expected);
+  }
+}
+
+/// Root of history slot, never zero hash
+lean::BlockHash historyRoot(lean::Slot slot) {
+  lean::BlockHash root;
+  root[0] = 0xab;
+  root[1] = static_cast<uint8_t>(slot);
+  return root;
+}
+
+/**
+ * State of `validator_count` validators, with `slots` history roots and
+ * only genesis justified and finalized
+ */
+lean::State historyState(size_t validator_count, lean::Slot slots) {
+  std::vector<lean::Validator> validators;
+  validators.resize(validator_count);
+  auto state = lean::STF::generateGenesisState({}, validators);
+  auto &history = state.historical_block_hashes.mut().data();
+  history.clear();
+  for (lean::Slot slot = 0; slot < slots; ++slot) {
+    history.emplace_back(historyRoot(slot));
+  }
+  state.justified_slots.data().assign(slots - 1, false);
+  state.latest_justified = {.root = historyRoot(0), .slot = 0};
+  state.latest_finalized = state.latest_justified;
+  return state;
+}
+
+lean::AggregatedAttestation justificationVote(
+    lean::Slot source_slot,
+    lean::Slot target_slot,
+    std::initializer_list<lean::ValidatorIndex> validators) {
+  lean::Checkpoint source{.root = historyRoot(source_slot),
+                          .slot = source_slot};
+  lean::Checkpoint target{.root = historyRoot(target_slot),
+                          .slot = target_slot};
+  lean::AggregatedAttestation attestation{
+      .data = {.slot = target_slot,
+               .head = target,
+               .target = target,
+               .source = source},
+  };
+  for (auto validator_index : validators) {
+    attestation.aggregation_bits.add(validator_index);
+  }
+  return attestation;
+}
+
+/**
+ * Justifications as map of votes by root, as processed before votes were
+ * edited in place in state lists
+ */
+struct JustificationsModel {
+  explicit JustificationsModel(const lean::State &state)
+      : latest_justified{state.latest_justified},
+        latest_finalized{state.latest_finalized} {
+    auto validator_count = state.validatorCount();
+    auto &votes_list = state.justifications_validators.data();
+    for (size_t i = 0; i < state.justifications_roots.size(); ++i) {
+      auto begin = votes_list.begin() + i * validator_count;
+      votes[state.justifications_roots[i]].assign(begin,
+                                                  begin + validator_count);
+    }
+    auto &bits = state.justified_slots.data();
+    for (size_t i = 0; i < bits.size(); ++i) {
+      if (bits[i]) {
+        justified.emplace(latest_finalized.slot + 1 + i);
+      }
+    }
+  }
+
+  bool isJustified(lean::Slot slot) const {
+    return slot <= latest_finalized.slot or justified.contains(slot);
+  }
+
+  void process(const lean::State &state,
+               const lean::AggregatedAttestations &attestations) {
+    auto &history = state.historical_block_hashes.data();
+    auto validator_count = state.validatorCount();
+    std::unordered_map<lean::BlockHash, lean::Slot> root_to_slot;
+    for (auto slot = latest_finalized.slot + 1; slot < history.size();
+         ++slot) {
+      root_to_slot[history[slot]] = slot;
+    }
+    for (auto &attestation : attestations) {
+      auto &source = attestation.data.source;
+      auto &target = attestation.data.target;
+      if (not isJustified(source.slot) or isJustified(target.slot)
+          or source.root != history.at(source.slot)
+          or target.root != history.at(target.slot)
+          or target.slot <= source.slot
+          or not lean::isJustifiableSlot(latest_finalized.slot,
+                                         target.slot)) {
+        continue;
+      }
+      auto &bits = votes[target.root];
+      bits.resize(validator_count);
+      for (auto validator_index : attestation.aggregation_bits.iter()) {
+        bits.at(validator_index) = true;
+      }
+      size_t count = std::ranges::count(bits, true);
+      if (3 * count < 2 * validator_count) {
+        continue;
+      }
+      latest_justified = target;
+      justified.emplace(target.slot);
+      votes.erase(target.root);
+      auto any = false;
+      for (auto slot = source.slot + 1; slot < target.slot; ++slot) {
+        any = any or lean::isJustifiableSlot(latest_finalized.slot, slot);
+      }
+      if (any) {
+        continue;
+      }
+      auto old_finalized_slot = latest_finalized.slot;
+      latest_finalized = source;
+      if (latest_finalized.slot <= old_finalized_slot) {
+        continue;
+      }
+      std::erase_if(justified, [&](lean::Slot slot) {
+        return slot <= latest_finalized.slot;
+      });
+      std::erase_if(votes, [&](const auto &pair) {
+        return root_to_slot.at(pair.first) <= latest_finalized.slot;
+      });
+    }
+  }
+
+  /// Justifications and checkpoints of state are same as of model
+  void expectSame(const lean::State &state) const {
+    EXPECT_EQ(state.latest_justified, latest_justified);
+    EXPECT_EQ(state.latest_finalized, latest_finalized);
+    std::vector<lean::BlockHash> roots;
+    std::vector<bool> votes_list;
+    for (auto &[root, bits] : votes) {
+      roots.emplace_back(root);
+      votes_list.insert(votes_list.end(), bits.begin(), bits.end());
+    }
+    EXPECT_EQ(state.justifications_roots.data(), roots);
+    EXPECT_EQ(state.justifications_validators.data(), votes_list);
+    auto &bits = state.justified_slots.data();
+    for (size_t i = 0; i < bits.size(); ++i) {
+      EXPECT_EQ(bits[i], justified.contains(latest_finalized.slot + 1 + i))
+          << "slot " << latest_finalized.slot + 1 + i;
+    }
+  }
+
+  std::map<lean::BlockHash, std::vector<bool>> votes;
+  /// Justified slots after finalized one
+  std::set<lean::Slot> justified;
+  lean::Checkpoint latest_justified;
+  lean::Checkpoint latest_finalized;
+};
+
+lean::STF justificationsStf() {
+  auto block_tree = std::make_shared<lean::blockchain::BlockTreeMock>();
+  EXPECT_CALL(*block_tree, getLatestJustified()).Times(testing::AnyNumber());
+  EXPECT_CALL(*block_tree, lastFinalized()).Times(testing::AnyNumber());
+  return lean::STF{testutil::prepareLoggers(),
+                   block_tree,
+                   std::make_shared<lean::metrics::MetricsMock>()};
+}
+
+/**
+ * @given state with pending justifications in unsorted order, as not
+ * produced by spec
+ * @when attestations justify one of roots, and then finalize it
+ * @then roots are sorted with their votes, justified root is removed, votes
+ * for it are ignored after, and result is same as of previous
+ * implementation
+ */
+TEST(STF, JustificationsOutOfOrderRoots) {
+  auto stf = justificationsStf();
+  auto state = historyState(4, 8);
+  // Roots of slots 5 and 2, voted by validators 0 and 1
+  state.justifications_roots.mut().data() = {historyRoot(5), historyRoot(2)};
+  state.justifications_validators.mut().data() = {
+      true, false, false, false, false, true, false, false};
+  JustificationsModel model{state};
+
+  lean::AggregatedAttestations attestations;
+  attestations.push_back(justificationVote(0, 2, {2, 3}));
+  // Already justified root is not tracked again
+  attestations.push_back(justificationVote(0, 2, {0}));
+  ASSERT_TRUE(stf.processAttestations(state, attestations).has_value());
+  model.process(state, attestations);
+  EXPECT_EQ(state.latest_justified.slot, 2);
+  EXPECT_EQ(state.latest_finalized.slot, 0);
+  EXPECT_EQ(state.justifications_roots.data(),
+            std::vector{historyRoot(5)});
+  EXPECT_EQ(state.justifications_validators.data(),
+            (std::vector<bool>{true, false, false, false}));
+  model.expectSame(state);
+
+  // No justifiable slot between 2 and 3, so 2 is finalized
+  attestations.clear();
+  attestations.push_back(justificationVote(2, 3, {0, 1, 2}));
+  ASSERT_TRUE(stf.processAttestations(state, attestations).has_value());
+  model.process(state, attestations);
+  EXPECT_EQ(state.latest_justified.slot, 3);
+  EXPECT_EQ(state.latest_finalized.slot, 2);
+  EXPECT_EQ(state.justifications_roots.data(),
+            std::vector{historyRoot(5)});
+  model.expectSame(state);
+}
+
+/**
+ * @given state with history and no pending justifications
+ * @when random attestations are processed block by block, some of them
+ * justifying and finalizing, and some invalid, while index is dropped as
+ * for decoded state
+ * @then justifications, justified slots and checkpoints are always same as
+ * of previous implementation
+ */
+TEST(STF, JustificationsMatchMapImplementation) {
+  auto stf = justificationsStf();
+  constexpr size_t kValidators = 7;
+  constexpr lean::Slot kSlots = 48;
+  auto state = historyState(kValidators, kSlots);
+  JustificationsModel model{state};
+  std::mt19937 random{7};
+  auto uniform = [&](uint64_t min, uint64_t max) {
+    return std::uniform_int_distribution<uint64_t>{min, max}(random);
+  };
+  for (size_t block = 0; block < 200; ++block) {
+    lean::AggregatedAttestations attestations;
+    for (auto i = uniform(0, 4); i > 0; --i) {
+      auto target_slot = uniform(1, kSlots - 1);
+      // Mostly justified source, for attestations to be counted
+      auto source_slot = model.latest_justified.slot;
+      if (uniform(0, 3) == 0) {
+        source_slot = uniform(
+            std::min(model.latest_finalized.slot, target_slot), target_slot);
+      }
+      auto attestation = justificationVote(source_slot, target_slot, {});
+      for (auto j = uniform(1, 3); j > 0; --j) {
+        attestation.aggregation_bits.add(uniform(0, kValidators - 1));
+      }
+      if (uniform(0, 9) == 0) {
+        attestation.data.target.root = historyRoot(target_slot + 1);
+      }
+      attestations.push_back(attestation);
+    }
+    if (block % 5 == 0) {
+      state.justifications_index = {};
+    }
+    ASSERT_TRUE(stf.processAttestations(state, attestations).has_value());
+    model.process(state, attestations);
+    model.expectSame(state);
+    if (testing::Test::HasFailure()) {
+      FAIL() << "block " << block;
+    }
+  }
+  // Scenario is not trivial
+  EXPECT_GT(state.latest_finalized.slot, 0);
+}
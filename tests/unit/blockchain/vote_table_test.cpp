@@ -0,0 +1,128 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/vote_table.hpp"
+
+#include <map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using lean::AttestationData;
+using lean::VoteTable;
+
+AttestationData testData(lean::Slot slot) {
+  AttestationData data;
+  data.slot = slot;
+  data.head.slot = slot;
+  data.head.root[0] = static_cast<uint8_t>(slot);
+  return data;
+}
+
+/**
+ * @given empty table
+ * @when votes are inserted, replaced and erased
+ * @then lookups reflect latest vote of each validator
+ */
+TEST(VoteTableTest, InsertReplaceErase) {
+  VoteTable votes;
+  EXPECT_TRUE(votes.empty());
+  EXPECT_EQ(votes.find(0), nullptr);
+
+  votes.insert_or_assign(3, testData(1));
+  votes.insert_or_assign(5, testData(1));
+  votes.insert_or_assign(3, testData(2));
+  EXPECT_EQ(votes.size(), 2);
+  ASSERT_NE(votes.find(3), nullptr);
+  EXPECT_EQ(votes.find(3)->slot, 2);
+  EXPECT_EQ(votes.at(5).slot, 1);
+  EXPECT_FALSE(votes.contains(4));
+  EXPECT_THROW(votes.at(4), std::out_of_range);
+
+  EXPECT_TRUE(votes.erase(5));
+  EXPECT_FALSE(votes.erase(5));
+  EXPECT_EQ(votes.size(), 1);
+  EXPECT_FALSE(votes.contains(5));
+}
+
+/**
+ * @given validators voting the same way
+ * @when distinct data is iterated
+ * @then equal votes share one entry counted by voters
+ */
+TEST(VoteTableTest, SharesEqualData) {
+  VoteTable votes;
+  for (lean::ValidatorIndex i = 0; i < 10; ++i) {
+    votes.insert_or_assign(i, testData(i < 7 ? 1 : 2));
+  }
+  EXPECT_EQ(votes.distinctCount(), 2);
+
+  std::map<lean::Slot, size_t> voters;
+  votes.forEachData([&](const AttestationData &data, size_t count) {
+    voters[data.slot] += count;
+  });
+  EXPECT_EQ(voters, (std::map<lean::Slot, size_t>{{1, 7}, {2, 3}}));
+
+  // Entry is released when last voter moves away, and reused
+  for (lean::ValidatorIndex i = 7; i < 10; ++i) {
+    votes.insert_or_assign(i, testData(3));
+  }
+  EXPECT_EQ(votes.distinctCount(), 2);
+}
+
+/**
+ * @given table with sparse validators
+ * @when it is iterated
+ * @then votes come in validator order, skipping validators without vote
+ */
+TEST(VoteTableTest, IteratesByValidator) {
+  VoteTable votes{{4, testData(4)}, {1, testData(1)}, {9, testData(9)}};
+  votes.erase(4);
+  std::vector<lean::ValidatorIndex> validators;
+  for (auto &&[validator, data] : votes) {
+    EXPECT_EQ(data.slot, validator);
+    validators.emplace_back(validator);
+  }
+  EXPECT_EQ(validators, (std::vector<lean::ValidatorIndex>{1, 9}));
+
+  votes.clear();
+  EXPECT_TRUE(votes.empty());
+  EXPECT_EQ(votes.begin(), votes.end());
+}
+
+/**
+ * @given table with votes of different slots
+ * @when batch of validators is assigned newer data
+ * @then only votes accepted by predicate change and are returned
+ */
+TEST(VoteTableTest, AssignBatch) {
+  VoteTable votes;
+  votes.insert_or_assign(1, testData(1));
+  votes.insert_or_assign(2, testData(5));
+  votes.insert_or_assign(3, testData(3));
+
+  std::vector<lean::ValidatorIndex> validators{0, 1, 2, 3, 9};
+  auto assigned = votes.assign(
+      validators, testData(3), [](const AttestationData *vote) {
+        return vote == nullptr or vote->slot < 3;
+      });
+  EXPECT_EQ(assigned, (std::vector<lean::ValidatorIndex>{0, 1, 9}));
+  EXPECT_EQ(votes.size(), 5);
+  EXPECT_EQ(votes.at(0).slot, 3);
+  EXPECT_EQ(votes.at(1).slot, 3);
+  EXPECT_EQ(votes.at(2).slot, 5);
+  EXPECT_EQ(votes.at(9).slot, 3);
+  // Data of slot 1 lost its only voter
+  EXPECT_EQ(votes.distinctCount(), 2);
+
+  // Nothing assigned, data is not kept
+  EXPECT_TRUE(votes
+                  .assign(validators,
+                          testData(7),
+                          [](const AttestationData *) { return false; })
+                  .empty());
+  EXPECT_EQ(votes.distinctCount(), 2);
+}
@@ -0,0 +1,53 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "blockchain/vote_tally.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using lean::countVotes;
+using lean::supermajorityThreshold;
+
+/**
+ * @given validator counts
+ * @when threshold is computed
+ * @then it is least count with `3 * votes >= 2 * validators`
+ */
+TEST(VoteTallyTest, SupermajorityThreshold) {
+  for (uint64_t validators = 0; validators < 100; ++validators) {
+    auto threshold = supermajorityThreshold(validators);
+    EXPECT_GE(3 * threshold, 2 * validators);
+    if (threshold != 0) {
+      EXPECT_LT(3 * (threshold - 1), 2 * validators);
+    }
+  }
+}
+
+/**
+ * @given random bits
+ * @when ranges of any offset and length are counted
+ * @then result matches counting bit by bit
+ */
+TEST(VoteTallyTest, CountVotes) {
+  std::mt19937 random{42};
+  std::vector<bool> bits(300);
+  for (auto &&bit : bits) {
+    bit = random() % 3 == 0;
+  }
+  const auto &cbits = bits;
+  for (size_t first = 0; first < 140; first += 7) {
+    for (size_t count = 0; first + count <= bits.size(); count += 13) {
+      auto begin = cbits.begin() + static_cast<ptrdiff_t>(first);
+      EXPECT_EQ(countVotes(begin, count),
+                std::count(begin, begin + static_cast<ptrdiff_t>(count), true))
+          << first << " " << count;
+    }
+  }
+}
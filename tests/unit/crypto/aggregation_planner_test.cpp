@@ -0,0 +1,57 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include "crypto/xmss/aggregation_planner.hpp"
+
+using lean::crypto::xmss::AggregationCostModel;
+using lean::crypto::xmss::AggregationPlan;
+
+/// Small groups are not worth splitting
+TEST(AggregationPlanTest, SmallGroupIsFlat) {
+  AggregationCostModel cost;
+  auto plan = AggregationPlan::make(
+      cost, AggregationPlan::kMinLeafSignatures, 0, 16);
+  EXPECT_TRUE(plan.flat());
+}
+
+/// Single thread can't prove leaves in parallel
+TEST(AggregationPlanTest, SingleThreadIsFlat) {
+  AggregationCostModel cost;
+  auto plan = AggregationPlan::make(cost, 1024, 0, 1);
+  EXPECT_TRUE(plan.flat());
+}
+
+/// Large group is split when signatures dominate proving time
+TEST(AggregationPlanTest, LargeGroupIsSplit) {
+  AggregationCostModel cost;
+  auto plan = AggregationPlan::make(cost, 1024, 0, 8);
+  EXPECT_FALSE(plan.flat());
+  EXPECT_LE(plan.leaves, 8);
+  EXPECT_LT(plan.seconds, cost.estimate(1024, 0));
+}
+
+/// Expensive merges keep aggregation flat
+TEST(AggregationPlanTest, ExpensiveMergeIsFlat) {
+  AggregationCostModel cost;
+  for (int i = 0; i < 100; ++i) {
+    cost.observe(0, 2, 10);
+    cost.observe(64, 0, 0.064);
+  }
+  auto plan = AggregationPlan::make(cost, 64, 0, 8);
+  EXPECT_TRUE(plan.flat());
+}
+
+/// Model converges to measured linear cost
+TEST(AggregationCostModelTest, LearnsSignatureCost) {
+  AggregationCostModel cost;
+  for (int i = 0; i < 1000; ++i) {
+    auto signatures = static_cast<size_t>(16 + i % 64);
+    cost.observe(signatures, 0, 0.1 + 0.01 * static_cast<double>(signatures));
+  }
+  EXPECT_NEAR(cost.estimate(100, 0), 1.1, 0.1);
+}
@@ -0,0 +1,40 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <array>
+
+#include "crypto/xmss/xmss_provider_fake.hpp"
+
+using lean::crypto::xmss::FakeCryptoPool;
+using namespace std::chrono_literals;
+
+const FakeCryptoPool::Clock::time_point kStart{};
+
+/// Jobs of batch run on free lanes in parallel
+TEST(FakeCryptoPoolTest, BatchRunsInParallel) {
+  FakeCryptoPool pool{4};
+  std::array<FakeCryptoPool::Clock::duration, 4> costs{1s, 1s, 1s, 1s};
+  EXPECT_EQ(pool.schedule(costs, kStart), kStart + 1s);
+}
+
+/// Jobs beyond lanes queue behind earlier ones
+TEST(FakeCryptoPoolTest, ExtraJobsQueue) {
+  FakeCryptoPool pool{2};
+  std::array<FakeCryptoPool::Clock::duration, 3> costs{1s, 1s, 1s};
+  EXPECT_EQ(pool.schedule(costs, kStart), kStart + 2s);
+}
+
+/// Concurrent callers share lanes
+TEST(FakeCryptoPoolTest, CallersShareLanes) {
+  FakeCryptoPool pool{1};
+  std::array<FakeCryptoPool::Clock::duration, 1> cost{1s};
+  EXPECT_EQ(pool.schedule(cost, kStart), kStart + 1s);
+  EXPECT_EQ(pool.schedule(cost, kStart), kStart + 2s);
+  // Idle lane starts job at once
+  EXPECT_EQ(pool.schedule(cost, kStart + 5s), kStart + 6s);
+}
@@ -0,0 +1,34 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "crypto/sha/sha256.hpp"
+
+#include <gtest/gtest.h>
+
+#include <qtils/byte_vec.hpp>
+
+using lean::Hash256;
+
+TEST(Sha256Test, PairsMatchSingleHashes) {
+  // Enough blocks for every multi-buffer lane width and remainder
+  for (size_t count : {1, 3, 4, 8, 17, 100}) {
+    qtils::ByteVec input(64 * count);
+    for (size_t i = 0; i < input.size(); ++i) {
+      input[i] = static_cast<uint8_t>(i * 7 + count);
+    }
+    std::vector<Hash256> output(count);
+    lean::crypto::sha256Pairs(output, input);
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_EQ(output[i],
+                lean::crypto::sha256(
+                    qtils::ByteView{input}.subspan(64 * i, 64)));
+    }
+  }
+}
+
+TEST(Sha256Test, PairsEmpty) {
+  lean::crypto::sha256Pairs({}, {});
+}
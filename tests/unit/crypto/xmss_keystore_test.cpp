@@ -0,0 +1,81 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "crypto/xmss/xmss_keystore.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+#include <qtils/test/outcome.hpp>
+
+#include "crypto/xmss/xmss_provider_impl.hpp"
+
+using lean::crypto::xmss::XmssKeypair;
+using lean::crypto::xmss::XmssKeystore;
+using lean::crypto::xmss::XmssKeystoreError;
+using lean::crypto::xmss::XmssMessage;
+using lean::crypto::xmss::XmssProviderImpl;
+using lean::crypto::xmss::XmssPublicKey;
+
+class XmssKeystoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = std::filesystem::temp_directory_path()
+          / ("xmss_keystore_test_" + std::to_string(::getpid()));
+  }
+
+  void TearDown() override {
+    std::filesystem::remove(path_);
+  }
+
+  std::filesystem::path path_;
+};
+
+/**
+ * @given keystore written from generated keypairs
+ * @when keys are loaded from it
+ * @then loaded private keys sign for their public keys
+ */
+TEST_F(XmssKeystoreTest, WriteLoad) {
+  XmssProviderImpl provider;
+  std::vector<XmssKeypair> keypairs{
+      provider.generateKeypair(0, 10),
+      provider.generateKeypair(0, 10),
+  };
+  ASSERT_OUTCOME_SUCCESS(XmssKeystore::write(path_, keypairs));
+  ASSERT_OUTCOME_SUCCESS(keystore, XmssKeystore::open(path_));
+
+  XmssMessage message{0x42};
+  for (auto &keypair : keypairs) {
+    EXPECT_TRUE(keystore->contains(keypair.public_key));
+    ASSERT_OUTCOME_SUCCESS(loaded, keystore->load(keypair.public_key));
+    EXPECT_EQ(loaded.public_key, keypair.public_key);
+    auto signature = provider.sign(loaded.private_key, 5, message);
+    EXPECT_TRUE(provider.verify(keypair.public_key, message, 5, signature));
+  }
+
+  XmssPublicKey unknown{};
+  EXPECT_FALSE(keystore->contains(unknown));
+  ASSERT_OUTCOME_ERROR(keystore->load(unknown),
+                       XmssKeystoreError::KeyNotFound);
+}
+
+/**
+ * @given file with keystore magic and key count larger than file
+ * @when it is opened
+ * @then it is rejected
+ */
+TEST_F(XmssKeystoreTest, BadFormat) {
+  {
+    std::ofstream file{path_, std::ios::binary};
+    file << "QLEANKS1" << std::string(8, '\xff');
+  }
+  ASSERT_OUTCOME_ERROR(XmssKeystore::open(path_),
+                       XmssKeystoreError::BadFormat);
+}
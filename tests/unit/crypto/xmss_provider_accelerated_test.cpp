@@ -0,0 +1,206 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "crypto/xmss/xmss_provider_accelerated.hpp"
+
+using namespace lean::crypto::xmss;
+
+/// Aggregated signatures with first byte 1 are valid
+class CpuXmssProvider : public XmssProvider {
+ public:
+  XmssKeypair generateKeypair(uint64_t, uint64_t) override {
+    return {};
+  }
+  XmssSignature sign(XmssPrivateKey, uint32_t, const XmssMessage &) override {
+    return {};
+  }
+  bool verify(const XmssPublicKey &,
+              const XmssMessage &,
+              uint32_t,
+              const XmssSignature &) override {
+    return true;
+  }
+  XmssAggregatedSignature aggregateSignatures(
+      std::span<const std::vector<XmssPublicKeyRef>>,
+      std::span<const XmssAggregatedSignature>,
+      std::span<const XmssPublicKeyRef>,
+      std::span<const XmssSignature>,
+      uint32_t,
+      const XmssMessage &) const override {
+    ++calls;
+    return {1};
+  }
+  bool verifyAggregatedSignatures(
+      std::span<const XmssPublicKeyRef>,
+      uint32_t,
+      const XmssMessage &,
+      XmssAggregatedSignatureIn aggregated_signature) const override {
+    ++calls;
+    return not aggregated_signature.empty() and aggregated_signature[0] == 1;
+  }
+
+  mutable std::atomic_size_t calls = 0;
+};
+
+/// Device of same rules as `CpuXmssProvider`, records batch sizes
+struct TestDevice {
+  static int verify(void *ctx,
+                    const QleanXmssVerifyJob *jobs,
+                    size_t count,
+                    uint8_t *results) {
+    auto &self = *static_cast<TestDevice *>(ctx);
+    self.record(count);
+    if (self.fail) {
+      return 1;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      auto &proof = jobs[i].proof;
+      results[i] = proof.size != 0 and proof.data[0] == 1;
+    }
+    return 0;
+  }
+
+  static int aggregate(void *ctx,
+                       const QleanXmssAggregateJob *jobs,
+                       size_t count,
+                       QleanXmssBytes *proofs) {
+    auto &self = *static_cast<TestDevice *>(ctx);
+    self.record(count);
+    for (size_t i = 0; i < count; ++i) {
+      auto *proof = new uint8_t[1]{static_cast<uint8_t>(jobs[i].count)};
+      proofs[i] = {proof, 1};
+    }
+    return 0;
+  }
+
+  static void freeProof(void *ctx, QleanXmssBytes proof) {
+    ++static_cast<TestDevice *>(ctx)->freed;
+    delete[] proof.data;
+  }
+
+  void record(size_t count) {
+    std::unique_lock lock{mutex};
+    batches.emplace_back(count);
+    if (batches.size() == 1 and hold_first) {
+      release.wait(lock, [&] { return released; });
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable release;
+  bool hold_first = false;
+  bool released = false;
+  bool fail = false;
+  std::vector<size_t> batches;
+  std::atomic_size_t freed = 0;
+  QleanXmssAccelerator api{
+      .abi_version = QLEAN_XMSS_ACCELERATOR_ABI,
+      .name = "test",
+      .public_key_size = PQ_PUBLIC_KEY_SIZE,
+      .signature_size = PQ_SIGNATURE_SIZE,
+      .message_size = PQ_MESSAGE_SIZE,
+      .ctx = this,
+      .verify = verify,
+      .aggregate = aggregate,
+      .free_proof = freeProof,
+  };
+};
+
+class XmssProviderAcceleratedTest : public ::testing::Test {
+ protected:
+  XmssVerifyItem item(const XmssAggregatedSignature &proof) {
+    return {.public_keys = {},
+            .epoch = 0,
+            .message = {},
+            .aggregated_signature = proof};
+  }
+
+  XmssAggregatedSignature valid_{1};
+  XmssAggregatedSignature invalid_{0};
+  std::shared_ptr<CpuXmssProvider> cpu_ = std::make_shared<CpuXmssProvider>();
+  TestDevice device_;
+};
+
+/// Items run on CPU without accelerator
+TEST_F(XmssProviderAcceleratedTest, NoAccelerator) {
+  XmssProviderAccelerated provider{cpu_, nullptr, nullptr};
+  std::vector items{item(valid_), item(invalid_)};
+  EXPECT_EQ(provider.verifyBatch(items), (std::vector{true, false}));
+  EXPECT_EQ(cpu_->calls, 2);
+}
+
+/// Device verifies and aggregates whole batch in single call
+TEST_F(XmssProviderAcceleratedTest, Device) {
+  XmssProviderAccelerated provider{
+      cpu_, std::make_shared<XmssAccelerator>(device_.api), nullptr};
+  std::vector items{item(valid_), item(invalid_), item(valid_)};
+  EXPECT_EQ(provider.verifyBatch(items), (std::vector{true, false, true}));
+  EXPECT_TRUE(provider.verifyAggregatedSignatures({}, 0, {}, valid_));
+
+  std::vector<XmssSignature> signatures(3);
+  std::vector<XmssPublicKey> keys(3);
+  std::vector<XmssPublicKeyRef> key_refs{&keys[0], &keys[1], &keys[2]};
+  auto proof =
+      provider.aggregateSignatures({}, {}, key_refs, signatures, 0, {});
+  EXPECT_EQ(proof, XmssAggregatedSignature{3});
+  EXPECT_EQ(device_.freed, 1);
+  EXPECT_EQ(device_.batches, (std::vector<size_t>{3, 1, 1}));
+  EXPECT_EQ(cpu_->calls, 0);
+}
+
+/// Items of failed device call run on CPU
+TEST_F(XmssProviderAcceleratedTest, Fallback) {
+  device_.fail = true;
+  XmssProviderAccelerated provider{
+      cpu_, std::make_shared<XmssAccelerator>(device_.api), nullptr};
+  std::vector items{item(valid_), item(invalid_)};
+  EXPECT_EQ(provider.verifyBatch(items), (std::vector{true, false}));
+  EXPECT_EQ(cpu_->calls, 2);
+}
+
+/// Callers queued while device is busy share next device call
+TEST_F(XmssProviderAcceleratedTest, BatchesCallers) {
+  device_.hold_first = true;
+  XmssProviderAccelerated provider{
+      cpu_, std::make_shared<XmssAccelerator>(device_.api), nullptr};
+  std::vector first{item(valid_)};
+  std::vector later{item(valid_), item(invalid_)};
+  auto busy = std::async(std::launch::async,
+                         [&] { return provider.verifyBatch(first); });
+  while (true) {
+    std::lock_guard lock{device_.mutex};
+    if (not device_.batches.empty()) {
+      break;
+    }
+  }
+  std::vector<std::future<std::vector<bool>>> queued;
+  for (size_t i = 0; i < 3; ++i) {
+    queued.emplace_back(std::async(
+        std::launch::async, [&] { return provider.verifyBatch(later); }));
+  }
+  // Callers can't be observed waiting in queue
+  std::this_thread::sleep_for(std::chrono::milliseconds{100});
+  {
+    std::lock_guard lock{device_.mutex};
+    device_.released = true;
+  }
+  device_.release.notify_all();
+  EXPECT_EQ(busy.get(), std::vector{true});
+  for (auto &result : queued) {
+    EXPECT_EQ(result.get(), (std::vector{true, false}));
+  }
+  EXPECT_EQ(device_.batches, (std::vector<size_t>{1, 6}));
+  EXPECT_EQ(cpu_->calls, 0);
+}
@@ -0,0 +1,114 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <thread>
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include "crypto/xmss/xmss_provider_async.hpp"
+#include "utils/worker_pool.hpp"
+
+using namespace lean::crypto::xmss;
+
+/// Verifies signatures with first byte 1, records verifying thread
+class TestXmssProvider : public XmssProvider {
+ public:
+  XmssKeypair generateKeypair(uint64_t, uint64_t) override {
+    return {};
+  }
+  XmssSignature sign(XmssPrivateKey, uint32_t, const XmssMessage &) override {
+    return {};
+  }
+  bool verify(const XmssPublicKey &,
+              const XmssMessage &,
+              uint32_t,
+              const XmssSignature &signature) override {
+    thread = std::this_thread::get_id();
+    if (signature[0] == 2) {
+      throw std::runtime_error{"invalid encoding"};
+    }
+    return signature[0] == 1;
+  }
+  XmssAggregatedSignature aggregateSignatures(
+      std::span<const std::vector<XmssPublicKeyRef>>,
+      std::span<const XmssAggregatedSignature>,
+      std::span<const XmssPublicKeyRef>,
+      std::span<const XmssSignature>,
+      uint32_t,
+      const XmssMessage &) const override {
+    return {};
+  }
+  bool verifyAggregatedSignatures(std::span<const XmssPublicKeyRef>,
+                                  uint32_t,
+                                  const XmssMessage &,
+                                  XmssAggregatedSignatureIn) const override {
+    return true;
+  }
+
+  std::atomic<std::thread::id> thread;
+};
+
+class XmssProviderAsyncTest : public ::testing::Test {
+ protected:
+  /// Run coroutine on io context of test thread
+  template <typename T>
+  T run(XmssProviderAsync::Coro<T> coro) {
+    std::optional<T> result;
+    std::exception_ptr error;
+    boost::asio::co_spawn(
+        io_context_,
+        [&]() -> XmssProviderAsync::Coro<void> {
+          try {
+            result.emplace(co_await std::move(coro));
+          } catch (...) {
+            error = std::current_exception();
+          }
+          EXPECT_EQ(std::this_thread::get_id(), test_thread_);
+        },
+        boost::asio::detached);
+    io_context_.restart();
+    io_context_.run();
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return std::move(result.value());
+  }
+
+  std::thread::id test_thread_ = std::this_thread::get_id();
+  boost::asio::io_context io_context_;
+  std::shared_ptr<TestXmssProvider> provider_ =
+      std::make_shared<TestXmssProvider>();
+  XmssProviderAsync async_{provider_, std::make_shared<lean::WorkerPool>(2)};
+};
+
+/// Work runs on pool, coroutine resumes on its own thread
+TEST_F(XmssProviderAsyncTest, VerifyOnPool) {
+  XmssSignature signature{};
+  signature[0] = 1;
+  EXPECT_EQ(run(async_.verify({}, {}, 0, signature)), true);
+  EXPECT_NE(provider_->thread.load(), test_thread_);
+  EXPECT_EQ(run(async_.verify({}, {}, 0, {})), false);
+}
+
+/// Cancelled work is skipped
+TEST_F(XmssProviderAsyncTest, Cancelled) {
+  auto cancel = std::make_shared<XmssCancel>();
+  cancel->cancel();
+  EXPECT_EQ(run(async_.verify({}, {}, 0, {}, cancel)), std::nullopt);
+  EXPECT_EQ(provider_->thread.load(), std::thread::id{});
+}
+
+/// Exception of provider is rethrown in coroutine
+TEST_F(XmssProviderAsyncTest, Exception) {
+  XmssSignature signature{};
+  signature[0] = 2;
+  EXPECT_THROW(run(async_.verify({}, {}, 0, signature)), std::runtime_error);
+}
@@ -86,10 +86,30 @@ TEST_F(XmssProviderTest, VerifyFailsWithWrongEpoch) {
   EXPECT_FALSE(result);
 }
 
+/**
+ * Public key parsed by earlier verification is reused, and doesn't affect
+ * results for other keys and signatures
+ */
+TEST_F(XmssProviderTest, VerifyReusesParsedPublicKey) {
+  auto signature = provider_->sign(keypair.private_key, epoch, message);
+  auto signature2 = provider_->sign(keypair2.private_key, epoch, message);
+
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_TRUE(
+        provider_->verify(keypair.public_key, message, epoch, signature));
+    EXPECT_TRUE(
+        provider_->verify(keypair2.public_key, message, epoch, signature2));
+    EXPECT_FALSE(
+        provider_->verify(keypair.public_key, message, epoch, signature2));
+    EXPECT_FALSE(provider_->verify(
+        keypair.public_key, wrong_message, epoch, signature));
+  }
+}
+
 TEST_F(XmssProviderTest, AggregateSignatures) {
-  std::vector<XmssPublicKey> public_keys{
-      keypair.public_key,
-      keypair2.public_key,
+  std::vector<XmssPublicKeyRef> public_keys{
+      &keypair.public_key,
+      &keypair2.public_key,
   };
   std::vector<XmssSignature> signatures{
       provider_->sign(keypair.private_key, epoch, message),
@@ -102,3 +122,57 @@ TEST_F(XmssProviderTest, AggregateSignatures) {
   EXPECT_FALSE(provider_->verifyAggregatedSignatures(
       public_keys, epoch, wrong_message, aggregated_signature));
 }
+
+/**
+ * @given aggregated signatures, valid ones mixed with ones checked against
+ * wrong message, epoch or public keys
+ * @when they are verified in one batch, and one by one
+ * @then each item has its own result, in order of items
+ */
+TEST_F(XmssProviderTest, VerifyBatchMixedResults) {
+  std::vector<XmssPublicKeyRef> public_keys{
+      &keypair.public_key,
+      &keypair2.public_key,
+  };
+  std::vector<XmssPublicKeyRef> wrong_public_keys{
+      &keypair2.public_key,
+      &keypair.public_key,
+  };
+  std::vector<XmssSignature> signatures{
+      provider_->sign(keypair.private_key, epoch, message),
+      provider_->sign(keypair2.private_key, epoch, message),
+  };
+  auto aggregated_signature = provider_->aggregateSignatures(
+      {}, {}, public_keys, signatures, epoch, message);
+  XmssVerifyItem valid{
+      .public_keys = public_keys,
+      .epoch = epoch,
+      .message = message,
+      .aggregated_signature = aggregated_signature,
+  };
+  auto with_wrong_message = valid;
+  with_wrong_message.message = wrong_message;
+  auto with_wrong_epoch = valid;
+  with_wrong_epoch.epoch = wrong_epoch;
+  auto with_wrong_public_keys = valid;
+  with_wrong_public_keys.public_keys = wrong_public_keys;
+
+  std::vector<XmssVerifyItem> items{
+      valid,
+      with_wrong_message,
+      valid,
+      with_wrong_epoch,
+      with_wrong_public_keys,
+  };
+  EXPECT_EQ(provider_->verifyBatch(items),
+            (std::vector<bool>{true, false, true, false, false}));
+  for (auto &item : items) {
+    EXPECT_EQ(provider_->verifyBatch(std::span{&item, 1}),
+              std::vector<bool>{provider_->verifyAggregatedSignatures(
+                  item.public_keys,
+                  item.epoch,
+                  item.message,
+                  item.aggregated_signature)});
+  }
+  EXPECT_TRUE(provider_->verifyBatch({}).empty());
+}
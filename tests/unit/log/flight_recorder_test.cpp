@@ -0,0 +1,82 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "log/flight_recorder.hpp"
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using lean::log::FlightEventKind;
+using lean::log::FlightRecorderError;
+
+class FlightRecorderTest : public testing::Test {
+ protected:
+  void TearDown() override {
+    lean::log::startFlightRecorder(0, {});
+  }
+};
+
+/**
+ * @given flight recorder disabled
+ * @when dumped
+ * @then error is returned
+ */
+TEST_F(FlightRecorderTest, Disabled) {
+  lean::log::startFlightRecorder(0, {});
+  lean::log::recordFlightEvent(FlightEventKind::INSTANT, "event");
+  EXPECT_EQ(lean::log::dumpFlightRecorder().error(),
+            FlightRecorderError::DISABLED);
+}
+
+/**
+ * @given flight recorder keeping 4 events per thread
+ * @when threads record more events
+ * @then dump decodes to last 4 events of each thread in order
+ */
+TEST_F(FlightRecorderTest, RoundTrip) {
+  lean::log::startFlightRecorder(4, {});
+  for (uint64_t i = 0; i < 10; ++i) {
+    lean::log::recordFlightEvent(FlightEventKind::INSTANT, "main", i);
+  }
+  std::thread{[] {
+    lean::log::FlightSpan span{"other", 7};
+  }}.join();
+
+  auto recording =
+      lean::log::decodeFlightRecording(lean::log::dumpFlightRecorder().value())
+          .value();
+  ASSERT_EQ(recording.threads.size(), 2);
+  auto &main = recording.threads[0].events;
+  ASSERT_EQ(main.size(), 4);
+  for (uint64_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(main[i].kind, FlightEventKind::INSTANT);
+    EXPECT_EQ(main[i].name, "main");
+    EXPECT_EQ(main[i].arg, 6 + i);
+  }
+  EXPECT_LE(main[0].time, main[3].time);
+  EXPECT_LE(main[3].time, recording.steady_time);
+  auto &other = recording.threads[1].events;
+  ASSERT_EQ(other.size(), 2);
+  EXPECT_EQ(other[0].kind, FlightEventKind::BEGIN);
+  EXPECT_EQ(other[1].kind, FlightEventKind::END);
+  EXPECT_EQ(other[1].name, "other");
+  EXPECT_EQ(other[1].arg, 7);
+}
+
+/**
+ * @given truncated dump
+ * @when decoded
+ * @then error is returned
+ */
+TEST_F(FlightRecorderTest, Truncated) {
+  lean::log::startFlightRecorder(4, {});
+  lean::log::recordFlightEvent(FlightEventKind::INSTANT, "event");
+  auto dump = lean::log::dumpFlightRecorder().value();
+  dump.pop_back();
+  EXPECT_EQ(lean::log::decodeFlightRecording(dump).error(),
+            FlightRecorderError::BAD_FILE);
+}
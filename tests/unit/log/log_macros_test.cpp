@@ -0,0 +1,56 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "log/logger.hpp"
+
+#include <gtest/gtest.h>
+
+#include "testutil/prepare_loggers.hpp"
+
+using lean::log::Level;
+
+class LogMacrosTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    std::ignore = logsys_->setLevelOfLogger("LogMacrosTest", Level::INFO);
+  }
+
+  int argument() {
+    ++evaluated_;
+    return evaluated_;
+  }
+
+  qtils::SharedRef<lean::log::LoggingSystem> logsys_ =
+      testutil::prepareLoggers();
+  lean::log::Logger logger_ = logsys_->getLogger("LogMacrosTest", "testing");
+  int evaluated_ = 0;
+};
+
+/**
+ * @given logger of INFO level
+ * @when messages of enabled and disabled levels are logged
+ * @then arguments are evaluated only for enabled levels
+ */
+TEST_F(LogMacrosTest, LazyArguments) {
+  SL_TRACE(logger_, "{}", argument());
+  SL_DEBUG(logger_, "{}", argument());
+  SL_DEBUG_LIMITED(logger_, "{}", argument());
+  EXPECT_EQ(evaluated_, 0);
+  SL_INFO(logger_, "{}", argument());
+  SL_INFO_LIMITED(logger_, "{}", argument());
+  EXPECT_EQ(evaluated_, 2);
+}
+
+/**
+ * @given logger of TRACE level
+ * @when TRACE message is logged
+ * @then arguments are evaluated only if TRACE is compiled in
+ */
+TEST_F(LogMacrosTest, MaxLevel) {
+  std::ignore = logsys_->setLevelOfLogger("LogMacrosTest", Level::TRACE);
+  SL_TRACE(logger_, "{}", argument());
+  EXPECT_EQ(evaluated_, lean::log::kMaxLevel >= Level::TRACE ? 1 : 0);
+}
@@ -0,0 +1,30 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "log/log_rate_limiter.hpp"
+
+#include <gtest/gtest.h>
+
+using lean::log::LogRateLimiter;
+using std::chrono_literals::operator""ms;
+
+/**
+ * @given rate limiter with burst of 2 messages per second
+ * @when messages come faster
+ * @then extra messages are suppressed until next window,
+ * and first message of next window reports number of suppressed
+ */
+TEST(LogRateLimiterTest, Burst) {
+  LogRateLimiter limiter{2, 1000ms};
+  LogRateLimiter::Clock::time_point now{};
+  EXPECT_EQ(limiter.acquire(now), 0);
+  EXPECT_EQ(limiter.acquire(now + 10ms), 0);
+  EXPECT_EQ(limiter.acquire(now + 20ms), std::nullopt);
+  EXPECT_EQ(limiter.acquire(now + 999ms), std::nullopt);
+  EXPECT_EQ(limiter.acquire(now + 1000ms), 2);
+  EXPECT_EQ(limiter.acquire(now + 1001ms), 0);
+  EXPECT_EQ(limiter.acquire(now + 1002ms), std::nullopt);
+}
@@ -0,0 +1,56 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include "metrics/histogram_buckets.hpp"
+
+using lean::metrics::parseHistogramBuckets;
+
+/**
+ * @given list of boundaries
+ * @when parsed
+ * @then boundaries are returned as is
+ */
+TEST(HistogramBucketsTest, List) {
+  EXPECT_EQ(parseHistogramBuckets("0.0005,0.001,1"),
+            (std::vector<double>{0.0005, 0.001, 1}));
+  EXPECT_EQ(parseHistogramBuckets("2"), (std::vector<double>{2}));
+}
+
+/**
+ * @given exponential and linear specs
+ * @when parsed
+ * @then boundaries are generated from start
+ */
+TEST(HistogramBucketsTest, Generated) {
+  EXPECT_EQ(parseHistogramBuckets("exp:0.0001:2:4"),
+            (std::vector<double>{0.0001, 0.0002, 0.0004, 0.0008}));
+  EXPECT_EQ(parseHistogramBuckets("lin:0:0.5:3"),
+            (std::vector<double>{0, 0.5, 1}));
+}
+
+/**
+ * @given malformed specs
+ * @when parsed
+ * @then nullopt is returned
+ */
+TEST(HistogramBucketsTest, Malformed) {
+  for (auto spec : {"",
+                    "1,,2",
+                    "2,1",
+                    "1,1",
+                    "1,x",
+                    "exp:1:1:4",
+                    "exp:0:2:4",
+                    "exp:1:2:0",
+                    "exp:1:2:100000",
+                    "lin:0:-1:3",
+                    "log:1:2:3",
+                    "exp:1:2"}) {
+    EXPECT_FALSE(parseHistogramBuckets(spec).has_value()) << spec;
+  }
+}
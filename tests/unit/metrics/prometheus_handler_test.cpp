@@ -0,0 +1,77 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <mock/app/configuration_mock.hpp>
+
+#include "metrics/impl/prometheus/handler_impl.hpp"
+#include "metrics/impl/prometheus/registry_impl.hpp"
+#include "metrics/metrics.hpp"
+#include "testutil/prepare_loggers.hpp"
+
+using lean::app::ConfigurationMock;
+using lean::metrics::PrometheusHandler;
+using lean::metrics::PrometheusRegistry;
+using MetricsConfig = lean::app::Configuration::MetricsConfig;
+using namespace testing;
+
+struct PrometheusHandlerTest : public Test {
+  /// Handler of registry with gauge `name`
+  std::shared_ptr<PrometheusHandler> handler(
+      std::chrono::milliseconds cache_ttl, const std::string &name) {
+    config.cache_ttl = cache_ttl;
+    EXPECT_CALL(*app_config, metrics()).WillRepeatedly(ReturnRef(config));
+    auto handler =
+        std::make_shared<PrometheusHandler>(testutil::prepareLoggers(),
+                                            app_config);
+    registry.setHandler(*handler);
+    registry.registerGaugeFamily(name, "Test gauge");
+    gauge = registry.registerGaugeMetric(name);
+    return handler;
+  }
+
+  MetricsConfig config;
+  std::shared_ptr<ConfigurationMock> app_config =
+      std::make_shared<ConfigurationMock>();
+  PrometheusRegistry registry;
+  lean::metrics::Gauge *gauge = nullptr;
+};
+
+/**
+ * @given handler without cache
+ * @when value of one family changes between scrapes
+ * @then each scrape has current values, text of unchanged families is same
+ */
+TEST_F(PrometheusHandlerTest, Uncached) {
+  auto handler =
+      this->handler(std::chrono::milliseconds{0}, "test_uncached_gauge");
+  registry.registerGaugeFamily("test_unchanged_gauge", "Unchanged gauge");
+  registry.registerGaugeMetric("test_unchanged_gauge")->set(7);
+  gauge->set(1);
+  auto first = handler->collect();
+  EXPECT_THAT(first, HasSubstr("test_uncached_gauge 1"));
+  EXPECT_THAT(first, HasSubstr("test_unchanged_gauge 7"));
+  gauge->set(2);
+  auto second = handler->collect();
+  EXPECT_THAT(second, HasSubstr("test_uncached_gauge 2"));
+  EXPECT_THAT(second, HasSubstr("test_unchanged_gauge 7"));
+  EXPECT_EQ(handler->collect(), second);
+}
+
+/**
+ * @given handler with cache
+ * @when value changes after scrape
+ * @then next scrape within ttl has previous text
+ */
+TEST_F(PrometheusHandlerTest, Cached) {
+  auto handler = this->handler(std::chrono::hours{1}, "test_cached_gauge");
+  gauge->set(1);
+  auto first = handler->collect();
+  EXPECT_THAT(first, HasSubstr("test_cached_gauge 1"));
+  gauge->set(2);
+  EXPECT_EQ(handler->collect(), first);
+}
@@ -0,0 +1,70 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "metrics/metrics.hpp"
+
+using lean::metrics::ShardedCounter;
+using lean::metrics::ShardedHistogram;
+
+/**
+ * @given sharded counter
+ * @when it is incremented from several threads
+ * @then value is sum of all increments
+ */
+TEST(ShardedMetricsTest, Counter) {
+  ShardedCounter counter;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i) {
+    threads.emplace_back([&] {
+      for (size_t j = 0; j < 1000; ++j) {
+        counter.inc();
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  counter.inc(0.5);
+  EXPECT_EQ(counter.value(), 4000.5);
+}
+
+/**
+ * @given sharded histogram
+ * @when values are observed
+ * @then each falls into first bucket with upper bound not less than it
+ */
+TEST(ShardedMetricsTest, Histogram) {
+  ShardedHistogram histogram{{1, 10}};
+  histogram.observe(0.5);
+  histogram.observe(1);
+  std::thread{[&] { histogram.observe(5); }}.join();
+  histogram.observe(100);
+
+  auto snapshot = histogram.collect();
+  EXPECT_EQ(snapshot.counts, (std::vector<uint64_t>{2, 1, 1}));
+  EXPECT_EQ(snapshot.sum, 106.5);
+}
+
+/**
+ * @given sharded histogram
+ * @when buckets are replaced before observations
+ * @then observations fall into new buckets
+ */
+TEST(ShardedMetricsTest, SetBucketBoundaries) {
+  ShardedHistogram histogram{{1, 10}};
+  histogram.setBucketBoundaries({0.001, 0.01});
+  EXPECT_EQ(histogram.bucketBoundaries(), (std::vector<double>{0.001, 0.01}));
+  histogram.observe(0.005);
+  histogram.observe(1);
+
+  auto snapshot = histogram.collect();
+  EXPECT_EQ(snapshot.counts, (std::vector<uint64_t>{0, 1, 1}));
+}
@@ -0,0 +1,109 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "modules/networking/gossip_filter.hpp"
+
+#include <initializer_list>
+
+#include <gtest/gtest.h>
+#include <qtils/byte_vec.hpp>
+
+using lean::SignedAggregatedAttestation;
+using lean::ValidatorIndex;
+using lean::modules::GossipFilter;
+using Verdict = GossipFilter::Verdict;
+
+SignedAggregatedAttestation makeAggregation(
+    std::initializer_list<ValidatorIndex> participants, uint8_t proof = 0) {
+  SignedAggregatedAttestation aggregation;
+  aggregation.data.slot = 1;
+  aggregation.data.head.slot = 1;
+  aggregation.data.target.slot = 1;
+  for (auto validator : participants) {
+    aggregation.proof.participants.add(validator);
+  }
+  aggregation.proof.proof_data = qtils::ByteVec{proof};
+  return aggregation;
+}
+
+/**
+ * @given aggregation of participants accepted by fork choice
+ * @when it or aggregation of its subset is checked
+ * @then they are duplicates
+ */
+TEST(GossipFilterTest, AcceptedAggregationIsSeen) {
+  GossipFilter filter{1};
+  auto aggregation = makeAggregation({0, 1, 2});
+  EXPECT_EQ(filter.check(aggregation, 0), Verdict::Accept);
+  filter.markSeen(aggregation);
+  EXPECT_EQ(filter.check(aggregation, 0), Verdict::Duplicate);
+  EXPECT_EQ(filter.check(makeAggregation({0, 1}), 0), Verdict::Duplicate);
+  EXPECT_EQ(filter.check(makeAggregation({0, 3}), 0), Verdict::Accept);
+}
+
+/**
+ * @given forged aggregation claiming superset of participants, rejected by
+ * fork choice, so not marked seen
+ * @when valid aggregations of its participants are checked
+ * @then they are accepted
+ */
+TEST(GossipFilterTest, RejectedAggregationIsNotSeen) {
+  GossipFilter filter{1};
+  auto forged = makeAggregation({0, 1, 2});
+  ASSERT_EQ(filter.check(forged, 0), Verdict::Accept);
+  ASSERT_TRUE(filter.beginVerification(forged));
+  EXPECT_TRUE(filter.endVerification(forged).empty());
+  EXPECT_EQ(filter.check(makeAggregation({0, 1}), 0), Verdict::Accept);
+  EXPECT_EQ(filter.check(makeAggregation({0, 1, 2}, 1), 0), Verdict::Accept);
+}
+
+/**
+ * @given aggregation being verified
+ * @when copies with same participants arrive
+ * @then they wait for it, and are returned when its verification ends
+ */
+TEST(GossipFilterTest, CopiesWaitForVerification) {
+  GossipFilter filter{1};
+  auto first = makeAggregation({0, 1}, 1);
+  auto copy = makeAggregation({0, 1}, 2);
+  ASSERT_TRUE(filter.beginVerification(first));
+  EXPECT_FALSE(filter.beginVerification(copy));
+  EXPECT_FALSE(filter.beginVerification(copy));
+  // Other participants are verified independently
+  EXPECT_TRUE(filter.beginVerification(makeAggregation({0, 2})));
+
+  // First copy valid, waiting copies are duplicates
+  filter.markSeen(first);
+  auto copies = filter.endVerification(first);
+  ASSERT_EQ(copies.size(), 2);
+  EXPECT_EQ(copies.front(), copy);
+  EXPECT_EQ(filter.check(copies.front(), 0), Verdict::Duplicate);
+  // Verification is over, next copy is verified again
+  EXPECT_TRUE(filter.beginVerification(copy));
+}
+
+/**
+ * @given forged first copy of aggregation, with valid copy waiting for it
+ * @when forged copy fails verification
+ * @then waiting copy is returned for verification and is not duplicate,
+ * then it is verified instead of waiting
+ */
+TEST(GossipFilterTest, CopiesReplayedOnFailure) {
+  GossipFilter filter{1};
+  auto forged = makeAggregation({0, 1}, 1);
+  auto valid = makeAggregation({0, 1}, 2);
+  ASSERT_TRUE(filter.beginVerification(forged));
+  ASSERT_FALSE(filter.beginVerification(valid));
+
+  auto copies = filter.endVerification(forged);
+  ASSERT_EQ(copies.size(), 1);
+  EXPECT_EQ(copies.front(), valid);
+  EXPECT_EQ(filter.check(copies.front(), 0), Verdict::Accept);
+  EXPECT_TRUE(filter.beginVerification(copies.front()));
+  filter.markSeen(copies.front());
+  EXPECT_TRUE(filter.endVerification(copies.front()).empty());
+  EXPECT_EQ(filter.check(forged, 0), Verdict::Duplicate);
+}
@@ -0,0 +1,119 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "modules/networking/peer_exchange.hpp"
+
+#include <gtest/gtest.h>
+
+#include "modules/networking/ssz_snappy.hpp"
+
+using lean::MAX_PEER_EXCHANGE_PEERS;
+using lean::PeerAdvert;
+using lean::PeerExchangeCandidate;
+using lean::PeerExchangeRequest;
+using lean::PeerExchangeResponse;
+using lean::rankPeerAdverts;
+using lean::SubnetBits;
+
+PeerExchangeCandidate makeCandidate(uint8_t id,
+                                    SubnetBits subnets,
+                                    bool is_aggregator = false,
+                                    bool connected = false) {
+  PeerExchangeCandidate candidate{
+      .advert = {.subnets = subnets, .is_aggregator = is_aggregator},
+      .connected = connected,
+  };
+  candidate.advert.peer_id.push_back(id);
+  return candidate;
+}
+
+std::vector<uint8_t> advertIds(const std::vector<PeerAdvert> &adverts) {
+  std::vector<uint8_t> ids;
+  for (auto &advert : adverts) {
+    ids.emplace_back(advert.peer_id.data().at(0));
+  }
+  return ids;
+}
+
+/**
+ * @given peers on other subnets, connected, aggregators and on requested
+ * subnets
+ * @when response is ranked
+ * @then peers on requested subnets come first, then aggregators, then
+ * connected ones
+ */
+TEST(PeerExchangeTest, RankBySubnetsRoleAndConnection) {
+  std::vector<PeerExchangeCandidate> candidates{
+      makeCandidate(1, 0b10),
+      makeCandidate(2, 0b10, false, true),
+      makeCandidate(3, 0b10, true),
+      makeCandidate(4, 0b01),
+      makeCandidate(5, 0b11, true),
+  };
+  auto adverts = rankPeerAdverts(
+      std::move(candidates),
+      PeerExchangeRequest{.subnets = 0b01, .count = MAX_PEER_EXCHANGE_PEERS});
+  EXPECT_EQ(advertIds(adverts), (std::vector<uint8_t>{5, 4, 3, 2, 1}));
+}
+
+/**
+ * @given more candidates than requested and than protocol allows
+ * @when response is ranked
+ * @then only best requested count, bounded by protocol, are advertised
+ */
+TEST(PeerExchangeTest, RankLimitsCount) {
+  std::vector<PeerExchangeCandidate> candidates;
+  for (uint8_t i = 0; i < 2 * MAX_PEER_EXCHANGE_PEERS; ++i) {
+    candidates.emplace_back(makeCandidate(i, i == 7 ? 0b01 : 0b10));
+  }
+  auto adverts = rankPeerAdverts(candidates,
+                                 PeerExchangeRequest{
+                                     .subnets = 0b01,
+                                     .count = 2,
+                                 });
+  ASSERT_EQ(adverts.size(), 2);
+  EXPECT_EQ(adverts.front().peer_id.data().at(0), 7);
+
+  adverts = rankPeerAdverts(std::move(candidates),
+                            PeerExchangeRequest{.subnets = 0b01, .count = 100});
+  EXPECT_EQ(adverts.size(), MAX_PEER_EXCHANGE_PEERS);
+}
+
+/**
+ * @given largest response protocol allows, with longest peer ids and
+ * addresses
+ * @when it is encoded as protocol sends it
+ * @then it decodes within decode budget of protocol
+ */
+TEST(PeerExchangeTest, LargestResponseFitsDecodeBudget) {
+  PeerExchangeResponse response;
+  for (size_t i = 0; i <= MAX_PEER_EXCHANGE_PEERS; ++i) {
+    PeerAdvert advert{.subnets = i, .is_aggregator = i % 2 == 0};
+    advert.peer_id.data().assign(64, static_cast<uint8_t>(i));
+    advert.address.data().assign(256, static_cast<uint8_t>(i));
+    response.peers.push_back(std::move(advert));
+  }
+  auto framed = lean::encodeSszSnappyFramed(response);
+  auto decoded = lean::decodeSszSnappyFramed<PeerExchangeResponse>(framed);
+  ASSERT_TRUE(decoded.has_value()) << decoded.error();
+  ASSERT_EQ(decoded.value().peers.size(), MAX_PEER_EXCHANGE_PEERS + 1);
+  EXPECT_EQ(decoded.value().peers.data().back().address.data(),
+            response.peers.data().back().address.data());
+}
+
+/**
+ * @given peer exchange request
+ * @when it is encoded as protocol sends it
+ * @then it decodes within decode budget of protocol
+ */
+TEST(PeerExchangeTest, RequestRoundTrip) {
+  PeerExchangeRequest request{.subnets = 0b101, .count = 3};
+  auto framed = lean::encodeSszSnappyFramed(request);
+  auto decoded = lean::decodeSszSnappyFramed<PeerExchangeRequest>(framed);
+  ASSERT_TRUE(decoded.has_value()) << decoded.error();
+  EXPECT_EQ(decoded.value().subnets, request.subnets);
+  EXPECT_EQ(decoded.value().count, request.count);
+}
@@ -0,0 +1,197 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "types/aggregation_bits.hpp"
+
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "serde/serialization.hpp"
+
+using lean::AggregationBits;
+using lean::ValidatorIndex;
+using Indices = std::vector<ValidatorIndex>;
+
+/// Bitlist of `size` bits, written directly like decoded one
+AggregationBits makeBits(size_t size, const Indices &indices) {
+  AggregationBits bits;
+  bits.bits.data().assign(size, false);
+  for (auto i : indices) {
+    bits.bits.data().at(i) = true;
+  }
+  return bits;
+}
+
+/// Set bits by iterator of packed copy
+Indices iterated(const AggregationBits &bits) {
+  Indices indices;
+  for (auto i : bits.iter()) {
+    indices.emplace_back(i);
+  }
+  return indices;
+}
+
+/// Set bits by plain scan of `bits`
+Indices scanned(const AggregationBits &bits) {
+  Indices indices;
+  for (size_t i = 0; i < bits.bits.size(); ++i) {
+    if (bits.bits.data()[i]) {
+      indices.emplace_back(i);
+    }
+  }
+  return indices;
+}
+
+/**
+ * @given bitlists with lengths around word boundaries
+ * @when set bits are iterated and counted
+ * @then bits of partial last word are found, and nothing past length
+ */
+TEST(AggregationBitsTest, LengthNotMultipleOfWord) {
+  for (size_t size : {1, 2, 63, 64, 65, 127, 128, 129, 200}) {
+    Indices indices{0};
+    if (size > 64) {
+      indices.emplace_back(63);
+      indices.emplace_back(64);
+    }
+    if (indices.back() != size - 1) {
+      indices.emplace_back(size - 1);
+    }
+    auto bits = makeBits(size, indices);
+    EXPECT_EQ(iterated(bits), indices) << "size " << size;
+    EXPECT_EQ(bits.count(), indices.size()) << "size " << size;
+    EXPECT_TRUE(bits.contains(size - 1)) << "size " << size;
+    EXPECT_FALSE(bits.contains(size)) << "size " << size;
+  }
+  EXPECT_EQ(iterated(makeBits(65, {})), Indices{});
+  EXPECT_EQ(makeBits(0, {}).count(), 0);
+}
+
+/**
+ * @given bitlist with packed copy already built
+ * @when `bits` are resized directly, then changed through methods
+ * @then packed copy follows new length
+ */
+TEST(AggregationBitsTest, ResizeAfterPackedCopyBuilt) {
+  auto bits = makeBits(70, {3, 69});
+  EXPECT_EQ(bits.count(), 2);
+
+  bits.bits.data().resize(200);
+  bits.bits.data()[150] = true;
+  EXPECT_EQ(bits.count(), 3);
+  EXPECT_EQ(iterated(bits), (Indices{3, 69, 150}));
+
+  bits.bits.data().resize(64);
+  EXPECT_EQ(iterated(bits), Indices{3});
+  EXPECT_EQ(bits.count(), 1);
+
+  bits.add(100);
+  EXPECT_EQ(bits.bits.size(), 101);
+  EXPECT_EQ(iterated(bits), (Indices{3, 100}));
+  EXPECT_EQ(iterated(bits), scanned(bits));
+
+  bits.add(5);
+  EXPECT_EQ(bits.bits.size(), 101);
+  EXPECT_EQ(iterated(bits), (Indices{3, 5, 100}));
+}
+
+/**
+ * @given bitlist with packed copy built
+ * @when it is encoded and decoded
+ * @then decoded packed copy has same bits
+ */
+TEST(AggregationBitsTest, DecodeRebuildsPackedCopy) {
+  auto bits = makeBits(130, {0, 64, 129});
+  EXPECT_EQ(bits.count(), 3);
+  auto decoded =
+      lean::decode<AggregationBits>(lean::encode(bits).value()).value();
+  EXPECT_EQ(decoded, bits);
+  EXPECT_EQ(iterated(decoded), (Indices{0, 64, 129}));
+  EXPECT_TRUE(decoded.isSubsetOf(bits));
+  EXPECT_TRUE(bits.isSubsetOf(decoded));
+}
+
+/**
+ * @given bitlists of different lengths
+ * @when compared and merged
+ * @then missing words of shorter one are zero, and union has bits of both
+ */
+TEST(AggregationBitsTest, SubsetAndUnionOfDifferentLengths) {
+  auto a = makeBits(66, {1, 65});
+  auto b = makeBits(131, {1, 65, 130});
+  // Longer, but with no bits past shorter ones
+  auto c = makeBits(200, {1});
+
+  EXPECT_TRUE(a.isSubsetOf(b));
+  EXPECT_FALSE(b.isSubsetOf(a));
+  EXPECT_TRUE(c.isSubsetOf(a));
+  EXPECT_TRUE(c.isSubsetOf(b));
+  EXPECT_FALSE(a.isSubsetOf(c));
+  EXPECT_EQ(b.countNotIn(a), 1);
+  EXPECT_EQ(a.countNotIn(b), 0);
+  EXPECT_EQ(a.countNotIn(c), 1);
+  EXPECT_TRUE(c.intersects(b));
+  EXPECT_FALSE(makeBits(66, {65}).intersects(c));
+
+  auto merged = a;
+  merged.unionWith(b);
+  EXPECT_EQ(iterated(merged), (Indices{1, 65, 130}));
+  EXPECT_EQ(merged.bits.size(), 131);
+  EXPECT_TRUE(b.isSubsetOf(merged));
+
+  merged = b;
+  merged.unionWith(a);
+  EXPECT_EQ(merged, b);
+
+  auto d = makeBits(1, {0});
+  d.unionWith(c);
+  EXPECT_EQ(iterated(d), (Indices{0, 1}));
+  EXPECT_TRUE(c.isSubsetOf(d));
+  EXPECT_EQ(d.count(), 2);
+}
+
+/**
+ * @given random bitlists of random lengths
+ * @when compared and merged
+ * @then results match plain bit by bit checks
+ */
+TEST(AggregationBitsTest, MatchesPlainBits) {
+  std::mt19937 random{8};
+  auto random_bits = [&] {
+    auto size = std::uniform_int_distribution<size_t>{0, 300}(random);
+    AggregationBits bits;
+    bits.bits.data().resize(size);
+    for (size_t i = 0; i < size; ++i) {
+      bits.bits.data()[i] = random() % 8 == 0;
+    }
+    return bits;
+  };
+  for (size_t round = 0; round < 200; ++round) {
+    auto lhs = random_bits();
+    auto rhs = random_bits();
+    size_t not_in = 0;
+    auto shared = false;
+    for (auto i : scanned(lhs)) {
+      not_in += rhs.contains(i) ? 0 : 1;
+      shared = shared or rhs.contains(i);
+    }
+    EXPECT_EQ(iterated(lhs), scanned(lhs));
+    EXPECT_EQ(lhs.count(), scanned(lhs).size());
+    EXPECT_EQ(lhs.countNotIn(rhs), not_in);
+    EXPECT_EQ(lhs.isSubsetOf(rhs), not_in == 0);
+    EXPECT_EQ(lhs.intersects(rhs), shared);
+
+    auto merged = lhs;
+    merged.unionWith(rhs);
+    for (size_t i = 0; i < std::max(lhs.bits.size(), rhs.bits.size()); ++i) {
+      EXPECT_EQ(merged.contains(i), lhs.contains(i) or rhs.contains(i));
+    }
+    EXPECT_EQ(iterated(merged), scanned(merged));
+    EXPECT_TRUE(lhs.isSubsetOf(merged));
+    EXPECT_TRUE(rhs.isSubsetOf(merged));
+  }
+}
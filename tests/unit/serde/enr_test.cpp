@@ -55,6 +55,28 @@ TEST(EnrTest, EncodeDecodeRoundTrip) {
   EXPECT_EQ(info.id, enr.peerId());
 }
 
+/// Attestation subnets are advertised by `attnets`, absent unless given
+TEST(EnrTest, Attnets) {
+  lean::SamplePeer peer{0, true, false};
+
+  ASSERT_OUTCOME_SUCCESS(
+      plain,
+      lean::enr::encode(
+          peer.keypair, peer.enr_ip, peer.port, peer.is_aggregator));
+  ASSERT_OUTCOME_SUCCESS(plain_enr, lean::enr::decode(plain));
+  EXPECT_EQ(plain_enr.attnets, std::nullopt);
+
+  lean::enr::Attnets attnets = (1 << 0) | (uint64_t{1} << 63);
+  ASSERT_OUTCOME_SUCCESS(
+      encoded,
+      lean::enr::encode(
+          peer.keypair, peer.enr_ip, peer.port, peer.is_aggregator, attnets));
+  ASSERT_OUTCOME_SUCCESS(enr, lean::enr::decode(encoded));
+  EXPECT_EQ(enr.attnets, attnets);
+  EXPECT_TRUE(enr.isAggregator());
+  EXPECT_EQ(enr.peerId(), plain_enr.peerId());
+}
+
 TEST(EnrTest, DeterministicEncoding) {
   lean::SamplePeer peer{0, false, false};
   lean::SamplePeer peer2{1, false, false};
@@ -0,0 +1,77 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "serde/json_writer.hpp"
+
+#include <gtest/gtest.h>
+
+using lean::json::encodeInto;
+using lean::json::NameCase;
+
+struct Inner {
+  qtils::ByteArr<4> root;
+  uint64_t slot_number;
+
+  JSON_FIELDS(root, slot_number);
+};
+
+struct Outer {
+  std::vector<Inner> nodes;
+  std::string name;
+  int64_t delta;
+  bool ok;
+
+  JSON_FIELDS(nodes, name, delta, ok);
+};
+
+Outer testOuter() {
+  Inner first{.slot_number = 7};
+  first.root[1] = 0x1f;
+  first.root[2] = 0xa0;
+  first.root[3] = 0xff;
+  return {
+      .nodes = {first, {.slot_number = 18446744073709551615u}},
+      .name = "a\"b\\c\n\x01",
+      .delta = -42,
+      .ok = true,
+  };
+}
+
+/**
+ * @given object with nested objects, array, bytes and escaped string
+ * @when streamed
+ * @then text matches compact document writer
+ */
+TEST(JsonWriterTest, Snake) {
+  std::string out;
+  encodeInto(NameCase::SNAKE, testOuter(), out);
+  EXPECT_EQ(out,
+            R"({"nodes":[{"root":"0x001fa0ff","slot_number":7},)"
+            R"({"root":"0x00000000","slot_number":18446744073709551615}],)"
+            R"("name":"a\"b\\c\n\u0001","delta":-42,"ok":true})");
+}
+
+/**
+ * @given object
+ * @when streamed with camel case into non empty buffer
+ * @then camel names are appended after existing text
+ */
+TEST(JsonWriterTest, CamelAppends) {
+  std::string out = "x";
+  encodeInto(NameCase::CAMEL, Inner{.slot_number = 1}, out);
+  EXPECT_EQ(out, R"(x{"root":"0x00000000","slotNumber":1})");
+}
+
+/**
+ * @given empty vector
+ * @when streamed
+ * @then empty array
+ */
+TEST(JsonWriterTest, EmptyArray) {
+  std::string out;
+  encodeInto(NameCase::SNAKE, std::vector<uint32_t>{}, out);
+  EXPECT_EQ(out, "[]");
+}
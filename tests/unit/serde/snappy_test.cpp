@@ -6,6 +6,8 @@
 
 #include "serde/snappy.hpp"
 
+#include <algorithm>
+
 #include <gtest/gtest.h>
 
 TEST(SnappyTest, Framed) {
@@ -20,3 +22,82 @@ TEST(SnappyTest, Framed) {
   auto uncompressed2 = lean::snappy::uncompressFramed(compressed2).value();
   EXPECT_EQ(uncompressed2, uncompressed);
 }
+
+TEST(SnappyTest, UncompressIntoReusesBuffer) {
+  qtils::ByteVec large(1000, 1);
+  qtils::ByteVec small(10, 2);
+  qtils::ByteVec buffer;
+  ASSERT_TRUE(lean::snappy::uncompressInto(lean::snappy::compress(large),
+                                           buffer));
+  EXPECT_EQ(buffer, large);
+  auto data = buffer.data();
+  ASSERT_TRUE(lean::snappy::uncompressInto(lean::snappy::compress(small),
+                                           buffer));
+  EXPECT_EQ(buffer, small);
+  EXPECT_EQ(buffer.data(), data);
+  EXPECT_FALSE(lean::snappy::uncompressInto(small, buffer));
+}
+
+TEST(SnappyTest, CompressAppendKeepsPrefix) {
+  qtils::ByteVec input(1000, 3);
+  qtils::ByteVec out{1, 2};
+  lean::snappy::compressAppend(input, out);
+  EXPECT_EQ(out[0], 1);
+  EXPECT_EQ(out[1], 2);
+  EXPECT_EQ(lean::snappy::uncompress(std::span{out}.subspan(2)).value(),
+            input);
+}
+
+TEST(SnappyTest, FramedMultipleChunks) {
+  qtils::ByteVec input(3 * lean::snappy::kMaxBlockSize + 5);
+  for (size_t i = 0; i < input.size(); ++i) {
+    input[i] = static_cast<uint8_t>(i * i);
+  }
+  auto compressed = lean::snappy::compressFramed(input);
+  EXPECT_LE(compressed.size(),
+            lean::snappy::maxCompressedFramedLength(input.size()));
+  EXPECT_EQ(lean::snappy::uncompressFramed(compressed).value(), input);
+}
+
+TEST(SnappyTest, UncompressFrameAppendKeepsPrefix) {
+  qtils::ByteVec input(1000, 4);
+  qtils::ByteVec frame;
+  lean::snappy::appendCompressedFrame(input, frame);
+  auto content = std::span{frame}.subspan(lean::snappy::kHeaderSize);
+  qtils::ByteVec out{1, 2};
+  ASSERT_TRUE(lean::snappy::uncompressFrameAppend(
+      lean::snappy::ChunkType::Compressed, content, out, input.size()));
+  EXPECT_EQ(out.size(), 2 + input.size());
+  EXPECT_EQ(out[0], 1);
+  EXPECT_EQ(out[1], 2);
+  EXPECT_TRUE(std::equal(input.begin(), input.end(), out.begin() + 2));
+
+  qtils::ByteVec limited;
+  auto res =
+      lean::snappy::uncompressFrameAppend(lean::snappy::ChunkType::Compressed,
+                                          content,
+                                          limited,
+                                          input.size() - 1);
+  ASSERT_FALSE(res);
+  EXPECT_EQ(res.error(), lean::snappy::SnappyError::UNCOMPRESS_TOO_LONG);
+}
+
+/// Declared length beyond what input can expand to is rejected unallocated
+TEST(SnappyTest, UncompressRejectsForgedLength) {
+  qtils::ByteVec compressed = lean::snappy::compress(qtils::ByteVec(300, 5));
+  auto max = lean::snappy::maxUncompressedLength(compressed.size());
+  EXPECT_GE(max, 300);
+
+  // Varint length header of 1 MiB before same content
+  qtils::ByteVec forged{0x80, 0x80, 0x40};
+  forged.insert(forged.end(), compressed.begin() + 2, compressed.end());
+  qtils::ByteVec buffer;
+  auto res = lean::snappy::uncompressInto(forged, buffer);
+  ASSERT_FALSE(res);
+  EXPECT_EQ(res.error(), lean::snappy::SnappyError::UNCOMPRESS_INVALID);
+  EXPECT_EQ(buffer.capacity(), 0);
+
+  res = lean::snappy::uncompressInto(compressed, buffer, 299);
+  ASSERT_FALSE(res);
+  EXPECT_EQ(res.error(), lean::snappy::SnappyError::UNCOMPRESS_TOO_LONG);
+}
@@ -0,0 +1,92 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "serde/serialization.hpp"
+
+#include <gtest/gtest.h>
+
+#include "types/attestation.hpp"
+#include "types/signed_attestation.hpp"
+
+using lean::Attestation;
+using lean::AttestationData;
+using lean::Checkpoint;
+using lean::SszPacked;
+
+static_assert(SszPacked<Checkpoint>);
+static_assert(SszPacked<AttestationData>);
+static_assert(SszPacked<Attestation>);
+
+Checkpoint testCheckpoint(uint8_t i) {
+  Checkpoint checkpoint{.slot = 100u + i};
+  checkpoint.root[0] = i;
+  checkpoint.root[31] = ~i;
+  return checkpoint;
+}
+
+Attestation testAttestation() {
+  return {
+      .validator_id = 0x0102030405060708,
+      .data =
+          {
+              .slot = 9,
+              .head = testCheckpoint(1),
+              .target = testCheckpoint(2),
+              .source = testCheckpoint(3),
+          },
+  };
+}
+
+/// Encoding of generic sszpp serializer
+template <typename T>
+qtils::ByteVec sszppEncode(const T &v) {
+  qtils::ByteVec out(ssz::size(v));
+  ssz::serialize(reinterpret_cast<std::byte *>(out.data()), v);
+  return out;
+}
+
+/**
+ * @given packed containers
+ * @when encoded by single copy
+ * @then encoding matches generic ssz one
+ */
+TEST(SszPackedTest, EncodeMatchesSszpp) {
+  auto attestation = testAttestation();
+  EXPECT_EQ(lean::encode(attestation).value(), sszppEncode(attestation));
+  EXPECT_EQ(lean::encode(attestation.data).value(),
+            sszppEncode(attestation.data));
+  EXPECT_EQ(lean::encode(attestation.data.head).value(),
+            sszppEncode(attestation.data.head));
+}
+
+/**
+ * @given generic ssz encoding
+ * @when decoded by single copy
+ * @then value is restored, and wrong size is rejected
+ */
+TEST(SszPackedTest, Decode) {
+  auto attestation = testAttestation();
+  auto encoded = sszppEncode(attestation);
+  EXPECT_EQ(lean::decode<Attestation>(encoded).value(), attestation);
+  encoded.pop_back();
+  EXPECT_FALSE(lean::decode<Attestation>(encoded).has_value());
+}
+
+/**
+ * @given signed attestation, packed or not depending on signature size
+ * @when encoded and decoded
+ * @then it matches generic ssz encoding either way
+ */
+TEST(SszPackedTest, SignedAttestation) {
+  auto attestation = testAttestation();
+  auto signed_attestation = lean::SignedAttestation::from(attestation, {});
+  signed_attestation.signature[0] = 0x42;
+  auto encoded = lean::encode(signed_attestation).value();
+  EXPECT_EQ(encoded, sszppEncode(signed_attestation));
+  auto decoded = lean::decode<lean::SignedAttestation>(encoded).value();
+  EXPECT_EQ(decoded.data, attestation.data);
+  EXPECT_EQ(decoded.signature, signed_attestation.signature);
+}
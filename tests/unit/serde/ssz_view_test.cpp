@@ -0,0 +1,109 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "serde/ssz_view.hpp"
+
+#include <gtest/gtest.h>
+
+#include "types/block_view.hpp"
+#include "types/state_view.hpp"
+
+using lean::Block;
+using lean::BlockHash;
+using lean::BlockView;
+using lean::SignedBlock;
+using lean::SignedBlockView;
+using lean::State;
+using lean::StateView;
+
+BlockHash testHash(uint8_t i) {
+  BlockHash hash;
+  hash[0] = i;
+  return hash;
+}
+
+Block makeBlock() {
+  Block block;
+  block.slot = 7;
+  block.proposer_index = 2;
+  block.parent_root = testHash(1);
+  block.state_root = testHash(2);
+  return block;
+}
+
+/**
+ * @given encoded signed block
+ * @when view is made
+ * @then block fields are read without decoding, and match block
+ */
+TEST(SszViewTest, SignedBlock) {
+  SignedBlock signed_block;
+  signed_block.block = makeBlock();
+  auto bytes = lean::encode(signed_block).value();
+
+  auto view = SignedBlockView::make(bytes).value();
+  const auto &block = view.block();
+  EXPECT_EQ(block.slot(), 7);
+  EXPECT_EQ(block.proposerIndex(), 2);
+  EXPECT_EQ(block.parentRoot(), testHash(1));
+  EXPECT_EQ(block.stateRoot(), testHash(2));
+  auto body = block.body().value();
+  EXPECT_EQ(body, signed_block.block.body);
+  auto decoded = view.decode().value();
+  EXPECT_EQ(decoded, signed_block);
+}
+
+/**
+ * @given encoded block
+ * @when bytes are truncated, or offset of body is wrong
+ * @then view is not made
+ */
+TEST(SszViewTest, Malformed) {
+  auto bytes = lean::encode(makeBlock()).value();
+  EXPECT_TRUE(BlockView::make(bytes));
+
+  EXPECT_FALSE(BlockView::make(qtils::BytesIn{bytes}.first(20)));
+
+  // Body offset follows slot, proposer index and two roots
+  auto bad_offset = bytes;
+  ++bad_offset[8 + 8 + 32 + 32];
+  EXPECT_FALSE(BlockView::make(bad_offset));
+}
+
+/**
+ * @given encoded state with lists
+ * @when view is made
+ * @then header fields and list elements match state
+ */
+TEST(SszViewTest, State) {
+  State state;
+  state.config.genesis_time = 5;
+  state.slot = 3;
+  state.latest_block_header.slot = 2;
+  state.latest_justified.slot = 1;
+  state.latest_finalized.root = testHash(9);
+  for (uint8_t i = 0; i < 3; ++i) {
+    state.historical_block_hashes.mut().data().emplace_back(testHash(i));
+    state.justified_slots.data().emplace_back(i == 0);
+  }
+  state.validators.mut().data().resize(4);
+  state.validators.mut().data()[3].index = 3;
+  auto bytes = lean::encode(state).value();
+
+  auto view = StateView::make(bytes).value();
+  EXPECT_EQ(view.config(), state.config);
+  EXPECT_EQ(view.slot(), 3);
+  EXPECT_EQ(view.latestBlockHeader(), state.latest_block_header);
+  EXPECT_EQ(view.latestJustified(), state.latest_justified);
+  EXPECT_EQ(view.latestFinalized(), state.latest_finalized);
+  EXPECT_EQ(view.historicalBlockHashes().size(), 3);
+  EXPECT_EQ(view.historicalBlockHashes().at(2), testHash(2));
+  EXPECT_EQ(view.historicalBlockHashes().at(3), std::nullopt);
+  EXPECT_EQ(view.validators().size(), 4);
+  EXPECT_EQ(view.validators().at(3), state.validators[3]);
+  auto decoded = view.decode().value();
+  EXPECT_EQ(decoded, state);
+}
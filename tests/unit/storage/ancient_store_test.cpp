@@ -0,0 +1,89 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/ancient_store.hpp"
+
+#include <fstream>
+
+#include <gtest/gtest.h>
+#include <qtils/test/outcome.hpp>
+
+#include "storage/storage_error.hpp"
+#include "testutil/storage/base_fs_test.hpp"
+
+using lean::storage::AncientStore;
+using lean::storage::StorageError;
+using qtils::ByteVec;
+
+struct AncientStoreTest : public test::BaseFS_Test {
+  AncientStoreTest() : test::BaseFS_Test("/tmp/lean-test-ancient-store") {}
+};
+
+/**
+ * @given ancient store with records of keys with gaps
+ * @when store is reopened
+ * @then records are read by key, single and many at once, skipped keys have
+ * no records, and keys must go on ascending
+ */
+TEST_F(AncientStoreTest, AppendAndReopen) {
+  {
+    ASSERT_OUTCOME_SUCCESS(store, AncientStore::open(base_path));
+    EXPECT_EQ(store->firstKey(), std::nullopt);
+    ASSERT_OUTCOME_SUCCESS(store->append(10, ByteVec{1}));
+    ASSERT_OUTCOME_SUCCESS(store->append(11, ByteVec{2, 2}));
+    ASSERT_OUTCOME_SUCCESS(store->append(14, ByteVec{3, 3, 3}));
+    ASSERT_OUTCOME_SUCCESS(store->sync());
+  }
+
+  ASSERT_OUTCOME_SUCCESS(store, AncientStore::open(base_path));
+  EXPECT_EQ(store->firstKey(), 10);
+  EXPECT_EQ(store->endKey(), 15);
+  ASSERT_OUTCOME_SUCCESS(value, store->get(11));
+  EXPECT_EQ(value, (ByteVec{2, 2}));
+  ASSERT_OUTCOME_SUCCESS(skipped, store->get(12));
+  EXPECT_EQ(skipped, std::nullopt);
+
+  std::vector<uint64_t> keys{14, 9, 10, 13, 11, 15};
+  ASSERT_OUTCOME_SUCCESS(values, store->getMany(keys));
+  EXPECT_EQ(values,
+            (std::vector<std::optional<ByteVec>>{ByteVec{3, 3, 3},
+                                                 std::nullopt,
+                                                 ByteVec{1},
+                                                 std::nullopt,
+                                                 ByteVec{2, 2},
+                                                 std::nullopt}));
+
+  ASSERT_OUTCOME_ERROR(store->append(14, ByteVec{4}),
+                       StorageError::INVALID_ARGUMENT);
+  ASSERT_OUTCOME_SUCCESS(store->append(15, ByteVec{4}));
+  ASSERT_OUTCOME_SUCCESS(last, store->get(15));
+  EXPECT_EQ(last, ByteVec{4});
+}
+
+/**
+ * @given ancient store with record written to data file but not indexed
+ * @when store is reopened
+ * @then unindexed tail is dropped and next record is appended after last
+ * indexed one
+ */
+TEST_F(AncientStoreTest, TruncatesUnindexedTail) {
+  {
+    ASSERT_OUTCOME_SUCCESS(store, AncientStore::open(base_path));
+    ASSERT_OUTCOME_SUCCESS(store->append(0, ByteVec{1, 1}));
+  }
+  {
+    std::ofstream data{base_path / "data", std::ios::binary | std::ios::app};
+    data << "garbage";
+  }
+
+  ASSERT_OUTCOME_SUCCESS(store, AncientStore::open(base_path));
+  EXPECT_EQ(store->endKey(), 1);
+  EXPECT_EQ(fs::file_size(base_path / "data"), 2);
+  ASSERT_OUTCOME_SUCCESS(store->append(1, ByteVec{2}));
+  ASSERT_OUTCOME_SUCCESS(values, store->getMany(std::vector<uint64_t>{0, 1}));
+  EXPECT_EQ(values,
+            (std::vector<std::optional<ByteVec>>{ByteVec{1, 1}, ByteVec{2}}));
+}
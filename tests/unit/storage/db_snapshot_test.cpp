@@ -0,0 +1,90 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/db_snapshot.hpp"
+
+#include <fstream>
+#include <sstream>
+
+#include <gtest/gtest.h>
+#include <qtils/test/outcome.hpp>
+
+#include "testutil/storage/base_fs_test.hpp"
+
+using lean::storage::DbSnapshotError;
+using lean::storage::exportDbSnapshot;
+using lean::storage::importDbSnapshot;
+
+struct DbSnapshotTest : public test::BaseFS_Test {
+  DbSnapshotTest() : test::BaseFS_Test("/tmp/lean-test-db-snapshot") {}
+
+  void write(const fs::path &path, const std::string &content) {
+    fs::create_directories(path.parent_path());
+    std::ofstream{path, std::ios::binary} << content;
+  }
+
+  std::string read(const fs::path &path) {
+    std::ifstream file{path, std::ios::binary};
+    return {std::istreambuf_iterator<char>{file}, {}};
+  }
+};
+
+/**
+ * @given database directory with nested files, one larger than snappy block
+ * @when it is exported and imported into new directory
+ * @then files are same, except ones written by RocksDB on open
+ */
+TEST_F(DbSnapshotTest, ExportImport) {
+  auto db = base_path / "db";
+  std::string large(200000, '\0');
+  for (size_t i = 0; i < large.size(); ++i) {
+    large[i] = static_cast<char>(i * 7 % 251);
+  }
+  write(db / "000001.sst", large);
+  write(db / "CURRENT", "MANIFEST-000001\n");
+  write(db / "ancient" / "index", "index");
+  write(db / "ancient" / "data", "");
+  write(db / "LOCK", "");
+  write(db / "LOG", "log");
+
+  std::stringstream archive;
+  ASSERT_OUTCOME_SUCCESS(exportDbSnapshot(db, archive));
+  auto imported = base_path / "imported";
+  ASSERT_OUTCOME_SUCCESS(importDbSnapshot(archive, imported));
+
+  EXPECT_EQ(read(imported / "000001.sst"), large);
+  EXPECT_EQ(read(imported / "CURRENT"), "MANIFEST-000001\n");
+  EXPECT_EQ(read(imported / "ancient" / "index"), "index");
+  EXPECT_TRUE(fs::exists(imported / "ancient" / "data"));
+  EXPECT_FALSE(fs::exists(imported / "LOCK"));
+  EXPECT_FALSE(fs::exists(imported / "LOG"));
+  EXPECT_FALSE(fs::exists(base_path / "imported.import"));
+
+  archive.clear();
+  archive.seekg(0);
+  ASSERT_OUTCOME_ERROR(importDbSnapshot(archive, imported),
+                       DbSnapshotError::EXISTS);
+}
+
+/**
+ * @given truncated archive
+ * @when it is imported
+ * @then import fails and leaves no directory
+ */
+TEST_F(DbSnapshotTest, Truncated) {
+  auto db = base_path / "db";
+  write(db / "CURRENT", "MANIFEST-000001\n");
+  std::stringstream archive;
+  ASSERT_OUTCOME_SUCCESS(exportDbSnapshot(db, archive));
+  auto bytes = archive.str();
+  std::stringstream truncated{bytes.substr(0, bytes.size() - 1)};
+
+  auto imported = base_path / "imported";
+  ASSERT_OUTCOME_ERROR(importDbSnapshot(truncated, imported),
+                       DbSnapshotError::INVALID);
+  EXPECT_FALSE(fs::exists(imported));
+  EXPECT_FALSE(fs::exists(base_path / "imported.import"));
+}
@@ -0,0 +1,85 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/in_memory/hashed_memory_storage.hpp"
+
+#include <gtest/gtest.h>
+#include <qtils/test/outcome.hpp>
+
+#include "storage/storage_error.hpp"
+
+using lean::storage::HashedMemoryStorage;
+using lean::storage::StorageError;
+using qtils::ByteVec;
+
+ByteVec testKey(uint32_t i) {
+  return ByteVec{
+      uint8_t(i >> 24), uint8_t(i >> 16), uint8_t(i >> 8), uint8_t(i)};
+}
+
+/**
+ * @given hashed storage
+ * @when many values are written, overwritten and removed
+ * @then reads see latest values, table grows and arena is compacted
+ */
+TEST(HashedMemoryStorageTest, PutGetRemove) {
+  HashedMemoryStorage storage{false};
+  constexpr uint32_t kCount = 1000;
+  for (uint32_t round = 0; round < 3; ++round) {
+    for (uint32_t i = 0; i < kCount; ++i) {
+      ByteVec value(1000, uint8_t(i + round));
+      ASSERT_OUTCOME_SUCCESS(storage.put(testKey(i), std::move(value)));
+    }
+  }
+  for (uint32_t i = 0; i < kCount; i += 2) {
+    ASSERT_OUTCOME_SUCCESS(storage.remove(testKey(i)));
+  }
+  EXPECT_EQ(storage.byteSizeHint(), kCount / 2 * 1000);
+
+  for (uint32_t i = 0; i < kCount; ++i) {
+    ASSERT_OUTCOME_SUCCESS(value, storage.tryGet(testKey(i)));
+    if (i % 2 == 0) {
+      EXPECT_FALSE(value.has_value());
+      continue;
+    }
+    ASSERT_TRUE(value.has_value());
+    EXPECT_EQ(value.value(), ByteVec(1000, uint8_t(i + 2)));
+  }
+  ASSERT_OUTCOME_ERROR(storage.get(testKey(0)), StorageError::NOT_FOUND);
+  ASSERT_OUTCOME_ERROR(storage.put(ByteVec(33), ByteVec{1}),
+                       StorageError::INVALID_ARGUMENT);
+}
+
+/**
+ * @given hashed storage with and without ordered index
+ * @when keys are iterated with cursor
+ * @then they are visited in order, and removed keys are skipped
+ */
+TEST(HashedMemoryStorageTest, Cursor) {
+  for (auto ordered : {false, true}) {
+    HashedMemoryStorage storage{ordered};
+    for (uint32_t i : {5, 1, 3, 4, 2}) {
+      ASSERT_OUTCOME_SUCCESS(storage.put(testKey(i), ByteVec{uint8_t(i)}));
+    }
+    auto cursor = storage.cursor();
+    ASSERT_OUTCOME_SUCCESS(storage.remove(testKey(4)));
+
+    std::vector<ByteVec> visited;
+    ASSERT_OUTCOME_SUCCESS(cursor->seek(testKey(2)));
+    while (cursor->isValid()) {
+      EXPECT_EQ(cursor->value().value(), ByteVec{cursor->key().value()[3]});
+      visited.emplace_back(cursor->key().value());
+      ASSERT_OUTCOME_SUCCESS(cursor->next());
+    }
+    EXPECT_EQ(visited, (std::vector{testKey(2), testKey(3), testKey(5)}));
+
+    ASSERT_OUTCOME_SUCCESS(last, cursor->seekLast());
+    EXPECT_TRUE(last);
+    EXPECT_EQ(cursor->key(), testKey(5));
+    ASSERT_OUTCOME_SUCCESS(cursor->prev());
+    EXPECT_EQ(cursor->key(), testKey(3));
+  }
+}
@@ -59,7 +59,8 @@ TEST_F(RocksDb_Open, OpenNonExistingDB) {
 
   EXPECT_CALL(*app_config, database()).WillRepeatedly(ReturnRef(db_config));
 
-  ASSERT_THROW_OUTCOME(RocksDb(logsys, app_config), std::errc::not_a_directory);
+  ASSERT_THROW_OUTCOME(RocksDb(logsys, app_config, nullptr),
+                       std::errc::not_a_directory);
 }
 
 /**
@@ -75,5 +76,36 @@ TEST_F(RocksDb_Open, OpenExistingDB) {
 
   EXPECT_CALL(*app_config, database()).WillRepeatedly(ReturnRef(db_config));
 
-  ASSERT_NO_THROW(RocksDb(logsys, app_config));
+  ASSERT_NO_THROW(RocksDb(logsys, app_config, nullptr));
+}
+
+/**
+ * @given database of running primary instance
+ * @when open it as secondary and write to primary
+ * @then writes are read by secondary after catch up
+ */
+TEST_F(RocksDb_Open, CatchUpSecondary) {
+  DatabaseConfig db_config{
+      .directory = getPathString() + "/db",
+      .cache_size = 8 << 20,  // 8Mb
+  };
+  auto secondary_config = db_config;
+  secondary_config.secondary_directory = getPathString() + "/secondary";
+  qtils::ByteVec key{1, 3, 3, 7};
+  qtils::ByteVec value{1, 2, 3};
+
+  RocksDb primary(logsys, db_config, nullptr);
+  auto primary_space = primary.getSpace(lean::storage::Space::Default);
+  ASSERT_OUTCOME_SUCCESS(primary_space->put(key, qtils::ByteView{value}));
+
+  RocksDb secondary(logsys, secondary_config, nullptr);
+  auto secondary_space = secondary.getSpace(lean::storage::Space::Default);
+  ASSERT_OUTCOME_SUCCESS(old_value, secondary_space->get(key));
+  EXPECT_EQ(old_value, value);
+
+  qtils::ByteVec new_value{4, 5, 6};
+  ASSERT_OUTCOME_SUCCESS(primary_space->put(key, qtils::ByteView{new_value}));
+  ASSERT_OUTCOME_SUCCESS(secondary.catchUp());
+  ASSERT_OUTCOME_SUCCESS(caught_up_value, secondary_space->get(key));
+  EXPECT_EQ(caught_up_value, new_value);
 }
@@ -0,0 +1,222 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "storage/write_behind_storage.hpp"
+
+#include <atomic>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <qtils/test/outcome.hpp>
+
+#include "storage/in_memory/in_memory_spaced_storage.hpp"
+#include "storage/storage_error.hpp"
+#include "testutil/prepare_loggers.hpp"
+
+using lean::storage::InMemorySpacedStorage;
+using lean::storage::Space;
+using lean::storage::SpacedBatch;
+using lean::storage::StorageError;
+using lean::storage::WriteBehindStorage;
+using qtils::ByteVec;
+
+/// Counts batches committed to backend
+class CountingStorage : public InMemorySpacedStorage {
+ public:
+  std::unique_ptr<SpacedBatch> createBatch() override {
+    ++batches;
+    return InMemorySpacedStorage::createBatch();
+  }
+
+  std::atomic_size_t batches = 0;
+};
+
+class WriteBehindStorageTest : public testing::Test {
+ public:
+  void SetUp() override {
+    backend = std::make_shared<CountingStorage>();
+  }
+
+  auto make(std::chrono::milliseconds commit_delay = std::chrono::hours{1}) {
+    return std::make_shared<WriteBehindStorage>(
+        logsys, backend, commit_delay);
+  }
+
+  qtils::SharedRef<lean::log::LoggingSystem> logsys =
+      testutil::prepareLoggers();
+  std::shared_ptr<CountingStorage> backend;
+  ByteVec key{1, 2, 3};
+  ByteVec value{4, 5, 6};
+};
+
+/**
+ * @given write-behind storage with long commit window
+ * @when value is written
+ * @then it is readable before it reaches backend, and after flush
+ */
+TEST_F(WriteBehindStorageTest, ReadsPendingWrites) {
+  auto storage = make();
+  auto space = storage->getSpace(Space::Header);
+  ASSERT_OUTCOME_SUCCESS(space->put(key, ByteVec{value}));
+
+  ASSERT_OUTCOME_SUCCESS(pending, space->tryGet(key));
+  ASSERT_TRUE(pending.has_value());
+  EXPECT_EQ(pending.value(), value);
+  EXPECT_EQ(storage->pendingWrites(), 1);
+  ASSERT_OUTCOME_SUCCESS(in_backend,
+                         backend->getSpace(Space::Header)->contains(key));
+  EXPECT_FALSE(in_backend);
+
+  ASSERT_OUTCOME_SUCCESS(storage->flush());
+  EXPECT_EQ(storage->pendingWrites(), 0);
+  ASSERT_OUTCOME_SUCCESS(durable, backend->getSpace(Space::Header)->get(key));
+  EXPECT_EQ(durable, value);
+  ASSERT_OUTCOME_SUCCESS(after_flush, space->get(key));
+  EXPECT_EQ(after_flush, value);
+}
+
+/**
+ * @given value present in backend
+ * @when it is removed through write-behind storage
+ * @then it is not visible immediately, and removed from backend after flush
+ */
+TEST_F(WriteBehindStorageTest, RemoveShadowsBackend) {
+  ASSERT_OUTCOME_SUCCESS(
+      backend->getSpace(Space::State)->put(key, ByteVec{value}));
+  auto storage = make();
+  auto space = storage->getSpace(Space::State);
+  ASSERT_OUTCOME_SUCCESS(space->remove(key));
+
+  ASSERT_OUTCOME_SUCCESS(contains, space->contains(key));
+  EXPECT_FALSE(contains);
+  ASSERT_OUTCOME_ERROR(space->get(key), StorageError::NOT_FOUND);
+  ASSERT_OUTCOME_SUCCESS(in_backend,
+                         backend->getSpace(Space::State)->contains(key));
+  EXPECT_TRUE(in_backend);
+
+  ASSERT_OUTCOME_SUCCESS(storage->flush());
+  ASSERT_OUTCOME_SUCCESS(removed,
+                         backend->getSpace(Space::State)->contains(key));
+  EXPECT_FALSE(removed);
+}
+
+/**
+ * @given values pending, removed and present only in backend
+ * @when they are read at once
+ * @then overlay shadows backend, other keys are read from backend
+ */
+TEST_F(WriteBehindStorageTest, ReadsManyThroughOverlay) {
+  ByteVec removed{7};
+  ByteVec durable{8};
+  ByteVec missing{9};
+  auto backend_space = backend->getSpace(Space::Body);
+  ASSERT_OUTCOME_SUCCESS(backend_space->put(removed, ByteVec{value}));
+  ASSERT_OUTCOME_SUCCESS(backend_space->put(durable, ByteVec{value}));
+  auto storage = make();
+  auto space = storage->getSpace(Space::Body);
+  ASSERT_OUTCOME_SUCCESS(space->put(key, ByteVec{value}));
+  ASSERT_OUTCOME_SUCCESS(space->remove(removed));
+
+  std::vector<qtils::ByteView> keys{key, removed, durable, missing};
+  ASSERT_OUTCOME_SUCCESS(values, space->tryGetMany(keys));
+  ASSERT_EQ(values.size(), 4);
+  ASSERT_TRUE(values[0].has_value());
+  EXPECT_EQ(values[0].value(), value);
+  EXPECT_FALSE(values[1].has_value());
+  ASSERT_TRUE(values[2].has_value());
+  EXPECT_EQ(values[2].value(), value);
+  EXPECT_FALSE(values[3].has_value());
+}
+
+/**
+ * @given value pending in overlay, value removed and value only in backend
+ * @when they are read in place
+ * @then overlay shadows backend, other keys are read from backend
+ */
+TEST_F(WriteBehindStorageTest, ReadsInPlaceThroughOverlay) {
+  ByteVec removed{7};
+  ByteVec durable{8};
+  auto backend_space = backend->getSpace(Space::Header);
+  ASSERT_OUTCOME_SUCCESS(backend_space->put(removed, ByteVec{value}));
+  ASSERT_OUTCOME_SUCCESS(backend_space->put(durable, ByteVec{value}));
+  auto storage = make();
+  auto space = storage->getSpace(Space::Header);
+  ASSERT_OUTCOME_SUCCESS(space->put(key, ByteVec{value}));
+  ASSERT_OUTCOME_SUCCESS(space->remove(removed));
+
+  size_t reads = 0;
+  auto read = [&](qtils::BytesIn bytes) -> outcome::result<void> {
+    ++reads;
+    EXPECT_EQ(ByteVec(bytes.begin(), bytes.end()), value);
+    return outcome::success();
+  };
+  ASSERT_OUTCOME_SUCCESS(pending, space->tryRead(key, read));
+  EXPECT_TRUE(pending);
+  ASSERT_OUTCOME_SUCCESS(shadowed, space->tryRead(removed, read));
+  EXPECT_FALSE(shadowed);
+  ASSERT_OUTCOME_SUCCESS(in_backend, space->tryRead(durable, read));
+  EXPECT_TRUE(in_backend);
+  EXPECT_EQ(reads, 2);
+}
+
+/**
+ * @given writes to several spaces within commit window
+ * @when storage is flushed
+ * @then backend receives them in one batch
+ */
+TEST_F(WriteBehindStorageTest, GroupsWritesIntoOneBatch) {
+  auto storage = make();
+  ASSERT_OUTCOME_SUCCESS(
+      storage->getSpace(Space::Header)->put(key, ByteVec{value}));
+  ASSERT_OUTCOME_SUCCESS(
+      storage->getSpace(Space::Body)->put(key, ByteVec{value}));
+  auto batch = storage->createBatch();
+  ASSERT_OUTCOME_SUCCESS(batch->put(Space::State, key, ByteVec{value}));
+  ASSERT_OUTCOME_SUCCESS(batch->put(Space::StateDiff, key, ByteVec{value}));
+  ASSERT_OUTCOME_SUCCESS(batch->commit());
+  EXPECT_EQ(storage->pendingWrites(), 4);
+
+  ASSERT_OUTCOME_SUCCESS(storage->flush());
+  EXPECT_EQ(backend->batches, 1);
+  for (auto space : {Space::Header, Space::Body, Space::State}) {
+    ASSERT_OUTCOME_SUCCESS(durable, backend->getSpace(space)->contains(key));
+    EXPECT_TRUE(durable);
+  }
+}
+
+/**
+ * @given write-behind storage with short commit window
+ * @when value is written
+ * @then it reaches backend without explicit flush
+ */
+TEST_F(WriteBehindStorageTest, CommitsAfterDelay) {
+  auto storage = make(std::chrono::milliseconds{1});
+  ASSERT_OUTCOME_SUCCESS(
+      storage->getSpace(Space::Header)->put(key, ByteVec{value}));
+  for (auto i = 0; i < 1000 and storage->pendingWrites() != 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }
+  EXPECT_EQ(storage->pendingWrites(), 0);
+  ASSERT_OUTCOME_SUCCESS(storage->flush());
+  ASSERT_OUTCOME_SUCCESS(durable,
+                         backend->getSpace(Space::Header)->contains(key));
+  EXPECT_TRUE(durable);
+}
+
+/**
+ * @given pending writes
+ * @when write-behind storage is destroyed
+ * @then writes reach backend
+ */
+TEST_F(WriteBehindStorageTest, CommitsOnDestruction) {
+  auto storage = make();
+  ASSERT_OUTCOME_SUCCESS(
+      storage->getSpace(Space::Header)->put(key, ByteVec{value}));
+  storage.reset();
+  ASSERT_OUTCOME_SUCCESS(durable,
+                         backend->getSpace(Space::Header)->contains(key));
+  EXPECT_TRUE(durable);
+}
@@ -0,0 +1,153 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/async_file_io.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <optional>
+#include <vector>
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <fcntl.h>
+#include <unistd.h>
+
+using lean::AsyncFileIo;
+
+/// Both io_uring, if kernel allows it, and thread fallback
+class AsyncFileIoTest : public testing::TestWithParam<bool> {
+ protected:
+  void SetUp() override {
+    char path[] = "/tmp/lean-test-async-file-io-XXXXXX";
+    fd_ = ::mkstemp(path);
+    ASSERT_GE(fd_, 0);
+    ::unlink(path);
+  }
+
+  void TearDown() override {
+    ::close(fd_);
+  }
+
+  /// Run batch, wait for completion on io context
+  AsyncFileIo::Results run(AsyncFileIo &io,
+                           std::vector<AsyncFileIo::Request> batch) {
+    std::optional<AsyncFileIo::Results> results;
+    io.submit(std::move(batch),
+              io_context_.get_executor(),
+              [&](AsyncFileIo::Results r) { results = std::move(r); });
+    while (not results.has_value()) {
+      io_context_.run_one();
+    }
+    io_context_.restart();
+    return std::move(results.value());
+  }
+
+  boost::asio::io_context io_context_;
+  int fd_ = -1;
+};
+
+/**
+ * @given file written by batch of adjacent writes
+ * @when it is read by batch of reads, last one past end of file
+ * @then reads return written bytes, last one is short
+ */
+TEST_P(AsyncFileIoTest, WriteRead) {
+  AsyncFileIo io{4, GetParam()};
+  std::vector<uint8_t> data(100000);
+  std::iota(data.begin(), data.end(), 0);
+  std::vector<AsyncFileIo::Request> writes;
+  for (size_t offset = 0; offset < data.size(); offset += 10000) {
+    writes.emplace_back(AsyncFileIo::Request{
+        .fd = fd_,
+        .offset = offset,
+        .buffer = std::span{data}.subspan(offset, 10000),
+        .write = true,
+    });
+  }
+  for (auto &result : run(io, writes)) {
+    ASSERT_EQ(result.value(), 10000);
+  }
+
+  std::vector<uint8_t> read(data.size() + 100);
+  auto results = run(io,
+                     {
+                         {.fd = fd_,
+                          .offset = 0,
+                          .buffer = std::span{read}.first(60000)},
+                         {.fd = fd_,
+                          .offset = 60000,
+                          .buffer = std::span{read}.subspan(60000)},
+                     });
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].value(), 60000);
+  EXPECT_EQ(results[1].value(), 40000);
+  read.resize(data.size());
+  EXPECT_EQ(read, data);
+
+  EXPECT_TRUE(run(io, {}).empty());
+  auto failed = run(io, {{.fd = -1, .offset = 0, .buffer = read}});
+  EXPECT_TRUE(failed.at(0).has_error());
+}
+
+/**
+ * @given registered buffer
+ * @when coroutine writes and reads with fixed requests
+ * @then bytes are read back
+ */
+TEST_P(AsyncFileIoTest, FixedAwaitable) {
+  AsyncFileIo io{4, GetParam()};
+  std::vector<uint8_t> buffer(8192);
+  std::vector<std::span<uint8_t>> buffers{buffer};
+  ASSERT_TRUE(io.registerBuffers(buffers).has_value());
+  std::fill_n(buffer.begin(), 4096, 7);
+
+  std::vector<AsyncFileIo::Request> write{{
+      .fd = fd_,
+      .offset = 0,
+      .buffer = std::span{buffer}.first(4096),
+      .write = true,
+      .fixed_buffer = 0,
+  }};
+  std::vector<AsyncFileIo::Request> read{{
+      .fd = fd_,
+      .offset = 0,
+      .buffer = std::span{buffer}.subspan(4096),
+      .fixed_buffer = 0,
+  }};
+  std::optional<size_t> written;
+  std::optional<size_t> was_read;
+  boost::asio::co_spawn(
+      io_context_,
+      [&]() -> boost::asio::awaitable<void> {
+        auto executor = co_await boost::asio::this_coro::executor;
+        auto results = co_await io.asyncSubmit(
+            write, executor, boost::asio::use_awaitable);
+        written = results.at(0).value();
+        results = co_await io.asyncSubmit(
+            read, executor, boost::asio::use_awaitable);
+        was_read = results.at(0).value();
+      },
+      boost::asio::detached);
+  io_context_.run();
+  EXPECT_EQ(written, 4096);
+  EXPECT_EQ(was_read, 4096);
+  EXPECT_TRUE(std::all_of(
+      buffer.begin() + 4096, buffer.end(), [](uint8_t b) { return b == 7; }));
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends,
+                         AsyncFileIoTest,
+                         testing::Values(true, false),
+                         [](const auto &info) {
+                           return std::string{info.param ? "IoUring"
+                                                         : "Threads"};
+                         });
@@ -0,0 +1,47 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/blocked_bloom_filter.hpp"
+
+#include <random>
+
+#include <gtest/gtest.h>
+#include <qtils/byte_arr.hpp>
+
+using lean::BlockedBloomFilter;
+
+/**
+ * @given filter with capacity for keys
+ * @when keys are inserted
+ * @then all of them may be contained, and few other keys may be
+ */
+TEST(BlockedBloomFilterTest, NoFalseNegatives) {
+  constexpr size_t kCount = 10000;
+  BlockedBloomFilter filter{kCount};
+  std::mt19937_64 random{1};
+  auto key = [&] {
+    qtils::ByteArr<32> key;
+    for (auto &byte : key) {
+      byte = static_cast<uint8_t>(random());
+    }
+    return key;
+  };
+
+  std::vector<qtils::ByteArr<32>> keys;
+  for (size_t i = 0; i < kCount; ++i) {
+    keys.emplace_back(key());
+    filter.insert(keys.back());
+  }
+  for (auto &inserted : keys) {
+    EXPECT_TRUE(filter.mayContain(inserted));
+  }
+
+  size_t false_positives = 0;
+  for (size_t i = 0; i < kCount; ++i) {
+    false_positives += filter.mayContain(key()) ? 1 : 0;
+  }
+  EXPECT_LT(false_positives, kCount * 3 / 100);
+}
@@ -0,0 +1,88 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/bounded_channel.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+
+using Channel = lean::BoundedChannel<int>;
+
+TEST(BoundedChannelTest, TrySendAndBatch) {
+  Channel channel{3};
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(channel.trySend(int{i}));
+  }
+  EXPECT_FALSE(channel.trySend(3));
+  EXPECT_EQ(channel.tryReceiveBatch(2), (std::vector{0, 1}));
+  EXPECT_EQ(channel.tryReceiveBatch(5), (std::vector{2}));
+  EXPECT_TRUE(channel.tryReceiveBatch(5).empty());
+}
+
+TEST(BoundedChannelTest, DropPolicies) {
+  Channel newest{2, Channel::Overflow::DropNewest};
+  Channel oldest{2, Channel::Overflow::DropOldest};
+  for (int i = 0; i < 4; ++i) {
+    newest.send(int{i});
+    oldest.send(int{i});
+  }
+  EXPECT_EQ(newest.receiveBatch(4), (std::vector{0, 1}));
+  EXPECT_EQ(oldest.receiveBatch(4), (std::vector{2, 3}));
+  EXPECT_EQ(newest.dropped(), 2);
+  EXPECT_EQ(oldest.dropped(), 2);
+}
+
+// Waiting sender is released by consumer, and by close
+TEST(BoundedChannelTest, SendWaitsForSpace) {
+  Channel channel{1};
+  EXPECT_TRUE(channel.send(0));
+  std::thread producer{[&] {
+    EXPECT_TRUE(channel.send(1));
+    EXPECT_FALSE(channel.send(2));
+  }};
+  EXPECT_EQ(channel.receiveBatch(4), (std::vector{0}));
+  // Second value fills channel again, third one waits
+  while (channel.size() == 0) {
+    std::this_thread::yield();
+  }
+  channel.close();
+  producer.join();
+  EXPECT_EQ(channel.receiveBatch(4), (std::vector{1}));
+  EXPECT_TRUE(channel.receiveBatch(4).empty());
+  EXPECT_FALSE(channel.trySend(3));
+}
+
+TEST(BoundedChannelTest, AsyncReceive) {
+  Channel channel{16};
+  boost::asio::io_context io;
+  std::vector<int> received;
+  boost::asio::co_spawn(
+      io,
+      [&]() -> boost::asio::awaitable<void> {
+        for (;;) {
+          auto batch = co_await channel.asyncReceiveBatch(4);
+          if (batch.empty()) {
+            co_return;
+          }
+          received.insert(received.end(), batch.begin(), batch.end());
+        }
+      },
+      boost::asio::detached);
+  std::thread producer{[&] {
+    for (int i = 0; i < 10; ++i) {
+      ASSERT_TRUE(channel.send(int{i}));
+    }
+    channel.close();
+  }};
+  io.run();
+  producer.join();
+  EXPECT_EQ(received, (std::vector{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
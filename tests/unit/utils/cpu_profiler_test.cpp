@@ -0,0 +1,88 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/cpu_profiler.hpp"
+
+#include <atomic>
+#include <sstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using lean::profileCpu;
+
+/// Thread spinning until destroyed
+struct Spinner {
+  Spinner() {
+    while (tid == 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  ~Spinner() {
+    stop = true;
+    thread.join();
+  }
+
+  std::atomic_bool stop = false;
+  std::atomic<uint64_t> tid = 0;
+  std::thread thread{[this] {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+    tid = syscall(SYS_gettid);
+    while (not stop) {}
+  }};
+};
+
+/**
+ * @given thread busy in loop, named by callback
+ * @when process is profiled
+ * @then folded stacks of that thread have its name and sample counts
+ */
+TEST(CpuProfilerTest, SamplesBusyThread) {
+  Spinner spinner;
+  auto folded = profileCpu(
+      std::chrono::milliseconds{300},
+      200,
+      [&](uint64_t tid) -> std::optional<std::string> {
+        if (tid == spinner.tid) {
+          return "spinner";
+        }
+        return std::nullopt;
+      });
+  ASSERT_TRUE(folded.has_value()) << folded.error().message();
+
+  size_t samples = 0;
+  std::istringstream lines{folded.value()};
+  std::string line;
+  while (std::getline(lines, line)) {
+    auto space = line.rfind(' ');
+    ASSERT_NE(space, std::string::npos) << line;
+    if (line.starts_with("spinner;")) {
+      samples += std::stoul(line.substr(space + 1));
+    }
+  }
+  // 60 expected, timers of CPU clocks may fire late on loaded machine
+  EXPECT_GT(samples, 10);
+}
+
+/**
+ * @given profiling in progress
+ * @when another profiling is started
+ * @then it fails without waiting
+ */
+TEST(CpuProfilerTest, OneProfileAtTime) {
+  Spinner spinner;
+  std::thread first{[] {
+    std::ignore = profileCpu(std::chrono::milliseconds{500}, 100, {});
+  }};
+  std::this_thread::sleep_for(std::chrono::milliseconds{100});
+  auto second = profileCpu(std::chrono::milliseconds{1}, 100, {});
+  first.join();
+  ASSERT_TRUE(second.has_error());
+  EXPECT_EQ(second.error(), lean::CpuProfilerError::BUSY);
+}
@@ -0,0 +1,90 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/hex.hpp"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using lean::hex0x;
+using lean::hexDecode;
+using lean::hexEncode;
+
+/// Reference codec, one digit at a time
+std::string slowHex(std::span<const uint8_t> bytes) {
+  constexpr std::string_view digits = "0123456789abcdef";
+  std::string hex;
+  for (auto byte : bytes) {
+    hex.push_back(digits[byte >> 4]);
+    hex.push_back(digits[byte & 15]);
+  }
+  return hex;
+}
+
+std::vector<uint8_t> testBytes(size_t size) {
+  std::vector<uint8_t> bytes(size);
+  for (size_t i = 0; i < size; ++i) {
+    bytes[i] = static_cast<uint8_t>(i * 37 + 11);
+  }
+  return bytes;
+}
+
+/**
+ * @given byte strings of lengths around vector width, with all byte values
+ * @when encoded and decoded
+ * @then hex matches reference and decodes back
+ */
+TEST(HexTest, RoundTrip) {
+  for (size_t size : {0, 1, 15, 16, 17, 31, 32, 33, 52, 256}) {
+    auto bytes = testBytes(size);
+    std::string hex(2 * size, '\0');
+    hexEncode(bytes, hex.data());
+    EXPECT_EQ(hex, slowHex(bytes)) << size;
+    EXPECT_EQ(hex0x(bytes), "0x" + hex);
+    std::vector<uint8_t> decoded(size);
+    EXPECT_TRUE(hexDecode(hex, decoded));
+    EXPECT_EQ(decoded, bytes);
+    decoded.assign(size, 0);
+    EXPECT_TRUE(hexDecode("0x" + hex, decoded));
+    EXPECT_EQ(decoded, bytes);
+  }
+}
+
+/**
+ * @given uppercase hex
+ * @when decoded
+ * @then same bytes as lowercase
+ */
+TEST(HexTest, DecodeUppercase) {
+  auto bytes = testBytes(40);
+  auto hex = slowHex(bytes);
+  for (auto &c : hex) {
+    c = static_cast<char>(std::toupper(c));
+  }
+  std::vector<uint8_t> decoded(bytes.size());
+  EXPECT_TRUE(hexDecode(hex, decoded));
+  EXPECT_EQ(decoded, bytes);
+}
+
+/**
+ * @given hex with invalid digit at every position, or wrong length
+ * @when decoded
+ * @then rejected
+ */
+TEST(HexTest, DecodeInvalid) {
+  auto hex = slowHex(testBytes(40));
+  std::vector<uint8_t> decoded(40);
+  for (size_t i = 0; i < hex.size(); ++i) {
+    for (char c : {'g', 'G', '/', ':', '@', '`', ' ', '\xff'}) {
+      auto bad = hex;
+      bad[i] = c;
+      EXPECT_FALSE(hexDecode(bad, decoded)) << i << c;
+    }
+  }
+  EXPECT_FALSE(hexDecode(hex.substr(2), decoded));
+  EXPECT_FALSE(hexDecode(hex + "00", decoded));
+}
@@ -0,0 +1,94 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/http.hpp"
+
+#include <gtest/gtest.h>
+
+#include <boost/beast/http/string_body.hpp>
+
+using lean::http::EventParser;
+using lean::http::queryParam;
+using lean::http::Request;
+using lean::http::Response;
+using lean::http::sharedBodyResponse;
+using lean::http::SharedResponse;
+using lean::http::targetPath;
+namespace beast_http = boost::beast::http;
+
+/**
+ * @given request target with query
+ * @when path and parameters are read
+ * @then path is before "?", parameters are matched by whole name
+ */
+TEST(HttpTest, QueryParam) {
+  std::string_view target = "/lean/v0/blocks?start_slot=10&count=5&c=1";
+  EXPECT_EQ(targetPath(target), "/lean/v0/blocks");
+  EXPECT_EQ(queryParam(target, "start_slot"), "10");
+  EXPECT_EQ(queryParam(target, "count"), "5");
+  EXPECT_EQ(queryParam(target, "c"), "1");
+  EXPECT_EQ(queryParam(target, "slot"), std::nullopt);
+  EXPECT_EQ(targetPath("/lean/v0/health"), "/lean/v0/health");
+  EXPECT_EQ(queryParam("/lean/v0/health", "count"), std::nullopt);
+}
+
+/**
+ * @given shared body
+ * @when requested whole, by range, by matching etag and out of range
+ * @then 200, 206 with part, 304 and 416 are returned
+ */
+TEST(HttpTest, SharedBodyRange) {
+  auto body = std::make_shared<const qtils::ByteVec>(
+      qtils::ByteVec{0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+  std::string_view etag = R"("0x01")";
+  Request request{beast_http::verb::get, "/", 11};
+
+  auto whole = sharedBodyResponse(request, body, etag, "x");
+  auto &whole_shared = std::get<SharedResponse>(whole);
+  EXPECT_EQ(whole_shared.header.result(), beast_http::status::ok);
+  EXPECT_EQ(whole_shared.offset, 0);
+  EXPECT_EQ(whole_shared.size, std::nullopt);
+
+  request.set(beast_http::field::range, "bytes=2-4");
+  auto part = sharedBodyResponse(request, body, etag, "x");
+  auto &part_shared = std::get<SharedResponse>(part);
+  EXPECT_EQ(part_shared.header.result(), beast_http::status::partial_content);
+  EXPECT_EQ(part_shared.offset, 2);
+  EXPECT_EQ(part_shared.size, 3);
+  EXPECT_EQ(part_shared.header[beast_http::field::content_range],
+            "bytes 2-4/10");
+
+  request.set(beast_http::field::range, "bytes=20-");
+  auto outside = sharedBodyResponse(request, body, etag, "x");
+  EXPECT_EQ(std::get<Response>(outside).result(),
+            beast_http::status::range_not_satisfiable);
+
+  request.set(beast_http::field::if_none_match, etag);
+  auto cached = sharedBodyResponse(request, body, etag, "x");
+  EXPECT_EQ(std::get<Response>(cached).result(),
+            beast_http::status::not_modified);
+}
+
+/**
+ * @given event stream split at arbitrary points, with keep alive comments
+ * @when bytes are fed to parser
+ * @then events are returned once their blank line arrives
+ */
+TEST(HttpTest, EventParser) {
+  EventParser parser;
+  EXPECT_TRUE(parser.feed(":\n\nevent: head\nda").empty());
+  auto events = parser.feed("ta: 0x01\n\nevent: interval\r\ndata:2\r\n");
+  ASSERT_EQ(events.size(), 1);
+  EXPECT_EQ(events[0].event, "head");
+  EXPECT_EQ(events[0].data, "0x01");
+
+  events = parser.feed("\r\ndata: a\ndata: b\n\n");
+  ASSERT_EQ(events.size(), 2);
+  EXPECT_EQ(events[0].event, "interval");
+  EXPECT_EQ(events[0].data, "2");
+  EXPECT_EQ(events[1].event, "");
+  EXPECT_EQ(events[1].data, "a\nb");
+}
@@ -0,0 +1,84 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/mpmc_queue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+TEST(MpmcQueueTest, CapacityRoundedUp) {
+  lean::MpmcQueue<int> queue{5};
+  EXPECT_EQ(queue.capacity(), 8);
+}
+
+TEST(MpmcQueueTest, FifoAndFull) {
+  lean::MpmcQueue<int> queue{4};
+  EXPECT_TRUE(queue.empty());
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.tryPush(int{i}));
+  }
+  auto rejected = 4;
+  EXPECT_FALSE(queue.tryPush(std::move(rejected)));
+
+  int value = -1;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.tryPop(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(queue.tryPop(value));
+  EXPECT_TRUE(queue.empty());
+}
+
+// Failed push must leave value intact, so caller can put it elsewhere
+TEST(MpmcQueueTest, FailedPushKeepsValue) {
+  lean::MpmcQueue<std::vector<int>> queue{2};
+  EXPECT_TRUE(queue.tryPush({1}));
+  EXPECT_TRUE(queue.tryPush({2}));
+  std::vector<int> value{3, 4};
+  EXPECT_FALSE(queue.tryPush(std::move(value)));
+  EXPECT_EQ(value, (std::vector<int>{3, 4}));
+}
+
+TEST(MpmcQueueTest, ConcurrentProducersConsumers) {
+  constexpr int kThreads = 4;
+  constexpr int kPerThread = 10000;
+  lean::MpmcQueue<int> queue{64};
+  std::atomic_int64_t sum = 0;
+  std::atomic_int popped = 0;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kPerThread; ++i) {
+        auto value = t * kPerThread + i;
+        while (not queue.tryPush(std::move(value))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+    threads.emplace_back([&] {
+      int value = 0;
+      while (popped.load() < kThreads * kPerThread) {
+        if (queue.tryPop(value)) {
+          sum += value;
+          ++popped;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  constexpr int64_t kTotal = kThreads * kPerThread;
+  EXPECT_EQ(popped.load(), kTotal);
+  EXPECT_EQ(sum.load(), kTotal * (kTotal - 1) / 2);
+  EXPECT_TRUE(queue.empty());
+}
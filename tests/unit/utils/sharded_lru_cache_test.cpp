@@ -0,0 +1,108 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/sharded_lru_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "tests/testutil/dummy_error.hpp"
+#include "utils/lru_cache.hpp"
+
+using lean::ShardedLruCache;
+
+TEST(ShardedLruCacheTest, PutThenGetReturnsValue) {
+  ShardedLruCache<int, int> cache{64};
+  EXPECT_FALSE(cache.get(1).has_value());
+
+  auto sp = cache.put(1, 42);
+  ASSERT_TRUE(sp);
+  EXPECT_EQ(*sp, 42);
+
+  auto got = cache.get(1);
+  ASSERT_TRUE(got.has_value());
+  EXPECT_EQ(*got.value(), 42);
+}
+
+TEST(ShardedLruCacheTest, PutSameKeyReplacesValue) {
+  ShardedLruCache<int, int> cache{64};
+  cache.put(1, 1);
+  cache.put(1, 2);
+  EXPECT_EQ(*cache.get(1).value(), 2);
+  EXPECT_EQ(cache.keys().size(), 1);
+}
+
+TEST(ShardedLruCacheTest, GetUpdatesRecencySoLruIsEvicted) {
+  // One shard, same as plain LRU
+  ShardedLruCache<int, int, std::hash<int>, 1> cache{2};
+  cache.put(1, 1);
+  cache.put(2, 2);
+  ASSERT_TRUE(cache.get(1).has_value());
+  cache.put(3, 3);
+
+  EXPECT_EQ(cache.keys(), (std::vector{3, 1}));
+  EXPECT_TRUE(cache.get(1).has_value());
+  EXPECT_FALSE(cache.get(2).has_value());
+  EXPECT_TRUE(cache.get(3).has_value());
+}
+
+TEST(ShardedLruCacheTest, CapacityIsSpreadOverShards) {
+  ShardedLruCache<int, int> cache{20};
+  for (int i = 0; i < 1000; ++i) {
+    cache.put(i, i);
+  }
+  EXPECT_EQ(cache.keys().size(), 20);
+  // Recently put keys survive in each shard
+  EXPECT_TRUE(cache.get(999).has_value());
+}
+
+TEST(ShardedLruCacheTest, EraseAndEraseIf) {
+  ShardedLruCache<int, int> cache{64};
+  for (int i = 0; i < 10; ++i) {
+    cache.put(i, i);
+  }
+  cache.erase(0);
+  cache.erase_if([](const int &, const int &value) { return value % 2 == 1; });
+  EXPECT_FALSE(cache.get(0).has_value());
+  EXPECT_FALSE(cache.get(1).has_value());
+  EXPECT_TRUE(cache.get(2).has_value());
+  EXPECT_EQ(cache.keys().size(), 4);
+}
+
+TEST(ShardedLruCacheTest, ByteSizeCountsValueHeap) {
+  ShardedLruCache<int, std::vector<char>> cache{64};
+  auto value_bytes = [](const std::vector<char> &value) {
+    return value.capacity();
+  };
+  auto empty = cache.byteSize(value_bytes);
+  cache.put(1, std::vector<char>(1000));
+  cache.put(2, std::vector<char>(3000));
+  EXPECT_GE(cache.byteSize(value_bytes), empty + 4000);
+  cache.erase(2);
+  EXPECT_LT(cache.byteSize(value_bytes), empty + 3000);
+}
+
+TEST(ShardedLruCacheTest, GetElseStoresOnSuccessOnly) {
+  ShardedLruCache<int, int> cache{64};
+  auto calls = 0;
+  auto ok = cache.get_else(1, [&]() -> outcome::result<int> {
+    ++calls;
+    return 7;
+  });
+  ASSERT_TRUE(ok.has_value());
+  ok = cache.get_else(1, [&]() -> outcome::result<int> {
+    ++calls;
+    return 8;
+  });
+  EXPECT_EQ(*ok.value(), 7);
+  EXPECT_EQ(calls, 1);
+
+  auto failed = cache.get_else(
+      2, [&]() -> outcome::result<int> { return testutil::DummyError::ERROR; });
+  EXPECT_TRUE(failed.has_error());
+  EXPECT_FALSE(cache.get(2).has_value());
+}
@@ -0,0 +1,66 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/thread_placement.hpp"
+
+#include <algorithm>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <sched.h>
+
+using lean::formatCpuList;
+using lean::parseCpuList;
+using lean::threadClass;
+
+TEST(ThreadPlacementTest, CpuList) {
+  EXPECT_EQ(parseCpuList("3"), (std::vector<uint32_t>{3}));
+  EXPECT_EQ(parseCpuList("4-6,0,2,5"),
+            (std::vector<uint32_t>{0, 2, 4, 5, 6}));
+  EXPECT_EQ(parseCpuList(""), std::nullopt);
+  EXPECT_EQ(parseCpuList("1-"), std::nullopt);
+  EXPECT_EQ(parseCpuList("3-1"), std::nullopt);
+  EXPECT_EQ(parseCpuList("1,,2"), std::nullopt);
+  EXPECT_EQ(formatCpuList({0, 2, 4, 5, 6}), "0,2,4-6");
+  EXPECT_EQ(formatCpuList({}), "");
+}
+
+TEST(ThreadPlacementTest, ThreadClass) {
+  EXPECT_EQ(threadClass("pool.3"), "pool");
+  EXPECT_EQ(threadClass("rocksdb:low"), "rocksdb");
+  EXPECT_EQ(threadClass("io"), "io");
+}
+
+/**
+ * @given placement of thread class pinned to one allowed CPU
+ * @when thread of class is named
+ * @then it is pinned and listed with its class and affinity
+ */
+TEST(ThreadPlacementTest, PinsNamedThread) {
+  cpu_set_t set;
+  ASSERT_EQ(sched_getaffinity(0, sizeof(set), &set), 0);
+  uint32_t cpu = 0;
+  while (not CPU_ISSET(cpu, &set)) {
+    ++cpu;
+  }
+  lean::setThreadPlacements(
+      {{"pinned", {.cpus = {cpu}, .nice = std::nullopt}}});
+
+  std::vector<lean::ThreadJson> threads;
+  std::thread thread{[&] {
+    lean::setThreadName("pinned.1");
+    threads = lean::listThreads();
+  }};
+  thread.join();
+  lean::setThreadPlacements({});
+
+  auto it = std::ranges::find(threads, "pinned.1", &lean::ThreadJson::name);
+  ASSERT_NE(it, threads.end());
+  EXPECT_EQ(it->thread_class, "pinned");
+  EXPECT_EQ(it->affinity, std::to_string(cpu));
+  EXPECT_EQ(it->cpu, cpu);
+}
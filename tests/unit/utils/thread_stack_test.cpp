@@ -0,0 +1,63 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/thread_stack.hpp"
+
+#include <atomic>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using lean::captureThreadStack;
+
+/**
+ * @given thread busy in loop
+ * @when its stack is captured
+ * @then frames are returned, and thread keeps running
+ */
+TEST(ThreadStackTest, CaptureBusyThread) {
+  std::atomic_bool stop = false;
+  std::atomic<uint64_t> tid = 0;
+  std::atomic_size_t spins = 0;
+  std::thread thread{[&] {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+    tid = syscall(SYS_gettid);
+    while (not stop) {
+      spins.fetch_add(1);
+    }
+  }};
+  while (tid == 0) {
+    std::this_thread::yield();
+  }
+
+  auto stack = captureThreadStack(tid, std::chrono::seconds{1});
+  ASSERT_TRUE(stack.has_value());
+  EXPECT_FALSE(stack->empty());
+
+  auto before = spins.load();
+  while (spins.load() == before) {
+    std::this_thread::yield();
+  }
+  stop = true;
+  thread.join();
+}
+
+/**
+ * @given id of thread which doesn't exist
+ * @when its stack is captured
+ * @then nothing is returned
+ */
+TEST(ThreadStackTest, MissingThread) {
+  std::atomic<uint64_t> tid = 0;
+  std::thread{[&] {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+    tid = syscall(SYS_gettid);
+  }}.join();
+  EXPECT_FALSE(
+      captureThreadStack(tid, std::chrono::milliseconds{100}).has_value());
+}
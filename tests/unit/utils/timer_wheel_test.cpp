@@ -0,0 +1,80 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/timer_wheel.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <latch>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+using lean::TimerWheel;
+
+TEST(TimerWheelTest, FiresInDeadlineOrder) {
+  TimerWheel wheel;
+  std::mutex mutex;
+  std::vector<int> order;
+  std::latch done{3};
+  auto push = [&](int i) {
+    return [&, i] {
+      std::lock_guard lock{mutex};
+      order.emplace_back(i);
+      done.count_down();
+    };
+  };
+  wheel.add(30ms, push(3));
+  wheel.add(10ms, push(1));
+  wheel.add(20ms, push(2));
+  done.wait();
+  EXPECT_EQ(order, (std::vector{1, 2, 3}));
+  EXPECT_EQ(wheel.size(), 0);
+}
+
+TEST(TimerWheelTest, NeverEarly) {
+  TimerWheel wheel;
+  // Crosses level 0 and level 1 slot boundaries
+  for (auto delay : {1ms, 63ms, 64ms, 65ms, 150ms}) {
+    std::latch done{1};
+    auto deadline = TimerWheel::Clock::now() + delay;
+    TimerWheel::Clock::time_point fired;
+    wheel.addAt(deadline, [&] {
+      fired = TimerWheel::Clock::now();
+      done.count_down();
+    });
+    done.wait();
+    EXPECT_GE(fired, deadline) << delay.count();
+  }
+}
+
+TEST(TimerWheelTest, Cancel) {
+  TimerWheel wheel;
+  std::atomic_bool cancelled_fired = false;
+  std::latch done{1};
+  auto id = wheel.add(10ms, [&] { cancelled_fired = true; });
+  wheel.add(20ms, [&] { done.count_down(); });
+  EXPECT_TRUE(wheel.cancel(id));
+  EXPECT_FALSE(wheel.cancel(id));
+  done.wait();
+  EXPECT_FALSE(cancelled_fired.load());
+}
+
+// Many far timers don't delay near one
+TEST(TimerWheelTest, ManyPending) {
+  TimerWheel wheel;
+  for (size_t i = 0; i < 10000; ++i) {
+    wheel.add(std::chrono::minutes{1} + std::chrono::milliseconds{i}, [] {});
+  }
+  std::latch done{1};
+  auto deadline = TimerWheel::Clock::now() + 5ms;
+  wheel.addAt(deadline, [&] { done.count_down(); });
+  done.wait();
+  EXPECT_LT(TimerWheel::Clock::now() - deadline, 50ms);
+  EXPECT_EQ(wheel.size(), 10000);
+}
@@ -0,0 +1,145 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/tiny_lfu_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+using lean::FrequencySketch;
+using lean::TinyLfuCache;
+
+TEST(FrequencySketchTest, CountsUpToMax) {
+  FrequencySketch sketch{64};
+  EXPECT_EQ(sketch.frequency(1), 0);
+  for (int i = 0; i < 3; ++i) {
+    sketch.increment(1);
+  }
+  EXPECT_EQ(sketch.frequency(1), 3);
+  for (int i = 0; i < 100; ++i) {
+    sketch.increment(2);
+  }
+  // Counters saturate, sample size of 640 increments is not reached
+  EXPECT_EQ(sketch.frequency(2), FrequencySketch::kMaxFrequency);
+}
+
+TEST(FrequencySketchTest, HalvesOnReset) {
+  // Sample size is 10 increments
+  FrequencySketch sketch{1};
+  for (int i = 0; i < 8; ++i) {
+    sketch.increment(1);
+  }
+  sketch.increment(2);
+  EXPECT_EQ(sketch.frequency(1), 8);
+  sketch.increment(2);
+  EXPECT_EQ(sketch.frequency(1), 4);
+  EXPECT_EQ(sketch.frequency(2), 1);
+}
+
+TEST(TinyLfuCacheTest, PutThenGetReturnsValue) {
+  TinyLfuCache<int, int> cache{8};
+  EXPECT_FALSE(cache.get(1).has_value());
+
+  auto sp = cache.put(1, 42);
+  ASSERT_TRUE(sp);
+  EXPECT_EQ(*sp, 42);
+
+  auto got = cache.get(1);
+  ASSERT_TRUE(got.has_value());
+  EXPECT_EQ(*got.value(), 42);
+
+  cache.put(1, 43);
+  EXPECT_EQ(*cache.get(1).value(), 43);
+  EXPECT_EQ(cache.keys().size(), 1);
+}
+
+/**
+ * @given cache with keys accessed repeatedly
+ * @when many keys are accessed once each
+ * @then repeatedly accessed keys stay in cache
+ */
+TEST(TinyLfuCacheTest, ScanDoesNotEvictHotKeys) {
+  TinyLfuCache<int, int> cache{{.capacity = 10, .window_percent = 10}};
+  for (int round = 0; round < 3; ++round) {
+    for (int key = 0; key < 5; ++key) {
+      if (not cache.get(key).has_value()) {
+        cache.put(key, key);
+      }
+    }
+  }
+  for (int key = 1000; key < 1100; ++key) {
+    ASSERT_TRUE(cache.get_else(key, [&] { return key; }).has_value());
+  }
+
+  for (int key = 0; key < 5; ++key) {
+    EXPECT_TRUE(cache.contains(key)) << key;
+  }
+  EXPECT_GT(cache.stats().rejected, 0);
+  EXPECT_LE(cache.stats().entries, 10);
+}
+
+/**
+ * @given cache with plain LRU like window of whole capacity
+ * @when keys are put
+ * @then least recently used key is evicted
+ */
+TEST(TinyLfuCacheTest, WindowIsLru) {
+  TinyLfuCache<int, int> cache{{.capacity = 2, .window_percent = 100}};
+  cache.put(1, 1);
+  cache.put(2, 2);
+  ASSERT_TRUE(cache.get(1).has_value());
+  cache.put(3, 3);
+
+  EXPECT_EQ(cache.keys(), (std::vector{3, 1}));
+}
+
+TEST(TinyLfuCacheTest, CapacityIsWeight) {
+  TinyLfuCache<int, std::string> cache{{
+      .capacity = 100,
+      .weigher = [](const std::string &value) { return value.size(); },
+      .window_percent = 50,
+  }};
+  for (int key = 0; key < 20; ++key) {
+    cache.put(key, std::string(10, 'x'));
+    EXPECT_LE(cache.stats().weight, 100);
+  }
+  EXPECT_LE(cache.stats().entries, 10);
+
+  // Heavier than main segment, never admitted
+  cache.put(100, std::string(60, 'x'));
+  cache.put(101, std::string(60, 'x'));
+  EXPECT_FALSE(cache.contains(100));
+  EXPECT_LE(cache.stats().weight, 100);
+}
+
+TEST(TinyLfuCacheTest, Erase) {
+  TinyLfuCache<int, int> cache{{.capacity = 10, .window_percent = 20}};
+  for (int key = 0; key < 6; ++key) {
+    cache.put(key, key);
+    cache.get(key);
+  }
+  cache.erase(0);
+  EXPECT_FALSE(cache.contains(0));
+  cache.erase_if([](int key, int) { return key % 2 == 1; });
+  for (int key = 1; key < 6; ++key) {
+    EXPECT_EQ(cache.contains(key), key % 2 == 0) << key;
+  }
+  EXPECT_EQ(cache.stats().entries, 2);
+  EXPECT_EQ(cache.stats().weight, 2);
+}
+
+TEST(TinyLfuCacheTest, CountsHitsAndMisses) {
+  TinyLfuCache<int, int> cache{4};
+  cache.get(1);
+  cache.put(1, 1);
+  cache.get(1);
+  cache.get(1);
+  auto stats = cache.stats();
+  EXPECT_EQ(stats.hits, 2);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.entries, 1);
+}
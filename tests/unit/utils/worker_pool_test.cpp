@@ -0,0 +1,73 @@
+/**
+ * Copyright Quadrivium LLC
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "utils/worker_pool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <latch>
+#include <thread>
+
+TEST(WorkerPoolTest, DefaultSize) {
+  lean::WorkerPool pool{0};
+  EXPECT_EQ(pool.size(), std::max(1u, std::thread::hardware_concurrency()));
+}
+
+TEST(WorkerPoolTest, RunsAllTasks) {
+  constexpr size_t kTasks = 10000;
+  lean::WorkerPool pool{4};
+  std::atomic_size_t counter = 0;
+  std::latch done{kTasks};
+  for (size_t i = 0; i < kTasks; ++i) {
+    pool.post([&] {
+      ++counter;
+      done.count_down();
+    });
+  }
+  pool.wait(done);
+  EXPECT_EQ(counter.load(), kTasks);
+}
+
+// Tasks pinned to busy worker are stolen by idle ones
+TEST(WorkerPoolTest, IdleWorkersSteal) {
+  constexpr size_t kTasks = 8;
+  lean::WorkerPool pool{4};
+  std::latch release{1};
+  std::latch done{kTasks};
+  pool.post([&] { release.wait(); }, 0);
+  for (size_t i = 0; i < kTasks; ++i) {
+    pool.post([&] { done.count_down(); }, 0);
+  }
+  pool.wait(done);
+  release.count_down();
+}
+
+// Pool task waiting for nested tasks runs them itself instead of blocking
+TEST(WorkerPoolTest, NestedWait) {
+  lean::WorkerPool pool{1};
+  std::latch outer{1};
+  pool.post([&] {
+    std::latch inner{2};
+    pool.post([&] { inner.count_down(); });
+    pool.post([&] { inner.count_down(); });
+    pool.wait(inner);
+    outer.count_down();
+  });
+  pool.wait(outer);
+}
+
+// Destructor runs tasks queued before it
+TEST(WorkerPoolTest, DrainsOnDestroy) {
+  std::atomic_size_t counter = 0;
+  {
+    lean::WorkerPool pool{2};
+    for (size_t i = 0; i < 100; ++i) {
+      pool.post([&] { ++counter; });
+    }
+  }
+  EXPECT_EQ(counter.load(), 100);
+}